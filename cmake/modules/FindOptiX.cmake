@@ -62,7 +62,7 @@ OPTIX_find_api_library(optix ${OPTIX_VERSION})
 OPTIX_find_api_library(optixu ${OPTIX_VERSION})
 OPTIX_find_api_library(optix_prime ${OPTIX_VERSION})
 
-set (OPTIX_LIBRARIES ${optix_LIBRARY})
+set (OPTIX_LIBRARIES ${optix_LIBRARY} ${optix_prime_LIBRARY})
 
 message (STATUS "OptiX version = ${OPTIX_VERSION}")
 if (NOT OptiX_FIND_QUIETLY)
@@ -0,0 +1,147 @@
+#!/usr/bin/python
+
+#
+# This source file is part of appleseed.
+# Visit https://appleseedhq.net/ for additional information and resources.
+#
+# This software is released under the MIT license.
+#
+# Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+
+from __future__ import print_function
+import argparse
+import re
+import xml.etree.ElementTree as ElementTree
+
+
+# -------------------------------------------------------------------------------------------------
+# Constants.
+# -------------------------------------------------------------------------------------------------
+
+# Scaling benchmark cases are named <Name>_<N>Thread or <Name>_<N>Threads.
+CASE_NAME_REGEX = re.compile(r"^(.+)_(\d+)Threads?$")
+
+
+# -------------------------------------------------------------------------------------------------
+# Read scaling benchmark results.
+# -------------------------------------------------------------------------------------------------
+
+def read_running_time(case_element):
+    results = case_element.find("results")
+    if results is None:
+        return None
+
+    frequency = float(results.findtext("frequency"))
+    samples = results.findtext("samples")
+
+    if samples:
+        values = [float(v) for v in samples.split()]
+        ticks = sum(values) / len(values)
+    else:
+        ticks = float(results.findtext("ticks"))
+
+    return ticks / frequency
+
+
+def read_scaling_series(filepath):
+    # Map "Suite::Name" to a dictionary of thread count -> running time in seconds.
+    series = {}
+
+    root = ElementTree.parse(filepath).getroot()
+
+    for suite in root.findall("benchmarksuite"):
+        for case in suite.findall("benchmarkcase"):
+            match = CASE_NAME_REGEX.match(case.get("name"))
+            if match is None:
+                continue
+
+            running_time = read_running_time(case)
+            if running_time is None or running_time <= 0.0:
+                continue
+
+            name = "{0}::{1}".format(suite.get("name"), match.group(1))
+            series.setdefault(name, {})[int(match.group(2))] = running_time
+
+    # Scaling is measured against the single-threaded case.
+    return {name: times for name, times in series.items() if 1 in times}
+
+
+# -------------------------------------------------------------------------------------------------
+# Report and plot scaling efficiency.
+# -------------------------------------------------------------------------------------------------
+
+def print_report(series):
+    for name in sorted(series):
+        times = series[name]
+        print("{0}:".format(name))
+        for thread_count in sorted(times):
+            speedup = times[1] / times[thread_count]
+            efficiency = speedup / thread_count
+            print("  {0:>3} thread(s): speedup x{1:.2f}, efficiency {2:.0f}%".format(
+                thread_count, speedup, 100.0 * efficiency))
+
+
+def write_gnuplot_file(series, filepath):
+    with open(filepath, "w") as file:
+        file.write("set title \"Scaling efficiency\"\n")
+        file.write("set xlabel \"Threads\"\n")
+        file.write("set ylabel \"Efficiency\"\n")
+        file.write("set logscale x 2\n")
+        file.write("set yrange [0:1.2]\n")
+        file.write("set key outside\n")
+
+        names = sorted(series)
+        plots = ["'-' with linespoints title \"{0}\"".format(name) for name in names]
+        file.write("plot " + ", ".join(plots) + "\n")
+
+        for name in names:
+            times = series[name]
+            for thread_count in sorted(times):
+                efficiency = times[1] / times[thread_count] / thread_count
+                file.write("{0} {1}\n".format(thread_count, efficiency))
+            file.write("e\n")
+
+
+# -------------------------------------------------------------------------------------------------
+# Entry point.
+# -------------------------------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description="report and plot the scaling efficiency of the "
+                                     "multithreaded benchmark cases of a benchmark results file.")
+    parser.add_argument("-o", "--output", metavar="filepath", help="write a gnuplot file")
+    parser.add_argument("filepath", help="benchmark results file written by appleseed.cli")
+    args = parser.parse_args()
+
+    series = read_scaling_series(args.filepath)
+
+    if len(series) == 0:
+        print("no scaling benchmark cases found in {0}.".format(args.filepath))
+        return
+
+    print_report(series)
+
+    if args.output:
+        write_gnuplot_file(series, args.output)
+
+if __name__ == "__main__":
+    main()
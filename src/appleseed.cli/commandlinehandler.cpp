@@ -69,6 +69,30 @@ CommandLineHandler::CommandLineHandler()
             .set_flags(OptionHandler::Repeatable)
             .set_exact_value_count(1));
 
+    parser().add_option_handler(
+        &m_server
+            .add_name("--server")
+            .set_description("keep the project loaded and render jobs read from the standard input"));
+
+    parser().add_option_handler(
+        &m_animation_path
+            .add_name("--animation-path")
+            .set_description("render one frame per keyframe of a camera animation path file")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_skip_validation
+            .add_name("--skip-validation")
+            .set_description("do not validate the project file against the project schema"));
+
+    parser().add_option_handler(
+        &m_huge_pages
+            .add_name("--huge-pages")
+            .set_description("back large geometry, BVH and texture allocations with huge pages")
+            .set_syntax("off|transparent|2mb|1gb")
+            .set_exact_value_count(1));
+
     parser().add_option_handler(
         &m_threads
             .add_name("--threads")
@@ -115,6 +139,13 @@ CommandLineHandler::CommandLineHandler()
             .set_syntax("n")
             .set_exact_value_count(1));
 
+    parser().add_option_handler(
+        &m_pass_range
+            .add_name("--pass-range")
+            .set_description("only render passes first to last (0-based, inclusive)")
+            .set_syntax("first last")
+            .set_exact_value_count(2));
+
     parser().add_option_handler(
         &m_override_shading
             .add_name("--override-shading")
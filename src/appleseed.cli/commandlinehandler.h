@@ -59,6 +59,10 @@ class CommandLineHandler
     // General options.
     foundation::ValueOptionHandler<std::string>         m_configuration;
     foundation::ValueOptionHandler<std::string>         m_params;
+    foundation::FlagOptionHandler                       m_server;
+    foundation::ValueOptionHandler<std::string>         m_animation_path;
+    foundation::FlagOptionHandler                       m_skip_validation;
+    foundation::ValueOptionHandler<std::string>         m_huge_pages;
 
     // Aliases for rendering options.
     foundation::ValueOptionHandler<std::string>         m_threads;  // std::string because we need to handle 'auto'
@@ -67,6 +71,7 @@ class CommandLineHandler
     foundation::ValueOptionHandler<foundation::uint32>  m_noise_seed;
     foundation::ValueOptionHandler<int>                 m_samples;
     foundation::ValueOptionHandler<int>                 m_passes;
+    foundation::ValueOptionHandler<int>                 m_pass_range;
     foundation::ValueOptionHandler<std::string>         m_override_shading;
     foundation::ValueOptionHandler<std::string>         m_show_object_instances;
     foundation::ValueOptionHandler<std::string>         m_hide_object_instances;
@@ -32,6 +32,7 @@
 #include "stdouttilecallback.h"
 
 // appleseed.shared headers.
+#include "application/animationpath.h"
 #include "application/application.h"
 #include "application/progresstilecallback.h"
 #include "application/superlogger.h"
@@ -68,7 +69,10 @@
 // Standard headers.
 #include <cstddef>
 #include <cstdlib>
+#include <iomanip>
+#include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
 
 using namespace appleseed::cli;
@@ -271,6 +275,40 @@ namespace
         }
     }
 
+    bool apply_huge_page_command_line_option()
+    {
+        if (!g_cl.m_huge_pages.is_set())
+            return true;
+
+        const string& value = g_cl.m_huge_pages.value();
+
+        HugePageMode mode;
+        if (value == "off")
+            mode = HugePagesOff;
+        else if (value == "transparent")
+            mode = HugePagesTransparent;
+        else if (value == "2mb")
+            mode = HugePages2MB;
+        else if (value == "1gb")
+            mode = HugePages1GB;
+        else
+        {
+            LOG_ERROR(
+                g_logger,
+                "invalid value \"%s\" for %s, expected off, transparent, 2mb or 1gb",
+                value.c_str(),
+                g_cl.m_huge_pages.get_name().c_str());
+            return false;
+        }
+
+        // Tessellations and trees are built while the project loads, so this must come first.
+        set_huge_page_mode(MemoryTagBVH, mode);
+        set_huge_page_mode(MemoryTagGeometry, mode);
+        set_huge_page_mode(MemoryTagTextures, mode);
+
+        return true;
+    }
+
     void apply_custom_parameter_command_line_options(ParamArray& params)
     {
         for (size_t i = 0; i < g_cl.m_params.values().size(); ++i)
@@ -368,6 +406,24 @@ namespace
         if (g_cl.m_passes.is_set())
             params.insert_path("passes", g_cl.m_passes.values()[0]);
 
+        if (g_cl.m_pass_range.is_set())
+        {
+            if (!g_cl.m_passes.is_set())
+            {
+                LOG_ERROR(
+                    g_logger,
+                    "number of passes must be specified with %s when using %s",
+                    g_cl.m_passes.get_name().c_str(),
+                    g_cl.m_pass_range.get_name().c_str());
+                return false;
+            }
+
+            const string pass_range =
+                  foundation::to_string(g_cl.m_pass_range.values()[0]) + ' ' +
+                  foundation::to_string(g_cl.m_pass_range.values()[1]);
+            params.insert("pass_range", pass_range);
+        }
+
         auto_release_ptr<Frame> new_frame(
             FrameFactory::create(
                 frame->get_name(),
@@ -463,7 +519,10 @@ namespace
         return
             reader.read(
                 project_filepath.c_str(),
-                schema_filepath.string().c_str());
+                schema_filepath.string().c_str(),
+                g_cl.m_skip_validation.is_set()
+                    ? ProjectFileReader::OmitProjectSchemaValidation
+                    : ProjectFileReader::Defaults);
     }
 
     bool configure_project(Project& project, ParamArray& params)
@@ -505,19 +564,10 @@ namespace
         return value == "progressive";
     }
 
-    bool render(const string& project_filename)
+    ITileCallbackFactory* create_tile_callback_factory(
+        const Project&      project,
+        const ParamArray&   params)
     {
-        // Load the project.
-        auto_release_ptr<Project> project = load_project(project_filename);
-        if (project.get() == nullptr)
-            return false;
-
-        // Retrieve the rendering parameters.
-        ParamArray params;
-        if (!configure_project(project.ref(), params))
-            return false;
-
-        // Create the tile callback factory.
         unique_ptr<ITileCallbackFactory> tile_callback_factory;
         if (g_cl.m_send_to_stdout.is_set())
         {
@@ -525,7 +575,7 @@ namespace
                 new StdOutTileCallbackFactory(
                     StdOutTileCallbackFactory::TileOutputOptions::AllAOVs));
         }
-        else if (project->get_display() == nullptr)
+        else if (project.get_display() == nullptr)
         {
             // Create a default tile callback if needed.
             if (params.get_optional<string>("frame_renderer", "") != "progressive")
@@ -537,22 +587,23 @@ namespace
             }
         }
 
-        SearchPaths resource_search_paths;
-        Application::initialize_resource_search_paths(resource_search_paths);
+        return tile_callback_factory.release();
+    }
 
-        // Create the master renderer.
-        DefaultRendererController renderer_controller;
-        MasterRenderer renderer(
-            project.ref(),
-            params,
-            resource_search_paths,
-            &renderer_controller,
-            tile_callback_factory.get());
+    void set_output_streaming_path(Frame& frame, const char* file_path)
+    {
+        // If the frame is streamed to disk while rendering, stream it to the output file.
+        ParamArray& frame_params = frame.get_parameters();
+        if (file_path != nullptr && frame_params.get_optional<bool>("output_streaming", false))
+            frame_params.insert("output_filename", file_path);
+    }
 
-        // Render the frame.
+    MasterRenderer::RenderingResult render_frame(MasterRenderer& renderer)
+    {
         LOG_INFO(g_logger, "rendering frame...");
+
         MasterRenderer::RenderingResult rendering_result;
-        if (params.get_optional<bool>("background_mode", true))
+        if (renderer.get_parameters().get_optional<bool>("background_mode", true))
         {
             ProcessPriorityContext background_context(ProcessPriorityLow, &g_logger);
             rendering_result = renderer.render();
@@ -561,20 +612,64 @@ namespace
         {
             rendering_result = renderer.render();
         }
-        if (rendering_result.m_status != MasterRenderer::RenderingResult::Succeeded)
-            return false;
 
         // Print rendering time.
-        LOG_INFO(
-            g_logger,
-            "rendering finished in %s.",
-            pretty_time(rendering_result.m_render_time, 3).c_str());
+        if (rendering_result.m_status == MasterRenderer::RenderingResult::Succeeded)
+        {
+            LOG_INFO(
+                g_logger,
+                "rendering finished in %s.",
+                pretty_time(rendering_result.m_render_time, 3).c_str());
+        }
+
+        return rendering_result;
+    }
+
+    bool write_frame(const Frame& frame, const char* file_path)
+    {
+        return frame.write_main_and_aov_images(file_path);
+    }
+
+    bool render(const string& project_filename)
+    {
+        // Load the project.
+        auto_release_ptr<Project> project = load_project(project_filename);
+        if (project.get() == nullptr)
+            return false;
+
+        // Retrieve the rendering parameters.
+        ParamArray params;
+        if (!configure_project(project.ref(), params))
+            return false;
+
+        const char* output_path = g_cl.m_output.is_set() ? g_cl.m_output.value().c_str() : nullptr;
+        set_output_streaming_path(*project->get_frame(), output_path);
+
+        // Create the tile callback factory.
+        unique_ptr<ITileCallbackFactory> tile_callback_factory(
+            create_tile_callback_factory(project.ref(), params));
+
+        SearchPaths resource_search_paths;
+        Application::initialize_resource_search_paths(resource_search_paths);
+
+        // Create the master renderer.
+        DefaultRendererController renderer_controller;
+        MasterRenderer renderer(
+            project.ref(),
+            params,
+            resource_search_paths,
+            &renderer_controller,
+            tile_callback_factory.get());
+
+        // Render the frame.
+        if (render_frame(renderer).m_status != MasterRenderer::RenderingResult::Succeeded)
+            return false;
 
         bool success = true;
 
         // Optionally archive the frame to disk.
         char* archive_path = nullptr;
-        if (params.get_optional<bool>("autosave", true))
+        if (params.get_optional<bool>("autosave", true) && !project->get_frame()->is_output_streamed())
         {
             // Construct the path to the archive directory.
             const bf::path autosave_path =
@@ -590,19 +685,8 @@ namespace
         }
 
         // Optionally write the frame to disk.
-        if (g_cl.m_output.is_set())
-        {
-            const char* file_path = g_cl.m_output.value().c_str();
-            if (!project->get_frame()->write_main_image(file_path))
-                success = false;
-            if (!project->get_frame()->write_aov_images(file_path))
-                success = false;
-        }
-        else
-        {
-            if (!project->get_frame()->write_main_and_aov_images())
-                success = false;
-        }
+        if (!write_frame(*project->get_frame(), output_path))
+            success = false;
 
 #if defined __APPLE__ || defined _WIN32
 
@@ -632,6 +716,280 @@ namespace
         return success;
     }
 
+    bool split_assignment(const string& s, string& name, string& value)
+    {
+        const string::size_type equal_pos = s.find_first_of('=');
+        if (equal_pos == string::npos || equal_pos == 0)
+        {
+            LOG_ERROR(g_logger, "expected name=value, got \"%s\".", s.c_str());
+            return false;
+        }
+
+        name = s.substr(0, equal_pos);
+        value = s.substr(equal_pos + 1);
+
+        return true;
+    }
+
+    bool set_active_camera(Project& project, const string& camera_name)
+    {
+        if (project.get_scene()->cameras().get_by_name(camera_name.c_str()) == nullptr)
+        {
+            LOG_ERROR(g_logger, "the camera \"%s\" does not exist.", camera_name.c_str());
+            return false;
+        }
+
+        project.get_frame()->get_parameters().insert("camera", camera_name);
+
+        return true;
+    }
+
+    bool set_frame_parameter(Project& project, const string& assignment)
+    {
+        string name, value;
+        if (!split_assignment(assignment, name, value))
+            return false;
+
+        // Frame parameters are only read when the frame is created.
+        const Frame* frame = project.get_frame();
+        ParamArray params = frame->get_parameters();
+        params.insert_path(name, value);
+
+        auto_release_ptr<Frame> new_frame(
+            FrameFactory::create(
+                frame->get_name(),
+                params,
+                frame->aovs()));
+
+        project.set_frame(new_frame);
+
+        return true;
+    }
+
+    bool set_rendering_parameter(MasterRenderer& renderer, const string& assignment)
+    {
+        string name, value;
+        if (!split_assignment(assignment, name, value))
+            return false;
+
+        renderer.get_parameters().insert_path(name, value);
+
+        return true;
+    }
+
+    bool render_job(Project& project, MasterRenderer& renderer, const string& output_path)
+    {
+        const char* file_path = output_path.empty() ? nullptr : output_path.c_str();
+        set_output_streaming_path(*project.get_frame(), file_path);
+
+        if (render_frame(renderer).m_status != MasterRenderer::RenderingResult::Succeeded)
+            return false;
+
+        return write_frame(*project.get_frame(), file_path);
+    }
+
+    //
+    // In server mode, the project and the master renderer are kept alive and render jobs
+    // are read from the standard input, one command per line:
+    //
+    //   camera <name>          make a camera active
+    //   frame <name>=<value>   set a frame parameter
+    //   param <path>=<value>   set a rendering parameter
+    //   output [<path>]        set the output file, or write to the frame's output file
+    //   render                 render the frame and write it to disk
+    //   quit                   exit
+    //
+    // Each command is answered with "ok" or "error" on the standard output. Since the
+    // project stays loaded, successive jobs only update the acceleration structures
+    // of the entities that changed instead of rebuilding them.
+    //
+
+    bool serve(const string& project_filename)
+    {
+        // The standard output is used to answer commands.
+        if (g_cl.m_send_to_stdout.is_set())
+        {
+            LOG_ERROR(
+                g_logger,
+                "%s cannot be used with %s.",
+                g_cl.m_send_to_stdout.get_name().c_str(),
+                g_cl.m_server.get_name().c_str());
+            return false;
+        }
+
+        // Load the project.
+        auto_release_ptr<Project> project = load_project(project_filename);
+        if (project.get() == nullptr)
+            return false;
+
+        // Retrieve the rendering parameters.
+        ParamArray params;
+        if (!configure_project(project.ref(), params))
+            return false;
+
+        // Create the tile callback factory.
+        unique_ptr<ITileCallbackFactory> tile_callback_factory(
+            create_tile_callback_factory(project.ref(), params));
+
+        SearchPaths resource_search_paths;
+        Application::initialize_resource_search_paths(resource_search_paths);
+
+        // Create the master renderer.
+        DefaultRendererController renderer_controller;
+        MasterRenderer renderer(
+            project.ref(),
+            params,
+            resource_search_paths,
+            &renderer_controller,
+            tile_callback_factory.get());
+
+        string output_path = g_cl.m_output.is_set() ? g_cl.m_output.value() : string();
+
+        LOG_INFO(g_logger, "waiting for commands on standard input...");
+
+        string line;
+        while (getline(cin, line))
+        {
+            line = trim_both(line);
+            if (line.empty())
+                continue;
+
+            const string::size_type space_pos = line.find_first_of(' ');
+            const string command = line.substr(0, space_pos);
+            const string argument =
+                space_pos != string::npos
+                    ? trim_both(line.substr(space_pos + 1))
+                    : string();
+
+            if (command == "quit")
+                break;
+
+            bool success = false;
+            if (command == "camera")
+                success = set_active_camera(project.ref(), argument);
+            else if (command == "frame")
+                success = set_frame_parameter(project.ref(), argument);
+            else if (command == "param")
+                success = set_rendering_parameter(renderer, argument);
+            else if (command == "output")
+            {
+                output_path = argument;
+                success = true;
+            }
+            else if (command == "render")
+                success = render_job(project.ref(), renderer, output_path);
+            else LOG_ERROR(g_logger, "unknown command: %s", command.c_str());
+
+            cout << (success ? "ok" : "error") << endl;
+        }
+
+        return true;
+    }
+
+    string make_numbered_filename(
+        const string&   filename,
+        const size_t    number,
+        const size_t    digits = 4)
+    {
+        const bf::path path(filename);
+
+        stringstream sstr;
+        sstr << path.stem().string();
+        sstr << '.';
+        sstr << setw(digits) << setfill('0') << number;
+        sstr << path.extension().string();
+
+        return (path.parent_path() / sstr.str()).string();
+    }
+
+    //
+    // Render all frames of a camera animation with the same master renderer. Only the
+    // camera moves, so acceleration structures, OSL shader groups and the texture
+    // system are set up once and reused by every frame.
+    //
+
+    bool render_animation(const string& project_filename)
+    {
+        // Load the animation path.
+        AnimationPath animation_path(g_logger);
+        if (!animation_path.load(g_cl.m_animation_path.value().c_str()))
+            return false;
+
+        // Load the project.
+        auto_release_ptr<Project> project = load_project(project_filename);
+        if (project.get() == nullptr)
+            return false;
+
+        // Retrieve the rendering parameters.
+        ParamArray params;
+        if (!configure_project(project.ref(), params))
+            return false;
+
+        // Retrieve the path of the output files.
+        const string output_path =
+            g_cl.m_output.is_set()
+                ? g_cl.m_output.value()
+                : project->get_frame()->get_parameters().get_optional<string>("output_filename", "");
+        if (output_path.empty())
+        {
+            LOG_ERROR(g_logger, "output path must be specified when rendering an animation.");
+            return false;
+        }
+
+        Camera* camera = project->get_uncached_active_camera();
+        if (camera == nullptr)
+        {
+            LOG_ERROR(g_logger, "no active camera to animate.");
+            return false;
+        }
+
+        // Create the tile callback factory.
+        unique_ptr<ITileCallbackFactory> tile_callback_factory(
+            create_tile_callback_factory(project.ref(), params));
+
+        SearchPaths resource_search_paths;
+        Application::initialize_resource_search_paths(resource_search_paths);
+
+        // Create the master renderer.
+        DefaultRendererController renderer_controller;
+        MasterRenderer renderer(
+            project.ref(),
+            params,
+            resource_search_paths,
+            &renderer_controller,
+            tile_callback_factory.get());
+
+        for (size_t i = 0, e = animation_path.size(); i < e; ++i)
+        {
+            const size_t frame = i + 1;
+            const string file_path = make_numbered_filename(output_path, frame);
+
+            LOG_INFO(
+                g_logger,
+                "rendering animation frame %s of %s...",
+                pretty_uint(frame).c_str(),
+                pretty_uint(e).c_str());
+
+            // Set the camera's transform sequence.
+            camera->transform_sequence().clear();
+            camera->transform_sequence().set_transform(0.0f, animation_path[i]);
+
+            set_output_streaming_path(*project->get_frame(), file_path.c_str());
+
+            if (render_frame(renderer).m_status != MasterRenderer::RenderingResult::Succeeded)
+            {
+                project->get_frame()->wait_for_image_writes();
+                return false;
+            }
+
+            // Write this frame's images while the next frame is being set up.
+            // The frame waits for these writes before its next rendering starts.
+            project->get_frame()->write_main_and_aov_images_in_background(file_path.c_str());
+        }
+
+        return project->get_frame()->wait_for_image_writes();
+    }
+
     bool benchmark_render(const string& project_filename)
     {
         // Configure our logger.
@@ -748,13 +1106,29 @@ int main(int argc, char* argv[])
     // Render the specified project.
     if (!g_cl.m_filename.values().empty())
     {
+        success = success && apply_huge_page_command_line_option();
+
         const string project_filename = g_cl.m_filename.value();
 
+        // Let a dedicated thread send the renderer's messages to the log targets so that
+        // render threads don't wait on each other, and keep warning storms in check.
+        global_logger().set_repeated_message_limit(10);
+        global_logger().set_async_mode();
+
         if (g_cl.m_benchmark_mode.is_set())
             success = success && benchmark_render(project_filename);
+        else if (g_cl.m_server.is_set())
+            success = success && serve(project_filename);
+        else if (g_cl.m_animation_path.is_set())
+            success = success && render_animation(project_filename);
         else success = success && render(project_filename);
+
+        global_logger().set_async_mode(false);
     }
 
+    // Write the recorded timeline, if requested.
+    g_cl.write_trace_file(g_logger);
+
     if (is_debugger_attached())
         Console::pause();
 
@@ -26,14 +26,26 @@
 // THE SOFTWARE.
 //
 
+// appleseed.python headers.
+#include "gillocks.h"
+
 // appleseed.renderer headers.
 #include "renderer/api/object.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/vector.h"
 #include "foundation/platform/python.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/thread/thread.hpp"
 
 // Standard headers.
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <vector>
 
 namespace bpy = boost::python;
 using namespace foundation;
@@ -95,6 +107,45 @@ namespace
         short mat_nr;
         char flag, pad;
     };
+
+    // Call func(begin, end) on disjoint chunks of [0, count) from as many threads as there are CPU cores.
+    template <typename Func>
+    void parallel_for_chunks(const size_t count, const Func& func)
+    {
+        const size_t MinChunkSize = 64 * 1024;
+
+        const size_t chunk_count =
+            std::min(
+                System::get_logical_cpu_core_count(),
+                std::max<size_t>(count / MinChunkSize, 1));
+
+        const size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+
+        boost::thread_group threads;
+
+        for (size_t i = 1; i < chunk_count; ++i)
+        {
+            const size_t begin = std::min(i * chunk_size, count);
+            const size_t end = std::min(begin + chunk_size, count);
+            threads.create_thread([&func, begin, end]() { func(begin, end); });
+        }
+
+        func(0, std::min(chunk_size, count));
+
+        threads.join_all();
+    }
+
+    GVector3 convert_normal(const short no[3])
+    {
+        const GVector3 n(
+            static_cast<GScalar>(no[0]),
+            static_cast<GScalar>(no[1]),
+            static_cast<GScalar>(no[2]));
+
+        const GScalar norm2 = square_norm(n);
+
+        return norm2 > GScalar(0.0) ? n / std::sqrt(norm2) : GVector3(0.0, 0.0, 1.0);
+    }
 }
 
 
@@ -326,10 +377,181 @@ void export_mesh_blender80_pose(
     }
 }
 
+//
+// Same as export_mesh_blender80(), but vertices and vertex normals are exported once per
+// Blender vertex instead of once per loop, UV coordinates are deduplicated per vertex, and
+// triangles are filled in parallel directly in the mesh storage. Python's global interpreter
+// lock is released during the conversion.
+//
+// Vertex poses for meshes exported by this function are set with export_mesh_blender80_parallel_pose().
+//
+
+void export_mesh_blender80_parallel(
+    MeshObject*         blender_mesh,
+    const size_t        bl_looptri_count,
+    const uintptr_t     bl_looptri_ptr,
+    const size_t        bl_loop_count,
+    const uintptr_t     bl_loops_ptr,
+    const uintptr_t     bl_polys_ptr,
+    const size_t        bl_vert_count,
+    const uintptr_t     bl_vertices_ptr,
+    const uintptr_t     bl_loops_uv_ptr,
+    const bool          export_normals,
+    const bool          export_uvs)
+{
+    // Convert uintptr_t numbers to actual pointers.
+    const MLoopTri* bl_looptri_array = reinterpret_cast<MLoopTri*>(bl_looptri_ptr);
+    const MLoop* bl_loop_array = reinterpret_cast<MLoop*>(bl_loops_ptr);
+    const MPoly* bl_poly_array = reinterpret_cast<MPoly*>(bl_polys_ptr);
+    const MVert* bl_vert_array = reinterpret_cast<MVert*>(bl_vertices_ptr);
+    const MLoopUV* bl_loop_uv_array = reinterpret_cast<MLoopUV*>(bl_loops_uv_ptr);
+
+    ScopedGILUnlock unlock;
+
+    const uint32 vertex_base = static_cast<uint32>(blender_mesh->get_vertex_count());
+    const uint32 normal_base = static_cast<uint32>(blender_mesh->get_vertex_normal_count());
+    const uint32 uv_base = static_cast<uint32>(blender_mesh->get_tex_coords_count());
+    const size_t triangle_base = blender_mesh->get_triangle_count();
+
+    // Push vertices.
+    blender_mesh->reserve_vertices(vertex_base + bl_vert_count);
+
+    for (size_t vertex_index = 0; vertex_index < bl_vert_count; ++vertex_index)
+    {
+        const MVert& bl_vert = bl_vert_array[vertex_index];
+        blender_mesh->push_vertex(GVector3(bl_vert.co[0], bl_vert.co[1], bl_vert.co[2]));
+    }
+
+    // Push normals.
+    if (export_normals)
+    {
+        blender_mesh->reserve_vertex_normals(normal_base + bl_vert_count);
+
+        for (size_t vertex_index = 0; vertex_index < bl_vert_count; ++vertex_index)
+            blender_mesh->push_vertex_normal(convert_normal(bl_vert_array[vertex_index].no));
+    }
+
+    // Push UV coordinates, merging identical UV coordinates of the loops of a same vertex.
+    std::vector<uint32> loop_uv_indices;
+    if (export_uvs)
+    {
+        const uint32 EndOfList = ~uint32(0);
+
+        std::vector<GVector2> uvs;
+        std::vector<uint32> next_uv_indices;
+        std::vector<uint32> first_uv_indices(bl_vert_count, EndOfList);
+        loop_uv_indices.resize(bl_loop_count);
+
+        for (size_t loop_index = 0; loop_index < bl_loop_count; ++loop_index)
+        {
+            const uint32 vertex_index = bl_loop_array[loop_index].v;
+            const MLoopUV& bl_loop_uv = bl_loop_uv_array[loop_index];
+            const GVector2 uv(bl_loop_uv.uv[0], bl_loop_uv.uv[1]);
+
+            uint32 uv_index = first_uv_indices[vertex_index];
+            while (uv_index != EndOfList && uvs[uv_index] != uv)
+                uv_index = next_uv_indices[uv_index];
+
+            if (uv_index == EndOfList)
+            {
+                uv_index = static_cast<uint32>(uvs.size());
+                uvs.push_back(uv);
+                next_uv_indices.push_back(first_uv_indices[vertex_index]);
+                first_uv_indices[vertex_index] = uv_index;
+            }
+
+            loop_uv_indices[loop_index] = uv_index;
+        }
+
+        blender_mesh->reserve_tex_coords(uv_base + uvs.size());
+
+        for (const GVector2& uv : uvs)
+            blender_mesh->push_tex_coords(uv);
+    }
+
+    if (bl_looptri_count == 0)
+        return;
+
+    // Allocate triangles, then fill them in parallel.
+    blender_mesh->reserve_triangles(triangle_base + bl_looptri_count);
+
+    for (size_t looptri_index = 0; looptri_index < bl_looptri_count; ++looptri_index)
+        blender_mesh->push_triangle(Triangle());
+
+    Triangle* triangles = &blender_mesh->get_triangle(triangle_base);
+    const uint32* uv_indices = loop_uv_indices.data();
+
+    parallel_for_chunks(
+        bl_looptri_count,
+        [=](const size_t begin, const size_t end)
+        {
+            for (size_t looptri_index = begin; looptri_index < end; ++looptri_index)
+            {
+                const MLoopTri& bl_looptri = bl_looptri_array[looptri_index];
+                const uint32 v0 = bl_loop_array[bl_looptri.tri[0]].v;
+                const uint32 v1 = bl_loop_array[bl_looptri.tri[1]].v;
+                const uint32 v2 = bl_loop_array[bl_looptri.tri[2]].v;
+
+                Triangle& as_tri = triangles[looptri_index];
+
+                as_tri.m_v0 = vertex_base + v0;
+                as_tri.m_v1 = vertex_base + v1;
+                as_tri.m_v2 = vertex_base + v2;
+
+                if (export_normals)
+                {
+                    as_tri.m_n0 = normal_base + v0;
+                    as_tri.m_n1 = normal_base + v1;
+                    as_tri.m_n2 = normal_base + v2;
+                }
+                else as_tri.m_n0 = as_tri.m_n1 = as_tri.m_n2 = Triangle::None;
+
+                if (export_uvs)
+                {
+                    as_tri.m_a0 = uv_base + uv_indices[bl_looptri.tri[0]];
+                    as_tri.m_a1 = uv_base + uv_indices[bl_looptri.tri[1]];
+                    as_tri.m_a2 = uv_base + uv_indices[bl_looptri.tri[2]];
+                }
+                else as_tri.m_a0 = as_tri.m_a1 = as_tri.m_a2 = Triangle::None;
+
+                as_tri.m_pa = static_cast<uint32>(bl_poly_array[bl_looptri.poly].mat_nr);
+            }
+        });
+}
+
+void export_mesh_blender80_parallel_pose(
+    MeshObject*         blender_mesh,
+    const size_t        pose,
+    const size_t        bl_vert_count,
+    const uintptr_t     bl_vert_ptr,
+    const bool          export_normals)
+{
+    // Convert uintptr_t numbers to actual pointers.
+    const MVert* bl_vert_array = reinterpret_cast<MVert*>(bl_vert_ptr);
+
+    ScopedGILUnlock unlock;
+
+    // Push vertices.
+    for (size_t vertex_index = 0; vertex_index < bl_vert_count; ++vertex_index)
+    {
+        const MVert& bl_vert = bl_vert_array[vertex_index];
+        blender_mesh->set_vertex_pose(vertex_index, pose, GVector3(bl_vert.co[0], bl_vert.co[1], bl_vert.co[2]));
+    }
+
+    // Push normals.
+    if (export_normals)
+    {
+        for (size_t vertex_index = 0; vertex_index < bl_vert_count; ++vertex_index)
+            blender_mesh->set_vertex_normal_pose(vertex_index, pose, convert_normal(bl_vert_array[vertex_index].no));
+    }
+}
+
 void bind_blender_mesh_converter()
 {
     bpy::def("export_mesh_blender79", &export_mesh_blender79);
     bpy::def("export_mesh_blender79_pose", &export_mesh_blender79_pose);
     bpy::def("export_mesh_blender80", &export_mesh_blender80);
     bpy::def("export_mesh_blender80_pose", &export_mesh_blender80_pose);
+    bpy::def("export_mesh_blender80_parallel", &export_mesh_blender80_parallel);
+    bpy::def("export_mesh_blender80_parallel_pose", &export_mesh_blender80_parallel_pose);
 }
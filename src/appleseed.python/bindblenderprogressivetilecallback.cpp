@@ -43,9 +43,15 @@
 // OpenGL
 #include <glad/glad.h>
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace bpy = boost::python;
@@ -61,6 +67,49 @@ using namespace renderer;
 
 namespace
 {
+    //
+    // Render threads never wait on Python's global interpreter lock: frame updates are
+    // copied into a native buffer under a mutex, and the redraw request, if any, is queued
+    // with Py_AddPendingCall() to be run by the Python main thread. At most one request is
+    // queued at any time; further updates are coalesced into it. Alternatively, the Python
+    // side can poll has_pending_update() at its own rate and call draw_pixels() when needed.
+    //
+
+    struct RedrawRequest
+    {
+        bpy::object             m_callback;
+        boost::atomic<bool>     m_queued;
+
+        explicit RedrawRequest(const bpy::object& callback)
+          : m_callback(callback)
+          , m_queued(false)
+        {
+        }
+    };
+
+    typedef std::shared_ptr<RedrawRequest> RedrawRequestPtr;
+
+    // Called by the Python main thread with the global interpreter lock held.
+    int run_redraw_request(void* arg)
+    {
+        const std::unique_ptr<RedrawRequestPtr> request(static_cast<RedrawRequestPtr*>(arg));
+
+        // Clear the flag before invoking the callback so that updates made in the meantime are not lost.
+        (*request)->m_queued = false;
+
+        try
+        {
+            (*request)->m_callback();
+        }
+        catch (...)
+        {
+            // Don't let Python exceptions propagate into C++.
+            PyErr_Clear();
+        }
+
+        return 0;
+    }
+
     class BlenderProgressiveTileCallback
       : public ITileCallback
     {
@@ -69,9 +118,9 @@ namespace
           : m_buffer_width(0)
           , m_buffer_height(0)
           , m_updated_buffer(false)
+          , m_texture_id(0)
           , m_texture_width(0)
           , m_texture_height(0)
-          , m_request_redraw_callback(request_redraw_callback)
           , m_updated_data_buffer(false)
           , m_shader_program_id(0)
           , m_vao_id(0)
@@ -79,6 +128,9 @@ namespace
           , m_texture_vbo_id(0)
           , m_ebo_id(0)
         {
+            if (request_redraw_callback)
+                m_redraw_request.reset(new RedrawRequest(request_redraw_callback));
+
             gladLoadGL();
         }
 
@@ -119,45 +171,60 @@ namespace
 
         void on_progressive_frame_update(const Frame* frame) override
         {
-            Image& image = frame->image();
-
-            // Realloc the buffer if the image size changed since the last time.
-            const CanvasProperties& props = image.properties();
-
-            if (props.m_canvas_width != m_buffer_width || props.m_canvas_height != m_buffer_height)
             {
-                m_buffer_width = props.m_canvas_width;
-                m_buffer_height = props.m_canvas_height;
-                m_buffer.resize(m_buffer_width * m_buffer_height * 4);
-            }
+                boost::mutex::scoped_lock lock(m_buffer_mutex);
 
-            // Copy the pixels to the buffer.
-            for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
-            {
-                for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
-                    copy_tile(image.tile(tx, ty), props, tx, ty);
-            }
+                Image& image = frame->image();
 
-            m_updated_buffer = true;
+                // Realloc the buffer if the image size changed since the last time.
+                const CanvasProperties& props = image.properties();
 
-            // Call the request redraw Python callback.
-            if (m_request_redraw_callback)
-            {
-                ScopedGILLock lock;
+                if (props.m_canvas_width != m_buffer_width || props.m_canvas_height != m_buffer_height)
+                {
+                    m_buffer_width = props.m_canvas_width;
+                    m_buffer_height = props.m_canvas_height;
+                    m_buffer.resize(m_buffer_width * m_buffer_height * 4);
+                }
 
-                try
+                // Copy the pixels to the buffer.
+                for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
                 {
-                    m_request_redraw_callback();
+                    for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+                        copy_tile(image.tile(tx, ty), props, tx, ty);
                 }
-                catch (...)
+
+                m_updated_buffer = true;
+            }
+
+            // Queue a call to the request redraw Python callback unless one is already queued.
+            if (m_redraw_request && !m_redraw_request->m_queued.exchange(true))
+            {
+                RedrawRequestPtr* arg = new RedrawRequestPtr(m_redraw_request);
+
+                if (Py_AddPendingCall(run_redraw_request, arg) != 0)
                 {
-                    // Don't let Python exceptions propagate into C++.
+                    // The queue of pending calls is full, retry on the next update.
+                    delete arg;
+                    m_redraw_request->m_queued = false;
                 }
             }
         }
 
+        bool has_pending_update() const
+        {
+            return m_updated_buffer;
+        }
+
         void draw_pixels()
         {
+            // Don't hold the global interpreter lock while waiting for a render thread to finish its copy.
+            boost::unique_lock<boost::mutex> lock(m_buffer_mutex, boost::defer_lock);
+
+            {
+                ScopedGILUnlock unlock;
+                lock.lock();
+            }
+
             if (m_texture_width != m_buffer_width || m_texture_height != m_buffer_height)
                 delete_texture();
 
@@ -271,16 +338,17 @@ namespace
         }
 
     private:
+        boost::mutex            m_buffer_mutex;
         std::vector<float>      m_buffer;
         size_t                  m_buffer_width;
         size_t                  m_buffer_height;
-        bool                    m_updated_buffer;
+        boost::atomic<bool>     m_updated_buffer;
 
         GLuint                  m_texture_id;
         size_t                  m_texture_width;
         size_t                  m_texture_height;
 
-        bpy::object             m_request_redraw_callback;
+        RedrawRequestPtr        m_redraw_request;
 
         std::array<GLfloat, 8>  m_vertex_coords;
         std::array<GLfloat, 8>  m_texture_coords;
@@ -405,6 +473,11 @@ namespace
     {
         return auto_release_ptr<BlenderProgressiveTileCallback>(new BlenderProgressiveTileCallback(request_redraw_callback));
     }
+
+    auto_release_ptr<BlenderProgressiveTileCallback> create_polled_blender_progressive_tile_callback()
+    {
+        return create_blender_progressive_tile_callback(bpy::object());
+    }
 }
 
 // Work around a regression in Visual Studio 2015 Update 3.
@@ -419,5 +492,7 @@ void bind_blender_progressive_tile_callback()
 {
     bpy::class_<BlenderProgressiveTileCallback, auto_release_ptr<BlenderProgressiveTileCallback>, bpy::bases<ITileCallback>, boost::noncopyable>("BlenderProgressiveTileCallback", bpy::no_init)
         .def("__init__", bpy::make_constructor(create_blender_progressive_tile_callback))
+        .def("__init__", bpy::make_constructor(create_polled_blender_progressive_tile_callback))
+        .def("has_pending_update", &BlenderProgressiveTileCallback::has_pending_update)
         .def("draw_pixels", &BlenderProgressiveTileCallback::draw_pixels);
 }
@@ -201,8 +201,8 @@ void bind_curve_object()
 
         .def("get_curve1_count", &CurveObject::get_curve1_count)
         .def("get_curve3_count", &CurveObject::get_curve3_count)
-        .def("get_curve1", &CurveObject::get_curve1, bpy::return_value_policy<bpy::reference_existing_object>())
-        .def("get_curve3", &CurveObject::get_curve3, bpy::return_value_policy<bpy::reference_existing_object>());
+        .def("get_curve1", &CurveObject::get_curve1)
+        .def("get_curve3", &CurveObject::get_curve3);
 
     boost::python::implicitly_convertible<auto_release_ptr<CurveObject>, auto_release_ptr<Object>>();
 
@@ -27,6 +27,9 @@
 // THE SOFTWARE.
 //
 
+// appleseed.python headers.
+#include "pybuffer.h"
+
 // appleseed.renderer headers.
 #include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/aov/tilestack.h"
@@ -133,6 +136,30 @@ namespace
         return c_array_to_py_array(data.get(), tile->get_pixel_format(), tile->get_size());
     }
 
+    bpy::object tile_get_storage_buffer(const Tile* tile)
+    {
+        // Expose the pixels without copying them.
+        return
+            make_memory_view(
+                tile->get_storage(),
+                tile->get_size(),
+                python_array_code(tile->get_pixel_format()),
+                false);
+    }
+
+    void tile_set_storage_from_buffer(Tile* tile, const bpy::object& buffer)
+    {
+        const ScopedPyBuffer source(buffer);
+
+        if (source.size() != tile->get_size())
+        {
+            PyErr_SetString(PyExc_RuntimeError, "Buffer size does not match tile size in appleseed.Tile.set_storage_from_buffer");
+            bpy::throw_error_already_set();
+        }
+
+        std::memcpy(tile->get_storage(), source.data(), source.size());
+    }
+
     std::string image_stack_get_name(const ImageStack* image_stack, const size_t index)
     {
         return image_stack->get_name(index);
@@ -177,7 +204,9 @@ void bind_image()
         .def("get_channel_count", &Tile::get_channel_count)
         .def("get_pixel_count", &Tile::get_pixel_count)
         .def("get_size", &Tile::get_size)
-        .def("get_storage", tile_get_storage);
+        .def("get_storage", tile_get_storage)
+        .def("get_storage_buffer", tile_get_storage_buffer)
+        .def("set_storage_from_buffer", tile_set_storage_from_buffer);
 
     const Tile& (Image::*image_get_tile)(const size_t, const size_t) const = &Image::tile;
 
@@ -30,17 +30,20 @@
 // appleseed.python headers.
 #include "bindentitycontainers.h"
 #include "dict2dict.h"
+#include "pybuffer.h"
 
 // appleseed.renderer headers.
 #include "renderer/api/object.h"
 
 // appleseed.foundation headers.
 #include "foundation/platform/python.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/murmurhash.h"
 #include "foundation/utility/searchpaths.h"
 
 // Standard headers.
 #include <cstddef>
+#include <cstring>
 #include <string>
 
 namespace bpy = boost::python;
@@ -77,6 +80,172 @@ namespace
         object->get_triangle(index) = triangle;
     }
 
+    //
+    // Buffer access.
+    //
+    // The views returned by the get_*_buffer() methods reference the mesh's own storage:
+    // they are read-only and become invalid if the mesh is modified or destroyed.
+    //
+
+    bpy::object get_vertices_buffer(const MeshObject* object)
+    {
+        const StaticTriangleTess& tess = object->get_static_triangle_tess();
+        return
+            make_memory_view(
+                const_cast<GVector3*>(tess.m_vertices.data()),
+                tess.m_vertices.size() * sizeof(GVector3),
+                sizeof(GScalar) == 4 ? "f" : "d",
+                true);
+    }
+
+    bpy::object get_vertex_normals_buffer(const MeshObject* object)
+    {
+        const StaticTriangleTess& tess = object->get_static_triangle_tess();
+        typedef StaticTriangleTess::UnitVectorType UnitVectorType;
+        return
+            make_memory_view(
+                const_cast<UnitVectorType*>(tess.m_vertex_normals.data()),
+                tess.m_vertex_normals.size() * sizeof(UnitVectorType),
+#ifdef APPLESEED_WITH_COMPRESSED_NORMALS
+                "h",    // pairs of 16-bit octahedral coordinates
+#else
+                sizeof(GScalar) == 4 ? "f" : "d",
+#endif
+                true);
+    }
+
+    bpy::object get_triangles_buffer(const MeshObject* object)
+    {
+        static_assert(sizeof(Triangle) == 10 * sizeof(uint32), "Unexpected layout of renderer::Triangle");
+
+        const StaticTriangleTess& tess = object->get_static_triangle_tess();
+
+        // Triangles of meshes prepared for rendering may be stored with 16-bit indices.
+        if (tess.has_compact_primitives())
+        {
+            static_assert(sizeof(CompactTriangle) == 10 * sizeof(uint16), "Unexpected layout of renderer::CompactTriangle");
+
+            return
+                make_memory_view(
+                    const_cast<CompactTriangle*>(tess.m_compact_primitives.data()),
+                    tess.m_compact_primitives.size() * sizeof(CompactTriangle),
+                    "H",
+                    true);
+        }
+
+        return
+            make_memory_view(
+                const_cast<Triangle*>(tess.m_primitives.data()),
+                tess.m_primitives.size() * sizeof(Triangle),
+                "I",
+                true);
+    }
+
+    size_t get_float_tuple_count(
+        const ScopedPyBuffer&   buffer,
+        const size_t            tuple_size,
+        const char*             function_name)
+    {
+        const bool is_float = buffer.format() == 'f' && buffer.item_size() == 4;
+        const bool is_double = buffer.format() == 'd' && buffer.item_size() == 8;
+
+        if ((!is_float && !is_double) || (buffer.size() / buffer.item_size()) % tuple_size != 0)
+        {
+            const string msg =
+                "Incompatible buffer given to appleseed.MeshObject." + string(function_name) +
+                ": expected float32 or float64 items in groups of " + to_string(tuple_size);
+            PyErr_SetString(PyExc_TypeError, msg.c_str());
+            bpy::throw_error_already_set();
+        }
+
+        return buffer.size() / buffer.item_size() / tuple_size;
+    }
+
+    GScalar get_scalar(const ScopedPyBuffer& buffer, const size_t index)
+    {
+        return
+            buffer.format() == 'd'
+                ? static_cast<GScalar>(static_cast<const double*>(buffer.data())[index])
+                : static_cast<GScalar>(static_cast<const float*>(buffer.data())[index]);
+    }
+
+    void push_vertices_from_buffer(MeshObject* object, const bpy::object& buffer)
+    {
+        const ScopedPyBuffer source(buffer);
+        const size_t count = get_float_tuple_count(source, 3, "push_vertices_from_buffer");
+
+        object->reserve_vertices(object->get_vertex_count() + count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            object->push_vertex(
+                GVector3(
+                    get_scalar(source, i * 3 + 0),
+                    get_scalar(source, i * 3 + 1),
+                    get_scalar(source, i * 3 + 2)));
+        }
+    }
+
+    void push_vertex_normals_from_buffer(MeshObject* object, const bpy::object& buffer)
+    {
+        const ScopedPyBuffer source(buffer);
+        const size_t count = get_float_tuple_count(source, 3, "push_vertex_normals_from_buffer");
+
+        object->reserve_vertex_normals(object->get_vertex_normal_count() + count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            object->push_vertex_normal(
+                GVector3(
+                    get_scalar(source, i * 3 + 0),
+                    get_scalar(source, i * 3 + 1),
+                    get_scalar(source, i * 3 + 2)));
+        }
+    }
+
+    void push_tex_coords_from_buffer(MeshObject* object, const bpy::object& buffer)
+    {
+        const ScopedPyBuffer source(buffer);
+        const size_t count = get_float_tuple_count(source, 2, "push_tex_coords_from_buffer");
+
+        object->reserve_tex_coords(object->get_tex_coords_count() + count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            object->push_tex_coords(
+                GVector2(
+                    get_scalar(source, i * 2 + 0),
+                    get_scalar(source, i * 2 + 1)));
+        }
+    }
+
+    void push_triangles_from_buffer(MeshObject* object, const bpy::object& buffer)
+    {
+        const ScopedPyBuffer source(buffer);
+
+        // Triangles are given with the layout of get_triangles_buffer(): ten 32-bit indices per triangle.
+        if (source.item_size() != 4 ||
+            (source.format() != 'I' && source.format() != 'i' && source.format() != 'L' && source.format() != 'l') ||
+            source.size() % sizeof(Triangle) != 0)
+        {
+            PyErr_SetString(
+                PyExc_TypeError,
+                "Incompatible buffer given to appleseed.MeshObject.push_triangles_from_buffer: expected 32-bit integer items in groups of 10");
+            bpy::throw_error_already_set();
+        }
+
+        const size_t count = source.size() / sizeof(Triangle);
+        object->reserve_triangles(object->get_triangle_count() + count);
+
+        const uint8* data = static_cast<const uint8*>(source.data());
+        for (size_t i = 0; i < count; ++i)
+        {
+            Triangle triangle;
+            std::memcpy(&triangle, data + i * sizeof(Triangle), sizeof(Triangle));
+            object->push_triangle(triangle);
+        }
+    }
+
     bpy::list read_mesh_objects(
         const bpy::list&    search_paths,
         const string&       base_object_name,
@@ -166,11 +335,15 @@ void bind_mesh_object()
         .def("push_vertex", &MeshObject::push_vertex)
         .def("get_vertex_count", &MeshObject::get_vertex_count)
         .def("get_vertex", &MeshObject::get_vertex, bpy::return_value_policy<bpy::reference_existing_object>())
+        .def("get_vertices_buffer", get_vertices_buffer)
+        .def("push_vertices_from_buffer", push_vertices_from_buffer)
 
         .def("reserve_vertex_normals", &MeshObject::reserve_vertex_normals)
         .def("push_vertex_normal", &MeshObject::push_vertex_normal)
         .def("get_vertex_normal_count", &MeshObject::get_vertex_normal_count)
         .def("get_vertex_normal", &MeshObject::get_vertex_normal, bpy::return_value_policy<bpy::reference_existing_object>())
+        .def("get_vertex_normals_buffer", get_vertex_normals_buffer)
+        .def("push_vertex_normals_from_buffer", push_vertex_normals_from_buffer)
 
         .def("reserve_vertex_tangents", &MeshObject::reserve_vertex_tangents)
         .def("push_vertex_tangent", &MeshObject::push_vertex_tangent)
@@ -181,12 +354,15 @@ void bind_mesh_object()
         .def("push_tex_coords", &MeshObject::push_tex_coords)
         .def("get_tex_coords_count", &MeshObject::get_tex_coords_count)
         .def("get_tex_coords", &MeshObject::get_tex_coords)
+        .def("push_tex_coords_from_buffer", push_tex_coords_from_buffer)
 
         .def("reserve_triangles", &MeshObject::reserve_triangles)
         .def("push_triangle", &MeshObject::push_triangle)
         .def("get_triangle_count", &MeshObject::get_triangle_count)
         .def("get_triangle", get_triangle, bpy::return_value_policy<bpy::reference_existing_object>())
         .def("set_triangle", set_triangle)
+        .def("get_triangles_buffer", get_triangles_buffer)
+        .def("push_triangles_from_buffer", push_triangles_from_buffer)
 
         .def("set_motion_segment_count", &MeshObject::set_motion_segment_count)
         .def("get_motion_segment_count", &MeshObject::get_motion_segment_count)
@@ -49,10 +49,12 @@
 #include "renderer/api/scene.h"
 #include "renderer/api/surfaceshader.h"
 #include "renderer/api/texture.h"
+#include "renderer/api/trace.h"
 #include "renderer/api/volume.h"
 
 // appleseed.foundation headers.
 #include "foundation/platform/python.h"
+#include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/searchpaths.h"
 
 // Standard headers.
@@ -128,6 +130,14 @@ namespace
         }
     }
 
+    bpy::dict project_get_tree_statistics(const Project* project)
+    {
+        if (!project->has_trace_context())
+            return bpy::dict();
+
+        return dictionary_to_bpy_dict(project->get_trace_context().get_tree_statistics());
+    }
+
     ConfigurationContainer* project_get_configs(Project* project)
     {
         return &(project->configurations());
@@ -353,6 +363,9 @@ void bind_project()
 
         .def("get_active_camera", &Project::get_uncached_active_camera, bpy::return_value_policy<bpy::reference_existing_object>())
 
+        .def("build_trace_context", &Project::build_trace_context)
+        .def("get_tree_statistics", project_get_tree_statistics)
+
         .def("_wrap_cpp_project_pointer", &wrap_cpp_project_pointer).staticmethod("_wrap_cpp_project_pointer");
 
     bpy::enum_<ProjectFileReader::Options>("ProjectFileReaderOptions")
@@ -177,6 +177,24 @@ namespace
             }
         }
 
+        void on_remaining_time(const double seconds) override
+        {
+            // Lock Python's global interpreter lock (GIL),
+            // it was released in MasterRenderer.render.
+            ScopedGILLock lock;
+
+            try
+            {
+                // This callback is optional.
+                if (bpy::override f = get_override("on_remaining_time"))
+                    f(seconds);
+            }
+            catch (bpy::error_already_set)
+            {
+                PyErr_Print();
+            }
+        }
+
         Status get_status() const override
         {
             // Lock Python's global interpreter lock (GIL),
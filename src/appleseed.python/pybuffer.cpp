@@ -0,0 +1,104 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "pybuffer.h"
+
+// Standard headers.
+#include <cstring>
+
+namespace bpy = boost::python;
+
+bpy::object make_memory_view(
+    void*           data,
+    const size_t    size,
+    const char*     format,
+    const bool      read_only)
+{
+#if PY_MAJOR_VERSION >= 3
+    bpy::object view(
+        bpy::handle<>(
+            PyMemoryView_FromMemory(
+                static_cast<char*>(data),
+                static_cast<Py_ssize_t>(size),
+                read_only ? PyBUF_READ : PyBUF_WRITE)));
+
+    return std::strcmp(format, "B") == 0 ? view : view.attr("cast")(format);
+#else
+    return
+        bpy::object(
+            bpy::handle<>(
+                read_only
+                    ? PyBuffer_FromMemory(data, static_cast<Py_ssize_t>(size))
+                    : PyBuffer_FromReadWriteMemory(data, static_cast<Py_ssize_t>(size))));
+#endif
+}
+
+ScopedPyBuffer::ScopedPyBuffer(const bpy::object& obj)
+{
+    if (PyObject_GetBuffer(obj.ptr(), &m_buffer, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+    {
+        PyErr_Clear();
+        PyErr_SetString(PyExc_TypeError, "Incompatible type. Only contiguous buffers are supported.");
+        bpy::throw_error_already_set();
+    }
+}
+
+ScopedPyBuffer::~ScopedPyBuffer()
+{
+    PyBuffer_Release(&m_buffer);
+}
+
+const void* ScopedPyBuffer::data() const
+{
+    return m_buffer.buf;
+}
+
+size_t ScopedPyBuffer::size() const
+{
+    return static_cast<size_t>(m_buffer.len);
+}
+
+size_t ScopedPyBuffer::item_size() const
+{
+    return static_cast<size_t>(m_buffer.itemsize);
+}
+
+char ScopedPyBuffer::format() const
+{
+    // No format means unsigned bytes.
+    const char* format = m_buffer.format;
+    if (format == nullptr)
+        return 'B';
+
+    // Skip the native byte order and alignment prefixes.
+    while (*format == '@' || *format == '=' || *format == '<')
+        ++format;
+
+    return *format;
+}
@@ -0,0 +1,72 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/python.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Return a Python object exposing a region of memory through the buffer protocol,
+// for instance to build NumPy arrays with numpy.frombuffer(). The memory is not copied
+// and must outlive the returned object. `format` is a struct module format character
+// used to type the returned memoryview (ignored with Python 2, which returns bytes).
+boost::python::object make_memory_view(
+    void*                           data,
+    const size_t                    size,
+    const char*                     format,
+    const bool                      read_only);
+
+// This class acquires a C-contiguous buffer from a Python object supporting
+// the buffer protocol (e.g. a NumPy array, a bytes or array.array object)
+// on construction and releases it on destruction.
+class ScopedPyBuffer
+  : public foundation::NonCopyable
+{
+  public:
+    // Raise a Python TypeError if the object doesn't expose a contiguous buffer.
+    explicit ScopedPyBuffer(const boost::python::object& obj);
+    ~ScopedPyBuffer();
+
+    const void* data() const;
+
+    // Return the size of the buffer in bytes.
+    size_t size() const;
+
+    // Return the size of one item of the buffer in bytes.
+    size_t item_size() const;
+
+    // Return the struct module format character of the items of the buffer.
+    char format() const;
+
+  private:
+    Py_buffer                       m_buffer;
+};
@@ -0,0 +1,86 @@
+
+#
+# This source file is part of appleseed.
+# Visit https://appleseedhq.net/ for additional information and resources.
+#
+# This software is released under the MIT license.
+#
+# Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+
+import array
+import unittest
+import appleseed as asr
+
+
+def buffer_to_array(typecode, buffer):
+    result = array.array(typecode)
+    if hasattr(result, "frombytes"):
+        result.frombytes(bytes(buffer))
+    else:
+        result.fromstring(bytes(buffer))
+    return result
+
+
+class TestMeshObject(unittest.TestCase):
+
+    def setUp(self):
+        self.mesh = asr.MeshObject("mesh", {})
+
+    def test_push_vertices_from_buffer(self):
+        self.mesh.push_vertices_from_buffer(array.array('f', [1.0, 2.0, 3.0, 4.0, 5.0, 6.0]))
+
+        self.assertEqual(2, self.mesh.get_vertex_count())
+        self.assertEqual(asr.Vector3f(4.0, 5.0, 6.0), self.mesh.get_vertex(1))
+
+    def test_push_vertices_from_double_buffer(self):
+        self.mesh.push_vertices_from_buffer(array.array('d', [1.0, 2.0, 3.0]))
+
+        self.assertEqual(asr.Vector3f(1.0, 2.0, 3.0), self.mesh.get_vertex(0))
+
+    def test_push_vertices_from_incomplete_buffer_raises(self):
+        with self.assertRaises(TypeError):
+            self.mesh.push_vertices_from_buffer(array.array('f', [1.0, 2.0]))
+
+    def test_get_vertices_buffer(self):
+        self.mesh.push_vertex(asr.Vector3f(1.0, 2.0, 3.0))
+        self.mesh.push_vertex(asr.Vector3f(4.0, 5.0, 6.0))
+
+        vertices = buffer_to_array('f', self.mesh.get_vertices_buffer())
+
+        self.assertEqual([1.0, 2.0, 3.0, 4.0, 5.0, 6.0], vertices.tolist())
+
+    def test_push_triangles_from_buffer(self):
+        self.mesh.push_triangles_from_buffer(array.array('I', [0, 1, 2, 0, 1, 2, 3, 4, 5, 7]))
+
+        self.assertEqual(1, self.mesh.get_triangle_count())
+        self.assertEqual(2, self.mesh.get_triangle(0).m_v2)
+        self.assertEqual(7, self.mesh.get_triangle(0).m_pa)
+
+        triangles = buffer_to_array('I', self.mesh.get_triangles_buffer())
+
+        self.assertEqual([0, 1, 2, 0, 1, 2, 3, 4, 5, 7], triangles.tolist())
+
+    def tearDown(self):
+        pass
+
+if __name__ == "__main__":
+    unittest.main()
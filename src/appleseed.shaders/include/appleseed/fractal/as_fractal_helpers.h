@@ -26,7 +26,6 @@
 // THE SOFTWARE.
 //
 
-
 //
 // Reference:
 //
@@ -47,7 +47,7 @@ using namespace foundation;
 using namespace std;
 
 namespace appleseed {
-namespace animatecamera {
+namespace shared {
 
 AnimationPath::AnimationPath(Logger& logger)
   : m_logger(logger)
@@ -207,5 +207,5 @@ const Transformd& AnimationPath::operator[](const size_t i) const
     return m_keyframes[i];
 }
 
-}   // namespace animatecamera
+}   // namespace shared
 }   // namespace appleseed
@@ -29,6 +29,9 @@
 
 #pragma once
 
+// appleseed.shared headers.
+#include "dllsymbol.h"
+
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/transform.h"
@@ -41,13 +44,13 @@
 namespace foundation    { class Logger; }
 
 namespace appleseed {
-namespace animatecamera {
+namespace shared {
 
 //
 // An animation path is a series of rigid transformation keyframes.
 //
 
-class AnimationPath
+class SHAREDDLL AnimationPath
   : public foundation::NonCopyable
 {
   public:
@@ -74,5 +77,5 @@ class AnimationPath
     std::vector<foundation::Transformd> m_keyframes;
 };
 
-}   // namespace animatecamera
+}   // namespace shared
 }   // namespace appleseed
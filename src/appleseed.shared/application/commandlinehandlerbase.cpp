@@ -42,6 +42,7 @@
 #include "foundation/platform/windows.h"
 #endif
 #include "foundation/utility/commandlineparser.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/log.h"
 
 // Boost headers.
@@ -71,6 +72,7 @@ struct CommandLineHandlerBase::Impl
     ValueOptionHandler<string>  m_message_verbosity;
     FlagOptionHandler           m_message_coloring;
     FlagOptionHandler           m_display_options;
+    ValueOptionHandler<string>  m_trace_file;
 
 #if defined WIN32 && defined DEBUG
     FlagOptionHandler           m_disable_abort_dialogs;
@@ -169,6 +171,7 @@ void CommandLineHandlerBase::add_default_options()
     add_disable_abort_dialogs_option();
 #endif
     add_display_options_option();
+    add_trace_file_option();
 }
 
 void CommandLineHandlerBase::add_help_option()
@@ -243,6 +246,16 @@ void CommandLineHandlerBase::add_display_options_option()
             .set_description("display the recognized command line options"));
 }
 
+void CommandLineHandlerBase::add_trace_file_option()
+{
+    impl->m_parser.add_option_handler(
+        &impl->m_trace_file
+            .add_name("--trace-file")
+            .set_description("record a timeline of render phases and write it to a Chrome trace file")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+}
+
 CommandLineHandlerBase::~CommandLineHandlerBase()
 {
     delete impl;
@@ -278,6 +291,10 @@ void CommandLineHandlerBase::parse(const int argc, char* argv[], SuperLogger& lo
 
     if (impl->m_message_verbosity.is_set())
         logger.set_verbosity_level_from_string(impl->m_message_verbosity.value().c_str(), false);
+
+    // Start recording events as early as possible so that project loading is captured.
+    if (impl->m_trace_file.is_set())
+        EventTracer::instance().set_enabled(true);
 }
 
 void CommandLineHandlerBase::apply(SuperLogger& logger)
@@ -325,6 +342,18 @@ void CommandLineHandlerBase::apply(SuperLogger& logger)
     }
 }
 
+void CommandLineHandlerBase::write_trace_file(SuperLogger& logger) const
+{
+    if (!impl->m_trace_file.is_set())
+        return;
+
+    const char* file_path = impl->m_trace_file.value().c_str();
+
+    if (EventTracer::instance().write_chrome_trace(file_path))
+        LOG_INFO(logger, "wrote trace file %s.", file_path);
+    else LOG_ERROR(logger, "failed to write trace file %s.", file_path);
+}
+
 CommandLineParser& CommandLineHandlerBase::parser()
 {
     return impl->m_parser;
@@ -67,6 +67,7 @@ class SHAREDDLL CommandLineHandlerBase
     void add_message_verbosity_option();
     void add_message_coloring_option();
     void add_display_options_option();
+    void add_trace_file_option();
 #if defined WIN32 && defined DEBUG
     void add_disable_abort_dialogs_option();
 #endif
@@ -81,6 +82,10 @@ class SHAREDDLL CommandLineHandlerBase
     // This method may reconfigure the logger (to enable message coloring, for instance).
     void apply(SuperLogger& logger);
 
+    // Write the timeline recorded by the event tracer if a trace file was requested
+    // on the command line. Call this once rendering is complete.
+    void write_trace_file(SuperLogger& logger) const;
+
   protected:
     // This method must be implemented to emit usage instructions to the logger.
     virtual void print_program_usage(
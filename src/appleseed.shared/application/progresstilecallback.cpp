@@ -78,6 +78,11 @@ namespace
             // Prevent this instance from being destroyed by doing nothing here.
         }
 
+        bool accesses_tiles_synchronously() const override
+        {
+            return true;
+        }
+
         void on_tiled_frame_begin(const Frame* frame) override
         {
             // Do not restart the stopwatch if it is already running.
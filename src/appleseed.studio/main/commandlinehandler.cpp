@@ -61,6 +61,8 @@ CommandLineHandler::CommandLineHandler()
             .add_name("--render")
             .set_description("start rendering using the specified configuration")
             .set_exact_value_count(1));
+
+    add_trace_file_option();
 }
 
 void CommandLineHandler::parse(
@@ -78,6 +80,12 @@ void CommandLineHandler::parse(
     CommandLineHandlerBase::parse(argc, argv, logger);
 }
 
+void CommandLineHandler::write_trace_file() const
+{
+    SuperLogger logger;
+    CommandLineHandlerBase::write_trace_file(logger);
+}
+
 void CommandLineHandler::print_program_usage(
     const char*     executable_name,
     SuperLogger&    logger) const
@@ -63,6 +63,9 @@ class CommandLineHandler
         const int               argc,
         char*                   argv[]);
 
+    // Write the recorded timeline if a trace file was requested.
+    void write_trace_file() const;
+
   private:
     // Emit usage instructions to the logger.
     void print_program_usage(
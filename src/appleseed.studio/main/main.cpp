@@ -393,5 +393,10 @@ int main(int argc, char* argv[])
 
     window.show();
 
-    return application.exec();
+    const int result = application.exec();
+
+    // Write the recorded timeline, if requested.
+    cl.write_trace_file();
+
+    return result;
 }
@@ -112,7 +112,7 @@ namespace
 void MaterialDropHandler::assign_material(const renderer::ObjectInstance::Side side)
 {
     const renderer::ScenePicker scene_picker(m_project);
-    const renderer::ScenePicker::PickingResult result = scene_picker.pick(m_drop_pos);
+    const renderer::ScenePicker::PickingResult result = scene_picker.pick_entities(m_drop_pos);
     renderer::ObjectInstance* instance = result.m_object_instance;
 
     std::vector<MaterialSlot> material_slots;
@@ -33,10 +33,6 @@
 // appleseed.studio headers.
 #include "mainwindow/rendering/renderwidget.h"
 
-// Qt headers.
-#include <QObject>
-#include <Qt>
-
 // Standard headers.
 #include <cassert>
 #include <cstddef>
@@ -52,20 +48,18 @@ namespace studio {
 
 namespace
 {
+    //
+    // The render widget takes care of scheduling repaints of the regions that
+    // were updated, so this callback never posts events to the GUI thread itself.
+    //
+
     class QtTileCallback
-      : public QObject
-      , public TileCallbackBase
+      : public TileCallbackBase
     {
-        Q_OBJECT
-
       public:
         explicit QtTileCallback(RenderWidget* render_widget)
           : m_render_widget(render_widget)
         {
-            connect(
-                this, SIGNAL(signal_update()),
-                m_render_widget, SLOT(update()),
-                Qt::QueuedConnection);
         }
 
         void release() override
@@ -80,7 +74,6 @@ namespace
         {
             assert(m_render_widget);
             m_render_widget->highlight_tile(*frame, tile_x, tile_y);
-            emit signal_update();
         }
 
         void on_tile_end(
@@ -90,7 +83,6 @@ namespace
         {
             assert(m_render_widget);
             m_render_widget->blit_tile(*frame, tile_x, tile_y);
-            emit signal_update();
         }
 
         void on_progressive_frame_update(
@@ -98,12 +90,8 @@ namespace
         {
             assert(m_render_widget);
             m_render_widget->blit_frame(*frame);
-            emit signal_update();
         }
 
-      signals:
-        void signal_update();
-
       private:
         RenderWidget* m_render_widget;
     };
@@ -131,5 +119,3 @@ ITileCallback* QtTileCallbackFactory::create()
 
 }   // namespace studio
 }   // namespace appleseed
-
-#include "mainwindow/rendering/moc_cpp_qttilecallback.cxx"
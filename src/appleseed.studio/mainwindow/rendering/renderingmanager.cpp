@@ -202,7 +202,7 @@ void RenderingManager::start_rendering(
     m_render_tab->get_render_widget()->start_render();
 
     TileCallbackCollectionFactory* tile_callback_collection_factory = 
-        new TileCallbackCollectionFactory();
+        new TileCallbackCollectionFactory(true);
 
     tile_callback_collection_factory->insert(
         new QtTileCallbackFactory(
@@ -48,11 +48,14 @@
 #include <QDropEvent>
 #include <QMimeData>
 #include <QMutexLocker>
+#include <QPaintEvent>
 #include <Qt>
+#include <QTimer>
 
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <memory>
 
 using namespace foundation;
 using namespace renderer;
@@ -72,8 +75,16 @@ RenderWidget::RenderWidget(
     QWidget*                parent)
   : QWidget(parent)
   , m_mutex(QMutex::Recursive)
+  , m_refresh_pending(false)
   , m_ocio_config(ocio_config)
 {
+    connect(
+        this, SIGNAL(signal_refresh_requested()),
+        this, SLOT(slot_schedule_refresh()),
+        Qt::QueuedConnection);
+
+    m_last_refresh.start();
+
     setFocusPolicy(Qt::StrongFocus);
     setAutoFillBackground(false);
     setAttribute(Qt::WA_OpaquePaintEvent, true);
@@ -241,6 +252,48 @@ void RenderWidget::highlight_tile(
         BracketExtent,
         BracketColor,
         sizeof(BracketColor));
+
+    invalidate_no_lock(
+        QRect(
+            static_cast<int>(x),
+            static_cast<int>(y),
+            static_cast<int>(width),
+            static_cast<int>(height)));
+}
+
+namespace
+{
+    // Apply a display transform to a tile and convert it to 8-bit RGB.
+    unique_ptr<Tile> make_display_tile(
+        const Tile&             src_tile,
+        const OCIO::Processor&  ocio_processor,
+        uint8*                  float_tile_storage = nullptr,
+        uint8*                  uint8_tile_storage = nullptr)
+    {
+        // Copy the tile.
+        Tile float_tile(
+            src_tile,
+            PixelFormatFloat,
+            float_tile_storage);
+
+        // Apply OCIO transform.
+        OCIO::PackedImageDesc image_desc(
+            reinterpret_cast<float*>(float_tile.get_storage()),
+            static_cast<long>(float_tile.get_width()),
+            static_cast<long>(float_tile.get_height()),
+            static_cast<long>(float_tile.get_channel_count()));
+        ocio_processor.apply(image_desc);
+
+        // Convert the tile to 8-bit RGB for display.
+        static const size_t shuffle_table[4] = { 0, 1, 2, Pixel::SkipChannel };
+        return
+            unique_ptr<Tile>(
+                new Tile(
+                    float_tile,
+                    PixelFormatUInt8,
+                    shuffle_table,
+                    uint8_tile_storage));
+    }
 }
 
 void RenderWidget::blit_tile(
@@ -248,12 +301,28 @@ void RenderWidget::blit_tile(
     const size_t    tile_x,
     const size_t    tile_y)
 {
-    QMutexLocker locker(&m_mutex);
+    OCIO::ConstProcessorRcPtr ocio_processor;
 
-    allocate_working_storage(frame.image().properties());
+    {
+        QMutexLocker locker(&m_mutex);
+
+        allocate_working_storage(frame.image().properties());
+
+        blit_tile_no_lock(frame, tile_x, tile_y);
+        ocio_processor = m_ocio_processor;
+    }
+
+    // Apply the display transform without holding the lock, so that concurrent
+    // render threads only serialize on copying final pixels to the display image.
+    const unique_ptr<Tile> uint8_rgb_tile(
+        make_display_tile(frame.image().tile(tile_x, tile_y), *ocio_processor));
 
-    blit_tile_no_lock(frame, tile_x, tile_y);
-    update_tile_no_lock(tile_x, tile_y);
+    QMutexLocker locker(&m_mutex);
+
+    // The display transform may have changed in the meantime.
+    if (m_ocio_processor == ocio_processor)
+        draw_tile_no_lock(tile_x, tile_y, *uint8_rgb_tile);
+    else update_tile_no_lock(tile_x, tile_y);
 }
 
 void RenderWidget::blit_frame(const Frame& frame)
@@ -301,6 +370,34 @@ void RenderWidget::slot_display_transform_changed(const QString& transform)
     update();
 }
 
+void RenderWidget::slot_schedule_refresh()
+{
+    const qint64 MinRefreshInterval = 1000 / MaxRefreshRate;    // in milliseconds
+    const qint64 elapsed = m_last_refresh.elapsed();
+
+    QTimer::singleShot(
+        elapsed < MinRefreshInterval ? static_cast<int>(MinRefreshInterval - elapsed) : 0,
+        this,
+        SLOT(slot_refresh()));
+}
+
+void RenderWidget::slot_refresh()
+{
+    QRect dirty_rect;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        dirty_rect = m_dirty_rect;
+        m_dirty_rect = QRect();
+        m_refresh_pending = false;
+    }
+
+    m_last_refresh.restart();
+
+    update(dirty_rect);
+}
+
 namespace
 {
     bool is_compatible(const Tile& tile, const CanvasProperties& props)
@@ -371,31 +468,21 @@ void RenderWidget::blit_tile_no_lock(
 
 void RenderWidget::update_tile_no_lock(const size_t tile_x, const size_t tile_y)
 {
-    // Retrieve the source tile.
-    const Tile& src_tile = m_image_storage->tile(tile_x, tile_y);
-
-    // Copy the tile.
-    Tile float_tile(
-        src_tile,
-        PixelFormatFloat,
-        m_float_tile_storage->get_storage());
-
-    // Apply OCIO transform.
-    OCIO::PackedImageDesc image_desc(
-        reinterpret_cast<float*>(float_tile.get_storage()),
-        static_cast<long>(float_tile.get_width()),
-        static_cast<long>(float_tile.get_height()),
-        static_cast<long>(float_tile.get_channel_count()));
-    m_ocio_processor->apply(image_desc);
-
-    // Convert the tile to 8-bit RGB for display.
-    static const size_t shuffle_table[4] = { 0, 1, 2, Pixel::SkipChannel };
-    Tile uint8_rgb_tile(
-        float_tile,
-        PixelFormatUInt8,
-        shuffle_table,
-        m_uint8_tile_storage->get_storage());
+    const unique_ptr<Tile> uint8_rgb_tile(
+        make_display_tile(
+            m_image_storage->tile(tile_x, tile_y),
+            *m_ocio_processor,
+            m_float_tile_storage->get_storage(),
+            m_uint8_tile_storage->get_storage()));
+
+    draw_tile_no_lock(tile_x, tile_y, *uint8_rgb_tile);
+}
 
+void RenderWidget::draw_tile_no_lock(
+    const size_t    tile_x,
+    const size_t    tile_y,
+    const Tile&     uint8_rgb_tile)
+{
     // Retrieve destination image information.
     APPLESEED_UNUSED const size_t image_width = static_cast<size_t>(m_image.width());
     APPLESEED_UNUSED const size_t image_height = static_cast<size_t>(m_image.height());
@@ -409,22 +496,41 @@ void RenderWidget::update_tile_no_lock(const size_t tile_x, const size_t tile_y)
     // Clipping is not supported.
     assert(x < image_width);
     assert(y < image_height);
-    assert(x + src_tile.get_width() <= image_width);
-    assert(y + src_tile.get_height() <= image_height);
+    assert(x + uint8_rgb_tile.get_width() <= image_width);
+    assert(y + uint8_rgb_tile.get_height() <= image_height);
 
     // Get a pointer to the first destination pixel.
     uint8* dest = get_image_pointer(m_image, x, y);
 
     // Blit the tile to the destination image.
     NativeDrawing::blit(dest, dest_stride, uint8_rgb_tile);
+
+    invalidate_no_lock(
+        QRect(
+            static_cast<int>(x),
+            static_cast<int>(y),
+            static_cast<int>(uint8_rgb_tile.get_width()),
+            static_cast<int>(uint8_rgb_tile.get_height())));
+}
+
+void RenderWidget::invalidate_no_lock(const QRect& rect)
+{
+    m_dirty_rect |= rect;
+
+    if (!m_refresh_pending)
+    {
+        m_refresh_pending = true;
+        emit signal_refresh_requested();
+    }
 }
 
 void RenderWidget::paintEvent(QPaintEvent* event)
 {
     QMutexLocker locker(&m_mutex);
 
+    // Only repaint the invalidated region; the widget and the image have the same size.
     m_painter.begin(this);
-    m_painter.drawImage(rect(), m_image);
+    m_painter.drawImage(event->rect(), m_image, event->rect());
     m_painter.end();
 }
 
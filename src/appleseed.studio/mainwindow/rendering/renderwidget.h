@@ -42,9 +42,11 @@
 namespace OCIO = OCIO_NAMESPACE;
 
 // Qt headers.
+#include <QElapsedTimer>
 #include <QImage>
 #include <QMutex>
 #include <QPainter>
+#include <QRect>
 #include <QWidget>
 
 // Standard headers.
@@ -66,6 +68,10 @@ namespace studio {
 //
 // A render widget based on QImage.
 //
+// Render threads tone map tiles and write them directly into the display image.
+// Updated regions are accumulated and repainted from the GUI thread at most
+// MaxRefreshRate times per second.
+//
 
 class RenderWidget
   : public QWidget
@@ -117,18 +123,30 @@ class RenderWidget
     QMutex& mutex();
     QImage& image();
 
+    // Maximum number of repaints per second triggered by image updates.
+    static const int MaxRefreshRate = 30;
+
   signals:
     void signal_material_dropped(
         const foundation::Vector2d& drop_pos,
         const QString&          material_name);
 
+    void signal_refresh_requested();
+
   public slots:
     void slot_display_transform_changed(const QString& transform);
 
+  private slots:
+    void slot_schedule_refresh();
+    void slot_refresh();
+
   private:
     mutable QMutex                      m_mutex;
     QImage                              m_image;
     QPainter                            m_painter;
+    QRect                               m_dirty_rect;           // protected by m_mutex
+    bool                                m_refresh_pending;      // protected by m_mutex
+    QElapsedTimer                       m_last_refresh;         // only accessed from the GUI thread
     std::unique_ptr<foundation::Tile>   m_float_tile_storage;
     std::unique_ptr<foundation::Tile>   m_uint8_tile_storage;
     std::unique_ptr<foundation::Image>  m_image_storage;
@@ -147,6 +165,14 @@ class RenderWidget
         const size_t            tile_x,
         const size_t            tile_y);
 
+    void draw_tile_no_lock(
+        const size_t            tile_x,
+        const size_t            tile_y,
+        const foundation::Tile& uint8_rgb_tile);
+
+    // Mark a region of the image as needing a repaint.
+    void invalidate_no_lock(const QRect& rect);
+
     void paintEvent(QPaintEvent* event) override;
     void dragEnterEvent(QDragEnterEvent* event) override;
     void dragMoveEvent(QDragMoveEvent* event) override;
@@ -758,11 +758,16 @@ namespace
 
             create_image_plane_sampling_general_settings(layout);
 
+            create_direct_link("general.bootstrap_passes", "progressive_frame_renderer.bootstrap_passes");
+
             load_general_sampler(config);
+            load_directly_linked_values(config);
         }
 
         void save_config(Configuration& config) const override
         {            
+            save_directly_linked_values(config);
+
             if (get_widget<bool>("general.unlimited_samples"))
                 config.get_parameters().remove_path("progressive_frame_renderer.max_average_spp");
             else set_config(config, "progressive_frame_renderer.max_average_spp", get_widget<int>("general.max_average_spp"));
@@ -784,6 +789,10 @@ namespace
             QCheckBox* unlimited_samples = create_checkbox("general.unlimited_samples", "Unlimited");
             sublayout->addRow("Max Average Samples Per Pixel:", create_horizontal_group(max_average_spp, unlimited_samples));
             connect(unlimited_samples, SIGNAL(toggled(bool)), max_average_spp, SLOT(setDisabled(bool)));
+
+            QSpinBox* bootstrap_passes = create_integer_input("general.bootstrap_passes", 0, 3, 1);
+            bootstrap_passes->setToolTip(m_params_metadata.get_path("progressive_frame_renderer.bootstrap_passes.help"));
+            sublayout->addRow("Bootstrap Passes:", bootstrap_passes);
         }
 
         void load_general_sampler(const Configuration& config)
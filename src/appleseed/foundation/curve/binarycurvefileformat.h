@@ -0,0 +1,79 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+namespace foundation
+{
+
+//
+// On-disk layout of version 3 of the binarycurve file format.
+//
+// Version 3 stores curves uncompressed, in structure-of-arrays form, so that
+// files can be memory-mapped and read without going through a decompressor.
+// Widths and opacities are stored as half-precision floats.
+//
+// The file starts with the usual signature and version number, followed by
+// padding up to the first page boundary. Each curve object then occupies a
+// block that starts on a page boundary and begins with a BinaryCurveBlockHeader.
+// All offsets stored in the header are relative to the start of the block, and
+// all sections start on a page boundary:
+//
+//   curve vertex counts    curve_count         x uint32
+//   vertices               vertex_count        x Vector3f
+//   widths                 vertex_count        x Half
+//   opacities              vertex_count        x Half
+//   colors                 curve_count         x Color3f   (if SharedCurveColors is set)
+//                          vertex_count        x Color3f   (otherwise)
+//
+
+const size_t BinaryCurvePageSize = 4096;
+
+struct BinaryCurveBlockHeader
+{
+    enum Flags
+    {
+        SharedCurveColors = 1UL << 0    // all vertices of a curve share the same color
+    };
+
+    uint64  m_block_size;               // size in bytes of the whole block, a multiple of the page size
+    uint64  m_flags;
+    uint64  m_basis;
+    uint64  m_curve_count;
+    uint64  m_vertex_count;             // sum of the vertex counts of all curves
+    uint64  m_vertex_counts_offset;
+    uint64  m_vertices_offset;
+    uint64  m_widths_offset;
+    uint64  m_opacities_offset;
+    uint64  m_colors_offset;
+};
+
+}   // namespace foundation
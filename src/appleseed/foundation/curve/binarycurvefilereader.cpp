@@ -31,9 +31,12 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/curve/binarycurvefileformat.h"
 #include "foundation/curve/icurvebuilder.h"
 #include "foundation/image/color.h"
+#include "foundation/math/half.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/memorymappedfile.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/bufferedfile.h"
 
@@ -60,11 +63,14 @@ void BinaryCurveFileReader::read(ICurveBuilder& builder)
     BufferedFile file(
         m_filename.c_str(),
         BufferedFile::BinaryType,
-        BufferedFile::ReadMode);
+        BufferedFile::ReadMode,
+        BufferedFile::ReadAheadBufferSize);
 
     if (!file.is_open())
         throw ExceptionIOError();
 
+    file.enable_read_ahead();
+
     read_and_check_signature(file);
 
     uint16 version;
@@ -84,6 +90,12 @@ void BinaryCurveFileReader::read(ICurveBuilder& builder)
         reader.reset(new LZ4CompressedReaderAdapter(file));
         break;
 
+      // Uncompressed, memory-mappable.
+      case 3:
+        file.close();
+        read_mapped_curves(builder);
+        return;
+
       // Unknown format.
       default:
         throw ExceptionIOError("unknown binarycurve format version");
@@ -179,4 +191,97 @@ void BinaryCurveFileReader::read_curve(ReaderAdapter &reader, ICurveBuilder &bui
     }
 }
 
+namespace
+{
+    // Return the address of a section of a mapped curve block, after checking that it fits in the block.
+    template <typename T>
+    const T* get_section(
+        const uint8*                    block,
+        const BinaryCurveBlockHeader&   header,
+        const uint64                    offset,
+        const uint64                    count)
+    {
+        if (offset > header.m_block_size ||
+            count > (header.m_block_size - offset) / sizeof(T))
+            throw ExceptionIOError("invalid binarycurve section");
+
+        return reinterpret_cast<const T*>(block + offset);
+    }
+}
+
+void BinaryCurveFileReader::read_mapped_curves(ICurveBuilder& builder)
+{
+    MemoryMappedFile file;
+
+    if (!file.open(m_filename.c_str()))
+        throw ExceptionIOError();
+
+    const uint8* base = static_cast<const uint8*>(file.data());
+    const uint64 file_size = file.size();
+
+    // The first curve block follows the signature and the version number, on the first page boundary.
+    uint64 block_offset = BinaryCurvePageSize;
+
+    while (block_offset < file_size)
+    {
+        if (file_size - block_offset < sizeof(BinaryCurveBlockHeader))
+            throw ExceptionIOError("truncated binarycurve file");
+
+        const uint8* block = base + block_offset;
+
+        BinaryCurveBlockHeader header;
+        memcpy(&header, block, sizeof(header));
+
+        if (header.m_block_size < sizeof(BinaryCurveBlockHeader) ||
+            header.m_block_size > file_size - block_offset)
+            throw ExceptionIOError("invalid binarycurve block size");
+
+        if (header.m_basis < 1 || header.m_basis > 4)
+            throw ExceptionIOError();
+
+        const bool shared_colors = (header.m_flags & BinaryCurveBlockHeader::SharedCurveColors) != 0;
+
+        const uint32* vertex_counts = get_section<uint32>(block, header, header.m_vertex_counts_offset, header.m_curve_count);
+        const Vector3f* vertices = get_section<Vector3f>(block, header, header.m_vertices_offset, header.m_vertex_count);
+        const Half* widths = get_section<Half>(block, header, header.m_widths_offset, header.m_vertex_count);
+        const Half* opacities = get_section<Half>(block, header, header.m_opacities_offset, header.m_vertex_count);
+        const Color3f* colors =
+            get_section<Color3f>(
+                block,
+                header,
+                header.m_colors_offset,
+                shared_colors ? header.m_curve_count : header.m_vertex_count);
+
+        builder.begin_curve_object(
+            static_cast<CurveBasis>(header.m_basis),
+            static_cast<size_t>(header.m_curve_count));
+
+        uint64 first = 0;
+
+        for (uint64 i = 0; i < header.m_curve_count; ++i)
+        {
+            const size_t count = vertex_counts[i];
+
+            if (count > header.m_vertex_count - first)
+                throw ExceptionIOError("invalid binarycurve vertex count");
+
+            builder.begin_curve();
+            builder.push_vertex_arrays(
+                count,
+                vertices + first,
+                widths + first,
+                opacities + first,
+                shared_colors ? colors + i : colors + first,
+                shared_colors ? 1 : count);
+            builder.end_curve();
+
+            first += count;
+        }
+
+        builder.end_curve_object();
+
+        block_offset += header.m_block_size;
+    }
+}
+
 }   // namespace foundation
@@ -62,6 +62,7 @@ class BinaryCurveFileReader
     static void read_and_check_signature(BufferedFile& file);
     void read_curves(ReaderAdapter& reader, ICurveBuilder& builder);
     void read_curve(ReaderAdapter& reader, ICurveBuilder& builder);
+    void read_mapped_curves(ICurveBuilder& builder);
 };
 
 }   // namespace foundation
@@ -31,7 +31,10 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/curve/binarycurvefileformat.h"
 #include "foundation/curve/icurvewalker.h"
+#include "foundation/image/color.h"
+#include "foundation/math/half.h"
 #include "foundation/math/vector.h"
 
 // Standard headers.
@@ -46,8 +49,25 @@ namespace foundation
 // BinaryCurveFileWriter class implementation.
 //
 
-BinaryCurveFileWriter::BinaryCurveFileWriter(const string& filename)
+namespace
+{
+    // Version of the BinaryCurve file format being written by this code.
+    const uint16 Version = 2;
+
+    // Version written when the MemoryMappable option is set.
+    const uint16 MemoryMappableVersion = 3;
+
+    uint64 align_to_page(const uint64 offset)
+    {
+        return (offset + BinaryCurvePageSize - 1) & ~uint64(BinaryCurvePageSize - 1);
+    }
+}
+
+BinaryCurveFileWriter::BinaryCurveFileWriter(
+    const string&   filename,
+    const int       options)
   : m_filename(filename)
+  , m_options(options)
   , m_writer(m_file, 256 * 1024)
 {
 }
@@ -68,7 +88,9 @@ void BinaryCurveFileWriter::write(const ICurveWalker& walker)
         write_version();
     }
 
-    write_curves(walker);
+    if (m_options & MemoryMappable)
+        write_mapped_curves(walker);
+    else write_curves(walker);
 }
 
 void BinaryCurveFileWriter::write_signature()
@@ -79,8 +101,12 @@ void BinaryCurveFileWriter::write_signature()
 
 void BinaryCurveFileWriter::write_version()
 {
-    const uint16 Version = 2;
-    checked_write(m_file, Version);
+    if (m_options & MemoryMappable)
+    {
+        checked_write(m_file, MemoryMappableVersion);
+        write_padding();
+    }
+    else checked_write(m_file, Version);
 }
 
 void BinaryCurveFileWriter::write_curves(const ICurveWalker& walker)
@@ -126,4 +152,92 @@ void BinaryCurveFileWriter::write_curve(const ICurveWalker& walker, const uint32
     vertex_count += count;
 }
 
+void BinaryCurveFileWriter::write_padding()
+{
+    static const char Zeros[BinaryCurvePageSize] = { 0 };
+
+    const uint64 position = static_cast<uint64>(m_file.tell());
+    const size_t padding = static_cast<size_t>(align_to_page(position) - position);
+
+    if (padding > 0)
+        checked_write(m_file, Zeros, padding);
+}
+
+void BinaryCurveFileWriter::write_mapped_curves(const ICurveWalker& walker)
+{
+    const size_t curve_count = walker.get_curve_count();
+
+    // Find out whether colors can be stored once per curve.
+    size_t vertex_count = 0;
+    bool shared_colors = true;
+    for (size_t i = 0; i < curve_count; ++i)
+    {
+        const size_t count = walker.get_vertex_count(i);
+        if (count == 0)
+            shared_colors = false;
+        for (size_t j = 1; j < count && shared_colors; ++j)
+        {
+            if (walker.get_vertex_color(vertex_count + j) != walker.get_vertex_color(vertex_count))
+                shared_colors = false;
+        }
+        vertex_count += count;
+    }
+
+    const size_t color_count = shared_colors ? curve_count : vertex_count;
+
+    // Lay out the block: every section starts on a page boundary.
+    BinaryCurveBlockHeader header;
+    header.m_flags = shared_colors ? BinaryCurveBlockHeader::SharedCurveColors : 0;
+    header.m_basis = static_cast<uint64>(walker.get_basis());
+    header.m_curve_count = curve_count;
+    header.m_vertex_count = vertex_count;
+
+    uint64 offset = align_to_page(sizeof(BinaryCurveBlockHeader));
+    header.m_vertex_counts_offset = offset;
+    offset = align_to_page(offset + curve_count * sizeof(uint32));
+    header.m_vertices_offset = offset;
+    offset = align_to_page(offset + vertex_count * sizeof(Vector3f));
+    header.m_widths_offset = offset;
+    offset = align_to_page(offset + vertex_count * sizeof(Half));
+    header.m_opacities_offset = offset;
+    offset = align_to_page(offset + vertex_count * sizeof(Half));
+    header.m_colors_offset = offset;
+    header.m_block_size = align_to_page(offset + color_count * sizeof(Color3f));
+
+    checked_write(m_file, header);
+    write_padding();
+
+    for (size_t i = 0; i < curve_count; ++i)
+        checked_write(m_file, static_cast<uint32>(walker.get_vertex_count(i)));
+    write_padding();
+
+    for (size_t i = 0; i < vertex_count; ++i)
+        checked_write(m_file, walker.get_vertex(i));
+    write_padding();
+
+    for (size_t i = 0; i < vertex_count; ++i)
+        checked_write(m_file, Half(walker.get_vertex_width(i)));
+    write_padding();
+
+    for (size_t i = 0; i < vertex_count; ++i)
+        checked_write(m_file, Half(walker.get_vertex_opacity(i)));
+    write_padding();
+
+    if (shared_colors)
+    {
+        size_t first = 0;
+        for (size_t i = 0; i < curve_count; ++i)
+        {
+            checked_write(m_file, walker.get_vertex_color(first));
+            first += walker.get_vertex_count(i);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < vertex_count; ++i)
+            checked_write(m_file, walker.get_vertex_color(i));
+    }
+    write_padding();
+}
+
 }   // namespace foundation
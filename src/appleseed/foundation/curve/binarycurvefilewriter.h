@@ -50,14 +50,23 @@ class BinaryCurveFileWriter
   : public ICurveFileWriter
 {
   public:
+    enum Options
+    {
+        Default                 = 0,            // none of the flags below
+        MemoryMappable          = 1UL << 0      // write uncompressed, page-aligned curves that can be memory-mapped
+    };
+
     // Constructor.
-    explicit BinaryCurveFileWriter(const std::string& filename);
+    explicit BinaryCurveFileWriter(
+        const std::string&  filename,
+        const int           options = Default);
 
     // Write a curve object.
     void write(const ICurveWalker& walker) override;
 
   private:
     const std::string           m_filename;
+    const int                   m_options;
     BufferedFile                m_file;
     LZ4CompressedWriterAdapter  m_writer;
 
@@ -68,6 +77,9 @@ class BinaryCurveFileWriter
     void write_curve_count(const ICurveWalker& walker);
     void write_basis(const ICurveWalker& walker);
     void write_curve(const ICurveWalker& walker, const uint32 curve_id, uint32& vertex_count);
+
+    void write_padding();
+    void write_mapped_curves(const ICurveWalker& walker);
 };
 
 }   // namespace foundation
@@ -46,13 +46,15 @@ namespace bf = boost::filesystem;
 namespace foundation
 {
 
-GenericCurveFileWriter::GenericCurveFileWriter(const char* filename)
+GenericCurveFileWriter::GenericCurveFileWriter(
+    const char*     filename,
+    const int       binarycurve_options)
 {
     const bf::path filepath(filename);
     const string extension = lower_case(filepath.extension().string());
 
     if (extension == ".binarycurve")
-        m_writer = new BinaryCurveFileWriter(filename);
+        m_writer = new BinaryCurveFileWriter(filename, binarycurve_options);
     else throw ExceptionUnsupportedFileFormat(filename);
 }
 
@@ -49,8 +49,11 @@ class APPLESEED_DLLSYMBOL GenericCurveFileWriter
   : public ICurveFileWriter
 {
   public:
-    // Constructor.
-    explicit GenericCurveFileWriter(const char* filename);
+    // Constructor. binarycurve_options is a combination of BinaryCurveFileWriter::Options
+    // flags and is only used when writing a binarycurve file.
+    explicit GenericCurveFileWriter(
+        const char*     filename,
+        const int       binarycurve_options = 0);
 
     // Destructor.
     ~GenericCurveFileWriter() override;
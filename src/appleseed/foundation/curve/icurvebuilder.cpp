@@ -0,0 +1,66 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+// Interface header.
+#include "icurvebuilder.h"
+
+// Standard headers.
+#include <cassert>
+
+namespace foundation
+{
+
+//
+// ICurveBuilder class implementation.
+//
+
+void ICurveBuilder::push_vertex_arrays(
+    const size_t    count,
+    const Vector3f  vertices[],
+    const Half      widths[],
+    const Half      opacities[],
+    const Color3f   colors[],
+    const size_t    color_count)
+{
+    assert(color_count == 1 || color_count == count);
+
+    for (size_t i = 0; i < count; ++i)
+        push_vertex(vertices[i]);
+
+    for (size_t i = 0; i < count; ++i)
+        push_vertex_width(widths[i]);
+
+    for (size_t i = 0; i < count; ++i)
+        push_vertex_opacity(opacities[i]);
+
+    for (size_t i = 0; i < count; ++i)
+        push_vertex_color(colors[color_count == 1 ? 0 : i]);
+}
+
+}   // namespace foundation
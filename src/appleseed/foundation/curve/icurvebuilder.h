@@ -32,6 +32,7 @@
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/curve/curvebasis.h"
 #include "foundation/image/color.h"
+#include "foundation/math/half.h"
 #include "foundation/math/vector.h"
 
 // appleseed.main headers.
@@ -72,6 +73,18 @@ class APPLESEED_DLLSYMBOL ICurveBuilder
     // Append an opacity value to the vertex of a curve.
     virtual void push_vertex_opacity(const float o) = 0;
 
+    // Append arrays of vertices, widths, opacities and colors to the curve. colors holds
+    // either one color per vertex or, if color_count is 1, a color shared by all vertices.
+    // The default implementation calls push_vertex(), push_vertex_width(),
+    // push_vertex_opacity() and push_vertex_color() for each vertex.
+    virtual void push_vertex_arrays(
+        const size_t    count,
+        const Vector3f  vertices[],
+        const Half      widths[],
+        const Half      opacities[],
+        const Color3f   colors[],
+        const size_t    color_count);
+
     // End the definition of a curve.
     virtual void end_curve() = 0;
 
@@ -66,11 +66,14 @@ void MitsHairFileReader::read(ICurveBuilder& builder)
     BufferedFile file(
         m_filename.c_str(),
         BufferedFile::BinaryType,
-        BufferedFile::ReadMode);
+        BufferedFile::ReadMode,
+        BufferedFile::ReadAheadBufferSize);
 
     if (!file.is_open())
         throw ExceptionIOError();
 
+    file.enable_read_ahead();
+
     read_and_check_signature(file);
 
     unique_ptr<ReaderAdapter> reader;
@@ -41,8 +41,9 @@ namespace foundation
 AccumulatorTile::AccumulatorTile(
     const size_t            width,
     const size_t            height,
-    const size_t            channel_count)
-  : Tile(width, height, channel_count + 1, PixelFormatFloat)
+    const size_t            channel_count,
+    uint8*                  storage)
+  : Tile(width, height, channel_count + 1, PixelFormatFloat, storage)
   , m_crop_window(Vector2u(0, 0), Vector2u(width - 1, height - 1))
 {
 }
@@ -51,8 +52,9 @@ AccumulatorTile::AccumulatorTile(
     const size_t            width,
     const size_t            height,
     const size_t            channel_count,
-    const AABB2u&           crop_window)
-  : Tile(width, height, channel_count + 1, PixelFormatFloat)
+    const AABB2u&           crop_window,
+    uint8*                  storage)
+  : Tile(width, height, channel_count + 1, PixelFormatFloat, storage)
   , m_crop_window(crop_window)
 {
 }
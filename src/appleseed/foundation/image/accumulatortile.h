@@ -53,17 +53,20 @@ class AccumulatorTile
     AccumulatorTile(
         const size_t        width,
         const size_t        height,
-        const size_t        channel_count);
+        const size_t        channel_count,
+        uint8*              storage = nullptr); // if provided, use this memory for pixel storage
 
     AccumulatorTile(
         const size_t        width,
         const size_t        height,
         const size_t        channel_count,
-        const AABB2u&       crop_window);
+        const AABB2u&       crop_window,
+        uint8*              storage = nullptr); // if provided, use this memory for pixel storage
 
     // Tile properties.
     size_t get_channel_count() const;   // number of channels in one pixel, excluding the weight channel
     const AABB2u& get_crop_window() const;
+    void set_crop_window(const AABB2u& crop_window);
 
     // Direct access to a given pixel.
     float* pixel(
@@ -125,7 +128,7 @@ class AccumulatorTile
         const float*        values);
 
   protected:
-    const AABB2u m_crop_window;
+    AABB2u m_crop_window;
 };
 
 
@@ -143,6 +146,11 @@ inline const AABB2u& AccumulatorTile::get_crop_window() const
     return m_crop_window;
 }
 
+inline void AccumulatorTile::set_crop_window(const AABB2u& crop_window)
+{
+    m_crop_window = crop_window;
+}
+
 inline float* AccumulatorTile::pixel(
     const size_t            i) const
 {
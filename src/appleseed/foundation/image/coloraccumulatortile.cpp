@@ -0,0 +1,68 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "coloraccumulatortile.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/memory.h"
+
+// Standard headers.
+#include <cstring>
+
+namespace foundation
+{
+
+//
+// ColorAccumulatorTile class implementation.
+//
+
+ColorAccumulatorTile::ColorAccumulatorTile(
+    const size_t            width,
+    const size_t            height)
+  : m_width(width)
+  , m_height(height)
+  , m_pixel_count(width * height)
+  , m_colors(static_cast<float*>(aligned_malloc(m_pixel_count * 4 * sizeof(float), 16)))
+  , m_weights(static_cast<float*>(aligned_malloc(m_pixel_count * sizeof(float), 16)))
+{
+}
+
+ColorAccumulatorTile::~ColorAccumulatorTile()
+{
+    aligned_free(m_weights);
+    aligned_free(m_colors);
+}
+
+void ColorAccumulatorTile::clear()
+{
+    memset(m_colors, 0, m_pixel_count * 4 * sizeof(float));
+    memset(m_weights, 0, m_pixel_count * sizeof(float));
+}
+
+}   // namespace foundation
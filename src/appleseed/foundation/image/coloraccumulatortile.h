@@ -0,0 +1,173 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/color.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/atomic.h"
+#include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// A tile accumulating RGBA colors, each with a weight of 1.
+//
+// Unlike AccumulatorTile which interleaves weights and colors, weights and colors are
+// stored in separate planes. Colors are thus aligned on 16 bytes and are accumulated
+// with a single SIMD addition, and a single 128-bit compare-and-swap when thread safety
+// is required.
+//
+
+class ColorAccumulatorTile
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    ColorAccumulatorTile(
+        const size_t        width,
+        const size_t        height);
+
+    // Destructor.
+    ~ColorAccumulatorTile();
+
+    // Tile properties.
+    size_t get_width() const;
+    size_t get_height() const;
+    size_t get_pixel_count() const;
+
+    // Set all colors to transparent black and all weights to zero.
+    void clear();
+
+    // Add a color to a given pixel.
+    void add(
+        const Vector2u&     pi,
+        const float         values[4]);
+
+    // Thread-safe variant of add().
+    void atomic_add(
+        const Vector2u&     pi,
+        const float         values[4]);
+
+    // Retrieve the average color of a given pixel.
+    void get_pixel(
+        const size_t        i,
+        Color4f&            color) const;
+
+  private:
+    const size_t            m_width;
+    const size_t            m_height;
+    const size_t            m_pixel_count;
+    float*                  m_colors;           // 4 floats per pixel, aligned on 16 bytes
+    float*                  m_weights;          // 1 float per pixel
+};
+
+
+//
+// ColorAccumulatorTile class implementation.
+//
+
+inline size_t ColorAccumulatorTile::get_width() const
+{
+    return m_width;
+}
+
+inline size_t ColorAccumulatorTile::get_height() const
+{
+    return m_height;
+}
+
+inline size_t ColorAccumulatorTile::get_pixel_count() const
+{
+    return m_pixel_count;
+}
+
+inline void ColorAccumulatorTile::add(
+    const Vector2u&         pi,
+    const float             values[4])
+{
+    assert(pi.x < m_width);
+    assert(pi.y < m_height);
+
+    const size_t i = pi.y * m_width + pi.x;
+
+    m_weights[i] += 1.0f;
+
+    float* APPLESEED_RESTRICT ptr = m_colors + 4 * i;
+
+#ifdef APPLESEED_USE_SSE
+    _mm_store_ps(ptr, _mm_add_ps(_mm_load_ps(ptr), _mm_loadu_ps(values)));
+#else
+    for (size_t c = 0; c < 4; ++c)
+        ptr[c] += values[c];
+#endif
+}
+
+inline void ColorAccumulatorTile::atomic_add(
+    const Vector2u&         pi,
+    const float             values[4])
+{
+    assert(pi.x < m_width);
+    assert(pi.y < m_height);
+
+    const size_t i = pi.y * m_width + pi.x;
+
+    foundation::atomic_add4(m_colors + 4 * i, values);
+    foundation::atomic_add(m_weights + i, 1.0f);
+}
+
+inline void ColorAccumulatorTile::get_pixel(
+    const size_t            i,
+    Color4f&                color) const
+{
+    assert(i < m_pixel_count);
+
+    const float weight = m_weights[i];
+    const float rcp_weight = weight == 0.0f ? 0.0f : 1.0f / weight;
+
+    const float* APPLESEED_RESTRICT ptr = m_colors + 4 * i;
+
+#ifdef APPLESEED_USE_SSE
+    _mm_storeu_ps(&color[0], _mm_mul_ps(_mm_load_ps(ptr), _mm_set1_ps(rcp_weight)));
+#else
+    for (size_t c = 0; c < 4; ++c)
+        color[c] = ptr[c] * rcp_weight;
+#endif
+}
+
+}   // namespace foundation
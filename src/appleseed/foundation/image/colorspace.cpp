@@ -1443,6 +1443,152 @@ const RegularSpectrum31f RGBToSpectrumRedIlluminance(RegularSpectrum31f::from_ar
 const RegularSpectrum31f RGBToSpectrumGreenIlluminance(RegularSpectrum31f::from_array(RGBToSpectrumGreenIlluminanceTab));
 const RegularSpectrum31f RGBToSpectrumBlueIlluminance(RegularSpectrum31f::from_array(RGBToSpectrumBlueIlluminanceTab));
 
+// Reflectance basis spectra recombined for each ordering of the RGB components.
+const RegularSpectrum31f RGBToSpectrumReflectanceBases[6][3] =
+{
+    // r <= g <= b
+    {
+        RGBToSpectrumWhiteReflectance - RGBToSpectrumCyanReflectance,
+        RGBToSpectrumCyanReflectance - RGBToSpectrumBlueReflectance,
+        RGBToSpectrumBlueReflectance
+    },
+
+    // r <= b < g
+    {
+        RGBToSpectrumWhiteReflectance - RGBToSpectrumCyanReflectance,
+        RGBToSpectrumGreenReflectance,
+        RGBToSpectrumCyanReflectance - RGBToSpectrumGreenReflectance
+    },
+
+    // g < r <= b
+    {
+        RGBToSpectrumMagentaReflectance - RGBToSpectrumBlueReflectance,
+        RGBToSpectrumWhiteReflectance - RGBToSpectrumMagentaReflectance,
+        RGBToSpectrumBlueReflectance
+    },
+
+    // g <= b < r
+    {
+        RGBToSpectrumRedReflectance,
+        RGBToSpectrumWhiteReflectance - RGBToSpectrumMagentaReflectance,
+        RGBToSpectrumMagentaReflectance - RGBToSpectrumRedReflectance
+    },
+
+    // b < r <= g
+    {
+        RGBToSpectrumYellowReflectance - RGBToSpectrumGreenReflectance,
+        RGBToSpectrumGreenReflectance,
+        RGBToSpectrumWhiteReflectance - RGBToSpectrumYellowReflectance
+    },
+
+    // b < g < r
+    {
+        RGBToSpectrumRedReflectance,
+        RGBToSpectrumYellowReflectance - RGBToSpectrumRedReflectance,
+        RGBToSpectrumWhiteReflectance - RGBToSpectrumYellowReflectance
+    }
+};
+
+
+//
+// Linear RGB <-> sRGB transformations implementation.
+//
+
+void fast_linear_rgb_to_srgb(const float* input, float* output, const size_t count)
+{
+    size_t i = 0;
+
+#ifdef APPLESEED_USE_SSE
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(output + i, fast_linear_rgb_to_srgb(_mm_loadu_ps(input + i)));
+#endif
+
+    for (; i < count; ++i)
+        output[i] = fast_linear_rgb_to_srgb(input[i]);
+}
+
+void fast_srgb_to_linear_rgb(const float* input, float* output, const size_t count)
+{
+    size_t i = 0;
+
+#ifdef APPLESEED_USE_SSE
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(output + i, fast_srgb_to_linear_rgb(_mm_loadu_ps(input + i)));
+#endif
+
+    for (; i < count; ++i)
+        output[i] = fast_srgb_to_linear_rgb(input[i]);
+}
+
+// srgb_to_linear_rgb(i * (1.0f / 255.0f)) for i in [0, 255].
+const float SRGBUInt8ToLinearRGBTable[256] =
+{
+        0.000000000e+00f, 3.035269910e-04f, 6.070539821e-04f, 9.105810313e-04f,
+        1.214107964e-03f, 1.517634955e-03f, 1.821162063e-03f, 2.124689054e-03f,
+        2.428215928e-03f, 2.731743036e-03f, 3.035269910e-03f, 3.346534912e-03f,
+        3.676506924e-03f, 4.024716560e-03f, 4.391441122e-03f, 4.776952323e-03f,
+        5.181516055e-03f, 5.605390761e-03f, 6.048831623e-03f, 6.512089167e-03f,
+        6.995408330e-03f, 7.499029394e-03f, 8.023192175e-03f, 8.568124846e-03f,
+        9.134056978e-03f, 9.721215814e-03f, 1.032982022e-02f, 1.096009091e-02f,
+        1.161224209e-02f, 1.228648424e-02f, 1.298303064e-02f, 1.370208059e-02f,
+        1.444384083e-02f, 1.520851161e-02f, 1.599629037e-02f, 1.680737175e-02f,
+        1.764194854e-02f, 1.850021444e-02f, 1.938235760e-02f, 2.028855868e-02f,
+        2.121900581e-02f, 2.217387967e-02f, 2.315336093e-02f, 2.415762655e-02f,
+        2.518685162e-02f, 2.624121308e-02f, 2.732088789e-02f, 2.842603438e-02f,
+        2.955683693e-02f, 3.071344644e-02f, 3.189603612e-02f, 3.310476616e-02f,
+        3.433980793e-02f, 3.560131416e-02f, 3.688945249e-02f, 3.820437565e-02f,
+        3.954623640e-02f, 4.091519862e-02f, 4.231141135e-02f, 4.373502731e-02f,
+        4.518620297e-02f, 4.666508362e-02f, 4.817182198e-02f, 4.970656335e-02f,
+        5.126945302e-02f, 5.286063999e-02f, 5.448026955e-02f, 5.612849444e-02f,
+        5.780543387e-02f, 5.951124057e-02f, 6.124605611e-02f, 6.301002204e-02f,
+        6.480326504e-02f, 6.662593782e-02f, 6.847816706e-02f, 7.036009431e-02f,
+        7.227184623e-02f, 7.421356440e-02f, 7.618537545e-02f, 7.818741351e-02f,
+        8.021981269e-02f, 8.228269964e-02f, 8.437620103e-02f, 8.650046587e-02f,
+        8.865559101e-02f, 9.084171057e-02f, 9.305896610e-02f, 9.530746192e-02f,
+        9.758734703e-02f, 9.989872575e-02f, 1.022417247e-01f, 1.046164781e-01f,
+        1.070230976e-01f, 1.094617024e-01f, 1.119324192e-01f, 1.144353598e-01f,
+        1.169706732e-01f, 1.195384338e-01f, 1.221387759e-01f, 1.247718409e-01f,
+        1.274376959e-01f, 1.301364899e-01f, 1.328683347e-01f, 1.356333494e-01f,
+        1.384316236e-01f, 1.412633061e-01f, 1.441284865e-01f, 1.470272839e-01f,
+        1.499598026e-01f, 1.529261619e-01f, 1.559264660e-01f, 1.589608341e-01f,
+        1.620293707e-01f, 1.651321948e-01f, 1.682693958e-01f, 1.714411229e-01f,
+        1.746474206e-01f, 1.778884381e-01f, 1.811642647e-01f, 1.844750047e-01f,
+        1.878207922e-01f, 1.912016720e-01f, 1.946178079e-01f, 1.980693489e-01f,
+        2.015562952e-01f, 2.050787657e-01f, 2.086368948e-01f, 2.122307867e-01f,
+        2.158605307e-01f, 2.195262313e-01f, 2.232279778e-01f, 2.269658893e-01f,
+        2.307400703e-01f, 2.345505953e-01f, 2.383975834e-01f, 2.422811389e-01f,
+        2.462013364e-01f, 2.501582801e-01f, 2.541520894e-01f, 2.581828535e-01f,
+        2.622506618e-01f, 2.663556039e-01f, 2.704977989e-01f, 2.746773064e-01f,
+        2.788942456e-01f, 2.831487358e-01f, 2.874408364e-01f, 2.917706370e-01f,
+        2.961382568e-01f, 3.005437851e-01f, 3.049872816e-01f, 3.094688952e-01f,
+        3.139886856e-01f, 3.185467422e-01f, 3.231431842e-01f, 3.277781308e-01f,
+        3.324515820e-01f, 3.371636569e-01f, 3.419144452e-01f, 3.467040956e-01f,
+        3.515326381e-01f, 3.564001620e-01f, 3.613067865e-01f, 3.662526011e-01f,
+        3.712376952e-01f, 3.762621284e-01f, 3.813260198e-01f, 3.864294291e-01f,
+        3.915724754e-01f, 3.967552185e-01f, 4.019777775e-01f, 4.072402120e-01f,
+        4.125426114e-01f, 4.178850651e-01f, 4.232676625e-01f, 4.286904633e-01f,
+        4.341536164e-01f, 4.396571517e-01f, 4.452011585e-01f, 4.507857561e-01f,
+        4.564109743e-01f, 4.620769620e-01f, 4.677837491e-01f, 4.735314548e-01f,
+        4.793201387e-01f, 4.851498902e-01f, 4.910208881e-01f, 4.969330430e-01f,
+        5.028864741e-01f, 5.088813305e-01f, 5.149176717e-01f, 5.209956169e-01f,
+        5.271152258e-01f, 5.332764983e-01f, 5.394796133e-01f, 5.457245708e-01f,
+        5.520114899e-01f, 5.583404899e-01f, 5.647116303e-01f, 5.711249113e-01f,
+        5.775805116e-01f, 5.840784907e-01f, 5.906189084e-01f, 5.972018838e-01f,
+        6.038274169e-01f, 6.104956269e-01f, 6.172066331e-01f, 6.239604354e-01f,
+        6.307572126e-01f, 6.375969648e-01f, 6.444797516e-01f, 6.514056921e-01f,
+        6.583748460e-01f, 6.653873324e-01f, 6.724432111e-01f, 6.795425415e-01f,
+        6.866853237e-01f, 6.938717961e-01f, 7.011018991e-01f, 7.083758116e-01f,
+        7.156936526e-01f, 7.230552435e-01f, 7.304608822e-01f, 7.379105687e-01f,
+        7.454043627e-01f, 7.529423237e-01f, 7.605246305e-01f, 7.681512833e-01f,
+        7.758223414e-01f, 7.835379243e-01f, 7.912980318e-01f, 7.991028428e-01f,
+        8.069523573e-01f, 8.148466945e-01f, 8.227858543e-01f, 8.307699561e-01f,
+        8.387991190e-01f, 8.468732834e-01f, 8.549926877e-01f, 8.631572723e-01f,
+        8.713672161e-01f, 8.796224594e-01f, 8.879230618e-01f, 8.962693810e-01f,
+        9.046611190e-01f, 9.130986929e-01f, 9.215817451e-01f, 9.301108718e-01f,
+        9.386855960e-01f, 9.473065734e-01f, 9.559733868e-01f, 9.646863937e-01f,
+        9.734452963e-01f, 9.822506905e-01f, 9.911020994e-01f, 9.999998808e-01f
+};
+
 
 //
 // Lighting conditions class implementation.
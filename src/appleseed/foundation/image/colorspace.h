@@ -40,6 +40,7 @@
 #ifdef APPLESEED_USE_SSE
 #include "foundation/platform/sse.h"
 #endif
+#include "foundation/platform/types.h"
 #include "foundation/utility/otherwise.h"
 
 // appleseed.main headers.
@@ -153,6 +154,10 @@ extern const RegularSpectrum31f RGBToSpectrumRedIlluminance;
 extern const RegularSpectrum31f RGBToSpectrumGreenIlluminance;
 extern const RegularSpectrum31f RGBToSpectrumBlueIlluminance;
 
+// Reflectance basis spectra recombined for each of the six orderings of the RGB components,
+// such that the converted spectrum is r * bases[0] + g * bases[1] + b * bases[2].
+extern const RegularSpectrum31f RGBToSpectrumReflectanceBases[6][3];
+
 
 //
 // Lighting conditions, defined as a set of color matching functions and an illuminant.
@@ -296,10 +301,21 @@ float fast_linear_rgb_to_srgb(const float c);
 float fast_srgb_to_linear_rgb(const float c);
 #ifdef APPLESEED_USE_SSE
 inline __m128 fast_linear_rgb_to_srgb(const __m128 linear_rgb);
+inline __m128 fast_srgb_to_linear_rgb(const __m128 srgb);
 #endif
 Color3f fast_linear_rgb_to_srgb(const Color3f& linear_rgb);
 Color3f fast_srgb_to_linear_rgb(const Color3f& srgb);
 
+// Convert arrays of color components, four at a time when SSE is available.
+// The results are identical to those of the single component variants above.
+// input and output may point to the same array.
+APPLESEED_DLLSYMBOL void fast_linear_rgb_to_srgb(const float* input, float* output, const size_t count);
+APPLESEED_DLLSYMBOL void fast_srgb_to_linear_rgb(const float* input, float* output, const size_t count);
+
+// Convert an 8-bit color component from the sRGB color space to the linear RGB color space
+// using a lookup table. The result is identical to srgb_to_linear_rgb(c * (1.0f / 255.0f)).
+float srgb_uint8_to_linear_rgb(const uint8 c);
+
 // Variants of the above functions using an even faster approximation of the power function.
 float faster_linear_rgb_to_srgb(const float c);
 float faster_srgb_to_linear_rgb(const float c);
@@ -735,6 +751,37 @@ inline Color3f fast_linear_rgb_to_srgb(const Color3f& linear_rgb)
     return Color3f(transfer[0], transfer[1], transfer[2]);
 }
 
+inline __m128 fast_srgb_to_linear_rgb(const __m128 srgb)
+{
+    // Apply 2.4 gamma correction.
+    const __m128 y =
+        fast_pow(
+            _mm_mul_ps(_mm_add_ps(srgb, _mm_set1_ps(0.055f)), _mm_set1_ps(1.0f / 1.055f)),
+            _mm_set1_ps(2.4f));
+
+    // Compute the linear outcome of the branch.
+    const __m128 a = _mm_mul_ps(_mm_set1_ps(1.0f / 12.92f), srgb);
+
+    // Interleave both outcomes based on the comparison result.
+    const __m128 mask = _mm_cmple_ps(srgb, _mm_set1_ps(0.04045f));
+    return _mm_add_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, y));
+}
+
+inline Color3f fast_srgb_to_linear_rgb(const Color3f& srgb)
+{
+    APPLESEED_SIMD4_ALIGN float transfer[4] =
+    {
+        srgb[0],
+        srgb[1],
+        srgb[2],
+        srgb[2]
+    };
+
+    _mm_store_ps(transfer, fast_srgb_to_linear_rgb(_mm_load_ps(transfer)));
+
+    return Color3f(transfer[0], transfer[1], transfer[2]);
+}
+
 #else
 
 inline Color3f fast_linear_rgb_to_srgb(const Color3f& linear_rgb)
@@ -745,8 +792,6 @@ inline Color3f fast_linear_rgb_to_srgb(const Color3f& linear_rgb)
         fast_linear_rgb_to_srgb(linear_rgb[2]));
 }
 
-#endif  // APPLESEED_USE_SSE
-
 inline Color3f fast_srgb_to_linear_rgb(const Color3f& srgb)
 {
     return Color3f(
@@ -755,6 +800,15 @@ inline Color3f fast_srgb_to_linear_rgb(const Color3f& srgb)
         fast_srgb_to_linear_rgb(srgb[2]));
 }
 
+#endif  // APPLESEED_USE_SSE
+
+APPLESEED_DLLSYMBOL extern const float SRGBUInt8ToLinearRGBTable[256];
+
+inline float srgb_uint8_to_linear_rgb(const uint8 c)
+{
+    return SRGBUInt8ToLinearRGBTable[c];
+}
+
 inline float faster_linear_rgb_to_srgb(const float c)
 {
     return c <= 0.0031308f
@@ -1061,6 +1115,56 @@ namespace impl
     }
 }
 
+
+namespace impl
+{
+    // Return the index of the precomputed bases matching the ordering of the RGB components.
+    // The cases are the same as in linear_rgb_to_spectrum().
+    inline size_t rgb_to_spectrum_bases_index(const Color3f& linear_rgb)
+    {
+        const float r = linear_rgb[0];
+        const float g = linear_rgb[1];
+        const float b = linear_rgb[2];
+
+        if (r <= g && r <= b)
+            return g <= b ? 0 : 1;
+        else if (g <= r && g <= b)
+            return r <= b ? 2 : 3;
+        else return r <= g ? 4 : 5;
+    }
+
+    inline void linear_rgb_to_spectrum(
+        const Color3f&          linear_rgb,
+        const RegularSpectrum31f bases[3],
+        RegularSpectrum31f&     spectrum)
+    {
+#ifdef APPLESEED_USE_SSE
+        const __m128 r = _mm_set1_ps(linear_rgb[0]);
+        const __m128 g = _mm_set1_ps(linear_rgb[1]);
+        const __m128 b = _mm_set1_ps(linear_rgb[2]);
+
+        for (size_t w = 0; w < RegularSpectrum31f::StoredSamples; w += 4)
+        {
+            _mm_store_ps(
+                &spectrum[w],
+                _mm_add_ps(
+                    _mm_add_ps(
+                        _mm_mul_ps(r, _mm_load_ps(&bases[0][w])),
+                        _mm_mul_ps(g, _mm_load_ps(&bases[1][w]))),
+                    _mm_mul_ps(b, _mm_load_ps(&bases[2][w]))));
+        }
+#else
+        for (size_t w = 0; w < RegularSpectrum31f::Samples; ++w)
+        {
+            spectrum[w] =
+                linear_rgb[0] * bases[0][w] +
+                linear_rgb[1] * bases[1][w] +
+                linear_rgb[2] * bases[2][w];
+        }
+#endif
+    }
+}
+
 template <typename T, typename SpectrumType>
 void linear_rgb_reflectance_to_spectrum_unclamped(
     const Color<T, 3>&          linear_rgb,
@@ -1078,6 +1182,17 @@ void linear_rgb_reflectance_to_spectrum_unclamped(
         spectrum);
 }
 
+template <>
+inline void linear_rgb_reflectance_to_spectrum_unclamped(
+    const Color3f&              linear_rgb,
+    RegularSpectrum31f&         spectrum)
+{
+    impl::linear_rgb_to_spectrum(
+        linear_rgb,
+        RGBToSpectrumReflectanceBases[impl::rgb_to_spectrum_bases_index(linear_rgb)],
+        spectrum);
+}
+
 template <typename T, typename SpectrumType>
 inline void linear_rgb_reflectance_to_spectrum(
     const Color<T, 3>&          linear_rgb,
@@ -1116,6 +1231,18 @@ void linear_rgb_illuminance_to_spectrum_unclamped(
         spectrum);
 }
 
+template <>
+inline void linear_rgb_illuminance_to_spectrum_unclamped(
+    const Color3f&              linear_rgb,
+    RegularSpectrum31f&         spectrum)
+{
+    // Like the generic version, use the reflectance basis spectra.
+    impl::linear_rgb_to_spectrum(
+        linear_rgb,
+        RGBToSpectrumReflectanceBases[impl::rgb_to_spectrum_bases_index(linear_rgb)],
+        spectrum);
+}
+
 template <typename T, typename SpectrumType>
 inline void linear_rgb_illuminance_to_spectrum(
     const Color<T, 3>&          linear_rgb,
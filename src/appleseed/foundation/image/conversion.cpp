@@ -34,6 +34,10 @@
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -57,10 +61,86 @@ bool is_linear_image_file_format(const bf::path& path)
         extension == ".hdr";
 }
 
+namespace
+{
+    // Same as the generic paths of the functions below, for RGB tiles in single precision.
+    template <void (*Transfer)(const float*, float*, const size_t)>
+    void convert_rgb_float_tile(Tile& tile)
+    {
+        float* values = reinterpret_cast<float*>(tile.get_storage());
+        const size_t value_count = tile.get_pixel_count() * 3;
+
+        Transfer(values, values, value_count);
+
+        for (size_t i = 0; i < value_count; ++i)
+            values[i] = saturate(values[i]);
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    // Same as the generic paths of the functions below, for RGBA tiles in single precision.
+    template <__m128 (*Transfer)(const __m128)>
+    void convert_rgba_float_tile(Tile& tile)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 alpha_lane = _mm_castsi128_ps(_mm_set_epi32(~0, 0, 0, 0));
+
+        float* pixel = reinterpret_cast<float*>(tile.get_storage());
+
+        for (size_t i = 0, e = tile.get_pixel_count(); i < e; ++i, pixel += 4)
+        {
+            const __m128 color = _mm_loadu_ps(pixel);
+            const __m128 alpha = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3));
+
+            // Unpremultiply, leaving colors with zero alpha untouched.
+            const __m128 has_alpha = _mm_cmpneq_ps(alpha, zero);
+            const __m128 unpremultiplied =
+                _mm_or_ps(
+                    _mm_and_ps(has_alpha, _mm_mul_ps(color, _mm_div_ps(one, alpha))),
+                    _mm_andnot_ps(has_alpha, color));
+
+            // Convert RGB and keep the original alpha, then saturate.
+            const __m128 converted = Transfer(unpremultiplied);
+            const __m128 result =
+                _mm_min_ps(
+                    _mm_max_ps(
+                        _mm_or_ps(_mm_andnot_ps(alpha_lane, converted), _mm_and_ps(alpha_lane, color)),
+                        zero),
+                    one);
+
+            // Premultiply with the saturated alpha.
+            const __m128 saturated_alpha = _mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 3, 3, 3));
+            const __m128 premultiplied =
+                _mm_or_ps(
+                    _mm_andnot_ps(alpha_lane, _mm_mul_ps(result, saturated_alpha)),
+                    _mm_and_ps(alpha_lane, result));
+
+            _mm_storeu_ps(pixel, premultiplied);
+        }
+    }
+
+#endif  // APPLESEED_USE_SSE
+}
+
 void convert_srgb_to_linear_rgb(Tile& tile)
 {
     assert(tile.get_channel_count() == 3 || tile.get_channel_count() == 4);
 
+    if (tile.get_pixel_format() == PixelFormatFloat)
+    {
+        if (tile.get_channel_count() == 3)
+        {
+            convert_rgb_float_tile<fast_srgb_to_linear_rgb>(tile);
+            return;
+        }
+
+#ifdef APPLESEED_USE_SSE
+        convert_rgba_float_tile<fast_srgb_to_linear_rgb>(tile);
+        return;
+#endif
+    }
+
     if (tile.get_channel_count() == 3)
     {
         for (size_t i = 0, e = tile.get_pixel_count(); i < e; ++i)
@@ -102,10 +182,25 @@ void convert_srgb_to_linear_rgb(Image& image)
     }
 }
 
+
 void convert_linear_rgb_to_srgb(Tile& tile)
 {
     assert(tile.get_channel_count() == 3 || tile.get_channel_count() == 4);
 
+    if (tile.get_pixel_format() == PixelFormatFloat)
+    {
+        if (tile.get_channel_count() == 3)
+        {
+            convert_rgb_float_tile<fast_linear_rgb_to_srgb>(tile);
+            return;
+        }
+
+#ifdef APPLESEED_USE_SSE
+        convert_rgba_float_tile<fast_linear_rgb_to_srgb>(tile);
+        return;
+#endif
+    }
+
     if (tile.get_channel_count() == 3)
     {
         for (size_t i = 0, e = tile.get_pixel_count(); i < e; ++i)
@@ -75,6 +75,7 @@ struct GenericProgressiveImageFileReader::Impl
 
     bool                                    m_supports_random_access;
     bool                                    m_is_tiled;
+    int                                     m_mip_level;
     CanvasProperties                        m_props;
 
     void open()
@@ -85,9 +86,22 @@ struct GenericProgressiveImageFileReader::Impl
             throw ExceptionIOError(OIIO::geterror().c_str());
 
         m_supports_random_access = m_input->supports("random_access") != 0;
+        m_mip_level = 0;
         read_spec(m_input->spec());
     }
 
+    bool seek(const int subimage, const int mip_level)
+    {
+        OIIO::ImageSpec spec;
+        if (!m_input->seek_subimage(subimage, mip_level, spec))
+            return false;
+
+        m_mip_level = mip_level;
+        read_spec(spec);
+
+        return true;
+    }
+
     void read_spec(const OIIO::ImageSpec& spec)
     {
         m_is_tiled = spec.tile_width > 0 && spec.tile_height > 0 && spec.tile_depth > 0;
@@ -157,6 +171,7 @@ GenericProgressiveImageFileReader::GenericProgressiveImageFileReader(Logger* log
     impl->m_input = nullptr;
     impl->m_supports_random_access = false;
     impl->m_is_tiled = false;
+    impl->m_mip_level = 0;
 }
 
 GenericProgressiveImageFileReader::~GenericProgressiveImageFileReader()
@@ -244,16 +259,16 @@ void GenericProgressiveImageFileReader::read_image_attributes(
 
 bool GenericProgressiveImageFileReader::choose_subimage(const size_t subimage) const
 {
-    OIIO::ImageSpec spec;
-    const bool success = impl->m_input->seek_subimage(
-        static_cast<int>(subimage),
-        0,
-        spec);
+    return impl->seek(static_cast<int>(subimage), 0);
+}
 
-    if (success)
-        impl->read_spec(spec);
+bool GenericProgressiveImageFileReader::choose_mip_level(const size_t level) const
+{
+    assert(is_open());
 
-    return success;
+    return
+        static_cast<int>(level) == impl->m_mip_level ||
+        impl->seek(impl->m_input->current_subimage(), static_cast<int>(level));
 }
 
 Tile* GenericProgressiveImageFileReader::read_tile(
@@ -368,8 +383,15 @@ void GenericProgressiveImageFileReader::read_tile(
 
         if (!impl->m_supports_random_access)
         {
+            const int subimage = impl->m_input->current_subimage();
+            const int mip_level = impl->m_mip_level;
+
             close();
             impl->open();
+
+            // Reopening the file rewinds it to its first layer and level.
+            if ((subimage != 0 || mip_level != 0) && !impl->seek(subimage, mip_level))
+                throw ExceptionIOError(impl->m_input->geterror().c_str());
         }
 
         if (!impl->m_input->read_image(
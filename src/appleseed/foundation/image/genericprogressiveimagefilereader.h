@@ -82,6 +82,10 @@ class APPLESEED_DLLSYMBOL GenericProgressiveImageFileReader
     // Choose the layer in the image file if available.
     bool choose_subimage(const size_t subimage) const;
 
+    // Choose the mipmap level of the current layer if available.
+    // Canvas properties and tiles are then those of the chosen level.
+    bool choose_mip_level(const size_t level) const;
+
     // Read an image tile. Returns a newly allocated tile.
     Tile* read_tile(
         const size_t        tile_x,
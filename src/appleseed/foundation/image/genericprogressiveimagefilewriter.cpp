@@ -0,0 +1,376 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "genericprogressiveimagefilewriter.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exceptionioerror.h"
+#include "foundation/image/imageattributes.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/string.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/imageio.h"
+#include "OpenImageIO/typedesc.h"
+#include "OpenImageIO/version.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// GenericProgressiveImageFileWriter class implementation.
+//
+
+namespace
+{
+    OIIO::TypeDesc convert_pixel_format(const PixelFormat format)
+    {
+        switch (format)
+        {
+          case PixelFormatUInt8: return OIIO::TypeDesc::UINT8;
+          case PixelFormatUInt16: return OIIO::TypeDesc::UINT16;
+          case PixelFormatUInt32: return OIIO::TypeDesc::UINT32;
+          case PixelFormatHalf: return OIIO::TypeDesc::HALF;
+          case PixelFormatFloat: return OIIO::TypeDesc::FLOAT;
+          case PixelFormatDouble: return OIIO::TypeDesc::DOUBLE;
+          default: return OIIO::TypeDesc::UNKNOWN;
+        }
+    }
+
+    void set_image_attributes(OIIO::ImageSpec& spec, const ImageAttributes& image_attributes)
+    {
+        for (const_each<ImageAttributes> i = image_attributes; i; ++i)
+        {
+            const string attr_name = i->key();
+
+            // Chromaticities are handled below.
+            if (ends_with(attr_name, "_xy_chromaticity"))
+                continue;
+
+            const string attr_value = i->value<string>();
+
+            if (attr_name == "author")
+                spec.attribute("Artist", attr_value);
+            else if (attr_name == "copyright")
+                spec.attribute("Copyright", attr_value);
+            else if (attr_name == "title")
+                spec.attribute("DocumentName", attr_value);
+            else if (attr_name == "description")
+                spec.attribute("ImageDescription", attr_value);
+            else if (attr_name == "date")
+                spec.attribute("DateTime", attr_value);
+            else if (attr_name == "software")
+                spec.attribute("Software", attr_value);
+            else if (attr_name == "computer")
+                spec.attribute("HostComputer", attr_value);
+            else if (attr_name == "color_space")
+                spec.attribute("oiio:ColorSpace", attr_value == "linear" ? "Linear" : attr_value);
+            else if (attr_name == "compression")
+                spec.attribute("compression", attr_value);
+            else spec.attribute(attr_name, attr_value);
+        }
+
+        if (image_attributes.exist("white_xy_chromaticity") &&
+            image_attributes.exist("red_xy_chromaticity") &&
+            image_attributes.exist("green_xy_chromaticity") &&
+            image_attributes.exist("blue_xy_chromaticity"))
+        {
+            const Vector2f red = image_attributes.get<Vector2f>("red_xy_chromaticity");
+            const Vector2f green = image_attributes.get<Vector2f>("green_xy_chromaticity");
+            const Vector2f blue = image_attributes.get<Vector2f>("blue_xy_chromaticity");
+            const Vector2f white = image_attributes.get<Vector2f>("white_xy_chromaticity");
+
+            const float chromaticities[8] =
+            {
+                red[0], red[1],
+                green[0], green[1],
+                blue[0], blue[1],
+                white[0], white[1]
+            };
+
+            OIIO::TypeDesc type;
+            type.basetype = OIIO::TypeDesc::BASETYPE::FLOAT;
+            type.aggregate = OIIO::TypeDesc::AGGREGATE::SCALAR;
+            type.arraylen = 8;
+
+            spec.attribute("chromaticities", type, chromaticities);
+        }
+    }
+}
+
+struct GenericProgressiveImageFileWriter::Impl
+{
+    string                                  m_filename;
+
+#if OIIO_VERSION >= 20000
+    unique_ptr<OIIO::ImageOutput>           m_writer;
+#else
+    OIIO::ImageOutput*                      m_writer;
+#endif
+
+    OIIO::ImageSpec                         m_spec;
+    vector<size_t>                          m_group_channel_counts;
+    size_t                                  m_tile_count_x;
+    size_t                                  m_tile_count_y;
+    bool                                    m_is_open;
+
+    // Protects the image output and the list of written tiles.
+    boost::mutex                            m_mutex;
+    vector<bool>                            m_written_tiles;
+
+    // Write a tile of the image from a buffer of m_spec.tile_width x m_spec.tile_height
+    // pixels in floating-point format. The mutex must be held.
+    void write_tile_buffer(
+        const size_t    tile_x,
+        const size_t    tile_y,
+        const float*    buffer)
+    {
+        if (!m_writer->write_tile(
+                static_cast<int>(tile_x * m_spec.tile_width),
+                static_cast<int>(tile_y * m_spec.tile_height),
+                0,
+                OIIO::TypeDesc::FLOAT,
+                buffer))
+        {
+            const string msg = m_writer->geterror();
+            throw ExceptionIOError(msg.c_str());
+        }
+
+        m_written_tiles[tile_y * m_tile_count_x + tile_x] = true;
+    }
+};
+
+GenericProgressiveImageFileWriter::GenericProgressiveImageFileWriter(const char* filename)
+  : impl(new Impl())
+{
+    assert(filename);
+
+    impl->m_filename = filename;
+    impl->m_writer = OIIO::ImageOutput::create(impl->m_filename);
+    impl->m_tile_count_x = 0;
+    impl->m_tile_count_y = 0;
+    impl->m_is_open = false;
+
+    if (impl->m_writer == nullptr)
+    {
+        const string msg = OIIO::geterror();
+        delete impl;
+        throw ExceptionIOError(msg.c_str());
+    }
+}
+
+GenericProgressiveImageFileWriter::~GenericProgressiveImageFileWriter()
+{
+    if (impl->m_is_open)
+        impl->m_writer->close();
+
+#if OIIO_VERSION < 20000
+    OIIO::ImageOutput::destroy(impl->m_writer);
+#endif
+
+    delete impl;
+}
+
+void GenericProgressiveImageFileWriter::add_channels(
+    const size_t            channel_count,
+    const char**            channel_names,
+    const PixelFormat       output_pixel_format)
+{
+    assert(!impl->m_is_open);
+    assert(channel_count > 0);
+    assert(channel_names);
+
+    const OIIO::TypeDesc format = convert_pixel_format(output_pixel_format);
+
+    for (size_t i = 0; i < channel_count; ++i)
+    {
+        if (strcmp(channel_names[i], "A") == 0)
+            impl->m_spec.alpha_channel = static_cast<int>(impl->m_spec.channelnames.size());
+
+        impl->m_spec.channelnames.push_back(channel_names[i]);
+        impl->m_spec.channelformats.push_back(format);
+    }
+
+    impl->m_group_channel_counts.push_back(channel_count);
+}
+
+size_t GenericProgressiveImageFileWriter::get_channel_group_count() const
+{
+    return impl->m_group_channel_counts.size();
+}
+
+void GenericProgressiveImageFileWriter::open(
+    const size_t            canvas_width,
+    const size_t            canvas_height,
+    const size_t            tile_width,
+    const size_t            tile_height,
+    const ImageAttributes&  image_attributes)
+{
+    assert(!impl->m_is_open);
+    assert(!impl->m_group_channel_counts.empty());
+
+    if (!impl->m_writer->supports("tiles") || !impl->m_writer->supports("random_access"))
+        throw ExceptionIOError("file format is unable to write tiles in arbitrary order");
+
+    OIIO::ImageSpec& spec = impl->m_spec;
+
+    spec.width = spec.full_width = static_cast<int>(canvas_width);
+    spec.height = spec.full_height = static_cast<int>(canvas_height);
+    spec.x = spec.full_x = 0;
+    spec.y = spec.full_y = 0;
+    spec.tile_width = static_cast<int>(tile_width);
+    spec.tile_height = static_cast<int>(tile_height);
+    spec.nchannels = static_cast<int>(spec.channelnames.size());
+
+    // The widest channel format is the format of the image.
+    OIIO::TypeDesc format = spec.channelformats.front();
+    for (const OIIO::TypeDesc& channel_format : spec.channelformats)
+    {
+        if (channel_format.size() > format.size())
+            format = channel_format;
+    }
+    spec.format = format;
+
+    // Tiles are written as they become available.
+    spec.attribute("openexr:lineOrder", "randomY");
+
+    set_image_attributes(spec, image_attributes);
+
+    if (!impl->m_writer->open(impl->m_filename, spec))
+    {
+        const string msg = impl->m_writer->geterror();
+        throw ExceptionIOError(msg.c_str());
+    }
+
+    impl->m_tile_count_x = (canvas_width + tile_width - 1) / tile_width;
+    impl->m_tile_count_y = (canvas_height + tile_height - 1) / tile_height;
+    impl->m_written_tiles.assign(impl->m_tile_count_x * impl->m_tile_count_y, false);
+    impl->m_is_open = true;
+}
+
+bool GenericProgressiveImageFileWriter::is_open() const
+{
+    return impl->m_is_open;
+}
+
+void GenericProgressiveImageFileWriter::write_tile(
+    const size_t            tile_x,
+    const size_t            tile_y,
+    const Tile* const*      tiles)
+{
+    assert(impl->m_is_open);
+    assert(tile_x < impl->m_tile_count_x);
+    assert(tile_y < impl->m_tile_count_y);
+    assert(tiles);
+
+    const size_t tile_width = static_cast<size_t>(impl->m_spec.tile_width);
+    const size_t tile_height = static_cast<size_t>(impl->m_spec.tile_height);
+    const size_t channel_count = impl->m_spec.channelnames.size();
+
+    // Interleave the channels of all tiles into a buffer of the full tile size.
+    vector<float> buffer(tile_width * tile_height * channel_count, 0.0f);
+
+    size_t first_channel = 0;
+
+    for (size_t g = 0, e = impl->m_group_channel_counts.size(); g < e; ++g)
+    {
+        const Tile& tile = *tiles[g];
+        const size_t group_channel_count = impl->m_group_channel_counts[g];
+        assert(tile.get_width() <= tile_width);
+        assert(tile.get_height() <= tile_height);
+        assert(tile.get_channel_count() >= group_channel_count);
+
+        for (size_t y = 0, h = tile.get_height(); y < h; ++y)
+        {
+            for (size_t x = 0, w = tile.get_width(); x < w; ++x)
+            {
+                float* dest = &buffer[(y * tile_width + x) * channel_count + first_channel];
+
+                for (size_t c = 0; c < group_channel_count; ++c)
+                    dest[c] = tile.get_component<float>(x, y, c);
+            }
+        }
+
+        first_channel += group_channel_count;
+    }
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->write_tile_buffer(tile_x, tile_y, buffer.data());
+}
+
+void GenericProgressiveImageFileWriter::close()
+{
+    assert(impl->m_is_open);
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    // Tiled images must be complete to be readable.
+    const vector<float> black_tile(
+        static_cast<size_t>(impl->m_spec.tile_width) *
+        static_cast<size_t>(impl->m_spec.tile_height) *
+        impl->m_spec.channelnames.size(),
+        0.0f);
+
+    for (size_t ty = 0; ty < impl->m_tile_count_y; ++ty)
+    {
+        for (size_t tx = 0; tx < impl->m_tile_count_x; ++tx)
+        {
+            if (!impl->m_written_tiles[ty * impl->m_tile_count_x + tx])
+                impl->write_tile_buffer(tx, ty, black_tile.data());
+        }
+    }
+
+    impl->m_is_open = false;
+
+    if (!impl->m_writer->close())
+    {
+        const string msg = impl->m_writer->geterror();
+        throw ExceptionIOError(msg.c_str());
+    }
+}
+
+}   // namespace foundation
@@ -0,0 +1,102 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/pixel.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class ImageAttributes; }
+namespace foundation    { class Tile; }
+
+namespace foundation
+{
+
+//
+// A progressive image file writer based on OpenImageIO.
+//
+// The image is written as a single tiled image whose channels are the
+// concatenation of one or more groups of channels. Tiles may be written in
+// any order and from any thread, which allows writing an image while it is
+// being produced without keeping it entirely in memory.
+//
+
+class APPLESEED_DLLSYMBOL GenericProgressiveImageFileWriter
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    explicit GenericProgressiveImageFileWriter(const char* filename);
+
+    // Destructor. Closes the image file if it is still open.
+    ~GenericProgressiveImageFileWriter();
+
+    // Add a group of channels to the image. Must be called before open().
+    void add_channels(
+        const size_t            channel_count,
+        const char**            channel_names,
+        const PixelFormat       output_pixel_format);
+
+    // Return the number of groups of channels.
+    size_t get_channel_group_count() const;
+
+    // Open the image file.
+    void open(
+        const size_t            canvas_width,
+        const size_t            canvas_height,
+        const size_t            tile_width,
+        const size_t            tile_height,
+        const ImageAttributes&  image_attributes);
+
+    // Return true if the image file is currently open.
+    bool is_open() const;
+
+    // Write an image tile. `tiles` must contain one tile per group of channels,
+    // in the order in which the groups were added. Thread-safe.
+    void write_tile(
+        const size_t            tile_x,
+        const size_t            tile_y,
+        const Tile* const*      tiles);
+
+    // Write the tiles that were never written as black tiles, then close the image file.
+    void close();
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}   // namespace foundation
@@ -34,6 +34,9 @@
 #include "foundation/image/tile.h"
 #include "foundation/platform/types.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
 #include <cassert>
 #include <cstring>
@@ -61,6 +64,7 @@ Image::Image(
         tile_height,
         channel_count,
         pixel_format)
+  , m_memory_tag(get_current_memory_tag())
 {
     assert(image_width > 0);
     assert(image_height > 0);
@@ -76,6 +80,7 @@ Image::Image(
 
 Image::Image(const CanvasProperties& props)
   : m_props(props)
+  , m_memory_tag(get_current_memory_tag())
 {
     m_tiles = new Tile*[m_props.m_tile_count];
 
@@ -85,6 +90,7 @@ Image::Image(const CanvasProperties& props)
 
 Image::Image(const Image& rhs)
   : m_props(rhs.m_props)
+  , m_memory_tag(get_current_memory_tag())
 {
     m_tiles = new Tile*[m_props.m_tile_count];
 
@@ -107,6 +113,7 @@ Image::Image(
         tile_height,
         source.properties().m_channel_count,
         pixel_format)
+  , m_memory_tag(get_current_memory_tag())
 {
     assert(tile_width > 0);
     assert(tile_height > 0);
@@ -165,6 +172,7 @@ Image::Image(
         Pixel::get_dest_channel_count(source.properties().m_channel_count, shuffle_table),
         pixel_format
   )
+  , m_memory_tag(get_current_memory_tag())
 {
     m_tiles = new Tile*[m_props.m_tile_count];
 
@@ -204,6 +212,9 @@ Tile& Image::tile(
 
     if (m_tiles[tile_index] == nullptr)
     {
+        // Attribute the tile to the memory tag that was current when the image was created.
+        MemoryTagScope memory_tag_scope(m_memory_tag);
+
         Tile* tile =
             new Tile(
                 m_props.get_tile_width(tile_x),
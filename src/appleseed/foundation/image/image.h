@@ -36,6 +36,7 @@
 #include "foundation/image/pixel.h"
 
 // appleseed.main headers.
+#include "main/allocator.h"
 #include "main/dllsymbol.h"
 
 // Standard headers.
@@ -119,6 +120,7 @@ class APPLESEED_DLLSYMBOL Image
   protected:
     CanvasProperties        m_props;
     Tile**                  m_tiles;
+    MemoryTag               m_memory_tag;       // memory tag of lazily allocated tiles
 };
 
 
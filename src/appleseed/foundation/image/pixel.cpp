@@ -30,6 +30,11 @@
 // Interface header.
 #include "pixel.h"
 
+// appleseed.foundation headers.
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
 namespace foundation
 {
 
@@ -123,4 +128,99 @@ size_t Pixel::get_dest_channel_count(
     return dest_channel_count;
 }
 
+#ifdef APPLESEED_USE_SSE
+
+void Pixel::convert_float_to_uint8(
+    const float*        src_begin,
+    const float*        src_end,
+    uint8*              dest)
+{
+    const size_t count = src_end - src_begin;
+    const float* src = src_begin;
+
+    const __m128 scale = _mm_set1_ps(256.0f);
+    const __m128 min_value = _mm_setzero_ps();
+    const __m128 max_value = _mm_set1_ps(255.0f);
+
+    // Convert 16 values at a time. Clamped values fit in 8 bits, so the saturated packs are exact.
+    for (size_t i = 0, e = count / 16; i < e; ++i, src += 16, dest += 16)
+    {
+        const __m128i i0 = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src +  0), scale), max_value), min_value));
+        const __m128i i1 = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src +  4), scale), max_value), min_value));
+        const __m128i i2 = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src +  8), scale), max_value), min_value));
+        const __m128i i3 = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(_mm_mul_ps(_mm_loadu_ps(src + 12), scale), max_value), min_value));
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dest),
+            _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3)));
+    }
+
+    // Convert the remaining values.
+    for (; src < src_end; ++src, ++dest)
+        *dest = truncate<uint8>(clamp(*src * 256.0f, 0.0f, 255.0f));
+}
+
+void Pixel::convert_float_to_half(
+    const float*        src_begin,
+    const float*        src_end,
+    Half*               dest)
+{
+    const size_t count = src_end - src_begin;
+    const float* src = src_begin;
+
+    // Convert 8 values at a time.
+    for (size_t i = 0, e = count / 8; i < e; ++i, src += 8, dest += 8)
+    {
+#ifdef APPLESEED_USE_F16C
+        const __m128i h0 = _mm_cvtps_ph(_mm_loadu_ps(src + 0), _MM_FROUND_TO_NEAREST_INT);
+        const __m128i h1 = _mm_cvtps_ph(_mm_loadu_ps(src + 4), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_unpacklo_epi64(h0, h1));
+#else
+        // float_to_half() returns halves in the low 16 bits of 32-bit lanes.
+        // Sign-extend them so that the signed saturated pack preserves them.
+        const __m128i h0 = float_to_half(_mm_loadu_ps(src + 0));
+        const __m128i h1 = float_to_half(_mm_loadu_ps(src + 4));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dest),
+            _mm_packs_epi32(
+                _mm_srai_epi32(_mm_slli_epi32(h0, 16), 16),
+                _mm_srai_epi32(_mm_slli_epi32(h1, 16), 16)));
+#endif
+    }
+
+    // Convert the remaining values.
+    for (; src < src_end; ++src, ++dest)
+        *dest = float_to_half(*src);
+}
+
+void Pixel::convert_half_to_float(
+    const Half*         src_begin,
+    const Half*         src_end,
+    float*              dest)
+{
+    const size_t count = src_end - src_begin;
+    const Half* src = src_begin;
+
+    // Convert 8 values at a time.
+    for (size_t i = 0, e = count / 8; i < e; ++i, src += 8, dest += 8)
+    {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+#ifdef APPLESEED_USE_F16C
+        _mm_storeu_ps(dest + 0, _mm_cvtph_ps(h));
+        _mm_storeu_ps(dest + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(h, h)));
+#else
+        // half_to_float() expects halves in the low 16 bits of 32-bit lanes.
+        const __m128i zero = _mm_setzero_si128();
+        _mm_storeu_ps(dest + 0, half_to_float(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(dest + 4, half_to_float(_mm_unpackhi_epi16(h, zero)));
+#endif
+    }
+
+    // Convert the remaining values.
+    for (; src < src_end; ++src, ++dest)
+        *dest = half_to_float(*src);
+}
+
+#endif  // APPLESEED_USE_SSE
+
 }   // namespace foundation
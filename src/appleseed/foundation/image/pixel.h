@@ -162,6 +162,23 @@ class Pixel
         const size_t        src_channels,   // number of source channels
         const size_t*       shuffle_table); // channel shuffling table
 
+  private:
+#ifdef APPLESEED_USE_SSE
+    // SIMD kernels for the most common conversions of contiguous ranges of values.
+    // They produce the same results as the generic loops.
+    APPLESEED_DLLSYMBOL static void convert_float_to_uint8(
+        const float*        src_begin,
+        const float*        src_end,
+        uint8*              dest);
+    APPLESEED_DLLSYMBOL static void convert_float_to_half(
+        const float*        src_begin,
+        const float*        src_end,
+        Half*               dest);
+    APPLESEED_DLLSYMBOL static void convert_half_to_float(
+        const Half*         src_begin,
+        const Half*         src_end,
+        float*              dest);
+#endif
 };
 
 
@@ -504,6 +521,13 @@ inline void Pixel::convert_to_format<Half>(
 
       case PixelFormatFloat:                // lossless half -> float
         {
+#ifdef APPLESEED_USE_SSE
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                convert_half_to_float(src_begin, src_end, reinterpret_cast<float*>(dest));
+                break;
+            }
+#endif
             float* typed_dest = reinterpret_cast<float*>(dest);
             for (const Half* it = src_begin; it < src_end; it += src_stride)
             {
@@ -545,7 +569,13 @@ inline void Pixel::convert_to_format<float>(
     {
       case PixelFormatUInt8:                // lossy float -> uint8
         {
-            // todo: optimize this case using SSE?
+#ifdef APPLESEED_USE_SSE
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                convert_float_to_uint8(src_begin, src_end, reinterpret_cast<uint8*>(dest));
+                break;
+            }
+#endif
             uint8* typed_dest = reinterpret_cast<uint8*>(dest);
             for (const float* it = src_begin; it < src_end; it += src_stride)
             {
@@ -582,6 +612,13 @@ inline void Pixel::convert_to_format<float>(
 
       case PixelFormatHalf:                 // lossy float -> half
         {
+#ifdef APPLESEED_USE_SSE
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                convert_float_to_half(src_begin, src_end, reinterpret_cast<Half*>(dest));
+                break;
+            }
+#endif
             Half* typed_dest = reinterpret_cast<Half*>(dest);
             for (const float* it = src_begin; it < src_end; it += src_stride)
             {
@@ -767,6 +804,16 @@ inline void Pixel::convert_from_format<uint8>(
 
       case PixelFormatFloat:                // lossy float -> uint8
         {
+#ifdef APPLESEED_USE_SSE
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                convert_float_to_uint8(
+                    reinterpret_cast<const float*>(src_begin),
+                    reinterpret_cast<const float*>(src_end),
+                    dest);
+                break;
+            }
+#endif
             const float* it = reinterpret_cast<const float*>(src_begin);
             for (; it < reinterpret_cast<const float*>(src_end); it += src_stride)
             {
@@ -1019,6 +1066,16 @@ inline void Pixel::convert_from_format<float>(
 
       case PixelFormatHalf:                 // lossless half -> float
         {
+#ifdef APPLESEED_USE_SSE
+            if (src_stride == 1 && dest_stride == 1)
+            {
+                convert_half_to_float(
+                    reinterpret_cast<const Half*>(src_begin),
+                    reinterpret_cast<const Half*>(src_end),
+                    dest);
+                break;
+            }
+#endif
             const Half* it = reinterpret_cast<const Half*>(src_begin);
             for (; it < reinterpret_cast<const Half*>(src_end); it += src_stride)
             {
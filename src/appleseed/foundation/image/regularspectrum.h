@@ -88,6 +88,7 @@ class RegularSpectrum
     const ValueType& operator[](const size_t i) const;
 
   private:
+    // Only 16-byte alignment is guaranteed, AVX code paths use unaligned loads and stores.
     APPLESEED_SIMD4_ALIGN ValueType m_samples[StoredSamples];
 };
 
@@ -245,6 +246,14 @@ inline void RegularSpectrum<T, N>::set(const ValueType val)
 template <>
 APPLESEED_FORCE_INLINE void RegularSpectrum<float, 31>::set(const float val)
 {
+#ifdef APPLESEED_USE_AVX
+    const __m256 mval8 = _mm256_set1_ps(val);
+
+    _mm256_storeu_ps(&m_samples[ 0], mval8);
+    _mm256_storeu_ps(&m_samples[ 8], mval8);
+    _mm256_storeu_ps(&m_samples[16], mval8);
+    _mm256_storeu_ps(&m_samples[24], mval8);
+#else
     const __m128 mval = _mm_set1_ps(val);
 
     _mm_store_ps(&m_samples[ 0], mval);
@@ -255,6 +264,7 @@ APPLESEED_FORCE_INLINE void RegularSpectrum<float, 31>::set(const float val)
     _mm_store_ps(&m_samples[20], mval);
     _mm_store_ps(&m_samples[24], mval);
     _mm_store_ps(&m_samples[28], mval);
+#endif
 }
 
 #endif  // APPLESEED_USE_SSE
@@ -466,6 +476,12 @@ inline RegularSpectrum<T, N>& operator+=(RegularSpectrum<T, N>& lhs, const Regul
 template <>
 APPLESEED_FORCE_INLINE RegularSpectrum<float, 31>& operator+=(RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
 {
+#ifdef APPLESEED_USE_AVX
+    _mm256_storeu_ps(&lhs[ 0], _mm256_add_ps(_mm256_loadu_ps(&lhs[ 0]), _mm256_loadu_ps(&rhs[ 0])));
+    _mm256_storeu_ps(&lhs[ 8], _mm256_add_ps(_mm256_loadu_ps(&lhs[ 8]), _mm256_loadu_ps(&rhs[ 8])));
+    _mm256_storeu_ps(&lhs[16], _mm256_add_ps(_mm256_loadu_ps(&lhs[16]), _mm256_loadu_ps(&rhs[16])));
+    _mm256_storeu_ps(&lhs[24], _mm256_add_ps(_mm256_loadu_ps(&lhs[24]), _mm256_loadu_ps(&rhs[24])));
+#else
     _mm_store_ps(&lhs[ 0], _mm_add_ps(_mm_load_ps(&lhs[ 0]), _mm_load_ps(&rhs[ 0])));
     _mm_store_ps(&lhs[ 4], _mm_add_ps(_mm_load_ps(&lhs[ 4]), _mm_load_ps(&rhs[ 4])));
     _mm_store_ps(&lhs[ 8], _mm_add_ps(_mm_load_ps(&lhs[ 8]), _mm_load_ps(&rhs[ 8])));
@@ -474,6 +490,7 @@ APPLESEED_FORCE_INLINE RegularSpectrum<float, 31>& operator+=(RegularSpectrum<fl
     _mm_store_ps(&lhs[20], _mm_add_ps(_mm_load_ps(&lhs[20]), _mm_load_ps(&rhs[20])));
     _mm_store_ps(&lhs[24], _mm_add_ps(_mm_load_ps(&lhs[24]), _mm_load_ps(&rhs[24])));
     _mm_store_ps(&lhs[28], _mm_add_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&rhs[28])));
+#endif
 
     return lhs;
 }
@@ -503,6 +520,14 @@ inline RegularSpectrum<T, N>& operator*=(RegularSpectrum<T, N>& lhs, const T rhs
 template <>
 APPLESEED_FORCE_INLINE RegularSpectrum<float, 31>& operator*=(RegularSpectrum<float, 31>& lhs, const float rhs)
 {
+#ifdef APPLESEED_USE_AVX
+    const __m256 mrhs8 = _mm256_set1_ps(rhs);
+
+    _mm256_storeu_ps(&lhs[ 0], _mm256_mul_ps(_mm256_loadu_ps(&lhs[ 0]), mrhs8));
+    _mm256_storeu_ps(&lhs[ 8], _mm256_mul_ps(_mm256_loadu_ps(&lhs[ 8]), mrhs8));
+    _mm256_storeu_ps(&lhs[16], _mm256_mul_ps(_mm256_loadu_ps(&lhs[16]), mrhs8));
+    _mm256_storeu_ps(&lhs[24], _mm256_mul_ps(_mm256_loadu_ps(&lhs[24]), mrhs8));
+#else
     const __m128 mrhs = _mm_set1_ps(rhs);
 
     _mm_store_ps(&lhs[ 0], _mm_mul_ps(_mm_load_ps(&lhs[ 0]), mrhs));
@@ -513,6 +538,7 @@ APPLESEED_FORCE_INLINE RegularSpectrum<float, 31>& operator*=(RegularSpectrum<fl
     _mm_store_ps(&lhs[20], _mm_mul_ps(_mm_load_ps(&lhs[20]), mrhs));
     _mm_store_ps(&lhs[24], _mm_mul_ps(_mm_load_ps(&lhs[24]), mrhs));
     _mm_store_ps(&lhs[28], _mm_mul_ps(_mm_load_ps(&lhs[28]), mrhs));
+#endif
 
     return lhs;
 }
@@ -533,6 +559,12 @@ inline RegularSpectrum<T, N>& operator*=(RegularSpectrum<T, N>& lhs, const Regul
 template <>
 APPLESEED_FORCE_INLINE RegularSpectrum<float, 31>& operator*=(RegularSpectrum<float, 31>& lhs, const RegularSpectrum<float, 31>& rhs)
 {
+#ifdef APPLESEED_USE_AVX
+    _mm256_storeu_ps(&lhs[ 0], _mm256_mul_ps(_mm256_loadu_ps(&lhs[ 0]), _mm256_loadu_ps(&rhs[ 0])));
+    _mm256_storeu_ps(&lhs[ 8], _mm256_mul_ps(_mm256_loadu_ps(&lhs[ 8]), _mm256_loadu_ps(&rhs[ 8])));
+    _mm256_storeu_ps(&lhs[16], _mm256_mul_ps(_mm256_loadu_ps(&lhs[16]), _mm256_loadu_ps(&rhs[16])));
+    _mm256_storeu_ps(&lhs[24], _mm256_mul_ps(_mm256_loadu_ps(&lhs[24]), _mm256_loadu_ps(&rhs[24])));
+#else
     _mm_store_ps(&lhs[ 0], _mm_mul_ps(_mm_load_ps(&lhs[ 0]), _mm_load_ps(&rhs[ 0])));
     _mm_store_ps(&lhs[ 4], _mm_mul_ps(_mm_load_ps(&lhs[ 4]), _mm_load_ps(&rhs[ 4])));
     _mm_store_ps(&lhs[ 8], _mm_mul_ps(_mm_load_ps(&lhs[ 8]), _mm_load_ps(&rhs[ 8])));
@@ -541,6 +573,7 @@ APPLESEED_FORCE_INLINE RegularSpectrum<float, 31>& operator*=(RegularSpectrum<fl
     _mm_store_ps(&lhs[20], _mm_mul_ps(_mm_load_ps(&lhs[20]), _mm_load_ps(&rhs[20])));
     _mm_store_ps(&lhs[24], _mm_mul_ps(_mm_load_ps(&lhs[24]), _mm_load_ps(&rhs[24])));
     _mm_store_ps(&lhs[28], _mm_mul_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&rhs[28])));
+#endif
 
     return lhs;
 }
@@ -708,6 +741,14 @@ inline T min_value(const RegularSpectrum<T, N>& s)
 template <>
 inline float min_value(const RegularSpectrum<float, 31>& s)
 {
+#ifdef APPLESEED_USE_AVX
+    // Replace the padding sample by a copy of the last sample.
+    const __m256 s24 = _mm256_blend_ps(_mm256_loadu_ps(&s[24]), _mm256_loadu_ps(&s[23]), 0x80);
+    const __m256 m1 = _mm256_min_ps(_mm256_loadu_ps(&s[ 0]), _mm256_loadu_ps(&s[ 8]));
+    const __m256 m2 = _mm256_min_ps(_mm256_loadu_ps(&s[16]), s24);
+    const __m256 m3 = _mm256_min_ps(m1, m2);
+          __m128 m  = _mm_min_ps(_mm256_castps256_ps128(m3), _mm256_extractf128_ps(m3, 1));
+#else
     const __m128 m1 = _mm_min_ps(_mm_load_ps(&s[ 0]), _mm_load_ps(&s[ 4]));
     const __m128 m2 = _mm_min_ps(_mm_load_ps(&s[ 8]), _mm_load_ps(&s[12]));
     const __m128 m3 = _mm_min_ps(_mm_load_ps(&s[16]), _mm_load_ps(&s[20]));
@@ -716,6 +757,7 @@ inline float min_value(const RegularSpectrum<float, 31>& s)
     const __m128 m5 = _mm_min_ps(m1, m2);
     const __m128 m6 = _mm_min_ps(m3, m4);
           __m128 m  = _mm_min_ps(m5, m6);
+#endif
 
     m = _mm_min_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
     m = _mm_min_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
@@ -744,6 +786,14 @@ inline T max_value(const RegularSpectrum<T, N>& s)
 template <>
 inline float max_value(const RegularSpectrum<float, 31>& s)
 {
+#ifdef APPLESEED_USE_AVX
+    // Replace the padding sample by a copy of the last sample.
+    const __m256 s24 = _mm256_blend_ps(_mm256_loadu_ps(&s[24]), _mm256_loadu_ps(&s[23]), 0x80);
+    const __m256 m1 = _mm256_max_ps(_mm256_loadu_ps(&s[ 0]), _mm256_loadu_ps(&s[ 8]));
+    const __m256 m2 = _mm256_max_ps(_mm256_loadu_ps(&s[16]), s24);
+    const __m256 m3 = _mm256_max_ps(m1, m2);
+          __m128 m  = _mm_max_ps(_mm256_castps256_ps128(m3), _mm256_extractf128_ps(m3, 1));
+#else
     const __m128 m1 = _mm_max_ps(_mm_load_ps(&s[ 0]), _mm_load_ps(&s[ 4]));
     const __m128 m2 = _mm_max_ps(_mm_load_ps(&s[ 8]), _mm_load_ps(&s[12]));
     const __m128 m3 = _mm_max_ps(_mm_load_ps(&s[16]), _mm_load_ps(&s[20]));
@@ -752,6 +802,7 @@ inline float max_value(const RegularSpectrum<float, 31>& s)
     const __m128 m5 = _mm_max_ps(m1, m2);
     const __m128 m6 = _mm_max_ps(m3, m4);
           __m128 m  = _mm_max_ps(m5, m6);
+#endif
 
     m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
     m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
@@ -30,6 +30,9 @@
 // Interface header.
 #include "tile.h"
 
+// appleseed.foundation headers.
+#include "foundation/utility/memory.h"
+
 using namespace std;
 
 namespace foundation
@@ -65,7 +68,7 @@ Tile::Tile(
     }
     else
     {
-        m_pixel_array = new uint8[m_array_size];
+        m_pixel_array = static_cast<uint8*>(aligned_malloc(m_array_size, 16));
         m_own_storage = true;
     }
 }
@@ -90,7 +93,7 @@ Tile::Tile(
     }
     else
     {
-        m_pixel_array = new uint8[m_array_size];
+        m_pixel_array = static_cast<uint8*>(aligned_malloc(m_array_size, 16));
         m_own_storage = true;
     }
 
@@ -118,7 +121,7 @@ Tile::Tile(
     }
     else
     {
-        m_pixel_array = new uint8[m_array_size];
+        m_pixel_array = static_cast<uint8*>(aligned_malloc(m_array_size, 16));
         m_own_storage = true;
     }
 
@@ -142,7 +145,7 @@ Tile::Tile(const Tile& rhs)
   , m_channel_size(rhs.m_channel_size)
   , m_pixel_size(rhs.m_pixel_size)
   , m_array_size(rhs.m_array_size)
-  , m_pixel_array(new uint8[rhs.m_array_size])
+  , m_pixel_array(static_cast<uint8*>(aligned_malloc(rhs.m_array_size, 16)))
   , m_own_storage(true)
 {
     memcpy(
@@ -154,7 +157,7 @@ Tile::Tile(const Tile& rhs)
 Tile::~Tile()
 {
     if (m_own_storage)
-        delete[] m_pixel_array;
+        aligned_free(m_pixel_array);
 }
 
 void Tile::release()
@@ -0,0 +1,305 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/fp.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// Alias table for sampling a discrete distribution in constant time.
+//
+// Items are identified by their insertion index. Unlike a CDF, the mapping from
+// uniform samples to items is not monotonic, so stratification of the input
+// samples is not preserved across items.
+//
+// References:
+//
+//   Darts, Dice, and Coins: Sampling from a Discrete Distribution
+//   http://www.keithschwarz.com/darts-dice-coins/
+//
+//   Michael D. Vose, A Linear Algorithm For Generating Random Numbers With a
+//   Given Distribution, IEEE Transactions on Software Engineering, 1991.
+//
+
+template <typename Weight>
+class AliasTable
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    AliasTable();
+
+    // Return true if the table is empty.
+    bool empty() const;
+
+    // Return true if the table has at least one item with a positive weight.
+    bool valid() const;
+
+    // Return the number of items in the table.
+    size_t size() const;
+
+    // Return the sum of the weight of all inserted items.
+    Weight weight() const;
+
+    // Remove all items from the table.
+    void clear();
+
+    // Allocate memory for a given number of items.
+    void reserve(const size_t count);
+
+    // Insert an item with a given non-negative weight.
+    void insert(const Weight weight);
+
+    // Prepare the table for sampling.
+    // This method must be called once and only once before sample() is called.
+    void prepare();
+
+    // Return the probability of the i'th item. Only valid after prepare() was called.
+    Weight get_probability(const size_t i) const;
+
+    // Sample the table and return the index of the chosen item and its probability. x is in [0,1).
+    size_t sample(
+        const Weight        x,
+        Weight&             probability) const;
+
+    // Same as above, but also return a new uniform sample in [0,1) that is independent
+    // of the chosen item, for instance to pick a point within the item.
+    size_t sample(
+        const Weight        x,
+        Weight&             probability,
+        Weight&             remapped_x) const;
+
+  private:
+    struct Entry
+    {
+        Weight              m_probability;          // probability of this item
+        Weight              m_threshold;            // probability of keeping this item rather than its alias
+        uint32              m_alias;
+    };
+
+    std::vector<Entry>      m_entries;
+    Weight                  m_weight_sum;
+};
+
+
+//
+// AliasTable class implementation.
+//
+
+template <typename Weight>
+inline AliasTable<Weight>::AliasTable()
+  : m_weight_sum(0.0)
+{
+}
+
+template <typename Weight>
+inline bool AliasTable<Weight>::empty() const
+{
+    return m_entries.empty();
+}
+
+template <typename Weight>
+inline bool AliasTable<Weight>::valid() const
+{
+    return m_weight_sum > Weight(0.0);
+}
+
+template <typename Weight>
+inline size_t AliasTable<Weight>::size() const
+{
+    return m_entries.size();
+}
+
+template <typename Weight>
+inline Weight AliasTable<Weight>::weight() const
+{
+    return m_weight_sum;
+}
+
+template <typename Weight>
+inline void AliasTable<Weight>::clear()
+{
+    m_entries.clear();
+    m_weight_sum = Weight(0.0);
+}
+
+template <typename Weight>
+inline void AliasTable<Weight>::reserve(const size_t count)
+{
+    m_entries.reserve(count);
+}
+
+template <typename Weight>
+inline void AliasTable<Weight>::insert(const Weight weight)
+{
+    assert(weight >= Weight(0.0));
+
+    Entry entry;
+    entry.m_probability = weight;
+    entry.m_threshold = Weight(0.0);
+    entry.m_alias = 0;
+    m_entries.push_back(entry);
+
+    m_weight_sum += weight;
+}
+
+template <typename Weight>
+void AliasTable<Weight>::prepare()
+{
+    assert(valid());
+    assert(m_entries.size() <= ~uint32(0));
+
+    const size_t item_count = m_entries.size();
+
+    // Normalize weights so that they add up to 1.0.
+    const Weight rcp_weight_sum = Weight(1.0) / m_weight_sum;
+    for (size_t i = 0; i < item_count; ++i)
+        m_entries[i].m_probability *= rcp_weight_sum;
+
+    // Split items into those below and above the average probability.
+    // Scaled probabilities are kept in double precision to limit the drift of the residuals.
+    std::vector<double> scaled(item_count);
+    std::vector<uint32> small, large;
+    uint32 any_large = 0;
+
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        scaled[i] = static_cast<double>(m_entries[i].m_probability) * item_count;
+        if (scaled[i] < 1.0)
+            small.push_back(static_cast<uint32>(i));
+        else
+        {
+            large.push_back(static_cast<uint32>(i));
+            any_large = static_cast<uint32>(i);
+        }
+    }
+
+    // Pair each item below the average with an item above it.
+    while (!small.empty() && !large.empty())
+    {
+        const uint32 s = small.back();
+        small.pop_back();
+
+        const uint32 l = large.back();
+        large.pop_back();
+
+        m_entries[s].m_threshold = static_cast<Weight>(scaled[s]);
+        m_entries[s].m_alias = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+
+        if (scaled[l] < 1.0)
+            small.push_back(l);
+        else large.push_back(l);
+    }
+
+    // Remaining items are at the average probability, up to rounding errors.
+    for (const uint32 l : large)
+    {
+        m_entries[l].m_threshold = Weight(1.0);
+        m_entries[l].m_alias = l;
+    }
+
+    for (const uint32 s : small)
+    {
+        // Never return an item with a zero weight.
+        const bool positive = m_entries[s].m_probability > Weight(0.0);
+        m_entries[s].m_threshold = positive ? Weight(1.0) : Weight(0.0);
+        m_entries[s].m_alias = positive ? s : any_large;
+    }
+}
+
+template <typename Weight>
+inline Weight AliasTable<Weight>::get_probability(const size_t i) const
+{
+    assert(i < m_entries.size());
+    return m_entries[i].m_probability;
+}
+
+template <typename Weight>
+inline size_t AliasTable<Weight>::sample(
+    const Weight            x,
+    Weight&                 probability) const
+{
+    Weight remapped_x;
+    return sample(x, probability, remapped_x);
+}
+
+template <typename Weight>
+inline size_t AliasTable<Weight>::sample(
+    const Weight            x,
+    Weight&                 probability,
+    Weight&                 remapped_x) const
+{
+    assert(!m_entries.empty());
+    assert(x >= Weight(0.0));
+    assert(x < Weight(1.0));
+
+    // Use the integer part of x * n to choose an entry and its fractional part to
+    // choose between the entry and its alias.
+    const size_t item_count = m_entries.size();
+    const double u = static_cast<double>(x) * item_count;
+    const size_t i = std::min(truncate<size_t>(u), item_count - 1);
+    const Weight v = std::min(static_cast<Weight>(u - i), shift(Weight(1.0), -1));
+
+    const Entry& entry = m_entries[i];
+
+    size_t result;
+
+    if (v < entry.m_threshold)
+    {
+        result = i;
+        remapped_x = v / entry.m_threshold;
+    }
+    else
+    {
+        result = entry.m_alias;
+        remapped_x = (v - entry.m_threshold) / (Weight(1.0) - entry.m_threshold);
+    }
+
+    remapped_x = std::min(remapped_x, shift(Weight(1.0), -1));
+    probability = m_entries[result].m_probability;
+
+    assert(probability > Weight(0.0));
+    return result;
+}
+
+}   // namespace foundation
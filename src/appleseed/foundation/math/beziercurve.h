@@ -37,6 +37,9 @@
 #include "foundation/math/ray.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 
 // Standard headers.
 #include <algorithm>
@@ -100,6 +103,9 @@ class BezierCurveBase
     AABBType compute_bbox() const;
     ValueType compute_max_width() const;
 
+    // Multiply the widths of the curve by a given factor.
+    void scale_widths(const ValueType factor);
+
   protected:
     template <typename>
     friend class BezierCurveIntersector;
@@ -111,6 +117,12 @@ class BezierCurveBase
 
     static VectorType transform_point(const MatrixType& xfm, const VectorType& p);
 
+    // Transform all the control points of a curve.
+    static void transform_points(
+        const MatrixType&   xfm,
+        const VectorType    input[N + 1],
+        VectorType          output[N + 1]);
+
     size_t compute_recursion_depth(const ValueType epsilon) const;
 };
 
@@ -350,9 +362,10 @@ BezierCurveBase<T, N>::BezierCurveBase(
     const BezierCurveBase&  curve,
     const MatrixType&       xfm)
 {
+    transform_points(xfm, curve.m_ctrl_pts, m_ctrl_pts);
+
     for (size_t i = 0; i < N + 1; ++i)
     {
-        m_ctrl_pts[i] = transform_point(xfm, curve.m_ctrl_pts[i]);
         m_width[i] = curve.m_width[i];
         m_opacity[i] = curve.m_opacity[i];
         m_color[i] = curve.m_color[i];
@@ -416,6 +429,15 @@ inline T BezierCurveBase<T, N>::compute_max_width() const
     return max_width;
 }
 
+template <typename T, size_t N>
+inline void BezierCurveBase<T, N>::scale_widths(const ValueType factor)
+{
+    assert(factor >= ValueType(0.0));
+
+    for (size_t i = 0; i < N + 1; ++i)
+        m_width[i] *= factor;
+}
+
 template <typename T, size_t N>
 inline typename BezierCurveBase<T, N>::VectorType BezierCurveBase<T, N>::transform_point(const MatrixType& xfm, const VectorType& p)
 {
@@ -428,6 +450,59 @@ inline typename BezierCurveBase<T, N>::VectorType BezierCurveBase<T, N>::transfo
     return VectorType(xpt.x * rcp_w, xpt.y * rcp_w, xpt.z * rcp_w);
 }
 
+template <typename T, size_t N>
+inline void BezierCurveBase<T, N>::transform_points(
+    const MatrixType&   xfm,
+    const VectorType    input[N + 1],
+    VectorType          output[N + 1])
+{
+    for (size_t i = 0; i < N + 1; ++i)
+        output[i] = transform_point(xfm, input[i]);
+}
+
+#ifdef APPLESEED_USE_SSE
+
+// SSE-optimized transform of the four control points of a single precision cubic curve,
+// with one control point per SSE lane. Curves are transformed to ray space before every
+// ray-curve intersection test.
+template <>
+inline void BezierCurveBase<float, 3>::transform_points(
+    const MatrixType&   xfm,
+    const VectorType    input[4],
+    VectorType          output[4])
+{
+    const __m128 x = _mm_set_ps(input[3].x, input[2].x, input[1].x, input[0].x);
+    const __m128 y = _mm_set_ps(input[3].y, input[2].y, input[1].y, input[0].y);
+    const __m128 z = _mm_set_ps(input[3].z, input[2].z, input[1].z, input[0].z);
+
+    M128Fields xpt[4];
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        xpt[i].m128 =
+            _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(xfm[i * 4 + 0]), x),
+                    _mm_mul_ps(_mm_set1_ps(xfm[i * 4 + 1]), y)),
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(xfm[i * 4 + 2]), z),
+                    _mm_set1_ps(xfm[i * 4 + 3])));
+    }
+
+    const __m128 rcp_w = _mm_div_ps(_mm_set1_ps(1.0f), xpt[3].m128);
+
+    for (size_t i = 0; i < 3; ++i)
+        xpt[i].m128 = _mm_mul_ps(xpt[i].m128, rcp_w);
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        assert(xpt[3].f32[i] != 0.0f);
+        output[i] = VectorType(xpt[0].f32[i], xpt[1].f32[i], xpt[2].f32[i]);
+    }
+}
+
+#endif  // APPLESEED_USE_SSE
+
 template <typename T, size_t N>
 size_t BezierCurveBase<T, N>::compute_recursion_depth(const ValueType epsilon) const
 {
@@ -286,8 +286,8 @@ void Intersector<Tree, Visitor, Ray, StackSize, N>::intersect_motion(
     const NodeType* stack[StackSize];
     const NodeType** stack_ptr = stack;
 
-    // Current node.
-    const NodeType* node_ptr = &tree.m_nodes[0];
+    // Current node: the root of the subtree covering the ray time.
+    const NodeType* node_ptr = &tree.m_nodes[tree.get_root_node_index(static_cast<double>(ray_time))];
 
     // Initialize traversal statistics.
     FOUNDATION_BVH_TRAVERSAL_STATS(++stats.m_traversal_count);
@@ -651,8 +651,8 @@ void Intersector<Tree, Visitor, Ray3d, StackSize, 3>::intersect_motion(
     const NodeType* stack[StackSize];
     const NodeType** stack_ptr = stack;
 
-    // Current node.
-    const NodeType* node_ptr = &tree.m_nodes[0];
+    // Current node: the root of the subtree covering the ray time.
+    const NodeType* node_ptr = &tree.m_nodes[tree.get_root_node_index(static_cast<double>(ray_time))];
 
     // Initialize traversal statistics.
     FOUNDATION_BVH_TRAVERSAL_STATS(++stats.m_traversal_count);
@@ -0,0 +1,457 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/bvh/bvh_statistics.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Default number of rays per packet: one lane per ray in a single precision SIMD register.
+//
+
+#ifdef APPLESEED_USE_AVX
+const size_t DefaultRayPacketSize = 8;
+#else
+const size_t DefaultRayPacketSize = 4;
+#endif
+
+
+//
+// Packet of rays stored in structure-of-arrays layout.
+//
+// Packets are meant to hold coherent rays (e.g. primary rays or shadow rays
+// from a single tile) so that they can share node fetches during traversal.
+// Lanes beyond the packet size are never accessed.
+//
+
+template <typename T, size_t N, size_t PacketSize>
+class APPLESEED_ALIGN(64) RayPacket
+{
+  public:
+    typedef T ValueType;
+    typedef Ray<T, N> RayType;
+    typedef RayInfo<T, N> RayInfoType;
+
+    static const size_t Dimension = N;
+    static const size_t MaxSize = PacketSize;
+
+    // Number of rays in the packet.
+    size_t      m_size;
+
+    // Per-dimension, per-ray origins, reciprocal directions and direction signs.
+    ValueType   m_org[N][PacketSize];
+    ValueType   m_rcp_dir[N][PacketSize];
+    uint32      m_sgn_dir[N][PacketSize];
+
+    // Per-ray ray intervals.
+    ValueType   m_tmin[PacketSize];
+    ValueType   m_tmax[PacketSize];
+
+    // Constructor.
+    RayPacket();
+
+    // Append a ray to the packet, return its index in the packet.
+    size_t push_back(const RayType& ray, const RayInfoType& ray_info);
+
+    // Return the mask of all valid rays in the packet.
+    uint32 get_full_mask() const;
+};
+
+
+//
+// BVH packet intersector.
+//
+// Traverses a BVH with a whole packet of rays at once: each node is fetched
+// once per packet rather than once per ray, and the child bounding boxes are
+// intersected with all active rays of the packet in a single, vectorizable
+// loop. Rays that miss a subtree are masked out of that subtree.
+//
+// The Visitor class must conform to the following prototype:
+//
+//      class Visitor
+//        : public foundation::NonCopyable
+//      {
+//        public:
+//          // Return whether BVH traversal should continue or not.
+//          // 'ray_mask' is the set of rays of the packet that reached this leaf.
+//          // 'distances[i]' should be set to the distance to the closest hit so
+//          // far for every ray i in 'ray_mask'. Rays may be removed from 'ray_mask'
+//          // to exclude them from the rest of the traversal (e.g. probe rays that
+//          // found a hit).
+//          bool visit(
+//              const NodeType&             node,
+//              const RayPacketType&        packet,
+//              uint32&                     ray_mask,
+//              ValueType                   distances[]
+//      #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+//              , TraversalStatistics&      stats
+//      #endif
+//              );
+//      };
+//
+
+template <
+    typename Tree,
+    typename Visitor,
+    size_t PacketSize = DefaultRayPacketSize,
+    size_t StackSize = 64
+>
+class PacketIntersector
+  : public NonCopyable
+{
+  public:
+    typedef typename Tree::NodeType NodeType;
+    typedef typename NodeType::AABBType AABBType;
+    typedef typename AABBType::ValueType ValueType;
+    static const size_t Dimension = AABBType::Dimension;
+    typedef RayPacket<ValueType, Dimension, PacketSize> RayPacketType;
+
+    // Intersect a packet of rays with a given BVH without motion.
+    void intersect_no_motion(
+        const Tree&             tree,
+        const RayPacketType&    packet,
+        Visitor&                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , TraversalStatistics&  stats
+#endif
+        ) const;
+
+  private:
+    // Intersect a bounding box with the active rays of a packet.
+    // Return the mask of the rays that hit the bounding box, their entry distances
+    // and the average of these distances, used to order child nodes during traversal.
+    static uint32 intersect_bbox(
+        const RayPacketType&    packet,
+        const AABBType&         bbox,
+        const ValueType         tmax[],
+        const uint32            ray_mask,
+        ValueType               tmin[],
+        ValueType&              tmin_avg);
+};
+
+
+//
+// RayPacket class implementation.
+//
+
+template <typename T, size_t N, size_t PacketSize>
+inline RayPacket<T, N, PacketSize>::RayPacket()
+  : m_size(0)
+{
+}
+
+template <typename T, size_t N, size_t PacketSize>
+inline size_t RayPacket<T, N, PacketSize>::push_back(
+    const RayType&                  ray,
+    const RayInfoType&              ray_info)
+{
+    assert(m_size < PacketSize);
+
+    const size_t index = m_size++;
+
+    for (size_t d = 0; d < N; ++d)
+    {
+        m_org[d][index] = ray.m_org[d];
+        m_rcp_dir[d][index] = ray_info.m_rcp_dir[d];
+        m_sgn_dir[d][index] = ray_info.m_sgn_dir[d];
+    }
+
+    m_tmin[index] = ray.m_tmin;
+    m_tmax[index] = ray.m_tmax;
+
+    return index;
+}
+
+template <typename T, size_t N, size_t PacketSize>
+inline uint32 RayPacket<T, N, PacketSize>::get_full_mask() const
+{
+    return m_size == 32 ? ~uint32(0) : (uint32(1) << m_size) - 1;
+}
+
+
+//
+// PacketIntersector class implementation.
+//
+
+template <
+    typename Tree,
+    typename Visitor,
+    size_t PacketSize,
+    size_t StackSize
+>
+inline uint32 PacketIntersector<Tree, Visitor, PacketSize, StackSize>::intersect_bbox(
+    const RayPacketType&        packet,
+    const AABBType&             bbox,
+    const ValueType             tmax[],
+    const uint32                ray_mask,
+    ValueType                   tmin[],
+    ValueType&                  tmin_avg)
+{
+    // Compute entry and exit distances for all rays of the packet. Inactive
+    // lanes are computed as well since this keeps the loop branchless and
+    // vectorizable; they are masked out below.
+    ValueType* t0 = tmin;
+    ValueType t1[PacketSize];
+
+    for (size_t i = 0; i < PacketSize; ++i)
+    {
+        t0[i] = packet.m_tmin[i];
+        t1[i] = tmax[i];
+    }
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        const ValueType bmin = bbox.min[d];
+        const ValueType bmax = bbox.max[d];
+
+        for (size_t i = 0; i < PacketSize; ++i)
+        {
+            const ValueType rcp_dir = packet.m_rcp_dir[d][i];
+            const ValueType near_plane = packet.m_sgn_dir[d][i] ? bmin : bmax;
+            const ValueType far_plane = packet.m_sgn_dir[d][i] ? bmax : bmin;
+            const ValueType tnear = rcp_dir * (near_plane - packet.m_org[d][i]);
+            const ValueType tfar = rcp_dir * (far_plane - packet.m_org[d][i]);
+
+            // Same NaN behavior as the single ray code: a NaN distance never wins.
+            t0[i] = tnear > t0[i] ? tnear : t0[i];
+            t1[i] = tfar < t1[i] ? tfar : t1[i];
+        }
+    }
+
+    uint32 hit_mask = 0;
+    size_t hit_count = 0;
+    ValueType tmin_sum(0.0);
+
+    for (size_t i = 0; i < PacketSize; ++i)
+    {
+        const uint32 bit = uint32(1) << i;
+
+        if ((ray_mask & bit) && t0[i] <= t1[i] && t0[i] < tmax[i])
+        {
+            hit_mask |= bit;
+            tmin_sum += t0[i];
+            ++hit_count;
+        }
+    }
+
+    tmin_avg = hit_count > 0 ? tmin_sum / static_cast<ValueType>(hit_count) : ValueType(0.0);
+
+    return hit_mask;
+}
+
+template <
+    typename Tree,
+    typename Visitor,
+    size_t PacketSize,
+    size_t StackSize
+>
+void PacketIntersector<Tree, Visitor, PacketSize, StackSize>::intersect_no_motion(
+    const Tree&                 tree,
+    const RayPacketType&        packet,
+    Visitor&                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , TraversalStatistics&      stats
+#endif
+    ) const
+{
+    // Make sure the tree was built.
+    assert(!tree.m_nodes.empty());
+
+    // Make sure the packet is not empty.
+    assert(packet.m_size > 0);
+    assert(packet.m_size <= PacketSize && PacketSize <= 32);
+
+    struct StackEntry
+    {
+        const NodeType*     m_node;
+        uint32              m_ray_mask;
+        ValueType           m_tmin[PacketSize];
+    };
+
+    // Node stack.
+    StackEntry stack[StackSize];
+    StackEntry* stack_ptr = stack;
+
+    // Current node and set of active rays.
+    const NodeType* node_ptr = &tree.m_nodes[0];
+    uint32 ray_mask = packet.get_full_mask();
+
+    // Initialize traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(++stats.m_traversal_count);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_nodes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_leaves = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t intersected_bboxes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t discarded_nodes = 0);
+
+    // Per-ray distance to the closest intersection so far.
+    ValueType ray_tmax[PacketSize];
+    for (size_t i = 0; i < PacketSize; ++i)
+        ray_tmax[i] = packet.m_tmax[i];
+
+    // Traverse the tree and intersect leaf nodes.
+    while (true)
+    {
+        // Fetch the node.
+        FOUNDATION_BVH_TRAVERSAL_STATS(++visited_nodes);
+
+        if (node_ptr->is_interior())
+        {
+            FOUNDATION_BVH_TRAVERSAL_STATS(intersected_bboxes += 2);
+
+            ValueType tmin[2][PacketSize];
+            ValueType tmin_avg[2];
+
+            // Intersect the left and right bounding boxes with all active rays.
+            const uint32 left_mask =
+                intersect_bbox(packet, node_ptr->get_left_bbox(), ray_tmax, ray_mask, tmin[0], tmin_avg[0]);
+            const uint32 right_mask =
+                intersect_bbox(packet, node_ptr->get_right_bbox(), ray_tmax, ray_mask, tmin[1], tmin_avg[1]);
+
+            const NodeType* child_ptr = &tree.m_nodes[node_ptr->get_child_node_index()];
+
+            if (left_mask && right_mask)
+            {
+                // Push the far child node to the stack, continue with the near child
+                // node. The near child is the one that is entered first on average.
+                const size_t far_index = tmin_avg[0] <= tmin_avg[1] ? 1 : 0;
+
+                assert(stack_ptr < stack + StackSize);
+                stack_ptr->m_node = child_ptr + far_index;
+                stack_ptr->m_ray_mask = far_index ? right_mask : left_mask;
+                for (size_t i = 0; i < PacketSize; ++i)
+                    stack_ptr->m_tmin[i] = tmin[far_index][i];
+                ++stack_ptr;
+
+                node_ptr = child_ptr + (1 - far_index);
+                ray_mask = far_index ? left_mask : right_mask;
+                continue;
+            }
+
+            if (left_mask | right_mask)
+            {
+                // Continue with the left or right child node.
+                FOUNDATION_BVH_TRAVERSAL_STATS(++discarded_nodes);
+                node_ptr = left_mask ? child_ptr : child_ptr + 1;
+                ray_mask = left_mask | right_mask;
+                continue;
+            }
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(discarded_nodes += 2);
+        }
+        else
+        {
+            // Visit the leaf.
+            FOUNDATION_BVH_TRAVERSAL_STATS(++visited_leaves);
+
+            ValueType distances[PacketSize];
+            for (size_t i = 0; i < PacketSize; ++i)
+                distances[i] = ray_tmax[i];
+
+            uint32 visited_mask = ray_mask;
+            const bool proceed =
+                visitor.visit(
+                    *node_ptr,
+                    packet,
+                    visited_mask,
+                    distances
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , stats
+#endif
+                    );
+
+            // Terminate traversal if the visitor decided so.
+            if (!proceed)
+                break;
+
+            // Rays removed by the visitor are excluded from the rest of the traversal.
+            const uint32 retired_mask = ray_mask & ~visited_mask;
+            for (size_t i = 0; i < PacketSize; ++i)
+            {
+                const uint32 bit = uint32(1) << i;
+
+                if (retired_mask & bit)
+                    ray_tmax[i] = ValueType(-1.0);
+                else if ((ray_mask & bit) && ray_tmax[i] > distances[i])
+                {
+                    // Keep track of the distance to the closest intersection.
+                    assert(distances[i] >= ValueType(0.0));
+                    ray_tmax[i] = distances[i];
+                }
+            }
+        }
+
+        // Pop the next node that still has active rays from the stack. Rays that
+        // found a closer hit since the node was pushed, or that were retired by
+        // the visitor (their tmax is negative), are removed from the node.
+        bool found = false;
+        while (stack_ptr > stack)
+        {
+            --stack_ptr;
+            node_ptr = stack_ptr->m_node;
+            ray_mask = stack_ptr->m_ray_mask;
+
+            for (size_t i = 0; i < PacketSize; ++i)
+            {
+                if (stack_ptr->m_tmin[i] >= ray_tmax[i])
+                    ray_mask &= ~(uint32(1) << i);
+            }
+
+            if (ray_mask)
+            {
+                found = true;
+                break;
+            }
+        }
+
+        // Terminate traversal if the node stack is empty.
+        if (!found)
+            break;
+    }
+
+    // Store traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_nodes.insert(visited_nodes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_leaves.insert(visited_leaves));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_bboxes.insert(intersected_bboxes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_discarded_nodes.insert(discarded_nodes));
+}
+
+}   // namespace bvh
+}   // namespace foundation
@@ -0,0 +1,415 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
+#include "foundation/utility/stopwatch.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Multithreaded BVH builder.
+//
+// The top levels of the tree are built on the calling thread until the remaining
+// subsets of items are small enough; the subtrees rooted at these subsets are then
+// built concurrently and stitched back into the tree. The partitioning decisions
+// are the same as those of foundation::bvh::Builder, so the resulting trees only
+// differ in the order in which nodes are stored.
+//
+// The Partitioner class must conform to the prototype documented in bvh_builder.h.
+// In addition, its partition() method must be safe to call concurrently on disjoint
+// ranges of items, as long as none of these ranges spans more than half the items.
+//
+
+template <typename Tree, typename Partitioner>
+class ParallelBuilder
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    explicit ParallelBuilder(const size_t thread_count);
+
+    // Build a tree.
+    template <typename Timer>
+    void build(
+        Tree&           tree,
+        Partitioner&    partitioner,
+        const size_t    size,
+        const size_t    items_per_leaf_hint);
+
+    // Return the construction time.
+    double get_build_time() const;
+
+  private:
+    typedef typename Tree::NodeVectorType NodeVectorType;
+    typedef typename Tree::NodeType NodeType;
+    typedef typename NodeType::AABBType AABBType;
+
+    struct Subtree
+    {
+        explicit Subtree(const typename NodeVectorType::allocator_type& allocator)
+          : m_nodes(allocator)
+        {
+        }
+
+        size_t          m_node_index;       // index in the tree of the root of the subtree
+        size_t          m_begin;
+        size_t          m_end;
+        AABBType        m_bbox;
+        NodeVectorType  m_nodes;            // nodes of the subtree, root first
+
+        bool operator<(const Subtree& rhs) const
+        {
+            // Largest subtrees first.
+            return m_end - m_begin > rhs.m_end - rhs.m_begin;
+        }
+    };
+
+    const size_t            m_thread_count;
+    size_t                  m_max_subtree_size;
+    std::vector<Subtree>    m_subtrees;
+    double                  m_build_time;
+
+    // Subdivide the top levels of the tree, collecting the subtrees to build concurrently.
+    void subdivide_top(
+        Tree&           tree,
+        Partitioner&    partitioner,
+        const size_t    node_index,
+        const size_t    begin,
+        const size_t    end,
+        const AABBType& bbox);
+
+    // Build the collected subtrees using all threads.
+    void build_subtrees(Partitioner& partitioner);
+
+    // Append the nodes of a subtree to the tree.
+    static void stitch_subtree(
+        Tree&           tree,
+        const Subtree&  subtree);
+
+    // Try to split a node, return the pivot or 'end' if the node must be a leaf.
+    static size_t split_node(
+        NodeVectorType& nodes,
+        Partitioner&    partitioner,
+        const size_t    node_index,
+        const size_t    begin,
+        const size_t    end,
+        const AABBType& bbox,
+        AABBType&       left_bbox,
+        AABBType&       right_bbox);
+
+    // Recursively subdivide a subtree.
+    static void subdivide_recurse(
+        NodeVectorType& nodes,
+        Partitioner&    partitioner,
+        const size_t    node_index,
+        const size_t    begin,
+        const size_t    end,
+        const AABBType& bbox);
+};
+
+
+//
+// ParallelBuilder class implementation.
+//
+
+template <typename Tree, typename Partitioner>
+ParallelBuilder<Tree, Partitioner>::ParallelBuilder(const size_t thread_count)
+  : m_thread_count(std::max<size_t>(thread_count, 1))
+  , m_max_subtree_size(0)
+  , m_build_time(0.0)
+{
+}
+
+template <typename Tree, typename Partitioner>
+template <typename Timer>
+void ParallelBuilder<Tree, Partitioner>::build(
+    Tree&               tree,
+    Partitioner&        partitioner,
+    const size_t        size,
+    const size_t        items_per_leaf_hint)
+{
+    // Start stopwatch.
+    Stopwatch<Timer> stopwatch;
+    stopwatch.start();
+
+    // Clear the tree.
+    tree.m_nodes.clear();
+
+    // Reserve memory for the nodes.
+    const size_t leaf_count_guess = size / items_per_leaf_hint;
+    const size_t node_count_guess = leaf_count_guess > 0 ? 2 * leaf_count_guess - 1 : 0;
+    tree.m_nodes.reserve(node_count_guess);
+
+    // Create the root node of the tree.
+    tree.m_nodes.push_back(NodeType());
+
+    // Compute the bounding box of the tree.
+    const AABBType root_bbox(partitioner.compute_bbox(0, size));
+
+    // Aim for several subtrees per thread to balance the load. Subtrees must never
+    // span more than half the items so that they can be partitioned concurrently.
+    const size_t MinSubtreeSize = 4096;
+    m_max_subtree_size = std::max(size / (8 * m_thread_count), MinSubtreeSize);
+    m_max_subtree_size = std::min(m_max_subtree_size, size / 2);
+
+    // Build the top of the tree on the calling thread.
+    m_subtrees.clear();
+    subdivide_top(
+        tree,
+        partitioner,
+        0,              // node index
+        0,              // begin
+        size,           // end
+        root_bbox);
+
+    // Build the subtrees concurrently.
+    build_subtrees(partitioner);
+
+    // Append the subtrees to the tree, in a deterministic order.
+    for (size_t i = 0; i < m_subtrees.size(); ++i)
+        stitch_subtree(tree, m_subtrees[i]);
+
+    m_subtrees.clear();
+
+    // Measure and save construction time.
+    stopwatch.measure();
+    m_build_time = stopwatch.get_seconds();
+}
+
+template <typename Tree, typename Partitioner>
+inline double ParallelBuilder<Tree, Partitioner>::get_build_time() const
+{
+    return m_build_time;
+}
+
+template <typename Tree, typename Partitioner>
+void ParallelBuilder<Tree, Partitioner>::subdivide_top(
+    Tree&               tree,
+    Partitioner&        partitioner,
+    const size_t        node_index,
+    const size_t        begin,
+    const size_t        end,
+    const AABBType&     bbox)
+{
+    if (end - begin <= m_max_subtree_size)
+    {
+        // Defer the construction of this subtree.
+        m_subtrees.push_back(Subtree(tree.m_nodes.get_allocator()));
+        Subtree& subtree = m_subtrees.back();
+        subtree.m_node_index = node_index;
+        subtree.m_begin = begin;
+        subtree.m_end = end;
+        subtree.m_bbox = bbox;
+        return;
+    }
+
+    AABBType left_bbox, right_bbox;
+    const size_t pivot =
+        split_node(
+            tree.m_nodes,
+            partitioner,
+            node_index,
+            begin,
+            end,
+            bbox,
+            left_bbox,
+            right_bbox);
+
+    if (pivot < end)
+    {
+        const size_t left_node_index = tree.m_nodes[node_index].get_child_node_index();
+        subdivide_top(tree, partitioner, left_node_index, begin, pivot, left_bbox);
+        subdivide_top(tree, partitioner, left_node_index + 1, pivot, end, right_bbox);
+    }
+}
+
+template <typename Tree, typename Partitioner>
+void ParallelBuilder<Tree, Partitioner>::build_subtrees(Partitioner& partitioner)
+{
+    // Start with the largest subtrees; keep the original order to stitch them.
+    std::vector<Subtree*> schedule(m_subtrees.size());
+    for (size_t i = 0; i < m_subtrees.size(); ++i)
+        schedule[i] = &m_subtrees[i];
+    std::stable_sort(
+        schedule.begin(),
+        schedule.end(),
+        [](const Subtree* lhs, const Subtree* rhs) { return *lhs < *rhs; });
+
+    boost::atomic<size_t> next_subtree(0);
+
+    const auto worker = [&]()
+    {
+        while (true)
+        {
+            const size_t i = next_subtree++;
+            if (i >= schedule.size())
+                break;
+
+            Subtree& subtree = *schedule[i];
+            subtree.m_nodes.push_back(NodeType());
+            subdivide_recurse(
+                subtree.m_nodes,
+                partitioner,
+                0,
+                subtree.m_begin,
+                subtree.m_end,
+                subtree.m_bbox);
+        }
+    };
+
+    const size_t thread_count = std::min(m_thread_count, schedule.size());
+
+    boost::thread_group threads;
+    for (size_t i = 1; i < thread_count; ++i)
+        threads.create_thread(worker);
+
+    worker();
+
+    threads.join_all();
+}
+
+template <typename Tree, typename Partitioner>
+void ParallelBuilder<Tree, Partitioner>::stitch_subtree(
+    Tree&               tree,
+    const Subtree&      subtree)
+{
+    // The root of the subtree replaces the placeholder node, the other nodes are appended.
+    const size_t base = tree.m_nodes.size() - 1;
+
+    for (size_t i = 0; i < subtree.m_nodes.size(); ++i)
+    {
+        NodeType node = subtree.m_nodes[i];
+
+        if (node.is_interior())
+            node.set_child_node_index(base + node.get_child_node_index());
+
+        if (i == 0)
+            tree.m_nodes[subtree.m_node_index] = node;
+        else tree.m_nodes.push_back(node);
+    }
+}
+
+template <typename Tree, typename Partitioner>
+size_t ParallelBuilder<Tree, Partitioner>::split_node(
+    NodeVectorType&     nodes,
+    Partitioner&        partitioner,
+    const size_t        node_index,
+    const size_t        begin,
+    const size_t        end,
+    const AABBType&     bbox,
+    AABBType&           left_bbox,
+    AABBType&           right_bbox)
+{
+    assert(node_index < nodes.size());
+
+    // Try to partition the set of items.
+    size_t pivot = end;
+    if (end - begin > 1)
+    {
+        pivot = partitioner.partition(begin, end, typename Partitioner::AABBType(bbox));
+        assert(pivot > begin);
+        assert(pivot <= end);
+    }
+
+    if (pivot == end)
+    {
+        // Turn the current node into a leaf node.
+        NodeType& node = nodes[node_index];
+        node.make_leaf();
+        node.set_item_index(begin);
+        node.set_item_count(end - begin);
+    }
+    else
+    {
+        // Compute the bounding box of the child nodes.
+        left_bbox = AABBType(partitioner.compute_bbox(begin, pivot));
+        right_bbox = AABBType(partitioner.compute_bbox(pivot, end));
+
+        // Compute the index of the first child node.
+        const size_t left_node_index = nodes.size();
+
+        // Turn the current node into an interior node.
+        NodeType& node = nodes[node_index];
+        node.make_interior();
+        node.set_left_bbox(left_bbox);
+        node.set_right_bbox(right_bbox);
+        node.set_child_node_index(left_node_index);
+
+        // Create the child nodes.
+        nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
+    }
+
+    return pivot;
+}
+
+template <typename Tree, typename Partitioner>
+void ParallelBuilder<Tree, Partitioner>::subdivide_recurse(
+    NodeVectorType&     nodes,
+    Partitioner&        partitioner,
+    const size_t        node_index,
+    const size_t        begin,
+    const size_t        end,
+    const AABBType&     bbox)
+{
+    AABBType left_bbox, right_bbox;
+    const size_t pivot =
+        split_node(
+            nodes,
+            partitioner,
+            node_index,
+            begin,
+            end,
+            bbox,
+            left_bbox,
+            right_bbox);
+
+    if (pivot < end)
+    {
+        const size_t left_node_index = nodes[node_index].get_child_node_index();
+        subdivide_recurse(nodes, partitioner, left_node_index, begin, pivot, left_bbox);
+        subdivide_recurse(nodes, partitioner, left_node_index + 1, pivot, end, right_bbox);
+    }
+}
+
+}   // namespace bvh
+}   // namespace foundation
@@ -31,6 +31,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
 #include "foundation/math/population.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
@@ -38,6 +39,8 @@
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <string>
+#include <vector>
 
 namespace foundation {
 namespace bvh {
@@ -45,6 +48,10 @@ namespace bvh {
 //
 // BVH tree statistics.
 //
+// The SAH cost is computed with unit traversal and intersection costs and is
+// relative to the surface area of the tree's bounding box, so that trees built
+// for different items and with different settings can be compared.
+//
 
 template <typename Tree>
 class TreeStatistics
@@ -59,14 +66,28 @@ class TreeStatistics
         const Tree&         tree,
         const AABBType&     tree_bbox);
 
+    // Return the SAH cost of the tree.
+    double get_sah_cost() const;
+
+    // Return the number of leaf nodes.
+    size_t get_leaf_count() const;
+
+    // Return the number of leaves per item count and per depth.
+    const std::vector<size_t>& get_leaf_size_histogram() const;
+    const std::vector<size_t>& get_leaf_depth_histogram() const;
+
   private:
     typedef typename AABBType::ValueType ValueType;
 
+    ValueType               m_root_area;            // half surface area of the tree's bounding box
     ValueType               m_leaf_volume;          // total volume of the leaves
     size_t                  m_leaf_count;           // number of leaf nodes
+    double                  m_sah_cost;             // SAH cost of the tree
     Population<size_t>      m_leaf_depth;           // leaf depth statistics
     Population<size_t>      m_leaf_size;            // leaf size statistics
     Population<double>      m_sibling_overlap;      // amount of overlap between sibling nodes
+    std::vector<size_t>     m_leaf_depth_histogram; // number of leaves per depth
+    std::vector<size_t>     m_leaf_size_histogram;  // number of leaves per item count
 
     // Helper method to recursively traverse the tree and collect statistics.
     void collect_stats_recurse(
@@ -74,6 +95,14 @@ class TreeStatistics
         const NodeType&     node,
         const AABBType&     bbox,
         const size_t        depth);
+
+    // Add a leaf to a histogram.
+    static void insert_into_histogram(
+        std::vector<size_t>&        histogram,
+        const size_t                value);
+
+    // Format the non-empty buckets of a histogram as "value:count" pairs.
+    static std::string format_histogram(const std::vector<size_t>& histogram);
 };
 
 
@@ -108,8 +137,10 @@ template <typename Tree>
 TreeStatistics<Tree>::TreeStatistics(
     const Tree&             tree,
     const AABBType&         tree_bbox)
-  : m_leaf_volume(ValueType(0.0))
+  : m_root_area(tree_bbox.is_valid() ? half_surface_area(tree_bbox) : ValueType(0.0))
+  , m_leaf_volume(ValueType(0.0))
   , m_leaf_count(0)
+  , m_sah_cost(0.0)
 {
     assert(!tree.m_nodes.empty());
 
@@ -128,11 +159,38 @@ TreeStatistics<Tree>::TreeStatistics(
         "  interior " + pretty_uint(tree.m_nodes.size() - m_leaf_count) +
         "  leaves " + pretty_uint(m_leaf_count));
     insert_percent("leaf volume", m_leaf_volume, tree_volume);
+    insert("sah cost", m_sah_cost);
     insert("leaf depth", m_leaf_depth);
+    insert("leaf depth histogram", format_histogram(m_leaf_depth_histogram));
     insert("leaf size", m_leaf_size);
+    insert("leaf size histogram", format_histogram(m_leaf_size_histogram));
     insert("sibling overlap", m_sibling_overlap, "%");
 }
 
+template <typename Tree>
+inline double TreeStatistics<Tree>::get_sah_cost() const
+{
+    return m_sah_cost;
+}
+
+template <typename Tree>
+inline size_t TreeStatistics<Tree>::get_leaf_count() const
+{
+    return m_leaf_count;
+}
+
+template <typename Tree>
+inline const std::vector<size_t>& TreeStatistics<Tree>::get_leaf_size_histogram() const
+{
+    return m_leaf_size_histogram;
+}
+
+template <typename Tree>
+inline const std::vector<size_t>& TreeStatistics<Tree>::get_leaf_depth_histogram() const
+{
+    return m_leaf_depth_histogram;
+}
+
 template <typename Tree>
 void TreeStatistics<Tree>::collect_stats_recurse(
     const Tree&             tree,
@@ -140,17 +198,28 @@ void TreeStatistics<Tree>::collect_stats_recurse(
     const AABBType&         bbox,
     const size_t            depth)
 {
+    // Relative probability of a ray hitting the node, given that it hits the tree.
+    const double hit_probability =
+        m_root_area > ValueType(0.0) && bbox.is_valid()
+            ? static_cast<double>(half_surface_area(bbox) / m_root_area)
+            : 0.0;
+
     if (node.is_leaf())
     {
         // Gather leaf statistics.
         m_leaf_depth.insert(depth);
         m_leaf_size.insert(node.get_item_count());
+        insert_into_histogram(m_leaf_depth_histogram, depth);
+        insert_into_histogram(m_leaf_size_histogram, node.get_item_count());
         ++m_leaf_count;
         if (bbox.is_valid())
             m_leaf_volume += bbox.volume();
+        m_sah_cost += hit_probability * node.get_item_count();
     }
     else
     {
+        m_sah_cost += hit_probability;
+
         // Fetch left and right children.
         const size_t child_index = node.get_child_node_index();
         const AABBType left_bbox = node.get_left_bbox();
@@ -167,5 +236,35 @@ void TreeStatistics<Tree>::collect_stats_recurse(
     }
 }
 
+template <typename Tree>
+void TreeStatistics<Tree>::insert_into_histogram(
+    std::vector<size_t>&    histogram,
+    const size_t            value)
+{
+    if (histogram.size() <= value)
+        histogram.resize(value + 1, 0);
+
+    ++histogram[value];
+}
+
+template <typename Tree>
+std::string TreeStatistics<Tree>::format_histogram(const std::vector<size_t>& histogram)
+{
+    std::string result;
+
+    for (size_t i = 0, e = histogram.size(); i < e; ++i)
+    {
+        if (histogram[i] == 0)
+            continue;
+
+        if (!result.empty())
+            result += "  ";
+
+        result += foundation::to_string(i) + ":" + pretty_uint(histogram[i]);
+    }
+
+    return result.empty() ? "n/a" : result;
+}
+
 }   // namespace bvh
 }   // namespace foundation
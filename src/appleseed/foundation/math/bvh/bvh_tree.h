@@ -62,6 +62,9 @@ class Tree
     template <typename Tree, typename Partitioner>
     friend class Builder;
 
+    template <typename Tree, typename Partitioner>
+    friend class ParallelBuilder;
+
     template <typename Tree, typename Partitioner>
     friend class SpatialBuilder;
 
@@ -71,11 +74,24 @@ class Tree
     template <typename Tree, typename Visitor, typename Ray, size_t StackSize, size_t N>
     friend class Intersector;
 
+    template <typename Tree, typename Visitor, size_t PacketSize, size_t StackSize>
+    friend class PacketIntersector;
+
+    template <typename LeafNode, size_t Width>
+    friend class WideTree;
+
     typedef typename NodeType::AABBType AABBType;
     typedef std::vector<AABBType> AABBVector;
 
-    NodeVector  m_nodes;
-    AABBVector  m_node_bboxes;
+    NodeVector          m_nodes;
+    AABBVector          m_node_bboxes;
+
+    // Root nodes of the subtrees that cover consecutive, equal intervals of normalized time.
+    // When empty, the tree has a single root covering the whole shutter interval.
+    std::vector<size_t> m_time_segment_roots;
+
+    // Return the index of the root node to use for a given normalized time.
+    size_t get_root_node_index(const double time) const;
 };
 
 
@@ -94,6 +110,7 @@ template <typename NodeVector>
 void Tree<NodeVector>::clear()
 {
     m_nodes.clear();
+    m_time_segment_roots.clear();
 }
 
 template <typename NodeVector>
@@ -101,7 +118,21 @@ size_t Tree<NodeVector>::get_memory_size() const
 {
     return
           sizeof(*this)
-        + m_nodes.capacity() * sizeof(NodeType);
+        + m_nodes.capacity() * sizeof(NodeType)
+        + m_time_segment_roots.capacity() * sizeof(size_t);
+}
+
+template <typename NodeVector>
+inline size_t Tree<NodeVector>::get_root_node_index(const double time) const
+{
+    if (m_time_segment_roots.empty())
+        return 0;
+
+    const size_t segment_count = m_time_segment_roots.size();
+    const double x = time * segment_count;
+    const size_t segment = x > 0.0 ? static_cast<size_t>(x) : 0;
+
+    return m_time_segment_roots[segment < segment_count ? segment : segment_count - 1];
 }
 
 }   // namespace bvh
@@ -0,0 +1,251 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/bvh/bvh_intersector.h"
+#include "foundation/math/bvh/bvh_statistics.h"
+#include "foundation/math/bvh/bvh_widetree.h"
+#include "foundation/math/ray.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Wide BVH intersector.
+//
+// The Visitor class must conform to the same prototype as for
+// foundation::bvh::Intersector; it is handed the leaf nodes of
+// the binary tree the wide tree was collapsed from.
+//
+
+template <
+    typename WideTree,
+    typename Visitor,
+    typename Ray,
+    size_t StackSize = 128
+>
+class WideIntersector
+  : public NonCopyable
+{
+  public:
+    typedef typename WideTree::NodeType NodeType;
+    typedef typename WideTree::LeafNodeType LeafNodeType;
+    typedef typename WideTree::ValueType ValueType;
+    typedef Ray RayType;
+    typedef RayInfo<ValueType, NodeType::Dimension> RayInfoType;
+
+    // Intersect a ray with a given wide BVH without motion.
+    void intersect_no_motion(
+        const WideTree&         tree,
+        const RayType&          ray,
+        const RayInfoType&      ray_info,
+        Visitor&                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , TraversalStatistics&  stats
+#endif
+        ) const;
+};
+
+
+//
+// WideIntersector class implementation.
+//
+
+template <
+    typename WideTree,
+    typename Visitor,
+    typename Ray,
+    size_t StackSize
+>
+void WideIntersector<WideTree, Visitor, Ray, StackSize>::intersect_no_motion(
+    const WideTree&             tree,
+    const RayType&              ray,
+    const RayInfoType&          ray_info,
+    Visitor&                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , TraversalStatistics&      stats
+#endif
+    ) const
+{
+    const size_t Width = NodeType::MaxChildCount;
+    const size_t Dimension = NodeType::Dimension;
+
+    // Make sure the tree was built.
+    assert(!tree.empty());
+
+    struct StackEntry
+    {
+        uint32      m_ref;
+        ValueType   m_tmin;
+    };
+
+    // Node stack. Each wide node can push up to Width - 1 entries.
+    StackEntry stack[StackSize];
+    StackEntry* stack_ptr = stack;
+
+    // Current node: the root of the wide tree, or the single leaf of the binary tree.
+    uint32 ref = tree.is_single_leaf() ? NodeType::LeafFlag : 0;
+
+    // Initialize traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(++stats.m_traversal_count);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_nodes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t visited_leaves = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t intersected_bboxes = 0);
+    FOUNDATION_BVH_TRAVERSAL_STATS(size_t discarded_nodes = 0);
+
+    // Traverse the tree and intersect leaf nodes.
+    ValueType ray_tmax = ray.m_tmax;
+    while (true)
+    {
+        // Fetch the node.
+        FOUNDATION_BVH_TRAVERSAL_STATS(++visited_nodes);
+
+        if (!(ref & NodeType::LeafFlag))
+        {
+            const NodeType& node = tree.get_node(ref);
+            const size_t child_count = node.get_child_count();
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(intersected_bboxes += child_count);
+
+            // Intersect the bounding boxes of all the children at once.
+            // Empty child slots have empty bounding boxes and are always missed.
+            ValueType tmin[Width];
+            ValueType tmax[Width];
+
+            for (size_t i = 0; i < Width; ++i)
+            {
+                tmin[i] = ray.m_tmin;
+                tmax[i] = ray_tmax;
+            }
+
+            for (size_t d = 0; d < Dimension; ++d)
+            {
+                const ValueType origin = node.get_origin(d);
+                const ValueType scale = node.get_scale(d);
+                const uint8* qnear = ray_info.m_sgn_dir[d] ? node.get_quantized_min(d) : node.get_quantized_max(d);
+                const uint8* qfar = ray_info.m_sgn_dir[d] ? node.get_quantized_max(d) : node.get_quantized_min(d);
+                const ValueType org = ray.m_org[d];
+                const ValueType rcp_dir = ray_info.m_rcp_dir[d];
+
+                for (size_t i = 0; i < Width; ++i)
+                {
+                    const ValueType tnear = rcp_dir * ((origin + static_cast<ValueType>(qnear[i]) * scale) - org);
+                    const ValueType tfar = rcp_dir * ((origin + static_cast<ValueType>(qfar[i]) * scale) - org);
+                    tmin[i] = tnear > tmin[i] ? tnear : tmin[i];
+                    tmax[i] = tfar < tmax[i] ? tfar : tmax[i];
+                }
+            }
+
+            // Collect the children that were hit, sorted by increasing entry distance.
+            StackEntry hits[Width];
+            size_t hit_count = 0;
+
+            for (size_t i = 0; i < child_count; ++i)
+            {
+                if (tmin[i] <= tmax[i] && tmin[i] < ray_tmax)
+                {
+                    size_t j = hit_count++;
+                    while (j > 0 && hits[j - 1].m_tmin > tmin[i])
+                    {
+                        hits[j] = hits[j - 1];
+                        --j;
+                    }
+                    hits[j].m_ref = node.get_child_ref(i);
+                    hits[j].m_tmin = tmin[i];
+                }
+            }
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(discarded_nodes += child_count - hit_count);
+
+            if (hit_count > 0)
+            {
+                // Push the far children to the stack, farthest first, continue with the nearest child.
+                assert(stack_ptr + hit_count - 1 <= stack + StackSize);
+                for (size_t i = hit_count - 1; i > 0; --i)
+                    *stack_ptr++ = hits[i];
+                ref = hits[0].m_ref;
+                continue;
+            }
+        }
+        else
+        {
+            // Visit the leaf.
+            FOUNDATION_BVH_TRAVERSAL_STATS(++visited_leaves);
+            ValueType distance;
+#ifndef NDEBUG
+            distance = ValueType(-1.0);
+#endif
+            const bool proceed =
+                visitor.visit(
+                    tree.get_leaf(ref & ~NodeType::LeafFlag),
+                    ray,
+                    ray_info,
+                    distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , stats
+#endif
+                    );
+            assert(!proceed || distance >= ValueType(0.0));
+
+            // Terminate traversal if the visitor decided so.
+            if (!proceed)
+                break;
+
+            // Keep track of the distance to the closest intersection.
+            if (ray_tmax > distance)
+                ray_tmax = distance;
+        }
+
+        // Pop the nearest node that is not beyond the closest intersection.
+        while (stack_ptr > stack && (stack_ptr - 1)->m_tmin >= ray_tmax)
+            --stack_ptr;
+
+        // Terminate traversal if the node stack is empty.
+        if (stack_ptr == stack)
+            break;
+
+        ref = (--stack_ptr)->m_ref;
+    }
+
+    // Store traversal statistics.
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_nodes.insert(visited_nodes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_visited_leaves.insert(visited_leaves));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_bboxes.insert(intersected_bboxes));
+    FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_discarded_nodes.insert(discarded_nodes));
+}
+
+}   // namespace bvh
+}   // namespace foundation
@@ -0,0 +1,503 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/alignedvector.h"
+#include "foundation/utility/casts.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace foundation {
+namespace bvh {
+
+//
+// Node of a wide (4- or 8-ary) BVH.
+//
+// The bounding boxes of the children are stored in structure-of-arrays layout
+// and quantized to 8 bits per coordinate relative to the bounding box of the
+// node, so that a 4-wide node fits in a single 64-byte cache line. Quantized
+// bounding boxes are always conservative.
+//
+// A child is either another wide node or a leaf. Leaves are the leaf nodes of
+// the binary BVH the wide BVH was collapsed from, so that their user data (and
+// the leaf visitors that interpret it) can be used unchanged.
+//
+// Reference:
+//
+//   Efficient Incoherent Ray Traversal on GPUs Through Compressed Wide BVHs
+//   Henri Ylitie, Tero Karras, Samuli Laine
+//   http://research.nvidia.com/publication/2017-07_Efficient-Incoherent-Ray
+//
+
+template <typename AABB, size_t Width = 4>
+class APPLESEED_ALIGN(64) WideNode
+{
+  public:
+    typedef AABB AABBType;
+    typedef typename AABBType::ValueType ValueType;
+
+    static const size_t Dimension = AABBType::Dimension;
+    static const size_t MaxChildCount = Width;
+
+    // Flag set in the reference of leaf children.
+    static const uint32 LeafFlag = 0x80000000UL;
+
+    // Constructor, creates a node with no children.
+    WideNode();
+
+    // Set the bounding box of the node. Must be called before adding children.
+    // The bounding box must enclose the bounding boxes of all the children.
+    void set_bbox(const AABBType& bbox);
+
+    // Add a child to the node.
+    void add_child(const AABBType& bbox, const uint32 child_ref);
+
+    // Return the number of children of the node.
+    size_t get_child_count() const;
+
+    // Return the reference of a child: either the index of a wide node or, if
+    // LeafFlag is set, the index of a leaf node in the binary tree.
+    uint32 get_child_ref(const size_t index) const;
+
+    // Return the (dequantized) bounding box of a child.
+    AABBType get_child_bbox(const size_t index) const;
+
+    // Return the origin and the quantization step of the local grid along a given dimension.
+    ValueType get_origin(const size_t dim) const;
+    ValueType get_scale(const size_t dim) const;
+
+    // Return the quantized bounds of the children along a given dimension.
+    const uint8* get_quantized_min(const size_t dim) const;
+    const uint8* get_quantized_max(const size_t dim) const;
+
+  private:
+    float   m_origin[Dimension];
+    int8    m_exponent[Dimension];
+    uint8   m_child_count;
+    uint8   m_qmin[Dimension][Width];
+    uint8   m_qmax[Dimension][Width];
+    uint32  m_child_ref[Width];
+
+    static ValueType exponent_to_scale(const int8 exponent);
+};
+
+
+//
+// Wide BVH, collapsed from a binary BVH.
+//
+// The wide tree references the leaf nodes of the binary tree. The binary tree
+// must outlive the wide tree and must not be modified after the wide tree was
+// built. Only trees without motion are supported.
+//
+
+template <typename LeafNode, size_t Width = 4>
+class WideTree
+  : public NonCopyable
+{
+  public:
+    typedef LeafNode LeafNodeType;
+    typedef typename LeafNodeType::AABBType AABBType;
+    typedef typename AABBType::ValueType ValueType;
+    typedef WideNode<AABBType, Width> NodeType;
+    typedef AlignedVector<NodeType> NodeVector;
+
+    // Constructor.
+    WideTree();
+
+    // Collapse a binary tree into this wide tree.
+    template <typename Tree>
+    void build(const Tree& tree);
+
+    // Clear the tree.
+    void clear();
+
+    // Return true if the tree was not built.
+    bool empty() const;
+
+    // Return the number of wide nodes.
+    size_t get_node_count() const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+    // Access the wide nodes.
+    const NodeType& get_node(const size_t index) const;
+
+    // Access the leaf nodes.
+    const LeafNodeType& get_leaf(const size_t index) const;
+
+    // Return true if the binary tree was reduced to a single leaf, in which case there is no wide node.
+    bool is_single_leaf() const;
+
+  private:
+    struct Child
+    {
+        size_t      m_index;
+        AABBType    m_bbox;
+    };
+
+    NodeVector              m_nodes;
+    const LeafNodeType*     m_leaves;
+    bool                    m_single_leaf;
+
+    template <typename Tree>
+    uint32 collapse(
+        const Tree&         tree,
+        const size_t        node_index);
+};
+
+
+//
+// WideNode class implementation.
+//
+
+template <typename AABB, size_t Width>
+inline WideNode<AABB, Width>::WideNode()
+  : m_child_count(0)
+{
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        m_origin[d] = 0.0f;
+        m_exponent[d] = 0;
+
+        // Empty slots have an empty bounding box and can never be hit.
+        for (size_t i = 0; i < Width; ++i)
+        {
+            m_qmin[d][i] = 255;
+            m_qmax[d][i] = 0;
+        }
+    }
+
+    for (size_t i = 0; i < Width; ++i)
+        m_child_ref[i] = 0;
+}
+
+template <typename AABB, size_t Width>
+inline typename WideNode<AABB, Width>::ValueType WideNode<AABB, Width>::exponent_to_scale(const int8 exponent)
+{
+    // Build the IEEE 754 single precision representation of 2^exponent.
+    return static_cast<ValueType>(binary_cast<float>(static_cast<uint32>(exponent + 127) << 23));
+}
+
+template <typename AABB, size_t Width>
+void WideNode<AABB, Width>::set_bbox(const AABBType& bbox)
+{
+    assert(bbox.is_valid());
+    assert(m_child_count == 0);
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        // Round the origin down to single precision.
+        float origin = static_cast<float>(bbox.min[d]);
+        while (static_cast<ValueType>(origin) > bbox.min[d])
+            origin = std::nextafter(origin, -std::numeric_limits<float>::max());
+        m_origin[d] = origin;
+
+        // Find the smallest power of two step such that 255 steps span the bounding box.
+        const ValueType extent = bbox.max[d] - static_cast<ValueType>(origin);
+        int exponent = -126;
+        if (extent > ValueType(0.0))
+        {
+            int e;
+            std::frexp(static_cast<double>(extent) / 255.0, &e);
+            exponent = std::max(e - 1, -126);
+        }
+        while (
+            exponent < 127 &&
+            static_cast<ValueType>(origin) + ValueType(255.0) * exponent_to_scale(static_cast<int8>(exponent)) < bbox.max[d])
+            ++exponent;
+        assert(exponent >= -126 && exponent <= 127);
+        m_exponent[d] = static_cast<int8>(exponent);
+    }
+}
+
+template <typename AABB, size_t Width>
+void WideNode<AABB, Width>::add_child(const AABBType& bbox, const uint32 child_ref)
+{
+    assert(m_child_count < Width);
+
+    const size_t index = m_child_count++;
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        const ValueType origin = get_origin(d);
+        const ValueType scale = get_scale(d);
+
+        ValueType qmin = std::floor((bbox.min[d] - origin) / scale);
+        ValueType qmax = std::ceil((bbox.max[d] - origin) / scale);
+        qmin = clamp(qmin, ValueType(0.0), ValueType(255.0));
+        qmax = clamp(qmax, ValueType(0.0), ValueType(255.0));
+
+        // Make sure the dequantized bounds are conservative despite rounding.
+        while (qmin > ValueType(0.0) && origin + qmin * scale > bbox.min[d])
+            qmin -= ValueType(1.0);
+        while (qmax < ValueType(255.0) && origin + qmax * scale < bbox.max[d])
+            qmax += ValueType(1.0);
+
+        m_qmin[d][index] = static_cast<uint8>(qmin);
+        m_qmax[d][index] = static_cast<uint8>(qmax);
+    }
+
+    m_child_ref[index] = child_ref;
+}
+
+template <typename AABB, size_t Width>
+inline size_t WideNode<AABB, Width>::get_child_count() const
+{
+    return m_child_count;
+}
+
+template <typename AABB, size_t Width>
+inline uint32 WideNode<AABB, Width>::get_child_ref(const size_t index) const
+{
+    assert(index < m_child_count);
+    return m_child_ref[index];
+}
+
+template <typename AABB, size_t Width>
+inline AABB WideNode<AABB, Width>::get_child_bbox(const size_t index) const
+{
+    assert(index < m_child_count);
+
+    AABBType bbox;
+
+    for (size_t d = 0; d < Dimension; ++d)
+    {
+        const ValueType origin = get_origin(d);
+        const ValueType scale = get_scale(d);
+        bbox.min[d] = origin + static_cast<ValueType>(m_qmin[d][index]) * scale;
+        bbox.max[d] = origin + static_cast<ValueType>(m_qmax[d][index]) * scale;
+    }
+
+    return bbox;
+}
+
+template <typename AABB, size_t Width>
+inline typename WideNode<AABB, Width>::ValueType WideNode<AABB, Width>::get_origin(const size_t dim) const
+{
+    assert(dim < Dimension);
+    return static_cast<ValueType>(m_origin[dim]);
+}
+
+template <typename AABB, size_t Width>
+inline typename WideNode<AABB, Width>::ValueType WideNode<AABB, Width>::get_scale(const size_t dim) const
+{
+    assert(dim < Dimension);
+    return exponent_to_scale(m_exponent[dim]);
+}
+
+template <typename AABB, size_t Width>
+inline const uint8* WideNode<AABB, Width>::get_quantized_min(const size_t dim) const
+{
+    assert(dim < Dimension);
+    return m_qmin[dim];
+}
+
+template <typename AABB, size_t Width>
+inline const uint8* WideNode<AABB, Width>::get_quantized_max(const size_t dim) const
+{
+    assert(dim < Dimension);
+    return m_qmax[dim];
+}
+
+
+//
+// WideTree class implementation.
+//
+
+template <typename LeafNode, size_t Width>
+WideTree<LeafNode, Width>::WideTree()
+  : m_leaves(nullptr)
+  , m_single_leaf(false)
+{
+}
+
+template <typename LeafNode, size_t Width>
+template <typename Tree>
+void WideTree<LeafNode, Width>::build(const Tree& tree)
+{
+    clear();
+
+    if (tree.m_nodes.empty())
+        return;
+
+    m_leaves = &tree.m_nodes[0];
+
+    if (tree.m_nodes[0].is_leaf())
+    {
+        m_single_leaf = true;
+        return;
+    }
+
+    // Collapse the tree, the root of the binary tree becomes the root of the wide tree.
+    m_nodes.reserve(tree.m_nodes.size() / (Width - 1) + 1);
+    collapse(tree, 0);
+}
+
+template <typename LeafNode, size_t Width>
+template <typename Tree>
+uint32 WideTree<LeafNode, Width>::collapse(
+    const Tree&         tree,
+    const size_t        node_index)
+{
+    const LeafNodeType& node = tree.m_nodes[node_index];
+    assert(node.is_interior());
+
+    // Start with the two children of the binary node.
+    Child children[Width];
+    size_t child_count = 2;
+    children[0].m_index = node.get_child_node_index();
+    children[0].m_bbox = node.get_left_bbox();
+    children[1].m_index = node.get_child_node_index() + 1;
+    children[1].m_bbox = node.get_right_bbox();
+
+    // Repeatedly open the interior child with the largest surface area.
+    while (child_count < Width)
+    {
+        size_t best_child = Width;
+        ValueType best_area(-1.0);
+
+        for (size_t i = 0; i < child_count; ++i)
+        {
+            if (tree.m_nodes[children[i].m_index].is_interior())
+            {
+                const ValueType area = half_surface_area(children[i].m_bbox);
+                if (area > best_area)
+                {
+                    best_child = i;
+                    best_area = area;
+                }
+            }
+        }
+
+        if (best_child == Width)
+            break;
+
+        const LeafNodeType& opened = tree.m_nodes[children[best_child].m_index];
+        const size_t first_grandchild = opened.get_child_node_index();
+
+        children[child_count].m_index = first_grandchild + 1;
+        children[child_count].m_bbox = opened.get_right_bbox();
+        children[best_child].m_index = first_grandchild;
+        children[best_child].m_bbox = opened.get_left_bbox();
+        ++child_count;
+    }
+
+    AABBType bbox;
+    bbox.invalidate();
+    for (size_t i = 0; i < child_count; ++i)
+        bbox.insert(children[i].m_bbox);
+
+    // Create the wide node before its children so that the root is at index 0.
+    const size_t wide_index = m_nodes.size();
+    m_nodes.push_back(NodeType());
+
+    uint32 child_refs[Width];
+    for (size_t i = 0; i < child_count; ++i)
+    {
+        const size_t child_index = children[i].m_index;
+        assert(child_index < NodeType::LeafFlag);
+
+        child_refs[i] =
+            tree.m_nodes[child_index].is_leaf()
+                ? static_cast<uint32>(child_index) | NodeType::LeafFlag
+                : collapse(tree, child_index);
+    }
+
+    // The node vector may have been reallocated during recursion.
+    NodeType& wide_node = m_nodes[wide_index];
+    wide_node.set_bbox(bbox);
+    for (size_t i = 0; i < child_count; ++i)
+        wide_node.add_child(children[i].m_bbox, child_refs[i]);
+
+    return static_cast<uint32>(wide_index);
+}
+
+template <typename LeafNode, size_t Width>
+void WideTree<LeafNode, Width>::clear()
+{
+    m_nodes.clear();
+    m_leaves = nullptr;
+    m_single_leaf = false;
+}
+
+template <typename LeafNode, size_t Width>
+inline bool WideTree<LeafNode, Width>::empty() const
+{
+    return m_leaves == nullptr;
+}
+
+template <typename LeafNode, size_t Width>
+inline size_t WideTree<LeafNode, Width>::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+template <typename LeafNode, size_t Width>
+size_t WideTree<LeafNode, Width>::get_memory_size() const
+{
+    return
+          sizeof(*this)
+        + m_nodes.capacity() * sizeof(NodeType);
+}
+
+template <typename LeafNode, size_t Width>
+inline const typename WideTree<LeafNode, Width>::NodeType& WideTree<LeafNode, Width>::get_node(const size_t index) const
+{
+    assert(index < m_nodes.size());
+    return m_nodes[index];
+}
+
+template <typename LeafNode, size_t Width>
+inline const LeafNode& WideTree<LeafNode, Width>::get_leaf(const size_t index) const
+{
+    assert(m_leaves);
+    assert(m_leaves[index].is_leaf());
+    return m_leaves[index];
+}
+
+template <typename LeafNode, size_t Width>
+inline bool WideTree<LeafNode, Width>::is_single_leaf() const
+{
+    return m_single_leaf;
+}
+
+}   // namespace bvh
+}   // namespace foundation
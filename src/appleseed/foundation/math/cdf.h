@@ -67,6 +67,9 @@ class CDF
     // Return true if the CDF has at least one item with a positive weight.
     bool valid() const;
 
+    // Return the number of items in the CDF.
+    size_t size() const;
+
     // Return the sum of the weight of all inserted items.
     Weight weight() const;
 
@@ -157,6 +160,12 @@ inline bool CDF<Item, Weight>::valid() const
     return m_weight_sum > Weight(0.0);
 }
 
+template <typename Item, typename Weight>
+inline size_t CDF<Item, Weight>::size() const
+{
+    return m_items.size();
+}
+
 template <typename Item, typename Weight>
 inline Weight CDF<Item, Weight>::weight() const
 {
@@ -30,6 +30,7 @@
 #pragma once
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #ifdef APPLESEED_USE_SSE
 #include "foundation/platform/sse.h"
 #endif
@@ -38,7 +39,9 @@
 #include "foundation/utility/memory.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 
 namespace foundation
@@ -121,6 +124,9 @@ namespace foundation
 //   Fast reciprocal square root:
 //     http://www.lomont.org/Math/Papers/2003/InvSqrt.pdf
 //
+//   Fast arc cosine:
+//     Handbook of Mathematical Functions, Abramowitz and Stegun, formula 4.4.45
+//
 
 // Fast approximations of 2^p.
 float fast_pow2(const float p);
@@ -163,6 +169,19 @@ float fast_rcp_sqrt(const float x);
 double fast_rcp_sqrt(const double x);
 float faster_rcp_sqrt(const float x);
 
+// Fast arc cosine approximation, absolute error below 7e-5. x is clamped to [-1, 1].
+float fast_acos(const float x);
+
+// Transcendental functions used by BSDFs and microfacet distributions. They map
+// to the fast approximations above when appleseed is built with the fast shading
+// math option (APPLESEED_WITH_FAST_SHADING_MATH), and to the standard library
+// functions otherwise. In fast mode, the relative error of shading_pow() is below
+// 2e-3 (x >= 0), the relative error of shading_exp() is below 1e-4 and the absolute
+// error of shading_acos() is below 7e-5.
+float shading_pow(const float x, const float p);
+float shading_exp(const float p);
+float shading_acos(const float x);
+
 // SSE variants of some of the functions above.
 #ifdef APPLESEED_USE_SSE
 __m128 fast_pow2(const __m128 p);
@@ -407,6 +426,53 @@ inline float faster_rcp_sqrt(const float x)
 
 #endif  // APPLESEED_USE_SSE
 
+inline float fast_acos(const float x)
+{
+    const float abs_x = std::min(std::abs(x), 1.0f);
+    const float y =
+        std::sqrt(1.0f - abs_x) *
+        (1.5707288f + abs_x * (-0.2121144f + abs_x * (0.0742610f - 0.0187293f * abs_x)));
+
+    return x < 0.0f ? Pi<float>() - y : y;
+}
+
+#ifdef APPLESEED_WITH_FAST_SHADING_MATH
+
+inline float shading_pow(const float x, const float p)
+{
+    // The error of fast_pow() grows linearly with the exponent.
+    return std::abs(p) <= 16.0f ? fast_pow(x, p) : std::pow(x, p);
+}
+
+inline float shading_exp(const float p)
+{
+    return fast_exp(p);
+}
+
+inline float shading_acos(const float x)
+{
+    return fast_acos(x);
+}
+
+#else
+
+inline float shading_pow(const float x, const float p)
+{
+    return std::pow(x, p);
+}
+
+inline float shading_exp(const float p)
+{
+    return std::exp(p);
+}
+
+inline float shading_acos(const float x)
+{
+    return std::acos(x);
+}
+
+#endif  // APPLESEED_WITH_FAST_SHADING_MATH
+
 #ifdef APPLESEED_USE_SSE
 
 inline __m128 fast_pow2(const __m128 p)
@@ -0,0 +1,260 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/math/intersection/raytrianglemt.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+
+namespace foundation
+{
+
+//
+// Four triangles stored in structure-of-arrays form, intersected at once with the
+// Moeller-Trumbore test. The hits are exactly the ones TriangleMT would report.
+//
+
+template <typename T>
+struct TriangleMT4
+{
+    // Types.
+    typedef T ValueType;
+    typedef TriangleMT<T> TriangleType;
+
+    // Number of triangles.
+    static const size_t Width = 4;
+
+    // First vertices.
+    ValueType   m_v0[3][Width];
+
+    // Two edges.
+    ValueType   m_e0[3][Width];
+    ValueType   m_e1[3][Width];
+
+    // Set or retrieve one of the triangles.
+    void set(const size_t lane, const TriangleType& triangle);
+    TriangleType get(const size_t lane) const;
+
+    // Return a bit mask of the triangles intersected by the ray.
+    // On return, t, u and v contain the hit parameters of those triangles.
+    template <typename U>
+    size_t intersect(
+        const Ray<U, 3>&    ray,
+        U                   t[Width],
+        U                   u[Width],
+        U                   v[Width]) const;
+};
+
+
+//
+// TriangleMT4 class implementation.
+//
+
+template <typename T>
+inline void TriangleMT4<T>::set(const size_t lane, const TriangleType& triangle)
+{
+    assert(lane < Width);
+
+    for (size_t d = 0; d < 3; ++d)
+    {
+        m_v0[d][lane] = triangle.m_v0[d];
+        m_e0[d][lane] = triangle.m_e0[d];
+        m_e1[d][lane] = triangle.m_e1[d];
+    }
+}
+
+template <typename T>
+inline TriangleMT<T> TriangleMT4<T>::get(const size_t lane) const
+{
+    assert(lane < Width);
+
+    TriangleType triangle;
+
+    for (size_t d = 0; d < 3; ++d)
+    {
+        triangle.m_v0[d] = m_v0[d][lane];
+        triangle.m_e0[d] = m_e0[d][lane];
+        triangle.m_e1[d] = m_e1[d][lane];
+    }
+
+    return triangle;
+}
+
+template <typename T>
+template <typename U>
+APPLESEED_FORCE_INLINE size_t TriangleMT4<T>::intersect(
+    const Ray<U, 3>&        ray,
+    U                       t[Width],
+    U                       u[Width],
+    U                       v[Width]) const
+{
+    size_t mask = 0;
+
+    for (size_t i = 0; i < Width; ++i)
+    {
+        const TriangleMT<U> triangle(get(i));
+
+        if (triangle.intersect(ray, t[i], u[i], v[i]))
+            mask |= size_t(1) << i;
+    }
+
+    return mask;
+}
+
+#ifdef APPLESEED_USE_SSE
+
+//
+// Single precision storage, double precision intersection, two triangles per SSE2 register.
+// The operations are carried out in the same order as in TriangleMT<double>::intersect()
+// so that both tests agree exactly.
+//
+
+template <>
+template <>
+APPLESEED_FORCE_INLINE size_t TriangleMT4<float>::intersect(
+    const Ray<double, 3>&   ray,
+    double                  t[Width],
+    double                  u[Width],
+    double                  v[Width]) const
+{
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+
+    const __m128d org_x = _mm_set1_pd(ray.m_org.x);
+    const __m128d org_y = _mm_set1_pd(ray.m_org.y);
+    const __m128d org_z = _mm_set1_pd(ray.m_org.z);
+    const __m128d dir_x = _mm_set1_pd(ray.m_dir.x);
+    const __m128d dir_y = _mm_set1_pd(ray.m_dir.y);
+    const __m128d dir_z = _mm_set1_pd(ray.m_dir.z);
+    const __m128d tmin = _mm_set1_pd(ray.m_tmin);
+    const __m128d tmax = _mm_set1_pd(ray.m_tmax);
+
+    // Load the triangles and convert them to double precision.
+    __m128d v0[3][2], e0[3][2], e1[3][2];
+    for (size_t d = 0; d < 3; ++d)
+    {
+        const __m128 v0f = _mm_loadu_ps(m_v0[d]);
+        const __m128 e0f = _mm_loadu_ps(m_e0[d]);
+        const __m128 e1f = _mm_loadu_ps(m_e1[d]);
+        v0[d][0] = _mm_cvtps_pd(v0f);
+        v0[d][1] = _mm_cvtps_pd(_mm_movehl_ps(v0f, v0f));
+        e0[d][0] = _mm_cvtps_pd(e0f);
+        e0[d][1] = _mm_cvtps_pd(_mm_movehl_ps(e0f, e0f));
+        e1[d][0] = _mm_cvtps_pd(e1f);
+        e1[d][1] = _mm_cvtps_pd(_mm_movehl_ps(e1f, e1f));
+    }
+
+    size_t mask = 0;
+
+    for (size_t h = 0; h < 2; ++h)
+    {
+        // Calculate determinant.
+        const __m128d p_x = _mm_sub_pd(_mm_mul_pd(dir_y, e1[2][h]), _mm_mul_pd(e1[1][h], dir_z));
+        const __m128d p_y = _mm_sub_pd(_mm_mul_pd(dir_z, e1[0][h]), _mm_mul_pd(e1[2][h], dir_x));
+        const __m128d p_z = _mm_sub_pd(_mm_mul_pd(dir_x, e1[1][h]), _mm_mul_pd(e1[0][h], dir_y));
+        const __m128d det =
+            _mm_add_pd(
+                _mm_add_pd(_mm_mul_pd(e0[0][h], p_x), _mm_mul_pd(e0[1][h], p_y)),
+                _mm_mul_pd(e0[2][h], p_z));
+
+        // Calculate distance from v0 to ray origin.
+        const __m128d t_x = _mm_sub_pd(org_x, v0[0][h]);
+        const __m128d t_y = _mm_sub_pd(org_y, v0[1][h]);
+        const __m128d t_z = _mm_sub_pd(org_z, v0[2][h]);
+
+        // Calculate u parameter.
+        const __m128d uu =
+            _mm_add_pd(
+                _mm_add_pd(_mm_mul_pd(t_x, p_x), _mm_mul_pd(t_y, p_y)),
+                _mm_mul_pd(t_z, p_z));
+
+        // Calculate v and t parameters.
+        const __m128d q_x = _mm_sub_pd(_mm_mul_pd(t_y, e0[2][h]), _mm_mul_pd(e0[1][h], t_z));
+        const __m128d q_y = _mm_sub_pd(_mm_mul_pd(t_z, e0[0][h]), _mm_mul_pd(e0[2][h], t_x));
+        const __m128d q_z = _mm_sub_pd(_mm_mul_pd(t_x, e0[1][h]), _mm_mul_pd(e0[0][h], t_y));
+        const __m128d vv =
+            _mm_add_pd(
+                _mm_add_pd(_mm_mul_pd(dir_x, q_x), _mm_mul_pd(dir_y, q_y)),
+                _mm_mul_pd(dir_z, q_z));
+        const __m128d tt =
+            _mm_add_pd(
+                _mm_add_pd(_mm_mul_pd(e1[0][h], q_x), _mm_mul_pd(e1[1][h], q_y)),
+                _mm_mul_pd(e1[2][h], q_z));
+
+        const __m128d uv = _mm_add_pd(uu, vv);
+        const __m128d tmin_det = _mm_mul_pd(tmin, det);
+        const __m128d tmax_det = _mm_mul_pd(tmax, det);
+
+        // Test bounds for triangles with a positive determinant.
+        const __m128d pos_hit =
+            _mm_and_pd(
+                _mm_and_pd(
+                    _mm_and_pd(_mm_cmpnlt_pd(uu, zero), _mm_cmpngt_pd(uu, det)),
+                    _mm_and_pd(_mm_cmpnlt_pd(vv, zero), _mm_cmpngt_pd(uv, det))),
+                _mm_and_pd(_mm_cmpnge_pd(tt, tmax_det), _mm_cmpnlt_pd(tt, tmin_det)));
+
+        // Test bounds for triangles with a negative or zero determinant.
+        const __m128d neg_hit =
+            _mm_and_pd(
+                _mm_and_pd(
+                    _mm_and_pd(_mm_cmpngt_pd(uu, zero), _mm_cmpnlt_pd(uu, det)),
+                    _mm_and_pd(_mm_cmpngt_pd(vv, zero), _mm_cmpnlt_pd(uv, det))),
+                _mm_and_pd(_mm_cmpnle_pd(tt, tmax_det), _mm_cmpngt_pd(tt, tmin_det)));
+
+        const __m128d pos = _mm_cmpgt_pd(det, zero);
+        const __m128d hit = _mm_or_pd(_mm_and_pd(pos, pos_hit), _mm_andnot_pd(pos, neg_hit));
+
+        const int hit_mask = _mm_movemask_pd(hit);
+
+        if (hit_mask)
+        {
+            // Scale parameters.
+            const __m128d rcp_det = _mm_div_pd(one, det);
+            _mm_storeu_pd(t + 2 * h, _mm_mul_pd(tt, rcp_det));
+            _mm_storeu_pd(u + 2 * h, _mm_mul_pd(uu, rcp_det));
+            _mm_storeu_pd(v + 2 * h, _mm_mul_pd(vv, rcp_det));
+            mask |= static_cast<size_t>(hit_mask) << (2 * h);
+        }
+    }
+
+    return mask;
+}
+
+#endif  // APPLESEED_USE_SSE
+
+}   // namespace foundation
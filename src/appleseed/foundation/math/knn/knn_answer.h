@@ -73,6 +73,8 @@ class Answer
 
     size_t size() const;
 
+    size_t max_size() const;
+
     void clear();
 
     void array_insert(
@@ -150,6 +152,12 @@ inline size_t Answer<T>::size() const
     return m_size;
 }
 
+template <typename T>
+inline size_t Answer<T>::max_size() const
+{
+    return m_max_size;
+}
+
 template <typename T>
 inline void Answer<T>::clear()
 {
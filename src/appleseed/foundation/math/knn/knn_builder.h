@@ -37,8 +37,12 @@
 #include "foundation/math/permutation.h"
 #include "foundation/math/split.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/thread.h"
 #include "foundation/utility/stopwatch.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
@@ -60,8 +64,12 @@ class Builder
     typedef Vector<T, N> VectorType;
     typedef Tree<T, N> TreeType;
 
-    // Constructor.
-    explicit Builder(TreeType& tree);
+    // Constructor. With more than one thread, the subtrees below the top levels of
+    // the tree are built concurrently; the resulting tree only differs from the one
+    // built on a single thread in the order in which nodes are stored.
+    explicit Builder(
+        TreeType&                   tree,
+        const size_t                thread_count = 1);
 
     // Build a tree for a given set of points.
     template <typename Timer>
@@ -81,6 +89,7 @@ class Builder
     typedef typename TreeType::NodeType NodeType;
     typedef AABB<T, N> BboxType;
     typedef Split<T> SplitType;
+    typedef std::vector<NodeType> NodeVector;
 
     struct PartitionPredicate
     {
@@ -97,10 +106,39 @@ class Builder
             const size_t            index) const;
     };
 
-    TreeType&   m_tree;
-    double      m_build_time;
+    struct Subtree
+    {
+        size_t                      m_node_index;       // index in the tree of the root of the subtree
+        size_t                      m_begin;
+        size_t                      m_end;
+        NodeVector                  m_nodes;            // nodes of the subtree, root first
+    };
+
+    TreeType&                       m_tree;
+    const size_t                    m_thread_count;
+    double                          m_build_time;
+
+    // Build the tree and reorder the points on multiple threads.
+    void build_parallel(
+        std::vector<VectorType>&    temp);
+
+    // Subdivide the top levels of the tree, collecting the subtrees to build concurrently.
+    void partition_top(
+        const size_t                parent_node_index,
+        const size_t                begin,
+        const size_t                end,
+        const size_t                max_subtree_size,
+        std::vector<Subtree>&       subtrees) const;
+
+    // Split a node if it holds more than one point, return the pivot or 'end'.
+    size_t split_node(
+        NodeVector&                 nodes,
+        const size_t                parent_node_index,
+        const size_t                begin,
+        const size_t                end) const;
 
     void partition(
+        NodeVector&                 nodes,
         const size_t                parent_node_index,
         const size_t                begin,
         const size_t                end) const;
@@ -121,8 +159,11 @@ typedef Builder<double, 3> Builder3d;
 //
 
 template <typename T, size_t N>
-inline Builder<T, N>::Builder(TreeType& tree)
+inline Builder<T, N>::Builder(
+    TreeType&                   tree,
+    const size_t                thread_count)
   : m_tree(tree)
+  , m_thread_count(std::max<size_t>(thread_count, 1))
   , m_build_time(0.0)
 {
 }
@@ -167,17 +208,29 @@ void Builder<T, N>::build_move_points(
     m_tree.m_nodes.reserve(count * 2 + 1);
     m_tree.m_nodes.push_back(NodeType());
 
-    partition(0, 0, count);
+    // Below this number of points, threads would cost more than they save.
+    const size_t MinParallelPointCount = 16384;
 
-    if (count > 0)
+    if (m_thread_count > 1 && count >= MinParallelPointCount)
     {
         std::vector<VectorType> temp(count);
-
-        small_item_reorder(
-            &m_tree.m_points[0],
-            &temp[0],
-            &m_tree.m_indices[0],
-            count);
+        build_parallel(temp);
+        m_tree.m_points.swap(temp);
+    }
+    else
+    {
+        partition(m_tree.m_nodes, 0, 0, count);
+
+        if (count > 0)
+        {
+            std::vector<VectorType> temp(count);
+
+            small_item_reorder(
+                &m_tree.m_points[0],
+                &temp[0],
+                &m_tree.m_indices[0],
+                count);
+        }
     }
 
     stopwatch.measure();
@@ -207,8 +260,120 @@ inline bool Builder<T, N>::PartitionPredicate::operator()(
     return m_points[index][m_split.m_dimension] < m_split.m_abscissa;
 }
 
+template <typename T, size_t N>
+void Builder<T, N>::build_parallel(
+    std::vector<VectorType>&    temp)
+{
+    const size_t count = m_tree.m_points.size();
+
+    // Aim for several subtrees per thread to balance the load.
+    const size_t MinSubtreeSize = 4096;
+    const size_t max_subtree_size = std::max(count / (8 * m_thread_count), MinSubtreeSize);
+
+    // Build the top of the tree on the calling thread.
+    std::vector<Subtree> subtrees;
+    partition_top(0, 0, count, max_subtree_size, subtrees);
+
+    // Subtrees span disjoint ranges of points: build them concurrently, and gather
+    // their points in tree order at the same time.
+    boost::atomic<size_t> next_subtree(0);
+
+    const auto worker = [&]()
+    {
+        while (true)
+        {
+            const size_t i = next_subtree++;
+            if (i >= subtrees.size())
+                break;
+
+            Subtree& subtree = subtrees[i];
+            subtree.m_nodes.reserve((subtree.m_end - subtree.m_begin) * 2 + 1);
+            subtree.m_nodes.push_back(NodeType());
+            partition(subtree.m_nodes, 0, subtree.m_begin, subtree.m_end);
+
+            for (size_t j = subtree.m_begin; j < subtree.m_end; ++j)
+                temp[j] = m_tree.m_points[m_tree.m_indices[j]];
+        }
+    };
+
+    const size_t thread_count = std::min(m_thread_count, subtrees.size());
+
+    boost::thread_group threads;
+    for (size_t i = 1; i < thread_count; ++i)
+        threads.create_thread(worker);
+
+    worker();
+
+    threads.join_all();
+
+    // Append the subtrees to the tree, in a deterministic order. The root of each
+    // subtree replaces its placeholder node, its other nodes are appended.
+    for (size_t i = 0, e = subtrees.size(); i < e; ++i)
+    {
+        const Subtree& subtree = subtrees[i];
+        const size_t base = m_tree.m_nodes.size() - 1;
+
+        for (size_t j = 0, f = subtree.m_nodes.size(); j < f; ++j)
+        {
+            NodeType node = subtree.m_nodes[j];
+
+            if (node.is_interior())
+                node.set_child_node_index(base + node.get_child_node_index());
+
+            if (j == 0)
+                m_tree.m_nodes[subtree.m_node_index] = node;
+            else m_tree.m_nodes.push_back(node);
+        }
+    }
+}
+
+template <typename T, size_t N>
+void Builder<T, N>::partition_top(
+    const size_t                parent_node_index,
+    const size_t                begin,
+    const size_t                end,
+    const size_t                max_subtree_size,
+    std::vector<Subtree>&       subtrees) const
+{
+    if (end - begin <= max_subtree_size)
+    {
+        // Defer the construction of this subtree.
+        subtrees.push_back(Subtree());
+        Subtree& subtree = subtrees.back();
+        subtree.m_node_index = parent_node_index;
+        subtree.m_begin = begin;
+        subtree.m_end = end;
+        return;
+    }
+
+    const size_t pivot = split_node(m_tree.m_nodes, parent_node_index, begin, end);
+    assert(pivot < end);
+
+    const size_t left_node_index = m_tree.m_nodes[parent_node_index].get_child_node_index();
+    partition_top(left_node_index, begin, pivot, max_subtree_size, subtrees);
+    partition_top(left_node_index + 1, pivot, end, max_subtree_size, subtrees);
+}
+
 template <typename T, size_t N>
 void Builder<T, N>::partition(
+    NodeVector&                 nodes,
+    const size_t                parent_node_index,
+    const size_t                begin,
+    const size_t                end) const
+{
+    const size_t pivot = split_node(nodes, parent_node_index, begin, end);
+
+    if (pivot < end)
+    {
+        const size_t left_node_index = nodes[parent_node_index].get_child_node_index();
+        partition(nodes, left_node_index, begin, pivot);
+        partition(nodes, left_node_index + 1, pivot, end);
+    }
+}
+
+template <typename T, size_t N>
+size_t Builder<T, N>::split_node(
+    NodeVector&                 nodes,
     const size_t                parent_node_index,
     const size_t                begin,
     const size_t                end) const
@@ -217,10 +382,12 @@ void Builder<T, N>::partition(
 
     if (count <= 1)
     {
-        NodeType& parent_node = m_tree.m_nodes[parent_node_index];
+        NodeType& parent_node = nodes[parent_node_index];
         parent_node.make_leaf();
         parent_node.set_point_index(begin);
         parent_node.set_point_count(count);
+
+        return end;
     }
     else
     {
@@ -244,13 +411,12 @@ void Builder<T, N>::partition(
         if (pivot == begin || pivot == end)
             pivot = (begin + end) / 2;
 
-        const size_t left_node_index = m_tree.m_nodes.size();
-        const size_t right_node_index = left_node_index + 1;
+        const size_t left_node_index = nodes.size();
 
-        m_tree.m_nodes.push_back(NodeType());
-        m_tree.m_nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
+        nodes.push_back(NodeType());
 
-        NodeType& parent_node = m_tree.m_nodes[parent_node_index];
+        NodeType& parent_node = nodes[parent_node_index];
         parent_node.make_interior();
         parent_node.set_split_dim(split.m_dimension);
         parent_node.set_split_abs(split.m_abscissa);
@@ -258,8 +424,7 @@ void Builder<T, N>::partition(
         parent_node.set_point_index(begin);
         parent_node.set_point_count(count);
 
-        partition(left_node_index, begin, pivot);
-        partition(right_node_index, pivot, end);
+        return pivot;
     }
 }
 
@@ -40,9 +40,12 @@
 #include "foundation/platform/compiler.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <limits>
+#include <utility>
+#include <vector>
 
 // Enable or disable k-nn query statistics.
 #undef FOUNDATION_KNN_ENABLE_QUERY_STATS
@@ -90,6 +93,17 @@ class Query
         const ValueType     query_max_square_distance) const;
 #endif
 
+    // Run one query per point of a batch. Query points are processed in the order
+    // of the tree leaves that contain them, so that consecutive queries touch the
+    // same nodes and points. visitor(i, answer) is called once the answer for
+    // query_points[i] is available; the answer is only valid during the call.
+    template <typename Visitor>
+    void run_batch(
+        const VectorType    query_points[],
+        const size_t        query_count,
+        const ValueType     query_max_square_distance,
+        Visitor&            visitor) const;
+
   private:
     typedef typename TreeType::NodeType NodeType;
 
@@ -119,6 +133,9 @@ class Query
 
     const TreeType&         m_tree;
     AnswerType&             m_answer;
+
+    // Return the index of the first point of the leaf containing a given point.
+    size_t find_leaf_point_index(const VectorType& point) const;
 };
 
 typedef Query<float, 2>  Query2f;
@@ -454,7 +471,10 @@ inline void Query<T, N>::run(
                     m_answer.array_insert(point_index, square_dist);
 
                     if (m_answer.m_size == max_answer_size)
+                    {
                         m_answer.make_heap();
+                        max_square_dist = m_answer.top().m_square_dist;
+                    }
                 }
             }
 
@@ -469,6 +489,56 @@ inline void Query<T, N>::run(
     FOUNDATION_KNN_QUERY_STATS(stats.m_tested_points.insert(tested_point_count));
 }
 
+template <typename T, size_t N>
+template <typename Visitor>
+void Query<T, N>::run_batch(
+    const VectorType        query_points[],
+    const size_t            query_count,
+    const ValueType         query_max_square_distance,
+    Visitor&                visitor) const
+{
+    if (query_count == 0)
+        return;
+
+    assert(query_points);
+
+    std::vector<std::pair<size_t, size_t>> order(query_count);
+
+    for (size_t i = 0; i < query_count; ++i)
+        order[i] = std::make_pair(find_leaf_point_index(query_points[i]), i);
+
+    std::sort(order.begin(), order.end());
+
+    for (size_t i = 0; i < query_count; ++i)
+    {
+        const size_t query_index = order[i].second;
+        run(query_points[query_index], query_max_square_distance);
+        visitor(query_index, m_answer);
+    }
+}
+
+template <typename T, size_t N>
+inline size_t Query<T, N>::find_leaf_point_index(const VectorType& point) const
+{
+    assert(!m_tree.empty());
+
+    const NodeType* nodes = &m_tree.m_nodes.front();
+    const NodeType* node = nodes;
+
+    while (node->is_interior())
+    {
+        const NodeType* child_node = nodes + node->get_child_node_index();
+
+        // Points on the split plane belong to the right child node.
+        if (point[node->get_split_dim()] >= node->get_split_abs())
+            ++child_node;
+
+        node = child_node;
+    }
+
+    return node->get_point_index();
+}
+
 #ifdef FOUNDATION_KNN_ENABLE_QUERY_STATS
 
 template <typename T, size_t N>
@@ -30,6 +30,7 @@
 #include "microfacet.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/fastmath.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/specialfunctions.h"
 
@@ -98,6 +99,60 @@ namespace
         return sqrt(cos_phi_2_ax_2 + sin_phi_2_ay_2);
     }
 
+    // Direction-dependent terms shared by all GGX lobes of a batch.
+    struct GGXDirectionTerms
+    {
+        float   m_tan_theta_2;      // zero when the direction is tangent to the surface
+        float   m_cos_phi_2;
+        float   m_sin_phi_2;
+    };
+
+    GGXDirectionTerms compute_ggx_direction_terms(const Vector3f& v)
+    {
+        GGXDirectionTerms terms;
+
+        const float cos_theta_2 = square(v.y);
+
+        if (cos_theta_2 == 0.0f)
+        {
+            terms.m_tan_theta_2 = 0.0f;
+            terms.m_cos_phi_2 = 1.0f;
+            terms.m_sin_phi_2 = 0.0f;
+            return terms;
+        }
+
+        const float sin_theta_2 = max(0.0f, 1.0f - cos_theta_2);
+        terms.m_tan_theta_2 = sin_theta_2 / cos_theta_2;
+
+        if (sin_theta_2 == 0.0f)
+        {
+            terms.m_cos_phi_2 = 1.0f;
+            terms.m_sin_phi_2 = 0.0f;
+        }
+        else
+        {
+            const float rcp_sin_theta = 1.0f / sqrt(sin_theta_2);
+            terms.m_cos_phi_2 = square(v.x * rcp_sin_theta);
+            terms.m_sin_phi_2 = square(v.z * rcp_sin_theta);
+        }
+
+        return terms;
+    }
+
+    inline float ggx_lambda(
+        const GGXDirectionTerms&    terms,
+        const bool                  isotropic,
+        const float                 alpha_x_2,
+        const float                 alpha_y_2)
+    {
+        const float alpha_2 =
+            isotropic
+                ? alpha_x_2
+                : terms.m_cos_phi_2 * alpha_x_2 + terms.m_sin_phi_2 * alpha_y_2;
+
+        return (-1.0f + sqrt(1.0f + alpha_2 * terms.m_tan_theta_2)) * 0.5f;
+    }
+
     template <typename MDF>
     float pdf_visible_normals(
         const Vector3f&     v,
@@ -130,7 +185,7 @@ float BlinnMDF::D(
     const float         alpha_y,
     const float         gamma)
 {
-    return (alpha_x + 2.0f) * RcpTwoPi<float>() * pow(abs(m.y), alpha_x);
+    return (alpha_x + 2.0f) * RcpTwoPi<float>() * shading_pow(abs(m.y), alpha_x);
 }
 
 float BlinnMDF::G(
@@ -213,7 +268,7 @@ float BeckmannMDF::D(
             alpha_x,
             alpha_y);
 
-    return exp(-tan_theta_2 * A) / (Pi<float>() * alpha_x * alpha_y * cos_theta_4);
+    return shading_exp(-tan_theta_2 * A) / (Pi<float>() * alpha_x * alpha_y * cos_theta_4);
 }
 
 float BeckmannMDF::G(
@@ -292,14 +347,22 @@ Vector3f BeckmannMDF::sample(
     stretched = normalize(stretched);
 
     const float cos_theta = stretched[1];
-    const float phi =
-        stretched[1] < 0.99999f ? atan2(stretched[2], stretched[0]) : 0.0f;
+
+    // Compute the azimuth of the stretched direction directly from its
+    // components rather than going through atan2(), cos() and sin().
+    float cos_phi = 1.0f;
+    float sin_phi = 0.0f;
+    if (cos_theta < 0.99999f)
+    {
+        const float rcp_sin_theta =
+            1.0f / sqrt(square(stretched[0]) + square(stretched[2]));
+        cos_phi = stretched[0] * rcp_sin_theta;
+        sin_phi = stretched[2] * rcp_sin_theta;
+    }
 
     Vector2f slope = sample_slope(cos_theta, s, gamma);
 
     // Rotate.
-    const float cos_phi = cos(phi);
-    const float sin_phi = sin(phi);
     slope = Vector2f(
         cos_phi * slope[0] - sin_phi * slope[1],
         sin_phi * slope[0] + cos_phi * slope[1]);
@@ -461,6 +524,54 @@ float GGXMDF::lambda(
     return (-1.0f + sqrt(1.0f + a2_rcp)) * 0.5f;
 }
 
+void GGXMDF::evaluate_lobes(
+    const Vector3f&     wi,
+    const Vector3f&     wo,
+    const Vector3f&     m,
+    const size_t        lobe_count,
+    const float*        alpha_x,
+    const float*        alpha_y,
+    float*              D,
+    float*              G,
+    float*              pdf)
+{
+    const GGXDirectionTerms terms_m = compute_ggx_direction_terms(m);
+    const GGXDirectionTerms terms_i = compute_ggx_direction_terms(wi);
+    const GGXDirectionTerms terms_o = compute_ggx_direction_terms(wo);
+
+    const bool m_is_tangent = m.y == 0.0f;
+    const float cos_theta_m_4 = square(square(m.y));
+
+    // pdf(wo, m) = G1(wo, m) * |dot(wo, m)| * D(m) / |cos(wo, n)|.
+    const float pdf_scale = wo.y == 0.0f ? 0.0f : abs(dot(wo, m)) / abs(wo.y);
+
+    for (size_t i = 0; i < lobe_count; ++i)
+    {
+        const float ax = alpha_x[i];
+        const float ay = alpha_y[i];
+        const float ax_2 = square(ax);
+        const float ay_2 = square(ay);
+        const bool isotropic = ax == ay;
+
+        const float A =
+            isotropic
+                ? 1.0f / ax_2
+                : terms_m.m_cos_phi_2 / ax_2 + terms_m.m_sin_phi_2 / ay_2;
+        const float tmp = 1.0f + terms_m.m_tan_theta_2 * A;
+        const float d =
+            m_is_tangent
+                ? ax_2 * RcpPi<float>()
+                : 1.0f / (Pi<float>() * ax * ay * cos_theta_m_4 * square(tmp));
+
+        const float lambda_i = ggx_lambda(terms_i, isotropic, ax_2, ay_2);
+        const float lambda_o = ggx_lambda(terms_o, isotropic, ax_2, ay_2);
+
+        D[i] = d;
+        G[i] = 1.0f / (1.0f + lambda_o + lambda_i);
+        pdf[i] = d * pdf_scale / (1.0f + lambda_o);
+    }
+}
+
 Vector3f GGXMDF::sample(
     const Vector3f&     v,
     const Vector2f&     s,
@@ -542,7 +653,7 @@ float WardMDF::D(
     const float tan_alpha_2 = (1.0f - cos_theta_2) / cos_theta_2;
 
     const float alpha_x2 = square(alpha_x);
-    return exp(-tan_alpha_2 / alpha_x2) / (alpha_x2 * Pi<float>() * cos_theta_3);
+    return shading_exp(-tan_alpha_2 / alpha_x2) / (alpha_x2 * Pi<float>() * cos_theta_3);
 }
 
 float WardMDF::G(
@@ -731,7 +842,7 @@ float StdMDF::D(
 
     // [1] Equation 18.
     const float den = 1.0f + tan_theta_2 * A / (gamma - 1.0f);
-    const float den4 = pow(den, gamma / 4.0f);
+    const float den4 = shading_pow(den, gamma / 4.0f);
     const float den0 = Pi<float>() * den4;
     const float den1 = alpha_x * den4;
     const float den2 = alpha_y * den4;
@@ -793,9 +904,9 @@ float StdMDF::lambda(
     const float cot_theta_a_2 = square(cot_theta_a);
     const float pg1_cot_theta_a_2 = (gamma - 1.0f) + cot_theta_a_2;
     const float frac_a1_sg1 = (gamma - 1.0f) / pg1_cot_theta_a_2;
-    float a1_sg1 = pow(frac_a1_sg1, gamma);
+    float a1_sg1 = shading_pow(frac_a1_sg1, gamma);
     a1_sg1 *= 1.0f / ((2.0f * gamma - 3.0f) * cot_theta_a);
-    a1_sg1 *= pow(pg1_cot_theta_a_2, 3.0f / 2.0f);
+    a1_sg1 *= shading_pow(pg1_cot_theta_a_2, 3.0f / 2.0f);
     const float a2 = sqrt(gamma - 1.0f);
     const float a2_sg2 = a2 * Sg2;
     const float gfrac = gamma_fraction(gamma - 0.5f, gamma) / SqrtPi<float>();
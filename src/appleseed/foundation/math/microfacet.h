@@ -34,6 +34,7 @@
 
 // Standard headers.
 #include <algorithm>
+#include <cstddef>
 
 namespace foundation
 {
@@ -231,6 +232,21 @@ class GGXMDF
         const float         alpha_x,
         const float         alpha_y,
         const float         gamma);
+
+    // Evaluate D(), G() and pdf(wo, m) for a batch of lobes that share the same
+    // directions and only differ by their roughness. Terms that depend only on
+    // the directions are computed once, and the per-lobe loop is branchless so
+    // that it can be vectorized across lobes.
+    static void evaluate_lobes(
+        const Vector3f&     wi,
+        const Vector3f&     wo,
+        const Vector3f&     m,
+        const size_t        lobe_count,
+        const float*        alpha_x,
+        const float*        alpha_y,
+        float*              D,
+        float*              G,
+        float*              pdf);
 };
 
 
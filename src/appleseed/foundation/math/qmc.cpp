@@ -297,4 +297,45 @@ const double PrecomputedHaltonSequence[4 * PrecomputedHaltonSequenceSize] =
     0.9960937500000000, 0.1495198902606310, 0.0432000000000000, 0.4635568513119533
 };
 
+
+//
+// Generator matrices of the first SobolDimensionCount dimensions of the Sobol sequence.
+//
+
+const uint32 SobolMatrices[32 * SobolDimensionCount] =
+{
+    0x80000000u, 0x80000000u, 0x80000000u, 0x80000000u, 0x80000000u, 0x80000000u, 0x80000000u, 0x80000000u,
+    0x40000000u, 0xC0000000u, 0xC0000000u, 0xC0000000u, 0x40000000u, 0x40000000u, 0xC0000000u, 0x40000000u,
+    0x20000000u, 0xA0000000u, 0x60000000u, 0x20000000u, 0x20000000u, 0x60000000u, 0xA0000000u, 0xA0000000u,
+    0x10000000u, 0xF0000000u, 0x90000000u, 0x50000000u, 0xB0000000u, 0x30000000u, 0xD0000000u, 0x50000000u,
+    0x08000000u, 0x88000000u, 0xE8000000u, 0xF8000000u, 0xF8000000u, 0xC8000000u, 0x58000000u, 0x88000000u,
+    0x04000000u, 0xCC000000u, 0x5C000000u, 0x74000000u, 0xDC000000u, 0x24000000u, 0x94000000u, 0x24000000u,
+    0x02000000u, 0xAA000000u, 0x8E000000u, 0xA2000000u, 0x7A000000u, 0x56000000u, 0x3E000000u, 0x12000000u,
+    0x01000000u, 0xFF000000u, 0xC5000000u, 0x93000000u, 0x9D000000u, 0xFB000000u, 0xE3000000u, 0x2D000000u,
+    0x00800000u, 0x80800000u, 0x68800000u, 0xD8800000u, 0x5A800000u, 0xE0800000u, 0xBE800000u, 0x76800000u,
+    0x00400000u, 0xC0C00000u, 0x9CC00000u, 0x25400000u, 0x2FC00000u, 0x70400000u, 0x23C00000u, 0x9E400000u,
+    0x00200000u, 0xA0A00000u, 0xEE600000u, 0x59E00000u, 0xA1600000u, 0xA8600000u, 0x1E200000u, 0x08200000u,
+    0x00100000u, 0xF0F00000u, 0x55900000u, 0xE6D00000u, 0xF0B00000u, 0x14300000u, 0xF3100000u, 0x64100000u,
+    0x00080000u, 0x88880000u, 0x80680000u, 0x78080000u, 0xDA880000u, 0x9EC80000u, 0x46780000u, 0xB2280000u,
+    0x00040000u, 0xCCCC0000u, 0xC09C0000u, 0xB40C0000u, 0x6FC40000u, 0xDF240000u, 0x67840000u, 0x7D140000u,
+    0x00020000u, 0xAAAA0000u, 0x60EE0000u, 0x82020000u, 0x81620000u, 0xB6D60000u, 0x78460000u, 0xFEA20000u,
+    0x00010000u, 0xFFFF0000u, 0x90550000u, 0xC3050000u, 0x40BB0000u, 0x8BBB0000u, 0x84670000u, 0xBA490000u,
+    0x00008000u, 0x80008000u, 0xE8808000u, 0x208F8000u, 0x22878000u, 0x48008000u, 0xC6788000u, 0x1A248000u,
+    0x00004000u, 0xC000C000u, 0x5CC0C000u, 0x51474000u, 0xB3C9C000u, 0x64004000u, 0xA784C000u, 0x491B4000u,
+    0x00002000u, 0xA000A000u, 0x8E606000u, 0xFBEA2000u, 0xFB65A000u, 0x36006000u, 0xD846A000u, 0xC4B5A000u,
+    0x00001000u, 0xF000F000u, 0xC5909000u, 0x75D93000u, 0xDDB2D000u, 0xCB003000u, 0x5467D000u, 0xE3739000u,
+    0x00000800u, 0x88008800u, 0x6868E800u, 0xA0858800u, 0x78022800u, 0x2880C800u, 0x9E78D800u, 0xF6800800u,
+    0x00000400u, 0xCC00CC00u, 0x9C9C5C00u, 0x914E5400u, 0x9C0B3C00u, 0x54402400u, 0x33845400u, 0xDE400400u,
+    0x00000200u, 0xAA00AA00u, 0xEEEE8E00u, 0xDBE79E00u, 0x5A0FB600u, 0xFE605600u, 0xE6469E00u, 0xA8200A00u,
+    0x00000100u, 0xFF00FF00u, 0x5555C500u, 0x25DB6D00u, 0x2D0DDB00u, 0xEF30FB00u, 0xB7673300u, 0x34100500u,
+    0x00000080u, 0x80808080u, 0x8000E880u, 0x58800080u, 0xA2878080u, 0x7E48E080u, 0x20F86680u, 0x3A280880u,
+    0x00000040u, 0xC0C0C0C0u, 0xC0005CC0u, 0xE54000C0u, 0xF3C9C040u, 0xAF647040u, 0x104477C0u, 0x59140240u,
+    0x00000020u, 0xA0A0A0A0u, 0x60008E60u, 0x79E00020u, 0xDB65A020u, 0x1EB6A860u, 0xF8668020u, 0xECA20120u,
+    0x00000010u, 0xF0F0F0F0u, 0x9000C590u, 0xB6D00050u, 0x6DB2D0B0u, 0x9F8B1430u, 0x4477C010u, 0x974902D0u,
+    0x00000008u, 0x88888888u, 0xE8006868u, 0x800800F8u, 0x800228F8u, 0xD6C81EC8u, 0x668020F8u, 0x6CA48768u,
+    0x00000004u, 0xCCCCCCCCu, 0x5C009C9Cu, 0xC00C0074u, 0x400B3CDCu, 0xBB249F24u, 0x77C01044u, 0xD75B49E4u,
+    0x00000002u, 0xAAAAAAAAu, 0x8E00EEEEu, 0x200200A2u, 0x200FB67Au, 0x80D6D6D6u, 0x8020F866u, 0xCC95A082u,
+    0x00000001u, 0xFFFFFFFFu, 0xC5005555u, 0x50050093u, 0xB00DDB9Du, 0x40BBBBBBu, 0xC0104477u, 0x87639641u
+};
+
 }   // namespace foundation
@@ -30,6 +30,7 @@
 #pragma once
 
 // appleseed.foundation headers.
+#include "foundation/math/hash.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/arch.h"
 #include "foundation/platform/types.h"
@@ -52,7 +53,6 @@ namespace foundation
 //   implement specializations of Halton and Hammersley sequences generators for bases (2,3).
 //   implement incremental radical inverse (for successive input values).
 //   implement vectorized radical inverse functions with SSE2.
-//   implement Sobol sequence generator.
 //
 
 
@@ -199,6 +199,57 @@ Vector<T, Dim> hammersley_zaremba_sequence(
     const size_t        i);             // sample number
 
 
+//
+// Owen-scrambled Sobol sequences.
+//
+// The generator matrices are precomputed for the first SobolDimensionCount dimensions
+// from the Joe-Kuo direction numbers. Owen scrambling is implemented with the hash-based
+// nested uniform scrambling of Laine and Karras, as described by Burley.
+//
+// All return values are in the interval [0, 1).
+//
+// References:
+//
+//   Joe and Kuo, Constructing Sobol Sequences with Better Two-Dimensional Projections
+//   http://web.maths.unsw.edu.au/~fkuo/sobol/joe-kuo-notes.pdf
+//
+//   Burley, Practical Hash-based Owen Scrambling
+//   http://www.jcgt.org/published/0009/04/01/
+//
+
+const size_t SobolDimensionCount = 8;
+
+// Generator matrices, stored bit-major (entry [bit * SobolDimensionCount + dimension])
+// so that all dimensions of a sample are generated in a single, vectorizable pass.
+extern const uint32 SobolMatrices[32 * SobolDimensionCount];
+
+// Return one dimension of the i'th sample of the Sobol sequence, in 0.32 fixed point.
+uint32 sobol_uint32(
+    const size_t        dimension,      // dimension, in [0, SobolDimensionCount)
+    uint32              i);             // sample number
+
+// Owen-scramble a value in 0.32 fixed point.
+uint32 owen_scramble_uint32(
+    uint32              value,          // value to scramble
+    const uint32        seed);          // scrambling seed
+
+// Return one dimension of the i'th sample of an Owen-scrambled Sobol sequence.
+template <typename T>
+T owen_scrambled_sobol(
+    const size_t        dimension,      // dimension, in [0, SobolDimensionCount)
+    const uint32        i,              // sample number
+    const uint32        seed);          // scrambling seed
+
+// Return the first dim_count dimensions of the i'th sample of an Owen-scrambled
+// Sobol sequence. Produces the same values as owen_scrambled_sobol().
+template <typename T>
+void owen_scrambled_sobol_sequence(
+    const size_t        dim_count,      // number of dimensions, at most SobolDimensionCount
+    const uint32        i,              // sample number
+    const uint32        seed,           // scrambling seed
+    T                   values[]);      // output values (dim_count entries)
+
+
 //
 // Base-2 radical inverse functions implementation.
 //
@@ -2597,4 +2648,125 @@ inline Vector<T, Dim> hammersley_zaremba_sequence(
     return p;
 }
 
+
+//
+// Owen-scrambled Sobol sequences implementation.
+//
+
+namespace impl
+{
+    inline uint32 reverse_bits(uint32 value)
+    {
+        value = (value >> 16) | (value << 16);
+        value = ((value & 0xFF00FF00u) >> 8) | ((value & 0x00FF00FFu) << 8);
+        value = ((value & 0xF0F0F0F0u) >> 4) | ((value & 0x0F0F0F0Fu) << 4);
+        value = ((value & 0xCCCCCCCCu) >> 2) | ((value & 0x33333333u) << 2);
+        value = ((value & 0xAAAAAAAAu) >> 1) | ((value & 0x55555555u) << 1);
+        return value;
+    }
+
+    inline uint32 laine_karras_permutation(uint32 value, const uint32 seed)
+    {
+        value += seed;
+        value ^= value * 0x6C50B47Cu;
+        value ^= value * 0xB82F1E52u;
+        value ^= value * 0xC7AFE638u;
+        value ^= value * 0x8D22F6E6u;
+        return value;
+    }
+
+    inline uint32 sobol_dimension_seed(const uint32 seed, const size_t dimension)
+    {
+        return mix_uint32(seed, static_cast<uint32>(dimension));
+    }
+
+    // Keep only the bits that the target type can represent so that 1.0 is never returned.
+    template <typename T> T fixed_point_to_unit(const uint32 value);
+
+    template <>
+    inline float fixed_point_to_unit<float>(const uint32 value)
+    {
+        return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+    }
+
+    template <>
+    inline double fixed_point_to_unit<double>(const uint32 value)
+    {
+        return static_cast<double>(value) * (1.0 / 4294967296.0);
+    }
+}
+
+inline uint32 sobol_uint32(
+    const size_t        dimension,
+    uint32              i)
+{
+    assert(dimension < SobolDimensionCount);
+
+    uint32 result = 0;
+
+    for (const uint32* m = SobolMatrices + dimension; i != 0; i >>= 1, m += SobolDimensionCount)
+    {
+        if (i & 1)
+            result ^= *m;
+    }
+
+    return result;
+}
+
+inline uint32 owen_scramble_uint32(
+    uint32              value,
+    const uint32        seed)
+{
+    value = impl::reverse_bits(value);
+    value = impl::laine_karras_permutation(value, seed);
+    return impl::reverse_bits(value);
+}
+
+template <typename T>
+inline T owen_scrambled_sobol(
+    const size_t        dimension,
+    const uint32        i,
+    const uint32        seed)
+{
+    // Shuffle the sequence with the same seed in all dimensions, then scramble each dimension.
+    const uint32 shuffled = owen_scramble_uint32(i, seed);
+    const uint32 value = sobol_uint32(dimension, shuffled);
+
+    return
+        impl::fixed_point_to_unit<T>(
+            owen_scramble_uint32(value, impl::sobol_dimension_seed(seed, dimension)));
+}
+
+template <typename T>
+inline void owen_scrambled_sobol_sequence(
+    const size_t        dim_count,
+    const uint32        i,
+    const uint32        seed,
+    T                   values[])
+{
+    assert(dim_count <= SobolDimensionCount);
+
+    uint32 bits[SobolDimensionCount] = { 0 };
+
+    // Walk the set bits of the sample number once, XORing whole rows of the generator
+    // matrices; the inner loop runs over contiguous memory and is vectorized by the compiler.
+    uint32 shuffled = owen_scramble_uint32(i, seed);
+
+    for (const uint32* m = SobolMatrices; shuffled != 0; shuffled >>= 1, m += SobolDimensionCount)
+    {
+        if (shuffled & 1)
+        {
+            for (size_t d = 0; d < SobolDimensionCount; ++d)
+                bits[d] ^= m[d];
+        }
+    }
+
+    for (size_t d = 0; d < dim_count; ++d)
+    {
+        values[d] =
+            impl::fixed_point_to_unit<T>(
+                owen_scramble_uint32(bits[d], impl::sobol_dimension_seed(seed, d)));
+    }
+}
+
 }   // namespace foundation
@@ -0,0 +1,184 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// Ray sorting.
+//
+// Rays are sorted by direction octant first, then by origin along a Morton
+// (Z-order) curve. Tracing rays in this order improves the coherence of
+// acceleration structure traversal and of the subsequent shading.
+//
+// Reference:
+//
+//   Sorted Deferred Shading for Production Path Tracing
+//   Christian Eisenacher, Gregory Nichols, Andrew Selle, Brent Burley
+//   https://www.yiningkarlli.com/projects/hyperion/sorted-deferred-shading.pdf
+//
+
+// Interleave the 10 lower bits of three integers into a 30-bit Morton code.
+uint32 morton_code(
+    const uint32    x,
+    const uint32    y,
+    const uint32    z);
+
+// Return the octant (in [0, 8)) of a direction vector.
+template <typename T>
+size_t direction_octant(const Vector<T, 3>& dir);
+
+// Compute the sort key of a ray, given the bounding box of the ray origins.
+template <typename T>
+uint64 ray_sort_key(
+    const Ray<T, 3>&        ray,
+    const AABB<T, 3>&       origin_bbox);
+
+// Generate the ordering that sorts a set of rays.
+template <typename RayType>
+void ray_sort_ordering(
+    std::vector<size_t>&    ordering,
+    const RayType*          rays,
+    const size_t            ray_count);
+
+
+//
+// Ray sorting implementation.
+//
+
+namespace raysorting_impl
+{
+    // Insert two zero bits between each of the 10 lower bits of x.
+    inline uint32 spread_bits(uint32 x)
+    {
+        x &= 0x000003FFUL;
+        x = (x | (x << 16)) & 0x030000FFUL;
+        x = (x | (x << 8)) & 0x0300F00FUL;
+        x = (x | (x << 4)) & 0x030C30C3UL;
+        x = (x | (x << 2)) & 0x09249249UL;
+        return x;
+    }
+
+    template <typename T>
+    inline uint32 quantize_coordinate(const T x, const T min, const T max)
+    {
+        const T extent = max - min;
+        if (!(extent > T(0.0)))
+            return 0;
+
+        const T q = (x - min) / extent * T(1023.0);
+        return static_cast<uint32>(clamp(q, T(0.0), T(1023.0)));
+    }
+}
+
+inline uint32 morton_code(
+    const uint32    x,
+    const uint32    y,
+    const uint32    z)
+{
+    return
+          (raysorting_impl::spread_bits(x) << 2)
+        | (raysorting_impl::spread_bits(y) << 1)
+        |  raysorting_impl::spread_bits(z);
+}
+
+template <typename T>
+inline size_t direction_octant(const Vector<T, 3>& dir)
+{
+    return
+          (dir[0] < T(0.0) ? 4 : 0)
+        | (dir[1] < T(0.0) ? 2 : 0)
+        | (dir[2] < T(0.0) ? 1 : 0);
+}
+
+template <typename T>
+inline uint64 ray_sort_key(
+    const Ray<T, 3>&        ray,
+    const AABB<T, 3>&       origin_bbox)
+{
+    assert(origin_bbox.is_valid());
+
+    const uint32 code =
+        morton_code(
+            raysorting_impl::quantize_coordinate(ray.m_org[0], origin_bbox.min[0], origin_bbox.max[0]),
+            raysorting_impl::quantize_coordinate(ray.m_org[1], origin_bbox.min[1], origin_bbox.max[1]),
+            raysorting_impl::quantize_coordinate(ray.m_org[2], origin_bbox.min[2], origin_bbox.max[2]));
+
+    return (static_cast<uint64>(direction_octant(ray.m_dir)) << 30) | code;
+}
+
+template <typename RayType>
+void ray_sort_ordering(
+    std::vector<size_t>&    ordering,
+    const RayType*          rays,
+    const size_t            ray_count)
+{
+    typedef typename RayType::ValueType ValueType;
+
+    ordering.resize(ray_count);
+
+    if (ray_count == 0)
+        return;
+
+    AABB<ValueType, 3> origin_bbox;
+    origin_bbox.invalidate();
+    for (size_t i = 0; i < ray_count; ++i)
+        origin_bbox.insert(rays[i].m_org);
+
+    std::vector<uint64> keys(ray_count);
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        keys[i] = ray_sort_key(rays[i], origin_bbox);
+        ordering[i] = i;
+    }
+
+    std::stable_sort(
+        ordering.begin(),
+        ordering.end(),
+        [&keys](const size_t lhs, const size_t rhs)
+        {
+            return keys[lhs] < keys[rhs];
+        });
+}
+
+}   // namespace foundation
@@ -0,0 +1,158 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+namespace foundation
+{
+
+//
+// An adapter that serves the numbers of another random number generator from
+// a buffer refilled in blocks with RNG::fill_uint32(). Useful with generators
+// such as SimdMersenneTwister that produce numbers much faster in bulk.
+//
+// The sequence of numbers is exactly the one of the underlying generator.
+// The buffer is only filled when a number is requested.
+//
+
+template <typename RNG, size_t BufferSize = 32>
+class BufferedRNG
+{
+  public:
+    // Underlying random number generator type.
+    typedef RNG RNGType;
+
+    // Constructors, seed the underlying generator.
+    BufferedRNG();
+    explicit BufferedRNG(const RNG& rng);
+    template <typename A0>
+    explicit BufferedRNG(const A0& a0);
+    template <typename A0, typename A1>
+    BufferedRNG(const A0& a0, const A1& a1);
+
+    // Generate a 32-bit random number.
+    uint32 rand_uint32();
+
+    // Fill an array with 32-bit random numbers.
+    // Produces the same numbers as `count` successive calls to rand_uint32().
+    void fill_uint32(uint32 values[], size_t count);
+
+  private:
+    RNG     m_rng;
+    uint32  m_buffer[BufferSize];
+    size_t  m_index;                // index of the next unused number in m_buffer
+
+    void refill();
+};
+
+
+//
+// BufferedRNG class implementation.
+//
+
+template <typename RNG, size_t BufferSize>
+inline BufferedRNG<RNG, BufferSize>::BufferedRNG()
+  : m_index(BufferSize)
+{
+}
+
+template <typename RNG, size_t BufferSize>
+inline BufferedRNG<RNG, BufferSize>::BufferedRNG(const RNG& rng)
+  : m_rng(rng)
+  , m_index(BufferSize)
+{
+}
+
+template <typename RNG, size_t BufferSize>
+template <typename A0>
+inline BufferedRNG<RNG, BufferSize>::BufferedRNG(const A0& a0)
+  : m_rng(a0)
+  , m_index(BufferSize)
+{
+}
+
+template <typename RNG, size_t BufferSize>
+template <typename A0, typename A1>
+inline BufferedRNG<RNG, BufferSize>::BufferedRNG(const A0& a0, const A1& a1)
+  : m_rng(a0, a1)
+  , m_index(BufferSize)
+{
+}
+
+template <typename RNG, size_t BufferSize>
+inline uint32 BufferedRNG<RNG, BufferSize>::rand_uint32()
+{
+    if (m_index == BufferSize)
+        refill();
+
+    return m_buffer[m_index++];
+}
+
+template <typename RNG, size_t BufferSize>
+inline void BufferedRNG<RNG, BufferSize>::fill_uint32(uint32 values[], size_t count)
+{
+    // Hand out what is left in the buffer first.
+    const size_t available = BufferSize - m_index;
+    const size_t n = count < available ? count : available;
+    std::memcpy(values, m_buffer + m_index, n * sizeof(uint32));
+    m_index += n;
+    values += n;
+    count -= n;
+
+    // Large requests bypass the buffer.
+    if (count >= BufferSize)
+    {
+        m_rng.fill_uint32(values, count);
+        return;
+    }
+
+    if (count > 0)
+    {
+        refill();
+        std::memcpy(values, m_buffer, count * sizeof(uint32));
+        m_index = count;
+    }
+}
+
+template <typename RNG, size_t BufferSize>
+inline void BufferedRNG<RNG, BufferSize>::refill()
+{
+    assert(m_index == BufferSize);
+    m_rng.fill_uint32(m_buffer, BufferSize);
+    m_index = 0;
+}
+
+}   // namespace foundation
@@ -34,6 +34,7 @@
 #include "foundation/platform/types.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <limits>
@@ -93,6 +94,13 @@ template <typename RNG> double rand3(RNG& rng, const double min, const double ma
 // Return a random number in the real interval [0,1) with 53-bit resolution.
 template <typename RNG> double rand_double2_res53(RNG& rng);
 
+// Fill an array with random numbers in the real interval [0,1). The underlying 32-bit
+// numbers are drawn in blocks with RNG::fill_uint32(); the values are the same as those
+// returned by successive calls to rand_float2(), rand_double2() or rand2().
+template <typename RNG> void fill_rand_float2(RNG& rng, float values[], const size_t count);
+template <typename RNG> void fill_rand_double2(RNG& rng, double values[], const size_t count);
+template <typename T, typename RNG> void fill_rand2(RNG& rng, T values[], const size_t count);
+
 
 //
 // Random vectors.
@@ -406,6 +414,60 @@ inline double rand_double2_res53(RNG& rng)
     return result;
 }
 
+template <typename RNG>
+inline void fill_rand_float2(RNG& rng, float values[], const size_t count)
+{
+    const size_t BlockSize = 64;
+    uint32 block[BlockSize];
+
+    for (size_t i = 0; i < count; i += BlockSize)
+    {
+        const size_t n = std::min(BlockSize, count - i);
+        rng.fill_uint32(block, n);
+
+        for (size_t j = 0; j < n; ++j)
+            values[i + j] = block[j] * 2.3283063e-010f;
+    }
+}
+
+template <typename RNG>
+inline void fill_rand_double2(RNG& rng, double values[], const size_t count)
+{
+    const size_t BlockSize = 64;
+    uint32 block[BlockSize];
+
+    for (size_t i = 0; i < count; i += BlockSize)
+    {
+        const size_t n = std::min(BlockSize, count - i);
+        rng.fill_uint32(block, n);
+
+        for (size_t j = 0; j < n; ++j)
+            values[i + j] = block[j] * (1.0 / 4294967296.0);
+    }
+}
+
+template <typename T, typename RNG>
+struct FillRand2Helper;
+
+template <typename RNG>
+struct FillRand2Helper<float, RNG>
+{
+    void operator()(RNG& rng, float values[], const size_t count) { fill_rand_float2(rng, values, count); }
+};
+
+template <typename RNG>
+struct FillRand2Helper<double, RNG>
+{
+    void operator()(RNG& rng, double values[], const size_t count) { fill_rand_double2(rng, values, count); }
+};
+
+template <typename T, typename RNG>
+inline void fill_rand2(RNG& rng, T values[], const size_t count)
+{
+    FillRand2Helper<T, RNG> helper;
+    helper(rng, values, count);
+}
+
 template <typename VectorType, typename RNG>
 inline VectorType rand_vector1(RNG& rng)
 {
@@ -32,6 +32,9 @@
 // appleseed.foundation headers.
 #include "foundation/platform/types.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace foundation
 {
 
@@ -64,6 +67,10 @@ class LCG
     // Generate a 32-bit random number.
     uint32 rand_uint32();
 
+    // Fill an array with 32-bit random numbers.
+    // Produces the same numbers as `count` successive calls to rand_uint32().
+    void fill_uint32(uint32 values[], const size_t count);
+
   private:
     uint32 m_s;
 };
@@ -84,4 +91,10 @@ inline uint32 LCG::rand_uint32()
     return m_s;
 }
 
+inline void LCG::fill_uint32(uint32 values[], const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        values[i] = rand_uint32();
+}
+
 }   // namespace foundation
@@ -31,6 +31,9 @@
 // appleseed.foundation headers.
 #include "foundation/platform/types.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace foundation
 {
 
@@ -53,6 +56,10 @@ class PCG
     // Generate a 32-bit random number.
     uint32 rand_uint32();
 
+    // Fill an array with 32-bit random numbers.
+    // Produces the same numbers as `count` successive calls to rand_uint32().
+    void fill_uint32(uint32 values[], const size_t count);
+
   private:
     uint64  m_state;    // current state of the generator
     uint64  m_inc;      // controls which RNG sequence (stream) is selected -- must *always* be odd
@@ -86,6 +93,24 @@ inline uint32 PCG::rand_uint32()
     return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
 }
 
+inline void PCG::fill_uint32(uint32 values[], const size_t count)
+{
+    // Keep the state in a register for the whole block.
+    uint64 state = m_state;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint64 old_state = state;
+        state = old_state * 6364136223846793005ull + m_inc;
+
+        const uint32 xorshifted = static_cast<uint32>(((old_state >> 18) ^ old_state) >> 27);
+        const uint32 rot = static_cast<uint32>(old_state >> 59);
+        values[i] = (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+    }
+
+    m_state = state;
+}
+
 #pragma warning (pop)
 
 }   // namespace foundation
@@ -35,6 +35,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 namespace foundation
 {
 
@@ -52,6 +55,10 @@ class APPLESEED_DLLSYMBOL SerialMersenneTwister
     // Generate a 32-bit random number.
     uint32 rand_uint32();
 
+    // Fill an array with 32-bit random numbers.
+    // Produces the same numbers as `count` successive calls to rand_uint32().
+    void fill_uint32(uint32 values[], const size_t count);
+
   private:
     // Period parameters.
     enum { N = 624, M = 397 };
@@ -90,4 +97,10 @@ inline uint32 SerialMersenneTwister::rand_uint32()
     return y;
 }
 
+inline void SerialMersenneTwister::fill_uint32(uint32 values[], const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        values[i] = rand_uint32();
+}
+
 }   // namespace foundation
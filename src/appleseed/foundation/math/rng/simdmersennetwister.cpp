@@ -30,6 +30,7 @@
 #include "simdmersennetwister.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstring>
 
 using namespace std;
@@ -149,6 +150,27 @@ SimdMersenneTwister::SimdMersenneTwister(const uint32 init_key[], const int key_
     init_array_state(init_key, key_length);
 }
 
+void SimdMersenneTwister::fill_uint32(uint32 values[], size_t count)
+{
+    const uint32* psfmt32 = &mt[0].u[0];
+
+    while (count > 0)
+    {
+        if (mti >= N32)
+        {
+            update_state();
+            mti = 0;
+        }
+
+        const size_t n = min(count, static_cast<size_t>(N32 - mti));
+        memcpy(values, psfmt32 + mti, n * sizeof(uint32));
+
+        values += n;
+        count -= n;
+        mti += static_cast<int>(n);
+    }
+}
+
 void SimdMersenneTwister::init_state(const uint32 seed)
 {
     uint32 *psfmt32 = &mt[0].u[0];
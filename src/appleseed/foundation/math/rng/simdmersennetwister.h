@@ -55,6 +55,11 @@ class APPLESEED_DLLSYMBOL SimdMersenneTwister
     // Generate a 32-bit random number.
     uint32 rand_uint32();
 
+    // Fill an array with 32-bit random numbers, copying them straight from the
+    // state vector which is updated 128 bits at a time.
+    // Produces the same numbers as `count` successive calls to rand_uint32().
+    void fill_uint32(uint32 values[], size_t count);
+
   private:
     // Parameters.
     enum
@@ -34,6 +34,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <cstddef>
 
 namespace foundation
 {
@@ -61,6 +62,10 @@ class Xoroshiro128plus
     // Generate a 32-bit random number.
     uint32 rand_uint32();
 
+    // Fill an array with 32-bit random numbers.
+    // Produces the same numbers as `count` successive calls to rand_uint32().
+    void fill_uint32(uint32 values[], const size_t count);
+
   private:
     uint64 m_s[2];
 };
@@ -97,4 +102,25 @@ inline uint32 Xoroshiro128plus::rand_uint32()
     return static_cast<uint32>(result >> 32);
 }
 
+inline void Xoroshiro128plus::fill_uint32(uint32 values[], const size_t count)
+{
+    // Keep the state in registers for the whole block.
+    uint64 s0 = m_s[0];
+    uint64 s1 = m_s[1];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint64 result = s0 + s1;
+
+        s1 ^= s0;
+        s0 = rotl64(s0, 55) ^ s1 ^ (s1 << 14);  // a, b
+        s1 = rotl64(s1, 36);                    // c
+
+        values[i] = static_cast<uint32>(result >> 32);
+    }
+
+    m_s[0] = s0;
+    m_s[1] = s1;
+}
+
 }   // namespace foundation
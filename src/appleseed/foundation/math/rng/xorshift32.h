@@ -34,6 +34,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <cstddef>
 
 namespace foundation
 {
@@ -66,6 +67,10 @@ class Xorshift32
     // Generate a 32-bit random number.
     uint32 rand_uint32();
 
+    // Fill an array with 32-bit random numbers.
+    // Produces the same numbers as `count` successive calls to rand_uint32().
+    void fill_uint32(uint32 values[], const size_t count);
+
   private:
     uint32 m_s;
 };
@@ -89,4 +94,10 @@ inline uint32 Xorshift32::rand_uint32()
     return m_s;
 }
 
+inline void Xorshift32::fill_uint32(uint32 values[], const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        values[i] = rand_uint32();
+}
+
 }   // namespace foundation
@@ -33,6 +33,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <cstddef>
 
 namespace foundation
 {
@@ -65,6 +66,10 @@ class Xorshift64
     // Generate a 32-bit random number.
     uint32 rand_uint32();
 
+    // Fill an array with 32-bit random numbers.
+    // Produces the same numbers as `count` successive calls to rand_uint32().
+    void fill_uint32(uint32 values[], const size_t count);
+
   private:
     uint64 m_s;
 };
@@ -88,4 +93,10 @@ inline uint32 Xorshift64::rand_uint32()
     return static_cast<uint32>(m_s >> 32);
 }
 
+inline void Xorshift64::fill_uint32(uint32 values[], const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        values[i] = rand_uint32();
+}
+
 }   // namespace foundation
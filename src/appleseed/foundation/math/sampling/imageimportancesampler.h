@@ -35,6 +35,7 @@
 #include "foundation/image/color.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/image.h"
+#include "foundation/math/aliastable.h"
 #include "foundation/math/cdf.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
@@ -69,10 +70,12 @@ class ImageImportanceSampler
   public:
     typedef Vector<Importance, 2> Vector2Type;
 
-    // Constructor.
+    // Constructor. Alias tables make sampling constant-time at the cost of some memory
+    // and of the stratification of the input samples.
     ImageImportanceSampler(
         const size_t        width,
-        const size_t        height);
+        const size_t        height,
+        const bool          use_alias_tables = false);
 
     // Destructor.
     ~ImageImportanceSampler();
@@ -100,6 +103,17 @@ class ImageImportanceSampler
         Payload&            payload,
         Importance&         probability) const;
 
+    // Sample the image and return the coordinates of the chosen pixel, its probability
+    // density, its associated payload and the coordinates in [0,1)^2 of the sample within
+    // the pixel.
+    void sample(
+        const Vector2Type&  s,
+        size_t&             x,
+        size_t&             y,
+        Payload&            payload,
+        Importance&         probability,
+        Vector2Type&        jitter) const;
+
     // Return the probability density of a given pixel.
     Importance get_pdf(
         const size_t        x,
@@ -108,13 +122,25 @@ class ImageImportanceSampler
   private:
     typedef CDF<size_t, Importance> RowCDF;
     typedef CDF<Payload, Importance> ColCDF;
+    typedef AliasTable<Importance> AliasTableType;
 
     const size_t            m_width;
     const size_t            m_height;
     const Importance        m_rcp_pixel_count;
+    const bool              m_use_alias_tables;
 
     ColCDF*                 m_cols_cdf;
     RowCDF                  m_rows_cdf;
+
+    AliasTableType*         m_cols_alias_tables;
+    AliasTableType          m_rows_alias_table;
+
+    void sample_pixel(
+        const Vector2Type&  s,
+        size_t&             x,
+        size_t&             y,
+        Importance&         probability,
+        Vector2Type&        jitter) const;
 };
 
 
@@ -143,17 +169,21 @@ class ImageSampler
 template <typename Payload, typename Importance>
 ImageImportanceSampler<Payload, Importance>::ImageImportanceSampler(
     const size_t            width,
-    const size_t            height)
+    const size_t            height,
+    const bool              use_alias_tables)
   : m_width(width)
   , m_height(height)
   , m_rcp_pixel_count(Importance(1.0) / (width * height))
+  , m_use_alias_tables(use_alias_tables)
 {
     m_cols_cdf = new ColCDF[m_height];
+    m_cols_alias_tables = use_alias_tables ? new AliasTableType[m_height] : nullptr;
 }
 
 template <typename Payload, typename Importance>
 ImageImportanceSampler<Payload, Importance>::~ImageImportanceSampler()
 {
+    delete[] m_cols_alias_tables;
     delete[] m_cols_cdf;
 }
 
@@ -195,6 +225,38 @@ void ImageImportanceSampler<Payload, Importance>::rebuild(
 
     if (m_rows_cdf.valid())
         m_rows_cdf.prepare();
+
+    if (m_use_alias_tables)
+    {
+        m_rows_alias_table.clear();
+
+        if (!m_rows_cdf.valid())
+            return;
+
+        m_rows_alias_table.reserve(m_height);
+
+        for (size_t y = 0, ye = m_height; y < ye; ++y)
+        {
+            const ColCDF& col_cdf = m_cols_cdf[y];
+            AliasTableType& col_alias_table = m_cols_alias_tables[y];
+
+            col_alias_table.clear();
+
+            if (col_cdf.valid())
+            {
+                col_alias_table.reserve(m_width);
+
+                for (size_t x = 0, xe = m_width; x < xe; ++x)
+                    col_alias_table.insert(col_cdf[x].second);
+
+                col_alias_table.prepare();
+            }
+
+            m_rows_alias_table.insert(m_rows_cdf[y].second);
+        }
+
+        m_rows_alias_table.prepare();
+    }
 }
 
 template <typename Payload, typename Importance>
@@ -204,30 +266,8 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
     size_t&                 y,
     Importance&             probability) const
 {
-    if (m_rows_cdf.valid())
-    {
-        // Select a row.
-        const typename RowCDF::ItemWeightPair& row = m_rows_cdf.sample(s[1]);
-        assert(row.second != Importance(0.0));
-        y = row.first;
-
-        // Select a column within this row.
-        const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y].sample(s[0]);
-        assert(col.second != Importance(0.0));
-        x = &col - &m_cols_cdf[y][0];
-
-        probability = row.second * col.second;
-    }
-    else
-    {
-        // Uniform random sampling.
-        x = truncate<size_t>(s[0] * m_width);
-        y = truncate<size_t>(s[1] * m_height);
-
-        probability = m_rcp_pixel_count;
-    }
-
-    assert(probability > Importance(0.0));
+    Vector2Type jitter;
+    sample_pixel(s, x, y, probability, jitter);
 }
 
 template <typename Payload, typename Importance>
@@ -237,21 +277,64 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
     size_t&                 y,
     Payload&                payload,
     Importance&             probability) const
+{
+    Vector2Type jitter;
+    sample_pixel(s, x, y, probability, jitter);
+    payload = m_cols_cdf[y][x].first;
+}
+
+template <typename Payload, typename Importance>
+inline void ImageImportanceSampler<Payload, Importance>::sample(
+    const Vector2Type&      s,
+    size_t&                 x,
+    size_t&                 y,
+    Payload&                payload,
+    Importance&             probability,
+    Vector2Type&            jitter) const
+{
+    sample_pixel(s, x, y, probability, jitter);
+    payload = m_cols_cdf[y][x].first;
+}
+
+template <typename Payload, typename Importance>
+inline void ImageImportanceSampler<Payload, Importance>::sample_pixel(
+    const Vector2Type&      s,
+    size_t&                 x,
+    size_t&                 y,
+    Importance&             probability,
+    Vector2Type&            jitter) const
 {
     if (m_rows_cdf.valid())
     {
-        // Select a row.
-        const typename RowCDF::ItemWeightPair& row = m_rows_cdf.sample(s[1]);
-        assert(row.second != Importance(0.0));
-        y = row.first;
-
-        // Select a column within this row.
-        const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y].sample(s[0]);
-        assert(col.second != Importance(0.0));
-        x = &col - &m_cols_cdf[y][0];
-
-        payload = col.first;
-        probability = row.second * col.second;
+        if (m_use_alias_tables)
+        {
+            // Select a row.
+            Importance row_prob;
+            y = m_rows_alias_table.sample(s[1], row_prob, jitter[1]);
+
+            // Select a column within this row.
+            Importance col_prob;
+            x = m_cols_alias_tables[y].sample(s[0], col_prob, jitter[0]);
+
+            probability = row_prob * col_prob;
+        }
+        else
+        {
+            // Select a row.
+            const typename RowCDF::ItemWeightPair& row = m_rows_cdf.sample(s[1]);
+            assert(row.second != Importance(0.0));
+            y = row.first;
+
+            // Select a column within this row.
+            const typename ColCDF::ItemWeightPair& col = m_cols_cdf[y].sample(s[0]);
+            assert(col.second != Importance(0.0));
+            x = &col - &m_cols_cdf[y][0];
+
+            probability = row.second * col.second;
+
+            jitter[0] = frac(s[0] * m_width);
+            jitter[1] = frac(s[1] * m_height);
+        }
     }
     else
     {
@@ -259,8 +342,10 @@ inline void ImageImportanceSampler<Payload, Importance>::sample(
         x = truncate<size_t>(s[0] * m_width);
         y = truncate<size_t>(s[1] * m_height);
 
-        payload = m_cols_cdf[y][x].first;
         probability = m_rcp_pixel_count;
+
+        jitter[0] = frac(s[0] * m_width);
+        jitter[1] = frac(s[1] * m_height);
     }
 
     assert(probability > Importance(0.0));
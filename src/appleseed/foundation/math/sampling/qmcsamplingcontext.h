@@ -30,6 +30,7 @@
 #pragma once
 
 // appleseed.foundation headers.
+#include "foundation/math/hash.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/primes.h"
 #include "foundation/math/qmc.h"
@@ -59,6 +60,11 @@ namespace foundation
 //   - Cranley-Patterson rotation
 //   - Monte Carlo padding
 //
+// or, in Sobol mode:
+//
+//   - deterministic sampling based on Sobol sequences
+//   - hash-based Owen scrambling, seeded per dimension allocation and instance
+//
 // Reference:
 //
 //   Kollig and Keller, Efficient Multidimensional Sampling
@@ -72,10 +78,11 @@ class QMCSamplingContext
     // Random number generator type.
     typedef RNG RNGType;
 
-    // This sampler can operate in two modes:
+    // This sampler can operate in three modes:
     //   1. In QMC mode, it uses possibly patent-encumbered techniques.
     //   2. In RNG mode, it works like `RNGSamplingContext` and sticks to random sampling.
-    enum Mode { QMCMode, RNGMode };
+    //   3. In Sobol mode, it uses Owen-scrambled Sobol sequences.
+    enum Mode { QMCMode, RNGMode, SobolMode };
 
     // Construct a sampling context of dimension 0.
     // The resulting sampling context cannot be used directly;
@@ -158,6 +165,8 @@ class QMCSamplingContext
 
     void compute_offset();
 
+    uint32 compute_sobol_seed() const;
+
     template <typename T> struct Tag {};
 
     template <typename T> T next2(Tag<T>);
@@ -338,6 +347,16 @@ inline void QMCSamplingContext<RNG>::compute_offset()
     }
 }
 
+template <typename RNG>
+inline uint32 QMCSamplingContext<RNG>::compute_sobol_seed() const
+{
+    // Each dimension allocation and each parent instance gets its own scrambling.
+    return
+        mix_uint32(
+            static_cast<uint32>(m_base_dimension),
+            static_cast<uint32>(m_base_instance));
+}
+
 template <typename RNG>
 template <typename T>
 inline T QMCSamplingContext<RNG>::next2(Tag<T>)
@@ -377,10 +396,21 @@ inline Vector<T, N> QMCSamplingContext<RNG>::next2(Tag<Vector<T, N>>)
             }
         }
     }
+    else if (m_mode == SobolMode)
+    {
+        static_assert(
+            N <= SobolDimensionCount,
+            "foundation::QMCSamplingContext::next2() expects N <= SobolDimensionCount");
+
+        owen_scrambled_sobol_sequence(
+            N,
+            static_cast<uint32>(m_instance),
+            compute_sobol_seed(),
+            &v[0]);
+    }
     else
     {
-        for (size_t i = 0; i < N; ++i)
-            v[i] = rand2<T>(m_rng);
+        fill_rand2(m_rng, &v[0], N);
     }
 
     ++m_instance;
@@ -42,6 +42,10 @@ namespace foundation
 //
 // A sampling context implementing random sampling.
 //
+// All the dimensions of a sample are drawn with a single call to RNG::fill_uint32().
+// Use `BufferedRNG` as random number generator to serve them from a buffer filled
+// in large blocks.
+//
 
 template <typename RNG>
 class RNGSamplingContext
@@ -173,10 +177,13 @@ template <typename RNG>
 template <typename T, size_t N>
 inline Vector<T, N> RNGSamplingContext<RNG>::next2(Tag<Vector<T, N>>)
 {
+    double values[N];
+    fill_rand_double2(m_rng, values, N);
+
     Vector<T, N> v;
 
     for (size_t i = 0; i < N; ++i)
-        v[i] = rand_double2(m_rng);
+        v[i] = static_cast<T>(values[i]);
 
     return v;
 }
@@ -41,6 +41,7 @@
 
 // Standard headers.
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <cstdio>
@@ -57,8 +58,29 @@ class SphericalImportanceSampler
   public:
     explicit SphericalImportanceSampler(const size_t subdivisions);
 
+    // Uniformly sample the unit sphere.
     Vector<T, 3> sample(const Vector<T, 3>& s) const;
 
+    // Return the number of spherical triangles tessellating the unit sphere.
+    size_t get_triangle_count() const;
+
+    // Return the solid angle subtended by a given triangle.
+    T get_triangle_area(const size_t triangle_index) const;
+
+    // Return the unit-length direction of the centroid of a given triangle.
+    Vector<T, 3> get_triangle_center(const size_t triangle_index) const;
+
+    // Return the angle between the centroid of a given triangle and its farthest vertex.
+    T get_triangle_radius(const size_t triangle_index) const;
+
+    // Uniformly sample a given triangle.
+    Vector<T, 3> sample_triangle(
+        const size_t        triangle_index,
+        const Vector<T, 2>& s) const;
+
+    // Return the index of the triangle containing a given unit-length direction.
+    size_t find_triangle(const Vector<T, 3>& direction) const;
+
     bool dump_as_obj(const char* filepath) const;
     void dump_to_vpython_file(VPythonFile& file) const;
 
@@ -81,12 +103,27 @@ class SphericalImportanceSampler
 
     std::vector<Vector<T, 3>>   m_verts;
     std::vector<Tri>            m_tris;
+    std::vector<T>              m_areas;
     CDF<size_t, T>              m_cdf;
 
+    // Coarser tessellations, from the icosahedron up. The children of triangle i
+    // at a given level are triangles 4 * i to 4 * i + 3 of the next level.
+    std::vector<std::vector<Tri>> m_levels;
+
     void create_regular_icosahedron();
     void subdivide(const size_t subdivisions);
     size_t get_or_create_middle_point(PointCache& point_cache, size_t v0, size_t v1);
     void build_cdf();
+
+    // Return a value that is non-negative if and only if a direction lies inside a triangle.
+    T compute_inclusion(const Tri& tri, const Vector<T, 3>& direction) const;
+
+    // Return the index of the triangle of a given range that best contains a direction.
+    size_t find_best_triangle(
+        const std::vector<Tri>& tris,
+        const size_t            begin,
+        const size_t            end,
+        const Vector<T, 3>&     direction) const;
 };
 
 
@@ -122,6 +159,74 @@ Vector<T, 3> SphericalImportanceSampler<T>::sample(const Vector<T, 3>& s) const
             Vector<T, 2>(s[1], s[2]));
 }
 
+template <typename T>
+inline size_t SphericalImportanceSampler<T>::get_triangle_count() const
+{
+    return m_tris.size();
+}
+
+template <typename T>
+inline T SphericalImportanceSampler<T>::get_triangle_area(const size_t triangle_index) const
+{
+    assert(triangle_index < m_areas.size());
+    return m_areas[triangle_index];
+}
+
+template <typename T>
+Vector<T, 3> SphericalImportanceSampler<T>::get_triangle_center(const size_t triangle_index) const
+{
+    assert(triangle_index < m_tris.size());
+    const Tri& tri = m_tris[triangle_index];
+
+    return normalize(m_verts[tri.m_v0] + m_verts[tri.m_v1] + m_verts[tri.m_v2]);
+}
+
+template <typename T>
+T SphericalImportanceSampler<T>::get_triangle_radius(const size_t triangle_index) const
+{
+    assert(triangle_index < m_tris.size());
+    const Tri& tri = m_tris[triangle_index];
+
+    const Vector<T, 3> center = get_triangle_center(triangle_index);
+    const T min_cos =
+        std::min(
+            std::min(dot(center, m_verts[tri.m_v0]), dot(center, m_verts[tri.m_v1])),
+            dot(center, m_verts[tri.m_v2]));
+
+    return std::acos(clamp(min_cos, T(-1.0), T(1.0)));
+}
+
+template <typename T>
+Vector<T, 3> SphericalImportanceSampler<T>::sample_triangle(
+    const size_t            triangle_index,
+    const Vector<T, 2>&     s) const
+{
+    assert(triangle_index < m_tris.size());
+    const Tri& tri = m_tris[triangle_index];
+
+    return
+        sample_spherical_triangle_uniform(
+            m_verts[tri.m_v0],
+            m_verts[tri.m_v1],
+            m_verts[tri.m_v2],
+            s);
+}
+
+template <typename T>
+size_t SphericalImportanceSampler<T>::find_triangle(const Vector<T, 3>& direction) const
+{
+    if (m_levels.empty())
+        return find_best_triangle(m_tris, 0, m_tris.size(), direction);
+
+    // Find the icosahedron face containing the direction, then descend the subdivisions.
+    size_t index = find_best_triangle(m_levels[0], 0, m_levels[0].size(), direction);
+
+    for (size_t level = 1; level < m_levels.size(); ++level)
+        index = find_best_triangle(m_levels[level], 4 * index, 4 * index + 4, direction);
+
+    return find_best_triangle(m_tris, 4 * index, 4 * index + 4, direction);
+}
+
 template <typename T>
 bool SphericalImportanceSampler<T>::dump_as_obj(const char* filepath) const
 {
@@ -244,6 +349,8 @@ void SphericalImportanceSampler<T>::subdivide(const size_t subdivisions)
             new_tris.push_back(Tri(a, b, c));
         }
 
+        m_levels.push_back(std::vector<Tri>());
+        m_levels.back().swap(m_tris);
         m_tris.swap(new_tris);
     }
 }
@@ -276,6 +383,7 @@ template <typename T>
 void SphericalImportanceSampler<T>::build_cdf()
 {
     const size_t tri_count = m_tris.size();
+    m_areas.reserve(tri_count);
     m_cdf.reserve(tri_count);
 
     for (size_t i = 0; i < tri_count; ++i)
@@ -297,10 +405,59 @@ void SphericalImportanceSampler<T>::build_cdf()
         // Compute the area of the spherical triangle.
         const T area = compute_spherical_triangle_area(alpha, beta, gamma);
 
+        m_areas.push_back(area);
         m_cdf.insert(i, area);
     }
 
     m_cdf.prepare();
 }
 
+template <typename T>
+inline T SphericalImportanceSampler<T>::compute_inclusion(
+    const Tri&              tri,
+    const Vector<T, 3>&     direction) const
+{
+    const Vector<T, 3>& v0 = m_verts[tri.m_v0];
+    const Vector<T, 3>& v1 = m_verts[tri.m_v1];
+    const Vector<T, 3>& v2 = m_verts[tri.m_v2];
+
+    // Signed distances to the planes of the three great circles bounding the triangle,
+    // oriented toward the inside of the triangle whatever its winding.
+    const T orientation = dot(v0, cross(v1, v2)) >= T(0.0) ? T(1.0) : T(-1.0);
+    const T d0 = dot(direction, cross(v0, v1));
+    const T d1 = dot(direction, cross(v1, v2));
+    const T d2 = dot(direction, cross(v2, v0));
+
+    return orientation * (orientation > T(0.0) ? std::min(std::min(d0, d1), d2) : std::max(std::max(d0, d1), d2));
+}
+
+template <typename T>
+size_t SphericalImportanceSampler<T>::find_best_triangle(
+    const std::vector<Tri>& tris,
+    const size_t            begin,
+    const size_t            end,
+    const Vector<T, 3>&     direction) const
+{
+    assert(begin < end);
+    assert(end <= tris.size());
+
+    // Directions lying on an edge, or slightly outside of every candidate due to
+    // rounding errors, go to the triangle they are the least outside of.
+    size_t best_index = begin;
+    T best_inclusion = compute_inclusion(tris[begin], direction);
+
+    for (size_t i = begin + 1; i < end && best_inclusion < T(0.0); ++i)
+    {
+        const T inclusion = compute_inclusion(tris[i], direction);
+
+        if (best_inclusion < inclusion)
+        {
+            best_index = i;
+            best_inclusion = inclusion;
+        }
+    }
+
+    return best_index;
+}
+
 }   // namespace foundation
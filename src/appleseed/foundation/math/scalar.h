@@ -134,6 +134,10 @@ bool is_pow2(const T x);
 template <typename T>
 T log2_int(T x);
 
+// Return the number of trailing zero bits of a given nonzero integer.
+template <typename T>
+T trailing_zeros_int(T x);
+
 // Return the log in a given base of a given scalar.
 template <typename T>
 T log(const T x, const T base);
@@ -530,6 +534,70 @@ inline unsigned long log2_int(const unsigned long x)
 
 #endif
 
+template <typename T>
+inline T trailing_zeros_int(T x)
+{
+    assert(x > 0);
+
+    T n = 0;
+
+    while ((x & 1) == 0)
+    {
+        x >>= 1;
+        ++n;
+    }
+
+    return n;
+}
+
+// Visual C++.
+#if defined _MSC_VER
+
+template <>
+inline uint32 trailing_zeros_int(const uint32 x)
+{
+    assert(x > 0);
+
+    unsigned long index;
+    _BitScanForward(&index, x);
+
+    return static_cast<uint32>(index);
+}
+
+#ifdef APPLESEED_ARCH64
+
+template <>
+inline uint64 trailing_zeros_int(const uint64 x)
+{
+    assert(x > 0);
+
+    unsigned long index;
+    _BitScanForward64(&index, x);
+
+    return static_cast<uint64>(index);
+}
+
+#endif
+
+// gcc.
+#elif defined __GNUC__
+
+template <>
+inline unsigned int trailing_zeros_int(const unsigned int x)
+{
+    assert(x > 0);
+    return __builtin_ctz(x);
+}
+
+template <>
+inline unsigned long trailing_zeros_int(const unsigned long x)
+{
+    assert(x > 0);
+    return __builtin_ctzl(x);
+}
+
+#endif
+
 template <typename T>
 inline T log(const T x, const T base)
 {
@@ -0,0 +1,534 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// A sparse 3D grid of voxels.
+//
+// The grid is partitioned into leaves of 8x8x8 voxels. Only leaves that received
+// at least one voxel are allocated; all other voxels read as zero. A dense table
+// maps leaf coordinates to leaf indices, and leaf values are stored contiguously,
+// one leaf after the other, so that a lookup costs one table read plus one access
+// into a compact 512-voxel block. Each leaf also records the maximum of each of
+// its channels, which lets callers build conservative bounds (e.g. majorants)
+// without touching individual voxels.
+//
+// The grid is meant to be filled once and then queried read-only: lookups follow
+// the conventions of VoxelGrid3 and can be substituted for it directly.
+//
+
+template <typename ValueType, typename CoordType>
+class SparseVoxelGrid3
+  : public NonCopyable
+{
+  public:
+    // Types.
+    typedef Vector<CoordType, 3> PointType;
+
+    // Leaf dimensions.
+    static const size_t LeafLog2 = 3;
+    static const size_t LeafDim = 1 << LeafLog2;
+    static const size_t LeafMask = LeafDim - 1;
+    static const size_t LeafVoxelCount = LeafDim * LeafDim * LeafDim;
+
+    // Constructor.
+    SparseVoxelGrid3(
+        const size_t        nx,
+        const size_t        ny,
+        const size_t        nz,
+        const size_t        channel_count);
+
+    // Get the grid properties.
+    size_t get_xres() const;
+    size_t get_yres() const;
+    size_t get_zres() const;
+    size_t get_channel_count() const;
+
+    // Get the resolution of the leaf table.
+    size_t get_leaf_xres() const;
+    size_t get_leaf_yres() const;
+    size_t get_leaf_zres() const;
+
+    // Return the number of allocated leaves.
+    size_t get_leaf_count() const;
+
+    // Return the size in bytes of the grid.
+    size_t get_memory_size() const;
+
+    // Return true if a given leaf is allocated.
+    bool is_leaf_active(
+        const size_t        lx,
+        const size_t        ly,
+        const size_t        lz) const;
+
+    // Return an upper bound on the values of a given channel in a given leaf.
+    // Returns zero for leaves that are not allocated.
+    ValueType get_leaf_max(
+        const size_t        lx,
+        const size_t        ly,
+        const size_t        lz,
+        const size_t        channel) const;
+
+    // Set the values of a given voxel, allocating its leaf if necessary.
+    void set_voxel(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z,
+        const ValueType*    values);
+
+    // Direct read-only access to a given voxel.
+    const ValueType* voxel(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    // Perform an unfiltered lookup of the voxel grid.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    void nearest_lookup(
+        const PointType&    point,
+        ValueType*          values) const;
+
+    // Perform a trilinearly interpolated lookup of the voxel grid.
+    // 'point' must be expressed in the unit cube [0,1]^3.
+    void linear_lookup(
+        const PointType&    point,
+        ValueType*          values) const;
+
+    // Perform trilinearly interpolated lookups at a batch of points. Values are
+    // written consecutively, channel_count values per point. Successive points
+    // falling into the same leaf reuse the leaf found for the previous point.
+    void linear_lookup(
+        const size_t        count,
+        const PointType*    points,
+        ValueType*          values) const;
+
+  private:
+    static const uint32 EmptyLeaf = ~uint32(0);
+
+    const size_t            m_nx;
+    const size_t            m_ny;
+    const size_t            m_nz;
+    const CoordType         m_scalar_nx;
+    const CoordType         m_scalar_ny;
+    const CoordType         m_scalar_nz;
+    const CoordType         m_max_x;
+    const CoordType         m_max_y;
+    const CoordType         m_max_z;
+    const size_t            m_channel_count;
+    const size_t            m_leaf_nx;
+    const size_t            m_leaf_ny;
+    const size_t            m_leaf_nz;
+    const size_t            m_leaf_size;        // number of values in one leaf
+    std::vector<uint32>     m_leaf_indices;
+    std::vector<ValueType>  m_leaf_values;
+    std::vector<ValueType>  m_leaf_max;
+    std::vector<ValueType>  m_zero;
+
+    size_t get_leaf_slot(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    size_t get_leaf_offset(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    const ValueType* get_leaf(const size_t slot) const;
+
+    void linear_lookup(
+        const PointType&    point,
+        size_t&             cached_slot,
+        const ValueType*&   cached_leaf,
+        ValueType*          values) const;
+};
+
+
+//
+// SparseVoxelGrid3 class implementation.
+//
+
+template <typename ValueType, typename CoordType>
+SparseVoxelGrid3<ValueType, CoordType>::SparseVoxelGrid3(
+    const size_t            nx,
+    const size_t            ny,
+    const size_t            nz,
+    const size_t            channel_count)
+  : m_nx(nx)
+  , m_ny(ny)
+  , m_nz(nz)
+  , m_scalar_nx(static_cast<CoordType>(nx))
+  , m_scalar_ny(static_cast<CoordType>(ny))
+  , m_scalar_nz(static_cast<CoordType>(nz))
+  , m_max_x(static_cast<CoordType>(nx - 1))
+  , m_max_y(static_cast<CoordType>(ny - 1))
+  , m_max_z(static_cast<CoordType>(nz - 1))
+  , m_channel_count(channel_count)
+  , m_leaf_nx((nx + LeafMask) >> LeafLog2)
+  , m_leaf_ny((ny + LeafMask) >> LeafLog2)
+  , m_leaf_nz((nz + LeafMask) >> LeafLog2)
+  , m_leaf_size(LeafVoxelCount * channel_count)
+  , m_leaf_indices(m_leaf_nx * m_leaf_ny * m_leaf_nz, EmptyLeaf)
+  , m_zero(channel_count, ValueType(0.0))
+{
+    assert(m_nx > 0);
+    assert(m_ny > 0);
+    assert(m_nz > 0);
+    assert(m_channel_count > 0);
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_xres() const
+{
+    return m_nx;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_yres() const
+{
+    return m_ny;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_zres() const
+{
+    return m_nz;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_channel_count() const
+{
+    return m_channel_count;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_leaf_xres() const
+{
+    return m_leaf_nx;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_leaf_yres() const
+{
+    return m_leaf_ny;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_leaf_zres() const
+{
+    return m_leaf_nz;
+}
+
+template <typename ValueType, typename CoordType>
+inline size_t SparseVoxelGrid3<ValueType, CoordType>::get_leaf_count() const
+{
+    return m_leaf_values.size() / m_leaf_size;
+}
+
+template <typename ValueType, typename CoordType>
+size_t SparseVoxelGrid3<ValueType, CoordType>::get_memory_size() const
+{
+    return
+          sizeof(*this)
+        + m_leaf_indices.capacity() * sizeof(uint32)
+        + m_leaf_values.capacity() * sizeof(ValueType)
+        + m_leaf_max.capacity() * sizeof(ValueType)
+        + m_zero.capacity() * sizeof(ValueType);
+}
+
+template <typename ValueType, typename CoordType>
+inline bool SparseVoxelGrid3<ValueType, CoordType>::is_leaf_active(
+    const size_t            lx,
+    const size_t            ly,
+    const size_t            lz) const
+{
+    assert(lx < m_leaf_nx);
+    assert(ly < m_leaf_ny);
+    assert(lz < m_leaf_nz);
+    return m_leaf_indices[(lz * m_leaf_ny + ly) * m_leaf_nx + lx] != EmptyLeaf;
+}
+
+template <typename ValueType, typename CoordType>
+inline ValueType SparseVoxelGrid3<ValueType, CoordType>::get_leaf_max(
+    const size_t            lx,
+    const size_t            ly,
+    const size_t            lz,
+    const size_t            channel) const
+{
+    assert(lx < m_leaf_nx);
+    assert(ly < m_leaf_ny);
+    assert(lz < m_leaf_nz);
+    assert(channel < m_channel_count);
+
+    const uint32 leaf_index = m_leaf_indices[(lz * m_leaf_ny + ly) * m_leaf_nx + lx];
+    return
+        leaf_index == EmptyLeaf
+            ? ValueType(0.0)
+            : m_leaf_max[leaf_index * m_channel_count + channel];
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::set_voxel(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z,
+    const ValueType*        values)
+{
+    assert(x < m_nx);
+    assert(y < m_ny);
+    assert(z < m_nz);
+
+    uint32& leaf_index = m_leaf_indices[get_leaf_slot(x, y, z)];
+
+    if (leaf_index == EmptyLeaf)
+    {
+        leaf_index = static_cast<uint32>(get_leaf_count());
+        m_leaf_values.resize(m_leaf_values.size() + m_leaf_size, ValueType(0.0));
+        m_leaf_max.resize(m_leaf_max.size() + m_channel_count, ValueType(0.0));
+    }
+
+    ValueType* dest = &m_leaf_values[leaf_index * m_leaf_size + get_leaf_offset(x, y, z)];
+    ValueType* leaf_max = &m_leaf_max[leaf_index * m_channel_count];
+
+    // The leaf maximum is never lowered, so it remains an upper bound if voxels are overwritten.
+    for (size_t i = 0; i < m_channel_count; ++i)
+    {
+        dest[i] = values[i];
+        leaf_max[i] = std::max(leaf_max[i], values[i]);
+    }
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE const ValueType* SparseVoxelGrid3<ValueType, CoordType>::voxel(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    assert(x < m_nx);
+    assert(y < m_ny);
+    assert(z < m_nz);
+
+    const ValueType* leaf = get_leaf(get_leaf_slot(x, y, z));
+    return leaf ? leaf + get_leaf_offset(x, y, z) : &m_zero[0];
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::nearest_lookup(
+    const PointType&                point,
+    ValueType* APPLESEED_RESTRICT   values) const
+{
+    // Compute the coordinates of the voxel containing the lookup point.
+    const CoordType x = clamp(point.x * m_scalar_nx, CoordType(0.0), m_max_x);
+    const CoordType y = clamp(point.y * m_scalar_ny, CoordType(0.0), m_max_y);
+    const CoordType z = clamp(point.z * m_scalar_nz, CoordType(0.0), m_max_z);
+    const size_t ix = truncate<size_t>(x);
+    const size_t iy = truncate<size_t>(y);
+    const size_t iz = truncate<size_t>(z);
+
+    // Return the values of that voxel.
+    const ValueType* APPLESEED_RESTRICT source = voxel(ix, iy, iz);
+    for (size_t i = 0; i < m_channel_count; ++i)
+        *values++ = *source++;
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::linear_lookup(
+    const PointType&                point,
+    ValueType* APPLESEED_RESTRICT   values) const
+{
+    size_t cached_slot = ~size_t(0);
+    const ValueType* cached_leaf = nullptr;
+    linear_lookup(point, cached_slot, cached_leaf, values);
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::linear_lookup(
+    const size_t                    count,
+    const PointType*                points,
+    ValueType* APPLESEED_RESTRICT   values) const
+{
+    size_t cached_slot = ~size_t(0);
+    const ValueType* cached_leaf = nullptr;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        linear_lookup(points[i], cached_slot, cached_leaf, values);
+        values += m_channel_count;
+    }
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_leaf_slot(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    return ((z >> LeafLog2) * m_leaf_ny + (y >> LeafLog2)) * m_leaf_nx + (x >> LeafLog2);
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t SparseVoxelGrid3<ValueType, CoordType>::get_leaf_offset(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    return ((((z & LeafMask) << LeafLog2) + (y & LeafMask)) * LeafDim + (x & LeafMask)) * m_channel_count;
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE const ValueType* SparseVoxelGrid3<ValueType, CoordType>::get_leaf(const size_t slot) const
+{
+    const uint32 leaf_index = m_leaf_indices[slot];
+    return leaf_index == EmptyLeaf ? nullptr : &m_leaf_values[leaf_index * m_leaf_size];
+}
+
+template <typename ValueType, typename CoordType>
+void SparseVoxelGrid3<ValueType, CoordType>::linear_lookup(
+    const PointType&                point,
+    size_t&                         cached_slot,
+    const ValueType*&               cached_leaf,
+    ValueType* APPLESEED_RESTRICT   values) const
+{
+    // Compute the coordinates of the voxel containing the lookup point.
+    const CoordType x = saturate(point.x) * m_max_x;
+    const CoordType y = saturate(point.y) * m_max_y;
+    const CoordType z = saturate(point.z) * m_max_z;
+    const size_t ix = truncate<size_t>(x);
+    const size_t iy = truncate<size_t>(y);
+    const size_t iz = truncate<size_t>(z);
+
+    // Compute interpolation weights.
+    const ValueType x1 = static_cast<ValueType>(x - ix);
+    const ValueType y1 = static_cast<ValueType>(y - iy);
+    const ValueType z1 = static_cast<ValueType>(z - iz);
+    const ValueType x0 = ValueType(1.0) - x1;
+    const ValueType y0 = ValueType(1.0) - y1;
+    const ValueType z0 = ValueType(1.0) - z1;
+    const ValueType y0z0 = y0 * z0;
+    const ValueType y1z0 = y1 * z0;
+    const ValueType y0z1 = y0 * z1;
+    const ValueType y1z1 = y1 * z1;
+    const ValueType w000 = x0 * y0z0;
+    const ValueType w100 = x1 * y0z0;
+    const ValueType w010 = x0 * y1z0;
+    const ValueType w110 = x1 * y1z0;
+    const ValueType w001 = x0 * y0z1;
+    const ValueType w101 = x1 * y0z1;
+    const ValueType w011 = x0 * y1z1;
+    const ValueType w111 = x1 * y1z1;
+
+    // Coordinates of the opposite corner of the lookup footprint.
+    const size_t jx = ix == m_nx - 1 ? ix : ix + 1;
+    const size_t jy = iy == m_ny - 1 ? iy : iy + 1;
+    const size_t jz = iz == m_nz - 1 ? iz : iz + 1;
+
+    // Compute source pointers.
+    const ValueType* APPLESEED_RESTRICT src000;
+    const ValueType* APPLESEED_RESTRICT src100;
+    const ValueType* APPLESEED_RESTRICT src010;
+    const ValueType* APPLESEED_RESTRICT src110;
+    const ValueType* APPLESEED_RESTRICT src001;
+    const ValueType* APPLESEED_RESTRICT src101;
+    const ValueType* APPLESEED_RESTRICT src011;
+    const ValueType* APPLESEED_RESTRICT src111;
+
+    if (((ix ^ jx) | (iy ^ jy) | (iz ^ jz)) >> LeafLog2 == 0)
+    {
+        // Fast path: the whole footprint lies in a single leaf.
+        const size_t slot = get_leaf_slot(ix, iy, iz);
+        if (slot != cached_slot)
+        {
+            cached_slot = slot;
+            cached_leaf = get_leaf(slot);
+        }
+
+        if (cached_leaf == nullptr)
+        {
+            for (size_t i = 0; i < m_channel_count; ++i)
+                *values++ = ValueType(0.0);
+            return;
+        }
+
+        const size_t dx = (jx - ix) * m_channel_count;
+        const size_t dy = (jy - iy) * LeafDim * m_channel_count;
+        const size_t dz = (jz - iz) * LeafDim * LeafDim * m_channel_count;
+        src000 = cached_leaf + get_leaf_offset(ix, iy, iz);
+        src100 = src000 + dx;
+        src010 = src000 + dy;
+        src001 = src000 + dz;
+        src110 = src100 + dy;
+        src101 = src100 + dz;
+        src011 = src010 + dz;
+        src111 = src110 + dz;
+    }
+    else
+    {
+        // Slow path: the footprint straddles leaves.
+        src000 = voxel(ix, iy, iz);
+        src100 = voxel(jx, iy, iz);
+        src010 = voxel(ix, jy, iz);
+        src110 = voxel(jx, jy, iz);
+        src001 = voxel(ix, iy, jz);
+        src101 = voxel(jx, iy, jz);
+        src011 = voxel(ix, jy, jz);
+        src111 = voxel(jx, jy, jz);
+    }
+
+    // Blend.
+    for (size_t i = 0; i < m_channel_count; ++i)
+    {
+        *values++ =
+            *src000++ * w000 +
+            *src100++ * w100 +
+            *src010++ * w010 +
+            *src110++ * w110 +
+            *src001++ * w001 +
+            *src101++ * w101 +
+            *src011++ * w011 +
+            *src111++ * w111;
+    }
+}
+
+}   // namespace foundation
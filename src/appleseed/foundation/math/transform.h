@@ -211,6 +211,10 @@ class TransformInterpolator
     Vector<T, 3>  m_s0, m_s1;
     Quaternion<T> m_q0, m_q1;
     Vector<T, 3>  m_t0, m_t1;
+
+    // Coefficients of fast_slerp() that only depend on the two rotations.
+    T             m_slerp_a, m_slerp_b;
+    bool          m_rotates;
 };
 
 
@@ -650,6 +654,12 @@ bool TransformInterpolator<T>::set_transforms(
     if (dot(m_q0, m_q1) < T(0.0))
         m_q1 = -m_q1;
 
+    // Precompute the parts of fast_slerp() that don't depend on the interpolation parameter.
+    const T d = dot(m_q0, m_q1);
+    m_slerp_a = T(1.0904) + d * (T(-3.2452) + d * (T(3.55645) + d * T(-1.43519)));
+    m_slerp_b = T(0.848013) + d * (T(-1.06021) + d * T(0.215638));
+    m_rotates = m_q0 != m_q1;
+
     const T Eps = make_eps<T>(1.0e-4f, 1.0e-6);
     return is_normalized(m_q0, Eps) && is_normalized(m_q1, Eps);
 }
@@ -719,7 +729,16 @@ inline void TransformInterpolator<T>::evaluate(const T t, Transform<T>& result)
     //     parent_to_local = inv_smat * parent_to_local;
     //
 
-    const Quaternion<T> q = fast_slerp(m_q0, m_q1, t);
+    // Same as fast_slerp(m_q0, m_q1, t) but using the precomputed coefficients.
+    Quaternion<T> q = m_q0;
+    if (m_rotates)
+    {
+        const T u = t - T(1.0);
+        const T v = t - T(0.5);
+        const T k = m_slerp_a * v * v + m_slerp_b;
+        const T w = k * u * v * t + t;
+        q = normalize(lerp(m_q0, m_q1, w));
+    }
 
     const T rtx = q.v[0] + q.v[0];
     const T rty = q.v[1] + q.v[1];
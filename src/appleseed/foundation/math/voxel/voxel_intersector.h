@@ -33,6 +33,9 @@
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/ray.h"
 #include "foundation/math/voxel/voxel_statistics.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 
 // Standard headers.
 #include <cassert>
@@ -73,6 +76,22 @@ class Intersector
 #endif
         ) const;
 
+    // Maximum number of rays in a packet.
+    static const size_t PacketSize = 4;
+
+    // Intersect a packet of up to PacketSize rays with a given voxel tree. The rays must
+    // share their origin and the signs of the components of their direction, and their
+    // extents must lie within the tree. The rays are traversed together front to back.
+    // Return a bit mask of the rays that found an intersection; the distance to the
+    // voxel is stored in distances[i] for every such ray i.
+    size_t intersect_packet(
+        const Tree&             tree,
+        const RayType           rays[],
+        const RayInfoType       ray_infos[],
+        const size_t            ray_count,
+        const bool              solid,
+        ValueType               distances[]) const;
+
   private:
     // Node stack size.
     static const size_t StackSize = S;
@@ -83,9 +102,89 @@ class Intersector
         ValueType           m_tfar;
         const NodeType*     m_node;
     };
+
+    // Entry of the node stack of packet traversals.
+    struct PacketNodeEntry
+    {
+        ValueType           m_tnear[PacketSize];
+        ValueType           m_tfar[PacketSize];
+        size_t              m_active;           // rays of the packet that reach the node
+        const NodeType*     m_node;
+    };
 };
 
 
+//
+// Compute the distances to a splitting plane along the rays of a packet, and the masks of
+// the active rays whose [tnear, tfar] segment lies in part in front of and behind the plane.
+//
+
+namespace voxel_impl
+{
+    template <typename T>
+    inline void classify_packet(
+        const T                 split_offset,   // splitting abscissa minus ray origin
+        const T                 rcp_dir[4],
+        const T                 tnear[4],
+        const T                 tfar[4],
+        const size_t            active,
+        T                       t[4],
+        size_t&                 front,
+        size_t&                 back)
+    {
+        front = back = 0;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            t[i] = split_offset * rcp_dir[i];
+
+            if (!(t[i] < tnear[i]))
+                front |= size_t(1) << i;
+
+            if (t[i] < tfar[i])
+                back |= size_t(1) << i;
+        }
+
+        front &= active;
+        back &= active;
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    template <>
+    inline void classify_packet<double>(
+        const double            split_offset,
+        const double            rcp_dir[4],
+        const double            tnear[4],
+        const double            tfar[4],
+        const size_t            active,
+        double                  t[4],
+        size_t&                 front,
+        size_t&                 back)
+    {
+        const __m128d offset = _mm_set1_pd(split_offset);
+        const __m128d t01 = _mm_mul_pd(offset, _mm_loadu_pd(rcp_dir));
+        const __m128d t23 = _mm_mul_pd(offset, _mm_loadu_pd(rcp_dir + 2));
+
+        _mm_storeu_pd(t, t01);
+        _mm_storeu_pd(t + 2, t23);
+
+        const int front_mask =
+              _mm_movemask_pd(_mm_cmpnlt_pd(t01, _mm_loadu_pd(tnear)))
+            | (_mm_movemask_pd(_mm_cmpnlt_pd(t23, _mm_loadu_pd(tnear + 2))) << 2);
+
+        const int back_mask =
+              _mm_movemask_pd(_mm_cmplt_pd(t01, _mm_loadu_pd(tfar)))
+            | (_mm_movemask_pd(_mm_cmplt_pd(t23, _mm_loadu_pd(tfar + 2))) << 2);
+
+        front = static_cast<size_t>(front_mask) & active;
+        back = static_cast<size_t>(back_mask) & active;
+    }
+
+#endif  // APPLESEED_USE_SSE
+}
+
+
 //
 // Intersector class implementation.
 //
@@ -200,6 +299,152 @@ bool Intersector<T, Tree, S>::intersect(
     }
 }
 
+template <typename T, typename Tree, size_t S>
+size_t Intersector<T, Tree, S>::intersect_packet(
+    const Tree&             tree,
+    const RayType           rays[],
+    const RayInfoType       ray_infos[],
+    const size_t            ray_count,
+    const bool              solid,
+    ValueType               distances[]) const
+{
+    assert(!tree.m_nodes.empty());
+    assert(ray_count > 0 && ray_count <= PacketSize);
+
+    // Lay out the rays in structure-of-arrays form. Unused lanes are filled with the last ray.
+    ValueType rcp_dir[Tree::Dimension][PacketSize];
+    ValueType tnear[PacketSize];
+    ValueType tfar[PacketSize];
+
+    for (size_t i = 0; i < PacketSize; ++i)
+    {
+        const size_t r = i < ray_count ? i : ray_count - 1;
+
+        assert(rays[r].m_org == rays[0].m_org);
+        assert(ray_infos[r].m_sgn_dir == ray_infos[0].m_sgn_dir);
+
+        for (size_t d = 0; d < Tree::Dimension; ++d)
+            rcp_dir[d][i] = ray_infos[r].m_rcp_dir[d];
+
+        tnear[i] = rays[r].m_tmin;
+        tfar[i] = rays[r].m_tmax;
+    }
+
+    const size_t all_rays = (size_t(1) << ray_count) - 1;
+    size_t active = all_rays;
+    size_t hits = 0;
+
+    // Initialize the node stack.
+    PacketNodeEntry  stack[StackSize];
+    PacketNodeEntry* stack_ptr = stack;
+
+    // Start at the root node.
+    const NodeType* node = &tree.m_nodes.front();
+
+    // Traverse the tree and intersect leaf nodes.
+    while (true)
+    {
+        // Traverse the tree until a leaf is reached.
+        while (node->is_interior())
+        {
+            // Get the splitting dimension and abscissa.
+            const size_t split_dim = node->get_split_dim();
+            const ValueType split_abs = static_cast<ValueType>(node->get_split_abs());
+
+            // Compute the intersection of the splitting plane with the rays and find the rays
+            // that need to visit the front and the back nodes.
+            ValueType t[PacketSize];
+            size_t front, back;
+            voxel_impl::classify_packet(
+                split_abs - rays[0].m_org[split_dim],
+                rcp_dir[split_dim],
+                tnear,
+                tfar,
+                active,
+                t,
+                front,
+                back);
+
+            // Get child node index and ray direction sign.
+            node = &tree.m_nodes[node->get_child_node_index()];
+            const size_t sgn_dir = ray_infos[0].m_sgn_dir[split_dim];
+
+            if (front == 0)
+            {
+                // Follow the back node.
+                for (size_t i = 0; i < PacketSize; ++i)
+                {
+                    if (t[i] > tnear[i])
+                        tnear[i] = t[i];
+                }
+
+                active = back;
+                node += sgn_dir;
+            }
+            else
+            {
+                if (back != 0)
+                {
+                    // Push the back node on the stack, with the rays that reach it.
+                    assert(stack_ptr < &stack[StackSize]);
+                    for (size_t i = 0; i < PacketSize; ++i)
+                    {
+                        stack_ptr->m_tnear[i] = t[i] > tnear[i] ? t[i] : tnear[i];
+                        stack_ptr->m_tfar[i] = tfar[i];
+                    }
+                    stack_ptr->m_active = back;
+                    stack_ptr->m_node = node + sgn_dir;
+                    ++stack_ptr;
+                }
+
+                // Follow the front node.
+                for (size_t i = 0; i < PacketSize; ++i)
+                {
+                    if (t[i] < tfar[i])
+                        tfar[i] = t[i];
+                }
+
+                active = front;
+                node += 1 - sgn_dir;
+            }
+        }
+
+        // Rays terminate as soon as they hit a solid/empty leaf.
+        if (node->is_solid() == solid)
+        {
+            for (size_t i = 0; i < ray_count; ++i)
+            {
+                if (active & (size_t(1) << i))
+                    distances[i] = tnear[i];
+            }
+
+            hits |= active;
+
+            if (hits == all_rays)
+                return hits;
+        }
+
+        // Pop the next node visited by rays that did not terminate yet.
+        do
+        {
+            // Terminate traversal if there is no more nodes to visit.
+            if (stack_ptr == stack)
+                return hits;
+
+            --stack_ptr;
+            active = stack_ptr->m_active & ~hits;
+        } while (active == 0);
+
+        for (size_t i = 0; i < PacketSize; ++i)
+        {
+            tnear[i] = stack_ptr->m_tnear[i];
+            tfar[i] = stack_ptr->m_tfar[i];
+        }
+
+        node = stack_ptr->m_node;
+    }
+}
+
 #undef FOUNDATION_VOXEL_TRAVERSAL_STATS
 
 }   // namespace voxel
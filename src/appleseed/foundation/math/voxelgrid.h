@@ -34,6 +34,10 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cassert>
@@ -46,6 +50,14 @@ namespace foundation
 //
 // A regular 3D grid of voxel.
 //
+// Voxels are either stored row by row and slice by slice, or by bricks of 4x4x4 voxels.
+// In the bricked layout, the voxels of a brick are stored in Morton order and bricks are
+// stored row by row and slice by slice, so that the voxels read by lookups at nearby
+// points, such as the successive steps of a ray march, are close to each other in memory.
+//
+// With both layouts, the offset of a voxel is the sum of independent offsets along
+// each axis; they are precomputed for the bricked layout.
+//
 
 template <typename ValueType, typename CoordType>
 class VoxelGrid3
@@ -55,18 +67,30 @@ class VoxelGrid3
     // Types.
     typedef Vector<CoordType, 3> PointType;
 
+    // Storage layouts.
+    enum Layout
+    {
+        LinearLayout,                           // row by row, slice by slice
+        BrickedLayout                           // bricks of 4x4x4 voxels in Morton order
+    };
+
+    // Number of points processed together by batched lookups.
+    static const size_t BatchSize = 4;
+
     // Constructor.
     VoxelGrid3(
         const size_t        nx,
         const size_t        ny,
         const size_t        nz,
-        const size_t        channel_count);
+        const size_t        channel_count,
+        const Layout        layout = LinearLayout);
 
     // Get the grid properties.
     size_t get_xres() const;
     size_t get_yres() const;
     size_t get_zres() const;
     size_t get_channel_count() const;
+    Layout get_layout() const;
 
     // Direct access to a given voxel.
     ValueType* voxel(
@@ -96,6 +120,13 @@ class VoxelGrid3
         const PointType&    point,
         ValueType*          values) const;
 
+    // Perform trilinearly interpolated lookups at a batch of points, BatchSize points
+    // at a time. Values are written consecutively, channel_count values per point.
+    void linear_lookup(
+        const size_t        count,
+        const PointType*    points,
+        ValueType*          values) const;
+
   private:
     const size_t            m_nx;
     const size_t            m_ny;
@@ -109,10 +140,173 @@ class VoxelGrid3
     const size_t            m_channel_count;
     const size_t            m_row_size;
     const size_t            m_slice_size;
+    const Layout            m_layout;
+    std::vector<size_t>     m_x_offsets;        // bricked layout only: offsets of voxels, by axis
+    std::vector<size_t>     m_y_offsets;
+    std::vector<size_t>     m_z_offsets;
     std::vector<ValueType>  m_values;
+
+    void initialize_storage();
+
+    size_t get_x_offset(const size_t x) const;
+    size_t get_y_offset(const size_t y) const;
+    size_t get_z_offset(const size_t z) const;
+
+    size_t get_offset(
+        const size_t        x,
+        const size_t        y,
+        const size_t        z) const;
+
+    // Compute pointers to the values of the 8 voxels surrounding a lookup point.
+    void get_linear_sources(
+        const size_t        ix,
+        const size_t        iy,
+        const size_t        iz,
+        const ValueType*    src[8]) const;
+
+    // Interpolate the values of the 8 voxels surrounding a lookup point.
+    void blend_linear(
+        const ValueType* const  src[8],
+        const ValueType         x1,
+        const ValueType         y1,
+        const ValueType         z1,
+        ValueType*              values) const;
 };
 
 
+//
+// Blend the values of the 8 voxels surrounding a lookup point.
+//
+
+namespace voxelgrid_impl
+{
+    template <typename ValueType>
+    inline void blend_linear(
+        const size_t                        channel_count,
+        const ValueType* const              src[8],
+        const ValueType                     w[8],
+        ValueType* APPLESEED_RESTRICT       values)
+    {
+        for (size_t i = 0; i < channel_count; ++i)
+        {
+            values[i] =
+                src[0][i] * w[0] +
+                src[1][i] * w[1] +
+                src[2][i] * w[2] +
+                src[3][i] * w[3] +
+                src[4][i] * w[4] +
+                src[5][i] * w[5] +
+                src[6][i] * w[6] +
+                src[7][i] * w[7];
+        }
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    template <>
+    inline void blend_linear<float>(
+        const size_t                        channel_count,
+        const float* const                  src[8],
+        const float                         w[8],
+        float* APPLESEED_RESTRICT           values)
+    {
+        // Blend four channels at a time.
+        size_t i = 0;
+
+        for (; i + 4 <= channel_count; i += 4)
+        {
+            __m128 v = _mm_mul_ps(_mm_loadu_ps(src[0] + i), _mm_set1_ps(w[0]));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(src[1] + i), _mm_set1_ps(w[1])));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(src[2] + i), _mm_set1_ps(w[2])));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(src[3] + i), _mm_set1_ps(w[3])));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(src[4] + i), _mm_set1_ps(w[4])));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(src[5] + i), _mm_set1_ps(w[5])));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(src[6] + i), _mm_set1_ps(w[6])));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(src[7] + i), _mm_set1_ps(w[7])));
+            _mm_storeu_ps(values + i, v);
+        }
+
+        for (; i < channel_count; ++i)
+        {
+            values[i] =
+                src[0][i] * w[0] +
+                src[1][i] * w[1] +
+                src[2][i] * w[2] +
+                src[3][i] * w[3] +
+                src[4][i] * w[4] +
+                src[5][i] * w[5] +
+                src[6][i] * w[6] +
+                src[7][i] * w[7];
+        }
+    }
+
+#endif  // APPLESEED_USE_SSE
+
+    // Compute the coordinates of the voxels containing four lookup points together
+    // with the interpolation weights of their upper neighbors.
+    template <typename ValueType, typename CoordType>
+    inline void compute_linear_coords(
+        const Vector<CoordType, 3>          points[4],
+        const Vector<CoordType, 3>&         max_coords,
+        size_t                              indices[3][4],
+        ValueType                           weights[3][4])
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            for (size_t d = 0; d < 3; ++d)
+            {
+                const CoordType x = saturate(points[j][d]) * max_coords[d];
+                indices[d][j] = truncate<size_t>(x);
+                weights[d][j] = static_cast<ValueType>(x - indices[d][j]);
+            }
+        }
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    template <>
+    inline void compute_linear_coords<float, double>(
+        const Vector<double, 3>             points[4],
+        const Vector<double, 3>&            max_coords,
+        size_t                              indices[3][4],
+        float                               weights[3][4])
+    {
+        const __m128d zero = _mm_setzero_pd();
+        const __m128d one = _mm_set1_pd(1.0);
+
+        for (size_t d = 0; d < 3; ++d)
+        {
+            const __m128d m = _mm_set1_pd(max_coords[d]);
+
+            // Voxel coordinates are within [0, max_coords[d]] and fit in 32-bit integers.
+            const __m128d x01 = _mm_mul_pd(_mm_min_pd(_mm_max_pd(_mm_set_pd(points[1][d], points[0][d]), zero), one), m);
+            const __m128d x23 = _mm_mul_pd(_mm_min_pd(_mm_max_pd(_mm_set_pd(points[3][d], points[2][d]), zero), one), m);
+            const __m128i i01 = _mm_cvttpd_epi32(x01);
+            const __m128i i23 = _mm_cvttpd_epi32(x23);
+            const __m128 w01 = _mm_cvtpd_ps(_mm_sub_pd(x01, _mm_cvtepi32_pd(i01)));
+            const __m128 w23 = _mm_cvtpd_ps(_mm_sub_pd(x23, _mm_cvtepi32_pd(i23)));
+
+            APPLESEED_SIMD4_ALIGN int32 i[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(i), _mm_unpacklo_epi64(i01, i23));
+            _mm_storeu_ps(weights[d], _mm_movelh_ps(w01, w23));
+
+            indices[d][0] = static_cast<size_t>(i[0]);
+            indices[d][1] = static_cast<size_t>(i[1]);
+            indices[d][2] = static_cast<size_t>(i[2]);
+            indices[d][3] = static_cast<size_t>(i[3]);
+        }
+    }
+
+#endif  // APPLESEED_USE_SSE
+
+    // Spread the two lowest bits of a coordinate three bits apart.
+    inline size_t spread_brick_bits(const size_t x)
+    {
+        return (x & 1) | ((x & 2) << 2);
+    }
+}
+
+
 //
 // VoxelGrid3 class implementation.
 //
@@ -122,7 +316,8 @@ VoxelGrid3<ValueType, CoordType>::VoxelGrid3(
     const size_t            nx,
     const size_t            ny,
     const size_t            nz,
-    const size_t            channel_count)
+    const size_t            channel_count,
+    const Layout            layout)
   : m_nx(nx)
   , m_ny(ny)
   , m_nz(nz)
@@ -135,12 +330,46 @@ VoxelGrid3<ValueType, CoordType>::VoxelGrid3(
   , m_channel_count(channel_count)
   , m_row_size(channel_count * nx)          // number of values in one row of voxels
   , m_slice_size(channel_count * nx * ny)   // number of values in one slice of voxels
-  , m_values(nx * ny * nz * channel_count, ValueType(0.0))
+  , m_layout(layout)
 {
     assert(m_nx > 0);
     assert(m_ny > 0);
     assert(m_nz > 0);
     assert(m_channel_count > 0);
+
+    initialize_storage();
+}
+
+template <typename ValueType, typename CoordType>
+void VoxelGrid3<ValueType, CoordType>::initialize_storage()
+{
+    if (m_layout == LinearLayout)
+        m_values.assign(m_nx * m_ny * m_nz * m_channel_count, ValueType(0.0));
+    else
+    {
+        using namespace voxelgrid_impl;
+
+        m_x_offsets.resize(m_nx);
+        m_y_offsets.resize(m_ny);
+        m_z_offsets.resize(m_nz);
+
+        // The grid is padded to an integer number of bricks.
+        const size_t brick_size = 4 * 4 * 4 * m_channel_count;
+        const size_t bnx = (m_nx + 3) / 4;
+        const size_t bny = (m_ny + 3) / 4;
+        const size_t bnz = (m_nz + 3) / 4;
+
+        for (size_t x = 0; x < m_nx; ++x)
+            m_x_offsets[x] = (x / 4) * brick_size + spread_brick_bits(x & 3) * m_channel_count;
+
+        for (size_t y = 0; y < m_ny; ++y)
+            m_y_offsets[y] = (y / 4) * bnx * brick_size + (spread_brick_bits(y & 3) << 1) * m_channel_count;
+
+        for (size_t z = 0; z < m_nz; ++z)
+            m_z_offsets[z] = (z / 4) * bnx * bny * brick_size + (spread_brick_bits(z & 3) << 2) * m_channel_count;
+
+        m_values.assign(bnx * bny * bnz * brick_size, ValueType(0.0));
+    }
 }
 
 template <typename ValueType, typename CoordType>
@@ -167,16 +396,49 @@ APPLESEED_FORCE_INLINE size_t VoxelGrid3<ValueType, CoordType>::get_channel_coun
     return m_channel_count;
 }
 
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE typename VoxelGrid3<ValueType, CoordType>::Layout VoxelGrid3<ValueType, CoordType>::get_layout() const
+{
+    return m_layout;
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t VoxelGrid3<ValueType, CoordType>::get_x_offset(const size_t x) const
+{
+    assert(x < m_nx);
+    return m_layout == LinearLayout ? x * m_channel_count : m_x_offsets[x];
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t VoxelGrid3<ValueType, CoordType>::get_y_offset(const size_t y) const
+{
+    assert(y < m_ny);
+    return m_layout == LinearLayout ? y * m_row_size : m_y_offsets[y];
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t VoxelGrid3<ValueType, CoordType>::get_z_offset(const size_t z) const
+{
+    assert(z < m_nz);
+    return m_layout == LinearLayout ? z * m_slice_size : m_z_offsets[z];
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE size_t VoxelGrid3<ValueType, CoordType>::get_offset(
+    const size_t            x,
+    const size_t            y,
+    const size_t            z) const
+{
+    return get_x_offset(x) + get_y_offset(y) + get_z_offset(z);
+}
+
 template <typename ValueType, typename CoordType>
 APPLESEED_FORCE_INLINE ValueType* VoxelGrid3<ValueType, CoordType>::voxel(
     const size_t            x,
     const size_t            y,
     const size_t            z)
 {
-    assert(x < m_nx);
-    assert(y < m_ny);
-    assert(z < m_nz);
-    return &m_values[((z * m_ny + y) * m_nx + x) * m_channel_count];
+    return &m_values[get_offset(x, y, z)];
 }
 
 template <typename ValueType, typename CoordType>
@@ -185,10 +447,7 @@ APPLESEED_FORCE_INLINE const ValueType* VoxelGrid3<ValueType, CoordType>::voxel(
     const size_t            y,
     const size_t            z) const
 {
-    assert(x < m_nx);
-    assert(y < m_ny);
-    assert(z < m_nz);
-    return &m_values[((z * m_ny + y) * m_nx + x) * m_channel_count];
+    return &m_values[get_offset(x, y, z)];
 }
 
 template <typename ValueType, typename CoordType>
@@ -223,10 +482,106 @@ void VoxelGrid3<ValueType, CoordType>::linear_lookup(
     const size_t iy = truncate<size_t>(y);
     const size_t iz = truncate<size_t>(z);
 
+    // Compute source pointers.
+    const ValueType* src[8];
+    get_linear_sources(ix, iy, iz, src);
+
+    // Compute interpolation weights and blend.
+    blend_linear(
+        src,
+        static_cast<ValueType>(x - ix),
+        static_cast<ValueType>(y - iy),
+        static_cast<ValueType>(z - iz),
+        values);
+}
+
+template <typename ValueType, typename CoordType>
+void VoxelGrid3<ValueType, CoordType>::linear_lookup(
+    const size_t                    count,
+    const PointType*                points,
+    ValueType* APPLESEED_RESTRICT   values) const
+{
+    const PointType max_coords(m_max_x, m_max_y, m_max_z);
+    size_t p = 0;
+
+    for (; p + BatchSize <= count; p += BatchSize)
+    {
+        // Compute the coordinates of the voxels containing the lookup points and interpolation weights.
+        size_t indices[3][BatchSize];
+        ValueType weights[3][BatchSize];
+        voxelgrid_impl::compute_linear_coords(points + p, max_coords, indices, weights);
+
+        for (size_t j = 0; j < BatchSize; ++j)
+        {
+            // Compute source pointers.
+            const ValueType* src[8];
+            get_linear_sources(indices[0][j], indices[1][j], indices[2][j], src);
+
+            // Blend.
+            blend_linear(src, weights[0][j], weights[1][j], weights[2][j], values);
+            values += m_channel_count;
+        }
+    }
+
+    for (; p < count; ++p)
+    {
+        linear_lookup(points[p], values);
+        values += m_channel_count;
+    }
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE void VoxelGrid3<ValueType, CoordType>::get_linear_sources(
+    const size_t                    ix,
+    const size_t                    iy,
+    const size_t                    iz,
+    const ValueType*                src[8]) const
+{
+    assert(ix < m_nx);
+    assert(iy < m_ny);
+    assert(iz < m_nz);
+
+    size_t offset, dx, dy, dz;
+
+    if (m_layout == LinearLayout)
+    {
+        offset = iz * m_slice_size + iy * m_row_size + ix * m_channel_count;
+        dx = ix == m_nx - 1 ? 0 : m_channel_count;
+        dy = iy == m_ny - 1 ? 0 : m_row_size;
+        dz = iz == m_nz - 1 ? 0 : m_slice_size;
+    }
+    else
+    {
+        offset = m_x_offsets[ix] + m_y_offsets[iy] + m_z_offsets[iz];
+        dx = ix == m_nx - 1 ? 0 : m_x_offsets[ix + 1] - m_x_offsets[ix];
+        dy = iy == m_ny - 1 ? 0 : m_y_offsets[iy + 1] - m_y_offsets[iy];
+        dz = iz == m_nz - 1 ? 0 : m_z_offsets[iz + 1] - m_z_offsets[iz];
+    }
+
+    const ValueType* src000 = &m_values[offset];
+    const ValueType* src100 = src000 + dx;
+    const ValueType* src010 = src000 + dy;
+    const ValueType* src110 = src100 + dy;
+
+    src[0] = src000;
+    src[1] = src100;
+    src[2] = src010;
+    src[3] = src110;
+    src[4] = src000 + dz;
+    src[5] = src100 + dz;
+    src[6] = src010 + dz;
+    src[7] = src110 + dz;
+}
+
+template <typename ValueType, typename CoordType>
+APPLESEED_FORCE_INLINE void VoxelGrid3<ValueType, CoordType>::blend_linear(
+    const ValueType* const          src[8],
+    const ValueType                 x1,
+    const ValueType                 y1,
+    const ValueType                 z1,
+    ValueType* APPLESEED_RESTRICT   values) const
+{
     // Compute interpolation weights.
-    const ValueType x1 = static_cast<ValueType>(x - ix);
-    const ValueType y1 = static_cast<ValueType>(y - iy);
-    const ValueType z1 = static_cast<ValueType>(z - iz);
     const ValueType x0 = ValueType(1.0) - x1;
     const ValueType y0 = ValueType(1.0) - y1;
     const ValueType z0 = ValueType(1.0) - z1;
@@ -234,42 +589,20 @@ void VoxelGrid3<ValueType, CoordType>::linear_lookup(
     const ValueType y1z0 = y1 * z0;
     const ValueType y0z1 = y0 * z1;
     const ValueType y1z1 = y1 * z1;
-    const ValueType w000 = x0 * y0z0;
-    const ValueType w100 = x1 * y0z0;
-    const ValueType w010 = x0 * y1z0;
-    const ValueType w110 = x1 * y1z0;
-    const ValueType w001 = x0 * y0z1;
-    const ValueType w101 = x1 * y0z1;
-    const ValueType w011 = x0 * y1z1;
-    const ValueType w111 = x1 * y1z1;
-
-    // Compute source pointers.
-    const size_t dx = ix == m_nx - 1 ? 0 : m_channel_count;
-    const size_t dy = iy == m_ny - 1 ? 0 : m_row_size;
-    const size_t dz = iz == m_nz - 1 ? 0 : m_slice_size;
-    const ValueType* APPLESEED_RESTRICT src = voxel(ix, iy, iz);
-    const ValueType* APPLESEED_RESTRICT src000 = src;
-    const ValueType* APPLESEED_RESTRICT src100 = src + dx;
-    const ValueType* APPLESEED_RESTRICT src010 = src + dy;
-    const ValueType* APPLESEED_RESTRICT src001 = src + dz;
-    const ValueType* APPLESEED_RESTRICT src110 = src100 + dy;
-    const ValueType* APPLESEED_RESTRICT src101 = src100 + dz;
-    const ValueType* APPLESEED_RESTRICT src011 = src010 + dz;
-    const ValueType* APPLESEED_RESTRICT src111 = src110 + dz;
+    const ValueType w[8] =
+    {
+        x0 * y0z0,      // w000
+        x1 * y0z0,      // w100
+        x0 * y1z0,      // w010
+        x1 * y1z0,      // w110
+        x0 * y0z1,      // w001
+        x1 * y0z1,      // w101
+        x0 * y1z1,      // w011
+        x1 * y1z1       // w111
+    };
 
     // Blend.
-    for (size_t i = 0; i < m_channel_count; ++i)
-    {
-       *values++ =
-           *src000++ * w000 +
-           *src100++ * w100 +
-           *src010++ * w010 +
-           *src110++ * w110 +
-           *src001++ * w001 +
-           *src101++ * w101 +
-           *src011++ * w011 +
-           *src111++ * w111;
-    }
+    voxelgrid_impl::blend_linear(m_channel_count, src, w, values);
 }
 
 template <typename ValueType, typename CoordType>
@@ -337,40 +670,43 @@ void VoxelGrid3<ValueType, CoordType>::quadratic_lookup(
     const ValueType wz0 = wz2 - tz + ValueType(0.5);
 
     // Compute source pointers.
-    const size_t dxn = ix == 0 ? 0 : m_channel_count;
-    const size_t dyn = iy == 0 ? 0 : m_row_size;
-    const size_t dzn = iz == 0 ? 0 : m_slice_size;
-    const size_t dxp = ix == m_nx - 1 ? 0 : m_channel_count;
-    const size_t dyp = iy == m_ny - 1 ? 0 : m_row_size;
-    const size_t dzp = iz == m_nz - 1 ? 0 : m_slice_size;
-    const ValueType* APPLESEED_RESTRICT src = voxel(ix, iy, iz);
-    const ValueType* APPLESEED_RESTRICT src111 = src;
-    const ValueType* APPLESEED_RESTRICT src011 = src111 - dxn;
-    const ValueType* APPLESEED_RESTRICT src211 = src111 + dxp;
-    const ValueType* APPLESEED_RESTRICT src101 = src111 - dyn;
-    const ValueType* APPLESEED_RESTRICT src001 = src011 - dyn;
-    const ValueType* APPLESEED_RESTRICT src201 = src211 - dyn;
-    const ValueType* APPLESEED_RESTRICT src121 = src111 + dyp;
-    const ValueType* APPLESEED_RESTRICT src021 = src011 + dyp;
-    const ValueType* APPLESEED_RESTRICT src221 = src211 + dyp;
-    const ValueType* APPLESEED_RESTRICT src110 = src111 - dzn;
-    const ValueType* APPLESEED_RESTRICT src010 = src011 - dzn;
-    const ValueType* APPLESEED_RESTRICT src210 = src211 - dzn;
-    const ValueType* APPLESEED_RESTRICT src100 = src101 - dzn;
-    const ValueType* APPLESEED_RESTRICT src000 = src001 - dzn;
-    const ValueType* APPLESEED_RESTRICT src200 = src201 - dzn;
-    const ValueType* APPLESEED_RESTRICT src120 = src121 - dzn;
-    const ValueType* APPLESEED_RESTRICT src020 = src021 - dzn;
-    const ValueType* APPLESEED_RESTRICT src220 = src221 - dzn;
-    const ValueType* APPLESEED_RESTRICT src112 = src111 + dzp;
-    const ValueType* APPLESEED_RESTRICT src012 = src011 + dzp;
-    const ValueType* APPLESEED_RESTRICT src212 = src211 + dzp;
-    const ValueType* APPLESEED_RESTRICT src102 = src101 + dzp;
-    const ValueType* APPLESEED_RESTRICT src002 = src001 + dzp;
-    const ValueType* APPLESEED_RESTRICT src202 = src201 + dzp;
-    const ValueType* APPLESEED_RESTRICT src122 = src121 + dzp;
-    const ValueType* APPLESEED_RESTRICT src022 = src021 + dzp;
-    const ValueType* APPLESEED_RESTRICT src222 = src221 + dzp;
+    const size_t x1o = get_x_offset(ix);
+    const size_t y1o = get_y_offset(iy);
+    const size_t z1o = get_z_offset(iz);
+    const size_t x0o = ix == 0 ? x1o : get_x_offset(ix - 1);
+    const size_t y0o = iy == 0 ? y1o : get_y_offset(iy - 1);
+    const size_t z0o = iz == 0 ? z1o : get_z_offset(iz - 1);
+    const size_t x2o = ix == m_nx - 1 ? x1o : get_x_offset(ix + 1);
+    const size_t y2o = iy == m_ny - 1 ? y1o : get_y_offset(iy + 1);
+    const size_t z2o = iz == m_nz - 1 ? z1o : get_z_offset(iz + 1);
+    const ValueType* base = &m_values[0];
+    const ValueType* APPLESEED_RESTRICT src000 = base + x0o + y0o + z0o;
+    const ValueType* APPLESEED_RESTRICT src100 = base + x1o + y0o + z0o;
+    const ValueType* APPLESEED_RESTRICT src200 = base + x2o + y0o + z0o;
+    const ValueType* APPLESEED_RESTRICT src010 = base + x0o + y1o + z0o;
+    const ValueType* APPLESEED_RESTRICT src110 = base + x1o + y1o + z0o;
+    const ValueType* APPLESEED_RESTRICT src210 = base + x2o + y1o + z0o;
+    const ValueType* APPLESEED_RESTRICT src020 = base + x0o + y2o + z0o;
+    const ValueType* APPLESEED_RESTRICT src120 = base + x1o + y2o + z0o;
+    const ValueType* APPLESEED_RESTRICT src220 = base + x2o + y2o + z0o;
+    const ValueType* APPLESEED_RESTRICT src001 = base + x0o + y0o + z1o;
+    const ValueType* APPLESEED_RESTRICT src101 = base + x1o + y0o + z1o;
+    const ValueType* APPLESEED_RESTRICT src201 = base + x2o + y0o + z1o;
+    const ValueType* APPLESEED_RESTRICT src011 = base + x0o + y1o + z1o;
+    const ValueType* APPLESEED_RESTRICT src111 = base + x1o + y1o + z1o;
+    const ValueType* APPLESEED_RESTRICT src211 = base + x2o + y1o + z1o;
+    const ValueType* APPLESEED_RESTRICT src021 = base + x0o + y2o + z1o;
+    const ValueType* APPLESEED_RESTRICT src121 = base + x1o + y2o + z1o;
+    const ValueType* APPLESEED_RESTRICT src221 = base + x2o + y2o + z1o;
+    const ValueType* APPLESEED_RESTRICT src002 = base + x0o + y0o + z2o;
+    const ValueType* APPLESEED_RESTRICT src102 = base + x1o + y0o + z2o;
+    const ValueType* APPLESEED_RESTRICT src202 = base + x2o + y0o + z2o;
+    const ValueType* APPLESEED_RESTRICT src012 = base + x0o + y1o + z2o;
+    const ValueType* APPLESEED_RESTRICT src112 = base + x1o + y1o + z2o;
+    const ValueType* APPLESEED_RESTRICT src212 = base + x2o + y1o + z2o;
+    const ValueType* APPLESEED_RESTRICT src022 = base + x0o + y2o + z2o;
+    const ValueType* APPLESEED_RESTRICT src122 = base + x1o + y2o + z2o;
+    const ValueType* APPLESEED_RESTRICT src222 = base + x2o + y2o + z2o;
 
     // Blend.
     for (size_t i = 0; i < m_channel_count; ++i)
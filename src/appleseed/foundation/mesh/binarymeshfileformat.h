@@ -0,0 +1,90 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+namespace foundation
+{
+
+//
+// On-disk layout of version 5 of the binarymesh file format.
+//
+// Version 5 stores geometry uncompressed, in structure-of-arrays form, so that
+// files can be memory-mapped and read without going through a decompressor.
+//
+// The file starts with the usual signature and version number, followed by
+// padding up to the first page boundary. Each mesh then occupies a block that
+// starts on a page boundary and begins with a BinaryMeshBlockHeader. All offsets
+// stored in the header are relative to the start of the block, and all sections
+// start on a page boundary:
+//
+//   vertices               vertex_count        x Vector3f
+//   vertex normals         normal_count        x Vector3f
+//   texture coordinates    tex_coords_count    x Vector2f
+//   face vertex counts     face_count          x uint16    (absent if AllTriangles is set)
+//   face vertices          face_vertex_count   x uint32
+//   face vertex normals    face_vertex_count   x uint32
+//   face texture coords    face_vertex_count   x uint32
+//   face materials         face_count          x uint16
+//   strings                mesh name followed by material slot names,
+//                          each stored as a uint16 length and the characters
+//
+
+const size_t BinaryMeshPageSize = 4096;
+
+struct BinaryMeshBlockHeader
+{
+    enum Flags
+    {
+        AllTriangles = 1UL << 0         // all faces are triangles
+    };
+
+    uint64  m_block_size;               // size in bytes of the whole block, a multiple of the page size
+    uint64  m_flags;
+    uint64  m_vertex_count;
+    uint64  m_vertices_offset;
+    uint64  m_normal_count;
+    uint64  m_normals_offset;
+    uint64  m_tex_coords_count;
+    uint64  m_tex_coords_offset;
+    uint64  m_material_slot_count;
+    uint64  m_face_count;
+    uint64  m_face_vertex_count;        // sum of the vertex counts of all faces
+    uint64  m_face_vertex_counts_offset;
+    uint64  m_face_vertices_offset;
+    uint64  m_face_normals_offset;
+    uint64  m_face_tex_coords_offset;
+    uint64  m_face_materials_offset;
+    uint64  m_strings_offset;
+    uint64  m_strings_size;
+};
+
+}   // namespace foundation
@@ -33,12 +33,15 @@
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionioerror.h"
 #include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfileformat.h"
 #include "foundation/mesh/imeshbuilder.h"
+#include "foundation/platform/memorymappedfile.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/bufferedfile.h"
 #include "foundation/utility/memory.h"
 
 // Standard headers.
+#include <cstddef>
 #include <cstring>
 #include <memory>
 
@@ -61,11 +64,14 @@ void BinaryMeshFileReader::read(IMeshBuilder& builder)
     BufferedFile file(
         m_filename.c_str(),
         BufferedFile::BinaryType,
-        BufferedFile::ReadMode);
+        BufferedFile::ReadMode,
+        BufferedFile::ReadAheadBufferSize);
 
     if (!file.is_open())
         throw ExceptionIOError();
 
+    file.enable_read_ahead();
+
     read_and_check_signature(file);
 
     uint16 version;
@@ -103,6 +109,12 @@ void BinaryMeshFileReader::read(IMeshBuilder& builder)
         }
         break;
 
+      // Uncompressed, single-precision, memory-mappable geometry.
+      case 5:
+        file.close();
+        read_mapped_meshes(builder);
+        break;
+
       // Unknown format.
       default:
         throw ExceptionIOError("unknown binarymesh format version");
@@ -266,4 +278,147 @@ void BinaryMeshFileReader::read_face(ReaderAdapter& reader, IMeshBuilder& builde
     builder.end_face();
 }
 
+namespace
+{
+    // Return the address of a section of a mapped mesh block, after checking that it fits in the block.
+    template <typename T>
+    const T* get_section(
+        const uint8*                    block,
+        const BinaryMeshBlockHeader&    header,
+        const uint64                    offset,
+        const uint64                    count)
+    {
+        if (offset > header.m_block_size ||
+            count > (header.m_block_size - offset) / sizeof(T))
+            throw ExceptionIOError("invalid binarymesh section");
+
+        return reinterpret_cast<const T*>(block + offset);
+    }
+
+    string read_mapped_string(const uint8*& ptr, const uint8* end)
+    {
+        uint16 length;
+
+        if (end - ptr < static_cast<ptrdiff_t>(sizeof(length)))
+            throw ExceptionIOError("invalid binarymesh string");
+
+        memcpy(&length, ptr, sizeof(length));
+        ptr += sizeof(length);
+
+        if (end - ptr < static_cast<ptrdiff_t>(length))
+            throw ExceptionIOError("invalid binarymesh string");
+
+        const string s(reinterpret_cast<const char*>(ptr), length);
+        ptr += length;
+
+        return s;
+    }
+}
+
+void BinaryMeshFileReader::read_mapped_meshes(IMeshBuilder& builder)
+{
+    MemoryMappedFile file;
+
+    if (!file.open(m_filename.c_str()))
+        throw ExceptionIOError();
+
+    const uint8* base = static_cast<const uint8*>(file.data());
+    const uint64 file_size = file.size();
+
+    // The first mesh block follows the signature and the version number, on the first page boundary.
+    uint64 block_offset = BinaryMeshPageSize;
+
+    while (block_offset < file_size)
+    {
+        if (file_size - block_offset < sizeof(BinaryMeshBlockHeader))
+            throw ExceptionIOError("truncated binarymesh file");
+
+        const uint8* block = base + block_offset;
+
+        BinaryMeshBlockHeader header;
+        memcpy(&header, block, sizeof(header));
+
+        if (header.m_block_size < sizeof(BinaryMeshBlockHeader) ||
+            header.m_block_size > file_size - block_offset)
+            throw ExceptionIOError("invalid binarymesh block size");
+
+        const Vector3f* vertices = get_section<Vector3f>(block, header, header.m_vertices_offset, header.m_vertex_count);
+        const Vector3f* normals = get_section<Vector3f>(block, header, header.m_normals_offset, header.m_normal_count);
+        const Vector2f* tex_coords = get_section<Vector2f>(block, header, header.m_tex_coords_offset, header.m_tex_coords_count);
+        const uint32* face_vertices = get_section<uint32>(block, header, header.m_face_vertices_offset, header.m_face_vertex_count);
+        const uint32* face_normals = get_section<uint32>(block, header, header.m_face_normals_offset, header.m_face_vertex_count);
+        const uint32* face_tex_coords = get_section<uint32>(block, header, header.m_face_tex_coords_offset, header.m_face_vertex_count);
+        const uint16* face_materials = get_section<uint16>(block, header, header.m_face_materials_offset, header.m_face_count);
+        const uint8* strings = get_section<uint8>(block, header, header.m_strings_offset, header.m_strings_size);
+        const uint8* strings_end = strings + header.m_strings_size;
+
+        const bool all_triangles = (header.m_flags & BinaryMeshBlockHeader::AllTriangles) != 0;
+
+        if (all_triangles && header.m_face_vertex_count != header.m_face_count * 3)
+            throw ExceptionIOError("invalid binarymesh face vertex count");
+
+        const string mesh_name = read_mapped_string(strings, strings_end);
+        builder.begin_mesh(mesh_name.c_str());
+
+        builder.push_vertex_array(vertices, static_cast<size_t>(header.m_vertex_count));
+        builder.push_vertex_normal_array(normals, static_cast<size_t>(header.m_normal_count));
+        builder.push_tex_coords_array(tex_coords, static_cast<size_t>(header.m_tex_coords_count));
+
+        for (uint64 i = 0; i < header.m_material_slot_count; ++i)
+        {
+            const string material_slot = read_mapped_string(strings, strings_end);
+            builder.push_material_slot(material_slot.c_str());
+        }
+
+        if (all_triangles)
+        {
+            builder.push_triangle_array(
+                face_vertices,
+                face_normals,
+                face_tex_coords,
+                face_materials,
+                static_cast<size_t>(header.m_face_count));
+        }
+        else
+        {
+            const uint16* face_vertex_counts =
+                get_section<uint16>(block, header, header.m_face_vertex_counts_offset, header.m_face_count);
+
+            uint64 first = 0;
+
+            for (uint64 i = 0; i < header.m_face_count; ++i)
+            {
+                const size_t count = face_vertex_counts[i];
+
+                if (count > header.m_face_vertex_count - first)
+                    throw ExceptionIOError("invalid binarymesh face vertex count");
+
+                ensure_minimum_size(m_vertices, count);
+                ensure_minimum_size(m_vertex_normals, count);
+                ensure_minimum_size(m_tex_coords, count);
+
+                for (size_t j = 0; j < count; ++j)
+                {
+                    m_vertices[j] = face_vertices[first + j];
+                    m_vertex_normals[j] = face_normals[first + j];
+                    m_tex_coords[j] = face_tex_coords[first + j];
+                }
+
+                builder.begin_face(count);
+                builder.set_face_vertices(&m_vertices[0]);
+                builder.set_face_vertex_normals(&m_vertex_normals[0]);
+                builder.set_face_vertex_tex_coords(&m_tex_coords[0]);
+                builder.set_face_material(face_materials[i]);
+                builder.end_face();
+
+                first += count;
+            }
+        }
+
+        builder.end_mesh();
+
+        block_offset += header.m_block_size;
+    }
+}
+
 }   // namespace foundation
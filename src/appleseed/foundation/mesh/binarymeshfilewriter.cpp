@@ -33,6 +33,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionioerror.h"
 #include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfileformat.h"
 #include "foundation/mesh/imeshwalker.h"
 #include "foundation/platform/types.h"
 
@@ -52,10 +53,21 @@ namespace
 {
     // Version of the BinaryMesh file format being written by this code.
     const uint16 Version = 4;
+
+    // Version written when the MemoryMappable option is set.
+    const uint16 MemoryMappableVersion = 5;
+
+    uint64 align_to_page(const uint64 offset)
+    {
+        return (offset + BinaryMeshPageSize - 1) & ~uint64(BinaryMeshPageSize - 1);
+    }
 }
 
-BinaryMeshFileWriter::BinaryMeshFileWriter(const string& filename)
+BinaryMeshFileWriter::BinaryMeshFileWriter(
+    const string&   filename,
+    const int       options)
   : m_filename(filename)
+  , m_options(options)
   , m_writer(m_file, 256 * 1024)
 {
 }
@@ -76,7 +88,9 @@ void BinaryMeshFileWriter::write(const IMeshWalker& walker)
         write_version();
     }
 
-    write_mesh(walker);
+    if (m_options & MemoryMappable)
+        write_mapped_mesh(walker);
+    else write_mesh(walker);
 }
 
 void BinaryMeshFileWriter::write_signature()
@@ -87,7 +101,12 @@ void BinaryMeshFileWriter::write_signature()
 
 void BinaryMeshFileWriter::write_version()
 {
-    checked_write(m_file, Version);
+    if (m_options & MemoryMappable)
+    {
+        checked_write(m_file, MemoryMappableVersion);
+        write_padding();
+    }
+    else checked_write(m_file, Version);
 }
 
 void BinaryMeshFileWriter::write_string(const char* s)
@@ -168,4 +187,134 @@ void BinaryMeshFileWriter::write_face(const IMeshWalker& walker, const size_t fa
     checked_write(m_writer, static_cast<uint16>(walker.get_face_material(face_index)));
 }
 
+void BinaryMeshFileWriter::write_padding()
+{
+    static const char Zeros[BinaryMeshPageSize] = { 0 };
+
+    const uint64 position = static_cast<uint64>(m_file.tell());
+    const size_t padding = static_cast<size_t>(align_to_page(position) - position);
+
+    if (padding > 0)
+        checked_write(m_file, Zeros, padding);
+}
+
+void BinaryMeshFileWriter::write_mapped_string(const char* s)
+{
+    const uint16 length = static_cast<uint16>(strlen(s));
+
+    checked_write(m_file, length);
+    checked_write(m_file, s, length);
+}
+
+void BinaryMeshFileWriter::write_mapped_mesh(const IMeshWalker& walker)
+{
+    const size_t vertex_count = walker.get_vertex_count();
+    const size_t normal_count = walker.get_vertex_normal_count();
+    const size_t tex_coords_count = walker.get_tex_coords_count();
+    const size_t material_slot_count = walker.get_material_slot_count();
+    const size_t face_count = walker.get_face_count();
+
+    // Gather the sizes of the variable-length sections.
+    size_t face_vertex_count = 0;
+    bool all_triangles = true;
+    for (size_t i = 0; i < face_count; ++i)
+    {
+        const size_t count = walker.get_face_vertex_count(i);
+        face_vertex_count += count;
+        if (count != 3)
+            all_triangles = false;
+    }
+
+    size_t strings_size = sizeof(uint16) + strlen(walker.get_name());
+    for (size_t i = 0; i < material_slot_count; ++i)
+        strings_size += sizeof(uint16) + strlen(walker.get_material_slot(i));
+
+    // Lay out the block: every section starts on a page boundary.
+    BinaryMeshBlockHeader header;
+    header.m_flags = all_triangles ? BinaryMeshBlockHeader::AllTriangles : 0;
+    header.m_vertex_count = vertex_count;
+    header.m_normal_count = normal_count;
+    header.m_tex_coords_count = tex_coords_count;
+    header.m_material_slot_count = material_slot_count;
+    header.m_face_count = face_count;
+    header.m_face_vertex_count = face_vertex_count;
+
+    uint64 offset = align_to_page(sizeof(BinaryMeshBlockHeader));
+    header.m_vertices_offset = offset;
+    offset = align_to_page(offset + vertex_count * sizeof(Vector3f));
+    header.m_normals_offset = offset;
+    offset = align_to_page(offset + normal_count * sizeof(Vector3f));
+    header.m_tex_coords_offset = offset;
+    offset = align_to_page(offset + tex_coords_count * sizeof(Vector2f));
+    header.m_face_vertex_counts_offset = offset;
+    if (!all_triangles)
+        offset = align_to_page(offset + face_count * sizeof(uint16));
+    header.m_face_vertices_offset = offset;
+    offset = align_to_page(offset + face_vertex_count * sizeof(uint32));
+    header.m_face_normals_offset = offset;
+    offset = align_to_page(offset + face_vertex_count * sizeof(uint32));
+    header.m_face_tex_coords_offset = offset;
+    offset = align_to_page(offset + face_vertex_count * sizeof(uint32));
+    header.m_face_materials_offset = offset;
+    offset = align_to_page(offset + face_count * sizeof(uint16));
+    header.m_strings_offset = offset;
+    header.m_strings_size = strings_size;
+    header.m_block_size = align_to_page(offset + strings_size);
+
+    checked_write(m_file, header);
+    write_padding();
+
+    for (size_t i = 0; i < vertex_count; ++i)
+        checked_write(m_file, Vector3f(walker.get_vertex(i)));
+    write_padding();
+
+    for (size_t i = 0; i < normal_count; ++i)
+        checked_write(m_file, Vector3f(walker.get_vertex_normal(i)));
+    write_padding();
+
+    for (size_t i = 0; i < tex_coords_count; ++i)
+        checked_write(m_file, Vector2f(walker.get_tex_coords(i)));
+    write_padding();
+
+    if (!all_triangles)
+    {
+        for (size_t i = 0; i < face_count; ++i)
+            checked_write(m_file, static_cast<uint16>(walker.get_face_vertex_count(i)));
+        write_padding();
+    }
+
+    for (size_t i = 0; i < face_count; ++i)
+    {
+        const size_t count = walker.get_face_vertex_count(i);
+        for (size_t j = 0; j < count; ++j)
+            checked_write(m_file, static_cast<uint32>(walker.get_face_vertex(i, j)));
+    }
+    write_padding();
+
+    for (size_t i = 0; i < face_count; ++i)
+    {
+        const size_t count = walker.get_face_vertex_count(i);
+        for (size_t j = 0; j < count; ++j)
+            checked_write(m_file, static_cast<uint32>(walker.get_face_vertex_normal(i, j)));
+    }
+    write_padding();
+
+    for (size_t i = 0; i < face_count; ++i)
+    {
+        const size_t count = walker.get_face_vertex_count(i);
+        for (size_t j = 0; j < count; ++j)
+            checked_write(m_file, static_cast<uint32>(walker.get_face_tex_coords(i, j)));
+    }
+    write_padding();
+
+    for (size_t i = 0; i < face_count; ++i)
+        checked_write(m_file, static_cast<uint16>(walker.get_face_material(i)));
+    write_padding();
+
+    write_mapped_string(walker.get_name());
+    for (size_t i = 0; i < material_slot_count; ++i)
+        write_mapped_string(walker.get_material_slot(i));
+    write_padding();
+}
+
 }   // namespace foundation
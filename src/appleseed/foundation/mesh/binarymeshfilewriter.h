@@ -52,14 +52,23 @@ class BinaryMeshFileWriter
   : public IMeshFileWriter
 {
   public:
+    enum Options
+    {
+        Default                 = 0,            // none of the flags below
+        MemoryMappable          = 1UL << 0      // write uncompressed, page-aligned geometry that can be memory-mapped
+    };
+
     // Constructor.
-    explicit BinaryMeshFileWriter(const std::string& filename);
+    explicit BinaryMeshFileWriter(
+        const std::string&  filename,
+        const int           options = Default);
 
     // Write a mesh.
     void write(const IMeshWalker& walker) override;
 
   private:
     const std::string           m_filename;
+    const int                   m_options;
     BufferedFile                m_file;
     LZ4CompressedWriterAdapter  m_writer;
 
@@ -74,6 +83,10 @@ class BinaryMeshFileWriter
     void write_material_slots(const IMeshWalker& walker);
     void write_faces(const IMeshWalker& walker);
     void write_face(const IMeshWalker& walker, const size_t face_index);
+
+    void write_padding();
+    void write_mapped_string(const char* s);
+    void write_mapped_mesh(const IMeshWalker& walker);
 };
 
 }   // namespace foundation
@@ -50,8 +50,11 @@ class APPLESEED_DLLSYMBOL GenericMeshFileWriter
   : public IMeshFileWriter
 {
   public:
-    // Constructor.
-    explicit GenericMeshFileWriter(const char* filename);
+    // Constructor. binarymesh_options is a combination of BinaryMeshFileWriter::Options
+    // flags and is only used when writing a binarymesh file.
+    explicit GenericMeshFileWriter(
+        const char*     filename,
+        const int       binarymesh_options = 0);
 
     // Destructor.
     ~GenericMeshFileWriter() override;
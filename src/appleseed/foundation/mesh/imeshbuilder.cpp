@@ -0,0 +1,79 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "imeshbuilder.h"
+
+namespace foundation
+{
+
+//
+// IMeshBuilder class implementation.
+//
+
+void IMeshBuilder::push_vertex_array(const Vector3f vertices[], const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        push_vertex(Vector3d(vertices[i]));
+}
+
+void IMeshBuilder::push_vertex_normal_array(const Vector3f vertex_normals[], const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        push_vertex_normal(Vector3d(vertex_normals[i]));
+}
+
+void IMeshBuilder::push_tex_coords_array(const Vector2f tex_coords[], const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        push_tex_coords(Vector2d(tex_coords[i]));
+}
+
+void IMeshBuilder::push_triangle_array(
+    const uint32    vertices[],
+    const uint32    vertex_normals[],
+    const uint32    tex_coords[],
+    const uint16    materials[],
+    const size_t    count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t face_vertices[3] = { vertices[i * 3 + 0], vertices[i * 3 + 1], vertices[i * 3 + 2] };
+        const size_t face_vertex_normals[3] = { vertex_normals[i * 3 + 0], vertex_normals[i * 3 + 1], vertex_normals[i * 3 + 2] };
+        const size_t face_tex_coords[3] = { tex_coords[i * 3 + 0], tex_coords[i * 3 + 1], tex_coords[i * 3 + 2] };
+
+        begin_face(3);
+        set_face_vertices(face_vertices);
+        set_face_vertex_normals(face_vertex_normals);
+        set_face_vertex_tex_coords(face_tex_coords);
+        set_face_material(materials[i]);
+        end_face();
+    }
+}
+
+}   // namespace foundation
@@ -32,6 +32,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 
 // appleseed.main headers.
 #include "main/dllsymbol.h"
@@ -68,6 +69,18 @@ class APPLESEED_DLLSYMBOL IMeshBuilder
     // Return the index of the vector within the mesh.
     virtual size_t push_tex_coords(const Vector2d& v) = 0;
 
+    // Append an array of vertices to the mesh.
+    // The default implementation calls push_vertex() for each vertex.
+    virtual void push_vertex_array(const Vector3f vertices[], const size_t count);
+
+    // Append an array of vertex normals to the mesh.
+    // The default implementation calls push_vertex_normal() for each normal.
+    virtual void push_vertex_normal_array(const Vector3f vertex_normals[], const size_t count);
+
+    // Append an array of texture coordinates to the mesh.
+    // The default implementation calls push_tex_coords() for each vector.
+    virtual void push_tex_coords_array(const Vector2f tex_coords[], const size_t count);
+
     // Append a material slot to the mesh.
     virtual size_t push_material_slot(const char* name) = 0;
 
@@ -89,6 +102,16 @@ class APPLESEED_DLLSYMBOL IMeshBuilder
     // End the definition of the face.
     virtual void end_face() = 0;
 
+    // Append an array of triangles to the mesh. vertices, vertex_normals and tex_coords
+    // hold three indices per triangle, materials holds one index per triangle.
+    // The default implementation defines one face per triangle.
+    virtual void push_triangle_array(
+        const uint32    vertices[],
+        const uint32    vertex_normals[],
+        const uint32    tex_coords[],
+        const uint16    materials[],
+        const size_t    count);
+
     // End the definition of the mesh.
     virtual void end_mesh() = 0;
 };
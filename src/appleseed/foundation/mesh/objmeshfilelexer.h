@@ -40,6 +40,7 @@
 #include <cctype>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -62,6 +63,9 @@ class OBJMeshFileLexer
     // Constructor.
     explicit OBJMeshFileLexer(const ParsingMode parsing_mode = Precise)
       : m_parsing_mode(parsing_mode)
+      , m_from_memory(false)
+      , m_memory_ptr(nullptr)
+      , m_memory_end(nullptr)
       , m_eof(false)
       , m_line_number(0)
       , m_line(4096)
@@ -81,6 +85,9 @@ class OBJMeshFileLexer
         m_line_number = 0;
         m_line_size = 0;
         m_line_index = 0;
+        m_from_memory = false;
+        m_memory_ptr = nullptr;
+        m_memory_end = nullptr;
 
         m_file.open(
             filename.c_str(),
@@ -95,16 +102,45 @@ class OBJMeshFileLexer
         return true;
     }
 
+    // Read input from a block of memory instead of a file. The block must remain valid until
+    // the lexer is closed. Line endings may be either LF or CR LF. Line numbers start at 1 at
+    // the beginning of the block.
+    void open(const char* begin, const char* end)
+    {
+        assert(begin <= end);
+
+        m_file.close();
+
+        m_eof = false;
+        m_line_number = 0;
+        m_line_size = 0;
+        m_line_index = 0;
+        m_memory_ptr = begin;
+        m_memory_end = end;
+        m_from_memory = true;
+
+        read_next_line();
+    }
+
     // Close the input file.
     void close()
     {
         m_file.close();
+        m_memory_ptr = nullptr;
+        m_memory_end = nullptr;
+        m_from_memory = false;
+    }
+
+    // Return true if the lexer is reading from a file or from a block of memory.
+    bool is_open() const
+    {
+        return m_from_memory || m_file.is_open();
     }
 
     // Return the position of the current line in the file.
     size_t get_line_number() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_number;
     }
@@ -112,7 +148,7 @@ class OBJMeshFileLexer
     // Return the current character in the line.
     APPLESEED_FORCE_INLINE unsigned char get_char() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_index == m_line_size ? '\n' : m_line[m_line_index];
     }
@@ -120,7 +156,7 @@ class OBJMeshFileLexer
     // Advance to the next character in the line.
     APPLESEED_FORCE_INLINE void next_char()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (m_line_index < m_line_size)
             ++m_line_index;
@@ -140,7 +176,7 @@ class OBJMeshFileLexer
     // Return true if the end of the line has been reached.
     APPLESEED_FORCE_INLINE bool is_eol() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_line_index == m_line_size;
     }
@@ -148,7 +184,7 @@ class OBJMeshFileLexer
     // Return true if the end of the file has been reached.
     APPLESEED_FORCE_INLINE bool is_eof() const
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         return m_eof && is_eol();
     }
@@ -156,7 +192,7 @@ class OBJMeshFileLexer
     // Eat blank characters and comments.
     void eat_blanks()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         while (true)
         {
@@ -191,7 +227,7 @@ class OBJMeshFileLexer
     // Accept a end-of-line character, or generate a parse error.
     void accept_newline()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (!is_eol())
             parse_error();
@@ -202,7 +238,7 @@ class OBJMeshFileLexer
     // Accept a string of non-blank characters, or generate a parse error.
     void accept_string(const char** begin, size_t* length)
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         if (is_eof())
             parse_error();
@@ -235,7 +271,7 @@ class OBJMeshFileLexer
     // Accept a long integer, or generate a parse error.
     APPLESEED_FORCE_INLINE long accept_long()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         // Read an integer value at the current position in the line.
         const char* base_ptr = &m_line[0];
@@ -254,7 +290,7 @@ class OBJMeshFileLexer
     // Accept a double-precision floating point number, or generate a parse error.
     APPLESEED_FORCE_INLINE double accept_double()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         // Read a floating-point value at the current position in the line.
         char* base_ptr = &m_line[0];
@@ -278,6 +314,9 @@ class OBJMeshFileLexer
     const ParsingMode   m_parsing_mode;     // parsing mode for floating-point values
     bool                m_is_space[256];    // precomputed values of std::isspace(c) for all c
     BufferedFile        m_file;
+    bool                m_from_memory;      // is the lexer reading from a memory block rather than from a file?
+    const char*         m_memory_ptr;       // current position in the memory block, when reading from memory
+    const char*         m_memory_end;       // end of the memory block, when reading from memory
     bool                m_eof;              // has the end of the file been reached?
     size_t              m_line_number;      // position of the current line in the file
     std::vector<char>   m_line;             // current line
@@ -287,17 +326,23 @@ class OBJMeshFileLexer
     // Close the input file and throw an ExceptionParseError exception.
     void parse_error()
     {
-        m_file.close();
+        close();
         throw OBJMeshFileReader::ExceptionParseError(m_line_number);
     }
 
     // Read the next line from the input file.
     void read_next_line()
     {
-        assert(m_file.is_open());
+        assert(is_open());
 
         m_line_size = 0;
 
+        if (m_from_memory)
+        {
+            read_next_line_from_memory();
+            return;
+        }
+
         if (!m_eof)
         {
             ++m_line_number;
@@ -325,6 +370,47 @@ class OBJMeshFileLexer
         // Append a null terminator.
         m_line[m_line_size] = 0;
     }
+
+    // Read the next line from the memory block, splitting overlong lines exactly like read_next_line().
+    void read_next_line_from_memory()
+    {
+        if (!m_eof)
+        {
+            ++m_line_number;
+
+            const size_t capacity = m_line.size() - 1;
+            const size_t remaining = static_cast<size_t>(m_memory_end - m_memory_ptr);
+            const size_t max_size = remaining < capacity ? remaining : capacity;
+
+            const char* newline =
+                max_size > 0
+                    ? static_cast<const char*>(std::memchr(m_memory_ptr, '\n', max_size))
+                    : nullptr;
+
+            m_line_size = newline != nullptr ? newline - m_memory_ptr : max_size;
+
+            if (m_line_size > 0)
+                std::memcpy(&m_line[0], m_memory_ptr, m_line_size);
+
+            if (newline != nullptr)
+                m_memory_ptr = newline + 1;
+            else
+            {
+                m_memory_ptr += max_size;
+
+                // Reached the end of the block before filling the line.
+                if (max_size < capacity)
+                    m_eof = true;
+            }
+
+            // Strip the carriage return of CR LF line endings.
+            if (newline != nullptr && m_line_size > 0 && m_line[m_line_size - 1] == '\r')
+                --m_line_size;
+        }
+
+        // Append a null terminator.
+        m_line[m_line_size] = 0;
+    }
 };
 
 }   // namespace foundation
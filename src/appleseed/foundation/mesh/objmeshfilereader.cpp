@@ -26,7 +26,6 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 //
-
 // Interface header.
 #include "objmeshfilereader.h"
 
@@ -35,10 +34,17 @@
 #include "foundation/math/vector.h"
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/objmeshfilelexer.h"
+#include "foundation/platform/memorymappedfile.h"
+#include "foundation/platform/system.h"
 #include "foundation/utility/memory.h"
 
+// Boost headers.
+#include "boost/thread/thread.hpp"
+
 // Standard headers.
+#include <algorithm>
 #include <cstring>
+#include <exception>
 #include <map>
 #include <utility>
 #include <vector>
@@ -55,506 +61,915 @@ namespace foundation
 namespace
 {
     const size_t Undefined = ~size_t(0);
-}
 
-struct OBJMeshFileReader::Impl
-{
-    const int               m_options;
-    IMeshBuilder&           m_builder;
-    OBJMeshFileLexer        m_lexer;
-
-    // Current state.
-    bool                    m_inside_mesh_def;              // currently inside a mesh definition?
-    string                  m_current_mesh_name;            // name of the current mesh
-    map<string, size_t>     m_material_slots;               // material slots for the current mesh
-    size_t                  m_current_material_slot_index;  // index of the current material slot
-
-    // Features defined in the file.
-    vector<Vector3d>        m_vertices;
-    vector<Vector2d>        m_tex_coords;
-    vector<Vector3d>        m_normals;
-
-    // Mappings between internal indices and mesh indices.
-    vector<size_t>          m_vertex_index_mapping;
-    vector<size_t>          m_tex_coord_index_mapping;
-    vector<size_t>          m_normal_index_mapping;
-
-    // Temporary vectors for collecting indices while parsing face statements.
-    vector<size_t>          m_face_vertex_indices;
-    vector<size_t>          m_face_tex_coord_indices;
-    vector<size_t>          m_face_normal_indices;
-
-    // Constructor.
-    Impl(
-        const int           options,
-        IMeshBuilder&       builder)
-      : m_options(options)
-      , m_builder(builder)
-      , m_lexer(
-            (options & FavorSpeedOverPrecision)
-                ? OBJMeshFileLexer::Fast
-                : OBJMeshFileLexer::Precise)
-      , m_inside_mesh_def(false)
-      , m_current_material_slot_index(0)
+    // Minimum amount of data handed to a thread when parsing a file in parallel.
+    const size_t MinParallelChunkSize = 1024 * 1024;
+
+
+    //
+    // Parse OBJ statements from a lexer and forward them to a handler.
+    //
+    // The handler must provide the following methods:
+    //
+    //   void vertex(const Vector3d& v);
+    //   void tex_coords(const Vector2d& v);
+    //   void normal(const Vector3d& n);
+    //   void face(size_t line, const vector<long>& vertex_indices, const vector<long>& tex_coord_indices, const vector<long>& normal_indices);
+    //   void object_or_group(const string& name);
+    //   void material_slot(const string& name);
+    //
+    // Face indices are forwarded exactly as they appear in the file: 1-based and possibly negative.
+    //
+
+    template <typename Handler>
+    class StatementParser
     {
-    }
+      public:
+        StatementParser(
+            OBJMeshFileLexer&   lexer,
+            Handler&            handler)
+          : m_lexer(lexer)
+          , m_handler(handler)
+        {
+        }
 
-    // Close the input file and throw an ExceptionParseError exception.
-    void parse_error()
-    {
-        const size_t line_number = m_lexer.get_line_number();
+        void parse()
+        {
+            while (true)
+            {
+                m_lexer.eat_blanks();
 
-        m_lexer.close();
+                // Handle end of file.
+                if (m_lexer.is_eof())
+                    break;
 
-        throw ExceptionParseError(line_number);
-    }
+                // Handle empty lines.
+                if (m_lexer.is_eol())
+                {
+                    m_lexer.accept_newline();
+                    continue;
+                }
 
-    void parse_file()
-    {
-        while (true)
-        {
-            m_lexer.eat_blanks();
+                const char* keyword;
+                size_t keyword_length;
 
-            // Handle end of file.
-            if (m_lexer.is_eof())
-                break;
+                m_lexer.accept_string(&keyword, &keyword_length);
 
-            // Handle empty lines.
-            if (m_lexer.is_eol())
-            {
+                if (keyword_length == 1)
+                {
+                    switch (keyword[0])
+                    {
+                      case 'f':
+                        parse_f_statement();
+                        break;
+
+                      case 'g':
+                      case 'o':
+                        m_handler.object_or_group(parse_compound_identifier());
+                        break;
+
+                      case 'v':
+                        parse_v_statement();
+                        break;
+
+                      default:
+                        // Ignore unknown or unhandled statements.
+                        m_lexer.eat_line();
+                        continue;
+                    }
+                }
+                else if (keyword_length == 2)
+                {
+                    switch (keyword[0] * 256 + keyword[1])
+                    {
+                      case 'v' * 256 + 'n':
+                        parse_vn_statement();
+                        break;
+
+                      case 'v' * 256 + 't':
+                        parse_vt_statement();
+                        break;
+
+                      default:
+                        // Ignore unknown or unhandled statements.
+                        m_lexer.eat_line();
+                        continue;
+                    }
+                }
+                else if (strncmp(keyword, "usemtl", keyword_length) == 0)
+                {
+                    m_handler.material_slot(parse_compound_identifier());
+                }
+                else
+                {
+                    // Ignore unknown or unhandled statements.
+                    m_lexer.eat_line();
+                    continue;
+                }
+
+                m_lexer.eat_blanks();
                 m_lexer.accept_newline();
-                continue;
             }
+        }
+
+      private:
+        OBJMeshFileLexer&       m_lexer;
+        Handler&                m_handler;
 
-            const char* keyword;
-            size_t keyword_length;
+        // Temporary vectors for collecting indices while parsing face statements.
+        vector<long>            m_face_vertex_indices;
+        vector<long>            m_face_tex_coord_indices;
+        vector<long>            m_face_normal_indices;
 
-            m_lexer.accept_string(&keyword, &keyword_length);
+        // Close the input file and throw an ExceptionParseError exception.
+        void parse_error()
+        {
+            const size_t line_number = m_lexer.get_line_number();
+
+            m_lexer.close();
+
+            throw OBJMeshFileReader::ExceptionParseError(line_number);
+        }
 
-            if (keyword_length == 1)
+        void parse_f_statement()
+        {
+            clear_keep_memory(m_face_vertex_indices);
+            clear_keep_memory(m_face_tex_coord_indices);
+            clear_keep_memory(m_face_normal_indices);
+
+            while (true)
             {
-                switch (keyword[0])
-                {
-                  case 'f':
-                    parse_f_statement();
-                    break;
+                m_lexer.eat_blanks();
 
-                  case 'g':
-                  case 'o':
-                    parse_o_g_statement();
+                if (m_lexer.is_eol())
                     break;
 
-                  case 'v':
-                    parse_v_statement();
-                    break;
+                //
+                // Recognized (epsilon)
+                // Accept n
+                //
 
-                  default:
-                    // Ignore unknown or unhandled statements.
-                    m_lexer.eat_line();
-                    continue;
+                m_face_vertex_indices.push_back(m_lexer.accept_long());
+
+                //
+                // Recognized n
+                // Accept (epsilon), /
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else if (c == '/')
+                        m_lexer.next_char();
+                    else parse_error();
                 }
-            }
-            else if (keyword_length == 2)
-            {
-                switch (keyword[0] * 256 + keyword[1])
+
+                //
+                // Recognized n/
+                // Accept /, n
+                //
+
                 {
-                  case 'v' * 256 + 'n':
-                    parse_vn_statement();
-                    break;
+                    const unsigned char c = m_lexer.get_char();
+                    if (c == '/')
+                    {
+                        m_lexer.next_char();
+                        goto skip;
+                    }
+                    else m_face_tex_coord_indices.push_back(m_lexer.accept_long());
+                }
 
-                  case 'v' * 256 + 't':
-                    parse_vt_statement();
-                    break;
+                //
+                // Recognized n/n
+                // Accept (epsilon), /
+                //
 
-                  default:
-                    // Ignore unknown or unhandled statements.
-                    m_lexer.eat_line();
-                    continue;
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else if (c == '/')
+                        m_lexer.next_char();
+                    else parse_error();
+                }
+
+              skip:
+
+                //
+                // Recognized n//, n/n/
+                // Accept (epsilon), n
+                //
+
+                {
+                    const unsigned char c = m_lexer.get_char();
+                    if (m_lexer.is_space(c))
+                        continue;
+                    else m_face_normal_indices.push_back(m_lexer.accept_long());
                 }
             }
-            else if (strncmp(keyword, "usemtl", keyword_length) == 0)
-            {
-                parse_usemtl_statement();
-            }
-            else
+
+            m_handler.face(
+                m_lexer.get_line_number(),
+                m_face_vertex_indices,
+                m_face_tex_coord_indices,
+                m_face_normal_indices);
+        }
+
+        string parse_compound_identifier()
+        {
+            string identifier;
+
+            m_lexer.eat_blanks();
+
+            while (!m_lexer.is_eol())
             {
-                // Ignore unknown or unhandled statements.
-                m_lexer.eat_line();
-                continue;
+                const char* token;
+                size_t token_length;
+
+                m_lexer.accept_string(&token, &token_length);
+                m_lexer.eat_blanks();
+
+                if (!identifier.empty())
+                    identifier += ' ';
+
+                identifier.append(token, token_length);
             }
 
+            return identifier;
+        }
+
+        void parse_v_statement()
+        {
+            Vector3d v;
+
+            m_lexer.eat_blanks();
+            v.x = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+            v.z = m_lexer.accept_double();
+
             m_lexer.eat_blanks();
-            m_lexer.accept_newline();
+
+            if (!m_lexer.is_eol())
+                m_lexer.accept_double();
+
+            m_handler.vertex(v);
         }
 
-        // End the definition of the last object.
-        if (m_inside_mesh_def)
-            m_builder.end_mesh();
-    }
+        void parse_vt_statement()
+        {
+            Vector2d v;
 
-    void parse_f_statement()
-    {
-        clear_keep_memory(m_face_vertex_indices);
-        clear_keep_memory(m_face_tex_coord_indices);
-        clear_keep_memory(m_face_normal_indices);
+            m_lexer.eat_blanks();
+            v.x = m_lexer.accept_double();
 
-        while (true)
+            m_lexer.eat_blanks();
+            v.y = m_lexer.accept_double();
+
+            m_lexer.eat_blanks();
+
+            if (!m_lexer.is_eol())
+                m_lexer.accept_double();
+
+            m_handler.tex_coords(v);
+        }
+
+        void parse_vn_statement()
         {
+            Vector3d n;
+
             m_lexer.eat_blanks();
+            n.x = m_lexer.accept_double();
 
-            if (m_lexer.is_eol())
-                break;
+            m_lexer.eat_blanks();
+            n.y = m_lexer.accept_double();
 
-            //
-            // Recognized (epsilon)
-            // Accept n
-            //
+            m_lexer.eat_blanks();
+            n.z = m_lexer.accept_double();
+
+            m_handler.normal(n);
+        }
+    };
 
-            {
-                const long n = m_lexer.accept_long();
-                const size_t v = fix_index(n, m_vertices.size());
-                m_face_vertex_indices.push_back(v);
-            }
 
-            //
-            // Recognized n
-            // Accept (epsilon), /
-            //
+    //
+    // Forward OBJ statements to a mesh builder, inserting only the features
+    // referenced by the faces of each mesh.
+    //
+
+    class MeshAssembler
+    {
+      public:
+        // Features defined in the file.
+        vector<Vector3d>        m_vertices;
+        vector<Vector2d>        m_tex_coords;
+        vector<Vector3d>        m_normals;
+
+        MeshAssembler(
+            IMeshBuilder&       builder,
+            const int           options)
+          : m_options(options)
+          , m_builder(builder)
+          , m_inside_mesh_def(false)
+          , m_current_material_slot_index(0)
+        {
+        }
 
+        void vertex(const Vector3d& v)
+        {
+            m_vertices.push_back(v);
+        }
+
+        void tex_coords(const Vector2d& v)
+        {
+            m_tex_coords.push_back(v);
+        }
+
+        void normal(const Vector3d& n)
+        {
+            m_normals.push_back(n);
+        }
+
+        void face(
+            const size_t            line,
+            const vector<long>&     vertex_indices,
+            const vector<long>&     tex_coord_indices,
+            const vector<long>&     normal_indices)
+        {
+            insert_face(
+                line,
+                vertex_indices.data(), vertex_indices.size(),
+                tex_coord_indices.data(), tex_coord_indices.size(),
+                normal_indices.data(), normal_indices.size(),
+                m_vertices.size(),
+                m_tex_coords.size(),
+                m_normals.size());
+        }
+
+        // Insert a face given its indices as they appear in the file and the number
+        // of vertices, texture coordinates and normals defined before the face.
+        void insert_face(
+            const size_t            line,
+            const long*             vertex_indices,
+            const size_t            vertex_index_count,
+            const long*             tex_coord_indices,
+            const size_t            tex_coord_index_count,
+            const long*             normal_indices,
+            const size_t            normal_index_count,
+            const size_t            vertex_count,
+            const size_t            tex_coord_count,
+            const size_t            normal_count)
+        {
+            fix_indices(line, vertex_indices, vertex_index_count, vertex_count, m_face_vertex_indices);
+            fix_indices(line, tex_coord_indices, tex_coord_index_count, tex_coord_count, m_face_tex_coord_indices);
+            fix_indices(line, normal_indices, normal_index_count, normal_count, m_face_normal_indices);
+
+            // Check whether the face is well-formed.
+            const size_t vc = vertex_index_count;
+            const size_t tc = tex_coord_index_count;
+            const size_t nc = normal_index_count;
+            const bool well_formed =
+                    vc >= 3
+                && (tc == 0 || tc == vc)
+                && (nc == 0 || nc == vc);
+
+            if (well_formed)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else if (c == '/')
-                    m_lexer.next_char();
-                else parse_error();
+                // The face is well-formed, insert it into the mesh.
+                insert_face_into_mesh();
             }
+            else
+            {
+                // The face is ill-formed, ignore it or abort parsing.
+                if (m_options & OBJMeshFileReader::StopOnInvalidFaceDef)
+                    throw OBJMeshFileReader::ExceptionInvalidFaceDef(line);
+            }
+        }
 
-            //
-            // Recognized n/
-            // Accept /, n
-            //
-
+        void object_or_group(const string& name)
+        {
+            // Start a new mesh only if the name of the object or group actually changes.
+            if (name != m_current_mesh_name)
             {
-                const unsigned char c = m_lexer.get_char();
-                if (c == '/')
+                // End the current mesh.
+                if (m_inside_mesh_def)
                 {
-                    m_lexer.next_char();
-                    goto skip;
+                    m_builder.end_mesh();
+                    m_inside_mesh_def = false;
                 }
-                else
-                {
-                    const long n = m_lexer.accept_long();
-                    const size_t vt = fix_index(n, m_tex_coords.size());
-                    m_face_tex_coord_indices.push_back(vt);
-                }
-            }
 
-            //
-            // Recognized n/n
-            // Accept (epsilon), /
-            //
+                clear_keep_memory(m_vertex_index_mapping);
+                clear_keep_memory(m_tex_coord_index_mapping);
+                clear_keep_memory(m_normal_index_mapping);
 
-            {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else if (c == '/')
-                    m_lexer.next_char();
-                else parse_error();
+                m_current_mesh_name = name;
             }
+        }
 
-          skip:
+        void material_slot(const string& material_slot_name)
+        {
+            // Begin a mesh definition if we're not already inside one.
+            ensure_mesh_def();
 
-            //
-            // Recognized n//, n/n/
-            // Accept (epsilon), n
-            //
+            // Check whether this material slot has already been defined for this mesh.
+            const map<string, size_t>::const_iterator& it =
+                m_material_slots.find(material_slot_name);
 
+            if (it != m_material_slots.end())
             {
-                const unsigned char c = m_lexer.get_char();
-                if (m_lexer.is_space(c))
-                    continue;
-                else
-                {
-                    const long n = m_lexer.accept_long();
-                    const size_t vn = fix_index(n, m_normals.size());
-                    m_face_normal_indices.push_back(vn);
-                }
+                // It has: just make it the active material slot.
+                m_current_material_slot_index = it->second;
+            }
+            else
+            {
+                // It hasn't: insert it into the mesh and make it the active material slot.
+                m_current_material_slot_index = m_builder.push_material_slot(material_slot_name.c_str());
+                m_material_slots.insert(make_pair(material_slot_name, m_current_material_slot_index));
             }
         }
 
-        // Check whether the face is well-formed.
-        const size_t vc = m_face_vertex_indices.size();
-        const size_t tc = m_face_tex_coord_indices.size();
-        const size_t nc = m_face_normal_indices.size();
-        const bool well_formed =
-                vc >= 3
-            && (tc == 0 || tc == vc)
-            && (nc == 0 || nc == vc);
-
-        if (well_formed)
-        {
-            // The face is well-formed, insert it into the mesh.
-            insert_face_into_mesh();
-        }
-        else
+        // End the definition of the last object.
+        void end()
         {
-            // The face is ill-formed, ignore it or abort parsing.
-            if (m_options & StopOnInvalidFaceDef)
-                throw ExceptionInvalidFaceDef(m_lexer.get_line_number());
+            if (m_inside_mesh_def)
+                m_builder.end_mesh();
         }
-    }
 
-    // Convert 1-based indices (including negative indices) to 0-based indices.
-    size_t fix_index(const long index, const size_t count)
-    {
-        if (index > 0)
-        {
-            const size_t i = static_cast<size_t>(index);
-            if (i > count)
-                parse_error();
-            return i - 1;
-        }
-        else if (index < 0)
+      private:
+        const int               m_options;
+        IMeshBuilder&           m_builder;
+
+        // Current state.
+        bool                    m_inside_mesh_def;              // currently inside a mesh definition?
+        string                  m_current_mesh_name;            // name of the current mesh
+        map<string, size_t>     m_material_slots;               // material slots for the current mesh
+        size_t                  m_current_material_slot_index;  // index of the current material slot
+
+        // Mappings between internal indices and mesh indices.
+        vector<size_t>          m_vertex_index_mapping;
+        vector<size_t>          m_tex_coord_index_mapping;
+        vector<size_t>          m_normal_index_mapping;
+
+        // Temporary vectors for collecting the indices of the current face.
+        vector<size_t>          m_face_vertex_indices;
+        vector<size_t>          m_face_tex_coord_indices;
+        vector<size_t>          m_face_normal_indices;
+
+        // Convert 1-based indices (including negative indices) to 0-based indices.
+        static void fix_indices(
+            const size_t            line,
+            const long*             indices,
+            const size_t            index_count,
+            const size_t            count,
+            vector<size_t>&         fixed_indices)
         {
-            const size_t i = static_cast<size_t>(-index);
-            if (i > count)
-                parse_error();
-            return count - i;
+            clear_keep_memory(fixed_indices);
+
+            for (size_t i = 0; i < index_count; ++i)
+                fixed_indices.push_back(fix_index(line, indices[i], count));
         }
-        else
+
+        static size_t fix_index(
+            const size_t            line,
+            const long              index,
+            const size_t            count)
         {
-            parse_error();
-            return 0;       // keep the compiler happy
+            if (index > 0)
+            {
+                const size_t i = static_cast<size_t>(index);
+                if (i > count)
+                    throw OBJMeshFileReader::ExceptionParseError(line);
+                return i - 1;
+            }
+            else if (index < 0)
+            {
+                const size_t i = static_cast<size_t>(-index);
+                if (i > count)
+                    throw OBJMeshFileReader::ExceptionParseError(line);
+                return count - i;
+            }
+            else throw OBJMeshFileReader::ExceptionParseError(line);
         }
-    }
 
-    void insert_face_into_mesh()
-    {
-        // Begin a mesh definition if we're not already inside one.
-        ensure_mesh_def();
+        void insert_face_into_mesh()
+        {
+            // Begin a mesh definition if we're not already inside one.
+            ensure_mesh_def();
 
-        // Insert the features into the mesh, updating index mappings as necessary.
-        insert_vertices_into_mesh();
-        insert_vertex_normals_into_mesh();
-        insert_tex_coords_into_mesh();
+            // Insert the features into the mesh, updating index mappings as necessary.
+            insert_vertices_into_mesh();
+            insert_vertex_normals_into_mesh();
+            insert_tex_coords_into_mesh();
 
-        // Translate feature indices from internal space to mesh space.
-        translate_indices(m_face_vertex_indices, m_vertex_index_mapping);
-        translate_indices(m_face_normal_indices, m_normal_index_mapping);
-        translate_indices(m_face_tex_coord_indices, m_tex_coord_index_mapping);
+            // Translate feature indices from internal space to mesh space.
+            translate_indices(m_face_vertex_indices, m_vertex_index_mapping);
+            translate_indices(m_face_normal_indices, m_normal_index_mapping);
+            translate_indices(m_face_tex_coord_indices, m_tex_coord_index_mapping);
 
-        const size_t n = m_face_vertex_indices.size();
+            const size_t n = m_face_vertex_indices.size();
 
-        // Begin defining a new face.
-        m_builder.begin_face(n);
+            // Begin defining a new face.
+            m_builder.begin_face(n);
 
-        // Set face vertices.
-        m_builder.set_face_vertices(&m_face_vertex_indices.front());
+            // Set face vertices.
+            m_builder.set_face_vertices(&m_face_vertex_indices.front());
 
-        // Set face vertex normals (if any).
-        if (m_face_normal_indices.size() == n)
-            m_builder.set_face_vertex_normals(&m_face_normal_indices.front());
+            // Set face vertex normals (if any).
+            if (m_face_normal_indices.size() == n)
+                m_builder.set_face_vertex_normals(&m_face_normal_indices.front());
 
-        // Set face vertex texture coordinates (if any).
-        if (m_face_tex_coord_indices.size() == n)
-            m_builder.set_face_vertex_tex_coords(&m_face_tex_coord_indices.front());
+            // Set face vertex texture coordinates (if any).
+            if (m_face_tex_coord_indices.size() == n)
+                m_builder.set_face_vertex_tex_coords(&m_face_tex_coord_indices.front());
 
-        // Set face material.
-        m_builder.set_face_material(m_current_material_slot_index);
+            // Set face material.
+            m_builder.set_face_material(m_current_material_slot_index);
 
-        // End defining the face.
-        m_builder.end_face();
-    }
-
-    void insert_vertices_into_mesh()
-    {
-        const size_t face_vertex_index_count = m_face_vertex_indices.size();
+            // End defining the face.
+            m_builder.end_face();
+        }
 
-        for (size_t i = 0; i < face_vertex_index_count; ++i)
+        void insert_vertices_into_mesh()
         {
-            const size_t vertex_index = m_face_vertex_indices[i];
-            ensure_minimum_size(m_vertex_index_mapping, vertex_index + 1, Undefined);
-            if (m_vertex_index_mapping[vertex_index] == Undefined)
-                m_vertex_index_mapping[vertex_index] = m_builder.push_vertex(m_vertices[vertex_index]);
-        }
-    }
+            const size_t face_vertex_index_count = m_face_vertex_indices.size();
 
-    void insert_vertex_normals_into_mesh()
-    {
-        const size_t face_normal_index_count = m_face_normal_indices.size();
+            for (size_t i = 0; i < face_vertex_index_count; ++i)
+            {
+                const size_t vertex_index = m_face_vertex_indices[i];
+                ensure_minimum_size(m_vertex_index_mapping, vertex_index + 1, Undefined);
+                if (m_vertex_index_mapping[vertex_index] == Undefined)
+                    m_vertex_index_mapping[vertex_index] = m_builder.push_vertex(m_vertices[vertex_index]);
+            }
+        }
 
-        for (size_t i = 0; i < face_normal_index_count; ++i)
+        void insert_vertex_normals_into_mesh()
         {
-            const size_t normal_index = m_face_normal_indices[i];
-            ensure_minimum_size(m_normal_index_mapping, normal_index + 1, Undefined);
-            if (m_normal_index_mapping[normal_index] == Undefined)
-                m_normal_index_mapping[normal_index] = m_builder.push_vertex_normal(m_normals[normal_index]);
-        }
-    }
+            const size_t face_normal_index_count = m_face_normal_indices.size();
 
-    void insert_tex_coords_into_mesh()
-    {
-        const size_t face_tex_coord_index_count = m_face_tex_coord_indices.size();
+            for (size_t i = 0; i < face_normal_index_count; ++i)
+            {
+                const size_t normal_index = m_face_normal_indices[i];
+                ensure_minimum_size(m_normal_index_mapping, normal_index + 1, Undefined);
+                if (m_normal_index_mapping[normal_index] == Undefined)
+                    m_normal_index_mapping[normal_index] = m_builder.push_vertex_normal(m_normals[normal_index]);
+            }
+        }
 
-        for (size_t i = 0; i < face_tex_coord_index_count; ++i)
+        void insert_tex_coords_into_mesh()
         {
-            const size_t tex_coord_index = m_face_tex_coord_indices[i];
-            ensure_minimum_size(m_tex_coord_index_mapping, tex_coord_index + 1, Undefined);
-            if (m_tex_coord_index_mapping[tex_coord_index] == Undefined)
-                m_tex_coord_index_mapping[tex_coord_index] = m_builder.push_tex_coords(m_tex_coords[tex_coord_index]);
-        }
-    }
+            const size_t face_tex_coord_index_count = m_face_tex_coord_indices.size();
 
-    static void translate_indices(
-        vector<size_t>&         indices,
-        const vector<size_t>&   mapping)
-    {
-        const size_t count = indices.size();
+            for (size_t i = 0; i < face_tex_coord_index_count; ++i)
+            {
+                const size_t tex_coord_index = m_face_tex_coord_indices[i];
+                ensure_minimum_size(m_tex_coord_index_mapping, tex_coord_index + 1, Undefined);
+                if (m_tex_coord_index_mapping[tex_coord_index] == Undefined)
+                    m_tex_coord_index_mapping[tex_coord_index] = m_builder.push_tex_coords(m_tex_coords[tex_coord_index]);
+            }
+        }
 
-        for (size_t i = 0; i < count; ++i)
-            indices[i] = mapping[indices[i]];
-    }
+        static void translate_indices(
+            vector<size_t>&         indices,
+            const vector<size_t>&   mapping)
+        {
+            const size_t count = indices.size();
 
-    void parse_o_g_statement()
-    {
-        // Retrieve the name of the upcoming mesh.
-        const string upcoming_mesh_name = parse_compound_identifier();
+            for (size_t i = 0; i < count; ++i)
+                indices[i] = mapping[indices[i]];
+        }
 
-        // Start a new mesh only if the name of the object or group actually changes.
-        if (upcoming_mesh_name != m_current_mesh_name)
+        void ensure_mesh_def()
         {
-            // End the current mesh.
-            if (m_inside_mesh_def)
+            if (!m_inside_mesh_def)
             {
-                m_builder.end_mesh();
-                m_inside_mesh_def = false;
+                // Begin the definition of the new mesh.
+                m_builder.begin_mesh(m_current_mesh_name.c_str());
+                m_inside_mesh_def = true;
+
+                // Clear material slot definitions.
+                m_material_slots.clear();
+                m_current_material_slot_index = 0;
             }
+        }
+    };
 
-            clear_keep_memory(m_vertex_index_mapping);
-            clear_keep_memory(m_tex_coord_index_mapping);
-            clear_keep_memory(m_normal_index_mapping);
 
-            m_current_mesh_name = upcoming_mesh_name;
-        }
-    }
+    //
+    // The statements of a contiguous range of lines of the file, recorded by
+    // a worker thread so that they can later be replayed in file order.
+    //
+    // Feature counts and line numbers are relative to the beginning of the chunk.
+    //
 
-    string parse_compound_identifier()
+    class ParsedChunk
     {
-        string identifier;
-
-        m_lexer.eat_blanks();
+      public:
+        struct Face
+        {
+            size_t              m_line;
+            size_t              m_vertex_count;                 // number of vertices defined in the chunk before this face
+            size_t              m_tex_coord_count;              // number of texture coordinates defined in the chunk before this face
+            size_t              m_normal_count;                 // number of normals defined in the chunk before this face
+            size_t              m_first_index;                  // index of the first vertex index of this face in m_indices
+            size_t              m_vertex_index_count;
+            size_t              m_tex_coord_index_count;
+            size_t              m_normal_index_count;
+        };
+
+        struct NamedStatement
+        {
+            bool                m_is_material_slot;             // usemtl statement if true, o or g statement otherwise
+            size_t              m_face_index;                   // number of faces recorded before this statement
+            string              m_name;
+        };
+
+        vector<Vector3d>        m_vertices;
+        vector<Vector2d>        m_tex_coords;
+        vector<Vector3d>        m_normals;
+        vector<Face>            m_faces;
+        vector<long>            m_indices;                      // vertex, then texture coordinate, then normal indices of each face
+        vector<NamedStatement>  m_named_statements;
+
+        size_t                  m_line_count;                   // number of lines in the chunk, valid if parsing succeeded
+        bool                    m_parse_error;                  // did parsing stop on a parse error?
+        size_t                  m_parse_error_line;
+        exception_ptr           m_exception;                    // any other exception thrown during parsing
+
+        ParsedChunk()
+          : m_line_count(0)
+          , m_parse_error(false)
+          , m_parse_error_line(0)
+        {
+        }
 
-        while (!m_lexer.is_eol())
+        void parse(
+            const char*                         begin,
+            const char*                         end,
+            const OBJMeshFileLexer::ParsingMode parsing_mode)
         {
-            const char* token;
-            size_t token_length;
+            try
+            {
+                OBJMeshFileLexer lexer(parsing_mode);
+                lexer.open(begin, end);
 
-            m_lexer.accept_string(&token, &token_length);
-            m_lexer.eat_blanks();
+                StatementParser<ParsedChunk> parser(lexer, *this);
+                parser.parse();
 
-            if (!identifier.empty())
-                identifier += ' ';
+                // The lexer counts one extra line when it hits the end of the chunk.
+                m_line_count = lexer.get_line_number() - 1;
 
-            identifier.append(token, token_length);
+                lexer.close();
+            }
+            catch (const OBJMeshFileReader::ExceptionParseError& e)
+            {
+                m_parse_error = true;
+                m_parse_error_line = e.m_line;
+            }
+            catch (...)
+            {
+                m_exception = current_exception();
+            }
         }
 
-        return identifier;
-    }
+        void vertex(const Vector3d& v)
+        {
+            m_vertices.push_back(v);
+        }
 
-    void parse_v_statement()
-    {
-        Vector3d v;
+        void tex_coords(const Vector2d& v)
+        {
+            m_tex_coords.push_back(v);
+        }
 
-        m_lexer.eat_blanks();
-        v.x = m_lexer.accept_double();
+        void normal(const Vector3d& n)
+        {
+            m_normals.push_back(n);
+        }
 
-        m_lexer.eat_blanks();
-        v.y = m_lexer.accept_double();
+        void face(
+            const size_t            line,
+            const vector<long>&     vertex_indices,
+            const vector<long>&     tex_coord_indices,
+            const vector<long>&     normal_indices)
+        {
+            Face face;
+            face.m_line = line;
+            face.m_vertex_count = m_vertices.size();
+            face.m_tex_coord_count = m_tex_coords.size();
+            face.m_normal_count = m_normals.size();
+            face.m_first_index = m_indices.size();
+            face.m_vertex_index_count = vertex_indices.size();
+            face.m_tex_coord_index_count = tex_coord_indices.size();
+            face.m_normal_index_count = normal_indices.size();
+            m_faces.push_back(face);
+
+            m_indices.insert(m_indices.end(), vertex_indices.begin(), vertex_indices.end());
+            m_indices.insert(m_indices.end(), tex_coord_indices.begin(), tex_coord_indices.end());
+            m_indices.insert(m_indices.end(), normal_indices.begin(), normal_indices.end());
+        }
 
-        m_lexer.eat_blanks();
-        v.z = m_lexer.accept_double();
+        void object_or_group(const string& name)
+        {
+            push_named_statement(false, name);
+        }
 
-        m_lexer.eat_blanks();
+        void material_slot(const string& name)
+        {
+            push_named_statement(true, name);
+        }
 
-        if (!m_lexer.is_eol())
-            m_lexer.accept_double();
+      private:
+        void push_named_statement(const bool is_material_slot, const string& name)
+        {
+            NamedStatement statement;
+            statement.m_is_material_slot = is_material_slot;
+            statement.m_face_index = m_faces.size();
+            statement.m_name = name;
+            m_named_statements.push_back(statement);
+        }
+    };
 
-        m_vertices.push_back(v);
+    template <typename T>
+    void append_and_release(vector<T>& dest, vector<T>& source)
+    {
+        dest.insert(dest.end(), source.begin(), source.end());
+        vector<T>().swap(source);
     }
 
-    void parse_vt_statement()
+    void replay_named_statement(
+        MeshAssembler&                          assembler,
+        const ParsedChunk::NamedStatement&      statement)
     {
-        Vector2d v;
-
-        m_lexer.eat_blanks();
-        v.x = m_lexer.accept_double();
+        if (statement.m_is_material_slot)
+            assembler.material_slot(statement.m_name);
+        else assembler.object_or_group(statement.m_name);
+    }
 
-        m_lexer.eat_blanks();
-        v.y = m_lexer.accept_double();
+    void replay_chunk(
+        MeshAssembler&                          assembler,
+        const ParsedChunk&                      chunk,
+        const size_t                            first_line,
+        const size_t                            vertex_base,
+        const size_t                            tex_coord_base,
+        const size_t                            normal_base)
+    {
+        const size_t face_count = chunk.m_faces.size();
+        const size_t named_statement_count = chunk.m_named_statements.size();
+        size_t named_statement_index = 0;
 
-        m_lexer.eat_blanks();
+        for (size_t i = 0; i < face_count; ++i)
+        {
+            while (named_statement_index < named_statement_count &&
+                   chunk.m_named_statements[named_statement_index].m_face_index == i)
+            {
+                replay_named_statement(
+                    assembler,
+                    chunk.m_named_statements[named_statement_index++]);
+            }
 
-        if (!m_lexer.is_eol())
-            m_lexer.accept_double();
+            const ParsedChunk::Face& face = chunk.m_faces[i];
+            const long* vertex_indices = chunk.m_indices.data() + face.m_first_index;
+            const long* tex_coord_indices = vertex_indices + face.m_vertex_index_count;
+            const long* normal_indices = tex_coord_indices + face.m_tex_coord_index_count;
+
+            assembler.insert_face(
+                first_line + face.m_line - 1,
+                vertex_indices, face.m_vertex_index_count,
+                tex_coord_indices, face.m_tex_coord_index_count,
+                normal_indices, face.m_normal_index_count,
+                vertex_base + face.m_vertex_count,
+                tex_coord_base + face.m_tex_coord_count,
+                normal_base + face.m_normal_count);
+        }
 
-        m_tex_coords.push_back(v);
+        while (named_statement_index < named_statement_count)
+        {
+            replay_named_statement(
+                assembler,
+                chunk.m_named_statements[named_statement_index++]);
+        }
     }
+}
 
-    void parse_vn_statement()
+struct OBJMeshFileReader::Impl
+{
+    static OBJMeshFileLexer::ParsingMode get_parsing_mode(const int options)
     {
-        Vector3d n;
+        return
+            (options & FavorSpeedOverPrecision)
+                ? OBJMeshFileLexer::Fast
+                : OBJMeshFileLexer::Precise;
+    }
 
-        m_lexer.eat_blanks();
-        n.x = m_lexer.accept_double();
+    static void read_sequential(
+        const string&       filename,
+        const int           options,
+        IMeshBuilder&       builder)
+    {
+        OBJMeshFileLexer lexer(get_parsing_mode(options));
+        MeshAssembler assembler(builder, options);
 
-        m_lexer.eat_blanks();
-        n.y = m_lexer.accept_double();
+        // Open the input file.
+        if (!lexer.open(filename))
+            throw ExceptionIOError();
 
-        m_lexer.eat_blanks();
-        n.z = m_lexer.accept_double();
+        // Parse the file.
+        StatementParser<MeshAssembler> parser(lexer, assembler);
+        parser.parse();
+        assembler.end();
 
-        m_normals.push_back(n);
+        // Close the input file.
+        lexer.close();
     }
 
-    void parse_usemtl_statement()
+    static void read_parallel(
+        const string&       filename,
+        const int           options,
+        IMeshBuilder&       builder)
     {
-        // Begin a mesh definition if we're not already inside one.
-        ensure_mesh_def();
-
-        // Retrieve the name of the material slot.
-        const string material_slot_name = parse_compound_identifier();
-
-        // Check whether this material slot has already been defined for this mesh.
-        const map<string, size_t>::const_iterator& it =
-            m_material_slots.find(material_slot_name);
+        // Map the input file into memory.
+        MemoryMappedFile file;
+        if (!file.open(filename.c_str()))
+            throw ExceptionIOError();
+
+        const char* file_begin = static_cast<const char*>(file.data());
+        const char* file_end = file_begin + file.size();
+
+        // Split the file into chunks at line boundaries, one chunk per thread.
+        const size_t chunk_count =
+            max<size_t>(
+                min<size_t>(
+                    System::get_logical_cpu_core_count(),
+                    file.size() / MinParallelChunkSize),
+                1);
+        vector<const char*> chunk_bounds(chunk_count + 1);
+        chunk_bounds[0] = file_begin;
+        chunk_bounds[chunk_count] = file_end;
+        for (size_t i = 1; i < chunk_count; ++i)
+        {
+            const char* ptr = max(file_begin + file.size() / chunk_count * i, chunk_bounds[i - 1]);
+            const char* newline = static_cast<const char*>(memchr(ptr, '\n', file_end - ptr));
+            chunk_bounds[i] = newline != nullptr ? newline + 1 : file_end;
+        }
 
-        if (it != m_material_slots.end())
+        // Parse all chunks in parallel.
+        const OBJMeshFileLexer::ParsingMode parsing_mode = get_parsing_mode(options);
+        vector<ParsedChunk> chunks(chunk_count);
+        boost::thread_group threads;
+        for (size_t i = 1; i < chunk_count; ++i)
         {
-            // It has: just make it the active material slot.
-            m_current_material_slot_index = it->second;
+            threads.create_thread(
+                [&chunks, &chunk_bounds, parsing_mode, i]()
+                {
+                    chunks[i].parse(chunk_bounds[i], chunk_bounds[i + 1], parsing_mode);
+                });
         }
-        else
+        chunks[0].parse(chunk_bounds[0], chunk_bounds[1], parsing_mode);
+        threads.join_all();
+
+        // Merge the features of all chunks in file order.
+        MeshAssembler assembler(builder, options);
+        vector<size_t> vertex_bases(chunk_count);
+        vector<size_t> tex_coord_bases(chunk_count);
+        vector<size_t> normal_bases(chunk_count);
+        for (size_t i = 0; i < chunk_count; ++i)
         {
-            // It hasn't: insert it into the mesh and make it the active material slot.
-            m_current_material_slot_index = m_builder.push_material_slot(material_slot_name.c_str());
-            m_material_slots.insert(make_pair(material_slot_name, m_current_material_slot_index));
+            vertex_bases[i] = assembler.m_vertices.size();
+            tex_coord_bases[i] = assembler.m_tex_coords.size();
+            normal_bases[i] = assembler.m_normals.size();
+            append_and_release(assembler.m_vertices, chunks[i].m_vertices);
+            append_and_release(assembler.m_tex_coords, chunks[i].m_tex_coords);
+            append_and_release(assembler.m_normals, chunks[i].m_normals);
         }
-    }
 
-    void ensure_mesh_def()
-    {
-        if (!m_inside_mesh_def)
+        // Replay the statements of all chunks in file order.
+        size_t first_line = 1;
+        for (size_t i = 0; i < chunk_count; ++i)
         {
-            // Begin the definition of the new mesh.
-            m_builder.begin_mesh(m_current_mesh_name.c_str());
-            m_inside_mesh_def = true;
+            const ParsedChunk& chunk = chunks[i];
+
+            if (chunk.m_exception)
+                rethrow_exception(chunk.m_exception);
+
+            replay_chunk(
+                assembler,
+                chunk,
+                first_line,
+                vertex_bases[i],
+                tex_coord_bases[i],
+                normal_bases[i]);
+
+            if (chunk.m_parse_error)
+                throw ExceptionParseError(first_line + chunk.m_parse_error_line - 1);
 
-            // Clear material slot definitions.
-            m_material_slots.clear();
-            m_current_material_slot_index = 0;
+            first_line += chunk.m_line_count;
         }
+
+        assembler.end();
     }
 };
 
@@ -568,17 +983,9 @@ OBJMeshFileReader::OBJMeshFileReader(
 
 void OBJMeshFileReader::read(IMeshBuilder& builder)
 {
-    Impl impl(m_options, builder);
-
-    // Open the input file.
-    if (!impl.m_lexer.open(m_filename))
-        throw ExceptionIOError();
-
-    // Parse the file.
-    impl.parse_file();
-
-    // Close the input file.
-    impl.m_lexer.close();
+    if (m_options & ParallelParsing)
+        Impl::read_parallel(m_filename, m_options, builder);
+    else Impl::read_sequential(m_filename, m_options, builder);
 }
 
 }   // namespace foundation
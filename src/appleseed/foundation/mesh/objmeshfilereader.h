@@ -82,7 +82,8 @@ class OBJMeshFileReader
     {
         Default                 = 0,            // none of the flags below
         FavorSpeedOverPrecision = 1UL << 0,     // use approximate algorithm for parsing floating-point values
-        StopOnInvalidFaceDef    = 1UL << 1      // stop parsing on invalid face definitions
+        StopOnInvalidFaceDef    = 1UL << 1,     // stop parsing on invalid face definitions
+        ParallelParsing         = 1UL << 2      // memory-map the file and parse it on all available cores
     };
 
     // Constructor.
@@ -30,8 +30,12 @@
 // appleseed.foundation headers.
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/rng/lcg.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/benchmark.h"
 #include "foundation/utility/cache.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
 
 // Standard headers.
 #include <cassert>
@@ -104,3 +108,235 @@ BENCHMARK_SUITE(Foundation_Utility_Cache_LRUCache)
     BENCHMARK_CASE_F(MediumHitRate, Fixture<50>)    { payload(); }
     BENCHMARK_CASE_F(HighHitRate, Fixture<95>)      { payload(); }
 }
+
+BENCHMARK_SUITE(Foundation_Utility_Cache_SACache)
+{
+    // All fixtures hold the same number of elements, spread over more or fewer ways.
+    template <size_t Ways>
+    struct Fixture
+    {
+        typedef size_t MyKey;
+        typedef int MyElement;
+
+        struct MyKeyHasher
+        {
+            size_t operator()(const MyKey& key) const
+            {
+                return key;
+            }
+        };
+
+        struct MyElementSwapper
+        {
+            void load(const MyKey key, MyElement& element)
+            {
+                element = static_cast<MyElement>(key);
+            }
+
+            void unload(const MyKey key, MyElement& element)
+            {
+            }
+        };
+
+        typedef SACache<
+            MyKey,
+            MyKeyHasher,
+            MyElement,
+            MyElementSwapper,
+            256 / Ways,
+            Ways
+        > MyCache;
+
+        MyKeyHasher             m_key_hasher;
+        MyElementSwapper        m_element_swapper;
+        MyCache                 m_cache;
+        int                     m_dummy;
+
+        Fixture()
+          : m_cache(m_key_hasher, m_element_swapper, ~MyKey(0))
+        {
+        }
+
+        void payload()
+        {
+            LCG rng;
+
+            m_dummy = 0;
+
+            for (size_t i = 0; i < 1000; ++i)
+                m_dummy += m_cache.get(rand_int1(rng, 0, 319));
+        }
+    };
+
+    BENCHMARK_CASE_F(Get_1Way, Fixture<1>)      { payload(); }
+    BENCHMARK_CASE_F(Get_2Ways, Fixture<2>)     { payload(); }
+    BENCHMARK_CASE_F(Get_4Ways, Fixture<4>)     { payload(); }
+    BENCHMARK_CASE_F(Get_8Ways, Fixture<8>)     { payload(); }
+    BENCHMARK_CASE_F(Get_16Ways, Fixture<16>)   { payload(); }
+}
+
+BENCHMARK_SUITE(Foundation_Utility_Cache_Scaling)
+{
+    // The total number of lookups is the same regardless of the number of threads.
+    const size_t JobCount = 64;
+    const size_t LookupCount = 10000;
+    const int32 MaxKey = 511;
+
+    typedef size_t MyKey;
+    typedef int MyElement;
+
+    struct MyKeyHasher
+    {
+        size_t operator()(const MyKey& key) const
+        {
+            return key;
+        }
+    };
+
+    struct MySACacheElementSwapper
+    {
+        void load(const MyKey key, MyElement& element)
+        {
+            element = static_cast<MyElement>(key);
+        }
+
+        void unload(const MyKey key, MyElement& element)
+        {
+        }
+    };
+
+    struct MyLRUCacheElementSwapper
+    {
+        void load(const MyKey key, MyElement& element)
+        {
+            element = static_cast<MyElement>(key);
+        }
+
+        bool unload(const MyKey key, MyElement& element)
+        {
+            return true;
+        }
+
+        bool is_full(const size_t element_count) const
+        {
+            return element_count == 256;
+        }
+    };
+
+    typedef SACache<
+        MyKey,
+        MyKeyHasher,
+        MyElement,
+        MySACacheElementSwapper,
+        64,                     // number of cache lines
+        4                       // number of ways
+    > MySACache;
+
+    typedef LRUCache<
+        MyKey,
+        MyKeyHasher,
+        MyElement,
+        MyLRUCacheElementSwapper
+    > MyLRUCache;
+
+    // Each job owns its cache, like rendering threads own their texture caches.
+    struct PrivateSACacheJob
+      : public IJob
+    {
+        uint32          m_seed;
+        volatile int    m_dummy;
+
+        void execute(const size_t thread_index) override
+        {
+            MyKeyHasher key_hasher;
+            MySACacheElementSwapper element_swapper;
+            MySACache cache(key_hasher, element_swapper, ~MyKey(0));
+
+            LCG rng(m_seed);
+            int dummy = 0;
+
+            for (size_t i = 0; i < LookupCount; ++i)
+                dummy += cache.get(rand_int1(rng, 0, MaxKey));
+
+            m_dummy = dummy;
+        }
+    };
+
+    // All jobs share a single cache protected by a mutex.
+    struct SharedLRUCacheJob
+      : public IJob
+    {
+        MyLRUCache*     m_cache;
+        boost::mutex*   m_mutex;
+        uint32          m_seed;
+        volatile int    m_dummy;
+
+        void execute(const size_t thread_index) override
+        {
+            LCG rng(m_seed);
+            int dummy = 0;
+
+            for (size_t i = 0; i < LookupCount; ++i)
+            {
+                const MyKey key = rand_int1(rng, 0, MaxKey);
+                boost::mutex::scoped_lock lock(*m_mutex);
+                dummy += m_cache->get(key);
+            }
+
+            m_dummy = dummy;
+        }
+    };
+
+    template <size_t ThreadCount>
+    struct Fixture
+    {
+        Logger                      m_logger;
+        JobQueue                    m_job_queue;
+        JobManager                  m_job_manager;
+
+        MyKeyHasher                 m_key_hasher;
+        MyLRUCacheElementSwapper    m_element_swapper;
+        MyLRUCache                  m_shared_cache;
+        boost::mutex                m_shared_cache_mutex;
+
+        PrivateSACacheJob           m_private_cache_jobs[JobCount];
+        SharedLRUCacheJob           m_shared_cache_jobs[JobCount];
+
+        Fixture()
+          : m_job_manager(m_logger, m_job_queue, ThreadCount, JobManager::KeepRunningOnEmptyQueue)
+          , m_shared_cache(m_key_hasher, m_element_swapper)
+        {
+            for (size_t i = 0; i < JobCount; ++i)
+            {
+                m_private_cache_jobs[i].m_seed = static_cast<uint32>(i);
+
+                m_shared_cache_jobs[i].m_cache = &m_shared_cache;
+                m_shared_cache_jobs[i].m_mutex = &m_shared_cache_mutex;
+                m_shared_cache_jobs[i].m_seed = static_cast<uint32>(i);
+            }
+
+            m_job_manager.start();
+        }
+
+        template <typename JobType>
+        void run_jobs(JobType* jobs)
+        {
+            for (size_t i = 0; i < JobCount; ++i)
+                m_job_queue.schedule(&jobs[i], false);
+
+            m_job_queue.wait_until_completion();
+        }
+    };
+
+    BENCHMARK_CASE_F(PrivateSACache_1Thread, Fixture<1>)      { run_jobs(m_private_cache_jobs); }
+    BENCHMARK_CASE_F(PrivateSACache_2Threads, Fixture<2>)     { run_jobs(m_private_cache_jobs); }
+    BENCHMARK_CASE_F(PrivateSACache_4Threads, Fixture<4>)     { run_jobs(m_private_cache_jobs); }
+    BENCHMARK_CASE_F(PrivateSACache_8Threads, Fixture<8>)     { run_jobs(m_private_cache_jobs); }
+    BENCHMARK_CASE_F(PrivateSACache_16Threads, Fixture<16>)   { run_jobs(m_private_cache_jobs); }
+
+    BENCHMARK_CASE_F(SharedLRUCache_1Thread, Fixture<1>)      { run_jobs(m_shared_cache_jobs); }
+    BENCHMARK_CASE_F(SharedLRUCache_2Threads, Fixture<2>)     { run_jobs(m_shared_cache_jobs); }
+    BENCHMARK_CASE_F(SharedLRUCache_4Threads, Fixture<4>)     { run_jobs(m_shared_cache_jobs); }
+    BENCHMARK_CASE_F(SharedLRUCache_8Threads, Fixture<8>)     { run_jobs(m_shared_cache_jobs); }
+    BENCHMARK_CASE_F(SharedLRUCache_16Threads, Fixture<16>)   { run_jobs(m_shared_cache_jobs); }
+}
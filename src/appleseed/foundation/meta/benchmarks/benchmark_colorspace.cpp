@@ -63,6 +63,44 @@ BENCHMARK_SUITE(Foundation_Image_ColorSpace)
         m_output = fast_linear_rgb_to_srgb(m_input);
     }
 
+    struct TransferFunctionArrayFixture
+    {
+        static const size_t ValueCount = 1024;
+
+        float m_input[ValueCount];
+        float m_output[ValueCount];
+
+        TransferFunctionArrayFixture()
+        {
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < ValueCount; ++i)
+                m_input[i] = rand_float1(rng);
+        }
+    };
+
+    BENCHMARK_CASE_F(FastLinearRGBTosRGBConversion_SingleComponents, TransferFunctionArrayFixture)
+    {
+        for (size_t i = 0; i < ValueCount; ++i)
+            m_output[i] = fast_linear_rgb_to_srgb(m_input[i]);
+    }
+
+    BENCHMARK_CASE_F(FastLinearRGBTosRGBConversion_Array, TransferFunctionArrayFixture)
+    {
+        fast_linear_rgb_to_srgb(m_input, m_output, ValueCount);
+    }
+
+    BENCHMARK_CASE_F(FastsRGBToLinearRGBConversion_SingleComponents, TransferFunctionArrayFixture)
+    {
+        for (size_t i = 0; i < ValueCount; ++i)
+            m_output[i] = fast_srgb_to_linear_rgb(m_input[i]);
+    }
+
+    BENCHMARK_CASE_F(FastsRGBToLinearRGBConversion_Array, TransferFunctionArrayFixture)
+    {
+        fast_srgb_to_linear_rgb(m_input, m_output, ValueCount);
+    }
+
     struct SpectrumToCIEXYZFixture
     {
         const LightingConditions    m_lighting_conditions;
@@ -0,0 +1,107 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/hash.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/containers/flathashtable.h"
+#include "foundation/utility/containers/hashtable.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+BENCHMARK_SUITE(Foundation_Utility_Containers_HashTable)
+{
+    const size_t TableSize = 64 * 1024;
+    const size_t LookupCount = 1000;
+
+    struct KeyHasher
+    {
+        size_t operator()(const uint32 key) const
+        {
+            return static_cast<size_t>(hash_uint32(key));
+        }
+    };
+
+    template <typename HashTableType>
+    struct Fixture
+    {
+        KeyHasher       m_key_hasher;
+        HashTableType   m_hash_table;
+        vector<uint32>  m_keys;
+        float           m_result;
+
+        Fixture()
+          : m_hash_table(m_key_hasher)
+          , m_result(0.0f)
+        {
+            m_hash_table.resize(TableSize);
+
+            for (size_t i = 0; i < TableSize; ++i)
+                m_hash_table.insert(static_cast<uint32>(i), static_cast<float>(i));
+
+            // Half of the lookups are for keys that are not in the table.
+            MersenneTwister rng;
+            m_keys.resize(LookupCount);
+
+            for (size_t i = 0; i < LookupCount; ++i)
+                m_keys[i] = static_cast<uint32>(rand_int1(rng, 0, static_cast<int32>(2 * TableSize - 1)));
+        }
+
+        void lookup()
+        {
+            for (size_t i = 0; i < LookupCount; ++i)
+            {
+                const float* value = m_hash_table.get(m_keys[i]);
+
+                if (value != nullptr)
+                    m_result += *value;
+            }
+        }
+    };
+
+    typedef Fixture<HashTable<uint32, KeyHasher, float>> ChainingFixture;
+    typedef Fixture<FlatHashTable<uint32, KeyHasher, float>> FlatFixture;
+
+    BENCHMARK_CASE_F(HashTable_Get, ChainingFixture)
+    {
+        lookup();
+    }
+
+    BENCHMARK_CASE_F(FlatHashTable_Get, FlatFixture)
+    {
+        lookup();
+    }
+}
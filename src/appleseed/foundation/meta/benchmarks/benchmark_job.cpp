@@ -48,6 +48,23 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
         }
     };
 
+    // A job performing a fixed amount of computations.
+    struct ComputeJob
+      : public IJob
+    {
+        volatile double m_result;
+
+        void execute(const size_t thread_index) override
+        {
+            double x = 0.0;
+
+            for (size_t i = 0; i < 10000; ++i)
+                x = x * 0.999 + 1.0 / (1.0 + static_cast<double>(i));
+
+            m_result = x;
+        }
+    };
+
     template <size_t ThreadCount>
     struct Fixture
     {
@@ -61,16 +78,23 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
             m_job_manager.start();
         }
 
-        void payload()
+        template <typename JobType>
+        void run_jobs()
         {
+            // The total amount of work is the same regardless of the number of threads.
             const size_t JobCount = 256;
-            EmptyJob jobs[JobCount];
+            JobType jobs[JobCount];
 
             for (size_t i = 0; i < JobCount; ++i)
                 m_job_queue.schedule(&jobs[i], false);
 
             m_job_queue.wait_until_completion();
         }
+
+        void payload()
+        {
+            run_jobs<EmptyJob>();
+        }
     };
 
     BENCHMARK_CASE_F(SingleThreadedJobExecution, Fixture<1>)
@@ -82,4 +106,19 @@ BENCHMARK_SUITE(Foundation_Utility_Job)
     {
         payload();
     }
+
+    // Scaling benchmarks. Empty jobs measure the contention on the job queue,
+    // compute jobs measure how well useful work scales with the number of threads.
+
+    BENCHMARK_CASE_F(EmptyJobs_1Thread, Fixture<1>)         { run_jobs<EmptyJob>(); }
+    BENCHMARK_CASE_F(EmptyJobs_2Threads, Fixture<2>)        { run_jobs<EmptyJob>(); }
+    BENCHMARK_CASE_F(EmptyJobs_4Threads, Fixture<4>)        { run_jobs<EmptyJob>(); }
+    BENCHMARK_CASE_F(EmptyJobs_8Threads, Fixture<8>)        { run_jobs<EmptyJob>(); }
+    BENCHMARK_CASE_F(EmptyJobs_16Threads, Fixture<16>)      { run_jobs<EmptyJob>(); }
+
+    BENCHMARK_CASE_F(ComputeJobs_1Thread, Fixture<1>)       { run_jobs<ComputeJob>(); }
+    BENCHMARK_CASE_F(ComputeJobs_2Threads, Fixture<2>)      { run_jobs<ComputeJob>(); }
+    BENCHMARK_CASE_F(ComputeJobs_4Threads, Fixture<4>)      { run_jobs<ComputeJob>(); }
+    BENCHMARK_CASE_F(ComputeJobs_8Threads, Fixture<8>)      { run_jobs<ComputeJob>(); }
+    BENCHMARK_CASE_F(ComputeJobs_16Threads, Fixture<16>)    { run_jobs<ComputeJob>(); }
 }
@@ -106,6 +106,11 @@ BENCHMARK_SUITE(Foundation_Math_Microfacet)
         sample(0.5f, 0.5f);
     }
 
+    BENCHMARK_CASE_F(BeckmannMDF_SampleAnisotropic, FixtureBase<BeckmannMDF>)
+    {
+        sample(0.25f, 0.75f);
+    }
+
     BENCHMARK_CASE_F(BeckmannMDF_Evaluate, FixtureBase<BeckmannMDF>)
     {
         evaluate(0.5f, 0.5f);
@@ -27,6 +27,7 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/math/rng/bufferedrng.h"
 #include "foundation/math/rng/lcg.h"
 #include "foundation/math/rng/pcg.h"
 #include "foundation/math/rng/serialmersennetwister.h"
@@ -138,4 +139,44 @@ BENCHMARK_SUITE(Foundation_Math_RNG)
             m_dummy ^= m_rng.rand_uint32();
         }
     }
+
+    template <typename RNG>
+    struct FillFixture
+      : public Fixture<RNG>
+    {
+        uint32  m_values[1000];
+    };
+
+    BENCHMARK_CASE_F(PCG_FillUint32, FillFixture<PCG>)
+    {
+        m_rng.fill_uint32(m_values, 1000);
+        m_dummy ^= m_values[999];
+    }
+
+#ifdef APPLESEED_USE_SSE
+
+    BENCHMARK_CASE_F(SimdMersenneTwister_FillUint32, FillFixture<SimdMersenneTwister>)
+    {
+        m_rng.fill_uint32(m_values, 1000);
+        m_dummy ^= m_values[999];
+    }
+
+    BENCHMARK_CASE_F(BufferedSimdMersenneTwister_RandUint32, Fixture<BufferedRNG<SimdMersenneTwister>>)
+    {
+        for (size_t i = 0; i < 250000; ++i)
+        {
+            m_dummy ^= m_rng.rand_uint32();
+            m_dummy ^= m_rng.rand_uint32();
+            m_dummy ^= m_rng.rand_uint32();
+            m_dummy ^= m_rng.rand_uint32();
+        }
+    }
+
+#endif
+
+    BENCHMARK_CASE_F(Xoroshiro128plus_FillUint32, FillFixture<Xoroshiro128plus>)
+    {
+        m_rng.fill_uint32(m_values, 1000);
+        m_dummy ^= m_values[999];
+    }
 }
@@ -28,6 +28,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
+#include "foundation/image/conversion.h"
 #include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/utility/benchmark.h"
@@ -69,4 +70,56 @@ BENCHMARK_SUITE(Foundation_Image_Tile)
     {
         m_dest.copy_from(m_source);
     }
+
+    template <PixelFormat SourceFormat, PixelFormat DestFormat>
+    struct ConversionFixture
+    {
+        Tile m_source;
+        Tile m_dest;
+
+        ConversionFixture()
+          : m_source(64, 64, 4, SourceFormat)
+          , m_dest(64, 64, 4, DestFormat)
+        {
+            for (size_t i = 0, e = m_source.get_pixel_count(); i < e; ++i)
+                m_source.set_pixel(i, Color4f(i * (1.0f / e), 0.5f, 0.75f, 1.0f));
+        }
+    };
+
+    typedef ConversionFixture<PixelFormatFloat, PixelFormatHalf> FloatToHalfFixture;
+
+    BENCHMARK_CASE_F(CopyFrom_FloatToHalf, FloatToHalfFixture)
+    {
+        m_dest.copy_from(m_source);
+    }
+
+    typedef ConversionFixture<PixelFormatFloat, PixelFormatUInt8> FloatToUInt8Fixture;
+
+    BENCHMARK_CASE_F(CopyFrom_FloatToUInt8, FloatToUInt8Fixture)
+    {
+        m_dest.copy_from(m_source);
+    }
+
+    typedef ConversionFixture<PixelFormatHalf, PixelFormatFloat> HalfToFloatFixture;
+
+    BENCHMARK_CASE_F(CopyFrom_HalfToFloat, HalfToFloatFixture)
+    {
+        m_dest.copy_from(m_source);
+    }
+
+    struct LinearRGBToSRGBFixture
+    {
+        Tile m_tile;
+
+        LinearRGBToSRGBFixture()
+          : m_tile(64, 64, 4, PixelFormatFloat)
+        {
+            m_tile.clear(Color4f(0.2f, 0.4f, 0.6f, 0.8f));
+        }
+    };
+
+    BENCHMARK_CASE_F(ConvertLinearRGBToSRGB, LinearRGBToSRGBFixture)
+    {
+        convert_linear_rgb_to_srgb(m_tile);
+    }
 }
@@ -108,6 +108,18 @@ BENCHMARK_SUITE(Foundation_Math_VoxelGrid3)
         }
     }
 
+    BENCHMARK_CASE_F(BatchedLinearLookup, Fixture)
+    {
+        APPLESEED_SIMD4_ALIGN float values[LookupPointCount * ChannelCount];
+        m_grid.linear_lookup(LookupPointCount, m_lookup_points, values);
+
+        for (size_t i = 0; i < LookupPointCount; ++i)
+        {
+            for (size_t j = 0; j < ChannelCount; ++j)
+                m_accumulated_values[j] += values[i * ChannelCount + j];
+        }
+    }
+
     BENCHMARK_CASE_F(QuadraticLookup, Fixture)
     {
         for (size_t i = 0; i < LookupPointCount; ++i)
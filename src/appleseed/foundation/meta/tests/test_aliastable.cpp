@@ -0,0 +1,160 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aliastable.h"
+#include "foundation/math/fp.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_AliasTable)
+{
+    typedef foundation::AliasTable<double> AliasTable;
+
+    TEST_CASE(Empty_GivenTableInInitialState_ReturnsTrue)
+    {
+        AliasTable table;
+
+        EXPECT_TRUE(table.empty());
+    }
+
+    TEST_CASE(Valid_GivenTableInInitialState_ReturnsFalse)
+    {
+        AliasTable table;
+
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Valid_GivenTableWithOneItemWithZeroWeight_ReturnsFalse)
+    {
+        AliasTable table;
+        table.insert(0.0);
+
+        EXPECT_FALSE(table.valid());
+    }
+
+    TEST_CASE(Sample_GivenTableWithOneItemWithPositiveWeight_ReturnsItem)
+    {
+        AliasTable table;
+        table.insert(0.5);
+        table.prepare();
+
+        double probability;
+        const size_t result = table.sample(0.5, probability);
+
+        EXPECT_EQ(0, result);
+        EXPECT_FEQ(1.0, probability);
+    }
+
+    struct Fixture
+    {
+        AliasTable m_table;
+
+        Fixture()
+        {
+            m_table.insert(0.0);
+            m_table.insert(1.0);
+            m_table.insert(0.0);
+            m_table.insert(2.0);
+            m_table.insert(5.0);
+            m_table.prepare();
+        }
+
+        vector<size_t> sweep(const size_t sample_count) const
+        {
+            vector<size_t> counts(m_table.size(), 0);
+
+            for (size_t i = 0; i < sample_count; ++i)
+            {
+                double probability;
+                ++counts[m_table.sample((i + 0.5) / sample_count, probability)];
+            }
+
+            return counts;
+        }
+    };
+
+    TEST_CASE_F(GetProbability_ReturnsNormalizedWeights, Fixture)
+    {
+        EXPECT_FEQ(0.125, m_table.get_probability(1));
+        EXPECT_FEQ(0.250, m_table.get_probability(3));
+        EXPECT_FEQ(0.625, m_table.get_probability(4));
+    }
+
+    TEST_CASE_F(Sample_NeverReturnsItemsWithZeroWeight, Fixture)
+    {
+        const vector<size_t> counts = sweep(10000);
+
+        EXPECT_EQ(0, counts[0]);
+        EXPECT_EQ(0, counts[2]);
+    }
+
+    TEST_CASE_F(Sample_GivenInputOneUlpBeforeOne_ReturnsItemWithPositiveWeight, Fixture)
+    {
+        double probability;
+        const size_t result = m_table.sample(shift(1.0, -1), probability);
+
+        EXPECT_GT(0.0, probability);
+        EXPECT_FEQ(m_table.get_probability(result), probability);
+    }
+
+    TEST_CASE_F(Sample_GivenUniformInputs_ReturnsItemsProportionallyToTheirWeight, Fixture)
+    {
+        const size_t SampleCount = 80000;
+        const vector<size_t> counts = sweep(SampleCount);
+
+        EXPECT_EQ(10000, counts[1]);
+        EXPECT_EQ(20000, counts[3]);
+        EXPECT_EQ(50000, counts[4]);
+    }
+
+    TEST_CASE_F(Sample_GivenUniformInputs_ReturnsUniformRemappedInputs, Fixture)
+    {
+        const size_t SampleCount = 80000;
+        vector<size_t> histogram(4, 0);
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            double probability, remapped_x;
+            if (m_table.sample((i + 0.5) / SampleCount, probability, remapped_x) == 4)
+            {
+                ASSERT_TRUE(remapped_x >= 0.0 && remapped_x < 1.0);
+                ++histogram[static_cast<size_t>(remapped_x * histogram.size())];
+            }
+        }
+
+        for (size_t i = 0; i < histogram.size(); ++i)
+            EXPECT_FEQ_EPS(12500.0, static_cast<double>(histogram[i]), 1.0e-3);
+    }
+}
@@ -0,0 +1,137 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/arena.h"
+#include "foundation/utility/memory.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Utility_Arena)
+{
+    TEST_CASE(Allocate_Returns16ByteAlignedBlocks)
+    {
+        Arena arena;
+
+        for (size_t i = 1; i < 100; ++i)
+            EXPECT_TRUE(is_aligned(arena.allocate(i), 16));
+    }
+
+    TEST_CASE(Allocate_GivenMoreMemoryThanOneChunk_AddsChunks)
+    {
+        Arena arena(1024);
+
+        // Allocate more memory than the largest chunk that may be recycled from the pool.
+        for (size_t i = 0; i < 200; ++i)
+            arena.allocate(1000);
+
+        EXPECT_GT(1u, arena.get_chunk_count());
+    }
+
+    TEST_CASE(Allocate_GivenBlockLargerThanChunkSize_Succeeds)
+    {
+        Arena arena(1024);
+
+        char* ptr = static_cast<char*>(arena.allocate(10000));
+        ptr[0] = ptr[9999] = 42;
+
+        EXPECT_EQ(1, arena.get_chunk_count());
+    }
+
+    TEST_CASE(Clear_KeepsChunksForSubsequentAllocations)
+    {
+        Arena arena(1024);
+
+        void* first = arena.allocate(16);
+
+        for (size_t i = 0; i < 100; ++i)
+            arena.allocate(100);
+
+        const size_t chunk_count = arena.get_chunk_count();
+
+        arena.clear();
+
+        EXPECT_EQ(first, arena.allocate(16));
+
+        for (size_t i = 0; i < 100; ++i)
+            arena.allocate(100);
+
+        EXPECT_EQ(chunk_count, arena.get_chunk_count());
+    }
+
+    TEST_CASE(Rewind_ReleasesAllocationsMadeAfterMarker)
+    {
+        Arena arena(1024);
+
+        arena.allocate(64);
+
+        const Arena::Marker marker = arena.get_marker();
+        void* ptr = arena.allocate(64);
+
+        for (size_t i = 0; i < 100; ++i)
+            arena.allocate(100);
+
+        arena.rewind(marker);
+
+        EXPECT_EQ(ptr, arena.allocate(64));
+    }
+
+    TEST_CASE(ArenaScope_RewindsArenaOnDestruction)
+    {
+        Arena arena;
+        arena.allocate(64);
+
+        void* ptr;
+
+        {
+            ArenaScope scope(arena);
+            ptr = arena.allocate(64);
+        }
+
+        EXPECT_EQ(ptr, arena.allocate(64));
+    }
+
+    TEST_CASE(ArenaScope_GivenEmptyArena_RewindsArenaOnDestruction)
+    {
+        Arena arena;
+
+        void* ptr;
+
+        {
+            ArenaScope scope(arena);
+            ptr = arena.allocate(64);
+        }
+
+        EXPECT_EQ(ptr, arena.allocate(64));
+        EXPECT_EQ(1, arena.get_chunk_count());
+    }
+}
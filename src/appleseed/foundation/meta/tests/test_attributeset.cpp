@@ -96,4 +96,25 @@ TEST_SUITE(Foundation_Utility_AttributeSet)
 
         EXPECT_EQ(RefUV, uv);
     }
+
+    TEST_CASE_F(TestCopyFrom, FixtureTestAttributeSet)
+    {
+        const Vector2f RefUV(0.2f, 0.4f);
+        attributes.push_attribute(uv_id, RefUV);
+
+        AttributeSet copy;
+        copy.create_channel("other", NumericTypeFloat, 1);
+        copy.copy_from(attributes);
+
+        attributes.set_attribute(uv_id, 0, Vector2f(0.0f));
+
+        EXPECT_EQ(uv_id, copy.find_channel("uv"));
+        EXPECT_TRUE(copy.find_channel("other") == AttributeSet::InvalidChannelID);
+        ASSERT_EQ(1, copy.get_attribute_count(uv_id));
+
+        Vector2f uv;
+        copy.get_attribute<Vector2f>(uv_id, 0, &uv);
+
+        EXPECT_EQ(RefUV, uv);
+    }
 }
@@ -37,6 +37,7 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/countof.h"
+#include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
@@ -47,6 +48,44 @@
 using namespace foundation;
 using namespace std;
 
+TEST_SUITE(Foundation_Math_BezierCurve3)
+{
+    TEST_CASE(Constructor_GivenProjectiveTransform_TransformsControlPoints)
+    {
+        const Vector3f ControlPoints[] = { Vector3f(-0.7f, 0.0f, 1.0f), Vector3f(-0.2f, 0.8f, 2.0f), Vector3f(0.2f, -0.8f, 3.0f), Vector3f(0.7f, 0.0f, 4.0f) };
+        const BezierCurve3f curve(ControlPoints, 0.1f, 1.0f, Color3f(0.2f, 0.0f, 0.7f));
+
+        Matrix4f xfm = Matrix4f::make_rotation_y(0.3f) * Matrix4f::make_translation(Vector3f(1.0f, 2.0f, 3.0f));
+        xfm(3, 2) = 0.5f;
+
+        const BezierCurve3f xfm_curve(curve, xfm);
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const Vector4f p = xfm * Vector4f(ControlPoints[i].x, ControlPoints[i].y, ControlPoints[i].z, 1.0f);
+            const Vector3f expected(p.x / p.w, p.y / p.w, p.z / p.w);
+
+            EXPECT_FEQ_EPS(expected, xfm_curve.get_control_point(i), 1.0e-5f);
+        }
+    }
+
+    TEST_CASE(ScaleWidths_MultipliesAllWidths)
+    {
+        const Vector3f ControlPoints[] = { Vector3f(0.0f, 0.0f, 0.0f), Vector3f(1.0f, 0.0f, 0.0f), Vector3f(2.0f, 0.0f, 0.0f), Vector3f(3.0f, 0.0f, 0.0f) };
+        const float Widths[] = { 0.1f, 0.2f, 0.3f, 0.4f };
+        const float Opacities[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        const Color3f Colors[] = { Color3f(1.0f), Color3f(1.0f), Color3f(1.0f), Color3f(1.0f) };
+        BezierCurve3f curve(ControlPoints, Widths, Opacities, Colors);
+
+        curve.scale_widths(4.0f);
+
+        for (size_t i = 0; i < 4; ++i)
+            EXPECT_FEQ(4.0f * Widths[i], curve.get_width(i));
+
+        EXPECT_FEQ(1.6f, curve.compute_max_width());
+    }
+}
+
 TEST_SUITE(Foundation_Math_BezierCurveIntersector)
 {
 #pragma warning (push)
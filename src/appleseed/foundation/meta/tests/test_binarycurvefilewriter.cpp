@@ -0,0 +1,259 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/curve/binarycurvefilereader.h"
+#include "foundation/curve/binarycurvefilewriter.h"
+#include "foundation/curve/curvebasis.h"
+#include "foundation/curve/icurvebuilder.h"
+#include "foundation/curve/icurvewalker.h"
+#include "foundation/image/color.h"
+#include "foundation/math/half.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Curve_BinaryCurveFileWriter)
+{
+    struct Curves
+    {
+        CurveBasis          m_basis;
+        vector<size_t>      m_vertex_counts;
+        vector<Vector3f>    m_vertices;
+        vector<float>       m_widths;
+        vector<float>       m_opacities;
+        vector<Color3f>     m_colors;
+    };
+
+    struct CurveBuilder
+      : public ICurveBuilder
+    {
+        vector<Curves>      m_objects;
+        size_t              m_vertex_array_count;
+        size_t              m_shared_color_count;
+
+        CurveBuilder()
+          : m_vertex_array_count(0)
+          , m_shared_color_count(0)
+        {
+        }
+
+        void begin_curve_object(const CurveBasis basis, const size_t count) override
+        {
+            m_objects.emplace_back();
+            m_objects.back().m_basis = basis;
+        }
+
+        void begin_curve() override
+        {
+            m_objects.back().m_vertex_counts.push_back(0);
+        }
+
+        void push_vertex(const Vector3f& v) override
+        {
+            m_objects.back().m_vertices.push_back(v);
+            ++m_objects.back().m_vertex_counts.back();
+        }
+
+        void push_vertex_width(const float w) override
+        {
+            m_objects.back().m_widths.push_back(w);
+        }
+
+        void push_vertex_color(const Color3f& c) override
+        {
+            m_objects.back().m_colors.push_back(c);
+        }
+
+        void push_vertex_opacity(const float o) override
+        {
+            m_objects.back().m_opacities.push_back(o);
+        }
+
+        void push_vertex_arrays(
+            const size_t    count,
+            const Vector3f  vertices[],
+            const Half      widths[],
+            const Half      opacities[],
+            const Color3f   colors[],
+            const size_t    color_count) override
+        {
+            ++m_vertex_array_count;
+
+            if (color_count == 1)
+                ++m_shared_color_count;
+
+            ICurveBuilder::push_vertex_arrays(count, vertices, widths, opacities, colors, color_count);
+        }
+
+        void end_curve() override
+        {
+        }
+
+        void end_curve_object() override
+        {
+        }
+    };
+
+    struct CurveWalker
+      : public ICurveWalker
+    {
+        const Curves& m_curves;
+
+        explicit CurveWalker(const Curves& curves)
+          : m_curves(curves)
+        {
+        }
+
+        CurveBasis get_basis() const override
+        {
+            return m_curves.m_basis;
+        }
+
+        size_t get_curve_count() const override
+        {
+            return m_curves.m_vertex_counts.size();
+        }
+
+        size_t get_vertex_count(const size_t i) const override
+        {
+            return m_curves.m_vertex_counts[i];
+        }
+
+        Vector3f get_vertex(const size_t i) const override
+        {
+            return m_curves.m_vertices[i];
+        }
+
+        float get_vertex_width(const size_t i) const override
+        {
+            return m_curves.m_widths[i];
+        }
+
+        float get_vertex_opacity(const size_t i) const override
+        {
+            return m_curves.m_opacities[i];
+        }
+
+        Color3f get_vertex_color(const size_t i) const override
+        {
+            return m_curves.m_colors[i];
+        }
+    };
+
+    // Widths and opacities are exactly representable in half precision.
+    Curves create_curves(const Color3f& tip_color)
+    {
+        Curves curves;
+        curves.m_basis = CurveBasis::Bezier;
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            curves.m_vertex_counts.push_back(4);
+
+            for (size_t j = 0; j < 4; ++j)
+            {
+                curves.m_vertices.emplace_back(static_cast<float>(i), static_cast<float>(j), 0.5f);
+                curves.m_widths.push_back(0.25f / (1 << j));
+                curves.m_opacities.push_back(j == 3 ? 0.5f : 1.0f);
+                curves.m_colors.push_back(j == 3 ? tip_color : Color3f(0.25f, 0.5f, 1.0f));
+            }
+        }
+
+        return curves;
+    }
+
+    bool operator==(const Curves& lhs, const Curves& rhs)
+    {
+        return
+            lhs.m_basis == rhs.m_basis &&
+            lhs.m_vertex_counts == rhs.m_vertex_counts &&
+            lhs.m_vertices == rhs.m_vertices &&
+            lhs.m_widths == rhs.m_widths &&
+            lhs.m_opacities == rhs.m_opacities &&
+            lhs.m_colors == rhs.m_colors;
+    }
+
+    void write_curves(const char* filename, const int options, const Curves& curves1, const Curves& curves2)
+    {
+        BinaryCurveFileWriter writer(filename, options);
+        writer.write(CurveWalker(curves1));
+        writer.write(CurveWalker(curves2));
+    }
+
+    TEST_CASE(WriteTwoObjectsToFile)
+    {
+        const Curves curves1 = create_curves(Color3f(0.25f, 0.5f, 1.0f));
+        const Curves curves2 = create_curves(Color3f(1.0f, 0.0f, 0.0f));
+
+        write_curves(
+            "unit tests/outputs/test_binarycurvefilewriter_twoobjects.binarycurve",
+            BinaryCurveFileWriter::Default,
+            curves1,
+            curves2);
+
+        BinaryCurveFileReader reader("unit tests/outputs/test_binarycurvefilewriter_twoobjects.binarycurve");
+        CurveBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(2, builder.m_objects.size());
+        EXPECT_TRUE(curves1 == builder.m_objects[0]);
+        EXPECT_TRUE(curves2 == builder.m_objects[1]);
+        EXPECT_EQ(0, builder.m_vertex_array_count);
+    }
+
+    TEST_CASE(WriteTwoMemoryMappableObjectsToFile_ReadsVertexArraysInBulk)
+    {
+        const Curves curves1 = create_curves(Color3f(0.25f, 0.5f, 1.0f));
+        const Curves curves2 = create_curves(Color3f(1.0f, 0.0f, 0.0f));
+
+        write_curves(
+            "unit tests/outputs/test_binarycurvefilewriter_twomappableobjects.binarycurve",
+            BinaryCurveFileWriter::MemoryMappable,
+            curves1,
+            curves2);
+
+        BinaryCurveFileReader reader("unit tests/outputs/test_binarycurvefilewriter_twomappableobjects.binarycurve");
+        CurveBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(2, builder.m_objects.size());
+        EXPECT_TRUE(curves1 == builder.m_objects[0]);
+        EXPECT_TRUE(curves2 == builder.m_objects[1]);
+        EXPECT_EQ(4, builder.m_vertex_array_count);
+
+        // Only the curves of the first object have a uniform color.
+        EXPECT_EQ(2, builder.m_shared_color_count);
+    }
+}
@@ -0,0 +1,360 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfilereader.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
+#include "foundation/mesh/imeshwalker.h"
+#include "foundation/mesh/meshbuilderbase.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Mesh_BinaryMeshFileWriter)
+{
+    struct Face
+    {
+        vector<size_t>      m_vertices;
+        vector<size_t>      m_vertex_normals;
+        vector<size_t>      m_tex_coords;
+        size_t              m_material;
+    };
+
+    struct Mesh
+    {
+        string              m_name;
+        vector<Vector3d>    m_vertices;
+        vector<Vector3d>    m_vertex_normals;
+        vector<Vector2d>    m_tex_coords;
+        vector<string>      m_material_slots;
+        vector<Face>        m_faces;
+    };
+
+    struct MeshBuilder
+      : public MeshBuilderBase
+    {
+        vector<Mesh>    m_meshes;
+        size_t          m_triangle_array_count;
+        size_t          m_face_vertex_count;
+
+        MeshBuilder()
+          : m_triangle_array_count(0)
+        {
+        }
+
+        void begin_mesh(const char* name) override
+        {
+            m_meshes.emplace_back();
+            m_meshes.back().m_name = name;
+        }
+
+        size_t push_vertex(const Vector3d& v) override
+        {
+            m_meshes.back().m_vertices.push_back(v);
+            return m_meshes.back().m_vertices.size() - 1;
+        }
+
+        size_t push_vertex_normal(const Vector3d& v) override
+        {
+            m_meshes.back().m_vertex_normals.push_back(v);
+            return m_meshes.back().m_vertex_normals.size() - 1;
+        }
+
+        size_t push_tex_coords(const Vector2d& v) override
+        {
+            m_meshes.back().m_tex_coords.push_back(v);
+            return m_meshes.back().m_tex_coords.size() - 1;
+        }
+
+        size_t push_material_slot(const char* name) override
+        {
+            m_meshes.back().m_material_slots.emplace_back(name);
+            return m_meshes.back().m_material_slots.size() - 1;
+        }
+
+        void push_triangle_array(
+            const uint32    vertices[],
+            const uint32    vertex_normals[],
+            const uint32    tex_coords[],
+            const uint16    materials[],
+            const size_t    count) override
+        {
+            ++m_triangle_array_count;
+            MeshBuilderBase::push_triangle_array(vertices, vertex_normals, tex_coords, materials, count);
+        }
+
+        void begin_face(const size_t vertex_count) override
+        {
+            m_meshes.back().m_faces.emplace_back();
+            m_face_vertex_count = vertex_count;
+        }
+
+        void set_face_vertices(const size_t vertices[]) override
+        {
+            m_meshes.back().m_faces.back().m_vertices.assign(vertices, vertices + m_face_vertex_count);
+        }
+
+        void set_face_vertex_normals(const size_t vertex_normals[]) override
+        {
+            m_meshes.back().m_faces.back().m_vertex_normals.assign(vertex_normals, vertex_normals + m_face_vertex_count);
+        }
+
+        void set_face_vertex_tex_coords(const size_t tex_coords[]) override
+        {
+            m_meshes.back().m_faces.back().m_tex_coords.assign(tex_coords, tex_coords + m_face_vertex_count);
+        }
+
+        void set_face_material(const size_t material) override
+        {
+            m_meshes.back().m_faces.back().m_material = material;
+        }
+    };
+
+    struct MeshWalker
+      : public IMeshWalker
+    {
+        const Mesh& m_mesh;
+
+        explicit MeshWalker(const Mesh& mesh)
+          : m_mesh(mesh)
+        {
+        }
+
+        const char* get_name() const override
+        {
+            return m_mesh.m_name.c_str();
+        }
+
+        size_t get_vertex_count() const override
+        {
+            return m_mesh.m_vertices.size();
+        }
+
+        Vector3d get_vertex(const size_t i) const override
+        {
+            return m_mesh.m_vertices[i];
+        }
+
+        size_t get_vertex_normal_count() const override
+        {
+            return m_mesh.m_vertex_normals.size();
+        }
+
+        Vector3d get_vertex_normal(const size_t i) const override
+        {
+            return m_mesh.m_vertex_normals[i];
+        }
+
+        size_t get_tex_coords_count() const override
+        {
+            return m_mesh.m_tex_coords.size();
+        }
+
+        Vector2d get_tex_coords(const size_t i) const override
+        {
+            return m_mesh.m_tex_coords[i];
+        }
+
+        size_t get_material_slot_count() const override
+        {
+            return m_mesh.m_material_slots.size();
+        }
+
+        const char* get_material_slot(const size_t i) const override
+        {
+            return m_mesh.m_material_slots[i].c_str();
+        }
+
+        size_t get_face_count() const override
+        {
+            return m_mesh.m_faces.size();
+        }
+
+        size_t get_face_vertex_count(const size_t face_index) const override
+        {
+            return m_mesh.m_faces[face_index].m_vertices.size();
+        }
+
+        size_t get_face_vertex(const size_t face_index, const size_t vertex_index) const override
+        {
+            return m_mesh.m_faces[face_index].m_vertices[vertex_index];
+        }
+
+        size_t get_face_vertex_normal(const size_t face_index, const size_t vertex_index) const override
+        {
+            return m_mesh.m_faces[face_index].m_vertex_normals[vertex_index];
+        }
+
+        size_t get_face_tex_coords(const size_t face_index, const size_t vertex_index) const override
+        {
+            return m_mesh.m_faces[face_index].m_tex_coords[vertex_index];
+        }
+
+        size_t get_face_material(const size_t face_index) const override
+        {
+            return m_mesh.m_faces[face_index].m_material;
+        }
+    };
+
+    Face create_face(const size_t v0, const size_t v1, const size_t v2, const size_t material)
+    {
+        Face face;
+        face.m_vertices = { v0, v1, v2 };
+        face.m_vertex_normals = { 0, 0, 0 };
+        face.m_tex_coords = { v0, v1, v2 };
+        face.m_material = material;
+        return face;
+    }
+
+    Mesh create_mesh(const string& name)
+    {
+        Mesh mesh;
+        mesh.m_name = name;
+
+        mesh.m_vertices.emplace_back(0.0, 0.0, 0.0);
+        mesh.m_vertices.emplace_back(1.0, 0.0, 0.0);
+        mesh.m_vertices.emplace_back(1.0, 1.0, 0.0);
+        mesh.m_vertices.emplace_back(0.0, 1.0, 0.0);
+
+        mesh.m_vertex_normals.emplace_back(0.0, 0.0, 1.0);
+
+        mesh.m_tex_coords.emplace_back(0.0, 0.0);
+        mesh.m_tex_coords.emplace_back(1.0, 0.0);
+        mesh.m_tex_coords.emplace_back(1.0, 1.0);
+        mesh.m_tex_coords.emplace_back(0.0, 1.0);
+
+        mesh.m_material_slots.emplace_back("front");
+        mesh.m_material_slots.emplace_back("back");
+
+        mesh.m_faces.push_back(create_face(0, 1, 2, 0));
+        mesh.m_faces.push_back(create_face(2, 3, 0, 1));
+
+        return mesh;
+    }
+
+    bool operator==(const Face& lhs, const Face& rhs)
+    {
+        return
+            lhs.m_vertices == rhs.m_vertices &&
+            lhs.m_vertex_normals == rhs.m_vertex_normals &&
+            lhs.m_tex_coords == rhs.m_tex_coords &&
+            lhs.m_material == rhs.m_material;
+    }
+
+    bool operator==(const Mesh& lhs, const Mesh& rhs)
+    {
+        return
+            lhs.m_name == rhs.m_name &&
+            lhs.m_vertices == rhs.m_vertices &&
+            lhs.m_vertex_normals == rhs.m_vertex_normals &&
+            lhs.m_tex_coords == rhs.m_tex_coords &&
+            lhs.m_material_slots == rhs.m_material_slots &&
+            lhs.m_faces == rhs.m_faces;
+    }
+
+    void write_meshes(const char* filename, const int options, const Mesh& mesh1, const Mesh& mesh2)
+    {
+        BinaryMeshFileWriter writer(filename, options);
+        writer.write(MeshWalker(mesh1));
+        writer.write(MeshWalker(mesh2));
+    }
+
+    TEST_CASE(WriteTwoObjectsToFile)
+    {
+        const Mesh mesh1 = create_mesh("mesh1");
+        const Mesh mesh2 = create_mesh("mesh2");
+
+        write_meshes(
+            "unit tests/outputs/test_binarymeshfilewriter_twoobjects.binarymesh",
+            BinaryMeshFileWriter::Default,
+            mesh1,
+            mesh2);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfilewriter_twoobjects.binarymesh");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(2, builder.m_meshes.size());
+        EXPECT_TRUE(mesh1 == builder.m_meshes[0]);
+        EXPECT_TRUE(mesh2 == builder.m_meshes[1]);
+        EXPECT_EQ(0, builder.m_triangle_array_count);
+    }
+
+    TEST_CASE(WriteTwoMemoryMappableObjectsToFile_ReadsTrianglesInBulk)
+    {
+        const Mesh mesh1 = create_mesh("mesh1");
+        const Mesh mesh2 = create_mesh("mesh2");
+
+        write_meshes(
+            "unit tests/outputs/test_binarymeshfilewriter_twomappableobjects.binarymesh",
+            BinaryMeshFileWriter::MemoryMappable,
+            mesh1,
+            mesh2);
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfilewriter_twomappableobjects.binarymesh");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(2, builder.m_meshes.size());
+        EXPECT_TRUE(mesh1 == builder.m_meshes[0]);
+        EXPECT_TRUE(mesh2 == builder.m_meshes[1]);
+        EXPECT_EQ(2, builder.m_triangle_array_count);
+    }
+
+    TEST_CASE(WriteMemoryMappablePolygonalObjectToFile)
+    {
+        Mesh mesh = create_mesh("mesh");
+        mesh.m_faces.resize(1);
+        mesh.m_faces[0].m_vertices = { 0, 1, 2, 3 };
+        mesh.m_faces[0].m_vertex_normals = { 0, 0, 0, 0 };
+        mesh.m_faces[0].m_tex_coords = { 0, 1, 2, 3 };
+
+        {
+            BinaryMeshFileWriter writer(
+                "unit tests/outputs/test_binarymeshfilewriter_mappablepolygon.binarymesh",
+                BinaryMeshFileWriter::MemoryMappable);
+            writer.write(MeshWalker(mesh));
+        }
+
+        BinaryMeshFileReader reader("unit tests/outputs/test_binarymeshfilewriter_mappablepolygon.binarymesh");
+        MeshBuilder builder;
+        reader.read(builder);
+
+        ASSERT_EQ(1, builder.m_meshes.size());
+        EXPECT_TRUE(mesh == builder.m_meshes[0]);
+        EXPECT_EQ(0, builder.m_triangle_array_count);
+    }
+}
@@ -35,6 +35,7 @@
 // Standard headers.
 #include <cstddef>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -313,4 +314,188 @@ TEST_SUITE(Foundation_Utility_BufferedFile)
         EXPECT_EQ(4, file.read(value));
         EXPECT_EQ(Value2, value);
     }
+
+    vector<uint32> write_lz4_compressed_file(const size_t chunk_size, const size_t thread_count)
+    {
+        BufferedFile file(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::WriteMode);
+
+        LZ4CompressedWriterAdapter writer(file, chunk_size, thread_count);
+
+        vector<uint32> values;
+
+        for (uint32 i = 0; i < 1000; ++i)
+        {
+            const uint32 value = i * 2654435761u;
+            writer.write(&value, sizeof(value));
+            values.push_back(value);
+        }
+
+        return values;
+    }
+
+    vector<uint8> read_file_bytes()
+    {
+        BufferedFile file(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode);
+
+        vector<uint8> bytes;
+        uint8 byte;
+
+        while (file.read(byte) == 1)
+            bytes.push_back(byte);
+
+        return bytes;
+    }
+
+    TEST_CASE(LZ4CompressedAdapters_MultipleThreads_RoundTrip)
+    {
+        const vector<uint32> expected = write_lz4_compressed_file(64, 4);
+
+        BufferedFile file(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode);
+
+        LZ4CompressedReaderAdapter reader(file, 3);
+
+        vector<uint32> values;
+        uint32 value;
+
+        while (reader.read(&value, sizeof(value)) == sizeof(value))
+            values.push_back(value);
+
+        ASSERT_EQ(expected.size(), values.size());
+        EXPECT_SEQUENCE_EQ(expected.size(), &expected[0], &values[0]);
+    }
+
+    TEST_CASE(LZ4CompressedAdapters_ReadSpanningMultipleChunks)
+    {
+        const vector<uint32> expected = write_lz4_compressed_file(64, 2);
+
+        BufferedFile file(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode);
+
+        LZ4CompressedReaderAdapter reader(file, 2);
+
+        vector<uint32> values(expected.size());
+        const size_t expected_size = values.size() * sizeof(uint32);
+
+        ASSERT_EQ(expected_size, reader.read(&values[0], expected_size));
+        EXPECT_SEQUENCE_EQ(expected.size(), &expected[0], &values[0]);
+    }
+
+    TEST_CASE(LZ4CompressedWriterAdapter_FileDoesNotDependOnThreadCount)
+    {
+        write_lz4_compressed_file(64, 1);
+        const vector<uint8> single_threaded = read_file_bytes();
+
+        write_lz4_compressed_file(64, 5);
+        const vector<uint8> multi_threaded = read_file_bytes();
+
+        ASSERT_EQ(single_threaded.size(), multi_threaded.size());
+        EXPECT_SEQUENCE_EQ(single_threaded.size(), &single_threaded[0], &multi_threaded[0]);
+    }
+
+    void write_byte_sequence_file(const size_t size)
+    {
+        BufferedFile file(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::WriteMode);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            const uint8 value = static_cast<uint8>(i % 251);
+            file.write(value);
+        }
+    }
+
+    TEST_CASE(ReadAhead_ReadingSequentially_ReturnsFileContent)
+    {
+        write_byte_sequence_file(1000);
+
+        BufferedFile file(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode,
+            7);
+
+        ASSERT_TRUE(file.enable_read_ahead());
+
+        vector<uint8> values(1000);
+        EXPECT_EQ(values.size(), file.read(&values[0], values.size()));
+
+        bool ok = true;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            if (values[i] != i % 251)
+                ok = false;
+        }
+        EXPECT_TRUE(ok);
+
+        uint8 value;
+        EXPECT_EQ(0, file.read(value));
+    }
+
+    TEST_CASE(ReadAhead_SeekingAndReadingUnbuffered_ReturnsFileContent)
+    {
+        write_byte_sequence_file(1000);
+
+        BufferedFile file(
+            Filename,
+            BufferedFile::BinaryType,
+            BufferedFile::ReadMode,
+            16);
+
+        ASSERT_TRUE(file.enable_read_ahead());
+
+        uint8 value;
+
+        // Consume a few buffers, then seek backward and forward outside of the I/O buffer.
+        file.seek(100, BufferedFile::SeekFromBeginning);
+        file.read(value);
+        EXPECT_EQ(100, value);
+
+        file.seek(-50, BufferedFile::SeekFromCurrent);
+        file.read(value);
+        EXPECT_EQ(51, value);
+        EXPECT_EQ(52, file.tell());
+
+        file.seek(500, BufferedFile::SeekFromBeginning);
+        file.read(value);
+        EXPECT_EQ(500 % 251, value);
+
+        file.seek(-1, BufferedFile::SeekFromEnd);
+        file.read(value);
+        EXPECT_EQ(999 % 251, value);
+
+        // Read past the I/O buffer without buffering.
+        file.seek(10, BufferedFile::SeekFromBeginning);
+        uint8 values[40];
+        EXPECT_EQ(40, file.read_unbuf(values, 40));
+        EXPECT_EQ(10, values[0]);
+        EXPECT_EQ(49, values[39]);
+
+        file.read(value);
+        EXPECT_EQ(50, value);
+    }
+
+    TEST_CASE(EnableReadAhead_GivenTextFile_ReturnsFalse)
+    {
+        write_byte_sequence_file(10);
+
+        BufferedFile file(
+            Filename,
+            BufferedFile::TextType,
+            BufferedFile::ReadMode);
+
+        EXPECT_FALSE(file.enable_read_ahead());
+    }
 }
@@ -30,14 +30,20 @@
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
 #include "foundation/math/bvh.h"
+#include "foundation/math/intersection/rayaabb.h"
 #include "foundation/math/ray.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/defaulttimers.h"
 #include "foundation/utility/alignedvector.h"
 #include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
+#include <limits>
 #include <vector>
 
 using namespace foundation;
@@ -121,6 +127,72 @@ TEST_SUITE(Foundation_Math_BVH_SpatialBuilder)
     }
 }
 
+TEST_SUITE(Foundation_Math_BVH_TreeStatistics)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+
+    struct TwoLeafTree
+      : public bvh::Tree<vector<NodeType>>
+    {
+        // Root node covering [0, 2] x [0, 1] x [0, 1] split in two unit cubes
+        // holding respectively 3 items and 1 item.
+        TwoLeafTree()
+        {
+            m_nodes.resize(3);
+
+            m_nodes[0].make_interior();
+            m_nodes[0].set_child_node_index(1);
+            m_nodes[0].set_left_bbox(AABB3d(Vector3d(0.0, 0.0, 0.0), Vector3d(1.0, 1.0, 1.0)));
+            m_nodes[0].set_right_bbox(AABB3d(Vector3d(1.0, 0.0, 0.0), Vector3d(2.0, 1.0, 1.0)));
+
+            m_nodes[1].make_leaf();
+            m_nodes[1].set_item_index(0);
+            m_nodes[1].set_item_count(3);
+
+            m_nodes[2].make_leaf();
+            m_nodes[2].set_item_index(3);
+            m_nodes[2].set_item_count(1);
+        }
+    };
+
+    struct Fixture
+    {
+        const TwoLeafTree                       m_tree;
+        const bvh::TreeStatistics<TwoLeafTree>  m_stats;
+
+        Fixture()
+          : m_stats(m_tree, AABB3d(Vector3d(0.0, 0.0, 0.0), Vector3d(2.0, 1.0, 1.0)))
+        {
+        }
+    };
+
+    TEST_CASE_F(GetSAHCost_ReturnsCostRelativeToRootSurfaceArea, Fixture)
+    {
+        // The root is always traversed, each leaf is hit with probability 3/5.
+        EXPECT_FEQ(1.0 + 0.6 * 3.0 + 0.6 * 1.0, m_stats.get_sah_cost());
+    }
+
+    TEST_CASE_F(GetLeafSizeHistogram_CountsLeavesPerItemCount, Fixture)
+    {
+        const vector<size_t>& histogram = m_stats.get_leaf_size_histogram();
+
+        ASSERT_EQ(4, histogram.size());
+        EXPECT_EQ(0, histogram[0]);
+        EXPECT_EQ(1, histogram[1]);
+        EXPECT_EQ(0, histogram[2]);
+        EXPECT_EQ(1, histogram[3]);
+    }
+
+    TEST_CASE_F(GetLeafDepthHistogram_CountsLeavesPerDepth, Fixture)
+    {
+        const vector<size_t>& histogram = m_stats.get_leaf_depth_histogram();
+
+        ASSERT_EQ(3, histogram.size());
+        EXPECT_EQ(2, histogram[2]);
+        EXPECT_EQ(2, m_stats.get_leaf_count());
+    }
+}
+
 TEST_SUITE(Foundation_Math_BVH_Intersector_2D)
 {
     typedef bvh::Node<AABB2d> NodeType;
@@ -150,3 +222,607 @@ TEST_SUITE(Foundation_Math_BVH_Intersector_2D)
         > intersector;
     }
 }
+
+TEST_SUITE(Foundation_Math_BVH_Intersector_TimeSegments)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+
+    // Two subtrees of two leaves each, covering the first and second half of the shutter interval.
+    struct TimeSegmentedTree
+      : public bvh::Tree<AlignedVector<NodeType>>
+    {
+        TimeSegmentedTree()
+        {
+            const AABB3d leaf_bbox(Vector3d(0.0, 0.0, 0.0), Vector3d(1.0, 1.0, 1.0));
+
+            m_nodes.resize(6);
+
+            for (size_t s = 0; s < 2; ++s)
+            {
+                NodeType& root = m_nodes[s * 3];
+                root.make_interior();
+                root.set_left_bbox(leaf_bbox);
+                root.set_right_bbox(leaf_bbox);
+                root.set_left_bbox_count(1);
+                root.set_right_bbox_count(1);
+                root.set_child_node_index(s * 3 + 1);
+
+                for (size_t i = 0; i < 2; ++i)
+                {
+                    NodeType& leaf = m_nodes[s * 3 + 1 + i];
+                    leaf.make_leaf();
+                    leaf.set_item_index(s * 2 + i);
+                    leaf.set_item_count(1);
+                }
+
+                m_time_segment_roots.push_back(s * 3);
+            }
+        }
+    };
+
+    struct Visitor
+    {
+        vector<size_t> m_visited_items;
+
+        bool visit(
+            const NodeType&                 node,
+            const Ray3d&                    ray,
+            const RayInfo3d&                ray_info,
+            double&                         distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics&     stats
+#endif
+            )
+        {
+            m_visited_items.push_back(node.get_item_index());
+            distance = ray.m_tmax;
+            return true;
+        }
+    };
+
+    vector<size_t> collect_visited_items(const double ray_time)
+    {
+        const TimeSegmentedTree tree;
+        const Ray3d ray(Vector3d(0.5, 0.5, -1.0), Vector3d(0.0, 0.0, 1.0));
+
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        bvh::TraversalStatistics stats;
+#endif
+
+        Visitor visitor;
+        bvh::Intersector<TimeSegmentedTree, Visitor, Ray3d> intersector;
+        intersector.intersect_motion(
+            tree,
+            ray,
+            RayInfo3d(ray),
+            ray_time,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , stats
+#endif
+            );
+
+        sort(visitor.m_visited_items.begin(), visitor.m_visited_items.end());
+        return visitor.m_visited_items;
+    }
+
+    TEST_CASE(IntersectMotion_GivenTimeInFirstSegment_TraversesFirstSubtree)
+    {
+        const vector<size_t> items = collect_visited_items(0.25);
+
+        ASSERT_EQ(2, items.size());
+        EXPECT_EQ(0, items[0]);
+        EXPECT_EQ(1, items[1]);
+    }
+
+    TEST_CASE(IntersectMotion_GivenTimeInSecondSegment_TraversesSecondSubtree)
+    {
+        const vector<size_t> items = collect_visited_items(0.75);
+
+        ASSERT_EQ(2, items.size());
+        EXPECT_EQ(2, items[0]);
+        EXPECT_EQ(3, items[1]);
+    }
+
+    TEST_CASE(IntersectMotion_GivenEndOfShutterInterval_TraversesLastSubtree)
+    {
+        const vector<size_t> items = collect_visited_items(1.0);
+
+        ASSERT_EQ(2, items.size());
+        EXPECT_EQ(2, items[0]);
+        EXPECT_EQ(3, items[1]);
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_PacketIntersector)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+
+    // A tree with a single interior node and two leaves, built by hand.
+    struct TwoLeafTree
+      : public bvh::Tree<AlignedVector<NodeType>>
+    {
+        AABB3d m_leaf_bboxes[2];
+
+        TwoLeafTree()
+        {
+            m_leaf_bboxes[0] = AABB3d(Vector3d(0.0, 0.0, 0.0), Vector3d(1.0, 1.0, 1.0));
+            m_leaf_bboxes[1] = AABB3d(Vector3d(2.0, 0.0, 0.0), Vector3d(3.0, 1.0, 1.0));
+
+            m_nodes.resize(3);
+
+            m_nodes[0].make_interior();
+            m_nodes[0].set_left_bbox(m_leaf_bboxes[0]);
+            m_nodes[0].set_right_bbox(m_leaf_bboxes[1]);
+            m_nodes[0].set_child_node_index(1);
+
+            for (size_t i = 0; i < 2; ++i)
+            {
+                m_nodes[1 + i].make_leaf();
+                m_nodes[1 + i].set_item_index(i);
+                m_nodes[1 + i].set_item_count(1);
+            }
+        }
+    };
+
+    typedef bvh::PacketIntersector<TwoLeafTree, struct Visitor, 4> Intersector;
+
+    // Record visited leaves. Hits occur at the entry point of the leaf bounding box:
+    // they either shorten the ray or retire it from the rest of the traversal.
+    struct Visitor
+    {
+        const TwoLeafTree&  m_tree;
+        const Ray3d*        m_rays;
+        bool                m_retire_on_hit;
+        vector<size_t>      m_visited[4];
+
+        Visitor(const TwoLeafTree& tree, const Ray3d* rays, const bool retire_on_hit)
+          : m_tree(tree)
+          , m_rays(rays)
+          , m_retire_on_hit(retire_on_hit)
+        {
+        }
+
+        bool visit(
+            const NodeType&                 node,
+            const Intersector::RayPacketType& packet,
+            uint32&                         ray_mask,
+            double                          distances[]
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics&     stats
+#endif
+            )
+        {
+            const size_t item_index = node.get_item_index();
+
+            for (size_t i = 0; i < packet.m_size; ++i)
+            {
+                if (!(ray_mask & (uint32(1) << i)))
+                    continue;
+
+                m_visited[i].push_back(item_index);
+
+                double tmin;
+                if (intersect(m_rays[i], RayInfo3d(m_rays[i]), m_tree.m_leaf_bboxes[item_index], tmin))
+                {
+                    if (m_retire_on_hit)
+                        ray_mask &= ~(uint32(1) << i);
+                    else distances[i] = tmin;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    void make_packet(const Ray3d rays[], const size_t count, Intersector::RayPacketType& packet)
+    {
+        for (size_t i = 0; i < count; ++i)
+            packet.push_back(rays[i], RayInfo3d(rays[i]));
+    }
+
+    TEST_CASE(IntersectNoMotion_CullsLeavesBeyondClosestHit)
+    {
+        const TwoLeafTree tree;
+
+        const Ray3d rays[4] =
+        {
+            Ray3d(Vector3d(-1.0, 0.5, 0.5), Vector3d( 1.0, 0.0, 0.0)),      // left leaf, occludes right leaf
+            Ray3d(Vector3d( 4.0, 0.5, 0.5), Vector3d(-1.0, 0.0, 0.0)),      // both leaves, in packet order
+            Ray3d(Vector3d( 0.5, -1.0, 0.5), Vector3d(0.0, 1.0, 0.0)),      // left leaf only
+            Ray3d(Vector3d( 0.5, 5.0, 0.5), Vector3d(0.0, 1.0, 0.0))        // no leaf
+        };
+
+        Intersector::RayPacketType packet;
+        make_packet(rays, 4, packet);
+
+        Visitor visitor(tree, rays, false);
+        Intersector intersector;
+        intersector.intersect_no_motion(
+            tree,
+            packet,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics()
+#endif
+            );
+
+        ASSERT_EQ(1, visitor.m_visited[0].size());
+        EXPECT_EQ(0, visitor.m_visited[0][0]);
+
+        // The packet as a whole enters the left leaf first.
+        ASSERT_EQ(2, visitor.m_visited[1].size());
+        EXPECT_EQ(0, visitor.m_visited[1][0]);
+        EXPECT_EQ(1, visitor.m_visited[1][1]);
+
+        ASSERT_EQ(1, visitor.m_visited[2].size());
+        EXPECT_EQ(0, visitor.m_visited[2][0]);
+
+        EXPECT_TRUE(visitor.m_visited[3].empty());
+    }
+
+    TEST_CASE(IntersectNoMotion_GivenPartialPacket_IgnoresUnusedLanes)
+    {
+        const TwoLeafTree tree;
+
+        const Ray3d rays[1] =
+        {
+            Ray3d(Vector3d(2.5, -1.0, 0.5), Vector3d(0.0, 1.0, 0.0))        // right leaf only
+        };
+
+        Intersector::RayPacketType packet;
+        make_packet(rays, 1, packet);
+
+        Visitor visitor(tree, rays, false);
+        Intersector intersector;
+        intersector.intersect_no_motion(
+            tree,
+            packet,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics()
+#endif
+            );
+
+        ASSERT_EQ(1, visitor.m_visited[0].size());
+        EXPECT_EQ(1, visitor.m_visited[0][0]);
+
+        for (size_t i = 1; i < 4; ++i)
+            EXPECT_TRUE(visitor.m_visited[i].empty());
+    }
+
+    TEST_CASE(IntersectNoMotion_RaysRetiredByVisitor_AreNotTraversedFurther)
+    {
+        const TwoLeafTree tree;
+
+        // Both rays cross the two leaves but don't shorten their interval on hits,
+        // so only retirement can prevent them from reaching the second leaf.
+        const Ray3d rays[2] =
+        {
+            Ray3d(Vector3d(-1.0, 0.5, 0.5), Vector3d( 1.0, 0.0, 0.0)),
+            Ray3d(Vector3d( 4.0, 0.5, 0.5), Vector3d(-1.0, 0.0, 0.0))
+        };
+
+        Intersector::RayPacketType packet;
+        make_packet(rays, 2, packet);
+
+        Visitor visitor(tree, rays, true);
+        Intersector intersector;
+        intersector.intersect_no_motion(
+            tree,
+            packet,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics()
+#endif
+            );
+
+        // The two rays diverge: the order in which the packet visits the leaves
+        // is not the preferred order of both rays, but neither visits two leaves.
+        EXPECT_EQ(1, visitor.m_visited[0].size());
+        EXPECT_EQ(1, visitor.m_visited[1].size());
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_WideTree)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+    typedef vector<AABB3d> AABBVector;
+
+    struct BinaryTree
+      : public bvh::Tree<AlignedVector<NodeType>>
+    {
+        AABBVector  m_bboxes;       // item bounding boxes, in tree order
+    };
+
+    typedef bvh::WideTree<NodeType, 4> WideTree;
+
+    void build_random_tree(BinaryTree& tree, const size_t item_count)
+    {
+        MersenneTwister rng;
+
+        AABBVector bboxes;
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            const Vector3d center(
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0));
+            const Vector3d extent(
+                rand_double1(rng, 0.01, 1.0),
+                rand_double1(rng, 0.01, 1.0),
+                rand_double1(rng, 0.01, 1.0));
+            bboxes.emplace_back(center - extent, center + extent);
+        }
+
+        typedef bvh::SAHPartitioner<AABBVector> Partitioner;
+        Partitioner partitioner(bboxes, 1);
+
+        bvh::Builder<BinaryTree, Partitioner> builder;
+        builder.build<DefaultWallclockTimer>(tree, partitioner, bboxes.size(), 1);
+
+        const vector<size_t>& ordering = partitioner.get_item_ordering();
+        for (size_t i = 0; i < ordering.size(); ++i)
+            tree.m_bboxes.push_back(bboxes[ordering[i]]);
+    }
+
+    // Find the closest item hit by the ray.
+    struct ClosestHitVisitor
+    {
+        const AABBVector&   m_bboxes;
+        double              m_distance;
+        size_t              m_item;
+        size_t              m_visited_leaves;
+
+        explicit ClosestHitVisitor(const AABBVector& bboxes)
+          : m_bboxes(bboxes)
+          , m_distance(numeric_limits<double>::max())
+          , m_item(~size_t(0))
+          , m_visited_leaves(0)
+        {
+        }
+
+        bool visit(
+            const NodeType&                 node,
+            const Ray3d&                    ray,
+            const RayInfo3d&                ray_info,
+            double&                         distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , bvh::TraversalStatistics&     stats
+#endif
+            )
+        {
+            ++m_visited_leaves;
+
+            for (size_t i = node.get_item_index(), e = i + node.get_item_count(); i < e; ++i)
+            {
+                double tmin;
+                if (intersect(ray, ray_info, m_bboxes[i], tmin) && tmin < m_distance)
+                {
+                    m_distance = tmin;
+                    m_item = i;
+                }
+            }
+
+            distance = min(m_distance, ray.m_tmax);
+            return true;
+        }
+    };
+
+    TEST_CASE(Build_GivenBinaryTree_WideNodesReferenceAllLeaves)
+    {
+        BinaryTree tree;
+        build_random_tree(tree, 100);
+
+        WideTree wide_tree;
+        wide_tree.build(tree);
+
+        size_t leaf_count = 0;
+        for (size_t i = 0; i < wide_tree.get_node_count(); ++i)
+        {
+            const WideTree::NodeType& node = wide_tree.get_node(i);
+            for (size_t c = 0; c < node.get_child_count(); ++c)
+            {
+                if (node.get_child_ref(c) & WideTree::NodeType::LeafFlag)
+                    ++leaf_count;
+            }
+        }
+
+        EXPECT_EQ(100, leaf_count);
+        EXPECT_LT(50, wide_tree.get_node_count());
+    }
+
+    TEST_CASE(AddChild_QuantizedBoundingBoxIsConservative)
+    {
+        const AABB3d node_bbox(Vector3d(-1.3, 0.7, 1000.1), Vector3d(2.9, 0.8, 1003.7));
+        const AABB3d child_bbox(Vector3d(-0.21, 0.71, 1001.3), Vector3d(1.17, 0.75, 1001.9));
+
+        bvh::WideNode<AABB3d, 4> node;
+        node.set_bbox(node_bbox);
+        node.add_child(child_bbox, 0);
+
+        const AABB3d quantized_bbox = node.get_child_bbox(0);
+
+        for (size_t d = 0; d < 3; ++d)
+        {
+            EXPECT_TRUE(quantized_bbox.min[d] <= child_bbox.min[d]);
+            EXPECT_TRUE(quantized_bbox.max[d] >= child_bbox.max[d]);
+            EXPECT_TRUE(quantized_bbox.min[d] >= node_bbox.min[d] - (node_bbox.max[d] - node_bbox.min[d]) / 64);
+            EXPECT_TRUE(quantized_bbox.max[d] <= node_bbox.max[d] + (node_bbox.max[d] - node_bbox.min[d]) / 64);
+        }
+    }
+
+    TEST_CASE(IntersectNoMotion_FindsSameClosestHitAsBinaryTraversal)
+    {
+        BinaryTree tree;
+        build_random_tree(tree, 200);
+
+        WideTree wide_tree;
+        wide_tree.build(tree);
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const Vector3d org(
+                rand_double1(rng, -15.0, 15.0),
+                rand_double1(rng, -15.0, 15.0),
+                rand_double1(rng, -15.0, 15.0));
+            const Vector3d target(
+                rand_double1(rng, -5.0, 5.0),
+                rand_double1(rng, -5.0, 5.0),
+                rand_double1(rng, -5.0, 5.0));
+            const Ray3d ray(org, normalize(target - org));
+            const RayInfo3d ray_info(ray);
+
+            ClosestHitVisitor binary_visitor(tree.m_bboxes);
+            bvh::Intersector<BinaryTree, ClosestHitVisitor, Ray3d> binary_intersector;
+            binary_intersector.intersect_no_motion(
+                tree,
+                ray,
+                ray_info,
+                binary_visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , bvh::TraversalStatistics()
+#endif
+                );
+
+            ClosestHitVisitor wide_visitor(tree.m_bboxes);
+            bvh::WideIntersector<WideTree, ClosestHitVisitor, Ray3d> wide_intersector;
+            wide_intersector.intersect_no_motion(
+                wide_tree,
+                ray,
+                ray_info,
+                wide_visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , bvh::TraversalStatistics()
+#endif
+                );
+
+            EXPECT_EQ(binary_visitor.m_item, wide_visitor.m_item);
+        }
+    }
+}
+
+TEST_SUITE(Foundation_Math_BVH_ParallelBuilder)
+{
+    typedef bvh::Node<AABB3d> NodeType;
+    typedef vector<AABB3d> AABBVector;
+    typedef bvh::SAHPartitioner<AABBVector> Partitioner;
+
+    struct TestTree
+      : public bvh::Tree<AlignedVector<NodeType>>
+    {
+        const NodeVectorType& get_nodes() const
+        {
+            return m_nodes;
+        }
+    };
+
+    AABBVector make_random_bboxes(const size_t item_count)
+    {
+        MersenneTwister rng;
+
+        AABBVector bboxes;
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            const Vector3d center(
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0),
+                rand_double1(rng, -10.0, 10.0));
+            const Vector3d extent(
+                rand_double1(rng, 0.001, 0.1),
+                rand_double1(rng, 0.001, 0.1),
+                rand_double1(rng, 0.001, 0.1));
+            bboxes.emplace_back(center - extent, center + extent);
+        }
+
+        return bboxes;
+    }
+
+    // Return true if two subtrees have the same topology, bounding boxes and leaves.
+    bool are_same_subtrees(
+        const TestTree&     lhs,
+        const size_t        lhs_node_index,
+        const TestTree&     rhs,
+        const size_t        rhs_node_index)
+    {
+        const NodeType& lhs_node = lhs.get_nodes()[lhs_node_index];
+        const NodeType& rhs_node = rhs.get_nodes()[rhs_node_index];
+
+        if (lhs_node.is_leaf() != rhs_node.is_leaf())
+            return false;
+
+        if (lhs_node.is_leaf())
+        {
+            return
+                lhs_node.get_item_index() == rhs_node.get_item_index() &&
+                lhs_node.get_item_count() == rhs_node.get_item_count();
+        }
+
+        if (lhs_node.get_left_bbox() != rhs_node.get_left_bbox() ||
+            lhs_node.get_right_bbox() != rhs_node.get_right_bbox())
+            return false;
+
+        const size_t lhs_child = lhs_node.get_child_node_index();
+        const size_t rhs_child = rhs_node.get_child_node_index();
+
+        return
+            are_same_subtrees(lhs, lhs_child, rhs, rhs_child) &&
+            are_same_subtrees(lhs, lhs_child + 1, rhs, rhs_child + 1);
+    }
+
+    void check_parallel_build_matches_sequential_build(
+        const size_t        item_count,
+        const size_t        thread_count,
+        bool&               same_node_count,
+        bool&               same_item_ordering,
+        bool&               same_trees)
+    {
+        const AABBVector bboxes = make_random_bboxes(item_count);
+
+        TestTree sequential_tree;
+        Partitioner sequential_partitioner(bboxes, 4);
+        bvh::Builder<TestTree, Partitioner> sequential_builder;
+        sequential_builder.build<DefaultWallclockTimer>(sequential_tree, sequential_partitioner, item_count, 4);
+
+        TestTree parallel_tree;
+        Partitioner parallel_partitioner(bboxes, 4);
+        bvh::ParallelBuilder<TestTree, Partitioner> parallel_builder(thread_count);
+        parallel_builder.build<DefaultWallclockTimer>(parallel_tree, parallel_partitioner, item_count, 4);
+
+        same_node_count = sequential_tree.get_nodes().size() == parallel_tree.get_nodes().size();
+        same_item_ordering = sequential_partitioner.get_item_ordering() == parallel_partitioner.get_item_ordering();
+        same_trees = are_same_subtrees(sequential_tree, 0, parallel_tree, 0);
+    }
+
+    TEST_CASE(Build_GivenFewItems_MatchesSequentialBuild)
+    {
+        bool same_node_count, same_item_ordering, same_trees;
+        check_parallel_build_matches_sequential_build(100, 4, same_node_count, same_item_ordering, same_trees);
+
+        EXPECT_TRUE(same_node_count);
+        EXPECT_TRUE(same_item_ordering);
+        EXPECT_TRUE(same_trees);
+    }
+
+    TEST_CASE(Build_GivenManyItems_MatchesSequentialBuild)
+    {
+        bool same_node_count, same_item_ordering, same_trees;
+        check_parallel_build_matches_sequential_build(50000, 4, same_node_count, same_item_ordering, same_trees);
+
+        EXPECT_TRUE(same_node_count);
+        EXPECT_TRUE(same_item_ordering);
+        EXPECT_TRUE(same_trees);
+    }
+
+    TEST_CASE(Build_GivenSingleThread_MatchesSequentialBuild)
+    {
+        bool same_node_count, same_item_ordering, same_trees;
+        check_parallel_build_matches_sequential_build(20000, 1, same_node_count, same_item_ordering, same_trees);
+
+        EXPECT_TRUE(same_node_count);
+        EXPECT_TRUE(same_item_ordering);
+        EXPECT_TRUE(same_trees);
+    }
+}
@@ -116,6 +116,89 @@ TEST_SUITE(Foundation_Utility_Cache_SACache)
 
         EXPECT_EQ(0, element_swapper.m_unload_count);
     }
+
+    struct ElementSwapperStoringKeys
+    {
+        size_t m_load_count;
+        size_t m_last_unloaded_key;
+
+        ElementSwapperStoringKeys()
+          : m_load_count(0)
+          , m_last_unloaded_key(InvalidKey)
+        {
+        }
+
+        void load(const Key key, Element& element)
+        {
+            element = key;
+            ++m_load_count;
+        }
+
+        void unload(const Key key, Element& element)
+        {
+            m_last_unloaded_key = key;
+        }
+    };
+
+    TEST_CASE(Get_GivenEightWayCache_KeepsEightElementsPerLine)
+    {
+        KeyHasher key_hasher;
+        ElementSwapperStoringKeys element_swapper;
+        SACache<Key, KeyHasher, Element, ElementSwapperStoringKeys, 1, 8> cache(
+            key_hasher,
+            element_swapper,
+            InvalidKey);
+
+        for (size_t i = 0; i < 8; ++i)
+            cache.get(i);
+
+        for (size_t i = 0; i < 8; ++i)
+            EXPECT_EQ(i, cache.get(i));
+
+        EXPECT_EQ(8, element_swapper.m_load_count);
+        EXPECT_EQ(8, cache.get_hit_count());
+        EXPECT_EQ(InvalidKey, element_swapper.m_last_unloaded_key);
+    }
+
+    TEST_CASE(Get_GivenFullFourWayLine_DoesNotEvictMostRecentlyUsedElement)
+    {
+        KeyHasher key_hasher;
+        ElementSwapperStoringKeys element_swapper;
+        SACache<Key, KeyHasher, Element, ElementSwapperStoringKeys, 1, 4> cache(
+            key_hasher,
+            element_swapper,
+            InvalidKey);
+
+        for (size_t i = 0; i < 4; ++i)
+            cache.get(i);
+
+        cache.get(0);
+        cache.get(4);
+
+        EXPECT_NEQ(0, element_swapper.m_last_unloaded_key);
+        EXPECT_NEQ(InvalidKey, element_swapper.m_last_unloaded_key);
+        EXPECT_EQ(0, cache.get(0));
+        EXPECT_EQ(4, cache.get(4));
+        EXPECT_EQ(5, element_swapper.m_load_count);
+    }
+
+    TEST_CASE(Get_GivenSixteenWayCache_ReturnsLoadedElements)
+    {
+        KeyHasher key_hasher;
+        ElementSwapperStoringKeys element_swapper;
+        SACache<Key, KeyHasher, Element, ElementSwapperStoringKeys, 4, 16> cache(
+            key_hasher,
+            element_swapper,
+            InvalidKey);
+
+        LCG rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const Key key = static_cast<Key>(rand_int1(rng, 0, 200));
+            EXPECT_EQ(key, cache.get(key));
+        }
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Cache_LRUCache)
@@ -136,6 +219,19 @@ TEST_SUITE(Foundation_Utility_Cache_LRUCache)
         EXPECT_EQ(3, element_swapper.m_unload_count);
     }
 
+    TEST_CASE(Contains_DoesNotLoadElement)
+    {
+        KeyHasher key_hasher;
+        ElementSwapperCountingUnloads element_swapper;
+        LRUCache<Key, KeyHasher, Element, ElementSwapperCountingUnloads> cache(key_hasher, element_swapper);
+
+        cache.get(1);
+
+        EXPECT_TRUE(cache.contains(1));
+        EXPECT_FALSE(cache.contains(2));
+        EXPECT_EQ(1, cache.get_miss_count());
+    }
+
     struct ElementSwapperTrackingSize
     {
         size_t m_memory_size;
@@ -0,0 +1,137 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/coloraccumulatortile.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Boost headers.
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Image_ColorAccumulatorTile)
+{
+    struct Fixture
+    {
+        ColorAccumulatorTile m_tile;
+
+        Fixture()
+          : m_tile(2, 3)
+        {
+            m_tile.clear();
+        }
+    };
+
+    TEST_CASE_F(Properties, Fixture)
+    {
+        EXPECT_EQ(2, m_tile.get_width());
+        EXPECT_EQ(3, m_tile.get_height());
+        EXPECT_EQ(6, m_tile.get_pixel_count());
+    }
+
+    TEST_CASE_F(GetPixel_GivenEmptyPixel_ReturnsTransparentBlack, Fixture)
+    {
+        Color4f c;
+        m_tile.get_pixel(0, c);
+
+        EXPECT_EQ(Color4f(0.0f), c);
+    }
+
+    TEST_CASE_F(GetPixel_AfterAddingTwoColors_ReturnsTheirAverage, Fixture)
+    {
+        const float color1[4] = { 0.1f, 0.2f, 0.3f, 1.0f };
+        const float color2[4] = { 0.3f, 0.4f, 0.5f, 0.0f };
+        m_tile.add(Vector2u(1, 2), color1);
+        m_tile.add(Vector2u(1, 2), color2);
+
+        Color4f c;
+        m_tile.get_pixel(5, c);
+
+        EXPECT_FEQ(Color4f(0.2f, 0.3f, 0.4f, 0.5f), c);
+    }
+
+    TEST_CASE_F(AtomicAdd_AccumulatesLikeAdd, Fixture)
+    {
+        const float color[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+        m_tile.atomic_add(Vector2u(0, 1), color);
+        m_tile.atomic_add(Vector2u(0, 1), color);
+
+        Color4f c;
+        m_tile.get_pixel(2, c);
+
+        EXPECT_EQ(Color4f(1.0f, 2.0f, 3.0f, 4.0f), c);
+
+        m_tile.get_pixel(3, c);
+
+        EXPECT_EQ(Color4f(0.0f), c);
+    }
+
+    struct AddColors
+    {
+        ColorAccumulatorTile&   m_tile;
+        const size_t            m_thread_index;
+
+        AddColors(ColorAccumulatorTile& tile, const size_t thread_index)
+          : m_tile(tile)
+          , m_thread_index(thread_index)
+        {
+        }
+
+        void operator()()
+        {
+            const float c = static_cast<float>(m_thread_index);
+            const float color[4] = { c, 2.0f * c, 3.0f * c, 1.0f };
+
+            for (size_t i = 0; i < 10000; ++i)
+                m_tile.atomic_add(Vector2u(i % 2, 0), color);
+        }
+    };
+
+    TEST_CASE_F(AtomicAdd_FromSeveralThreads_LosesNoColor, Fixture)
+    {
+        const size_t ThreadCount = 4;
+
+        boost::thread_group threads;
+        for (size_t i = 0; i < ThreadCount; ++i)
+            threads.create_thread(AddColors(m_tile, i));
+        threads.join_all();
+
+        // Each pixel received 5000 colors from each thread, whose indices sum to 6.
+        Color4f c;
+        m_tile.get_pixel(0, c);
+
+        EXPECT_FEQ(Color4f(6.0f / 4.0f, 12.0f / 4.0f, 18.0f / 4.0f, 1.0f), c);
+    }
+}
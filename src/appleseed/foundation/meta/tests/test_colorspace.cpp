@@ -550,6 +550,100 @@ TEST_SUITE(Foundation_Image_ColorSpace)
             1.0e-6f);
     }
 
+    // An odd number of values, to exercise both the vectorized and the scalar paths.
+    const float TransferFunctionInputs[] =
+    {
+        -1.0f, 0.0f, 0.001f, 0.0031308f, 0.004f, 0.04045f, 0.05f, 0.1f, 0.2f,
+        0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 0.99f, 1.0f, 2.0f
+    };
+
+    const size_t TransferFunctionInputCount = sizeof(TransferFunctionInputs) / sizeof(TransferFunctionInputs[0]);
+
+    TEST_CASE(FastLinearRGBToSRGB_GivenArray_MatchesSingleComponentVariant)
+    {
+        float output[TransferFunctionInputCount];
+        fast_linear_rgb_to_srgb(TransferFunctionInputs, output, TransferFunctionInputCount);
+
+        for (size_t i = 0; i < TransferFunctionInputCount; ++i)
+            EXPECT_EQ(fast_linear_rgb_to_srgb(TransferFunctionInputs[i]), output[i]);
+    }
+
+    TEST_CASE(FastSRGBToLinearRGB_GivenArray_MatchesSingleComponentVariant)
+    {
+        float output[TransferFunctionInputCount];
+        fast_srgb_to_linear_rgb(TransferFunctionInputs, output, TransferFunctionInputCount);
+
+        for (size_t i = 0; i < TransferFunctionInputCount; ++i)
+            EXPECT_EQ(fast_srgb_to_linear_rgb(TransferFunctionInputs[i]), output[i]);
+    }
+
+    TEST_CASE(FastSRGBToLinearRGB_GivenArrayConvertedInPlace_MatchesSingleComponentVariant)
+    {
+        float values[TransferFunctionInputCount];
+        for (size_t i = 0; i < TransferFunctionInputCount; ++i)
+            values[i] = TransferFunctionInputs[i];
+
+        fast_srgb_to_linear_rgb(values, values, TransferFunctionInputCount);
+
+        for (size_t i = 0; i < TransferFunctionInputCount; ++i)
+            EXPECT_EQ(fast_srgb_to_linear_rgb(TransferFunctionInputs[i]), values[i]);
+    }
+
+    TEST_CASE(FastSRGBToLinearRGB_GivenColor_MatchesSingleComponentVariant)
+    {
+        const Color3f srgb(0.02f, 0.5f, 0.9f);
+        const Color3f linear_rgb = fast_srgb_to_linear_rgb(srgb);
+
+        EXPECT_EQ(fast_srgb_to_linear_rgb(srgb[0]), linear_rgb[0]);
+        EXPECT_EQ(fast_srgb_to_linear_rgb(srgb[1]), linear_rgb[1]);
+        EXPECT_EQ(fast_srgb_to_linear_rgb(srgb[2]), linear_rgb[2]);
+    }
+
+    TEST_CASE(SRGBUInt8ToLinearRGB_MatchesExactConversion)
+    {
+        for (size_t i = 0; i < 256; ++i)
+        {
+            EXPECT_EQ(
+                srgb_to_linear_rgb(static_cast<float>(i) * (1.0f / 255.0f)),
+                srgb_uint8_to_linear_rgb(static_cast<uint8>(i)));
+        }
+    }
+
+    TEST_CASE(LinearRGBReflectanceToSpectrum_MatchesConversionFromBasisSpectra)
+    {
+        // One color per ordering of the RGB components, plus a gray.
+        const Color3f Colors[] =
+        {
+            Color3f(0.1f, 0.4f, 0.7f),
+            Color3f(0.1f, 0.7f, 0.4f),
+            Color3f(0.4f, 0.1f, 0.7f),
+            Color3f(0.7f, 0.1f, 0.4f),
+            Color3f(0.4f, 0.7f, 0.1f),
+            Color3f(0.7f, 0.4f, 0.1f),
+            Color3f(0.5f, 0.5f, 0.5f)
+        };
+
+        for (size_t i = 0; i < sizeof(Colors) / sizeof(Colors[0]); ++i)
+        {
+            RegularSpectrum31f expected;
+            foundation::impl::linear_rgb_to_spectrum(
+                Colors[i],
+                RGBToSpectrumWhiteReflectance,
+                RGBToSpectrumCyanReflectance,
+                RGBToSpectrumMagentaReflectance,
+                RGBToSpectrumYellowReflectance,
+                RGBToSpectrumRedReflectance,
+                RGBToSpectrumGreenReflectance,
+                RGBToSpectrumBlueReflectance,
+                expected);
+
+            RegularSpectrum31f spectrum;
+            linear_rgb_reflectance_to_spectrum_unclamped(Colors[i], spectrum);
+
+            EXPECT_FEQ_EPS(expected, spectrum, 1.0e-5f);
+        }
+    }
+
     vector<Vector2d> zip(const double x[], const double y[], const size_t count)
     {
         vector<Vector2d> points(count);
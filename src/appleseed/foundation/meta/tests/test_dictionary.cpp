@@ -169,6 +169,45 @@ TEST_SUITE(Foundation_Utility_StringDictionary)
 
         EXPECT_EQ(&sd, result);
     }
+
+    TEST_CASE(Find_GivenKeyOfNonExistingItem_ReturnsNullptr)
+    {
+        StringDictionary sd;
+        sd.insert("key", "value");
+
+        EXPECT_EQ(nullptr, sd.find("other"));
+    }
+
+    TEST_CASE(Find_GivenManyItems_ReturnsValues)
+    {
+        StringDictionary sd;
+
+        for (int i = 0; i < 100; ++i)
+            sd.insert(("key" + to_string(i)).c_str(), i);
+
+        for (int i = 0; i < 100; i += 2)
+            sd.remove("key" + to_string(i));
+
+        const StringDictionary copy(sd);
+
+        EXPECT_EQ(50, copy.size());
+
+        for (int i = 0; i < 100; ++i)
+        {
+            const char* value = copy.find(("key" + to_string(i)).c_str());
+
+            if (i % 2 == 0)
+                EXPECT_EQ(nullptr, value);
+            else
+            {
+                ASSERT_NEQ(nullptr, value);
+                EXPECT_EQ(to_string(i), value);
+            }
+        }
+
+        // Iteration still follows key order.
+        EXPECT_EQ(string("key1"), copy.begin().key());
+    }
 }
 
 TEST_SUITE(Foundation_Utility_DictionaryDictionary)
@@ -0,0 +1,141 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/eventtracer.h"
+#include "foundation/utility/test.h"
+
+// Boost headers.
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_EventTracer)
+{
+    const char* TraceFilePath = "unit tests/outputs/test_eventtracer.json";
+
+    string read_file(const char* path)
+    {
+        ifstream file(path);
+        return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+
+    size_t count_occurrences(const string& s, const string& pattern)
+    {
+        size_t count = 0;
+
+        for (size_t i = s.find(pattern); i != string::npos; i = s.find(pattern, i + 1))
+            ++count;
+
+        return count;
+    }
+
+    struct Fixture
+    {
+        EventTracer& m_tracer;
+
+        Fixture()
+          : m_tracer(EventTracer::instance())
+        {
+            m_tracer.clear();
+        }
+
+        ~Fixture()
+        {
+            m_tracer.set_enabled(false);
+            m_tracer.clear();
+        }
+    };
+
+    TEST_CASE_F(TraceScope_GivenDisabledTracer_RecordsNothing, Fixture)
+    {
+        {
+            TraceScope scope("test", "disabled scope");
+        }
+
+        EXPECT_TRUE(m_tracer.write_chrome_trace(TraceFilePath));
+        EXPECT_EQ(0, count_occurrences(read_file(TraceFilePath), "disabled scope"));
+    }
+
+    TEST_CASE_F(TraceScope_GivenEnabledTracer_RecordsCompleteEvent, Fixture)
+    {
+        m_tracer.set_enabled(true);
+
+        {
+            TraceScope scope("test", "enabled \"scope\"");
+        }
+
+        EXPECT_TRUE(m_tracer.write_chrome_trace(TraceFilePath));
+
+        const string trace = read_file(TraceFilePath);
+        EXPECT_EQ(1, count_occurrences(trace, "{\"name\":\"enabled \\\"scope\\\"\",\"cat\":\"test\",\"ph\":\"X\""));
+    }
+
+    TEST_CASE_F(Record_GivenMoreEventsThanCapacity_KeepsMostRecentEvents, Fixture)
+    {
+        m_tracer.set_enabled(true);
+
+        m_tracer.record("test", "old event", 0, 1);
+
+        for (size_t i = 0; i < EventTracer::ThreadBufferCapacity; ++i)
+            m_tracer.record("test", "new event", 1, 2);
+
+        EXPECT_TRUE(m_tracer.write_chrome_trace(TraceFilePath));
+
+        const string trace = read_file(TraceFilePath);
+        EXPECT_EQ(0, count_occurrences(trace, "old event"));
+        EXPECT_EQ(EventTracer::ThreadBufferCapacity, count_occurrences(trace, "new event"));
+    }
+
+    void record_thread_event()
+    {
+        EventTracer::instance().set_current_thread_name("test thread");
+        TraceScope scope("test", "thread event");
+    }
+
+    TEST_CASE_F(WriteChromeTrace_GivenEventsFromAnotherThread_ExportsThreadName, Fixture)
+    {
+        m_tracer.set_enabled(true);
+
+        boost::thread thread(record_thread_event);
+        thread.join();
+
+        EXPECT_TRUE(m_tracer.write_chrome_trace(TraceFilePath));
+
+        const string trace = read_file(TraceFilePath);
+        EXPECT_EQ(1, count_occurrences(trace, "\"args\":{\"name\":\"test thread\"}"));
+        EXPECT_EQ(1, count_occurrences(trace, "thread event"));
+    }
+}
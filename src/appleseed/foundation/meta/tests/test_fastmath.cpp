@@ -40,6 +40,7 @@
 #include "foundation/utility/test.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <string>
@@ -720,4 +721,67 @@ TEST_SUITE(Foundation_Math_FastMath)
             1.0f,
             1000);
     }
+
+    //
+    // Acos(x).
+    //
+
+    TEST_CASE(ScalarFastAcos)
+    {
+        float max_error = 0.0f;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const float x = fit<size_t, float>(i, 0, 999, -1.0f, 1.0f);
+            max_error = max(max_error, abs(acos(x) - fast_acos(x)));
+        }
+
+        EXPECT_LT(7.0e-5f, max_error);
+    }
+
+    TEST_CASE(ScalarFastAcos_GivenValueOutsideDomain_ClampsValue)
+    {
+        EXPECT_EQ(0.0f, fast_acos(1.0001f));
+        EXPECT_FEQ(Pi<float>(), fast_acos(-1.0001f));
+    }
+
+    TEST_CASE(PlotAcosFunctions)
+    {
+        const FuncDef<float (*)(float)> functions[] =
+        {
+            { "std::acos", "black", acos },
+            { "foundation::fast_acos", "green", fast_acos }
+        };
+
+        plot_functions(
+            "unit tests/outputs/test_fastmath_acos.gnuplot",
+            functions,
+            countof(functions),
+            -1.0f,
+            1.0f,
+            1000);
+    }
+
+    //
+    // Shading functions.
+    //
+
+    TEST_CASE(ShadingPow_GivenExponentsUpTo16_RelativeErrorIsBounded)
+    {
+        const float Exponents[] = { -2.0f, 0.25f, 1.5f, 8.0f, 16.0f };
+
+        float max_error = 0.0f;
+
+        for (size_t e = 0; e < countof(Exponents); ++e)
+        {
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                const float x = fit<size_t, float>(i, 0, 999, 1.0e-2f, 10.0f);
+                const float ref = pow(x, Exponents[e]);
+                max_error = max(max_error, compute_relative_error(ref, shading_pow(x, Exponents[e])));
+            }
+        }
+
+        EXPECT_LT(2.0e-3f, max_error);
+    }
 }
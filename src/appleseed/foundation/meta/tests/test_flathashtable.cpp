@@ -0,0 +1,144 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2018 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// appleseed.foundation headers.
+#include "foundation/math/hash.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/containers/flathashtable.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Utility_Containers_FlatHashTable)
+{
+    struct KeyHasher
+    {
+        size_t operator()(const size_t key) const
+        {
+            return
+                static_cast<size_t>(
+                    hash_uint64(
+                        static_cast<uint64>(key)));
+        }
+    };
+
+    struct ConstantKeyHasher
+    {
+        size_t operator()(const size_t key) const
+        {
+            return 42;
+        }
+    };
+
+    TEST_CASE(Get_TableIsEmpty_ReturnsNullptr)
+    {
+        KeyHasher key_hasher;
+        FlatHashTable<size_t, KeyHasher, float> hash_table(key_hasher);
+
+        const float* val_ptr = hash_table.get(12);
+
+        EXPECT_EQ(0, val_ptr);
+    }
+
+    TEST_CASE(Get_KeyIsMissing_ReturnsNullptr)
+    {
+        KeyHasher key_hasher;
+        FlatHashTable<size_t, KeyHasher, float> hash_table(key_hasher);
+
+        hash_table.resize(64);
+
+        for (size_t i = 0; i < 64; ++i)
+            hash_table.insert(i, static_cast<float>(i));
+
+        const float* val_ptr = hash_table.get(64);
+
+        EXPECT_EQ(0, val_ptr);
+    }
+
+    TEST_CASE(Get_AllKeysCollide_ReturnsCorrectValues)
+    {
+        const size_t N = 64;
+
+        ConstantKeyHasher key_hasher;
+        FlatHashTable<size_t, ConstantKeyHasher, float> hash_table(key_hasher);
+
+        hash_table.resize(N);
+
+        for (size_t i = 0; i < N; ++i)
+            hash_table.insert(i, static_cast<float>(2 * i));
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            const float* val_ptr = hash_table.get(i);
+
+            ASSERT_NEQ(0, val_ptr);
+            EXPECT_EQ(static_cast<float>(2 * i), *val_ptr);
+        }
+
+        EXPECT_EQ(0, hash_table.get(N));
+    }
+
+    TEST_CASE(Resize_ClearsTable)
+    {
+        KeyHasher key_hasher;
+        FlatHashTable<size_t, KeyHasher, float> hash_table(key_hasher);
+
+        hash_table.resize(4);
+        hash_table.insert(1, 1.0f);
+        hash_table.resize(4);
+
+        const float* val_ptr = hash_table.get(1);
+
+        EXPECT_EQ(0, val_ptr);
+    }
+
+    TEST_CASE(StressTest)
+    {
+        const size_t N = 16 * 1024;
+
+        KeyHasher key_hasher;
+        FlatHashTable<size_t, KeyHasher, float> hash_table(key_hasher);
+
+        hash_table.resize(N);
+
+        for (size_t i = 0; i < N; ++i)
+            hash_table.insert(i, static_cast<float>(2 * i));
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            const float* val_ptr = hash_table.get(i);
+
+            ASSERT_NEQ(0, val_ptr);
+            EXPECT_EQ(static_cast<float>(2 * i), *val_ptr);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/genericimagefilereader.h"
+#include "foundation/image/genericprogressiveimagefilewriter.h"
+#include "foundation/image/image.h"
+#include "foundation/image/imageattributes.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Image_GenericProgressiveImageFileWriter)
+{
+    TEST_CASE(WriteTile_TilesWrittenInAnyOrder_CorrectlyWritesImagePixels)
+    {
+        const char* ImageFilePath = "unit tests/outputs/test_genericprogressiveimagefilewriter_pixels.exr";
+
+        {
+            const char* color_channel_names[] = { "R", "G", "B", "A" };
+            const char* depth_channel_names[] = { "depth.Z" };
+
+            GenericProgressiveImageFileWriter writer(ImageFilePath);
+            writer.add_channels(4, color_channel_names, PixelFormatHalf);
+            writer.add_channels(1, depth_channel_names, PixelFormatFloat);
+            writer.open(4, 2, 2, 2, ImageAttributes());
+
+            Tile color_tile(2, 2, 4, PixelFormatFloat);
+            Tile depth_tile(2, 2, 1, PixelFormatFloat);
+            const Tile* tiles[] = { &color_tile, &depth_tile };
+
+            color_tile.clear(Color4f(0.5f, 0.25f, 0.125f, 1.0f));
+            depth_tile.clear(Color<float, 1>(7.0f));
+            writer.write_tile(1, 0, tiles);
+
+            color_tile.clear(Color4f(1.0f, 0.5f, 0.25f, 1.0f));
+            depth_tile.clear(Color<float, 1>(3.0f));
+            writer.write_tile(0, 0, tiles);
+
+            writer.close();
+        }
+
+        {
+            GenericImageFileReader reader;
+            unique_ptr<Image> image(reader.read(ImageFilePath));
+
+            ASSERT_EQ(5, image->properties().m_channel_count);
+
+            EXPECT_EQ(1.0f, image->tile(0, 0).get_component<float>(1, 1, 0));
+            EXPECT_EQ(3.0f, image->tile(0, 0).get_component<float>(1, 1, 4));
+            EXPECT_EQ(0.5f, image->tile(1, 0).get_component<float>(0, 0, 0));
+            EXPECT_EQ(7.0f, image->tile(1, 0).get_component<float>(0, 0, 4));
+        }
+    }
+
+    TEST_CASE(Close_GivenMissingTiles_WritesBlackTiles)
+    {
+        const char* ImageFilePath = "unit tests/outputs/test_genericprogressiveimagefilewriter_missingtiles.exr";
+
+        {
+            const char* channel_names[] = { "R", "G", "B", "A" };
+
+            GenericProgressiveImageFileWriter writer(ImageFilePath);
+            writer.add_channels(4, channel_names, PixelFormatFloat);
+            writer.open(4, 2, 2, 2, ImageAttributes());
+
+            Tile tile(2, 2, 4, PixelFormatFloat);
+            tile.clear(Color4f(1.0f));
+            const Tile* tiles[] = { &tile };
+            writer.write_tile(0, 0, tiles);
+
+            writer.close();
+        }
+
+        {
+            GenericImageFileReader reader;
+            unique_ptr<Image> image(reader.read(ImageFilePath));
+
+            Color4f c;
+            image->get_pixel(0, 0, c);
+            EXPECT_EQ(Color4f(1.0f), c);
+            image->get_pixel(3, 1, c);
+            EXPECT_EQ(Color4f(0.0f), c);
+        }
+    }
+}
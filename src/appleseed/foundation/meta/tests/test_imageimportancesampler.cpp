@@ -86,6 +86,35 @@ TEST_SUITE(Foundation_Math_Sampling_ImageImportanceSampler)
         EXPECT_EQ(prob_xy, pdf);
     }
 
+    TEST_CASE(Sample_UsingAliasTables_ReturnsPixelsWithPositiveImportanceAndTheirProbability)
+    {
+        const size_t Width = 5;
+        const size_t Height = 5;
+
+        ImageImportanceSampler<HorizontalGradientSampler::Payload, float> importance_sampler(Width, Height, true);
+        HorizontalGradientSampler sampler(Width);
+        importance_sampler.rebuild(sampler);
+
+        const size_t SampleCount = 256;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const size_t Bases[1] = { 2 };
+            const Vector2f s = hammersley_sequence<float, 2>(Bases, SampleCount, i);
+
+            size_t x, y;
+            HorizontalGradientSampler::Payload payload;
+            float prob_xy;
+            Vector2f jitter;
+            importance_sampler.sample(s, x, y, payload, prob_xy, jitter);
+
+            ASSERT_NEQ(0, x);
+            ASSERT_FEQ(importance_sampler.get_pdf(x, y), prob_xy);
+            ASSERT_TRUE(jitter[0] >= 0.0f && jitter[0] < 1.0f);
+            ASSERT_TRUE(jitter[1] >= 0.0f && jitter[1] < 1.0f);
+        }
+    }
+
     void generate_image(
         const char*     input_filename,
         const char*     output_image,
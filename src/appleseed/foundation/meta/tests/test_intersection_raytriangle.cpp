@@ -29,11 +29,17 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/intersection/raytrianglemt.h"
+#include "foundation/math/intersection/raytrianglemt4.h"
 #include "foundation/math/intersection/raytrianglessk.h"
 #include "foundation/math/ray.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 
 namespace
@@ -166,3 +172,88 @@ TEST_SUITE(Foundation_Math_Intersection_RayTriangleSSK)
         EXPECT_FEQ(0.5, v);
     }
 }
+
+TEST_SUITE(Foundation_Math_Intersection_RayTriangleMT4)
+{
+    TEST_CASE(Intersect_GivenRayHittingTwoOfFourTriangles_ReturnsMaskOfHitTriangles)
+    {
+        TriangleMT4<float> triangles;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const float y = -static_cast<float>(i);
+            const float x = i == 2 ? 10.0f : 0.0f;
+            triangles.set(
+                i,
+                TriangleMT<float>(
+                    Vector3f(x + 0.5f, y, 0.5f),
+                    Vector3f(x - 0.5f, y, 0.5f),
+                    Vector3f(x - 0.5f, y, -0.5f)));
+        }
+
+        const Ray3d ray(Vector3d(-0.2, 1.0, 0.2), Vector3d(0.0, -1.0, 0.0), 0.0, 3.5);
+
+        double t[4], u[4], v[4];
+        const size_t mask = triangles.intersect(ray, t, u, v);
+
+        ASSERT_EQ(0x3, mask);
+        EXPECT_FEQ(1.0, t[0]);
+        EXPECT_FEQ(2.0, t[1]);
+    }
+
+    TEST_CASE(Intersect_GivenRandomTrianglesAndRays_AgreesWithTriangleMT)
+    {
+        MersenneTwister rng;
+
+        for (size_t iteration = 0; iteration < 1000; ++iteration)
+        {
+            TriangleMT4<float> triangles;
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                Vector3f vertices[3];
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    vertices[j] =
+                        Vector3f(
+                            rand_float1(rng, -1.0f, 1.0f),
+                            rand_float1(rng, -1.0f, 1.0f),
+                            rand_float1(rng, -1.0f, 1.0f));
+                }
+
+                triangles.set(i, TriangleMT<float>(vertices[0], vertices[1], vertices[2]));
+            }
+
+            // Aim the ray at the neighborhood of the triangles.
+            const Vector3d origin(
+                rand_double1(rng, -2.0, 2.0),
+                rand_double1(rng, -2.0, 2.0),
+                rand_double1(rng, -2.0, 2.0));
+            const Vector3d target(
+                rand_double1(rng, -0.5, 0.5),
+                rand_double1(rng, -0.5, 0.5),
+                rand_double1(rng, -0.5, 0.5));
+            const Ray3d ray(origin, target - origin, 0.0, rand_double1(rng, 0.0, 2.0));
+
+            double t[4], u[4], v[4];
+            const size_t mask = triangles.intersect(ray, t, u, v);
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                const TriangleMT<double> triangle(triangles.get(i));
+
+                double expected_t, expected_u, expected_v;
+                const bool expected_hit = triangle.intersect(ray, expected_t, expected_u, expected_v);
+
+                ASSERT_EQ(expected_hit, (mask & (size_t(1) << i)) != 0);
+
+                if (expected_hit)
+                {
+                    EXPECT_EQ(expected_t, t[i]);
+                    EXPECT_EQ(expected_u, u[i]);
+                    EXPECT_EQ(expected_v, v[i]);
+                }
+            }
+        }
+    }
+}
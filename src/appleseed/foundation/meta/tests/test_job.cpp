@@ -295,6 +295,100 @@ TEST_SUITE(Foundation_Utility_Job_JobQueue)
 
         EXPECT_EQ(0, destruction_count);
     }
+
+    TEST_CASE(SetWorkerQueueCount_PreservesScheduledJobs)
+    {
+        volatile uint32 destruction_count = 0;
+
+        JobQueue job_queue;
+        job_queue.schedule(new JobNotifyingAboutDestruction(&destruction_count));
+        job_queue.schedule(new JobNotifyingAboutDestruction(&destruction_count));
+        job_queue.schedule(new JobNotifyingAboutDestruction(&destruction_count));
+
+        job_queue.set_worker_queue_count(2);
+        EXPECT_EQ(3, job_queue.get_scheduled_job_count());
+
+        job_queue.set_worker_queue_count(0);
+        EXPECT_EQ(3, job_queue.get_scheduled_job_count());
+
+        job_queue.clear_scheduled_jobs();
+        EXPECT_EQ(3, destruction_count);
+    }
+
+    TEST_CASE(AcquireScheduledJob_WorkStealingEnabled_StealsJobFromOtherWorker)
+    {
+        IJob* job = new EmptyJob();
+
+        JobQueue job_queue;
+        job_queue.set_worker_queue_count(2);
+        job_queue.schedule(job);            // goes to the deque of worker 0
+
+        const JobQueue::RunningJobInfo running_job_info =
+            job_queue.acquire_scheduled_job(1);
+
+        EXPECT_EQ(job, running_job_info.first.m_job);
+
+        EXPECT_FALSE(job_queue.has_scheduled_jobs());
+        EXPECT_TRUE(job_queue.has_running_jobs());
+        EXPECT_EQ(1, job_queue.get_total_job_count());
+
+        job_queue.retire_running_job(running_job_info);
+
+        EXPECT_FALSE(job_queue.has_scheduled_or_running_jobs());
+    }
+
+    TEST_CASE(AcquireScheduledJob_WorkStealingEnabledOnTwoNodes_StealsJobFromSameNodeFirst)
+    {
+        IJob* jobs[4];
+
+        JobQueue job_queue;
+        job_queue.set_worker_queue_count(4, 2);     // workers 0 and 1 on node 0, workers 2 and 3 on node 1
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            jobs[i] = new EmptyJob();
+            job_queue.schedule(jobs[i]);            // goes to the deque of worker i
+        }
+
+        const JobQueue::RunningJobInfo own_job_info = job_queue.acquire_scheduled_job(1);
+        const JobQueue::RunningJobInfo stolen_job_info = job_queue.acquire_scheduled_job(1);
+
+        EXPECT_EQ(jobs[1], own_job_info.first.m_job);
+        EXPECT_EQ(jobs[0], stolen_job_info.first.m_job);
+
+        job_queue.retire_running_job(own_job_info);
+        job_queue.retire_running_job(stolen_job_info);
+        job_queue.clear_scheduled_jobs();
+
+        EXPECT_FALSE(job_queue.has_scheduled_or_running_jobs());
+    }
+
+    TEST_CASE(ScheduleOnWorker_WorkStealingEnabled_WorkerAcquiresItsJobsFirst)
+    {
+        IJob* jobs[3];
+
+        JobQueue job_queue;
+        job_queue.set_worker_queue_count(2);
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            jobs[i] = new EmptyJob();
+            job_queue.schedule_on_worker(jobs[i], 1);   // all go to the deque of worker 1
+        }
+
+        const JobQueue::RunningJobInfo own_job_info = job_queue.acquire_scheduled_job(1);
+        const JobQueue::RunningJobInfo stolen_job_info = job_queue.acquire_scheduled_job(0);
+
+        EXPECT_EQ(jobs[0], own_job_info.first.m_job);
+        EXPECT_EQ(jobs[2], stolen_job_info.first.m_job);
+        EXPECT_EQ(1, job_queue.get_scheduled_job_count());
+
+        job_queue.retire_running_job(own_job_info);
+        job_queue.retire_running_job(stolen_job_info);
+        job_queue.clear_scheduled_jobs();
+
+        EXPECT_FALSE(job_queue.has_scheduled_or_running_jobs());
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Job_JobManager)
@@ -374,6 +468,66 @@ TEST_SUITE(Foundation_Utility_Job_JobManager)
 
         EXPECT_EQ(1, execution_count);
     }
+
+    struct FixtureWorkStealingJobManager
+    {
+        Logger      logger;
+        JobQueue    job_queue;
+        JobManager  job_manager;
+
+        FixtureWorkStealingJobManager()
+          : job_manager(logger, job_queue, 4, JobManager::WorkStealing)
+        {
+        }
+    };
+
+    TEST_CASE_F(WorkStealingJobManagerExecutesAllJobs, FixtureWorkStealingJobManager)
+    {
+        volatile uint32 execution_count = 0;
+
+        for (size_t i = 0; i < 100; ++i)
+            job_queue.schedule(new JobNotifyingAboutExecution(&execution_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(100, execution_count);
+        EXPECT_FALSE(job_queue.has_scheduled_or_running_jobs());
+    }
+
+    TEST_CASE_F(WorkStealingJobManagerExecutesSubJobs, FixtureWorkStealingJobManager)
+    {
+        volatile uint32 execution_count = 0;
+
+        for (size_t i = 0; i < 10; ++i)
+            job_queue.schedule(new JobCreatingAnotherJob(job_queue, &execution_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(10, execution_count);
+    }
+
+    TEST_CASE(NumaPinnedWorkStealingJobManagerExecutesAllJobs)
+    {
+        Logger logger;
+        JobQueue job_queue;
+        JobManager job_manager(
+            logger,
+            job_queue,
+            4,
+            JobManager::WorkStealing | JobManager::PinThreadsToNumaNodes);
+
+        volatile uint32 execution_count = 0;
+
+        for (size_t i = 0; i < 100; ++i)
+            job_queue.schedule(new JobNotifyingAboutExecution(&execution_count));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+
+        EXPECT_EQ(100, execution_count);
+    }
 }
 
 TEST_SUITE(Foundation_Utility_Job_WorkerThread)
@@ -142,6 +142,68 @@ TEST_SUITE(Foundation_Math_Knn_Builder)
         knn::Builder3d builder(tree);
         builder.build<DefaultWallclockTimer>(points, PointCount);
     }
+
+    TEST_CASE(Build_GivenFourThreads_BuildsTreeEquivalentToSingleThreadedTree)
+    {
+        const size_t PointCount = 100000;
+        const size_t QueryCount = 100;
+        const size_t AnswerSize = 10;
+
+        MersenneTwister rng;
+
+        vector<Vector3d> points;
+        points.reserve(PointCount);
+        for (size_t i = 0; i < PointCount; ++i)
+            points.push_back(rand_vector1<Vector3d>(rng));
+
+        knn::Tree3d serial_tree;
+        knn::Builder3d serial_builder(serial_tree);
+        serial_builder.build<DefaultWallclockTimer>(&points[0], PointCount);
+
+        knn::Tree3d parallel_tree;
+        knn::Builder3d parallel_builder(parallel_tree, 4);
+        parallel_builder.build<DefaultWallclockTimer>(&points[0], PointCount);
+
+        // Both trees store the points in the same order.
+        bool same_points = true;
+        for (size_t i = 0; i < PointCount; ++i)
+        {
+            if (serial_tree.remap(i) != parallel_tree.remap(i) ||
+                serial_tree.get_point(i) != parallel_tree.get_point(i))
+                same_points = false;
+        }
+        EXPECT_TRUE(same_points);
+
+        knn::Answer<double> serial_answer(AnswerSize);
+        knn::Query3d serial_query(serial_tree, serial_answer);
+
+        knn::Answer<double> parallel_answer(AnswerSize);
+        knn::Query3d parallel_query(parallel_tree, parallel_answer);
+
+        bool same_answers = true;
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            const Vector3d q = rand_vector1<Vector3d>(rng);
+
+            serial_query.run(q);
+            serial_answer.sort();
+
+            parallel_query.run(q);
+            parallel_answer.sort();
+
+            if (serial_answer.size() != parallel_answer.size())
+                same_answers = false;
+            else
+            {
+                for (size_t j = 0; j < serial_answer.size(); ++j)
+                {
+                    if (serial_answer.get(j).m_index != parallel_answer.get(j).m_index)
+                        same_answers = false;
+                }
+            }
+        }
+        EXPECT_TRUE(same_answers);
+    }
 }
 
 TEST_SUITE(Foundation_Math_Knn_Answer)
@@ -342,6 +404,43 @@ TEST_SUITE(Foundation_Math_Knn_Query)
         }
     }
 
+    TEST_CASE(Run_GivenMaxSearchDistanceAndSmallAnswer_ReturnsNearestNeighbors)
+    {
+        const size_t PointCount = 20000;
+        const size_t QueryCount = 1000;
+        const size_t AnswerSize = 10;
+        const double QueryMaxSquareDistance = square(0.05);
+
+        MersenneTwister rng;
+
+        vector<Vector3d> points;
+        generate_random_points(rng, points, PointCount);
+
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(&points[0], PointCount);
+
+        knn::Answer<double> full_answer(AnswerSize);
+        knn::Query3d full_query(tree, full_answer);
+
+        knn::Answer<double> limited_answer(AnswerSize);
+        knn::Query3d limited_query(tree, limited_answer);
+
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            const Vector3d q = rand_vector1<Vector3d>(rng);
+
+            full_query.run(q);
+            full_answer.sort();
+
+            limited_query.run(q, QueryMaxSquareDistance);
+            limited_answer.sort();
+
+            for (size_t j = 0; j < limited_answer.size(); ++j)
+                EXPECT_EQ(full_answer.get(j).m_index, limited_answer.get(j).m_index);
+        }
+    }
+
     struct SortPointByDistancePredicate
     {
         const vector<Vector3d>&     m_points;
@@ -461,4 +560,64 @@ TEST_SUITE(Foundation_Math_Knn_Query)
         auto make_query_point = [&rng, &points]() { return points[rand_int1(rng, 0, static_cast<int32>(points.size()) - 1)]; };
         EXPECT_TRUE(do_results_match_naive_algorithm(points, AnswerSize, QueryCount, make_query_point));
     }
+
+    struct CollectAnswers
+    {
+        vector<vector<size_t>>      m_answers;
+        size_t                      m_call_count;
+
+        explicit CollectAnswers(const size_t query_count)
+          : m_answers(query_count)
+          , m_call_count(0)
+        {
+        }
+
+        void operator()(const size_t query_index, knn::Answer<double>& answer)
+        {
+            answer.sort();
+
+            for (size_t i = 0; i < answer.size(); ++i)
+                m_answers[query_index].push_back(answer.get(i).m_index);
+
+            ++m_call_count;
+        }
+    };
+
+    TEST_CASE(RunBatch_ReturnsIdenticalResultsAsIndividualQueries)
+    {
+        const size_t PointCount = 1000;
+        const size_t QueryCount = 200;
+        const size_t AnswerSize = 20;
+
+        MersenneTwister rng;
+
+        vector<Vector3d> points;
+        generate_random_points(rng, points, PointCount);
+
+        vector<Vector3d> query_points;
+        generate_random_points(rng, query_points, QueryCount);
+
+        knn::Tree3d tree;
+        knn::Builder3d builder(tree);
+        builder.build<DefaultWallclockTimer>(&points[0], points.size());
+
+        knn::Answer<double> answer(AnswerSize);
+        knn::Query3d query(tree, answer);
+
+        CollectAnswers visitor(QueryCount);
+        query.run_batch(&query_points[0], QueryCount, 0.01, visitor);
+
+        ASSERT_EQ(QueryCount, visitor.m_call_count);
+
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            query.run(query_points[i], 0.01);
+            answer.sort();
+
+            ASSERT_EQ(answer.size(), visitor.m_answers[i].size());
+
+            for (size_t j = 0; j < answer.size(); ++j)
+                EXPECT_EQ(answer.get(j).m_index, visitor.m_answers[i][j]);
+        }
+    }
 }
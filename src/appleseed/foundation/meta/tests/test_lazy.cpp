@@ -118,3 +118,85 @@ TEST_SUITE(Foundation_Utility_Lazy_Access)
         EXPECT_EQ(0, access.get());
     }
 }
+
+TEST_SUITE(Foundation_Utility_Lazy)
+{
+    struct CountingObjectFactory : public ObjectFactory
+    {
+        size_t m_creation_count;
+
+        CountingObjectFactory()
+          : m_creation_count(0)
+        {
+        }
+
+        unique_ptr<Object> create() override
+        {
+            ++m_creation_count;
+            return unique_ptr<Object>(new Object(42));
+        }
+    };
+
+    TEST_CASE(ReleaseObject_GivenObjectBeingAccessed_ReturnsFalse)
+    {
+        unique_ptr<ObjectFactory> factory(new SimpleObjectFactory(42));
+        Lazy<Object> object(move(factory));
+
+        Access<Object> access(&object);
+
+        EXPECT_FALSE(object.release_object());
+        EXPECT_EQ(42, access->m_value);
+    }
+
+    TEST_CASE(ReleaseObject_GivenObjectNeverAccessed_ReturnsFalse)
+    {
+        unique_ptr<ObjectFactory> factory(new SimpleObjectFactory(42));
+        Lazy<Object> object(move(factory));
+
+        EXPECT_FALSE(object.release_object());
+    }
+
+    TEST_CASE(ReleaseObject_GivenReleasedObject_CreatesObjectAgainOnNextAccess)
+    {
+        CountingObjectFactory* counting_factory = new CountingObjectFactory();
+        unique_ptr<ObjectFactory> factory(counting_factory);
+        Lazy<Object> object(move(factory));
+
+        {
+            Access<Object> access(&object);
+        }
+
+        EXPECT_TRUE(object.release_object());
+
+        Access<Object> access(&object);
+
+        EXPECT_EQ(42, access->m_value);
+        EXPECT_EQ(2, counting_factory->m_creation_count);
+    }
+
+    TEST_CASE(ReleaseObject_GivenSourceObject_ReturnsFalse)
+    {
+        Object source_object(42);
+        Lazy<Object> object(&source_object);
+
+        {
+            Access<Object> access(&object);
+        }
+
+        EXPECT_FALSE(object.release_object());
+    }
+
+    TEST_CASE(GetAccessStamp_GivenObjectsAccessedInSequence_ReturnsIncreasingStamps)
+    {
+        unique_ptr<ObjectFactory> factory1(new SimpleObjectFactory(1));
+        Lazy<Object> object1(move(factory1));
+
+        unique_ptr<ObjectFactory> factory2(new SimpleObjectFactory(2));
+        Lazy<Object> object2(move(factory2));
+
+        Access<Object> access2(&object2);
+        Access<Object> access1(&object1);
+
+        EXPECT_LT(object1.get_access_stamp(), object2.get_access_stamp());
+    }
+}
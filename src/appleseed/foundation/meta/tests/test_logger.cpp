@@ -0,0 +1,157 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/test.h"
+
+// Boost headers.
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Utility_Log_Logger)
+{
+    struct Fixture
+    {
+        unique_ptr<StringLogTarget, void (*)(StringLogTarget*)> m_target;
+        Logger                                                  m_logger;
+
+        Fixture()
+          : m_target(create_string_log_target(), [](StringLogTarget* target) { target->release(); })
+        {
+            m_logger.set_all_formats("{message}");
+            m_logger.add_target(m_target.get());
+        }
+
+        ~Fixture()
+        {
+            m_logger.remove_target(m_target.get());
+        }
+    };
+
+    TEST_CASE_F(Write_GivenThreadMessageBuffer_KeepsMessageAside, Fixture)
+    {
+        Logger::MessageBuffer buffer;
+
+        m_logger.set_thread_message_buffer(&buffer);
+        LOG_INFO(m_logger, "hello %d", 42);
+        m_logger.set_thread_message_buffer(nullptr);
+
+        EXPECT_EQ("", string(m_target->get_string()));
+        ASSERT_EQ(1, buffer.size());
+        EXPECT_EQ(LogMessage::Info, buffer[0].m_category);
+        EXPECT_EQ("hello 42", buffer[0].m_message);
+    }
+
+    TEST_CASE_F(WriteBufferedMessages_WritesMessagesInOrder, Fixture)
+    {
+        Logger::MessageBuffer buffer;
+
+        m_logger.set_thread_message_buffer(&buffer);
+        LOG_WARNING(m_logger, "first");
+        LOG_ERROR(m_logger, "second");
+        m_logger.set_thread_message_buffer(nullptr);
+
+        LOG_INFO(m_logger, "direct");
+        m_logger.write_buffered_messages(buffer);
+
+        EXPECT_EQ("direct\nfirst\nsecond\n", string(m_target->get_string()));
+    }
+
+    TEST_CASE_F(Flush_GivenAsyncMode_WritesMessagesInOrder, Fixture)
+    {
+        m_logger.set_async_mode();
+        LOG_WARNING(m_logger, "first");
+        LOG_ERROR(m_logger, "second %d", 2);
+        m_logger.flush();
+
+        EXPECT_EQ("first\nsecond 2\n", string(m_target->get_string()));
+
+        m_logger.set_async_mode(false);
+    }
+
+    TEST_CASE_F(SetAsyncMode_GivenMessagesFromMultipleThreads_WritesAllMessages, Fixture)
+    {
+        const size_t ThreadCount = 4;
+        const size_t MessageCount = 2000;
+
+        m_logger.set_async_mode();
+
+        boost::thread_group threads;
+
+        for (size_t i = 0; i < ThreadCount; ++i)
+        {
+            threads.create_thread(
+                [this, i]()
+                {
+                    for (size_t j = 0; j < MessageCount; ++j)
+                        LOG_INFO(m_logger, "thread " FMT_SIZE_T " message " FMT_SIZE_T, i, j);
+                });
+        }
+
+        threads.join_all();
+
+        m_logger.set_async_mode(false);
+
+        vector<string> lines;
+        split(m_target->get_string(), "\n", lines);
+
+        EXPECT_EQ(ThreadCount * MessageCount + 1, lines.size());
+        EXPECT_EQ("", lines.back());
+    }
+
+    TEST_CASE_F(Flush_GivenRepeatedMessageLimit_SuppressesRepeatedMessages, Fixture)
+    {
+        m_logger.set_repeated_message_limit(2);
+        m_logger.set_async_mode();
+
+        for (size_t i = 0; i < 10; ++i)
+            LOG_WARNING(m_logger, "invalid sample");
+
+        LOG_WARNING(m_logger, "other");
+        m_logger.flush();
+
+        EXPECT_EQ(
+            "invalid sample\n"
+            "invalid sample\n"
+            "other\n"
+            "invalid sample (8 more occurrences suppressed)\n",
+            string(m_target->get_string()));
+
+        m_logger.set_async_mode(false);
+    }
+}
@@ -34,9 +34,13 @@
 #include "foundation/utility/memory.h"
 #include "foundation/utility/test.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <vector>
 
 using namespace foundation;
@@ -160,6 +164,112 @@ TEST_SUITE(Foundation_Utility_Memory)
 
 #endif
 
+    TEST_CASE(AlignedMalloc_AttributesBlockToCurrentMemoryTag)
+    {
+        const size_t initial_live_bytes = get_tagged_memory_live_bytes(MemoryTagPhotons);
+
+        void* ptr;
+
+        {
+            MemoryTagScope memory_tag_scope(MemoryTagPhotons);
+            ptr = aligned_malloc(1000, 16);
+        }
+
+        EXPECT_GT(initial_live_bytes + 1000, get_tagged_memory_live_bytes(MemoryTagPhotons));
+
+        // The block is released under its own tag regardless of the current tag.
+        aligned_free(ptr);
+
+        EXPECT_EQ(initial_live_bytes, get_tagged_memory_live_bytes(MemoryTagPhotons));
+    }
+
+    TEST_CASE(AlignedMalloc_GivenTransparentHugePages_ReturnsAlignedWritableBlock)
+    {
+        const size_t Size = 5 * 1024 * 1024;
+        const size_t initial_huge_page_bytes = get_huge_page_live_bytes(MemoryTagPhotons);
+
+        set_huge_page_mode(MemoryTagPhotons, HugePagesTransparent);
+
+        void* ptr;
+
+        {
+            MemoryTagScope memory_tag_scope(MemoryTagPhotons);
+            ptr = aligned_malloc(Size, 64);
+        }
+
+        set_huge_page_mode(MemoryTagPhotons, HugePagesOff);
+
+        ASSERT_NEQ(0, ptr);
+        EXPECT_TRUE(is_aligned(ptr, 64));
+
+        memset(ptr, 0xAB, Size);
+
+#ifdef __linux__
+        EXPECT_GT(initial_huge_page_bytes + Size, get_huge_page_live_bytes(MemoryTagPhotons));
+#endif
+
+        aligned_free(ptr);
+
+        EXPECT_EQ(initial_huge_page_bytes, get_huge_page_live_bytes(MemoryTagPhotons));
+    }
+
+    TEST_CASE(AlignedMalloc_GivenHugePagesAndSmallBlock_AllocatesBlockOnHeap)
+    {
+        const size_t initial_huge_page_bytes = get_huge_page_live_bytes(MemoryTagPhotons);
+
+        set_huge_page_mode(MemoryTagPhotons, HugePages2MB);
+
+        void* ptr;
+
+        {
+            MemoryTagScope memory_tag_scope(MemoryTagPhotons);
+            ptr = aligned_malloc(1000, 16);
+        }
+
+        set_huge_page_mode(MemoryTagPhotons, HugePagesOff);
+
+        EXPECT_EQ(initial_huge_page_bytes, get_huge_page_live_bytes(MemoryTagPhotons));
+
+        aligned_free(ptr);
+    }
+
+    TEST_CASE(MemoryTagScope_RestoresPreviousMemoryTag)
+    {
+        const MemoryTag initial_tag = get_current_memory_tag();
+
+        {
+            MemoryTagScope outer_scope(MemoryTagGeometry);
+
+            {
+                MemoryTagScope inner_scope(MemoryTagBVH);
+                EXPECT_EQ(MemoryTagBVH, get_current_memory_tag());
+            }
+
+            EXPECT_EQ(MemoryTagGeometry, get_current_memory_tag());
+        }
+
+        EXPECT_EQ(initial_tag, get_current_memory_tag());
+    }
+
+    TEST_CASE(TaggedMemoryRecord_TracksLiveAndPeakBytes)
+    {
+        reset_tagged_memory_peaks();
+
+        const size_t initial_live_bytes = get_tagged_memory_live_bytes(MemoryTagLights);
+
+        {
+            TaggedMemoryRecord record(MemoryTagLights);
+
+            record.set(300);
+            record.set(100);
+
+            EXPECT_EQ(initial_live_bytes + 100, get_tagged_memory_live_bytes(MemoryTagLights));
+            EXPECT_EQ(initial_live_bytes + 300, get_tagged_memory_peak_bytes(MemoryTagLights));
+        }
+
+        EXPECT_EQ(initial_live_bytes, get_tagged_memory_live_bytes(MemoryTagLights));
+    }
+
     TEST_CASE(EnsureMinimumSize_GivenEmptyVector_ResizesVectorByInsertingDefaultValue)
     {
         vector<int> v;
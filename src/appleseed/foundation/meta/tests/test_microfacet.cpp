@@ -335,6 +335,47 @@ TEST_SUITE(Foundation_Math_Microfacet)
         EXPECT_WEAK_WHITE_FURNACE_PASS(result);
     }
 
+    TEST_CASE(GGXMDF_EvaluateLobes_MatchesPerLobeEvaluation)
+    {
+        const size_t LobeCount = 5;
+        const float AlphaX[LobeCount] = { 0.05f, 0.2f, 0.35f, 0.25f, 0.9f };
+        const float AlphaY[LobeCount] = { 0.05f, 0.2f, 0.35f, 0.5f, 0.1f };
+
+        const Vector3f wo = normalize(Vector3f(0.3f, 0.8f, -0.2f));
+        const Vector3f wi = normalize(Vector3f(-0.6f, 0.5f, 0.4f));
+        const Vector3f m = normalize(wi + wo);
+
+        float D[LobeCount], G[LobeCount], pdf[LobeCount];
+        GGXMDF::evaluate_lobes(wi, wo, m, LobeCount, AlphaX, AlphaY, D, G, pdf);
+
+        for (size_t i = 0; i < LobeCount; ++i)
+        {
+            EXPECT_FEQ_EPS(GGXMDF::D(m, AlphaX[i], AlphaY[i], 0.0f), D[i], 1.0e-4f);
+            EXPECT_FEQ_EPS(GGXMDF::G(wi, wo, m, AlphaX[i], AlphaY[i], 0.0f), G[i], 1.0e-4f);
+            EXPECT_FEQ_EPS(GGXMDF::pdf(wo, m, AlphaX[i], AlphaY[i], 0.0f), pdf[i], 1.0e-4f);
+        }
+    }
+
+    TEST_CASE(GGXMDF_EvaluateLobes_GivenTangentDirections_MatchesPerLobeEvaluation)
+    {
+        const float AlphaX[2] = { 0.5f, 0.25f };
+        const float AlphaY[2] = { 0.5f, 0.75f };
+
+        const Vector3f wo(0.0f, 1.0f, 0.0f);
+        const Vector3f wi(1.0f, 0.0f, 0.0f);
+        const Vector3f m(0.0f, 0.0f, 1.0f);
+
+        float D[2], G[2], pdf[2];
+        GGXMDF::evaluate_lobes(wi, wo, m, 2, AlphaX, AlphaY, D, G, pdf);
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            EXPECT_FEQ(GGXMDF::D(m, AlphaX[i], AlphaY[i], 0.0f), D[i]);
+            EXPECT_FEQ(GGXMDF::G(wi, wo, m, AlphaX[i], AlphaY[i], 0.0f), G[i]);
+            EXPECT_FEQ(GGXMDF::pdf(wo, m, AlphaX[i], AlphaY[i], 0.0f), pdf[i]);
+        }
+    }
+
 
     //
     // Ward MDF.
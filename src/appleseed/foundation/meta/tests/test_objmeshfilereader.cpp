@@ -36,6 +36,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -121,4 +122,212 @@ TEST_SUITE(Foundation_Mesh_OBJMeshFileReader)
         EXPECT_EQ(4, mesh.m_tex_coords.size());
         EXPECT_EQ(1, mesh.m_faces.size());
     }
+
+    TEST_CASE(ReadCubeMeshFile_ParallelParsing)
+    {
+        OBJMeshFileReader reader(
+            "unit tests/inputs/test_objmeshfilereader_cube.obj",
+            OBJMeshFileReader::ParallelParsing);
+        MeshBuilder builder;
+        reader.read(builder);
+
+        EXPECT_EQ(1, builder.m_meshes.size());
+
+        Mesh& mesh = builder.m_meshes.front();
+        EXPECT_EQ("", mesh.m_name);
+        EXPECT_EQ(20, mesh.m_vertices.size());
+        EXPECT_EQ(6, mesh.m_vertex_normals.size());
+        EXPECT_EQ(20, mesh.m_tex_coords.size());
+        EXPECT_EQ(12, mesh.m_faces.size());
+    }
+
+    // Records every call made by the reader.
+    struct TraceMeshBuilder
+      : public MeshBuilderBase
+    {
+        vector<string>      m_names;
+        vector<double>      m_trace;
+        size_t              m_vertex_count;
+        size_t              m_vertex_normal_count;
+        size_t              m_tex_coord_count;
+        size_t              m_material_slot_count;
+        size_t              m_face_vertex_count;
+
+        void begin_mesh(const char* name) override
+        {
+            m_names.push_back(name);
+            m_trace.push_back(-1.0);
+            m_vertex_count = 0;
+            m_vertex_normal_count = 0;
+            m_tex_coord_count = 0;
+            m_material_slot_count = 0;
+        }
+
+        size_t push_vertex(const Vector3d& v) override
+        {
+            m_trace.insert(m_trace.end(), &v[0], &v[0] + 3);
+            return m_vertex_count++;
+        }
+
+        size_t push_vertex_normal(const Vector3d& v) override
+        {
+            m_trace.insert(m_trace.end(), &v[0], &v[0] + 3);
+            return m_vertex_normal_count++;
+        }
+
+        size_t push_tex_coords(const Vector2d& v) override
+        {
+            m_trace.insert(m_trace.end(), &v[0], &v[0] + 2);
+            return m_tex_coord_count++;
+        }
+
+        size_t push_material_slot(const char* name) override
+        {
+            m_names.push_back(name);
+            m_trace.push_back(-2.0);
+            return m_material_slot_count++;
+        }
+
+        void begin_face(const size_t vertex_count) override
+        {
+            m_trace.push_back(-3.0);
+            m_trace.push_back(static_cast<double>(vertex_count));
+            m_face_vertex_count = vertex_count;
+        }
+
+        void set_face_vertices(const size_t vertices[]) override
+        {
+            push_indices(vertices);
+        }
+
+        void set_face_vertex_normals(const size_t vertex_normals[]) override
+        {
+            push_indices(vertex_normals);
+        }
+
+        void set_face_vertex_tex_coords(const size_t tex_coords[]) override
+        {
+            push_indices(tex_coords);
+        }
+
+        void set_face_material(const size_t material) override
+        {
+            m_trace.push_back(static_cast<double>(material));
+        }
+
+        void end_mesh() override
+        {
+            m_trace.push_back(-4.0);
+        }
+
+        void push_indices(const size_t indices[])
+        {
+            for (size_t i = 0; i < m_face_vertex_count; ++i)
+                m_trace.push_back(static_cast<double>(indices[i]));
+        }
+    };
+
+    // Write an OBJ file large enough to be split across several threads.
+    // Optionally write an invalid face statement in the second half of the file
+    // and return its line number.
+    size_t write_large_mesh_file(const char* filename, const bool with_error)
+    {
+        FILE* file = fopen(filename, "wt");
+        size_t line = 0;
+        size_t error_line = 0;
+
+        for (size_t i = 0; i < 50000; ++i)
+        {
+            if (i % 1000 == 0)
+            {
+                fprintf(file, "g group_%u\n", static_cast<unsigned int>(i / 3000));
+                fprintf(file, "usemtl material_%u\n", static_cast<unsigned int>(i % 3));
+                line += 2;
+            }
+
+            fprintf(file, "v %u.25 %u.5 -%u.75\n", static_cast<unsigned int>(i), static_cast<unsigned int>(i + 1), static_cast<unsigned int>(i + 2));
+            fprintf(file, "vt 0.%u 0.%u\n", static_cast<unsigned int>(i % 97), static_cast<unsigned int>(i % 89));
+            fprintf(file, "vn 0 %u 1 # normal\n", static_cast<unsigned int>(i % 7));
+            line += 3;
+
+            if (i >= 3)
+            {
+                if (i % 2 == 0)
+                    fprintf(file, "f -1/-1/-1 -2/-2/-2 -3/-3/-3\n");
+                else fprintf(file, "f %u//%u %u//%u %u//%u %u//%u\n",
+                    static_cast<unsigned int>(i - 2), static_cast<unsigned int>(i - 2),
+                    static_cast<unsigned int>(i - 1), static_cast<unsigned int>(i - 1),
+                    static_cast<unsigned int>(i), static_cast<unsigned int>(i),
+                    static_cast<unsigned int>(i + 1), static_cast<unsigned int>(i + 1));
+                ++line;
+            }
+
+            if (with_error && error_line == 0 && i == 37000)
+            {
+                // The statement is valid up to its last index.
+                fprintf(file, "f 1/1/1 2/2/2 3/3/x\n");
+                error_line = ++line;
+            }
+        }
+
+        fclose(file);
+
+        return error_line;
+    }
+
+    TEST_CASE(ParallelParsing_ProducesSameMeshesAsSequentialParsing)
+    {
+        const char* Filename = "unit tests/outputs/test_objmeshfilereader_large.obj";
+        write_large_mesh_file(Filename, false);
+
+        TraceMeshBuilder sequential_builder;
+        OBJMeshFileReader sequential_reader(Filename, OBJMeshFileReader::FavorSpeedOverPrecision);
+        sequential_reader.read(sequential_builder);
+
+        TraceMeshBuilder parallel_builder;
+        OBJMeshFileReader parallel_reader(
+            Filename,
+            OBJMeshFileReader::FavorSpeedOverPrecision | OBJMeshFileReader::ParallelParsing);
+        parallel_reader.read(parallel_builder);
+
+        ASSERT_EQ(sequential_builder.m_names.size(), parallel_builder.m_names.size());
+        EXPECT_SEQUENCE_EQ(sequential_builder.m_names.size(), &sequential_builder.m_names[0], &parallel_builder.m_names[0]);
+
+        ASSERT_EQ(sequential_builder.m_trace.size(), parallel_builder.m_trace.size());
+        EXPECT_SEQUENCE_EQ(sequential_builder.m_trace.size(), &sequential_builder.m_trace[0], &parallel_builder.m_trace[0]);
+    }
+
+    TEST_CASE(ParallelParsing_ReportsSameParseErrorLineAsSequentialParsing)
+    {
+        const char* Filename = "unit tests/outputs/test_objmeshfilereader_large_with_error.obj";
+        const size_t error_line = write_large_mesh_file(Filename, true);
+
+        size_t sequential_error_line = 0;
+        size_t parallel_error_line = 0;
+
+        try
+        {
+            MeshBuilderBase builder;
+            OBJMeshFileReader reader(Filename);
+            reader.read(builder);
+        }
+        catch (const OBJMeshFileReader::ExceptionParseError& e)
+        {
+            sequential_error_line = e.m_line;
+        }
+
+        try
+        {
+            MeshBuilderBase builder;
+            OBJMeshFileReader reader(Filename, OBJMeshFileReader::ParallelParsing);
+            reader.read(builder);
+        }
+        catch (const OBJMeshFileReader::ExceptionParseError& e)
+        {
+            parallel_error_line = e.m_line;
+        }
+
+        EXPECT_EQ(error_line, sequential_error_line);
+        EXPECT_EQ(error_line, parallel_error_line);
+    }
 }
@@ -33,7 +33,12 @@
 #include "foundation/platform/types.h"
 #include "foundation/utility/test.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 using namespace foundation;
+using namespace std;
 
 TEST_SUITE(Foundation_Image_Pixel)
 {
@@ -96,4 +101,76 @@ TEST_SUITE(Foundation_Image_Pixel)
 
         EXPECT_EQ(4294967295UL, output);
     }
+
+    // Return values covering the range of interest, the length of which is not a multiple of the SIMD width.
+    vector<float> make_test_values()
+    {
+        vector<float> values;
+        for (size_t i = 0; i < 1037; ++i)
+            values.push_back(-0.5f + i * (2.0f / 1037));
+        values.push_back(1.0e-6f);
+        values.push_back(65504.0f);
+        values.push_back(1.0e6f);
+        return values;
+    }
+
+    // Contiguous ranges take the SIMD code paths, single values the generic ones.
+
+    TEST_CASE(ConvertToFormat_FloatToUInt8_ContiguousRangeMatchesSingleValues)
+    {
+        const vector<float> input = make_test_values();
+
+        vector<uint8> output(input.size());
+        Pixel::convert_to_format(
+            &input[0], &input[0] + input.size(),
+            1,
+            PixelFormatUInt8,
+            &output[0],
+            1);
+
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            uint8 expected;
+            Pixel::convert_to_format(&input[i], &input[i] + 1, 1, PixelFormatUInt8, &expected, 1);
+            EXPECT_EQ(expected, output[i]);
+        }
+    }
+
+    TEST_CASE(ConvertToFormat_FloatToHalf_ContiguousRangeMatchesSingleValues)
+    {
+        const vector<float> input = make_test_values();
+
+        vector<Half> output(input.size());
+        Pixel::convert_to_format(
+            &input[0], &input[0] + input.size(),
+            1,
+            PixelFormatHalf,
+            &output[0],
+            1);
+
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            Half expected;
+            Pixel::convert_to_format(&input[i], &input[i] + 1, 1, PixelFormatHalf, &expected, 1);
+            EXPECT_EQ(static_cast<float>(expected), static_cast<float>(output[i]));
+        }
+    }
+
+    TEST_CASE(ConvertFromFormat_HalfToFloat_ContiguousRangeMatchesSingleValues)
+    {
+        vector<Half> input;
+        for (size_t i = 0; i < 0x7c00; i += 7)
+            input.push_back(Half::from_bits(static_cast<uint16>(i)));
+
+        vector<float> output(input.size());
+        Pixel::convert_from_format(
+            PixelFormatHalf,
+            &input[0], &input[0] + input.size(),
+            1,
+            &output[0],
+            1);
+
+        for (size_t i = 0; i < input.size(); ++i)
+            EXPECT_EQ(half_to_float(input[i]), output[i]);
+    }
 }
@@ -172,6 +172,63 @@ TEST_SUITE(Foundation_Math_QMC)
         EXPECT_FEQ(7.0 / 9, permuted_radical_inverse<double>(3, Perm, 7));
     }
 
+    TEST_CASE(Sobol_FirstDimension_MatchesRadicalInverseBase2)
+    {
+        for (uint32 i = 0; i < 64; ++i)
+            EXPECT_FEQ(radical_inverse_base2_32<double>(i), sobol_uint32(0, i) / 4294967296.0);
+    }
+
+    TEST_CASE(Sobol_SecondDimension)
+    {
+        EXPECT_EQ(0x00000000u, sobol_uint32(1, 0));
+        EXPECT_EQ(0x80000000u, sobol_uint32(1, 1));
+        EXPECT_EQ(0xC0000000u, sobol_uint32(1, 2));
+        EXPECT_EQ(0x40000000u, sobol_uint32(1, 3));
+        EXPECT_EQ(0xA0000000u, sobol_uint32(1, 4));
+        EXPECT_EQ(0x20000000u, sobol_uint32(1, 5));
+        EXPECT_EQ(0x60000000u, sobol_uint32(1, 6));
+        EXPECT_EQ(0xE0000000u, sobol_uint32(1, 7));
+    }
+
+    TEST_CASE(OwenScrambledSobolSequence_MatchesOwenScrambledSobol)
+    {
+        for (uint32 i = 0; i < 256; ++i)
+        {
+            float values[SobolDimensionCount];
+            owen_scrambled_sobol_sequence(SobolDimensionCount, i, 0x1234567u, values);
+
+            for (size_t d = 0; d < SobolDimensionCount; ++d)
+                EXPECT_EQ(owen_scrambled_sobol<float>(d, i, 0x1234567u), values[d]);
+        }
+    }
+
+    TEST_CASE(OwenScrambledSobol_PreservesStratification)
+    {
+        // Each interval [k/N, (k+1)/N) of each dimension must contain exactly one of the first N points.
+        const size_t N = 64;
+
+        for (size_t d = 0; d < SobolDimensionCount; ++d)
+        {
+            vector<size_t> counts(N, 0);
+
+            for (uint32 i = 0; i < N; ++i)
+            {
+                const double x = owen_scrambled_sobol<double>(d, i, 42);
+                ASSERT_TRUE(x >= 0.0 && x < 1.0);
+                ++counts[static_cast<size_t>(x * N)];
+            }
+
+            for (size_t k = 0; k < N; ++k)
+                EXPECT_EQ(1, counts[k]);
+        }
+    }
+
+    TEST_CASE(OwenScrambledSobol_GivenMaximumValue_ReturnsValueLessThanOne)
+    {
+        EXPECT_LT(1.0f, impl::fixed_point_to_unit<float>(0xFFFFFFFFu));
+        EXPECT_LT(1.0, impl::fixed_point_to_unit<double>(0xFFFFFFFFu));
+    }
+
     static const size_t PointCount = 256;
 
     TEST_CASE(Generate2DRandomSequenceImage)
@@ -0,0 +1,111 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/raysorting.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_RaySorting)
+{
+    TEST_CASE(MortonCode_InterleavesBits)
+    {
+        EXPECT_EQ(0, morton_code(0, 0, 0));
+        EXPECT_EQ(4, morton_code(1, 0, 0));
+        EXPECT_EQ(2, morton_code(0, 1, 0));
+        EXPECT_EQ(1, morton_code(0, 0, 1));
+        EXPECT_EQ(7 << 3, morton_code(2, 2, 2));
+        EXPECT_EQ(0x3FFFFFFFUL, morton_code(1023, 1023, 1023));
+    }
+
+    TEST_CASE(DirectionOctant_ReturnsDistinctOctantPerSignCombination)
+    {
+        EXPECT_EQ(0, direction_octant(Vector3d(1.0, 1.0, 1.0)));
+        EXPECT_EQ(7, direction_octant(Vector3d(-1.0, -1.0, -1.0)));
+        EXPECT_EQ(4, direction_octant(Vector3d(-1.0, 1.0, 1.0)));
+        EXPECT_EQ(1, direction_octant(Vector3d(1.0, 1.0, -1.0)));
+    }
+
+    TEST_CASE(RaySortKey_OrdersRaysByOctantFirst)
+    {
+        const AABB3d bbox(Vector3d(0.0), Vector3d(1.0));
+
+        const Ray3d a(Vector3d(1.0), Vector3d(1.0, 0.0, 0.0));
+        const Ray3d b(Vector3d(0.0), Vector3d(0.0, 0.0, -1.0));
+
+        EXPECT_LT(ray_sort_key(b, bbox), ray_sort_key(a, bbox));
+    }
+
+    TEST_CASE(RaySortOrdering_GroupsRaysWithSameOctantAndNearbyOrigins)
+    {
+        const Ray3d rays[] =
+        {
+            Ray3d(Vector3d(0.0, 0.0, 0.0), Vector3d(0.0, 0.0, -1.0)),
+            Ray3d(Vector3d(9.0, 9.0, 9.0), Vector3d(1.0, 0.0, 0.0)),
+            Ray3d(Vector3d(0.1, 0.1, 0.1), Vector3d(0.0, 0.0, -1.0)),
+            Ray3d(Vector3d(0.0, 0.1, 0.0), Vector3d(1.0, 0.0, 0.0))
+        };
+
+        vector<size_t> ordering;
+        ray_sort_ordering(ordering, rays, 4);
+
+        ASSERT_EQ(4, ordering.size());
+        EXPECT_EQ(3, ordering[0]);
+        EXPECT_EQ(1, ordering[1]);
+        EXPECT_EQ(0, ordering[2]);
+        EXPECT_EQ(2, ordering[3]);
+    }
+
+    TEST_CASE(RaySortOrdering_GivenRaysWithSameOrigin_PreservesOrderWithinOctant)
+    {
+        const Ray3d rays[] =
+        {
+            Ray3d(Vector3d(1.0, 2.0, 3.0), Vector3d(0.0, 1.0, 0.0)),
+            Ray3d(Vector3d(1.0, 2.0, 3.0), Vector3d(0.0, -1.0, 0.0)),
+            Ray3d(Vector3d(1.0, 2.0, 3.0), Vector3d(0.0, 1.0, 0.0))
+        };
+
+        vector<size_t> ordering;
+        ray_sort_ordering(ordering, rays, 3);
+
+        ASSERT_EQ(3, ordering.size());
+        EXPECT_EQ(0, ordering[0]);
+        EXPECT_EQ(2, ordering[1]);
+        EXPECT_EQ(1, ordering[2]);
+    }
+}
@@ -28,12 +28,14 @@
 //
 
 // appleseed.foundation headers.
+#include "foundation/math/rng/bufferedrng.h"
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/rng/pcg.h"
 #include "foundation/math/rng/serialmersennetwister.h"
 #ifdef APPLESEED_USE_SSE
 #include "foundation/math/rng/simdmersennetwister.h"
 #endif
+#include "foundation/math/rng/xoroshiro128plus.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/countof.h"
 #include "foundation/utility/test.h"
@@ -560,6 +562,19 @@ TEST_SUITE(Foundation_Math_RNG_PCG)
         for (size_t i = 0; i < 1000; ++i)
             EXPECT_EQ(Expected[i], rng.rand_uint32());
     }
+
+    TEST_CASE(FillUint32_ProducesSameNumbersAsRandUint32)
+    {
+        PCG rng;
+        PCG filled_rng;
+
+        uint32 values[1000];
+        filled_rng.fill_uint32(values, 10);
+        filled_rng.fill_uint32(values + 10, 990);
+
+        for (size_t i = 0; i < 1000; ++i)
+            EXPECT_EQ(rng.rand_uint32(), values[i]);
+    }
 }
 
 TEST_SUITE(Foundation_Math_RNG_SerialMersenneTwister)
@@ -776,6 +791,19 @@ TEST_SUITE(Foundation_Math_RNG_SerialMersenneTwister)
         for (size_t i = 0; i < 1000; ++i)
             EXPECT_EQ(Expected[i], rng.rand_uint32());
     }
+
+    TEST_CASE(FillUint32_ProducesSameNumbersAsRandUint32)
+    {
+        SerialMersenneTwister rng;
+        SerialMersenneTwister filled_rng;
+
+        uint32 values[1000];
+        filled_rng.fill_uint32(values, 10);
+        filled_rng.fill_uint32(values + 10, 990);
+
+        for (size_t i = 0; i < 1000; ++i)
+            EXPECT_EQ(rng.rand_uint32(), values[i]);
+    }
 }
 
 #ifdef APPLESEED_USE_SSE
@@ -994,6 +1022,68 @@ TEST_SUITE(Foundation_Math_RNG_SimdMersenneTwister)
         for (size_t i = 0; i < 1000; ++i)
             EXPECT_EQ(Expected[i], rng.rand_uint32());
     }
+
+    TEST_CASE(FillUint32_ProducesSameNumbersAsRandUint32)
+    {
+        SimdMersenneTwister rng;
+        SimdMersenneTwister filled_rng;
+
+        uint32 values[1000];
+        filled_rng.fill_uint32(values, 10);
+        filled_rng.fill_uint32(values + 10, 990);
+
+        for (size_t i = 0; i < 1000; ++i)
+            EXPECT_EQ(rng.rand_uint32(), values[i]);
+    }
 }
 
 #endif
+
+TEST_SUITE(Foundation_Math_RNG_BufferedRNG)
+{
+    typedef BufferedRNG<Xoroshiro128plus, 16> RNG;
+
+    TEST_CASE(RandUint32_ProducesSameNumbersAsUnderlyingRNG)
+    {
+        Xoroshiro128plus expected_rng;
+        RNG rng;
+
+        for (size_t i = 0; i < 100; ++i)
+            EXPECT_EQ(expected_rng.rand_uint32(), rng.rand_uint32());
+    }
+
+    TEST_CASE(FillUint32_InterleavedWithRandUint32_ProducesSameNumbersAsUnderlyingRNG)
+    {
+        Xoroshiro128plus expected_rng;
+        RNG rng;
+
+        uint32 values[40];
+
+        EXPECT_EQ(expected_rng.rand_uint32(), rng.rand_uint32());
+
+        // Partly served from the buffer, partly from a refilled buffer.
+        rng.fill_uint32(values, 20);
+        for (size_t i = 0; i < 20; ++i)
+            EXPECT_EQ(expected_rng.rand_uint32(), values[i]);
+
+        // Large enough to bypass the buffer.
+        rng.fill_uint32(values, 40);
+        for (size_t i = 0; i < 40; ++i)
+            EXPECT_EQ(expected_rng.rand_uint32(), values[i]);
+
+        for (size_t i = 0; i < 20; ++i)
+            EXPECT_EQ(expected_rng.rand_uint32(), rng.rand_uint32());
+    }
+
+    TEST_CASE(FillRandFloat2_ProducesSameNumbersAsRandFloat2)
+    {
+        Xoroshiro128plus expected_rng;
+        RNG rng;
+
+        float values[100];
+        fill_rand_float2(rng, values, 100);
+
+        for (size_t i = 0; i < 100; ++i)
+            EXPECT_EQ(rand_float2(expected_rng), values[i]);
+    }
+}
@@ -210,6 +210,22 @@ TEST_SUITE(Foundation_Math_Scalar)
         EXPECT_EQ(31, log2_int(1UL << 31));
     }
 
+    TEST_CASE(TrailingZerosInt)
+    {
+        EXPECT_EQ(0,  trailing_zeros_int(1));
+        EXPECT_EQ(1,  trailing_zeros_int(2));
+        EXPECT_EQ(0,  trailing_zeros_int(3));
+        EXPECT_EQ(2,  trailing_zeros_int(12));
+        EXPECT_EQ(5,  trailing_zeros_int<int16>(1UL << 5));
+        EXPECT_EQ(5,  trailing_zeros_int<int32>(3UL << 5));
+        EXPECT_EQ(5,  trailing_zeros_int<int64>(1UL << 5));
+        EXPECT_EQ(5,  trailing_zeros_int<uint16>(1UL << 5));
+        EXPECT_EQ(5,  trailing_zeros_int<uint32>(3UL << 5));
+        EXPECT_EQ(5,  trailing_zeros_int<uint64>(1UL << 5));
+        EXPECT_EQ(16, trailing_zeros_int(1UL << 16));
+        EXPECT_EQ(31, trailing_zeros_int(1UL << 31));
+    }
+
     TEST_CASE(NextMultiple)
     {
         EXPECT_EQ(0,  next_multiple(0, 5));
@@ -0,0 +1,174 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sparsevoxelgrid.h"
+#include "foundation/math/vector.h"
+#include "foundation/math/voxelgrid.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_SparseVoxelGrid3)
+{
+    const size_t ChannelCount = 2;
+
+    // A 20x12x10 grid with a ball of non-zero voxels straddling eight leaves.
+    struct Fixture
+    {
+        VoxelGrid3<float, double>       m_dense_grid;
+        SparseVoxelGrid3<float, double> m_sparse_grid;
+
+        Fixture()
+          : m_dense_grid(20, 12, 10, ChannelCount)
+          , m_sparse_grid(20, 12, 10, ChannelCount)
+        {
+            for (size_t z = 0; z < 10; ++z)
+            {
+                for (size_t y = 0; y < 12; ++y)
+                {
+                    for (size_t x = 0; x < 20; ++x)
+                    {
+                        const Vector3d d(x - 6.0, y - 6.0, z - 6.0);
+                        const double r2 = dot(d, d);
+
+                        if (r2 < 16.0)
+                        {
+                            float values[ChannelCount];
+                            values[0] = static_cast<float>(16.0 - r2);
+                            values[1] = static_cast<float>(x + y + z);
+
+                            float* dense_values = m_dense_grid.voxel(x, y, z);
+                            dense_values[0] = values[0];
+                            dense_values[1] = values[1];
+
+                            m_sparse_grid.set_voxel(x, y, z, values);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    TEST_CASE_F(Constructor_OnlyAllocatesTouchedLeaves, Fixture)
+    {
+        ASSERT_EQ(3, m_sparse_grid.get_leaf_xres());
+        ASSERT_EQ(2, m_sparse_grid.get_leaf_yres());
+        ASSERT_EQ(2, m_sparse_grid.get_leaf_zres());
+
+        EXPECT_TRUE(m_sparse_grid.is_leaf_active(0, 0, 0));
+        EXPECT_TRUE(m_sparse_grid.is_leaf_active(1, 1, 0));
+        EXPECT_FALSE(m_sparse_grid.is_leaf_active(2, 0, 0));
+        EXPECT_EQ(8, m_sparse_grid.get_leaf_count());
+    }
+
+    TEST_CASE_F(GetLeafMax_ReturnsMaximumOfLeafValues, Fixture)
+    {
+        EXPECT_EQ(16.0f, m_sparse_grid.get_leaf_max(0, 0, 0, 0));
+        EXPECT_EQ(0.0f, m_sparse_grid.get_leaf_max(2, 1, 1, 0));
+    }
+
+    TEST_CASE_F(Voxel_GivenUnallocatedLeaf_ReturnsZero, Fixture)
+    {
+        const float* values = m_sparse_grid.voxel(19, 11, 9);
+
+        EXPECT_EQ(0.0f, values[0]);
+        EXPECT_EQ(0.0f, values[1]);
+    }
+
+    TEST_CASE_F(NearestLookup_MatchesDenseGrid, Fixture)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            Vector3d point;
+            point.x = rand_double1(rng, -0.1, 1.1);
+            point.y = rand_double1(rng, -0.1, 1.1);
+            point.z = rand_double1(rng, -0.1, 1.1);
+
+            float expected[ChannelCount], values[ChannelCount];
+            m_dense_grid.nearest_lookup(point, expected);
+            m_sparse_grid.nearest_lookup(point, values);
+
+            EXPECT_EQ(expected[0], values[0]);
+            EXPECT_EQ(expected[1], values[1]);
+        }
+    }
+
+    TEST_CASE_F(LinearLookup_MatchesDenseGrid, Fixture)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            Vector3d point;
+            point.x = rand_double1(rng, -0.1, 1.1);
+            point.y = rand_double1(rng, -0.1, 1.1);
+            point.z = rand_double1(rng, -0.1, 1.1);
+
+            float expected[ChannelCount], values[ChannelCount];
+            m_dense_grid.linear_lookup(point, expected);
+            m_sparse_grid.linear_lookup(point, values);
+
+            EXPECT_FEQ(expected[0], values[0]);
+            EXPECT_FEQ(expected[1], values[1]);
+        }
+    }
+
+    TEST_CASE_F(BatchedLinearLookup_MatchesIndividualLookups, Fixture)
+    {
+        // Points along a line so that consecutive lookups often share a leaf.
+        const size_t PointCount = 200;
+        vector<Vector3d> points(PointCount);
+        for (size_t i = 0; i < PointCount; ++i)
+        {
+            const double t = static_cast<double>(i) / (PointCount - 1);
+            points[i] = Vector3d(t, 0.5 * t + 0.1, 0.4);
+        }
+
+        vector<float> values(PointCount * ChannelCount);
+        m_sparse_grid.linear_lookup(PointCount, &points[0], &values[0]);
+
+        for (size_t i = 0; i < PointCount; ++i)
+        {
+            float expected[ChannelCount];
+            m_sparse_grid.linear_lookup(points[i], expected);
+
+            EXPECT_EQ(expected[0], values[i * ChannelCount + 0]);
+            EXPECT_EQ(expected[1], values[i * ChannelCount + 1]);
+        }
+    }
+}
@@ -29,11 +29,13 @@
 // appleseed.foundation headers.
 #include "foundation/math/qmc.h"
 #include "foundation/math/sampling/sphericalimportancesampler.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/test.h"
 #include "foundation/utility/vpythonfile.h"
 
 // Standard headers.
+#include <cmath>
 #include <cstddef>
 
 using namespace foundation;
@@ -62,4 +64,42 @@ TEST_SUITE(Foundation_Math_Sampling_SphericalImportanceSampler)
             file.draw_point(p, "color.white", 1);
         }
     }
+
+    TEST_CASE(GetTriangleArea_SumOverAllTriangles_ReturnsFourPi)
+    {
+        const SphericalImportanceSampler<double> sampler(2);
+
+        EXPECT_EQ(size_t(20 * 4 * 4), sampler.get_triangle_count());
+
+        double total_area = 0.0;
+
+        for (size_t i = 0; i < sampler.get_triangle_count(); ++i)
+            total_area += sampler.get_triangle_area(i);
+
+        EXPECT_FEQ(FourPi<double>(), total_area);
+    }
+
+    TEST_CASE(FindTriangle_GivenSampleOfTriangle_ReturnsThisTriangle)
+    {
+        const SphericalImportanceSampler<double> sampler(3);
+
+        for (size_t i = 0; i < sampler.get_triangle_count(); ++i)
+        {
+            const Vector3d p = sampler.sample_triangle(i, Vector2d(0.3, 0.6));
+
+            ASSERT_EQ(i, sampler.find_triangle(p));
+            ASSERT_EQ(i, sampler.find_triangle(sampler.get_triangle_center(i)));
+        }
+    }
+
+    TEST_CASE(FindTriangle_GivenVertexDirection_ReturnsTriangleWithNearbyCenter)
+    {
+        const SphericalImportanceSampler<double> sampler(2);
+
+        const Vector3d p = normalize(Vector3d(-1.0, GoldenRatio<double>(), 0.0));
+        const size_t i = sampler.find_triangle(p);
+
+        ASSERT_LT(sampler.get_triangle_count(), i);
+        EXPECT_LT(sampler.get_triangle_radius(i) + 1.0e-6, acos(dot(p, sampler.get_triangle_center(i))));
+    }
 }
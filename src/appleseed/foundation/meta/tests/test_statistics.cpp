@@ -30,6 +30,7 @@
 // appleseed.foundation headers.
 #include "foundation/math/population.h"
 #include "foundation/platform/types.h"
+#include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/test.h"
 
@@ -211,6 +212,19 @@ TEST_SUITE(Foundation_Utility_Statistics)
 
         EXPECT_EQ("  existing value                19.6%", stats.to_string());
     }
+
+    TEST_CASE(ToDictionary_ReturnsFormattedValuesIndexedByName)
+    {
+        Statistics stats;
+        stats.insert<uint64>("first value", 17000);
+        stats.insert<string>("second value", "hit");
+
+        const Dictionary dictionary = stats.to_dictionary();
+
+        ASSERT_EQ(2, dictionary.size());
+        EXPECT_EQ("17,000", string(dictionary.get("first value")));
+        EXPECT_EQ("hit", string(dictionary.get("second value")));
+    }
 }
 
 TEST_SUITE(Foundation_Utility_StatisticsVector)
@@ -229,4 +243,23 @@ TEST_SUITE(Foundation_Utility_StatisticsVector)
 
         EXPECT_EQ("stats 1:\n  counter 1                     17\nstats 2:\n  counter 2                     42", vec.to_string());
     }
+
+    TEST_CASE(ToDictionary_GivenTwoItems_ReturnsOneChildDictionaryPerItem)
+    {
+        Statistics stats1;
+        stats1.insert<uint64>("counter 1", 17);
+
+        Statistics stats2;
+        stats2.insert<uint64>("counter 2", 42);
+
+        StatisticsVector vec;
+        vec.insert("stats 1", stats1);
+        vec.insert("stats 2", stats2);
+
+        const Dictionary dictionary = vec.to_dictionary();
+
+        ASSERT_EQ(2, dictionary.dictionaries().size());
+        EXPECT_EQ("17", string(dictionary.dictionary("stats 1").get("counter 1")));
+        EXPECT_EQ("42", string(dictionary.dictionary("stats 2").get("counter 2")));
+    }
 }
@@ -44,6 +44,11 @@ TEST_SUITE(Foundation_Platform_Thread)
         sleep(1000 * 3600, abort_switch);
     }
 
+    TEST_CASE(GetNumaNodeCount_ReturnsAtLeastOneNode)
+    {
+        EXPECT_TRUE(get_numa_node_count() >= 1);
+    }
+
 #ifdef EXPLORATION_TESTS
 
     TEST_CASE(Sleep_CheckElapsedTime)
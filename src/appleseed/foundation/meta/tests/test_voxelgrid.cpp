@@ -32,6 +32,8 @@
 #include "foundation/image/genericimagefilewriter.h"
 #include "foundation/image/image.h"
 #include "foundation/image/pixel.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/math/voxelgrid.h"
@@ -41,6 +43,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -354,6 +357,101 @@ TEST_SUITE(Foundation_Math_VoxelGrid3)
             0.5);
     }
 
+    //
+    // Bricked layout and batched lookups.
+    //
+
+    // Grid dimensions are not multiples of the brick size, and there are more than four channels.
+    const size_t LayoutTestXRes = 5;
+    const size_t LayoutTestYRes = 6;
+    const size_t LayoutTestZRes = 9;
+    const size_t LayoutTestChannelCount = 5;
+    const size_t LayoutTestPointCount = 103;
+
+    template <typename Grid>
+    void fill_grid(Grid& grid)
+    {
+        MersenneTwister rng;
+
+        for (size_t z = 0; z < grid.get_zres(); ++z)
+        {
+            for (size_t y = 0; y < grid.get_yres(); ++y)
+            {
+                for (size_t x = 0; x < grid.get_xres(); ++x)
+                {
+                    float* values = grid.voxel(x, y, z);
+
+                    for (size_t c = 0; c < grid.get_channel_count(); ++c)
+                        values[c] = rand_float1(rng);
+                }
+            }
+        }
+    }
+
+    vector<Vector3d> make_lookup_points()
+    {
+        MersenneTwister rng;
+        vector<Vector3d> points(LayoutTestPointCount);
+
+        for (size_t i = 0; i < LayoutTestPointCount; ++i)
+        {
+            // Some of the points are outside the unit cube.
+            points[i].x = rand_double1(rng, -0.1, 1.1);
+            points[i].y = rand_double1(rng, -0.1, 1.1);
+            points[i].z = rand_double1(rng, -0.1, 1.1);
+        }
+
+        return points;
+    }
+
+    TEST_CASE(BrickedLayout_GivenSameVoxels_ReturnsSameLookupValuesAsLinearLayout)
+    {
+        typedef VoxelGrid3<float, double> GridType;
+
+        GridType linear_grid(LayoutTestXRes, LayoutTestYRes, LayoutTestZRes, LayoutTestChannelCount);
+        GridType bricked_grid(LayoutTestXRes, LayoutTestYRes, LayoutTestZRes, LayoutTestChannelCount, GridType::BrickedLayout);
+        fill_grid(linear_grid);
+        fill_grid(bricked_grid);
+
+        const vector<Vector3d> points = make_lookup_points();
+
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            float expected[LayoutTestChannelCount], values[LayoutTestChannelCount];
+
+            linear_grid.nearest_lookup(points[i], expected);
+            bricked_grid.nearest_lookup(points[i], values);
+            EXPECT_SEQUENCE_EQ(LayoutTestChannelCount, expected, values);
+
+            linear_grid.linear_lookup(points[i], expected);
+            bricked_grid.linear_lookup(points[i], values);
+            EXPECT_SEQUENCE_FEQ(LayoutTestChannelCount, expected, values);
+
+            linear_grid.quadratic_lookup(points[i], expected);
+            bricked_grid.quadratic_lookup(points[i], values);
+            EXPECT_SEQUENCE_FEQ(LayoutTestChannelCount, expected, values);
+        }
+    }
+
+    TEST_CASE(BatchedLinearLookup_ReturnsSameValuesAsSingleLookups)
+    {
+        typedef VoxelGrid3<float, double> GridType;
+
+        GridType grid(LayoutTestXRes, LayoutTestYRes, LayoutTestZRes, LayoutTestChannelCount);
+        fill_grid(grid);
+
+        const vector<Vector3d> points = make_lookup_points();
+
+        vector<float> expected(points.size() * LayoutTestChannelCount);
+        for (size_t i = 0; i < points.size(); ++i)
+            grid.linear_lookup(points[i], &expected[i * LayoutTestChannelCount]);
+
+        vector<float> values(points.size() * LayoutTestChannelCount);
+        grid.linear_lookup(points.size(), &points[0], &values[0]);
+
+        EXPECT_SEQUENCE_FEQ(values.size(), &expected[0], &values[0]);
+    }
+
     //
     // Reference code for bilinear filtering.
     //
@@ -0,0 +1,140 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/intersection/rayaabb.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/vector.h"
+#include "foundation/math/voxel.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+TEST_SUITE(Foundation_Math_Voxel_Intersector)
+{
+    typedef voxel::Tree<double, 3> TreeType;
+    typedef voxel::Builder<TreeType> BuilderType;
+    typedef voxel::Intersector<double, TreeType> IntersectorType;
+
+    class BoxIntersector
+    {
+      public:
+        explicit BoxIntersector(const AABB3d& box)
+          : m_box(box)
+        {
+        }
+
+        bool intersect(const AABB3d& bbox) const
+        {
+            return AABB3d::overlap(m_box, bbox);
+        }
+
+      private:
+        const AABB3d m_box;
+    };
+
+    struct Fixture
+    {
+        TreeType        m_tree;
+        MersenneTwister m_rng;
+
+        Fixture()
+        {
+            BuilderType builder(m_tree, AABB3d(Vector3d(0.0), Vector3d(1.0)), 1.0 / 64);
+
+            for (size_t i = 0; i < 40; ++i)
+            {
+                const Vector3d center = rand_vector1<Vector3d>(m_rng);
+                const Vector3d half_extent = 0.05 * rand_vector1<Vector3d>(m_rng);
+                builder.push(BoxIntersector(AABB3d(center - half_extent, center + half_extent)));
+            }
+
+            builder.complete();
+        }
+    };
+
+    TEST_CASE_F(IntersectPacket_GivenRaysSharingOriginAndOctant_MatchesIntersectingRaysOneByOne, Fixture)
+    {
+        const IntersectorType intersector;
+
+        for (size_t packet = 0; packet < 500; ++packet)
+        {
+            const Vector3d org = rand_vector1<Vector3d>(m_rng);
+            const Vector3d signs(
+                rand_double1(m_rng) < 0.5 ? -1.0 : 1.0,
+                rand_double1(m_rng) < 0.5 ? -1.0 : 1.0,
+                rand_double1(m_rng) < 0.5 ? -1.0 : 1.0);
+
+            const size_t ray_count = 1 + packet % IntersectorType::PacketSize;
+
+            Ray3d rays[IntersectorType::PacketSize];
+            RayInfo3d ray_infos[IntersectorType::PacketSize];
+
+            for (size_t i = 0; i < ray_count; ++i)
+            {
+                const Vector3d dir = sample_sphere_uniform(rand_vector2<Vector2d>(m_rng));
+                const Vector3d octant_dir(abs(dir[0]) * signs[0], abs(dir[1]) * signs[1], abs(dir[2]) * signs[2]);
+                rays[i] = Ray3d(org, octant_dir, 0.0, 0.5);
+                ray_infos[i] = RayInfo3d(rays[i]);
+                clip(rays[i], ray_infos[i], m_tree.get_bbox());
+            }
+
+            for (size_t s = 0; s < 2; ++s)
+            {
+                const bool solid = s == 0;
+
+                double distances[IntersectorType::PacketSize];
+                const size_t hits =
+                    intersector.intersect_packet(m_tree, rays, ray_infos, ray_count, solid, distances);
+
+                for (size_t i = 0; i < ray_count; ++i)
+                {
+                    double expected_distance;
+                    const bool expected_hit =
+                        intersector.intersect(m_tree, rays[i], ray_infos[i], solid, expected_distance);
+
+                    ASSERT_EQ(expected_hit, (hits & (size_t(1) << i)) != 0);
+
+                    if (expected_hit)
+                        EXPECT_EQ(expected_distance, distances[i]);
+                }
+
+                EXPECT_EQ(0, hits >> ray_count);
+            }
+        }
+    }
+}
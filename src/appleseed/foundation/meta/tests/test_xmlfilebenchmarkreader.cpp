@@ -0,0 +1,114 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark/benchmarksuite.h"
+#include "foundation/utility/benchmark/ibenchmarkcase.h"
+#include "foundation/utility/benchmark/timingresult.h"
+#include "foundation/utility/benchmark/xmlfilebenchmarklistener.h"
+#include "foundation/utility/benchmark/xmlfilebenchmarkreader.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+TEST_SUITE(Foundation_Utility_Benchmark_XMLFileBenchmarkReader)
+{
+    struct BenchmarkCase
+      : public IBenchmarkCase
+    {
+        const char* get_name() const override
+        {
+            return "Case";
+        }
+
+        void run() override
+        {
+        }
+    };
+
+    const char* OutputFilePath = "unit tests/outputs/test_xmlfilebenchmarkreader.xml";
+
+    void write_benchmark_file(const TimingResult& timing_result)
+    {
+        const BenchmarkSuite benchmark_suite("Suite");
+        const BenchmarkCase benchmark_case;
+
+        XMLFileBenchmarkListener* listener = create_xmlfile_benchmark_listener();
+        listener->open(OutputFilePath);
+        listener->begin_suite(benchmark_suite);
+        listener->begin_case(benchmark_suite, benchmark_case);
+        listener->write(benchmark_suite, benchmark_case, __FILE__, __LINE__, timing_result);
+        listener->end_case(benchmark_suite, benchmark_case);
+        listener->end_suite(benchmark_suite);
+        listener->release();
+    }
+
+    TEST_CASE(Read_GivenNonExistingFile_ReturnsFalse)
+    {
+        XMLFileBenchmarkReader reader;
+        const bool success = reader.read("unit tests/inputs/test_xmlfilebenchmarkreader_nonexisting.xml");
+
+        EXPECT_FALSE(success);
+        EXPECT_EQ(0, reader.get_case_count());
+    }
+
+    TEST_CASE(Read_GivenFileWrittenByXMLFileBenchmarkListener_ReadsBackTimingResult)
+    {
+        TimingResult expected;
+        expected.m_iteration_count = 1;
+        expected.m_measurement_count = 1000;
+        expected.m_frequency = 3000000000.0;
+        expected.m_ticks = 1234.5;
+        expected.m_samples.push_back(1234.5);
+        expected.m_samples.push_back(1300.0);
+        expected.m_samples.push_back(1250.25);
+
+        write_benchmark_file(expected);
+
+        XMLFileBenchmarkReader reader;
+        const bool success = reader.read(OutputFilePath);
+
+        ASSERT_TRUE(success);
+        ASSERT_EQ(1, reader.get_case_count());
+        EXPECT_EQ(0, reader.find_case("Suite", "Case"));
+        EXPECT_EQ(~size_t(0), reader.find_case("Suite", "OtherCase"));
+
+        const TimingResult& result = reader.get_timing_result(0);
+        EXPECT_EQ(expected.m_iteration_count, result.m_iteration_count);
+        EXPECT_EQ(expected.m_measurement_count, result.m_measurement_count);
+        EXPECT_FEQ(expected.m_frequency, result.m_frequency);
+        EXPECT_FEQ(expected.m_ticks, result.m_ticks);
+        ASSERT_EQ(expected.m_samples.size(), result.m_samples.size());
+        EXPECT_FEQ(expected.m_samples[0], result.m_samples[0]);
+        EXPECT_FEQ(expected.m_samples[1], result.m_samples[1]);
+        EXPECT_FEQ(expected.m_samples[2], result.m_samples[2]);
+    }
+}
@@ -36,6 +36,7 @@
 
 // Standard headers.
 #include <algorithm>
+#include <cstring>
 #include <set>
 #include <string>
 #include <vector>
@@ -138,4 +139,60 @@ TEST_SUITE(Foundation_Utility_Zip)
         EXPECT_TRUE(find(files.begin(), files.end(), "subfolder/b.txt") != files.end());
         EXPECT_TRUE(find(files.begin(), files.end(), "c.txt")           != files.end());
     }
+
+    TEST_CASE(ZipArchive_Open_IndexesFileEntriesOnly)
+    {
+        ZipArchive archive;
+        archive.open("unit tests/inputs/test_zip_validzipfile.zip");
+
+        ASSERT_TRUE(archive.is_open());
+        EXPECT_EQ(4, archive.get_entry_names().size());
+        EXPECT_TRUE(archive.has_entry("subfolder/a.txt"));
+        EXPECT_FALSE(archive.has_entry("subfolder/"));
+        EXPECT_EQ(3, archive.get_entry_size("c.txt"));
+    }
+
+    TEST_CASE(ZipArchive_MapEntry_GivenStoredEntry_ReturnsEntryContents)
+    {
+        ZipArchive archive;
+        archive.open("unit tests/inputs/test_zip_validzipfile.zip");
+
+        const void* data = archive.map_entry("subfolder/b.txt");
+
+        ASSERT_NEQ(nullptr, data);
+        EXPECT_EQ(0, memcmp(data, "B\r\n", 3));
+    }
+
+    TEST_CASE(ZipArchive_ReadEntry_GivenDeflatedEntry_ReturnsEntryContents)
+    {
+        const string TargetZip = "unit tests/outputs/test_zip_archive.zip";
+
+        try
+        {
+            ASSERT_FALSE(bf::exists(TargetZip));
+
+            zip(TargetZip, "unit tests/inputs/test_zip");
+
+            ZipArchive archive;
+            archive.open(TargetZip);
+
+            // Text files are deflated, PNG files are stored.
+            EXPECT_EQ(nullptr, archive.map_entry("c.txt"));
+            EXPECT_NEQ(nullptr, archive.map_entry("d.png"));
+
+            vector<char> contents;
+            archive.read_entry("c.txt", contents);
+
+            ASSERT_EQ(3, contents.size());
+            EXPECT_EQ(0, memcmp(&contents[0], "C\r\n", 3));
+
+            archive.close();
+            bf::remove(TargetZip);
+        }
+        catch (const exception& e)
+        {
+            bf::remove(TargetZip);
+            throw e;
+        }
+    }
 }
@@ -30,6 +30,9 @@
 
 // appleseed.foundation headers.
 #include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 #include "foundation/platform/types.h"
 #ifdef _WIN32
 #include "foundation/platform/windows.h"
@@ -73,6 +76,13 @@ void atomic_add(
     volatile float*     ptr,
     const float         operand);
 
+// Add four floats to four consecutive floats aligned on a 16-byte boundary. The four
+// additions happen as a single atomic operation if 128-bit compare-and-swap is available,
+// otherwise each addition is atomic on its own.
+void atomic_add4(
+    volatile float*     ptr,
+    const float         operands[4]);
+
 
 //
 // Implementation.
@@ -137,4 +147,57 @@ APPLESEED_FORCE_INLINE void atomic_add(
     }
 }
 
+APPLESEED_FORCE_INLINE void atomic_add4(
+    volatile float*     ptr,
+    const float         operands[4])
+{
+    assert(is_aligned(ptr, 16));
+
+#if defined APPLESEED_USE_SSE && defined _MSC_VER && defined _M_X64
+
+    volatile __int64* iptr = reinterpret_cast<volatile __int64*>(ptr);
+    const __m128 operand = _mm_loadu_ps(operands);
+
+    M128Fields expected;
+    expected.i64[0] = iptr[0];
+    expected.i64[1] = iptr[1];
+
+    while (true)
+    {
+        M128Fields new_value;
+        new_value.m128 = _mm_add_ps(expected.m128, operand);
+
+        // On failure, the current value is written to expected.i64.
+        if (_InterlockedCompareExchange128(iptr, new_value.i64[1], new_value.i64[0], expected.i64))
+            return;
+    }
+
+#elif defined APPLESEED_USE_SSE && defined __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+
+    typedef unsigned __int128 uint128;
+
+    volatile uint128* iptr = reinterpret_cast<volatile uint128*>(ptr);
+    const __m128 operand = _mm_loadu_ps(operands);
+
+    // This read may be torn, in which case the first compare-and-swap fails.
+    uint128 expected = *iptr;
+
+    while (true)
+    {
+        const __m128 value = _mm_add_ps(binary_cast<__m128>(expected), operand);
+        const uint128 new_value = binary_cast<uint128>(value);
+        const uint128 actual = __sync_val_compare_and_swap(iptr, expected, new_value);
+        if (actual == expected)
+            return;
+        expected = actual;
+    }
+
+#else
+
+    for (size_t i = 0; i < 4; ++i)
+        atomic_add(ptr + i, operands[i]);
+
+#endif
+}
+
 }   // namespace foundation
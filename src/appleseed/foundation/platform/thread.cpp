@@ -44,6 +44,10 @@
 
 // Standard headers.
 #include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
 
 // Platform headers.
 #if defined __APPLE__
@@ -52,6 +56,8 @@
 #include <pthread.h>
 #include <pthread_np.h>
 #elif defined __linux__
+#include <pthread.h>
+#include <sched.h>
 #include <sys/prctl.h>
 #endif
 
@@ -166,6 +172,135 @@ void yield()
     this_thread::yield();
 }
 
+// Windows.
+#if defined _WIN32
+
+    //
+    // Reference:
+    //
+    //   https://docs.microsoft.com/en-us/windows/desktop/procthread/numa-support
+    //
+
+    size_t get_numa_node_count()
+    {
+        ULONG highest_node;
+        if (!GetNumaHighestNodeNumber(&highest_node))
+            return 1;
+
+        return static_cast<size_t>(highest_node) + 1;
+    }
+
+    bool set_current_thread_numa_node(const size_t node)
+    {
+        assert(node < get_numa_node_count());
+
+        GROUP_AFFINITY affinity;
+        if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity))
+            return false;
+
+        // Nodes without processors have an empty mask.
+        if (affinity.Mask == 0)
+            return false;
+
+        return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+    }
+
+// Linux.
+#elif defined __linux__
+
+    namespace
+    {
+        // Parse a list of ranges such as "0-3,8-11" as found in /sys/devices/system/node.
+        bool read_sysfs_list(const char* path, std::vector<size_t>& values)
+        {
+            std::ifstream file(path);
+            std::string line;
+
+            if (!std::getline(file, line))
+                return false;
+
+            const char* p = line.c_str();
+
+            while (*p >= '0' && *p <= '9')
+            {
+                char* end;
+                const size_t first = std::strtoul(p, &end, 10);
+                size_t last = first;
+                p = end;
+
+                if (*p == '-')
+                {
+                    last = std::strtoul(p + 1, &end, 10);
+                    p = end;
+                }
+
+                for (size_t i = first; i <= last; ++i)
+                    values.push_back(i);
+
+                if (*p == ',')
+                    ++p;
+            }
+
+            return !values.empty();
+        }
+
+        // Return the identifiers of the online NUMA nodes; node identifiers are not necessarily contiguous.
+        std::vector<size_t> get_online_numa_nodes()
+        {
+            std::vector<size_t> nodes;
+            read_sysfs_list("/sys/devices/system/node/online", nodes);
+            return nodes;
+        }
+    }
+
+    size_t get_numa_node_count()
+    {
+        const size_t node_count = get_online_numa_nodes().size();
+        return node_count > 0 ? node_count : 1;
+    }
+
+    bool set_current_thread_numa_node(const size_t node)
+    {
+        const std::vector<size_t> nodes = get_online_numa_nodes();
+
+        if (node >= nodes.size())
+            return false;
+
+        const std::string path =
+            "/sys/devices/system/node/node" + std::to_string(nodes[node]) + "/cpulist";
+
+        std::vector<size_t> cpus;
+        if (!read_sysfs_list(path.c_str(), cpus))
+            return false;
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+
+        for (size_t i = 0, e = cpus.size(); i < e; ++i)
+        {
+            if (cpus[i] < CPU_SETSIZE)
+                CPU_SET(cpus[i], &cpu_set);
+        }
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+    }
+
+// Other platforms.
+#else
+
+    size_t get_numa_node_count()
+    {
+        return 1;
+    }
+
+    bool set_current_thread_numa_node(const size_t node)
+    {
+        // Thread affinity is not supported.
+        return false;
+    }
+
+#endif
+
 
 //
 // ProcessPriorityContext class implementation (Windows).
@@ -43,6 +43,9 @@
 #include "boost/thread/mutex.hpp"
 #include "boost/thread/thread.hpp"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class Logger; }
@@ -65,6 +68,15 @@ APPLESEED_DLLSYMBOL void sleep(const uint32 ms, IAbortSwitch& abort_switch);
 // Give up the remainder of the current thread's time slice, to allow other threads to run.
 APPLESEED_DLLSYMBOL void yield();
 
+// Return the number of NUMA nodes of the system.
+// Returns 1 on non-NUMA systems or when the topology cannot be determined.
+APPLESEED_DLLSYMBOL size_t get_numa_node_count();
+
+// Restrict the current thread to the logical processors of a given NUMA node.
+// Memory pages first touched by the thread will then be allocated on that node.
+// The node index must be in [0, get_numa_node_count()). Return true on success.
+APPLESEED_DLLSYMBOL bool set_current_thread_numa_node(const size_t node);
+
 
 //
 // A simple spinlock.
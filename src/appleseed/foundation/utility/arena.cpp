@@ -0,0 +1,167 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "arena.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <algorithm>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// Arena class implementation.
+//
+
+Arena::Arena(const size_t chunk_size)
+  : m_chunk_size(chunk_size)
+  , m_first_chunk(nullptr)
+  , m_current_chunk(nullptr)
+  , m_current(nullptr)
+  , m_end(nullptr)
+{
+    assert(chunk_size > align(sizeof(Chunk), 16));
+}
+
+Arena::~Arena()
+{
+    Chunk* chunk = m_first_chunk;
+
+    while (chunk)
+    {
+        Chunk* next = chunk->m_next;
+        release_chunk(chunk);
+        chunk = next;
+    }
+}
+
+size_t Arena::get_chunk_count() const
+{
+    size_t count = 0;
+
+    for (const Chunk* chunk = m_first_chunk; chunk; chunk = chunk->m_next)
+        ++count;
+
+    return count;
+}
+
+void* Arena::allocate_slow(const size_t size)
+{
+    // Look for room in the chunks kept from before the last clear() or rewind().
+    Chunk* chunk = m_current_chunk ? m_current_chunk->m_next : m_first_chunk;
+    Chunk* last_chunk = m_current_chunk;
+
+    while (chunk && chunk->m_size < size)
+    {
+        last_chunk = chunk;
+        chunk = chunk->m_next;
+    }
+
+    // Append a new chunk if none is large enough.
+    if (chunk == nullptr)
+    {
+        const size_t min_size = m_chunk_size - align(sizeof(Chunk), 16);
+        chunk = acquire_chunk(max(size, min_size));
+
+        if (last_chunk)
+            last_chunk->m_next = chunk;
+        else m_first_chunk = chunk;
+    }
+
+    set_current_chunk(chunk);
+
+    void* ptr = m_current;
+    m_current += size;
+
+    assert(is_aligned(ptr, 16));
+
+    return ptr;
+}
+
+Arena::ChunkPool& Arena::get_chunk_pool()
+{
+    // Chunks left in the pool when a thread exits are only reclaimed at process exit;
+    // the pool is bounded to keep this overhead small.
+    static APPLESEED_TLS ChunkPool pool;
+    return pool;
+}
+
+Arena::Chunk* Arena::acquire_chunk(const size_t size)
+{
+    ChunkPool& pool = get_chunk_pool();
+
+    // Reuse a pooled chunk if one is large enough.
+    for (Chunk** link = &pool.m_head; *link; link = &(*link)->m_next)
+    {
+        Chunk* chunk = *link;
+
+        if (chunk->m_size >= size)
+        {
+            *link = chunk->m_next;
+            --pool.m_count;
+
+            chunk->m_next = nullptr;
+            return chunk;
+        }
+    }
+
+    // Otherwise allocate a new chunk.
+    void* ptr = aligned_malloc(align(sizeof(Chunk), 16) + size, 16);
+
+    if (ptr == nullptr)
+        throw bad_alloc();
+
+    Chunk* chunk = static_cast<Chunk*>(ptr);
+    chunk->m_next = nullptr;
+    chunk->m_size = size;
+
+    return chunk;
+}
+
+void Arena::release_chunk(Chunk* chunk)
+{
+    ChunkPool& pool = get_chunk_pool();
+
+    // Only keep chunks of the default size around, and not too many of them.
+    if (pool.m_count < MaxPooledChunkCount &&
+        chunk->m_size <= DefaultChunkSize - align(sizeof(Chunk), 16))
+    {
+        chunk->m_next = pool.m_head;
+        pool.m_head = chunk;
+        ++pool.m_count;
+    }
+    else aligned_free(chunk);
+}
+
+}   // namespace foundation
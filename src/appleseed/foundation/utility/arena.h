@@ -30,14 +30,14 @@
 #pragma once
 
 // appleseed.foundation headers.
-#include "foundation/core/exceptions/exception.h"
-#include "foundation/platform/compiler.h"
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/memory.h"
 
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <new>
 
 namespace foundation
 {
@@ -45,27 +45,100 @@ namespace foundation
 //
 // An arena is a temporary heap providing extremely cheap memory allocation.
 //
+// Memory is carved out of a linked list of chunks that grows on demand, so the
+// arena never runs out of memory. Chunks are kept when the arena is cleared or
+// rewound, and returned to a small per-thread pool when the arena is destructed
+// so that short-lived arenas don't hit the heap either.
+//
 
 class Arena
+  : public NonCopyable
 {
+  private:
+    struct Chunk;
+
   public:
-    Arena();
+    enum { DefaultChunkSize = 64 * 1024 };      // bytes, including the chunk header
+
+    // A position in the arena, allowing to release at once all the memory allocated after it.
+    struct Marker
+    {
+        Chunk*  m_chunk;
+        uint8*  m_current;
+    };
+
+    // Constructor. No memory is allocated until the first allocation.
+    explicit Arena(const size_t chunk_size = DefaultChunkSize);
+
+    // Destructor.
+    ~Arena();
 
+    // Release all allocations. Chunks are kept for subsequent allocations.
     void clear();
 
+    // Retrieve the current position in the arena.
+    Marker get_marker() const;
+
+    // Release all allocations made since a given position was retrieved.
+    void rewind(const Marker& marker);
+
+    // Allocate a 16-byte aligned block of memory.
     void* allocate(const size_t size);
 
     template <typename T> T* allocate();
     template <typename T> T* allocate_noinit();
 
-    const uint8* get_storage() const;
+    // Return the number of chunks currently owned by the arena.
+    size_t get_chunk_count() const;
 
   private:
-    enum { ArenaSize = 384 * 1024 };    // bytes
+    enum { MaxPooledChunkCount = 16 };
+
+    struct Chunk
+    {
+        Chunk*  m_next;
+        size_t  m_size;                         // usable bytes, excluding the chunk header
+
+        uint8* begin();
+        uint8* end();
+    };
+
+    struct ChunkPool
+    {
+        Chunk*  m_head;
+        size_t  m_count;
+    };
+
+    const size_t    m_chunk_size;
+    Chunk*          m_first_chunk;
+    Chunk*          m_current_chunk;
+    uint8*          m_current;
+    uint8*          m_end;
+
+    void* allocate_slow(const size_t size);
+
+    void set_current_chunk(Chunk* chunk);
+
+    static ChunkPool& get_chunk_pool();
+    static Chunk* acquire_chunk(const size_t size);
+    static void release_chunk(Chunk* chunk);
+};
+
+
+//
+// Make all allocations made from an arena during the lifetime of the scope temporary.
+//
+
+class ArenaScope
+  : public NonCopyable
+{
+  public:
+    explicit ArenaScope(Arena& arena);
+    ~ArenaScope();
 
-    APPLESEED_SIMD4_ALIGN uint8 m_storage[ArenaSize];
-    const uint8*                m_end;
-    uint8*                      m_current;
+  private:
+    Arena&                  m_arena;
+    const Arena::Marker     m_marker;
 };
 
 
@@ -73,24 +146,38 @@ class Arena
 // Arena class implementation.
 //
 
-inline Arena::Arena()
-  : m_end(m_storage + ArenaSize)
-  , m_current(m_storage)
+inline void Arena::clear()
 {
+    set_current_chunk(m_first_chunk);
 }
 
-inline void Arena::clear()
+inline Arena::Marker Arena::get_marker() const
+{
+    const Marker marker = { m_current_chunk, m_current };
+    return marker;
+}
+
+inline void Arena::rewind(const Marker& marker)
 {
-    m_current = m_storage;
+    if (marker.m_chunk == nullptr)
+        clear();
+    else
+    {
+        m_current_chunk = marker.m_chunk;
+        m_current = marker.m_current;
+        m_end = marker.m_chunk->end();
+    }
 }
 
 inline void* Arena::allocate(const size_t size)
 {
-    if (m_current + size > m_end)
-        throw Exception("out of arena memory");
+    const size_t aligned_size = align(size, 16);
+
+    if (m_current == nullptr || aligned_size > static_cast<size_t>(m_end - m_current))
+        return allocate_slow(aligned_size);
 
     void* ptr = m_current;
-    m_current += align(size, 16);
+    m_current += aligned_size;
 
     assert(is_aligned(ptr, 16));
 
@@ -113,9 +200,42 @@ inline T* Arena::allocate_noinit()
     return static_cast<T*>(allocate(sizeof(T)));
 }
 
-inline const uint8* Arena::get_storage() const
+inline void Arena::set_current_chunk(Chunk* chunk)
+{
+    m_current_chunk = chunk;
+
+    if (chunk)
+    {
+        m_current = chunk->begin();
+        m_end = chunk->end();
+    }
+    else m_current = m_end = nullptr;
+}
+
+inline uint8* Arena::Chunk::begin()
+{
+    return reinterpret_cast<uint8*>(this) + align(sizeof(Chunk), 16);
+}
+
+inline uint8* Arena::Chunk::end()
+{
+    return begin() + m_size;
+}
+
+
+//
+// ArenaScope class implementation.
+//
+
+inline ArenaScope::ArenaScope(Arena& arena)
+  : m_arena(arena)
+  , m_marker(arena.get_marker())
+{
+}
+
+inline ArenaScope::~ArenaScope()
 {
-    return m_storage;
+    m_arena.rewind(m_marker);
 }
 
 }   // namespace foundation
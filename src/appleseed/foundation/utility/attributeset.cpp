@@ -74,6 +74,20 @@ void AttributeSet::delete_channel(const ChannelID channel_id)
     m_channels.erase(m_channels.begin() + channel_id);
 }
 
+void AttributeSet::copy_from(const AttributeSet& source)
+{
+    if (&source == this)
+        return;
+
+    for (size_t i = 0; i < m_channels.size(); ++i)
+        delete m_channels[i];
+
+    m_channels.resize(source.m_channels.size());
+
+    for (size_t i = 0; i < m_channels.size(); ++i)
+        m_channels[i] = new Channel(*source.m_channels[i]);
+}
+
 AttributeSet::ChannelID AttributeSet::find_channel(const char* name) const
 {
     assert(name);
@@ -89,4 +103,15 @@ AttributeSet::ChannelID AttributeSet::find_channel(const char* name) const
     return InvalidChannelID;
 }
 
+size_t AttributeSet::get_memory_size() const
+{
+    size_t mem_size = sizeof(*this);
+    mem_size += m_channels.capacity() * sizeof(Channel*);
+
+    for (size_t i = 0; i < m_channels.size(); ++i)
+        mem_size += sizeof(Channel) + m_channels[i]->m_storage.capacity();
+
+    return mem_size;
+}
+
 }   // namespace foundation
@@ -67,6 +67,10 @@ class AttributeSet
     // Delete an existing channel.
     void delete_channel(const ChannelID channel_id);
 
+    // Replace all channels by copies of the channels of another attribute set.
+    // Channel IDs of the source attribute set remain valid in this one.
+    void copy_from(const AttributeSet& source);
+
     // Find a given attribute channel. Return InvalidChannelID if
     // the requested channel does not exist. Since this method is
     // typically called with a literal value in argument ("uv"),
@@ -82,6 +86,9 @@ class AttributeSet
         const ChannelID     channel_id,
         const size_t        count);
 
+    // Remove all attributes of a given attribute channel and release their memory.
+    void clear_attributes(const ChannelID channel_id);
+
     // Insert a new attribute at the end of a given attribute channel.
     // Return the index of the attribute in the attribute channel.
     template <typename T>
@@ -103,6 +110,9 @@ class AttributeSet
         const size_t        index,
         T*                  value) const;
 
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
   private:
     struct Channel
     {
@@ -142,6 +152,16 @@ inline void AttributeSet::reserve_attributes(
     channel->m_storage.reserve(count * channel->m_value_size);
 }
 
+inline void AttributeSet::clear_attributes(const ChannelID channel_id)
+{
+    // Get the channel descriptor.
+    assert(channel_id < m_channels.size());
+    Channel* channel = m_channels[channel_id];
+
+    // Release memory.
+    clear_release_memory(channel->m_storage);
+}
+
 template <typename T>
 inline size_t AttributeSet::push_attribute(
     const ChannelID         channel_id,
@@ -43,3 +43,4 @@
 #include "foundation/utility/benchmark/loggerbenchmarklistener.h"
 #include "foundation/utility/benchmark/timingresult.h"
 #include "foundation/utility/benchmark/xmlfilebenchmarklistener.h"
+#include "foundation/utility/benchmark/xmlfilebenchmarkreader.h"
@@ -264,6 +264,20 @@ void BenchmarkSuite::run(
             timing_result.m_frequency = static_cast<double>(stopwatch.get_timer().frequency());
             timing_result.m_ticks = runtime_ticks > overhead_ticks ? runtime_ticks - overhead_ticks : 0.0;
 
+            // Collect individual measurements to allow estimating the variability of the running time.
+            const size_t SampleCount = 100;
+            timing_result.m_samples.reserve(SampleCount);
+            for (size_t j = 0; j < SampleCount; ++j)
+            {
+                const double ticks =
+                    Impl::measure_runtime(
+                        benchmark.get(),
+                        stopwatch,
+                        BenchmarkSuite::Impl::measure_runtime_ticks,
+                        max<size_t>(1, measurement_count / SampleCount));
+                timing_result.m_samples.push_back(ticks > overhead_ticks ? ticks - overhead_ticks : 0.0);
+            }
+
             // Post the timing result.
             suite_result.write(
                 *this,
@@ -275,19 +289,8 @@ void BenchmarkSuite::run(
 #ifdef GENERATE_BENCHMARK_PLOTS
             vector<Vector2d> points;
 
-            const size_t PointCount = 100;
-            for (size_t j = 0; j < PointCount; ++j)
-            {
-                const double ticks =
-                    Impl::measure_runtime(
-                        benchmark.get(),
-                        stopwatch,
-                        BenchmarkSuite::Impl::measure_runtime_ticks,
-                        max<size_t>(1, measurement_count / PointCount));
-                points.emplace_back(
-                    static_cast<double>(j),
-                    ticks > overhead_ticks ? ticks - overhead_ticks : 0.0);
-            }
+            for (size_t j = 0; j < timing_result.m_samples.size(); ++j)
+                points.emplace_back(static_cast<double>(j), timing_result.m_samples[j]);
 
             const string filepath =
                 format("unit benchmarks/plots/{0}_{1}.gnuplot", get_name(), benchmark->get_name());
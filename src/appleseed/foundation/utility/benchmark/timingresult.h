@@ -31,6 +31,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <vector>
 
 namespace foundation
 {
@@ -46,6 +47,8 @@ class TimingResult
     size_t  m_measurement_count;    // number of measurements per benchmark case
     double  m_frequency;            // frequency of the timer used for the measurement
     double  m_ticks;                // average running time, in timer ticks
+
+    std::vector<double> m_samples;  // individual measurements of the running time, in timer ticks
 };
 
 }   // namespace foundation
@@ -182,6 +182,16 @@ void XMLFileBenchmarkListener::write(
         impl->m_indenter.c_str(),
         timing_result.m_ticks);
 
+    if (!timing_result.m_samples.empty())
+    {
+        fprintf(impl->m_file, "%s<samples>", impl->m_indenter.c_str());
+
+        for (size_t i = 0; i < timing_result.m_samples.size(); ++i)
+            fprintf(impl->m_file, i > 0 ? " %f" : "%f", timing_result.m_samples[i]);
+
+        fprintf(impl->m_file, "</samples>\n");
+    }
+
     --impl->m_indenter;
 
     fprintf(impl->m_file, "%s</results>\n", impl->m_indenter.c_str());
@@ -0,0 +1,282 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "xmlfilebenchmarkreader.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/benchmark/timingresult.h"
+#include "foundation/utility/string.h"
+#include "foundation/utility/xercesc.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+
+// Xerces-C++ headers.
+#include "xercesc/dom/DOM.hpp"
+#include "xercesc/parsers/XercesDOMParser.hpp"
+#include "xercesc/util/XMLException.hpp"
+
+// Standard headers.
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace xercesc;
+namespace bf = boost::filesystem;
+
+namespace foundation
+{
+
+//
+// XMLFileBenchmarkReader class implementation.
+//
+
+namespace
+{
+    string get_name_attribute(const DOMNode* node)
+    {
+        const DOMNamedNodeMap* attributes = node->getAttributes();
+        const DOMNode* name_attribute = attributes->getNamedItem(transcode("name").c_str());
+        return name_attribute ? transcode(name_attribute->getNodeValue()) : string();
+    }
+
+    bool is_element(const DOMNode* node, const char* name)
+    {
+        return
+            node->getNodeType() == DOMNode::ELEMENT_NODE &&
+            transcode(node->getNodeName()) == name;
+    }
+}
+
+struct XMLFileBenchmarkReader::Impl
+{
+    struct BenchmarkCase
+    {
+        string          m_suite_name;
+        string          m_case_name;
+        TimingResult    m_timing_result;
+    };
+
+    XercesCContext          m_xerces_context;
+    XercesDOMParser         m_xerces_parser;
+
+    string                  m_configuration;
+    vector<BenchmarkCase>   m_cases;
+
+    Impl()
+    {
+        m_xerces_parser.setCreateCommentNodes(false);
+    }
+
+    bool scan_document(const DOMDocument* document)
+    {
+        assert(document);
+
+        const DOMElement* root = document->getDocumentElement();
+
+        if (!root || transcode(root->getNodeName()) != "benchmarkexecution")
+            return false;
+
+        const DOMNode* config_attribute =
+            root->getAttributes()->getNamedItem(transcode("configuration").c_str());
+
+        if (config_attribute)
+            m_configuration = transcode(config_attribute->getNodeValue());
+
+        for (const DOMNode* suite = root->getFirstChild(); suite; suite = suite->getNextSibling())
+        {
+            if (!is_element(suite, "benchmarksuite"))
+                continue;
+
+            const string suite_name = get_name_attribute(suite);
+
+            for (const DOMNode* c = suite->getFirstChild(); c; c = c->getNextSibling())
+            {
+                if (!is_element(c, "benchmarkcase"))
+                    continue;
+
+                BenchmarkCase benchmark_case;
+                benchmark_case.m_suite_name = suite_name;
+                benchmark_case.m_case_name = get_name_attribute(c);
+
+                // Benchmark cases that failed don't have results.
+                if (scan_case(c, benchmark_case.m_timing_result))
+                    m_cases.push_back(benchmark_case);
+            }
+        }
+
+        return true;
+    }
+
+    static bool scan_case(const DOMNode* node, TimingResult& timing_result)
+    {
+        for (const DOMNode* results = node->getFirstChild(); results; results = results->getNextSibling())
+        {
+            if (!is_element(results, "results"))
+                continue;
+
+            timing_result.m_iteration_count = 0;
+            timing_result.m_measurement_count = 0;
+            timing_result.m_frequency = 0.0;
+            timing_result.m_ticks = 0.0;
+
+            bool has_ticks = false;
+
+            for (const DOMNode* child = results->getFirstChild(); child; child = child->getNextSibling())
+            {
+                if (child->getNodeType() != DOMNode::ELEMENT_NODE)
+                    continue;
+
+                const string name = transcode(child->getNodeName());
+                const string text = trim_both(transcode(child->getTextContent()));
+
+                try
+                {
+                    if (name == "iterations")
+                        timing_result.m_iteration_count = from_string<size_t>(text);
+                    else if (name == "measurements")
+                        timing_result.m_measurement_count = from_string<size_t>(text);
+                    else if (name == "frequency")
+                        timing_result.m_frequency = from_string<double>(text);
+                    else if (name == "ticks")
+                    {
+                        timing_result.m_ticks = from_string<double>(text);
+                        has_ticks = true;
+                    }
+                    else if (name == "samples")
+                    {
+                        vector<string> tokens;
+                        tokenize(text, Blanks, tokens);
+
+                        for (size_t i = 0; i < tokens.size(); ++i)
+                            timing_result.m_samples.push_back(from_string<double>(tokens[i]));
+                    }
+                }
+                catch (const ExceptionStringConversionError&)
+                {
+                    return false;
+                }
+            }
+
+            return has_ticks && timing_result.m_frequency > 0.0;
+        }
+
+        return false;
+    }
+};
+
+XMLFileBenchmarkReader::XMLFileBenchmarkReader()
+  : impl(new Impl())
+{
+}
+
+XMLFileBenchmarkReader::~XMLFileBenchmarkReader()
+{
+    delete impl;
+}
+
+bool XMLFileBenchmarkReader::read(const char* path)
+{
+    assert(path);
+
+    impl->m_configuration.clear();
+    impl->m_cases.clear();
+
+    if (!impl->m_xerces_context.is_initialized())
+        return false;
+
+    if (!bf::is_regular_file(path))
+        return false;
+
+    try
+    {
+        impl->m_xerces_parser.parse(path);
+    }
+    catch (const XMLException&)
+    {
+        return false;
+    }
+    catch (const DOMException&)
+    {
+        return false;
+    }
+
+    const DOMDocument* document = impl->m_xerces_parser.getDocument();
+
+    if (!document)
+        return false;
+
+    return impl->scan_document(document);
+}
+
+const char* XMLFileBenchmarkReader::get_configuration() const
+{
+    return impl->m_configuration.c_str();
+}
+
+size_t XMLFileBenchmarkReader::get_case_count() const
+{
+    return impl->m_cases.size();
+}
+
+const char* XMLFileBenchmarkReader::get_suite_name(const size_t case_index) const
+{
+    assert(case_index < impl->m_cases.size());
+    return impl->m_cases[case_index].m_suite_name.c_str();
+}
+
+const char* XMLFileBenchmarkReader::get_case_name(const size_t case_index) const
+{
+    assert(case_index < impl->m_cases.size());
+    return impl->m_cases[case_index].m_case_name.c_str();
+}
+
+const TimingResult& XMLFileBenchmarkReader::get_timing_result(const size_t case_index) const
+{
+    assert(case_index < impl->m_cases.size());
+    return impl->m_cases[case_index].m_timing_result;
+}
+
+size_t XMLFileBenchmarkReader::find_case(const char* suite_name, const char* case_name) const
+{
+    assert(suite_name);
+    assert(case_name);
+
+    for (size_t i = 0; i < impl->m_cases.size(); ++i)
+    {
+        if (impl->m_cases[i].m_suite_name == suite_name &&
+            impl->m_cases[i].m_case_name == case_name)
+            return i;
+    }
+
+    return ~size_t(0);
+}
+
+}   // namespace foundation
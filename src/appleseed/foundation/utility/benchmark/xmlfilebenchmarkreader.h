@@ -0,0 +1,87 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class TimingResult; }
+
+namespace foundation
+{
+
+//
+// Read back the benchmark results written by XMLFileBenchmarkListener.
+//
+
+class APPLESEED_DLLSYMBOL XMLFileBenchmarkReader
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    XMLFileBenchmarkReader();
+
+    // Destructor.
+    ~XMLFileBenchmarkReader();
+
+    // Read a benchmark results file, replacing previously read results.
+    // Returns false if the file could not be read.
+    bool read(const char* path);
+
+    // Return the configuration (e.g. Release) of the build that produced the results.
+    const char* get_configuration() const;
+
+    // Return the number of benchmark cases.
+    size_t get_case_count() const;
+
+    // Return the name of the suite of a given benchmark case.
+    const char* get_suite_name(const size_t case_index) const;
+
+    // Return the name of a given benchmark case.
+    const char* get_case_name(const size_t case_index) const;
+
+    // Return the timing result of a given benchmark case.
+    const TimingResult& get_timing_result(const size_t case_index) const;
+
+    // Return the index of a benchmark case, or ~size_t(0) if there is no such case.
+    size_t find_case(const char* suite_name, const char* case_name) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}   // namespace foundation
@@ -0,0 +1,496 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "binaryxml.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/memorymappedfile.h"
+#include "foundation/utility/xercesc.h"
+
+// Xerces-C++ headers.
+#include "xercesc/sax2/Attributes.hpp"
+#include "xercesc/sax2/SAX2XMLReader.hpp"
+#include "xercesc/sax2/XMLReaderFactory.hpp"
+#include "xercesc/util/XMLException.hpp"
+#include "xercesc/util/XMLUni.hpp"
+
+// Standard headers.
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+using namespace std;
+using namespace xercesc;
+
+namespace foundation
+{
+
+namespace
+{
+    const char Magic[4] = { 'A', 'S', 'B', 'X' };
+    const uint32 FormatVersion = 1;
+    const size_t HeaderSize = 4 * sizeof(uint32);
+
+    enum EventType
+    {
+        StartElementEvent = 1,
+        EndElementEvent,
+        CharactersEvent
+    };
+
+    bool is_whitespace(const basic_string<XMLCh>& s)
+    {
+        for (const XMLCh c : s)
+        {
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+                return false;
+        }
+
+        return true;
+    }
+
+    template <typename T>
+    bool write_value(FILE* file, const T& value)
+    {
+        return fwrite(&value, sizeof(T), 1, file) == 1;
+    }
+
+    //
+    // Attributes of the current element, referencing the transcoded string table.
+    //
+
+    class AttributeList
+      : public Attributes
+    {
+      public:
+        explicit AttributeList(const vector<basic_string<XMLCh>>& strings)
+          : m_strings(strings)
+        {
+        }
+
+        void clear()
+        {
+            m_attributes.clear();
+        }
+
+        void push_back(const uint32 name, const uint32 value)
+        {
+            m_attributes.emplace_back(name, value);
+        }
+
+        XMLSize_t getLength() const override
+        {
+            return m_attributes.size();
+        }
+
+        const XMLCh* getURI(const XMLSize_t index) const override
+        {
+            return index < m_attributes.size() ? XMLUni::fgZeroLenString : nullptr;
+        }
+
+        const XMLCh* getLocalName(const XMLSize_t index) const override
+        {
+            return index < m_attributes.size() ? m_strings[m_attributes[index].first].c_str() : nullptr;
+        }
+
+        const XMLCh* getQName(const XMLSize_t index) const override
+        {
+            return getLocalName(index);
+        }
+
+        const XMLCh* getType(const XMLSize_t index) const override
+        {
+            return index < m_attributes.size() ? XMLUni::fgCDATAString : nullptr;
+        }
+
+        const XMLCh* getValue(const XMLSize_t index) const override
+        {
+            return index < m_attributes.size() ? m_strings[m_attributes[index].second].c_str() : nullptr;
+        }
+
+        bool getIndex(const XMLCh* const uri, const XMLCh* const local_part, XMLSize_t& index) const override
+        {
+            return getIndex(local_part, index);
+        }
+
+        int getIndex(const XMLCh* const uri, const XMLCh* const local_part) const override
+        {
+            return getIndex(local_part);
+        }
+
+        bool getIndex(const XMLCh* const qname, XMLSize_t& index) const override
+        {
+            for (size_t i = 0, e = m_attributes.size(); i < e; ++i)
+            {
+                if (XMLString::equals(m_strings[m_attributes[i].first].c_str(), qname))
+                {
+                    index = i;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        int getIndex(const XMLCh* const qname) const override
+        {
+            XMLSize_t index;
+            return getIndex(qname, index) ? static_cast<int>(index) : -1;
+        }
+
+        const XMLCh* getType(const XMLCh* const uri, const XMLCh* const local_part) const override
+        {
+            return getType(local_part);
+        }
+
+        const XMLCh* getType(const XMLCh* const qname) const override
+        {
+            XMLSize_t index;
+            return getIndex(qname, index) ? XMLUni::fgCDATAString : nullptr;
+        }
+
+        const XMLCh* getValue(const XMLCh* const uri, const XMLCh* const local_part) const override
+        {
+            return getValue(local_part);
+        }
+
+        const XMLCh* getValue(const XMLCh* const qname) const override
+        {
+            XMLSize_t index;
+            return getIndex(qname, index) ? getValue(index) : nullptr;
+        }
+
+      private:
+        const vector<basic_string<XMLCh>>&  m_strings;
+        vector<pair<uint32, uint32>>        m_attributes;
+    };
+}
+
+
+//
+// BinaryXMLWriter class implementation.
+//
+
+bool BinaryXMLWriter::write(const char* filepath)
+{
+    flush_characters();
+
+    FILE* file = fopen(filepath, "wb");
+    if (file == nullptr)
+        return false;
+
+    // Compute the offsets of the strings.
+    vector<uint32> offsets;
+    offsets.reserve(m_strings.size());
+
+    uint32 string_data_size = 0;
+    for (const string& s : m_strings)
+    {
+        offsets.push_back(string_data_size);
+        string_data_size += static_cast<uint32>(s.size() + 1);
+    }
+
+    const uint32 padding = (4 - string_data_size % 4) % 4;
+    const uint32 zeros = 0;
+
+    bool success =
+        fwrite(Magic, sizeof(Magic), 1, file) == 1 &&
+        write_value(file, FormatVersion) &&
+        write_value(file, static_cast<uint32>(m_strings.size())) &&
+        write_value(file, string_data_size);
+
+    if (success && !offsets.empty())
+        success = fwrite(offsets.data(), sizeof(uint32), offsets.size(), file) == offsets.size();
+
+    for (size_t i = 0, e = m_strings.size(); success && i < e; ++i)
+        success = fwrite(m_strings[i].c_str(), m_strings[i].size() + 1, 1, file) == 1;
+
+    if (success && padding > 0)
+        success = fwrite(&zeros, padding, 1, file) == 1;
+
+    if (success && !m_events.empty())
+        success = fwrite(m_events.data(), sizeof(uint32), m_events.size(), file) == m_events.size();
+
+    return fclose(file) == 0 && success;
+}
+
+void BinaryXMLWriter::startElement(
+    const XMLCh* const                          uri,
+    const XMLCh* const                          localname,
+    const XMLCh* const                          qname,
+    const Attributes&                           attrs)
+{
+    flush_characters();
+
+    const XMLSize_t attribute_count = attrs.getLength();
+
+    m_events.push_back(StartElementEvent);
+    m_events.push_back(intern(transcode(localname)));
+    m_events.push_back(static_cast<uint32>(attribute_count));
+
+    for (XMLSize_t i = 0; i < attribute_count; ++i)
+    {
+        m_events.push_back(intern(transcode(attrs.getLocalName(i))));
+        m_events.push_back(intern(transcode(attrs.getValue(i))));
+    }
+}
+
+void BinaryXMLWriter::endElement(
+    const XMLCh* const                          uri,
+    const XMLCh* const                          localname,
+    const XMLCh* const                          qname)
+{
+    flush_characters();
+
+    m_events.push_back(EndElementEvent);
+}
+
+void BinaryXMLWriter::characters(
+    const XMLCh* const                          chars,
+    const XMLSize_t                             length)
+{
+    m_pending_chars.append(chars, length);
+}
+
+uint32 BinaryXMLWriter::intern(const string& s)
+{
+    const auto it = m_string_indices.find(s);
+    if (it != m_string_indices.end())
+        return it->second;
+
+    const uint32 index = static_cast<uint32>(m_strings.size());
+    m_strings.push_back(s);
+    m_string_indices.insert(make_pair(s, index));
+
+    return index;
+}
+
+void BinaryXMLWriter::flush_characters()
+{
+    if (!is_whitespace(m_pending_chars))
+    {
+        m_events.push_back(CharactersEvent);
+        m_events.push_back(intern(transcode(m_pending_chars.c_str())));
+    }
+
+    m_pending_chars.clear();
+}
+
+
+//
+// BinaryXMLReader class implementation.
+//
+
+bool BinaryXMLReader::is_binary_xml_file(const char* filepath)
+{
+    FILE* file = fopen(filepath, "rb");
+    if (file == nullptr)
+        return false;
+
+    char magic[sizeof(Magic)];
+    const bool success = fread(magic, sizeof(magic), 1, file) == 1;
+
+    fclose(file);
+
+    return success && memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+bool BinaryXMLReader::is_binary_xml_data(
+    const void*                                 data,
+    const size_t                                size)
+{
+    return size >= sizeof(Magic) && memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+bool BinaryXMLReader::parse(
+    const char*                                 filepath,
+    ContentHandler&                             handler) const
+{
+    MemoryMappedFile file;
+    if (!file.open(filepath))
+        return false;
+
+    return parse(file.data(), file.size(), handler);
+}
+
+bool BinaryXMLReader::parse(
+    const void*                                 data,
+    const size_t                                size,
+    ContentHandler&                             handler) const
+{
+    if (size < HeaderSize)
+        return false;
+
+    const uint8* bytes = static_cast<const uint8*>(data);
+    const uint32* header = reinterpret_cast<const uint32*>(bytes);
+
+    if (memcmp(bytes, Magic, sizeof(Magic)) != 0 || header[1] != FormatVersion)
+        return false;
+
+    const size_t string_count = header[2];
+    const size_t string_data_size = header[3];
+    const size_t string_data_begin = HeaderSize + string_count * sizeof(uint32);
+    const size_t events_begin = string_data_begin + (string_data_size + 3) / 4 * 4;
+
+    if (events_begin > size)
+        return false;
+
+    // Transcode every string once.
+    const uint32* offsets = header + 4;
+    const char* string_data = reinterpret_cast<const char*>(bytes + string_data_begin);
+
+    vector<basic_string<XMLCh>> strings(string_count);
+    for (size_t i = 0; i < string_count; ++i)
+    {
+        const size_t offset = offsets[i];
+        if (offset >= string_data_size ||
+            memchr(string_data + offset, '\0', string_data_size - offset) == nullptr)
+            return false;
+
+        strings[i] = transcode(string_data + offset);
+    }
+
+    // Replay the events.
+    const uint32* ptr = reinterpret_cast<const uint32*>(bytes + events_begin);
+    const uint32* end = ptr + (size - events_begin) / sizeof(uint32);
+
+    AttributeList attributes(strings);
+    vector<uint32> open_elements;
+
+    handler.startDocument();
+
+    while (ptr < end)
+    {
+        switch (*ptr++)
+        {
+          case StartElementEvent:
+            {
+                if (end - ptr < 2 || ptr[0] >= string_count)
+                    return false;
+
+                const uint32 name = ptr[0];
+                const uint32 attribute_count = ptr[1];
+                ptr += 2;
+
+                if (static_cast<size_t>(end - ptr) < 2 * static_cast<size_t>(attribute_count))
+                    return false;
+
+                attributes.clear();
+
+                for (uint32 i = 0; i < attribute_count; ++i, ptr += 2)
+                {
+                    if (ptr[0] >= string_count || ptr[1] >= string_count)
+                        return false;
+
+                    attributes.push_back(ptr[0], ptr[1]);
+                }
+
+                const XMLCh* name_str = strings[name].c_str();
+                handler.startElement(XMLUni::fgZeroLenString, name_str, name_str, attributes);
+
+                open_elements.push_back(name);
+            }
+            break;
+
+          case EndElementEvent:
+            {
+                if (open_elements.empty())
+                    return false;
+
+                const XMLCh* name_str = strings[open_elements.back()].c_str();
+                handler.endElement(XMLUni::fgZeroLenString, name_str, name_str);
+
+                open_elements.pop_back();
+            }
+            break;
+
+          case CharactersEvent:
+            {
+                if (ptr == end || ptr[0] >= string_count)
+                    return false;
+
+                const basic_string<XMLCh>& chars = strings[*ptr++];
+                handler.characters(chars.c_str(), chars.size());
+            }
+            break;
+
+          default:
+            return false;
+        }
+    }
+
+    if (!open_elements.empty())
+        return false;
+
+    handler.endDocument();
+
+    return true;
+}
+
+
+//
+// convert_xml_file_to_binary_xml_file() function implementation.
+//
+
+bool convert_xml_file_to_binary_xml_file(
+    Logger&                                     logger,
+    const char*                                 input_filepath,
+    const char*                                 output_filepath)
+{
+    BinaryXMLWriter writer;
+    ErrorLogger error_handler(logger, input_filepath);
+
+    unique_ptr<SAX2XMLReader> parser(XMLReaderFactory::createXMLReader());
+    parser->setFeature(XMLUni::fgSAX2CoreNameSpaces, true);
+    parser->setFeature(XMLUni::fgSAX2CoreValidation, false);
+    parser->setFeature(XMLUni::fgXercesSchema, false);
+    parser->setErrorHandler(&error_handler);
+    parser->setContentHandler(&writer);
+
+    try
+    {
+        parser->parse(input_filepath);
+    }
+    catch (const XMLException&)
+    {
+        return false;
+    }
+    catch (const SAXParseException&)
+    {
+        return false;
+    }
+
+    if (error_handler.get_error_count() > 0 ||
+        error_handler.get_fatal_error_count() > 0)
+        return false;
+
+    return writer.write(output_filepath);
+}
+
+}   // namespace foundation
@@ -0,0 +1,151 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// Xerces-C++ headers.
+#include "xercesc/sax2/ContentHandler.hpp"
+#include "xercesc/sax2/DefaultHandler.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class Logger; }
+
+namespace foundation
+{
+
+//
+// Binary XML files store the SAX event stream of a XML document (element starts, element
+// ends and character data) in a compact form that is replayed without any XML parsing.
+//
+// Every distinct string (element and attribute names, attribute values, character data)
+// is stored once, null-terminated, in a string table. Character data consisting only of
+// whitespace is dropped. The file is read through a memory mapping.
+//
+// File layout (32-bit unsigned integers in native byte order):
+//
+//   magic number "ASBX", format version, string count, string data size in bytes
+//   string count offsets into the string data
+//   string data, padded to a multiple of 4 bytes
+//   events until the end of the file:
+//     StartElement name attribute-count (attribute-name attribute-value)*
+//     EndElement
+//     Characters string
+//
+
+//
+// A SAX2 content handler that records the events of a XML document in binary XML form.
+//
+
+class BinaryXMLWriter
+  : public xercesc::DefaultHandler
+  , public NonCopyable
+{
+  public:
+    // Write the recorded events to a binary XML file.
+    // Returns true on success, false otherwise.
+    bool write(const char* filepath);
+
+    // Receive notification of the start of an element.
+    void startElement(
+        const XMLCh* const                          uri,
+        const XMLCh* const                          localname,
+        const XMLCh* const                          qname,
+        const xercesc::Attributes&                  attrs) override;
+
+    // Receive notification of the end of an element.
+    void endElement(
+        const XMLCh* const                          uri,
+        const XMLCh* const                          localname,
+        const XMLCh* const                          qname) override;
+
+    // Receive notification of character data inside an element.
+    void characters(
+        const XMLCh* const                          chars,
+        const XMLSize_t                             length) override;
+
+  private:
+    std::vector<std::string>                        m_strings;
+    std::unordered_map<std::string, uint32>         m_string_indices;
+    std::vector<uint32>                             m_events;
+    std::basic_string<XMLCh>                        m_pending_chars;
+
+    uint32 intern(const std::string& s);
+    void flush_characters();
+};
+
+
+//
+// Replay the events of a binary XML file into a SAX2 content handler.
+//
+
+class BinaryXMLReader
+  : public NonCopyable
+{
+  public:
+    // Return true if a given file is a binary XML file.
+    static bool is_binary_xml_file(const char* filepath);
+
+    // Return true if a given memory block holds a binary XML file.
+    static bool is_binary_xml_data(
+        const void*                                 data,
+        const size_t                                size);
+
+    // Xerces-C++ must be initialized. Returns false if the file cannot be read or is malformed.
+    bool parse(
+        const char*                                 filepath,
+        xercesc::ContentHandler&                    handler) const;
+
+    // Same as above, but read the binary XML file from a memory block aligned on 4 bytes.
+    bool parse(
+        const void*                                 data,
+        const size_t                                size,
+        xercesc::ContentHandler&                    handler) const;
+};
+
+
+//
+// Convert a XML file to a binary XML file, without validation.
+// Xerces-C++ must be initialized. Returns true on success, false otherwise.
+//
+
+bool convert_xml_file_to_binary_xml_file(
+    Logger&                                         logger,
+    const char*                                     input_filepath,
+    const char*                                     output_filepath);
+
+}   // namespace foundation
@@ -31,12 +31,18 @@
 #include "bufferedfile.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/system.h"
 #include "foundation/utility/memory.h"
 #include "foundation/utility/otherwise.h"
 
 // LZ4 headers.
 #include <lz4.h>
 
+// Boost headers.
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cstring>
@@ -50,6 +56,101 @@ namespace foundation
 // BufferedFile class implementation.
 //
 
+struct BufferedFile::ReadAhead
+{
+    std::FILE*                  m_file;
+    uint8*                      m_buffer;       // buffer being filled by the background thread
+    const size_t                m_buffer_size;
+    size_t                      m_size;         // number of bytes read by the last request
+    bool                        m_requested;    // is a read pending?
+    bool                        m_ready;        // does m_buffer hold the result of a completed read?
+    bool                        m_abort;
+    boost::mutex                m_mutex;
+    boost::condition_variable   m_cond;
+    boost::thread               m_thread;
+
+    ReadAhead(
+        std::FILE*              file,
+        const size_t            buffer_size)
+      : m_file(file)
+      , m_buffer(new uint8[buffer_size])
+      , m_buffer_size(buffer_size)
+      , m_size(0)
+      , m_requested(false)
+      , m_ready(false)
+      , m_abort(false)
+      , m_thread(&ReadAhead::run, this)
+    {
+    }
+
+    ~ReadAhead()
+    {
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_abort = true;
+            m_cond.notify_all();
+        }
+
+        m_thread.join();
+
+        delete[] m_buffer;
+    }
+
+    // Return true if a read is pending or its result hasn't been taken yet.
+    bool is_busy()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_requested || m_ready;
+    }
+
+    // Ask the background thread to read the next block of the file.
+    void request()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        assert(!m_requested && !m_ready);
+        m_requested = true;
+        m_cond.notify_all();
+    }
+
+    // Wait for the pending read, if any, and return the number of bytes it read.
+    size_t take()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        while (m_requested)
+            m_cond.wait(lock);
+
+        const size_t size = m_ready ? m_size : 0;
+        m_ready = false;
+
+        return size;
+    }
+
+    void run()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        while (true)
+        {
+            while (!m_requested && !m_abort)
+                m_cond.wait(lock);
+
+            if (m_abort)
+                break;
+
+            // The I/O thread owns the file and the buffer until the request is completed.
+            lock.unlock();
+            const size_t size = fread(m_buffer, 1, m_buffer_size, m_file);
+            lock.lock();
+
+            m_size = size;
+            m_requested = false;
+            m_ready = true;
+            m_cond.notify_all();
+        }
+    }
+};
+
 BufferedFile::BufferedFile()
 {
     reset();
@@ -108,6 +209,27 @@ namespace
     }
 }
 
+namespace
+{
+    int64 portable_fseek(FILE* file, const int64 offset, const int mode)
+    {
+#ifdef _WIN32
+        return _fseeki64(file, offset, mode);
+#else
+        return fseek(file, offset, mode);
+#endif
+    }
+
+    int64 portable_ftell(FILE* file)
+    {
+#ifdef _WIN32
+        return _ftelli64(file);
+#else
+        return ftell(file);
+#endif
+    }
+}
+
 bool BufferedFile::open(
     const char*         path,
     const FileType      type,
@@ -125,6 +247,7 @@ bool BufferedFile::open(
     if (m_file == nullptr)
         return false;
 
+    m_file_type = type;
     m_file_mode = mode;
     m_file_index = 0;
     m_buffer = new uint8[buffer_size];
@@ -142,6 +265,8 @@ bool BufferedFile::close()
     if (m_file_mode == WriteMode)
         success = flush_buffer();
 
+    delete m_read_ahead;
+
     if (m_file)
     {
         if (fclose(m_file))
@@ -160,15 +285,41 @@ bool BufferedFile::is_open() const
     return m_file != nullptr;
 }
 
+bool BufferedFile::enable_read_ahead()
+{
+    assert(m_file);
+
+    if (m_file_type != BinaryType || m_file_mode != ReadMode)
+        return false;
+
+    if (m_read_ahead == nullptr)
+        m_read_ahead = new ReadAhead(m_file, m_buffer_size);
+
+    return true;
+}
+
 void BufferedFile::reset()
 {
     m_file = nullptr;
+    m_file_type = BinaryType;
     m_file_mode = ReadMode;
     m_file_index = 0;
     m_buffer = nullptr;
     m_buffer_size = 0;
     m_buffer_end = 0;
     m_buffer_index = 0;
+    m_read_ahead = nullptr;
+}
+
+void BufferedFile::cancel_read_ahead()
+{
+    if (m_read_ahead == nullptr)
+        return;
+
+    const size_t size = m_read_ahead->take();
+
+    if (size > 0)
+        portable_fseek(m_file, -static_cast<int64>(size), SEEK_CUR);
 }
 
 void BufferedFile::fill_buffer()
@@ -179,7 +330,22 @@ void BufferedFile::fill_buffer()
 
     m_file_index += static_cast<int64>(m_buffer_index);
 
-    m_buffer_end = fread(m_buffer, 1, m_buffer_size, m_file);
+    if (m_read_ahead)
+    {
+        // Unless it was already requested, read the next block now.
+        if (!m_read_ahead->is_busy())
+            m_read_ahead->request();
+
+        // Swap the block that was read in the background into the I/O buffer.
+        m_buffer_end = m_read_ahead->take();
+        swap(m_buffer, m_read_ahead->m_buffer);
+
+        // Start reading the following block unless the end of the file was reached.
+        if (m_buffer_end == m_buffer_size)
+            m_read_ahead->request();
+    }
+    else m_buffer_end = fread(m_buffer, 1, m_buffer_size, m_file);
+
     m_buffer_index = 0;
 }
 
@@ -260,6 +426,7 @@ size_t BufferedFile::read_unbuf(
         {
             m_file_index += static_cast<int64>(m_buffer_index);
 
+            cancel_read_ahead();
             invalidate_buffer();
 
             // Read all remaining data from disk directly into the output buffer.
@@ -374,27 +541,6 @@ size_t BufferedFile::write_unbuf(
     return bytes;
 }
 
-namespace
-{
-    int64 portable_fseek(FILE* file, const int64 offset, const int mode)
-    {
-#ifdef _WIN32
-        return _fseeki64(file, offset, mode);
-#else
-        return fseek(file, offset, mode);
-#endif
-    }
-
-    int64 portable_ftell(FILE* file)
-    {
-#ifdef _WIN32
-        return _ftelli64(file);
-#else
-        return ftell(file);
-#endif
-    }
-}
-
 bool BufferedFile::seek(
     const int64         offset,
     const SeekOrigin    origin)
@@ -406,7 +552,10 @@ bool BufferedFile::seek(
     if (origin == SeekFromEnd)
     {
         if (m_file_mode == ReadMode)
+        {
+            cancel_read_ahead();
             invalidate_buffer();
+        }
         else flush_buffer();
 
         if (portable_fseek(m_file, offset, SEEK_END))
@@ -440,6 +589,7 @@ bool BufferedFile::seek(
             if (m_file_mode == ReadMode)
             {
                 current_file_index = m_file_index + static_cast<int64>(m_buffer_end);
+                cancel_read_ahead();
                 invalidate_buffer();
             }
             else
@@ -520,7 +670,7 @@ size_t CompressedReaderAdapter::read(
                 break;
         }
 
-        const size_t copy = min(size, m_buffer_end - m_buffer_index);
+        const size_t copy = min(remaining, m_buffer_end - m_buffer_index);
         memcpy(outbuf, &m_buffer[m_buffer_index], copy);
 
         outbuf = reinterpret_cast<uint8*>(outbuf) + copy;
@@ -546,6 +696,21 @@ namespace
         x = static_cast<T>(y);
         return result;
     }
+
+    // Call func(i) for every i in [0, count), each call on its own thread.
+    template <typename Func>
+    void for_each_in_parallel(const size_t count, const Func& func)
+    {
+        boost::thread_group threads;
+
+        for (size_t i = 1; i < count; ++i)
+            threads.create_thread([&func, i]() { func(i); });
+
+        if (count > 0)
+            func(0);
+
+        threads.join_all();
+    }
 }
 
 
@@ -555,6 +720,9 @@ namespace
 
 LZ4CompressedWriterAdapter::LZ4CompressedWriterAdapter(BufferedFile& file)
   : CompressedWriterAdapter(file)
+  , m_thread_count(System::get_logical_cpu_core_count())
+  , m_chunks(m_thread_count)
+  , m_chunk_count(0)
 {
 }
 
@@ -562,6 +730,20 @@ LZ4CompressedWriterAdapter::LZ4CompressedWriterAdapter(
     BufferedFile&       file,
     const size_t        buffer_size)
   : CompressedWriterAdapter(file, buffer_size)
+  , m_thread_count(System::get_logical_cpu_core_count())
+  , m_chunks(m_thread_count)
+  , m_chunk_count(0)
+{
+}
+
+LZ4CompressedWriterAdapter::LZ4CompressedWriterAdapter(
+    BufferedFile&       file,
+    const size_t        buffer_size,
+    const size_t        thread_count)
+  : CompressedWriterAdapter(file, buffer_size)
+  , m_thread_count(max<size_t>(thread_count, 1))
+  , m_chunks(m_thread_count)
+  , m_chunk_count(0)
 {
 }
 
@@ -569,6 +751,9 @@ LZ4CompressedWriterAdapter::~LZ4CompressedWriterAdapter()
 {
     if (m_buffer_index > 0)
         flush_buffer();
+
+    if (m_chunk_count > 0)
+        flush_chunks();
 }
 
 void LZ4CompressedWriterAdapter::flush_buffer()
@@ -576,30 +761,58 @@ void LZ4CompressedWriterAdapter::flush_buffer()
     // Make sure we have some data to compress and write.
     assert(m_buffer_index > 0);
 
-    // Allocate memory for the compressed buffer.
-    const size_t max_compressed_buffer_size =
-        static_cast<size_t>(LZ4_compressBound(static_cast<int>(m_buffer_index)));
-    ensure_minimum_size(m_compressed_buffer, max_compressed_buffer_size);
+    // Queue the buffer as a new chunk, and recycle the storage of an old chunk as the new buffer.
+    Chunk& chunk = m_chunks[m_chunk_count++];
+    chunk.m_data.swap(m_buffer);
+    chunk.m_size = m_buffer_index;
+    m_buffer_index = 0;
+
+    if (m_chunk_count == m_thread_count)
+        flush_chunks();
+}
 
-    // Compress data.
-    const int compressed_buffer_size =
-        LZ4_compress_default(
-            reinterpret_cast<const char*>(&m_buffer[0]),
-            reinterpret_cast<char*>(&m_compressed_buffer[0]),
-            static_cast<int>(m_buffer_index),
-            static_cast<int>(max_compressed_buffer_size));
-    assert(compressed_buffer_size > 0);
+void LZ4CompressedWriterAdapter::flush_chunks()
+{
+    // Compress chunks.
+    for_each_in_parallel(
+        m_chunk_count,
+        [this](const size_t chunk_index)
+        {
+            Chunk& chunk = m_chunks[chunk_index];
+
+            // Allocate memory for the compressed buffer.
+            const size_t max_compressed_buffer_size =
+                static_cast<size_t>(LZ4_compressBound(static_cast<int>(chunk.m_size)));
+            ensure_minimum_size(chunk.m_compressed_data, max_compressed_buffer_size);
+
+            // Compress data.
+            const int compressed_buffer_size =
+                LZ4_compress_default(
+                    reinterpret_cast<const char*>(&chunk.m_data[0]),
+                    reinterpret_cast<char*>(&chunk.m_compressed_data[0]),
+                    static_cast<int>(chunk.m_size),
+                    static_cast<int>(max_compressed_buffer_size));
+            assert(compressed_buffer_size > 0);
+
+            chunk.m_compressed_size = static_cast<size_t>(compressed_buffer_size);
+        });
+
+    // Write chunks in order.
+    for (size_t i = 0; i < m_chunk_count; ++i)
+    {
+        const Chunk& chunk = m_chunks[i];
 
-    // Write uncompressed size.
-    m_file.write(static_cast<uint64>(m_buffer_index));
+        // Write uncompressed size.
+        m_file.write(static_cast<uint64>(chunk.m_size));
 
-    // Write compressed size.
-    m_file.write(static_cast<uint64>(compressed_buffer_size));
+        // Write compressed size.
+        m_file.write(static_cast<uint64>(chunk.m_compressed_size));
 
-    // Write compressed data.
-    m_file.write(&m_compressed_buffer[0], compressed_buffer_size);
+        // Write compressed data.
+        m_file.write(&chunk.m_compressed_data[0], chunk.m_compressed_size);
+    }
 
-    m_buffer_index = 0;
+    m_chunk_count = 0;
 }
 
 
@@ -609,42 +822,91 @@ void LZ4CompressedWriterAdapter::flush_buffer()
 
 LZ4CompressedReaderAdapter::LZ4CompressedReaderAdapter(BufferedFile& file)
   : CompressedReaderAdapter(file)
+  , m_thread_count(System::get_logical_cpu_core_count())
+  , m_chunks(m_thread_count)
+  , m_chunk_index(0)
+  , m_chunk_count(0)
+{
+}
+
+LZ4CompressedReaderAdapter::LZ4CompressedReaderAdapter(
+    BufferedFile&       file,
+    const size_t        thread_count)
+  : CompressedReaderAdapter(file)
+  , m_thread_count(max<size_t>(thread_count, 1))
+  , m_chunks(m_thread_count)
+  , m_chunk_index(0)
+  , m_chunk_count(0)
 {
 }
 
 bool LZ4CompressedReaderAdapter::fill_buffer()
 {
-    // Read uncompressed size.
-    size_t buffer_size;
-    if (read_uint64(m_file, buffer_size) == 0)
-        return false;
+    if (m_chunk_index == m_chunk_count)
+    {
+        if (!read_chunks())
+            return false;
+    }
 
-    // Allocate memory for the uncompressed buffer.
-    ensure_minimum_size(m_buffer, buffer_size);
+    // Hand the next decompressed chunk over to the buffer, and recycle the storage of the buffer.
+    Chunk& chunk = m_chunks[m_chunk_index++];
+    m_buffer.swap(chunk.m_data);
 
-    // Read compressed size.
-    size_t compressed_buffer_size;
-    read_uint64(m_file, compressed_buffer_size);
+    m_buffer_index = 0;
+    m_buffer_end = chunk.m_size;
 
-    // Allocate memory for the compressed buffer.
-    ensure_minimum_size(m_compressed_buffer, compressed_buffer_size);
+    return true;
+}
+
+bool LZ4CompressedReaderAdapter::read_chunks()
+{
+    m_chunk_index = 0;
+    m_chunk_count = 0;
+
+    // Read up to one chunk per thread.
+    while (m_chunk_count < m_thread_count)
+    {
+        Chunk& chunk = m_chunks[m_chunk_count];
+
+        // Read uncompressed size.
+        if (read_uint64(m_file, chunk.m_size) == 0)
+            break;
+
+        // Allocate memory for the uncompressed buffer.
+        ensure_minimum_size(chunk.m_data, chunk.m_size);
+
+        // Read compressed size.
+        read_uint64(m_file, chunk.m_compressed_size);
 
-    // Read compressed data.
-    m_file.read(&m_compressed_buffer[0], compressed_buffer_size);
+        // Allocate memory for the compressed buffer.
+        ensure_minimum_size(chunk.m_compressed_data, chunk.m_compressed_size);
+
+        // Read compressed data.
+        m_file.read(&chunk.m_compressed_data[0], chunk.m_compressed_size);
+
+        ++m_chunk_count;
+    }
+
+    if (m_chunk_count == 0)
+        return false;
+
+    // Decompress chunks.
+    for_each_in_parallel(
+        m_chunk_count,
+        [this](const size_t chunk_index)
+        {
+            Chunk& chunk = m_chunks[chunk_index];
 
-    // Decompress data.
 #ifndef NDEBUG
-    const int decompressed_bytes =
+            const int decompressed_bytes =
 #endif
-        LZ4_decompress_safe(
-            reinterpret_cast<const char*>(&m_compressed_buffer[0]),
-            reinterpret_cast<char*>(&m_buffer[0]),
-            static_cast<int>(compressed_buffer_size),
-            static_cast<int>(buffer_size));
-    assert(decompressed_bytes == static_cast<int>(buffer_size));
-
-    m_buffer_index = 0;
-    m_buffer_end = buffer_size;
+                LZ4_decompress_safe(
+                    reinterpret_cast<const char*>(&chunk.m_compressed_data[0]),
+                    reinterpret_cast<char*>(&chunk.m_data[0]),
+                    static_cast<int>(chunk.m_compressed_size),
+                    static_cast<int>(chunk.m_size));
+            assert(decompressed_bytes == static_cast<int>(chunk.m_size));
+        });
 
     return true;
 }
@@ -61,6 +61,11 @@ namespace foundation
 //     except open(), the BufferedFile object is left in an unknown state
 //     and no other method except close() may be called safely.
 //
+//   - Binary files open in read mode can read ahead: while the content of
+//     the I/O buffer is being consumed, a background thread reads the next
+//     block of the file into a second buffer. This hides I/O latency when
+//     reading large files sequentially, e.g. from network file systems.
+//
 
 class APPLESEED_DLLSYMBOL BufferedFile
 {
@@ -82,7 +87,8 @@ class APPLESEED_DLLSYMBOL BufferedFile
     // Default read/write buffer size, in bytes.
     enum
     {
-        DefaultBufferSize = 32 * 1024
+        DefaultBufferSize = 32 * 1024,
+        ReadAheadBufferSize = 1024 * 1024   // suggested buffer size when reading ahead
     };
 
     // Initial position for seek().
@@ -119,6 +125,11 @@ class APPLESEED_DLLSYMBOL BufferedFile
     // Return true if the file is open, false otherwise.
     bool is_open() const;
 
+    // Start reading ahead in the background.
+    // The file must be binary and open in read mode.
+    // Return true on success, false if read-ahead is not supported for this file.
+    bool enable_read_ahead();
+
     // Read a contiguous sequence of bytes from the file.
     // The file must be open in read mode.
     // Return the number of bytes that were successfully read.
@@ -181,17 +192,25 @@ class APPLESEED_DLLSYMBOL BufferedFile
     int64 tell() const;
 
   private:
+    struct ReadAhead;
+
     std::FILE*              m_file;
+    FileType                m_file_type;
     FileMode                m_file_mode;
     int64                   m_file_index;       // index in the file of the first byte of the I/O buffer
     uint8*                  m_buffer;           // I/O buffer
     size_t                  m_buffer_size;      // size of the I/O buffer
     size_t                  m_buffer_end;       // one past the index of the last byte in the I/O buffer
     size_t                  m_buffer_index;     // index of the next byte in the I/O buffer
+    ReadAhead*              m_read_ahead;       // background reader, or nullptr if not reading ahead
 
     // Reset the internal state of the object.
     void reset();
 
+    // Wait for the background read to complete and discard its result,
+    // leaving the file pointer right after the end of the I/O buffer.
+    void cancel_read_ahead();
+
     // Invalidate the I/O buffer (read mode only).
     void invalidate_buffer();
 
@@ -341,6 +360,11 @@ class CompressedReaderAdapter
 //
 // LZ4 compression adapters.
 //
+// Data is split into chunks that are compressed independently. Up to one chunk per
+// thread is compressed or decompressed concurrently; chunks are still written to and
+// read from the file in order, so the file format does not depend on the thread count.
+// By default, one thread per logical CPU core is used.
+//
 
 class LZ4CompressedWriterAdapter
   : public CompressedWriterAdapter
@@ -352,12 +376,28 @@ class LZ4CompressedWriterAdapter
         BufferedFile&       file,
         const size_t        buffer_size);               // compression buffer size, in bytes
 
+    LZ4CompressedWriterAdapter(
+        BufferedFile&       file,
+        const size_t        buffer_size,                // compression buffer size, in bytes
+        const size_t        thread_count);
+
     ~LZ4CompressedWriterAdapter() override;
 
   private:
-    std::vector<uint8>      m_compressed_buffer;
+    struct Chunk
+    {
+        std::vector<uint8>  m_data;
+        size_t              m_size;
+        std::vector<uint8>  m_compressed_data;
+        size_t              m_compressed_size;
+    };
+
+    const size_t            m_thread_count;
+    std::vector<Chunk>      m_chunks;
+    size_t                  m_chunk_count;
 
     void flush_buffer() override;
+    void flush_chunks();
 };
 
 class LZ4CompressedReaderAdapter
@@ -366,10 +406,26 @@ class LZ4CompressedReaderAdapter
   public:
     explicit LZ4CompressedReaderAdapter(BufferedFile& file);
 
+    LZ4CompressedReaderAdapter(
+        BufferedFile&       file,
+        const size_t        thread_count);
+
   private:
-    std::vector<uint8>      m_compressed_buffer;
+    struct Chunk
+    {
+        std::vector<uint8>  m_data;
+        size_t              m_size;
+        std::vector<uint8>  m_compressed_data;
+        size_t              m_compressed_size;
+    };
+
+    const size_t            m_thread_count;
+    std::vector<Chunk>      m_chunks;
+    size_t                  m_chunk_index;
+    size_t                  m_chunk_count;
 
     bool fill_buffer() override;
+    bool read_chunks();
 };
 
 
@@ -31,7 +31,11 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
 #include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
 #include "foundation/platform/types.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/iterators.h"
@@ -94,41 +98,27 @@ namespace cache_impl
     };
 
 
-    //
-    // Timestamp type.
-    //
-
-    typedef size_t Timestamp;
-
-
     //
     // Single cache entry for set associative caches.
     //
 
-    template <typename Key, typename Element, bool WithTimestamp>
-    struct SACacheEntry;
-
-    template <typename Key, typename Element>
-    struct SACacheEntry<Key, Element, false>
-      : public NonCopyable
-    {
-        Key         m_key;
-        Element     m_element;
-    };
-
     template <typename Key, typename Element>
-    struct SACacheEntry<Key, Element, true>
+    struct SACacheEntry
       : public NonCopyable
     {
         Key         m_key;
         Element     m_element;
-        Timestamp   m_timestamp;
     };
 
 
     //
     // Single cache line for a generic N-way set associative cache.
     //
+    // The number of ways must be a power of two. Each entry has a 32-bit tag
+    // derived from the hash of its key; tags of a line are stored contiguously
+    // and compared four at a time with SSE before keys are compared. Replacement
+    // follows a tree-based pseudo-LRU policy which needs Ways - 1 bits per line.
+    //
 
     template <typename Key, typename Element, size_t Ways_>
     class SACacheLine
@@ -137,9 +127,13 @@ namespace cache_impl
       public:
         typedef Key KeyType;
         typedef Element ElementType;
-        typedef SACacheEntry<Key, Element, true> EntryType;
+        typedef SACacheEntry<Key, Element> EntryType;
         static const size_t Ways = Ways_;
 
+        static_assert(
+            Ways >= 4 && Ways <= 32 && (Ways & (Ways - 1)) == 0,
+            "foundation::SACacheLine: the number of ways must be a power of two between 4 and 32");
+
         // Return a given entry.
         EntryType& get_entry(const size_t i)
         {
@@ -158,48 +152,97 @@ namespace cache_impl
             for (size_t i = 0; i < Ways; ++i)
             {
                 m_entries[i].m_key = invalid_key;
-                m_entries[i].m_timestamp = 0;
+                m_tags[i] = 0;
             }
+
+            m_plru_bits = 0;
         }
 
         // Return a pointer to the entry corresponding to a given key, or 0 if this key was not found.
-        EntryType* find_entry(const KeyType& key)
+        EntryType* find_entry(const KeyType& key, const size_t hash)
         {
-            for (size_t i = 0; i < Ways; ++i)
+            uint32 mask = find_matching_tags(make_tag(hash));
+
+            while (mask != 0)
             {
+                const uint32 i = trailing_zeros_int(mask);
+
                 if (m_entries[i].m_key == key)
                     return &m_entries[i];
+
+                mask &= mask - 1;
             }
 
             return nullptr;
         }
 
-        // Update the timestamp of a given entry in this cache line.
-        void touch_entry(EntryType* entry, const Timestamp timestamp)
+        // Set the tag of a given entry after a new key was stored into it.
+        void set_entry_tag(EntryType* entry, const size_t hash)
         {
-            entry->m_timestamp = timestamp;
+            m_tags[entry - m_entries] = make_tag(hash);
         }
 
-        // Find an entry to replace in this cache line.
-        EntryType* find_eviction_candidate()
+        // Record an access to a given entry in this cache line.
+        void touch_entry(EntryType* entry)
         {
-            size_t oldest_index = 0;
-            Timestamp oldest_timestamp = m_entries[0].m_timestamp;
+            // Flip the bits along the path to this entry so that they point away from it.
+            const size_t way = entry - m_entries;
+            size_t node = 1;
 
-            for (size_t i = 1; i < Ways; ++i)
+            for (size_t level = Ways >> 1; level > 0; level >>= 1)
             {
-                if (oldest_timestamp > m_entries[i].m_timestamp)
-                {
-                    oldest_index = i;
-                    oldest_timestamp = m_entries[i].m_timestamp;
-                }
+                const uint32 bit = (way & level) ? 1 : 0;
+                m_plru_bits = (m_plru_bits & ~(uint32(1) << node)) | ((bit ^ 1) << node);
+                node = 2 * node + bit;
             }
+        }
+
+        // Find an entry to replace in this cache line.
+        EntryType* find_eviction_candidate()
+        {
+            // Follow the bits from the root of the tree down to a leaf.
+            size_t node = 1;
+
+            while (node < Ways)
+                node = 2 * node + ((m_plru_bits >> node) & 1);
 
-            return &m_entries[oldest_index];
+            return &m_entries[node - Ways];
         }
 
       private:
-        EntryType m_entries[Ways];
+        uint32      m_tags[Ways];
+        uint32      m_plru_bits;        // bit i holds the state of node i of the tree (1-based)
+        EntryType   m_entries[Ways];
+
+        static uint32 make_tag(const size_t hash)
+        {
+            return static_cast<uint32>(static_cast<uint64>(hash) ^ (static_cast<uint64>(hash) >> 32));
+        }
+
+        // Return a bit mask with bit i set if the tag of entry i equals a given tag.
+        uint32 find_matching_tags(const uint32 tag) const
+        {
+            uint32 mask = 0;
+
+#ifdef APPLESEED_USE_SSE
+            const __m128i tag4 = _mm_set1_epi32(static_cast<int>(tag));
+
+            for (size_t i = 0; i < Ways; i += 4)
+            {
+                const __m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_tags + i));
+                const __m128i eq = _mm_cmpeq_epi32(tags, tag4);
+                mask |= static_cast<uint32>(_mm_movemask_ps(_mm_castsi128_ps(eq))) << i;
+            }
+#else
+            for (size_t i = 0; i < Ways; ++i)
+            {
+                if (m_tags[i] == tag)
+                    mask |= uint32(1) << i;
+            }
+#endif
+
+            return mask;
+        }
     };
 
 
@@ -214,7 +257,7 @@ namespace cache_impl
       public:
         typedef Key KeyType;
         typedef Element ElementType;
-        typedef SACacheEntry<Key, Element, false> EntryType;
+        typedef SACacheEntry<Key, Element> EntryType;
         static const size_t Ways = 1;
 
         // Return a given entry.
@@ -236,13 +279,18 @@ namespace cache_impl
         }
 
         // Return a pointer to the entry corresponding to a given key, or 0 if this key was not found.
-        EntryType* find_entry(const KeyType& key)
+        EntryType* find_entry(const KeyType& key, const size_t hash)
         {
             return m_entry.m_key == key ? &m_entry : nullptr;
         }
 
-        // Update the timestamp of a given entry in this cache line.
-        void touch_entry(EntryType* entry, const Timestamp timestamp)
+        // Set the tag of a given entry after a new key was stored into it.
+        void set_entry_tag(EntryType* entry, const size_t hash)
+        {
+        }
+
+        // Record an access to a given entry in this cache line.
+        void touch_entry(EntryType* entry)
         {
         }
 
@@ -268,7 +316,7 @@ namespace cache_impl
       public:
         typedef Key KeyType;
         typedef Element ElementType;
-        typedef SACacheEntry<Key, Element, false> EntryType;
+        typedef SACacheEntry<Key, Element> EntryType;
         static const size_t Ways = 2;
 
         // Return a given entry.
@@ -292,15 +340,20 @@ namespace cache_impl
         }
 
         // Return a pointer to the entry corresponding to a given key, or 0 if this key was not found.
-        EntryType* find_entry(const KeyType& key)
+        EntryType* find_entry(const KeyType& key, const size_t hash)
         {
             return
                 m_entries[0].m_key == key ? &m_entries[0] :
                 m_entries[1].m_key == key ? &m_entries[1] : nullptr;
         }
 
-        // Update the timestamp of a given entry in this cache line.
-        void touch_entry(EntryType* entry, const Timestamp timestamp)
+        // Set the tag of a given entry after a new key was stored into it.
+        void set_entry_tag(EntryType* entry, const size_t hash)
+        {
+        }
+
+        // Record an access to a given entry in this cache line.
+        void touch_entry(EntryType* entry)
         {
             m_oldest = 1 - (entry - m_entries);
         }
@@ -323,6 +376,7 @@ namespace cache_impl
 // Set associative cache.
 //
 // If the template parameter Ways equals 1, this is a direct-mapped cache.
+// Otherwise Ways must be 2 or a power of two between 4 and 32.
 //
 // The KeyHasher class must conform to the following prototype:
 //
@@ -409,7 +463,6 @@ class SACache
     KeyHasherType&          m_key_hasher;
     ElementSwapperType&     m_element_swapper;
     const KeyType           m_invalid_key;
-    cache_impl::Timestamp   m_timestamp;
     LineType                m_lines[Lines];             // cache storage
 };
 
@@ -472,6 +525,9 @@ class LRUCache
     // Get an element from the cache.
     ElementType& get(const KeyType& key);
 
+    // Return true if an element is in the cache. Does not affect statistics nor the LRU order.
+    bool contains(const KeyType& key) const;
+
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
@@ -732,7 +788,6 @@ SACache(
   : m_key_hasher(key_hasher)
   , m_element_swapper(element_swapper)
   , m_invalid_key(invalid_key)
-  , m_timestamp(0)
 {
     clear();
 }
@@ -762,11 +817,11 @@ FOUNDATION_SACACHE_TEMPLATE_DEF(inline Element&)
 get(const KeyType& key)
 {
     // Find the cache line that might contain this key.
-    const size_t index = m_key_hasher(key);
-    LineType& line = m_lines[index % Lines];
+    const size_t hash = m_key_hasher(key);
+    LineType& line = m_lines[hash % Lines];
 
     // Look for this key inside the cache line.
-    EntryType* entry = line.find_entry(key);
+    EntryType* entry = line.find_entry(key, hash);
 
     if (entry)
     {
@@ -790,10 +845,11 @@ get(const KeyType& key)
 
         // Set the entry's key only after loading succeeded (it might have failed with an exception).
         entry->m_key = key;
+        line.set_entry_tag(entry, hash);
     }
 
-    // Update the timestamp of this entry.
-    line.touch_entry(entry, m_timestamp++);
+    // Record the access to this entry.
+    line.touch_entry(entry);
 
     // Return the corresponding element.
     return entry->m_element;
@@ -803,11 +859,11 @@ FOUNDATION_SACACHE_TEMPLATE_DEF(inline void)
 invalidate(const KeyType& key)
 {
     // Find the cache line that might contain this key.
-    const size_t index = m_key_hasher(key);
-    LineType& line = m_lines[index % Lines];
+    const size_t hash = m_key_hasher(key);
+    LineType& line = m_lines[hash % Lines];
 
     // Look for this key inside the cache line.
-    EntryType* entry = line.find_entry(key);
+    EntryType* entry = line.find_entry(key, hash);
 
     if (entry)
     {
@@ -967,6 +1023,12 @@ get(const KeyType& key)
     }
 }
 
+FOUNDATION_LRUCACHE_TEMPLATE_DEF(inline bool)
+contains(const KeyType& key) const
+{
+    return m_index.find(key) != m_index.end();
+}
+
 FOUNDATION_LRUCACHE_TEMPLATE_DEF(inline size_t)
 get_memory_size() const
 {
@@ -33,17 +33,156 @@
 // appleseed.foundation headers.
 #include "foundation/utility/foreach.h"
 
+// Boost headers.
+#include "boost/unordered_map.hpp"
+
 // Standard headers.
 #include <cassert>
 #include <map>
+#include <utility>
 
 using namespace std;
 
 namespace foundation
 {
 
-typedef map<string, string> StringMap;
-typedef map<string, Dictionary> DictionaryMap;
+namespace
+{
+    // Number of items from which a map also maintains a hash index of its keys.
+    const size_t HashIndexThreshold = 16;
+
+    //
+    // A map from strings to values, iterated in key order. Small maps rely on std::map alone;
+    // larger maps also maintain a hash index of their keys so that lookups don't turn into
+    // long sequences of string comparisons.
+    //
+
+    template <typename Value>
+    class IndexedMap
+    {
+      public:
+        typedef map<string, Value> Storage;
+        typedef typename Storage::iterator iterator;
+        typedef typename Storage::const_iterator const_iterator;
+
+        IndexedMap()
+        {
+        }
+
+        IndexedMap(const IndexedMap& rhs)
+          : m_storage(rhs.m_storage)
+        {
+            rebuild_index();
+        }
+
+        IndexedMap& operator=(const IndexedMap& rhs)
+        {
+            if (this != &rhs)
+            {
+                m_storage = rhs.m_storage;
+                rebuild_index();
+            }
+
+            return *this;
+        }
+
+        size_t size() const
+        {
+            return m_storage.size();
+        }
+
+        bool empty() const
+        {
+            return m_storage.empty();
+        }
+
+        void clear()
+        {
+            m_storage.clear();
+            m_index.clear();
+        }
+
+        iterator begin()
+        {
+            return m_storage.begin();
+        }
+
+        iterator end()
+        {
+            return m_storage.end();
+        }
+
+        const_iterator begin() const
+        {
+            return m_storage.begin();
+        }
+
+        const_iterator end() const
+        {
+            return m_storage.end();
+        }
+
+        iterator find(const char* key)
+        {
+            if (m_index.empty())
+                return m_storage.find(key);
+
+            const typename Index::const_iterator i = m_index.find(key);
+            return i == m_index.end() ? m_storage.end() : i->second;
+        }
+
+        const_iterator find(const char* key) const
+        {
+            return const_cast<IndexedMap*>(this)->find(key);
+        }
+
+        Value& operator[](const char* key)
+        {
+            const iterator i = find(key);
+
+            if (i != m_storage.end())
+                return i->second;
+
+            const iterator j = m_storage.insert(make_pair(string(key), Value())).first;
+
+            if (!m_index.empty())
+                m_index.insert(make_pair(j->first.c_str(), j));
+            else if (m_storage.size() >= HashIndexThreshold)
+                rebuild_index();
+
+            return j->second;
+        }
+
+        void erase(const iterator i)
+        {
+            if (!m_index.empty())
+                m_index.erase(i->first.c_str());
+
+            m_storage.erase(i);
+        }
+
+      private:
+        // Keys of the index point to the keys of the storage, which never move.
+        typedef boost::unordered_map<const char*, iterator, StringHash, StringEqual> Index;
+
+        Storage m_storage;
+        Index   m_index;
+
+        void rebuild_index()
+        {
+            m_index.clear();
+
+            if (m_storage.size() >= HashIndexThreshold)
+            {
+                for (iterator i = m_storage.begin(), e = m_storage.end(); i != e; ++i)
+                    m_index.insert(make_pair(i->first.c_str(), i));
+            }
+        }
+    };
+}
+
+typedef IndexedMap<string> StringMap;
+typedef IndexedMap<Dictionary> DictionaryMap;
 
 
 //
@@ -218,6 +357,15 @@ const char* StringDictionary::get(const char* key) const
     return i->second.c_str();
 }
 
+const char* StringDictionary::find(const char* key) const
+{
+    assert(key);
+
+    const StringMap::const_iterator i = impl->m_strings.find(key);
+
+    return i == impl->m_strings.end() ? nullptr : i->second.c_str();
+}
+
 bool StringDictionary::exist(const char* key) const
 {
     assert(key);
@@ -509,6 +657,15 @@ const Dictionary& DictionaryDictionary::get(const char* key) const
     return i->second;
 }
 
+const Dictionary* DictionaryDictionary::find(const char* key) const
+{
+    assert(key);
+
+    const DictionaryMap::const_iterator i = impl->m_dictionaries.find(key);
+
+    return i == impl->m_dictionaries.end() ? nullptr : &i->second;
+}
+
 bool DictionaryDictionary::exist(const char* key) const
 {
     assert(key);
@@ -150,6 +150,9 @@ class APPLESEED_DLLSYMBOL StringDictionary
     template <typename T> T get(const char* key) const;
     template <typename T> T get(const std::string& key) const;
 
+    // Retrieve an item from the dictionary, or return nullptr if it could not be found.
+    const char* find(const char* key) const;
+
     // Return true if an item with a given key exists in the dictionary.
     bool exist(const char* key) const;
     template <typename T> bool exist(const std::basic_string<T>& key) const;
@@ -306,6 +309,9 @@ class APPLESEED_DLLSYMBOL DictionaryDictionary
     template <typename T> Dictionary& get(const std::basic_string<T>& key);
     template <typename T> const Dictionary& get(const std::basic_string<T>& key) const;
 
+    // Retrieve an item from the dictionary, or return nullptr if it could not be found.
+    const Dictionary* find(const char* key) const;
+
     // Return true if an item with a given key exists in the dictionary.
     bool exist(const char* key) const;
     template <typename T> bool exist(const std::basic_string<T>& key) const;
@@ -0,0 +1,212 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace foundation
+{
+
+//
+// A hash table with the same interface and restrictions as foundation::HashTable
+// but using open addressing instead of chaining.
+//
+// All entries live in a single flat array, next to an array of one control byte
+// per slot holding the 7 low bits of the key's hash, or a marker for empty slots.
+// Slots are grouped by 16 and the control bytes of a group are compared to the
+// searched hash in one SIMD instruction; keys are only compared for slots whose
+// control byte matched. Groups are probed in triangular order.
+//
+// Restrictions:
+//
+//   * No dynamic resizing (the table is cleared on resize)
+//   * Table size must be a power of two
+//   * No deletion of elements
+//   * No control over memory allocation
+//   * Keys and values must be default-constructible
+//
+
+template <typename KeyType, typename KeyHasherType, typename ValueType>
+class FlatHashTable
+{
+  public:
+    // Constructor, creates an empty hash table with a given key hasher.
+    explicit FlatHashTable(const KeyHasherType& key_hasher);
+
+    // Resize the table so that it can hold size elements. The size must be a power of two.
+    // All previously inserted elements are lost.
+    void resize(const size_t size);
+
+    // Insert an element into the hash table. The key must be unique.
+    void insert(const KeyType& key, const ValueType& value);
+
+    // Retrieve an element from the hash table. Returns nullptr if the element cannot be found.
+    const ValueType* get(const KeyType& key) const;
+
+  private:
+    typedef std::pair<KeyType, ValueType> Entry;
+
+    enum { GroupSize = 16 };
+
+    static const uint8 EmptyControl = 0x80;
+
+    const KeyHasherType&    m_key_hasher;
+    size_t                  m_group_mask;
+    size_t                  m_size;
+    std::vector<uint8>      m_controls;
+    std::vector<Entry>      m_entries;
+
+    // Return a bit mask with bit i set if the i'th control byte of a group equals a given value.
+    static uint32 match_controls(const uint8* controls, const uint8 value);
+};
+
+
+//
+// FlatHashTable class implementation.
+//
+
+template <typename KeyType, typename KeyHasherType, typename ValueType>
+FlatHashTable<KeyType, KeyHasherType, ValueType>::FlatHashTable(const KeyHasherType& key_hasher)
+  : m_key_hasher(key_hasher)
+{
+    resize(0);
+}
+
+template <typename KeyType, typename KeyHasherType, typename ValueType>
+void FlatHashTable<KeyType, KeyHasherType, ValueType>::resize(const size_t size)
+{
+    assert(size == 0 || is_pow2(size));
+
+    // Keep the load factor at or below 1/2 to keep probe sequences short.
+    const size_t group_count = size * 2 > GroupSize ? size * 2 / GroupSize : 1;
+
+    m_group_mask = group_count - 1;
+    m_size = 0;
+
+    m_controls.assign(group_count * GroupSize, static_cast<uint8>(EmptyControl));
+    m_entries.clear();
+    m_entries.resize(group_count * GroupSize);
+}
+
+template <typename KeyType, typename KeyHasherType, typename ValueType>
+inline void FlatHashTable<KeyType, KeyHasherType, ValueType>::insert(const KeyType& key, const ValueType& value)
+{
+    // Always leave at least one empty slot so that unsuccessful lookups terminate.
+    assert(m_size + 1 < m_controls.size());
+
+    const size_t hash = m_key_hasher(key);
+    size_t group = (hash >> 7) & m_group_mask;
+
+    for (size_t step = 1; ; ++step)
+    {
+        const uint32 empty = match_controls(&m_controls[group * GroupSize], EmptyControl);
+
+        if (empty != 0)
+        {
+            const size_t index = group * GroupSize + trailing_zeros_int(empty);
+            m_controls[index] = static_cast<uint8>(hash & 0x7F);
+            m_entries[index] = std::make_pair(key, value);
+            ++m_size;
+            return;
+        }
+
+        group = (group + step) & m_group_mask;
+    }
+}
+
+template <typename KeyType, typename KeyHasherType, typename ValueType>
+inline const ValueType* FlatHashTable<KeyType, KeyHasherType, ValueType>::get(const KeyType& key) const
+{
+    const size_t hash = m_key_hasher(key);
+    const uint8 control = static_cast<uint8>(hash & 0x7F);
+    size_t group = (hash >> 7) & m_group_mask;
+
+    for (size_t step = 1; ; ++step)
+    {
+        const uint8* controls = &m_controls[group * GroupSize];
+
+        uint32 matches = match_controls(controls, control);
+
+        while (matches != 0)
+        {
+            const size_t index = group * GroupSize + trailing_zeros_int(matches);
+
+            if (m_entries[index].first == key)
+                return &m_entries[index].second;
+
+            matches &= matches - 1;
+        }
+
+        // Since elements are never deleted, an empty slot ends the probe sequence.
+        if (match_controls(controls, EmptyControl) != 0)
+            return nullptr;
+
+        group = (group + step) & m_group_mask;
+    }
+}
+
+template <typename KeyType, typename KeyHasherType, typename ValueType>
+inline uint32 FlatHashTable<KeyType, KeyHasherType, ValueType>::match_controls(
+    const uint8*    controls,
+    const uint8     value)
+{
+#ifdef APPLESEED_USE_SSE
+
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(controls));
+    const __m128i eq = _mm_cmpeq_epi8(c, _mm_set1_epi8(static_cast<char>(value)));
+
+    return static_cast<uint32>(_mm_movemask_epi8(eq));
+
+#else
+
+    uint32 mask = 0;
+
+    for (size_t i = 0; i < GroupSize; ++i)
+    {
+        if (controls[i] == value)
+            mask |= uint32(1) << i;
+    }
+
+    return mask;
+
+#endif
+}
+
+}   // namespace foundation
@@ -0,0 +1,240 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "eventtracer.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+
+// Boost headers.
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace foundation
+{
+
+//
+// EventTracer class implementation.
+//
+
+namespace
+{
+    struct Event
+    {
+        const char*     m_category;
+        const char*     m_name;
+        uint64          m_begin;
+        uint64          m_end;
+    };
+
+    struct ThreadBuffer
+    {
+        size_t                  m_thread_id;
+        string                  m_thread_name;
+        vector<Event>           m_events;
+        boost::atomic<uint64>   m_event_count;
+
+        explicit ThreadBuffer(const size_t thread_id)
+          : m_thread_id(thread_id)
+          , m_events(EventTracer::ThreadBufferCapacity)
+          , m_event_count(0)
+        {
+        }
+    };
+
+    // Buffer of the calling thread. Buffers are owned by the tracer and never released
+    // before it, so this pointer remains valid during the lifetime of the thread.
+    APPLESEED_TLS ThreadBuffer* t_thread_buffer = nullptr;
+
+    void write_json_string(ofstream& file, const char* s)
+    {
+        file << '"';
+
+        for (; *s != '\0'; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+                file << '\\';
+            file << *s;
+        }
+
+        file << '"';
+    }
+}
+
+struct EventTracer::Impl
+{
+    typedef chrono::steady_clock Clock;
+
+    const Clock::time_point             m_origin;
+    mutable boost::mutex                m_mutex;
+    vector<unique_ptr<ThreadBuffer>>    m_buffers;
+
+    Impl()
+      : m_origin(Clock::now())
+    {
+    }
+
+    ThreadBuffer& get_thread_buffer()
+    {
+        if (t_thread_buffer == nullptr)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_buffers.emplace_back(new ThreadBuffer(m_buffers.size()));
+            t_thread_buffer = m_buffers.back().get();
+        }
+
+        return *t_thread_buffer;
+    }
+};
+
+EventTracer& EventTracer::instance()
+{
+    static EventTracer tracer;
+    return tracer;
+}
+
+EventTracer::EventTracer()
+  : impl(new Impl())
+  , m_enabled(false)
+{
+}
+
+EventTracer::~EventTracer()
+{
+    delete impl;
+}
+
+void EventTracer::set_enabled(const bool enabled)
+{
+    m_enabled.store(enabled, boost::memory_order_relaxed);
+}
+
+void EventTracer::set_current_thread_name(const char* name)
+{
+    ThreadBuffer& buffer = impl->get_thread_buffer();
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+    buffer.m_thread_name = name;
+}
+
+uint64 EventTracer::now() const
+{
+    return
+        static_cast<uint64>(
+            chrono::duration_cast<chrono::microseconds>(
+                Impl::Clock::now() - impl->m_origin).count());
+}
+
+void EventTracer::record(
+    const char*     category,
+    const char*     name,
+    const uint64    begin,
+    const uint64    end)
+{
+    ThreadBuffer& buffer = impl->get_thread_buffer();
+
+    const uint64 index = buffer.m_event_count.load(boost::memory_order_relaxed);
+
+    Event& event = buffer.m_events[index % ThreadBufferCapacity];
+    event.m_category = category;
+    event.m_name = name;
+    event.m_begin = begin;
+    event.m_end = end;
+
+    buffer.m_event_count.store(index + 1, boost::memory_order_release);
+}
+
+void EventTracer::clear()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    for (const auto& buffer : impl->m_buffers)
+        buffer->m_event_count.store(0, boost::memory_order_relaxed);
+}
+
+bool EventTracer::write_chrome_trace(const char* file_path) const
+{
+    ofstream file(file_path);
+
+    if (!file.is_open())
+        return false;
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+
+    for (const auto& buffer : impl->m_buffers)
+    {
+        const uint64 event_count = buffer->m_event_count.load(boost::memory_order_acquire);
+
+        if (!buffer->m_thread_name.empty())
+        {
+            file << (first ? "" : ",\n");
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->m_thread_id << ",\"args\":{\"name\":";
+            write_json_string(file, buffer->m_thread_name.c_str());
+            file << "}}";
+            first = false;
+        }
+
+        const uint64 first_event =
+            event_count > ThreadBufferCapacity ? event_count - ThreadBufferCapacity : 0;
+
+        for (uint64 i = first_event; i < event_count; ++i)
+        {
+            const Event& event = buffer->m_events[i % ThreadBufferCapacity];
+
+            file << (first ? "" : ",\n");
+            file << "{\"name\":";
+            write_json_string(file, event.m_name);
+            file << ",\"cat\":";
+            write_json_string(file, event.m_category);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->m_thread_id;
+            file << ",\"ts\":" << event.m_begin << ",\"dur\":" << event.m_end - event.m_begin << "}";
+            first = false;
+        }
+    }
+
+    file << "\n]}\n";
+
+    return file.good();
+}
+
+}   // namespace foundation
@@ -0,0 +1,152 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+namespace foundation
+{
+
+//
+// A low overhead recorder of timed events, exported in the Chrome trace event format
+// (viewable in chrome://tracing or https://ui.perfetto.dev).
+//
+// Each thread records its events into its own ring buffer, such that the oldest events
+// are overwritten once a thread has recorded ThreadBufferCapacity events. Event names
+// and categories are stored by pointer and must outlive the tracer: use string literals.
+//
+
+class APPLESEED_DLLSYMBOL EventTracer
+  : public NonCopyable
+{
+  public:
+    // Maximum number of events kept per thread.
+    enum { ThreadBufferCapacity = 1 << 16 };
+
+    // Return the unique instance of this class.
+    static EventTracer& instance();
+
+    // Enable or disable recording. The tracer is disabled by default.
+    void set_enabled(const bool enabled);
+    bool is_enabled() const;
+
+    // Set the name under which the events of the calling thread are exported.
+    void set_current_thread_name(const char* name);
+
+    // Return the time elapsed since the creation of the tracer, in microseconds.
+    uint64 now() const;
+
+    // Record an event of the calling thread. Times are expressed in microseconds.
+    void record(
+        const char*     category,
+        const char*     name,
+        const uint64    begin,
+        const uint64    end);
+
+    // Discard all recorded events. No event must be recorded concurrently.
+    void clear();
+
+    // Write all recorded events to a Chrome trace file. No event should be recorded concurrently.
+    bool write_chrome_trace(const char* file_path) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+
+    boost::atomic<bool> m_enabled;
+
+    EventTracer();
+    ~EventTracer();
+};
+
+
+//
+// Record an event spanning the lifetime of this object, if the tracer is enabled.
+//
+
+class TraceScope
+  : public NonCopyable
+{
+  public:
+    TraceScope(
+        const char*     category,
+        const char*     name);
+
+    ~TraceScope();
+
+  private:
+    const char*         m_category;
+    const char*         m_name;
+    bool                m_enabled;
+    uint64              m_begin;
+};
+
+
+//
+// EventTracer class implementation.
+//
+
+inline bool EventTracer::is_enabled() const
+{
+    return m_enabled.load(boost::memory_order_relaxed);
+}
+
+
+//
+// TraceScope class implementation.
+//
+
+inline TraceScope::TraceScope(
+    const char*         category,
+    const char*         name)
+  : m_category(category)
+  , m_name(name)
+  , m_enabled(EventTracer::instance().is_enabled())
+  , m_begin(m_enabled ? EventTracer::instance().now() : 0)
+{
+}
+
+inline TraceScope::~TraceScope()
+{
+    if (m_enabled)
+    {
+        EventTracer& tracer = EventTracer::instance();
+        tracer.record(m_category, m_name, m_begin, tracer.now());
+    }
+}
+
+}   // namespace foundation
@@ -31,6 +31,7 @@
 #include "jobmanager.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/thread.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/job/workerthread.h"
@@ -103,6 +104,16 @@ void JobManager::start()
     // Create worker threads if they don't already exist.
     if (impl->m_worker_threads.empty())
     {
+        // Split worker threads over the NUMA nodes if thread pinning is enabled.
+        const size_t node_count =
+            impl->m_flags & PinThreadsToNumaNodes
+                ? get_numa_node_count()
+                : 1;
+
+        // Create one deque per worker thread if work stealing is enabled.
+        if (impl->m_flags & WorkStealing)
+            impl->m_job_queue.set_worker_queue_count(impl->m_thread_count, node_count);
+
         for (size_t i = 0; i < impl->m_thread_count; ++i)
         {
             impl->m_worker_threads.push_back(
@@ -110,7 +121,8 @@ void JobManager::start()
                     i,
                     impl->m_logger,
                     impl->m_job_queue,
-                    impl->m_flags));
+                    impl->m_flags,
+                    JobQueue::get_worker_numa_node(i, impl->m_thread_count, node_count)));
         }
     }
 
@@ -124,6 +136,11 @@ void JobManager::stop()
     // Stop and delete worker threads.
     for (each<Impl::WorkerThreads> i = impl->m_worker_threads; i; ++i)
         delete *i;
+
+    // Bring back the remaining scheduled jobs into the shared list of the job queue.
+    if (!impl->m_worker_threads.empty() && (impl->m_flags & WorkStealing))
+        impl->m_job_queue.set_worker_queue_count(0);
+
     impl->m_worker_threads.clear();
 }
 
@@ -58,7 +58,9 @@ class APPLESEED_DLLSYMBOL JobManager
     enum Flags
     {
         KeepRunningOnEmptyQueue = 1UL << 0,     // the worker thread keeps running even if the job queue is empty
-        KeepRunningOnJobFailure = 1UL << 1      // the worker thread keeps executing jobs from the work queue even if one or more jobs failed
+        KeepRunningOnJobFailure = 1UL << 1,     // the worker thread keeps executing jobs from the work queue even if one or more jobs failed
+        WorkStealing            = 1UL << 2,     // each worker thread gets its own deque of jobs and steals jobs from the other deques when it runs out of work
+        PinThreadsToNumaNodes   = 1UL << 3      // worker threads are split evenly over the NUMA nodes and restricted to the processors of their node
     };
 
     // Constructor.
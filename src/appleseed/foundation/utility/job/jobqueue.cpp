@@ -38,10 +38,12 @@
 #include "foundation/utility/job/ijob.h"
 
 // Boost headers.
+#include "boost/atomic/atomic.hpp"
 #include "boost/thread/condition_variable.hpp"
 
 // Standard headers.
 #include <cassert>
+#include <vector>
 
 using namespace std;
 
@@ -54,11 +56,87 @@ namespace foundation
 
 struct JobQueue::Impl
 {
+    // A per-worker deque of scheduled jobs, used when work stealing is enabled.
+    struct WorkerQueue
+      : public NonCopyable
+    {
+        Spinlock                    m_spinlock;
+        JobList                     m_jobs;
+        size_t                      m_node;
+    };
+
+    typedef std::vector<WorkerQueue*> WorkerQueueVector;
+
     mutable boost::mutex            m_mutex;
     boost::condition_variable_any   m_event;
     JobList                         m_scheduled_jobs;
     JobList                         m_running_jobs;
 
+    // Work stealing.
+    WorkerQueueVector               m_worker_queues;
+    boost::atomic<size_t>           m_next_worker_queue;
+    boost::atomic<size_t>           m_stealing_scheduled_job_count;
+    boost::atomic<size_t>           m_stealing_running_job_count;
+
+    Impl()
+      : m_next_worker_queue(0)
+      , m_stealing_scheduled_job_count(0)
+      , m_stealing_running_job_count(0)
+    {
+    }
+
+    ~Impl()
+    {
+        for (each<WorkerQueueVector> i = m_worker_queues; i; ++i)
+            delete *i;
+    }
+
+    bool is_work_stealing() const
+    {
+        return !m_worker_queues.empty();
+    }
+
+    size_t get_scheduled_job_count() const
+    {
+        return is_work_stealing() ? m_stealing_scheduled_job_count.load() : m_scheduled_jobs.size();
+    }
+
+    size_t get_running_job_count() const
+    {
+        return is_work_stealing() ? m_stealing_running_job_count.load() : m_running_jobs.size();
+    }
+
+    // Move all scheduled jobs from the per-worker deques to the shared list.
+    void gather_worker_queues()
+    {
+        for (each<WorkerQueueVector> i = m_worker_queues; i; ++i)
+        {
+            m_scheduled_jobs.splice(m_scheduled_jobs.end(), (*i)->m_jobs);
+            delete *i;
+        }
+
+        m_worker_queues.clear();
+        m_stealing_scheduled_job_count = 0;
+    }
+
+    // Append a scheduled job to the deque of a given worker.
+    void push_to_worker_queue(const JobInfo& job_info, const size_t queue_index)
+    {
+        // Count the job before it becomes visible so that the total job count never transiently drops to zero.
+        ++m_stealing_scheduled_job_count;
+
+        WorkerQueue& worker_queue = *m_worker_queues[queue_index];
+
+        {
+            Spinlock::ScopedLock worker_lock(worker_queue.m_spinlock);
+            worker_queue.m_jobs.push_back(job_info);
+        }
+
+        // Notify idle worker threads that a new scheduled job is available.
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_event.notify_all();
+    }
+
     static void delete_jobs(JobList& list)
     {
         for (each<JobList> i = list; i; ++i)
@@ -81,9 +159,10 @@ JobQueue::~JobQueue()
     // We assume that worker threads are not running, so we don't lock.
 
     // At this point, no job must be running.
-    assert(impl->m_running_jobs.empty());
+    assert(impl->get_running_job_count() == 0);
 
     // Delete all scheduled jobs that the queue owns.
+    impl->gather_worker_queues();
     Impl::delete_jobs(impl->m_scheduled_jobs);
 
     delete impl;
@@ -95,6 +174,13 @@ void JobQueue::clear_scheduled_jobs()
 
     impl->delete_jobs(impl->m_scheduled_jobs);
 
+    for (each<Impl::WorkerQueueVector> i = impl->m_worker_queues; i; ++i)
+    {
+        Spinlock::ScopedLock worker_lock((*i)->m_spinlock);
+        impl->m_stealing_scheduled_job_count -= (*i)->m_jobs.size();
+        impl->delete_jobs((*i)->m_jobs);
+    }
+
     // Notify worker threads that all scheduled jobs are gone.
     impl->m_event.notify_all();
 }
@@ -103,48 +189,61 @@ bool JobQueue::has_scheduled_jobs() const
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    return !impl->m_scheduled_jobs.empty();
+    return impl->get_scheduled_job_count() > 0;
 }
 
 bool JobQueue::has_running_jobs() const
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    return !impl->m_running_jobs.empty();
+    return impl->get_running_job_count() > 0;
 }
 
 bool JobQueue::has_scheduled_or_running_jobs() const
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    return !impl->m_scheduled_jobs.empty() || !impl->m_running_jobs.empty();
+    return impl->get_scheduled_job_count() > 0 || impl->get_running_job_count() > 0;
 }
 
 size_t JobQueue::get_scheduled_job_count() const
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    return impl->m_scheduled_jobs.size();
+    return impl->get_scheduled_job_count();
 }
 
 size_t JobQueue::get_running_job_count() const
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    return impl->m_running_jobs.size();
+    return impl->get_running_job_count();
 }
 
 size_t JobQueue::get_total_job_count() const
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    return impl->m_scheduled_jobs.size() + impl->m_running_jobs.size();
+    return impl->get_scheduled_job_count() + impl->get_running_job_count();
 }
 
 void JobQueue::schedule(IJob* job, const bool transfer_ownership)
 {
     assert(job);
 
+    if (impl->is_work_stealing())
+    {
+        // Restart the distribution from the first deque when the queue is idle, so that successive
+        // batches of identical jobs (e.g. the tiles of successive passes) map to the same workers.
+        if (impl->m_stealing_scheduled_job_count == 0 && impl->m_stealing_running_job_count == 0)
+            impl->m_next_worker_queue = 0;
+
+        // Distribute scheduled jobs over the per-worker deques in a round-robin fashion.
+        const size_t queue_index = impl->m_next_worker_queue++ % impl->m_worker_queues.size();
+        impl->push_to_worker_queue(JobInfo(job, transfer_ownership), queue_index);
+        return;
+    }
+
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
     impl->m_scheduled_jobs.push_back(JobInfo(job, transfer_ownership));
@@ -153,23 +252,121 @@ void JobQueue::schedule(IJob* job, const bool transfer_ownership)
     impl->m_event.notify_all();
 }
 
+void JobQueue::schedule_on_worker(
+    IJob*           job,
+    const size_t    worker_index,
+    const bool      transfer_ownership)
+{
+    assert(job);
+
+    if (!impl->is_work_stealing())
+    {
+        schedule(job, transfer_ownership);
+        return;
+    }
+
+    const size_t queue_index = worker_index % impl->m_worker_queues.size();
+    impl->push_to_worker_queue(JobInfo(job, transfer_ownership), queue_index);
+}
+
 void JobQueue::wait_until_completion()
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
     // Wait until there is no more scheduled or running jobs.
-    while (!impl->m_scheduled_jobs.empty() || !impl->m_running_jobs.empty())
+    while (impl->get_scheduled_job_count() > 0 || impl->get_running_job_count() > 0)
         impl->m_event.wait(lock);
 }
 
-JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job()
+void JobQueue::set_worker_queue_count(
+    const size_t    count,
+    const size_t    node_count)
+{
+    // Bring back all scheduled jobs to the shared list.
+    impl->gather_worker_queues();
+
+    if (count == 0)
+        return;
+
+    assert(impl->m_running_jobs.empty());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Impl::WorkerQueue* worker_queue = new Impl::WorkerQueue();
+        worker_queue->m_node = get_worker_numa_node(i, count, node_count);
+        impl->m_worker_queues.push_back(worker_queue);
+    }
+
+    // Distribute the scheduled jobs over the per-worker deques.
+    impl->m_stealing_scheduled_job_count = impl->m_scheduled_jobs.size();
+    impl->m_next_worker_queue = 0;
+    while (!impl->m_scheduled_jobs.empty())
+    {
+        const size_t queue_index = impl->m_next_worker_queue++ % count;
+        JobList& jobs = impl->m_worker_queues[queue_index]->m_jobs;
+        jobs.splice(jobs.end(), impl->m_scheduled_jobs, impl->m_scheduled_jobs.begin());
+    }
+}
+
+JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job(const size_t worker_index)
 {
+    if (impl->is_work_stealing())
+        return steal_scheduled_job(worker_index);
+
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
-    return acquire_scheduled_job_no_lock();
+    return acquire_scheduled_job_no_lock(worker_index);
+}
+
+size_t JobQueue::get_worker_numa_node(
+    const size_t    worker_index,
+    const size_t    worker_count,
+    const size_t    node_count)
+{
+    assert(worker_index < worker_count);
+    assert(node_count > 0);
+
+    return (worker_index * node_count) / worker_count;
 }
 
-JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job_no_lock()
+JobQueue::RunningJobInfo JobQueue::steal_scheduled_job(const size_t worker_index)
+{
+    const size_t queue_count = impl->m_worker_queues.size();
+    const size_t worker_node = impl->m_worker_queues[worker_index % queue_count]->m_node;
+
+    // First visit the deques of the workers on the same NUMA node, then the other deques.
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        for (size_t i = 0; i < queue_count; ++i)
+        {
+            // Start with the worker's own deque, then visit the other deques in turn.
+            Impl::WorkerQueue& worker_queue = *impl->m_worker_queues[(worker_index + i) % queue_count];
+            if ((worker_queue.m_node == worker_node) != (pass == 0))
+                continue;
+
+            Spinlock::ScopedLock worker_lock(worker_queue.m_spinlock);
+
+            if (worker_queue.m_jobs.empty())
+                continue;
+
+            // Take the oldest job from the worker's own deque, and the newest job from the other deques.
+            JobInfo job_info = i == 0 ? worker_queue.m_jobs.front() : worker_queue.m_jobs.back();
+            if (i == 0)
+                worker_queue.m_jobs.pop_front();
+            else worker_queue.m_jobs.pop_back();
+
+            // Update the counters, in this order so that the total job count never transiently drops to zero.
+            ++impl->m_stealing_running_job_count;
+            --impl->m_stealing_scheduled_job_count;
+
+            return RunningJobInfo(job_info, impl->m_running_jobs.end());
+        }
+    }
+
+    return RunningJobInfo(JobInfo(nullptr, false), impl->m_running_jobs.end());
+}
+
+JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job_no_lock(const size_t worker_index)
 {
     // Bail out if there is no scheduled job.
     if (impl->m_scheduled_jobs.empty())
@@ -186,19 +383,65 @@ JobQueue::RunningJobInfo JobQueue::acquire_scheduled_job_no_lock()
     return RunningJobInfo(job_info, pred(impl->m_running_jobs.end()));
 }
 
-JobQueue::RunningJobInfo JobQueue::wait_for_scheduled_job(AbortSwitch& abort_switch)
+JobQueue::RunningJobInfo JobQueue::wait_for_scheduled_job(
+    AbortSwitch&    abort_switch,
+    const size_t    worker_index)
 {
+    if (impl->is_work_stealing())
+    {
+        while (true)
+        {
+            // Try to acquire a job without taking the queue mutex.
+            const RunningJobInfo running_job_info = steal_scheduled_job(worker_index);
+            if (running_job_info.first.m_job != nullptr)
+                return running_job_info;
+
+            boost::mutex::scoped_lock lock(impl->m_mutex);
+
+            if (abort_switch.is_aborted())
+                return running_job_info;
+
+            // Scheduled jobs that were not found are being acquired by other workers, try again.
+            if (impl->m_stealing_scheduled_job_count > 0)
+            {
+                lock.unlock();
+                yield();
+                continue;
+            }
+
+            impl->m_event.wait(lock);
+        }
+    }
+
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
     // Wait for a scheduled job to be available.
     while (!abort_switch.is_aborted() && impl->m_scheduled_jobs.empty())    // order matters
         impl->m_event.wait(lock);
 
-    return acquire_scheduled_job_no_lock();
+    return acquire_scheduled_job_no_lock(worker_index);
 }
 
 void JobQueue::retire_running_job(const RunningJobInfo& running_job_info)
 {
+    if (impl->is_work_stealing())
+    {
+        // Delete the job.
+        if (running_job_info.first.m_owned)
+            delete running_job_info.first.m_job;
+
+        // Only notify the threads waiting for completion when the last job is retired;
+        // idle worker threads are only interested in newly scheduled jobs.
+        if (--impl->m_stealing_running_job_count == 0 &&
+            impl->m_stealing_scheduled_job_count == 0)
+        {
+            boost::mutex::scoped_lock lock(impl->m_mutex);
+            impl->m_event.notify_all();
+        }
+
+        return;
+    }
+
     boost::mutex::scoped_lock lock(impl->m_mutex);
 
     // Remove the job from the running list.
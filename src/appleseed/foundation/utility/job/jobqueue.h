@@ -52,6 +52,10 @@ DECLARE_TEST_CASE(Foundation_Utility_Job_JobQueue, AcquireScheduledJobWorksOnNon
 DECLARE_TEST_CASE(Foundation_Utility_Job_JobQueue, RetiringRunningJobWorks);
 DECLARE_TEST_CASE(Foundation_Utility_Job_JobQueue, RunningJobOwnedByQueueIsDestructedWhenRetired);
 DECLARE_TEST_CASE(Foundation_Utility_Job_JobQueue, RunningJobNotOwnedByQueueIsNotDestructedWhenRetired);
+DECLARE_TEST_CASE(Foundation_Utility_Job_JobQueue, SetWorkerQueueCount_PreservesScheduledJobs);
+DECLARE_TEST_CASE(Foundation_Utility_Job_JobQueue, AcquireScheduledJob_WorkStealingEnabled_StealsJobFromOtherWorker);
+DECLARE_TEST_CASE(Foundation_Utility_Job_JobQueue, AcquireScheduledJob_WorkStealingEnabledOnTwoNodes_StealsJobFromSameNodeFirst);
+DECLARE_TEST_CASE(Foundation_Utility_Job_JobQueue, ScheduleOnWorker_WorkStealingEnabled_WorkerAcquiresItsJobsFirst);
 
 namespace foundation
 {
@@ -66,6 +70,14 @@ namespace foundation
 //   - scheduled: the job was inserted into the job queue, but hasn't yet been executed
 //   - running: the job is currently being executed
 //
+// By default, all worker threads acquire jobs from a single, mutex-protected list.
+// When work stealing is enabled (see JobManager::WorkStealing), scheduled jobs are
+// instead distributed over one deque per worker thread, each protected by its own
+// spinlock. Worker threads take jobs from the front of their own deque and steal
+// jobs from the back of the other deques when their own deque is empty. When worker
+// threads are pinned to NUMA nodes (see JobManager::PinThreadsToNumaNodes), deques of
+// workers on the same node are visited before the others.
+//
 
 class APPLESEED_DLLSYMBOL JobQueue
   : public NonCopyable
@@ -102,10 +114,20 @@ class APPLESEED_DLLSYMBOL JobQueue
     // to the job queue if and only if transfer_ownership is true.
     void schedule(IJob* job, const bool transfer_ownership = true);
 
+    // Schedule a job for execution, preferably by a given worker thread. When work stealing
+    // is enabled, the job is appended to the deque of that worker (modulo the number of
+    // workers) and other workers only get it by stealing it; otherwise this is equivalent
+    // to schedule().
+    void schedule_on_worker(
+        IJob*           job,
+        const size_t    worker_index,
+        const bool      transfer_ownership = true);
+
     // Wait until all scheduled and running jobs are completed.
     void wait_until_completion();
 
   private:
+    friend class JobManager;
     friend class WorkerThread;
 
     struct Impl;
@@ -116,6 +138,10 @@ class APPLESEED_DLLSYMBOL JobQueue
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Utility_Job_JobQueue, RetiringRunningJobWorks);
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Utility_Job_JobQueue, RunningJobOwnedByQueueIsDestructedWhenRetired);
     GRANT_ACCESS_TO_TEST_CASE(Foundation_Utility_Job_JobQueue, RunningJobNotOwnedByQueueIsNotDestructedWhenRetired);
+    GRANT_ACCESS_TO_TEST_CASE(Foundation_Utility_Job_JobQueue, SetWorkerQueueCount_PreservesScheduledJobs);
+    GRANT_ACCESS_TO_TEST_CASE(Foundation_Utility_Job_JobQueue, AcquireScheduledJob_WorkStealingEnabled_StealsJobFromOtherWorker);
+    GRANT_ACCESS_TO_TEST_CASE(Foundation_Utility_Job_JobQueue, AcquireScheduledJob_WorkStealingEnabledOnTwoNodes_StealsJobFromSameNodeFirst);
+    GRANT_ACCESS_TO_TEST_CASE(Foundation_Utility_Job_JobQueue, ScheduleOnWorker_WorkStealingEnabled_WorkerAcquiresItsJobsFirst);
 
     struct JobInfo
     {
@@ -133,14 +159,32 @@ class APPLESEED_DLLSYMBOL JobQueue
 
     typedef std::pair<JobInfo, JobList::iterator> RunningJobInfo;
 
+    // Set the number of per-worker deques; 0 disables work stealing.
+    // Workers are assigned to NUMA nodes using get_worker_numa_node().
+    // Scheduled jobs are preserved. Not thread-safe.
+    void set_worker_queue_count(
+        const size_t    count,
+        const size_t    node_count = 1);
+
+    // Return the NUMA node of a given worker. Workers are split into contiguous blocks, one per node.
+    static size_t get_worker_numa_node(
+        const size_t    worker_index,
+        const size_t    worker_count,
+        const size_t    node_count);
+
     // Acquire a scheduled job and change its state from 'scheduled' to 'running'.
-    RunningJobInfo acquire_scheduled_job();
+    RunningJobInfo acquire_scheduled_job(const size_t worker_index = 0);
+
+    // Acquire a scheduled job without any locking of the shared list.
+    RunningJobInfo acquire_scheduled_job_no_lock(const size_t worker_index);
 
-    // Acquire a scheduled job without any locking.
-    RunningJobInfo acquire_scheduled_job_no_lock();
+    // Acquire a scheduled job from the per-worker deques, stealing from other workers if necessary.
+    RunningJobInfo steal_scheduled_job(const size_t worker_index);
 
     // Wait for a scheduled job to be available.
-    RunningJobInfo wait_for_scheduled_job(AbortSwitch& abort_switch);
+    RunningJobInfo wait_for_scheduled_job(
+        AbortSwitch&    abort_switch,
+        const size_t    worker_index = 0);
 
     // Retire a running job. The job is deleted if it is owned by the queue.
     void retire_running_job(const RunningJobInfo& running_job_info);
@@ -36,10 +36,12 @@
 #include "foundation/platform/sse.h"
 #endif
 #include "foundation/platform/types.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/job/ijob.h"
 #include "foundation/utility/job/jobmanager.h"
 #include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
 #include <exception>
@@ -59,8 +61,10 @@ WorkerThread::WorkerThread(
     const size_t    index,
     Logger&         logger,
     JobQueue&       job_queue,
-    const int       flags)
+    const int       flags,
+    const size_t    numa_node)
   : m_index(index)
+  , m_numa_node(numa_node)
   , m_logger(logger)
   , m_job_queue(job_queue)
   , m_flags(flags)
@@ -134,12 +138,30 @@ void WorkerThread::set_thread_name()
     char thread_name[16];
     portable_snprintf(thread_name, sizeof(thread_name), "worker_%03lu", (long unsigned int)m_index);
     set_current_thread_name(thread_name);
+    EventTracer::instance().set_current_thread_name(thread_name);
+}
+
+void WorkerThread::set_thread_numa_node()
+{
+    // Pin the thread before it executes any job so that the memory it first touches is local to its node.
+    if (!set_current_thread_numa_node(m_numa_node))
+    {
+        LOG_WARNING(
+            m_logger,
+            "failed to pin worker thread %s to numa node %s.",
+            pretty_uint(m_index).c_str(),
+            pretty_uint(m_numa_node).c_str());
+    }
 }
 
 void WorkerThread::run()
 {
     set_thread_name();
 
+    // Pinning threads is pointless on systems with a single NUMA node.
+    if ((m_flags & JobManager::PinThreadsToNumaNodes) && get_numa_node_count() > 1)
+        set_thread_numa_node();
+
 #if defined APPLESEED_WITH_EMBREE && defined APPLESEED_USE_SSE42
 
     //
@@ -171,7 +193,7 @@ void WorkerThread::run()
 
         // Acquire a job.
         const JobQueue::RunningJobInfo running_job_info =
-            m_job_queue.wait_for_scheduled_job(m_abort_switch);
+            m_job_queue.wait_for_scheduled_job(m_abort_switch, m_index);
 
         // Handle the case where the job queue is empty.
         if (running_job_info.first.m_job == nullptr)
@@ -62,7 +62,8 @@ class WorkerThread
         const size_t    index,
         Logger&         logger,
         JobQueue&       job_queue,
-        const int       flags);     // see foundation::JobManager::Flags
+        const int       flags,          // see foundation::JobManager::Flags
+        const size_t    numa_node = 0); // only used with foundation::JobManager::PinThreadsToNumaNodes
 
     // Destructor.
     ~WorkerThread();
@@ -98,6 +99,7 @@ class WorkerThread
     };
 
     const size_t                    m_index;
+    const size_t                    m_numa_node;
     Logger&                         m_logger;
     JobQueue&                       m_job_queue;
     const int                       m_flags;
@@ -112,6 +114,7 @@ class WorkerThread
     boost::mutex                    m_pause_mutex;
 
     void set_thread_name();
+    void set_thread_numa_node();
 
     // Main line of the worker thread.
     void run();
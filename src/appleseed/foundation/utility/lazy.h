@@ -32,6 +32,7 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/core/exceptions/exception.h"
+#include "foundation/platform/atomic.h"
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/cache.h"
@@ -98,11 +99,21 @@ class Lazy
     // Return the source object associated with that lazy object, if any.
     ObjectType* get_source_object() const;
 
+    // Delete the object if it was created by the factory and nobody is currently
+    // accessing it. The object will be created again on next access. Returns false
+    // if the object could not be released, including when the lazy object is busy.
+    bool release_object();
+
+    // Return a stamp of the last time access to the object was acquired. Stamps of
+    // all lazy objects are comparable and can be used to find least recently used ones.
+    uint64 get_access_stamp() const;
+
   private:
     template <typename> friend class Access;
 
     boost::mutex    m_mutex;
     int             m_reference_count;
+    boost::atomic<uint64> m_access_stamp;
 
     FactoryType*    m_factory;
     ObjectType*     m_source_object;
@@ -343,6 +354,7 @@ class AccessCacheMap
 template <typename Object>
 Lazy<Object>::Lazy(std::unique_ptr<FactoryType> factory)
   : m_reference_count(0)
+  , m_access_stamp(0)
   , m_factory(factory.release())
   , m_source_object(nullptr)
   , m_object(nullptr)
@@ -354,6 +366,7 @@ Lazy<Object>::Lazy(std::unique_ptr<FactoryType> factory)
 template <typename Object>
 Lazy<Object>::Lazy(ObjectType* source_object)
   : m_reference_count(0)
+  , m_access_stamp(0)
   , m_factory(nullptr)
   , m_source_object(source_object)
   , m_object(nullptr)
@@ -386,6 +399,36 @@ inline typename Lazy<Object>::ObjectType* Lazy<Object>::get_source_object() cons
     return m_source_object;
 }
 
+template <typename Object>
+bool Lazy<Object>::release_object()
+{
+    // Never wait: the caller may itself hold the lock of another lazy object.
+    boost::mutex::scoped_try_lock lock(m_mutex);
+
+    if (!lock.owns_lock() || m_reference_count > 0 || m_object == nullptr || m_factory == nullptr)
+        return false;
+
+    delete m_object;
+    m_object = nullptr;
+
+    return true;
+}
+
+template <typename Object>
+inline uint64 Lazy<Object>::get_access_stamp() const
+{
+    return m_access_stamp;
+}
+
+namespace lazy_impl
+{
+    inline uint64 next_access_stamp()
+    {
+        static boost::atomic<uint64> clock(0);
+        return ++clock;
+    }
+}
+
 
 //
 // Access class implementation.
@@ -436,6 +479,7 @@ void Access<Object>::reset(LazyType* lazy)
     {
         boost::mutex::scoped_lock lock(m_lazy->m_mutex);
         ++m_lazy->m_reference_count;
+        m_lazy->m_access_stamp = lazy_impl::next_access_stamp();
 
         // Create the object if it doesn't exist yet.
         if (m_lazy->m_object == nullptr)
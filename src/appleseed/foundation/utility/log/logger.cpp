@@ -40,7 +40,10 @@
 #include "foundation/utility/string.h"
 
 // Boost headers.
+#include "boost/atomic/atomic.hpp"
 #include "boost/date_time/posix_time/posix_time.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/tss.hpp"
 
 // Standard headers.
 #include <algorithm>
@@ -50,6 +53,9 @@
 #include <cstdlib>
 #include <list>
 #include <map>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 using namespace boost::posix_time;
@@ -196,6 +202,106 @@ namespace
         size_t              m_thread_count;
         ThreadIdToIntMap    m_thread_id_to_int;
     };
+
+    // A message pushed into a record queue in asynchronous mode.
+    struct AsyncRecord
+    {
+        LogMessage::Category    m_category;
+        const char*             m_file;
+        size_t                  m_line;
+        ptime                   m_datetime;
+        string                  m_message;
+    };
+
+    // A lock-free queue of messages with a single producer (the thread writing the messages)
+    // and a single consumer (whoever holds the logger's mutex). Records are reused when the
+    // queue wraps around, so once their strings have grown pushing does not allocate.
+    class RecordQueue
+      : public NonCopyable
+    {
+      public:
+        RecordQueue(
+            const size_t                thread,
+            const size_t                capacity)
+          : m_thread(thread)
+          , m_records(capacity)
+          , m_mask(capacity - 1)
+          , m_head(0)
+          , m_tail(0)
+        {
+            assert((capacity & (capacity - 1)) == 0);
+        }
+
+        size_t get_thread() const
+        {
+            return m_thread;
+        }
+
+        // Called by the producer. Return false if the queue is full.
+        bool push(
+            const LogMessage::Category  category,
+            const char*                 file,
+            const size_t                line,
+            const ptime&                datetime,
+            const char*                 message)
+        {
+            const size_t tail = m_tail.load(boost::memory_order_relaxed);
+
+            if (tail - m_head.load(boost::memory_order_acquire) == m_records.size())
+                return false;
+
+            AsyncRecord& record = m_records[tail & m_mask];
+            record.m_category = category;
+            record.m_file = file;
+            record.m_line = line;
+            record.m_datetime = datetime;
+            record.m_message.assign(message);
+
+            m_tail.store(tail + 1, boost::memory_order_release);
+
+            return true;
+        }
+
+        // Called by the consumer. Return nullptr if the queue is empty.
+        const AsyncRecord* front() const
+        {
+            const size_t head = m_head.load(boost::memory_order_relaxed);
+
+            return
+                head != m_tail.load(boost::memory_order_acquire)
+                    ? &m_records[head & m_mask]
+                    : nullptr;
+        }
+
+        // Called by the consumer, after front() returned a record.
+        void pop()
+        {
+            m_head.store(m_head.load(boost::memory_order_relaxed) + 1, boost::memory_order_release);
+        }
+
+        // Used by the producer to format messages.
+        vector<char>                    m_format_buffer;
+
+      private:
+        const size_t                    m_thread;
+        vector<AsyncRecord>             m_records;
+        const size_t                    m_mask;
+        boost::atomic<size_t>           m_head;
+        boost::atomic<size_t>           m_tail;
+    };
+
+    struct RepeatedMessage
+    {
+        size_t                  m_count;
+        const char*             m_file;
+        size_t                  m_line;
+        size_t                  m_thread;
+
+        RepeatedMessage()
+          : m_count(0)
+        {
+        }
+    };
 }
 
 
@@ -203,25 +309,241 @@ namespace
 // Logger class implementation.
 //
 
-struct Logger::Impl
-{
-    typedef list<ILogTarget*> LogTargetContainer;
-
-    boost::mutex            m_mutex;
-    bool                    m_enabled;
-    LogMessage::Category    m_verbosity_level;
-    LogTargetContainer      m_targets;
-    vector<char>            m_message_buffer;
-    ThreadMap               m_thread_map;
-    Formatter               m_formatter;
-};
-
 namespace
 {
     const size_t InitialBufferSize = 1024;      // in bytes
     const size_t MaxBufferSize = 1024 * 1024;   // in bytes
+    const size_t RecordQueueCapacity = 1024;    // in messages, must be a power of two
+    const long DispatchPeriod = 10;             // in milliseconds
+    const long RateLimitPeriod = 1000;          // in milliseconds
 }
 
+struct Logger::Impl
+{
+    typedef list<ILogTarget*> LogTargetContainer;
+    typedef list<unique_ptr<RecordQueue>> RecordQueueContainer;
+    typedef map<pair<LogMessage::Category, string>, RepeatedMessage> RepeatedMessageMap;
+
+    boost::mutex                        m_mutex;
+    boost::atomic<bool>                 m_enabled;
+    boost::atomic<LogMessage::Category> m_verbosity_level;
+    LogTargetContainer                  m_targets;
+    vector<char>                        m_message_buffer;
+    ThreadMap                           m_thread_map;
+    Formatter                           m_formatter;
+
+    // Thread-local message buffers are owned by the caller.
+    boost::thread_specific_ptr<MessageBuffer> m_thread_message_buffers;
+
+    // Asynchronous mode. Record queues are owned by the logger and outlive their
+    // threads; they are only consumed while holding m_mutex.
+    boost::mutex                        m_async_mode_mutex;
+    boost::atomic<bool>                 m_async;
+    RecordQueueContainer                m_record_queues;
+    boost::thread_specific_ptr<RecordQueue> m_thread_record_queues;
+    boost::thread                       m_dispatch_thread;
+    boost::mutex                        m_dispatch_mutex;
+    boost::condition_variable           m_dispatch_cond;
+    bool                                m_stop_dispatch;
+
+    // Rate limiting of repeated messages, protected by m_mutex.
+    size_t                              m_repeated_message_limit;
+    ptime                               m_rate_limit_period_start;
+    RepeatedMessageMap                  m_repeated_messages;
+
+    Impl()
+      : m_thread_message_buffers(&release_message_buffer)
+      , m_async(false)
+      , m_thread_record_queues(&release_record_queue)
+      , m_stop_dispatch(false)
+      , m_repeated_message_limit(0)
+      , m_rate_limit_period_start(microsec_clock::universal_time())
+    {
+    }
+
+    static void release_message_buffer(MessageBuffer*)
+    {
+    }
+
+    static void release_record_queue(RecordQueue*)
+    {
+    }
+
+    // Send a message to all log targets. The caller must hold m_mutex.
+    void send(
+        const LogMessage::Category  category,
+        const char*                 file,
+        const size_t                line,
+        const ptime&                datetime,
+        const size_t                thread,
+        const char*                 text)
+    {
+        // Format the header and message.
+        const FormatEvaluator format_evaluator(category, datetime, thread, text);
+        const string header = format_evaluator.evaluate(m_formatter.get_header_format(category));
+        string message = format_evaluator.evaluate(m_formatter.get_message_format(category));
+
+        // Remove trailing newline characters from the message.
+        message = trim_right(message, "\n");
+
+        if (!message.empty())
+        {
+            // Send the header and message to all log targets.
+            for (const_each<LogTargetContainer> i = m_targets; i; ++i)
+            {
+                ILogTarget* target = *i;
+                target->write(
+                    category,
+                    file,
+                    line,
+                    header.c_str(),
+                    message.c_str());
+            }
+        }
+    }
+
+    // Return the record queue of the calling thread, creating it if necessary.
+    RecordQueue& get_thread_record_queue()
+    {
+        RecordQueue* queue = m_thread_record_queues.get();
+
+        if (queue == nullptr)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            const size_t thread = m_thread_map.thread_id_to_int(boost::this_thread::get_id());
+            queue = new RecordQueue(thread, RecordQueueCapacity);
+            queue->m_format_buffer.resize(InitialBufferSize);
+
+            m_record_queues.push_back(unique_ptr<RecordQueue>(queue));
+            m_thread_record_queues.reset(queue);
+        }
+
+        return *queue;
+    }
+
+    // Send all pending messages in chronological order. The caller must hold m_mutex.
+    // Return true if at least one message was pending.
+    bool drain_record_queues()
+    {
+        bool drained = false;
+
+        while (true)
+        {
+            RecordQueue* oldest_queue = nullptr;
+            const AsyncRecord* oldest_record = nullptr;
+
+            for (const_each<RecordQueueContainer> i = m_record_queues; i; ++i)
+            {
+                const AsyncRecord* record = (*i)->front();
+
+                if (record != nullptr &&
+                    (oldest_record == nullptr || record->m_datetime < oldest_record->m_datetime))
+                {
+                    oldest_queue = i->get();
+                    oldest_record = record;
+                }
+            }
+
+            if (oldest_record == nullptr)
+                break;
+
+            dispatch(*oldest_record, oldest_queue->get_thread());
+            oldest_queue->pop();
+
+            drained = true;
+        }
+
+        return drained;
+    }
+
+    // Send a pending message unless it was repeated too often. The caller must hold m_mutex.
+    void dispatch(const AsyncRecord& record, const size_t thread)
+    {
+        if (m_repeated_message_limit > 0)
+        {
+            if (record.m_datetime - m_rate_limit_period_start >= milliseconds(RateLimitPeriod))
+                end_rate_limit_period(record.m_datetime);
+
+            RepeatedMessage& repeated_message =
+                m_repeated_messages[make_pair(record.m_category, record.m_message)];
+
+            if (++repeated_message.m_count > m_repeated_message_limit)
+            {
+                repeated_message.m_file = record.m_file;
+                repeated_message.m_line = record.m_line;
+                repeated_message.m_thread = thread;
+                return;
+            }
+        }
+
+        send(
+            record.m_category,
+            record.m_file,
+            record.m_line,
+            record.m_datetime,
+            thread,
+            record.m_message.c_str());
+    }
+
+    // Report suppressed messages and start a new rate limiting period. The caller must hold m_mutex.
+    void end_rate_limit_period(const ptime& datetime)
+    {
+        for (const_each<RepeatedMessageMap> i = m_repeated_messages; i; ++i)
+        {
+            const RepeatedMessage& repeated_message = i->second;
+
+            if (repeated_message.m_count > m_repeated_message_limit)
+            {
+                const size_t suppressed_count = repeated_message.m_count - m_repeated_message_limit;
+                const string text =
+                    i->first.second + " (" + to_string(suppressed_count) +
+                    (suppressed_count > 1 ? " more occurrences suppressed)" : " more occurrence suppressed)");
+
+                send(
+                    i->first.first,
+                    repeated_message.m_file,
+                    repeated_message.m_line,
+                    datetime,
+                    repeated_message.m_thread,
+                    text.c_str());
+            }
+        }
+
+        m_repeated_messages.clear();
+        m_rate_limit_period_start = datetime;
+    }
+
+    // Entry point of the thread that sends messages to the log targets in asynchronous mode.
+    void run_dispatch_loop()
+    {
+        while (true)
+        {
+            bool drained;
+
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+
+                drained = drain_record_queues();
+
+                // Report messages suppressed by a storm that has ended.
+                const ptime now(microsec_clock::universal_time());
+                if (!m_repeated_messages.empty() &&
+                    now - m_rate_limit_period_start >= milliseconds(RateLimitPeriod))
+                    end_rate_limit_period(now);
+            }
+
+            boost::mutex::scoped_lock lock(m_dispatch_mutex);
+
+            if (m_stop_dispatch)
+                break;
+
+            if (!drained)
+                m_dispatch_cond.timed_wait(lock, milliseconds(DispatchPeriod));
+        }
+    }
+};
+
 Logger::Logger()
   : impl(new Impl())
 {
@@ -232,6 +554,8 @@ Logger::Logger()
 
 Logger::~Logger()
 {
+    set_async_mode(false);
+
     delete impl;
 }
 
@@ -240,8 +564,10 @@ void Logger::initialize_from(const Logger& source)
     boost::mutex::scoped_lock source_lock(source.impl->m_mutex);
     boost::mutex::scoped_lock this_lock(impl->m_mutex);
 
-    impl->m_enabled = source.impl->m_enabled;
-    impl->m_verbosity_level = source.impl->m_verbosity_level;
+    impl->drain_record_queues();
+
+    impl->m_enabled = source.impl->m_enabled.load();
+    impl->m_verbosity_level = source.impl->m_verbosity_level.load();
 
     impl->m_targets.clear();
     for (const_each<Impl::LogTargetContainer> i = source.impl->m_targets; i; ++i)
@@ -257,42 +583,47 @@ void Logger::initialize_from(const Logger& source)
 void Logger::set_enabled(const bool enabled)
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->drain_record_queues();
     impl->m_enabled = enabled;
 }
 
 void Logger::set_verbosity_level(const LogMessage::Category level)
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->drain_record_queues();
     impl->m_verbosity_level = level;
 }
 
 LogMessage::Category Logger::get_verbosity_level() const
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
     return impl->m_verbosity_level;
 }
 
 void Logger::reset_all_formats()
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->drain_record_queues();
     impl->m_formatter.reset_all_formats();
 }
 
 void Logger::reset_format(const LogMessage::Category category)
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->drain_record_queues();
     impl->m_formatter.reset_format(category);
 }
 
 void Logger::set_all_formats(const char* format)
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->drain_record_queues();
     impl->m_formatter.set_all_formats(format);
 }
 
 void Logger::set_format(const LogMessage::Category category, const char* format)
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->drain_record_queues();
     impl->m_formatter.set_format(category, format);
 }
 
@@ -305,6 +636,7 @@ const char* Logger::get_format(const LogMessage::Category category) const
 void Logger::add_target(ILogTarget* target)
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->drain_record_queues();
 
     assert(target);
     impl->m_targets.push_back(target);
@@ -313,6 +645,7 @@ void Logger::add_target(ILogTarget* target)
 void Logger::remove_target(ILogTarget* target)
 {
     boost::mutex::scoped_lock lock(impl->m_mutex);
+    impl->drain_record_queues();
 
     assert(target);
     impl->m_targets.remove(target);
@@ -365,11 +698,53 @@ void Logger::write(
     const size_t                        line,
     APPLESEED_PRINTF_FMT const char*    format, ...)
 {
-    boost::mutex::scoped_lock lock(impl->m_mutex);
-
     if (category < impl->m_verbosity_level)
         return;
 
+    // In asynchronous mode, format the message text on the calling thread and push it
+    // into the thread's record queue without taking any lock.
+    if (impl->m_async && impl->m_enabled && category != LogMessage::Fatal)
+    {
+        RecordQueue& queue = impl->get_thread_record_queue();
+
+        // Format the message into the thread's buffer.
+        va_list argptr;
+        va_start(argptr, format);
+        const bool formatting_succeeded =
+            write_to_buffer(queue.m_format_buffer, MaxBufferSize, format, argptr);
+        va_end(argptr);
+
+        // If formatting failed, print the message as an error.
+        const LogMessage::Category effective_category =
+            formatting_succeeded ? category : LogMessage::Error;
+
+        // Keep the message aside if the calling thread is buffering its messages.
+        MessageBuffer* buffer = impl->m_thread_message_buffers.get();
+        if (buffer != nullptr)
+        {
+            BufferedMessage buffered_message;
+            buffered_message.m_category = effective_category;
+            buffered_message.m_file = file;
+            buffered_message.m_line = line;
+            buffered_message.m_message = &queue.m_format_buffer[0];
+            buffer->push_back(buffered_message);
+            return;
+        }
+
+        const ptime datetime(microsec_clock::universal_time());
+
+        // If the queue is full, wait for the dispatch thread to make room.
+        while (!queue.push(effective_category, file, line, datetime, &queue.m_format_buffer[0]))
+            boost::this_thread::yield();
+
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    // Messages pushed in asynchronous mode precede this one.
+    impl->drain_record_queues();
+
     LogMessage::Category effective_category = category;
 
     if (impl->m_enabled)
@@ -384,37 +759,98 @@ void Logger::write(
         if (!formatting_succeeded)
             effective_category = LogMessage::Error;
 
+        // Keep the message aside if the calling thread is buffering its messages.
+        MessageBuffer* buffer = impl->m_thread_message_buffers.get();
+        if (buffer != nullptr && effective_category != LogMessage::Fatal)
+        {
+            BufferedMessage buffered_message;
+            buffered_message.m_category = effective_category;
+            buffered_message.m_file = file;
+            buffered_message.m_line = line;
+            buffered_message.m_message = &impl->m_message_buffer[0];
+            buffer->push_back(buffered_message);
+            return;
+        }
+
         // Retrieve the current UTC time.
         const ptime datetime(microsec_clock::universal_time());
 
-        // Format the header and message.
-        const size_t thread = impl->m_thread_map.thread_id_to_int(boost::this_thread::get_id());
-        const FormatEvaluator format_evaluator(effective_category, datetime, thread, &impl->m_message_buffer[0]);
-        const string header = format_evaluator.evaluate(impl->m_formatter.get_header_format(effective_category));
-        string message = format_evaluator.evaluate(impl->m_formatter.get_message_format(effective_category));
+        // Send the message to all log targets.
+        impl->send(
+            effective_category,
+            file,
+            line,
+            datetime,
+            impl->m_thread_map.thread_id_to_int(boost::this_thread::get_id()),
+            &impl->m_message_buffer[0]);
+    }
 
-        // Remove trailing newline characters from the message.
-        message = trim_right(message, "\n");
+    // Terminate the application if the message category is 'Fatal'.
+    if (effective_category == LogMessage::Fatal)
+        exit(EXIT_FAILURE);
+}
+
+void Logger::set_async_mode(const bool enabled)
+{
+    boost::mutex::scoped_lock async_mode_lock(impl->m_async_mode_mutex);
+
+    if (enabled == impl->m_async)
+        return;
+
+    if (enabled)
+    {
+        impl->m_stop_dispatch = false;
+        impl->m_dispatch_thread = boost::thread(&Impl::run_dispatch_loop, impl);
+        impl->m_async = true;
+    }
+    else
+    {
+        impl->m_async = false;
 
-        if (!message.empty())
         {
-            // Send the header and message to all log targets.
-            for (const_each<Impl::LogTargetContainer> i = impl->m_targets; i; ++i)
-            {
-                ILogTarget* target = *i;
-                target->write(
-                    effective_category,
-                    file,
-                    line,
-                    header.c_str(),
-                    message.c_str());
-            }
+            boost::mutex::scoped_lock lock(impl->m_dispatch_mutex);
+            impl->m_stop_dispatch = true;
+            impl->m_dispatch_cond.notify_all();
         }
+
+        impl->m_dispatch_thread.join();
+
+        flush();
     }
+}
 
-    // Terminate the application if the message category is 'Fatal'.
-    if (effective_category == LogMessage::Fatal)
-        exit(EXIT_FAILURE);
+bool Logger::is_async_mode() const
+{
+    return impl->m_async;
+}
+
+void Logger::flush()
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    impl->drain_record_queues();
+    impl->end_rate_limit_period(microsec_clock::universal_time());
+}
+
+void Logger::set_repeated_message_limit(const size_t limit)
+{
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    impl->drain_record_queues();
+    impl->end_rate_limit_period(microsec_clock::universal_time());
+
+    impl->m_repeated_message_limit = limit;
+}
+
+void Logger::set_thread_message_buffer(MessageBuffer* buffer)
+{
+    impl->m_thread_message_buffers.reset(buffer);
+}
+
+void Logger::write_buffered_messages(const MessageBuffer& buffer)
+{
+    for (const_each<MessageBuffer> i = buffer; i; ++i)
+        write(i->m_category, i->m_file, i->m_line, "%s", i->m_message.c_str());
 }
 
 }   // namespace foundation
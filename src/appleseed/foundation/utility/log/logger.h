@@ -40,6 +40,7 @@
 // Standard headers.
 #include <cstddef>
 #include <string>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class ILogTarget; }
@@ -52,11 +53,27 @@ namespace foundation
 //
 // All methods of this class are thread-safe.
 //
+// By default, messages are formatted and sent to the log targets on the calling thread,
+// under a lock. In asynchronous mode, the calling thread only formats the message text
+// and pushes it into a lock-free queue of its own; a dedicated thread drains the queues
+// and sends the messages to the log targets, optionally suppressing repeated messages.
+//
 
 class APPLESEED_DLLSYMBOL Logger
   : public NonCopyable
 {
   public:
+    // A message kept aside by a thread-local message buffer.
+    struct BufferedMessage
+    {
+        LogMessage::Category    m_category;
+        const char*             m_file;
+        size_t                  m_line;
+        std::string             m_message;
+    };
+
+    typedef std::vector<BufferedMessage> MessageBuffer;
+
     // Constructor.
     Logger();
 
@@ -112,6 +129,28 @@ class APPLESEED_DLLSYMBOL Logger
         APPLESEED_PRINTF_FMT const char*    format, ...)
         APPLESEED_PRINTF_FMT_ATTR(5, 6);
 
+    // Enable/disable asynchronous mode. Disabling it writes all pending messages.
+    // Fatal messages are always written synchronously, after all pending messages.
+    void set_async_mode(const bool enabled = true);
+    bool is_async_mode() const;
+
+    // Write all messages pushed so far in asynchronous mode, as well as the number of
+    // messages suppressed so far, before returning.
+    void flush();
+
+    // In asynchronous mode, only write the first `limit` occurrences per second of a given
+    // message (same category, same text); the number of suppressed occurrences is written
+    // when the second ends. A limit of 0 (the default) disables rate limiting.
+    void set_repeated_message_limit(const size_t limit);
+
+    // Append the messages subsequently written by the calling thread to a given buffer
+    // instead of sending them to the log targets. Pass nullptr to stop buffering.
+    // Fatal messages are never buffered. The buffer must outlive its use by the logger.
+    void set_thread_message_buffer(MessageBuffer* buffer);
+
+    // Write a set of buffered messages, in order.
+    void write_buffered_messages(const MessageBuffer& buffer);
+
   private:
     struct Impl;
     Impl* impl;
@@ -30,12 +30,22 @@
 // Interface header.
 #include "memory.h"
 
+// appleseed.foundation headers.
+#ifdef _WIN32
+#include "foundation/platform/windows.h"
+#endif
+
 // appleseed.main headers.
 #include "main/allocator.h"
 
 // Standard headers.
 #include <cstdlib>
 
+// Platform headers.
+#if defined __linux__
+#include <sys/mman.h>
+#endif
+
 using namespace std;
 
 namespace foundation
@@ -45,6 +55,128 @@ namespace foundation
 // Memory-alignment related functions implementation.
 //
 
+namespace
+{
+    // Header stored immediately before every block returned by aligned_malloc().
+    struct AlignedBlockHeader
+    {
+        void*       m_unaligned_ptr;
+        size_t      m_size;
+        MemoryTag   m_tag;
+        bool        m_huge_pages;       // was the block mapped on huge pages?
+    };
+
+    const size_t HugePageSize2MB = size_t(1) << 21;
+    const size_t HugePageSize1GB = size_t(1) << 30;
+
+    size_t get_huge_page_size(const HugePageMode mode)
+    {
+        return mode == HugePages1GB ? HugePageSize1GB : HugePageSize2MB;
+    }
+
+    size_t round_up_to_page(const size_t size, const size_t page_size)
+    {
+        return (size + page_size - 1) & ~(page_size - 1);
+    }
+
+    // Map a block of memory backed by huge pages. On success, size is rounded up
+    // to the size actually mapped. Returns nullptr if the mapping failed.
+    uint8* map_huge_pages(size_t& size, const HugePageMode mode)
+    {
+#if defined __linux__
+
+        if (mode == HugePagesTransparent)
+        {
+            size = round_up_to_page(size, HugePageSize2MB);
+
+            // Over-map by one huge page so that the block can be aligned on a huge page boundary.
+            const size_t mapped_size = size + HugePageSize2MB;
+            void* ptr = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED)
+                return nullptr;
+
+            // Release the unaligned head and the tail of the mapping.
+            uint8* const unaligned_ptr = static_cast<uint8*>(ptr);
+            uint8* const aligned_ptr = align(unaligned_ptr, HugePageSize2MB);
+            const size_t head_size = aligned_ptr - unaligned_ptr;
+            const size_t tail_size = mapped_size - head_size - size;
+            if (head_size > 0)
+                munmap(unaligned_ptr, head_size);
+            if (tail_size > 0)
+                munmap(aligned_ptr + size, tail_size);
+
+#ifdef MADV_HUGEPAGE
+            madvise(aligned_ptr, size, MADV_HUGEPAGE);
+#endif
+
+            return aligned_ptr;
+        }
+
+#if defined MAP_HUGETLB
+
+        // Page sizes are encoded in the mapping flags as log2(page size) << MAP_HUGE_SHIFT.
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+        const int page_size_flag = (mode == HugePages1GB ? 30 : 21) << MAP_HUGE_SHIFT;
+
+        size = round_up_to_page(size, get_huge_page_size(mode));
+
+        void* ptr =
+            mmap(
+                nullptr,
+                size,
+                PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | page_size_flag,
+                -1,
+                0);
+
+        return ptr == MAP_FAILED ? nullptr : static_cast<uint8*>(ptr);
+
+#else
+
+        return nullptr;
+
+#endif
+
+#elif defined _WIN32
+
+        // Windows only provides explicit large pages, of a single size. Using them
+        // requires the SeLockMemoryPrivilege privilege, VirtualAlloc() fails otherwise.
+        if (mode == HugePagesTransparent)
+            return nullptr;
+
+        const size_t page_size = GetLargePageMinimum();
+        if (page_size == 0)
+            return nullptr;
+
+        size = round_up_to_page(size, page_size);
+
+        return
+            static_cast<uint8*>(
+                VirtualAlloc(
+                    nullptr,
+                    size,
+                    MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                    PAGE_READWRITE));
+
+#else
+
+        return nullptr;
+
+#endif
+    }
+
+    void unmap_huge_pages(void* ptr, const size_t size)
+    {
+#if defined __linux__
+        munmap(ptr, size);
+#elif defined _WIN32
+        VirtualFree(ptr, 0, MEM_RELEASE);
+#endif
+    }
+}
+
 void* aligned_malloc(const size_t size, size_t alignment)
 {
     // Often, the value of alignment is set to the line size of the L1 data cache as
@@ -58,11 +190,32 @@ void* aligned_malloc(const size_t size, size_t alignment)
     assert(size > 0);
     assert(is_pow2(alignment));
 
+    // Make sure the block header is itself properly aligned.
+    if (alignment < alignof(AlignedBlockHeader))
+        alignment = alignof(AlignedBlockHeader);
+
     // Compute the total number of bytes of memory we need to allocate.
-    const size_t total_size = size + sizeof(void*) + (alignment - 1);
+    size_t total_size = size + sizeof(AlignedBlockHeader) + (alignment - 1);
+
+    // Place large enough blocks on huge pages if this is enabled for the current memory tag.
+    const MemoryTag tag = get_current_memory_tag();
+    const HugePageMode huge_page_mode = get_huge_page_mode(tag);
+    uint8* unaligned_ptr = nullptr;
+    bool huge_pages = false;
+    if (huge_page_mode != HugePagesOff && total_size >= get_huge_page_size(huge_page_mode))
+    {
+        size_t mapped_size = total_size;
+        unaligned_ptr = map_huge_pages(mapped_size, huge_page_mode);
+        if (unaligned_ptr)
+        {
+            total_size = mapped_size;
+            huge_pages = true;
+        }
+    }
 
     // Allocate the memory.
-    void** const unaligned_ptr = reinterpret_cast<void**>(malloc(total_size));
+    if (!huge_pages)
+        unaligned_ptr = reinterpret_cast<uint8*>(malloc(total_size));
 
     // Handle allocation failures.
     if (!unaligned_ptr)
@@ -72,12 +225,19 @@ void* aligned_malloc(const size_t size, size_t alignment)
     }
 
     // Compute the next aligned address.
-    void** const aligned_ptr = align(unaligned_ptr + 1, alignment);
+    uint8* const aligned_ptr = align(unaligned_ptr + sizeof(AlignedBlockHeader), alignment);
 
-    // Store the address of the unaligned memory block.
-    *(aligned_ptr - 1) = unaligned_ptr;
+    // Store the address of the unaligned memory block and the memory tag it is attributed to.
+    AlignedBlockHeader* header = reinterpret_cast<AlignedBlockHeader*>(aligned_ptr) - 1;
+    header->m_unaligned_ptr = unaligned_ptr;
+    header->m_size = total_size;
+    header->m_tag = tag;
+    header->m_huge_pages = huge_pages;
 
     log_allocation(aligned_ptr, total_size);
+    log_tagged_allocation(tag, total_size);
+    if (huge_pages)
+        log_huge_page_allocation(tag, total_size);
 
     return aligned_ptr;
 }
@@ -86,13 +246,22 @@ void aligned_free(void* aligned_ptr)
 {
     assert(aligned_ptr);
 
-    // Retrieve the address of the unaligned memory block.
-    void* unaligned_ptr = *(reinterpret_cast<void**>(aligned_ptr) - 1);
+    // Retrieve the block header.
+    const AlignedBlockHeader* header = reinterpret_cast<AlignedBlockHeader*>(aligned_ptr) - 1;
+    void* unaligned_ptr = header->m_unaligned_ptr;
+    const size_t total_size = header->m_size;
+    const MemoryTag tag = header->m_tag;
+    const bool huge_pages = header->m_huge_pages;
 
     // Deallocate the memory.
-    free(unaligned_ptr);
+    if (huge_pages)
+        unmap_huge_pages(unaligned_ptr, total_size);
+    else free(unaligned_ptr);
 
     log_deallocation(aligned_ptr);
+    log_tagged_deallocation(tag, total_size);
+    if (huge_pages)
+        log_huge_page_deallocation(tag, total_size);
 }
 
 }   // namespace foundation
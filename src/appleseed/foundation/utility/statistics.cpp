@@ -31,6 +31,7 @@
 #include "statistics.h"
 
 // appleseed.foundation headers.
+#include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
 
 using namespace std;
@@ -121,6 +122,19 @@ string Statistics::to_string(const size_t max_header_length) const
     return sstr.str();
 }
 
+Dictionary Statistics::to_dictionary() const
+{
+    Dictionary dictionary;
+
+    for (const_each<EntryVector> i = m_entries; i; ++i)
+    {
+        const Entry* entry = *i;
+        dictionary.insert(entry->m_name, entry->to_string());
+    }
+
+    return dictionary;
+}
+
 
 //
 // Statistics::ExceptionDuplicateName class implementation.
@@ -335,4 +349,14 @@ string StatisticsVector::to_string(const size_t max_header_length) const
     return sstr.str();
 }
 
+Dictionary StatisticsVector::to_dictionary() const
+{
+    Dictionary dictionary;
+
+    for (const_each<NamedStatisticsVector> i = m_stats; i; ++i)
+        dictionary.insert(i->m_name, i->m_stats.to_dictionary());
+
+    return dictionary;
+}
+
 }   // namespace foundation
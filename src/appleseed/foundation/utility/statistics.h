@@ -47,6 +47,9 @@
 #include <string>
 #include <vector>
 
+// Forward declarations.
+namespace foundation    { class Dictionary; }
+
 namespace foundation
 {
 
@@ -246,6 +249,9 @@ class Statistics
 
     std::string to_string(const size_t max_header_length = 30) const;
 
+    // Return the statistics as a dictionary of formatted values indexed by name.
+    Dictionary to_dictionary() const;
+
   private:
     typedef std::vector<Entry*> EntryVector;
     typedef std::map<std::string, Entry*> EntryIndex;
@@ -277,6 +283,9 @@ class StatisticsVector
 
     std::string to_string(const size_t max_header_length = 30) const;
 
+    // Return the statistics as a dictionary of child dictionaries indexed by name.
+    Dictionary to_dictionary() const;
+
   private:
     struct NamedStatistics
     {
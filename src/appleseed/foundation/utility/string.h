@@ -44,6 +44,7 @@
 #include <cassert>
 #include <cctype>
 #include <cstddef>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <ios>
@@ -234,6 +235,27 @@ std::string get_time_stamp_string();
 std::string replace_special_xml_characters(const std::string& s);
 
 
+//
+// Hash and equality functors accepting both C strings and C++ strings. They allow looking
+// up C strings in hash tables keyed by C++ strings without building temporary strings,
+// using for instance the heterogeneous find() method of boost::unordered_map.
+//
+
+struct StringHash
+{
+    size_t operator()(const char* s) const;
+    size_t operator()(const std::string& s) const;
+};
+
+struct StringEqual
+{
+    bool operator()(const char* lhs, const char* rhs) const;
+    bool operator()(const char* lhs, const std::string& rhs) const;
+    bool operator()(const std::string& lhs, const char* rhs) const;
+    bool operator()(const std::string& lhs, const std::string& rhs) const;
+};
+
+
 //
 // Fast alternative to std::strtol().
 //
@@ -895,6 +917,63 @@ inline std::string replace_special_xml_characters(const std::string& s)
 }
 
 
+//
+// StringHash and StringEqual functors implementation.
+//
+
+namespace impl
+{
+    // 64-bit FNV-1a hash.
+    inline uint64 hash_chars(const char* s, const char* end)
+    {
+        uint64 h = 14695981039346656037ULL;
+
+        for (; s != end; ++s)
+        {
+            h ^= static_cast<unsigned char>(*s);
+            h *= 1099511628211ULL;
+        }
+
+        return h;
+    }
+}
+
+inline size_t StringHash::operator()(const char* s) const
+{
+    assert(s);
+    return static_cast<size_t>(impl::hash_chars(s, s + std::strlen(s)));
+}
+
+inline size_t StringHash::operator()(const std::string& s) const
+{
+    return static_cast<size_t>(impl::hash_chars(s.data(), s.data() + s.size()));
+}
+
+inline bool StringEqual::operator()(const char* lhs, const char* rhs) const
+{
+    assert(lhs);
+    assert(rhs);
+    return std::strcmp(lhs, rhs) == 0;
+}
+
+inline bool StringEqual::operator()(const char* lhs, const std::string& rhs) const
+{
+    assert(lhs);
+    return rhs.compare(lhs) == 0;
+}
+
+inline bool StringEqual::operator()(const std::string& lhs, const char* rhs) const
+{
+    assert(rhs);
+    return lhs.compare(rhs) == 0;
+}
+
+inline bool StringEqual::operator()(const std::string& lhs, const std::string& rhs) const
+{
+    return lhs == rhs;
+}
+
+
 //
 // Fast string-to-number functions implementation.
 //
@@ -49,6 +49,7 @@
 #include <memory>
 #include <stack>
 #include <string>
+#include <utility>
 
 // Forward declarations.
 namespace foundation    { class Logger; }
@@ -264,11 +265,15 @@ class SAX2ContentHandler
         ElementHandlerFactoryType*  m_handler_factory;
     };
 
-    typedef std::map<std::string, FactoryInfo> FactoryInfoMap;
-    typedef std::stack<ElementHandlerType*> ElementHandlerStack;
+    // Factories are looked up by untranscoded element names, and each open element remembers
+    // its factory, so that elements are dispatched without allocating or transcoding strings.
+    typedef std::map<std::basic_string<XMLCh>, FactoryInfo> FactoryInfoMap;
+    typedef std::pair<ElementHandlerType*, const FactoryInfo*> OpenElement;
+    typedef std::stack<OpenElement> ElementHandlerStack;
 
     FactoryInfoMap                  m_factory_info;
     ElementHandlerStack             m_handler_stack;
+    std::basic_string<XMLCh>        m_element_name;
 };
 
 
@@ -401,7 +406,7 @@ template <typename ElementID>
 SAX2ContentHandler<ElementID>::SAX2ContentHandler()
 {
     // Push a dummy element handler on the stack to avoid special-casing for an empty stack.
-    m_handler_stack.push(new ElementHandlerBase<ElementID>());
+    m_handler_stack.push(OpenElement(new ElementHandlerBase<ElementID>(), nullptr));
 }
 
 template <typename ElementID>
@@ -409,7 +414,7 @@ SAX2ContentHandler<ElementID>::~SAX2ContentHandler()
 {
     while (!m_handler_stack.empty())
     {
-        delete m_handler_stack.top();
+        delete m_handler_stack.top().first;
         m_handler_stack.pop();
     }
 
@@ -428,7 +433,7 @@ void SAX2ContentHandler<ElementID>::register_factory(
     FactoryInfo info;
     info.m_id = id;
     info.m_handler_factory = handler_factory.release();
-    m_factory_info[name] = info;
+    m_factory_info[transcode(name)] = info;
 }
 
 template <typename ElementID>
@@ -438,10 +443,13 @@ void SAX2ContentHandler<ElementID>::startElement(
     const XMLCh* const                          qname,
     const xercesc::Attributes&                  attrs)
 {
+    m_element_name.assign(localname);
+
     const typename FactoryInfoMap::const_iterator it =
-        m_factory_info.find(transcode(localname));
+        m_factory_info.find(m_element_name);
 
     ElementHandlerType* handler;
+    const FactoryInfo* info = nullptr;
 
     if (it == m_factory_info.end())
     {
@@ -449,12 +457,13 @@ void SAX2ContentHandler<ElementID>::startElement(
     }
     else
     {
-        handler = it->second.m_handler_factory->create().release();
+        info = &it->second;
+        handler = info->m_handler_factory->create().release();
 
-        m_handler_stack.top()->start_child_element(it->second.m_id, handler);
+        m_handler_stack.top().first->start_child_element(info->m_id, handler);
     }
 
-    m_handler_stack.push(handler);
+    m_handler_stack.push(OpenElement(handler, info));
 
     handler->start_element(attrs);
 }
@@ -465,17 +474,15 @@ void SAX2ContentHandler<ElementID>::endElement(
     const XMLCh* const                          localname,
     const XMLCh* const                          qname)
 {
-    ElementHandlerType* handler = m_handler_stack.top();
+    ElementHandlerType* handler = m_handler_stack.top().first;
+    const FactoryInfo* info = m_handler_stack.top().second;
 
     handler->end_element();
 
     m_handler_stack.pop();
 
-    const typename FactoryInfoMap::const_iterator it =
-        m_factory_info.find(transcode(localname));
-
-    if (it != m_factory_info.end())
-        m_handler_stack.top()->end_child_element(it->second.m_id, handler);
+    if (info)
+        m_handler_stack.top().first->end_child_element(info->m_id, handler);
 
     delete handler;
 }
@@ -487,7 +494,7 @@ void SAX2ContentHandler<ElementID>::characters(
 {
     assert(!m_handler_stack.empty());
 
-    m_handler_stack.top()->characters(chars, length);
+    m_handler_stack.top().first->characters(chars, length);
 }
 
 }   // namespace foundation
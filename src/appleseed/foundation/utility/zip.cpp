@@ -30,6 +30,8 @@
 #include "zip.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/memorymappedfile.h"
+#include "foundation/utility/countof.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/minizip/unzip.h"
 #include "foundation/utility/minizip/zip.h"
@@ -39,9 +41,13 @@
 #include "boost/filesystem.hpp"
 
 // Standard headers.
+#include <algorithm>
+#include <cstring>
 #include <ctime>
 #include <fstream>
+#include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 using namespace std;
@@ -190,15 +196,43 @@ namespace
             throw ZipException("error while writing to zip", err);
     }
 
+    bool is_compressed_file_format(const string& filename)
+    {
+        static const char* Extensions[] =
+        {
+            ".binarycurve",
+            ".binarymesh",
+            ".exr",
+            ".jpeg",
+            ".jpg",
+            ".png",
+            ".tx"
+        };
+
+        const string extension = lower_case(bf::path(filename).extension().string());
+
+        for (size_t i = 0; i < countof(Extensions); ++i)
+        {
+            if (extension == Extensions[i])
+                return true;
+        }
+
+        return false;
+    }
+
     void open_new_file_in_zip(zipFile& zip_file, string filename_in_zip, zip_fileinfo zip_file_info)
     {
+        // Deflating files that are already compressed gains little, and storing them
+        // allows ZipArchive to read them directly from a memory mapping of the archive.
+        const int method = is_compressed_file_format(filename_in_zip) ? 0 : Z_DEFLATED;
+
         const int err =
             zipOpenNewFileInZip(
                 zip_file,
                 filename_in_zip.c_str(),
                 &zip_file_info,
                 nullptr, 0, nullptr, 0, nullptr,
-                Z_DEFLATED,
+                method,
                 Z_DEFAULT_COMPRESSION);
 
         if (err != ZIP_OK)
@@ -369,4 +403,256 @@ set<string> recursive_ls(const bf::path& dir)
     return files;
 }
 
+
+//
+// ZipArchive class implementation.
+//
+
+struct ZipArchive::Impl
+{
+    struct Entry
+    {
+        unz64_file_pos          m_position;
+        size_t                  m_size;
+        bool                    m_stored;
+        const char*             m_mapped_data;
+    };
+
+    string                      m_zip_filename;
+    unzFile                     m_zip_file;
+    vector<string>              m_entry_names;
+    map<string, Entry>          m_entries;
+    MemoryMappedFile            m_mapping;
+
+    Impl()
+      : m_zip_file(nullptr)
+    {
+    }
+
+    Entry& get_entry(const string& name)
+    {
+        if (m_zip_file == nullptr)
+            throw ZipException("zip archive is not open");
+
+        const map<string, Entry>::iterator i = m_entries.find(name);
+        if (i == m_entries.end())
+            throw ZipException(("can't find file " + name + " inside zip").c_str());
+
+        return i->second;
+    }
+
+    void go_to_entry(const Entry& entry)
+    {
+        const int err = unzGoToFilePos64(m_zip_file, &entry.m_position);
+        if (err != UNZ_OK)
+            throw ZipException("can't locate file inside zip: ", err);
+    }
+
+    const char* map_stored_entry(Entry& entry)
+    {
+        if (!entry.m_stored)
+            return nullptr;
+
+        if (entry.m_mapped_data == nullptr)
+        {
+            if (!m_mapping.is_open() && !m_mapping.open(m_zip_filename.c_str()))
+                throw ZipException(("can't map file " + m_zip_filename + " into memory").c_str());
+
+            // Opening a stored entry positions the stream on its first byte of data.
+            go_to_entry(entry);
+            open_current_file(m_zip_file);
+            const ZPOS64_T offset = unzGetCurrentFileZStreamPos64(m_zip_file);
+            unzCloseCurrentFile(m_zip_file);
+
+            if (offset > m_mapping.size() || entry.m_size > m_mapping.size() - offset)
+                throw ZipException("file inside zip extends past the end of the archive");
+
+            entry.m_mapped_data = static_cast<const char*>(m_mapping.data()) + offset;
+        }
+
+        return entry.m_mapped_data;
+    }
+};
+
+ZipArchive::ZipArchive()
+  : impl(new Impl())
+{
+}
+
+ZipArchive::~ZipArchive()
+{
+    close();
+
+    delete impl;
+}
+
+void ZipArchive::open(const string& zip_filename)
+{
+    close();
+
+    impl->m_zip_file = unzOpen64(zip_filename.c_str());
+    if (impl->m_zip_file == nullptr)
+        throw ZipException(("can't open file " + zip_filename).c_str());
+
+    impl->m_zip_filename = zip_filename;
+
+    try
+    {
+        int has_next = unzGoToFirstFile(impl->m_zip_file);
+        while (has_next == UNZ_OK)
+        {
+            const string filename = read_filename(impl->m_zip_file);
+
+            if (!is_zip_entry_directory(filename))
+            {
+                unz_file_info64 zip_file_info;
+                int err =
+                    unzGetCurrentFileInfo64(
+                        impl->m_zip_file,
+                        &zip_file_info,
+                        nullptr, 0,
+                        nullptr, 0,
+                        nullptr, 0);
+                if (err != UNZ_OK)
+                    throw ZipException("can't read file information inside zip: ", err);
+
+                Impl::Entry entry;
+                err = unzGetFilePos64(impl->m_zip_file, &entry.m_position);
+                if (err != UNZ_OK)
+                    throw ZipException("can't read file position inside zip: ", err);
+
+                // Only stored entries that are not encrypted can be read in place.
+                entry.m_size = static_cast<size_t>(zip_file_info.uncompressed_size);
+                entry.m_stored = zip_file_info.compression_method == 0 && (zip_file_info.flag & 1) == 0;
+                entry.m_mapped_data = nullptr;
+
+                if (impl->m_entries.insert(make_pair(filename, entry)).second)
+                    impl->m_entry_names.push_back(filename);
+            }
+
+            has_next = unzGoToNextFile(impl->m_zip_file);
+        }
+    }
+    catch (const ZipException&)
+    {
+        close();
+        throw;
+    }
+}
+
+void ZipArchive::close()
+{
+    impl->m_mapping.close();
+
+    if (impl->m_zip_file)
+    {
+        unzClose(impl->m_zip_file);
+        impl->m_zip_file = nullptr;
+    }
+
+    impl->m_zip_filename.clear();
+    impl->m_entry_names.clear();
+    impl->m_entries.clear();
+}
+
+bool ZipArchive::is_open() const
+{
+    return impl->m_zip_file != nullptr;
+}
+
+const vector<string>& ZipArchive::get_entry_names() const
+{
+    return impl->m_entry_names;
+}
+
+bool ZipArchive::has_entry(const string& name) const
+{
+    return impl->m_entries.find(name) != impl->m_entries.end();
+}
+
+size_t ZipArchive::get_entry_size(const string& name) const
+{
+    return impl->get_entry(name).m_size;
+}
+
+const void* ZipArchive::map_entry(const string& name)
+{
+    return impl->map_stored_entry(impl->get_entry(name));
+}
+
+void ZipArchive::read_entry(const string& name, vector<char>& contents)
+{
+    Impl::Entry& entry = impl->get_entry(name);
+
+    contents.resize(entry.m_size);
+
+    if (const char* data = impl->map_stored_entry(entry))
+    {
+        if (entry.m_size > 0)
+            memcpy(&contents[0], data, entry.m_size);
+        return;
+    }
+
+    impl->go_to_entry(entry);
+    open_current_file(impl->m_zip_file);
+
+    size_t offset = 0;
+    while (offset < entry.m_size)
+    {
+        const size_t MaxChunkSize = 1024 * 1024;
+
+        const size_t read =
+            read_chunk(
+                impl->m_zip_file,
+                &contents[offset],
+                min(entry.m_size - offset, MaxChunkSize));
+
+        if (read == 0)
+            break;
+
+        offset += read;
+    }
+
+    unzip_close_current_file(impl->m_zip_file);
+
+    if (offset != entry.m_size)
+        throw ZipException(("unexpected end of file " + name + " inside zip").c_str());
+}
+
+void ZipArchive::extract_entry(const string& name, const string& filepath)
+{
+    Impl::Entry& entry = impl->get_entry(name);
+    const char* data = impl->map_stored_entry(entry);
+
+    create_subdirectories(filepath);
+
+    fstream out(filepath.c_str(), ios_base::out | ios_base::binary);
+    if (out.fail())
+        throw ZipException(("can't open file " + filepath).c_str());
+
+    if (data)
+        out.write(data, entry.m_size);
+    else
+    {
+        impl->go_to_entry(entry);
+        open_current_file(impl->m_zip_file);
+
+        vector<char> buffer(64 * 1024);
+
+        do
+        {
+            const size_t read = read_chunk(impl->m_zip_file, &buffer[0], buffer.size());
+            out.write(&buffer[0], read);
+        }
+        while (!unzeof(impl->m_zip_file));
+
+        unzip_close_current_file(impl->m_zip_file);
+    }
+
+    out.close();
+
+    if (out.fail())
+        throw ZipException(("can't write file " + filepath).c_str());
+}
+
 }   // namespace foundation
@@ -29,12 +29,14 @@
 #pragma once
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/core/exceptions/exception.h"
 
 // Boost headers.
 #include "boost/filesystem/path.hpp"
 
 // Standard headers.
+#include <cstddef>
 #include <set>
 #include <string>
 #include <vector>
@@ -66,6 +68,9 @@ void unzip(const std::string& zip_filename, const std::string& unzipped_dir);
 //
 // Archives directory_to_zip to zip_filename zip file.
 //
+// Files that are already compressed (binary meshes and curves, most image formats)
+// are stored without compression so that ZipArchive can read them in place.
+//
 // Throws ZipException in case of exception.
 // If exception is thrown, zip archive is deleted.
 //
@@ -94,4 +99,58 @@ std::vector<std::string> get_filenames_with_extension_from_zip(
 
 std::set<std::string> recursive_ls(const boost::filesystem::path& dir);
 
+//
+// Read-only access to the file entries of a zip archive, without extracting them first.
+//
+// Stored (uncompressed) entries are read in place from a memory mapping of the archive;
+// other entries are decompressed on demand. Entry names use forward slashes and are the
+// names recorded in the archive (directory entries are omitted).
+//
+// All methods except the constructor and the destructor throw ZipException on error.
+//
+
+class ZipArchive
+  : public NonCopyable
+{
+  public:
+    // Constructor.
+    ZipArchive();
+
+    // Destructor, closes the archive if it is still open.
+    ~ZipArchive();
+
+    // Open an archive and index its entries.
+    void open(const std::string& zip_filename);
+
+    // Close the archive. Does nothing if the archive is not open.
+    void close();
+
+    // Return true if the archive is currently open.
+    bool is_open() const;
+
+    // Return the names of all file entries, in archive order.
+    const std::vector<std::string>& get_entry_names() const;
+
+    // Return true if the archive contains a given file entry.
+    bool has_entry(const std::string& name) const;
+
+    // Return the uncompressed size in bytes of a given entry.
+    size_t get_entry_size(const std::string& name) const;
+
+    // Return a pointer to the contents of a stored entry inside the memory mapping of the
+    // archive, or nullptr if the entry is compressed. The pointer remains valid until the
+    // archive is closed and is not guaranteed to have any particular alignment.
+    const void* map_entry(const std::string& name);
+
+    // Read the entire contents of an entry into memory.
+    void read_entry(const std::string& name, std::vector<char>& contents);
+
+    // Write the contents of an entry to a file, creating parent directories as needed.
+    void extract_entry(const std::string& name, const std::string& filepath);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
 }   // namespace foundation
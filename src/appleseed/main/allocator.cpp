@@ -30,6 +30,13 @@
 // Interface header.
 #include "allocator.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+
+// Standard headers.
+#include <atomic>
+#include <cassert>
+
 //
 // This module must be enabled on Windows, and on Windows only. Windows is
 // the only platform we support that doesn't natively provide 16-byte aligned
@@ -61,7 +68,6 @@
 
 // Standard headers.
 #include <algorithm>
-#include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
@@ -561,3 +567,131 @@ void start_memory_tracking() {}
 void stop_memory_tracking() {}
 
 #endif  // _WIN32
+
+
+//
+// Tagged memory accounting implementation.
+//
+
+namespace
+{
+    struct TagCounters
+    {
+        std::atomic<size_t> m_live_bytes;
+        std::atomic<size_t> m_peak_bytes;
+    };
+
+    // Zero-initialized before any dynamic initialization takes place.
+    TagCounters g_tag_counters[MemoryTagCount];
+    std::atomic<int> g_huge_page_modes[MemoryTagCount];
+    std::atomic<size_t> g_huge_page_live_bytes[MemoryTagCount];
+
+    APPLESEED_TLS int g_current_memory_tag = MemoryTagUntagged;
+}
+
+const char* get_memory_tag_name(const MemoryTag tag)
+{
+    switch (tag)
+    {
+      case MemoryTagUntagged:       return "untagged";
+      case MemoryTagGeometry:       return "geometry";
+      case MemoryTagBVH:            return "bvh";
+      case MemoryTagTextures:       return "textures";
+      case MemoryTagFramebuffers:   return "framebuffers";
+      case MemoryTagAOVs:           return "aovs";
+      case MemoryTagLights:         return "lights";
+      case MemoryTagOSL:            return "osl";
+      case MemoryTagPhotons:        return "photons";
+      default:                      return "unknown";
+    }
+}
+
+MemoryTag get_current_memory_tag()
+{
+    return static_cast<MemoryTag>(g_current_memory_tag);
+}
+
+void set_current_memory_tag(const MemoryTag tag)
+{
+    assert(tag < MemoryTagCount);
+    g_current_memory_tag = tag;
+}
+
+void log_tagged_allocation(const MemoryTag tag, const size_t size)
+{
+    assert(tag < MemoryTagCount);
+
+    TagCounters& counters = g_tag_counters[tag];
+    const size_t live = counters.m_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+    size_t peak = counters.m_peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak)
+    {
+        if (counters.m_peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            break;
+    }
+}
+
+void log_tagged_deallocation(const MemoryTag tag, const size_t size)
+{
+    assert(tag < MemoryTagCount);
+
+    g_tag_counters[tag].m_live_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+size_t get_tagged_memory_live_bytes(const MemoryTag tag)
+{
+    assert(tag < MemoryTagCount);
+    return g_tag_counters[tag].m_live_bytes.load(std::memory_order_relaxed);
+}
+
+size_t get_tagged_memory_peak_bytes(const MemoryTag tag)
+{
+    assert(tag < MemoryTagCount);
+    return g_tag_counters[tag].m_peak_bytes.load(std::memory_order_relaxed);
+}
+
+void reset_tagged_memory_peaks()
+{
+    for (size_t i = 0; i < MemoryTagCount; ++i)
+    {
+        g_tag_counters[i].m_peak_bytes.store(
+            g_tag_counters[i].m_live_bytes.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+    }
+}
+
+
+//
+// Huge pages implementation.
+//
+
+HugePageMode get_huge_page_mode(const MemoryTag tag)
+{
+    assert(tag < MemoryTagCount);
+    return static_cast<HugePageMode>(g_huge_page_modes[tag].load(std::memory_order_relaxed));
+}
+
+void set_huge_page_mode(const MemoryTag tag, const HugePageMode mode)
+{
+    assert(tag < MemoryTagCount);
+    g_huge_page_modes[tag].store(mode, std::memory_order_relaxed);
+}
+
+void log_huge_page_allocation(const MemoryTag tag, const size_t size)
+{
+    assert(tag < MemoryTagCount);
+    g_huge_page_live_bytes[tag].fetch_add(size, std::memory_order_relaxed);
+}
+
+void log_huge_page_deallocation(const MemoryTag tag, const size_t size)
+{
+    assert(tag < MemoryTagCount);
+    g_huge_page_live_bytes[tag].fetch_sub(size, std::memory_order_relaxed);
+}
+
+size_t get_huge_page_live_bytes(const MemoryTag tag)
+{
+    assert(tag < MemoryTagCount);
+    return g_huge_page_live_bytes[tag].load(std::memory_order_relaxed);
+}
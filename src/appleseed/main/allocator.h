@@ -28,6 +28,9 @@
 
 #pragma once
 
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
@@ -39,3 +42,143 @@ APPLESEED_DLLSYMBOL void log_allocation_failure(const size_t size);
 APPLESEED_DLLSYMBOL void log_deallocation(const void* ptr);
 APPLESEED_DLLSYMBOL void start_memory_tracking();
 APPLESEED_DLLSYMBOL void stop_memory_tracking();
+
+
+//
+// Tagged memory accounting.
+//
+// Every allocation made through foundation::aligned_malloc() (and, on Windows,
+// through the overridden new and delete operators) is attributed to the memory
+// tag that is current on the allocating thread. Subsystems whose storage does
+// not go through aligned_malloc() report it explicitly with a TaggedMemoryRecord.
+//
+
+enum MemoryTag
+{
+    MemoryTagUntagged,
+    MemoryTagGeometry,
+    MemoryTagBVH,
+    MemoryTagTextures,
+    MemoryTagFramebuffers,
+    MemoryTagAOVs,
+    MemoryTagLights,
+    MemoryTagOSL,
+    MemoryTagPhotons,
+    MemoryTagCount              // keep last
+};
+
+// Return a human-readable name for a given memory tag.
+APPLESEED_DLLSYMBOL const char* get_memory_tag_name(const MemoryTag tag);
+
+// Get or set the memory tag of the calling thread.
+APPLESEED_DLLSYMBOL MemoryTag get_current_memory_tag();
+APPLESEED_DLLSYMBOL void set_current_memory_tag(const MemoryTag tag);
+
+// Account for a block of memory allocated or deallocated under a given tag.
+APPLESEED_DLLSYMBOL void log_tagged_allocation(const MemoryTag tag, const size_t size);
+APPLESEED_DLLSYMBOL void log_tagged_deallocation(const MemoryTag tag, const size_t size);
+
+// Retrieve the number of bytes currently allocated, and the maximum number of bytes
+// simultaneously allocated since the last call to reset_tagged_memory_peaks(), under
+// a given tag. These functions are thread-safe and can be polled during rendering.
+APPLESEED_DLLSYMBOL size_t get_tagged_memory_live_bytes(const MemoryTag tag);
+APPLESEED_DLLSYMBOL size_t get_tagged_memory_peak_bytes(const MemoryTag tag);
+
+// Reset the peak of every tag to its current live value.
+APPLESEED_DLLSYMBOL void reset_tagged_memory_peaks();
+
+
+//
+// Huge pages.
+//
+// Blocks of at least one huge page allocated through foundation::aligned_malloc()
+// under a memory tag for which huge pages are enabled are mapped directly from the
+// operating system and backed by huge pages, to reduce TLB misses when accessing
+// large, long-lived structures such as BVH nodes, tessellations and texture tiles.
+// Smaller blocks, and blocks for which the mapping fails (e.g. when no huge pages
+// are reserved or the process lacks the privilege to use them), are allocated on
+// the regular heap. Huge pages are disabled for every tag by default.
+//
+
+enum HugePageMode
+{
+    HugePagesOff,               // allocate on the regular heap
+    HugePagesTransparent,       // 2 MB aligned mappings advised to use transparent huge pages (Linux)
+    HugePages2MB,               // explicit 2 MB pages (Linux hugetlbfs, Windows large pages)
+    HugePages1GB                // explicit 1 GB pages (Linux hugetlbfs)
+};
+
+// Get or set the huge page mode of a given memory tag.
+APPLESEED_DLLSYMBOL HugePageMode get_huge_page_mode(const MemoryTag tag);
+APPLESEED_DLLSYMBOL void set_huge_page_mode(const MemoryTag tag, const HugePageMode mode);
+
+// Account for a block of memory placed on huge pages under a given tag.
+APPLESEED_DLLSYMBOL void log_huge_page_allocation(const MemoryTag tag, const size_t size);
+APPLESEED_DLLSYMBOL void log_huge_page_deallocation(const MemoryTag tag, const size_t size);
+
+// Retrieve the number of bytes currently placed on huge pages under a given tag.
+APPLESEED_DLLSYMBOL size_t get_huge_page_live_bytes(const MemoryTag tag);
+
+//
+// Make a memory tag current on the calling thread for the lifetime of the scope.
+//
+
+class MemoryTagScope
+  : public foundation::NonCopyable
+{
+  public:
+    explicit MemoryTagScope(const MemoryTag tag)
+      : m_previous_tag(get_current_memory_tag())
+    {
+        set_current_memory_tag(tag);
+    }
+
+    ~MemoryTagScope()
+    {
+        set_current_memory_tag(m_previous_tag);
+    }
+
+  private:
+    const MemoryTag m_previous_tag;
+};
+
+//
+// Explicitly account for a tagged amount of memory, for instance the storage of
+// standard containers. The amount is released when the record is destructed.
+//
+
+class TaggedMemoryRecord
+  : public foundation::NonCopyable
+{
+  public:
+    explicit TaggedMemoryRecord(const MemoryTag tag)
+      : m_tag(tag)
+      , m_size(0)
+    {
+    }
+
+    ~TaggedMemoryRecord()
+    {
+        set(0);
+    }
+
+    // Replace the amount of memory accounted for by this record.
+    void set(const size_t size)
+    {
+        if (size > m_size)
+            log_tagged_allocation(m_tag, size - m_size);
+        else if (size < m_size)
+            log_tagged_deallocation(m_tag, m_size - size);
+
+        m_size = size;
+    }
+
+    size_t get() const
+    {
+        return m_size;
+    }
+
+  private:
+    const MemoryTag m_tag;
+    size_t          m_size;
+};
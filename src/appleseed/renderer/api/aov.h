@@ -40,6 +40,7 @@
 #include "renderer/modeling/aov/diffuseaov.h"
 #include "renderer/modeling/aov/emissionaov.h"
 #include "renderer/modeling/aov/glossyaov.h"
+#include "renderer/modeling/aov/idaov.h"
 #include "renderer/modeling/aov/iaovfactory.h"
 #include "renderer/modeling/aov/invalidsamplesaov.h"
 #include "renderer/modeling/aov/normalaov.h"
@@ -30,5 +30,6 @@
 #pragma once
 
 // API headers.
+#include "renderer/kernel/intersection/raydump.h"
 #include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/shading/shadingray.h"
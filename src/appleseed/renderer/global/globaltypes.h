@@ -39,6 +39,7 @@
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
 #include "foundation/math/aabb.h"
+#include "foundation/math/basis.h"
 #include "foundation/math/ray.h"
 #include "foundation/math/rng/xoroshiro128plus.h"
 #include "foundation/math/sampling/qmcsamplingcontext.h"
@@ -62,6 +63,18 @@ typedef foundation::AABB<GScalar, 1> GAABB1;
 typedef foundation::Ray<GScalar, 3> GRay3;
 typedef foundation::RayInfo<GScalar, 3> GRayInfo3;
 
+// Shading-space storage type (shading normals and shading bases).
+// Intersection-related quantities always remain in double precision.
+#ifdef APPLESEED_WITH_SINGLE_PRECISION_SHADING
+typedef float SScalar;
+#else
+typedef double SScalar;
+#endif
+
+// SScalar-derived types.
+typedef foundation::Vector<SScalar, 3> SVector3;
+typedef foundation::Basis3<SScalar> SBasis3;
+
 // Spectrum representation.
 #ifdef APPLESEED_WITH_SPECTRAL_SUPPORT
 typedef DynamicSpectrum31f Spectrum;
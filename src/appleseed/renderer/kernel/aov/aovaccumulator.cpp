@@ -62,6 +62,11 @@ void AOVAccumulator::release()
     delete this;
 }
 
+int AOVAccumulator::get_events() const
+{
+    return AllEvents;
+}
+
 void AOVAccumulator::on_tile_begin(
     const Frame&                frame,
     const size_t                tile_x,
@@ -107,6 +112,16 @@ void AOVAccumulator::write(
 }
 
 
+//
+// NullAOVAccumulator class implementation.
+//
+
+int NullAOVAccumulator::get_events() const
+{
+    return 0;
+}
+
+
 //
 // UnfilteredAOVAccumulator class implementation.
 //
@@ -117,6 +132,11 @@ UnfilteredAOVAccumulator::UnfilteredAOVAccumulator(Image& image)
 {
 }
 
+int UnfilteredAOVAccumulator::get_events() const
+{
+    return TileEvents | WriteEvents;
+}
+
 void UnfilteredAOVAccumulator::on_tile_begin(
     const Frame&                frame,
     const size_t                tile_x,
@@ -180,14 +200,17 @@ AOVAccumulatorContainer::AOVAccumulatorContainer(const Frame& frame)
 
 void AOVAccumulatorContainer::init()
 {
-    m_size = 0;
-    memset(m_accumulators, 0, MaxAOVAccumulatorCount * sizeof(AOVAccumulator*));
+    memset(&m_all, 0, sizeof(AccumulatorList));
+    memset(&m_tile_accumulators, 0, sizeof(AccumulatorList));
+    memset(&m_pixel_accumulators, 0, sizeof(AccumulatorList));
+    memset(&m_sample_accumulators, 0, sizeof(AccumulatorList));
+    memset(&m_write_accumulators, 0, sizeof(AccumulatorList));
 }
 
 AOVAccumulatorContainer::~AOVAccumulatorContainer()
 {
-    for (size_t i = 0, e = m_size; i < e; ++i)
-        delete m_accumulators[i];
+    for (size_t i = 0, e = m_all.m_size; i < e; ++i)
+        delete m_all.m_accumulators[i];
 }
 
 void AOVAccumulatorContainer::on_tile_begin(
@@ -196,8 +219,8 @@ void AOVAccumulatorContainer::on_tile_begin(
     const size_t                tile_y,
     const size_t                max_spp)
 {
-    for (size_t i = 0, e = m_size; i < e; ++i)
-        m_accumulators[i]->on_tile_begin(frame, tile_x, tile_y, max_spp);
+    for (size_t i = 0, e = m_tile_accumulators.m_size; i < e; ++i)
+        m_tile_accumulators.m_accumulators[i]->on_tile_begin(frame, tile_x, tile_y, max_spp);
 }
 
 void AOVAccumulatorContainer::on_tile_end(
@@ -205,36 +228,36 @@ void AOVAccumulatorContainer::on_tile_end(
     const size_t                tile_x,
     const size_t                tile_y)
 {
-    for (size_t i = 0, e = m_size; i < e; ++i)
-        m_accumulators[i]->on_tile_end(frame, tile_x, tile_y);
+    for (size_t i = 0, e = m_tile_accumulators.m_size; i < e; ++i)
+        m_tile_accumulators.m_accumulators[i]->on_tile_end(frame, tile_x, tile_y);
 }
 
 void AOVAccumulatorContainer::on_pixel_begin(
     const Vector2i&             pi)
 {
-    for (size_t i = 0, e = m_size; i < e; ++i)
-        m_accumulators[i]->on_pixel_begin(pi);
+    for (size_t i = 0, e = m_pixel_accumulators.m_size; i < e; ++i)
+        m_pixel_accumulators.m_accumulators[i]->on_pixel_begin(pi);
 }
 
 void AOVAccumulatorContainer::on_pixel_end(
     const Vector2i&             pi)
 {
-    for (size_t i = 0, e = m_size; i < e; ++i)
-        m_accumulators[i]->on_pixel_end(pi);
+    for (size_t i = 0, e = m_pixel_accumulators.m_size; i < e; ++i)
+        m_pixel_accumulators.m_accumulators[i]->on_pixel_end(pi);
 }
 
 void AOVAccumulatorContainer::on_sample_begin(
     const PixelContext&         pixel_context)
 {
-    for (size_t i = 0, e = m_size; i < e; ++i)
-        m_accumulators[i]->on_sample_begin(pixel_context);
+    for (size_t i = 0, e = m_sample_accumulators.m_size; i < e; ++i)
+        m_sample_accumulators.m_accumulators[i]->on_sample_begin(pixel_context);
 }
 
 void AOVAccumulatorContainer::on_sample_end(
     const PixelContext&         pixel_context)
 {
-    for (size_t i = 0, e = m_size; i < e; ++i)
-        m_accumulators[i]->on_sample_end(pixel_context);
+    for (size_t i = 0, e = m_sample_accumulators.m_size; i < e; ++i)
+        m_sample_accumulators.m_accumulators[i]->on_sample_end(pixel_context);
 }
 
 void AOVAccumulatorContainer::write(
@@ -244,9 +267,9 @@ void AOVAccumulatorContainer::write(
     const AOVComponents&        aov_components,
     ShadingResult&              shading_result)
 {
-    for (size_t i = 0, e = m_size; i < e; ++i)
+    for (size_t i = 0, e = m_write_accumulators.m_size; i < e; ++i)
     {
-        m_accumulators[i]->write(
+        m_write_accumulators.m_accumulators[i]->write(
             pixel_context,
             shading_point,
             shading_components,
@@ -259,10 +282,26 @@ bool AOVAccumulatorContainer::insert(auto_release_ptr<AOVAccumulator> aov_accum)
 {
     assert(aov_accum.get());
 
-    if (m_size + 1 == MaxAOVAccumulatorCount)
+    if (m_all.m_size + 1 == MaxAOVAccumulatorCount)
         return false;
 
-    m_accumulators[m_size++] = aov_accum.release();
+    AOVAccumulator* accumulator = aov_accum.release();
+    m_all.m_accumulators[m_all.m_size++] = accumulator;
+
+    const int events = accumulator->get_events();
+
+    if (events & AOVAccumulator::TileEvents)
+        m_tile_accumulators.m_accumulators[m_tile_accumulators.m_size++] = accumulator;
+
+    if (events & AOVAccumulator::PixelEvents)
+        m_pixel_accumulators.m_accumulators[m_pixel_accumulators.m_size++] = accumulator;
+
+    if (events & AOVAccumulator::SampleEvents)
+        m_sample_accumulators.m_accumulators[m_sample_accumulators.m_size++] = accumulator;
+
+    if (events & AOVAccumulator::WriteEvents)
+        m_write_accumulators.m_accumulators[m_write_accumulators.m_size++] = accumulator;
+
     return true;
 }
 
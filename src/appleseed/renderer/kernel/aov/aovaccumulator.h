@@ -62,12 +62,26 @@ class AOVAccumulator
   : public foundation::NonCopyable
 {
   public:
+    // Events an accumulator can be notified of.
+    enum Event
+    {
+        TileEvents      = 1UL << 0,     // on_tile_begin() and on_tile_end()
+        PixelEvents     = 1UL << 1,     // on_pixel_begin() and on_pixel_end()
+        SampleEvents    = 1UL << 2,     // on_sample_begin() and on_sample_end()
+        WriteEvents     = 1UL << 3,     // write()
+        AllEvents       = TileEvents | PixelEvents | SampleEvents | WriteEvents
+    };
+
     // Destructor.
     virtual ~AOVAccumulator();
 
     // Delete this instance.
     void release();
 
+    // Return the events this accumulator must be notified of, as a combination
+    // of Event flags. AOVAccumulatorContainer never invokes the other methods.
+    virtual int get_events() const;
+
     // This method is called before a tile gets rendered.
     virtual void on_tile_begin(
         const Frame&                frame,
@@ -107,6 +121,19 @@ class AOVAccumulator
 };
 
 
+//
+// An AOV accumulator that ignores all events, for AOVs that are not computed
+// while rendering samples.
+//
+
+class NullAOVAccumulator
+  : public AOVAccumulator
+{
+  public:
+    int get_events() const override;
+};
+
+
 //
 // Unfiltered AOV accumulator base class.
 //
@@ -118,6 +145,8 @@ class UnfilteredAOVAccumulator
     // Constructor.
     explicit UnfilteredAOVAccumulator(foundation::Image& image);
 
+    int get_events() const override;
+
     // This method is called before a tile gets rendered.
     void on_tile_begin(
         const Frame&                frame,
@@ -143,6 +172,11 @@ class UnfilteredAOVAccumulator
 //
 // A collection of AOV accumulators.
 //
+// The accumulators that must be notified of each kind of event are gathered
+// into flat lists when the container is constructed, so that for instance
+// accumulators that only write to shading results are not called for every
+// pixel and every sample.
+//
 
 class AOVAccumulatorContainer
   : public foundation::NonCopyable
@@ -198,8 +232,17 @@ class AOVAccumulatorContainer
 
     enum { MaxAOVAccumulatorCount = MaxAOVCount + 1 };  // MaxAOVCount + Beauty
 
-    size_t          m_size;
-    AOVAccumulator* m_accumulators[MaxAOVAccumulatorCount];
+    struct AccumulatorList
+    {
+        size_t          m_size;
+        AOVAccumulator* m_accumulators[MaxAOVAccumulatorCount];
+    };
+
+    AccumulatorList     m_all;
+    AccumulatorList     m_tile_accumulators;
+    AccumulatorList     m_pixel_accumulators;
+    AccumulatorList     m_sample_accumulators;
+    AccumulatorList     m_write_accumulators;
 };
 
 }   // namespace renderer
@@ -35,7 +35,11 @@
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
 #include "foundation/image/image.h"
+#include "foundation/platform/system.h"
 #include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/job/ijob.h"
+#include "foundation/utility/job/jobqueue.h"
+#include "foundation/utility/string.h"
 
 // BCD headers.
 #include "bcd/DeepImage.h"
@@ -45,7 +49,11 @@
 #include "bcd/SpikeRemovalFilter.h"
 #include "bcd/Utils.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
 // Standard headers.
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <vector>
@@ -204,6 +212,325 @@ namespace
         return denoiser->denoise();
     }
 
+
+    //
+    // Tiled denoising.
+    //
+    // Each tile is denoised from a copy of the input images extended by a border wide
+    // enough to contain the patches and search windows of the pixels of the tile, at all
+    // scales. Tiles are thus denoised with the same neighborhoods as when the whole image
+    // is denoised at once, while the intermediate buffers of the denoiser (among which one
+    // color accumulation buffer per thread) only cover a tile.
+    //
+
+    struct DenoiserTile
+    {
+        int     m_x0, m_y0, m_x1, m_y1;         // pixels written to the output image (exclusive end)
+        int     m_px0, m_py0, m_px1, m_py1;     // pixels read from the input images (exclusive end)
+    };
+
+    void crop_deepimage(
+        const Deepimf&          src,
+        const int               x0,
+        const int               y0,
+        const int               x1,
+        const int               y1,
+        Deepimf&                dst)
+    {
+        const int depth = src.getDepth();
+
+        dst.resize(x1 - x0, y1 - y0, depth);
+
+        for (int y = y0; y < y1; ++y)
+        {
+            for (int x = x0; x < x1; ++x)
+            {
+                for (int d = 0; d < depth; ++d)
+                    dst.set(y - y0, x - x0, d, src.get(y, x, d));
+            }
+        }
+    }
+
+    void paste_tile(
+        const Deepimf&          src,
+        const DenoiserTile&     tile,
+        Deepimf&                dst)
+    {
+        const int depth = src.getDepth();
+
+        for (int y = tile.m_y0; y < tile.m_y1; ++y)
+        {
+            for (int x = tile.m_x0; x < tile.m_x1; ++x)
+            {
+                for (int d = 0; d < depth; ++d)
+                    dst.set(y, x, d, src.get(y - tile.m_py0, x - tile.m_px0, d));
+            }
+        }
+    }
+
+    void split_into_tiles(
+        const int               width,
+        const int               height,
+        const DenoiserOptions&  options,
+        vector<DenoiserTile>&   tiles)
+    {
+        // Downsampled levels must see the same pixel grid in a tile as in the whole image.
+        const int alignment = 1 << (max<int>(static_cast<int>(options.m_num_scales), 1) - 1);
+        const int border = 2 * static_cast<int>(options.m_search_window_radius + options.m_patch_radius) * alignment;
+        const int tile_size = ((static_cast<int>(options.m_tile_size) + alignment - 1) / alignment) * alignment;
+
+        for (int y = 0; y < height; y += tile_size)
+        {
+            for (int x = 0; x < width; x += tile_size)
+            {
+                DenoiserTile tile;
+                tile.m_x0 = x;
+                tile.m_y0 = y;
+                tile.m_x1 = min(x + tile_size, width);
+                tile.m_y1 = min(y + tile_size, height);
+                tile.m_px0 = max(tile.m_x0 - border, 0);
+                tile.m_py0 = max(tile.m_y0 - border, 0);
+                tile.m_px1 = min(tile.m_x1 + border, width);
+                tile.m_py1 = min(tile.m_y1 + border, height);
+                tiles.push_back(tile);
+            }
+        }
+    }
+
+    // Estimate the memory used to denoise a tile of a given pixel count with a given number of threads.
+    size_t estimate_tile_memory(
+        const size_t            pixel_count,
+        const size_t            input_channel_count,
+        const size_t            thread_count,
+        const DenoiserOptions&  options)
+    {
+        // Copies of the inputs, the output, and per pixel square root of samples count,
+        // pixel covariances, the marks and one color and count accumulator per thread.
+        const size_t channel_count = 2 * input_channel_count + 3 + 2 + 4 * thread_count;
+        const size_t bytes = pixel_count * channel_count * sizeof(float);
+
+        // Account for the downsampled levels when using the multiscale denoiser.
+        return options.m_num_scales > 1 ? bytes + bytes / 3 : bytes;
+    }
+
+    struct TiledDenoiserContext
+    {
+        const Deepimf&          m_src;
+        const Deepimf&          m_num_samples;
+        const Deepimf&          m_histograms;
+        const Deepimf&          m_covariances;
+        const DenoiserOptions&  m_options;              // options used for each tile
+        IAbortSwitch*           m_abort_switch;
+        vector<DenoiserTile>    m_tiles;
+        Deepimf&                m_dst;
+        boost::atomic<size_t>   m_next_tile;
+        boost::atomic<bool>     m_success;
+
+        TiledDenoiserContext(
+            const Deepimf&          src,
+            const Deepimf&          num_samples,
+            const Deepimf&          histograms,
+            const Deepimf&          covariances,
+            const DenoiserOptions&  options,
+            IAbortSwitch*           abort_switch,
+            Deepimf&                dst)
+          : m_src(src)
+          , m_num_samples(num_samples)
+          , m_histograms(histograms)
+          , m_covariances(covariances)
+          , m_options(options)
+          , m_abort_switch(abort_switch)
+          , m_dst(dst)
+          , m_next_tile(0)
+          , m_success(true)
+        {
+        }
+    };
+
+    bool denoise_tile(
+        const TiledDenoiserContext& context,
+        const DenoiserTile&         tile)
+    {
+        Deepimf src, num_samples, histograms, covariances;
+        crop_deepimage(context.m_src, tile.m_px0, tile.m_py0, tile.m_px1, tile.m_py1, src);
+        crop_deepimage(context.m_num_samples, tile.m_px0, tile.m_py0, tile.m_px1, tile.m_py1, num_samples);
+        crop_deepimage(context.m_histograms, tile.m_px0, tile.m_py0, tile.m_px1, tile.m_py1, histograms);
+        crop_deepimage(context.m_covariances, tile.m_px0, tile.m_py0, tile.m_px1, tile.m_py1, covariances);
+
+        Deepimf dst(src);
+
+        if (!do_denoise_image(
+                src,
+                num_samples,
+                histograms,
+                covariances,
+                context.m_options,
+                context.m_abort_switch,
+                dst))
+            return false;
+
+        paste_tile(dst, tile, context.m_dst);
+
+        return true;
+    }
+
+    // Denoise tiles until there are none left. Running N such jobs in parallel
+    // bounds the number of tiles being denoised at any time to N.
+    class DenoiseTilesJob
+      : public IJob
+    {
+      public:
+        explicit DenoiseTilesJob(TiledDenoiserContext& context)
+          : m_context(context)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            while (true)
+            {
+                const size_t tile_index = m_context.m_next_tile++;
+
+                if (tile_index >= m_context.m_tiles.size())
+                    break;
+
+                if (!denoise_tile(m_context, m_context.m_tiles[tile_index]))
+                {
+                    m_context.m_success = false;
+                    break;
+                }
+            }
+        }
+
+      private:
+        TiledDenoiserContext& m_context;
+    };
+
+    bool denoise_tiled_image(
+        Deepimf&                src,
+        const Deepimf&          num_samples,
+        const Deepimf&          histograms,
+        const Deepimf&          covariances,
+        const DenoiserOptions&  options,
+        JobQueue*               job_queue,
+        IAbortSwitch*           abort_switch,
+        Deepimf&                dst)
+    {
+        DenoiserOptions tile_options(options);
+        TiledDenoiserContext context(
+            src,
+            num_samples,
+            histograms,
+            covariances,
+            tile_options,
+            abort_switch,
+            dst);
+
+        split_into_tiles(src.getWidth(), src.getHeight(), options, context.m_tiles);
+
+        // Find the largest tile, borders included.
+        size_t max_tile_pixel_count = 0;
+        for (const DenoiserTile& tile : context.m_tiles)
+        {
+            const size_t pixel_count = static_cast<size_t>(tile.m_px1 - tile.m_px0) * (tile.m_py1 - tile.m_py0);
+            max_tile_pixel_count = max(max_tile_pixel_count, pixel_count);
+        }
+
+        const size_t input_channel_count =
+            static_cast<size_t>(src.getDepth() + num_samples.getDepth() + histograms.getDepth() + covariances.getDepth());
+
+        // Choose how many tiles are denoised in parallel and by how many threads each.
+        const size_t thread_count =
+            options.m_num_cores > 0 ? options.m_num_cores : System::get_logical_cpu_core_count();
+        size_t job_count = job_queue ? min(thread_count, context.m_tiles.size()) : 1;
+        size_t threads_per_job = max<size_t>(thread_count / job_count, 1);
+
+        if (options.m_memory_limit > 0)
+        {
+            const size_t single_thread_memory =
+                estimate_tile_memory(max_tile_pixel_count, input_channel_count, 1, options);
+
+            if (single_thread_memory > options.m_memory_limit)
+            {
+                RENDERER_LOG_WARNING(
+                    "denoising a single tile requires about %s, more than the memory limit of %s; consider using smaller tiles.",
+                    pretty_size(single_thread_memory).c_str(),
+                    pretty_size(options.m_memory_limit).c_str());
+            }
+
+            job_count = max<size_t>(min(job_count, options.m_memory_limit / single_thread_memory), 1);
+            threads_per_job = max<size_t>(thread_count / job_count, 1);
+
+            while (threads_per_job > 1 &&
+                   job_count * estimate_tile_memory(max_tile_pixel_count, input_channel_count, threads_per_job, options) > options.m_memory_limit)
+                --threads_per_job;
+        }
+
+        tile_options.m_num_cores = threads_per_job;
+
+        RENDERER_LOG_DEBUG(
+            "denoising %s %s in %s %s of %s %s...",
+            pretty_uint(context.m_tiles.size()).c_str(),
+            plural(context.m_tiles.size(), "tile").c_str(),
+            pretty_uint(job_count).c_str(),
+            plural(job_count, "job").c_str(),
+            pretty_uint(threads_per_job).c_str(),
+            plural(threads_per_job, "thread").c_str());
+
+        if (job_queue)
+        {
+            for (size_t i = 0; i < job_count; ++i)
+                job_queue->schedule(new DenoiseTilesJob(context));
+
+            job_queue->wait_until_completion();
+        }
+        else
+        {
+            DenoiseTilesJob job(context);
+            job.execute(0);
+        }
+
+        return context.m_success;
+    }
+
+    bool denoise_deepimage(
+        Deepimf&                src,
+        const Deepimf&          num_samples,
+        const Deepimf&          histograms,
+        const Deepimf&          covariances,
+        const DenoiserOptions&  options,
+        JobQueue*               job_queue,
+        IAbortSwitch*           abort_switch,
+        Deepimf&                dst)
+    {
+        const size_t max_dimension =
+            static_cast<size_t>(max(src.getWidth(), src.getHeight()));
+
+        if (options.m_tile_size == 0 || options.m_tile_size >= max_dimension)
+        {
+            return
+                do_denoise_image(
+                    src,
+                    num_samples,
+                    histograms,
+                    covariances,
+                    options,
+                    abort_switch,
+                    dst);
+        }
+
+        return
+            denoise_tiled_image(
+                src,
+                num_samples,
+                histograms,
+                covariances,
+                options,
+                job_queue,
+                abort_switch,
+                dst);
+    }
+
 }
 
 bool denoise_beauty_image(
@@ -212,6 +539,7 @@ bool denoise_beauty_image(
     Deepimf&                histograms,
     Deepimf&                covariances,
     const DenoiserOptions&  options,
+    JobQueue*               job_queue,
     IAbortSwitch*           abort_switch)
 {
     Deepimf src;
@@ -230,12 +558,13 @@ bool denoise_beauty_image(
     Deepimf dst(src);
 
     const bool success =
-        do_denoise_image(
+        denoise_deepimage(
             src,
             num_samples,
             histograms,
             covariances,
             options,
+            job_queue,
             abort_switch,
             dst);
 
@@ -251,6 +580,7 @@ bool denoise_aov_image(
     const Deepimf&          histograms,
     const Deepimf&          covariances,
     const DenoiserOptions&  options,
+    JobQueue*               job_queue,
     IAbortSwitch*           abort_switch)
 {
     Deepimf src;
@@ -266,12 +596,13 @@ bool denoise_aov_image(
     Deepimf dst(src);
 
     const bool success =
-        do_denoise_image(
+        denoise_deepimage(
             src,
             num_samples,
             histograms,
             covariances,
             options,
+            job_queue,
             abort_switch,
             dst);
 
@@ -31,9 +31,13 @@
 // BCD headers.
 #include "bcd/DeepImage.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class Image; }
+namespace foundation    { class JobQueue; }
 
 namespace renderer
 {
@@ -52,6 +56,8 @@ class DenoiserOptions
     size_t  m_num_scales;                         //  number of pyramid levels to use.
     size_t  m_num_cores;                          //  number of cores used to denoise. O means using all the cores available.
     bool    m_mark_invalid_pixels;
+    size_t  m_tile_size;                          //  size in pixels of the tiles denoised independently and in parallel. 0 means denoising the whole image at once.
+    size_t  m_memory_limit;                       //  upper bound in bytes on the memory used by the tiles being denoised simultaneously. 0 means no limit.
 
     DenoiserOptions()
       : m_histogram_patch_distance_threshold(1.0f)
@@ -65,6 +71,8 @@ class DenoiserOptions
       , m_num_scales(3)
       , m_num_cores(0)
       , m_mark_invalid_pixels(false)
+      , m_tile_size(0)
+      , m_memory_limit(0)
     {
     }
 };
@@ -75,6 +83,7 @@ bool denoise_beauty_image(
     bcd::Deepimf&               histograms,
     bcd::Deepimf&               covariances,
     const DenoiserOptions&      options,
+    foundation::JobQueue*       job_queue,      // tiles are denoised on this job queue, or on the calling thread if it is null
     foundation::IAbortSwitch*   abort_switch);
 
 bool denoise_aov_image(
@@ -83,6 +92,7 @@ bool denoise_aov_image(
     const bcd::Deepimf&         histograms,
     const bcd::Deepimf&         covariances,
     const DenoiserOptions&      options,
+    foundation::JobQueue*       job_queue,      // tiles are denoised on this job queue, or on the calling thread if it is null
     foundation::IAbortSwitch*   abort_switch);
 
 }   // namespace renderer
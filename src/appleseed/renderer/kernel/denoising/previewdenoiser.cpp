@@ -0,0 +1,211 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "previewdenoiser.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/rendering/itilecallback.h"
+#include "renderer/kernel/rendering/sample.h"
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/platform/defaulttimers.h"
+#include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// PreviewDenoiser class implementation.
+//
+// The display thread owns the snapshot while no snapshot is pending and the denoising
+// thread owns it otherwise. The preview is only swapped with the denoised snapshot, or
+// read, while holding m_mutex.
+//
+
+PreviewDenoiser::PreviewDenoiser(
+    const Frame&            frame,
+    const size_t            pass_interval,
+    const size_t            thread_count)
+  : m_frame(frame)
+  , m_interval_sample_count(
+        static_cast<uint64>(max<size_t>(pass_interval, 1)) * frame.get_crop_window().volume())
+  , m_snapshot(new Image(frame.image()))
+  , m_preview(new Image(frame.image()))
+  , m_backup(new Image(frame.image()))
+  , m_snapshot_statistics(DenoiserAOVFactory::create())
+{
+    assert(m_frame.denoiser_aov());
+
+    m_frame.get_denoiser_options(m_options, thread_count);
+
+    clear();
+}
+
+PreviewDenoiser::~PreviewDenoiser()
+{
+}
+
+void PreviewDenoiser::clear()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_next_sample_count = m_interval_sample_count;
+    m_snapshot_pending = false;
+    m_has_preview = false;
+    m_new_preview = false;
+
+    boost::mutex::scoped_lock statistics_lock(m_statistics_mutex);
+    m_frame.denoiser_aov()->clear_image();
+}
+
+void PreviewDenoiser::store_samples(
+    const size_t            sample_count,
+    const Sample            samples[])
+{
+    boost::mutex::scoped_try_lock lock(m_statistics_mutex);
+
+    if (!lock.owns_lock())
+        return;
+
+    DenoiserAOV* denoiser_aov = m_frame.denoiser_aov();
+    const CanvasProperties& props = m_frame.image().properties();
+
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        const Sample& sample = samples[i];
+
+        if (sample.m_pixel_coords.x >= 0 &&
+            sample.m_pixel_coords.y >= 0 &&
+            sample.m_pixel_coords.x < static_cast<int>(props.m_canvas_width) &&
+            sample.m_pixel_coords.y < static_cast<int>(props.m_canvas_height))
+            denoiser_aov->store_sample(sample.m_pixel_coords, sample.m_color);
+    }
+}
+
+void PreviewDenoiser::on_frame_developed(const uint64 sample_count)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_snapshot_pending || sample_count < m_next_sample_count)
+        return;
+
+    m_snapshot->copy_from(m_frame.image());
+
+    {
+        boost::mutex::scoped_lock statistics_lock(m_statistics_mutex);
+        m_snapshot_statistics->copy_statistics_from(*m_frame.denoiser_aov());
+    }
+
+    m_next_sample_count = (sample_count / m_interval_sample_count + 1) * m_interval_sample_count;
+    m_snapshot_pending = true;
+}
+
+bool PreviewDenoiser::denoise_pending_snapshot(IAbortSwitch& abort_switch)
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        if (!m_snapshot_pending)
+            return false;
+    }
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    m_snapshot_statistics->extract_histograms_image(m_histograms);
+    m_snapshot_statistics->extract_num_samples_image(m_num_samples);
+    m_snapshot_statistics->compute_covariances_image(m_covariances);
+
+    const bool success =
+        denoise_beauty_image(
+            *m_snapshot,
+            m_num_samples,
+            m_histograms,
+            m_covariances,
+            m_options,
+            nullptr,
+            &abort_switch);
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    m_snapshot_pending = false;
+
+    if (!success || abort_switch.is_aborted())
+        return false;
+
+    swap(m_snapshot, m_preview);
+    m_has_preview = true;
+    m_new_preview = true;
+
+    stopwatch.measure();
+    RENDERER_LOG_DEBUG(
+        "denoised frame preview in %s.",
+        pretty_time(stopwatch.get_seconds()).c_str());
+
+    return true;
+}
+
+bool PreviewDenoiser::has_preview() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_has_preview;
+}
+
+void PreviewDenoiser::present_new_preview(ITileCallback* tile_callback)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (!m_new_preview)
+        return;
+
+    m_new_preview = false;
+
+    // Present the preview in place of the frame's image, which is still needed
+    // as it is since accumulation buffers may only develop the parts that changed.
+    Image& image = m_frame.image();
+    m_backup->copy_from(image);
+    image.copy_from(*m_preview);
+    tile_callback->on_progressive_frame_update(&m_frame);
+    image.copy_from(*m_backup);
+}
+
+}   // namespace renderer
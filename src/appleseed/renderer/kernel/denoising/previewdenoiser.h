@@ -0,0 +1,125 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/denoising/denoiser.h"
+#include "renderer/modeling/aov/denoiseraov.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/autoreleaseptr.h"
+
+// BCD headers.
+#include "bcd/DeepImage.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class Image; }
+namespace renderer      { class Frame; }
+namespace renderer      { class ITileCallback; }
+namespace renderer      { class Sample; }
+
+namespace renderer
+{
+
+//
+// Denoised previews of a progressively rendered frame.
+//
+// The samples stored by the progressive frame renderer are accumulated into the
+// statistics of the frame's denoiser AOV. Every given number of passes, the display
+// thread takes a snapshot of the frame and of the statistics, which a background
+// thread then denoises. Snapshot and preview images are allocated once and reused.
+//
+
+class PreviewDenoiser
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. The frame must have a denoiser AOV.
+    PreviewDenoiser(
+        const Frame&                frame,
+        const size_t                pass_interval,      // number of passes (average samples per pixel) between previews
+        const size_t                thread_count);      // number of threads used to denoise previews
+
+    // Destructor.
+    ~PreviewDenoiser();
+
+    // Discard the statistics and the previews. Must not be called while a preview is being denoised.
+    void clear();
+
+    // Accumulate samples into the denoiser statistics. Thread-safe. Never blocks: if the
+    // statistics are in use by another thread, the samples are left out of the statistics.
+    void store_samples(
+        const size_t                sample_count,
+        const Sample                samples[]);
+
+    // Take a snapshot of the frame if a preview is due and the previous one is done.
+    // Must be called from the thread that develops the frame, right after developing it.
+    void on_frame_developed(const foundation::uint64 sample_count);
+
+    // Denoise the pending snapshot, if any. Return true if a new preview was produced.
+    bool denoise_pending_snapshot(foundation::IAbortSwitch& abort_switch);
+
+    // Return true if a preview is available.
+    bool has_preview() const;
+
+    // Present the preview through a tile callback if it wasn't presented yet. The frame's
+    // image is restored afterward. Must be called from the thread that develops the frame.
+    void present_new_preview(ITileCallback* tile_callback);
+
+  private:
+    const Frame&                                m_frame;
+    const foundation::uint64                    m_interval_sample_count;
+    DenoiserOptions                             m_options;
+
+    foundation::uint64                          m_next_sample_count;
+    bool                                        m_snapshot_pending;
+    bool                                        m_has_preview;
+    bool                                        m_new_preview;
+    mutable boost::mutex                        m_mutex;
+
+    boost::mutex                                m_statistics_mutex;
+
+    std::unique_ptr<foundation::Image>          m_snapshot;
+    std::unique_ptr<foundation::Image>          m_preview;
+    std::unique_ptr<foundation::Image>          m_backup;
+    foundation::auto_release_ptr<DenoiserAOV>   m_snapshot_statistics;
+    bcd::Deepimf                                m_histograms;
+    bcd::Deepimf                                m_num_samples;
+    bcd::Deepimf                                m_covariances;
+};
+
+}   // namespace renderer
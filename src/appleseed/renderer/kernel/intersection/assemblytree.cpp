@@ -34,7 +34,9 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/rendering/renderingcounters.h"
 #include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/entity/entityvector.h"
 #include "renderer/modeling/object/curveobject.h"
 #include "renderer/modeling/object/meshobject.h"
@@ -42,11 +44,16 @@
 #include "renderer/modeling/object/proceduralobject.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/pointinstancer.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/bbox.h"
+#include "renderer/utility/messagecontext.h"
+#include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
 #include "foundation/math/beziercurve.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/ray.h"
 #include "foundation/math/transform.h"
@@ -55,21 +62,37 @@
 #include "foundation/platform/timers.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/alignedallocator.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/siphash.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <exception>
+#include <limits>
 #include <set>
+#include <string>
 #include <utility>
 
 using namespace foundation;
 using namespace std;
+namespace bfs = boost::filesystem;
 
 namespace renderer
 {
@@ -81,9 +104,20 @@ namespace renderer
 AssemblyTree::AssemblyTree(const Scene& scene)
   : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
   , m_scene(scene)
+  , m_topology_hash(0)
+  , m_build_cost(0.0)
+  , m_lazy_child_trees(false)
+  , m_has_proxy_trees(false)
+  , m_proxy_ray_types(0)
+  , m_proxy_ray_min_depth(0)
+  , m_proxy_ray_min_roughness(0.0f)
 #ifdef APPLESEED_WITH_EMBREE
   , m_use_embree(false)
   , m_dirty(false)
+  , m_use_embree_instancing(false)
+#endif
+#ifdef APPLESEED_WITH_GPU
+  , m_use_gpu(false)
 #endif
 {
 }
@@ -91,12 +125,102 @@ AssemblyTree::AssemblyTree(const Scene& scene)
 AssemblyTree::~AssemblyTree()
 {
     RENDERER_LOG_INFO("deleting assembly tree...");
+
+    delete_paging_directory();
 }
 
 void AssemblyTree::update()
 {
-    rebuild_assembly_tree();
+    TraceScope trace_scope("scene", "update assembly tree");
+    MemoryTagScope memory_tag_scope(MemoryTagBVH);
+
+    // Child trees may be built when rays first reach them, and released under memory pressure.
+    const ParamArray& params = m_scene.get_parameters().child("acceleration_structure");
+    m_lazy_child_trees = params.get_optional<bool>("lazy_child_trees", false);
+    const size_t child_trees_max_size = params.get_optional<size_t>("child_trees_max_size", 0);
+    m_child_tree_budget.set_max_size(child_trees_max_size);
+
+    // Released triangle trees are reloaded from disk rather than rebuilt. Use the tree
+    // cache when there is one, otherwise page them to a temporary directory.
+    if (child_trees_max_size > 0 &&
+        m_paging_directory.empty() &&
+        params.get_optional<string>("cache_directory", "").empty())
+        create_paging_directory();
+
+    // Secondary rays of the selected types, past a given depth or roughness, are
+    // intersected against the proxy geometry of object instances that have one.
+    const MessageContext context("while updating assembly tree: ");
+    m_proxy_ray_types =
+        VisibilityFlags::parse_names(
+            params.get_optional<string>("proxy_ray_types", "shadow diffuse glossy"),
+            context);
+    m_proxy_ray_min_depth =
+        static_cast<ShadingRay::DepthType>(params.get_optional<size_t>("proxy_ray_min_depth", 1));
+    m_proxy_ray_min_roughness = params.get_optional<float>("proxy_ray_min_roughness", 0.0f);
+
+    update_assembly_tree();
     update_tree_hierarchy();
+
+#ifdef APPLESEED_WITH_EMBREE
+    update_embree_instance_scene();
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+    update_gpu_scene();
+#endif
+}
+
+namespace
+{
+    template <typename PointInstancerTreeMap>
+    size_t get_point_instancer_trees_memory_size(const PointInstancerTreeMap& trees)
+    {
+        size_t size = 0;
+
+        for (const auto& tree : trees)
+            size += tree.second->get_memory_size();
+
+        return size;
+    }
+}
+
+void AssemblyTree::create_paging_directory()
+{
+    try
+    {
+        const bfs::path path =
+            bfs::temp_directory_path() / bfs::unique_path("appleseed-trees-%%%%-%%%%-%%%%-%%%%");
+        bfs::create_directories(path);
+        m_paging_directory = path.string();
+
+        RENDERER_LOG_INFO("paging released triangle trees to %s.", m_paging_directory.c_str());
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_WARNING(
+            "failed to create triangle tree paging directory (%s), released trees will be rebuilt.",
+            e.what());
+    }
+}
+
+void AssemblyTree::delete_paging_directory()
+{
+    if (m_paging_directory.empty())
+        return;
+
+    try
+    {
+        bfs::remove_all(m_paging_directory);
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_WARNING(
+            "failed to delete triangle tree paging directory %s: %s",
+            m_paging_directory.c_str(),
+            e.what());
+    }
+
+    m_paging_directory.clear();
 }
 
 size_t AssemblyTree::get_memory_size() const
@@ -106,13 +230,41 @@ size_t AssemblyTree::get_memory_size() const
         - sizeof(*static_cast<const TreeType*>(this))
         + sizeof(*this)
         + m_items.capacity() * sizeof(AssemblyInstance*)
-        + m_assembly_versions.size() * sizeof(pair<UniqueID, VersionID>);
+        + m_assembly_versions.size() * sizeof(pair<UniqueID, VersionID>)
+        + m_item_ordering.capacity() * sizeof(size_t)
+        + m_item_bboxes.capacity() * sizeof(AABB3d)
+        + m_assembly_bboxes.size() * sizeof(pair<UniqueID, AssemblyBBox>)
+        + m_wide_tree.get_memory_size()
+        - sizeof(m_wide_tree)
+        + get_point_instancer_trees_memory_size(m_point_instancer_trees);
+}
+
+StatisticsVector AssemblyTree::get_tree_statistics() const
+{
+    StatisticsVector statistics = m_statistics;
+
+    for (const_each<TriangleTreeContainer> i = m_triangle_trees; i; ++i)
+    {
+        Access<TriangleTree> access(i->second);
+        statistics.merge(access->get_statistics());
+    }
+
+    for (const_each<CurveTreeContainer> i = m_curve_trees; i; ++i)
+    {
+        Access<CurveTree> access(i->second);
+        statistics.merge(access->get_statistics());
+    }
+
+    return statistics;
 }
 
 void AssemblyTree::collect_assembly_instances(
     const AssemblyInstanceContainer&    assembly_instances,
     const TransformSequence&            parent_transform_seq,
-    AABBVector&                         assembly_instance_bboxes)
+    const AssemblyBBoxMap&              previous_assembly_bboxes,
+    PointInstancerTreeMap&              previous_point_instancer_trees,
+    AABBVector&                         assembly_instance_bboxes,
+    uint64&                             topology_hash)
 {
     for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
     {
@@ -131,7 +283,19 @@ void AssemblyTree::collect_assembly_instances(
         collect_assembly_instances(
             assembly.assembly_instances(),
             cumulated_transform_seq,
-            assembly_instance_bboxes);
+            previous_assembly_bboxes,
+            previous_point_instancer_trees,
+            assembly_instance_bboxes,
+            topology_hash);
+
+        // Collect the point instancers of this assembly.
+        collect_point_instancers(
+            assembly.point_instancers(),
+            &assembly_instance,
+            cumulated_transform_seq,
+            previous_point_instancer_trees,
+            assembly_instance_bboxes,
+            topology_hash);
 
         // Skip empty assemblies.
         if (assembly.object_instances().empty())
@@ -143,30 +307,153 @@ void AssemblyTree::collect_assembly_instances(
             &assembly_instance,
             cumulated_transform_seq);
 
+        // Update the hash of the instance hierarchy.
+        uint64 values[3];
+        values[0] = topology_hash;
+        values[1] = assembly_instance.get_uid();
+        values[2] = assembly.get_uid();
+        topology_hash = siphash24(&values, sizeof(values));
+
+        // Retrieve the local bounding box of the assembly, only recomputing it if the assembly changed.
+        AssemblyBBoxMap::iterator assembly_bbox_it = m_assembly_bboxes.find(assembly.get_uid());
+        if (assembly_bbox_it == m_assembly_bboxes.end())
+        {
+            AssemblyBBox assembly_bbox;
+            assembly_bbox.m_version_id = assembly.get_version_id();
+
+            const AssemblyBBoxMap::const_iterator previous_it = previous_assembly_bboxes.find(assembly.get_uid());
+            assembly_bbox.m_bbox =
+                previous_it != previous_assembly_bboxes.end() && previous_it->second.m_version_id == assembly_bbox.m_version_id
+                    ? previous_it->second.m_bbox
+                    : assembly.compute_non_hierarchical_local_bbox();
+
+            assembly_bbox_it = m_assembly_bboxes.insert(make_pair(assembly.get_uid(), assembly_bbox)).first;
+        }
+
         // Compute and store the assembly instance bounding box.
         AABB3d assembly_instance_bbox(
-            cumulated_transform_seq.to_parent(
-                assembly.compute_non_hierarchical_local_bbox()));
+            cumulated_transform_seq.to_parent(assembly_bbox_it->second.m_bbox));
         assembly_instance_bbox.robust_grow(1.0e-15);
         assembly_instance_bboxes.push_back(assembly_instance_bbox);
     }
 }
 
-void AssemblyTree::rebuild_assembly_tree()
+void AssemblyTree::collect_point_instancers(
+    const PointInstancerContainer&      point_instancers,
+    const AssemblyInstance*             assembly_instance,
+    const TransformSequence&            parent_transform_seq,
+    PointInstancerTreeMap&              previous_point_instancer_trees,
+    AABBVector&                         item_bboxes,
+    uint64&                             topology_hash)
+{
+    for (const_each<PointInstancerContainer> i = point_instancers; i; ++i)
+    {
+        // Retrieve the point instancer.
+        const PointInstancer& point_instancer = *i;
+
+        // Retrieve the tree of the point instancer, only rebuilding it if the point instancer
+        // or one of its prototypes changed. Point instancers may be reached more than once.
+        PointInstancerTreeMap::iterator tree_it = m_point_instancer_trees.find(point_instancer.get_uid());
+        if (tree_it == m_point_instancer_trees.end())
+        {
+            const PointInstancerTreeMap::iterator previous_it =
+                previous_point_instancer_trees.find(point_instancer.get_uid());
+
+            unique_ptr<PointInstancerTree> tree;
+            if (previous_it != previous_point_instancer_trees.end() && previous_it->second->is_up_to_date())
+                tree = move(previous_it->second);
+            else tree.reset(new PointInstancerTree(point_instancer));
+
+            tree_it = m_point_instancer_trees.insert(make_pair(point_instancer.get_uid(), move(tree))).first;
+        }
+
+        const PointInstancerTree& tree = *tree_it->second;
+
+        // Skip point instancers without visible instances.
+        if (tree.get_instance_count() == 0)
+            continue;
+
+        // Create and store an item for this point instancer.
+        m_items.emplace_back(
+            &tree,
+            assembly_instance,
+            parent_transform_seq);
+
+        // Update the hash of the instance hierarchy.
+        uint64 values[3];
+        values[0] = topology_hash;
+        values[1] = assembly_instance ? assembly_instance->get_uid() : ~UniqueID(0);
+        values[2] = point_instancer.get_uid();
+        topology_hash = siphash24(&values, sizeof(values));
+
+        // Compute and store the point instancer bounding box.
+        AABB3d item_bbox(parent_transform_seq.to_parent(tree.get_bbox()));
+        item_bbox.robust_grow(1.0e-15);
+        item_bboxes.push_back(item_bbox);
+    }
+}
+
+bool AssemblyTree::has_point_instancers() const
+{
+    for (const_each<ItemVector> i = m_items; i; ++i)
+    {
+        if (i->m_point_instancer)
+            return true;
+    }
+
+    return false;
+}
+
+void AssemblyTree::update_assembly_tree()
 {
-    // Clear the current tree.
-    clear();
     m_items.clear();
 
-    Statistics statistics;
+    // Only keep the bounding boxes of the assemblies that are still instantiated.
+    AssemblyBBoxMap previous_assembly_bboxes;
+    swap(previous_assembly_bboxes, m_assembly_bboxes);
+
+    // Likewise, only keep the trees of the point instancers that are still reachable.
+    PointInstancerTreeMap previous_point_instancer_trees;
+    swap(previous_point_instancer_trees, m_point_instancer_trees);
 
-    // Collect assembly instances and their bounding boxes.
+    // Collect assembly instances, point instancers and their bounding boxes.
     RENDERER_LOG_INFO("collecting assembly instances...");
     AABBVector assembly_instance_bboxes;
+    uint64 topology_hash = 0;
     collect_assembly_instances(
         m_scene.assembly_instances(),
         TransformSequence(),
-        assembly_instance_bboxes);
+        previous_assembly_bboxes,
+        previous_point_instancer_trees,
+        assembly_instance_bboxes,
+        topology_hash);
+    collect_point_instancers(
+        m_scene.point_instancers(),
+        nullptr,
+        TransformSequence(),
+        previous_point_instancer_trees,
+        assembly_instance_bboxes,
+        topology_hash);
+
+    // Refit the tree if the instance hierarchy is unchanged.
+    if (!m_nodes.empty() &&
+        topology_hash == m_topology_hash &&
+        refit_assembly_tree(assembly_instance_bboxes))
+        return;
+
+    rebuild_assembly_tree(assembly_instance_bboxes);
+    m_topology_hash = topology_hash;
+}
+
+void AssemblyTree::rebuild_assembly_tree(const AABBVector& assembly_instance_bboxes)
+{
+    // Clear the current tree.
+    clear();
+    m_wide_tree.clear();
+    m_item_ordering.clear();
+    m_item_bboxes.clear();
+
+    Statistics statistics;
 
     RENDERER_LOG_INFO(
         "building assembly tree (%s %s)...",
@@ -201,15 +488,153 @@ void AssemblyTree::rebuild_assembly_tree()
             &ordering[0],
             ordering.size());
 
+        // Keep the ordering and the bounding boxes around to refit the tree later.
+        m_item_ordering = ordering;
+        m_item_bboxes.resize(ordering.size());
+        for (size_t i = 0; i < ordering.size(); ++i)
+            m_item_bboxes[i] = assembly_instance_bboxes[ordering[i]];
+        m_build_cost = compute_sah_cost();
+
         // Store the items in the tree leaves whenever possible.
         store_items_in_leaves(statistics);
+
+        // Collapse the tree into a wide tree.
+        if (m_scene.get_parameters().child("acceleration_structure").get_optional<bool>("wide_bvh", false))
+        {
+            m_wide_tree.build(*this);
+            statistics.insert("wide nodes", m_wide_tree.get_node_count());
+        }
+    }
+
+    // Keep and print assembly tree statistics.
+    m_statistics = StatisticsVector::make("assembly tree statistics", statistics);
+    RENDERER_LOG_DEBUG("%s", m_statistics.to_string().c_str());
+}
+
+bool AssemblyTree::refit_assembly_tree(const AABBVector& assembly_instance_bboxes)
+{
+    // Refitting degrades the tree; rebuild it once it got too expensive to traverse.
+    const double MaxRefitCostRatio = 2.0;
+
+    const size_t item_count = m_items.size();
+
+    if (item_count == 0 || item_count != m_item_ordering.size())
+        return false;
+
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    // Bring the bounding boxes of the assembly instances into tree order.
+    size_t changed_item_count = 0;
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        const AABB3d& bbox = assembly_instance_bboxes[m_item_ordering[i]];
+
+        if (bbox != m_item_bboxes[i])
+        {
+            m_item_bboxes[i] = bbox;
+            ++changed_item_count;
+        }
+    }
+
+    if (changed_item_count > 0)
+    {
+        // Recompute the bounding boxes of the nodes bottom-up; child nodes are always stored after their parent.
+        const size_t node_count = m_nodes.size();
+        AABBVector node_bboxes(node_count);
+
+        for (size_t i = node_count; i-- > 0; )
+        {
+            NodeType& node = m_nodes[i];
+            AABB3d& node_bbox = node_bboxes[i];
+
+            if (node.is_interior())
+            {
+                const size_t child_node_index = node.get_child_node_index();
+                const AABB3d& left_bbox = node_bboxes[child_node_index];
+                const AABB3d& right_bbox = node_bboxes[child_node_index + 1];
+
+                node.set_left_bbox(left_bbox);
+                node.set_right_bbox(right_bbox);
+
+                node_bbox = left_bbox;
+                node_bbox.insert(right_bbox);
+            }
+            else
+            {
+                const size_t item_begin = node.get_item_index();
+                const size_t item_end = item_begin + node.get_item_count();
+
+                node_bbox.invalidate();
+
+                for (size_t j = item_begin; j < item_end; ++j)
+                    node_bbox.insert(m_item_bboxes[j]);
+            }
+        }
+
+        if (compute_sah_cost() > MaxRefitCostRatio * m_build_cost)
+            return false;
+    }
+
+    // Reorder the items according to the tree ordering.
+    ItemVector temp_assembly_instances(item_count);
+    small_item_reorder(
+        &m_items[0],
+        &temp_assembly_instances[0],
+        &m_item_ordering[0],
+        item_count);
+
+    // Store the items in the tree leaves whenever possible.
+    Statistics statistics;
+    store_items_in_leaves(statistics);
+
+    // Collapse the tree into a wide tree.
+    if (m_scene.get_parameters().child("acceleration_structure").get_optional<bool>("wide_bvh", false))
+        m_wide_tree.build(*this);
+
+    // Keep the statistics of the refitted tree.
+    statistics.insert_time("refit time", stopwatch.measure().get_seconds());
+    statistics.merge(bvh::TreeStatistics<AssemblyTree>(*this, AABB3d(m_scene.compute_bbox())));
+    m_statistics = StatisticsVector::make("assembly tree statistics", statistics);
+
+    RENDERER_LOG_INFO(
+        "refitted assembly tree (%s %s moved) in %s.",
+        pretty_uint(changed_item_count).c_str(),
+        plural(changed_item_count, "assembly instance").c_str(),
+        pretty_time(stopwatch.measure().get_seconds()).c_str());
+
+    return true;
+}
+
+double AssemblyTree::compute_sah_cost() const
+{
+    const NodeType& root_node = m_nodes[0];
+
+    if (root_node.is_leaf())
+        return 0.0;
+
+    AABB3d root_bbox = root_node.get_left_bbox();
+    root_bbox.insert(root_node.get_right_bbox());
+
+    const double root_area = half_surface_area(root_bbox);
+
+    if (root_area <= 0.0)
+        return 0.0;
+
+    // Sum the surface areas of the children of all interior nodes, relative to the root.
+    double cost = 0.0;
+
+    for (const_each<NodeVectorType> i = m_nodes; i; ++i)
+    {
+        if (i->is_interior())
+        {
+            cost +=
+                half_surface_area(i->get_left_bbox()) +
+                half_surface_area(i->get_right_bbox());
+        }
     }
 
-    // Print assembly tree statistics.
-    RENDERER_LOG_DEBUG("%s",
-        StatisticsVector::make(
-            "assembly tree statistics",
-            statistics).to_string().c_str());
+    return cost / root_area;
 }
 
 void AssemblyTree::store_items_in_leaves(Statistics& statistics)
@@ -254,6 +679,9 @@ void AssemblyTree::update_tree_hierarchy()
     // Delete child trees of assemblies that no longer exist.
     delete_unused_child_trees(assemblies);
 
+    // Assemblies whose child trees are (re)created.
+    AssemblyVector updated_assemblies;
+
     // Create or rebuild the child trees of each assembly.
     for (const_each<AssemblyVector> i = assemblies; i; ++i)
     {
@@ -275,7 +703,15 @@ void AssemblyTree::update_tree_hierarchy()
 #endif
                 )
             {
-                // The child trees of this assembly are up-to-date.
+                // The child trees of this assembly are up-to-date, unless the level of
+                // detail of its curves depends on a camera that has moved.
+                if (is_curve_lod_outdated(assembly))
+                {
+                    delete_curve_tree(assembly.get_uid());
+                    create_curve_tree(assembly);
+                    updated_assemblies.push_back(&assembly);
+                }
+
                 continue;
             }
 
@@ -285,11 +721,20 @@ void AssemblyTree::update_tree_hierarchy()
 
         // Lazily build new child trees.
         create_child_trees(assembly);
+        updated_assemblies.push_back(&assembly);
 
         // Store the current version ID of the assembly.
         m_assembly_versions[assembly.get_uid()] = current_version_id;
     }
 
+    // Build the new child trees concurrently.
+    build_child_trees(updated_assemblies);
+
+    // Proxy tree keys sort after the keys of regular triangle trees.
+    m_has_proxy_trees =
+        !m_triangle_trees.empty() &&
+        m_triangle_trees.rbegin()->first >= (UniqueID(1) << 63);
+
     // Update child trees.
     update_triangle_trees();
 
@@ -305,7 +750,19 @@ void AssemblyTree::collect_unique_assemblies(AssemblyVector& assemblies) const
     assemblies.reserve(m_items.size());
 
     for (const_each<ItemVector> i = m_items; i; ++i)
-        assemblies.push_back(i->m_assembly);
+    {
+        if (i->m_point_instancer)
+        {
+            // Collect the non-empty prototypes of point instancers.
+            for (size_t j = 0, e = i->m_point_instancer->get_prototype_count(); j < e; ++j)
+            {
+                const Assembly& assembly = i->m_point_instancer->get_prototype_instance(j).get_assembly();
+                if (!assembly.object_instances().empty())
+                    assemblies.push_back(&assembly);
+            }
+        }
+        else assemblies.push_back(i->m_assembly);
+    }
 
     sort(assemblies.begin(), assemblies.end());
 
@@ -368,6 +825,117 @@ namespace
 
         return hash;
     }
+
+    bool has_proxy_objects(const Assembly& assembly)
+    {
+        for (const_each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
+        {
+            if (i->get_proxy_object() != nullptr)
+                return true;
+        }
+
+        return false;
+    }
+
+    uint64 hash_assembly_proxy_geometry(const Assembly& assembly)
+    {
+        uint64 hash = hash_assembly_geometry(assembly, MeshObjectFactory().get_model());
+
+        for (const_each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
+        {
+            const Object* proxy_object = i->get_proxy_object();
+            const uint64 values[2] = { hash, proxy_object ? proxy_object->get_uid() : ~uint64(0) };
+            hash = siphash24(&values, sizeof(values));
+        }
+
+        return hash;
+    }
+}
+
+namespace
+{
+    void update_tree_non_geometry(TriangleTree& tree, const bool enable_intersection_filters)
+    {
+        tree.update_non_geometry(enable_intersection_filters);
+    }
+
+    void update_tree_non_geometry(CurveTree& tree, const bool enable_intersection_filters)
+    {
+    }
+
+    //
+    // Wraps the factory of a child tree to record the trees it builds in the memory
+    // budget of the assembly tree. Trees built once the assembly tree was updated,
+    // i.e. on first access or after having been released, get their non-geometry
+    // aspects updated right away.
+    //
+
+    template <typename TreeType>
+    class BudgetedTreeFactory
+      : public ILazyFactory<TreeType>
+    {
+      public:
+        BudgetedTreeFactory(
+            unique_ptr<ILazyFactory<TreeType>>  factory,
+            TreeMemoryBudget&                   budget)
+          : m_factory(move(factory))
+          , m_budget(budget)
+          , m_tree(nullptr)
+          , m_has_non_geometry_settings(false)
+          , m_enable_intersection_filters(false)
+        {
+        }
+
+        ~BudgetedTreeFactory() override
+        {
+            m_budget.remove(m_tree);
+        }
+
+        void set_tree(Lazy<TreeType>* tree)
+        {
+            m_tree = tree;
+        }
+
+        void set_enable_intersection_filters(const bool enable)
+        {
+            m_has_non_geometry_settings = true;
+            m_enable_intersection_filters = enable;
+        }
+
+        unique_ptr<TreeType> create() override
+        {
+            unique_ptr<TreeType> tree = m_factory->create();
+
+            if (m_has_non_geometry_settings)
+                update_tree_non_geometry(*tree, m_enable_intersection_filters);
+
+            m_budget.insert(m_tree, tree->get_memory_size());
+
+            return tree;
+        }
+
+      private:
+        unique_ptr<ILazyFactory<TreeType>>      m_factory;
+        TreeMemoryBudget&                       m_budget;
+        Lazy<TreeType>*                         m_tree;
+        bool                                    m_has_non_geometry_settings;
+        bool                                    m_enable_intersection_filters;
+    };
+
+    template <typename TreeType>
+    Lazy<TreeType>* create_budgeted_tree(
+        unique_ptr<ILazyFactory<TreeType>>      factory,
+        TreeMemoryBudget&                       budget)
+    {
+        BudgetedTreeFactory<TreeType>* budgeted_factory =
+            new BudgetedTreeFactory<TreeType>(move(factory), budget);
+
+        Lazy<TreeType>* tree =
+            new Lazy<TreeType>(unique_ptr<ILazyFactory<TreeType>>(budgeted_factory));
+        budgeted_factory->set_tree(tree);
+
+        return tree;
+    }
 }
 
 void AssemblyTree::create_child_trees(const Assembly& assembly)
@@ -377,6 +945,11 @@ void AssemblyTree::create_child_trees(const Assembly& assembly)
     if (use_embree())
     {
         create_embree_scene(assembly);
+
+        // Fall back to a curve tree if Embree cannot intersect curves.
+        if (!m_scene.get_embree_device().supports_curves() &&
+            has_object_instances_of_type(assembly, CurveObjectFactory().get_model()))
+            create_curve_tree(assembly);
     }
     else
 
@@ -394,35 +967,82 @@ void AssemblyTree::create_child_trees(const Assembly& assembly)
 
 void AssemblyTree::create_triangle_tree(const Assembly& assembly)
 {
+    // Compute the assembly space bounding box of the assembly.
+    const GAABB3 assembly_bbox =
+        compute_parent_bbox<GAABB3>(
+            assembly.object_instances().begin(),
+            assembly.object_instances().end());
+
     const uint64 hash = hash_assembly_geometry(assembly, MeshObjectFactory().get_model());
     Lazy<TriangleTree>* tree = m_triangle_tree_repository.acquire(hash);
 
     if (tree == nullptr)
     {
-        // Compute the assembly space bounding box of the assembly.
-        const GAABB3 assembly_bbox =
-            compute_parent_bbox<GAABB3>(
-                assembly.object_instances().begin(),
-                assembly.object_instances().end());
-
         unique_ptr<ILazyFactory<TriangleTree>> triangle_tree_factory(
             new TriangleTreeFactory(
                 TriangleTree::Arguments(
                     m_scene,
                     assembly.get_uid(),
                     assembly_bbox,
-                    assembly)));
+                    assembly,
+                    m_paging_directory)));
 
-        tree = new Lazy<TriangleTree>(move(triangle_tree_factory));
+        tree = create_budgeted_tree(move(triangle_tree_factory), m_child_tree_budget);
         m_triangle_tree_repository.insert(hash, tree);
     }
 
     m_triangle_trees.insert(make_pair(assembly.get_uid(), tree));
+
+    // Create a second tree from the proxy geometry of the object instances, if any.
+    if (!has_proxy_objects(assembly))
+        return;
+
+    const UniqueID proxy_tree_key = get_proxy_triangle_tree_key(assembly.get_uid());
+    const uint64 proxy_hash = hash_assembly_proxy_geometry(assembly);
+    Lazy<TriangleTree>* proxy_tree = m_triangle_tree_repository.acquire(proxy_hash);
+
+    if (proxy_tree == nullptr)
+    {
+        unique_ptr<ILazyFactory<TriangleTree>> triangle_tree_factory(
+            new TriangleTreeFactory(
+                TriangleTree::Arguments(
+                    m_scene,
+                    proxy_tree_key,
+                    assembly_bbox,
+                    assembly,
+                    m_paging_directory,
+                    true)));
+
+        proxy_tree = create_budgeted_tree(move(triangle_tree_factory), m_child_tree_budget);
+        m_triangle_tree_repository.insert(proxy_hash, proxy_tree);
+    }
+
+    m_triangle_trees.insert(make_pair(proxy_tree_key, proxy_tree));
 }
 
 void AssemblyTree::create_curve_tree(const Assembly& assembly)
 {
-    const uint64 hash = hash_assembly_geometry(assembly, CurveObjectFactory().get_model());
+    uint64 hash = hash_assembly_geometry(assembly, CurveObjectFactory().get_model());
+
+    // Curve trees with level of detail are specific to a camera position.
+    GVector3 lod_camera_position;
+    const bool has_lod_camera = compute_curve_lod_camera_position(assembly, lod_camera_position);
+    if (has_lod_camera)
+    {
+        const double coords[3] =
+        {
+            static_cast<double>(lod_camera_position.x),
+            static_cast<double>(lod_camera_position.y),
+            static_cast<double>(lod_camera_position.z)
+        };
+        uint64 values[1 + 3];
+        values[0] = hash;
+        memcpy(&values[1], coords, sizeof(coords));
+        hash = siphash24(&values, sizeof(values));
+        m_curve_lod_cameras[assembly.get_uid()] = lod_camera_position;
+    }
+    else m_curve_lod_cameras.erase(assembly.get_uid());
+
     Lazy<CurveTree>* tree = m_curve_tree_repository.acquire(hash);
 
     if (tree == nullptr)
@@ -439,34 +1059,132 @@ void AssemblyTree::create_curve_tree(const Assembly& assembly)
                     m_scene,
                     assembly.get_uid(),
                     assembly_bbox,
-                    assembly)));
+                    assembly,
+                    has_lod_camera ? &lod_camera_position : nullptr)));
 
-        tree = new Lazy<CurveTree>(move(curve_tree_factory));
+        tree = create_budgeted_tree(move(curve_tree_factory), m_child_tree_budget);
         m_curve_tree_repository.insert(hash, tree);
     }
 
     m_curve_trees.insert(make_pair(assembly.get_uid(), tree));
 }
 
-#ifdef APPLESEED_WITH_EMBREE
-
-bool AssemblyTree::use_embree() const
-{
-    return m_use_embree;
-}
-
-void AssemblyTree::set_use_embree(const bool value)
+bool AssemblyTree::compute_curve_lod_camera_position(
+    const Assembly&         assembly,
+    GVector3&               position) const
 {
-    if (value != m_use_embree)
+    // Only curve object instances may enable level of detail.
+    bool has_curve_lod = false;
+    for (const_each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
     {
-        m_dirty = true;
-        m_use_embree = value;
-    }
+        if (strcmp(i->get_object().get_model(), CurveObjectFactory().get_model()) == 0 &&
+            i->get_parameters().get_optional<double>("curve_lod_distance", 0.0) > 0.0)
+        {
+            has_curve_lod = true;
+            break;
+        }
+    }
+
+    if (!has_curve_lod)
+        return false;
+
+    const Camera* camera = m_scene.get_active_camera();
+    if (camera == nullptr)
+        return false;
+
+    const Vector3d camera_position =
+        camera->transform_sequence().get_earliest_transform().point_to_parent(Vector3d(0.0));
+
+    const GAABB3 assembly_bbox =
+        compute_parent_bbox<GAABB3>(
+            assembly.object_instances().begin(),
+            assembly.object_instances().end());
+    const Vector3d assembly_center(assembly_bbox.center());
+
+    // Use the instance of the assembly that is the closest to the camera.
+    bool found = false;
+    double closest_square_distance = numeric_limits<double>::max();
+    for (const_each<ItemVector> i = m_items; i; ++i)
+    {
+        if (i->m_point_instancer != nullptr || i->m_assembly != &assembly)
+            continue;
+
+        const Vector3d local_camera_position =
+            i->m_transform_sequence.get_earliest_transform().point_to_local(camera_position);
+        const double d = square_norm(local_camera_position - assembly_center);
+
+        if (d < closest_square_distance)
+        {
+            closest_square_distance = d;
+            position = GVector3(local_camera_position);
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool AssemblyTree::is_curve_lod_outdated(const Assembly& assembly) const
+{
+    GVector3 lod_camera_position;
+    const bool has_lod_camera = compute_curve_lod_camera_position(assembly, lod_camera_position);
+
+    const CurveLODCameraMap::const_iterator it = m_curve_lod_cameras.find(assembly.get_uid());
+    if (it == m_curve_lod_cameras.end())
+        return has_lod_camera;
+
+    return !has_lod_camera || it->second != lod_camera_position;
+}
+
+#ifdef APPLESEED_WITH_EMBREE
+
+bool AssemblyTree::use_embree() const
+{
+    return m_use_embree;
+}
+
+void AssemblyTree::set_use_embree(const bool value)
+{
+    if (value != m_use_embree)
+    {
+        m_dirty = true;
+        m_use_embree = value;
+    }
+}
+
+bool AssemblyTree::use_embree_instancing() const
+{
+    return m_use_embree_instancing;
+}
+
+void AssemblyTree::set_use_embree_instancing(const bool value)
+{
+    m_use_embree_instancing = value;
+}
+
+const EmbreeSceneSettings& AssemblyTree::get_embree_scene_settings() const
+{
+    return m_embree_scene_settings;
+}
+
+void AssemblyTree::set_embree_scene_settings(const EmbreeSceneSettings& settings)
+{
+    if (settings != m_embree_scene_settings)
+    {
+        m_dirty = true;
+        m_embree_scene_settings = settings;
+    }
 }
 
 void AssemblyTree::create_embree_scene(const Assembly& assembly)
 {
-    const uint64 hash = hash_assembly_geometry(assembly, MeshObjectFactory().get_model());
+    // Scenes built with different settings must not be shared.
+    const uint64 hash =
+        mix_uint64(
+            hash_assembly_geometry(assembly, MeshObjectFactory().get_model()),
+            static_cast<uint64>(m_embree_scene_settings.m_build_quality),
+            static_cast<uint64>(m_embree_scene_settings.m_compact),
+            static_cast<uint64>(m_embree_scene_settings.m_robust));
     Lazy<EmbreeScene>* scene = m_embree_scene_repository.acquire(hash);
 
     if (scene == nullptr)
@@ -475,7 +1193,8 @@ void AssemblyTree::create_embree_scene(const Assembly& assembly)
             new EmbreeSceneFactory(
                 EmbreeScene::Arguments(
                     m_scene.get_embree_device(),
-                    assembly
+                    assembly,
+                    m_embree_scene_settings
                 )));
 
         scene = new Lazy<EmbreeScene>(move(embree_scene_factory));
@@ -495,6 +1214,129 @@ void AssemblyTree::delete_embree_scene(const UniqueID assembly_id)
     }
 }
 
+void AssemblyTree::update_embree_instance_scene()
+{
+    // The instance scene refers to the items of the tree: always rebuild it.
+    m_embree_instance_scene.reset();
+
+    if (!use_embree() || !use_embree_instancing())
+        return;
+
+    // Point instancers are intersected by the assembly leaf visitor.
+    if (has_point_instancers())
+    {
+        RENDERER_LOG_INFO(
+            "the scene contains point instancers; not using Embree instancing.");
+        return;
+    }
+
+    // Procedural objects are intersected by the assembly leaf visitor.
+    AssemblyVector assemblies;
+    collect_unique_assemblies(assemblies);
+    for (const_each<AssemblyVector> i = assemblies; i; ++i)
+    {
+        for (const_each<ObjectInstanceContainer> j = (*i)->object_instances(); j; ++j)
+        {
+            const char* model = j->get_object().get_model();
+            if (strcmp(model, MeshObjectFactory().get_model()) != 0 &&
+                strcmp(model, CurveObjectFactory().get_model()) != 0)
+            {
+                RENDERER_LOG_INFO(
+                    "the scene contains procedural objects; not using Embree instancing.");
+                return;
+            }
+
+            // Curve trees are intersected by the assembly leaf visitor.
+            if (!m_scene.get_embree_device().supports_curves() &&
+                strcmp(model, CurveObjectFactory().get_model()) == 0)
+            {
+                RENDERER_LOG_INFO(
+                    "Embree was built without curve support; not using Embree instancing.");
+                return;
+            }
+        }
+    }
+
+    EmbreeInstanceScene::InstanceVector instances(m_items.size());
+    for (size_t i = 0, e = m_items.size(); i < e; ++i)
+    {
+        const Item& item = m_items[i];
+        const EmbreeSceneContainer::const_iterator it = m_embree_scenes.find(item.m_assembly_uid);
+        assert(it != m_embree_scenes.end());
+
+        instances[i].m_assembly_instance = item.m_assembly_instance;
+        instances[i].m_transform_sequence = &item.m_transform_sequence;
+        instances[i].m_embree_scene.reset(it->second);
+    }
+
+    const Camera* camera = m_scene.get_active_camera();
+
+    m_embree_instance_scene.reset(
+        new EmbreeInstanceScene(
+            m_scene.get_embree_device(),
+            instances,
+            camera ? camera->get_shutter_open_begin_time() : 0.0f,
+            camera ? camera->get_shutter_close_end_time() : 1.0f,
+            m_embree_scene_settings));
+}
+
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+
+bool AssemblyTree::use_gpu() const
+{
+    return m_use_gpu;
+}
+
+void AssemblyTree::set_use_gpu(const bool value)
+{
+    m_use_gpu = value;
+}
+
+void AssemblyTree::update_gpu_scene()
+{
+    // The GPU scene refers to the items of the tree: always rebuild it.
+    m_gpu_scene.reset();
+
+    if (!use_gpu() || m_items.empty())
+        return;
+
+    if (has_point_instancers())
+    {
+        RENDERER_LOG_INFO("the scene contains point instancers; tracing rays on the cpu.");
+        return;
+    }
+
+    GPUScene::InstanceVector instances(m_items.size());
+    for (size_t i = 0, e = m_items.size(); i < e; ++i)
+    {
+        const Item& item = m_items[i];
+        instances[i].m_assembly = item.m_assembly;
+        instances[i].m_assembly_instance = item.m_assembly_instance;
+        instances[i].m_transform_sequence = &item.m_transform_sequence;
+    }
+
+    if (!GPUScene::is_supported(instances))
+    {
+        RENDERER_LOG_INFO(
+            "the scene uses features not supported on the gpu (motion blur, alpha mapping, "
+            "visibility flags or procedural objects); tracing rays on the cpu.");
+        return;
+    }
+
+    RENDERER_LOG_INFO("building gpu scene...");
+
+    try
+    {
+        m_gpu_scene.reset(new GPUScene(instances));
+    }
+    catch (const Exception& e)
+    {
+        RENDERER_LOG_WARNING("%s; tracing rays on the cpu.", e.what());
+    }
+}
+
 #endif
 
 void AssemblyTree::delete_child_trees(const UniqueID assembly_id)
@@ -508,11 +1350,16 @@ void AssemblyTree::delete_child_trees(const UniqueID assembly_id)
 
 void AssemblyTree::delete_triangle_tree(const UniqueID assembly_id)
 {
-    const TriangleTreeContainer::iterator it = m_triangle_trees.find(assembly_id);
-    if (it != m_triangle_trees.end())
+    const UniqueID keys[2] = { assembly_id, get_proxy_triangle_tree_key(assembly_id) };
+
+    for (size_t i = 0; i < 2; ++i)
     {
-        m_triangle_tree_repository.release(it->second);
-        m_triangle_trees.erase(it);
+        const TriangleTreeContainer::iterator it = m_triangle_trees.find(keys[i]);
+        if (it != m_triangle_trees.end())
+        {
+            m_triangle_tree_repository.release(it->second);
+            m_triangle_trees.erase(it);
+        }
     }
 }
 
@@ -524,6 +1371,248 @@ void AssemblyTree::delete_curve_tree(const UniqueID assembly_id)
         m_curve_tree_repository.release(it->second);
         m_curve_trees.erase(it);
     }
+
+    m_curve_lod_cameras.erase(assembly_id);
+}
+
+namespace
+{
+    //
+    // Rough estimates of the temporary memory needed to build child trees,
+    // in bytes per triangle and per curve. They account for the primitive keys,
+    // vertex infos, bounding boxes and partitioner orderings of the builders.
+    //
+
+    const size_t TriangleTreeBuildBytesPerTriangle = 256;
+    const size_t CurveTreeBuildBytesPerCurve = 512;
+
+    size_t estimate_triangle_tree_build_memory(const Assembly& assembly)
+    {
+        const char* model = MeshObjectFactory().get_model();
+        size_t triangle_count = 0;
+
+        for (const_each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
+        {
+            const Object& object = i->get_object();
+
+            if (strcmp(object.get_model(), model) == 0)
+            {
+                const MeshObject& mesh = static_cast<const MeshObject&>(object);
+                triangle_count += mesh.get_triangle_count() * (mesh.get_motion_segment_count() + 1);
+            }
+        }
+
+        return triangle_count * TriangleTreeBuildBytesPerTriangle;
+    }
+
+    size_t estimate_curve_tree_build_memory(const Assembly& assembly)
+    {
+        const char* model = CurveObjectFactory().get_model();
+        size_t curve_count = 0;
+
+        for (const_each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
+        {
+            const Object& object = i->get_object();
+
+            if (strcmp(object.get_model(), model) == 0)
+                curve_count += static_cast<const CurveObject&>(object).get_curve_count();
+        }
+
+        return curve_count * CurveTreeBuildBytesPerCurve;
+    }
+
+    //
+    // Bounds the estimated memory used by the child trees being built at any one time.
+    // A build that exceeds the budget on its own is still allowed to run alone.
+    //
+
+    class BuildMemoryBudget
+      : public NonCopyable
+    {
+      public:
+        explicit BuildMemoryBudget(const size_t max_size)
+          : m_max_size(max_size)
+          , m_size(0)
+        {
+        }
+
+        void acquire(const size_t size)
+        {
+            boost::unique_lock<boost::mutex> lock(m_mutex);
+
+            while (m_size > 0 && m_size + size > m_max_size)
+                m_released.wait(lock);
+
+            m_size += size;
+        }
+
+        void release(const size_t size)
+        {
+            boost::lock_guard<boost::mutex> lock(m_mutex);
+
+            assert(m_size >= size);
+            m_size -= size;
+
+            m_released.notify_all();
+        }
+
+      private:
+        const size_t                m_max_size;
+        size_t                      m_size;
+        boost::mutex                m_mutex;
+        boost::condition_variable   m_released;
+    };
+
+    template <typename TreeType>
+    class BuildTreeJob
+      : public IJob
+    {
+      public:
+        BuildTreeJob(
+            Lazy<TreeType>*         tree,
+            const size_t            memory_size,
+            BuildMemoryBudget&      budget)
+          : m_tree(tree)
+          , m_memory_size(memory_size)
+          , m_budget(budget)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            const BudgetReservation reservation(m_budget, m_memory_size);
+
+            // Accessing the lazy tree forces its construction.
+            Access<TreeType> access(m_tree);
+        }
+
+      private:
+        struct BudgetReservation
+          : public NonCopyable
+        {
+            BuildMemoryBudget&  m_budget;
+            const size_t        m_size;
+
+            BudgetReservation(BuildMemoryBudget& budget, const size_t size)
+              : m_budget(budget)
+              , m_size(size)
+            {
+                m_budget.acquire(m_size);
+            }
+
+            ~BudgetReservation()
+            {
+                m_budget.release(m_size);
+            }
+        };
+
+        Lazy<TreeType>*             m_tree;
+        const size_t                m_memory_size;
+        BuildMemoryBudget&          m_budget;
+    };
+
+    template <typename TreeType, typename TreeContainer>
+    void schedule_tree_builds(
+        const TreeContainer&        trees,
+        const UniqueID              assembly_uid,
+        const size_t                memory_size,
+        set<Lazy<TreeType>*>&       scheduled_trees,
+        BuildMemoryBudget&          budget,
+        JobQueue&                   job_queue)
+    {
+        const typename TreeContainer::const_iterator it = trees.find(assembly_uid);
+
+        // Trees shared by several assemblies only need to be built once.
+        if (it != trees.end() && scheduled_trees.insert(it->second).second)
+            job_queue.schedule(new BuildTreeJob<TreeType>(it->second, memory_size, budget));
+    }
+}
+
+void AssemblyTree::build_child_trees(const AssemblyVector& assemblies)
+{
+    // Lazy child trees are built by the first ray that enters their bounds.
+    if (m_lazy_child_trees)
+        return;
+
+    const size_t thread_count = System::get_logical_cpu_core_count();
+
+    if (assemblies.size() < 2 || thread_count < 2)
+        return;
+
+    // Keep the peak build memory within a fraction of the physical memory.
+    BuildMemoryBudget budget(
+        static_cast<size_t>(System::get_total_physical_memory_size() / 4));
+
+    JobQueue job_queue;
+    set<Lazy<TriangleTree>*> scheduled_triangle_trees;
+    set<Lazy<CurveTree>*> scheduled_curve_trees;
+#ifdef APPLESEED_WITH_EMBREE
+    set<Lazy<EmbreeScene>*> scheduled_embree_scenes;
+#endif
+
+    for (const_each<AssemblyVector> i = assemblies; i; ++i)
+    {
+        const Assembly& assembly = **i;
+
+        schedule_tree_builds(
+            m_triangle_trees,
+            assembly.get_uid(),
+            estimate_triangle_tree_build_memory(assembly),
+            scheduled_triangle_trees,
+            budget,
+            job_queue);
+
+        schedule_tree_builds(
+            m_triangle_trees,
+            get_proxy_triangle_tree_key(assembly.get_uid()),
+            estimate_triangle_tree_build_memory(assembly),
+            scheduled_triangle_trees,
+            budget,
+            job_queue);
+
+        schedule_tree_builds(
+            m_curve_trees,
+            assembly.get_uid(),
+            estimate_curve_tree_build_memory(assembly),
+            scheduled_curve_trees,
+            budget,
+            job_queue);
+
+#ifdef APPLESEED_WITH_EMBREE
+        // Independent Embree scenes are committed concurrently as well.
+        schedule_tree_builds(
+            m_embree_scenes,
+            assembly.get_uid(),
+            estimate_triangle_tree_build_memory(assembly),
+            scheduled_embree_scenes,
+            budget,
+            job_queue);
+#endif
+    }
+
+    if (job_queue.get_scheduled_job_count() < 2)
+    {
+        // Let the trees be built on first access.
+        job_queue.clear_scheduled_jobs();
+        return;
+    }
+
+    RENDERER_LOG_INFO(
+        "building %s %s using %s %s...",
+        pretty_uint(job_queue.get_scheduled_job_count()).c_str(),
+        plural(job_queue.get_scheduled_job_count(), "child tree").c_str(),
+        pretty_uint(thread_count).c_str(),
+        plural(thread_count, "thread").c_str());
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        thread_count,
+        JobManager::KeepRunningOnEmptyQueue | JobManager::KeepRunningOnJobFailure);
+
+    job_manager.start();
+    job_queue.wait_until_completion();
+    job_manager.stop();
 }
 
 namespace
@@ -531,31 +1620,55 @@ namespace
     template <typename TreeType>
     struct UpdateTrees
     {
-        void operator()(Lazy<TreeType>& tree, const size_t ref_count)
+        const TreeMemoryBudget&     m_budget;
+        const bool                  m_lazy;
+
+        UpdateTrees(const TreeMemoryBudget& budget, const bool lazy)
+          : m_budget(budget)
+          , m_lazy(lazy)
         {
-            Access<TreeType> update(&tree);
+        }
 
+        void operator()(Lazy<TreeType>& tree, const size_t ref_count)
+        {
             const bool enable_intersection_filters = ref_count == 1;
-            update->update_non_geometry(enable_intersection_filters);
+            const bool built = m_budget.contains(&tree);
+
+            // Trees built from now on will update themselves.
+            static_cast<BudgetedTreeFactory<TreeType>*>(tree.get_factory())
+                ->set_enable_intersection_filters(enable_intersection_filters);
+
+            if (built)
+            {
+                Access<TreeType> update(&tree);
+                update->update_non_geometry(enable_intersection_filters);
+            }
+            else if (!m_lazy)
+            {
+                // Accessing the lazy tree forces its construction.
+                Access<TreeType> access(&tree);
+            }
         }
     };
 }
 
 void AssemblyTree::update_triangle_trees()
 {
-    UpdateTrees<TriangleTree> update_trees;
+    UpdateTrees<TriangleTree> update_trees(m_child_tree_budget, m_lazy_child_trees);
     m_triangle_tree_repository.for_each(update_trees);
 }
 
 
 //
-// Utility function to transform a ray to the space of an assembly instance.
+// Utility functions to transform a ray to the space of an assembly instance or of a point instancer.
 //
 
 namespace
 {
     void compute_assembly_instance_ray(
         const AssemblyInstance&     assembly_instance,
+        const PointInstancer*       point_instancer,
+        const size_t                point_instance_index,
         const Transformd&           assembly_instance_transform,
         const ShadingPoint*         parent_sp,
         const ShadingRay&           input_ray,
@@ -567,6 +1680,8 @@ namespace
         // Compute the ray origin in assembly instance space.
         if (parent_sp &&
             parent_sp->get_assembly_instance().get_uid() == assembly_instance.get_uid() &&
+            parent_sp->get_point_instancer() == point_instancer &&
+            parent_sp->get_point_instance_index() == point_instance_index &&
             parent_sp->get_object_instance().get_ray_bias_method() == ObjectInstance::RayBiasMethodNone)
         {
             // The caller provided the previous intersection, and we are about
@@ -595,6 +1710,24 @@ namespace
         output_ray.m_depth = input_ray.m_depth;
         output_ray.m_medium_count = input_ray.m_medium_count;
     }
+
+    void compute_point_instancer_ray(
+        const Transformd&           point_instancer_transform,
+        const ShadingRay&           input_ray,
+        ShadingRay&                 output_ray)
+    {
+        // The ray is only used to traverse the tree of the point instancer:
+        // instances are intersected using the input ray.
+        output_ray.m_org = point_instancer_transform.point_to_local(input_ray.m_org);
+        output_ray.m_dir = point_instancer_transform.vector_to_local(input_ray.m_dir);
+        output_ray.m_has_differentials = false;
+        output_ray.m_tmin = input_ray.m_tmin;
+        output_ray.m_tmax = input_ray.m_tmax;
+        output_ray.m_time = input_ray.m_time;
+        output_ray.m_flags = input_ray.m_flags;
+        output_ray.m_depth = input_ray.m_depth;
+        output_ray.m_medium_count = input_ray.m_medium_count;
+    }
 }
 
 
@@ -612,6 +1745,8 @@ bool AssemblyLeafVisitor::visit(
 #endif
     )
 {
+    ++RenderingCounters::current().m_traversal_step_count;
+
     // Retrieve the assembly instances for this leaf.
     const size_t assembly_instance_index = node.get_item_index();
     const size_t assembly_instance_count = node.get_item_count();
@@ -622,8 +1757,22 @@ bool AssemblyLeafVisitor::visit(
 
     for (size_t i = 0; i < assembly_instance_count; ++i)
     {
-        // Retrieve the assembly instance.
         const AssemblyTree::Item& item = items[i];
+
+        // Point instancers.
+        if (item.m_point_instancer)
+        {
+            // Skip this point instancer if it isn't visible for this ray.
+            if (!(item.m_point_instancer->get_vis_flags() & ray.m_flags))
+                continue;
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(1));
+
+            visit_point_instancer(item, ray);
+            continue;
+        }
+
+        // Retrieve the assembly instance.
         const AssemblyInstance& assembly_instance = *item.m_assembly_instance;
 
         // Skip this assembly instance if it isn't visible for this ray.
@@ -633,177 +1782,322 @@ bool AssemblyLeafVisitor::visit(
         FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(1));
 
         // Evaluate the transformation of the assembly instance.
-        const TransformSequence* assembly_instance_transform_seq =
-            &item.m_transform_sequence;
         Transformd scratch;
         const Transformd& assembly_instance_transform =
-            assembly_instance_transform_seq->evaluate(ray.m_time.m_absolute, scratch);
+            item.m_transform_sequence.evaluate(ray.m_time.m_absolute, scratch);
 
-        // Transform the ray to assembly instance space.
-        ShadingPoint local_shading_point;
-        compute_assembly_instance_ray(
+        visit_assembly(
+            *item.m_assembly,
             assembly_instance,
             assembly_instance_transform,
-            m_parent_shading_point,
-            ray,
-            local_shading_point.m_ray);
-        const RayInfo3d local_ray_info(local_shading_point.m_ray);
+            &item.m_transform_sequence,
+            nullptr,
+            0,
+            ray);
+    }
+
+    // Continue traversal.
+    distance = m_shading_point.m_ray.m_tmax;
+    return true;
+}
+
+void AssemblyLeafVisitor::visit_assembly_instance(
+    const ShadingPoint&                 owner,
+    const ShadingRay&                   ray)
+{
+    assert(owner.hit_surface());
+
+    ++RenderingCounters::current().m_traversal_step_count;
+
+    const AssemblyInstance& assembly_instance = *owner.m_assembly_instance;
+
+    visit_assembly(
+        assembly_instance.get_assembly(),
+        assembly_instance,
+        owner.m_assembly_instance_transform,
+        owner.m_assembly_instance_transform_seq,
+        owner.m_point_instancer,
+        owner.m_point_instance_index,
+        ray);
+}
+
+void AssemblyLeafVisitor::visit_assembly(
+    const Assembly&                     assembly,
+    const AssemblyInstance&             assembly_instance,
+    const Transformd&                   assembly_instance_transform,
+    const TransformSequence*            assembly_instance_transform_seq,
+    const PointInstancer*               point_instancer,
+    const size_t                        point_instance_index,
+    const ShadingRay&                   ray)
+{
+    const UniqueID assembly_uid = assembly.get_uid();
+
+    // Transform the ray to assembly instance space.
+    ShadingPoint local_shading_point;
+    compute_assembly_instance_ray(
+        assembly_instance,
+        point_instancer,
+        point_instance_index,
+        assembly_instance_transform,
+        m_parent_shading_point,
+        ray,
+        local_shading_point.m_ray);
+    const RayInfo3d local_ray_info(local_shading_point.m_ray);
+
+    // Whether triangles were intersected from the proxy tree of this assembly.
+    bool hit_proxy_tree = false;
 
 #ifdef APPLESEED_WITH_EMBREE
 
-        if (m_tree.use_embree())
-        {
-            const EmbreeScene& embree_scene =
-                *m_embree_scene_cache.access(
-                    item.m_assembly_uid,
-                    m_tree.m_embree_scenes);
+    if (m_tree.use_embree())
+    {
+        const EmbreeScene& embree_scene =
+            *m_embree_scene_cache.access(
+                assembly_uid,
+                m_tree.m_embree_scenes);
 
-            embree_scene.intersect(local_shading_point);
-        }
-        else
+        embree_scene.intersect(local_shading_point);
+    }
+    else
 
 #endif
+    {
+        // Retrieve the triangle tree of this assembly, or its proxy version.
+        const TriangleTree* triangle_tree = nullptr;
+        if (m_use_proxy_trees)
         {
-            // Retrieve the triangle tree of this assembly.
-            const TriangleTree* triangle_tree =
+            triangle_tree =
                 m_triangle_tree_cache.access(
-                    item.m_assembly_uid,
+                    AssemblyTree::get_proxy_triangle_tree_key(assembly_uid),
                     m_tree.m_triangle_trees);
+            hit_proxy_tree = triangle_tree != nullptr;
+        }
+        if (triangle_tree == nullptr)
+        {
+            triangle_tree =
+                m_triangle_tree_cache.access(
+                    assembly_uid,
+                    m_tree.m_triangle_trees);
+        }
 
-            if (triangle_tree)
+        if (triangle_tree)
+        {
+            // Check the intersection between the ray and the triangle tree.
+            TriangleLeafVisitor visitor(*triangle_tree, local_shading_point);
+            if (const TriangleTree::WideTreeType* wide_tree = triangle_tree->get_wide_tree())
+            {
+                TriangleTreeWideIntersector intersector;
+                intersector.intersect_no_motion(
+                    *wide_tree,
+                    local_shading_point.m_ray,
+                    local_ray_info,
+                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , m_triangle_tree_stats
+#endif
+                    );
+            }
+            else if (triangle_tree->get_moving_triangle_count() > 0)
             {
-                // Check the intersection between the ray and the triangle tree.
                 TriangleTreeIntersector intersector;
-                TriangleLeafVisitor visitor(*triangle_tree, local_shading_point);
-                if (triangle_tree->get_moving_triangle_count() > 0)
-                {
-                    intersector.intersect_motion(
-                        *triangle_tree,
-                        local_shading_point.m_ray,
-                        local_ray_info,
-                        local_shading_point.m_ray.m_time.m_normalized,
-                        visitor
+                intersector.intersect_motion(
+                    *triangle_tree,
+                    local_shading_point.m_ray,
+                    local_ray_info,
+                    local_shading_point.m_ray.m_time.m_normalized,
+                    visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-                        , m_triangle_tree_stats
+                    , m_triangle_tree_stats
 #endif
-                        );
-                }
-                else
-                {
-                    intersector.intersect_no_motion(
-                        *triangle_tree,
-                        local_shading_point.m_ray,
-                        local_ray_info,
-                        visitor
+                    );
+            }
+            else
+            {
+                TriangleTreeIntersector intersector;
+                intersector.intersect_no_motion(
+                    *triangle_tree,
+                    local_shading_point.m_ray,
+                    local_ray_info,
+                    visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-                        , m_triangle_tree_stats
+                    , m_triangle_tree_stats
 #endif
-                        );
-                }
-                visitor.read_hit_triangle_data();
+                    );
             }
+            visitor.read_hit_triangle_data();
         }
+    }
+
+    // Retrieve the curve tree of this assembly.
+    const CurveTree* curve_tree =
+        m_curve_tree_cache.access(
+            assembly_uid,
+            m_tree.m_curve_trees);
 
-        // Retrieve the curve tree of this assembly.
-        const CurveTree* curve_tree =
-            m_curve_tree_cache.access(
-                item.m_assembly_uid,
-                m_tree.m_curve_trees);
-
-        if (curve_tree)
-        {
-            // Check the intersection between the ray and the curve tree.
-            const GRay3 ray(local_shading_point.m_ray);
-            const GRayInfo3 ray_info(local_ray_info);
-            CurveMatrixType xfm_matrix;
-            make_curve_projection_transform(xfm_matrix, ray);
-            CurveLeafVisitor visitor(*curve_tree, xfm_matrix, local_shading_point);
-            CurveTreeIntersector intersector;
-            intersector.intersect_no_motion(
-                *curve_tree,
-                ray,
-                ray_info,
-                visitor
+    if (curve_tree)
+    {
+        // Check the intersection between the ray and the curve tree.
+        const GRay3 ray(local_shading_point.m_ray);
+        const GRayInfo3 ray_info(local_ray_info);
+        CurveMatrixType xfm_matrix;
+        make_curve_projection_transform(xfm_matrix, ray);
+        CurveLeafVisitor visitor(*curve_tree, xfm_matrix, local_shading_point);
+        CurveTreeIntersector intersector;
+        intersector.intersect_no_motion(
+            *curve_tree,
+            ray,
+            ray_info,
+            visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-                , m_curve_tree_stats
+            , m_curve_tree_stats
 #endif
-                );
-        }
+            );
+    }
 
-        // Keep track of the closest hit.
-        if (local_shading_point.hit_surface() && local_shading_point.m_ray.m_tmax < m_shading_point.m_ray.m_tmax)
-        {
-            m_shading_point.m_ray.m_tmax = local_shading_point.m_ray.m_tmax;
-            m_shading_point.m_primitive_type = local_shading_point.m_primitive_type;
-            m_shading_point.m_bary = local_shading_point.m_bary;
-            m_shading_point.m_assembly_instance = item.m_assembly_instance;
-            m_shading_point.m_assembly_instance_transform = assembly_instance_transform;
-            m_shading_point.m_assembly_instance_transform_seq = assembly_instance_transform_seq;
-            m_shading_point.m_object_instance_index = local_shading_point.m_object_instance_index;
-            m_shading_point.m_primitive_index = local_shading_point.m_primitive_index;
-            m_shading_point.m_triangle_support_plane = local_shading_point.m_triangle_support_plane;
-        }
+    // Keep track of the closest hit.
+    if (local_shading_point.hit_surface() && local_shading_point.m_ray.m_tmax < m_shading_point.m_ray.m_tmax)
+    {
+        m_shading_point.m_ray.m_tmax = local_shading_point.m_ray.m_tmax;
+        m_shading_point.m_primitive_type = local_shading_point.m_primitive_type;
+        m_shading_point.m_bary = local_shading_point.m_bary;
+        m_shading_point.m_assembly_instance = &assembly_instance;
+        m_shading_point.m_assembly_instance_transform = assembly_instance_transform;
+        m_shading_point.m_assembly_instance_transform_seq = assembly_instance_transform_seq;
+        m_shading_point.m_point_instancer = point_instancer;
+        m_shading_point.m_point_instance_index = point_instance_index;
+        m_shading_point.m_object_instance_index = local_shading_point.m_object_instance_index;
+        m_shading_point.m_primitive_index = local_shading_point.m_primitive_index;
+        m_shading_point.m_triangle_support_plane = local_shading_point.m_triangle_support_plane;
+
+        // Let the shading point fetch the geometry of the proxy that was hit.
+        if (hit_proxy_tree && local_shading_point.m_primitive_type == ShadingPoint::PrimitiveTriangle)
+            m_shading_point.m_ray.m_flags |= VisibilityFlags::ProxyRay;
+        else m_shading_point.m_ray.m_flags &= ~VisibilityFlags::ProxyRay;
+    }
 
-        // Check the intersection between the ray and procedural objects.
-        if (item.m_assembly->has_render_data())
+    // Check the intersection between the ray and procedural objects.
+    if (assembly.has_render_data())
+    {
+        const IndexedObjectInstanceArray& procedural_object_instances =
+            assembly.get_render_data().m_procedural_object_instances;
+
+        for (size_t j = 0, e = procedural_object_instances.size(); j < e; ++j)
         {
-            const IndexedObjectInstanceArray& procedural_object_instances =
-                item.m_assembly->get_render_data().m_procedural_object_instances;
+            // Retrieve the object instance.
+            const IndexedObjectInstance& object_instance_index_pair = procedural_object_instances[j];
+            const ObjectInstance* object_instance = object_instance_index_pair.first;
+
+            // Skip this object instance if it isn't visible for this ray.
+            if (!(object_instance->get_vis_flags() & ray.m_flags))
+                continue;
 
-            for (size_t j = 0, e = procedural_object_instances.size(); j < e; ++j)
+            // Transform the ray to object instance space.
+            // todo: transform ray differentials.
+            const Transformd& object_instance_transform = object_instance->get_transform();
+            ShadingRay instance_local_ray;
+            instance_local_ray.m_org = object_instance_transform.point_to_local(local_shading_point.m_ray.m_org);
+            instance_local_ray.m_dir = object_instance_transform.vector_to_local(local_shading_point.m_ray.m_dir);
+            instance_local_ray.m_has_differentials = false;
+            instance_local_ray.m_tmin = local_shading_point.m_ray.m_tmin;
+            instance_local_ray.m_tmax = local_shading_point.m_ray.m_tmax;
+            instance_local_ray.m_time = local_shading_point.m_ray.m_time;
+            instance_local_ray.m_flags = local_shading_point.m_ray.m_flags;
+            instance_local_ray.m_depth = local_shading_point.m_ray.m_depth;
+            instance_local_ray.m_medium_count = local_shading_point.m_ray.m_medium_count;
+
+            // Ask the procedural object to intersect itself against the ray.
+            const ProceduralObject& object = static_cast<const ProceduralObject&>(object_instance->get_object());
+            ProceduralObject::IntersectionResult result;
+            object.intersect(instance_local_ray, result);
+
+            // Keep track of the closest hit.
+            if (result.m_hit && result.m_distance < m_shading_point.m_ray.m_tmax)
             {
-                // Retrieve the object instance.
-                const IndexedObjectInstance& object_instance_index_pair = procedural_object_instances[j];
-                const ObjectInstance* object_instance = object_instance_index_pair.first;
-
-                // Skip this object instance if it isn't visible for this ray.
-                if (!(object_instance->get_vis_flags() & ray.m_flags))
-                    continue;
-
-                // Transform the ray to object instance space.
-                // todo: transform ray differentials.
-                const Transformd& object_instance_transform = object_instance->get_transform();
-                ShadingRay instance_local_ray;
-                instance_local_ray.m_org = object_instance_transform.point_to_local(local_shading_point.m_ray.m_org);
-                instance_local_ray.m_dir = object_instance_transform.vector_to_local(local_shading_point.m_ray.m_dir);
-                instance_local_ray.m_has_differentials = false;
-                instance_local_ray.m_tmin = local_shading_point.m_ray.m_tmin;
-                instance_local_ray.m_tmax = local_shading_point.m_ray.m_tmax;
-                instance_local_ray.m_time = local_shading_point.m_ray.m_time;
-                instance_local_ray.m_flags = local_shading_point.m_ray.m_flags;
-                instance_local_ray.m_depth = local_shading_point.m_ray.m_depth;
-                instance_local_ray.m_medium_count = local_shading_point.m_ray.m_medium_count;
-
-                // Ask the procedural object to intersect itself against the ray.
-                const ProceduralObject& object = static_cast<const ProceduralObject&>(object_instance->get_object());
-                ProceduralObject::IntersectionResult result;
-                object.intersect(instance_local_ray, result);
-
-                // Keep track of the closest hit.
-                if (result.m_hit && result.m_distance < m_shading_point.m_ray.m_tmax)
-                {
-                    m_shading_point.m_ray.m_tmax = result.m_distance;
-                    m_shading_point.m_primitive_type = ShadingPoint::PrimitiveProceduralSurface;
-                    m_shading_point.m_bary = result.m_uv;
-                    m_shading_point.m_assembly_instance = item.m_assembly_instance;
-                    m_shading_point.m_assembly_instance_transform = assembly_instance_transform;
-                    m_shading_point.m_assembly_instance_transform_seq = assembly_instance_transform_seq;
-                    m_shading_point.m_object_instance_index = object_instance_index_pair.second;
-                    m_shading_point.m_primitive_index = 0;
-                    m_shading_point.m_primitive_pa = result.m_material_slot;
-                    m_shading_point.m_geometric_normal = object_instance_transform.normal_to_parent(result.m_geometric_normal);
-                    m_shading_point.m_original_shading_normal = object_instance_transform.normal_to_parent(result.m_shading_normal);
-                    m_shading_point.m_uv = result.m_uv;
-                }
+                m_shading_point.m_ray.m_tmax = result.m_distance;
+                m_shading_point.m_primitive_type = ShadingPoint::PrimitiveProceduralSurface;
+                m_shading_point.m_bary = result.m_uv;
+                m_shading_point.m_assembly_instance = &assembly_instance;
+                m_shading_point.m_assembly_instance_transform = assembly_instance_transform;
+                m_shading_point.m_assembly_instance_transform_seq = assembly_instance_transform_seq;
+                m_shading_point.m_point_instancer = point_instancer;
+                m_shading_point.m_point_instance_index = point_instance_index;
+                m_shading_point.m_object_instance_index = object_instance_index_pair.second;
+                m_shading_point.m_primitive_index = 0;
+                m_shading_point.m_primitive_pa = result.m_material_slot;
+                m_shading_point.m_geometric_normal = object_instance_transform.normal_to_parent(result.m_geometric_normal);
+                m_shading_point.m_original_shading_normal = object_instance_transform.normal_to_parent(result.m_shading_normal);
+                m_shading_point.m_uv = result.m_uv;
             }
         }
     }
-
-    // Continue traversal.
-    distance = m_shading_point.m_ray.m_tmax;
-    return true;
 }
 
+struct AssemblyLeafVisitor::PointInstanceVisitor
+{
+    AssemblyLeafVisitor&                m_visitor;
+    const AssemblyTree::Item&           m_item;
+    const Transformd&                   m_point_instancer_transform;
+    const ShadingRay&                   m_ray;
+
+    bool visit_instance(
+        const size_t                    instance_index,
+        double&                         distance)
+    {
+        const PointInstancer& point_instancer = *m_item.m_point_instancer;
+        const AssemblyInstance& prototype_instance =
+            point_instancer.get_prototype_instance(
+                point_instancer.get_instance_prototype(instance_index));
+
+        // Place the prototype in the space of the point instancer, then in world space.
+        const Transformd instance_transform =
+            point_instancer.get_instance_transform(instance_index) * m_point_instancer_transform;
+
+        m_visitor.visit_assembly(
+            prototype_instance.get_assembly(),
+            prototype_instance,
+            instance_transform,
+            &m_item.m_transform_sequence,
+            &point_instancer,
+            instance_index,
+            m_ray);
+
+        // Continue traversal.
+        distance = m_visitor.m_shading_point.m_ray.m_tmax;
+        return true;
+    }
+};
+
+void AssemblyLeafVisitor::visit_point_instancer(
+    const AssemblyTree::Item&           item,
+    const ShadingRay&                   ray)
+{
+    // Evaluate the transformation of the point instancer.
+    Transformd scratch;
+    const Transformd& point_instancer_transform =
+        item.m_transform_sequence.evaluate(ray.m_time.m_absolute, scratch);
+
+    // Transform the ray to point instancer space.
+    ShadingRay local_ray;
+    compute_point_instancer_ray(point_instancer_transform, ray, local_ray);
+    const RayInfo3d local_ray_info(local_ray);
+
+    // Intersect the instances whose bounding box is hit by the ray.
+    PointInstanceVisitor instance_visitor = { *this, item, point_instancer_transform, ray };
+    PointInstancerLeafVisitor<PointInstanceVisitor> visitor(*item.m_point_instancer_tree, instance_visitor);
+    PointInstancerTreeIntersector<PointInstanceVisitor>::Type intersector;
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    bvh::TraversalStatistics point_instancer_tree_stats;
+#endif
+    intersector.intersect_no_motion(
+        *item.m_point_instancer_tree,
+        local_ray,
+        local_ray_info,
+        visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , point_instancer_tree_stats
+#endif
+        );
+}
 
 //
 // AssemblyLeafProbeVisitor class implementation.
@@ -819,6 +2113,8 @@ bool AssemblyLeafProbeVisitor::visit(
 #endif
     )
 {
+    ++RenderingCounters::current().m_traversal_step_count;
+
     // Retrieve the assembly instances for this leaf.
     const size_t assembly_instance_count = node.get_item_count();
     const AssemblyTree::Item* items =
@@ -828,8 +2124,28 @@ bool AssemblyLeafProbeVisitor::visit(
 
     for (size_t i = 0; i < assembly_instance_count; ++i)
     {
-        // Retrieve the assembly instance.
         const AssemblyTree::Item& item = items[i];
+
+        // Point instancers.
+        if (item.m_point_instancer)
+        {
+            // Skip this point instancer if it isn't visible for this ray.
+            if (!(item.m_point_instancer->get_vis_flags() & ray.m_flags))
+                continue;
+
+            FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(1));
+
+            // Terminate traversal if there was a hit.
+            if (visit_point_instancer(item, ray))
+            {
+                m_hit = true;
+                return false;
+            }
+
+            continue;
+        }
+
+        // Retrieve the assembly instance.
         const AssemblyInstance& assembly_instance = *item.m_assembly_instance;
 
         // Skip this assembly instance if it isn't visible for this ray.
@@ -843,158 +2159,442 @@ bool AssemblyLeafProbeVisitor::visit(
         const Transformd& assembly_instance_transform =
             item.m_transform_sequence.evaluate(ray.m_time.m_absolute, scratch);
 
-        // Transform the ray to assembly instance space.
-        ShadingRay local_ray;
-        compute_assembly_instance_ray(
-            assembly_instance,
-            assembly_instance_transform,
-            m_parent_shading_point,
-            ray,
-            local_ray);
-        const RayInfo3d local_ray_info(local_ray);
+        // Terminate traversal if there was a hit.
+        if (visit_assembly(
+                *item.m_assembly,
+                assembly_instance,
+                assembly_instance_transform,
+                &item.m_transform_sequence,
+                nullptr,
+                0,
+                ray))
+        {
+            m_hit = true;
+            return false;
+        }
+    }
+
+    // Continue traversal.
+    distance = ray.m_tmax;
+    return true;
+}
+
+bool AssemblyLeafProbeVisitor::visit_assembly(
+    const Assembly&                     assembly,
+    const AssemblyInstance&             assembly_instance,
+    const Transformd&                   assembly_instance_transform,
+    const TransformSequence*            assembly_instance_transform_seq,
+    const PointInstancer*               point_instancer,
+    const size_t                        point_instance_index,
+    const ShadingRay&                   ray)
+{
+    const UniqueID assembly_uid = assembly.get_uid();
+
+    // Transform the ray to assembly instance space.
+    ShadingRay local_ray;
+    compute_assembly_instance_ray(
+        assembly_instance,
+        point_instancer,
+        point_instance_index,
+        assembly_instance_transform,
+        m_parent_shading_point,
+        ray,
+        local_ray);
+    const RayInfo3d local_ray_info(local_ray);
 
 #ifdef APPLESEED_WITH_EMBREE
 
-        if (m_tree.use_embree())
-        {
-            const EmbreeScene& embree_scene =
-                *m_embree_scene_cache.access(
-                    item.m_assembly_uid,
-                    m_tree.m_embree_scenes);
+    if (m_tree.use_embree())
+    {
+        const EmbreeScene& embree_scene =
+            *m_embree_scene_cache.access(
+                assembly_uid,
+                m_tree.m_embree_scenes);
 
-            if (embree_scene.occlude(local_ray))
-            {
-                m_hit = true;
-                return false;
-            }
-        }
-        else
+        if (embree_scene.occlude(local_ray))
+            return true;
+    }
+    else
 
 #endif
+    {
+        // Retrieve the triangle tree of this assembly, or its proxy version.
+        const TriangleTree* triangle_tree = nullptr;
+        if (m_tree.uses_proxy_geometry(ray))
         {
-            // Retrieve the triangle tree of this assembly.
-            const TriangleTree* triangle_tree =
+            triangle_tree =
                 m_triangle_tree_cache.access(
-                    item.m_assembly_uid,
+                    AssemblyTree::get_proxy_triangle_tree_key(assembly_uid),
                     m_tree.m_triangle_trees);
+        }
+        if (triangle_tree == nullptr)
+        {
+            triangle_tree =
+                m_triangle_tree_cache.access(
+                    assembly_uid,
+                    m_tree.m_triangle_trees);
+        }
 
-            if (triangle_tree)
+        if (triangle_tree)
+        {
+            // Check the intersection between the ray and the triangle tree.
+            TriangleLeafProbeVisitor visitor(*triangle_tree, local_ray.m_time.m_normalized, local_ray.m_flags);
+            if (const TriangleTree::WideTreeType* wide_tree = triangle_tree->get_wide_tree())
+            {
+                TriangleTreeWideProbeIntersector intersector;
+                intersector.intersect_no_motion(
+                    *wide_tree,
+                    local_ray,
+                    local_ray_info,
+                    visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                    , m_triangle_tree_stats
+#endif
+                    );
+            }
+            else if (triangle_tree->get_moving_triangle_count() > 0)
             {
-                // Check the intersection between the ray and the triangle tree.
                 TriangleTreeProbeIntersector intersector;
-                TriangleLeafProbeVisitor visitor(*triangle_tree, local_ray.m_time.m_normalized, local_ray.m_flags);
-                if (triangle_tree->get_moving_triangle_count() > 0)
-                {
-                    intersector.intersect_motion(
-                        *triangle_tree,
-                        local_ray,
-                        local_ray_info,
-                        local_ray.m_time.m_normalized,
-                        visitor
+                intersector.intersect_motion(
+                    *triangle_tree,
+                    local_ray,
+                    local_ray_info,
+                    local_ray.m_time.m_normalized,
+                    visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-                        , m_triangle_tree_stats
+                    , m_triangle_tree_stats
 #endif
-                        );
-                }
-                else
-                {
-                    intersector.intersect_no_motion(
-                        *triangle_tree,
-                        local_ray,
-                        local_ray_info,
-                        visitor
+                    );
+            }
+            else
+            {
+                TriangleTreeProbeIntersector intersector;
+                intersector.intersect_no_motion(
+                    *triangle_tree,
+                    local_ray,
+                    local_ray_info,
+                    visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-                        , m_triangle_tree_stats
+                    , m_triangle_tree_stats
 #endif
-                        );
-                }
+                    );
+            }
 
-                // Terminate traversal if there was a hit.
-                if (visitor.hit())
+            // Terminate traversal if there was a hit.
+            if (visitor.hit())
+            {
+                // Record the occluder.
+                if (m_occluder && point_instancer == nullptr)
                 {
-                    m_hit = true;
-                    return false;
+                    m_occluder->m_assembly_instance = &assembly_instance;
+                    m_occluder->m_transform_sequence = assembly_instance_transform_seq;
+                    m_occluder->m_triangle_tree = triangle_tree;
+                    m_occluder->m_leaf = visitor.get_last_leaf();
                 }
+
+                return true;
             }
         }
+    }
+
+    // Retrieve the curve tree of this assembly.
+    const CurveTree* curve_tree =
+        m_curve_tree_cache.access(
+            assembly_uid,
+            m_tree.m_curve_trees);
 
-        // Retrieve the curve tree of this assembly.
-        const CurveTree* curve_tree =
-            m_curve_tree_cache.access(
-                item.m_assembly_uid,
-                m_tree.m_curve_trees);
-
-        if (curve_tree)
-        {
-            // Check intersection between ray and curve tree.
-            const GRay3 ray(local_ray);
-            const GRayInfo3 ray_info(local_ray_info);
-            CurveMatrixType xfm_matrix;
-            make_curve_projection_transform(xfm_matrix, ray);
-            CurveLeafProbeVisitor visitor(*curve_tree, xfm_matrix);
-            CurveTreeProbeIntersector intersector;
-            intersector.intersect_no_motion(
-                *curve_tree,
-                ray,
-                ray_info,
-                visitor
+    if (curve_tree)
+    {
+        // Check intersection between ray and curve tree.
+        const GRay3 ray(local_ray);
+        const GRayInfo3 ray_info(local_ray_info);
+        CurveMatrixType xfm_matrix;
+        make_curve_projection_transform(xfm_matrix, ray);
+        CurveLeafProbeVisitor visitor(*curve_tree, xfm_matrix);
+        CurveTreeProbeIntersector intersector;
+        intersector.intersect_no_motion(
+            *curve_tree,
+            ray,
+            ray_info,
+            visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-                , m_curve_tree_stats
+            , m_curve_tree_stats
 #endif
-                );
+            );
 
-            // Terminate traversal if there was a hit.
-            if (visitor.hit())
-            {
-                m_hit = true;
-                return false;
-            }
-        }
+        // Terminate traversal if there was a hit.
+        if (visitor.hit())
+            return true;
+    }
+
+    // Check the intersection between the ray and procedural objects.
+    if (assembly.has_render_data())
+    {
+        const IndexedObjectInstanceArray& procedural_object_instances =
+            assembly.get_render_data().m_procedural_object_instances;
 
-        // Check the intersection between the ray and procedural objects.
-        if (item.m_assembly->has_render_data())
+        for (size_t j = 0, e = procedural_object_instances.size(); j < e; ++j)
         {
-            const IndexedObjectInstanceArray& procedural_object_instances =
-                item.m_assembly->get_render_data().m_procedural_object_instances;
+            // Retrieve the object and object instance.
+            const IndexedObjectInstance& object_instance_index_pair = procedural_object_instances[j];
+            const ObjectInstance* object_instance = object_instance_index_pair.first;
 
-            for (size_t j = 0, e = procedural_object_instances.size(); j < e; ++j)
-            {
-                // Retrieve the object and object instance.
-                const IndexedObjectInstance& object_instance_index_pair = procedural_object_instances[j];
-                const ObjectInstance* object_instance = object_instance_index_pair.first;
-
-                // Skip this object instance if it isn't visible for this ray.
-                if (!(object_instance->get_vis_flags() & ray.m_flags))
-                    continue;
-
-                // Transform the ray to object instance space.
-                // todo: transform ray differentials.
-                const Transformd& object_instance_transform = object_instance->get_transform();
-                ShadingRay instance_local_ray;
-                instance_local_ray.m_org = object_instance_transform.point_to_local(local_ray.m_org);
-                instance_local_ray.m_dir = object_instance_transform.vector_to_local(local_ray.m_dir);
-                instance_local_ray.m_has_differentials = false;
-                instance_local_ray.m_tmin = local_ray.m_tmin;
-                instance_local_ray.m_tmax = local_ray.m_tmax;
-                instance_local_ray.m_time = local_ray.m_time;
-                instance_local_ray.m_flags = local_ray.m_flags;
-                instance_local_ray.m_depth = local_ray.m_depth;
-                instance_local_ray.m_medium_count = local_ray.m_medium_count;
-
-                // Ask the procedural object to intersect itself against the ray.
-                const ProceduralObject& object = static_cast<const ProceduralObject&>(object_instance->get_object());
-                if (object.intersect(instance_local_ray))
-                {
-                    m_hit = true;
-                    return false;
-                }
-            }
+            // Skip this object instance if it isn't visible for this ray.
+            if (!(object_instance->get_vis_flags() & ray.m_flags))
+                continue;
+
+            // Transform the ray to object instance space.
+            // todo: transform ray differentials.
+            const Transformd& object_instance_transform = object_instance->get_transform();
+            ShadingRay instance_local_ray;
+            instance_local_ray.m_org = object_instance_transform.point_to_local(local_ray.m_org);
+            instance_local_ray.m_dir = object_instance_transform.vector_to_local(local_ray.m_dir);
+            instance_local_ray.m_has_differentials = false;
+            instance_local_ray.m_tmin = local_ray.m_tmin;
+            instance_local_ray.m_tmax = local_ray.m_tmax;
+            instance_local_ray.m_time = local_ray.m_time;
+            instance_local_ray.m_flags = local_ray.m_flags;
+            instance_local_ray.m_depth = local_ray.m_depth;
+            instance_local_ray.m_medium_count = local_ray.m_medium_count;
+
+            // Ask the procedural object to intersect itself against the ray.
+            const ProceduralObject& object = static_cast<const ProceduralObject&>(object_instance->get_object());
+            if (object.intersect(instance_local_ray))
+                return true;
         }
     }
 
+    return false;
+}
+
+struct AssemblyLeafProbeVisitor::PointInstanceVisitor
+{
+    AssemblyLeafProbeVisitor&           m_visitor;
+    const AssemblyTree::Item&           m_item;
+    const Transformd&                   m_point_instancer_transform;
+    const ShadingRay&                   m_ray;
+    bool                                m_hit;
+
+    bool visit_instance(
+        const size_t                    instance_index,
+        double&                         distance)
+    {
+        const PointInstancer& point_instancer = *m_item.m_point_instancer;
+        const AssemblyInstance& prototype_instance =
+            point_instancer.get_prototype_instance(
+                point_instancer.get_instance_prototype(instance_index));
+
+        // Place the prototype in the space of the point instancer, then in world space.
+        const Transformd instance_transform =
+            point_instancer.get_instance_transform(instance_index) * m_point_instancer_transform;
+
+        m_hit =
+            m_visitor.visit_assembly(
+                prototype_instance.get_assembly(),
+                prototype_instance,
+                instance_transform,
+                &m_item.m_transform_sequence,
+                &point_instancer,
+                instance_index,
+                m_ray);
+
+        // Terminate traversal if there was a hit.
+        distance = m_ray.m_tmax;
+        return !m_hit;
+    }
+};
+
+bool AssemblyLeafProbeVisitor::visit_point_instancer(
+    const AssemblyTree::Item&           item,
+    const ShadingRay&                   ray)
+{
+    // Evaluate the transformation of the point instancer.
+    Transformd scratch;
+    const Transformd& point_instancer_transform =
+        item.m_transform_sequence.evaluate(ray.m_time.m_absolute, scratch);
+
+    // Transform the ray to point instancer space.
+    ShadingRay local_ray;
+    compute_point_instancer_ray(point_instancer_transform, ray, local_ray);
+    const RayInfo3d local_ray_info(local_ray);
+
+    // Intersect the instances whose bounding box is hit by the ray.
+    PointInstanceVisitor instance_visitor = { *this, item, point_instancer_transform, ray, false };
+    PointInstancerLeafVisitor<PointInstanceVisitor> visitor(*item.m_point_instancer_tree, instance_visitor);
+    PointInstancerTreeIntersector<PointInstanceVisitor>::Type intersector;
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    bvh::TraversalStatistics point_instancer_tree_stats;
+#endif
+    intersector.intersect_no_motion(
+        *item.m_point_instancer_tree,
+        local_ray,
+        local_ray_info,
+        visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , point_instancer_tree_stats
+#endif
+        );
+
+    return instance_visitor.m_hit;
+}
+
+//
+// AssemblyLeafPacketVisitor class implementation.
+//
+
+bool AssemblyLeafPacketVisitor::visit(
+    const AssemblyTree::NodeType&       node,
+    const AssemblyTreeRayPacket&        packet,
+    uint32&                             ray_mask,
+    double                              distances[]
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , bvh::TraversalStatistics&         stats
+#endif
+    )
+{
+    for (size_t i = 0; i < packet.m_size; ++i)
+    {
+        if (!(ray_mask & (uint32(1) << i)))
+            continue;
+
+        ShadingPoint& shading_point = m_shading_points[i];
+
+        AssemblyLeafVisitor visitor(
+            shading_point,
+            m_tree,
+            m_triangle_tree_cache,
+            m_curve_tree_cache,
+#ifdef APPLESEED_WITH_EMBREE
+            m_embree_scene_cache,
+#endif
+            m_parent_shading_points ? m_parent_shading_points[i] : nullptr
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_triangle_tree_stats
+            , m_curve_tree_stats
+#endif
+            );
+
+        visitor.visit(
+            node,
+            shading_point.m_ray,
+            m_ray_infos[i],
+            distances[i]
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , stats
+#endif
+            );
+    }
+
     // Continue traversal.
-    distance = ray.m_tmax;
     return true;
 }
 
+bool AssemblyLeafProbeVisitor::visit_occluder(
+    const ProbeOccluder&                occluder,
+    const ShadingRay&                   ray)
+{
+    assert(occluder.m_leaf);
+
+    const AssemblyInstance& assembly_instance = *occluder.m_assembly_instance;
+
+    // Skip the occluder if its assembly instance isn't visible for this ray.
+    if (!(assembly_instance.get_vis_flags() & ray.m_flags))
+        return false;
+
+    // Evaluate the transformation of the assembly instance.
+    Transformd scratch;
+    const Transformd& assembly_instance_transform =
+        occluder.m_transform_sequence->evaluate(ray.m_time.m_absolute, scratch);
+
+    // Transform the ray to assembly instance space.
+    ShadingRay local_ray;
+    compute_assembly_instance_ray(
+        assembly_instance,
+        nullptr,
+        0,
+        assembly_instance_transform,
+        m_parent_shading_point,
+        ray,
+        local_ray);
+    const RayInfo3d local_ray_info(local_ray);
+
+    // Check the intersection between the ray and the leaf of the triangle tree.
+    TriangleLeafProbeVisitor visitor(
+        *occluder.m_triangle_tree,
+        local_ray.m_time.m_normalized,
+        local_ray.m_flags);
+    double distance;
+    visitor.visit(
+        *occluder.m_leaf,
+        local_ray,
+        local_ray_info,
+        distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , m_triangle_tree_stats
+#endif
+        );
+
+    m_hit = visitor.hit();
+    return m_hit;
+}
+
+
+//
+// AssemblyLeafProbePacketVisitor class implementation.
+//
+
+bool AssemblyLeafProbePacketVisitor::visit(
+    const AssemblyTree::NodeType&       node,
+    const AssemblyTreeRayPacket&        packet,
+    uint32&                             ray_mask,
+    double                              distances[]
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , bvh::TraversalStatistics&         stats
+#endif
+    )
+{
+    for (size_t i = 0; i < packet.m_size; ++i)
+    {
+        const uint32 bit = uint32(1) << i;
+
+        if (!(ray_mask & bit))
+            continue;
+
+        AssemblyLeafProbeVisitor visitor(
+            m_tree,
+            m_triangle_tree_cache,
+            m_curve_tree_cache,
+#ifdef APPLESEED_WITH_EMBREE
+            m_embree_scene_cache,
+#endif
+            m_parent_shading_points ? m_parent_shading_points[i] : nullptr,
+            nullptr
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_triangle_tree_stats
+            , m_curve_tree_stats
+#endif
+            );
+
+        visitor.visit(
+            node,
+            m_rays[i],
+            m_ray_infos[i],
+            distances[i]
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , stats
+#endif
+            );
+
+        // Retire rays that found an occluder.
+        if (visitor.hit())
+        {
+            m_hits[i] = true;
+            ray_mask &= ~bit;
+        }
+    }
+
+    // Terminate traversal once all rays of the packet are occluded.
+    return ray_mask != 0;
+}
+
 }   // namespace renderer
@@ -34,30 +34,40 @@
 #ifdef APPLESEED_WITH_EMBREE
 #include "renderer/kernel/intersection/embreescene.h"
 #endif
+#ifdef APPLESEED_WITH_GPU
+#include "renderer/kernel/intersection/gpuscene.h"
+#endif
+#include "renderer/kernel/intersection/pointinstancertree.h"
 #include "renderer/kernel/intersection/probevisitorbase.h"
+#include "renderer/kernel/intersection/treememorybudget.h"
 #include "renderer/kernel/intersection/treerepository.h"
 #include "renderer/kernel/intersection/triangletree.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/visibilityflags.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/bvh.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/alignedvector.h"
+#include "foundation/utility/statistics.h"
 #include "foundation/utility/uid.h"
 #include "foundation/utility/version.h"
 
 // Standard headers.
 #include <cstddef>
 #include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 // Forward declarations.
-namespace foundation    { class Statistics; }
 namespace renderer      { class AssemblyInstance; }
+namespace renderer      { class PointInstancer; }
 namespace renderer      { class Scene; }
 namespace renderer      { class ShadingPoint; }
 
@@ -76,35 +86,74 @@ class AssemblyTree
            >
 {
   public:
+    typedef foundation::bvh::WideTree<NodeType> WideTreeType;
+
     // Constructor, builds the tree for a given scene.
     explicit AssemblyTree(const Scene& scene);
 
     // Destructor.
     ~AssemblyTree();
 
-    // Update the assembly tree and all the child trees.
+    // Update the assembly tree and all the child trees. The assembly tree is
+    // refitted rather than rebuilt when only assembly instance transforms or
+    // assembly contents changed.
     void update();
 
+    // Return the wide version of the tree, or nullptr if it was not built.
+    const WideTreeType* get_wide_tree() const;
+
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
+    // Return the statistics of the assembly tree and of its triangle and curve trees,
+    // collected when they were last built. Lazy child trees are built by this call.
+    foundation::StatisticsVector get_tree_statistics() const;
+
+    // Return true if a given ray is intersected against the proxy geometry of object
+    // instances rather than against their full geometry. Only triangle trees have
+    // proxy versions.
+    bool uses_proxy_geometry(const ShadingRay& ray) const;
+
 #ifdef APPLESEED_WITH_EMBREE
 
     bool use_embree() const;
     void set_use_embree(const bool value);
 
+    // When Embree is used, also let Embree handle assembly instances so that
+    // rays are traced entirely by Embree instead of this tree.
+    bool use_embree_instancing() const;
+    void set_use_embree_instancing(const bool value);
+
+    // Settings of the Embree scenes built from now on.
+    const EmbreeSceneSettings& get_embree_scene_settings() const;
+    void set_embree_scene_settings(const EmbreeSceneSettings& settings);
+
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+
+    // Trace batches of rays on the GPU when the scene allows it.
+    bool use_gpu() const;
+    void set_use_gpu(const bool value);
+
 #endif
 
   private:
     friend class AssemblyLeafVisitor;
     friend class AssemblyLeafProbeVisitor;
+    friend class AssemblyLeafPacketVisitor;
+    friend class AssemblyLeafProbePacketVisitor;
     friend class Intersector;
 
+    // An item is either an assembly instance, or a point instancer together with the
+    // assembly instance that contains it (nullptr for point instancers of the scene).
     struct Item
     {
         const renderer::Assembly*               m_assembly;
         foundation::UniqueID                    m_assembly_uid;
         const renderer::AssemblyInstance*       m_assembly_instance;
+        const renderer::PointInstancer*         m_point_instancer;
+        const PointInstancerTree*               m_point_instancer_tree;
         renderer::TransformSequence             m_transform_sequence;
 
         Item() {}
@@ -116,6 +165,21 @@ class AssemblyTree
           : m_assembly(assembly)
           , m_assembly_uid(assembly->get_uid())
           , m_assembly_instance(assembly_instance)
+          , m_point_instancer(nullptr)
+          , m_point_instancer_tree(nullptr)
+          , m_transform_sequence(transform_sequence)
+        {
+        }
+
+        Item(
+            const PointInstancerTree*           point_instancer_tree,
+            const renderer::AssemblyInstance*   assembly_instance,
+            const renderer::TransformSequence&  transform_sequence)
+          : m_assembly(nullptr)
+          , m_assembly_uid(foundation::UniqueID(~0))
+          , m_assembly_instance(assembly_instance)
+          , m_point_instancer(&point_instancer_tree->get_point_instancer())
+          , m_point_instancer_tree(point_instancer_tree)
           , m_transform_sequence(transform_sequence)
         {
         }
@@ -126,15 +190,50 @@ class AssemblyTree
     typedef std::vector<const Assembly*> AssemblyVector;
     typedef std::map<foundation::UniqueID, foundation::VersionID> AssemblyVersionMap;
 
+    struct AssemblyBBox
+    {
+        foundation::VersionID                   m_version_id;
+        GAABB3                                  m_bbox;
+    };
+
+    typedef std::map<foundation::UniqueID, AssemblyBBox> AssemblyBBoxMap;
+    typedef std::map<foundation::UniqueID, GVector3> CurveLODCameraMap;
+    typedef std::map<foundation::UniqueID, std::unique_ptr<PointInstancerTree>> PointInstancerTreeMap;
+
     const Scene&                    m_scene;
     ItemVector                      m_items;
     AssemblyVersionMap              m_assembly_versions;
+    WideTreeType                    m_wide_tree;
+    foundation::StatisticsVector    m_statistics;
+
+    // State used to refit the assembly tree instead of rebuilding it.
+    foundation::uint64              m_topology_hash;        // hash of the instance hierarchy the tree was built for
+    std::vector<size_t>             m_item_ordering;        // tree order of the assembly instances, in collection order
+    AABBVector                      m_item_bboxes;          // bounding boxes of the assembly instances, in tree order
+    double                          m_build_cost;           // SAH cost of the tree when it was built
+    AssemblyBBoxMap                 m_assembly_bboxes;      // local bounding boxes of the assemblies
+    PointInstancerTreeMap           m_point_instancer_trees;
+
+    // Lazy construction of child trees; the budget must outlive the tree repositories.
+    bool                            m_lazy_child_trees;     // only build child trees when rays reach them
+    TreeMemoryBudget                m_child_tree_budget;
+    std::string                     m_paging_directory;     // temporary directory released triangle trees are reloaded from
 
     TreeRepository<TriangleTree>    m_triangle_tree_repository;
-    TriangleTreeContainer           m_triangle_trees;
+    TriangleTreeContainer           m_triangle_trees;       // also holds proxy trees, see get_proxy_triangle_tree_key()
+
+    // Selection of the rays that are intersected against proxy geometry.
+    bool                            m_has_proxy_trees;
+    VisibilityFlags::Type           m_proxy_ray_types;
+    ShadingRay::DepthType           m_proxy_ray_min_depth;
+    float                           m_proxy_ray_min_roughness;
+
+    // Return the key of the proxy triangle tree of an assembly in m_triangle_trees.
+    static foundation::UniqueID get_proxy_triangle_tree_key(const foundation::UniqueID assembly_uid);
 
     TreeRepository<CurveTree>       m_curve_tree_repository;
     CurveTreeContainer              m_curve_trees;
+    CurveLODCameraMap               m_curve_lod_cameras;    // camera positions the curve trees were built for
 
 #ifdef APPLESEED_WITH_EMBREE
 
@@ -142,15 +241,44 @@ class AssemblyTree
     EmbreeSceneContainer            m_embree_scenes;
     bool                            m_use_embree;
     bool                            m_dirty; // is used to determine triangle tree / embree switch
+    bool                            m_use_embree_instancing;
+    EmbreeSceneSettings             m_embree_scene_settings;
+    std::unique_ptr<EmbreeInstanceScene> m_embree_instance_scene;
+
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+
+    bool                            m_use_gpu;
+    std::unique_ptr<GPUScene>       m_gpu_scene;
 
 #endif
 
     void collect_assembly_instances(
         const AssemblyInstanceContainer&        assembly_instances,
         const TransformSequence&                parent_transform_seq,
-        AABBVector&                             assembly_instance_bboxes);
+        const AssemblyBBoxMap&                  previous_assembly_bboxes,
+        PointInstancerTreeMap&                  previous_point_instancer_trees,
+        AABBVector&                             assembly_instance_bboxes,
+        foundation::uint64&                     topology_hash);
+
+    void collect_point_instancers(
+        const PointInstancerContainer&          point_instancers,
+        const AssemblyInstance*                 assembly_instance,
+        const TransformSequence&                parent_transform_seq,
+        PointInstancerTreeMap&                  previous_point_instancer_trees,
+        AABBVector&                             item_bboxes,
+        foundation::uint64&                     topology_hash);
 
-    void rebuild_assembly_tree();
+    bool has_point_instancers() const;
+
+    void create_paging_directory();
+    void delete_paging_directory();
+
+    void update_assembly_tree();
+    void rebuild_assembly_tree(const AABBVector& assembly_instance_bboxes);
+    bool refit_assembly_tree(const AABBVector& assembly_instance_bboxes);
+    double compute_sah_cost() const;
     void store_items_in_leaves(foundation::Statistics& statistics);
 
     void update_tree_hierarchy();
@@ -161,13 +289,32 @@ class AssemblyTree
     void create_triangle_tree(const Assembly& assembly);
     void create_curve_tree(const Assembly& assembly);
 
+    // Compute the position, in the space of a given assembly, of the camera that drives
+    // the level of detail of its curves. Return false if its curves have no level of detail.
+    bool compute_curve_lod_camera_position(
+        const Assembly&                         assembly,
+        GVector3&                               position) const;
+
+    // Return true if the level of detail of the curves of an assembly needs updating.
+    bool is_curve_lod_outdated(const Assembly& assembly) const;
+
 #ifdef APPLESEED_WITH_EMBREE
 
     void create_embree_scene(const Assembly& assembly);
     void delete_embree_scene(const foundation::UniqueID assembly_id);
 
+    void update_embree_instance_scene();
+
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+
+    void update_gpu_scene();
+
 #endif
 
+    void build_child_trees(const AssemblyVector& assemblies);
+
     void delete_child_trees(const foundation::UniqueID assembly_id);
     void delete_triangle_tree(const foundation::UniqueID assembly_id);
     void delete_curve_tree(const foundation::UniqueID assembly_id);
@@ -211,7 +358,15 @@ class AssemblyLeafVisitor
 #endif
         );
 
+    // Intersect only the assembly instance that a given shading point lies on,
+    // placed with the assembly instance transform recorded in that shading point.
+    void visit_assembly_instance(
+        const ShadingPoint&                         owner,
+        const ShadingRay&                           ray);
+
   private:
+    struct PointInstanceVisitor;
+
     ShadingPoint&                                   m_shading_point;
     const AssemblyTree&                             m_tree;
     TriangleTreeAccessCache&                        m_triangle_tree_cache;
@@ -220,10 +375,26 @@ class AssemblyLeafVisitor
     EmbreeSceneAccessCache&                         m_embree_scene_cache;
 #endif
     const ShadingPoint*                             m_parent_shading_point;
+    const bool                                      m_use_proxy_trees;
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
     foundation::bvh::TraversalStatistics&           m_curve_tree_stats;
 #endif
+
+    // Intersect an assembly (or a prototype of a point instancer) placed with a given transform.
+    void visit_assembly(
+        const Assembly&                             assembly,
+        const AssemblyInstance&                     assembly_instance,
+        const foundation::Transformd&               assembly_instance_transform,
+        const TransformSequence*                    assembly_instance_transform_seq,
+        const PointInstancer*                       point_instancer,
+        const size_t                                point_instance_index,
+        const ShadingRay&                           ray);
+
+    // Intersect the instances of a point instancer.
+    void visit_point_instancer(
+        const AssemblyTree::Item&                   item,
+        const ShadingRay&                           ray);
 };
 
 
@@ -244,7 +415,8 @@ class AssemblyLeafProbeVisitor
 #ifdef APPLESEED_WITH_EMBREE
         EmbreeSceneAccessCache&                     embree_scene_cache,
 #endif
-        const ShadingPoint*                         parent_shading_point
+        const ShadingPoint*                         parent_shading_point,
+        ProbeOccluder*                              occluder
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , foundation::bvh::TraversalStatistics&     triangle_tree_stats
         , foundation::bvh::TraversalStatistics&     curve_tree_stats
@@ -262,7 +434,14 @@ class AssemblyLeafProbeVisitor
 #endif
         );
 
+    // Intersect a ray with the occluder found by a previous probe ray.
+    bool visit_occluder(
+        const ProbeOccluder&                        occluder,
+        const ShadingRay&                           ray);
+
   private:
+    struct PointInstanceVisitor;
+
     const AssemblyTree&                             m_tree;
     TriangleTreeAccessCache&                        m_triangle_tree_cache;
     CurveTreeAccessCache&                           m_curve_tree_cache;
@@ -270,6 +449,137 @@ class AssemblyLeafProbeVisitor
     EmbreeSceneAccessCache&                         m_embree_scene_cache;
 #endif
     const ShadingPoint*                             m_parent_shading_point;
+    ProbeOccluder*                                  m_occluder;
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
+    foundation::bvh::TraversalStatistics&           m_curve_tree_stats;
+#endif
+
+    // Return true if an assembly (or a prototype of a point instancer) placed with
+    // a given transform occludes the ray. The occluder is only recorded for regular
+    // assembly instances.
+    bool visit_assembly(
+        const Assembly&                             assembly,
+        const AssemblyInstance&                     assembly_instance,
+        const foundation::Transformd&               assembly_instance_transform,
+        const TransformSequence*                    assembly_instance_transform_seq,
+        const PointInstancer*                       point_instancer,
+        const size_t                                point_instance_index,
+        const ShadingRay&                           ray);
+
+    // Return true if one of the instances of a point instancer occludes the ray.
+    bool visit_point_instancer(
+        const AssemblyTree::Item&                   item,
+        const ShadingRay&                           ray);
+};
+
+
+//
+// Assembly leaf visitors for packets of rays.
+//
+// The rays of a packet share the traversal of the assembly tree; the assembly
+// instances reached by a packet are then intersected ray by ray using the
+// regular (single ray) leaf visitors.
+//
+
+typedef foundation::bvh::RayPacket<
+    double,
+    3,
+    foundation::bvh::DefaultRayPacketSize
+> AssemblyTreeRayPacket;
+
+class AssemblyLeafPacketVisitor
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    AssemblyLeafPacketVisitor(
+        ShadingPoint*                               shading_points,
+        const ShadingRay::RayInfoType*              ray_infos,
+        const ShadingPoint* const*                  parent_shading_points,
+        const AssemblyTree&                         tree,
+        TriangleTreeAccessCache&                    triangle_tree_cache,
+        CurveTreeAccessCache&                       curve_tree_cache
+#ifdef APPLESEED_WITH_EMBREE
+        , EmbreeSceneAccessCache&                   embree_scene_cache
+#endif
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     triangle_tree_stats
+        , foundation::bvh::TraversalStatistics&     curve_tree_stats
+#endif
+        );
+
+    // Visit a leaf.
+    bool visit(
+        const AssemblyTree::NodeType&               node,
+        const AssemblyTreeRayPacket&                packet,
+        foundation::uint32&                         ray_mask,
+        double                                      distances[]
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     stats
+#endif
+        );
+
+  private:
+    ShadingPoint*                                   m_shading_points;
+    const ShadingRay::RayInfoType*                  m_ray_infos;
+    const ShadingPoint* const*                      m_parent_shading_points;
+    const AssemblyTree&                             m_tree;
+    TriangleTreeAccessCache&                        m_triangle_tree_cache;
+    CurveTreeAccessCache&                           m_curve_tree_cache;
+#ifdef APPLESEED_WITH_EMBREE
+    EmbreeSceneAccessCache&                         m_embree_scene_cache;
+#endif
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
+    foundation::bvh::TraversalStatistics&           m_curve_tree_stats;
+#endif
+};
+
+class AssemblyLeafProbePacketVisitor
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. 'hits' must be initialized to false by the caller.
+    AssemblyLeafProbePacketVisitor(
+        const ShadingRay*                           rays,
+        const ShadingRay::RayInfoType*              ray_infos,
+        const ShadingPoint* const*                  parent_shading_points,
+        bool*                                       hits,
+        const AssemblyTree&                         tree,
+        TriangleTreeAccessCache&                    triangle_tree_cache,
+        CurveTreeAccessCache&                       curve_tree_cache
+#ifdef APPLESEED_WITH_EMBREE
+        , EmbreeSceneAccessCache&                   embree_scene_cache
+#endif
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     triangle_tree_stats
+        , foundation::bvh::TraversalStatistics&     curve_tree_stats
+#endif
+        );
+
+    // Visit a leaf.
+    bool visit(
+        const AssemblyTree::NodeType&               node,
+        const AssemblyTreeRayPacket&                packet,
+        foundation::uint32&                         ray_mask,
+        double                                      distances[]
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     stats
+#endif
+        );
+
+  private:
+    const ShadingRay*                               m_rays;
+    const ShadingRay::RayInfoType*                  m_ray_infos;
+    const ShadingPoint* const*                      m_parent_shading_points;
+    bool*                                           m_hits;
+    const AssemblyTree&                             m_tree;
+    TriangleTreeAccessCache&                        m_triangle_tree_cache;
+    CurveTreeAccessCache&                           m_curve_tree_cache;
+#ifdef APPLESEED_WITH_EMBREE
+    EmbreeSceneAccessCache&                         m_embree_scene_cache;
+#endif
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     foundation::bvh::TraversalStatistics&           m_triangle_tree_stats;
     foundation::bvh::TraversalStatistics&           m_curve_tree_stats;
@@ -293,6 +603,62 @@ typedef foundation::bvh::Intersector<
     ShadingRay
 > AssemblyTreeProbeIntersector;
 
+typedef foundation::bvh::WideIntersector<
+    AssemblyTree::WideTreeType,
+    AssemblyLeafVisitor,
+    ShadingRay
+> AssemblyTreeWideIntersector;
+
+typedef foundation::bvh::WideIntersector<
+    AssemblyTree::WideTreeType,
+    AssemblyLeafProbeVisitor,
+    ShadingRay
+> AssemblyTreeWideProbeIntersector;
+
+typedef foundation::bvh::PacketIntersector<
+    AssemblyTree,
+    AssemblyLeafPacketVisitor,
+    AssemblyTreeRayPacket::MaxSize
+> AssemblyTreePacketIntersector;
+
+typedef foundation::bvh::PacketIntersector<
+    AssemblyTree,
+    AssemblyLeafProbePacketVisitor,
+    AssemblyTreeRayPacket::MaxSize
+> AssemblyTreeProbePacketIntersector;
+
+
+//
+// AssemblyTree class implementation.
+//
+
+inline const AssemblyTree::WideTreeType* AssemblyTree::get_wide_tree() const
+{
+    return m_wide_tree.empty() ? nullptr : &m_wide_tree;
+}
+
+inline bool AssemblyTree::uses_proxy_geometry(const ShadingRay& ray) const
+{
+    if (!m_has_proxy_trees)
+        return false;
+
+    if (ray.m_flags & VisibilityFlags::ProxyRay)
+        return true;
+
+    if (!(ray.m_flags & m_proxy_ray_types))
+        return false;
+
+    return
+        ray.m_depth >= m_proxy_ray_min_depth ||
+        (m_proxy_ray_min_roughness > 0.0f && ray.m_min_roughness >= m_proxy_ray_min_roughness);
+}
+
+inline foundation::UniqueID AssemblyTree::get_proxy_triangle_tree_key(const foundation::UniqueID assembly_uid)
+{
+    // Complementing the uid keeps proxy keys apart from assembly uids, including in access caches.
+    return ~assembly_uid;
+}
+
 
 //
 // AssemblyLeafVisitor class implementation.
@@ -320,6 +686,7 @@ inline AssemblyLeafVisitor::AssemblyLeafVisitor(
   , m_embree_scene_cache(embree_scene_cache)
 #endif
   , m_parent_shading_point(parent_shading_point)
+  , m_use_proxy_trees(tree.uses_proxy_geometry(shading_point.m_ray))
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
   , m_triangle_tree_stats(triangle_tree_stats)
   , m_curve_tree_stats(curve_tree_stats)
@@ -339,7 +706,8 @@ inline AssemblyLeafProbeVisitor::AssemblyLeafProbeVisitor(
 #ifdef APPLESEED_WITH_EMBREE
     EmbreeSceneAccessCache&                         embree_scene_cache,
 #endif
-    const ShadingPoint*                             parent_shading_point
+    const ShadingPoint*                             parent_shading_point,
+    ProbeOccluder*                                  occluder
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     , foundation::bvh::TraversalStatistics&         triangle_tree_stats
     , foundation::bvh::TraversalStatistics&         curve_tree_stats
@@ -352,6 +720,81 @@ inline AssemblyLeafProbeVisitor::AssemblyLeafProbeVisitor(
   , m_embree_scene_cache(embree_scene_cache)
 #endif
   , m_parent_shading_point(parent_shading_point)
+  , m_occluder(occluder)
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+  , m_triangle_tree_stats(triangle_tree_stats)
+  , m_curve_tree_stats(curve_tree_stats)
+#endif
+{
+}
+
+
+//
+// AssemblyLeafPacketVisitor class implementation.
+//
+
+inline AssemblyLeafPacketVisitor::AssemblyLeafPacketVisitor(
+    ShadingPoint*                                   shading_points,
+    const ShadingRay::RayInfoType*                  ray_infos,
+    const ShadingPoint* const*                      parent_shading_points,
+    const AssemblyTree&                             tree,
+    TriangleTreeAccessCache&                        triangle_tree_cache,
+    CurveTreeAccessCache&                           curve_tree_cache
+#ifdef APPLESEED_WITH_EMBREE
+    , EmbreeSceneAccessCache&                       embree_scene_cache
+#endif
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , foundation::bvh::TraversalStatistics&         triangle_tree_stats
+    , foundation::bvh::TraversalStatistics&         curve_tree_stats
+#endif
+    )
+  : m_shading_points(shading_points)
+  , m_ray_infos(ray_infos)
+  , m_parent_shading_points(parent_shading_points)
+  , m_tree(tree)
+  , m_triangle_tree_cache(triangle_tree_cache)
+  , m_curve_tree_cache(curve_tree_cache)
+#ifdef APPLESEED_WITH_EMBREE
+  , m_embree_scene_cache(embree_scene_cache)
+#endif
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+  , m_triangle_tree_stats(triangle_tree_stats)
+  , m_curve_tree_stats(curve_tree_stats)
+#endif
+{
+}
+
+
+//
+// AssemblyLeafProbePacketVisitor class implementation.
+//
+
+inline AssemblyLeafProbePacketVisitor::AssemblyLeafProbePacketVisitor(
+    const ShadingRay*                               rays,
+    const ShadingRay::RayInfoType*                  ray_infos,
+    const ShadingPoint* const*                      parent_shading_points,
+    bool*                                           hits,
+    const AssemblyTree&                             tree,
+    TriangleTreeAccessCache&                        triangle_tree_cache,
+    CurveTreeAccessCache&                           curve_tree_cache
+#ifdef APPLESEED_WITH_EMBREE
+    , EmbreeSceneAccessCache&                       embree_scene_cache
+#endif
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , foundation::bvh::TraversalStatistics&         triangle_tree_stats
+    , foundation::bvh::TraversalStatistics&         curve_tree_stats
+#endif
+    )
+  : m_rays(rays)
+  , m_ray_infos(ray_infos)
+  , m_parent_shading_points(parent_shading_points)
+  , m_hits(hits)
+  , m_tree(tree)
+  , m_triangle_tree_cache(triangle_tree_cache)
+  , m_curve_tree_cache(curve_tree_cache)
+#ifdef APPLESEED_WITH_EMBREE
+  , m_embree_scene_cache(embree_scene_cache)
+#endif
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
   , m_triangle_tree_stats(triangle_tree_stats)
   , m_curve_tree_stats(curve_tree_stats)
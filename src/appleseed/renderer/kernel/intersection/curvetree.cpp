@@ -42,11 +42,13 @@
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/exceptionnotimplemented.h"
 #include "foundation/math/beziercurve.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/permutation.h"
 #include "foundation/math/transform.h"
 #include "foundation/platform/defaulttimers.h"
 #include "foundation/platform/system.h"
 #include "foundation/utility/alignedallocator.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/memory.h"
@@ -54,8 +56,13 @@
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstring>
 #include <string>
 
@@ -65,6 +72,125 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    GAABB3 compute_curve_bbox(const Curve3Type& curve)
+    {
+        GAABB3 bbox = curve.compute_bbox();
+        bbox.grow(GVector3(GScalar(0.5) * curve.compute_max_width()));
+        return bbox;
+    }
+
+    // Recursively halve a curve for as long as it makes its bounding boxes significantly tighter.
+    void split_curve(
+        const Curve3Type&       curve,
+        const GScalar           v0,
+        const GScalar           v1,
+        const size_t            depth,
+        vector<Curve3Type>&     segments,
+        vector<GVector2>&       ranges,
+        vector<GAABB3>&         bboxes)
+    {
+        const GAABB3 bbox = compute_curve_bbox(curve);
+
+        if (depth > 0)
+        {
+            Curve3Type c1, c2;
+            curve.split(c1, c2);
+
+            const GAABB3 bbox1 = compute_curve_bbox(c1);
+            const GAABB3 bbox2 = compute_curve_bbox(c2);
+
+            if (half_surface_area(bbox1) + half_surface_area(bbox2) <=
+                    CurveTreeDefaultSplitThreshold * half_surface_area(bbox))
+            {
+                const GScalar vm = GScalar(0.5) * (v0 + v1);
+                split_curve(c1, v0, vm, depth - 1, segments, ranges, bboxes);
+                split_curve(c2, vm, v1, depth - 1, segments, ranges, bboxes);
+                return;
+            }
+        }
+
+        segments.push_back(curve);
+        ranges.push_back(GVector2(v0, v1));
+        bboxes.push_back(bbox);
+    }
+
+    //
+    // Camera-distance level of detail of the curves of an object instance.
+    //
+    // Beyond a given distance from the camera, strands are randomly dropped so that the
+    // density of strands decreases with the inverse of the distance, i.e. like their
+    // projected width. The widths of the remaining strands are scaled up by the inverse
+    // of the density to preserve the coverage of the groom on screen.
+    //
+
+    class CurveLOD
+    {
+      public:
+        CurveLOD(
+            const CurveTree::Arguments& arguments,
+            const ObjectInstance&       object_instance)
+          : m_enabled(false)
+          , m_seed(static_cast<uint32>(object_instance.get_uid()))
+        {
+            if (!arguments.m_has_lod_camera)
+                return;
+
+            const ParamArray& params = object_instance.get_parameters();
+            m_distance = params.get_optional<GScalar>("curve_lod_distance", GScalar(0.0));
+            m_min_density =
+                clamp(
+                    params.get_optional<GScalar>("curve_lod_min_density", GScalar(0.1)),
+                    GScalar(0.001),
+                    GScalar(1.0));
+            m_camera_position = arguments.m_lod_camera_position;
+            m_enabled = m_distance > GScalar(0.0);
+        }
+
+        // Return the fraction of strands kept around a given point.
+        template <typename CurveType>
+        GScalar compute_density(const CurveType& curve) const
+        {
+            if (!m_enabled)
+                return GScalar(1.0);
+
+            const GVector3 center =
+                GScalar(0.5) * (curve.get_control_point(0) + curve.get_control_point(CurveType::Degree));
+            const GScalar distance = norm(center - m_camera_position);
+
+            return distance > m_distance ? max(m_distance / distance, m_min_density) : GScalar(1.0);
+        }
+
+        // Decide whether a strand is kept. The decision only depends on the strand and
+        // this instance so that it is stable from one render to the next.
+        bool keep(const size_t curve_index, const GScalar density) const
+        {
+            if (density >= GScalar(1.0))
+                return true;
+
+            const uint32 h = hash_uint32(mix_uint32(m_seed, static_cast<uint32>(curve_index)));
+            return static_cast<GScalar>(h) * GScalar(1.0 / 4294967296.0) < density;
+        }
+
+        // Return the maximum split depth of a degree-3 curve given its strand density.
+        // Curves that shrink on screen benefit less from tight bounding boxes.
+        static size_t compute_split_depth(const GScalar density)
+        {
+            const size_t reduction = static_cast<size_t>(log2(GScalar(1.0) / density));
+            return reduction < CurveTreeDefaultMaxSplitDepth ? CurveTreeDefaultMaxSplitDepth - reduction : 0;
+        }
+
+      private:
+        bool        m_enabled;
+        uint32      m_seed;
+        GScalar     m_distance;
+        GScalar     m_min_density;
+        GVector3    m_camera_position;
+    };
+}
+
+
 //
 // CurveTree class implementation.
 //
@@ -73,11 +199,14 @@ CurveTree::Arguments::Arguments(
     const Scene&            scene,
     const UniqueID          curve_tree_uid,
     const GAABB3&           bbox,
-    const Assembly&         assembly)
+    const Assembly&         assembly,
+    const GVector3*         lod_camera_position)
   : m_scene(scene)
   , m_curve_tree_uid(curve_tree_uid)
   , m_bbox(bbox)
   , m_assembly(assembly)
+  , m_has_lod_camera(lod_camera_position != nullptr)
+  , m_lod_camera_position(lod_camera_position ? *lod_camera_position : GVector3(0.0))
 {
 }
 
@@ -85,6 +214,9 @@ CurveTree::CurveTree(const Arguments& arguments)
   : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
   , m_arguments(arguments)
 {
+    TraceScope trace_scope("scene", "build curve tree");
+    MemoryTagScope memory_tag_scope(MemoryTagBVH);
+
     // Retrieve construction parameters.
     const MessageContext message_context(
         format("while building curve tree for assembly \"{0}\"", m_arguments.m_assembly.get_path()));
@@ -104,16 +236,36 @@ CurveTree::CurveTree(const Arguments& arguments)
     statistics.insert_time("total build time", stopwatch.measure().get_seconds());
     statistics.insert_size("nodes alignment", alignment(&m_nodes[0]));
 
-    // Print curve tree statistics.
-    RENDERER_LOG_DEBUG("%s",
+    // Keep and print curve tree statistics.
+    m_statistics =
         StatisticsVector::make(
-            "curve tree #" + to_string(m_arguments.m_curve_tree_uid) + " statistics",
-            statistics).to_string().c_str());
+            "curve tree #" + to_string(m_arguments.m_curve_tree_uid) +
+            " (assembly \"" + m_arguments.m_assembly.get_path().c_str() + "\") statistics",
+            statistics);
+    RENDERER_LOG_DEBUG("%s", m_statistics.to_string().c_str());
+}
+
+const StatisticsVector& CurveTree::get_statistics() const
+{
+    return m_statistics;
+}
+
+size_t CurveTree::get_memory_size() const
+{
+    return
+          TreeType::get_memory_size()
+        - sizeof(*static_cast<const TreeType*>(this))
+        + sizeof(*this)
+        + m_curves1.capacity() * sizeof(Curve1Type)
+        + m_curves3.capacity() * sizeof(Curve3Type)
+        + m_curves3_ranges.capacity() * sizeof(GVector2)
+        + m_curve_keys.capacity() * sizeof(CurveKey);
 }
 
-void CurveTree::collect_curves(vector<GAABB3>& curve_bboxes)
+size_t CurveTree::collect_curves(vector<GAABB3>& curve_bboxes)
 {
     const ObjectInstanceContainer& object_instances = m_arguments.m_assembly.object_instances();
+    size_t dropped_curve_count = 0;
 
     for (size_t i = 0; i < object_instances.size(); ++i)
     {
@@ -134,11 +286,23 @@ void CurveTree::collect_curves(vector<GAABB3>& curve_bboxes)
         const Transformd::MatrixType& transform =
             object_instance->get_transform().get_local_to_parent();
 
+        // Retrieve the level of detail settings of this object instance.
+        const CurveLOD lod(m_arguments, *object_instance);
+
         // Store degree-1 curves, curve keys and curve bounding boxes.
         const size_t curve1_count = curve_object.get_curve1_count();
         for (size_t j = 0; j < curve1_count; ++j)
         {
-            const Curve1Type curve(curve_object.get_curve1(j), transform);
+            Curve1Type curve(curve_object.get_curve1(j), transform);
+
+            const GScalar density = lod.compute_density(curve);
+            if (!lod.keep(j, density))
+            {
+                ++dropped_curve_count;
+                continue;
+            }
+            curve.scale_widths(GScalar(1.0) / density);
+
             const CurveKey curve_key(
                 i,                  // object instance index
                 j,                  // curve index in object
@@ -155,25 +319,45 @@ void CurveTree::collect_curves(vector<GAABB3>& curve_bboxes)
         }
 
         // Store degree-3 curves, curve keys and curve bounding boxes.
+        // Curves with loose bounding boxes are split into segments stored as separate curves.
         const size_t curve3_count = curve_object.get_curve3_count();
         for (size_t j = 0; j < curve3_count; ++j)
         {
-            const Curve3Type curve(curve_object.get_curve3(j), transform);
-            const CurveKey curve_key(
-                i,                  // object instance index
-                j,                  // curve index in object
-                m_curves3.size(),   // curve index in tree
-                0,                  // for now we assume all the curves have the same material
-                3);                 // curve degree
-
-            GAABB3 curve_bbox = curve.compute_bbox();
-            curve_bbox.grow(GVector3(GScalar(0.5) * curve.compute_max_width()));
-
-            m_curves3.push_back(curve);
-            m_curve_keys.push_back(curve_key);
-            curve_bboxes.push_back(curve_bbox);
+            Curve3Type curve(curve_object.get_curve3(j), transform);
+
+            const GScalar density = lod.compute_density(curve);
+            if (!lod.keep(curve1_count + j, density))
+            {
+                ++dropped_curve_count;
+                continue;
+            }
+            curve.scale_widths(GScalar(1.0) / density);
+
+            const size_t first_segment = m_curves3.size();
+            split_curve(
+                curve,
+                GScalar(0.0),
+                GScalar(1.0),
+                CurveLOD::compute_split_depth(density),
+                m_curves3,
+                m_curves3_ranges,
+                curve_bboxes);
+
+            for (size_t k = first_segment, e = m_curves3.size(); k < e; ++k)
+            {
+                const CurveKey curve_key(
+                    i,                  // object instance index
+                    j,                  // curve index in object
+                    k,                  // curve index in tree
+                    0,                  // for now we assume all the curves have the same material
+                    3);                 // curve degree
+
+                m_curve_keys.push_back(curve_key);
+            }
         }
     }
+
+    return dropped_curve_count;
 }
 
 void CurveTree::build_bvh(
@@ -186,8 +370,11 @@ void CurveTree::build_bvh(
         "collecting geometry for curve tree #" FMT_UNIQUE_ID " from assembly \"%s\"...",
         m_arguments.m_curve_tree_uid,
         m_arguments.m_assembly.get_path().c_str());
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
     vector<GAABB3> curve_bboxes;
-    collect_curves(curve_bboxes);
+    const size_t dropped_curve_count = collect_curves(curve_bboxes);
+    const double collection_time = stopwatch.measure().get_seconds();
 
     // Print statistics about the input geometry.
     RENDERER_LOG_INFO(
@@ -212,10 +399,15 @@ void CurveTree::build_bvh(
         partitioner,
         m_curves1.size() + m_curves3.size(),
         CurveTreeDefaultMaxLeafSize);
+    statistics.insert_time("collection time", collection_time);
+    statistics.insert_time("partition time", builder.get_build_time());
+    statistics.insert("degree-3 curve segments", m_curves3.size());
+    statistics.insert("curves dropped by lod", dropped_curve_count);
     statistics.merge(
         bvh::TreeStatistics<CurveTree>(*this, m_arguments.m_bbox));
 
     // Reorder the curve keys based on the nodes ordering.
+    stopwatch.start();
     if (!m_curves1.empty() || !m_curves3.empty())
     {
         const vector<size_t>& ordering = partitioner.get_item_ordering();
@@ -223,6 +415,7 @@ void CurveTree::build_bvh(
         reorder_curves(ordering);
         reorder_curve_keys_in_leaf_nodes();
     }
+    statistics.insert_time("store time", stopwatch.measure().get_seconds());
 }
 
 void CurveTree::reorder_curve_keys(const vector<size_t>& ordering)
@@ -235,6 +428,7 @@ void CurveTree::reorder_curves(const vector<size_t>& ordering)
 {
     vector<Curve1Type> new_curves1(m_curves1.size());
     vector<Curve3Type> new_curves3(m_curves3.size());
+    vector<GVector2> new_curves3_ranges(m_curves3_ranges.size());
 
     size_t curve1_index = 0;
     size_t curve3_index = 0;
@@ -253,6 +447,7 @@ void CurveTree::reorder_curves(const vector<size_t>& ordering)
         {
             assert(key.get_curve_degree() == 3);
             new_curves3[curve3_index] = m_curves3[key.get_curve_index_tree()];
+            new_curves3_ranges[curve3_index] = m_curves3_ranges[key.get_curve_index_tree()];
             m_curve_keys[i].set_curve_index_tree(curve3_index);
             ++curve3_index;
         }
@@ -263,6 +458,7 @@ void CurveTree::reorder_curves(const vector<size_t>& ordering)
 
     m_curves1.swap(new_curves1);
     m_curves3.swap(new_curves3);
+    m_curves3_ranges.swap(new_curves3_ranges);
 }
 
 void CurveTree::reorder_curve_keys_in_leaf_nodes()
@@ -33,16 +33,19 @@
 #include "renderer/kernel/intersection/curvekey.h"
 #include "renderer/kernel/intersection/intersectionsettings.h"
 #include "renderer/kernel/intersection/probevisitorbase.h"
+#include "renderer/kernel/rendering/renderingcounters.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/bvh.h"
+#include "foundation/math/scalar.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/alignedvector.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/poolallocator.h"
+#include "foundation/utility/statistics.h"
 #include "foundation/utility/uid.h"
 
 // Standard headers.
@@ -52,7 +55,6 @@
 #include <vector>
 
 // Forward declarations.
-namespace foundation    { class Statistics; }
 namespace renderer      { class Assembly; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class Scene; }
@@ -79,18 +81,28 @@ class CurveTree
         const foundation::UniqueID              m_curve_tree_uid;
         const GAABB3                            m_bbox;
         const Assembly&                         m_assembly;
+        const bool                              m_has_lod_camera;
+        const GVector3                          m_lod_camera_position;  // in assembly space
 
-        // Constructor.
+        // Constructor. The camera position drives the level of detail of curve object
+        // instances that enable it; pass nullptr to keep all curves.
         Arguments(
             const Scene&                        scene,
             const foundation::UniqueID          curve_tree_uid,
             const GAABB3&                       bbox,
-            const Assembly&                     assembly);
+            const Assembly&                     assembly,
+            const GVector3*                     lod_camera_position);
     };
 
     // Constructor, builds the tree for a given assembly.
     explicit CurveTree(const Arguments& arguments);
 
+    // Return the statistics collected when the tree was built.
+    const foundation::StatisticsVector& get_statistics() const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
   private:
     friend class CurveLeafVisitor;
     friend class CurveLeafProbeVisitor;
@@ -106,9 +118,12 @@ class CurveTree
     const Arguments         m_arguments;
     std::vector<Curve1Type> m_curves1;
     std::vector<Curve3Type> m_curves3;
+    std::vector<GVector2>   m_curves3_ranges;       // range of the original curve's parameter covered by each degree-3 curve
     std::vector<CurveKey>   m_curve_keys;
+    foundation::StatisticsVector m_statistics;
 
-    void collect_curves(std::vector<GAABB3>& curve_bboxes);
+    // Collect the curves of the assembly and return the number of curves dropped by level of detail.
+    size_t collect_curves(std::vector<GAABB3>& curve_bboxes);
 
     void build_bvh(
         const ParamArray&                       params,
@@ -273,6 +288,8 @@ inline bool CurveLeafVisitor::visit(
 #endif
     )
 {
+    ++RenderingCounters::current().m_traversal_step_count;
+
     const CurveTree::LeafUserData& user_data = node.get_user_data<CurveTree::LeafUserData>();
 
     size_t curve_index = node.get_item_index();
@@ -299,6 +316,10 @@ inline bool CurveLeafVisitor::visit(
         const Curve3Type& curve = m_tree.m_curves3[user_data.m_curve3_offset + i];
         if (Curve3IntersectorType::intersect(curve, ray, m_xfm_matrix, u, v, t))
         {
+            // Curves may be segments of the original curve: remap v to the original curve.
+            const GVector2& range = m_tree.m_curves3_ranges[user_data.m_curve3_offset + i];
+            v = foundation::lerp(range[0], range[1], v);
+
             m_shading_point.m_primitive_type = ShadingPoint::PrimitiveCurve3;
             m_shading_point.m_ray.m_tmax = static_cast<double>(t);
             m_shading_point.m_bary[0] = static_cast<float>(u);
@@ -344,6 +365,8 @@ inline bool CurveLeafProbeVisitor::visit(
 #endif
     )
 {
+    ++RenderingCounters::current().m_traversal_step_count;
+
     const CurveTree::LeafUserData& user_data = node.get_user_data<CurveTree::LeafUserData>();
 
     for (foundation::uint32 i = 0; i < user_data.m_curve1_count; ++i)
@@ -38,7 +38,9 @@
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/object/triangle.h"
 #include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/containers.h"
+#include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/area.h"
@@ -68,6 +70,9 @@ class EmbreeGeometryData
     unsigned int            m_vertices_count;
     unsigned int            m_vertices_stride;
 
+    // Curve control points data (x, y, z, radius).
+    float*                  m_curve_vertices;
+
     // Primitive data.
     uint32*                 m_primitives;
     size_t                  m_primitives_count;
@@ -83,13 +88,16 @@ class EmbreeGeometryData
 
     EmbreeGeometryData()
       : m_vertices(nullptr)
+      , m_curve_vertices(nullptr)
       , m_primitives(nullptr)
+      , m_motion_steps_count(1)
       , m_geometry_handle(nullptr)
     {}
 
     ~EmbreeGeometryData()
     {
         delete[] m_vertices;
+        delete[] m_curve_vertices;
         delete[] m_primitives;
         rtcReleaseGeometry(m_geometry_handle);
     }
@@ -144,7 +152,7 @@ namespace
         //
         // Retrieve per primitive data.
         //
-        const size_t primitives_count = tess.m_primitives.size();
+        const size_t primitives_count = tess.get_primitive_count();
 
         geometry_data.m_primitives = new uint32[primitives_count * 3];
         geometry_data.m_primitives_stride = sizeof(uint32) * 3;
@@ -152,33 +160,115 @@ namespace
 
         for (size_t i = 0; i < primitives_count; ++i)
         {
-            geometry_data.m_primitives[i * 3] = tess.m_primitives[i].m_v0;
-            geometry_data.m_primitives[i * 3 + 1] = tess.m_primitives[i].m_v1;
-            geometry_data.m_primitives[i * 3 + 2] = tess.m_primitives[i].m_v2;
+            const Triangle triangle = tess.get_primitive(i);
+            geometry_data.m_primitives[i * 3] = triangle.m_v0;
+            geometry_data.m_primitives[i * 3 + 1] = triangle.m_v1;
+            geometry_data.m_primitives[i * 3 + 2] = triangle.m_v2;
         }
     };
 
+    template <typename CurveType>
+    void collect_curve_control_points(
+        const CurveType&        curve,
+        float*                  vertices)
+    {
+        for (size_t i = 0; i < CurveType::Degree + 1; ++i)
+        {
+            const GVector3& point = curve.get_control_point(i);
+            vertices[i * 4 + 0] = static_cast<float>(point.x);
+            vertices[i * 4 + 1] = static_cast<float>(point.y);
+            vertices[i * 4 + 2] = static_cast<float>(point.z);
+
+            // Curve widths are diameters.
+            vertices[i * 4 + 3] = 0.5f * static_cast<float>(curve.get_width(i));
+        }
+    }
+
     void collect_curve_data(
         const ObjectInstance&   object_instance,
         EmbreeGeometryData&     geometry_data)
     {
-        //const Transformd& transform = object_instance.get_transform();
+        // Retrieve object space -> assembly space transform for the object instance.
+        const Transformd::MatrixType& transform = object_instance.get_transform().get_local_to_parent();
+
+        // Retrieve the object.
+        const CurveObject& curves = static_cast<const CurveObject&>(object_instance.get_object());
 
-        switch(geometry_data.m_geometry_type)
+        // Curve objects don't have motion, Embree's default of one time step is fine.
+        geometry_data.m_motion_steps_count = 1;
+
+        size_t primitives_count;
+        size_t vertices_per_curve;
+
+        switch (geometry_data.m_geometry_type)
         {
-        case RTC_GEOMETRY_TYPE_FLAT_BEZIER_CURVE:
-            //
-            // [Note: Girish] Retrieve data from CurveObject here and push it to geometry_data.
-            //
+          case RTC_GEOMETRY_TYPE_FLAT_LINEAR_CURVE:
+            primitives_count = curves.get_curve1_count();
+            vertices_per_curve = 2;
+            break;
 
+          case RTC_GEOMETRY_TYPE_FLAT_BEZIER_CURVE:
+            primitives_count = curves.get_curve3_count();
+            vertices_per_curve = 4;
             break;
 
-        default:
+          default:
             assert(!"Unsupported geometry type.");
-            break;
+            return;
+        }
+
+        //
+        // Retrieve per vertex data. Control points are not shared between curves.
+        //
+        const unsigned int vertices_count = static_cast<unsigned int>(primitives_count * vertices_per_curve);
+        geometry_data.m_vertices_count = vertices_count;
+        geometry_data.m_vertices_stride = sizeof(float) * 4;
+        geometry_data.m_curve_vertices = new float[vertices_count * 4];
+
+        //
+        // Retrieve per primitive data: the index of the first control point of each curve.
+        //
+        geometry_data.m_primitives = new uint32[primitives_count];
+        geometry_data.m_primitives_stride = sizeof(uint32);
+        geometry_data.m_primitives_count = primitives_count;
+
+        for (size_t i = 0; i < primitives_count; ++i)
+        {
+            const size_t first_vertex = i * vertices_per_curve;
+            geometry_data.m_primitives[i] = static_cast<uint32>(first_vertex);
+
+            float* vertices = geometry_data.m_curve_vertices + first_vertex * 4;
+
+            // Transform curves to assembly space like the curve tree does.
+            if (geometry_data.m_geometry_type == RTC_GEOMETRY_TYPE_FLAT_LINEAR_CURVE)
+                collect_curve_control_points(Curve1Type(curves.get_curve1(i), transform), vertices);
+            else collect_curve_control_points(Curve3Type(curves.get_curve3(i), transform), vertices);
+        }
+    }
+
+    RTCBuildQuality get_build_quality(const EmbreeSceneSettings& settings)
+    {
+        switch (settings.m_build_quality)
+        {
+          case EmbreeSceneSettings::BuildQualityLow: return RTC_BUILD_QUALITY_LOW;
+          case EmbreeSceneSettings::BuildQualityMedium: return RTC_BUILD_QUALITY_MEDIUM;
+          default: return RTC_BUILD_QUALITY_HIGH;
         }
     }
 
+    RTCSceneFlags get_scene_flags(const EmbreeSceneSettings& settings)
+    {
+        int flags = RTC_SCENE_FLAG_NONE;
+
+        if (settings.m_compact)
+            flags |= RTC_SCENE_FLAG_COMPACT;
+
+        if (settings.m_robust)
+            flags |= RTC_SCENE_FLAG_ROBUST;
+
+        return static_cast<RTCSceneFlags>(flags);
+    }
+
     // Returns minimal tnear needed to compensate double to float transition of ray fields.
     float get_tnear_offset(const RTCRay& ray)
     {
@@ -238,6 +328,9 @@ EmbreeDevice::EmbreeDevice()
 {
     // todo: set number of threads.
     m_device = rtcNewDevice(nullptr);
+
+    m_supports_curves =
+        rtcGetDeviceProperty(m_device, RTC_DEVICE_PROPERTY_CURVE_GEOMETRY_SUPPORTED) != 0;
 };
 
 EmbreeDevice::~EmbreeDevice()
@@ -245,6 +338,11 @@ EmbreeDevice::~EmbreeDevice()
     rtcReleaseDevice(m_device);
 }
 
+bool EmbreeDevice::supports_curves() const
+{
+    return m_supports_curves;
+}
+
 
 //
 //  EmbreeScene class implementation.
@@ -261,9 +359,10 @@ EmbreeScene::EmbreeScene(const EmbreeScene::Arguments& arguments)
     m_device = arguments.m_device.m_device;
     m_scene = rtcNewScene(m_device);
 
-    rtcSetSceneBuildQuality(
-        m_scene,
-        RTCBuildQuality::RTC_BUILD_QUALITY_HIGH);
+    const RTCBuildQuality build_quality = get_build_quality(arguments.m_settings);
+
+    rtcSetSceneBuildQuality(m_scene, build_quality);
+    rtcSetSceneFlags(m_scene, get_scene_flags(arguments.m_settings));
 
     const ObjectInstanceContainer& instance_container = arguments.m_assembly.object_instances();
 
@@ -276,13 +375,6 @@ EmbreeScene::EmbreeScene(const EmbreeScene::Arguments& arguments)
         const ObjectInstance* object_instance = instance_container.get_by_index(instance_idx);
         assert(object_instance);
 
-        RTCGeometry geometry_handle;
-
-        // Set per instance data.
-        unique_ptr<EmbreeGeometryData> geometry_data(new EmbreeGeometryData());
-        geometry_data->m_object_instance_idx = instance_idx;
-        geometry_data->m_vis_flags = object_instance->get_vis_flags();
-
         //
         // Collect geometry data for the instance.
         //
@@ -290,18 +382,20 @@ EmbreeScene::EmbreeScene(const EmbreeScene::Arguments& arguments)
 
         if (strcmp(object_model, MeshObjectFactory().get_model()) == 0)
         {
+            unique_ptr<EmbreeGeometryData> geometry_data(
+                new EmbreeGeometryData());
+            geometry_data->m_object_instance_idx = instance_idx;
+            geometry_data->m_vis_flags = object_instance->get_vis_flags();
             geometry_data->m_geometry_type = RTC_GEOMETRY_TYPE_TRIANGLE;
 
             // Retrieve triangle data.
             collect_triangle_data(*object_instance, *geometry_data);
 
-            geometry_handle = rtcNewGeometry(
+            RTCGeometry geometry_handle = rtcNewGeometry(
                 m_device,
                 RTC_GEOMETRY_TYPE_TRIANGLE);
 
-            rtcSetGeometryBuildQuality(
-                geometry_handle,
-                RTCBuildQuality::RTC_BUILD_QUALITY_HIGH);
+            rtcSetGeometryBuildQuality(geometry_handle, build_quality);
 
             rtcSetGeometryTimeStepCount(
                 geometry_handle,
@@ -345,53 +439,88 @@ EmbreeScene::EmbreeScene(const EmbreeScene::Arguments& arguments)
                 geometry_data->m_vis_flags);
 
             rtcCommitGeometry(geometry_handle);
+
+            attach_geometry(move(geometry_data));
         }
         else if (strcmp(object_model, CurveObjectFactory().get_model()) == 0)
         {
-            geometry_data->m_geometry_type = RTC_GEOMETRY_TYPE_FLAT_BEZIER_CURVE;
+            // Without curve support in Embree, curve objects are left to curve trees.
+            if (!arguments.m_device.supports_curves())
+                continue;
 
-            // Retrieve curve data.
-            collect_curve_data(*object_instance, *geometry_data);
+            const CurveObject& curves = static_cast<const CurveObject&>(object_instance->get_object());
 
-            geometry_handle = rtcNewGeometry(
-                m_device,
-                RTC_GEOMETRY_TYPE_FLAT_BEZIER_CURVE);
+            // Degree-1 and degree-3 curves of an object go to separate geometries.
+            // Flat curves are ribbons facing the ray, like the curves of curve trees.
+            const RTCGeometryType GeometryTypes[] =
+            {
+                RTC_GEOMETRY_TYPE_FLAT_LINEAR_CURVE,
+                RTC_GEOMETRY_TYPE_FLAT_BEZIER_CURVE
+            };
+            const size_t CurveCounts[] =
+            {
+                curves.get_curve1_count(),
+                curves.get_curve3_count()
+            };
 
-            rtcSetGeometryBuildQuality(
-                geometry_handle,
-                RTCBuildQuality::RTC_BUILD_QUALITY_HIGH);
+            for (size_t i = 0; i < 2; ++i)
+            {
+                if (CurveCounts[i] == 0)
+                    continue;
 
-            // Set vertices. (x_pos, y_pos, z_pos, radii)
-            rtcSetSharedGeometryBuffer(
-                geometry_handle,                                // geometry
-                RTC_BUFFER_TYPE_INDEX,                          // buffer type
-                0,                                              // slot
-                RTC_FORMAT_FLOAT4,                              // format
-                geometry_data->m_vertices,                      // buffer
-                0,                                              // byte offset
-                geometry_data->m_vertices_stride,               // byte stride
-                geometry_data->m_vertices_count);               // item count
+                unique_ptr<EmbreeGeometryData> geometry_data(
+                    new EmbreeGeometryData());
+                geometry_data->m_object_instance_idx = instance_idx;
+                geometry_data->m_vis_flags = object_instance->get_vis_flags();
+                geometry_data->m_geometry_type = GeometryTypes[i];
 
-            // Set vertex indices.
-            rtcSetSharedGeometryBuffer(
-                geometry_handle,                                // geometry
-                RTC_BUFFER_TYPE_INDEX,                          // buffer type
-                0,                                              // slot
-                RTC_FORMAT_UINT4,                               // format
-                geometry_data->m_primitives,                    // buffer
-                0,                                              // byte offset
-                geometry_data->m_primitives_stride,             // byte stride
-                geometry_data->m_primitives_count);             // item count
+                // Retrieve curve data.
+                collect_curve_data(*object_instance, *geometry_data);
+
+                RTCGeometry geometry_handle = rtcNewGeometry(
+                    m_device,
+                    geometry_data->m_geometry_type);
+
+                rtcSetGeometryBuildQuality(geometry_handle, build_quality);
+
+                geometry_data->m_geometry_handle = geometry_handle;
+
+                // Set vertices. (x_pos, y_pos, z_pos, radii)
+                rtcSetSharedGeometryBuffer(
+                    geometry_handle,                            // geometry
+                    RTC_BUFFER_TYPE_VERTEX,                     // buffer type
+                    0,                                          // slot
+                    RTC_FORMAT_FLOAT4,                          // format
+                    geometry_data->m_curve_vertices,            // buffer
+                    0,                                          // byte offset
+                    geometry_data->m_vertices_stride,           // byte stride
+                    geometry_data->m_vertices_count);           // item count
+
+                // Set indices of the first control point of each curve.
+                rtcSetSharedGeometryBuffer(
+                    geometry_handle,                            // geometry
+                    RTC_BUFFER_TYPE_INDEX,                      // buffer type
+                    0,                                          // slot
+                    RTC_FORMAT_UINT,                            // format
+                    geometry_data->m_primitives,                // buffer
+                    0,                                          // byte offset
+                    geometry_data->m_primitives_stride,         // byte stride
+                    geometry_data->m_primitives_count);         // item count
+
+                rtcSetGeometryMask(
+                    geometry_handle,
+                    geometry_data->m_vis_flags);
 
+                rtcCommitGeometry(geometry_handle);
+
+                attach_geometry(move(geometry_data));
+            }
         }
         else
         {
             // Unsupported object type.
             continue;
         }
-
-        rtcAttachGeometryByID(m_scene, geometry_handle, static_cast<unsigned int>(instance_idx));
-        m_geometry_container.push_back(std::move(geometry_data));
     }
 
     rtcCommitScene(m_scene);
@@ -409,6 +538,17 @@ EmbreeScene::~EmbreeScene()
     rtcReleaseScene(m_scene);
 }
 
+void EmbreeScene::attach_geometry(unique_ptr<EmbreeGeometryData> geometry_data)
+{
+    // Geometry IDs index the geometry container.
+    rtcAttachGeometryByID(
+        m_scene,
+        geometry_data->m_geometry_handle,
+        static_cast<unsigned int>(m_geometry_container.size()));
+
+    m_geometry_container.push_back(move(geometry_data));
+}
+
 void EmbreeScene::intersect(ShadingPoint& shading_point) const
 {
     RTCIntersectContext context;
@@ -422,65 +562,84 @@ void EmbreeScene::intersect(ShadingPoint& shading_point) const
     rtcIntersect1(m_scene, &context, &rayhit);
 
     if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID)
-    {
-        assert(rayhit.hit.geomID < m_geometry_container.size());
+        read_hit(rayhit, shading_point);
+}
 
-        const auto& geometry_data = m_geometry_container[rayhit.hit.geomID];
-        assert(geometry_data);
+void EmbreeScene::read_hit(
+    const RTCRayHit&        rayhit,
+    ShadingPoint&           shading_point) const
+{
+    assert(rayhit.hit.geomID < m_geometry_container.size());
 
-        shading_point.m_bary[0] = rayhit.hit.u;
-        shading_point.m_bary[1] = rayhit.hit.v;
+    const auto& geometry_data = m_geometry_container[rayhit.hit.geomID];
+    assert(geometry_data);
 
-        shading_point.m_object_instance_index = geometry_data->m_object_instance_idx;
-        // TODO: remove regions
-        shading_point.m_primitive_index = rayhit.hit.primID;
-        shading_point.m_primitive_type = ShadingPoint::PrimitiveTriangle;
-        shading_point.m_ray.m_tmax = rayhit.ray.tfar;
+    shading_point.m_bary[0] = rayhit.hit.u;
+    shading_point.m_bary[1] = rayhit.hit.v;
 
-        const uint32 v0_idx = geometry_data->m_primitives[rayhit.hit.primID * 3];
-        const uint32 v1_idx = geometry_data->m_primitives[rayhit.hit.primID * 3 + 1];
-        const uint32 v2_idx = geometry_data->m_primitives[rayhit.hit.primID * 3 + 2];
+    shading_point.m_object_instance_index = geometry_data->m_object_instance_idx;
+    // TODO: remove regions
+    shading_point.m_primitive_index = rayhit.hit.primID;
+    shading_point.m_ray.m_tmax = rayhit.ray.tfar;
 
-        if (geometry_data->m_motion_steps_count > 1)
-        {
-            const uint32 last_motion_step_idx = geometry_data->m_motion_steps_count - 1;
+    if (geometry_data->m_geometry_type != RTC_GEOMETRY_TYPE_TRIANGLE)
+    {
+        // Curve primitives are the curves of the object, in order. Like curve trees,
+        // store the parameter along the curve in the second barycentric coordinate.
+        shading_point.m_primitive_type =
+            geometry_data->m_geometry_type == RTC_GEOMETRY_TYPE_FLAT_LINEAR_CURVE
+                ? ShadingPoint::PrimitiveCurve1
+                : ShadingPoint::PrimitiveCurve3;
+        shading_point.m_bary[0] = rayhit.hit.v;
+        shading_point.m_bary[1] = rayhit.hit.u;
+        return;
+    }
 
-            const uint32 motion_step_begin_idx = static_cast<uint32>(rayhit.ray.time * last_motion_step_idx);
-            const uint32 motion_step_end_idx = motion_step_begin_idx + 1;
+    shading_point.m_primitive_type = ShadingPoint::PrimitiveTriangle;
 
-            const uint32 motion_step_begin_offset = motion_step_begin_idx * geometry_data->m_vertices_count;
-            const uint32 motion_step_end_offset = motion_step_end_idx * geometry_data->m_vertices_count;
+    const uint32 v0_idx = geometry_data->m_primitives[rayhit.hit.primID * 3];
+    const uint32 v1_idx = geometry_data->m_primitives[rayhit.hit.primID * 3 + 1];
+    const uint32 v2_idx = geometry_data->m_primitives[rayhit.hit.primID * 3 + 2];
 
-            const float motion_step_begin_time = static_cast<float>(motion_step_begin_idx) / last_motion_step_idx;
+    if (geometry_data->m_motion_steps_count > 1)
+    {
+        const uint32 last_motion_step_idx = geometry_data->m_motion_steps_count - 1;
 
-            // Linear interpolation coefficients.
-            const float p = (rayhit.ray.time - motion_step_begin_time) * last_motion_step_idx;
-            const float q = 1.0f - p;
+        const uint32 motion_step_begin_idx = static_cast<uint32>(rayhit.ray.time * last_motion_step_idx);
+        const uint32 motion_step_end_idx = motion_step_begin_idx + 1;
 
-            assert(p > 0.0f && p <= 1.0f);
+        const uint32 motion_step_begin_offset = motion_step_begin_idx * geometry_data->m_vertices_count;
+        const uint32 motion_step_end_offset = motion_step_end_idx * geometry_data->m_vertices_count;
 
-            const TriangleType triangle(
-                Vector3d(
-                    geometry_data->m_vertices[motion_step_begin_offset + v0_idx] * q
-                    + geometry_data->m_vertices[motion_step_end_offset + v0_idx] * p),
-                Vector3d(
-                    geometry_data->m_vertices[motion_step_begin_offset + v1_idx] * q
-                    + geometry_data->m_vertices[motion_step_end_offset + v1_idx] * p),
-                Vector3d(
-                    geometry_data->m_vertices[motion_step_begin_offset + v2_idx] * q
-                    + geometry_data->m_vertices[motion_step_end_offset + v2_idx] * p));
+        const float motion_step_begin_time = static_cast<float>(motion_step_begin_idx) / last_motion_step_idx;
 
-            shading_point.m_triangle_support_plane.initialize(triangle);
-        }
-        else
-        {
-            const TriangleType triangle(
-                Vector3d(geometry_data->m_vertices[v0_idx]),
-                Vector3d(geometry_data->m_vertices[v1_idx]),
-                Vector3d(geometry_data->m_vertices[v2_idx]));
+        // Linear interpolation coefficients.
+        const float p = (rayhit.ray.time - motion_step_begin_time) * last_motion_step_idx;
+        const float q = 1.0f - p;
 
-            shading_point.m_triangle_support_plane.initialize(triangle);
-        }
+        assert(p > 0.0f && p <= 1.0f);
+
+        const TriangleType triangle(
+            Vector3d(
+                geometry_data->m_vertices[motion_step_begin_offset + v0_idx] * q
+                + geometry_data->m_vertices[motion_step_end_offset + v0_idx] * p),
+            Vector3d(
+                geometry_data->m_vertices[motion_step_begin_offset + v1_idx] * q
+                + geometry_data->m_vertices[motion_step_end_offset + v1_idx] * p),
+            Vector3d(
+                geometry_data->m_vertices[motion_step_begin_offset + v2_idx] * q
+                + geometry_data->m_vertices[motion_step_end_offset + v2_idx] * p));
+
+        shading_point.m_triangle_support_plane.initialize(triangle);
+    }
+    else
+    {
+        const TriangleType triangle(
+            Vector3d(geometry_data->m_vertices[v0_idx]),
+            Vector3d(geometry_data->m_vertices[v1_idx]),
+            Vector3d(geometry_data->m_vertices[v2_idx]));
+
+        shading_point.m_triangle_support_plane.initialize(triangle);
     }
 }
 
@@ -503,6 +662,229 @@ bool EmbreeScene::occlude(const ShadingRay& shading_ray) const
     return false;
 }
 
+
+//
+//  EmbreeInstanceScene class implementation.
+//
+
+EmbreeInstanceScene::EmbreeInstanceScene(
+    const EmbreeDevice&     device,
+    const InstanceVector&   instances,
+    const float             shutter_open,
+    const float             shutter_close,
+    const EmbreeSceneSettings& settings)
+  : m_instances(instances)
+{
+    // Start stopwatch.
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    m_scene = rtcNewScene(device.m_device);
+
+    rtcSetSceneBuildQuality(m_scene, get_build_quality(settings));
+    rtcSetSceneFlags(m_scene, get_scene_flags(settings));
+
+    for (size_t instance_idx = 0, e = m_instances.size(); instance_idx < e; ++instance_idx)
+    {
+        const Instance& instance = m_instances[instance_idx];
+        const TransformSequence& transform_sequence = *instance.m_transform_sequence;
+
+        RTCGeometry geometry_handle = rtcNewGeometry(
+            device.m_device,
+            RTC_GEOMETRY_TYPE_INSTANCE);
+
+        rtcSetGeometryInstancedScene(
+            geometry_handle,
+            instance.m_embree_scene.ref().m_scene);
+
+        // Embree expects transforms at evenly spaced times over the shutter interval,
+        // so resample the transform sequence using as many steps as it has keys.
+        const unsigned int motion_steps_count =
+            transform_sequence.size() > 1
+                ? static_cast<unsigned int>(transform_sequence.size())
+                : 1;
+
+        rtcSetGeometryTimeStepCount(
+            geometry_handle,
+            motion_steps_count);
+
+        for (unsigned int m = 0; m < motion_steps_count; ++m)
+        {
+            const float time =
+                motion_steps_count > 1
+                    ? lerp(shutter_open, shutter_close, static_cast<float>(m) / (motion_steps_count - 1))
+                    : shutter_open;
+
+            Transformd scratch;
+            const Matrix4d& local_to_parent =
+                transform_sequence.evaluate(time, scratch).get_local_to_parent();
+
+            // The first three rows of the matrix, in row-major order.
+            float xfm[12];
+            for (size_t i = 0; i < 12; ++i)
+                xfm[i] = static_cast<float>(local_to_parent[i]);
+
+            rtcSetGeometryTransform(
+                geometry_handle,
+                m,
+                RTC_FORMAT_FLOAT3X4_ROW_MAJOR,
+                xfm);
+        }
+
+        rtcSetGeometryMask(
+            geometry_handle,
+            instance.m_assembly_instance->get_vis_flags());
+
+        rtcCommitGeometry(geometry_handle);
+
+        rtcAttachGeometryByID(m_scene, geometry_handle, static_cast<unsigned int>(instance_idx));
+        rtcReleaseGeometry(geometry_handle);
+    }
+
+    rtcCommitScene(m_scene);
+
+    Statistics statistics;
+    statistics.insert("instances", m_instances.size());
+    statistics.insert_time("total build time", stopwatch.measure().get_seconds());
+
+    RENDERER_LOG_DEBUG("%s",
+        StatisticsVector::make(
+            "Embree instance scene statistics",
+            statistics).to_string().c_str());
+}
+
+EmbreeInstanceScene::~EmbreeInstanceScene()
+{
+    rtcReleaseScene(m_scene);
+}
+
+void EmbreeInstanceScene::intersect(ShadingPoint& shading_point) const
+{
+    RTCIntersectContext context;
+    rtcInitIntersectContext(&context);
+
+    RTCRayHit rayhit;
+    shading_ray_to_embree_ray(shading_point.get_ray(), rayhit.ray);
+
+    rayhit.hit.geomID = RTC_INVALID_GEOMETRY_ID;
+    rayhit.hit.instID[0] = RTC_INVALID_GEOMETRY_ID;
+
+    rtcIntersect1(m_scene, &context, &rayhit);
+
+    if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID)
+        read_hit(rayhit, shading_point);
+}
+
+bool EmbreeInstanceScene::occlude(const ShadingRay& shading_ray) const
+{
+    RTCIntersectContext context;
+    rtcInitIntersectContext(&context);
+
+    RTCRay ray;
+    shading_ray_to_embree_ray(shading_ray, ray);
+
+    rtcOccluded1(
+        m_scene,
+        &context,
+        &ray);
+
+    return ray.tfar < signed_min<float>();
+}
+
+void EmbreeInstanceScene::intersect(
+    ShadingPoint*           shading_points,
+    const size_t            count) const
+{
+    RTCIntersectContext context;
+    rtcInitIntersectContext(&context);
+    context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+    RTCRayHit rayhits[MaxStreamSize];
+
+    for (size_t i = 0; i < count; i += MaxStreamSize)
+    {
+        const size_t stream_size = min<size_t>(count - i, MaxStreamSize);
+
+        for (size_t j = 0; j < stream_size; ++j)
+        {
+            RTCRayHit& rayhit = rayhits[j];
+            shading_ray_to_embree_ray(shading_points[i + j].get_ray(), rayhit.ray);
+            rayhit.hit.geomID = RTC_INVALID_GEOMETRY_ID;
+            rayhit.hit.instID[0] = RTC_INVALID_GEOMETRY_ID;
+        }
+
+        rtcIntersect1M(
+            m_scene,
+            &context,
+            rayhits,
+            static_cast<unsigned int>(stream_size),
+            sizeof(RTCRayHit));
+
+        for (size_t j = 0; j < stream_size; ++j)
+        {
+            if (rayhits[j].hit.geomID != RTC_INVALID_GEOMETRY_ID)
+                read_hit(rayhits[j], shading_points[i + j]);
+        }
+    }
+}
+
+void EmbreeInstanceScene::occlude(
+    const ShadingRay*       shading_rays,
+    bool*                   hits,
+    const size_t            count) const
+{
+    RTCIntersectContext context;
+    rtcInitIntersectContext(&context);
+    context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+    RTCRay rays[MaxStreamSize];
+
+    for (size_t i = 0; i < count; i += MaxStreamSize)
+    {
+        const size_t stream_size = min<size_t>(count - i, MaxStreamSize);
+
+        for (size_t j = 0; j < stream_size; ++j)
+            shading_ray_to_embree_ray(shading_rays[i + j], rays[j]);
+
+        rtcOccluded1M(
+            m_scene,
+            &context,
+            rays,
+            static_cast<unsigned int>(stream_size),
+            sizeof(RTCRay));
+
+        // Occluded rays have their tfar set to -inf.
+        for (size_t j = 0; j < stream_size; ++j)
+            hits[i + j] = rays[j].tfar < signed_min<float>();
+    }
+}
+
+void EmbreeInstanceScene::read_hit(
+    const RTCRayHit&        rayhit,
+    ShadingPoint&           shading_point) const
+{
+    assert(rayhit.hit.instID[0] < m_instances.size());
+
+    const Instance& instance = m_instances[rayhit.hit.instID[0]];
+
+    // Hit data are expressed in the space of the assembly instance.
+    instance.m_embree_scene.ref().read_hit(rayhit, shading_point);
+
+    Transformd scratch;
+    shading_point.m_assembly_instance = instance.m_assembly_instance;
+    shading_point.m_assembly_instance_transform_seq = instance.m_transform_sequence;
+    shading_point.m_point_instancer = nullptr;
+    shading_point.m_point_instance_index = 0;
+    shading_point.m_assembly_instance_transform =
+        instance.m_transform_sequence->evaluate(
+            shading_point.get_ray().m_time.m_absolute,
+            scratch);
+}
+
+//
+//  EmbreeSceneFactory class implementation.
+//
+
 EmbreeSceneFactory::EmbreeSceneFactory(const EmbreeScene::Arguments& arguments)
   : m_arguments(arguments)
 {
@@ -50,8 +50,10 @@
 
 // Forward declarations.
 namespace renderer { class Assembly; }
+namespace renderer { class AssemblyInstance; }
 namespace renderer { class ShadingPoint; }
 namespace renderer { class ShadingRay; }
+namespace renderer { class TransformSequence; }
 
 namespace renderer
 {
@@ -69,10 +71,16 @@ class EmbreeDevice
     EmbreeDevice();
     ~EmbreeDevice();
 
+    // Return true if Embree was built with support for curve geometries.
+    // When it wasn't, curve objects are intersected by curve trees instead.
+    bool supports_curves() const;
+
   private:
     friend class EmbreeScene;
+    friend class EmbreeInstanceScene;
 
     RTCDevice m_device;
+    bool      m_supports_curves;
 };
 
 class EmbreeScene
@@ -81,14 +89,17 @@ class EmbreeScene
   public:
     struct Arguments
     {
-        const EmbreeDevice&     m_device;
-        const Assembly&         m_assembly;
-
-        explicit Arguments(
-            const EmbreeDevice&     embree_device,
-            const Assembly&         assembly)
+        const EmbreeDevice&         m_device;
+        const Assembly&             m_assembly;
+        const EmbreeSceneSettings   m_settings;
+
+        Arguments(
+            const EmbreeDevice&         embree_device,
+            const Assembly&             assembly,
+            const EmbreeSceneSettings&  settings)
           : m_device(embree_device)
           , m_assembly(assembly)
+          , m_settings(settings)
         {}
     };
 
@@ -100,9 +111,19 @@ class EmbreeScene
     bool occlude(const ShadingRay& shading_ray) const;
 
   private:
+    friend class EmbreeInstanceScene;
+
     RTCDevice                   m_device;
     RTCScene                    m_scene;
     EmbreeGeometryDataContainer m_geometry_container;
+
+    // Attach a committed geometry to this scene.
+    void attach_geometry(std::unique_ptr<EmbreeGeometryData> geometry_data);
+
+    // Record a triangle or curve hit of this scene into a shading point.
+    void read_hit(
+        const RTCRayHit&        rayhit,
+        ShadingPoint&           shading_point) const;
 };
 
 typedef std::map<
@@ -120,6 +141,61 @@ typedef foundation::AccessCacheMap<
 > EmbreeSceneAccessCache;
 
 
+//
+// A top-level Embree scene with one Embree instance per assembly instance.
+// Rays traced against it never leave Embree.
+//
+
+class EmbreeInstanceScene
+  : public foundation::NonCopyable
+{
+  public:
+    struct Instance
+    {
+        const AssemblyInstance*             m_assembly_instance;
+        const TransformSequence*            m_transform_sequence;
+        foundation::Access<EmbreeScene>     m_embree_scene;
+    };
+
+    typedef std::vector<Instance> InstanceVector;
+
+    // Constructor. Transform sequences are resampled at evenly spaced times
+    // between shutter_open and shutter_close, as Embree requires.
+    EmbreeInstanceScene(
+        const EmbreeDevice&     device,
+        const InstanceVector&   instances,
+        const float             shutter_open,
+        const float             shutter_close,
+        const EmbreeSceneSettings& settings);
+
+    ~EmbreeInstanceScene();
+
+    void intersect(ShadingPoint& shading_point) const;
+    bool occlude(const ShadingRay& shading_ray) const;
+
+    // Trace batches of rays using Embree's stream API.
+    // Rays are expected to be coherent, such as the camera rays of a tile.
+    void intersect(
+        ShadingPoint*           shading_points,
+        const size_t            count) const;
+    void occlude(
+        const ShadingRay*       shading_rays,
+        bool*                   hits,
+        const size_t            count) const;
+
+  private:
+    enum { MaxStreamSize = 64 };
+
+    RTCScene                    m_scene;
+    InstanceVector              m_instances;
+
+    // Record a hit of this scene into a shading point.
+    void read_hit(
+        const RTCRayHit&        rayhit,
+        ShadingPoint&           shading_point) const;
+};
+
+
 //
 // Embree scene factory.
 //
@@ -0,0 +1,467 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "gpuscene.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/tessellation/statictessellation.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstring>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Layout of RTP_BUFFER_FORMAT_RAY_ORIGIN_TMIN_DIRECTION_TMAX.
+    struct GPURay
+    {
+        float   m_org[3];
+        float   m_tmin;
+        float   m_dir[3];
+        float   m_tmax;
+    };
+
+    // Layout of RTP_BUFFER_FORMAT_HIT_T_TRIID_INSTID_U_V.
+    struct GPUHit
+    {
+        float   m_t;
+        int32   m_triangle_id;
+        int32   m_instance_id;
+        float   m_u;
+        float   m_v;
+    };
+
+    void shading_ray_to_gpu_ray(
+        const ShadingRay&       shading_ray,
+        GPURay&                 gpu_ray)
+    {
+        for (size_t i = 0; i < 3; ++i)
+        {
+            gpu_ray.m_org[i] = static_cast<float>(shading_ray.m_org[i]);
+            gpu_ray.m_dir[i] = static_cast<float>(shading_ray.m_dir[i]);
+        }
+
+        gpu_ray.m_tmin = static_cast<float>(shading_ray.m_tmin);
+        gpu_ray.m_tmax = static_cast<float>(shading_ray.m_tmax);
+    }
+
+    bool is_mesh(const Object& object)
+    {
+        return strcmp(object.get_model(), MeshObjectFactory().get_model()) == 0;
+    }
+}
+
+
+//
+// GPUScene class implementation.
+//
+
+bool GPUScene::is_supported(const InstanceVector& instances)
+{
+    // OptiX Prime's queries have no ray masks: every ray must see every object.
+    const uint32 all_rays = (1UL << VisibilityFlags::Count) - 1;
+
+    for (const_each<InstanceVector> i = instances; i; ++i)
+    {
+        if (i->m_transform_sequence->size() > 1)
+            return false;
+
+        if ((i->m_assembly_instance->get_vis_flags() & all_rays) != all_rays)
+            return false;
+
+        for (const_each<ObjectInstanceContainer> j = i->m_assembly->object_instances(); j; ++j)
+        {
+            const Object& object = j->get_object();
+
+            if (!is_mesh(object))
+                return false;
+
+            if (static_cast<const MeshObject&>(object).get_motion_segment_count() > 0)
+                return false;
+
+            if ((object.has_alpha_map() && !object.has_opaque_uniform_alpha_map()) || j->uses_alpha_mapping())
+                return false;
+
+            if ((j->get_vis_flags() & all_rays) != all_rays)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+GPUScene::GPUScene(const InstanceVector& instances)
+  : m_context(nullptr)
+  , m_model(nullptr)
+  , m_instances(instances)
+{
+    assert(is_supported(instances));
+
+    // Start stopwatch.
+    Stopwatch<DefaultWallclockTimer> stopwatch;
+    stopwatch.start();
+
+    try
+    {
+        require(rtpContextCreate(RTP_CONTEXT_TYPE_CUDA, &m_context));
+
+        // Build one model per unique assembly.
+        AssemblyModelIndexMap assembly_model_indices;
+        for (const_each<InstanceVector> i = m_instances; i; ++i)
+        {
+            const UniqueID assembly_uid = i->m_assembly->get_uid();
+            if (assembly_model_indices.find(assembly_uid) == assembly_model_indices.end())
+            {
+                assembly_model_indices[assembly_uid] = m_assembly_models.size();
+                m_assembly_models.push_back(AssemblyModel());
+            }
+        }
+
+        for (const_each<InstanceVector> i = m_instances; i; ++i)
+        {
+            AssemblyModel& assembly_model = m_assembly_models[assembly_model_indices[i->m_assembly->get_uid()]];
+            if (assembly_model.m_model == nullptr)
+                build_assembly_model(*i->m_assembly, assembly_model);
+        }
+
+        // Instantiate the assembly models.
+        const size_t instance_count = m_instances.size();
+        m_instance_models.reserve(instance_count);
+        m_instance_rtp_models.reserve(instance_count);
+        m_instance_transforms.reserve(instance_count * 12);
+
+        for (const_each<InstanceVector> i = m_instances; i; ++i)
+        {
+            const AssemblyModel& assembly_model = m_assembly_models[assembly_model_indices[i->m_assembly->get_uid()]];
+            m_instance_models.push_back(&assembly_model);
+            m_instance_rtp_models.push_back(assembly_model.m_model);
+
+            // The first three rows of the matrix, in row-major order.
+            const Matrix4d& local_to_parent = i->m_transform_sequence->get_earliest_transform().get_local_to_parent();
+            for (size_t j = 0; j < 12; ++j)
+                m_instance_transforms.push_back(static_cast<float>(local_to_parent[j]));
+        }
+
+        RTPbufferdesc instances_desc;
+        require(
+            rtpBufferDescCreate(
+                m_context,
+                RTP_BUFFER_FORMAT_INSTANCE_MODEL,
+                RTP_BUFFER_TYPE_HOST,
+                m_instance_rtp_models.data(),
+                &instances_desc));
+        require(rtpBufferDescSetRange(instances_desc, 0, instance_count));
+
+        RTPbufferdesc transforms_desc;
+        require(
+            rtpBufferDescCreate(
+                m_context,
+                RTP_BUFFER_FORMAT_TRANSFORM_FLOAT4x3,
+                RTP_BUFFER_TYPE_HOST,
+                m_instance_transforms.data(),
+                &transforms_desc));
+        require(rtpBufferDescSetRange(transforms_desc, 0, instance_count));
+
+        require(rtpModelCreate(m_context, &m_model));
+        require(rtpModelSetInstances(m_model, instances_desc, transforms_desc));
+        require(rtpModelUpdate(m_model, RTP_MODEL_HINT_NONE));
+
+        rtpBufferDescDestroy(transforms_desc);
+        rtpBufferDescDestroy(instances_desc);
+    }
+    catch (const Exception&)
+    {
+        release();
+        throw;
+    }
+
+    size_t triangle_count = 0;
+    for (const_each<vector<AssemblyModel>> i = m_assembly_models; i; ++i)
+        triangle_count += i->m_triangles.size();
+
+    Statistics statistics;
+    statistics.insert("assembly models", m_assembly_models.size());
+    statistics.insert("instances", m_instances.size());
+    statistics.insert("triangles", triangle_count);
+    statistics.insert_time("total build time", stopwatch.measure().get_seconds());
+
+    RENDERER_LOG_DEBUG("%s",
+        StatisticsVector::make(
+            "gpu scene statistics",
+            statistics).to_string().c_str());
+}
+
+GPUScene::~GPUScene()
+{
+    release();
+}
+
+void GPUScene::intersect(
+    ShadingPoint*           shading_points,
+    const size_t            count) const
+{
+    vector<GPURay> rays(count);
+    for (size_t i = 0; i < count; ++i)
+        shading_ray_to_gpu_ray(shading_points[i].get_ray(), rays[i]);
+
+    vector<GPUHit> hits(count);
+
+    if (!execute_query(
+            RTP_QUERY_TYPE_CLOSEST,
+            rays.data(),
+            RTP_BUFFER_FORMAT_HIT_T_TRIID_INSTID_U_V,
+            hits.data(),
+            count))
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const GPUHit& hit = hits[i];
+
+        if (hit.m_triangle_id < 0)
+            continue;
+
+        assert(static_cast<size_t>(hit.m_instance_id) < m_instances.size());
+
+        const Instance& instance = m_instances[hit.m_instance_id];
+        const AssemblyModel& assembly_model = *m_instance_models[hit.m_instance_id];
+        const TriangleRecord& triangle = assembly_model.m_triangles[hit.m_triangle_id];
+
+        ShadingPoint& shading_point = shading_points[i];
+
+        shading_point.m_bary[0] = hit.m_u;
+        shading_point.m_bary[1] = hit.m_v;
+        shading_point.m_object_instance_index = triangle.m_object_instance_index;
+        shading_point.m_primitive_index = triangle.m_primitive_index;
+        shading_point.m_primitive_type = ShadingPoint::PrimitiveTriangle;
+        shading_point.m_ray.m_tmax = hit.m_t;
+
+        // The support plane is expressed in assembly space.
+        const int32* indices = &assembly_model.m_indices[hit.m_triangle_id * 3];
+        const TriangleType triangle_as(
+            Vector3d(assembly_model.m_vertices[indices[0]]),
+            Vector3d(assembly_model.m_vertices[indices[1]]),
+            Vector3d(assembly_model.m_vertices[indices[2]]));
+        shading_point.m_triangle_support_plane.initialize(triangle_as);
+
+        shading_point.m_assembly_instance = instance.m_assembly_instance;
+        shading_point.m_assembly_instance_transform_seq = instance.m_transform_sequence;
+        shading_point.m_point_instancer = nullptr;
+        shading_point.m_point_instance_index = 0;
+        shading_point.m_assembly_instance_transform = instance.m_transform_sequence->get_earliest_transform();
+    }
+}
+
+void GPUScene::occlude(
+    const ShadingRay*       shading_rays,
+    bool*                   hits,
+    const size_t            count) const
+{
+    vector<GPURay> rays(count);
+    for (size_t i = 0; i < count; ++i)
+        shading_ray_to_gpu_ray(shading_rays[i], rays[i]);
+
+    // Distances are negative for rays that did not hit anything.
+    vector<float> distances(count, -1.0f);
+
+    execute_query(
+        RTP_QUERY_TYPE_ANY,
+        rays.data(),
+        RTP_BUFFER_FORMAT_HIT_T,
+        distances.data(),
+        count);
+
+    for (size_t i = 0; i < count; ++i)
+        hits[i] = distances[i] >= 0.0f;
+}
+
+void GPUScene::build_assembly_model(
+    const Assembly&         assembly,
+    AssemblyModel&          assembly_model)
+{
+    const ObjectInstanceContainer& object_instances = assembly.object_instances();
+
+    for (size_t i = 0, e = object_instances.size(); i < e; ++i)
+    {
+        const ObjectInstance& object_instance = *object_instances.get_by_index(i);
+
+        // Retrieve object space -> assembly space transform for the object instance.
+        const Transformd& transform = object_instance.get_transform();
+
+        const MeshObject& mesh = static_cast<const MeshObject&>(object_instance.get_object());
+        const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
+
+        const int32 base_vertex = static_cast<int32>(assembly_model.m_vertices.size());
+
+        for (size_t j = 0, je = tess.m_vertices.size(); j < je; ++j)
+            assembly_model.m_vertices.push_back(transform.point_to_parent(tess.m_vertices[j]));
+
+        for (size_t j = 0, je = tess.get_primitive_count(); j < je; ++j)
+        {
+            const Triangle primitive = tess.get_primitive(j);
+            assembly_model.m_indices.push_back(base_vertex + static_cast<int32>(primitive.m_v0));
+            assembly_model.m_indices.push_back(base_vertex + static_cast<int32>(primitive.m_v1));
+            assembly_model.m_indices.push_back(base_vertex + static_cast<int32>(primitive.m_v2));
+
+            TriangleRecord record;
+            record.m_object_instance_index = static_cast<uint32>(i);
+            record.m_primitive_index = static_cast<uint32>(j);
+            assembly_model.m_triangles.push_back(record);
+        }
+    }
+
+    RTPbufferdesc indices_desc;
+    require(
+        rtpBufferDescCreate(
+            m_context,
+            RTP_BUFFER_FORMAT_INDICES_INT3,
+            RTP_BUFFER_TYPE_HOST,
+            assembly_model.m_indices.data(),
+            &indices_desc));
+    require(rtpBufferDescSetRange(indices_desc, 0, assembly_model.m_triangles.size()));
+
+    RTPbufferdesc vertices_desc;
+    require(
+        rtpBufferDescCreate(
+            m_context,
+            RTP_BUFFER_FORMAT_VERTEX_FLOAT3,
+            RTP_BUFFER_TYPE_HOST,
+            assembly_model.m_vertices.data(),
+            &vertices_desc));
+    require(rtpBufferDescSetRange(vertices_desc, 0, assembly_model.m_vertices.size()));
+
+    require(rtpModelCreate(m_context, &assembly_model.m_model));
+    require(rtpModelSetTriangles(assembly_model.m_model, indices_desc, vertices_desc));
+    require(rtpModelUpdate(assembly_model.m_model, RTP_MODEL_HINT_NONE));
+
+    rtpBufferDescDestroy(vertices_desc);
+    rtpBufferDescDestroy(indices_desc);
+}
+
+bool GPUScene::execute_query(
+    const RTPquerytype      query_type,
+    void*                   rays,
+    const RTPbufferformat   hit_format,
+    void*                   hits,
+    const size_t            count) const
+{
+    // Only one thread at a time may use an OptiX Prime context.
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    RTPbufferdesc rays_desc = nullptr;
+    RTPbufferdesc hits_desc = nullptr;
+    RTPquery query = nullptr;
+
+    const bool success =
+        check(rtpBufferDescCreate(m_context, RTP_BUFFER_FORMAT_RAY_ORIGIN_TMIN_DIRECTION_TMAX, RTP_BUFFER_TYPE_HOST, rays, &rays_desc)) &&
+        check(rtpBufferDescSetRange(rays_desc, 0, count)) &&
+        check(rtpBufferDescCreate(m_context, hit_format, RTP_BUFFER_TYPE_HOST, hits, &hits_desc)) &&
+        check(rtpBufferDescSetRange(hits_desc, 0, count)) &&
+        check(rtpQueryCreate(m_model, query_type, &query)) &&
+        check(rtpQuerySetRays(query, rays_desc)) &&
+        check(rtpQuerySetHits(query, hits_desc)) &&
+        check(rtpQueryExecute(query, RTP_QUERY_HINT_NONE));
+
+    if (query)
+        rtpQueryDestroy(query);
+    if (hits_desc)
+        rtpBufferDescDestroy(hits_desc);
+    if (rays_desc)
+        rtpBufferDescDestroy(rays_desc);
+
+    return success;
+}
+
+void GPUScene::release()
+{
+    if (m_context == nullptr)
+        return;
+
+    if (m_model)
+        rtpModelDestroy(m_model);
+
+    for (each<vector<AssemblyModel>> i = m_assembly_models; i; ++i)
+    {
+        if (i->m_model)
+            rtpModelDestroy(i->m_model);
+    }
+
+    rtpContextDestroy(m_context);
+
+    m_context = nullptr;
+}
+
+bool GPUScene::check(const RTPresult result) const
+{
+    if (result == RTP_SUCCESS)
+        return true;
+
+    const char* message = nullptr;
+    if (m_context)
+        rtpContextGetLastErrorString(m_context, &message);
+
+    RENDERER_LOG_ERROR("optix prime error: %s", message ? message : "unknown error.");
+
+    return false;
+}
+
+void GPUScene::require(const RTPresult result) const
+{
+    if (!check(result))
+        throw Exception("failed to build gpu scene");
+}
+
+}   // namespace renderer
@@ -0,0 +1,151 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/uid.h"
+
+// OptiX headers.
+#include <optix_prime/optix_prime.h>
+
+// Standard headers.
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Forward declarations.
+namespace renderer { class Assembly; }
+namespace renderer { class AssemblyInstance; }
+namespace renderer { class ShadingPoint; }
+namespace renderer { class ShadingRay; }
+namespace renderer { class TransformSequence; }
+
+namespace renderer
+{
+
+//
+// A copy of the scene geometry on the GPU, intersected with OptiX Prime.
+//
+// Only batches of rays are traced on the GPU; hits are returned to the CPU
+// where shading takes place. Motion blur, alpha mapping, visibility flags
+// and procedural objects are not supported: use is_supported() to find out
+// whether a scene can be traced on the GPU.
+//
+
+class GPUScene
+  : public foundation::NonCopyable
+{
+  public:
+    struct Instance
+    {
+        const Assembly*             m_assembly;
+        const AssemblyInstance*     m_assembly_instance;
+        const TransformSequence*    m_transform_sequence;
+    };
+
+    typedef std::vector<Instance> InstanceVector;
+
+    // Return true if the given assembly instances can be traced on the GPU.
+    static bool is_supported(const InstanceVector& instances);
+
+    // Constructor. Throws a foundation::Exception if the GPU scene cannot be built.
+    explicit GPUScene(const InstanceVector& instances);
+
+    ~GPUScene();
+
+    // Trace batches of rays. Small batches are better traced on the CPU.
+    void intersect(
+        ShadingPoint*               shading_points,
+        const size_t                count) const;
+    void occlude(
+        const ShadingRay*           shading_rays,
+        bool*                       hits,
+        const size_t                count) const;
+
+  private:
+    // Origin of a triangle of an assembly model.
+    struct TriangleRecord
+    {
+        foundation::uint32                  m_object_instance_index;
+        foundation::uint32                  m_primitive_index;
+    };
+
+    // Geometry of one assembly, in assembly space.
+    struct AssemblyModel
+    {
+        RTPmodel                            m_model;
+        std::vector<GVector3>               m_vertices;
+        std::vector<foundation::int32>      m_indices;
+        std::vector<TriangleRecord>         m_triangles;
+
+        AssemblyModel()
+          : m_model(nullptr)
+        {
+        }
+    };
+
+    typedef std::map<foundation::UniqueID, size_t> AssemblyModelIndexMap;
+
+    RTPcontext                              m_context;
+    std::vector<AssemblyModel>              m_assembly_models;
+    RTPmodel                                m_model;
+    mutable boost::mutex                    m_mutex;
+
+    // Per assembly instance data, in the order of the OptiX instances.
+    InstanceVector                          m_instances;
+    std::vector<const AssemblyModel*>       m_instance_models;
+    std::vector<RTPmodel>                   m_instance_rtp_models;
+    std::vector<float>                      m_instance_transforms;
+
+    void build_assembly_model(
+        const Assembly&                     assembly,
+        AssemblyModel&                      assembly_model);
+
+    // Trace a batch of rays. Return false if the query failed.
+    bool execute_query(
+        const RTPquerytype                  query_type,
+        void*                               rays,
+        const RTPbufferformat               hit_format,
+        void*                               hits,
+        const size_t                        count) const;
+
+    void release();
+
+    // Log OptiX Prime errors. check() returns false on error, require() throws.
+    bool check(const RTPresult result) const;
+    void require(const RTPresult result) const;
+};
+
+}   // namespace renderer
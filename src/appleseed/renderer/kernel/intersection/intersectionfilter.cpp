@@ -40,9 +40,6 @@
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/scene/objectinstance.h"
 
-// appleseed.foundation headers.
-#include "foundation/utility/foreach.h"
-
 // Standard headers.
 #include <cassert>
 #include <memory>
@@ -55,22 +52,24 @@ namespace renderer
 
 namespace
 {
-    size_t get_triangle_count(Object& object)
+    size_t get_triangle_count(const Object& object)
     {
         const MeshObject& mesh = static_cast<const MeshObject&>(object);
         const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
-        return tess.m_primitives.size();
+        return tess.get_primitive_count();
     }
 
     void copy_uv_coordinates(const StaticTriangleTess& tess, vector<Vector2f>& uv)
     {
-        for (const_each<StaticTriangleTess::PrimitiveArray> i = tess.m_primitives; i; ++i)
+        for (size_t i = 0, e = tess.get_primitive_count(); i < e; ++i)
         {
-            if (i->has_vertex_attributes() && tess.get_tex_coords_count() > 0)
+            const Triangle triangle = tess.get_primitive(i);
+
+            if (triangle.has_vertex_attributes() && tess.get_tex_coords_count() > 0)
             {
-                const Vector2f uv0(tess.get_tex_coords(i->m_a0));
-                const Vector2f uv1(tess.get_tex_coords(i->m_a1));
-                const Vector2f uv2(tess.get_tex_coords(i->m_a2));
+                const Vector2f uv0(tess.get_tex_coords(triangle.m_a0));
+                const Vector2f uv1(tess.get_tex_coords(triangle.m_a1));
+                const Vector2f uv2(tess.get_tex_coords(triangle.m_a2));
 
                 uv.emplace_back(uv0[0], 1.0f - uv0[1]);
                 uv.emplace_back(uv1[0], 1.0f - uv1[1]);
@@ -85,7 +84,7 @@ namespace
         }
     }
 
-    void copy_uv_coordinates(Object& object, vector<Vector2f>& uv)
+    void copy_uv_coordinates(const Object& object, vector<Vector2f>& uv)
     {
         const MeshObject& mesh = static_cast<const MeshObject&>(object);
         const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
@@ -106,13 +105,6 @@ IntersectionFilter::IntersectionFilter(
 
     // Create alpha masks.
     update(object, materials, texture_cache);
-
-    if (has_alpha_masks())
-    {
-        // Make a local copy of the object's UV coordinates.
-        m_uv.reserve(get_triangle_count(object) * 3);
-        copy_uv_coordinates(object, m_uv);
-    }
 }
 
 IntersectionFilter::~IntersectionFilter()
@@ -201,6 +193,15 @@ void IntersectionFilter::update(
         else
             delete_and_clear(m_material_alpha_masks[i]);
     }
+
+    if (has_alpha_masks() && m_uv.empty())
+    {
+        // Make a local copy of the object's UV coordinates.
+        m_uv.reserve(get_triangle_count(object) * 3);
+        copy_uv_coordinates(object, m_uv);
+    }
+
+    classify_triangles(object);
 }
 
 bool IntersectionFilter::has_alpha_masks() const
@@ -235,7 +236,9 @@ size_t IntersectionFilter::get_masks_memory_size() const
 
 size_t IntersectionFilter::get_uv_memory_size() const
 {
-    return m_uv.capacity() * sizeof(Vector2f);
+    return
+          m_uv.capacity() * sizeof(Vector2f)
+        + m_triangle_opacities.capacity() * sizeof(uint8);
 }
 
 IntersectionFilter::AlphaMask* IntersectionFilter::create_alpha_mask(
@@ -280,4 +283,47 @@ IntersectionFilter::AlphaMask* IntersectionFilter::create_alpha_mask(
     return alpha_mask;
 }
 
+void IntersectionFilter::classify_triangles(const Object& object)
+{
+    const MeshObject& mesh = static_cast<const MeshObject&>(object);
+    const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
+    const size_t triangle_count = tess.get_primitive_count();
+
+    m_triangle_opacities.assign(triangle_count, static_cast<uint8>(Opaque));
+
+    if (!has_alpha_masks())
+        return;
+
+    assert(m_uv.size() == triangle_count * 3);
+
+    for (size_t i = 0; i < triangle_count; ++i)
+    {
+        // The UV coordinates of any point of the triangle lie within this rectangle.
+        const Vector2f& uv0 = m_uv[i * 3 + 0];
+        const Vector2f& uv1 = m_uv[i * 3 + 1];
+        const Vector2f& uv2 = m_uv[i * 3 + 2];
+        const Vector2f uv_min = component_wise_min(component_wise_min(uv0, uv1), uv2);
+        const Vector2f uv_max = component_wise_max(component_wise_max(uv0, uv1), uv2);
+
+        TriangleOpacity opacity = Opaque;
+
+        if (m_obj_alpha_mask)
+            opacity = m_obj_alpha_mask->get_opacity(uv_min, uv_max);
+
+        const size_t pa = tess.get_primitive(i).m_pa;
+
+        if (opacity != Transparent &&
+            pa < m_material_alpha_masks.size() &&
+            m_material_alpha_masks[pa])
+        {
+            const TriangleOpacity mtl_opacity =
+                m_material_alpha_masks[pa]->get_opacity(uv_min, uv_max);
+            if (mtl_opacity != Opaque)
+                opacity = mtl_opacity;
+        }
+
+        m_triangle_opacities[i] = static_cast<uint8>(opacity);
+    }
+}
+
 }   // namespace renderer
@@ -79,6 +79,14 @@ class IntersectionFilter
         const double            v) const;
 
   private:
+    // Opacity of a whole triangle, as seen through the alpha masks.
+    enum TriangleOpacity
+    {
+        Opaque,                         // the triangle is opaque everywhere
+        Transparent,                    // the triangle is transparent everywhere
+        Mixed                           // the alpha masks must be looked up
+    };
+
     class AlphaMask
       : public foundation::NonCopyable
     {
@@ -116,6 +124,30 @@ class IntersectionFilter
             return !is_opaque(uv);
         }
 
+        // Return the opacity of all the texels touched by a rectangle in UV space.
+        TriangleOpacity get_opacity(
+            const foundation::Vector2f& uv_min,
+            const foundation::Vector2f& uv_max) const
+        {
+            const size_t x0 = truncate_x(uv_min[0]);
+            const size_t y0 = truncate_y(uv_min[1]);
+            const size_t x1 = truncate_x(uv_max[0]);
+            const size_t y1 = truncate_y(uv_max[1]);
+
+            const bool first_texel_opaque = m_bitmask.is_set(x0, y0);
+
+            for (size_t y = y0; y <= y1; ++y)
+            {
+                for (size_t x = x0; x <= x1; ++x)
+                {
+                    if (m_bitmask.is_set(x, y) != first_texel_opaque)
+                        return Mixed;
+                }
+            }
+
+            return first_texel_opaque ? Opaque : Transparent;
+        }
+
         size_t get_memory_size() const
         {
             return m_bitmask.get_memory_size();
@@ -125,6 +157,18 @@ class IntersectionFilter
         const float             m_max_x;
         const float             m_max_y;
         foundation::BitMask2    m_bitmask;
+
+        size_t truncate_x(const float u) const
+        {
+            return foundation::truncate<size_t>(
+                foundation::clamp(u * m_bitmask.get_width(), 0.0f, m_max_x));
+        }
+
+        size_t truncate_y(const float v) const
+        {
+            return foundation::truncate<size_t>(
+                foundation::clamp(v * m_bitmask.get_height(), 0.0f, m_max_y));
+        }
     };
 
     foundation::uint64                  m_obj_alpha_map_signature;
@@ -132,6 +176,7 @@ class IntersectionFilter
     std::vector<foundation::uint64>     m_material_alpha_map_signatures;
     std::vector<AlphaMask*>             m_material_alpha_masks;
     std::vector<foundation::Vector2f>   m_uv;
+    std::vector<foundation::uint8>      m_triangle_opacities;
 
     template <typename EntityType>
     static void do_update(
@@ -144,6 +189,8 @@ class IntersectionFilter
         const Source*           alpha_map,
         TextureCache&           texture_cache,
         double&                 transparency);
+
+    void classify_triangles(const Object& object);
 };
 
 
@@ -165,12 +212,19 @@ inline bool IntersectionFilter::accept(
     if (u != u || v != v)
         return true;
 
+    const size_t triangle_index = triangle_key.get_triangle_index();
+
+    // Skip alpha mask lookups for triangles that are entirely opaque or transparent.
+    switch (m_triangle_opacities[triangle_index])
+    {
+      case Opaque: return true;
+      case Transparent: return false;
+    }
+
     const AlphaMask* mtl_alpha_mask = m_material_alpha_masks[triangle_key.get_triangle_pa()];
 
     if (m_obj_alpha_mask || mtl_alpha_mask)
     {
-        const size_t triangle_index = triangle_key.get_triangle_index();
-
         const float fu = static_cast<float>(u);
         const float fv = static_cast<float>(v);
 
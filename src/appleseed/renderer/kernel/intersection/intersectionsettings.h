@@ -35,6 +35,7 @@
 // appleseed.foundation headers.
 #include "foundation/math/beziercurve.h"
 #include "foundation/math/intersection/raytrianglemt.h"
+#include "foundation/math/intersection/raytrianglemt4.h"
 #include "foundation/math/matrix.h"
 
 // Standard headers.
@@ -57,6 +58,23 @@ const double AssemblyTreeInteriorNodeTraversalCost = 1.0;
 const double AssemblyTreeTriangleIntersectionCost = 10.0;
 
 
+//
+// Point instancer tree settings.
+//
+
+// Maximum number of point instances per leaf.
+const size_t PointInstancerTreeMaxLeafSize = 2;
+
+// Relative cost of traversing an interior node.
+const double PointInstancerTreeInteriorNodeTraversalCost = 1.0;
+
+// Relative cost of intersecting a point instance.
+const double PointInstancerTreeInstanceIntersectionCost = 10.0;
+
+// Size of the stack (in number of nodes) used during traversal.
+const size_t PointInstancerTreeStackSize = 64;
+
+
 //
 // Triangle tree settings.
 //
@@ -64,6 +82,9 @@ const double AssemblyTreeTriangleIntersectionCost = 10.0;
 // Triangle format used for storage.
 typedef foundation::TriangleMT<GScalar> GTriangleType;
 
+// Format of groups of triangles stored in SIMD leaves.
+typedef foundation::TriangleMT4<GScalar> GTriangle4Type;
+
 // Triangle format used for intersection.
 typedef foundation::TriangleMT<double> TriangleType;
 typedef foundation::TriangleMTSupportPlane<double> TriangleSupportPlaneType;
@@ -94,6 +115,12 @@ const size_t TriangleTreeAccessCacheWays = 2;
 // Size of the stack (in number of nodes) used during traversal.
 const size_t TriangleTreeStackSize = 64;
 
+// Number of children of the nodes of wide triangle trees (4 or 8).
+const size_t TriangleTreeWideNodeWidth = 4;
+
+// Size of the stack (in number of nodes) used during wide tree traversal.
+const size_t TriangleTreeWideStackSize = 128;
+
 
 //
 // Curve tree settings.
@@ -119,6 +146,12 @@ const GScalar CurveTreeDefaultInteriorNodeTraversalCost(1.0);
 // Relative cost of intersecting a curve.
 const GScalar CurveTreeDefaultCurveIntersectionCost(1.0);
 
+// Maximum number of times degree-3 curves are halved at build time to tighten their bounding boxes.
+const size_t CurveTreeDefaultMaxSplitDepth = 3;
+
+// Curves are halved only if the surface area of their two halves' bounding boxes is at most this fraction of theirs.
+const GScalar CurveTreeDefaultSplitThreshold(0.8);
+
 // Size of the curve tree access cache.
 const size_t CurveTreeAccessCacheLines = 128;
 const size_t CurveTreeAccessCacheWays = 2;
@@ -137,6 +170,41 @@ const size_t CurveTreeStackSize = 64;
 const size_t EmbreeSceneAccessCacheLines = 128;
 const size_t EmbreeSceneAccessCacheWays = 2;
 
+// Runtime settings of Embree scenes, trading build time against trace speed and memory.
+struct EmbreeSceneSettings
+{
+    enum BuildQuality
+    {
+        BuildQualityLow,                // fastest builds, slower traversal (interactive rendering)
+        BuildQualityMedium,
+        BuildQualityHigh                // slowest builds, fastest traversal (final rendering)
+    };
+
+    BuildQuality    m_build_quality;
+    bool            m_compact;          // use a more compact but slower acceleration structure
+    bool            m_robust;           // avoid optimizations that reduce arithmetic accuracy
+
+    EmbreeSceneSettings()
+      : m_build_quality(BuildQualityHigh)
+      , m_compact(false)
+      , m_robust(false)
+    {
+    }
+
+    bool operator==(const EmbreeSceneSettings& rhs) const
+    {
+        return
+            m_build_quality == rhs.m_build_quality &&
+            m_compact == rhs.m_compact &&
+            m_robust == rhs.m_robust;
+    }
+
+    bool operator!=(const EmbreeSceneSettings& rhs) const
+    {
+        return !(*this == rhs);
+    }
+};
+
 #endif
 
 //
@@ -33,11 +33,15 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/intersection/assemblytree.h"
+#include "renderer/kernel/intersection/raydump.h"
 #include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/rendering/renderingcounters.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/visibilityflags.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/utility/cache.h"
 #include "foundation/utility/casts.h"
@@ -48,6 +52,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <string>
@@ -67,6 +72,20 @@ Intersector::Intersector(
   , m_report_self_intersections(report_self_intersections)
   , m_shading_ray_count(0)
   , m_probe_ray_count(0)
+  , m_local_ray_count(0)
+  , m_ray_packet_count(0)
+  , m_volume_ray_count(0)
+{
+    assert(VisibilityFlags::Count == RayTypeCount);
+
+    for (size_t i = 0; i < RayTypeCount; ++i)
+        m_ray_type_counts[i] = 0;
+
+    if (RayDumpWriter* ray_dump_writer = trace_context.get_ray_dump_writer())
+        m_ray_dump_stream.reset(new RayDumpStream(*ray_dump_writer));
+}
+
+Intersector::~Intersector()
 {
 }
 
@@ -235,10 +254,65 @@ namespace
     }
 }
 
+inline void Intersector::update_ray_type_statistics(const ShadingRay& ray) const
+{
+    // Rays almost always carry a single visibility flag; rays with no or several flags
+    // only contribute to the total ray count.
+    const VisibilityFlags::Type ray_flags = ray.m_flags & ~VisibilityFlags::ProxyRay;
+    if (ray_flags != 0 && is_pow2(ray_flags))
+    {
+        const size_t ray_type = log2_int(ray_flags);
+        assert(ray_type < RayTypeCount);
+        ++m_ray_type_counts[ray_type];
+    }
+
+    const ShadingRay::Medium* medium = ray.get_current_medium();
+    if (medium != nullptr && medium->get_volume() != nullptr)
+        ++m_volume_ray_count;
+}
+
 bool Intersector::trace(
     const ShadingRay&                   ray,
     ShadingPoint&                       shading_point,
     const ShadingPoint*                 parent_shading_point) const
+{
+    const bool hit = do_trace(ray, shading_point, parent_shading_point);
+
+    if (m_ray_dump_stream)
+    {
+        m_ray_dump_stream->record(
+            ray,
+            parent_shading_point,
+            RayDumpRecord::Trace,
+            hit ? shading_point.get_distance() : -1.0);
+    }
+
+    return hit;
+}
+
+bool Intersector::trace_probe(
+    const ShadingRay&                   ray,
+    const ShadingPoint*                 parent_shading_point,
+    ProbeOccluder*                      occluder) const
+{
+    const bool hit = do_trace_probe(ray, parent_shading_point, occluder);
+
+    if (m_ray_dump_stream)
+    {
+        m_ray_dump_stream->record(
+            ray,
+            parent_shading_point,
+            RayDumpRecord::Probe,
+            hit ? 0.0 : -1.0);
+    }
+
+    return hit;
+}
+
+bool Intersector::do_trace(
+    const ShadingRay&                   ray,
+    ShadingPoint&                       shading_point,
+    const ShadingPoint*                 parent_shading_point) const
 {
     assert(is_normalized(ray.m_dir));
     assert(shading_point.m_scene == nullptr);
@@ -248,6 +322,8 @@ bool Intersector::trace(
 
     // Update ray casting statistics.
     ++m_shading_ray_count;
+    update_ray_type_statistics(ray);
+    ++RenderingCounters::current().m_ray_count;
 
     // Initialize the shading point.
     shading_point.m_texture_cache = &m_texture_cache;
@@ -266,30 +342,56 @@ bool Intersector::trace(
     // Retrieve assembly tree.
     const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
 
-    // Check the intersection between the ray and the assembly tree.
-    AssemblyTreeIntersector intersector;
-    AssemblyLeafVisitor visitor(
-        shading_point,
-        assembly_tree,
-        m_triangle_tree_cache,
-        m_curve_tree_cache,
 #ifdef APPLESEED_WITH_EMBREE
-        m_embree_scene_cache,
+
+    // Let Embree handle assembly instances if it can.
+    if (assembly_tree.m_embree_instance_scene)
+        assembly_tree.m_embree_instance_scene->intersect(shading_point);
+    else
+
 #endif
-        parent_shading_point
+    {
+        // Check the intersection between the ray and the assembly tree.
+        AssemblyLeafVisitor visitor(
+            shading_point,
+            assembly_tree,
+            m_triangle_tree_cache,
+            m_curve_tree_cache,
+#ifdef APPLESEED_WITH_EMBREE
+            m_embree_scene_cache,
+#endif
+            parent_shading_point
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-        , m_triangle_tree_traversal_stats
+            , m_triangle_tree_traversal_stats
 #endif
-        );
-    intersector.intersect_no_motion(
-        assembly_tree,
-        shading_point.m_ray,
-        ray_info,
-        visitor
+            );
+        if (const AssemblyTree::WideTreeType* wide_tree = assembly_tree.get_wide_tree())
+        {
+            AssemblyTreeWideIntersector intersector;
+            intersector.intersect_no_motion(
+                *wide_tree,
+                shading_point.m_ray,
+                ray_info,
+                visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
-        , m_assembly_tree_traversal_stats
+                , m_assembly_tree_traversal_stats
 #endif
-        );
+                );
+        }
+        else
+        {
+            AssemblyTreeIntersector intersector;
+            intersector.intersect_no_motion(
+                assembly_tree,
+                shading_point.m_ray,
+                ray_info,
+                visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+                , m_assembly_tree_traversal_stats
+#endif
+                );
+        }
+    }
 
     // Detect and report self-intersections.
     if (m_report_self_intersections)
@@ -302,15 +404,18 @@ bool Intersector::trace(
     return shading_point.hit_surface();
 }
 
-bool Intersector::trace_probe(
+bool Intersector::do_trace_probe(
     const ShadingRay&                   ray,
-    const ShadingPoint*                 parent_shading_point) const
+    const ShadingPoint*                 parent_shading_point,
+    ProbeOccluder*                      occluder) const
 {
     assert(is_normalized(ray.m_dir));
     assert(parent_shading_point == 0 || parent_shading_point->hit_surface());
 
     // Update ray casting statistics.
     ++m_probe_ray_count;
+    update_ray_type_statistics(ray);
+    ++RenderingCounters::current().m_ray_count;
 
     // Compute ray info once for the entire traversal.
     const ShadingRay::RayInfoType ray_info(ray);
@@ -324,33 +429,580 @@ bool Intersector::trace_probe(
     // Retrieve assembly tree.
     const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
 
+    // Forget the previous occluder.
+    if (occluder)
+        occluder->m_leaf = nullptr;
+
+#ifdef APPLESEED_WITH_EMBREE
+
+    // Let Embree handle assembly instances if it can.
+    if (assembly_tree.m_embree_instance_scene)
+        return assembly_tree.m_embree_instance_scene->occlude(ray);
+
+#endif
+
     // Check the intersection between the ray and the assembly tree.
-    AssemblyTreeProbeIntersector intersector;
     AssemblyLeafProbeVisitor visitor(
         assembly_tree,
         m_triangle_tree_cache,
         m_curve_tree_cache,
 #ifdef APPLESEED_WITH_EMBREE
         m_embree_scene_cache,
+#endif
+        parent_shading_point,
+        occluder
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , m_triangle_tree_traversal_stats
+#endif
+        );
+    if (const AssemblyTree::WideTreeType* wide_tree = assembly_tree.get_wide_tree())
+    {
+        AssemblyTreeWideProbeIntersector intersector;
+        intersector.intersect_no_motion(
+            *wide_tree,
+            ray,
+            ray_info,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+    }
+    else
+    {
+        AssemblyTreeProbeIntersector intersector;
+        intersector.intersect_no_motion(
+            assembly_tree,
+            ray,
+            ray_info,
+            visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+            , m_assembly_tree_traversal_stats
+#endif
+            );
+    }
+
+    return visitor.hit();
+}
+
+bool Intersector::trace_probe_occluder(
+    const ShadingRay&                   ray,
+    const ProbeOccluder&                occluder,
+    const ShadingPoint*                 parent_shading_point) const
+{
+    assert(is_normalized(ray.m_dir));
+    assert(parent_shading_point == 0 || parent_shading_point->hit_surface());
+    assert(occluder.m_leaf);
+
+    // Refine and offset the previous intersection point.
+    if (parent_shading_point &&
+        parent_shading_point->hit_surface() &&
+        !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+        parent_shading_point->refine_and_offset();
+
+    // Check the intersection between the ray and the occluder.
+    AssemblyLeafProbeVisitor visitor(
+        m_trace_context.get_assembly_tree(),
+        m_triangle_tree_cache,
+        m_curve_tree_cache,
+#ifdef APPLESEED_WITH_EMBREE
+        m_embree_scene_cache,
+#endif
+        parent_shading_point,
+        nullptr
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , m_triangle_tree_traversal_stats
+        , m_curve_tree_traversal_stats
+#endif
+        );
+    if (!visitor.visit_occluder(occluder, ray))
+        return false;
+
+    // Update ray casting statistics. Rays missing the occluder are counted when they are traced.
+    ++m_probe_ray_count;
+    update_ray_type_statistics(ray);
+    ++RenderingCounters::current().m_ray_count;
+
+    return true;
+}
+
+bool Intersector::trace_local(
+    const ShadingRay&                   ray,
+    const ShadingPoint&                 owner,
+    ShadingPoint&                       shading_point,
+    const ShadingPoint*                 parent_shading_point) const
+{
+    assert(is_normalized(ray.m_dir));
+    assert(owner.hit_surface());
+    assert(shading_point.m_scene == nullptr);
+    assert(!shading_point.is_valid());
+    assert(parent_shading_point == nullptr || parent_shading_point != &shading_point);
+    assert(parent_shading_point == nullptr || parent_shading_point->is_valid());
+
+    // Retrieve assembly tree.
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+#ifdef APPLESEED_WITH_EMBREE
+
+    // Assembly instances are not individually reachable when Embree handles them.
+    if (assembly_tree.m_embree_instance_scene)
+        return trace(ray, shading_point, parent_shading_point);
+
+#endif
+
+    // Update ray casting statistics.
+    ++m_shading_ray_count;
+    ++m_local_ray_count;
+    update_ray_type_statistics(ray);
+    ++RenderingCounters::current().m_ray_count;
+
+    // Initialize the shading point.
+    shading_point.m_texture_cache = &m_texture_cache;
+    shading_point.m_scene = &m_trace_context.get_scene();
+    shading_point.m_ray = ray;
+
+    // Refine and offset the previous intersection point.
+    if (parent_shading_point &&
+        parent_shading_point->hit_surface() &&
+        !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+        parent_shading_point->refine_and_offset();
+
+    // Check the intersection between the ray and the assembly instance of the owner.
+    AssemblyLeafVisitor visitor(
+        shading_point,
+        assembly_tree,
+        m_triangle_tree_cache,
+        m_curve_tree_cache,
+#ifdef APPLESEED_WITH_EMBREE
+        m_embree_scene_cache,
 #endif
         parent_shading_point
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , m_triangle_tree_traversal_stats
+        , m_curve_tree_traversal_stats
+#endif
+        );
+    visitor.visit_assembly_instance(owner, shading_point.m_ray);
+
+    // Detect and report self-intersections.
+    if (m_report_self_intersections)
+        report_self_intersection(shading_point, parent_shading_point);
+
+    const ShadingRay::Medium* medium = ray.get_current_medium();
+    if (!shading_point.hit_surface() && medium != nullptr && medium->get_volume() != nullptr)
+        shading_point.m_primitive_type = ShadingPoint::PrimitiveVolume;
+
+    return shading_point.hit_surface();
+}
+
+void Intersector::trace_local(
+    const ShadingRay*                   rays,
+    const ShadingPoint&                 owner,
+    ShadingPoint*                       shading_points,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    // All rays share the triangle tree and the transform of the owner's assembly
+    // instance, so the tree stays hot in the access caches across the batch.
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        trace_local(
+            rays[i],
+            owner,
+            shading_points[i],
+            parent_shading_points ? parent_shading_points[i] : nullptr);
+    }
+}
+
+void Intersector::trace(
+    const ShadingRay*                   rays,
+    ShadingPoint*                       shading_points,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    do_trace(rays, shading_points, ray_count, parent_shading_points);
+
+    if (m_ray_dump_stream)
+    {
+        for (size_t i = 0; i < ray_count; ++i)
+        {
+            m_ray_dump_stream->record(
+                rays[i],
+                parent_shading_points ? parent_shading_points[i] : nullptr,
+                RayDumpRecord::Trace,
+                shading_points[i].hit_surface() ? shading_points[i].get_distance() : -1.0);
+        }
+    }
+}
+
+void Intersector::trace_probe(
+    const ShadingRay*                   rays,
+    bool*                               hits,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    do_trace_probe(rays, hits, ray_count, parent_shading_points);
+
+    if (m_ray_dump_stream)
+    {
+        for (size_t i = 0; i < ray_count; ++i)
+        {
+            m_ray_dump_stream->record(
+                rays[i],
+                parent_shading_points ? parent_shading_points[i] : nullptr,
+                RayDumpRecord::Probe,
+                hits[i] ? 0.0 : -1.0);
+        }
+    }
+}
+
+void Intersector::do_trace(
+    const ShadingRay*                   rays,
+    ShadingPoint*                       shading_points,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+#ifdef APPLESEED_WITH_GPU
+
+    // Hand the whole batch to the GPU when it holds the scene.
+    if (assembly_tree.m_gpu_scene)
+    {
+        trace_stream(*assembly_tree.m_gpu_scene, rays, shading_points, ray_count, parent_shading_points);
+        return;
+    }
+
+#endif
+
+#ifdef APPLESEED_WITH_EMBREE
+
+    // Hand the whole batch to Embree when it handles assembly instances.
+    if (assembly_tree.m_embree_instance_scene)
+    {
+        trace_stream(*assembly_tree.m_embree_instance_scene, rays, shading_points, ray_count, parent_shading_points);
+        return;
+    }
+
+#endif
+
+    const size_t PacketSize = AssemblyTreeRayPacket::MaxSize;
+
+    for (size_t i = 0; i < ray_count; i += PacketSize)
+    {
+        trace_packet(
+            rays + i,
+            shading_points + i,
+            min(ray_count - i, PacketSize),
+            parent_shading_points ? parent_shading_points + i : nullptr);
+    }
+}
+
+void Intersector::do_trace_probe(
+    const ShadingRay*                   rays,
+    bool*                               hits,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+#ifdef APPLESEED_WITH_GPU
+
+    // Hand the whole batch to the GPU when it holds the scene.
+    if (assembly_tree.m_gpu_scene)
+    {
+        trace_probe_stream(*assembly_tree.m_gpu_scene, rays, hits, ray_count, parent_shading_points);
+        return;
+    }
+
+#endif
+
+#ifdef APPLESEED_WITH_EMBREE
+
+    // Hand the whole batch to Embree when it handles assembly instances.
+    if (assembly_tree.m_embree_instance_scene)
+    {
+        trace_probe_stream(*assembly_tree.m_embree_instance_scene, rays, hits, ray_count, parent_shading_points);
+        return;
+    }
+
+#endif
+
+    const size_t PacketSize = AssemblyTreeRayPacket::MaxSize;
+
+    for (size_t i = 0; i < ray_count; i += PacketSize)
+    {
+        trace_probe_packet(
+            rays + i,
+            hits + i,
+            min(ray_count - i, PacketSize),
+            parent_shading_points ? parent_shading_points + i : nullptr);
+    }
+}
+
+void Intersector::trace_packet(
+    const ShadingRay*                   rays,
+    ShadingPoint*                       shading_points,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    assert(ray_count > 0 && ray_count <= AssemblyTreeRayPacket::MaxSize);
+
+    // Update ray casting statistics.
+    m_shading_ray_count += ray_count;
+    ++m_ray_packet_count;
+    for (size_t i = 0; i < ray_count; ++i)
+        update_ray_type_statistics(rays[i]);
+    RenderingCounters::current().m_ray_count += ray_count;
+
+    AssemblyTreeRayPacket packet;
+    ShadingRay::RayInfoType ray_infos[AssemblyTreeRayPacket::MaxSize];
+
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        const ShadingRay& ray = rays[i];
+        ShadingPoint& shading_point = shading_points[i];
+        const ShadingPoint* parent_shading_point =
+            parent_shading_points ? parent_shading_points[i] : nullptr;
+
+        assert(is_normalized(ray.m_dir));
+        assert(shading_point.m_scene == nullptr);
+        assert(!shading_point.is_valid());
+        assert(parent_shading_point == nullptr || parent_shading_point != &shading_point);
+        assert(parent_shading_point == nullptr || parent_shading_point->is_valid());
+
+        // Initialize the shading point.
+        shading_point.m_texture_cache = &m_texture_cache;
+        shading_point.m_scene = &m_trace_context.get_scene();
+        shading_point.m_ray = ray;
+
+        // Compute ray info once for the entire traversal.
+        ray_infos[i] = ShadingRay::RayInfoType(shading_point.m_ray);
+        packet.push_back(shading_point.m_ray, ray_infos[i]);
+
+        // Refine and offset the previous intersection point.
+        if (parent_shading_point &&
+            parent_shading_point->hit_surface() &&
+            !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+            parent_shading_point->refine_and_offset();
+    }
+
+    // Retrieve assembly tree.
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+    // Check the intersection between the packet and the assembly tree.
+    AssemblyTreePacketIntersector intersector;
+    AssemblyLeafPacketVisitor visitor(
+        shading_points,
+        ray_infos,
+        parent_shading_points,
+        assembly_tree,
+        m_triangle_tree_cache,
+        m_curve_tree_cache
+#ifdef APPLESEED_WITH_EMBREE
+        , m_embree_scene_cache
+#endif
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , m_triangle_tree_traversal_stats
+        , m_curve_tree_traversal_stats
 #endif
         );
     intersector.intersect_no_motion(
         assembly_tree,
-        ray,
-        ray_info,
+        packet,
         visitor
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
         , m_assembly_tree_traversal_stats
 #endif
         );
 
-    return visitor.hit();
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        ShadingPoint& shading_point = shading_points[i];
+
+        // Detect and report self-intersections.
+        if (m_report_self_intersections)
+        {
+            report_self_intersection(
+                shading_point,
+                parent_shading_points ? parent_shading_points[i] : nullptr);
+        }
+
+        const ShadingRay::Medium* medium = rays[i].get_current_medium();
+        if (!shading_point.hit_surface() && medium != nullptr && medium->get_volume() != nullptr)
+            shading_point.m_primitive_type = ShadingPoint::PrimitiveVolume;
+    }
 }
 
+void Intersector::trace_probe_packet(
+    const ShadingRay*                   rays,
+    bool*                               hits,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    assert(ray_count > 0 && ray_count <= AssemblyTreeRayPacket::MaxSize);
+
+    // Update ray casting statistics.
+    m_probe_ray_count += ray_count;
+    ++m_ray_packet_count;
+    for (size_t i = 0; i < ray_count; ++i)
+        update_ray_type_statistics(rays[i]);
+    RenderingCounters::current().m_ray_count += ray_count;
+
+    AssemblyTreeRayPacket packet;
+    ShadingRay::RayInfoType ray_infos[AssemblyTreeRayPacket::MaxSize];
+
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        const ShadingRay& ray = rays[i];
+        const ShadingPoint* parent_shading_point =
+            parent_shading_points ? parent_shading_points[i] : nullptr;
+
+        assert(is_normalized(ray.m_dir));
+        assert(parent_shading_point == nullptr || parent_shading_point->hit_surface());
+
+        hits[i] = false;
+
+        // Compute ray info once for the entire traversal.
+        ray_infos[i] = ShadingRay::RayInfoType(ray);
+        packet.push_back(ray, ray_infos[i]);
+
+        // Refine and offset the previous intersection point.
+        if (parent_shading_point &&
+            parent_shading_point->hit_surface() &&
+            !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+            parent_shading_point->refine_and_offset();
+    }
+
+    // Retrieve assembly tree.
+    const AssemblyTree& assembly_tree = m_trace_context.get_assembly_tree();
+
+    // Check the intersection between the packet and the assembly tree.
+    AssemblyTreeProbePacketIntersector intersector;
+    AssemblyLeafProbePacketVisitor visitor(
+        rays,
+        ray_infos,
+        parent_shading_points,
+        hits,
+        assembly_tree,
+        m_triangle_tree_cache,
+        m_curve_tree_cache
+#ifdef APPLESEED_WITH_EMBREE
+        , m_embree_scene_cache
+#endif
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , m_triangle_tree_traversal_stats
+        , m_curve_tree_traversal_stats
+#endif
+        );
+    intersector.intersect_no_motion(
+        assembly_tree,
+        packet,
+        visitor
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , m_assembly_tree_traversal_stats
+#endif
+        );
+}
+
+#if defined APPLESEED_WITH_EMBREE || defined APPLESEED_WITH_GPU
+
+template <typename Scene>
+void Intersector::trace_stream(
+    const Scene&                        scene,
+    const ShadingRay*                   rays,
+    ShadingPoint*                       shading_points,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    assert(ray_count > 0);
+
+    // Update ray casting statistics.
+    m_shading_ray_count += ray_count;
+    ++m_ray_packet_count;
+    for (size_t i = 0; i < ray_count; ++i)
+        update_ray_type_statistics(rays[i]);
+    RenderingCounters::current().m_ray_count += ray_count;
+
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        const ShadingRay& ray = rays[i];
+        ShadingPoint& shading_point = shading_points[i];
+        const ShadingPoint* parent_shading_point =
+            parent_shading_points ? parent_shading_points[i] : nullptr;
+
+        assert(is_normalized(ray.m_dir));
+        assert(parent_shading_point == nullptr || parent_shading_point->hit_surface());
+
+        // Initialize the shading point.
+        shading_point.m_texture_cache = &m_texture_cache;
+        shading_point.m_scene = &m_trace_context.get_scene();
+        shading_point.m_ray = ray;
+
+        // Refine and offset the previous intersection point.
+        if (parent_shading_point &&
+            parent_shading_point->hit_surface() &&
+            !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+            parent_shading_point->refine_and_offset();
+    }
+
+    scene.intersect(shading_points, ray_count);
+
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        ShadingPoint& shading_point = shading_points[i];
+
+        // Detect and report self-intersections.
+        if (m_report_self_intersections)
+        {
+            report_self_intersection(
+                shading_point,
+                parent_shading_points ? parent_shading_points[i] : nullptr);
+        }
+
+        const ShadingRay::Medium* medium = rays[i].get_current_medium();
+        if (!shading_point.hit_surface() && medium != nullptr && medium->get_volume() != nullptr)
+            shading_point.m_primitive_type = ShadingPoint::PrimitiveVolume;
+    }
+}
+
+template <typename Scene>
+void Intersector::trace_probe_stream(
+    const Scene&                        scene,
+    const ShadingRay*                   rays,
+    bool*                               hits,
+    const size_t                        ray_count,
+    const ShadingPoint* const*          parent_shading_points) const
+{
+    assert(ray_count > 0);
+
+    // Update ray casting statistics.
+    m_probe_ray_count += ray_count;
+    ++m_ray_packet_count;
+    for (size_t i = 0; i < ray_count; ++i)
+        update_ray_type_statistics(rays[i]);
+    RenderingCounters::current().m_ray_count += ray_count;
+
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        const ShadingPoint* parent_shading_point =
+            parent_shading_points ? parent_shading_points[i] : nullptr;
+
+        assert(is_normalized(rays[i].m_dir));
+        assert(parent_shading_point == nullptr || parent_shading_point->hit_surface());
+
+        // Refine and offset the previous intersection point.
+        if (parent_shading_point &&
+            parent_shading_point->hit_surface() &&
+            !(parent_shading_point->m_members & ShadingPoint::HasRefinedPoints))
+            parent_shading_point->refine_and_offset();
+    }
+
+    scene.occlude(rays, hits, ray_count);
+}
+
+#endif
+
 void Intersector::make_triangle_shading_point(
     ShadingPoint&                       shading_point,
     const ShadingRay&                   shading_ray,
@@ -376,6 +1028,8 @@ void Intersector::make_triangle_shading_point(
     shading_point.m_assembly_instance = assembly_instance;
     shading_point.m_assembly_instance_transform = assembly_instance_transform;
     shading_point.m_assembly_instance_transform_seq = &assembly_instance->transform_sequence();
+    shading_point.m_point_instancer = nullptr;
+    shading_point.m_point_instance_index = 0;
     shading_point.m_object_instance_index = object_instance_index;
     shading_point.m_primitive_index = primitive_index;
     shading_point.m_triangle_support_plane = triangle_support_plane;
@@ -413,6 +1067,8 @@ void Intersector::make_procedural_surface_shading_point(
     shading_point.m_assembly_instance = assembly_instance;
     shading_point.m_assembly_instance_transform = assembly_instance_transform;
     shading_point.m_assembly_instance_transform_seq = &assembly_instance->transform_sequence();
+    shading_point.m_point_instancer = nullptr;
+    shading_point.m_point_instance_index = 0;
     shading_point.m_object_instance_index = object_instance_index;
     shading_point.m_primitive_index = primitive_index;
 
@@ -423,10 +1079,10 @@ void Intersector::make_procedural_surface_shading_point(
     shading_point.m_geometric_normal = shading_point.m_original_shading_normal = normal;
     shading_point.m_members |= ShadingPoint::HasGeometricNormal | ShadingPoint::HasOriginalShadingNormal;
 
-    shading_point.m_shading_basis = Basis3d(
-        normal,
-        normalize(dpdu),
-        normalize(dpdv));
+    shading_point.m_shading_basis = SBasis3(
+        SVector3(normal),
+        SVector3(normalize(dpdu)),
+        SVector3(normalize(dpdv)));
     shading_point.m_members |= ShadingPoint::HasShadingBasis;
 
     shading_point.m_uv = uv;
@@ -525,10 +1181,35 @@ StatisticsVector Intersector::get_statistics() const
                 "probe rays",
                 m_probe_ray_count,
                 total_ray_count)));
+    intersection_stats.insert(
+        unique_ptr<RayCountStatisticsEntry>(
+            new RayCountStatisticsEntry(
+                "assembly-local rays",
+                m_local_ray_count,
+                total_ray_count)));
+    intersection_stats.insert("ray packets", m_ray_packet_count);
+
+    Statistics ray_type_stats;
+    for (size_t i = 0; i < RayTypeCount; ++i)
+    {
+        ray_type_stats.insert(
+            unique_ptr<RayCountStatisticsEntry>(
+                new RayCountStatisticsEntry(
+                    string(VisibilityFlags::Names[i]) + " rays",
+                    m_ray_type_counts[i],
+                    total_ray_count)));
+    }
+    ray_type_stats.insert(
+        unique_ptr<RayCountStatisticsEntry>(
+            new RayCountStatisticsEntry(
+                "rays in volumes",
+                m_volume_ray_count,
+                total_ray_count)));
 
     StatisticsVector vec;
 
     vec.insert("intersection statistics", intersection_stats);
+    vec.insert("ray type statistics", ray_type_stats);
 
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     vec.insert(
@@ -538,6 +1219,10 @@ StatisticsVector Intersector::get_statistics() const
     vec.insert(
         "triangle trees intersection statistics",
         m_triangle_tree_traversal_stats.get_statistics());
+
+    vec.insert(
+        "curve trees intersection statistics",
+        m_curve_tree_traversal_stats.get_statistics());
 #endif
 
     vec.insert(
@@ -48,10 +48,12 @@
 
 // Standard headers.
 #include <cstddef>
+#include <memory>
 
 // Forward declarations.
 namespace foundation    { class StatisticsVector; }
 namespace renderer      { class AssemblyInstance; }
+namespace renderer      { class RayDumpStream; }
 namespace renderer      { class ShadingRay; }
 namespace renderer      { class TextureCache; }
 namespace renderer      { class TraceContext; }
@@ -73,6 +75,9 @@ class Intersector
         TextureCache&                       texture_cache,
         const bool                          report_self_intersections = false);
 
+    // Destructor.
+    ~Intersector();
+
     // Refine the location of a point on a surface.
     static foundation::Vector3d refine(
         const TriangleSupportPlaneType&     support_plane,
@@ -98,11 +103,58 @@ class Intersector
         ShadingPoint&                       shading_point,
         const ShadingPoint*                 parent_shading_point = nullptr) const;
 
-    // Trace a world space probe ray through the scene.
+    // Trace a world space probe ray through the scene. If 'occluder' is not null,
+    // the occluder found by the ray, if any, is recorded into it.
     bool trace_probe(
         const ShadingRay&                   ray,
+        const ShadingPoint*                 parent_shading_point = nullptr,
+        ProbeOccluder*                      occluder = nullptr) const;
+
+    // Intersect a world space probe ray with an occluder recorded by trace_probe().
+    // Returns false if the ray misses the occluder, in which case it must be traced.
+    bool trace_probe_occluder(
+        const ShadingRay&                   ray,
+        const ProbeOccluder&                occluder,
+        const ShadingPoint*                 parent_shading_point = nullptr) const;
+
+    // Trace a world space ray against the assembly instance that 'owner' lies on only,
+    // skipping the traversal of the assembly tree and reusing the assembly instance
+    // transform cached in 'owner'. This is meant for rays that cannot leave the object
+    // 'owner' belongs to, such as subsurface rays.
+    bool trace_local(
+        const ShadingRay&                   ray,
+        const ShadingPoint&                 owner,
+        ShadingPoint&                       shading_point,
         const ShadingPoint*                 parent_shading_point = nullptr) const;
 
+    // Trace a set of world space rays against the assembly instance that 'owner' lies on.
+    // 'parent_shading_points' is either null or an array of 'ray_count' (possibly null)
+    // pointers to the parent shading points.
+    void trace_local(
+        const ShadingRay*                   rays,
+        const ShadingPoint&                 owner,
+        ShadingPoint*                       shading_points,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points = nullptr) const;
+
+    // Trace a set of world space rays through the scene. The rays are traced in packets
+    // that share assembly tree traversal, so they should be coherent (e.g. primary rays
+    // or shadow rays from a single tile). 'parent_shading_points' is either null or an
+    // array of 'ray_count' (possibly null) pointers to the parent shading points.
+    void trace(
+        const ShadingRay*                   rays,
+        ShadingPoint*                       shading_points,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points = nullptr) const;
+
+    // Trace a set of world space probe rays through the scene, in packets.
+    // Whether each ray hit something is returned in 'hits'.
+    void trace_probe(
+        const ShadingRay*                   rays,
+        bool*                               hits,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points = nullptr) const;
+
     // Manufacture a triangle hit "by hand".
     // There is no restriction placed on the shading point passed to this method.
     // For instance it may have been previously initialized and used.
@@ -144,6 +196,9 @@ class Intersector
     foundation::StatisticsVector get_statistics() const;
 
   private:
+    // Number of ray types counted separately, one per visibility flag.
+    enum { RayTypeCount = 10 };
+
     const TraceContext&                             m_trace_context;
     TextureCache&                                   m_texture_cache;
     const bool                                      m_report_self_intersections;
@@ -157,11 +212,73 @@ class Intersector
     // Intersection statistics.
     mutable foundation::uint64                      m_shading_ray_count;
     mutable foundation::uint64                      m_probe_ray_count;
+    mutable foundation::uint64                      m_local_ray_count;
+    mutable foundation::uint64                      m_ray_packet_count;
+    mutable foundation::uint64                      m_ray_type_counts[RayTypeCount];
+    mutable foundation::uint64                      m_volume_ray_count;
 #ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
     mutable foundation::bvh::TraversalStatistics    m_assembly_tree_traversal_stats;
     mutable foundation::bvh::TraversalStatistics    m_triangle_tree_traversal_stats;
     mutable foundation::bvh::TraversalStatistics    m_curve_tree_traversal_stats;
 #endif
+
+    // Recorder of the traced rays, if the trace context records a ray dump.
+    std::unique_ptr<RayDumpStream>                  m_ray_dump_stream;
+
+    void update_ray_type_statistics(const ShadingRay& ray) const;
+
+    bool do_trace(
+        const ShadingRay&                   ray,
+        ShadingPoint&                       shading_point,
+        const ShadingPoint*                 parent_shading_point) const;
+
+    bool do_trace_probe(
+        const ShadingRay&                   ray,
+        const ShadingPoint*                 parent_shading_point,
+        ProbeOccluder*                      occluder) const;
+
+    void do_trace(
+        const ShadingRay*                   rays,
+        ShadingPoint*                       shading_points,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points) const;
+
+    void do_trace_probe(
+        const ShadingRay*                   rays,
+        bool*                               hits,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points) const;
+
+    void trace_packet(
+        const ShadingRay*                   rays,
+        ShadingPoint*                       shading_points,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points) const;
+
+    void trace_probe_packet(
+        const ShadingRay*                   rays,
+        bool*                               hits,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points) const;
+
+#if defined APPLESEED_WITH_EMBREE || defined APPLESEED_WITH_GPU
+    // Trace batches of rays with a backend that handles the whole scene.
+    template <typename Scene>
+    void trace_stream(
+        const Scene&                        scene,
+        const ShadingRay*                   rays,
+        ShadingPoint*                       shading_points,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points) const;
+
+    template <typename Scene>
+    void trace_probe_stream(
+        const Scene&                        scene,
+        const ShadingRay*                   rays,
+        bool*                               hits,
+        const size_t                        ray_count,
+        const ShadingPoint* const*          parent_shading_points) const;
+#endif
 };
 
 }   // namespace renderer
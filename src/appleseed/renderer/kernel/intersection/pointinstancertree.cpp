@@ -0,0 +1,169 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "pointinstancertree.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/pointinstancer.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/permutation.h"
+#include "foundation/math/transform.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/alignedallocator.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/string.h"
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// PointInstancerTree class implementation.
+//
+
+PointInstancerTree::PointInstancerTree(const PointInstancer& point_instancer)
+  : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
+  , m_point_instancer(point_instancer)
+  , m_version_id(point_instancer.get_version_id())
+  , m_prototype_version_ids(collect_prototype_version_ids())
+{
+    m_bbox.invalidate();
+
+    // Compute the local bounding boxes of the prototypes once.
+    const size_t prototype_count = point_instancer.get_prototype_count();
+    vector<GAABB3> prototype_bboxes(prototype_count);
+    for (size_t i = 0; i < prototype_count; ++i)
+    {
+        prototype_bboxes[i] =
+            point_instancer.get_prototype_instance(i).get_assembly().compute_non_hierarchical_local_bbox();
+    }
+
+    // Collect the instances of non-empty prototypes and their bounding boxes.
+    const size_t instance_count = point_instancer.get_instance_count();
+    vector<uint32> instance_indices;
+    vector<AABB3d> instance_bboxes;
+    instance_indices.reserve(instance_count);
+    instance_bboxes.reserve(instance_count);
+
+    for (size_t i = 0; i < instance_count; ++i)
+    {
+        const GAABB3& prototype_bbox = prototype_bboxes[point_instancer.get_instance_prototype(i)];
+
+        if (!prototype_bbox.is_valid())
+            continue;
+
+        AABB3d instance_bbox(point_instancer.get_instance_transform(i).to_parent(AABB3d(prototype_bbox)));
+        instance_bbox.robust_grow(1.0e-15);
+
+        instance_indices.push_back(static_cast<uint32>(i));
+        instance_bboxes.push_back(instance_bbox);
+        m_bbox.insert(instance_bbox);
+    }
+
+    if (instance_indices.empty())
+        return;
+
+    RENDERER_LOG_INFO(
+        "building point instancer tree for point instancer \"%s\" (%s %s)...",
+        point_instancer.get_path().c_str(),
+        pretty_int(instance_indices.size()).c_str(),
+        plural(instance_indices.size(), "instance").c_str());
+
+    // Create the partitioner.
+    typedef bvh::SAHPartitioner<vector<AABB3d>> Partitioner;
+    Partitioner partitioner(
+        instance_bboxes,
+        PointInstancerTreeMaxLeafSize,
+        PointInstancerTreeInteriorNodeTraversalCost,
+        PointInstancerTreeInstanceIntersectionCost);
+
+    // Build the tree.
+    typedef bvh::Builder<PointInstancerTree, Partitioner> Builder;
+    Builder builder;
+    builder.build<DefaultWallclockTimer>(
+        *this,
+        partitioner,
+        instance_indices.size(),
+        PointInstancerTreeMaxLeafSize);
+
+    // Reorder the instances according to the tree ordering.
+    const vector<size_t>& ordering = partitioner.get_item_ordering();
+    assert(ordering.size() == instance_indices.size());
+    m_instance_indices.resize(ordering.size());
+    for (size_t i = 0, e = ordering.size(); i < e; ++i)
+        m_instance_indices[i] = instance_indices[ordering[i]];
+
+    Statistics statistics;
+    statistics.insert_time("build time", builder.get_build_time());
+    statistics.merge(bvh::TreeStatistics<PointInstancerTree>(*this, m_bbox));
+
+    RENDERER_LOG_DEBUG("%s",
+        StatisticsVector::make(
+            "point instancer tree statistics",
+            statistics).to_string().c_str());
+}
+
+bool PointInstancerTree::is_up_to_date() const
+{
+    return
+        m_version_id == m_point_instancer.get_version_id() &&
+        m_prototype_version_ids == collect_prototype_version_ids();
+}
+
+size_t PointInstancerTree::get_memory_size() const
+{
+    return
+          TreeType::get_memory_size()
+        - sizeof(*static_cast<const TreeType*>(this))
+        + sizeof(*this)
+        + m_prototype_version_ids.capacity() * sizeof(VersionID)
+        + m_instance_indices.capacity() * sizeof(uint32);
+}
+
+vector<VersionID> PointInstancerTree::collect_prototype_version_ids() const
+{
+    const size_t prototype_count = m_point_instancer.get_prototype_count();
+
+    vector<VersionID> version_ids(prototype_count);
+    for (size_t i = 0; i < prototype_count; ++i)
+        version_ids[i] = m_point_instancer.get_prototype_instance(i).get_assembly().get_version_id();
+
+    return version_ids;
+}
+
+}   // namespace renderer
@@ -0,0 +1,225 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/shading/shadingray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/bvh.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/alignedvector.h"
+#include "foundation/utility/version.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class PointInstancer; }
+
+namespace renderer
+{
+
+//
+// A BVH over the instances of a point instancer, in the space of the point instancer.
+//
+
+class PointInstancerTree
+  : public foundation::bvh::Tree<
+               foundation::AlignedVector<
+                   foundation::bvh::Node<foundation::AABB3d>
+               >
+           >
+{
+  public:
+    // Constructor, builds the tree for a given point instancer.
+    // The prototypes of the point instancer must be bound.
+    explicit PointInstancerTree(const PointInstancer& point_instancer);
+
+    // Return true if the tree is still valid for its point instancer.
+    bool is_up_to_date() const;
+
+    // Return the point instancer this tree was built for.
+    const PointInstancer& get_point_instancer() const;
+
+    // Return the number of instances in the tree.
+    size_t get_instance_count() const;
+
+    // Return the index of the instance stored at a given position in the tree.
+    size_t get_instance_index(const size_t item_index) const;
+
+    // Return the bounding box of all instances, in point instancer space.
+    const foundation::AABB3d& get_bbox() const;
+
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
+  private:
+    const PointInstancer&                   m_point_instancer;
+    foundation::VersionID                   m_version_id;
+    std::vector<foundation::VersionID>      m_prototype_version_ids;
+    std::vector<foundation::uint32>         m_instance_indices;
+    foundation::AABB3d                      m_bbox;
+
+    std::vector<foundation::VersionID> collect_prototype_version_ids() const;
+};
+
+
+//
+// Point instancer leaf visitor, used during tree intersection.
+//
+// The InstanceVisitor class must conform to the following prototype:
+//
+//      class InstanceVisitor
+//      {
+//        public:
+//          // Intersect a given instance. Return whether traversal should continue or not.
+//          // 'distance' should be set to the distance to the closest hit so far.
+//          bool visit_instance(
+//              const size_t    instance_index,
+//              double&         distance);
+//      };
+//
+
+template <typename InstanceVisitor>
+class PointInstancerLeafVisitor
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    PointInstancerLeafVisitor(
+        const PointInstancerTree&                   tree,
+        InstanceVisitor&                            instance_visitor);
+
+    // Visit a leaf.
+    bool visit(
+        const PointInstancerTree::NodeType&         node,
+        const ShadingRay&                           ray,
+        const ShadingRay::RayInfoType&              ray_info,
+        double&                                     distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+        , foundation::bvh::TraversalStatistics&     stats
+#endif
+        );
+
+  private:
+    const PointInstancerTree&                       m_tree;
+    InstanceVisitor&                                m_instance_visitor;
+};
+
+
+//
+// PointInstancerTree class implementation.
+//
+
+inline const PointInstancer& PointInstancerTree::get_point_instancer() const
+{
+    return m_point_instancer;
+}
+
+inline size_t PointInstancerTree::get_instance_count() const
+{
+    return m_instance_indices.size();
+}
+
+inline size_t PointInstancerTree::get_instance_index(const size_t item_index) const
+{
+    assert(item_index < m_instance_indices.size());
+    return m_instance_indices[item_index];
+}
+
+inline const foundation::AABB3d& PointInstancerTree::get_bbox() const
+{
+    return m_bbox;
+}
+
+
+//
+// PointInstancerLeafVisitor class implementation.
+//
+
+template <typename InstanceVisitor>
+inline PointInstancerLeafVisitor<InstanceVisitor>::PointInstancerLeafVisitor(
+    const PointInstancerTree&                       tree,
+    InstanceVisitor&                                instance_visitor)
+  : m_tree(tree)
+  , m_instance_visitor(instance_visitor)
+{
+}
+
+template <typename InstanceVisitor>
+inline bool PointInstancerLeafVisitor<InstanceVisitor>::visit(
+    const PointInstancerTree::NodeType&             node,
+    const ShadingRay&                               ray,
+    const ShadingRay::RayInfoType&                  ray_info,
+    double&                                         distance
+#ifdef FOUNDATION_BVH_ENABLE_TRAVERSAL_STATS
+    , foundation::bvh::TraversalStatistics&         stats
+#endif
+    )
+{
+    distance = ray.m_tmax;
+
+    const size_t item_begin = node.get_item_index();
+    const size_t item_end = item_begin + node.get_item_count();
+
+    for (size_t i = item_begin; i < item_end; ++i)
+    {
+        FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(1));
+
+        if (!m_instance_visitor.visit_instance(m_tree.get_instance_index(i), distance))
+            return false;
+    }
+
+    // Continue traversal.
+    return true;
+}
+
+
+//
+// Point instancer tree intersector.
+//
+
+template <typename InstanceVisitor>
+struct PointInstancerTreeIntersector
+{
+    typedef foundation::bvh::Intersector<
+        PointInstancerTree,
+        PointInstancerLeafVisitor<InstanceVisitor>,
+        ShadingRay,
+        PointInstancerTreeStackSize
+    > Type;
+};
+
+}   // namespace renderer
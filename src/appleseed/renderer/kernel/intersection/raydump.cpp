@@ -0,0 +1,605 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "raydump.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/scene/objectinstance.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/exceptions/exception.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/timers.h"
+#include "foundation/utility/bufferedfile.h"
+#include "foundation/utility/stopwatch.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    const char Signature[7] = { 'R', 'A', 'Y', 'D', 'U', 'M', 'P' };
+
+    // Version of the ray dump file format written by this code.
+    const uint16 Version = 1;
+
+    // Closest hits found at a relative distance above this threshold from the recorded ones are reported.
+    const double DistanceTolerance = 1.0e-4;
+
+    template <typename File>
+    void write_record(File& file, const RayDumpRecord& record)
+    {
+        checked_write(file, record.m_org);
+        checked_write(file, record.m_dir);
+        checked_write(file, record.m_tmin);
+        checked_write(file, record.m_tmax);
+        checked_write(file, record.m_absolute_time);
+        checked_write(file, record.m_normalized_time);
+        checked_write(file, record.m_flags);
+        checked_write(file, record.m_depth);
+        checked_write(file, record.m_kind);
+        checked_write(file, record.m_hit_distance);
+    }
+
+    template <typename File>
+    void read_record(File& file, RayDumpRecord& record)
+    {
+        checked_read(file, record.m_org);
+        checked_read(file, record.m_dir);
+        checked_read(file, record.m_tmin);
+        checked_read(file, record.m_tmax);
+        checked_read(file, record.m_absolute_time);
+        checked_read(file, record.m_normalized_time);
+        checked_read(file, record.m_flags);
+        checked_read(file, record.m_depth);
+        checked_read(file, record.m_kind);
+        checked_read(file, record.m_hit_distance);
+    }
+}
+
+
+//
+// RayDumpRecord class implementation.
+//
+
+RayDumpRecord RayDumpRecord::make(
+    const ShadingRay&           ray,
+    const ShadingPoint*         parent_shading_point,
+    const Kind                  kind,
+    const double                hit_distance)
+{
+    RayDumpRecord record;
+
+    record.m_org = ray.m_org;
+
+    if (parent_shading_point &&
+        parent_shading_point->hit_surface() &&
+        parent_shading_point->get_object_instance().get_ray_bias_method() == ObjectInstance::RayBiasMethodNone)
+    {
+        // The intersector starts rays leaving a surface from the offset point of the surface.
+        const Transformd& transform = parent_shading_point->get_assembly_instance_transform();
+        record.m_org =
+            transform.point_to_parent(
+                parent_shading_point->get_offset_point(transform.vector_to_local(ray.m_dir)));
+    }
+
+    record.m_dir = ray.m_dir;
+    record.m_tmin = ray.m_tmin;
+    record.m_tmax = ray.m_tmax;
+    record.m_absolute_time = ray.m_time.m_absolute;
+    record.m_normalized_time = ray.m_time.m_normalized;
+    record.m_flags = ray.m_flags;
+    record.m_depth = ray.m_depth;
+    record.m_kind = static_cast<uint8>(kind);
+    record.m_hit_distance = static_cast<float>(hit_distance);
+
+    return record;
+}
+
+ShadingRay RayDumpRecord::get_ray() const
+{
+    ShadingRay::Time time;
+    time.m_absolute = m_absolute_time;
+    time.m_normalized = m_normalized_time;
+
+    return
+        ShadingRay(
+            m_org,
+            m_dir,
+            m_tmin,
+            m_tmax,
+            time,
+            m_flags,
+            m_depth);
+}
+
+
+//
+// RayDumpWriter class implementation.
+//
+
+struct RayDumpWriter::Impl
+{
+    string                                  m_path;
+    VisibilityFlags::Type                   m_ray_types;
+    BufferedFile                            m_file;
+    unique_ptr<LZ4CompressedWriterAdapter>  m_writer;
+    boost::mutex                            m_mutex;
+    uint64                                  m_ray_count;
+    bool                                    m_failed;
+};
+
+RayDumpWriter::RayDumpWriter()
+  : impl(new Impl())
+{
+    impl->m_ray_types = VisibilityFlags::AllRays;
+    impl->m_ray_count = 0;
+    impl->m_failed = false;
+}
+
+RayDumpWriter::~RayDumpWriter()
+{
+    close();
+    delete impl;
+}
+
+bool RayDumpWriter::open(
+    const char*                 path,
+    const VisibilityFlags::Type ray_types)
+{
+    close();
+
+    impl->m_path = path;
+    impl->m_ray_types = ray_types;
+    impl->m_ray_count = 0;
+    impl->m_failed = false;
+
+    if (!impl->m_file.open(path, BufferedFile::BinaryType, BufferedFile::WriteMode))
+        return false;
+
+    try
+    {
+        checked_write(impl->m_file, Signature, sizeof(Signature));
+        checked_write(impl->m_file, Version);
+    }
+    catch (const Exception&)
+    {
+        impl->m_file.close();
+        return false;
+    }
+
+    impl->m_writer.reset(new LZ4CompressedWriterAdapter(impl->m_file, 256 * 1024));
+
+    return true;
+}
+
+bool RayDumpWriter::close()
+{
+    if (!impl->m_file.is_open())
+        return true;
+
+    // Mark the end of the file with an empty batch.
+    try
+    {
+        checked_write(*impl->m_writer, uint32(0));
+    }
+    catch (const Exception&)
+    {
+        impl->m_failed = true;
+    }
+
+    // Deleting the adapter flushes the compressed data.
+    impl->m_writer.reset();
+
+    if (!impl->m_file.close())
+        impl->m_failed = true;
+
+    return !impl->m_failed;
+}
+
+bool RayDumpWriter::is_open() const
+{
+    return impl->m_file.is_open();
+}
+
+VisibilityFlags::Type RayDumpWriter::get_ray_types() const
+{
+    return impl->m_ray_types;
+}
+
+void RayDumpWriter::write(
+    const RayDumpRecord*        records,
+    const size_t                count)
+{
+    if (count == 0)
+        return;
+
+    boost::mutex::scoped_lock lock(impl->m_mutex);
+
+    if (!impl->m_writer || impl->m_failed)
+        return;
+
+    try
+    {
+        checked_write(*impl->m_writer, static_cast<uint32>(count));
+
+        for (size_t i = 0; i < count; ++i)
+            write_record(*impl->m_writer, records[i]);
+
+        impl->m_ray_count += count;
+    }
+    catch (const Exception&)
+    {
+        RENDERER_LOG_ERROR("failed to write ray dump file %s, ray recording stopped.", impl->m_path.c_str());
+        impl->m_failed = true;
+    }
+}
+
+uint64 RayDumpWriter::get_ray_count() const
+{
+    return impl->m_ray_count;
+}
+
+
+//
+// RayDumpReader class implementation.
+//
+
+struct RayDumpReader::Impl
+{
+    BufferedFile                            m_file;
+    unique_ptr<LZ4CompressedReaderAdapter>  m_reader;
+    size_t                                  m_remaining_batch_size;
+};
+
+RayDumpReader::RayDumpReader()
+  : impl(new Impl())
+{
+    impl->m_remaining_batch_size = 0;
+}
+
+RayDumpReader::~RayDumpReader()
+{
+    close();
+    delete impl;
+}
+
+bool RayDumpReader::open(const char* path)
+{
+    close();
+
+    if (!impl->m_file.open(path, BufferedFile::BinaryType, BufferedFile::ReadMode))
+        return false;
+
+    try
+    {
+        char signature[sizeof(Signature)];
+        checked_read(impl->m_file, signature, sizeof(signature));
+
+        uint16 version;
+        checked_read(impl->m_file, version);
+
+        if (memcmp(signature, Signature, sizeof(Signature)) != 0 || version != Version)
+        {
+            impl->m_file.close();
+            return false;
+        }
+    }
+    catch (const Exception&)
+    {
+        impl->m_file.close();
+        return false;
+    }
+
+    impl->m_reader.reset(new LZ4CompressedReaderAdapter(impl->m_file));
+    impl->m_remaining_batch_size = 0;
+
+    return true;
+}
+
+void RayDumpReader::close()
+{
+    impl->m_reader.reset();
+
+    if (impl->m_file.is_open())
+        impl->m_file.close();
+}
+
+size_t RayDumpReader::read(
+    RayDumpRecord*              records,
+    const size_t                max_count)
+{
+    if (!impl->m_reader)
+        return 0;
+
+    size_t count = 0;
+
+    try
+    {
+        while (count < max_count)
+        {
+            if (impl->m_remaining_batch_size == 0)
+            {
+                uint32 batch_size;
+                checked_read(*impl->m_reader, batch_size);
+
+                // An empty batch marks the end of the file.
+                if (batch_size == 0)
+                {
+                    close();
+                    break;
+                }
+
+                impl->m_remaining_batch_size = batch_size;
+            }
+
+            read_record(*impl->m_reader, records[count++]);
+            --impl->m_remaining_batch_size;
+        }
+    }
+    catch (const Exception&)
+    {
+        // Truncated file: keep the records read so far.
+        RENDERER_LOG_WARNING("ray dump file is truncated.");
+        close();
+    }
+
+    return count;
+}
+
+
+//
+// RayDumpStream class implementation.
+//
+
+RayDumpStream::RayDumpStream(RayDumpWriter& writer)
+  : m_writer(writer)
+  , m_ray_types(writer.get_ray_types())
+{
+}
+
+RayDumpStream::~RayDumpStream()
+{
+    flush();
+}
+
+void RayDumpStream::flush()
+{
+    m_writer.write(m_records.data(), m_records.size());
+    m_records.clear();
+}
+
+
+//
+// RayDumpReplayStatistics class implementation.
+//
+
+RayDumpReplayStatistics::Counts::Counts()
+  : m_ray_count(0)
+  , m_hit_count(0)
+  , m_hit_mismatch_count(0)
+  , m_distance_mismatch_count(0)
+  , m_seconds(0.0)
+{
+}
+
+void RayDumpReplayStatistics::Counts::add(const Counts& rhs)
+{
+    m_ray_count += rhs.m_ray_count;
+    m_hit_count += rhs.m_hit_count;
+    m_hit_mismatch_count += rhs.m_hit_mismatch_count;
+    m_distance_mismatch_count += rhs.m_distance_mismatch_count;
+    m_seconds += rhs.m_seconds;
+}
+
+
+//
+// Ray dump replay.
+//
+
+namespace
+{
+    void compare(
+        const RayDumpRecord&                record,
+        const bool                          hit,
+        const double                        hit_distance,
+        RayDumpReplayStatistics::Counts&    counts)
+    {
+        ++counts.m_ray_count;
+
+        if (hit)
+            ++counts.m_hit_count;
+
+        if (hit != record.is_hit())
+            ++counts.m_hit_mismatch_count;
+        else if (hit && record.m_kind == RayDumpRecord::Trace)
+        {
+            const double recorded_distance = static_cast<double>(record.m_hit_distance);
+            if (abs(hit_distance - recorded_distance) > DistanceTolerance * max(recorded_distance, 1.0))
+                ++counts.m_distance_mismatch_count;
+        }
+    }
+
+    // Trace a run of rays of the same kind and type.
+    void replay_run(
+        const Intersector&                  intersector,
+        const RayDumpRecord*                records,
+        const size_t                        count,
+        const size_t                        batch_size,
+        vector<ShadingRay>&                 rays,
+        ShadingPoint*                       shading_points,
+        bool*                               hits,
+        RayDumpReplayStatistics::Counts&    counts)
+    {
+        const RayDumpRecord::Kind kind = static_cast<RayDumpRecord::Kind>(records[0].m_kind);
+
+        rays.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            rays[i] = records[i].get_ray();
+
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        if (kind == RayDumpRecord::Trace)
+        {
+            for (size_t i = 0; i < count; ++i)
+                shading_points[i].clear();
+
+            if (batch_size > 1)
+            {
+                for (size_t i = 0; i < count; i += batch_size)
+                    intersector.trace(&rays[i], &shading_points[i], min(batch_size, count - i));
+            }
+            else
+            {
+                for (size_t i = 0; i < count; ++i)
+                    intersector.trace(rays[i], shading_points[i]);
+            }
+        }
+        else
+        {
+            if (batch_size > 1)
+            {
+                for (size_t i = 0; i < count; i += batch_size)
+                    intersector.trace_probe(&rays[i], &hits[i], min(batch_size, count - i));
+            }
+            else
+            {
+                for (size_t i = 0; i < count; ++i)
+                    hits[i] = intersector.trace_probe(rays[i]);
+            }
+        }
+
+        stopwatch.measure();
+        counts.m_seconds += stopwatch.get_seconds();
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (kind == RayDumpRecord::Trace)
+            {
+                const ShadingPoint& shading_point = shading_points[i];
+                const bool hit = shading_point.hit_surface();
+                compare(records[i], hit, hit ? shading_point.get_distance() : 0.0, counts);
+            }
+            else compare(records[i], hits[i], 0.0, counts);
+        }
+    }
+}
+
+bool replay_ray_dump(
+    const char*                     path,
+    const TraceContext&             trace_context,
+    const size_t                    batch_size,
+    RayDumpReplayStatistics&        stats)
+{
+    RayDumpReader reader;
+    if (!reader.open(path))
+        return false;
+
+    TextureStore texture_store(trace_context.get_scene());
+    TextureCache texture_cache(texture_store);
+    const Intersector intersector(trace_context, texture_cache);
+
+    // Rays are read in chunks and traced in runs of consecutive rays of the same kind and type.
+    const size_t ChunkSize = 64 * 1024;
+    const size_t MaxRunSize = max<size_t>(batch_size, 256);
+
+    vector<RayDumpRecord> records(ChunkSize);
+    vector<ShadingRay> rays;
+    unique_ptr<ShadingPoint[]> shading_points(new ShadingPoint[MaxRunSize]);
+    unique_ptr<bool[]> hits(new bool[MaxRunSize]);
+
+    stats = RayDumpReplayStatistics();
+
+    while (true)
+    {
+        const size_t count = reader.read(&records[0], ChunkSize);
+        if (count == 0)
+            break;
+
+        for (size_t begin = 0; begin < count; )
+        {
+            const RayDumpRecord& first = records[begin];
+
+            size_t end = begin + 1;
+            while (end < count &&
+                   end - begin < MaxRunSize &&
+                   records[end].m_kind == first.m_kind &&
+                   records[end].m_flags == first.m_flags)
+                ++end;
+
+            RayDumpReplayStatistics::Counts counts;
+            replay_run(
+                intersector,
+                &records[begin],
+                end - begin,
+                batch_size,
+                rays,
+                shading_points.get(),
+                hits.get(),
+                counts);
+
+            stats.m_total.add(counts);
+
+            // Rays almost always carry a single visibility flag; others only contribute to the totals.
+            const VisibilityFlags::Type ray_flags = first.m_flags & ~VisibilityFlags::ProxyRay;
+            if (ray_flags != 0 && is_pow2(ray_flags))
+            {
+                const size_t ray_type = log2_int(ray_flags);
+                if (ray_type < RayDumpReplayStatistics::RayTypeCount)
+                    stats.m_ray_types[ray_type].add(counts);
+            }
+
+            begin = end;
+        }
+    }
+
+    return true;
+}
+
+}   // namespace renderer
@@ -0,0 +1,272 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class ShadingPoint; }
+namespace renderer  { class TraceContext; }
+
+namespace renderer
+{
+
+//
+// A ray dump holds the rays traced through a scene while rendering, together with
+// the result of their intersection with the scene, so that the same workload can
+// later be traced again with other intersection backends to compare their speed
+// and their results.
+//
+// Ray dump files start with the signature "RAYDUMP" and a version number, followed
+// by LZ4-compressed batches of ray records. The end of the file is marked by an
+// empty batch.
+//
+
+struct RayDumpRecord
+{
+    enum Kind
+    {
+        Trace = 0,                                  // closest hit ray
+        Probe = 1                                   // any hit ray
+    };
+
+    foundation::Vector3d        m_org;              // world space origin
+    foundation::Vector3d        m_dir;              // world space direction, unit length
+    double                      m_tmin;
+    double                      m_tmax;
+    float                       m_absolute_time;
+    float                       m_normalized_time;
+    VisibilityFlags::Type       m_flags;
+    foundation::uint16          m_depth;
+    foundation::uint8           m_kind;
+    float                       m_hit_distance;     // distance to the closest hit, 0 for probe rays, negative for misses
+
+    // Make a record out of a traced ray. Rays leaving a surface are recorded from the
+    // offset point of their parent shading point since the latter cannot be stored.
+    static RayDumpRecord make(
+        const ShadingRay&       ray,
+        const ShadingPoint*     parent_shading_point,
+        const Kind              kind,
+        const double            hit_distance);
+
+    // Rebuild the ray of this record.
+    ShadingRay get_ray() const;
+
+    // Return true if the recorded ray hit the scene.
+    bool is_hit() const;
+};
+
+
+//
+// Write ray dump files.
+//
+
+class APPLESEED_DLLSYMBOL RayDumpWriter
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    RayDumpWriter();
+
+    // Destructor, closes the file if it is still open.
+    ~RayDumpWriter();
+
+    // Create a ray dump file. Only rays carrying at least one of the visibility flags
+    // in 'ray_types' are recorded. Return false if the file could not be created.
+    bool open(
+        const char*                 path,
+        const VisibilityFlags::Type ray_types = VisibilityFlags::AllRays);
+
+    // Terminate and close the file. Return false if an I/O error occurred.
+    bool close();
+
+    // Return true if the file is open.
+    bool is_open() const;
+
+    // Return the visibility flags of the recorded rays.
+    VisibilityFlags::Type get_ray_types() const;
+
+    // Append a batch of records to the file. Thread-safe.
+    void write(
+        const RayDumpRecord*        records,
+        const size_t                count);
+
+    // Return the number of rays written so far.
+    foundation::uint64 get_ray_count() const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+
+//
+// Read ray dump files.
+//
+
+class APPLESEED_DLLSYMBOL RayDumpReader
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    RayDumpReader();
+
+    // Destructor, closes the file if it is still open.
+    ~RayDumpReader();
+
+    // Open a ray dump file. Return false if the file could not be opened or is not a ray dump.
+    bool open(const char* path);
+
+    // Close the file.
+    void close();
+
+    // Read up to 'max_count' records. Return the number of records read, 0 at the end of the file.
+    size_t read(
+        RayDumpRecord*              records,
+        const size_t                max_count);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+
+//
+// A thread-local buffer of ray records, flushed to a ray dump writer in batches.
+//
+
+class RayDumpStream
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    explicit RayDumpStream(RayDumpWriter& writer);
+
+    // Destructor, flushes the remaining records.
+    ~RayDumpStream();
+
+    // Record a traced ray if its type is recorded.
+    void record(
+        const ShadingRay&           ray,
+        const ShadingPoint*         parent_shading_point,
+        const RayDumpRecord::Kind   kind,
+        const double                hit_distance);
+
+    // Write the buffered records to the ray dump.
+    void flush();
+
+  private:
+    enum { MaxBufferedRecordCount = 4096 };
+
+    RayDumpWriter&                  m_writer;
+    const VisibilityFlags::Type     m_ray_types;
+    std::vector<RayDumpRecord>      m_records;
+};
+
+
+//
+// Replay a ray dump against the acceleration structures of a trace context.
+//
+
+struct RayDumpReplayStatistics
+{
+    // Number of ray types counted separately, one per visibility flag.
+    enum { RayTypeCount = 10 };
+
+    struct Counts
+    {
+        foundation::uint64          m_ray_count;
+        foundation::uint64          m_hit_count;
+        foundation::uint64          m_hit_mismatch_count;       // rays that hit where the recorded ray missed, or vice versa
+        foundation::uint64          m_distance_mismatch_count;  // closest hits found at a different distance than recorded
+        double                      m_seconds;                  // time spent tracing
+
+        Counts();
+
+        void add(const Counts& rhs);
+    };
+
+    Counts                          m_total;
+    Counts                          m_ray_types[RayTypeCount];  // rays carrying a single visibility flag only
+};
+
+// Trace all the rays of a ray dump file, one at a time or in batches of 'batch_size'
+// rays through the batch interface of the intersector if 'batch_size' is greater than
+// one. Return false if the file could not be read.
+APPLESEED_DLLSYMBOL bool replay_ray_dump(
+    const char*                     path,
+    const TraceContext&             trace_context,
+    const size_t                    batch_size,
+    RayDumpReplayStatistics&        stats);
+
+
+//
+// RayDumpRecord class implementation.
+//
+
+inline bool RayDumpRecord::is_hit() const
+{
+    return m_hit_distance >= 0.0f;
+}
+
+
+//
+// RayDumpStream class implementation.
+//
+
+inline void RayDumpStream::record(
+    const ShadingRay&               ray,
+    const ShadingPoint*             parent_shading_point,
+    const RayDumpRecord::Kind       kind,
+    const double                    hit_distance)
+{
+    if ((ray.m_flags & m_ray_types) == 0)
+        return;
+
+    m_records.push_back(RayDumpRecord::make(ray, parent_shading_point, kind, hit_distance));
+
+    if (m_records.size() == MaxBufferedRecordCount)
+        flush();
+}
+
+}   // namespace renderer
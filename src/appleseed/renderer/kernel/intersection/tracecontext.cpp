@@ -42,6 +42,9 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/bvh.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -59,6 +62,7 @@ namespace renderer
 TraceContext::TraceContext(const Scene& scene)
   : m_scene(scene)
   , m_assembly_tree(new AssemblyTree(scene))
+  , m_ray_dump_writer(nullptr)
 {
     RENDERER_LOG_DEBUG(
         "data structures size:\n"
@@ -86,6 +90,16 @@ void TraceContext::update()
     m_assembly_tree->update();
 }
 
+Dictionary TraceContext::get_tree_statistics() const
+{
+    return m_assembly_tree->get_tree_statistics().to_dictionary();
+}
+
+void TraceContext::print_tree_statistics(Logger& logger) const
+{
+    LOG_INFO(logger, "%s", m_assembly_tree->get_tree_statistics().to_string().c_str());
+}
+
 #ifdef APPLESEED_WITH_EMBREE
 
 void TraceContext::set_use_embree(const bool value)
@@ -93,6 +107,25 @@ void TraceContext::set_use_embree(const bool value)
     m_assembly_tree->set_use_embree(value);
 }
 
+void TraceContext::set_use_embree_instancing(const bool value)
+{
+    m_assembly_tree->set_use_embree_instancing(value);
+}
+
+void TraceContext::set_embree_scene_settings(const EmbreeSceneSettings& settings)
+{
+    m_assembly_tree->set_embree_scene_settings(settings);
+}
+
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+
+void TraceContext::set_use_gpu(const bool value)
+{
+    m_assembly_tree->set_use_gpu(value);
+}
+
 #endif
 
 }   // namespace renderer
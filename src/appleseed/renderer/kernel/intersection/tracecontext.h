@@ -36,7 +36,11 @@
 #include "main/dllsymbol.h"
 
 // Forward declarations.
+namespace foundation  { class Dictionary; }
+namespace foundation  { class Logger; }
 namespace renderer  { class AssemblyTree; }
+namespace renderer  { struct EmbreeSceneSettings; }
+namespace renderer  { class RayDumpWriter; }
 namespace renderer  { class Scene; }
 
 namespace renderer
@@ -68,13 +72,34 @@ class APPLESEED_DLLSYMBOL TraceContext
     // Synchronize the trace context with the scene.
     void update();
 
+    // Return the statistics of the acceleration structures (SAH cost, leaf size and
+    // depth histograms, sibling overlap, memory, build time per phase) as a dictionary
+    // of per-tree dictionaries. Lazy child trees are built by this call.
+    foundation::Dictionary get_tree_statistics() const;
+
+    // Print the statistics of the acceleration structures.
+    void print_tree_statistics(foundation::Logger& logger) const;
+
+    // Set the ray dump that intersectors created from now on record their rays into, or null.
+    void set_ray_dump_writer(RayDumpWriter* writer);
+
+    // Return the ray dump that rays are recorded into, or null.
+    RayDumpWriter* get_ray_dump_writer() const;
+
 #ifdef APPLESEED_WITH_EMBREE
     void set_use_embree(const bool value);
+    void set_use_embree_instancing(const bool value);
+    void set_embree_scene_settings(const EmbreeSceneSettings& settings);
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+    void set_use_gpu(const bool value);
 #endif
 
   private:
     const Scene&    m_scene;
     AssemblyTree*   m_assembly_tree;
+    RayDumpWriter*  m_ray_dump_writer;
 };
 
 
@@ -92,4 +117,14 @@ inline const AssemblyTree& TraceContext::get_assembly_tree() const
     return *m_assembly_tree;
 }
 
+inline void TraceContext::set_ray_dump_writer(RayDumpWriter* writer)
+{
+    m_ray_dump_writer = writer;
+}
+
+inline RayDumpWriter* TraceContext::get_ray_dump_writer() const
+{
+    return m_ray_dump_writer;
+}
+
 }   // namespace renderer
@@ -0,0 +1,163 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "treememorybudget.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// TreeMemoryBudget class implementation.
+//
+
+TreeMemoryBudget::TreeMemoryBudget(const size_t max_size)
+  : m_max_size(max_size)
+  , m_size(0)
+  , m_release_count(0)
+{
+}
+
+void TreeMemoryBudget::set_max_size(const size_t max_size)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_max_size = max_size;
+}
+
+void TreeMemoryBudget::remove(const void* tree)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    const EntryMap::iterator it = m_entries.find(tree);
+
+    if (it != m_entries.end())
+    {
+        m_size -= it->second.m_size;
+        m_entries.erase(it);
+    }
+}
+
+bool TreeMemoryBudget::contains(const void* tree) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_entries.find(tree) != m_entries.end();
+}
+
+size_t TreeMemoryBudget::get_size() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_size;
+}
+
+uint64 TreeMemoryBudget::get_release_count() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_release_count;
+}
+
+void TreeMemoryBudget::insert_entry(const Entry& entry)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    // A tree that is built again replaces its previous record.
+    const EntryMap::iterator existing = m_entries.find(entry.m_tree);
+    if (existing != m_entries.end())
+    {
+        m_size -= existing->second.m_size;
+        m_entries.erase(existing);
+    }
+
+    if (m_max_size > 0 && m_size + entry.m_size > m_max_size)
+    {
+        // Sort built trees from least to most recently accessed.
+        typedef pair<uint64, EntryMap::iterator> Candidate;
+        vector<Candidate> candidates;
+        candidates.reserve(m_entries.size());
+
+        for (EntryMap::iterator i = m_entries.begin(), e = m_entries.end(); i != e; ++i)
+            candidates.emplace_back(i->second.m_get_access_stamp(i->second.m_tree), i);
+
+        sort(
+            candidates.begin(),
+            candidates.end(),
+            [](const Candidate& lhs, const Candidate& rhs) { return lhs.first < rhs.first; });
+
+        // Release trees until the new one fits. Trees in use are skipped.
+        size_t released_size = 0;
+        size_t released_count = 0;
+
+        for (const_each<vector<Candidate>> i = candidates; i; ++i)
+        {
+            if (m_size + entry.m_size <= m_max_size)
+                break;
+
+            const Entry& candidate = i->second->second;
+
+            if (candidate.m_release(candidate.m_tree))
+            {
+                m_size -= candidate.m_size;
+                released_size += candidate.m_size;
+                ++released_count;
+                m_entries.erase(i->second);
+            }
+        }
+
+        if (released_count > 0)
+        {
+            m_release_count += released_count;
+
+            RENDERER_LOG_DEBUG(
+                "released %s %s (%s) to stay within the tree memory budget of %s.",
+                pretty_uint(released_count).c_str(),
+                plural(released_count, "tree").c_str(),
+                pretty_size(released_size).c_str(),
+                pretty_size(m_max_size).c_str());
+        }
+    }
+
+    // A tree that doesn't fit on its own is kept anyway.
+    m_entries.insert(make_pair(static_cast<const void*>(entry.m_tree), entry));
+    m_size += entry.m_size;
+}
+
+}   // namespace renderer
@@ -0,0 +1,135 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/lazy.h"
+
+// Standard headers.
+#include <cstddef>
+#include <map>
+
+namespace renderer
+{
+
+//
+// Keeps track of the memory used by the lazily built child trees of an assembly tree.
+//
+// When a newly built tree makes the total exceed the budget, the least recently accessed
+// trees that no thread is currently accessing are released. Released trees are built
+// again the next time a ray enters their bounds.
+//
+// All methods are thread-safe.
+//
+
+class TreeMemoryBudget
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. A maximum size of 0 means no limit.
+    explicit TreeMemoryBudget(const size_t max_size = 0);
+
+    // Set the maximum size (in bytes) of the trees, 0 meaning no limit.
+    void set_max_size(const size_t max_size);
+
+    // Record that a tree was just built. The tree must still be accessed by the caller.
+    template <typename TreeType>
+    void insert(foundation::Lazy<TreeType>* tree, const size_t size);
+
+    // Forget about a tree, typically because it is being deleted.
+    void remove(const void* tree);
+
+    // Return true if a given tree is currently built.
+    bool contains(const void* tree) const;
+
+    // Return the total size (in bytes) of the trees currently built.
+    size_t get_size() const;
+
+    // Return the number of trees released so far to stay within the budget.
+    foundation::uint64 get_release_count() const;
+
+  private:
+    struct Entry
+    {
+        void*                   m_tree;
+        size_t                  m_size;
+        bool                    (*m_release)(void* tree);
+        foundation::uint64      (*m_get_access_stamp)(const void* tree);
+    };
+
+    typedef std::map<const void*, Entry> EntryMap;
+
+    mutable boost::mutex        m_mutex;
+    size_t                      m_max_size;
+    size_t                      m_size;
+    foundation::uint64          m_release_count;
+    EntryMap                    m_entries;
+
+    template <typename TreeType>
+    static bool release_tree(void* tree);
+
+    template <typename TreeType>
+    static foundation::uint64 get_tree_access_stamp(const void* tree);
+
+    void insert_entry(const Entry& entry);
+};
+
+
+//
+// TreeMemoryBudget class implementation.
+//
+
+template <typename TreeType>
+void TreeMemoryBudget::insert(foundation::Lazy<TreeType>* tree, const size_t size)
+{
+    Entry entry;
+    entry.m_tree = tree;
+    entry.m_size = size;
+    entry.m_release = &release_tree<TreeType>;
+    entry.m_get_access_stamp = &get_tree_access_stamp<TreeType>;
+
+    insert_entry(entry);
+}
+
+template <typename TreeType>
+bool TreeMemoryBudget::release_tree(void* tree)
+{
+    return static_cast<foundation::Lazy<TreeType>*>(tree)->release_object();
+}
+
+template <typename TreeType>
+foundation::uint64 TreeMemoryBudget::get_tree_access_stamp(const void* tree)
+{
+    return static_cast<const foundation::Lazy<TreeType>*>(tree)->get_access_stamp();
+}
+
+}   // namespace renderer
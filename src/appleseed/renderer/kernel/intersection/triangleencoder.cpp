@@ -35,8 +35,13 @@
 #include "renderer/kernel/intersection/trianglevertexinfo.h"
 
 // appleseed.foundation headers.
-#include "foundation/platform/types.h"
-#include "foundation/utility/memory.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 
 using namespace foundation;
 using namespace std;
@@ -44,6 +49,174 @@ using namespace std;
 namespace renderer
 {
 
+//
+// TriangleQuantizationGrid class implementation.
+//
+
+TriangleQuantizationGrid::TriangleQuantizationGrid()
+  : m_origin(GScalar(0.0))
+  , m_cell_size(GScalar(1.0))
+  , m_rcp_cell_size(GScalar(1.0))
+{
+}
+
+void TriangleQuantizationGrid::initialize(
+    const GAABB3&                       bbox,
+    const GScalar                       max_leaf_extent)
+{
+    // Use cubic cells.
+    const GScalar cell_size =
+        max(
+            max_value(bbox.extent()) / static_cast<GScalar>(CellCount - 1),
+            max_leaf_extent / static_cast<GScalar>(LeafCellCount - 1));
+
+    m_origin = bbox.min;
+    m_cell_size = GVector3(cell_size > GScalar(0.0) ? cell_size : GScalar(1.0));
+    m_rcp_cell_size = GVector3(GScalar(1.0) / m_cell_size[0]);
+}
+
+
+//
+// TriangleEncoder class implementation.
+//
+
+namespace
+{
+    struct CompactLeaf
+    {
+        uint32          m_corner[3];
+        size_t          m_vertex_count;
+        uint32          m_vertices[TriangleEncoder::MaxCompactLeafVertexCount][3];
+    };
+
+    // Quantize and deduplicate the vertices of a leaf. Return false if the leaf cannot be stored compactly.
+    bool quantize_leaf_vertices(
+        const TriangleQuantizationGrid&     grid,
+        const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+        const vector<GVector3>&             triangle_vertices,
+        const vector<size_t>&               triangle_indices,
+        const size_t                        item_begin,
+        const size_t                        item_count,
+        CompactLeaf&                        leaf)
+    {
+        leaf.m_vertex_count = 0;
+
+        uint32 cell_max[3];
+
+        for (size_t d = 0; d < 3; ++d)
+        {
+            leaf.m_corner[d] = ~uint32(0);
+            cell_max[d] = 0;
+        }
+
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            const size_t triangle_index = triangle_indices[item_begin + i];
+            const TriangleVertexInfo& vertex_info = triangle_vertex_infos[triangle_index];
+
+            if (vertex_info.m_motion_segment_count > 0)
+                return false;
+
+            for (size_t v = 0; v < 3; ++v)
+            {
+                const GVector3& vertex = triangle_vertices[vertex_info.m_vertex_index + v];
+
+                uint32 cell[3];
+                for (size_t d = 0; d < 3; ++d)
+                {
+                    cell[d] = grid.quantize(vertex[d], d);
+                    leaf.m_corner[d] = min(leaf.m_corner[d], cell[d]);
+                    cell_max[d] = max(cell_max[d], cell[d]);
+                }
+
+                size_t j = 0;
+                while (j < leaf.m_vertex_count &&
+                       (leaf.m_vertices[j][0] != cell[0] ||
+                        leaf.m_vertices[j][1] != cell[1] ||
+                        leaf.m_vertices[j][2] != cell[2]))
+                    ++j;
+
+                if (j == leaf.m_vertex_count)
+                {
+                    if (leaf.m_vertex_count == TriangleEncoder::MaxCompactLeafVertexCount)
+                        return false;
+
+                    leaf.m_vertices[j][0] = cell[0];
+                    leaf.m_vertices[j][1] = cell[1];
+                    leaf.m_vertices[j][2] = cell[2];
+                    ++leaf.m_vertex_count;
+                }
+            }
+        }
+
+        // Vertex offsets must fit in 16 bits.
+        for (size_t d = 0; d < 3; ++d)
+        {
+            if (cell_max[d] - leaf.m_corner[d] >= TriangleQuantizationGrid::LeafCellCount)
+                return false;
+        }
+
+        return leaf.m_vertex_count > 0;
+    }
+
+    uint8 find_leaf_vertex(
+        const TriangleQuantizationGrid&     grid,
+        const CompactLeaf&                  leaf,
+        const GVector3&                     vertex)
+    {
+        const uint32 cell_x = grid.quantize(vertex[0], 0);
+        const uint32 cell_y = grid.quantize(vertex[1], 1);
+        const uint32 cell_z = grid.quantize(vertex[2], 2);
+
+        for (size_t j = 0; j < leaf.m_vertex_count; ++j)
+        {
+            if (leaf.m_vertices[j][0] == cell_x &&
+                leaf.m_vertices[j][1] == cell_y &&
+                leaf.m_vertices[j][2] == cell_z)
+                return static_cast<uint8>(j);
+        }
+
+        assert(!"Vertex not found in compact leaf.");
+        return 0;
+    }
+
+    bool has_moving_triangles(
+        const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+        const vector<size_t>&               triangle_indices,
+        const size_t                        item_begin,
+        const size_t                        item_count)
+    {
+        for (size_t i = 0; i < item_count; ++i)
+        {
+            const size_t triangle_index = triangle_indices[item_begin + i];
+
+            if (triangle_vertex_infos[triangle_index].m_motion_segment_count > 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    size_t compute_simd_group_count(const size_t triangle_count)
+    {
+        return (triangle_count + GTriangle4Type::Width - 1) / GTriangle4Type::Width;
+    }
+
+    size_t compute_compact_leaf_size(const size_t vertex_count, const size_t triangle_count)
+    {
+        size_t size = 0;
+
+        size += sizeof(uint32);                             // vertex count
+        size += 3 * sizeof(uint32);                         // leaf corner
+        size += vertex_count * 3 * sizeof(uint16);          // vertex offsets
+        size += (vertex_count & 1) * sizeof(uint16);        // padding
+        size += triangle_count * sizeof(uint32);            // visibility flags
+        size += triangle_count * 4 * sizeof(uint8);         // vertex indices
+
+        return size;
+    }
+}
+
 size_t TriangleEncoder::compute_size(
     const vector<TriangleVertexInfo>&   triangle_vertex_infos,
     const vector<size_t>&               triangle_indices,
@@ -101,4 +274,186 @@ void TriangleEncoder::encode(
     }
 }
 
+size_t TriangleEncoder::compute_compact_size(
+    const TriangleQuantizationGrid&     grid,
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count)
+{
+    CompactLeaf leaf;
+
+    if (quantize_leaf_vertices(
+            grid,
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            item_begin,
+            item_count,
+            leaf))
+        return compute_compact_leaf_size(leaf.m_vertex_count, item_count);
+
+    return
+          sizeof(uint32)
+        + compute_size(
+              triangle_vertex_infos,
+              triangle_indices,
+              item_begin,
+              item_count);
+}
+
+void TriangleEncoder::encode_compact(
+    const TriangleQuantizationGrid&     grid,
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count,
+    MemoryWriter&                       writer)
+{
+    CompactLeaf leaf;
+
+    if (!quantize_leaf_vertices(
+            grid,
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            item_begin,
+            item_count,
+            leaf))
+    {
+        // Fall back to the regular layout.
+        writer.write(uint32(0));
+        encode(
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            item_begin,
+            item_count,
+            writer);
+        return;
+    }
+
+    writer.write(static_cast<uint32>(leaf.m_vertex_count));
+    writer.write(leaf.m_corner[0]);
+    writer.write(leaf.m_corner[1]);
+    writer.write(leaf.m_corner[2]);
+
+    for (size_t i = 0; i < leaf.m_vertex_count; ++i)
+    {
+        for (size_t d = 0; d < 3; ++d)
+            writer.write(static_cast<uint16>(leaf.m_vertices[i][d] - leaf.m_corner[d]));
+    }
+
+    if (leaf.m_vertex_count & 1)
+        writer.write(uint16(0));
+
+    for (size_t i = 0; i < item_count; ++i)
+    {
+        const size_t triangle_index = triangle_indices[item_begin + i];
+        const TriangleVertexInfo& vertex_info = triangle_vertex_infos[triangle_index];
+
+        writer.write(vertex_info.m_vis_flags);
+
+        for (size_t v = 0; v < 3; ++v)
+        {
+            writer.write(
+                find_leaf_vertex(
+                    grid,
+                    leaf,
+                    triangle_vertices[vertex_info.m_vertex_index + v]));
+        }
+
+        writer.write(uint8(0));
+    }
+}
+
+size_t TriangleEncoder::compute_simd_size(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count)
+{
+    if (item_count == 0 ||
+        has_moving_triangles(triangle_vertex_infos, triangle_indices, item_begin, item_count))
+    {
+        return
+              sizeof(uint32)
+            + compute_size(
+                  triangle_vertex_infos,
+                  triangle_indices,
+                  item_begin,
+                  item_count);
+    }
+
+    const size_t group_count = compute_simd_group_count(item_count);
+
+    size_t size = 0;
+
+    size += sizeof(uint32);                                         // group count
+    size += group_count * GTriangle4Type::Width * sizeof(uint32);   // visibility flags
+    size += group_count * sizeof(GTriangle4Type);                   // triangles
+
+    return size;
+}
+
+void TriangleEncoder::encode_simd(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count,
+    MemoryWriter&                       writer)
+{
+    if (item_count == 0 ||
+        has_moving_triangles(triangle_vertex_infos, triangle_indices, item_begin, item_count))
+    {
+        // Fall back to the regular layout.
+        writer.write(uint32(0));
+        encode(
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            item_begin,
+            item_count,
+            writer);
+        return;
+    }
+
+    const size_t group_count = compute_simd_group_count(item_count);
+
+    writer.write(static_cast<uint32>(group_count));
+
+    for (size_t g = 0; g < group_count; ++g)
+    {
+        // Unused lanes hold degenerate triangles that are never visible.
+        GTriangle4Type triangles;
+        memset(&triangles, 0, sizeof(triangles));
+
+        for (size_t lane = 0; lane < GTriangle4Type::Width; ++lane)
+        {
+            const size_t i = g * GTriangle4Type::Width + lane;
+
+            if (i < item_count)
+            {
+                const size_t triangle_index = triangle_indices[item_begin + i];
+                const TriangleVertexInfo& vertex_info = triangle_vertex_infos[triangle_index];
+
+                writer.write(vertex_info.m_vis_flags);
+
+                triangles.set(
+                    lane,
+                    GTriangleType(
+                        triangle_vertices[vertex_info.m_vertex_index + 0],
+                        triangle_vertices[vertex_info.m_vertex_index + 1],
+                        triangle_vertices[vertex_info.m_vertex_index + 2]));
+            }
+            else writer.write(uint32(0));
+        }
+
+        writer.write(triangles);
+    }
+}
+
 }   // namespace renderer
@@ -32,20 +32,90 @@
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
 
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/memory.h"
+
 // Standard headers.
 #include <cstddef>
 #include <vector>
 
 // Forward declarations.
-namespace foundation    { class MemoryWriter; }
 namespace renderer      { class TriangleVertexInfo; }
 
 namespace renderer
 {
 
+//
+// A regular grid used to quantize the vertices of compact leaves.
+//
+// The grid is shared by all the leaves of a tree so that a vertex shared by
+// triangles stored in different leaves is quantized to the same position in
+// all of them, which keeps quantized meshes watertight.
+//
+
+class TriangleQuantizationGrid
+{
+  public:
+    // Maximum number of cells along each dimension of the grid. Cell
+    // coordinates are exactly representable in single precision.
+    static const foundation::uint32 CellCount = 1UL << 24;
+
+    // Number of cells addressable from the corner of a compact leaf.
+    static const foundation::uint32 LeafCellCount = 1UL << 16;
+
+    // Constructor.
+    TriangleQuantizationGrid();
+
+    // Fit the grid to a bounding box, choosing the finest cells such that
+    // leaves up to a given extent can be addressed with 16-bit offsets.
+    void initialize(
+        const GAABB3&                           bbox,
+        const GScalar                           max_leaf_extent);
+
+    // Return the cell coordinates of the grid point closest to a given point.
+    foundation::uint32 quantize(const GScalar x, const size_t dim) const;
+
+    // Return the position of a grid point.
+    GVector3 dequantize(
+        const foundation::uint32                cell_x,
+        const foundation::uint32                cell_y,
+        const foundation::uint32                cell_z) const;
+
+  private:
+    GVector3    m_origin;
+    GVector3    m_cell_size;
+    GVector3    m_rcp_cell_size;
+};
+
+
+//
+// Encode the triangles of tree leaves.
+//
+// Regular leaves store a full-precision copy of each triangle. Compact leaves only
+// store static triangles, as indices into a list of vertices quantized to 16-bit
+// offsets (in grid cells) from a corner of the leaf:
+//
+//   uint32             vertex count (0 if the leaf uses the regular layout)
+//   uint32[3]          grid cell of the leaf corner
+//   uint16[3]          vertex offsets in grid cells, for each vertex
+//   (padding to a multiple of 4 bytes)
+//   uint32 + uint8[4]  visibility flags and vertex indices, for each triangle
+//
+// SIMD leaves only store static triangles, in groups of four laid out for
+// GTriangle4Type; unused lanes have no visibility flags:
+//
+//   uint32             group count (0 if the leaf uses the regular layout)
+//   uint32[4]          visibility flags of each lane, for each group
+//   GTriangle4Type     triangles, for each group
+//
+
 class TriangleEncoder
 {
   public:
+    // Maximum number of vertices in a compact leaf.
+    static const size_t MaxCompactLeafVertexCount = 255;
+
     static size_t compute_size(
         const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
         const std::vector<size_t>&              triangle_indices,
@@ -59,6 +129,104 @@ class TriangleEncoder
         const size_t                            item_begin,
         const size_t                            item_count,
         foundation::MemoryWriter&               writer);
+
+    // Compact leaves fall back to the regular layout (preceded by a zero vertex count)
+    // when they contain moving triangles or when their vertices don't fit the format.
+    static size_t compute_compact_size(
+        const TriangleQuantizationGrid&         grid,
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count);
+
+    static void encode_compact(
+        const TriangleQuantizationGrid&         grid,
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count,
+        foundation::MemoryWriter&               writer);
+
+    // SIMD leaves fall back to the regular layout (preceded by a zero group count)
+    // when they contain moving triangles.
+    static size_t compute_simd_size(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count);
+
+    static void encode_simd(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count,
+        foundation::MemoryWriter&               writer);
+
+    // Decode the vertices of a compact leaf whose vertex count was already read.
+    // On return, the reader points to the first triangle of the leaf.
+    static void decode_compact_vertices(
+        const TriangleQuantizationGrid&         grid,
+        const size_t                            vertex_count,
+        foundation::MemoryReader&               reader,
+        GVector3                                vertices[]);
 };
 
+
+//
+// TriangleQuantizationGrid class implementation.
+//
+
+inline foundation::uint32 TriangleQuantizationGrid::quantize(const GScalar x, const size_t dim) const
+{
+    const GScalar cell = (x - m_origin[dim]) * m_rcp_cell_size[dim] + GScalar(0.5);
+
+    return
+        cell <= GScalar(0.0) ? 0 :
+        cell >= GScalar(CellCount - 1) ? CellCount - 1 :
+        static_cast<foundation::uint32>(cell);
+}
+
+inline GVector3 TriangleQuantizationGrid::dequantize(
+    const foundation::uint32                    cell_x,
+    const foundation::uint32                    cell_y,
+    const foundation::uint32                    cell_z) const
+{
+    return
+        GVector3(
+            m_origin[0] + static_cast<GScalar>(cell_x) * m_cell_size[0],
+            m_origin[1] + static_cast<GScalar>(cell_y) * m_cell_size[1],
+            m_origin[2] + static_cast<GScalar>(cell_z) * m_cell_size[2]);
+}
+
+
+//
+// TriangleEncoder class implementation.
+//
+
+inline void TriangleEncoder::decode_compact_vertices(
+    const TriangleQuantizationGrid&             grid,
+    const size_t                                vertex_count,
+    foundation::MemoryReader&                   reader,
+    GVector3                                    vertices[])
+{
+    const foundation::uint32 corner_x = reader.read<foundation::uint32>();
+    const foundation::uint32 corner_y = reader.read<foundation::uint32>();
+    const foundation::uint32 corner_z = reader.read<foundation::uint32>();
+
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        const foundation::uint16 dx = reader.read<foundation::uint16>();
+        const foundation::uint16 dy = reader.read<foundation::uint16>();
+        const foundation::uint16 dz = reader.read<foundation::uint16>();
+        vertices[i] = grid.dequantize(corner_x + dx, corner_y + dy, corner_z + dz);
+    }
+
+    // Skip padding.
+    if (vertex_count & 1)
+        reader += sizeof(foundation::uint16);
+}
+
 }   // namespace renderer
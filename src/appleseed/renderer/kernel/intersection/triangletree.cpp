@@ -36,6 +36,7 @@
 #include "renderer/kernel/intersection/triangleencoder.h"
 #include "renderer/kernel/intersection/triangleitemhandler.h"
 #include "renderer/kernel/intersection/trianglevertexinfo.h"
+#include "renderer/kernel/rendering/renderingcounters.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/kernel/tessellation/statictessellation.h"
@@ -44,11 +45,13 @@
 #include "renderer/modeling/entity/entity.h"
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectoperations.h"
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/object/triangle.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
 #include "renderer/utility/bbox.h"
 #include "renderer/utility/messagecontext.h"
 #include "renderer/utility/paramarray.h"
@@ -60,25 +63,38 @@
 #include "foundation/math/transform.h"
 #include "foundation/math/treeoptimizer.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/memorymappedfile.h"
 #include "foundation/platform/system.h"
 #include "foundation/platform/timers.h"
 #include "foundation/utility/alignedallocator.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/murmurhash.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+#include "boost/filesystem/fstream.hpp"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <exception>
 #include <set>
 #include <string>
 
 using namespace foundation;
 using namespace std;
+namespace bfs = boost::filesystem;
 
 namespace renderer
 {
@@ -116,7 +132,7 @@ namespace
         size_t&                         triangle_vertex_count)
     {
         const Transformd& transform = object_instance.get_transform();
-        const size_t triangle_count = tess.m_primitives.size();
+        const size_t triangle_count = tess.get_primitive_count();
 
         if (save_memory)
         {
@@ -130,7 +146,7 @@ namespace
         for (size_t i = 0; i < triangle_count; ++i)
         {
             // Fetch the triangle.
-            const Triangle& triangle = tess.m_primitives[i];
+            const Triangle triangle = tess.get_primitive(i);
 
             // Retrieve the object space vertices of the triangle.
             const GVector3& v0_os = tess.m_vertices[triangle.m_v0];
@@ -212,7 +228,7 @@ namespace
     {
         const Transformd& transform = object_instance.get_transform();
         const size_t motion_segment_count = tess.get_motion_segment_count();
-        const size_t triangle_count = tess.m_primitives.size();
+        const size_t triangle_count = tess.get_primitive_count();
 
         if (save_memory)
         {
@@ -228,7 +244,7 @@ namespace
         for (size_t i = 0; i < triangle_count; ++i)
         {
             // Fetch the triangle.
-            const Triangle& triangle = tess.m_primitives[i];
+            const Triangle triangle = tess.get_primitive(i);
 
             // Retrieve the object space vertices of the triangle.
             const GVector3& v0_os = tess.m_vertices[triangle.m_v0];
@@ -339,7 +355,7 @@ namespace
             assert(object_instance);
 
             // Retrieve the object.
-            Object& object = object_instance->get_object();
+            Object& object = arguments.get_object(*object_instance);
 
             // Process only mesh objects.
             if (strcmp(object.get_model(), MeshObjectFactory().get_model()) != 0)
@@ -386,18 +402,39 @@ TriangleTree::Arguments::Arguments(
     const Scene&            scene,
     const UniqueID          triangle_tree_uid,
     const GAABB3&           bbox,
-    const Assembly&         assembly)
+    const Assembly&         assembly,
+    const string&           paging_directory,
+    const bool              use_proxies)
   : m_scene(scene)
   , m_triangle_tree_uid(triangle_tree_uid)
   , m_bbox(bbox)
   , m_assembly(assembly)
+  , m_paging_directory(paging_directory)
+  , m_use_proxies(use_proxies)
+{
+}
+
+Object& TriangleTree::Arguments::get_object(const ObjectInstance& object_instance) const
 {
+    if (m_use_proxies)
+    {
+        Object* proxy_object = object_instance.get_proxy_object();
+        if (proxy_object)
+            return *proxy_object;
+    }
+
+    return object_instance.get_object();
 }
 
 TriangleTree::TriangleTree(const Arguments& arguments)
   : TreeType(AlignedAllocator<void>(System::get_l1_data_cache_line_size()))
   , m_arguments(arguments)
+  , m_compact_leaves(false)
+  , m_simd_leaves(false)
 {
+    TraceScope trace_scope("scene", "build triangle tree");
+    MemoryTagScope memory_tag_scope(MemoryTagBVH);
+
     // Retrieve construction parameters.
     const MessageContext message_context(
         format("while building triangle tree for assembly \"{0}\"", m_arguments.m_assembly.get_path()));
@@ -405,31 +442,85 @@ TriangleTree::TriangleTree(const Arguments& arguments)
     const string algorithm = params.get_optional<string>("algorithm", "bvh", make_vector("bvh", "sbvh"), message_context);
     const double time = params.get_optional<double>("time", 0.5);
     const bool save_memory = params.get_optional<bool>("save_temporary_memory", false);
+    const bool wide_bvh = params.get_optional<bool>("wide_bvh", false);
+    m_compact_leaves = params.get_optional<bool>("compact_leaves", false);
+
+    // Compact leaves take precedence over SIMD leaves.
+    m_simd_leaves = !m_compact_leaves && params.get_optional<bool>("simd_leaves", false);
+
+    // The cache directory may be set per assembly or for the whole scene. Without one, trees
+    // that may be released under memory pressure are paged to a temporary directory instead.
+    string cache_directory =
+        params.get_optional<string>(
+            "cache_directory",
+            m_arguments.m_scene.get_parameters().child("acceleration_structure").get_optional<string>("cache_directory", ""));
+    if (cache_directory.empty())
+        cache_directory = m_arguments.m_paging_directory;
 
     // Start stopwatch.
     Stopwatch<DefaultWallclockTimer> stopwatch;
     stopwatch.start();
 
-    // Build the tree.
     Statistics statistics;
-    if (algorithm == "bvh")
-        build_bvh(params, time, save_memory, statistics);
-    else build_sbvh(params, time, save_memory, statistics);
-    statistics.insert_time("total build time", stopwatch.measure().get_seconds());
-    statistics.insert_size("nodes alignment", alignment(&m_nodes[0]));
+
+    // Try to load the tree from the cache.
+    string cache_key;
+    bfs::path cache_filepath;
+    bool loaded_from_cache = false;
+    if (!cache_directory.empty())
+    {
+        cache_key = compute_cache_key(params, algorithm, time);
+        cache_filepath = bfs::path(cache_directory) / (cache_key + ".triangletree");
+        loaded_from_cache = load_from_cache(cache_filepath, cache_key);
+        statistics.insert<string>("cache", loaded_from_cache ? "hit" : "miss");
+    }
+
+    if (!loaded_from_cache)
+    {
+        // Build the tree.
+        if (algorithm == "bvh")
+            build_bvh(params, time, save_memory, statistics);
+        else build_sbvh(params, time, save_memory, statistics);
 
 #ifdef RENDERER_TRIANGLE_TREE_REORDER_NODES
-    // Optimize the tree layout in memory.
-    TreeOptimizer<NodeVectorType> tree_optimizer(m_nodes);
-    tree_optimizer.optimize_node_layout(TriangleTreeSubtreeDepth);
-    assert(m_nodes.size() == m_nodes.capacity());
+        // Optimize the tree layout in memory. Trees with several roots are left as they are.
+        if (m_time_segment_roots.empty())
+        {
+            TreeOptimizer<NodeVectorType> tree_optimizer(m_nodes);
+            tree_optimizer.optimize_node_layout(TriangleTreeSubtreeDepth);
+            assert(m_nodes.size() == m_nodes.capacity());
+        }
 #endif
 
-    // Print triangle tree statistics.
-    RENDERER_LOG_DEBUG("%s",
+        // Store the tree into the cache.
+        if (!cache_directory.empty())
+            save_to_cache(cache_filepath, cache_key);
+    }
+    else
+    {
+        // The cache only holds the tree itself, collect its statistics again.
+        statistics.merge(bvh::TreeStatistics<TriangleTree>(*this, AABB3d(m_arguments.m_bbox)));
+    }
+
+    statistics.insert_time("total build time", stopwatch.measure().get_seconds());
+    statistics.insert_size("nodes alignment", alignment(&m_nodes[0]));
+
+    // Collapse the tree into a wide tree. Wide trees don't support motion.
+    if (wide_bvh && m_moving_triangle_count == 0)
+    {
+        stopwatch.start();
+        m_wide_tree.build(*this);
+        statistics.insert_time("wide tree build time", stopwatch.measure().get_seconds());
+        statistics.insert("wide nodes", m_wide_tree.get_node_count());
+    }
+
+    // Keep and print triangle tree statistics.
+    m_statistics =
         StatisticsVector::make(
-            "triangle tree #" + to_string(m_arguments.m_triangle_tree_uid) + " statistics",
-            statistics).to_string().c_str());
+            "triangle tree #" + to_string(m_arguments.m_triangle_tree_uid) +
+            " (assembly \"" + m_arguments.m_assembly.get_path().c_str() + "\") statistics",
+            statistics);
+    RENDERER_LOG_DEBUG("%s", m_statistics.to_string().c_str());
 }
 
 TriangleTree::~TriangleTree()
@@ -456,7 +547,38 @@ size_t TriangleTree::get_memory_size() const
         - sizeof(*static_cast<const TreeType*>(this))
         + sizeof(*this)
         + m_triangle_keys.capacity() * sizeof(TriangleKey)
-        + m_leaf_data.capacity() * sizeof(uint8);
+        + m_leaf_data.capacity() * sizeof(uint8)
+        + m_wide_tree.get_memory_size()
+        - sizeof(m_wide_tree);
+}
+
+size_t TriangleTree::estimate_memory_size(
+    const size_t            static_triangle_count,
+    const size_t            moving_triangle_count,
+    const size_t            moving_triangle_pose_count)
+{
+    const size_t triangle_count = static_triangle_count + moving_triangle_count;
+
+    if (triangle_count == 0)
+        return sizeof(TriangleTree);
+
+    // Leaves are filled up to the default maximum leaf size; a binary tree
+    // with n leaves has 2n - 1 nodes.
+    const size_t leaf_count =
+        (triangle_count + TriangleTreeDefaultMaxLeafSize - 1) / TriangleTreeDefaultMaxLeafSize;
+    const size_t node_count = 2 * leaf_count - 1;
+
+    // Leaf data, see TriangleEncoder::compute_size().
+    const size_t leaf_data_size =
+          triangle_count * 2 * sizeof(uint32)
+        + static_triangle_count * sizeof(GTriangleType)
+        + moving_triangle_pose_count * 3 * sizeof(GVector3);
+
+    return
+          sizeof(TriangleTree)
+        + node_count * sizeof(NodeType)
+        + triangle_count * sizeof(TriangleKey)
+        + leaf_data_size;
 }
 
 namespace
@@ -492,6 +614,297 @@ namespace
 
         return count;
     }
+
+    size_t compute_max_motion_segment_count(const vector<TriangleVertexInfo>& info)
+    {
+        size_t count = 0;
+
+        for (size_t i = 0; i < info.size(); ++i)
+            count = max<size_t>(count, info[i].m_motion_segment_count);
+
+        return count;
+    }
+
+    // Compute the bounding boxes of triangles at a given time.
+    void compute_triangle_bboxes(
+        const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+        const vector<GVector3>&             triangle_vertices,
+        const double                        time,
+        vector<GAABB3>&                     triangle_bboxes)
+    {
+        const size_t triangle_count = triangle_vertex_infos.size();
+        triangle_bboxes.resize(triangle_count);
+
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            const TriangleVertexInfo& vertex_info = triangle_vertex_infos[i];
+            const size_t motion_segment_count = vertex_info.m_motion_segment_count;
+            GAABB3& bbox = triangle_bboxes[i];
+
+            bbox.invalidate();
+
+            if (motion_segment_count == 0)
+            {
+                for (size_t v = 0; v < 3; ++v)
+                    bbox.insert(triangle_vertices[vertex_info.m_vertex_index + v]);
+            }
+            else
+            {
+                const size_t prev_pose_index =
+                    min(truncate<size_t>(time * motion_segment_count), motion_segment_count - 1);
+                const size_t base_vertex_index = vertex_info.m_vertex_index + prev_pose_index * 3;
+                const GScalar k = static_cast<GScalar>(time * motion_segment_count - prev_pose_index);
+
+                for (size_t v = 0; v < 3; ++v)
+                {
+                    bbox.insert(
+                        lerp(
+                            triangle_vertices[base_vertex_index + v],
+                            triangle_vertices[base_vertex_index + v + 3],
+                            k));
+                }
+            }
+        }
+    }
+}
+
+namespace
+{
+    //
+    // Triangle tree cache file format:
+    //
+    //   TriangleTreeCacheFileHeader
+    //   nodes                  node_count * sizeof(TriangleTree::NodeType)
+    //   node bounding boxes    node_bbox_count * sizeof(AABB3d)
+    //   triangle keys          triangle_key_count * sizeof(TriangleKey)
+    //   leaf data              leaf_data_size bytes
+    //   time segment roots     time_segment_root_count * sizeof(size_t)
+    //
+    // Cache files are only meant to be read back by the same build of appleseed:
+    // the layout of nodes and leaf data depends on the platform and build options,
+    // which is why the format version and the sizes of the stored types are part
+    // of the cache key.
+    //
+
+    const char TriangleTreeCacheFileSignature[8] = { 'A', 'S', 'T', 'T', 'R', 'E', 'E', 0 };
+    const uint64 TriangleTreeCacheFileFormatVersion = 4;
+
+    struct TriangleTreeCacheFileHeader
+    {
+        char                        m_signature[8];
+        uint64                      m_version;
+        char                        m_key[40];
+        uint64                      m_static_triangle_count;
+        uint64                      m_moving_triangle_count;
+        uint64                      m_compact_leaves;
+        uint64                      m_simd_leaves;
+        TriangleQuantizationGrid    m_quantization_grid;
+        uint64                      m_node_count;
+        uint64                      m_node_bbox_count;
+        uint64                      m_triangle_key_count;
+        uint64                      m_leaf_data_size;
+        uint64                      m_time_segment_root_count;
+    };
+
+    template <typename Vector>
+    bool read_cache_section(
+        const uint8*&   ptr,
+        const uint8*    end,
+        const uint64    count,
+        Vector&         vec)
+    {
+        typedef typename Vector::value_type ValueType;
+
+        if (count > static_cast<uint64>(end - ptr) / sizeof(ValueType))
+            return false;
+
+        vec.resize(static_cast<size_t>(count));
+
+        if (!vec.empty())
+            memcpy(&vec[0], ptr, vec.size() * sizeof(ValueType));
+
+        ptr += vec.size() * sizeof(ValueType);
+
+        return true;
+    }
+
+    template <typename Vector>
+    void write_cache_section(bfs::ofstream& file, const Vector& vec)
+    {
+        if (!vec.empty())
+        {
+            file.write(
+                reinterpret_cast<const char*>(&vec[0]),
+                vec.size() * sizeof(typename Vector::value_type));
+        }
+    }
+}
+
+string TriangleTree::compute_cache_key(
+    const ParamArray&   params,
+    const string&       algorithm,
+    const double        time) const
+{
+    MurmurHash hash;
+
+    // Format and build options.
+    hash.append(TriangleTreeCacheFileFormatVersion);
+    hash.append(sizeof(NodeType));
+    hash.append(sizeof(GScalar));
+    hash.append(sizeof(TriangleKey));
+#ifdef RENDERER_TRIANGLE_TREE_REORDER_NODES
+    hash.append(TriangleTreeSubtreeDepth);
+#endif
+
+    // Build parameters.
+    hash.append(algorithm);
+    hash.append(time);
+    hash.append(m_arguments.m_bbox.min);
+    hash.append(m_arguments.m_bbox.max);
+    hash.append(m_arguments.m_use_proxies);
+    for (const_each<StringDictionary> i = params.strings(); i; ++i)
+    {
+        if (strcmp(i->key(), "cache_directory") != 0)
+        {
+            hash.append(i->key());
+            hash.append(i->value());
+        }
+    }
+
+    // Tessellations and their placement, in the order in which triangles are collected.
+    for (size_t i = 0, e = m_arguments.m_assembly.object_instances().size(); i < e; ++i)
+    {
+        const ObjectInstance* object_instance =
+            m_arguments.m_assembly.object_instances().get_by_index(i);
+        const Object& object = m_arguments.get_object(*object_instance);
+
+        if (strcmp(object.get_model(), MeshObjectFactory().get_model()) != 0)
+            continue;
+
+        hash.append(i);
+        hash.append(object_instance->get_transform().get_local_to_parent());
+        hash.append(object_instance->get_vis_flags());
+        compute_signature(hash, static_cast<const MeshObject&>(object));
+    }
+
+    return hash.to_string();
+}
+
+bool TriangleTree::load_from_cache(
+    const bfs::path&    filepath,
+    const string&       key)
+{
+    MemoryMappedFile file;
+    if (!file.open(filepath.string().c_str()))
+        return false;
+
+    const uint8* ptr = static_cast<const uint8*>(file.data());
+    const uint8* end = ptr + file.size();
+
+    // Read and check the header.
+    if (file.size() < sizeof(TriangleTreeCacheFileHeader))
+        return false;
+    TriangleTreeCacheFileHeader header;
+    memcpy(&header, ptr, sizeof(header));
+    ptr += sizeof(header);
+    if (memcmp(header.m_signature, TriangleTreeCacheFileSignature, sizeof(header.m_signature)) != 0 ||
+        header.m_version != TriangleTreeCacheFileFormatVersion ||
+        strncmp(header.m_key, key.c_str(), sizeof(header.m_key)) != 0)
+    {
+        RENDERER_LOG_WARNING("ignoring invalid triangle tree cache file %s.", filepath.string().c_str());
+        return false;
+    }
+
+    // Read the tree.
+    if (!read_cache_section(ptr, end, header.m_node_count, m_nodes) ||
+        !read_cache_section(ptr, end, header.m_node_bbox_count, m_node_bboxes) ||
+        !read_cache_section(ptr, end, header.m_triangle_key_count, m_triangle_keys) ||
+        !read_cache_section(ptr, end, header.m_leaf_data_size, m_leaf_data) ||
+        !read_cache_section(ptr, end, header.m_time_segment_root_count, m_time_segment_roots) ||
+        m_nodes.empty())
+    {
+        RENDERER_LOG_WARNING("ignoring truncated triangle tree cache file %s.", filepath.string().c_str());
+        m_nodes.clear();
+        m_node_bboxes.clear();
+        m_triangle_keys.clear();
+        m_leaf_data.clear();
+        m_time_segment_roots.clear();
+        return false;
+    }
+
+    m_static_triangle_count = static_cast<size_t>(header.m_static_triangle_count);
+    m_moving_triangle_count = static_cast<size_t>(header.m_moving_triangle_count);
+    m_compact_leaves = header.m_compact_leaves != 0;
+    m_simd_leaves = header.m_simd_leaves != 0;
+    m_quantization_grid = header.m_quantization_grid;
+
+    RENDERER_LOG_INFO(
+        "loaded triangle tree #" FMT_UNIQUE_ID " (%s %s, %s %s) from cache file %s.",
+        m_arguments.m_triangle_tree_uid,
+        pretty_uint(m_static_triangle_count).c_str(),
+        plural(m_static_triangle_count, "static triangle").c_str(),
+        pretty_uint(m_moving_triangle_count).c_str(),
+        plural(m_moving_triangle_count, "moving triangle").c_str(),
+        filepath.string().c_str());
+
+    return true;
+}
+
+void TriangleTree::save_to_cache(
+    const bfs::path&    filepath,
+    const string&       key) const
+{
+    TriangleTreeCacheFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_signature, TriangleTreeCacheFileSignature, sizeof(header.m_signature));
+    header.m_version = TriangleTreeCacheFileFormatVersion;
+    strncpy(header.m_key, key.c_str(), sizeof(header.m_key) - 1);
+    header.m_static_triangle_count = m_static_triangle_count;
+    header.m_moving_triangle_count = m_moving_triangle_count;
+    header.m_compact_leaves = m_compact_leaves ? 1 : 0;
+    header.m_simd_leaves = m_simd_leaves ? 1 : 0;
+    header.m_quantization_grid = m_quantization_grid;
+    header.m_node_count = m_nodes.size();
+    header.m_node_bbox_count = m_node_bboxes.size();
+    header.m_triangle_key_count = m_triangle_keys.size();
+    header.m_leaf_data_size = m_leaf_data.size();
+    header.m_time_segment_root_count = m_time_segment_roots.size();
+
+    try
+    {
+        bfs::create_directories(filepath.parent_path());
+
+        // Write to a temporary file first so that concurrent renders never see a partial cache file.
+        const bfs::path temp_filepath =
+            filepath.parent_path() / bfs::unique_path(filepath.filename().string() + ".%%%%-%%%%-%%%%.tmp");
+
+        {
+            bfs::ofstream file(temp_filepath, ios::out | ios::binary | ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            write_cache_section(file, m_nodes);
+            write_cache_section(file, m_node_bboxes);
+            write_cache_section(file, m_triangle_keys);
+            write_cache_section(file, m_leaf_data);
+            write_cache_section(file, m_time_segment_roots);
+
+            if (!file)
+            {
+                file.close();
+                bfs::remove(temp_filepath);
+                RENDERER_LOG_WARNING("failed to write triangle tree cache file %s.", filepath.string().c_str());
+                return;
+            }
+        }
+
+        bfs::rename(temp_filepath, filepath);
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_WARNING(
+            "failed to write triangle tree cache file %s: %s.",
+            filepath.string().c_str(),
+            e.what());
+    }
 }
 
 void TriangleTree::build_bvh(
@@ -539,6 +952,63 @@ void TriangleTree::build_bvh(
     const GScalar interior_node_traversal_cost = params.get_optional<GScalar>("interior_node_traversal_cost", TriangleTreeDefaultInteriorNodeTraversalCost);
     const GScalar triangle_intersection_cost = params.get_optional<GScalar>("triangle_intersection_cost", TriangleTreeDefaultTriangleIntersectionCost);
 
+    // Deforming geometry may be split in time as well as in space.
+    const size_t time_segment_count = params.get_optional<size_t>("time_segments", 1);
+    if (time_segment_count > 1 && m_moving_triangle_count > 0)
+    {
+        // Bounding boxes are recomputed for each time segment.
+        clear_release_memory(triangle_bboxes);
+
+        stopwatch.start();
+
+        // Collect triangle vertices.
+        vector<GVector3> triangle_vertices;
+        collect_triangles<GAABB3>(
+            m_arguments,
+            time,
+            save_memory,
+            nullptr,
+            nullptr,
+            &triangle_vertices,
+            nullptr);
+
+        // Build one subtree per time segment.
+        vector<size_t> triangle_indices;
+        build_time_segments(
+            params,
+            time_segment_count,
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            statistics);
+
+        // Compute and propagate motion bounding boxes, sampled finely enough for each time segment.
+        const size_t motion_key_segment_count =
+            compute_max_motion_segment_count(triangle_vertex_infos) * time_segment_count;
+        for (const_each<vector<size_t>> i = m_time_segment_roots; i; ++i)
+        {
+            compute_motion_bboxes(
+                triangle_indices,
+                triangle_vertex_infos,
+                triangle_vertices,
+                *i,
+                motion_key_segment_count);
+        }
+
+        // Store triangles and triangle keys into the tree.
+        store_triangles(
+            triangle_indices,
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_keys,
+            statistics);
+
+        statistics.insert_time("collection time", collection_time);
+        statistics.insert_time("build and store time", stopwatch.measure().get_seconds());
+
+        return;
+    }
+
     // Create the partitioner.
     typedef bvh::SAHPartitioner<vector<GAABB3>> Partitioner;
     Partitioner partitioner(
@@ -548,8 +1018,8 @@ void TriangleTree::build_bvh(
         triangle_intersection_cost);
 
     // Build the tree.
-    typedef bvh::Builder<TriangleTree, Partitioner> Builder;
-    Builder builder;
+    typedef bvh::ParallelBuilder<TriangleTree, Partitioner> Builder;
+    Builder builder(System::get_logical_cpu_core_count());
     builder.build<DefaultWallclockTimer>(
         *this,
         partitioner,
@@ -596,6 +1066,89 @@ void TriangleTree::build_bvh(
     statistics.insert_time("store time", store_time);
 }
 
+void TriangleTree::build_time_segments(
+    const ParamArray&                   params,
+    const size_t                        time_segment_count,
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    vector<size_t>&                     triangle_indices,
+    Statistics&                         statistics)
+{
+    // Retrieving the partitioner parameters.
+    const size_t max_leaf_size = params.get_optional<size_t>("max_leaf_size", TriangleTreeDefaultMaxLeafSize);
+    const GScalar interior_node_traversal_cost = params.get_optional<GScalar>("interior_node_traversal_cost", TriangleTreeDefaultInteriorNodeTraversalCost);
+    const GScalar triangle_intersection_cost = params.get_optional<GScalar>("triangle_intersection_cost", TriangleTreeDefaultTriangleIntersectionCost);
+
+    typedef bvh::SAHPartitioner<vector<GAABB3>> Partitioner;
+    typedef bvh::ParallelBuilder<TriangleTree, Partitioner> Builder;
+
+    NodeVectorType nodes;
+    vector<GAABB3> triangle_bboxes;
+    double partition_time = 0.0;
+
+    m_time_segment_roots.clear();
+    m_time_segment_roots.reserve(time_segment_count);
+
+    triangle_indices.clear();
+    triangle_indices.reserve(triangle_vertex_infos.size() * time_segment_count);
+
+    for (size_t s = 0; s < time_segment_count; ++s)
+    {
+        // Partition the triangles according to their bounding boxes at the middle of the time segment.
+        const double segment_time = (s + 0.5) / time_segment_count;
+        compute_triangle_bboxes(
+            triangle_vertex_infos,
+            triangle_vertices,
+            segment_time,
+            triangle_bboxes);
+
+        Partitioner partitioner(
+            triangle_bboxes,
+            max_leaf_size,
+            interior_node_traversal_cost,
+            triangle_intersection_cost);
+
+        Builder builder(System::get_logical_cpu_core_count());
+        builder.build<DefaultWallclockTimer>(
+            *this,
+            partitioner,
+            triangle_vertex_infos.size(),
+            max_leaf_size);
+        partition_time += builder.get_build_time();
+
+        // Only report the statistics of the first subtree, the others are similar.
+        if (s == 0)
+        {
+            statistics.merge(
+                bvh::TreeStatistics<TriangleTree>(*this, AABB3d(m_arguments.m_bbox)));
+        }
+
+        // Append the subtree to the other ones.
+        const size_t node_offset = nodes.size();
+        const size_t item_offset = triangle_indices.size();
+        m_time_segment_roots.push_back(node_offset);
+
+        for (const_each<NodeVectorType> i = m_nodes; i; ++i)
+        {
+            NodeType node = *i;
+
+            if (node.is_interior())
+                node.set_child_node_index(node.get_child_node_index() + node_offset);
+            else node.set_item_index(node.get_item_index() + item_offset);
+
+            nodes.push_back(node);
+        }
+
+        const vector<size_t>& ordering = partitioner.get_item_ordering();
+        triangle_indices.insert(triangle_indices.end(), ordering.begin(), ordering.end());
+    }
+
+    m_nodes.swap(nodes);
+
+    statistics.insert("time segments", time_segment_count);
+    statistics.insert_time("partition time", partition_time);
+}
+
 void TriangleTree::build_sbvh(
     const ParamArray&   params,
     const double        time,
@@ -756,7 +1309,8 @@ vector<GAABB3> TriangleTree::compute_motion_bboxes(
     const vector<size_t>&               triangle_indices,
     const vector<TriangleVertexInfo>&   triangle_vertex_infos,
     const vector<GVector3>&             triangle_vertices,
-    const size_t                        node_index)
+    const size_t                        node_index,
+    const size_t                        motion_key_segment_count)
 {
     NodeType& node = m_nodes[node_index];
 
@@ -767,14 +1321,16 @@ vector<GAABB3> TriangleTree::compute_motion_bboxes(
                 triangle_indices,
                 triangle_vertex_infos,
                 triangle_vertices,
-                node.get_child_node_index() + 0);
+                node.get_child_node_index() + 0,
+                motion_key_segment_count);
 
         const vector<GAABB3> right_bboxes =
             compute_motion_bboxes(
                 triangle_indices,
                 triangle_vertex_infos,
                 triangle_vertices,
-                node.get_child_node_index() + 1);
+                node.get_child_node_index() + 1,
+                motion_key_segment_count);
 
         node.set_left_bbox_count(left_bboxes.size());
         node.set_right_bbox_count(right_bboxes.size());
@@ -831,6 +1387,14 @@ vector<GAABB3> TriangleTree::compute_motion_bboxes(
             base_pose_bbox.insert(triangle_vertices[vertex_info.m_vertex_index + 2]);
         }
 
+        // The requested number of motion segments must be a multiple of the number of motion
+        // segments of every triangle for the interpolated bounding boxes to remain conservative.
+        if (max_motion_segment_count > 0 && motion_key_segment_count > 0)
+        {
+            assert(motion_key_segment_count % max_motion_segment_count == 0);
+            max_motion_segment_count = motion_key_segment_count;
+        }
+
         vector<GAABB3> bboxes(max_motion_segment_count + 1);
         bboxes[0] = base_pose_bbox;
 
@@ -884,6 +1448,64 @@ void TriangleTree::store_triangles(
 {
     const size_t node_count = m_nodes.size();
 
+    // Fit the quantization grid of compact leaves to the triangles. The cells are
+    // sized such that most leaves (all but the largest 5%) fit in 16-bit offsets;
+    // the others fall back to the regular layout.
+    if (m_compact_leaves)
+    {
+        GAABB3 vertices_bbox;
+        vertices_bbox.invalidate();
+
+        for (const_each<vector<GVector3>> i = triangle_vertices; i; ++i)
+            vertices_bbox.insert(*i);
+
+        vector<GScalar> leaf_extents;
+
+        for (size_t i = 0; i < node_count; ++i)
+        {
+            const NodeType& node = m_nodes[i];
+
+            if (!node.is_leaf())
+                continue;
+
+            GAABB3 leaf_bbox;
+            leaf_bbox.invalidate();
+
+            const size_t item_begin = node.get_item_index();
+            const size_t item_count = node.get_item_count();
+
+            for (size_t j = 0; j < item_count; ++j)
+            {
+                const TriangleVertexInfo& vertex_info =
+                    triangle_vertex_infos[triangle_indices[item_begin + j]];
+
+                if (vertex_info.m_motion_segment_count > 0)
+                    continue;
+
+                for (size_t v = 0; v < 3; ++v)
+                    leaf_bbox.insert(triangle_vertices[vertex_info.m_vertex_index + v]);
+            }
+
+            if (leaf_bbox.is_valid())
+                leaf_extents.push_back(max_value(leaf_bbox.extent()));
+        }
+
+        if (vertices_bbox.is_valid())
+        {
+            GScalar max_leaf_extent = GScalar(0.0);
+
+            if (!leaf_extents.empty())
+            {
+                const vector<GScalar>::iterator nth =
+                    leaf_extents.begin() + (leaf_extents.size() - 1) * 95 / 100;
+                nth_element(leaf_extents.begin(), nth, leaf_extents.end());
+                max_leaf_extent = *nth;
+            }
+
+            m_quantization_grid.initialize(vertices_bbox, max_leaf_extent);
+        }
+    }
+
     // Gather statistics.
 
     size_t leaf_count = 0;
@@ -902,8 +1524,9 @@ void TriangleTree::store_triangles(
             const size_t item_count = node.get_item_count();
 
             const size_t leaf_size =
-                TriangleEncoder::compute_size(
+                compute_leaf_size(
                     triangle_vertex_infos,
+                    triangle_vertices,
                     triangle_indices,
                     item_begin,
                     item_count);
@@ -939,8 +1562,9 @@ void TriangleTree::store_triangles(
             }
 
             const size_t leaf_size =
-                TriangleEncoder::compute_size(
+                compute_leaf_size(
                     triangle_vertex_infos,
+                    triangle_vertices,
                     triangle_indices,
                     item_begin,
                     item_count);
@@ -951,7 +1575,7 @@ void TriangleTree::store_triangles(
             {
                 user_data_writer.write<uint32>(~uint32(0));
 
-                TriangleEncoder::encode(
+                encode_leaf(
                     triangle_vertex_infos,
                     triangle_vertices,
                     triangle_indices,
@@ -963,7 +1587,7 @@ void TriangleTree::store_triangles(
             {
                 user_data_writer.write(static_cast<uint32>(leaf_data_writer.offset()));
 
-                TriangleEncoder::encode(
+                encode_leaf(
                     triangle_vertex_infos,
                     triangle_vertices,
                     triangle_indices,
@@ -977,6 +1601,84 @@ void TriangleTree::store_triangles(
     statistics.insert_percent("fat leaves", fat_leaf_count, leaf_count);
 }
 
+size_t TriangleTree::compute_leaf_size(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count) const
+{
+    if (m_compact_leaves)
+    {
+        return
+            TriangleEncoder::compute_compact_size(
+                m_quantization_grid,
+                triangle_vertex_infos,
+                triangle_vertices,
+                triangle_indices,
+                item_begin,
+                item_count);
+    }
+
+    if (m_simd_leaves)
+    {
+        return
+            TriangleEncoder::compute_simd_size(
+                triangle_vertex_infos,
+                triangle_indices,
+                item_begin,
+                item_count);
+    }
+
+    return
+        TriangleEncoder::compute_size(
+            triangle_vertex_infos,
+            triangle_indices,
+            item_begin,
+            item_count);
+}
+
+void TriangleTree::encode_leaf(
+    const vector<TriangleVertexInfo>&   triangle_vertex_infos,
+    const vector<GVector3>&             triangle_vertices,
+    const vector<size_t>&               triangle_indices,
+    const size_t                        item_begin,
+    const size_t                        item_count,
+    MemoryWriter&                       writer) const
+{
+    if (m_compact_leaves)
+    {
+        TriangleEncoder::encode_compact(
+            m_quantization_grid,
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            item_begin,
+            item_count,
+            writer);
+    }
+    else if (m_simd_leaves)
+    {
+        TriangleEncoder::encode_simd(
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            item_begin,
+            item_count,
+            writer);
+    }
+    else
+    {
+        TriangleEncoder::encode(
+            triangle_vertex_infos,
+            triangle_vertices,
+            triangle_indices,
+            item_begin,
+            item_count,
+            writer);
+    }
+}
+
 namespace
 {
     struct FilterKey
@@ -1084,18 +1786,18 @@ namespace
 
     // Collect the set of object instances contained in an assembly.
     void collect_object_instances(
-        const Assembly&                     assembly,
+        const TriangleTree::Arguments&      arguments,
         IndexSet&                           object_instances)
     {
-        for (size_t i = 0, e = assembly.object_instances().size(); i < e; ++i)
+        for (size_t i = 0, e = arguments.m_assembly.object_instances().size(); i < e; ++i)
         {
             // Retrieve the object instance and its transformation.
             const ObjectInstance* object_instance =
-                assembly.object_instances().get_by_index(i);
+                arguments.m_assembly.object_instances().get_by_index(i);
             assert(object_instance);
 
             // Retrieve the object.
-            Object& object = object_instance->get_object();
+            Object& object = arguments.get_object(*object_instance);
 
             // Process only mesh objects.
             if (strcmp(object.get_model(), MeshObjectFactory().get_model()) == 0)
@@ -1105,7 +1807,7 @@ namespace
 
     // Create filter keys for a set of object instances, and establish an (object instance) -> (filter key) mapping.
     void create_filter_keys(
-        const ObjectInstanceContainer&      object_instances,
+        const TriangleTree::Arguments&      arguments,
         const IndexSet&                     object_instance_indices,
         FilterKeySet&                       filter_keys,
         IndexToFilterKeyMap&                object_instances_to_filter_keys)
@@ -1114,7 +1816,7 @@ namespace
         {
             const size_t object_instance_index = *i;
             const ObjectInstance* object_instance =
-                object_instances.get_by_index(object_instance_index);
+                arguments.m_assembly.object_instances().get_by_index(object_instance_index);
 
             // We create intersection filters for front materials, assuming materials will be the same on the back
             // side of the object instance. This assumption is checked in renderer::ObjectInstance::on_frame_begin()
@@ -1125,7 +1827,7 @@ namespace
             const FilterKeySet::const_iterator filter_key_it =
                 filter_keys.insert(
                     FilterKey(
-                        &object_instance->get_object(),
+                        &arguments.get_object(*object_instance),
                         object_instance->get_front_materials())).first;
 
             const FilterKey& filter_key = *filter_key_it;
@@ -1250,13 +1952,13 @@ void TriangleTree::update_intersection_filters()
 {
     // Collect object instances.
     IndexSet object_instances;
-    collect_object_instances(m_arguments.m_assembly, object_instances);
+    collect_object_instances(m_arguments, object_instances);
 
     // Create filter keys and map object instances to filter keys.
     FilterKeySet filter_keys;
     IndexToFilterKeyMap object_instances_to_filter_keys;
     create_filter_keys(
-        m_arguments.m_assembly.object_instances(),
+        m_arguments,
         object_instances,
         filter_keys,
         object_instances_to_filter_keys);
@@ -1359,6 +2061,8 @@ bool TriangleLeafVisitor::visit(
 #endif
     )
 {
+    ++RenderingCounters::current().m_traversal_step_count;
+
     // Retrieve the pointer to the data of this leaf.
     const uint8* user_data = &node.get_user_data<uint8>();
     const uint32 leaf_data_index = *reinterpret_cast<const uint32*>(user_data);
@@ -1368,6 +2072,142 @@ bool TriangleLeafVisitor::visit(
             : &m_tree.m_leaf_data[leaf_data_index];     // triangles are stored in the tree
     MemoryReader reader(leaf_data);
 
+    // Compact leaves store indexed, quantized static triangles.
+    if (m_tree.m_compact_leaves)
+    {
+        const size_t vertex_count = reader.read<uint32>();
+
+        if (vertex_count > 0)
+        {
+            GVector3 vertices[TriangleEncoder::MaxCompactLeafVertexCount];
+            TriangleEncoder::decode_compact_vertices(
+                m_tree.m_quantization_grid,
+                vertex_count,
+                reader,
+                vertices);
+
+            for (size_t triangle_index = node.get_item_index(),
+                        triangle_count = node.get_item_count();
+                        triangle_count--;
+                        triangle_index++)
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(1));
+
+                // Retrieve the triangle's visibility flags and vertex indices.
+                const uint32 vis_flags = reader.read<uint32>();
+                const uint8* indices = static_cast<const uint8*>(reader.read(4 * sizeof(uint8)));
+
+                // Check visibility flags.
+                if (!(vis_flags & m_shading_point.m_ray.m_flags))
+                    continue;
+
+                // Build the triangle and convert it to the right format if necessary.
+                const GTriangleType triangle(
+                    vertices[indices[0]],
+                    vertices[indices[1]],
+                    vertices[indices[2]]);
+                const TriangleReader triangle_reader(triangle);
+
+                // Intersect the triangle.
+                double t, u, v;
+                if (triangle_reader.m_triangle.intersect(ray, t, u, v))
+                {
+                    // Optionally filter intersections.
+                    if (m_has_intersection_filters)
+                    {
+                        const TriangleKey& triangle_key = m_tree.m_triangle_keys[triangle_index];
+                        const IntersectionFilter* filter =
+                            m_tree.m_intersection_filters[triangle_key.get_object_instance_index()];
+                        if (filter && !filter->accept(triangle_key, u, v))
+                            continue;
+                    }
+
+                    m_interpolated_triangle = triangle;
+                    m_hit_triangle = &m_interpolated_triangle;
+                    m_hit_triangle_index = triangle_index;
+                    m_shading_point.m_ray.m_tmax = t;
+                    m_shading_point.m_bary[0] = static_cast<float>(u);
+                    m_shading_point.m_bary[1] = static_cast<float>(v);
+                }
+            }
+
+            // Continue traversal.
+            distance = m_shading_point.m_ray.m_tmax;
+            return true;
+        }
+    }
+
+    // SIMD leaves store static triangles in groups of four.
+    if (m_tree.m_simd_leaves)
+    {
+        const size_t group_count = reader.read<uint32>();
+
+        if (group_count > 0)
+        {
+            for (size_t g = 0; g < group_count; ++g)
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(GTriangle4Type::Width));
+
+                // Retrieve the triangles and their visibility flags.
+                const uint32* vis_flags = static_cast<const uint32*>(reader.read(GTriangle4Type::Width * sizeof(uint32)));
+                const GTriangle4Type& triangles = reader.read<GTriangle4Type>();
+
+                // Check visibility flags.
+                size_t visible_mask = 0;
+                for (size_t lane = 0; lane < GTriangle4Type::Width; ++lane)
+                {
+                    if (vis_flags[lane] & m_shading_point.m_ray.m_flags)
+                        visible_mask |= size_t(1) << lane;
+                }
+                if (visible_mask == 0)
+                    continue;
+
+                // Intersect all four triangles at once.
+                double t[GTriangle4Type::Width], u[GTriangle4Type::Width], v[GTriangle4Type::Width];
+                size_t hit_mask = triangles.intersect(ray, t, u, v) & visible_mask;
+
+                // Consider the hits from closest to farthest until one passes the intersection filters.
+                while (hit_mask)
+                {
+                    size_t lane = GTriangle4Type::Width;
+                    for (size_t i = 0; i < GTriangle4Type::Width; ++i)
+                    {
+                        if ((hit_mask & (size_t(1) << i)) && (lane == GTriangle4Type::Width || t[i] < t[lane]))
+                            lane = i;
+                    }
+                    hit_mask &= ~(size_t(1) << lane);
+
+                    if (t[lane] >= m_shading_point.m_ray.m_tmax)
+                        break;
+
+                    const size_t triangle_index = node.get_item_index() + g * GTriangle4Type::Width + lane;
+
+                    // Optionally filter intersections.
+                    if (m_has_intersection_filters)
+                    {
+                        const TriangleKey& triangle_key = m_tree.m_triangle_keys[triangle_index];
+                        const IntersectionFilter* filter =
+                            m_tree.m_intersection_filters[triangle_key.get_object_instance_index()];
+                        if (filter && !filter->accept(triangle_key, u[lane], v[lane]))
+                            continue;
+                    }
+
+                    m_interpolated_triangle = triangles.get(lane);
+                    m_hit_triangle = &m_interpolated_triangle;
+                    m_hit_triangle_index = triangle_index;
+                    m_shading_point.m_ray.m_tmax = t[lane];
+                    m_shading_point.m_bary[0] = static_cast<float>(u[lane]);
+                    m_shading_point.m_bary[1] = static_cast<float>(v[lane]);
+                    break;
+                }
+            }
+
+            // Continue traversal.
+            distance = m_shading_point.m_ray.m_tmax;
+            return true;
+        }
+    }
+
     // Sequentially intersect all triangles of the leaf.
     for (size_t triangle_index = node.get_item_index(),
                 triangle_count = node.get_item_count();
@@ -1513,6 +2353,9 @@ bool TriangleLeafProbeVisitor::visit(
 #endif
     )
 {
+    ++RenderingCounters::current().m_traversal_step_count;
+    m_last_leaf = &node;
+
     // Retrieve the pointer to the data of this leaf.
     const uint8* user_data = &node.get_user_data<uint8>();
     const uint32 leaf_data_index = *reinterpret_cast<const uint32*>(user_data);
@@ -1522,6 +2365,93 @@ bool TriangleLeafProbeVisitor::visit(
             : &m_tree.m_leaf_data[leaf_data_index];     // triangles are stored in the tree
     MemoryReader reader(leaf_data);
 
+    // Compact leaves store indexed, quantized static triangles.
+    if (m_tree.m_compact_leaves)
+    {
+        const size_t vertex_count = reader.read<uint32>();
+
+        if (vertex_count > 0)
+        {
+            GVector3 vertices[TriangleEncoder::MaxCompactLeafVertexCount];
+            TriangleEncoder::decode_compact_vertices(
+                m_tree.m_quantization_grid,
+                vertex_count,
+                reader,
+                vertices);
+
+            for (size_t triangle_count = node.get_item_count(); triangle_count--; )
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(1));
+
+                // Retrieve the triangle's visibility flags and vertex indices.
+                const uint32 vis_flags = reader.read<uint32>();
+                const uint8* indices = static_cast<const uint8*>(reader.read(4 * sizeof(uint8)));
+
+                // Check visibility flags.
+                if (!(vis_flags & m_ray_flags))
+                    continue;
+
+                // Build the triangle and convert it to the right format if necessary.
+                const GTriangleType triangle(
+                    vertices[indices[0]],
+                    vertices[indices[1]],
+                    vertices[indices[2]]);
+                const TriangleReader triangle_reader(triangle);
+
+                // Intersect the triangle.
+                if (triangle_reader.m_triangle.intersect(ray))
+                {
+                    m_hit = true;
+                    return false;
+                }
+            }
+
+            // Continue traversal.
+            distance = ray.m_tmax;
+            return true;
+        }
+    }
+
+    // SIMD leaves store static triangles in groups of four.
+    if (m_tree.m_simd_leaves)
+    {
+        const size_t group_count = reader.read<uint32>();
+
+        if (group_count > 0)
+        {
+            for (size_t g = 0; g < group_count; ++g)
+            {
+                FOUNDATION_BVH_TRAVERSAL_STATS(stats.m_intersected_items.insert(GTriangle4Type::Width));
+
+                // Retrieve the triangles and their visibility flags.
+                const uint32* vis_flags = static_cast<const uint32*>(reader.read(GTriangle4Type::Width * sizeof(uint32)));
+                const GTriangle4Type& triangles = reader.read<GTriangle4Type>();
+
+                // Check visibility flags.
+                size_t visible_mask = 0;
+                for (size_t lane = 0; lane < GTriangle4Type::Width; ++lane)
+                {
+                    if (vis_flags[lane] & m_ray_flags)
+                        visible_mask |= size_t(1) << lane;
+                }
+                if (visible_mask == 0)
+                    continue;
+
+                // Intersect all four triangles at once.
+                double t[GTriangle4Type::Width], u[GTriangle4Type::Width], v[GTriangle4Type::Width];
+                if (triangles.intersect(ray, t, u, v) & visible_mask)
+                {
+                    m_hit = true;
+                    return false;
+                }
+            }
+
+            // Continue traversal.
+            distance = ray.m_tmax;
+            return true;
+        }
+    }
+
     // Sequentially intersect triangles until a hit is found.
     for (size_t triangle_count = node.get_item_count(); triangle_count--; )
     {
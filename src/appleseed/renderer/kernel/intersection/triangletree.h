@@ -33,6 +33,7 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/intersection/intersectionsettings.h"
 #include "renderer/kernel/intersection/probevisitorbase.h"
+#include "renderer/kernel/intersection/triangleencoder.h"
 #include "renderer/kernel/intersection/trianglekey.h"
 #include "renderer/kernel/intersection/trianglevertexinfo.h"
 #include "renderer/modeling/scene/visibilityflags.h"
@@ -46,21 +47,29 @@
 #include "foundation/utility/alignedvector.h"
 #include "foundation/utility/lazy.h"
 #include "foundation/utility/poolallocator.h"
+#include "foundation/utility/statistics.h"
 #include "foundation/utility/uid.h"
 
+// Boost headers.
+#include "boost/filesystem/path.hpp"
+
 // Standard headers.
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 // Forward declarations.
-namespace foundation    { class Statistics; }
 namespace renderer      { class Assembly; }
+namespace renderer      { class AssemblyInstance; }
 namespace renderer      { class IntersectionFilter; }
+namespace renderer      { class Object; }
+namespace renderer      { class ObjectInstance; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class Scene; }
 namespace renderer      { class ShadingPoint; }
+namespace renderer      { class TransformSequence; }
 
 namespace renderer
 {
@@ -80,6 +89,8 @@ class TriangleTree
            >
 {
   public:
+    typedef foundation::bvh::WideTree<NodeType, TriangleTreeWideNodeWidth> WideTreeType;
+
     // Construction arguments.
     struct Arguments
     {
@@ -87,13 +98,20 @@ class TriangleTree
         const foundation::UniqueID              m_triangle_tree_uid;
         const GAABB3                            m_bbox;
         const Assembly&                         m_assembly;
+        const std::string                       m_paging_directory;     // used as cache directory when none is set
+        const bool                              m_use_proxies;          // build the tree from proxy geometry
 
         // Constructor.
         Arguments(
             const Scene&                        scene,
             const foundation::UniqueID          triangle_tree_uid,
             const GAABB3&                       bbox,
-            const Assembly&                     assembly);
+            const Assembly&                     assembly,
+            const std::string&                  paging_directory = std::string(),
+            const bool                          use_proxies = false);
+
+        // Return the object of a given object instance that goes into the tree.
+        Object& get_object(const ObjectInstance& object_instance) const;
     };
 
     // Constructor, builds the tree for a given assembly.
@@ -109,9 +127,23 @@ class TriangleTree
     size_t get_static_triangle_count() const;
     size_t get_moving_triangle_count() const;
 
+    // Return the wide version of the tree, or nullptr if it was not built.
+    const WideTreeType* get_wide_tree() const;
+
+    // Return the statistics collected when the tree was built or loaded from the cache.
+    const foundation::StatisticsVector& get_statistics() const;
+
     // Return the size (in bytes) of this object in memory.
     size_t get_memory_size() const;
 
+    // Estimate the size (in bytes) in memory of a tree built with regular leaves
+    // from a given number of triangles, without building it. Moving triangles
+    // contribute one vertex pose per motion step, i.e. motion segment count + 1.
+    static size_t estimate_memory_size(
+        const size_t                            static_triangle_count,
+        const size_t                            moving_triangle_count,
+        const size_t                            moving_triangle_pose_count);
+
   private:
     friend class TriangleLeafVisitor;
     friend class TriangleLeafProbeVisitor;
@@ -124,9 +156,30 @@ class TriangleTree
     std::vector<TriangleKey>                    m_triangle_keys;
     std::vector<foundation::uint8>              m_leaf_data;
 
+    bool                                        m_compact_leaves;
+    bool                                        m_simd_leaves;
+    TriangleQuantizationGrid                    m_quantization_grid;
+
+    WideTreeType                                m_wide_tree;
+
+    foundation::StatisticsVector                m_statistics;
+
     IntersectionFilterRepository                m_intersection_filters_repository;
     std::vector<const IntersectionFilter*>      m_intersection_filters;
 
+    std::string compute_cache_key(
+        const ParamArray&                       params,
+        const std::string&                      algorithm,
+        const double                            time) const;
+
+    bool load_from_cache(
+        const boost::filesystem::path&          filepath,
+        const std::string&                      key);
+
+    void save_to_cache(
+        const boost::filesystem::path&          filepath,
+        const std::string&                      key) const;
+
     void build_bvh(
         const ParamArray&                       params,
         const double                            time,
@@ -139,11 +192,22 @@ class TriangleTree
         const bool                              save_memory,
         foundation::Statistics&                 statistics);
 
+    void build_time_segments(
+        const ParamArray&                       params,
+        const size_t                            time_segment_count,
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        std::vector<size_t>&                    triangle_indices,
+        foundation::Statistics&                 statistics);
+
+    // If motion_key_segment_count is nonzero, the bounding boxes of moving leaves are stored
+    // for that many motion segments instead of those of their most finely sampled triangle.
     std::vector<GAABB3> compute_motion_bboxes(
         const std::vector<size_t>&              triangle_indices,
         const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
         const std::vector<GVector3>&            triangle_vertices,
-        const size_t                            node_index);
+        const size_t                            node_index,
+        const size_t                            motion_key_segment_count = 0);
 
     void store_triangles(
         const std::vector<size_t>&              triangle_indices,
@@ -152,6 +216,21 @@ class TriangleTree
         const std::vector<TriangleKey>&         triangle_keys,
         foundation::Statistics&                 statistics);
 
+    size_t compute_leaf_size(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count) const;
+
+    void encode_leaf(
+        const std::vector<TriangleVertexInfo>&  triangle_vertex_infos,
+        const std::vector<GVector3>&            triangle_vertices,
+        const std::vector<size_t>&              triangle_indices,
+        const size_t                            item_begin,
+        const size_t                            item_count,
+        foundation::MemoryWriter&               writer) const;
+
     void update_intersection_filters();
     void delete_intersection_filters();
 };
@@ -261,11 +340,35 @@ class TriangleLeafProbeVisitor
 #endif
         );
 
+    // Return the last leaf visited, i.e. the leaf containing the occluder if there was a hit.
+    const TriangleTree::NodeType* get_last_leaf() const;
+
   private:
-    const TriangleTree&         m_tree;
-    const double                m_ray_time;
-    const VisibilityFlags::Type m_ray_flags;
-    const bool                  m_has_intersection_filters;
+    const TriangleTree&             m_tree;
+    const double                    m_ray_time;
+    const VisibilityFlags::Type     m_ray_flags;
+    const bool                      m_has_intersection_filters;
+    const TriangleTree::NodeType*   m_last_leaf;
+};
+
+
+//
+// The triangle tree leaf that contained the occluder found by a probe ray.
+// Probe rays traced shortly afterward are often blocked by the same occluder,
+// so testing this leaf first lets them skip the full traversal.
+//
+
+struct ProbeOccluder
+{
+    const AssemblyInstance*         m_assembly_instance;
+    const TransformSequence*        m_transform_sequence;
+    const TriangleTree*             m_triangle_tree;
+    const TriangleTree::NodeType*   m_leaf;             // null if there is no occluder
+
+    ProbeOccluder()
+      : m_leaf(nullptr)
+    {
+    }
 };
 
 
@@ -287,6 +390,20 @@ typedef foundation::bvh::Intersector<
     TriangleTreeStackSize
 > TriangleTreeProbeIntersector;
 
+typedef foundation::bvh::WideIntersector<
+    TriangleTree::WideTreeType,
+    TriangleLeafVisitor,
+    foundation::Ray3d,
+    TriangleTreeWideStackSize
+> TriangleTreeWideIntersector;
+
+typedef foundation::bvh::WideIntersector<
+    TriangleTree::WideTreeType,
+    TriangleLeafProbeVisitor,
+    foundation::Ray3d,
+    TriangleTreeWideStackSize
+> TriangleTreeWideProbeIntersector;
+
 
 //
 // TriangleTree class implementation.
@@ -302,6 +419,16 @@ inline size_t TriangleTree::get_moving_triangle_count() const
     return m_moving_triangle_count;
 }
 
+inline const TriangleTree::WideTreeType* TriangleTree::get_wide_tree() const
+{
+    return m_wide_tree.empty() ? nullptr : &m_wide_tree;
+}
+
+inline const foundation::StatisticsVector& TriangleTree::get_statistics() const
+{
+    return m_statistics;
+}
+
 
 //
 // TriangleLeafVisitor class implementation.
@@ -330,7 +457,13 @@ inline TriangleLeafProbeVisitor::TriangleLeafProbeVisitor(
   , m_ray_time(ray_time)
   , m_ray_flags(ray_flags)
   , m_has_intersection_filters(!tree.m_intersection_filters.empty())
+  , m_last_leaf(nullptr)
+{
+}
+
+inline const TriangleTree::NodeType* TriangleLeafProbeVisitor::get_last_leaf() const
 {
+    return m_last_leaf;
 }
 
 }   // namespace renderer
@@ -32,16 +32,29 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
 #include "renderer/kernel/lighting/lightsample.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/modeling/edf/edf.h"
+#include "renderer/modeling/input/source.h"
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/scene.h"
 
+// appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/foreach.h"
+
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -61,7 +74,7 @@ Dictionary BackwardLightSampler::get_params_metadata()
         "algorithm",
         Dictionary()
             .insert("type", "enum")
-            .insert("values", "cdf|lighttree")
+            .insert("values", "cdf|lighttree|lightcache")
             .insert("default", "cdf")
             .insert("label", "Light Sampler")
             .insert("help", "Light sampling algoritm")
@@ -77,7 +90,30 @@ Dictionary BackwardLightSampler::get_params_metadata()
                         "lighttree",
                         Dictionary()
                             .insert("label", "Light Tree")
-                            .insert("help", "Lights organized in a BVH"))));
+                            .insert("help", "Lights organized in a BVH"))
+                    .insert(
+                        "lightcache",
+                        Dictionary()
+                            .insert("label", "Light Cache")
+                            .insert("help", "Lights selected from per-region lists of the most important lights"))));
+
+    metadata.dictionaries().insert(
+        "light_cache_resolution",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "16")
+            .insert("min", "1")
+            .insert("label", "Light Cache Resolution")
+            .insert("help", "Number of light cache voxels along the longest dimension of the scene"));
+
+    metadata.dictionaries().insert(
+        "light_cache_max_lights",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "32")
+            .insert("min", "1")
+            .insert("label", "Light Cache Max Lights")
+            .insert("help", "Maximum number of important lights stored in each light cache voxel"));
 
     metadata.merge(LightSamplerBase::get_params_metadata());
 
@@ -90,10 +126,15 @@ BackwardLightSampler::BackwardLightSampler(
   : LightSamplerBase(params)
 {
     // Read which sampling algorithm should be used.
-    m_use_light_tree = params.get_optional<string>("algorithm", "cdf") == "lighttree";
+    const string algorithm = params.get_optional<string>("algorithm", "cdf");
+    m_use_light_tree = algorithm == "lighttree";
+    m_use_light_cache = algorithm == "lightcache";
+    m_light_cache_prob = 0.0f;
 
     RENDERER_LOG_INFO("collecting light emitters...");
 
+    MemoryTagScope memory_tag_scope(MemoryTagLights);
+
     // Collect all non-physical lights and separate them according to their
     // compatibility with the LightTree.
     collect_non_physical_lights(
@@ -107,6 +148,12 @@ BackwardLightSampler::BackwardLightSampler(
                 // Insert into light tree compatible lights.
                 m_light_tree_lights.push_back(light_info);
             }
+            else if (m_use_light_cache
+                && ((light_info.m_light->get_flags() & Light::LightTreeCompatible) != 0))
+            {
+                // Lights that can be located by a single point are sampled from the light cache.
+                m_light_cache_lights.push_back(light_info);
+            }
             else
             {
                 // Insert into non-physical lights to be evaluated using a CDF.
@@ -175,17 +222,25 @@ BackwardLightSampler::BackwardLightSampler(
 
         // Associate light tree nodes to emitting shapes.
         for (size_t i = 0, e = m_emitting_shapes.size(); i < e; ++i)
-            m_emitting_shapes[i].m_light_tree_node_index = tri_index_to_node_index[i];
+            m_emitting_shapes[i].m_light_tree_node_index = static_cast<uint32>(tri_index_to_node_index[i]);
     }
     else
     {
         // Prepare the light-emitting shapes CDF for smapling.
         if (m_emitting_shapes_cdf.valid())
+        {
             m_emitting_shapes_cdf.prepare();
 
+            if (m_params.m_alias_sampling)
+                build_alias_table(m_emitting_shapes_cdf, m_emitting_shapes_alias_table);
+        }
+
         // Store the shape probability densities into the emitting shapes.
         for (size_t i = 0, e = m_emitting_shapes.size(); i < e; ++i)
             m_emitting_shapes[i].m_shape_prob = m_emitting_shapes_cdf[i].second;
+
+        if (m_use_light_cache)
+            build_light_cache(scene, params);
     }
 
     RENDERER_LOG_INFO(
@@ -198,6 +253,60 @@ BackwardLightSampler::BackwardLightSampler(
         plural(m_emitting_shapes.size(), "shape").c_str());
 }
 
+void BackwardLightSampler::build_light_cache(
+    const Scene&                        scene,
+    const ParamArray&                   params)
+{
+    if (m_light_cache_lights.empty())
+        return;
+
+    vector<Vector3d> light_positions;
+    vector<float> light_importances;
+    light_positions.reserve(m_light_cache_lights.size());
+    light_importances.reserve(m_light_cache_lights.size());
+
+    for (const_each<NonPhysicalLightVector> i = m_light_cache_lights; i; ++i)
+    {
+        const Light* light = i->m_light;
+
+        // Retrieve the world space position of the light.
+        const Vector3d position =
+            i->m_transform_sequence.get_earliest_transform().point_to_parent(
+                light->get_transform().get_local_to_parent().extract_translation());
+        light_positions.push_back(position);
+
+        // Use the same importance as the light tree.
+        Spectrum intensity;
+        light->get_inputs().find("intensity").source()->evaluate_uniform(intensity);
+        light_importances.push_back(
+            average_value(intensity) * light->get_uncached_importance_multiplier());
+    }
+
+    m_light_cache.reset(
+        new SpatialLightCache(
+            AABB3d(scene.compute_bbox()),
+            light_positions,
+            light_importances,
+            params.get_optional<size_t>("light_cache_resolution", 16),
+            params.get_optional<size_t>("light_cache_max_lights", 32)));
+
+    if (!m_light_cache->valid())
+    {
+        RENDERER_LOG_WARNING("all lights sampled by the light cache have zero importance; ignoring them.");
+        m_light_cache.reset();
+        m_light_cache_lights.clear();
+        return;
+    }
+
+    // Split samples evenly between the light cache and emitting shapes.
+    m_light_cache_prob = m_emitting_shapes_cdf.valid() ? 0.5f : 1.0f;
+
+    RENDERER_LOG_INFO(
+        "sampling %s %s from the light cache.",
+        pretty_int(m_light_cache_lights.size()).c_str(),
+        plural(m_light_cache_lights.size(), "non-physical light").c_str());
+}
+
 void BackwardLightSampler::sample_lightset(
     const ShadingRay::Time&             time,
     const Vector3f&                     s,
@@ -213,6 +322,15 @@ void BackwardLightSampler::sample_lightset(
             shading_point,
             light_sample);
     }
+    else if (m_light_cache)
+    {
+        // Light cache sampling.
+        sample_light_cache(
+            time,
+            s,
+            shading_point,
+            light_sample);
+    }
     else
     {
         // CDF-based sampling.
@@ -241,13 +359,17 @@ float BackwardLightSampler::evaluate_pdf(
 
     const EmittingShape* shape = *shape_ptr;
 
-    const float shape_probability =
+    float shape_probability =
         m_use_light_tree
             ? m_light_tree->evaluate_node_pdf(
                 surface_shading_point,
                 shape->m_light_tree_node_index)
             : shape->evaluate_pdf_uniform();
 
+    // Account for the samples that went to the light cache.
+    if (m_light_cache)
+        shape_probability *= 1.0f - m_light_cache_prob;
+
     assert(shape_probability >= 0.0f);
 
     return shape_probability;
@@ -298,4 +420,52 @@ void BackwardLightSampler::sample_light_tree(
     assert(light_sample.m_probability > 0.0f);
 }
 
+void BackwardLightSampler::sample_light_cache(
+    const ShadingRay::Time&             time,
+    const Vector3f&                     s,
+    const ShadingPoint&                 shading_point,
+    LightSample&                        light_sample) const
+{
+    assert(m_light_cache);
+
+    if (s[0] >= m_light_cache_prob)
+    {
+        // Sample emitting shapes.
+        sample_emitting_shapes(
+            time,
+            Vector3f(
+                min((s[0] - m_light_cache_prob) / (1.0f - m_light_cache_prob), 0.99999994f),
+                s[1],
+                s[2]),
+            light_sample);
+
+        light_sample.m_probability *= 1.0f - m_light_cache_prob;
+    }
+    else
+    {
+        // Sample the light cache.
+        float light_prob;
+        const size_t light_index =
+            m_light_cache->sample(
+                shading_point.get_point(),
+                s[0] / m_light_cache_prob,
+                light_prob);
+
+        // Fetch the light.
+        const NonPhysicalLightInfo& light_info = m_light_cache_lights[light_index];
+        light_sample.m_light = light_info.m_light;
+
+        // Evaluate and store the transform of the light.
+        light_sample.m_light_transform =
+              light_info.m_light->get_transform()
+            * light_info.m_transform_sequence.evaluate(time.m_absolute);
+
+        // Store the probability density of this light.
+        light_sample.m_probability = light_prob * m_light_cache_prob;
+    }
+
+    assert(light_sample.m_light || light_sample.m_shape);
+    assert(light_sample.m_probability > 0.0f);
+}
+
 }   // namespace renderer
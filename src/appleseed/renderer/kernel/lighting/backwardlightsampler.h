@@ -33,6 +33,7 @@
 #include "renderer/kernel/lighting/lightsamplerbase.h"
 #include "renderer/kernel/lighting/lighttree.h"
 #include "renderer/kernel/lighting/lighttypes.h"
+#include "renderer/kernel/lighting/spatiallightcache.h"
 #include "renderer/kernel/shading/shadingray.h"
 
 // appleseed.foundation headers.
@@ -97,11 +98,26 @@ class BackwardLightSampler
     NonPhysicalLightVector                  m_light_tree_lights;
     std::unique_ptr<LightTree>              m_light_tree;
 
+    bool                                    m_use_light_cache;
+    NonPhysicalLightVector                  m_light_cache_lights;
+    std::unique_ptr<SpatialLightCache>      m_light_cache;
+    float                                   m_light_cache_prob;     // probability of sampling the light cache rather than emitting shapes
+
+    void build_light_cache(
+        const Scene&                        scene,
+        const ParamArray&                   params);
+
     void sample_light_tree(
         const ShadingRay::Time&             time,
         const foundation::Vector3f&         s,
         const ShadingPoint&                 shading_point,
         LightSample&                        light_sample) const;
+
+    void sample_light_cache(
+        const ShadingRay::Time&             time,
+        const foundation::Vector3f&         s,
+        const ShadingPoint&                 shading_point,
+        LightSample&                        light_sample) const;
 };
 
 
@@ -114,7 +130,8 @@ inline bool BackwardLightSampler::has_lights() const
     return
         m_non_physical_lights_cdf.valid() ||
         !m_emitting_shapes.empty() ||
-        !m_light_tree_lights.empty();
+        !m_light_tree_lights.empty() ||
+        !m_light_cache_lights.empty();
 }
 
 inline bool BackwardLightSampler::has_hittable_lights() const
@@ -124,7 +141,10 @@ inline bool BackwardLightSampler::has_hittable_lights() const
 
 inline bool BackwardLightSampler::has_lightset() const
 {
-    return !m_emitting_shapes.empty() || !m_light_tree_lights.empty();
+    return
+        !m_emitting_shapes.empty() ||
+        !m_light_tree_lights.empty() ||
+        !m_light_cache_lights.empty();
 }
 
 }   // namespace renderer
@@ -0,0 +1,191 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "backwardlightsamplercache.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/edf/edf.h"
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/transform.h"
+#include "foundation/utility/siphash.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// BackwardLightSamplerCache class implementation.
+//
+
+namespace
+{
+    uint64 combine_transform(uint64 signature, const Transformd& transform)
+    {
+        return
+            Entity::combine_signatures(
+                signature,
+                siphash24(&transform.get_local_to_parent(), sizeof(Matrix4d)));
+    }
+
+    uint64 combine_material(uint64 signature, const Material& material)
+    {
+        signature = Entity::combine_signatures(signature, material.compute_signature());
+
+        if (const EDF* edf = material.get_uncached_edf())
+            signature = Entity::combine_signatures(signature, edf->compute_signature());
+
+        if (const ShaderGroup* sg = material.get_uncached_osl_surface())
+            signature = Entity::combine_signatures(signature, sg->compute_signature());
+
+        return signature;
+    }
+
+    uint64 combine_materials(uint64 signature, const MaterialArray& materials)
+    {
+        for (size_t i = 0, e = materials.size(); i < e; ++i)
+        {
+            // Only light-emitting materials are referenced by the light sampler.
+            const Material* material = materials[i];
+            if (material != nullptr && material->has_emission())
+                signature = combine_material(signature, *material);
+            else signature = Entity::combine_signatures(signature, 0);
+        }
+
+        return signature;
+    }
+
+    uint64 combine_emitters(uint64 signature, const Assembly& assembly)
+    {
+        for (const Light& light : assembly.lights())
+        {
+            signature = Entity::combine_signatures(signature, light.compute_signature());
+            signature = combine_transform(signature, light.get_transform());
+        }
+
+        for (const ObjectInstance& object_instance : assembly.object_instances())
+        {
+            const MaterialArray& front_materials = object_instance.get_front_materials();
+            const MaterialArray& back_materials = object_instance.get_back_materials();
+
+            if (!has_emitting_materials(front_materials) && !has_emitting_materials(back_materials))
+                continue;
+
+            signature = Entity::combine_signatures(signature, object_instance.compute_signature());
+            signature = combine_transform(signature, object_instance.get_transform());
+            signature = combine_materials(signature, front_materials);
+            signature = combine_materials(signature, back_materials);
+        }
+
+        return signature;
+    }
+
+    uint64 combine_emitters(uint64 signature, const AssemblyInstanceContainer& assembly_instances)
+    {
+        for (const AssemblyInstance& assembly_instance : assembly_instances)
+        {
+            const Assembly& assembly = assembly_instance.get_assembly();
+
+            signature = Entity::combine_signatures(signature, assembly_instance.compute_signature());
+            signature = Entity::combine_signatures(signature, assembly.compute_signature());
+
+            const TransformSequence& transform_sequence = assembly_instance.transform_sequence();
+            for (size_t i = 0, e = transform_sequence.size(); i < e; ++i)
+            {
+                float time;
+                Transformd transform;
+                transform_sequence.get_transform(i, time, transform);
+                signature = Entity::combine_signatures(signature, siphash24(time));
+                signature = combine_transform(signature, transform);
+            }
+
+            signature = combine_emitters(signature, assembly.assembly_instances());
+            signature = combine_emitters(signature, assembly);
+        }
+
+        return signature;
+    }
+}
+
+BackwardLightSamplerCache::BackwardLightSamplerCache()
+  : m_signature(0)
+{
+}
+
+uint64 BackwardLightSamplerCache::compute_signature(const Scene& scene)
+{
+    return combine_emitters(0, scene.assembly_instances());
+}
+
+BackwardLightSampler& BackwardLightSamplerCache::get(
+    const Scene&            scene,
+    const ParamArray&       params)
+{
+    const uint64 signature = compute_signature(scene);
+
+    if (m_light_sampler.get() != nullptr &&
+        m_signature == signature &&
+        m_params == params)
+    {
+        RENDERER_LOG_DEBUG("light emitters are unchanged, reusing light sampler.");
+        return *m_light_sampler;
+    }
+
+    // Release the previous light sampler before building a new one to keep the memory peak low.
+    m_light_sampler.reset();
+    m_light_sampler.reset(new BackwardLightSampler(scene, params));
+    m_signature = signature;
+    m_params = params;
+
+    return *m_light_sampler;
+}
+
+void BackwardLightSamplerCache::clear()
+{
+    m_light_sampler.reset();
+    m_signature = 0;
+    m_params.clear();
+}
+
+}   // namespace renderer
@@ -0,0 +1,86 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/backwardlightsampler.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <memory>
+
+// Forward declarations.
+namespace renderer      { class Scene; }
+
+namespace renderer
+{
+
+//
+// Keeps a backward light sampler alive across render sessions so that edits that
+// don't affect light emitters (e.g. tweaking a non-emitting material or a texture)
+// don't force the light sampler and its light tree to be rebuilt.
+//
+// The light sampler is rebuilt whenever the signature of the light emitters of the
+// scene changes. This signature covers the non-physical lights, the object instances
+// with light-emitting materials, the emitting materials themselves and their EDFs or
+// OSL surfaces, and the transforms of all the assembly instances leading to them.
+//
+
+class BackwardLightSamplerCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    BackwardLightSamplerCache();
+
+    // Compute the signature of the light emitters of a scene.
+    // Must be called after the scene's on_render_begin() method.
+    static foundation::uint64 compute_signature(const Scene& scene);
+
+    // Return a light sampler for a given scene, only building a new one if the light
+    // emitters of the scene or the parameters changed since the last call.
+    // Must be called after the scene's on_render_begin() method.
+    BackwardLightSampler& get(
+        const Scene&                            scene,
+        const ParamArray&                       params);
+
+    // Release the cached light sampler.
+    void clear();
+
+  private:
+    std::unique_ptr<BackwardLightSampler>       m_light_sampler;
+    foundation::uint64                          m_signature;
+    ParamArray                                  m_params;
+};
+
+}   // namespace renderer
@@ -35,6 +35,7 @@
 #include "renderer/kernel/lighting/tracer.h"
 #include "renderer/kernel/shading/shadingcomponents.h"
 #include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/material/material.h"
@@ -42,10 +43,15 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/fp.h"
+#include "foundation/math/hash.h"
 #include "foundation/math/population.h"
 #include "foundation/utility/arena.h"
 #include "foundation/utility/statistics.h"
 
+// Standard headers.
+#include <memory>
+#include <vector>
+
 using namespace foundation;
 using namespace std;
 
@@ -114,8 +120,15 @@ namespace
         {
             const size_t    m_max_bounces;                  // maximum number of bounces, ~0 for unlimited
 
+            const bool      m_enable_light_vertex_cache;    // connect camera vertices to vertices of a shared pool of light subpaths?
+            const size_t    m_light_vertex_cache_paths;     // number of light subpaths in the pool
+            const size_t    m_light_vertex_connections;     // number of cached light vertices each camera vertex connects to
+
             explicit Parameters(const ParamArray& params)
-                : m_max_bounces(fixup_bounces(params.get_optional<int>("max_bounces", 8)))
+              : m_max_bounces(fixup_bounces(params.get_optional<int>("max_bounces", 8)))
+              , m_enable_light_vertex_cache(params.get_optional<bool>("enable_light_vertex_cache", false))
+              , m_light_vertex_cache_paths(max(params.get_optional<size_t>("light_vertex_cache_paths", 256), size_t(1)))
+              , m_light_vertex_connections(max(params.get_optional<size_t>("light_vertex_connections", 1), size_t(1)))
             {
             }
 
@@ -131,6 +144,8 @@ namespace
             const ParamArray&           params)
           : m_light_sampler(light_sampler)
           , m_params(params)
+          , m_cache_served_paths(0)
+          , m_cache_refresh_count(0)
         {
             const Camera* camera = project.get_uncached_active_camera();
             m_shutter_open_begin_time = camera->get_shutter_open_begin_time();
@@ -156,6 +171,12 @@ namespace
             ShadingComponents&          radiance,               // output radiance, in W.sr^-1.m^-2
             AOVComponents&              aov_components) override
         {
+            if (m_params.m_enable_light_vertex_cache)
+            {
+                compute_lighting_from_cache(sampling_context, shading_context, shading_point, radiance);
+                return;
+            }
+
             /// TODO:: use arena to alloc BDPTVertices instead
             BDPTVertex* camera_vertices = new BDPTVertex[m_num_max_vertices - 1];
             BDPTVertex* light_vertices = new BDPTVertex[m_num_max_vertices];
@@ -171,7 +192,7 @@ namespace
                 for (size_t t = 2; t < num_camera_vertices + 2; t++)
                 {
                     if (s + t <= m_num_max_vertices)
-                        connect(shading_context, shading_point, light_vertices, camera_vertices, s, t, radiance);
+                        connect(shading_context, shading_point, light_vertices, camera_vertices, s, t, 1.0f, radiance);
                 }
             }
 
@@ -179,6 +200,193 @@ namespace
             delete[] light_vertices;
         }
 
+        //
+        // Light vertex cache.
+        //
+        // Instead of tracing a fresh light subpath for every camera subpath, a pool of light
+        // subpaths is traced once and its vertices are stored contiguously. Each camera vertex
+        // is then connected to randomly chosen cached vertices, the chosen vertex determining
+        // the length of the light subpath prefix used by the connection. Picking one of the
+        // N_v cached vertices uniformly among those of N_p subpaths and weighting by N_v / N_p
+        // keeps the estimator unbiased.
+        //
+        // The pool belongs to this lighting engine, i.e. to one rendering thread, and is
+        // refreshed after it has served as many camera subpaths as it holds light subpaths.
+        // BSDF inputs don't outlive the arena they were evaluated in, so they are evaluated
+        // again, in a private arena, for the vertices of the prefix actually connected to.
+        //
+
+        void compute_lighting_from_cache(
+            SamplingContext&            sampling_context,
+            const ShadingContext&       shading_context,
+            const ShadingPoint&         shading_point,
+            ShadingComponents&          radiance)
+        {
+            if (m_cache_served_paths == 0)
+                refresh_light_vertex_cache(shading_context);
+
+            if (++m_cache_served_paths == m_params.m_light_vertex_cache_paths)
+                m_cache_served_paths = 0;
+
+            if (m_camera_vertices == nullptr)
+            {
+                m_camera_vertices.reset(new BDPTVertex[m_num_max_vertices - 1]);
+                m_light_vertices.reset(new BDPTVertex[m_num_max_vertices]);
+            }
+
+            for (size_t i = 0; i < m_num_max_vertices - 1; ++i)
+                m_camera_vertices[i] = BDPTVertex();
+
+            const size_t num_camera_vertices =
+                trace_camera(sampling_context, shading_context, shading_point, m_camera_vertices.get());
+
+            // Camera subpaths that hit a light by themselves.
+            for (size_t t = 2; t < num_camera_vertices + 2; ++t)
+                connect(shading_context, shading_point, nullptr, m_camera_vertices.get(), 0, t, 1.0f, radiance);
+
+            const size_t num_cached_vertices = m_cache_vertices.size();
+            if (num_cached_vertices == 0)
+                return;
+
+            const size_t connection_count = m_params.m_light_vertex_connections;
+            const float connection_weight =
+                static_cast<float>(num_cached_vertices) /
+                static_cast<float>(m_params.m_light_vertex_cache_paths * connection_count);
+
+            const ShadingContext cache_shading_context(
+                shading_context.get_intersector(),
+                shading_context.get_tracer(),
+                shading_context.get_texture_cache(),
+                shading_context.get_oiio_texture_system(),
+                shading_context.get_osl_shadergroup_exec(),
+                m_cache_arena,
+                shading_context.get_thread_index(),
+                shading_context.get_lighting_engine(),
+                shading_context.get_transparency_threshold(),
+                shading_context.get_max_iterations());
+
+            sampling_context.split_in_place(1, num_camera_vertices * connection_count);
+
+            for (size_t t = 2; t < num_camera_vertices + 2; ++t)
+            {
+                for (size_t i = 0; i < connection_count; ++i)
+                {
+                    // Pick a cached light vertex uniformly.
+                    const size_t vertex_index =
+                        min(
+                            truncate<size_t>(sampling_context.next2<float>() * num_cached_vertices),
+                            num_cached_vertices - 1);
+                    const size_t path_begin = m_cache_path_begin[vertex_index];
+                    const size_t s = vertex_index - path_begin + 1;
+
+                    if (s + t > m_num_max_vertices)
+                        continue;
+
+                    load_cached_light_subpath(cache_shading_context, path_begin, s);
+
+                    connect(
+                        shading_context,
+                        shading_point,
+                        m_light_vertices.get(),
+                        m_camera_vertices.get(),
+                        s,
+                        t,
+                        connection_weight,
+                        radiance);
+                }
+            }
+        }
+
+        void refresh_light_vertex_cache(const ShadingContext& shading_context)
+        {
+            const ShadingContext cache_shading_context(
+                shading_context.get_intersector(),
+                shading_context.get_tracer(),
+                shading_context.get_texture_cache(),
+                shading_context.get_oiio_texture_system(),
+                shading_context.get_osl_shadergroup_exec(),
+                m_cache_arena,
+                shading_context.get_thread_index(),
+                shading_context.get_lighting_engine(),
+                shading_context.get_transparency_threshold(),
+                shading_context.get_max_iterations());
+
+            // Every rendering thread gets its own, fresh, sequence of light subpaths.
+            SamplingContext::RNGType rng(
+                hash_uint64(m_cache_refresh_count),
+                hash_uint64(shading_context.get_thread_index()) | 1);
+
+            m_cache_vertices.clear();
+            m_cache_path_begin.clear();
+
+            unique_ptr<BDPTVertex[]> path_vertices(new BDPTVertex[m_num_max_vertices]);
+
+            for (size_t i = 0; i < m_params.m_light_vertex_cache_paths; ++i)
+            {
+                m_cache_arena.clear();
+
+                for (size_t j = 0; j < m_num_max_vertices; ++j)
+                    path_vertices[j] = BDPTVertex();
+
+                SamplingContext sampling_context(
+                    rng,
+                    SamplingContext::RNGMode,
+                    i);                         // initial instance number
+
+                const size_t num_vertices =
+                    trace_light(sampling_context, cache_shading_context, path_vertices.get());
+
+                const size_t path_begin = m_cache_vertices.size();
+
+                for (size_t j = 0; j < num_vertices; ++j)
+                {
+                    // The BSDF inputs won't survive the next arena reset.
+                    BDPTVertex& vertex = path_vertices[j];
+                    vertex.m_bsdf_data = nullptr;
+                    vertex.m_prev_vertex = nullptr;
+
+                    m_cache_vertices.push_back(vertex);
+                    m_cache_path_begin.push_back(static_cast<uint32>(path_begin));
+                }
+            }
+
+            m_cache_vertex_count.insert(m_cache_vertices.size());
+            ++m_cache_refresh_count;
+        }
+
+        void load_cached_light_subpath(
+            const ShadingContext&       cache_shading_context,
+            const size_t                path_begin,
+            const size_t                vertex_count)
+        {
+            m_cache_arena.clear();
+
+            for (size_t i = 0; i < vertex_count; ++i)
+            {
+                BDPTVertex& vertex = m_light_vertices[i];
+                vertex = m_cache_vertices[path_begin + i];
+
+                if (vertex.m_bsdf == nullptr)
+                    continue;
+
+                // Evaluate the BSDF inputs again, the same way the path tracer does.
+                const Material* material = vertex.m_shading_point.get_material();
+                if (material != nullptr)
+                {
+                    const Material::RenderData& material_data = material->get_render_data();
+                    if (material_data.m_shader_group)
+                    {
+                        cache_shading_context.execute_osl_shading(
+                            *material_data.m_shader_group,
+                            vertex.m_shading_point);
+                    }
+                }
+
+                vertex.m_bsdf_data =
+                    vertex.m_bsdf->evaluate_inputs(cache_shading_context, vertex.m_shading_point);
+            }
+        }
+
         // todo: use an output parameter instead of returning a spectrum.
         Spectrum compute_geometry_term(
             const ShadingContext&       shading_context,
@@ -343,6 +551,7 @@ namespace
             BDPTVertex*                 camera_vertices,
             const size_t                s,
             const size_t                t,
+            const float                 weight,
             ShadingComponents&          radiance)
         {
             assert(t >= 2);
@@ -447,7 +656,7 @@ namespace
             const float mis_weight = numerator / denominator;
 
             assert(mis_weight <= 1.0f);
-            radiance.m_beauty += mis_weight * result;
+            radiance.m_beauty += (weight * mis_weight) * result;
         }
 
         size_t trace_light(
@@ -636,6 +845,12 @@ namespace
         {
             Statistics stats;
 
+            if (m_params.m_enable_light_vertex_cache)
+            {
+                stats.insert("cache refreshes", m_cache_refresh_count);
+                stats.insert("cached vertices", m_cache_vertex_count);
+            }
+
             return StatisticsVector::make("bdpt statistics", stats);
         }
 
@@ -652,6 +867,16 @@ namespace
 
         size_t                      m_num_max_vertices;
 
+        // Light vertex cache.
+        Arena                       m_cache_arena;
+        vector<BDPTVertex>          m_cache_vertices;
+        vector<uint32>              m_cache_path_begin;             // index of the first vertex of each cached vertex's subpath
+        unique_ptr<BDPTVertex[]>    m_camera_vertices;
+        unique_ptr<BDPTVertex[]>    m_light_vertices;
+        size_t                      m_cache_served_paths;
+        uint64                      m_cache_refresh_count;
+        Population<uint64>          m_cache_vertex_count;
+
         struct PathVisitor
         {
             const ShadingContext&           m_shading_context;
@@ -766,6 +991,32 @@ Dictionary BDPTLightingEngineFactory::get_params_metadata()
             .insert("label", "Max Bounces")
             .insert("help", "Maximum number of bounces"));
 
+    metadata.dictionaries().insert(
+        "enable_light_vertex_cache",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Light Vertex Cache")
+            .insert("help", "Connect camera vertices to vertices of a shared pool of light subpaths"));
+
+    metadata.dictionaries().insert(
+        "light_vertex_cache_paths",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "256")
+            .insert("min", "1")
+            .insert("label", "Light Vertex Cache Paths")
+            .insert("help", "Number of light subpaths traced into the light vertex cache"));
+
+    metadata.dictionaries().insert(
+        "light_vertex_connections",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1")
+            .insert("min", "1")
+            .insert("label", "Light Vertex Connections")
+            .insert("help", "Number of cached light vertices each camera vertex connects to"));
+
     metadata.dictionaries().insert(
         "dl_light_samples",
         Dictionary()
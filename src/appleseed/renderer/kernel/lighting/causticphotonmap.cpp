@@ -0,0 +1,233 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "causticphotonmap.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/pathvertex.h"
+#include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/shading/directshadingcomponents.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/basis.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/job/iabortswitch.h"
+
+// Standard headers.
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Settings of the photon tracer, derived from the settings of the path tracer.
+    SPPMParameters make_photon_tracing_params(const ParamArray& params)
+    {
+        ParamArray sppm_params(params);
+        sppm_params.insert("photon_type", "poly");
+        sppm_params.insert("dl_mode", "rt");
+        sppm_params.insert("enable_caustics", true);
+        sppm_params.insert("caustic_photons_only", true);
+        sppm_params.insert("enable_importance_emission", false);
+        sppm_params.insert("light_photons_per_pass", params.get_optional<size_t>("caustic_photons_per_pass", 250000));
+        sppm_params.insert("env_photons_per_pass", params.get_optional<size_t>("caustic_photons_per_pass", 250000));
+        sppm_params.insert("initial_radius", params.get_optional<float>("caustic_photon_map_initial_radius", 0.1f));
+        sppm_params.insert("alpha", params.get_optional<float>("caustic_photon_map_alpha", 0.7f));
+        sppm_params.insert("max_photons_per_estimate", params.get_optional<size_t>("caustic_photon_map_max_photons", 100));
+        return SPPMParameters(sppm_params);
+    }
+
+    // Epanechnikov kernel, see sppmlightingengine.cpp.
+    float epanechnikov2d(const float r2)
+    {
+        return RcpHalfPi<float>() * (1.0f - r2);
+    }
+}
+
+
+//
+// CausticPhotonMap class implementation.
+//
+
+CausticPhotonMap::CausticPhotonMap(
+    const Scene&                    scene,
+    const ForwardLightSampler&      light_sampler,
+    const TraceContext&             trace_context,
+    TextureStore&                   texture_store,
+    OIIOTextureSystem&              oiio_texture_system,
+    OSLShadingSystem&               shading_system,
+    const ParamArray&               params)
+  : m_params(make_photon_tracing_params(params))
+  , m_photon_tracer(
+        scene,
+        light_sampler,
+        trace_context,
+        texture_store,
+        oiio_texture_system,
+        shading_system,
+        m_params)
+  , m_pass_number(0)
+  , m_photons_memory_record(MemoryTagPhotons)
+{
+    // The initial lookup radius is a percentage of the scene diameter.
+    const float scene_diameter = static_cast<float>(scene.compute_bbox().diameter());
+    m_initial_lookup_radius = scene_diameter * m_params.m_initial_radius_percents / 100.0f;
+    m_lookup_radius = m_initial_lookup_radius;
+}
+
+void CausticPhotonMap::build(
+    const uint32                    pass_hash,
+    JobQueue&                       job_queue,
+    IAbortSwitch&                   abort_switch)
+{
+    m_photon_map.reset();
+
+    m_photons.clear_keep_memory();
+    m_photon_tracer.trace_photons(
+        m_photons,
+        nullptr,                    // no visibility grid
+        pass_hash,
+        job_queue,
+        abort_switch);
+
+    m_photons_memory_record.set(m_photons.get_memory_size());
+
+    if (abort_switch.is_aborted())
+        return;
+
+    MemoryTagScope memory_tag_scope(MemoryTagPhotons);
+    m_photon_map.reset(
+        new SPPMPhotonMap(
+            m_photons,
+            m_params.m_photon_map_type,
+            m_lookup_radius));
+}
+
+void CausticPhotonMap::shrink_lookup_radius()
+{
+    const float k = (m_pass_number + m_params.m_alpha) / (m_pass_number + 1);
+    assert(k <= 1.0f);
+    m_lookup_radius *= sqrt(k);
+
+    ++m_pass_number;
+}
+
+bool CausticPhotonMap::estimate_radiance(
+    const PathVertex&               vertex,
+    knn::Answer<float>&             answer,
+    Spectrum&                       radiance) const
+{
+    if (!m_photon_map || m_photon_map->empty() || m_lookup_radius <= 0.0f)
+        return false;
+
+    // Find the nearby photons around the path vertex.
+    const float square_radius = m_lookup_radius * m_lookup_radius;
+    m_photon_map->query(Vector3f(vertex.get_point()), square_radius, answer);
+    const size_t photon_count = answer.size();
+
+    if (photon_count == 0)
+        return false;
+
+    // Compute the square radius of the lookup disk.
+    float max_square_dist;
+    if (photon_count < m_params.m_max_photons_per_estimate)
+        max_square_dist = square_radius;
+    else
+    {
+        max_square_dist = 0.0f;
+        for (size_t i = 0; i < photon_count; ++i)
+        {
+            const float square_dist = answer.get(i).m_square_dist;
+            if (max_square_dist < square_dist)
+                max_square_dist = square_dist;
+        }
+    }
+
+    if (max_square_dist <= 0.0f)
+        return false;
+
+    const float rcp_max_square_dist = 1.0f / max_square_dist;
+    const Vector3f normal(vertex.get_geometric_normal());
+
+    radiance.set(0.0f);
+
+    for (size_t i = 0; i < photon_count; ++i)
+    {
+        const knn::Answer<float>::Entry& entry = answer.get(i);
+        const SPPMPolyPhoton& photon = m_photons.m_poly_photons[m_photon_map->remap(entry.m_index)];
+
+        // Reject photons from the opposite hemisphere as they won't contribute.
+        if (dot(normal, photon.m_incoming) <= 0.0f)
+            continue;
+
+        // Reject photons on a surface with too different an orientation.
+        const float NormalThreshold = 1.0e-3f;
+        if (dot(normal, photon.m_geometric_normal) < NormalThreshold)
+            continue;
+
+        // Evaluate the diffuse component of the BSDF for this photon.
+        DirectShadingComponents bsdf_value;
+        const float bsdf_prob =
+            vertex.m_bsdf->evaluate(
+                vertex.m_bsdf_data,
+                false,                                      // not adjoint
+                true,                                       // multiply by |cos(incoming, normal)|
+                Vector3f(vertex.get_geometric_normal()),
+                Basis3f(vertex.get_shading_basis()),
+                Vector3f(vertex.m_outgoing.get_value()),    // toward the camera
+                normalize(photon.m_incoming),               // toward the light
+                ScatteringMode::Diffuse,
+                bsdf_value);
+        if (bsdf_prob == 0.0f)
+            continue;
+
+        // The photons store flux: divide by the projected area to get reflected radiance.
+        bsdf_value.m_beauty /= abs(dot(photon.m_incoming, photon.m_geometric_normal));
+        bsdf_value.m_beauty *= photon.m_flux;
+        bsdf_value.m_beauty *= epanechnikov2d(entry.m_square_dist * rcp_max_square_dist);
+
+        radiance += bsdf_value.m_beauty;
+    }
+
+    // Estimate photon density.
+    radiance *= rcp_max_square_dist;
+
+    return true;
+}
+
+}   // namespace renderer
@@ -0,0 +1,146 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
+#include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
+#include "renderer/kernel/lighting/sppm/sppmphotontracer.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/knn.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/allocator.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class ForwardLightSampler; }
+namespace renderer      { class OIIOTextureSystem; }
+namespace renderer      { class OSLShadingSystem; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class PathVertex; }
+namespace renderer      { class Scene; }
+namespace renderer      { class TextureStore; }
+namespace renderer      { class TraceContext; }
+
+namespace renderer
+{
+
+//
+// A photon map holding caustic photons only, i.e. photons that reached a non-specular
+// surface after one or more glossy or specular bounces, for the path tracer to look up
+// at diffuse vertices instead of tracing the caustic paths itself.
+//
+// A new set of photons is traced before each pass and the lookup radius shrinks from
+// pass to pass like in stochastic progressive photon mapping, so that the estimates
+// become sharper as rendering progresses.
+//
+
+class CausticPhotonMap
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    CausticPhotonMap(
+        const Scene&                    scene,
+        const ForwardLightSampler&      light_sampler,
+        const TraceContext&             trace_context,
+        TextureStore&                   texture_store,
+        OIIOTextureSystem&              oiio_texture_system,
+        OSLShadingSystem&               shading_system,
+        const ParamArray&               params);
+
+    // Trace a new set of caustic photons and rebuild the map.
+    void build(
+        const foundation::uint32        pass_hash,
+        foundation::JobQueue&           job_queue,
+        foundation::IAbortSwitch&       abort_switch);
+
+    // Shrink the lookup radius at the end of a pass.
+    void shrink_lookup_radius();
+
+    // Return the number of photons in the map.
+    size_t size() const;
+
+    // Return the current lookup radius.
+    float get_lookup_radius() const;
+
+    // Return the maximum number of photons per estimate, i.e. the capacity lookup answers need.
+    size_t get_max_photons_per_estimate() const;
+
+    // Estimate the caustic radiance reflected toward the outgoing direction of a path
+    // vertex by the diffuse component of its BSDF. Return false if no photon was found.
+    bool estimate_radiance(
+        const PathVertex&               vertex,
+        foundation::knn::Answer<float>& answer,
+        Spectrum&                       radiance) const;
+
+  private:
+    const SPPMParameters                m_params;
+    SPPMPhotonTracer                    m_photon_tracer;
+    size_t                              m_pass_number;
+    SPPMPhotonVector                    m_photons;
+    TaggedMemoryRecord                  m_photons_memory_record;
+    std::unique_ptr<SPPMPhotonMap>      m_photon_map;
+    float                               m_initial_lookup_radius;
+    float                               m_lookup_radius;
+};
+
+
+//
+// CausticPhotonMap class implementation.
+//
+
+inline size_t CausticPhotonMap::size() const
+{
+    // The photon positions are moved into the photon map, count the photons themselves.
+    return m_photons.m_poly_photons.size();
+}
+
+inline float CausticPhotonMap::get_lookup_radius() const
+{
+    return m_lookup_radius;
+}
+
+inline size_t CausticPhotonMap::get_max_photons_per_estimate() const
+{
+    return m_params.m_max_photons_per_estimate;
+}
+
+}   // namespace renderer
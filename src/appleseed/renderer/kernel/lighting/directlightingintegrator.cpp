@@ -44,11 +44,13 @@
 #include "renderer/modeling/scene/visibilityflags.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/population.h"
 #include "foundation/math/rr.h"
 #include "foundation/math/scalar.h"
 
 // Standard headers.
 #include <cassert>
+#include <algorithm>
 #include <cmath>
 
 using namespace foundation;
@@ -68,12 +70,34 @@ namespace renderer
 //   compute_outgoing_radiance_light_sampling_low_variance
 //       add_emitting_shape_sample_contribution
 //       add_non_physical_light_sample_contribution
+//       add_lightset_sample_contributions
+//           add_emitting_shape_sample_contribution
+//           add_non_physical_light_sample_contribution
+//           add_resampled_lightset_sample_contribution
+//               evaluate_emitting_shape_candidate
+//               evaluate_non_physical_light_candidate
+//       compute_adaptive_batch_size
 //
 //   compute_outgoing_radiance_combined_sampling_low_variance
 //       compute_outgoing_radiance_material_sampling
 //       compute_outgoing_radiance_light_sampling_low_variance
 //
 
+// A light sample together with its unoccluded contribution.
+struct DirectLightingIntegrator::LightCandidate
+{
+    LightSample                 m_sample;
+    Vector3d                    m_emission_position;    // target of the shadow ray
+    DirectShadingComponents     m_material_value;
+    Spectrum                    m_light_value;          // includes MIS weight and division by the sample's PDF
+    float                       m_weight;               // resampling weight
+
+    LightCandidate()
+      : m_light_value(Spectrum::Illuminance)
+    {
+    }
+};
+
 DirectLightingIntegrator::DirectLightingIntegrator(
     const ShadingContext&           shading_context,
     const BackwardLightSampler&     light_sampler,
@@ -82,6 +106,9 @@ DirectLightingIntegrator::DirectLightingIntegrator(
     const int                       light_sampling_modes,
     const size_t                    material_sample_count,
     const size_t                    light_sample_count,
+    const size_t                    light_candidate_count,
+    const size_t                    max_light_sample_count,
+    const float                     light_sample_error_threshold,
     const float                     low_light_threshold,
     const bool                      indirect)
   : m_shading_context(shading_context)
@@ -91,6 +118,9 @@ DirectLightingIntegrator::DirectLightingIntegrator(
   , m_light_sampling_modes(light_sampling_modes)
   , m_material_sample_count(material_sample_count)
   , m_light_sample_count(light_sample_count)
+  , m_light_candidate_count(light_candidate_count)
+  , m_max_light_sample_count(max_light_sample_count)
+  , m_light_sample_error_threshold(light_sample_error_threshold)
   , m_low_light_threshold(low_light_threshold)
   , m_indirect(indirect)
 {
@@ -158,46 +188,32 @@ void DirectLightingIntegrator::compute_outgoing_radiance_light_sampling_low_vari
     }
 
     // Add contributions from the light set.
-    if (m_light_sampler.has_lightset())
+    if (m_light_sampler.has_lightset() && m_light_sample_count > 0)
     {
         DirectShadingComponents lightset_radiance;
+        Population<float> sample_values;
+        size_t sample_count = 0;
 
-        sampling_context.split_in_place(3, m_light_sample_count);
-
-        for (size_t i = 0, e = m_light_sample_count; i < e; ++i)
+        // Take the requested number of samples. In adaptive mode, keep doubling the number
+        // of samples until the relative standard error of the estimate is low enough.
+        size_t batch_size = m_light_sample_count;
+        while (batch_size > 0)
         {
-            // Sample the light set.
-            LightSample sample;
-            m_light_sampler.sample_lightset(
-                m_time,
-                sampling_context.next2<Vector3f>(),
-                m_material_sampler.get_shading_point(),
-                sample);
+            add_lightset_sample_contributions(
+                sampling_context,
+                mis_heuristic,
+                outgoing,
+                batch_size,
+                lightset_radiance,
+                sample_values,
+                light_path_stream);
 
-            // Add the contribution of the chosen light.
-            if (sample.m_shape)
-            {
-                add_emitting_shape_sample_contribution(
-                    sampling_context,
-                    sample,
-                    mis_heuristic,
-                    outgoing,
-                    lightset_radiance,
-                    light_path_stream);
-            }
-            else
-            {
-                add_non_physical_light_sample_contribution(
-                    sampling_context,
-                    sample,
-                    outgoing,
-                    lightset_radiance,
-                    light_path_stream);
-            }
+            sample_count += batch_size;
+            batch_size = compute_adaptive_batch_size(sample_count, sample_values);
         }
 
-        if (m_light_sample_count > 1)
-            lightset_radiance /= static_cast<float>(m_light_sample_count);
+        if (sample_count > 1)
+            lightset_radiance /= static_cast<float>(sample_count);
 
         radiance += lightset_radiance;
     }
@@ -546,4 +562,318 @@ void DirectLightingIntegrator::add_non_physical_light_sample_contribution(
     }
 }
 
+void DirectLightingIntegrator::add_lightset_sample_contributions(
+    SamplingContext&            sampling_context,
+    const MISHeuristic          mis_heuristic,
+    const Dual3d&               outgoing,
+    const size_t                sample_count,
+    DirectShadingComponents&    radiance,
+    Population<float>&          sample_values,
+    LightPathStream*            light_path_stream) const
+{
+    if (m_light_candidate_count > 1)
+    {
+        for (size_t i = 0; i < sample_count; ++i)
+        {
+            DirectShadingComponents sample_radiance;
+            add_resampled_lightset_sample_contribution(
+                sampling_context,
+                mis_heuristic,
+                outgoing,
+                sample_radiance,
+                light_path_stream);
+
+            radiance += sample_radiance;
+            sample_values.insert(average_value(sample_radiance.m_beauty));
+        }
+
+        return;
+    }
+
+    sampling_context.split_in_place(3, sample_count);
+
+    for (size_t i = 0; i < sample_count; ++i)
+    {
+        // Sample the light set.
+        LightSample sample;
+        m_light_sampler.sample_lightset(
+            m_time,
+            sampling_context.next2<Vector3f>(),
+            m_material_sampler.get_shading_point(),
+            sample);
+
+        // Add the contribution of the chosen light.
+        DirectShadingComponents sample_radiance;
+        if (sample.m_shape)
+        {
+            add_emitting_shape_sample_contribution(
+                sampling_context,
+                sample,
+                mis_heuristic,
+                outgoing,
+                sample_radiance,
+                light_path_stream);
+        }
+        else
+        {
+            add_non_physical_light_sample_contribution(
+                sampling_context,
+                sample,
+                outgoing,
+                sample_radiance,
+                light_path_stream);
+        }
+
+        radiance += sample_radiance;
+        sample_values.insert(average_value(sample_radiance.m_beauty));
+    }
+}
+
+size_t DirectLightingIntegrator::compute_adaptive_batch_size(
+    const size_t                sample_count,
+    const Population<float>&    sample_values) const
+{
+    // Adaptive sampling is disabled or the sample budget is exhausted.
+    if (sample_count >= m_max_light_sample_count)
+        return 0;
+
+    // At least two samples are needed to estimate the variance.
+    if (sample_count < 2)
+        return 1;
+
+    // No light reaches this point, for instance because all samples were occluded.
+    const double mean = sample_values.get_mean();
+    if (mean <= 0.0)
+        return 0;
+
+    // Stop once the relative standard error of the mean is below the threshold.
+    const double relative_error =
+        sample_values.get_dev() / (mean * sqrt(static_cast<double>(sample_count)));
+    if (relative_error <= m_light_sample_error_threshold)
+        return 0;
+
+    return min(sample_count, m_max_light_sample_count - sample_count);
+}
+
+void DirectLightingIntegrator::add_resampled_lightset_sample_contribution(
+    SamplingContext&            sampling_context,
+    const MISHeuristic          mis_heuristic,
+    const Dual3d&               outgoing,
+    DirectShadingComponents&    radiance,
+    LightPathStream*            light_path_stream) const
+{
+    // Generate a uniform sample in [0,1) to select a candidate.
+    sampling_context.split_in_place(1, 1);
+    float s = sampling_context.next2<float>();
+
+    sampling_context.split_in_place(3, m_light_candidate_count);
+
+    // Stream through the candidates and keep one of them with a probability proportional
+    // to its weight. The uniform sample is rescaled after each decision so that a single
+    // sample is enough for the whole stream.
+    LightCandidate chosen;
+    float weight_sum = 0.0f;
+    for (size_t i = 0, e = m_light_candidate_count; i < e; ++i)
+    {
+        LightCandidate candidate;
+        m_light_sampler.sample_lightset(
+            m_time,
+            sampling_context.next2<Vector3f>(),
+            m_material_sampler.get_shading_point(),
+            candidate.m_sample);
+
+        const bool valid =
+            candidate.m_sample.m_shape
+                ? evaluate_emitting_shape_candidate(mis_heuristic, outgoing, candidate)
+                : evaluate_non_physical_light_candidate(sampling_context, outgoing, candidate);
+        if (!valid)
+            continue;
+
+        weight_sum += candidate.m_weight;
+
+        const float keep_prob = candidate.m_weight / weight_sum;
+        if (s < keep_prob)
+        {
+            chosen = candidate;
+            s /= keep_prob;
+        }
+        else s = (s - keep_prob) / (1.0f - keep_prob);
+    }
+
+    // No candidate contributes.
+    if (weight_sum == 0.0f)
+        return;
+
+    // Compute the transmission factor between the chosen light sample and the shading point.
+    Spectrum transmission;
+    m_material_sampler.trace_between(
+        m_shading_context,
+        chosen.m_emission_position,
+        transmission);
+
+    // Discard occluded samples.
+    if (is_zero(transmission))
+        return;
+
+    // Add the contribution of the chosen sample to the illumination.
+    chosen.m_light_value *= transmission;
+    chosen.m_light_value *= weight_sum / (static_cast<float>(m_light_candidate_count) * chosen.m_weight);
+    madd(radiance, chosen.m_material_value, chosen.m_light_value);
+
+    // Record light path event.
+    if (light_path_stream)
+    {
+        if (chosen.m_sample.m_shape)
+        {
+            light_path_stream->sampled_emitting_shape(
+                *chosen.m_sample.m_shape,
+                chosen.m_emission_position,
+                chosen.m_material_value.m_beauty,
+                chosen.m_light_value);
+        }
+        else
+        {
+            light_path_stream->sampled_non_physical_light(
+                *chosen.m_sample.m_light,
+                chosen.m_emission_position,
+                chosen.m_material_value.m_beauty,
+                chosen.m_light_value);
+        }
+    }
+}
+
+bool DirectLightingIntegrator::evaluate_emitting_shape_candidate(
+    const MISHeuristic          mis_heuristic,
+    const Dual3d&               outgoing,
+    LightCandidate&             candidate) const
+{
+    const LightSample& sample = candidate.m_sample;
+    const Material* material = sample.m_shape->get_material();
+    const Material::RenderData& material_data = material->get_render_data();
+    const EDF* edf = material_data.m_edf;
+
+    // No contribution if we are computing indirect lighting but this light does not cast indirect light.
+    if (m_indirect && !(edf->get_flags() & EDF::CastIndirectLight))
+        return false;
+
+    // Compute the incoming direction in world space.
+    Vector3d incoming = sample.m_point - m_material_sampler.get_point();
+
+    // No contribution if the shading point is behind the light.
+    double cos_on = dot(-incoming, sample.m_shading_normal);
+    if (cos_on <= 0.0)
+        return false;
+
+    // Compute the square distance between the light sample and the shading point.
+    const double square_distance = square_norm(incoming);
+
+    // Don't use this sample if we're closer than the light near start value.
+    if (square_distance < square(edf->get_light_near_start()))
+        return false;
+
+    const double rcp_sample_square_distance = 1.0 / square_distance;
+    const double rcp_sample_distance = sqrt(rcp_sample_square_distance);
+
+    // Normalize the incoming direction.
+    cos_on *= rcp_sample_distance;
+    incoming *= rcp_sample_distance;
+
+    // Evaluate the BSDF (or volume).
+    const float material_probability =
+        m_material_sampler.evaluate(
+            m_light_sampling_modes,
+            Vector3f(outgoing.get_value()),
+            Vector3f(incoming),
+            candidate.m_material_value);
+    assert(material_probability >= 0.0f);
+    if (material_probability == 0.0f)
+        return false;
+
+    // Build a shading point on the light source.
+    ShadingPoint light_shading_point;
+    sample.make_shading_point(
+        light_shading_point,
+        sample.m_shading_normal,
+        m_shading_context.get_intersector());
+
+    if (material_data.m_shader_group)
+    {
+        m_shading_context.execute_osl_emission(
+            *material_data.m_shader_group,
+            light_shading_point);
+    }
+
+    // Evaluate the EDF.
+    edf->evaluate(
+        edf->evaluate_inputs(m_shading_context, light_shading_point),
+        Vector3f(sample.m_geometric_normal),
+        Basis3f(Vector3f(sample.m_shading_normal)),
+        -Vector3f(incoming),
+        candidate.m_light_value);
+
+    const float g = static_cast<float>(cos_on * rcp_sample_square_distance);
+
+    // Apply MIS weighting. The weight depends on the light sampler's PDF, not on the
+    // resampled one, so that it matches the weight used on the material sampling side.
+    const float mis_weight =
+        mis(
+            mis_heuristic,
+            m_light_sample_count * sample.m_probability,
+            m_material_sample_count * material_probability * g);
+
+    candidate.m_light_value *= (mis_weight * g) / sample.m_probability;
+    candidate.m_emission_position = sample.m_point;
+    candidate.m_weight = average_value(candidate.m_material_value.m_beauty * candidate.m_light_value);
+
+    return candidate.m_weight > 0.0f;
+}
+
+bool DirectLightingIntegrator::evaluate_non_physical_light_candidate(
+    SamplingContext&            sampling_context,
+    const Dual3d&               outgoing,
+    LightCandidate&             candidate) const
+{
+    const LightSample& sample = candidate.m_sample;
+    const Light* light = sample.m_light;
+
+    // No contribution if we are computing indirect lighting but this light does not cast indirect light.
+    if (m_indirect && !(light->get_flags() & Light::CastIndirectLight))
+        return false;
+
+    // Generate a uniform sample in [0,1).
+    SamplingContext child_sampling_context = sampling_context.split(2, 1);
+    const Vector2d s = child_sampling_context.next2<Vector2d>();
+
+    // Evaluate the light.
+    Vector3d emission_direction;
+    float probability;
+    light->sample(
+        m_shading_context,
+        sample.m_light_transform,
+        m_material_sampler.get_point(),
+        s,
+        candidate.m_emission_position,
+        emission_direction,
+        candidate.m_light_value,
+        probability);
+
+    // Evaluate the BSDF (or volume).
+    const float material_probability =
+        m_material_sampler.evaluate(
+            m_light_sampling_modes,
+            Vector3f(outgoing.get_value()),
+            Vector3f(-emission_direction),
+            candidate.m_material_value);
+    assert(material_probability >= 0.0f);
+    if (material_probability == 0.0f)
+        return false;
+
+    const float attenuation = light->compute_distance_attenuation(
+        m_material_sampler.get_point(), candidate.m_emission_position);
+    candidate.m_light_value *= attenuation / (sample.m_probability * probability);
+    candidate.m_weight = average_value(candidate.m_material_value.m_beauty * candidate.m_light_value);
+
+    return candidate.m_weight > 0.0f;
+}
+
 }   // namespace renderer
@@ -44,6 +44,7 @@
 #include <cstddef>
 
 // Forward declarations.
+namespace foundation    { template <typename T> class Population; }
 namespace renderer  { class BackwardLightSampler; }
 namespace renderer  { class DirectShadingComponents; }
 namespace renderer  { class LightPathStream; }
@@ -67,6 +68,20 @@ namespace renderer
 //   The number of shadow rays cast by these functions may be as high as the number of light
 //   samples passed to the constructor plus the number of non-physical lights in the scene.
 //
+// Note about resampled light sampling:
+//
+//   When more than one light candidate is requested, each light sample of the light set is
+//   chosen among that many candidates by resampled importance sampling: candidates are drawn
+//   from the light sampler and weighted by their unoccluded contribution, and a single shadow
+//   ray is cast for the chosen candidate.
+//
+// Note about adaptive light sampling:
+//
+//   When the maximum number of light samples is larger than the number of light samples, the
+//   light set is sampled until the relative standard error of the estimate falls below the
+//   given threshold or the maximum number of samples is reached. At least two samples are
+//   taken in this mode.
+//
 
 class DirectLightingIntegrator
 {
@@ -80,6 +95,9 @@ class DirectLightingIntegrator
         const int                       light_sampling_modes,
         const size_t                    material_sample_count,        // number of samples in material sampling
         const size_t                    light_sample_count,           // number of samples in light sampling
+        const size_t                    light_candidate_count,        // number of candidates per light sample, 1 to disable resampling
+        const size_t                    max_light_sample_count,       // maximum number of samples in adaptive light sampling, 0 to disable
+        const float                     light_sample_error_threshold, // relative standard error target of adaptive light sampling
         const float                     low_light_threshold,          // light contribution threshold to disable shadow rays
         const bool                      indirect);                    // are we computing indirect lighting?
 
@@ -116,8 +134,13 @@ class DirectLightingIntegrator
     const float                         m_low_light_threshold;
     const size_t                        m_material_sample_count;
     const size_t                        m_light_sample_count;
+    const size_t                        m_light_candidate_count;
+    const size_t                        m_max_light_sample_count;
+    const float                         m_light_sample_error_threshold;
     const bool                          m_indirect;
 
+    struct LightCandidate;
+
     void take_single_material_sample(
         SamplingContext&                sampling_context,
         const foundation::MISHeuristic  mis_heuristic,
@@ -138,6 +161,36 @@ class DirectLightingIntegrator
         const foundation::Dual3d&       outgoing,
         DirectShadingComponents&        radiance,
         LightPathStream*                light_path_stream) const;
+
+    void add_lightset_sample_contributions(
+        SamplingContext&                sampling_context,
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
+        const size_t                    sample_count,
+        DirectShadingComponents&        radiance,
+        foundation::Population<float>&  sample_values,
+        LightPathStream*                light_path_stream) const;
+
+    size_t compute_adaptive_batch_size(
+        const size_t                    sample_count,
+        const foundation::Population<float>& sample_values) const;
+
+    void add_resampled_lightset_sample_contribution(
+        SamplingContext&                sampling_context,
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
+        DirectShadingComponents&        radiance,
+        LightPathStream*                light_path_stream) const;
+
+    bool evaluate_emitting_shape_candidate(
+        const foundation::MISHeuristic  mis_heuristic,
+        const foundation::Dual3d&       outgoing,
+        LightCandidate&                 candidate) const;
+
+    bool evaluate_non_physical_light_candidate(
+        SamplingContext&                sampling_context,
+        const foundation::Dual3d&       outgoing,
+        LightCandidate&                 candidate) const;
 };
 
 }   // namespace renderer
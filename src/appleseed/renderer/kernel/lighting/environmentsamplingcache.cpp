@@ -0,0 +1,250 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "environmentsamplingcache.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/environmentedf/environmentedf.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/fp.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Subdivision levels of the tessellations of the sphere of directions (1280 triangles)
+    // and of the sphere of normals (320 buckets).
+    const size_t DirectionSubdivisions = 3;
+    const size_t NormalSubdivisions = 2;
+
+    // Stratified samples used to estimate the power of a triangle.
+    const size_t PowerSampleCount = 4;
+    const Vector2f PowerSamples[PowerSampleCount] =
+    {
+        Vector2f(0.25f, 0.25f),
+        Vector2f(0.75f, 0.25f),
+        Vector2f(0.25f, 0.75f),
+        Vector2f(0.75f, 0.75f)
+    };
+}
+
+EnvironmentSamplingCache::EnvironmentSamplingCache(
+    const EnvironmentEDF&   environment_edf,
+    const float             env_fraction)
+  : m_environment_edf(environment_edf)
+  , m_env_fraction(clamp(env_fraction, 0.0f, 1.0f))
+  , m_sphere(DirectionSubdivisions)
+  , m_normal_buckets(NormalSubdivisions)
+  , m_power_built(false)
+  , m_buckets(m_normal_buckets.get_triangle_count())
+{
+    for (size_t i = 0, e = m_buckets.size(); i < e; ++i)
+    {
+        m_buckets[i].m_built = false;
+        m_buckets[i].m_valid = false;
+    }
+}
+
+void EnvironmentSamplingCache::sample(
+    const ShadingContext&   shading_context,
+    const Vector3f&         normal,
+    const Vector3f&         s,
+    Vector3f&               incoming,
+    Spectrum&               value,
+    float&                  probability)
+{
+    const Bucket& bucket = get_bucket(shading_context, normal);
+
+    if (!bucket.m_valid || m_env_fraction == 1.0f)
+    {
+        m_environment_edf.sample(
+            shading_context,
+            Vector2f(s[0], s[1]),
+            incoming,
+            value,
+            probability);
+        return;
+    }
+
+    float env_prob;
+
+    if (s[0] < m_env_fraction)
+    {
+        // Sample the environment EDF.
+        m_environment_edf.sample(
+            shading_context,
+            Vector2f(s[0] / m_env_fraction, s[1]),
+            incoming,
+            value,
+            env_prob);
+
+        // Don't return points with zero probability (e.g. infinite radiance).
+        if (env_prob == 0.0f)
+        {
+            probability = 0.0f;
+            return;
+        }
+    }
+    else
+    {
+        // Sample the cached distribution.
+        const float u = min((s[0] - m_env_fraction) / (1.0f - m_env_fraction), 0.99999994f);
+        const size_t triangle_index = bucket.m_cdf.sample(u).first;
+        incoming = m_sphere.sample_triangle(triangle_index, Vector2f(s[1], s[2]));
+        m_environment_edf.evaluate(shading_context, incoming, value, env_prob);
+    }
+
+    probability =
+          m_env_fraction * env_prob
+        + (1.0f - m_env_fraction) * evaluate_cache_pdf(bucket, incoming);
+}
+
+float EnvironmentSamplingCache::evaluate_pdf(
+    const ShadingContext&   shading_context,
+    const Vector3f&         normal,
+    const Vector3f&         incoming,
+    const float             env_prob)
+{
+    const Bucket& bucket = get_bucket(shading_context, normal);
+
+    if (!bucket.m_valid)
+        return env_prob;
+
+    return
+          m_env_fraction * env_prob
+        + (1.0f - m_env_fraction) * evaluate_cache_pdf(bucket, incoming);
+}
+
+void EnvironmentSamplingCache::build_power(const ShadingContext& shading_context)
+{
+    const size_t triangle_count = m_sphere.get_triangle_count();
+
+    m_triangle_power.resize(triangle_count);
+    m_triangle_centers.resize(triangle_count);
+    m_triangle_radii.resize(triangle_count);
+
+    for (size_t i = 0; i < triangle_count; ++i)
+    {
+        float average_radiance = 0.0f;
+
+        for (size_t j = 0; j < PowerSampleCount; ++j)
+        {
+            const Vector3f direction = m_sphere.sample_triangle(i, PowerSamples[j]);
+
+            Spectrum radiance;
+            m_environment_edf.evaluate(shading_context, direction, radiance);
+
+            const float luminance = average_value(radiance);
+            if (luminance > 0.0f && FP<float>::is_finite(luminance))
+                average_radiance += luminance;
+        }
+
+        average_radiance /= PowerSampleCount;
+
+        m_triangle_power[i] = average_radiance * m_sphere.get_triangle_area(i);
+        m_triangle_centers[i] = m_sphere.get_triangle_center(i);
+        m_triangle_radii[i] = m_sphere.get_triangle_radius(i);
+    }
+
+    m_power_built = true;
+}
+
+const EnvironmentSamplingCache::Bucket& EnvironmentSamplingCache::get_bucket(
+    const ShadingContext&   shading_context,
+    const Vector3f&         normal)
+{
+    if (!m_power_built)
+        build_power(shading_context);
+
+    const size_t bucket_index = m_normal_buckets.find_triangle(normal);
+    Bucket& bucket = m_buckets[bucket_index];
+
+    if (!bucket.m_built)
+        build_bucket(bucket_index, bucket);
+
+    return bucket;
+}
+
+void EnvironmentSamplingCache::build_bucket(const size_t bucket_index, Bucket& bucket) const
+{
+    const Vector3f bucket_center = m_normal_buckets.get_triangle_center(bucket_index);
+    const float bucket_radius = m_normal_buckets.get_triangle_radius(bucket_index);
+
+    const size_t triangle_count = m_triangle_power.size();
+    bucket.m_cdf.reserve(triangle_count);
+
+    for (size_t i = 0; i < triangle_count; ++i)
+    {
+        // Smallest angle between any normal of the bucket and any direction of the triangle.
+        const float angle =
+            max(
+                acos(clamp(dot(bucket_center, m_triangle_centers[i]), -1.0f, 1.0f))
+                    - bucket_radius
+                    - m_triangle_radii[i],
+                0.0f);
+
+        // Upper bound of the clamped cosine over the bucket and the triangle.
+        const float max_cos = angle < HalfPi<float>() ? cos(angle) : 0.0f;
+
+        // Triangles are inserted even with a zero weight so that their index in the CDF
+        // is their index in the tessellation, but they will never be sampled.
+        bucket.m_cdf.insert(i, m_triangle_power[i] * max_cos);
+    }
+
+    bucket.m_valid = bucket.m_cdf.valid();
+
+    if (bucket.m_valid)
+        bucket.m_cdf.prepare();
+
+    bucket.m_built = true;
+}
+
+float EnvironmentSamplingCache::evaluate_cache_pdf(
+    const Bucket&           bucket,
+    const Vector3f&         incoming) const
+{
+    assert(bucket.m_valid);
+
+    const size_t triangle_index = m_sphere.find_triangle(incoming);
+
+    return bucket.m_cdf[triangle_index].second / m_sphere.get_triangle_area(triangle_index);
+}
+
+}   // namespace renderer
@@ -0,0 +1,133 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/cdf.h"
+#include "foundation/math/sampling/sphericalimportancesampler.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class EnvironmentEDF; }
+namespace renderer  { class ShadingContext; }
+
+namespace renderer
+{
+
+//
+// A cache of hemisphere-aware distributions for sampling the environment.
+//
+// The sphere of directions is tessellated into spherical triangles whose power is
+// estimated once from the environment EDF. Normals are grouped in buckets, and each
+// bucket lazily gets a distribution over the triangles proportional to their power
+// times a conservative bound of the clamped cosine they subtend with the normals of
+// the bucket, so that samples are mostly spent above the horizon of the surface.
+//
+// Since this distribution is coarse, a fraction of the samples are still drawn from
+// the environment EDF's own distribution: the resulting mixture keeps the support
+// (and the fine details, such as small suns) of the environment EDF's distribution.
+//
+// This class is not thread-safe, each rendering thread must use its own instance.
+//
+
+class EnvironmentSamplingCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    EnvironmentSamplingCache(
+        const EnvironmentEDF&           environment_edf,
+        const float                     env_fraction = 0.5f);   // fraction of samples drawn from the environment EDF
+
+    // Return the environment EDF this cache was built for.
+    const EnvironmentEDF& get_environment_edf() const;
+
+    // Sample the environment as seen from a point with a given normal.
+    void sample(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3f&     normal,                 // world space geometric normal, unit-length
+        const foundation::Vector3f&     s,                      // sample in [0,1)^3
+        foundation::Vector3f&           incoming,               // world space direction toward the environment
+        Spectrum&                       value,
+        float&                          probability);
+
+    // Return the probability density with which sample() chooses a given direction,
+    // given the probability density of that direction with the environment EDF.
+    float evaluate_pdf(
+        const ShadingContext&           shading_context,
+        const foundation::Vector3f&     normal,                 // world space geometric normal, unit-length
+        const foundation::Vector3f&     incoming,               // world space direction toward the environment
+        const float                     env_prob);
+
+  private:
+    struct Bucket
+    {
+        bool                            m_built;
+        bool                            m_valid;                // false if no triangle has any weight
+        foundation::CDF<size_t, float>  m_cdf;                  // over the triangles of m_sphere
+    };
+
+    const EnvironmentEDF&               m_environment_edf;
+    const float                         m_env_fraction;
+
+    const foundation::SphericalImportanceSampler<float>   m_sphere;
+    const foundation::SphericalImportanceSampler<float>   m_normal_buckets;
+
+    bool                                m_power_built;
+    std::vector<float>                  m_triangle_power;
+    std::vector<foundation::Vector3f>   m_triangle_centers;
+    std::vector<float>                  m_triangle_radii;
+
+    std::vector<Bucket>                 m_buckets;
+
+    void build_power(const ShadingContext& shading_context);
+    const Bucket& get_bucket(const ShadingContext& shading_context, const foundation::Vector3f& normal);
+    void build_bucket(const size_t bucket_index, Bucket& bucket) const;
+    float evaluate_cache_pdf(const Bucket& bucket, const foundation::Vector3f& incoming) const;
+};
+
+
+//
+// EnvironmentSamplingCache class implementation.
+//
+
+inline const EnvironmentEDF& EnvironmentSamplingCache::get_environment_edf() const
+{
+    return m_environment_edf;
+}
+
+}   // namespace renderer
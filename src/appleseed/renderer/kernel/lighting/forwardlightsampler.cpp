@@ -34,15 +34,27 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/lighting/lightsample.h"
 #include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/light/light.h"
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/scene.h"
 
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/containers/dictionary.h"
+
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
 #include <cassert>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -54,11 +66,75 @@ namespace renderer
 // ForwardLightSampler class implementation.
 //
 
+namespace
+{
+    // Emitters whose projection falls this far outside the film are still considered in view.
+    const double ViewMargin = 0.25;
+
+    bool is_in_view(const Vector2d& ndc)
+    {
+        return
+            ndc.x >= -ViewMargin && ndc.x <= 1.0 + ViewMargin &&
+            ndc.y >= -ViewMargin && ndc.y <= 1.0 + ViewMargin;
+    }
+
+    // Coarse test of whether a world space bounding box may be seen by the camera.
+    bool is_in_view(
+        const Camera&       camera,
+        const Transformd&   camera_transform,
+        const AABB3d&       bbox)
+    {
+        // Emitters surrounding the camera are always in view.
+        if (bbox.contains(camera_transform.point_to_parent(Vector3d(0.0))))
+            return true;
+
+        Vector2d ndc;
+
+        if (camera.project_camera_space_point(
+                camera_transform.point_to_local(bbox.center()), ndc) && is_in_view(ndc))
+            return true;
+
+        for (size_t i = 0; i < 8; ++i)
+        {
+            if (camera.project_camera_space_point(
+                    camera_transform.point_to_local(bbox.compute_corner(i)), ndc) && is_in_view(ndc))
+                return true;
+        }
+
+        return false;
+    }
+}
+
+Dictionary ForwardLightSampler::get_params_metadata()
+{
+    Dictionary metadata;
+
+    metadata.insert(
+        "enable_camera_importance",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Camera Importance")
+            .insert("help", "When emitting light paths or photons, favor the emitters that are in view of the camera"));
+
+    metadata.insert(
+        "camera_importance_floor",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.1")
+            .insert("label", "Camera Importance Floor")
+            .insert("help", "Relative probability of picking emitters that are out of view of the camera"));
+
+    return metadata;
+}
+
 ForwardLightSampler::ForwardLightSampler(const Scene& scene, const ParamArray& params)
   : LightSamplerBase(params)
 {
     RENDERER_LOG_INFO("collecting light emitters...");
 
+    MemoryTagScope memory_tag_scope(MemoryTagLights);
+
     // Collect all non-physical lights.
     collect_non_physical_lights(
         scene.assembly_instances(),
@@ -102,15 +178,29 @@ ForwardLightSampler::ForwardLightSampler(const Scene& scene, const ParamArray& p
             return true;
         });
 
+    // Favor the emitters that the camera can see.
+    if (params.get_optional<bool>("enable_camera_importance", false))
+        apply_camera_importance(scene, params.get_optional<float>("camera_importance_floor", 0.1f));
+
     // Build the hash table of emitting shapes.
     build_emitting_shape_hash_table();
 
     // Prepare the CDFs for sampling.
     if (m_non_physical_lights_cdf.valid())
+    {
         m_non_physical_lights_cdf.prepare();
+
+        if (m_params.m_alias_sampling)
+            build_alias_table(m_non_physical_lights_cdf, m_non_physical_lights_alias_table);
+    }
     if (m_emitting_shapes_cdf.valid())
+    {
         m_emitting_shapes_cdf.prepare();
 
+        if (m_params.m_alias_sampling)
+            build_alias_table(m_emitting_shapes_cdf, m_emitting_shapes_alias_table);
+    }
+
     // Store the shape probability densities into the emitting shapes.
     for (size_t i = 0, e = m_emitting_shapes.size(); i < e; ++i)
         m_emitting_shapes[i].set_shape_prob(m_emitting_shapes_cdf[i].second);
@@ -123,6 +213,82 @@ ForwardLightSampler::ForwardLightSampler(const Scene& scene, const ParamArray& p
         plural(m_emitting_shapes.size(), "shape").c_str());
 }
 
+void ForwardLightSampler::apply_camera_importance(
+    const Scene&                        scene,
+    const float                         importance_floor)
+{
+    const Camera* camera = scene.get_active_camera();
+    if (camera == nullptr)
+        return;
+
+    // The camera transform sequence is not prepared yet, use the transform at shutter open.
+    const Transformd& camera_transform = camera->transform_sequence().get_earliest_transform();
+
+    // Out of view emitters keep a nonzero probability since they may light visible surfaces.
+    const float out_of_view_weight = clamp(importance_floor, 0.001f, 1.0f);
+
+    size_t in_view_count = 0;
+
+    // CDFs are not copyable: gather their weighted items then insert them back.
+    vector<EmitterCDF::ItemWeightPair> items;
+
+    // Weight non-physical lights.
+    items.reserve(m_non_physical_lights_cdf.size());
+    for (size_t i = 0, e = m_non_physical_lights_cdf.size(); i < e; ++i)
+    {
+        const EmitterCDF::ItemWeightPair& item = m_non_physical_lights_cdf[i];
+        const NonPhysicalLightInfo& light_info = m_non_physical_lights[item.first];
+
+        // Lights without a position, such as directional lights, are always in view.
+        bool in_view = true;
+        if (light_info.m_light->get_flags() & Light::LightTreeCompatible)
+        {
+            const Vector3d position =
+                light_info.m_transform_sequence.get_earliest_transform().point_to_parent(
+                    light_info.m_light->get_transform().point_to_parent(Vector3d(0.0)));
+            in_view = is_in_view(*camera, camera_transform, AABB3d(position, position));
+        }
+
+        if (in_view)
+            ++in_view_count;
+
+        items.emplace_back(
+            item.first,
+            in_view ? item.second : item.second * out_of_view_weight);
+    }
+    m_non_physical_lights_cdf.clear();
+    for (const EmitterCDF::ItemWeightPair& item : items)
+        m_non_physical_lights_cdf.insert(item.first, item.second);
+
+    // Weight light-emitting shapes.
+    items.clear();
+    items.reserve(m_emitting_shapes_cdf.size());
+    for (size_t i = 0, e = m_emitting_shapes_cdf.size(); i < e; ++i)
+    {
+        const EmitterCDF::ItemWeightPair& item = m_emitting_shapes_cdf[i];
+        const bool in_view =
+            is_in_view(*camera, camera_transform, m_emitting_shapes[item.first].get_bbox());
+
+        if (in_view)
+            ++in_view_count;
+
+        items.emplace_back(
+            item.first,
+            in_view ? item.second : item.second * out_of_view_weight);
+    }
+    m_emitting_shapes_cdf.clear();
+    for (const EmitterCDF::ItemWeightPair& item : items)
+        m_emitting_shapes_cdf.insert(item.first, item.second);
+
+    const size_t emitter_count = m_non_physical_lights_cdf.size() + m_emitting_shapes_cdf.size();
+
+    RENDERER_LOG_INFO(
+        "%s out of %s %s in view of the camera.",
+        pretty_uint(in_view_count).c_str(),
+        pretty_uint(emitter_count).c_str(),
+        plural(emitter_count, "emitter").c_str());
+}
+
 void ForwardLightSampler::sample(
     const ShadingRay::Time&             time,
     const Vector3f&                     s,
@@ -180,9 +346,20 @@ void ForwardLightSampler::sample_non_physical_lights(
 {
     assert(m_non_physical_lights_cdf.valid());
 
-    const EmitterCDF::ItemWeightPair result = m_non_physical_lights_cdf.sample(s[0]);
-    const size_t light_index = result.first;
-    const float light_prob = result.second;
+    size_t light_index;
+    float light_prob;
+
+    if (m_non_physical_lights_alias_table.valid())
+    {
+        const size_t i = m_non_physical_lights_alias_table.sample(s[0], light_prob);
+        light_index = m_non_physical_lights_cdf[i].first;
+    }
+    else
+    {
+        const EmitterCDF::ItemWeightPair result = m_non_physical_lights_cdf.sample(s[0]);
+        light_index = result.first;
+        light_prob = result.second;
+    }
 
     light_sample.m_shape = nullptr;
     sample_non_physical_light(
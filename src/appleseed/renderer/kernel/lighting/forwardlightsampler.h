@@ -42,6 +42,7 @@
 #include <vector>
 
 // Forward declarations.
+namespace foundation    { class Dictionary; }
 namespace renderer  { class LightSample; }
 namespace renderer  { class Scene; }
 
@@ -57,6 +58,9 @@ class ForwardLightSampler
   : public LightSamplerBase
 {
   public:
+    // Return metadata for the parameters specific to this light sampler.
+    static foundation::Dictionary get_params_metadata();
+
     // Constructor.
     ForwardLightSampler(
         const Scene&                    scene,
@@ -75,6 +79,11 @@ class ForwardLightSampler
         const ShadingPoint&             light_shading_point) const;
 
   private:
+    // Scale down the probability of picking emitters that lie outside the view of the camera.
+    void apply_camera_importance(
+        const Scene&                    scene,
+        const float                     importance_floor);
+
     // Sample the set of non-physical lights.
     void sample_non_physical_lights(
         const ShadingRay::Time&         time,
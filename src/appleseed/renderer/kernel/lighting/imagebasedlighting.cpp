@@ -31,6 +31,7 @@
 #include "imagebasedlighting.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/lighting/environmentsamplingcache.h"
 #include "renderer/kernel/lighting/lightpathstream.h"
 #include "renderer/kernel/lighting/materialsamplers.h"
 #include "renderer/kernel/lighting/tracer.h"
@@ -64,7 +65,8 @@ void compute_ibl_combined_sampling(
     const size_t                material_sample_count,
     const size_t                env_sample_count,
     DirectShadingComponents&    radiance,
-    LightPathStream*            light_path_stream)
+    LightPathStream*            light_path_stream,
+    EnvironmentSamplingCache*   env_sampling_cache)
 {
     assert(is_normalized(outgoing.get_value()));
 
@@ -77,7 +79,8 @@ void compute_ibl_combined_sampling(
         material_sampler,
         material_sample_count,
         env_sample_count,
-        radiance);
+        radiance,
+        env_sampling_cache);
 
     // Compute IBL by sampling the environment.
     DirectShadingComponents radiance_env_sampling;
@@ -91,7 +94,8 @@ void compute_ibl_combined_sampling(
         material_sample_count,
         env_sample_count,
         radiance_env_sampling,
-        light_path_stream);
+        light_path_stream,
+        env_sampling_cache);
     radiance += radiance_env_sampling;
 }
 
@@ -103,7 +107,8 @@ void compute_ibl_material_sampling(
     const IMaterialSampler&     material_sampler,
     const size_t                bsdf_sample_count,
     const size_t                env_sample_count,
-    DirectShadingComponents&    radiance)
+    DirectShadingComponents&    radiance,
+    EnvironmentSamplingCache*   env_sampling_cache)
 {
     assert(is_normalized(outgoing.get_value()));
 
@@ -142,6 +147,17 @@ void compute_ibl_material_sampling(
             env_value,
             env_prob);
 
+        // Account for the environment sampling cache in the environment PDF.
+        if (env_sampling_cache)
+        {
+            env_prob =
+                env_sampling_cache->evaluate_pdf(
+                    shading_context,
+                    Vector3f(material_sampler.get_shading_point().get_geometric_normal()),
+                    incoming.get_value(),
+                    env_prob);
+        }
+
         // Apply all weights, including MIS weight.
         if (material_prob == BSDF::DiracDelta)
             env_value *= transmission;
@@ -173,7 +189,8 @@ void compute_ibl_environment_sampling(
     const size_t                material_sample_count,
     const size_t                env_sample_count,
     DirectShadingComponents&    radiance,
-    LightPathStream*            light_path_stream)
+    LightPathStream*            light_path_stream,
+    EnvironmentSamplingCache*   env_sampling_cache)
 {
     assert(is_normalized(outgoing.get_value()));
 
@@ -183,23 +200,47 @@ void compute_ibl_environment_sampling(
     if (!material_sampler.contributes_to_light_sampling())
         return;
 
-    sampling_context.split_in_place(2, env_sample_count);
+    // The environment sampling cache needs an additional sample dimension.
+    sampling_context.split_in_place(env_sampling_cache ? 3 : 2, env_sample_count);
+
+    const Vector3f normal =
+        env_sampling_cache
+            ? Vector3f(material_sampler.get_shading_point().get_geometric_normal())
+            : Vector3f(0.0f);
 
     for (size_t i = 0; i < env_sample_count; ++i)
     {
-        // Generate a uniform sample in [0,1)^2.
-        const Vector2f s = sampling_context.next2<Vector2f>();
-
         // Sample the environment.
         Vector3f incoming;
         Spectrum env_value(Spectrum::Illuminance);
         float env_prob;
-        environment_edf.sample(
-            shading_context,
-            s,
-            incoming,
-            env_value,
-            env_prob);
+        if (env_sampling_cache)
+        {
+            // Generate a uniform sample in [0,1)^3.
+            const Vector3f s = sampling_context.next2<Vector3f>();
+
+            env_sampling_cache->sample(
+                shading_context,
+                normal,
+                s,
+                incoming,
+                env_value,
+                env_prob);
+            if (env_prob == 0.0f)
+                continue;
+        }
+        else
+        {
+            // Generate a uniform sample in [0,1)^2.
+            const Vector2f s = sampling_context.next2<Vector2f>();
+
+            environment_edf.sample(
+                shading_context,
+                s,
+                incoming,
+                env_value,
+                env_prob);
+        }
         assert(is_normalized(incoming));
 
         // Discard occluded samples.
@@ -43,6 +43,7 @@
 namespace renderer  { class BSDF; }
 namespace renderer  { class DirectShadingComponents; }
 namespace renderer  { class EnvironmentEDF; }
+namespace renderer  { class EnvironmentSamplingCache; }
 namespace renderer  { class IMaterialSampler; }
 namespace renderer  { class LightPathStream; }
 namespace renderer  { class ShadingContext; }
@@ -54,6 +55,9 @@ namespace renderer
 //
 // Compute image-based lighting at a given point in space.
 //
+// When an environment sampling cache is provided, environment samples are drawn from it
+// instead of from the environment EDF, and multiple importance sampling accounts for it.
+//
 
 // Compute outgoing radiance due to image-based lighting via combined BSDF and environment sampling.
 void compute_ibl_combined_sampling(
@@ -66,7 +70,8 @@ void compute_ibl_combined_sampling(
     const size_t                    material_sample_count,  // number of samples in BSDF sampling
     const size_t                    env_sample_count,       // number of samples in environment sampling
     DirectShadingComponents&        radiance,
-    LightPathStream*                light_path_stream);
+    LightPathStream*                light_path_stream,
+    EnvironmentSamplingCache*       env_sampling_cache = nullptr);
 
 // Compute outgoing radiance due to image-based lighting via BSDF sampling only.
 void compute_ibl_material_sampling(
@@ -77,7 +82,8 @@ void compute_ibl_material_sampling(
     const IMaterialSampler&         material_sampler,
     const size_t                    material_sample_count,  // number of samples in BSDF sampling
     const size_t                    env_sample_count,       // number of samples in environment sampling
-    DirectShadingComponents&        radiance);
+    DirectShadingComponents&        radiance,
+    EnvironmentSamplingCache*       env_sampling_cache = nullptr);
 
 // Compute outgoing radiance due to image-based lighting via environment sampling only.
 void compute_ibl_environment_sampling(
@@ -90,6 +96,7 @@ void compute_ibl_environment_sampling(
     const size_t                    material_sample_count,
     const size_t                    env_sample_count,       // number of samples in environment sampling
     DirectShadingComponents&        radiance,
-    LightPathStream*                light_path_stream);
+    LightPathStream*                light_path_stream,
+    EnvironmentSamplingCache*       env_sampling_cache = nullptr);
 
 }   // namespace renderer
@@ -0,0 +1,248 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "irradiancepointcloud.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/knn.h"
+#include "foundation/math/scalar.h"
+#include "foundation/platform/defaulttimers.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Number of nearest neighbors used to estimate the area represented by a record.
+    const size_t AreaEstimationNeighborCount = 16;
+
+    // Octree build parameters.
+    const size_t MaxLeafPointCount = 8;
+    const size_t MaxTreeDepth = 20;
+}
+
+
+//
+// IrradiancePointCloud class implementation.
+//
+
+IrradiancePointCloud::IrradiancePointCloud(
+    const float             max_solid_angle,
+    const size_t            max_record_count)
+  : m_max_solid_angle(max_solid_angle)
+  , m_max_record_count(max_record_count)
+  , m_is_recording(true)
+  , m_size(0)
+{
+}
+
+void IrradiancePointCloud::insert(const RecordVector& records)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    const size_t count =
+        min(records.size(), m_max_record_count - min(m_inserted_records.size(), m_max_record_count));
+
+    m_inserted_records.insert(m_inserted_records.end(), records.begin(), records.begin() + count);
+
+    if (m_inserted_records.size() == m_max_record_count)
+        m_is_recording = false;
+}
+
+void IrradiancePointCloud::update()
+{
+    // Records are only ever appended.
+    if (m_size == m_inserted_records.size())
+        return;
+
+    m_surfaces.clear();
+
+    for (const Record& record : m_inserted_records)
+    {
+        Point point;
+        point.m_position = record.m_position;
+        point.m_area = 0.0f;
+        point.m_irradiance = record.m_irradiance;
+
+        m_surfaces[SurfaceKey(record.m_bssrdf, record.m_object_instance)].m_points.push_back(point);
+    }
+
+    for (SurfaceMap::iterator i = m_surfaces.begin(), e = m_surfaces.end(); i != e; ++i)
+        build_surface(i->second);
+
+    m_size = m_inserted_records.size();
+}
+
+void IrradiancePointCloud::build_surface(Surface& surface)
+{
+    vector<Point>& points = surface.m_points;
+    assert(!points.empty());
+
+    // Estimate the area represented by each point from the distance to its neighbors.
+    if (points.size() > 1)
+    {
+        vector<Vector3f> positions(points.size());
+        for (size_t i = 0, e = points.size(); i < e; ++i)
+            positions[i] = points[i].m_position;
+
+        knn::Tree3f tree;
+        knn::Builder3f builder(tree);
+        builder.build_move_points<DefaultWallclockTimer>(positions);
+
+        const size_t neighbor_count = min(AreaEstimationNeighborCount, points.size());
+        knn::Answer<float> answer(neighbor_count);
+        knn::Query3f query(tree, answer);
+
+        for (Point& point : points)
+        {
+            query.run(point.m_position);
+
+            float max_square_dist = 0.0f;
+            for (size_t j = 0, e = answer.size(); j < e; ++j)
+                max_square_dist = max(max_square_dist, answer.get(j).m_square_dist);
+
+            point.m_area = Pi<float>() * max_square_dist / answer.size();
+        }
+    }
+
+    // Build the octree.
+    Node root;
+    root.m_point_index = 0;
+    root.m_point_count = static_cast<uint32>(points.size());
+    surface.m_nodes.push_back(root);
+    build_node(surface, 0, 0);
+}
+
+void IrradiancePointCloud::build_node(
+    Surface&                surface,
+    const size_t            node_index,
+    const size_t            depth)
+{
+    const uint32 point_index = surface.m_nodes[node_index].m_point_index;
+    const uint32 point_count = surface.m_nodes[node_index].m_point_count;
+    Point* points = &surface.m_points[point_index];
+
+    // Compute the aggregates of the node.
+    AABB3f bbox;
+    bbox.invalidate();
+    Vector3f position(0.0f);
+    float area = 0.0f;
+    Spectrum irradiance(0.0f);
+
+    for (uint32 i = 0; i < point_count; ++i)
+    {
+        const Point& point = points[i];
+        bbox.insert(point.m_position);
+        position += point.m_area * point.m_position;
+        area += point.m_area;
+        Spectrum weighted_irradiance = point.m_irradiance;
+        weighted_irradiance *= point.m_area;
+        irradiance += weighted_irradiance;
+    }
+
+    if (area > 0.0f)
+    {
+        position /= area;
+        irradiance /= area;
+    }
+    else
+        position = bbox.center();
+
+    Node& node = surface.m_nodes[node_index];
+    node.m_bbox = bbox;
+    node.m_position = position;
+    node.m_area = area;
+    node.m_irradiance = irradiance;
+    node.m_child_index = 0;
+    node.m_child_count = 0;
+
+    if (point_count <= MaxLeafPointCount || depth == MaxTreeDepth)
+        return;
+
+    // Sort the points into the octants of the node.
+    const Vector3f center = bbox.center();
+    uint32 octant_begin[9] = { 0 };
+    for (uint32 i = 0; i < point_count; ++i)
+    {
+        const Vector3f& p = points[i].m_position;
+        ++octant_begin[1 + (p.x > center.x ? 1 : 0) + (p.y > center.y ? 2 : 0) + (p.z > center.z ? 4 : 0)];
+    }
+
+    // All points fall into a single octant when they are coincident.
+    for (size_t i = 1; i < 9; ++i)
+    {
+        if (octant_begin[i] == point_count)
+            return;
+    }
+
+    for (size_t i = 1; i < 9; ++i)
+        octant_begin[i] += octant_begin[i - 1];
+
+    vector<Point> sorted_points(point_count);
+    uint32 octant_end[8];
+    copy(octant_begin, octant_begin + 8, octant_end);
+    for (uint32 i = 0; i < point_count; ++i)
+    {
+        const Vector3f& p = points[i].m_position;
+        const size_t octant = (p.x > center.x ? 1 : 0) + (p.y > center.y ? 2 : 0) + (p.z > center.z ? 4 : 0);
+        sorted_points[octant_end[octant]++] = points[i];
+    }
+    copy(sorted_points.begin(), sorted_points.end(), points);
+
+    // Create one child per non-empty octant; children are contiguous.
+    const uint32 child_index = static_cast<uint32>(surface.m_nodes.size());
+    uint32 child_count = 0;
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        if (octant_begin[i + 1] == octant_begin[i])
+            continue;
+
+        Node child;
+        child.m_point_index = point_index + octant_begin[i];
+        child.m_point_count = octant_begin[i + 1] - octant_begin[i];
+        surface.m_nodes.push_back(child);
+        ++child_count;
+    }
+
+    surface.m_nodes[node_index].m_child_index = child_index;
+    surface.m_nodes[node_index].m_child_count = child_count;
+
+    for (uint32 i = 0; i < child_count; ++i)
+        build_node(surface, child_index + i, depth + 1);
+}
+
+}   // namespace renderer
@@ -0,0 +1,310 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class BSSRDF; }
+namespace renderer  { class ObjectInstance; }
+
+namespace renderer
+{
+
+//
+// A hierarchical point cloud of the irradiance received by subsurface scattering
+// surfaces, following Jensen and Buhler's two-pass approach.
+//
+// Records are irradiance estimates at points of a surface made of a given BSSRDF
+// on a given object instance. Once built, the records of each surface are arranged
+// in an octree whose nodes store their total area and area-weighted irradiance.
+// Integration of a radial profile over the surface uses these aggregates for nodes
+// that subtend a small enough solid angle from the integration point, and the
+// individual records otherwise.
+//
+// The area of each record is estimated from the density of its nearest neighbors.
+//
+// [1] A Rapid Hierarchical Rendering Technique for Translucent Materials
+//     Henrik Wann Jensen, Juan Buhler
+//     http://graphics.ucsd.edu/~henrik/papers/fast_bssrdf/fast_bssrdf.pdf
+//
+
+class IrradiancePointCloud
+  : public foundation::NonCopyable
+{
+  public:
+    struct Record
+    {
+        foundation::Vector3f    m_position;
+        const BSSRDF*           m_bssrdf;
+        const ObjectInstance*   m_object_instance;
+        Spectrum                m_irradiance;           // in W.m^-2
+    };
+
+    typedef std::vector<Record> RecordVector;
+
+    // Constructor.
+    IrradiancePointCloud(
+        const float             max_solid_angle,        // largest solid angle of a node used as a whole, in sr
+        const size_t            max_record_count);      // records inserted beyond this number are discarded
+
+    // Enable or disable recording. The cloud can only be integrated once recording is over.
+    void set_recording(const bool recording);
+    bool is_recording() const;
+
+    // Insert records. They are ignored until the next call to update(). Thread-safe.
+    void insert(const RecordVector& records);
+
+    // Build the hierarchy from all the records inserted so far.
+    // Must not be called concurrently with any other method.
+    void update();
+
+    // Return the number of records in the hierarchy.
+    size_t size() const;
+
+    // Return true if the cloud can be integrated.
+    bool is_ready() const;
+
+    // Integrate profile(square_distance, value) * irradiance over the surface made of a given
+    // BSSRDF on a given object instance, within a given distance of a point. Return false if
+    // no record was ever made on that surface.
+    template <typename Profile>
+    bool integrate(
+        const foundation::Vector3f&     position,
+        const BSSRDF*                   bssrdf,
+        const ObjectInstance*           object_instance,
+        const float                     max_distance,
+        const Profile&                  profile,
+        Spectrum&                       result) const;
+
+  private:
+    struct Point
+    {
+        foundation::Vector3f    m_position;
+        float                   m_area;
+        Spectrum                m_irradiance;
+    };
+
+    struct Node
+    {
+        foundation::AABB3f      m_bbox;
+        foundation::Vector3f    m_position;             // area-weighted average position of the points
+        float                   m_area;                 // total area of the points
+        Spectrum                m_irradiance;           // area-weighted average irradiance of the points
+        foundation::uint32      m_child_index;          // index of the first child, children are contiguous
+        foundation::uint32      m_child_count;          // 0 for leaves
+        foundation::uint32      m_point_index;
+        foundation::uint32      m_point_count;
+    };
+
+    struct Surface
+    {
+        std::vector<Point>      m_points;
+        std::vector<Node>       m_nodes;
+    };
+
+    typedef std::pair<const BSSRDF*, const ObjectInstance*> SurfaceKey;
+    typedef std::map<SurfaceKey, Surface> SurfaceMap;
+
+    const float                         m_max_solid_angle;
+    const size_t                        m_max_record_count;
+    bool                                m_is_recording;
+
+    boost::mutex                        m_mutex;
+    RecordVector                        m_inserted_records;
+
+    SurfaceMap                          m_surfaces;
+    size_t                              m_size;
+
+    static void build_surface(Surface& surface);
+
+    static float compute_square_distance(
+        const foundation::AABB3f&       bbox,
+        const foundation::Vector3f&     point);
+
+    static float compute_max_square_distance(
+        const foundation::AABB3f&       bbox,
+        const foundation::Vector3f&     point);
+
+    static void build_node(
+        Surface&                        surface,
+        const size_t                    node_index,
+        const size_t                    depth);
+};
+
+
+//
+// IrradiancePointCloud class implementation.
+//
+
+inline void IrradiancePointCloud::set_recording(const bool recording)
+{
+    m_is_recording = recording;
+}
+
+inline bool IrradiancePointCloud::is_recording() const
+{
+    return m_is_recording;
+}
+
+inline size_t IrradiancePointCloud::size() const
+{
+    return m_size;
+}
+
+inline bool IrradiancePointCloud::is_ready() const
+{
+    return !m_is_recording && m_size > 0;
+}
+
+inline float IrradiancePointCloud::compute_square_distance(
+    const foundation::AABB3f&           bbox,
+    const foundation::Vector3f&         point)
+{
+    float d = 0.0f;
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        if (point[i] < bbox.min[i])
+            d += foundation::square(bbox.min[i] - point[i]);
+        else if (point[i] > bbox.max[i])
+            d += foundation::square(point[i] - bbox.max[i]);
+    }
+
+    return d;
+}
+
+inline float IrradiancePointCloud::compute_max_square_distance(
+    const foundation::AABB3f&           bbox,
+    const foundation::Vector3f&         point)
+{
+    float d = 0.0f;
+
+    for (size_t i = 0; i < 3; ++i)
+        d += foundation::square(std::max(point[i] - bbox.min[i], bbox.max[i] - point[i]));
+
+    return d;
+}
+
+template <typename Profile>
+bool IrradiancePointCloud::integrate(
+    const foundation::Vector3f&         position,
+    const BSSRDF*                       bssrdf,
+    const ObjectInstance*               object_instance,
+    const float                         max_distance,
+    const Profile&                      profile,
+    Spectrum&                           result) const
+{
+    const SurfaceMap::const_iterator it = m_surfaces.find(SurfaceKey(bssrdf, object_instance));
+    if (it == m_surfaces.end())
+        return false;
+
+    const Surface& surface = it->second;
+    const float max_square_distance = max_distance * max_distance;
+
+    result.set(0.0f);
+
+    const size_t MaxStackSize = 256;
+    foundation::uint32 stack[MaxStackSize];
+    size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0)
+    {
+        const Node& node = surface.m_nodes[stack[--stack_size]];
+
+        // Skip nodes lying entirely beyond the reach of the profile.
+        if (compute_square_distance(node.m_bbox, position) > max_square_distance)
+            continue;
+
+        Spectrum value;
+
+        if (node.m_child_count > 0)
+        {
+            // Use the node as a whole if it is small enough as seen from the integration point
+            // and if it lies entirely within the reach of the profile.
+            const float square_dist = foundation::square_norm(position - node.m_position);
+            if (!node.m_bbox.contains(position) &&
+                node.m_area < m_max_solid_angle * square_dist &&
+                compute_max_square_distance(node.m_bbox, position) <= max_square_distance)
+            {
+                profile(square_dist, value);
+                value *= node.m_irradiance;
+                value *= node.m_area;
+                result += value;
+                continue;
+            }
+
+            // Otherwise visit its children.
+            if (stack_size + node.m_child_count <= MaxStackSize)
+            {
+                for (foundation::uint32 i = 0; i < node.m_child_count; ++i)
+                    stack[stack_size++] = node.m_child_index + i;
+                continue;
+            }
+        }
+
+        // Visit the points of leaves, and of interior nodes when the stack is full.
+        const Point* points = &surface.m_points[node.m_point_index];
+        for (foundation::uint32 i = 0; i < node.m_point_count; ++i)
+        {
+            const Point& point = points[i];
+            const float square_dist = foundation::square_norm(position - point.m_position);
+            if (square_dist > max_square_distance)
+                continue;
+
+            profile(square_dist, value);
+            value *= point.m_irradiance;
+            value *= point.m_area;
+            result += value;
+        }
+    }
+
+    return true;
+}
+
+}   // namespace renderer
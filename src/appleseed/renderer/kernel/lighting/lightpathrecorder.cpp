@@ -50,7 +50,6 @@
 // Standard headers.
 #include <algorithm>
 #include <cassert>
-#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -146,6 +145,18 @@ void LightPathRecorder::finalize(
             pretty_uint(light_path_count).c_str(),
             light_path_count > 1 ? "s" : "");
 
+        // Grow the destination stream only once.
+        size_t path_count = 0, vertex_count = 0, point_count = 0;
+        for (const auto& stream : impl->m_streams)
+        {
+            path_count += stream->m_paths.size();
+            vertex_count += stream->m_vertices.size();
+            point_count += stream->m_points.size();
+        }
+        impl->m_streams[0]->m_paths.reserve(path_count);
+        impl->m_streams[0]->m_vertices.reserve(vertex_count);
+        impl->m_streams[0]->m_points.reserve(point_count);
+
         for (size_t i = 1, e = impl->m_streams.size(); i < e; ++i)
         {
             merge_streams(
@@ -258,12 +269,13 @@ void LightPathRecorder::get_light_path_vertex(
 
     assert(index < stream->m_vertices.size());
     const auto& source_vertex = stream->m_vertices[index];
+    const auto& source_point = stream->m_points[source_vertex.m_point_index];
 
-    result.m_entity = source_vertex.m_entity;
+    result.m_entity = stream->m_entities[source_point.m_entity_index];
 
-    result.m_position[0] = source_vertex.m_position[0];
-    result.m_position[1] = source_vertex.m_position[1];
-    result.m_position[2] = source_vertex.m_position[2];
+    result.m_position[0] = source_point.m_position[0];
+    result.m_position[1] = source_point.m_position[1];
+    result.m_position[2] = source_point.m_position[2];
 
     result.m_radiance[0] = source_vertex.m_radiance[0];
     result.m_radiance[1] = source_vertex.m_radiance[1];
@@ -340,31 +352,12 @@ bool LightPathRecorder::write(const char* filename) const
             checked_write(file, index_entry.m_path_count);
         }
 
-        // Collect entity names and build (entity name -> name index) dictionary.
-        vector<string> entity_names;
-        map<const Entity*, uint16> entity_name_to_index;
-        for (const auto& vertex : stream->m_vertices)
-        {
-            if (entity_name_to_index.find(vertex.m_entity) == entity_name_to_index.end())
-            {
-                // Insert a new (entity name -> name index) entry into the dictionary.
-                assert(entity_names.size() < 65536);
-                entity_name_to_index.insert(
-                    make_pair(
-                        vertex.m_entity,
-                        static_cast<uint16>(entity_names.size())));
-
-                // Insert the entity name into the vector.
-                entity_names.push_back(
-                    to_string(vertex.m_entity->get_path()));
-            }
-        }
-
-        // Write entity names.
-        assert(entity_names.size() < 65536);
-        checked_write(file, static_cast<uint16>(entity_names.size()));
-        for (const auto& name : entity_names)
+        // Write entity names. Name indices are the stream's entity indices.
+        assert(stream->m_entities.size() < 65536);
+        checked_write(file, static_cast<uint16>(stream->m_entities.size()));
+        for (const auto entity : stream->m_entities)
         {
+            const string name = to_string(entity->get_path());
             assert(name.size() < 65536);
             checked_write(file, static_cast<uint16>(name.size()));
             checked_write(file, name.c_str(), name.size());
@@ -399,21 +392,20 @@ bool LightPathRecorder::write(const char* filename) const
             for (auto i = path.m_vertex_begin_index; i < path.m_vertex_end_index; ++i)
             {
                 const auto& vertex = stream->m_vertices[i];
+                const auto& point = stream->m_points[vertex.m_point_index];
 
                 // Entity name index.
-                const auto it = entity_name_to_index.find(vertex.m_entity);
-                assert(it != entity_name_to_index.end());
-                checked_write(file, it->second);
+                checked_write(file, static_cast<uint16>(point.m_entity_index));
 
                 // Write world space position of this vertex.
-                checked_write(file, vertex.m_position[0]);
-                checked_write(file, vertex.m_position[1]);
-                checked_write(file, vertex.m_position[2]);
+                checked_write(file, point.m_position[0]);
+                checked_write(file, point.m_position[1]);
+                checked_write(file, point.m_position[2]);
 
                 // Write radiance at this vertex.
-                checked_write(file, vertex.m_radiance[0]);
-                checked_write(file, vertex.m_radiance[1]);
-                checked_write(file, vertex.m_radiance[2]);
+                checked_write(file, static_cast<float>(vertex.m_radiance[0]));
+                checked_write(file, static_cast<float>(vertex.m_radiance[1]));
+                checked_write(file, static_cast<float>(vertex.m_radiance[2]));
             }
         }
 
@@ -450,6 +442,35 @@ void LightPathRecorder::merge_streams(
     LightPathStream&    dest,
     LightPathStream&    source)
 {
+    // Map the entities of `source` to entities of `dest`.
+    vector<uint32> entity_remap(source.m_entities.size());
+    for (size_t i = 0, e = source.m_entities.size(); i < e; ++i)
+    {
+        const Entity* entity = source.m_entities[i];
+        const auto entity_it =
+            dest.m_entity_indices.insert(
+                make_pair(entity, static_cast<uint32>(dest.m_entities.size()))).first;
+        if (entity_it->second == dest.m_entities.size())
+            dest.m_entities.push_back(entity);
+        entity_remap[i] = entity_it->second;
+    }
+
+    clear_release_memory(source.m_entities);
+    source.m_entity_indices.clear();
+
+    // Append points.
+    const auto point_index_shift = static_cast<uint32>(dest.m_points.size());
+
+    for (const auto& point : source.m_points)
+    {
+        LightPathStream::StoredPathPoint remapped_point = point;
+        remapped_point.m_entity_index = entity_remap[point.m_entity_index];
+        dest.m_points.push_back(remapped_point);
+    }
+
+    clear_release_memory(source.m_points);
+
+    // Append paths.
     const size_t old_size = dest.m_paths.size();
 
     dest.m_paths.insert(
@@ -467,12 +488,18 @@ void LightPathRecorder::merge_streams(
         dest.m_paths[i].m_vertex_end_index += vertex_index_shift;
     }
 
+    // Append vertices.
+    const size_t old_vertex_count = dest.m_vertices.size();
+
     dest.m_vertices.insert(
         dest.m_vertices.end(),
         source.m_vertices.begin(),
         source.m_vertices.end());
 
     clear_release_memory(source.m_vertices);
+
+    for (size_t i = old_vertex_count, e = dest.m_vertices.size(); i < e; ++i)
+        dest.m_vertices[i].m_point_index += point_index_shift;
 }
 
 }   // namespace renderer
@@ -50,9 +50,11 @@
 #include "foundation/utility/otherwise.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -69,9 +71,13 @@ void LightPathStream::clear()
     clear_release_memory(m_hit_emitter_data);
     clear_release_memory(m_sampled_emitter_data);
     clear_release_memory(m_sampled_env_data);
+    clear_release_memory(m_event_points);
 
     clear_release_memory(m_paths);
     clear_release_memory(m_vertices);
+    clear_release_memory(m_points);
+    clear_release_memory(m_entities);
+    m_entity_indices.clear();
 }
 
 void LightPathStream::begin_path(
@@ -198,6 +204,9 @@ void LightPathStream::end_path()
         m_pixel_coords.x < 65536 &&
         m_pixel_coords.y < 65536)
     {
+        m_event_points.assign(m_events.size(), ~uint32(0));
+        m_camera_point = ~uint32(0);
+
         for (size_t i = 0, e = m_events.size(); i < e; ++i)
         {
             switch (m_events[i].m_type)
@@ -241,11 +250,9 @@ void LightPathStream::create_path_from_hit_emitter(const size_t emitter_event_in
     stored_path.m_vertex_begin_index = static_cast<uint32>(m_vertices.size());
 
     // Emitter vertex.
-    StoredPathVertex emitter_vertex;
-    emitter_vertex.m_entity = hit_emitter_data.m_object_instance;
-    emitter_vertex.m_position = hit_emitter_data.m_vertex_position;
-    emitter_vertex.m_radiance = hit_emitter_data.m_emitted_radiance;
-    m_vertices.push_back(emitter_vertex);
+    insert_vertex(
+        get_reflector_point(emitter_event_index),
+        hit_emitter_data.m_emitted_radiance);
 
     Color3f current_radiance = hit_emitter_data.m_emitted_radiance;
     Color3f prev_throughput = hit_emitter_data.m_path_throughput;
@@ -261,11 +268,7 @@ void LightPathStream::create_path_from_hit_emitter(const size_t emitter_event_in
             const auto& event_data = get_reflector_data(event_index);
 
             // Reflector vertex.
-            StoredPathVertex reflector_vertex;
-            reflector_vertex.m_entity = event_data.m_object_instance;
-            reflector_vertex.m_position = event_data.m_vertex_position;
-            reflector_vertex.m_radiance = current_radiance;
-            m_vertices.push_back(reflector_vertex);
+            insert_vertex(get_reflector_point(event_index), current_radiance);
 
             // Update current radiance.
             const auto& throughput = event_data.m_path_throughput;
@@ -276,11 +279,7 @@ void LightPathStream::create_path_from_hit_emitter(const size_t emitter_event_in
     }
 
     // Camera vertex.
-    StoredPathVertex camera_vertex;
-    camera_vertex.m_entity = m_camera;
-    camera_vertex.m_position = m_camera_vertex_position;
-    camera_vertex.m_radiance = current_radiance;
-    m_vertices.push_back(camera_vertex);
+    insert_vertex(get_camera_point(), current_radiance);
 
     // Store path.
     stored_path.m_vertex_end_index = static_cast<uint32>(m_vertices.size());
@@ -307,11 +306,9 @@ void LightPathStream::create_path_from_sampled_emitter(const size_t emitter_even
     stored_path.m_vertex_begin_index = static_cast<uint32>(m_vertices.size());
 
     // Emitter vertex.
-    StoredPathVertex emitter_vertex;
-    emitter_vertex.m_entity = sampled_emitter_data.m_entity;
-    emitter_vertex.m_position = sampled_emitter_data.m_vertex_position;
-    emitter_vertex.m_radiance = sampled_emitter_data.m_emitted_radiance;
-    m_vertices.push_back(emitter_vertex);
+    insert_vertex(
+        insert_point(sampled_emitter_data.m_entity, sampled_emitter_data.m_vertex_position),
+        sampled_emitter_data.m_emitted_radiance);
 
     Color3f current_radiance = sampled_emitter_data.m_emitted_radiance;
     Color3f prev_throughput = sampled_emitter_data.m_material_value * last_reflector_data.m_path_throughput;
@@ -327,11 +324,7 @@ void LightPathStream::create_path_from_sampled_emitter(const size_t emitter_even
             const auto& event_data = get_reflector_data(event_index);
 
             // Reflector vertex.
-            StoredPathVertex reflector_vertex;
-            reflector_vertex.m_entity = event_data.m_object_instance;
-            reflector_vertex.m_position = event_data.m_vertex_position;
-            reflector_vertex.m_radiance = current_radiance;
-            m_vertices.push_back(reflector_vertex);
+            insert_vertex(get_reflector_point(event_index), current_radiance);
 
             // Update current radiance.
             const auto& throughput = event_data.m_path_throughput;
@@ -342,11 +335,7 @@ void LightPathStream::create_path_from_sampled_emitter(const size_t emitter_even
     }
 
     // Camera vertex.
-    StoredPathVertex camera_vertex;
-    camera_vertex.m_entity = m_camera;
-    camera_vertex.m_position = m_camera_vertex_position;
-    camera_vertex.m_radiance = current_radiance;
-    m_vertices.push_back(camera_vertex);
+    insert_vertex(get_camera_point(), current_radiance);
 
     // Store path.
     stored_path.m_vertex_end_index = static_cast<uint32>(m_vertices.size());
@@ -373,11 +362,11 @@ void LightPathStream::create_path_from_sampled_environment(const size_t env_even
     stored_path.m_vertex_begin_index = static_cast<uint32>(m_vertices.size());
 
     // Emitter vertex.
-    StoredPathVertex emitter_vertex;
-    emitter_vertex.m_entity = sampled_env_data.m_environment_edf;
-    emitter_vertex.m_position = last_reflector_data.m_vertex_position + m_scene_diameter * sampled_env_data.m_emission_direction;
-    emitter_vertex.m_radiance = sampled_env_data.m_emitted_radiance;
-    m_vertices.push_back(emitter_vertex);
+    insert_vertex(
+        insert_point(
+            sampled_env_data.m_environment_edf,
+            last_reflector_data.m_vertex_position + m_scene_diameter * sampled_env_data.m_emission_direction),
+        sampled_env_data.m_emitted_radiance);
 
     Color3f current_radiance = sampled_env_data.m_emitted_radiance;
     Color3f prev_throughput = sampled_env_data.m_material_value * last_reflector_data.m_path_throughput;
@@ -393,11 +382,7 @@ void LightPathStream::create_path_from_sampled_environment(const size_t env_even
             const auto& event_data = get_reflector_data(event_index);
 
             // Reflector vertex.
-            StoredPathVertex reflector_vertex;
-            reflector_vertex.m_entity = event_data.m_object_instance;
-            reflector_vertex.m_position = event_data.m_vertex_position;
-            reflector_vertex.m_radiance = current_radiance;
-            m_vertices.push_back(reflector_vertex);
+            insert_vertex(get_reflector_point(event_index), current_radiance);
 
             // Update current radiance.
             const auto& throughput = event_data.m_path_throughput;
@@ -408,11 +393,7 @@ void LightPathStream::create_path_from_sampled_environment(const size_t env_even
     }
 
     // Camera vertex.
-    StoredPathVertex camera_vertex;
-    camera_vertex.m_entity = m_camera;
-    camera_vertex.m_position = m_camera_vertex_position;
-    camera_vertex.m_radiance = current_radiance;
-    m_vertices.push_back(camera_vertex);
+    insert_vertex(get_camera_point(), current_radiance);
 
     // Store path.
     stored_path.m_vertex_end_index = static_cast<uint32>(m_vertices.size());
@@ -433,4 +414,58 @@ const LightPathStream::HitReflectorData& LightPathStream::get_reflector_data(con
             : m_hit_emitter_data[event.m_data_index];
 }
 
+uint32 LightPathStream::insert_point(
+    const Entity*           entity,
+    const Vector3f&         position)
+{
+    // Find or assign the index of the entity.
+    const auto entity_it =
+        m_entity_indices.insert(
+            make_pair(entity, static_cast<uint32>(m_entities.size()))).first;
+    if (entity_it->second == m_entities.size())
+        m_entities.push_back(entity);
+
+    StoredPathPoint point;
+    point.m_entity_index = entity_it->second;
+    point.m_position = position;
+    m_points.push_back(point);
+
+    return static_cast<uint32>(m_points.size() - 1);
+}
+
+uint32 LightPathStream::get_reflector_point(const size_t event_index)
+{
+    // Reflectors are shared by all the paths created from the current camera path.
+    uint32& point_index = m_event_points[event_index];
+
+    if (point_index == ~uint32(0))
+    {
+        const auto& event_data = get_reflector_data(event_index);
+        point_index = insert_point(event_data.m_object_instance, event_data.m_vertex_position);
+    }
+
+    return point_index;
+}
+
+uint32 LightPathStream::get_camera_point()
+{
+    if (m_camera_point == ~uint32(0))
+        m_camera_point = insert_point(m_camera, m_camera_vertex_position);
+
+    return m_camera_point;
+}
+
+void LightPathStream::insert_vertex(
+    const uint32            point_index,
+    const Color3f&          radiance)
+{
+    // Clamp radiance to the range of half floats.
+    StoredPathVertex vertex;
+    vertex.m_point_index = point_index;
+    vertex.m_radiance[0] = min(radiance[0], 65504.0f);
+    vertex.m_radiance[1] = min(radiance[1], 65504.0f);
+    vertex.m_radiance[2] = min(radiance[2], 65504.0f);
+    m_vertices.push_back(vertex);
+}
+
 }   // namespace renderer
@@ -33,11 +33,13 @@
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
+#include "foundation/math/half.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cstddef>
+#include <unordered_map>
 #include <vector>
 
 // Forward declarations.
@@ -152,11 +154,19 @@ class LightPathStream
         foundation::uint32          m_vertex_end_index;         // index of one vertex past the last one in m_vertices
     };
 
+    // Scattering points are shared by all the paths going through them (e.g. all the
+    // paths built from the light samples taken along a given camera path), only the
+    // radiance arriving at them differs from one path to the next.
+    struct StoredPathPoint
+    {
+        foundation::uint32          m_entity_index;             // index of the object instance or non-physical light in m_entities
+        foundation::Vector3f        m_position;                 // world space position of this point
+    };
+
     struct StoredPathVertex
     {
-        const Entity*               m_entity;                   // object instance or non-physical light
-        foundation::Vector3f        m_position;                 // world space position of this vertex
-        foundation::Color3f         m_radiance;                 // radiance arriving at this vertex, in W.sr^-1.m^-2
+        foundation::uint32          m_point_index;              // index of this vertex's point in m_points
+        foundation::Half            m_radiance[3];              // radiance arriving at this vertex, in W.sr^-1.m^-2
     };
 
     // Scene.
@@ -176,9 +186,16 @@ class LightPathStream
     std::vector<SampledEmitterData> m_sampled_emitter_data;
     std::vector<SampledEnvData>     m_sampled_env_data;
 
-    // Final representation as paths and path vertices (persistent).
+    // Points created for the current camera path (transient).
+    std::vector<foundation::uint32> m_event_points;             // point index of each scattering event, or ~0
+    foundation::uint32              m_camera_point;             // point index of the camera vertex, or ~0
+
+    // Final representation as paths, path vertices and shared points (persistent).
     std::vector<StoredPath>         m_paths;
     std::vector<StoredPathVertex>   m_vertices;
+    std::vector<StoredPathPoint>    m_points;
+    std::vector<const Entity*>      m_entities;
+    std::unordered_map<const Entity*, foundation::uint32> m_entity_indices;
 
     // Constructor.
     explicit LightPathStream(const Project& project);
@@ -188,6 +205,16 @@ class LightPathStream
     void create_path_from_sampled_environment(const size_t env_event_index);
 
     const HitReflectorData& get_reflector_data(const size_t event_index) const;
+
+    foundation::uint32 insert_point(
+        const Entity*                   entity,
+        const foundation::Vector3f&     position);
+    foundation::uint32 get_reflector_point(const size_t event_index);
+    foundation::uint32 get_camera_point();
+
+    void insert_vertex(
+        const foundation::uint32        point_index,
+        const foundation::Color3f&      radiance);
 };
 
 }   // namespace renderer
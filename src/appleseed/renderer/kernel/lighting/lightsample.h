@@ -34,7 +34,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/hash.h"
-#include "foundation/utility/containers/hashtable.h"
+#include "foundation/utility/containers/flathashtable.h"
 #include "foundation/utility/uid.h"
 
 // Standard headers.
@@ -78,7 +78,7 @@ struct EmittingShapeKeyHasher
     size_t operator()(const EmittingShapeKey& key) const;
 };
 
-typedef foundation::HashTable<
+typedef foundation::FlatHashTable<
     EmittingShapeKey,
     EmittingShapeKeyHasher,
     const EmittingShape*
@@ -30,6 +30,7 @@
 #include "lightsamplerbase.h"
 
 // appleseed.renderer headers
+#include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/modeling/edf/edf.h"
@@ -44,7 +45,14 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/sampling/mappings.h"
+#include "foundation/platform/system.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/job.h"
+
+// Standard headers.
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -52,13 +60,308 @@ using namespace std;
 namespace renderer
 {
 
+//
+// LightSamplerBase::EmittingTriangleSource class implementation.
+//
+
+struct LightSamplerBase::EmittingTriangleSource
+{
+    const AssemblyInstance&     m_assembly_instance;
+    const size_t                m_object_instance_index;
+    const ObjectInstance&       m_object_instance;
+    const StaticTriangleTess&   m_tess;
+    const MaterialArray&        m_front_materials;
+    const MaterialArray&        m_back_materials;
+    const Transformd&           m_object_instance_transform;    // object instance space to assembly space
+    const Transformd&           m_assembly_instance_transform;  // assembly space to world space
+    const Transformd&           m_global_transform;             // object instance space to world space
+
+    EmittingTriangleSource(
+        const AssemblyInstance&     assembly_instance,
+        const size_t                object_instance_index,
+        const ObjectInstance&       object_instance,
+        const StaticTriangleTess&   tess,
+        const MaterialArray&        front_materials,
+        const MaterialArray&        back_materials,
+        const Transformd&           assembly_instance_transform,
+        const Transformd&           global_transform)
+      : m_assembly_instance(assembly_instance)
+      , m_object_instance_index(object_instance_index)
+      , m_object_instance(object_instance)
+      , m_tess(tess)
+      , m_front_materials(front_materials)
+      , m_back_materials(back_materials)
+      , m_object_instance_transform(object_instance.get_transform())
+      , m_assembly_instance_transform(assembly_instance_transform)
+      , m_global_transform(global_transform)
+    {
+    }
+};
+
+
+//
+// LightSamplerBase::EmittingTriangleJob class implementation.
+//
+
+class LightSamplerBase::EmittingTriangleJob
+  : public IJob
+{
+  public:
+    EmittingTriangleJob(
+        const EmittingTriangleSource&   source,
+        const size_t                    begin,
+        const size_t                    end,
+        EmittingShapeVector&            shapes)
+      : m_source(source)
+      , m_begin(begin)
+      , m_end(end)
+      , m_shapes(shapes)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        create_emitting_triangles(m_source, m_begin, m_end, m_shapes);
+    }
+
+  private:
+    const EmittingTriangleSource&       m_source;
+    const size_t                        m_begin;
+    const size_t                        m_end;
+    EmittingShapeVector&                m_shapes;
+};
+
+
 //
 // LightSamplerBase class implementation.
 //
 
+namespace
+{
+    // Number of triangles processed by a single job when collecting light-emitting triangles.
+    const size_t EmittingTriangleChunkSize = 16 * 1024;
+
+    // Meshes with fewer triangles are processed on the calling thread.
+    const size_t MinParallelEmittingTriangleCount = 4 * EmittingTriangleChunkSize;
+}
+
+void LightSamplerBase::create_emitting_triangles(
+    const EmittingTriangleSource&       source,
+    const size_t                        begin,
+    const size_t                        end,
+    EmittingShapeVector&                shapes)
+{
+    const StaticTriangleTess& tess = source.m_tess;
+    const MaterialArray& front_materials = source.m_front_materials;
+    const MaterialArray& back_materials = source.m_back_materials;
+    const Transformd& object_instance_transform = source.m_object_instance_transform;
+    const Transformd& assembly_instance_transform = source.m_assembly_instance_transform;
+    const Transformd& global_transform = source.m_global_transform;
+    const bool flip_normals = source.m_object_instance.must_flip_normals();
+
+    // Loop over the triangles of the range.
+    for (size_t triangle_index = begin; triangle_index < end; ++triangle_index)
+    {
+        // Fetch the triangle.
+        const Triangle triangle = tess.get_primitive(triangle_index);
+
+        // Skip triangles without a material.
+        if (triangle.m_pa == Triangle::None)
+            continue;
+
+        // Fetch the materials assigned to this triangle.
+        const size_t pa_index = static_cast<size_t>(triangle.m_pa);
+        const Material* front_material =
+            pa_index < front_materials.size() ? front_materials[pa_index] : nullptr;
+        const Material* back_material =
+            pa_index < back_materials.size() ? back_materials[pa_index] : nullptr;
+
+        // Skip triangles that don't emit light.
+        if ((front_material == nullptr || !front_material->has_emission()) &&
+            (back_material == nullptr || !back_material->has_emission()))
+            continue;
+
+        // Retrieve object instance space vertices of the triangle.
+        const GVector3& v0_os = tess.m_vertices[triangle.m_v0];
+        const GVector3& v1_os = tess.m_vertices[triangle.m_v1];
+        const GVector3& v2_os = tess.m_vertices[triangle.m_v2];
+
+        // Transform triangle vertices to assembly space.
+        const GVector3 v0_as = object_instance_transform.point_to_parent(v0_os);
+        const GVector3 v1_as = object_instance_transform.point_to_parent(v1_os);
+        const GVector3 v2_as = object_instance_transform.point_to_parent(v2_os);
+
+        // Compute the support plane of the hit triangle in assembly space.
+        const GTriangleType triangle_geometry(v0_as, v1_as, v2_as);
+        TriangleSupportPlaneType triangle_support_plane;
+        triangle_support_plane.initialize(TriangleType(triangle_geometry));
+
+        // Transform triangle vertices to world space.
+        const Vector3d v0(assembly_instance_transform.point_to_parent(v0_as));
+        const Vector3d v1(assembly_instance_transform.point_to_parent(v1_as));
+        const Vector3d v2(assembly_instance_transform.point_to_parent(v2_as));
+
+        // Compute the geometric normal to the triangle and the area of the triangle.
+        Vector3d geometric_normal = compute_triangle_normal(v0, v1, v2);
+        const double geometric_normal_norm = norm(geometric_normal);
+        if (geometric_normal_norm == 0.0)
+            continue;
+        const double rcp_geometric_normal_norm = 1.0 / geometric_normal_norm;
+        const double rcp_area = 2.0 * rcp_geometric_normal_norm;
+        const double area = 0.5 * geometric_normal_norm;
+        geometric_normal *= rcp_geometric_normal_norm;
+        assert(is_normalized(geometric_normal));
+
+        // Flip the geometric normal if the object instance requests so.
+        if (flip_normals)
+            geometric_normal = -geometric_normal;
+
+        Vector3d n0, n1, n2;
+
+        if (triangle.m_n0 != Triangle::None &&
+            triangle.m_n1 != Triangle::None &&
+            triangle.m_n2 != Triangle::None)
+        {
+            // Retrieve object instance space vertex normals.
+            const Vector3d n0_os = Vector3d(tess.get_vertex_normal(triangle.m_n0));
+            const Vector3d n1_os = Vector3d(tess.get_vertex_normal(triangle.m_n1));
+            const Vector3d n2_os = Vector3d(tess.get_vertex_normal(triangle.m_n2));
+
+            // Transform vertex normals to world space.
+            n0 = normalize(global_transform.normal_to_parent(n0_os));
+            n1 = normalize(global_transform.normal_to_parent(n1_os));
+            n2 = normalize(global_transform.normal_to_parent(n2_os));
+
+            // Flip normals if the object instance requests so.
+            if (flip_normals)
+            {
+                n0 = -n0;
+                n1 = -n1;
+                n2 = -n2;
+            }
+        }
+        else
+        {
+            n0 = n1 = n2 = geometric_normal;
+        }
+
+        for (size_t side = 0; side < 2; ++side)
+        {
+            // Retrieve the material; skip sides without a material or without emission.
+            const Material* material = side == 0 ? front_material : back_material;
+            if (material == nullptr || !material->has_emission())
+                continue;
+
+            // Create a light-emitting triangle.
+            auto emitting_shape = EmittingShape::create_triangle_shape(
+                &source.m_assembly_instance,
+                source.m_object_instance_index,
+                triangle_index,
+                material,
+                area,
+                v0,
+                v1,
+                v2,
+                side == 0 ? n0 : -n0,
+                side == 0 ? n1 : -n1,
+                side == 0 ? n2 : -n2,
+                side == 0 ? geometric_normal : -geometric_normal);
+            emitting_shape.m_shape_support_plane = triangle_support_plane;
+            emitting_shape.m_area = static_cast<float>(area);
+            emitting_shape.m_rcp_area = static_cast<float>(rcp_area);
+
+            // Estimate radiant flux emitted by this shape.
+            emitting_shape.estimate_flux();
+
+            shapes.push_back(emitting_shape);
+        }
+    }
+}
+
+void LightSamplerBase::collect_emitting_triangles(
+    const EmittingTriangleSource&       source,
+    float&                              object_area,
+    const ShapeHandlingFunction&        shape_handling)
+{
+    const size_t triangle_count = source.m_tess.get_primitive_count();
+
+    const size_t thread_count =
+        triangle_count >= MinParallelEmittingTriangleCount
+            ? System::get_logical_cpu_core_count()
+            : 1;
+
+    // Triangles are processed in batches of one chunk per thread to bound the amount of
+    // temporary storage. The shape handling function is then invoked on the candidate
+    // shapes in triangle order, exactly as if they had been created sequentially.
+    const size_t batch_size = thread_count * EmittingTriangleChunkSize;
+    vector<EmittingShapeVector> candidates(thread_count);
+
+    unique_ptr<JobQueue> job_queue;
+    unique_ptr<JobManager> job_manager;
+
+    if (thread_count > 1)
+    {
+        job_queue.reset(new JobQueue());
+        job_manager.reset(
+            new JobManager(
+                global_logger(),
+                *job_queue,
+                thread_count,
+                JobManager::KeepRunningOnEmptyQueue));
+        job_manager->start();
+    }
+
+    for (size_t batch_begin = 0; batch_begin < triangle_count; batch_begin += batch_size)
+    {
+        const size_t batch_end = min(batch_begin + batch_size, triangle_count);
+
+        size_t chunk_count = 0;
+
+        for (size_t chunk_begin = batch_begin; chunk_begin < batch_end; chunk_begin += EmittingTriangleChunkSize)
+        {
+            const size_t chunk_end = min(chunk_begin + EmittingTriangleChunkSize, batch_end);
+            EmittingShapeVector& chunk_shapes = candidates[chunk_count++];
+            chunk_shapes.clear();
+
+            if (job_manager)
+                job_queue->schedule(new EmittingTriangleJob(source, chunk_begin, chunk_end, chunk_shapes));
+            else create_emitting_triangles(source, chunk_begin, chunk_end, chunk_shapes);
+        }
+
+        if (job_manager)
+            job_queue->wait_until_completion();
+
+        for (size_t i = 0; i < chunk_count; ++i)
+        {
+            for (const EmittingShape& emitting_shape : candidates[i])
+            {
+                // Invoke the shape handling function.
+                const bool accept_shape =
+                    shape_handling(
+                        emitting_shape.get_material(),
+                        emitting_shape.m_area,
+                        m_emitting_shapes.size());
+
+                if (accept_shape)
+                {
+                    // Store the light-emitting shape.
+                    m_emitting_shapes.push_back(emitting_shape);
+
+                    // Accumulate the object area for OSL shaders.
+                    object_area += emitting_shape.m_area;
+                }
+            }
+        }
+    }
+
+    if (job_manager)
+        job_manager->stop();
+}
+
 LightSamplerBase::LightSamplerBase(const ParamArray& params)
   : m_params(params)
   , m_emitting_shape_hash_table(m_shape_key_hasher)
+  , m_memory_record(MemoryTagLights)
 {
 }
 
@@ -94,9 +397,33 @@ Dictionary LightSamplerBase::get_params_metadata()
             .insert("label", "Enable Importance Sampling")
             .insert("help", "Enable Importance Sampling"));
 
+    metadata.insert(
+        "enable_alias_sampling",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Alias Sampling")
+            .insert("help", "Pick emitters in constant time using alias tables instead of binary searches in CDFs"));
+
     return metadata;
 }
 
+void LightSamplerBase::build_alias_table(
+    const EmitterCDF&                   cdf,
+    EmitterAliasTable&                  alias_table)
+{
+    assert(cdf.valid());
+
+    // The alias table indices are the CDF indices, the CDF maps them back to emitters.
+    alias_table.clear();
+    alias_table.reserve(cdf.size());
+
+    for (size_t i = 0, e = cdf.size(); i < e; ++i)
+        alias_table.insert(cdf[i].second);
+
+    alias_table.prepare();
+}
+
 void LightSamplerBase::build_emitting_shape_hash_table()
 {
     const size_t emitting_shape_count = m_emitting_shapes.size();
@@ -115,6 +442,11 @@ void LightSamplerBase::build_emitting_shape_hash_table()
 
         m_emitting_shape_hash_table.insert(emitting_shape_key, &emitting_shape);
     }
+
+    // Account for the memory used by the light emitters.
+    m_memory_record.set(
+        m_non_physical_lights.capacity() * sizeof(NonPhysicalLightInfo) +
+        m_emitting_shapes.capacity() * sizeof(EmittingShape));
 }
 
 void LightSamplerBase::collect_emitting_shapes(
@@ -183,150 +515,18 @@ void LightSamplerBase::collect_emitting_shapes(
         {
             // Retrieve the tessellation of the mesh.
             const MeshObject& mesh = static_cast<const MeshObject&>(object);
-            const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
-
-            // Skip object instances without light-emitting materials.
-            if (!has_emitting_materials(front_materials) && !has_emitting_materials(back_materials))
-                continue;
-
-            // Compute the object space to world space transformation.
-            // todo: add support for moving light-emitters.
-            const Transformd& object_instance_transform = object_instance->get_transform();
-            const Transformd& assembly_instance_transform = transform_sequence.get_earliest_transform();
-            const Transformd global_transform = assembly_instance_transform * object_instance_transform;
-
-            // Loop over the triangles of the mesh.
-            for (size_t triangle_index = 0, triangle_count = tess.m_primitives.size();
-                triangle_index < triangle_count; ++triangle_index)
-            {
-                // Fetch the triangle.
-                const Triangle& triangle = tess.m_primitives[triangle_index];
-
-                // Skip triangles without a material.
-                if (triangle.m_pa == Triangle::None)
-                    continue;
-
-                // Fetch the materials assigned to this triangle.
-                const size_t pa_index = static_cast<size_t>(triangle.m_pa);
-                const Material* front_material =
-                    pa_index < front_materials.size() ? front_materials[pa_index] : nullptr;
-                const Material* back_material =
-                    pa_index < back_materials.size() ? back_materials[pa_index] : nullptr;
-
-                // Skip triangles that don't emit light.
-                if ((front_material == nullptr || !front_material->has_emission()) &&
-                    (back_material == nullptr || !back_material->has_emission()))
-                    continue;
-
-                // Retrieve object instance space vertices of the triangle.
-                const GVector3& v0_os = tess.m_vertices[triangle.m_v0];
-                const GVector3& v1_os = tess.m_vertices[triangle.m_v1];
-                const GVector3& v2_os = tess.m_vertices[triangle.m_v2];
-
-                // Transform triangle vertices to assembly space.
-                const GVector3 v0_as = object_instance_transform.point_to_parent(v0_os);
-                const GVector3 v1_as = object_instance_transform.point_to_parent(v1_os);
-                const GVector3 v2_as = object_instance_transform.point_to_parent(v2_os);
-
-                // Compute the support plane of the hit triangle in assembly space.
-                const GTriangleType triangle_geometry(v0_as, v1_as, v2_as);
-                TriangleSupportPlaneType triangle_support_plane;
-                triangle_support_plane.initialize(TriangleType(triangle_geometry));
-
-                // Transform triangle vertices to world space.
-                const Vector3d v0(assembly_instance_transform.point_to_parent(v0_as));
-                const Vector3d v1(assembly_instance_transform.point_to_parent(v1_as));
-                const Vector3d v2(assembly_instance_transform.point_to_parent(v2_as));
-
-                // Compute the geometric normal to the triangle and the area of the triangle.
-                Vector3d geometric_normal = compute_triangle_normal(v0, v1, v2);
-                const double geometric_normal_norm = norm(geometric_normal);
-                if (geometric_normal_norm == 0.0)
-                    continue;
-                const double rcp_geometric_normal_norm = 1.0 / geometric_normal_norm;
-                const double rcp_area = 2.0 * rcp_geometric_normal_norm;
-                const double area = 0.5 * geometric_normal_norm;
-                geometric_normal *= rcp_geometric_normal_norm;
-                assert(is_normalized(geometric_normal));
-
-                // Flip the geometric normal if the object instance requests so.
-                if (object_instance->must_flip_normals())
-                    geometric_normal = -geometric_normal;
-
-                Vector3d n0, n1, n2;
-
-                if (triangle.m_n0 != Triangle::None &&
-                    triangle.m_n1 != Triangle::None &&
-                    triangle.m_n2 != Triangle::None)
-                {
-                    // Retrieve object instance space vertex normals.
-                    const Vector3d n0_os = Vector3d(tess.m_vertex_normals[triangle.m_n0]);
-                    const Vector3d n1_os = Vector3d(tess.m_vertex_normals[triangle.m_n1]);
-                    const Vector3d n2_os = Vector3d(tess.m_vertex_normals[triangle.m_n2]);
-
-                    // Transform vertex normals to world space.
-                    n0 = normalize(global_transform.normal_to_parent(n0_os));
-                    n1 = normalize(global_transform.normal_to_parent(n1_os));
-                    n2 = normalize(global_transform.normal_to_parent(n2_os));
-
-                    // Flip normals if the object instance requests so.
-                    if (object_instance->must_flip_normals())
-                    {
-                        n0 = -n0;
-                        n1 = -n1;
-                        n2 = -n2;
-                    }
-                }
-                else
-                {
-                    n0 = n1 = n2 = geometric_normal;
-                }
 
-                for (size_t side = 0; side < 2; ++side)
-                {
-                    // Retrieve the material; skip sides without a material or without emission.
-                    const Material* material = side == 0 ? front_material : back_material;
-                    if (material == nullptr || !material->has_emission())
-                        continue;
-
-                    // Invoke the shape handling function.
-                    const bool accept_shape =
-                        shape_handling(
-                            material,
-                            static_cast<float>(area),
-                            m_emitting_shapes.size());
-
-                    if (accept_shape)
-                    {
-                        // Create a light-emitting triangle.
-                        auto emitting_shape = EmittingShape::create_triangle_shape(
-                            &assembly_instance,
-                            object_instance_index,
-                            triangle_index,
-                            material,
-                            area,
-                            v0,
-                            v1,
-                            v2,
-                            side == 0 ? n0 : -n0,
-                            side == 0 ? n1 : -n1,
-                            side == 0 ? n2 : -n2,
-                            side == 0 ? geometric_normal : -geometric_normal);
-                        emitting_shape.m_shape_support_plane = triangle_support_plane;
-                        emitting_shape.m_area = static_cast<float>(area);
-                        emitting_shape.m_rcp_area = static_cast<float>(rcp_area);
-
-                        // Estimate radiant flux emitted by this shape.
-                        emitting_shape.estimate_flux();
-
-                        // Store the light-emitting shape.
-                        m_emitting_shapes.push_back(emitting_shape);
-
-                        // Accumulate the object area for OSL shaders.
-                        object_area += emitting_shape.m_area;
-                    }
-                }
-            }
+            const EmittingTriangleSource source(
+                assembly_instance,
+                object_instance_index,
+                *object_instance,
+                mesh.get_static_triangle_tess(),
+                front_materials,
+                back_materials,
+                assembly_instance_transform,
+                global_transform);
+
+            collect_emitting_triangles(source, object_area, shape_handling);
         }
         else if (strcmp(object.get_model(), RectangleObjectFactory().get_model()) == 0)
         {
@@ -640,9 +840,20 @@ void LightSamplerBase::sample_emitting_shapes(
 {
     assert(m_emitting_shapes_cdf.valid());
 
-    const EmitterCDF::ItemWeightPair result = m_emitting_shapes_cdf.sample(s[0]);
-    const size_t emitter_index = result.first;
-    const float emitter_prob = result.second;
+    size_t emitter_index;
+    float emitter_prob;
+
+    if (m_emitting_shapes_alias_table.valid())
+    {
+        const size_t i = m_emitting_shapes_alias_table.sample(s[0], emitter_prob);
+        emitter_index = m_emitting_shapes_cdf[i].first;
+    }
+    else
+    {
+        const EmitterCDF::ItemWeightPair result = m_emitting_shapes_cdf.sample(s[0]);
+        emitter_index = result.first;
+        emitter_prob = result.second;
+    }
 
     light_sample.m_light = nullptr;
     const EmittingShape& emitting_shape = m_emitting_shapes[emitter_index];
@@ -659,6 +870,7 @@ void LightSamplerBase::sample_emitting_shapes(
 
 LightSamplerBase::Parameters::Parameters(const ParamArray& params)
   : m_importance_sampling(params.get_optional<bool>("enable_importance_sampling", false))
+  , m_alias_sampling(params.get_optional<bool>("enable_alias_sampling", false))
 {
 }
 
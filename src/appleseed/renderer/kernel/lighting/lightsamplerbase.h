@@ -36,8 +36,12 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aliastable.h"
 #include "foundation/math/cdf.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
 #include <functional>
 
@@ -76,6 +80,7 @@ class LightSamplerBase
     struct Parameters
     {
         const bool m_importance_sampling;
+        const bool m_alias_sampling;
 
         explicit Parameters(const ParamArray& params);
     };
@@ -83,6 +88,7 @@ class LightSamplerBase
     typedef std::vector<NonPhysicalLightInfo> NonPhysicalLightVector;
     typedef std::vector<EmittingShape> EmittingShapeVector;
     typedef foundation::CDF<size_t, float> EmitterCDF;
+    typedef foundation::AliasTable<float> EmitterAliasTable;
 
     typedef std::function<void (const NonPhysicalLightInfo&)> LightHandlingFunction;
     typedef std::function<bool (const Material*, const float, const size_t)> ShapeHandlingFunction;
@@ -97,18 +103,49 @@ class LightSamplerBase
     EmitterCDF                              m_non_physical_lights_cdf;
     EmitterCDF                              m_emitting_shapes_cdf;
 
+    // Alias tables mirroring the CDFs above, only built when alias sampling is enabled.
+    EmitterAliasTable                       m_non_physical_lights_alias_table;
+    EmitterAliasTable                       m_emitting_shapes_alias_table;
+
     EmittingShapeKeyHasher                  m_shape_key_hasher;
     EmittingShapeHashTable                  m_emitting_shape_hash_table;
 
+    TaggedMemoryRecord                      m_memory_record;
+
     // Return metadata for parameters common to all light samplers.
     static foundation::Dictionary get_params_metadata();
 
     // Constructor.
     explicit LightSamplerBase(const ParamArray& params);
 
+    // Build an alias table from a prepared emitter CDF.
+    static void build_alias_table(
+        const EmitterCDF&                   cdf,
+        EmitterAliasTable&                  alias_table);
+
     // Build a hash table that allows to find the emitting shape at a given shading point.
     void build_emitting_shape_hash_table();
 
+    // Source of the light-emitting triangles of a mesh object instance.
+    struct EmittingTriangleSource;
+
+    // Job creating the light-emitting triangles of a range of triangles.
+    class EmittingTriangleJob;
+
+    // Create the light-emitting triangles of a range of triangles of a mesh object instance,
+    // in the order in which they must be presented to the shape handling function.
+    static void create_emitting_triangles(
+        const EmittingTriangleSource&       source,
+        const size_t                        begin,
+        const size_t                        end,
+        EmittingShapeVector&                shapes);
+
+    // Collect the light-emitting triangles of a mesh object instance.
+    void collect_emitting_triangles(
+        const EmittingTriangleSource&       source,
+        float&                              object_area,
+        const ShapeHandlingFunction&        shape_handling);
+
     // Recursively collect emitting shapes from a given set of assembly instances.
     void collect_emitting_shapes(
         const AssemblyInstanceContainer&    assembly_instances,
@@ -472,7 +472,7 @@ namespace
                 const Vector3d geometric_normal =
                     flip_to_same_hemisphere(
                         vertex.get_geometric_normal(),
-                        vertex.get_shading_normal());
+                        Vector3d(vertex.get_shading_normal()));
 
                 // Evaluate the BSDF at the vertex position.
                 DirectShadingComponents bsdf_value;
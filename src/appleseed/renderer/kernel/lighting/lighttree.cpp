@@ -44,6 +44,7 @@
 #include "foundation/math/permutation.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/timers.h"
 #include "foundation/utility/vpythonfile.h"
 
@@ -116,8 +117,8 @@ vector<size_t> LightTree::build()
     Partitioner partitioner(light_bboxes);
 
     // Build the light tree.
-    typedef bvh::Builder<LightTree, Partitioner> Builder;
-    Builder builder;
+    typedef bvh::ParallelBuilder<LightTree, Partitioner> Builder;
+    Builder builder(System::get_logical_cpu_core_count());
     builder.build<DefaultWallclockTimer>(*this, partitioner, m_items.size(), 1);
 
     // Reorder m_items vector to match the ordering in the LightTree.
@@ -310,11 +311,27 @@ namespace
         assert(cos_omega >= -1.0f && cos_omega <= 1.0f);
         assert(cos_sigma >= 0.0f && cos_sigma <= 1.0f);
 
-        const float sin_omega = sqrt(1.0f - cos_omega * cos_omega);
-
         const float sin_sigma2 = 1.0f - (cos_sigma * cos_sigma);
         const float sin_sigma = sqrt(sin_sigma2);
 
+        // The angles omega and sigma are compared through their cosines: since omega lies
+        // in [0, pi] and sigma in [0, pi/2], omega < pi/2 - sigma is cos(omega) > sin(sigma)
+        // and omega < pi/2 + sigma is cos(omega) > -sin(sigma).
+
+        // The light source is entirely above the horizon.
+        if (cos_omega > sin_sigma)
+        {
+            const float contribution = cos_omega * sin_sigma2;
+            return fz(contribution) ? default_eps<float>() : contribution;
+        }
+
+        // The light source is entirely below the horizon.
+        if (cos_omega <= -sin_sigma)
+            return default_eps<float>();
+
+        // The light source straddles the horizon.
+        const float sin_omega = sqrt(1.0f - cos_omega * cos_omega);
+
         const float sin_gamma = cos_sigma / sin_omega;
         const float cos_gamma2 = 1.0f - (sin_gamma * sin_gamma);
         const float cos_gamma = sqrt(cos_gamma2);
@@ -329,18 +346,10 @@ namespace
                 cos_gamma * sqrt(sin_sigma2 - cos_gamma2)
                 + sin_sigma2 * asin(cos_gamma / sin_sigma));
 
-        const float omega = acos(cos_omega);
-        const float sigma = acos(cos_sigma);
-
-        float contribution;
-        if (omega < (HalfPi<float>() - sigma))
-            contribution = cos_omega * sin_sigma2;
-        else if (omega < HalfPi<float>())
-            contribution = cos_omega * sin_sigma2 + RcpPi<float>() * (g - h);
-        else if (omega < (HalfPi<float>() + sigma))
-            contribution = RcpPi<float>() * (g + h);
-        else
-            contribution = default_eps<float>();
+        const float contribution =
+            cos_omega > 0.0f
+                ? cos_omega * sin_sigma2 + RcpPi<float>() * (g - h)
+                : RcpPi<float>() * (g + h);
 
         // Avoid returning zero contribution.
         if (fz(contribution))
@@ -394,9 +403,10 @@ float LightTree::compute_node_probability(
     const Vector3d& incoming_light_direction = shading_point.get_ray().m_dir;
 
     // [1] "Arbitrary direction D receives light only if dot(D,L) >= 0".
-    const Vector3d& N = (dot(shading_point.get_geometric_normal(), incoming_light_direction) <= 0.0f)
-        ? shading_point.get_shading_normal()
-        : -shading_point.get_shading_normal();
+    const Vector3d N(
+        (dot(shading_point.get_geometric_normal(), incoming_light_direction) <= 0.0f)
+            ? shading_point.get_shading_normal()
+            : -shading_point.get_shading_normal());
 
     const float cos_omega = clamp(static_cast<float>(dot(N, outcoming_light_direction)), -1.0f, 1.0f);
     const float approx_contribution = sub_hemispherical_light_source_contribution(cos_omega, cos_sigma);
@@ -94,9 +94,9 @@ EmittingShape EmittingShape::create_triangle_shape(
     shape.m_geom.m_triangle.m_v0 = v0;
     shape.m_geom.m_triangle.m_v1 = v1;
     shape.m_geom.m_triangle.m_v2 = v2;
-    shape.m_geom.m_triangle.m_n0 = n0;
-    shape.m_geom.m_triangle.m_n1 = n1;
-    shape.m_geom.m_triangle.m_n2 = n2;
+    shape.m_geom.m_triangle.m_n0 = Vector3f(n0);
+    shape.m_geom.m_triangle.m_n1 = Vector3f(n1);
+    shape.m_geom.m_triangle.m_n2 = Vector3f(n2);
     shape.m_geom.m_triangle.m_geometric_normal = geometric_normal;
     shape.m_geom.m_triangle.m_plane_dist = -dot(v0, geometric_normal);
 
@@ -226,8 +226,8 @@ EmittingShape::EmittingShape(
         assembly_instance,
         static_cast<foundation::uint16>(shape_type));
 
-    m_object_instance_index = object_instance_index;
-    m_primitive_index = primitive_index;
+    m_object_instance_index = static_cast<uint32>(object_instance_index);
+    m_primitive_index = static_cast<uint32>(primitive_index);
     m_material = material;
     m_shape_prob = 0.0f;
     m_average_flux = 1.0f;
@@ -260,9 +260,9 @@ void EmittingShape::sample_uniform(
 
         // Compute the world space shading normal at the position of the sample.
         light_sample.m_shading_normal =
-              bary[0] * m_geom.m_triangle.m_n0
-            + bary[1] * m_geom.m_triangle.m_n1
-            + bary[2] * m_geom.m_triangle.m_n2;
+              bary[0] * Vector3d(m_geom.m_triangle.m_n0)
+            + bary[1] * Vector3d(m_geom.m_triangle.m_n1)
+            + bary[2] * Vector3d(m_geom.m_triangle.m_n2);
         light_sample.m_shading_normal = normalize(light_sample.m_shading_normal);
 
         // Set the world space geometric normal.
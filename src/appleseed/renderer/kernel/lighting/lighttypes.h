@@ -35,6 +35,7 @@
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/stampedptr.h"
 
 // Standard headers.
@@ -177,7 +178,7 @@ class EmittingShape
     struct Triangle
     {
         foundation::Vector3d    m_v0, m_v1, m_v2;               // world space vertices of the shape
-        foundation::Vector3d    m_n0, m_n1, m_n2;               // world space vertex normals
+        foundation::Vector3f    m_n0, m_n1, m_n2;               // world space vertex normals, stored in single precision to save memory
         foundation::Vector3d    m_geometric_normal;             // world space geometric normal, unit-length
         double  m_plane_dist;
     };
@@ -216,10 +217,9 @@ class EmittingShape
 
     typedef foundation::stamped_ptr<const AssemblyInstance> AssemblyInstanceAndType;
 
+    // Indices are stored on 32 bits, like in EmittingShapeKey, and packed with the
+    // single precision members below to avoid padding.
     AssemblyInstanceAndType     m_assembly_instance_and_type;
-    size_t                      m_object_instance_index;
-    size_t                      m_light_tree_node_index;
-    size_t                      m_primitive_index;
     Geom                        m_geom;
     TriangleSupportPlaneType    m_shape_support_plane;          // support plane of the shape in assembly space
     float                       m_area;                         // world space shape area
@@ -227,6 +227,9 @@ class EmittingShape
     float                       m_shape_prob;                   // probability density of this shape
     float                       m_average_flux;                 // estimated average radiant flux in W emitted by this shape
     float                       m_max_flux;                     // estimated maximum radiant flux in W emitted by this shape
+    foundation::uint32          m_object_instance_index;
+    foundation::uint32          m_light_tree_node_index;
+    foundation::uint32          m_primitive_index;
     const Material*             m_material;
     foundation::AABB3d          m_bbox;
     foundation::Vector3d        m_centroid;
@@ -140,7 +140,7 @@ class BSDFSampler
     const BSDF&                         m_bsdf;
     const void*                         m_bsdf_data;
     const int                           m_bsdf_sampling_modes;
-    const foundation::Basis3d&          m_shading_basis;
+    const SBasis3&                      m_shading_basis;
     const foundation::Vector3d&         m_geometric_normal;
     const ShadingPoint&                 m_shading_point;
 };
@@ -36,6 +36,7 @@
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/kernel/lighting/pathvertex.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/sdtree.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
@@ -46,6 +47,7 @@
 #include "renderer/modeling/input/source.h"
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 #include "renderer/modeling/volume/volume.h"
 
@@ -68,6 +70,27 @@
 namespace renderer
 {
 
+//
+// Optional features of the path tracer.
+//
+
+struct PathTracerFeatures
+{
+    enum Flags
+    {
+        None                    = 0,
+        Volumes                 = 1UL << 0,     // participating media
+        SubsurfaceScattering    = 1UL << 1,     // BSSRDFs
+        PathGuiding             = 1UL << 2,     // sampling from a spatial-directional tree
+        All                     = Volumes | SubsurfaceScattering | PathGuiding
+    };
+
+    // Return the features required to render a given scene, path guiding aside.
+    // Only valid between on_frame_begin() and on_frame_end() calls on the scene.
+    static int get_scene_features(const Scene& scene);
+};
+
+
 //
 // A generic path tracer.
 //
@@ -82,10 +105,13 @@ namespace renderer
 //           const ScatteringMode::Mode  next_mode) const;
 //
 //       void on_miss(const PathVertex& vertex);
-//       void on_hit(const PathVertex& vertex);
+//       void on_hit(PathVertex& vertex);
 //       void on_scatter(PathVertex& vertex);
 //   };
 //
+// on_hit() may terminate the path by disabling all scattering modes of the vertex, for
+// instance after substituting a cached estimate for the radiance leaving the vertex.
+//
 // The VolumeVisitor class must conform to the following prototype:
 //
 //   struct VolumeVisitor
@@ -97,8 +123,23 @@ namespace renderer
 //       void visit_ray(PathVertex& vertex, const ShadingRay& volume_ray);
 //   };
 //
+// When a spatial-directional tree is provided and ready, diffuse and glossy bounces
+// are sampled from a mixture of the BSDF and of the learned incident radiance
+// distribution (one-sample MIS). The probability density of the whole mixture is
+// then stored in PathVertex::m_prev_sampling_prob while PathVertex::m_prev_prob
+// keeps the BSDF's own density, which is what light-emitting vertices use for MIS.
+//
+// The Features template parameter is a combination of PathTracerFeatures flags.
+// Support for the features that are not enabled is compiled out of the path
+// tracing loop. Such a path tracer must only be used on scenes that don't need
+// those features (see PathTracerFeatures::get_scene_features()).
+//
 
-template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
+template <
+    typename PathVisitor,
+    typename VolumeVisitor,
+    bool Adjoint,
+    int Features = PathTracerFeatures::All>
 class PathTracer
   : public foundation::NonCopyable
 {
@@ -114,7 +155,8 @@ class PathTracer
         const size_t            max_volume_bounces,
         const bool              clamp_roughness,
         const size_t            max_iterations = 1000,
-        const double            near_start = 0.0);          // abort tracing if the first ray is shorter than this
+        const double            near_start = 0.0,           // abort tracing if the first ray is shorter than this
+        const SDTree*           sd_tree = nullptr);         // optional path guiding distributions
 
     size_t trace(
         SamplingContext&        sampling_context,
@@ -129,9 +171,11 @@ class PathTracer
         const ShadingPoint&     shading_point,
         const bool              clear_arena = true);
 
-    const ShadingPoint& get_path_vertex(const size_t i) const;
-
   private:
+    static const bool HasVolumes = (Features & PathTracerFeatures::Volumes) != 0;
+    static const bool HasSubsurfaceScattering = (Features & PathTracerFeatures::SubsurfaceScattering) != 0;
+    static const bool HasPathGuiding = (Features & PathTracerFeatures::PathGuiding) != 0;
+
     PathVisitor&                m_path_visitor;
     VolumeVisitor&              m_volume_visitor;
     const size_t                m_rr_min_path_length;
@@ -143,6 +187,7 @@ class PathTracer
     const bool                  m_clamp_roughness;
     const size_t                m_max_iterations;
     const double                m_near_start;
+    const SDTree*               m_sd_tree;
     size_t                      m_diffuse_bounces;
     size_t                      m_glossy_bounces;
     size_t                      m_specular_bounces;
@@ -160,6 +205,14 @@ class PathTracer
         SamplingContext&        sampling_context,
         PathVertex&             vertex);
 
+    // Sample either the BSDF or the path guiding distribution in a given path vertex.
+    // Return the probability density of the whole mixture.
+    float sample_guided(
+        SamplingContext&        sampling_context,
+        const PathVertex&       vertex,
+        const DTree&            d_tree,
+        BSDFSample&             sample) const;
+
     // Apply path visitor and sample BSDF in a given path vertex.
     // If all checks are passed, build a bounced ray that continues in the sampled direction
     // and return true, otherwise return false.
@@ -180,12 +233,30 @@ class PathTracer
 };
 
 
+//
+// PathTracerFeatures class implementation.
+//
+
+inline int PathTracerFeatures::get_scene_features(const Scene& scene)
+{
+    int features = None;
+
+    if (scene.has_volumes())
+        features |= Volumes;
+
+    if (scene.has_subsurface_scattering())
+        features |= SubsurfaceScattering;
+
+    return features;
+}
+
+
 //
 // PathTracer class implementation.
 //
 
-template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-inline PathTracer<PathVisitor, VolumeVisitor, Adjoint>::PathTracer(
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint, int Features>
+inline PathTracer<PathVisitor, VolumeVisitor, Adjoint, Features>::PathTracer(
     PathVisitor&                path_visitor,
     VolumeVisitor&              volume_visitor,
     const size_t                rr_min_path_length,
@@ -196,7 +267,8 @@ inline PathTracer<PathVisitor, VolumeVisitor, Adjoint>::PathTracer(
     const size_t                max_volume_bounces,
     const bool                  clamp_roughness,
     const size_t                max_iterations,
-    const double                near_start)
+    const double                near_start,
+    const SDTree*               sd_tree)
   : m_path_visitor(path_visitor)
   , m_volume_visitor(volume_visitor)
   , m_rr_min_path_length(rr_min_path_length)
@@ -208,11 +280,13 @@ inline PathTracer<PathVisitor, VolumeVisitor, Adjoint>::PathTracer(
   , m_clamp_roughness(clamp_roughness)
   , m_max_iterations(max_iterations)
   , m_near_start(near_start)
+  , m_sd_tree(sd_tree)
 {
+    assert(HasPathGuiding || m_sd_tree == nullptr);
 }
 
-template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-inline size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint, int Features>
+inline size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint, Features>::trace(
     SamplingContext&            sampling_context,
     const ShadingContext&       shading_context,
     const ShadingRay&           ray,
@@ -230,8 +304,8 @@ inline size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
             clear_arena);
 }
 
-template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint, int Features>
+size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint, Features>::trace(
     SamplingContext&            sampling_context,
     const ShadingContext&       shading_context,
     const ShadingPoint&         shading_point,
@@ -248,6 +322,7 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
     vertex.m_shading_point = &shading_point;
     vertex.m_prev_mode = ScatteringMode::Specular;
     vertex.m_prev_prob = BSDF::DiracDelta;
+    vertex.m_prev_sampling_prob = BSDF::DiracDelta;
     vertex.m_aov_mode = ScatteringMode::None;
 
     // This variable tracks the beginning of the path segment inside the current medium.
@@ -261,10 +336,14 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
     m_volume_bounces = 0;
     m_iterations = 0;
 
+    // Memory allocated from the shading arena while processing a path vertex
+    // is released before processing the next one.
+    const foundation::Arena::Marker arena_marker = shading_context.get_arena().get_marker();
+
     while (true)
     {
         if (clear_arena)
-            shading_context.get_arena().clear();
+            shading_context.get_arena().rewind(arena_marker);
 
         ShadingPoint* next_shading_point = m_shading_point_arena.allocate<ShadingPoint>();
 
@@ -443,11 +522,11 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
         vertex.m_edf =
             vertex.m_shading_point->is_curve_primitive() ? nullptr : material_data.m_edf;
         vertex.m_bsdf = material_data.m_bsdf;
-        vertex.m_bssrdf = material_data.m_bssrdf;
+        vertex.m_bssrdf = HasSubsurfaceScattering ? material_data.m_bssrdf : nullptr;
 
         // We allow materials with both a BSDF and a BSSRDF.
         // When both are present, pick one to extend the path.
-        if (vertex.m_bsdf && vertex.m_bssrdf)
+        if (HasSubsurfaceScattering && vertex.m_bsdf && vertex.m_bssrdf)
         {
             sampling_context.split_in_place(1, 1);
             if (sampling_context.next2<float>() < 0.5f)
@@ -464,7 +543,7 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
         }
 
         // Evaluate the inputs of the BSSRDF.
-        if (vertex.m_bssrdf)
+        if (HasSubsurfaceScattering && vertex.m_bssrdf)
         {
             vertex.m_bssrdf_data =
                 vertex.m_bssrdf->evaluate_inputs(shading_context, *vertex.m_shading_point);
@@ -475,7 +554,7 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
         // scattering, we purposely compute it at the outgoing vertex even though it may be used at
         // the incoming vertex if we need to change the probability of reaching this vertex by BSDF
         // sampling from projected solid angle measure to area measure.
-        vertex.m_cos_on = foundation::dot(vertex.m_outgoing.get_value(), vertex.get_shading_normal());
+        vertex.m_cos_on = foundation::dot(vertex.m_outgoing.get_value(), foundation::Vector3d(vertex.get_shading_normal()));
         m_path_visitor.on_hit(vertex);
 
         // Use Russian Roulette to cut the path without introducing bias.
@@ -508,7 +587,7 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
         // Subsurface scattering.
         BSSRDFSample bssrdf_sample;
         bssrdf_sample.m_modes = vertex.m_scattering_modes;
-        if (vertex.m_bssrdf)
+        if (HasSubsurfaceScattering && vertex.m_bssrdf)
         {
             // Sample the BSSRDF and terminate the path if no incoming point is found.
             if (!vertex.m_bssrdf->sample(
@@ -532,7 +611,7 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
         }
 
         // Terminate the path if no above-surface scattering possible.
-        if (vertex.m_bsdf == nullptr && material->get_render_data().m_volume == nullptr)
+        if (vertex.m_bsdf == nullptr && (!HasVolumes || material->get_render_data().m_volume == nullptr))
             break;
 
         // In case there is no BSDF, the current ray will be continued without increasing its depth.
@@ -556,7 +635,7 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
 
         // Build the medium list of the scattered ray.
         const foundation::Vector3d& geometric_normal = vertex.get_geometric_normal();
-        const bool crossing_interface = vertex.m_bssrdf == nullptr &&
+        const bool crossing_interface = (!HasSubsurfaceScattering || vertex.m_bssrdf == nullptr) &&
             foundation::dot(vertex.m_outgoing.get_value(), geometric_normal) *
             foundation::dot(next_ray.m_dir, geometric_normal) < 0.0;
         if (crossing_interface)
@@ -608,7 +687,8 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
         medium_start = vertex.get_point();
 
         const ShadingRay::Medium* current_medium = next_ray.get_current_medium();
-        if (current_medium != nullptr &&
+        if (HasVolumes &&
+            current_medium != nullptr &&
             current_medium->get_volume() != nullptr)
         {
             // This ray is being cast into a participating medium.
@@ -637,8 +717,8 @@ size_t PathTracer<PathVisitor, VolumeVisitor, Adjoint>::trace(
     return vertex.m_path_length;
 }
 
-template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-inline bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::pass_through(
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint, int Features>
+inline bool PathTracer<PathVisitor, VolumeVisitor, Adjoint, Features>::pass_through(
     SamplingContext&            sampling_context,
     const Alpha                 alpha)
 {
@@ -657,8 +737,8 @@ inline bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::pass_through(
     return s >= alpha[0];
 }
 
-template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-inline bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::continue_path_rr(
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint, int Features>
+inline bool PathTracer<PathVisitor, VolumeVisitor, Adjoint, Features>::continue_path_rr(
     SamplingContext&            sampling_context,
     PathVertex&                 vertex)
 {
@@ -685,8 +765,99 @@ inline bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::continue_path_rr(
     return true;
 }
 
-template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint, int Features>
+float PathTracer<PathVisitor, VolumeVisitor, Adjoint, Features>::sample_guided(
+    SamplingContext&            sampling_context,
+    const PathVertex&           vertex,
+    const DTree&                d_tree,
+    BSDFSample&                 sample) const
+{
+    const float bsdf_fraction = m_sd_tree->get_bsdf_sampling_fraction();
+    const int guided_modes =
+        vertex.m_bsdf->get_modes() &
+        vertex.m_scattering_modes &
+        (ScatteringMode::Diffuse | ScatteringMode::Glossy);
+
+    // Choose a sampling technique.
+    sampling_context.split_in_place(1, 1);
+    const float s = sampling_context.next2<float>();
+
+    if (s < bsdf_fraction)
+    {
+        vertex.m_bsdf->sample(
+            sampling_context,
+            vertex.m_bsdf_data,
+            Adjoint,
+            true,       // multiply by |cos(incoming, normal)|
+            vertex.m_scattering_modes,
+            sample);
+
+        if (sample.get_mode() == ScatteringMode::None)
+            return 0.0f;
+
+        // Specular directions can only be generated by sampling the BSDF.
+        if (sample.get_probability() == BSDF::DiracDelta)
+        {
+            sample.m_value /= bsdf_fraction;
+            return BSDF::DiracDelta;
+        }
+    }
+    else
+    {
+        sampling_context.split_in_place(2, 1);
+        float guided_prob;
+        const foundation::Vector3f incoming =
+            d_tree.sample(sampling_context.next2<foundation::Vector2f>(), guided_prob);
+
+        const float bsdf_prob =
+            vertex.m_bsdf->evaluate(
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,       // multiply by |cos(incoming, normal)|
+                sample.m_geometric_normal,
+                sample.m_shading_basis,
+                sample.m_outgoing.get_value(),
+                incoming,
+                guided_modes,
+                sample.m_value);
+
+        if (bsdf_prob == 0.0f)
+        {
+            sample.set_to_absorption();
+            return 0.0f;
+        }
+
+        // The BSDF does not tell which of its components contributes the most.
+        sample.set_to_scattering(
+            (guided_modes & ScatteringMode::Diffuse) != 0
+                ? ScatteringMode::Diffuse
+                : ScatteringMode::Glossy,
+            bsdf_prob);
+        sample.m_incoming = foundation::Dual3f(incoming);
+
+        // Only BSDF sampling provides the albedo needed at the first diffuse bounce.
+        if (!vertex.m_albedo_saved)
+        {
+            BSDFSample bsdf_sample(vertex.m_shading_point, sample.m_outgoing);
+            vertex.m_bsdf->sample(
+                sampling_context,
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,       // multiply by |cos(incoming, normal)|
+                vertex.m_scattering_modes,
+                bsdf_sample);
+            sample.m_aov_components = bsdf_sample.m_aov_components;
+        }
+    }
+
+    // One-sample MIS: the direction could have been generated by either technique.
+    return
+        bsdf_fraction * sample.get_probability() +
+        (1.0f - bsdf_fraction) * d_tree.evaluate_pdf(sample.m_incoming.get_value());
+}
+
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint, int Features>
+bool PathTracer<PathVisitor, VolumeVisitor, Adjoint, Features>::process_bounce(
     SamplingContext&            sampling_context,
     PathVertex&                 vertex,
     BSDFSample&                 sample,
@@ -699,16 +870,37 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
     if (vertex.m_scattering_modes == ScatteringMode::None)
         return false;
 
+    float sampling_prob;
+
     // Above-surface scattering.
-    if (vertex.m_bssrdf == nullptr)
+    if (!HasSubsurfaceScattering || vertex.m_bssrdf == nullptr)
     {
-        vertex.m_bsdf->sample(
-            sampling_context,
-            vertex.m_bsdf_data,
-            Adjoint,
-            true,       // multiply by |cos(incoming, normal)|
-            vertex.m_scattering_modes,
-            sample);
+        const int guided_modes =
+            vertex.m_bsdf->get_modes() &
+            vertex.m_scattering_modes &
+            (ScatteringMode::Diffuse | ScatteringMode::Glossy);
+
+        if (HasPathGuiding && m_sd_tree != nullptr && m_sd_tree->is_ready() && guided_modes != 0)
+        {
+            sampling_prob =
+                sample_guided(
+                    sampling_context,
+                    vertex,
+                    m_sd_tree->get_d_tree(vertex.get_point()),
+                    sample);
+        }
+        else
+        {
+            vertex.m_bsdf->sample(
+                sampling_context,
+                vertex.m_bsdf_data,
+                Adjoint,
+                true,       // multiply by |cos(incoming, normal)|
+                vertex.m_scattering_modes,
+                sample);
+
+            sampling_prob = sample.get_probability();
+        }
 
         next_ray.m_min_roughness = m_clamp_roughness ? sample.m_min_roughness : 0.0f;
 
@@ -725,6 +917,8 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
         // However, we need to check if the corresponding mode is still enabled.
         if ((sample.get_mode() & vertex.m_scattering_modes) == 0)
             sample.set_to_absorption();
+
+        sampling_prob = sample.get_probability();
     }
 
     // Terminate the path if it gets absorbed.
@@ -738,14 +932,15 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
     // Save the scattering properties for MIS at light-emitting vertices.
     vertex.m_prev_mode = sample.get_mode();
     vertex.m_prev_prob = sample.get_probability();
+    vertex.m_prev_sampling_prob = sampling_prob;
 
     // Update the AOV scattering mode only for the first bounce.
     if (vertex.m_path_length == 1)
         vertex.m_aov_mode = sample.get_mode();
 
     // Update path throughput.
-    if (sample.get_probability() != BSDF::DiracDelta)
-        sample.m_value /= sample.get_probability();
+    if (sampling_prob != BSDF::DiracDelta)
+        sample.m_value /= sampling_prob;
     vertex.m_throughput *= sample.m_value.m_beauty;
 
     // Update bounce counters.
@@ -776,8 +971,8 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::process_bounce(
     return true;
 }
 
-template <typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
+template <typename PathVisitor, typename VolumeVisitor, bool Adjoint, int Features>
+bool PathTracer<PathVisitor, VolumeVisitor, Adjoint, Features>::march(
     SamplingContext&            sampling_context,
     const ShadingContext&       shading_context,
     const ShadingRay&           ray,
@@ -800,9 +995,11 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
         exit_point,
         vertex.m_shading_point);
 
+    const foundation::Arena::Marker arena_marker = shading_context.get_arena().get_marker();
+
     while (true)
     {
-        shading_context.get_arena().clear();
+        shading_context.get_arena().rewind(arena_marker);
 
         // Put a hard limit on the number of iterations.
         if (m_iterations++ == m_max_iterations)
@@ -962,6 +1159,7 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
         // Save the scattering properties for MIS at light-emitting vertices.
         vertex.m_prev_mode = ScatteringMode::Volume;
         vertex.m_prev_prob = pdf;
+        vertex.m_prev_sampling_prob = pdf;
 
         // Update the AOV scattering mode only for the first bounce.
         if (vertex.m_path_length == 1)
@@ -990,10 +1188,4 @@ bool PathTracer<PathVisitor, VolumeVisitor, Adjoint>::march(
     return true;
 }
 
-template<typename PathVisitor, typename VolumeVisitor, bool Adjoint>
-inline const ShadingPoint& PathTracer<PathVisitor, VolumeVisitor, Adjoint>::get_path_vertex(const size_t i) const
-{
-    return reinterpret_cast<const ShadingPoint*>(m_shading_point_arena.get_storage())[i];
-}
-
 }   // namespace renderer
@@ -87,6 +87,7 @@ class PathVertex
     // Properties of the scattering event leading to this vertex.
     ScatteringMode::Mode        m_prev_mode;
     float                       m_prev_prob;
+    float                       m_prev_sampling_prob;   // differs from m_prev_prob when path guiding is used
 
     // AOV properties.
     ScatteringMode::Mode        m_aov_mode;
@@ -102,8 +103,8 @@ class PathVertex
     const foundation::Vector2f& get_uv(const size_t uvset) const;
     const foundation::Vector3d& get_point() const;
     const foundation::Vector3d& get_geometric_normal() const;
-    const foundation::Vector3d& get_shading_normal() const;
-    const foundation::Basis3d& get_shading_basis() const;
+    const SVector3& get_shading_normal() const;
+    const SBasis3& get_shading_basis() const;
     const Material* get_material() const;
 
     // Compute the radiance emitted at this vertex. Only call when there is an EDF (when m_edf is set).
@@ -154,12 +155,12 @@ inline const foundation::Vector3d& PathVertex::get_geometric_normal() const
     return m_shading_point->get_geometric_normal();
 }
 
-inline const foundation::Vector3d& PathVertex::get_shading_normal() const
+inline const SVector3& PathVertex::get_shading_normal() const
 {
     return m_shading_point->get_shading_normal();
 }
 
-inline const foundation::Basis3d& PathVertex::get_shading_basis() const
+inline const SBasis3& PathVertex::get_shading_basis() const
 {
     return m_shading_point->get_shading_basis();
 }
@@ -34,18 +34,25 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/aov/aovcomponents.h"
+#include "renderer/kernel/lighting/causticphotonmap.h"
 #include "renderer/kernel/lighting/directlightingintegrator.h"
+#include "renderer/kernel/lighting/environmentsamplingcache.h"
 #include "renderer/kernel/lighting/imagebasedlighting.h"
+#include "renderer/kernel/lighting/irradiancepointcloud.h"
 #include "renderer/kernel/lighting/lightpathrecorder.h"
 #include "renderer/kernel/lighting/lightpathstream.h"
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
+#include "renderer/kernel/lighting/pt/ptpasscallback.h"
+#include "renderer/kernel/lighting/radiancecache.h"
 #include "renderer/kernel/lighting/scatteringmode.h"
+#include "renderer/kernel/lighting/sdtree.h"
 #include "renderer/kernel/lighting/volumelightingintegrator.h"
 #include "renderer/kernel/shading/shadingcomponents.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/bssrdf/bssrdf.h"
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/environment/environment.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
@@ -54,8 +61,12 @@
 #include "renderer/utility/stochasticcast.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/fp.h"
+#include "foundation/math/knn.h"
 #include "foundation/math/mis.h"
 #include "foundation/math/population.h"
+#include "foundation/math/rr.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/containers/dictionary.h"
@@ -67,6 +78,7 @@
 #include <cassert>
 #include <cstddef>
 #include <limits>
+#include <memory>
 #include <string>
 
 // Forward declarations.
@@ -82,6 +94,15 @@ namespace renderer
 
 namespace
 {
+    // Adjoint-driven Russian Roulette keeps the paths expected to bring back at least this
+    // fraction of the radiance expected from their first vertex. This is the lower bound of
+    // a weight window of size 5 centered on the expected radiance.
+    const float AdjointRRWindowLowerBound = 1.0f / 3.0f;
+
+    // Lower bound on the probability of continuing a path with adjoint-driven Russian
+    // Roulette, to limit the variance caused by poor radiance estimates.
+    const float AdjointRRMinSurvivalProb = 0.05f;
+
     //
     // Path Tracing lighting engine.
     //
@@ -99,9 +120,11 @@ namespace
         PTLightingEngine(
             const BackwardLightSampler&     light_sampler,
             LightPathRecorder&              light_path_recorder,
+            PTPassCallback*                 pass_callback,
             const ParamArray&               params)
-          : m_params(params)
+          : m_params(params, pass_callback && pass_callback->get_caustic_photon_map())
           , m_light_sampler(light_sampler)
+          , m_sd_tree(pass_callback ? pass_callback->get_sd_tree() : nullptr)
           , m_light_path_stream(
               m_params.m_record_light_paths
                   ? light_path_recorder.create_stream()
@@ -109,6 +132,25 @@ namespace
           , m_path_count(0)
           , m_inf_volume_ray_warnings(0)
         {
+            RadianceCache* radiance_cache =
+                pass_callback ? pass_callback->get_radiance_cache() : nullptr;
+
+            if (radiance_cache)
+                m_radiance_cache_context.reset(new RadianceCacheContext(*radiance_cache));
+            else if (m_params.m_adjoint_rr)
+                RENDERER_LOG_WARNING("adjoint-driven russian roulette requires the radiance cache, using throughput-based russian roulette instead.");
+
+            IrradiancePointCloud* irradiance_cloud =
+                pass_callback ? pass_callback->get_sss_irradiance_cloud() : nullptr;
+
+            if (irradiance_cloud)
+                m_irradiance_cloud_context.reset(new IrradianceCloudContext(*irradiance_cloud));
+
+            const CausticPhotonMap* caustic_photon_map =
+                pass_callback ? pass_callback->get_caustic_photon_map() : nullptr;
+
+            if (caustic_photon_map)
+                m_caustic_photon_map_context.reset(new CausticPhotonMapContext(*caustic_photon_map));
         }
 
         void release() override
@@ -129,31 +171,49 @@ namespace
                 "  max specular bounces          %s\n"
                 "  max volume bounces            %s\n"
                 "  russian roulette start bounce %s\n"
+                "  adjoint russian roulette      %s\n"
                 "  next event estimation         %s\n"
                 "  dl light samples              %s\n"
+                "  dl light candidates           %s\n"
+                "  dl adaptive light samples     %s\n"
                 "  dl light threshold            %s\n"
                 "  ibl env samples               %s\n"
+                "  ibl env sampling cache        %s\n"
                 "  max ray intensity             %s\n"
                 "  volume distance samples       %s\n"
                 "  equiangular sampling          %s\n"
-                "  clamp roughness               %s",
+                "  clamp roughness               %s\n"
+                "  path guiding                  %s\n"
+                "  radiance cache                %s\n"
+                "  sss irradiance cloud          %s",
                 m_params.m_enable_dl ? "on" : "off",
                 m_params.m_enable_ibl ? "on" : "off",
-                m_params.m_enable_caustics ? "on" : "off",
+                m_caustic_photon_map_context ? "photon map" : m_params.m_enable_caustics ? "on" : "off",
                 m_params.m_max_bounces == ~size_t(0) ? "unlimited" : pretty_uint(m_params.m_max_bounces).c_str(),
                 m_params.m_max_diffuse_bounces == ~size_t(0) ? "unlimited" : pretty_uint(m_params.m_max_diffuse_bounces).c_str(),
                 m_params.m_max_glossy_bounces == ~size_t(0) ? "unlimited" : pretty_uint(m_params.m_max_glossy_bounces).c_str(),
                 m_params.m_max_specular_bounces == ~size_t(0) ? "unlimited" : pretty_uint(m_params.m_max_specular_bounces).c_str(),
                 m_params.m_max_volume_bounces == ~size_t(0) ? "unlimited" : pretty_uint(m_params.m_max_volume_bounces).c_str(),
                 m_params.m_rr_min_path_length == ~size_t(0) ? "unlimited" : pretty_uint(m_params.m_rr_min_path_length).c_str(),
+                use_adjoint_rr() ? "on" : "off",
                 m_params.m_next_event_estimation ? "on" : "off",
                 pretty_scalar(m_params.m_dl_light_sample_count).c_str(),
+                m_params.m_dl_light_candidate_count > 1 ? pretty_uint(m_params.m_dl_light_candidate_count).c_str() : "off",
+                m_params.m_dl_max_light_sample_count > 0
+                    ? ("up to " + pretty_uint(m_params.m_dl_max_light_sample_count) + ", error threshold " + pretty_scalar(m_params.m_dl_light_sample_error_threshold, 3)).c_str()
+                    : "off",
                 pretty_scalar(m_params.m_dl_low_light_threshold, 3).c_str(),
                 pretty_scalar(m_params.m_ibl_env_sample_count).c_str(),
+                m_params.m_enable_ibl_env_cache ? "on" : "off",
                 m_params.m_has_max_ray_intensity ? pretty_scalar(m_params.m_max_ray_intensity).c_str() : "unlimited",
                 pretty_int(m_params.m_distance_sample_count).c_str(),
                 m_params.m_enable_equiangular_sampling ? "on" : "off",
-                m_params.m_clamp_roughness ? "on" : "off");
+                m_params.m_clamp_roughness ? "on" : "off",
+                m_sd_tree ? "on" : "off",
+                m_radiance_cache_context
+                    ? ("on, after " + pretty_uint(m_params.m_radiance_cache_min_diffuse_bounces) + " diffuse bounce(s)").c_str()
+                    : "off",
+                m_irradiance_cloud_context ? "on" : "off");
         }
 
         void compute_lighting(
@@ -174,7 +234,7 @@ namespace
 
             if (m_params.m_next_event_estimation)
             {
-                do_compute_lighting<PathVisitorNextEventEstimation, VolumeVisitorDistanceSampling>(
+                dispatch_compute_lighting<PathVisitorNextEventEstimation, VolumeVisitorDistanceSampling>(
                     sampling_context,
                     shading_context,
                     shading_point,
@@ -183,7 +243,7 @@ namespace
             }
             else
             {
-                do_compute_lighting<PathVisitorSimple, VolumeVisitorSimple>(
+                dispatch_compute_lighting<PathVisitorSimple, VolumeVisitorSimple>(
                     sampling_context,
                     shading_context,
                     shading_point,
@@ -196,6 +256,40 @@ namespace
         }
 
         template <typename PathVisitor, typename VolumeVisitor>
+        void dispatch_compute_lighting(
+            SamplingContext&        sampling_context,
+            const ShadingContext&   shading_context,
+            const ShadingPoint&     shading_point,
+            ShadingComponents&      radiance,               // output radiance, in W.sr^-1.m^-2
+            AOVComponents&          aov_components)
+        {
+            // Use a path tracer stripped of volumes, subsurface scattering and path guiding
+            // for scenes that only need surface scattering, the general one otherwise.
+            const bool surfaces_only =
+                m_sd_tree == nullptr &&
+                PathTracerFeatures::get_scene_features(shading_point.get_scene()) == PathTracerFeatures::None;
+
+            if (surfaces_only)
+            {
+                do_compute_lighting<PathVisitor, VolumeVisitor, PathTracerFeatures::None>(
+                    sampling_context,
+                    shading_context,
+                    shading_point,
+                    radiance,
+                    aov_components);
+            }
+            else
+            {
+                do_compute_lighting<PathVisitor, VolumeVisitor, PathTracerFeatures::All>(
+                    sampling_context,
+                    shading_context,
+                    shading_point,
+                    radiance,
+                    aov_components);
+            }
+        }
+
+        template <typename PathVisitor, typename VolumeVisitor, int PathTracerFeatureFlags>
         void do_compute_lighting(
             SamplingContext&        sampling_context,
             const ShadingContext&   shading_context,
@@ -203,6 +297,18 @@ namespace
             ShadingComponents&      radiance,               // output radiance, in W.sr^-1.m^-2
             AOVComponents&          aov_components)
         {
+            // (Re)create the environment sampling cache if the environment EDF has changed.
+            if (m_params.m_enable_ibl && m_params.m_enable_ibl_env_cache)
+            {
+                const EnvironmentEDF* env_edf =
+                    shading_point.get_scene().get_environment()->get_environment_edf();
+
+                if (env_edf == nullptr)
+                    m_env_sampling_cache.reset();
+                else if (!m_env_sampling_cache || &m_env_sampling_cache->get_environment_edf() != env_edf)
+                    m_env_sampling_cache.reset(new EnvironmentSamplingCache(*env_edf));
+            }
+
             PathVisitor path_visitor(
                 m_params,
                 m_light_sampler,
@@ -211,7 +317,12 @@ namespace
                 shading_point.get_scene(),
                 radiance,
                 aov_components,
-                m_light_path_stream);
+                m_light_path_stream,
+                m_sd_tree != nullptr && m_sd_tree->is_training() ? m_sd_tree : nullptr,
+                m_radiance_cache_context.get(),
+                m_irradiance_cloud_context.get(),
+                m_caustic_photon_map_context.get(),
+                m_env_sampling_cache.get());
 
             VolumeVisitor volume_visitor(
                 m_params,
@@ -222,17 +333,20 @@ namespace
                 radiance,
                 m_inf_volume_ray_warnings);
 
-            PathTracer<PathVisitor, VolumeVisitor, false> path_tracer(     // false = not adjoint
+            PathTracer<PathVisitor, VolumeVisitor, false, PathTracerFeatureFlags> path_tracer(     // false = not adjoint
                 path_visitor,
                 volume_visitor,
-                m_params.m_rr_min_path_length,
+                use_adjoint_rr() ? ~size_t(0) : m_params.m_rr_min_path_length,     // the path visitor plays russian roulette
+
                 m_params.m_max_bounces == ~size_t(0) ? ~size_t(0) : m_params.m_max_bounces + 1,
                 m_params.m_max_diffuse_bounces == ~size_t(0) ? ~size_t(0) : m_params.m_max_diffuse_bounces + 1,
                 m_params.m_max_glossy_bounces,
                 m_params.m_max_specular_bounces,
                 m_params.m_max_volume_bounces,
                 m_params.m_clamp_roughness,
-                shading_context.get_max_iterations());
+                shading_context.get_max_iterations(),
+                0.0,
+                m_sd_tree);
 
             const size_t path_length =
                 path_tracer.trace(
@@ -240,6 +354,15 @@ namespace
                     shading_context,
                     shading_point);
 
+            // Train path guiding.
+            path_visitor.record_guiding_samples();
+
+            // Grow the radiance cache.
+            path_visitor.record_radiance_cache_samples();
+
+            // Grow the irradiance point cloud.
+            path_visitor.record_irradiance_cloud_samples();
+
             // Update statistics.
             ++m_path_count;
             m_path_length.insert(path_length);
@@ -251,6 +374,25 @@ namespace
             stats.insert("path count", m_path_count);
             stats.insert("path length", m_path_length);
 
+            if (m_radiance_cache_context)
+            {
+                stats.insert_percent(
+                    "cached paths",
+                    m_radiance_cache_context->m_hit_count,
+                    m_path_count);
+            }
+
+            if (m_irradiance_cloud_context)
+            {
+                stats.insert_percent(
+                    "sss cached paths",
+                    m_irradiance_cloud_context->m_hit_count,
+                    m_path_count);
+            }
+
+            if (m_caustic_photon_map_context)
+                stats.insert("caustic photon lookups", m_caustic_photon_map_context->m_hit_count);
+
             return StatisticsVector::make("path tracing statistics", stats);
         }
 
@@ -270,11 +412,16 @@ namespace
             const bool      m_clamp_roughness;
 
             const size_t    m_rr_min_path_length;           // minimum path length before Russian Roulette kicks in, ~0 for unlimited
+            const bool      m_adjoint_rr;                   // drive Russian Roulette by the radiance cache?
             const bool      m_next_event_estimation;        // use next event estimation?
 
             const float     m_dl_light_sample_count;        // number of light samples used to estimate direct illumination
+            const size_t    m_dl_light_candidate_count;     // number of candidates each light sample is resampled from
+            const size_t    m_dl_max_light_sample_count;    // maximum number of light samples in adaptive direct lighting, 0 to disable
+            const float     m_dl_light_sample_error_threshold;  // relative standard error target of adaptive direct lighting
             const float     m_dl_low_light_threshold;       // light contribution threshold to disable shadow rays
             const float     m_ibl_env_sample_count;         // number of environment samples used to estimate IBL
+            const bool      m_enable_ibl_env_cache;         // sample the environment with a hemisphere-aware cache?
             float           m_rcp_dl_light_sample_count;
             float           m_rcp_ibl_env_sample_count;
 
@@ -286,10 +433,13 @@ namespace
 
             const bool      m_record_light_paths;
 
-            explicit Parameters(const ParamArray& params)
+            const size_t    m_radiance_cache_min_diffuse_bounces;   // number of diffuse bounces before the radiance cache is used
+
+            // Caustics are estimated from the caustic photon map instead of traced when it exists.
+            Parameters(const ParamArray& params, const bool has_caustic_photon_map)
               : m_enable_dl(params.get_optional<bool>("enable_dl", true))
               , m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
-              , m_enable_caustics(params.get_optional<bool>("enable_caustics", false))
+              , m_enable_caustics(!has_caustic_photon_map && params.get_optional<bool>("enable_caustics", false))
               , m_max_bounces(fixup_bounces(params.get_optional<int>("max_bounces", 8)))
               , m_max_diffuse_bounces(fixup_bounces(params.get_optional<int>("max_diffuse_bounces", 3)))
               , m_max_glossy_bounces(fixup_bounces(params.get_optional<int>("max_glossy_bounces", 8)))
@@ -297,15 +447,21 @@ namespace
               , m_max_volume_bounces(fixup_bounces(params.get_optional<int>("max_volume_bounces", 8)))
               , m_clamp_roughness(params.get_optional<bool>("clamp_roughness", false))
               , m_rr_min_path_length(fixup_path_length(params.get_optional<size_t>("rr_min_path_length", 6)))
+              , m_adjoint_rr(params.get_optional<bool>("adjoint_rr", false))
               , m_next_event_estimation(params.get_optional<bool>("next_event_estimation", true))
               , m_dl_light_sample_count(params.get_optional<float>("dl_light_samples", 1.0f))
+              , m_dl_light_candidate_count(params.get_optional<size_t>("dl_light_candidates", 1))
+              , m_dl_max_light_sample_count(params.get_optional<size_t>("dl_adaptive_max_light_samples", 0))
+              , m_dl_light_sample_error_threshold(params.get_optional<float>("dl_adaptive_error_threshold", 0.1f))
               , m_dl_low_light_threshold(params.get_optional<float>("dl_low_light_threshold", 0.0f))
               , m_ibl_env_sample_count(params.get_optional<float>("ibl_env_samples", 1.0f))
+              , m_enable_ibl_env_cache(params.get_optional<bool>("enable_ibl_env_cache", false))
               , m_has_max_ray_intensity(params.strings().exist("max_ray_intensity"))
               , m_max_ray_intensity(params.get_optional<float>("max_ray_intensity", 0.0f))
               , m_distance_sample_count(params.get_optional<size_t>("volume_distance_samples", 2))
               , m_enable_equiangular_sampling(!params.get_optional<bool>("optimize_for_lights_outside_volumes", false))
               , m_record_light_paths(params.get_optional<bool>("record_light_paths", false))
+              , m_radiance_cache_min_diffuse_bounces(params.get_optional<size_t>("radiance_cache_min_diffuse_bounces", 1))
             {
                 // Precompute the reciprocal of the number of light samples.
                 m_rcp_dl_light_sample_count =
@@ -331,8 +487,68 @@ namespace
             }
         };
 
+        // Per-thread state used to query and grow the radiance cache.
+        struct RadianceCacheContext
+        {
+            RadianceCache&              m_cache;
+            knn::Answer<float>          m_answer;
+            RadianceCache::RecordVector m_pending_records;      // inserted into the cache in batches
+            uint64                      m_hit_count;
+
+            static const size_t         MaxPendingRecordCount = 256;
+
+            explicit RadianceCacheContext(RadianceCache& cache)
+              : m_cache(cache)
+              , m_answer(RadianceCache::LookupRecordCount)
+              , m_hit_count(0)
+            {
+                m_pending_records.reserve(MaxPendingRecordCount);
+            }
+        };
+
+        // Per-thread state used to query and grow the irradiance point cloud of subsurface scattering.
+        struct IrradianceCloudContext
+        {
+            IrradiancePointCloud&               m_cloud;
+            IrradiancePointCloud::RecordVector  m_pending_records;      // inserted into the cloud in batches
+            uint64                              m_hit_count;
+
+            static const size_t                 MaxPendingRecordCount = 256;
+
+            explicit IrradianceCloudContext(IrradiancePointCloud& cloud)
+              : m_cloud(cloud)
+              , m_hit_count(0)
+            {
+                m_pending_records.reserve(MaxPendingRecordCount);
+            }
+        };
+
+        // Per-thread state used to query the caustic photon map.
+        struct CausticPhotonMapContext
+        {
+            const CausticPhotonMap&     m_map;
+            knn::Answer<float>          m_answer;
+            uint64                      m_hit_count;
+
+            explicit CausticPhotonMapContext(const CausticPhotonMap& map)
+              : m_map(map)
+              , m_answer(map.get_max_photons_per_estimate())
+              , m_hit_count(0)
+            {
+            }
+        };
+
         const Parameters                m_params;
         const BackwardLightSampler&     m_light_sampler;
+        SDTree*                         m_sd_tree;
+        unique_ptr<RadianceCacheContext>
+                                        m_radiance_cache_context;
+        unique_ptr<IrradianceCloudContext>
+                                        m_irradiance_cloud_context;
+        unique_ptr<CausticPhotonMapContext>
+                                        m_caustic_photon_map_context;
+        unique_ptr<EnvironmentSamplingCache>
+                                        m_env_sampling_cache;
         LightPathStream*                m_light_path_stream;
 
         uint64                          m_path_count;
@@ -341,6 +557,11 @@ namespace
         size_t                          m_inf_volume_ray_warnings;
         static const size_t             MaxInfVolumeRayWarnings = 5;
 
+        bool use_adjoint_rr() const
+        {
+            return m_params.m_adjoint_rr && m_radiance_cache_context;
+        }
+
         //
         // Base path visitor.
         //
@@ -375,7 +596,154 @@ namespace
                 return true;
             }
 
+            void record_guiding_samples()
+            {
+                const Spectrum& path_radiance = m_path_radiance.m_beauty;
+
+                for (size_t i = 0; i < m_guiding_vertex_count; ++i)
+                {
+                    const GuidingVertex& guiding_vertex = m_guiding_vertices[i];
+
+                    // Radiance arriving at the vertex along the sampled direction.
+                    float incident_radiance = 0.0f;
+                    for (size_t c = 0, e = Spectrum::size(); c < e; ++c)
+                    {
+                        if (guiding_vertex.m_throughput[c] > 0.0f)
+                        {
+                            incident_radiance +=
+                                (path_radiance[c] - guiding_vertex.m_path_radiance[c]) /
+                                guiding_vertex.m_throughput[c];
+                        }
+                    }
+                    incident_radiance /= Spectrum::size();
+
+                    if (incident_radiance > 0.0f && FP<float>::is_finite(incident_radiance))
+                    {
+                        m_sd_tree->record(
+                            guiding_vertex.m_point,
+                            guiding_vertex.m_direction,
+                            incident_radiance / guiding_vertex.m_sampling_prob);
+                    }
+                }
+            }
+
+            void record_radiance_cache_samples()
+            {
+                // Paths cut short by the radiance cache would bias the cache toward itself.
+                if (m_radiance_cache_context == nullptr || m_terminated_by_radiance_cache)
+                    return;
+
+                RadianceCache& cache = m_radiance_cache_context->m_cache;
+                if (!cache.is_recording())
+                    return;
+
+                const Spectrum& path_radiance = m_path_radiance.m_beauty;
+                RadianceCache::RecordVector& pending_records = m_radiance_cache_context->m_pending_records;
+
+                for (size_t i = 0; i < m_radiance_cache_vertex_count; ++i)
+                {
+                    const RadianceCacheVertex& cache_vertex = m_radiance_cache_vertices[i];
+
+                    // Radiance reflected at the vertex toward the previous vertex.
+                    RadianceCache::Record record;
+                    record.m_position = cache_vertex.m_position;
+                    record.m_normal = cache_vertex.m_normal;
+                    record.m_material = cache_vertex.m_material;
+                    record.m_radiance = path_radiance;
+                    record.m_radiance -= cache_vertex.m_path_radiance;
+                    for (size_t c = 0, e = Spectrum::size(); c < e; ++c)
+                    {
+                        if (cache_vertex.m_throughput[c] > 0.0f)
+                            record.m_radiance[c] /= cache_vertex.m_throughput[c];
+                        else
+                            record.m_radiance[c] = 0.0f;
+                    }
+
+                    if (is_finite(record.m_radiance))
+                        pending_records.push_back(record);
+                }
+
+                if (pending_records.size() >= RadianceCacheContext::MaxPendingRecordCount)
+                {
+                    cache.insert(pending_records);
+                    pending_records.clear();
+                }
+            }
+
+            void record_irradiance_cloud_samples()
+            {
+                if (m_irradiance_cloud_context == nullptr)
+                    return;
+
+                IrradiancePointCloud& cloud = m_irradiance_cloud_context->m_cloud;
+                if (!cloud.is_recording())
+                    return;
+
+                const Spectrum& path_radiance = m_path_radiance.m_beauty;
+                IrradiancePointCloud::RecordVector& pending_records = m_irradiance_cloud_context->m_pending_records;
+
+                for (size_t i = 0; i < m_irradiance_cloud_vertex_count; ++i)
+                {
+                    const IrradianceCloudVertex& cloud_vertex = m_irradiance_cloud_vertices[i];
+
+                    // The Lambertian BRDF of the incoming point scatters E / Pi toward the path.
+                    IrradiancePointCloud::Record record;
+                    record.m_position = cloud_vertex.m_position;
+                    record.m_bssrdf = cloud_vertex.m_bssrdf;
+                    record.m_object_instance = cloud_vertex.m_object_instance;
+                    record.m_irradiance = path_radiance;
+                    record.m_irradiance -= cloud_vertex.m_path_radiance;
+                    for (size_t c = 0, e = Spectrum::size(); c < e; ++c)
+                    {
+                        if (cloud_vertex.m_throughput[c] > 0.0f)
+                            record.m_irradiance[c] *= Pi<float>() / cloud_vertex.m_throughput[c];
+                        else
+                            record.m_irradiance[c] = 0.0f;
+                    }
+
+                    if (is_finite(record.m_irradiance))
+                        pending_records.push_back(record);
+                }
+
+                if (pending_records.size() >= IrradianceCloudContext::MaxPendingRecordCount)
+                {
+                    cloud.insert(pending_records);
+                    pending_records.clear();
+                }
+            }
+
           protected:
+            struct GuidingVertex
+            {
+                Vector3d                        m_point;
+                Vector3f                        m_direction;
+                float                           m_sampling_prob;
+                Spectrum                        m_throughput;
+                Spectrum                        m_path_radiance;
+            };
+
+            struct RadianceCacheVertex
+            {
+                Vector3f                        m_position;
+                Vector3f                        m_normal;
+                const Material*                 m_material;
+                Spectrum                        m_throughput;
+                Spectrum                        m_path_radiance;
+            };
+
+            struct IrradianceCloudVertex
+            {
+                Vector3f                        m_position;
+                const BSSRDF*                   m_bssrdf;
+                const ObjectInstance*           m_object_instance;
+                Spectrum                        m_throughput;
+                Spectrum                        m_path_radiance;
+            };
+
+            static const size_t MaxGuidingVertexCount = 16;
+            static const size_t MaxRadianceCacheVertexCount = 16;
+            static const size_t MaxIrradianceCloudVertexCount = 16;
+
             const Parameters&                   m_params;
             const BackwardLightSampler&         m_light_sampler;
             SamplingContext&                    m_sampling_context;
@@ -385,6 +753,20 @@ namespace
             AOVComponents&                      m_aov_components;
             LightPathStream*                    m_light_path_stream;
             bool                                m_omit_emitted_light;
+            SDTree*                             m_sd_tree;
+            GuidingVertex                       m_guiding_vertices[MaxGuidingVertexCount];
+            size_t                              m_guiding_vertex_count;
+            RadianceCacheContext*               m_radiance_cache_context;
+            RadianceCacheVertex                 m_radiance_cache_vertices[MaxRadianceCacheVertexCount];
+            size_t                              m_radiance_cache_vertex_count;
+            size_t                              m_diffuse_bounces;
+            bool                                m_terminated_by_radiance_cache;
+            float                               m_adjoint_rr_reference;     // radiance expected from the path, negative if unknown yet
+            IrradianceCloudContext*             m_irradiance_cloud_context;
+            IrradianceCloudVertex               m_irradiance_cloud_vertices[MaxIrradianceCloudVertexCount];
+            size_t                              m_irradiance_cloud_vertex_count;
+            CausticPhotonMapContext*            m_caustic_photon_map_context;
+            EnvironmentSamplingCache*           m_env_sampling_cache;
 
             PathVisitorBase(
                 const Parameters&               params,
@@ -394,7 +776,12 @@ namespace
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
                 AOVComponents&                  aov_components,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                SDTree*                         sd_tree,
+                RadianceCacheContext*           radiance_cache_context,
+                IrradianceCloudContext*         irradiance_cloud_context,
+                CausticPhotonMapContext*        caustic_photon_map_context,
+                EnvironmentSamplingCache*       env_sampling_cache)
               : m_params(params)
               , m_light_sampler(light_sampler)
               , m_sampling_context(sampling_context)
@@ -404,7 +791,260 @@ namespace
               , m_aov_components(aov_components)
               , m_light_path_stream(light_path_stream)
               , m_omit_emitted_light(false)
+              , m_sd_tree(sd_tree)
+              , m_guiding_vertex_count(0)
+              , m_radiance_cache_context(radiance_cache_context)
+              , m_radiance_cache_vertex_count(0)
+              , m_diffuse_bounces(0)
+              , m_terminated_by_radiance_cache(false)
+              , m_adjoint_rr_reference(-1.0f)
+              , m_irradiance_cloud_context(irradiance_cloud_context)
+              , m_irradiance_cloud_vertex_count(0)
+              , m_caustic_photon_map_context(caustic_photon_map_context)
+              , m_env_sampling_cache(env_sampling_cache)
+            {
+            }
+
+            // Remember the vertex from which the ray leading to a given vertex was scattered,
+            // so that the radiance later found along that ray can train path guiding.
+            void save_guiding_vertex(const PathVertex& vertex)
+            {
+                if (m_sd_tree == nullptr || m_guiding_vertex_count == MaxGuidingVertexCount)
+                    return;
+
+                if (vertex.m_prev_mode != ScatteringMode::Diffuse &&
+                    vertex.m_prev_mode != ScatteringMode::Glossy)
+                    return;
+
+                const ShadingRay& ray = vertex.get_ray();
+
+                GuidingVertex& guiding_vertex = m_guiding_vertices[m_guiding_vertex_count++];
+                guiding_vertex.m_point = ray.m_org;
+                guiding_vertex.m_direction = Vector3f(ray.m_dir);
+                guiding_vertex.m_sampling_prob = vertex.m_prev_sampling_prob;
+                guiding_vertex.m_throughput = vertex.m_throughput;
+                guiding_vertex.m_path_radiance = m_path_radiance.m_beauty;
+            }
+
+            // Terminate the path at a given vertex using the radiance cached nearby, if possible.
+            // Otherwise, remember the vertex so that the radiance later found along the path can
+            // be inserted into the cache. Return true if the path was terminated.
+            bool use_radiance_cache(PathVertex& vertex)
+            {
+                if (m_radiance_cache_context == nullptr)
+                    return false;
+
+                if (vertex.m_prev_mode == ScatteringMode::Diffuse)
+                    ++m_diffuse_bounces;
+
+                // Subsurface scattering does not reflect light at the vertex itself.
+                if (vertex.m_bssrdf != nullptr)
+                    return false;
+
+                const Vector3f position(vertex.get_point());
+                Vector3f normal(vertex.get_geometric_normal());
+                if (dot(vertex.m_outgoing.get_value(), vertex.get_geometric_normal()) < 0.0)
+                    normal = -normal;
+
+                const Material* material = vertex.get_material();
+
+                if (m_diffuse_bounces >= m_params.m_radiance_cache_min_diffuse_bounces)
+                {
+                    Spectrum radiance;
+                    if (m_radiance_cache_context->m_cache.lookup(
+                            position,
+                            normal,
+                            material,
+                            m_radiance_cache_context->m_answer,
+                            radiance))
+                    {
+                        radiance *= vertex.m_throughput;
+
+                        DirectShadingComponents cached_radiance;
+                        cached_radiance.m_diffuse = radiance;
+                        cached_radiance.m_beauty = radiance;
+                        m_path_radiance.add(
+                            vertex.m_path_length,
+                            vertex.m_aov_mode,
+                            cached_radiance);
+
+                        vertex.m_scattering_modes = ScatteringMode::None;
+                        m_terminated_by_radiance_cache = true;
+                        ++m_radiance_cache_context->m_hit_count;
+                        return true;
+                    }
+                }
+
+                if (m_radiance_cache_vertex_count < MaxRadianceCacheVertexCount &&
+                    m_radiance_cache_context->m_cache.is_recording())
+                {
+                    RadianceCacheVertex& cache_vertex = m_radiance_cache_vertices[m_radiance_cache_vertex_count++];
+                    cache_vertex.m_position = position;
+                    cache_vertex.m_normal = normal;
+                    cache_vertex.m_material = material;
+                    cache_vertex.m_throughput = vertex.m_throughput;
+                    cache_vertex.m_path_radiance = m_path_radiance.m_beauty;
+                }
+
+                return false;
+            }
+
+            // Use Russian Roulette to cut the path at a given vertex, based on the radiance this vertex
+            // is expected to bring back relative to the radiance expected from the whole path. Both are
+            // estimated with the radiance cache; the latter at the first vertex where the cache has an
+            // estimate. Fall back to throughput-based Russian Roulette elsewhere. Paths are only
+            // terminated, never split.
+            void apply_adjoint_rr(PathVertex& vertex)
+            {
+                if (m_radiance_cache_context == nullptr ||
+                    !m_params.m_adjoint_rr ||
+                    vertex.m_scattering_modes == ScatteringMode::None)
+                    return;
+
+                float scattering_prob = 1.0f;
+
+                Spectrum radiance;
+                if (vertex.m_bssrdf == nullptr &&
+                    lookup_radiance_cache(vertex, radiance))
+                {
+                    radiance *= vertex.m_throughput;
+                    const float expected_radiance = average_value(radiance);
+
+                    // The first estimate serves as reference for the rest of the path.
+                    if (m_adjoint_rr_reference < 0.0f)
+                    {
+                        m_adjoint_rr_reference = average_value(m_path_radiance.m_beauty) + expected_radiance;
+                        return;
+                    }
+
+                    if (m_adjoint_rr_reference > 0.0f)
+                    {
+                        const float ratio = expected_radiance / m_adjoint_rr_reference;
+                        scattering_prob =
+                            max(min(ratio / AdjointRRWindowLowerBound, 1.0f), AdjointRRMinSurvivalProb);
+                    }
+                }
+                else if (vertex.m_path_length > m_params.m_rr_min_path_length)
+                    scattering_prob = min(max_value(vertex.m_throughput), 0.99f);
+
+                if (scattering_prob >= 1.0f)
+                    return;
+
+                // Generate a uniform sample in [0,1).
+                m_sampling_context.split_in_place(1, 1);
+                const float s = m_sampling_context.next2<float>();
+
+                // Russian Roulette.
+                if (!pass_rr(scattering_prob, s))
+                {
+                    vertex.m_scattering_modes = ScatteringMode::None;
+                    return;
+                }
+
+                // Adjust throughput to account for terminated paths.
+                assert(scattering_prob > 0.0f);
+                vertex.m_throughput /= scattering_prob;
+            }
+
+            // Estimate the radiance reflected at a given vertex toward the previous vertex using the
+            // radiance cache. Return false if the cache has no estimate.
+            bool lookup_radiance_cache(const PathVertex& vertex, Spectrum& radiance) const
+            {
+                Vector3f normal(vertex.get_geometric_normal());
+                if (dot(vertex.m_outgoing.get_value(), vertex.get_geometric_normal()) < 0.0)
+                    normal = -normal;
+
+                return
+                    m_radiance_cache_context->m_cache.lookup(
+                        Vector3f(vertex.get_point()),
+                        normal,
+                        vertex.get_material(),
+                        m_radiance_cache_context->m_answer,
+                        radiance);
+            }
+
+            // Terminate the path at a vertex with a BSSRDF using the irradiance cached over its
+            // surface, if possible, instead of sampling an incoming point.
+            void use_irradiance_cloud(PathVertex& vertex)
+            {
+                if (m_irradiance_cloud_context == nullptr ||
+                    vertex.m_bssrdf == nullptr ||
+                    !ScatteringMode::has_diffuse(vertex.m_scattering_modes))
+                    return;
+
+                const IrradiancePointCloud& cloud = m_irradiance_cloud_context->m_cloud;
+                if (!cloud.is_ready())
+                    return;
+
+                Spectrum radiance;
+                if (!vertex.m_bssrdf->evaluate_from_irradiance(
+                        vertex.m_bssrdf_data,
+                        *vertex.m_shading_point,
+                        Vector3f(vertex.m_outgoing.get_value()),
+                        cloud,
+                        radiance))
+                    return;
+
+                radiance *= vertex.m_throughput;
+
+                DirectShadingComponents cached_radiance;
+                cached_radiance.m_diffuse = radiance;
+                cached_radiance.m_beauty = radiance;
+                m_path_radiance.add(
+                    vertex.m_path_length,
+                    vertex.m_aov_mode,
+                    cached_radiance);
+
+                vertex.m_scattering_modes = ScatteringMode::None;
+                ++m_irradiance_cloud_context->m_hit_count;
+            }
+
+            // Remember the incoming point of a subsurface scattering event so that the radiance
+            // later found along the path can be inserted into the irradiance point cloud.
+            void save_irradiance_cloud_vertex(const PathVertex& vertex)
+            {
+                if (m_irradiance_cloud_context == nullptr ||
+                    vertex.m_bssrdf == nullptr ||
+                    m_irradiance_cloud_vertex_count == MaxIrradianceCloudVertexCount ||
+                    !m_irradiance_cloud_context->m_cloud.is_recording())
+                    return;
+
+                IrradianceCloudVertex& cloud_vertex = m_irradiance_cloud_vertices[m_irradiance_cloud_vertex_count++];
+                cloud_vertex.m_position = Vector3f(vertex.get_point());
+                cloud_vertex.m_bssrdf = vertex.m_bssrdf;
+                cloud_vertex.m_object_instance = &vertex.m_shading_point->get_object_instance();
+                cloud_vertex.m_throughput = vertex.m_throughput;
+                cloud_vertex.m_path_radiance = m_path_radiance.m_beauty;
+            }
+
+            // Add the caustics reflected at a diffuse vertex, estimated from the caustic photon map.
+            // The path tracer does not follow the paths leading to caustics in this case.
+            void add_caustic_photon_map_contribution(const PathVertex& vertex)
             {
+                if (m_caustic_photon_map_context == nullptr ||
+                    vertex.m_bsdf == nullptr ||
+                    vertex.m_bssrdf != nullptr ||
+                    !ScatteringMode::has_diffuse(vertex.m_scattering_modes))
+                    return;
+
+                Spectrum radiance;
+                if (!m_caustic_photon_map_context->m_map.estimate_radiance(
+                        vertex,
+                        m_caustic_photon_map_context->m_answer,
+                        radiance))
+                    return;
+
+                radiance *= vertex.m_throughput;
+
+                DirectShadingComponents caustic_radiance;
+                caustic_radiance.m_diffuse = radiance;
+                caustic_radiance.m_beauty = radiance;
+                m_path_radiance.add(
+                    vertex.m_path_length,
+                    vertex.m_aov_mode,
+                    caustic_radiance);
+
+                ++m_caustic_photon_map_context->m_hit_count;
             }
         };
 
@@ -424,7 +1064,12 @@ namespace
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
                 AOVComponents&                  aov_components,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                SDTree*                         sd_tree,
+                RadianceCacheContext*           radiance_cache_context,
+                IrradianceCloudContext*         irradiance_cloud_context,
+                CausticPhotonMapContext*        caustic_photon_map_context,
+                EnvironmentSamplingCache*       env_sampling_cache)
               : PathVisitorBase(
                     params,
                     light_sampler,
@@ -433,7 +1078,12 @@ namespace
                     scene,
                     path_radiance,
                     aov_components,
-                    light_path_stream)
+                    light_path_stream,
+                    sd_tree,
+                    radiance_cache_context,
+                    irradiance_cloud_context,
+                    caustic_photon_map_context,
+                    env_sampling_cache)
             {
             }
 
@@ -441,6 +1091,8 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::None);
 
+                save_guiding_vertex(vertex);
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == nullptr)
                     return;
@@ -466,8 +1118,10 @@ namespace
                     env_radiance);
             }
 
-            void on_hit(const PathVertex& vertex)
+            void on_hit(PathVertex& vertex)
             {
+                save_guiding_vertex(vertex);
+
                 // Emitted light contribution.
                 if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
                     vertex.m_edf &&
@@ -498,10 +1152,23 @@ namespace
                     if (m_light_path_stream)
                         m_light_path_stream->hit_reflector(vertex);
                 }
+
+                // Reuse the irradiance cached over subsurface scattering surfaces.
+                use_irradiance_cloud(vertex);
+
+                // Cut paths that are not expected to contribute much.
+                apply_adjoint_rr(vertex);
             }
 
             void on_scatter(PathVertex& vertex)
             {
+                // Reuse the radiance cached nearby.
+                if (use_radiance_cache(vertex))
+                    return;
+
+                // Remember the incoming point of subsurface scattering events.
+                save_irradiance_cloud_vertex(vertex);
+
                 // When caustics are disabled, disable glossy and specular components after a diffuse or volume bounce.
                 // Note that accept_scattering() is later going to return false in this case.
                 if (!m_params.m_enable_caustics)
@@ -510,6 +1177,9 @@ namespace
                         vertex.m_prev_mode == ScatteringMode::Volume)
                         vertex.m_scattering_modes &= ~(ScatteringMode::Glossy | ScatteringMode::Specular);
                 }
+
+                // Caustics estimated from the caustic photon map.
+                add_caustic_photon_map_contribution(vertex);
             }
         };
 
@@ -529,7 +1199,12 @@ namespace
                 const Scene&                    scene,
                 ShadingComponents&              path_radiance,
                 AOVComponents&                  aov_components,
-                LightPathStream*                light_path_stream)
+                LightPathStream*                light_path_stream,
+                SDTree*                         sd_tree,
+                RadianceCacheContext*           radiance_cache_context,
+                IrradianceCloudContext*         irradiance_cloud_context,
+                CausticPhotonMapContext*        caustic_photon_map_context,
+                EnvironmentSamplingCache*       env_sampling_cache)
               : PathVisitorBase(
                     params,
                     light_sampler,
@@ -538,7 +1213,12 @@ namespace
                     scene,
                     path_radiance,
                     aov_components,
-                    light_path_stream)
+                    light_path_stream,
+                    sd_tree,
+                    radiance_cache_context,
+                    irradiance_cloud_context,
+                    caustic_photon_map_context,
+                    env_sampling_cache)
               , m_is_indirect_lighting(false)
             {
             }
@@ -547,6 +1227,8 @@ namespace
             {
                 assert(vertex.m_prev_mode != ScatteringMode::None);
 
+                save_guiding_vertex(vertex);
+
                 // Can't look up the environment if there's no environment EDF.
                 if (m_env_edf == nullptr)
                     return;
@@ -569,6 +1251,20 @@ namespace
                 if (env_prob == 0.0)
                     return;
 
+                // Environment samples at surface vertices were drawn from the environment sampling cache.
+                if (m_env_sampling_cache &&
+                    vertex.m_prev_mode != ScatteringMode::Volume &&
+                    vertex.m_prev_mode != ScatteringMode::Specular &&
+                    vertex.m_parent_shading_point)
+                {
+                    env_prob =
+                        m_env_sampling_cache->evaluate_pdf(
+                            m_shading_context,
+                            Vector3f(vertex.m_parent_shading_point->get_geometric_normal()),
+                            -Vector3f(vertex.m_outgoing.get_value()),
+                            env_prob);
+                }
+
                 // Multiple importance sampling.
                 if (vertex.m_prev_mode != ScatteringMode::Specular)
                 {
@@ -595,8 +1291,10 @@ namespace
                     env_radiance);
             }
 
-            void on_hit(const PathVertex& vertex)
+            void on_hit(PathVertex& vertex)
             {
+                save_guiding_vertex(vertex);
+
                 // Emitted light contribution.
                 if ((!m_omit_emitted_light || m_params.m_enable_caustics) &&
                     vertex.m_edf &&
@@ -631,12 +1329,25 @@ namespace
                     if (m_light_path_stream)
                         m_light_path_stream->hit_reflector(vertex);
                 }
+
+                // Reuse the irradiance cached over subsurface scattering surfaces.
+                use_irradiance_cloud(vertex);
+
+                // Cut paths that are not expected to contribute much.
+                apply_adjoint_rr(vertex);
             }
 
             void on_scatter(PathVertex& vertex)
             {
                 assert(vertex.m_scattering_modes != ScatteringMode::None);
 
+                // Reuse the radiance cached nearby.
+                if (use_radiance_cache(vertex))
+                    return;
+
+                // Remember the incoming point of subsurface scattering events.
+                save_irradiance_cloud_vertex(vertex);
+
                 // Any light contribution after a diffuse or glossy bounce is considered indirect.
                 if (ScatteringMode::has_diffuse_or_glossy_or_volume(vertex.m_prev_mode))
                     m_is_indirect_lighting = true;
@@ -652,6 +1363,9 @@ namespace
                 if (vertex.m_scattering_modes == ScatteringMode::None)
                     return;
 
+                // Caustics estimated from the caustic photon map.
+                add_caustic_photon_map_contribution(vertex);
+
                 DirectShadingComponents vertex_radiance;
 
                 if (vertex.m_bssrdf == nullptr)
@@ -780,6 +1494,9 @@ namespace
                     scattering_modes,       // light_sampling_modes
                     1,                      // material_sample_count
                     light_sample_count,
+                    m_params.m_dl_light_candidate_count,
+                    m_params.m_dl_max_light_sample_count,
+                    m_params.m_dl_light_sample_error_threshold,
                     m_params.m_dl_low_light_threshold,
                     m_is_indirect_lighting);
                 integrator.compute_outgoing_radiance_light_sampling_low_variance(
@@ -830,7 +1547,8 @@ namespace
                     1,                      // bsdf_sample_count
                     env_sample_count,
                     ibl_radiance,
-                    light_path_stream);
+                    light_path_stream,
+                    m_env_sampling_cache);
 
                 // Divide by the sample count when this number is less than 1.
                 if (m_params.m_rcp_ibl_env_sample_count > 0.0f)
@@ -1081,6 +1799,52 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Enable Caustics")
             .insert("help", "Enable caustics"));
 
+    metadata.dictionaries().insert(
+        "enable_caustic_photon_map",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Caustic Photon Map")
+            .insert("help", "Estimate caustics seen through diffuse surfaces from photons traced before each rendering pass instead of tracing them"));
+
+    metadata.dictionaries().insert(
+        "caustic_photons_per_pass",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "250000")
+            .insert("min", "1000")
+            .insert("label", "Caustic Photons per Pass")
+            .insert("help", "Number of photons emitted from the lights and from the environment to build the caustic photon map"));
+
+    metadata.dictionaries().insert(
+        "caustic_photon_map_initial_radius",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.1")
+            .insert("min", "0.001")
+            .insert("max", "100.0")
+            .insert("label", "Caustic Photon Map Initial Radius")
+            .insert("help", "Initial lookup radius of the caustic photon map, as a percentage of the scene diameter"));
+
+    metadata.dictionaries().insert(
+        "caustic_photon_map_alpha",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.7")
+            .insert("min", "0.0")
+            .insert("max", "1.0")
+            .insert("label", "Caustic Photon Map Alpha")
+            .insert("help", "Lookup radius shrinking factor of the caustic photon map"));
+
+    metadata.dictionaries().insert(
+        "caustic_photon_map_max_photons",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "100")
+            .insert("min", "8")
+            .insert("label", "Caustic Photon Map Max Photons")
+            .insert("help", "Maximum number of photons per caustic radiance estimate"));
+
     metadata.dictionaries().insert(
         "max_bounces",
         Dictionary()
@@ -1140,6 +1904,14 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Russian Roulette Start Bounce")
             .insert("help", "Consider pruning low contribution paths starting with this bounce"));
 
+    metadata.dictionaries().insert(
+        "adjoint_rr",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Adjoint-Driven Russian Roulette")
+            .insert("help", "Prune paths according to the radiance they are expected to bring back, as estimated by the radiance cache; requires the radiance cache"));
+
     metadata.dictionaries().insert(
         "next_event_estimation",
         Dictionary()
@@ -1156,6 +1928,30 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Light Samples")
             .insert("help", "Number of samples used to estimate direct lighting"));
 
+    metadata.dictionaries().insert(
+        "dl_light_candidates",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1")
+            .insert("label", "Light Candidates")
+            .insert("help", "Number of light candidates each light sample is chosen from; a single shadow ray is traced per light sample"));
+
+    metadata.dictionaries().insert(
+        "dl_adaptive_max_light_samples",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Adaptive Max Light Samples")
+            .insert("help", "Maximum number of light samples taken at shading points where direct lighting has not converged; 0 disables adaptive direct lighting"));
+
+    metadata.dictionaries().insert(
+        "dl_adaptive_error_threshold",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.1")
+            .insert("label", "Adaptive Error Threshold")
+            .insert("help", "Relative standard error of direct lighting below which no more light samples are taken"));
+
     metadata.dictionaries().insert(
         "dl_low_light_threshold",
         Dictionary()
@@ -1172,6 +1968,14 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "IBL Samples")
             .insert("help", "Number of samples used to estimate environment lighting"));
 
+    metadata.dictionaries().insert(
+        "enable_ibl_env_cache",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "IBL Sampling Cache")
+            .insert("help", "Sample the environment according to the orientation of the surface"));
+
     metadata.dictionaries().insert(
         "clamp_roughness",
         Dictionary()
@@ -1216,15 +2020,116 @@ Dictionary PTLightingEngineFactory::get_params_metadata()
             .insert("label", "Record Light Paths")
             .insert("help", "Record light paths in memory to later allow visualizing them or saving them to disk"));
 
+    metadata.dictionaries().insert(
+        "enable_path_guiding",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Path Guiding")
+            .insert("help", "Learn the distribution of incident light during the first rendering passes and use it to guide diffuse and glossy bounces"));
+
+    metadata.dictionaries().insert(
+        "path_guiding_training_passes",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "4")
+            .insert("min", "1")
+            .insert("label", "Path Guiding Training Passes")
+            .insert("help", "Number of rendering passes used to learn the path guiding distributions; the last pass is never used for training"));
+
+    metadata.dictionaries().insert(
+        "path_guiding_bsdf_fraction",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.5")
+            .insert("min", "0.05")
+            .insert("max", "0.95")
+            .insert("label", "Path Guiding BSDF Fraction")
+            .insert("help", "Probability of sampling the BSDF rather than the learned distribution at guided bounces"));
+
+    metadata.dictionaries().insert(
+        "enable_radiance_cache",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable Radiance Cache")
+            .insert("help", "Cache the radiance reflected by surfaces during the first rendering passes and reuse it to terminate paths after a few diffuse bounces"));
+
+    metadata.dictionaries().insert(
+        "radiance_cache_min_diffuse_bounces",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1")
+            .insert("min", "0")
+            .insert("label", "Radiance Cache Min Diffuse Bounces")
+            .insert("help", "Number of diffuse bounces after which paths are terminated using the radiance cache"));
+
+    metadata.dictionaries().insert(
+        "radiance_cache_max_error",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.01")
+            .insert("min", "0.0001")
+            .insert("max", "0.1")
+            .insert("label", "Radiance Cache Max Error")
+            .insert("help", "Maximum distance, relative to the scene diameter, between a point and the cached records it reuses"));
+
+    metadata.dictionaries().insert(
+        "radiance_cache_max_records",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1000000")
+            .insert("min", "1000")
+            .insert("label", "Radiance Cache Max Records")
+            .insert("help", "Maximum number of records stored in the radiance cache"));
+
+    metadata.dictionaries().insert(
+        "enable_sss_irradiance_cloud",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Enable SSS Irradiance Cloud")
+            .insert("help", "Cache the irradiance of subsurface scattering surfaces during the first rendering passes and integrate the diffusion profiles of dipole BSSRDFs against it"));
+
+    metadata.dictionaries().insert(
+        "sss_irradiance_cloud_passes",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1")
+            .insert("min", "1")
+            .insert("label", "SSS Irradiance Cloud Passes")
+            .insert("help", "Number of rendering passes used to record the irradiance of subsurface scattering surfaces; the last pass is never used for recording"));
+
+    metadata.dictionaries().insert(
+        "sss_irradiance_cloud_max_error",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.1")
+            .insert("min", "0.0")
+            .insert("max", "1.0")
+            .insert("label", "SSS Irradiance Cloud Max Error")
+            .insert("help", "Maximum solid angle, in steradians, under which a group of cached records is integrated as a whole"));
+
+    metadata.dictionaries().insert(
+        "sss_irradiance_cloud_max_records",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1000000")
+            .insert("min", "1000")
+            .insert("label", "SSS Irradiance Cloud Max Records")
+            .insert("help", "Maximum number of records stored in the irradiance point cloud"));
+
     return metadata;
 }
 
 PTLightingEngineFactory::PTLightingEngineFactory(
     const BackwardLightSampler&     light_sampler,
     LightPathRecorder&              light_path_recorder,
+    PTPassCallback*                 pass_callback,
     const ParamArray&               params)
   : m_light_sampler(light_sampler)
   , m_light_path_recorder(light_path_recorder)
+  , m_pass_callback(pass_callback)
   , m_params(params)
 {
 }
@@ -1240,6 +2145,7 @@ ILightingEngine* PTLightingEngineFactory::create()
         new PTLightingEngine(
             m_light_sampler,
             m_light_path_recorder,
+            m_pass_callback,
             m_params);
 }
 
@@ -40,6 +40,7 @@
 namespace foundation    { class Dictionary; }
 namespace renderer      { class BackwardLightSampler; }
 namespace renderer      { class LightPathRecorder; }
+namespace renderer      { class PTPassCallback; }
 
 namespace renderer
 {
@@ -55,10 +56,11 @@ class PTLightingEngineFactory
     // Return parameters metadata.
     static foundation::Dictionary get_params_metadata();
 
-    // Constructor.
+    // Constructor. pass_callback may be null, in which case path guiding and the radiance cache are disabled.
     PTLightingEngineFactory(
         const BackwardLightSampler&     light_sampler,
         LightPathRecorder&              light_path_recorder,
+        PTPassCallback*                 pass_callback,
         const ParamArray&               params);
 
     // Delete this instance.
@@ -70,6 +72,7 @@ class PTLightingEngineFactory
   private:
     const BackwardLightSampler&         m_light_sampler;
     LightPathRecorder&                  m_light_path_recorder;
+    PTPassCallback*                     m_pass_callback;
     ParamArray                          m_params;
 };
 
@@ -0,0 +1,239 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "ptpasscallback.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/hash.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Number of samples a spatial leaf must receive during a training pass to get split.
+    const size_t SpatialSplitThreshold = 12000;
+
+    size_t get_training_pass_count(
+        const ParamArray&   params,
+        const char*         name,
+        const size_t        default_value)
+    {
+        const size_t pass_count = params.get_optional<size_t>("passes", 1);
+        const size_t training_pass_count = params.get_optional<size_t>(name, default_value);
+
+        // The last pass never benefits from training.
+        return min(training_pass_count, pass_count > 0 ? pass_count - 1 : 0);
+    }
+
+    AABB3d get_guiding_bbox(const Scene& scene)
+    {
+        AABB3d bbox(scene.compute_bbox());
+
+        if (!bbox.is_valid())
+            return AABB3d(Vector3d(-1.0), Vector3d(1.0));
+
+        // Make sure flat scenes get a usable box.
+        bbox.robust_grow(1.0e-4);
+
+        return bbox;
+    }
+}
+
+
+//
+// PTPassCallback class implementation.
+//
+
+PTPassCallback::PTPassCallback(
+    const Scene&            scene,
+    const ParamArray&       params,
+    CausticPhotonMap*       caustic_photon_map)
+  : m_training_pass_count(0)
+  , m_sss_recording_pass_count(0)
+  , m_pass_number(0)
+  , m_caustic_photon_map(caustic_photon_map)
+{
+    if (params.get_optional<bool>("enable_path_guiding", false))
+    {
+        m_training_pass_count = get_training_pass_count(params, "path_guiding_training_passes", 4);
+
+        if (m_training_pass_count > 0)
+        {
+            m_sd_tree.reset(
+                new SDTree(
+                    get_guiding_bbox(scene),
+                    clamp(params.get_optional<float>("path_guiding_bsdf_fraction", 0.5f), 0.05f, 0.95f),
+                    SpatialSplitThreshold));
+        }
+        else RENDERER_LOG_WARNING("path guiding requires at least two rendering passes and will be disabled.");
+    }
+
+    if (params.get_optional<bool>("enable_radiance_cache", false))
+    {
+        const float scene_diameter = static_cast<float>(scene.compute_bbox().diameter());
+        const float max_error = params.get_optional<float>("radiance_cache_max_error", 0.01f);
+
+        m_radiance_cache.reset(
+            new RadianceCache(
+                max(max_error, 0.0f) * scene_diameter,
+                params.get_optional<size_t>("radiance_cache_max_records", 1000000)));
+    }
+
+    if (params.get_optional<bool>("enable_sss_irradiance_cloud", false))
+    {
+        m_sss_recording_pass_count = get_training_pass_count(params, "sss_irradiance_cloud_passes", 1);
+
+        if (m_sss_recording_pass_count > 0)
+        {
+            m_sss_irradiance_cloud.reset(
+                new IrradiancePointCloud(
+                    max(params.get_optional<float>("sss_irradiance_cloud_max_error", 0.1f), 0.0f),
+                    params.get_optional<size_t>("sss_irradiance_cloud_max_records", 1000000)));
+        }
+        else RENDERER_LOG_WARNING("the sss irradiance cloud requires at least two rendering passes and will be disabled.");
+    }
+}
+
+void PTPassCallback::release()
+{
+    delete this;
+}
+
+void PTPassCallback::on_pass_begin(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    m_stopwatch.start();
+
+    if (m_caustic_photon_map)
+    {
+        const uint32 pass_hash = mix_uint32(frame.get_noise_seed(), static_cast<uint32>(m_pass_number));
+        m_caustic_photon_map->build(pass_hash, job_queue, abort_switch);
+
+        RENDERER_LOG_INFO(
+            "caustic photon map holds %s %s, lookup radius is %s.",
+            pretty_uint(m_caustic_photon_map->size()).c_str(),
+            plural(m_caustic_photon_map->size(), "photon").c_str(),
+            pretty_scalar(m_caustic_photon_map->get_lookup_radius(), 6).c_str());
+    }
+}
+
+void PTPassCallback::on_pass_end(
+    const Frame&            frame,
+    JobQueue&               job_queue,
+    IAbortSwitch&           abort_switch)
+{
+    if (m_sd_tree && m_pass_number < m_training_pass_count)
+    {
+        m_sd_tree->update();
+
+        m_stopwatch.measure();
+
+        RENDERER_LOG_INFO(
+            "path guiding training pass %s of %s completed in %s, using %s spatial %s and %s directional %s.",
+            pretty_uint(m_pass_number + 1).c_str(),
+            pretty_uint(m_training_pass_count).c_str(),
+            pretty_time(m_stopwatch.get_seconds()).c_str(),
+            pretty_uint(m_sd_tree->get_leaf_count()).c_str(),
+            plural(m_sd_tree->get_leaf_count(), "leaf", "leaves").c_str(),
+            pretty_uint(m_sd_tree->get_directional_node_count()).c_str(),
+            plural(m_sd_tree->get_directional_node_count(), "node").c_str());
+
+        // Stop recording once the last training pass is completed.
+        if (m_pass_number + 1 == m_training_pass_count)
+            m_sd_tree->set_training(false);
+    }
+
+    if (m_radiance_cache)
+    {
+        const size_t previous_size = m_radiance_cache->size();
+        m_radiance_cache->update();
+
+        if (m_radiance_cache->size() > previous_size)
+        {
+            RENDERER_LOG_INFO(
+                "radiance cache now holds %s %s.",
+                pretty_uint(m_radiance_cache->size()).c_str(),
+                plural(m_radiance_cache->size(), "record").c_str());
+        }
+    }
+
+    // The irradiance point cloud is only integrated once recording is over.
+    if (m_sss_irradiance_cloud && m_pass_number + 1 == m_sss_recording_pass_count)
+    {
+        m_sss_irradiance_cloud->set_recording(false);
+        m_sss_irradiance_cloud->update();
+
+        RENDERER_LOG_INFO(
+            "sss irradiance cloud holds %s %s.",
+            pretty_uint(m_sss_irradiance_cloud->size()).c_str(),
+            plural(m_sss_irradiance_cloud->size(), "record").c_str());
+    }
+
+    if (m_caustic_photon_map)
+        m_caustic_photon_map->shrink_lookup_radius();
+
+    ++m_pass_number;
+}
+
+void PTPassCallback::disable_training()
+{
+    if (m_sd_tree)
+        m_sd_tree->set_training(false);
+
+    if (m_radiance_cache)
+        m_radiance_cache->set_recording(false);
+
+    if (m_sss_irradiance_cloud)
+        m_sss_irradiance_cloud->set_recording(false);
+
+    // The caustic photon map would never be built; let the path tracer render caustics instead.
+    m_caustic_photon_map.reset();
+}
+
+}   // namespace renderer
@@ -0,0 +1,141 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/causticphotonmap.h"
+#include "renderer/kernel/lighting/irradiancepointcloud.h"
+#include "renderer/kernel/lighting/radiancecache.h"
+#include "renderer/kernel/lighting/sdtree.h"
+#include "renderer/kernel/rendering/ipasscallback.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/timers.h"
+#include "foundation/utility/stopwatch.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class Frame; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class Scene; }
+
+namespace renderer
+{
+
+//
+// This class is responsible for updating the data structures that the path tracing
+// lighting engine learns while rendering (path guiding distributions, radiance
+// cache and irradiance point cloud of subsurface scattering) at the end of
+// rendering passes, and for rebuilding the caustic photon map before each pass.
+//
+
+class PTPassCallback
+  : public IPassCallback
+{
+  public:
+    // Constructor. Takes ownership of the caustic photon map, which may be null.
+    PTPassCallback(
+        const Scene&                    scene,
+        const ParamArray&               params,
+        CausticPhotonMap*               caustic_photon_map = nullptr);
+
+    // Delete this instance.
+    void release() override;
+
+    // This method is called at the beginning of a pass.
+    void on_pass_begin(
+        const Frame&                    frame,
+        foundation::JobQueue&           job_queue,
+        foundation::IAbortSwitch&       abort_switch) override;
+
+    // This method is called at the end of a pass.
+    void on_pass_end(
+        const Frame&                    frame,
+        foundation::JobQueue&           job_queue,
+        foundation::IAbortSwitch&       abort_switch) override;
+
+    // Stop updating the learned data structures.
+    void disable_training();
+
+    // Return the spatial-directional tree used for path guiding, or null if path guiding is disabled.
+    SDTree* get_sd_tree();
+
+    // Return the radiance cache, or null if the radiance cache is disabled.
+    RadianceCache* get_radiance_cache();
+
+    // Return the irradiance point cloud of subsurface scattering, or null if it is disabled.
+    IrradiancePointCloud* get_sss_irradiance_cloud();
+
+    // Return the caustic photon map, or null if it is disabled.
+    CausticPhotonMap* get_caustic_photon_map();
+
+  private:
+    size_t                              m_training_pass_count;
+    size_t                              m_sss_recording_pass_count;
+    size_t                              m_pass_number;
+    std::unique_ptr<SDTree>             m_sd_tree;
+    std::unique_ptr<RadianceCache>      m_radiance_cache;
+    std::unique_ptr<IrradiancePointCloud>
+                                        m_sss_irradiance_cloud;
+    std::unique_ptr<CausticPhotonMap>   m_caustic_photon_map;
+    foundation::Stopwatch<foundation::DefaultWallclockTimer>
+                                        m_stopwatch;
+};
+
+
+//
+// PTPassCallback class implementation.
+//
+
+inline SDTree* PTPassCallback::get_sd_tree()
+{
+    return m_sd_tree.get();
+}
+
+inline RadianceCache* PTPassCallback::get_radiance_cache()
+{
+    return m_radiance_cache.get();
+}
+
+inline IrradiancePointCloud* PTPassCallback::get_sss_irradiance_cloud()
+{
+    return m_sss_irradiance_cloud.get();
+}
+
+inline CausticPhotonMap* PTPassCallback::get_caustic_photon_map()
+{
+    return m_caustic_photon_map.get();
+}
+
+}   // namespace renderer
@@ -0,0 +1,159 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "radiancecache.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/defaulttimers.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Minimum number of suitable records for a lookup to succeed.
+    const size_t MinLookupRecordCount = 4;
+
+    // Minimum cosine of the angle between the normals of a lookup point and of a record.
+    const float NormalThreshold = 0.9f;
+}
+
+
+//
+// RadianceCache class implementation.
+//
+
+RadianceCache::RadianceCache(
+    const float             max_distance,
+    const size_t            max_record_count)
+  : m_max_square_distance(max_distance * max_distance)
+  , m_max_record_count(max_record_count)
+  , m_is_recording(true)
+{
+}
+
+RadianceCache::~RadianceCache()
+{
+}
+
+void RadianceCache::insert(const RecordVector& records)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    const size_t count =
+        min(records.size(), m_max_record_count - min(m_inserted_records.size(), m_max_record_count));
+
+    m_inserted_records.insert(m_inserted_records.end(), records.begin(), records.begin() + count);
+
+    if (m_inserted_records.size() == m_max_record_count)
+        m_is_recording = false;
+}
+
+void RadianceCache::update()
+{
+    // Records are only ever appended.
+    if (m_tree && m_records.size() == m_inserted_records.size())
+        return;
+
+    m_records = m_inserted_records;
+
+    vector<Vector3f> positions(m_records.size());
+    for (size_t i = 0, e = m_records.size(); i < e; ++i)
+        positions[i] = m_records[i].m_position;
+
+    m_tree.reset(new knn::Tree3f());
+
+    knn::Builder3f builder(*m_tree);
+    builder.build_move_points<DefaultWallclockTimer>(positions);
+}
+
+bool RadianceCache::lookup(
+    const Vector3f&         position,
+    const Vector3f&         normal,
+    const Material*         material,
+    knn::Answer<float>&     answer,
+    Spectrum&               radiance) const
+{
+    if (m_records.empty())
+        return false;
+
+    const knn::Query3f query(*m_tree, answer);
+    query.run(position, m_max_square_distance);
+
+    const size_t answer_size = answer.size();
+    if (answer_size < MinLookupRecordCount)
+        return false;
+
+    // Use the most distant record to size the filter.
+    float max_square_dist = 0.0f;
+    for (size_t i = 0; i < answer_size; ++i)
+        max_square_dist = max(max_square_dist, answer.get(i).m_square_dist);
+    const float rcp_max_dist = max_square_dist > 0.0f ? 1.0f / sqrt(max_square_dist) : 0.0f;
+
+    // Average suitable records with a cone filter.
+    radiance.set(0.0f);
+    float weight_sum = 0.0f;
+    size_t record_count = 0;
+
+    for (size_t i = 0; i < answer_size; ++i)
+    {
+        const knn::Answer<float>::Entry& entry = answer.get(i);
+        const Record& record = m_records[m_tree->remap(entry.m_index)];
+
+        if (record.m_material != material)
+            continue;
+
+        if (dot(normal, record.m_normal) < NormalThreshold)
+            continue;
+
+        const float weight = 1.0f - 0.99f * sqrt(entry.m_square_dist) * rcp_max_dist;
+
+        Spectrum weighted_radiance = record.m_radiance;
+        weighted_radiance *= weight;
+        radiance += weighted_radiance;
+        weight_sum += weight;
+        ++record_count;
+    }
+
+    if (record_count < MinLookupRecordCount)
+        return false;
+
+    radiance /= weight_sum;
+
+    return true;
+}
+
+}   // namespace renderer
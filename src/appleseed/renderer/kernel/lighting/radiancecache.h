@@ -0,0 +1,145 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/knn.h"
+#include "foundation/math/vector.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class Material; }
+
+namespace renderer
+{
+
+//
+// A cache of the radiance reflected by diffuse surfaces, stored as a set of points
+// in a k-nearest neighbor tree.
+//
+// Records are single-path estimates of the radiance reflected off a surface point
+// (emission excluded); lookups average the records found near a point, on a surface
+// of similar orientation and made of the same material. Reusing nearby estimates
+// trades bias for variance and speed.
+//
+
+class RadianceCache
+  : public foundation::NonCopyable
+{
+  public:
+    struct Record
+    {
+        foundation::Vector3f    m_position;
+        foundation::Vector3f    m_normal;       // unit-length, on the side of the reflected radiance
+        const Material*         m_material;
+        Spectrum                m_radiance;
+    };
+
+    typedef std::vector<Record> RecordVector;
+
+    // Number of records averaged by a lookup.
+    static const size_t LookupRecordCount = 16;
+
+    // Constructor.
+    RadianceCache(
+        const float             max_distance,           // maximum distance between a lookup point and the records it uses
+        const size_t            max_record_count);      // records inserted beyond this number are discarded
+
+    // Destructor.
+    ~RadianceCache();
+
+    // Enable or disable recording.
+    void set_recording(const bool recording);
+    bool is_recording() const;
+
+    // Insert records. They are ignored by lookups until the next call to update(). Thread-safe.
+    void insert(const RecordVector& records);
+
+    // Make all the records inserted so far available to lookups.
+    // Must not be called concurrently with any other method.
+    void update();
+
+    // Return the number of records available to lookups.
+    size_t size() const;
+
+    // Estimate the radiance reflected at a given point of a given material, on the side of
+    // a given unit-length normal. Return false if too few suitable records are found nearby.
+    // The answer must be able to hold LookupRecordCount entries.
+    bool lookup(
+        const foundation::Vector3f&     position,
+        const foundation::Vector3f&     normal,
+        const Material*                 material,
+        foundation::knn::Answer<float>& answer,
+        Spectrum&                       radiance) const;
+
+  private:
+    const float                         m_max_square_distance;
+    const size_t                        m_max_record_count;
+    bool                                m_is_recording;
+
+    boost::mutex                        m_mutex;
+    RecordVector                        m_inserted_records;
+
+    RecordVector                        m_records;
+    std::unique_ptr<foundation::knn::Tree3f>
+                                        m_tree;
+};
+
+
+//
+// RadianceCache class implementation.
+//
+
+inline void RadianceCache::set_recording(const bool recording)
+{
+    m_is_recording = recording;
+}
+
+inline bool RadianceCache::is_recording() const
+{
+    return m_is_recording;
+}
+
+inline size_t RadianceCache::size() const
+{
+    return m_records.size();
+}
+
+}   // namespace renderer
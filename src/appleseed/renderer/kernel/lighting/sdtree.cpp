@@ -0,0 +1,493 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    // Largest float strictly smaller than 1.
+    const float PrevOne = 0.99999994f;
+
+    float clamp_to_unit_interval(const float x)
+    {
+        return clamp(x, 0.0f, PrevOne);
+    }
+
+    // Map a unit direction to the unit square; inverse of sample_sphere_uniform().
+    Vector2f direction_to_square(const Vector3f& direction)
+    {
+        float phi = atan2(direction.z, direction.x);
+        if (phi < 0.0f)
+            phi += TwoPi<float>();
+
+        return
+            Vector2f(
+                clamp_to_unit_interval(phi * RcpTwoPi<float>()),
+                clamp_to_unit_interval(0.5f * (1.0f - direction.y)));
+    }
+
+    void atomic_add(boost::atomic<float>& x, const float value)
+    {
+        float expected = x.load(boost::memory_order_relaxed);
+        while (!x.compare_exchange_weak(expected, expected + value, boost::memory_order_relaxed)) {}
+    }
+
+    // Return the index of the quadrant containing a point of the unit square,
+    // and remap the point to the unit square of that quadrant.
+    size_t select_quadrant(Vector2f& p)
+    {
+        const size_t x = p.x >= 0.5f ? 1 : 0;
+        const size_t y = p.y >= 0.5f ? 1 : 0;
+
+        p.x = clamp_to_unit_interval(2.0f * p.x - x);
+        p.y = clamp_to_unit_interval(2.0f * p.y - y);
+
+        return x + 2 * y;
+    }
+
+    float load_sums(const boost::atomic<float> atomic_sums[4], float sums[4])
+    {
+        float total = 0.0f;
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            sums[i] = atomic_sums[i].load(boost::memory_order_relaxed);
+            total += sums[i];
+        }
+
+        return total;
+    }
+}
+
+
+//
+// DTree class implementation.
+//
+
+DTree::Node::Node()
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        m_sums[i].store(0.0f, boost::memory_order_relaxed);
+        m_children[i] = 0;
+    }
+}
+
+DTree::Node::Node(const Node& rhs)
+{
+    *this = rhs;
+}
+
+DTree::Node& DTree::Node::operator=(const Node& rhs)
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        m_sums[i].store(rhs.m_sums[i].load(boost::memory_order_relaxed), boost::memory_order_relaxed);
+        m_children[i] = rhs.m_children[i];
+    }
+
+    return *this;
+}
+
+DTree::DTree()
+  : m_nodes(1)
+{
+}
+
+float DTree::get_total() const
+{
+    float sums[4];
+    return load_sums(m_nodes[0].m_sums, sums);
+}
+
+void DTree::record(
+    const Vector3f&     direction,
+    const float         value)
+{
+    assert(value >= 0.0f);
+
+    Vector2f p = direction_to_square(direction);
+    size_t node_index = 0;
+
+    while (true)
+    {
+        Node& node = m_nodes[node_index];
+        const size_t quadrant = select_quadrant(p);
+
+        atomic_add(node.m_sums[quadrant], value);
+
+        if (node.m_children[quadrant] == 0)
+            break;
+
+        node_index = node.m_children[quadrant];
+    }
+}
+
+Vector3f DTree::sample(
+    const Vector2f&     s,
+    float&              probability) const
+{
+    Vector2f p = s;
+    Vector2f origin(0.0f);
+    float size = 1.0f;
+    float density = 1.0f;
+    size_t node_index = 0;
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+
+        float sums[4];
+        const float total = load_sums(node.m_sums, sums);
+
+        // Nothing was recorded below this node: sample it uniformly.
+        if (total <= 0.0f)
+            break;
+
+        // Choose a column of quadrants, then a quadrant in that column.
+        const float left_prob = (sums[0] + sums[2]) / total;
+        size_t x;
+        if (p.x < left_prob || sums[1] + sums[3] == 0.0f)
+        {
+            x = 0;
+            p.x = clamp_to_unit_interval(p.x / left_prob);
+        }
+        else
+        {
+            x = 1;
+            p.x = clamp_to_unit_interval((p.x - left_prob) / (1.0f - left_prob));
+        }
+
+        const float bottom_prob = sums[x] / (sums[x] + sums[x + 2]);
+        size_t y;
+        if (p.y < bottom_prob || sums[x + 2] == 0.0f)
+        {
+            y = 0;
+            p.y = clamp_to_unit_interval(p.y / bottom_prob);
+        }
+        else
+        {
+            y = 1;
+            p.y = clamp_to_unit_interval((p.y - bottom_prob) / (1.0f - bottom_prob));
+        }
+
+        const size_t quadrant = x + 2 * y;
+        density *= 4.0f * sums[quadrant] / total;
+
+        size *= 0.5f;
+        origin.x += x * size;
+        origin.y += y * size;
+
+        if (node.m_children[quadrant] == 0)
+            break;
+
+        node_index = node.m_children[quadrant];
+    }
+
+    probability = density * RcpFourPi<float>();
+
+    return
+        sample_sphere_uniform(
+            Vector2f(
+                clamp_to_unit_interval(origin.x + p.x * size),
+                clamp_to_unit_interval(origin.y + p.y * size)));
+}
+
+float DTree::evaluate_pdf(const Vector3f& direction) const
+{
+    Vector2f p = direction_to_square(direction);
+    float density = 1.0f;
+    size_t node_index = 0;
+
+    while (true)
+    {
+        const Node& node = m_nodes[node_index];
+
+        float sums[4];
+        const float total = load_sums(node.m_sums, sums);
+
+        if (total <= 0.0f)
+            break;
+
+        const size_t quadrant = select_quadrant(p);
+        density *= 4.0f * sums[quadrant] / total;
+
+        if (density == 0.0f || node.m_children[quadrant] == 0)
+            break;
+
+        node_index = node.m_children[quadrant];
+    }
+
+    return density * RcpFourPi<float>();
+}
+
+void DTree::refine_from(
+    const DTree&        source,
+    const float         max_leaf_fraction,
+    const size_t        max_depth)
+{
+    m_nodes.assign(1, Node());
+
+    const float total = source.get_total();
+    if (total <= 0.0f)
+        return;
+
+    struct Item
+    {
+        size_t  m_node_index;
+        size_t  m_source_node_index;    // ~0 if the source tree has no node here
+        float   m_energy;
+        size_t  m_depth;
+    };
+
+    vector<Item> stack;
+    stack.push_back(Item{ 0, 0, total, 1 });
+
+    while (!stack.empty())
+    {
+        const Item item = stack.back();
+        stack.pop_back();
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            size_t source_child_index = ~size_t(0);
+            float energy;
+
+            if (item.m_source_node_index != ~size_t(0))
+            {
+                const Node& source_node = source.m_nodes[item.m_source_node_index];
+                energy = source_node.m_sums[i].load(boost::memory_order_relaxed);
+                if (source_node.m_children[i] != 0)
+                    source_child_index = source_node.m_children[i];
+            }
+            else
+            {
+                // Assume the energy of a source leaf is evenly distributed.
+                energy = 0.25f * item.m_energy;
+            }
+
+            if (item.m_depth < max_depth && energy > max_leaf_fraction * total)
+            {
+                const size_t child_index = m_nodes.size();
+                m_nodes.emplace_back();
+                m_nodes[item.m_node_index].m_children[i] = static_cast<uint32>(child_index);
+                stack.push_back(Item{ child_index, source_child_index, energy, item.m_depth + 1 });
+            }
+        }
+    }
+}
+
+
+//
+// SDTree class implementation.
+//
+
+struct SDTree::Leaf
+{
+    AABB3d                  m_bbox;
+    DTree                   m_sampling;
+    DTree                   m_building;
+    boost::atomic<size_t>   m_sample_count;
+
+    explicit Leaf(const AABB3d& bbox)
+      : m_bbox(bbox)
+      , m_sample_count(0)
+    {
+    }
+
+    Leaf(const Leaf& rhs)
+      : m_bbox(rhs.m_bbox)
+      , m_sampling(rhs.m_sampling)
+      , m_building(rhs.m_building)
+      , m_sample_count(rhs.m_sample_count.load(boost::memory_order_relaxed))
+    {
+    }
+};
+
+namespace
+{
+    // Maximum fraction of the energy of a directional tree held by a single leaf.
+    const float DTreeMaxLeafFraction = 0.01f;
+
+    // Maximum depth of directional trees.
+    const size_t DTreeMaxDepth = 20;
+
+    // Maximum depth of the spatial tree.
+    const size_t STreeMaxDepth = 48;
+}
+
+SDTree::SDTree(
+    const AABB3d&       bbox,
+    const float         bsdf_sampling_fraction,
+    const size_t        spatial_split_threshold)
+  : m_bsdf_sampling_fraction(bsdf_sampling_fraction)
+  , m_spatial_split_threshold(spatial_split_threshold)
+  , m_is_ready(false)
+  , m_is_training(true)
+{
+    assert(bsdf_sampling_fraction > 0.0f && bsdf_sampling_fraction < 1.0f);
+    assert(bbox.is_valid());
+
+    Node root;
+    root.m_child = 0;
+    root.m_axis = 0;
+    root.m_split = 0.0;
+    root.m_leaf = 0;
+    m_nodes.push_back(root);
+
+    m_leaves.emplace_back(new Leaf(bbox));
+}
+
+SDTree::~SDTree()
+{
+}
+
+size_t SDTree::get_directional_node_count() const
+{
+    size_t count = 0;
+
+    for (const auto& leaf : m_leaves)
+        count += leaf->m_sampling.get_node_count();
+
+    return count;
+}
+
+const DTree& SDTree::get_d_tree(const Vector3d& point) const
+{
+    return m_leaves[find_leaf(point)]->m_sampling;
+}
+
+void SDTree::record(
+    const Vector3d&     point,
+    const Vector3f&     direction,
+    const float         value)
+{
+    Leaf& leaf = *m_leaves[find_leaf(point)];
+    leaf.m_building.record(direction, value);
+    ++leaf.m_sample_count;
+}
+
+void SDTree::update()
+{
+    // Split spatial leaves that received too many samples, halving their sample counts.
+    vector<pair<size_t, size_t>> stack;     // (node index, depth)
+    for (size_t i = 0, e = m_nodes.size(); i < e; ++i)
+    {
+        if (m_nodes[i].m_child == 0)
+            stack.emplace_back(i, 0);
+    }
+
+    while (!stack.empty())
+    {
+        const size_t node_index = stack.back().first;
+        const size_t depth = stack.back().second;
+        stack.pop_back();
+
+        const size_t leaf_index = m_nodes[node_index].m_leaf;
+        Leaf& leaf = *m_leaves[leaf_index];
+
+        const size_t sample_count = leaf.m_sample_count.load(boost::memory_order_relaxed);
+        if (sample_count <= m_spatial_split_threshold || depth >= STreeMaxDepth)
+            continue;
+
+        const size_t axis = max_index(leaf.m_bbox.extent());
+        const double split = leaf.m_bbox.center()[axis];
+
+        unique_ptr<Leaf> upper_leaf(new Leaf(leaf));
+        leaf.m_bbox.max[axis] = split;
+        upper_leaf->m_bbox.min[axis] = split;
+        leaf.m_sample_count.store(sample_count / 2, boost::memory_order_relaxed);
+        upper_leaf->m_sample_count.store(sample_count / 2, boost::memory_order_relaxed);
+
+        const size_t child_index = m_nodes.size();
+
+        Node lower_node;
+        lower_node.m_child = 0;
+        lower_node.m_axis = 0;
+        lower_node.m_split = 0.0;
+        lower_node.m_leaf = static_cast<uint32>(leaf_index);
+
+        Node upper_node = lower_node;
+        upper_node.m_leaf = static_cast<uint32>(m_leaves.size());
+
+        m_leaves.push_back(move(upper_leaf));
+        m_nodes.push_back(lower_node);
+        m_nodes.push_back(upper_node);
+
+        Node& node = m_nodes[node_index];
+        node.m_child = static_cast<uint32>(child_index);
+        node.m_axis = static_cast<uint32>(axis);
+        node.m_split = split;
+
+        stack.emplace_back(child_index, depth + 1);
+        stack.emplace_back(child_index + 1, depth + 1);
+    }
+
+    // Start sampling the distributions learned during this pass and prepare refined
+    // ones for the next pass.
+    for (const auto& leaf : m_leaves)
+    {
+        leaf->m_sampling = leaf->m_building;
+        leaf->m_building.refine_from(leaf->m_sampling, DTreeMaxLeafFraction, DTreeMaxDepth);
+        leaf->m_sample_count.store(0, boost::memory_order_relaxed);
+    }
+
+    m_is_ready = true;
+}
+
+size_t SDTree::find_leaf(const Vector3d& point) const
+{
+    size_t node_index = 0;
+
+    while (m_nodes[node_index].m_child != 0)
+    {
+        const Node& node = m_nodes[node_index];
+        node_index = node.m_child + (point[node.m_axis] < node.m_split ? 0 : 1);
+    }
+
+    return m_nodes[node_index].m_leaf;
+}
+
+}   // namespace renderer
@@ -0,0 +1,223 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A directional quadtree storing the distribution of the radiance arriving at a region
+// of space, as in Practical Path Guiding. Directions are mapped to the unit square with
+// the equal-area cylindrical mapping of foundation::sample_sphere_uniform().
+//
+// Each node stores the energy recorded in each of its four quadrants; a quadrant without
+// a child node is a leaf over which the distribution is uniform.
+//
+
+class DTree
+{
+  public:
+    // Constructor, creates an empty tree.
+    DTree();
+
+    // Return the number of nodes of the tree.
+    size_t get_node_count() const;
+
+    // Return the total energy recorded in the tree.
+    float get_total() const;
+
+    // Record energy arriving from a given direction. Thread-safe.
+    void record(
+        const foundation::Vector3f&     direction,
+        const float                     value);
+
+    // Sample a direction proportionally to the recorded energy. s is in [0,1)^2.
+    // Returns the probability density of the direction with respect to solid angle.
+    foundation::Vector3f sample(
+        const foundation::Vector2f&     s,
+        float&                          probability) const;
+
+    // Return the probability density of sampling a given direction.
+    float evaluate_pdf(const foundation::Vector3f& direction) const;
+
+    // Rebuild this tree with the structure of another tree, refined so that no leaf holds
+    // more than a given fraction of the total energy of that tree. All energies are reset.
+    void refine_from(
+        const DTree&                    source,
+        const float                     max_leaf_fraction,
+        const size_t                    max_depth);
+
+  private:
+    struct Node
+    {
+        boost::atomic<float>            m_sums[4];
+        foundation::uint32              m_children[4];  // 0 for leaf quadrants
+
+        Node();
+        Node(const Node& rhs);
+        Node& operator=(const Node& rhs);
+    };
+
+    std::vector<Node>                   m_nodes;
+};
+
+
+//
+// A spatial-directional tree: a binary tree over space whose leaves hold directional
+// distributions of incident radiance. Radiance is recorded in one copy of the directional
+// trees while directions are sampled from the other copy, built during the previous
+// training pass.
+//
+// Reference:
+//
+//   Practical Path Guiding for Efficient Light-Transport Simulation
+//   Thomas Muller, Markus Gross, Jan Novak
+//   Computer Graphics Forum (Proceedings of EGSR 2017)
+//
+
+class SDTree
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    SDTree(
+        const foundation::AABB3d&       bbox,
+        const float                     bsdf_sampling_fraction,
+        const size_t                    spatial_split_threshold);
+
+    // Destructor.
+    ~SDTree();
+
+    // Return the probability of sampling the BSDF rather than the guiding distribution.
+    float get_bsdf_sampling_fraction() const;
+
+    // Return true once at least one training pass has been completed.
+    bool is_ready() const;
+
+    // Enable or disable recording.
+    void set_training(const bool training);
+    bool is_training() const;
+
+    // Return the number of spatial leaves.
+    size_t get_leaf_count() const;
+
+    // Return the total number of directional nodes used for sampling.
+    size_t get_directional_node_count() const;
+
+    // Return the directional distribution to sample at a given point.
+    const DTree& get_d_tree(const foundation::Vector3d& point) const;
+
+    // Record energy arriving at a given point from a given direction. Thread-safe.
+    void record(
+        const foundation::Vector3d&     point,
+        const foundation::Vector3f&     direction,
+        const float                     value);
+
+    // End a training pass: refine the spatial and directional subdivisions according to
+    // the recorded samples and start sampling the distributions learned during the pass.
+    // Must not be called concurrently with any other method.
+    void update();
+
+  private:
+    struct Node
+    {
+        foundation::uint32              m_child;        // index of the first child, 0 for leaves
+        foundation::uint32              m_axis;
+        double                          m_split;
+        foundation::uint32              m_leaf;
+    };
+
+    struct Leaf;
+
+    const float                         m_bsdf_sampling_fraction;
+    const size_t                        m_spatial_split_threshold;
+    bool                                m_is_ready;
+    bool                                m_is_training;
+    std::vector<Node>                   m_nodes;
+    std::vector<std::unique_ptr<Leaf>>  m_leaves;
+
+    // Return the index of the leaf containing a given point.
+    size_t find_leaf(const foundation::Vector3d& point) const;
+};
+
+
+//
+// DTree class implementation.
+//
+
+inline size_t DTree::get_node_count() const
+{
+    return m_nodes.size();
+}
+
+
+//
+// SDTree class implementation.
+//
+
+inline float SDTree::get_bsdf_sampling_fraction() const
+{
+    return m_bsdf_sampling_fraction;
+}
+
+inline bool SDTree::is_ready() const
+{
+    return m_is_ready;
+}
+
+inline void SDTree::set_training(const bool training)
+{
+    m_is_training = training;
+}
+
+inline bool SDTree::is_training() const
+{
+    return m_is_training;
+}
+
+inline size_t SDTree::get_leaf_count() const
+{
+    return m_leaves.size();
+}
+
+}   // namespace renderer
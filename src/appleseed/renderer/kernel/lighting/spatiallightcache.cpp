@@ -0,0 +1,272 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "spatiallightcache.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/distance.h"
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SpatialLightCache class implementation.
+//
+
+namespace
+{
+    // Remap a sample in [begin, begin + width) to [0, 1).
+    float remap_sample(const float s, const float begin, const float width)
+    {
+        // Largest float strictly smaller than 1.
+        const float PrevOne = 0.99999994f;
+
+        return min((s - begin) / width, PrevOne);
+    }
+}
+
+SpatialLightCache::SpatialLightCache(
+    const AABB3d&                       bbox,
+    const vector<Vector3d>&             light_positions,
+    const vector<float>&                light_importances,
+    const size_t                        resolution,
+    const size_t                        max_voxel_light_count)
+  : m_light_positions(light_positions)
+  , m_light_importances(light_importances)
+  , m_max_voxel_light_count(max(max_voxel_light_count, size_t(1)))
+{
+    assert(light_positions.size() == light_importances.size());
+
+    // Build the global distribution.
+    for (size_t i = 0, e = m_light_importances.size(); i < e; ++i)
+        m_global_cdf.insert(i, m_light_importances[i]);
+
+    if (m_global_cdf.valid())
+        m_global_cdf.prepare();
+
+    // Make sure the grid encloses all the lights.
+    m_bbox = bbox;
+    for (size_t i = 0, e = m_light_positions.size(); i < e; ++i)
+        m_bbox.insert(m_light_positions[i]);
+
+    if (!m_bbox.is_valid())
+        m_bbox = AABB3d(Vector3d(0.0), Vector3d(0.0));
+
+    // Use cubic voxels.
+    const Vector3d extent = m_bbox.extent();
+    const double max_extent = max_value(extent);
+    const double voxel_size =
+        max_extent > 0.0
+            ? max_extent / static_cast<double>(max(resolution, size_t(1)))
+            : 1.0;
+
+    m_voxel_size = Vector3d(voxel_size);
+    m_rcp_voxel_size = Vector3d(1.0 / voxel_size);
+
+    size_t voxel_count = 1;
+    for (size_t d = 0; d < 3; ++d)
+    {
+        m_resolution[d] = max(static_cast<size_t>(ceil(extent[d] / voxel_size)), size_t(1));
+        voxel_count *= m_resolution[d];
+    }
+
+    m_voxels.reset(new boost::atomic<Voxel*>[voxel_count]);
+    for (size_t i = 0; i < voxel_count; ++i)
+        m_voxels[i] = nullptr;
+}
+
+SpatialLightCache::~SpatialLightCache()
+{
+    const size_t voxel_count = m_resolution[0] * m_resolution[1] * m_resolution[2];
+
+    for (size_t i = 0; i < voxel_count; ++i)
+        delete m_voxels[i].load(boost::memory_order_relaxed);
+}
+
+size_t SpatialLightCache::sample(
+    const Vector3d&                     point,
+    const float                         s,
+    float&                              probability) const
+{
+    assert(valid());
+    assert(s >= 0.0f && s < 1.0f);
+
+    const Voxel& voxel = get_voxel(point);
+
+    const size_t light_index =
+        s < voxel.m_local_prob
+            ? voxel.m_cdf.sample(remap_sample(s, 0.0f, voxel.m_local_prob)).first
+            : m_global_cdf.sample(remap_sample(s, voxel.m_local_prob, 1.0f - voxel.m_local_prob)).first;
+
+    probability =
+          voxel.m_local_prob * evaluate_local_pdf(voxel, light_index)
+        + (1.0f - voxel.m_local_prob) * m_global_cdf[light_index].second;
+
+    assert(probability > 0.0f);
+
+    return light_index;
+}
+
+float SpatialLightCache::evaluate_pdf(
+    const Vector3d&                     point,
+    const size_t                        light_index) const
+{
+    assert(valid());
+    assert(light_index < m_light_positions.size());
+
+    const Voxel& voxel = get_voxel(point);
+
+    return
+          voxel.m_local_prob * evaluate_local_pdf(voxel, light_index)
+        + (1.0f - voxel.m_local_prob) * m_global_cdf[light_index].second;
+}
+
+const SpatialLightCache::Voxel& SpatialLightCache::get_voxel(const Vector3d& point) const
+{
+    // Points outside the grid use the closest voxel.
+    size_t coords[3];
+    for (size_t d = 0; d < 3; ++d)
+    {
+        const double x = (point[d] - m_bbox.min[d]) * m_rcp_voxel_size[d];
+        coords[d] =
+            x <= 0.0 ? 0 :
+            x >= static_cast<double>(m_resolution[d] - 1) ? m_resolution[d] - 1 :
+            truncate<size_t>(x);
+    }
+
+    boost::atomic<Voxel*>& slot =
+        m_voxels[(coords[2] * m_resolution[1] + coords[1]) * m_resolution[0] + coords[0]];
+
+    Voxel* voxel = slot.load(boost::memory_order_acquire);
+
+    if (voxel == nullptr)
+    {
+        // Several threads may build the same voxel; only one of them gets to publish it.
+        Voxel* new_voxel = build_voxel(coords[0], coords[1], coords[2]);
+
+        if (slot.compare_exchange_strong(voxel, new_voxel, boost::memory_order_acq_rel))
+            voxel = new_voxel;
+        else delete new_voxel;
+    }
+
+    return *voxel;
+}
+
+SpatialLightCache::Voxel* SpatialLightCache::build_voxel(
+    const size_t                        x,
+    const size_t                        y,
+    const size_t                        z) const
+{
+    const Vector3d voxel_min(
+        m_bbox.min[0] + x * m_voxel_size[0],
+        m_bbox.min[1] + y * m_voxel_size[1],
+        m_bbox.min[2] + z * m_voxel_size[2]);
+    const AABB3d voxel_bbox(voxel_min, voxel_min + m_voxel_size);
+
+    // Don't let the bound grow without limit for lights inside the voxel.
+    const double min_square_distance = 0.25 * square_norm(m_voxel_size);
+
+    // Bound the contribution of each light to any point of the voxel.
+    typedef pair<float, size_t> BoundLightPair;
+    vector<BoundLightPair> bounds;
+    bounds.reserve(m_light_positions.size());
+
+    for (size_t i = 0, e = m_light_positions.size(); i < e; ++i)
+    {
+        if (m_light_importances[i] > 0.0f)
+        {
+            const double d2 = max(square_distance(m_light_positions[i], voxel_bbox), min_square_distance);
+            bounds.emplace_back(static_cast<float>(m_light_importances[i] / d2), i);
+        }
+    }
+
+    // Keep the lights with the largest bounds.
+    const size_t kept_count = min(bounds.size(), m_max_voxel_light_count);
+    nth_element(
+        bounds.begin(),
+        bounds.begin() + kept_count,
+        bounds.end(),
+        [](const BoundLightPair& lhs, const BoundLightPair& rhs) { return lhs.first > rhs.first; });
+
+    float rest = 0.0f;
+    for (size_t i = kept_count, e = bounds.size(); i < e; ++i)
+        rest += bounds[i].first;
+
+    bounds.resize(kept_count);
+    sort(
+        bounds.begin(),
+        bounds.end(),
+        [](const BoundLightPair& lhs, const BoundLightPair& rhs) { return lhs.second < rhs.second; });
+
+    Voxel* voxel = new Voxel();
+    voxel->m_light_indices.reserve(kept_count);
+    voxel->m_cdf.reserve(kept_count);
+
+    float kept = 0.0f;
+    for (size_t i = 0; i < kept_count; ++i)
+    {
+        voxel->m_light_indices.push_back(bounds[i].second);
+        voxel->m_cdf.insert(bounds[i].second, bounds[i].first);
+        kept += bounds[i].first;
+    }
+
+    if (voxel->m_cdf.valid())
+    {
+        voxel->m_cdf.prepare();
+        voxel->m_local_prob = kept / (kept + rest);
+    }
+    else voxel->m_local_prob = 0.0f;
+
+    return voxel;
+}
+
+float SpatialLightCache::evaluate_local_pdf(
+    const Voxel&                        voxel,
+    const size_t                        light_index) const
+{
+    const vector<size_t>::const_iterator i =
+        lower_bound(voxel.m_light_indices.begin(), voxel.m_light_indices.end(), light_index);
+
+    return
+        i != voxel.m_light_indices.end() && *i == light_index
+            ? voxel.m_cdf[i - voxel.m_light_indices.begin()].second
+            : 0.0f;
+}
+
+}   // namespace renderer
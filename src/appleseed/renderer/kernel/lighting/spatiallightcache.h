@@ -0,0 +1,136 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/cdf.h"
+#include "foundation/math/vector.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A regular grid of voxels, each holding the list of the lights that matter the most
+// in that region of space together with a distribution to sample them.
+//
+// Voxels are built lazily, the first time a shading point falls into them, from an
+// upper bound of the contribution of each light to the voxel. Lights are sampled
+// from a mixture of the voxel's distribution (restricted to its most important lights)
+// and of a global distribution (over all lights), so that every light keeps a nonzero
+// probability of being chosen anywhere.
+//
+
+class SpatialLightCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    SpatialLightCache(
+        const foundation::AABB3d&                   bbox,
+        const std::vector<foundation::Vector3d>&    light_positions,
+        const std::vector<float>&                   light_importances,
+        const size_t                                resolution,
+        const size_t                                max_voxel_light_count);
+
+    // Destructor.
+    ~SpatialLightCache();
+
+    // Return the number of lights.
+    size_t get_light_count() const;
+
+    // Return true if at least one light has a positive importance.
+    bool valid() const;
+
+    // Choose a light to illuminate a given point. s is in [0,1).
+    size_t sample(
+        const foundation::Vector3d&                 point,
+        const float                                 s,
+        float&                                      probability) const;
+
+    // Return the probability of choosing a given light to illuminate a given point.
+    float evaluate_pdf(
+        const foundation::Vector3d&                 point,
+        const size_t                                light_index) const;
+
+  private:
+    typedef foundation::CDF<size_t, float> LightCDF;
+
+    struct Voxel
+    {
+        std::vector<size_t>     m_light_indices;        // sorted by increasing index
+        LightCDF                m_cdf;                  // same order as m_light_indices
+        float                   m_local_prob;           // probability of sampling m_cdf
+    };
+
+    const std::vector<foundation::Vector3d>         m_light_positions;
+    const std::vector<float>                        m_light_importances;
+    const size_t                                    m_max_voxel_light_count;
+
+    foundation::AABB3d                              m_bbox;
+    foundation::Vector3d                            m_rcp_voxel_size;
+    foundation::Vector3d                            m_voxel_size;
+    size_t                                          m_resolution[3];
+    LightCDF                                        m_global_cdf;
+
+    std::unique_ptr<boost::atomic<Voxel*>[]>        m_voxels;
+
+    const Voxel& get_voxel(const foundation::Vector3d& point) const;
+    Voxel* build_voxel(const size_t x, const size_t y, const size_t z) const;
+
+    float evaluate_local_pdf(
+        const Voxel&                                voxel,
+        const size_t                                light_index) const;
+};
+
+
+//
+// SpatialLightCache class implementation.
+//
+
+inline size_t SpatialLightCache::get_light_count() const
+{
+    return m_light_positions.size();
+}
+
+inline bool SpatialLightCache::valid() const
+{
+    return m_global_cdf.valid();
+}
+
+}   // namespace renderer
@@ -0,0 +1,253 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sppmemissionguide.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/cdf.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SPPMEmissionGuide::Statistics class implementation.
+//
+
+SPPMEmissionGuide::Statistics::Statistics(const size_t bin_count)
+  : m_traced_photons(bin_count, 0)
+  , m_useful_photons(bin_count, 0)
+{
+}
+
+void SPPMEmissionGuide::Statistics::merge(const Statistics& rhs)
+{
+    assert(m_traced_photons.size() == rhs.m_traced_photons.size());
+
+    for (size_t i = 0, e = m_traced_photons.size(); i < e; ++i)
+    {
+        m_traced_photons[i] += rhs.m_traced_photons[i];
+        m_useful_photons[i] += rhs.m_useful_photons[i];
+    }
+}
+
+
+//
+// SPPMEmissionGuide class implementation.
+//
+
+namespace
+{
+    // Largest float smaller than 1.
+    const float OneMinusEpsilon = 1.0f - 0.5f * numeric_limits<float>::epsilon();
+
+    // Choose a bin of a piecewise constant distribution over [0,1) and remap s so that
+    // it is uniformly distributed inside that bin. Return the density of the warp.
+    float sample_bin(
+        const float*    pdf,
+        const float*    cdf,
+        const size_t    size,
+        float&          s,
+        size_t&         bin)
+    {
+        bin = sample_cdf(cdf, cdf + size, s);
+
+        const float bin_begin = bin > 0 ? cdf[bin - 1] : 0.0f;
+        const float t = min((s - bin_begin) / pdf[bin], OneMinusEpsilon);
+        s = min((bin + t) / size, OneMinusEpsilon);
+
+        return pdf[bin] * size;
+    }
+
+    // Turn a vector of weights into a normalized PDF and the matching CDF.
+    void build_cdf(
+        float*          pdf,
+        float*          cdf,
+        const size_t    size)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < size; ++i)
+            sum += pdf[i];
+
+        assert(sum > 0.0f);
+        const float rcp_sum = 1.0f / sum;
+
+        float cumulated = 0.0f;
+        for (size_t i = 0; i < size; ++i)
+        {
+            pdf[i] *= rcp_sum;
+            cumulated += pdf[i];
+            cdf[i] = cumulated;
+        }
+
+        cdf[size - 1] = 1.0f;
+    }
+}
+
+SPPMEmissionGuide::SPPMEmissionGuide(
+    const size_t                light_bin_count,
+    const size_t                direction_bin_count,
+    const float                 guided_fraction)
+  : m_light_bin_count(light_bin_count)
+  , m_direction_bin_count(direction_bin_count)
+  , m_guided_fraction(guided_fraction)
+  , m_traced_photons(get_bin_count(), 0)
+  , m_useful_photons(get_bin_count(), 0)
+  , m_light_pdf(light_bin_count)
+  , m_light_cdf(light_bin_count)
+  , m_u_pdf(light_bin_count * direction_bin_count)
+  , m_u_cdf(light_bin_count * direction_bin_count)
+  , m_v_pdf(get_bin_count())
+  , m_v_cdf(get_bin_count())
+{
+    assert(light_bin_count > 0);
+    assert(direction_bin_count > 0);
+    assert(guided_fraction >= 0.0f && guided_fraction <= 1.0f);
+
+    build_distributions(vector<float>(get_bin_count(), 1.0f));
+}
+
+float SPPMEmissionGuide::sample_light(
+    float&                      s,
+    size_t&                     light_bin) const
+{
+    return
+        sample_bin(
+            &m_light_pdf[0],
+            &m_light_cdf[0],
+            m_light_bin_count,
+            s,
+            light_bin);
+}
+
+float SPPMEmissionGuide::sample_direction(
+    const size_t                light_bin,
+    Vector2f&                   s,
+    size_t&                     bin) const
+{
+    assert(light_bin < m_light_bin_count);
+
+    const size_t u_offset = light_bin * m_direction_bin_count;
+
+    size_t u_bin;
+    const float u_density =
+        sample_bin(
+            &m_u_pdf[u_offset],
+            &m_u_cdf[u_offset],
+            m_direction_bin_count,
+            s[0],
+            u_bin);
+
+    const size_t v_offset = (u_offset + u_bin) * m_direction_bin_count;
+
+    size_t v_bin;
+    const float v_density =
+        sample_bin(
+            &m_v_pdf[v_offset],
+            &m_v_cdf[v_offset],
+            m_direction_bin_count,
+            s[1],
+            v_bin);
+
+    bin = v_offset + v_bin;
+
+    return u_density * v_density;
+}
+
+void SPPMEmissionGuide::update(const Statistics& statistics)
+{
+    assert(statistics.m_traced_photons.size() == get_bin_count());
+
+    const size_t bin_count = get_bin_count();
+
+    // Estimate the fraction of useful photons emitted from each bin, with a prior of
+    // one half for the bins we know little about.
+    vector<float> weights(bin_count);
+    float weight_sum = 0.0f;
+    for (size_t i = 0; i < bin_count; ++i)
+    {
+        m_traced_photons[i] += statistics.m_traced_photons[i];
+        m_useful_photons[i] += statistics.m_useful_photons[i];
+
+        weights[i] =
+            static_cast<float>(m_useful_photons[i] + 1) /
+            static_cast<float>(m_traced_photons[i] + 2);
+        weight_sum += weights[i];
+    }
+
+    // Mix the learned distribution with the uniform one.
+    const float uniform_weight = (1.0f - m_guided_fraction) / bin_count;
+    const float guided_scale = m_guided_fraction / weight_sum;
+    for (size_t i = 0; i < bin_count; ++i)
+        weights[i] = uniform_weight + guided_scale * weights[i];
+
+    build_distributions(weights);
+}
+
+void SPPMEmissionGuide::build_distributions(const vector<float>& weights)
+{
+    const size_t n = m_direction_bin_count;
+
+    for (size_t l = 0; l < m_light_bin_count; ++l)
+    {
+        float light_weight = 0.0f;
+
+        for (size_t u = 0; u < n; ++u)
+        {
+            const size_t v_offset = (l * n + u) * n;
+
+            float u_weight = 0.0f;
+            for (size_t v = 0; v < n; ++v)
+            {
+                m_v_pdf[v_offset + v] = weights[v_offset + v];
+                u_weight += weights[v_offset + v];
+            }
+
+            build_cdf(&m_v_pdf[v_offset], &m_v_cdf[v_offset], n);
+
+            m_u_pdf[l * n + u] = u_weight;
+            light_weight += u_weight;
+        }
+
+        build_cdf(&m_u_pdf[l * n], &m_u_cdf[l * n], n);
+
+        m_light_pdf[l] = light_weight;
+    }
+
+    build_cdf(&m_light_pdf[0], &m_light_cdf[0], m_light_bin_count);
+}
+
+}   // namespace renderer
@@ -0,0 +1,142 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A learned photon emission distribution.
+//
+// The guide warps the primary samples used to select an emitter and an emission
+// direction so that more photons are emitted from the bins that produced photons
+// in the regions seen by the camera during previous passes. Bins are laid out in
+// primary sample space: the light selection sample is split into a number of light
+// bins, and the 2D emission direction sample into a regular grid of direction bins.
+//
+// A fraction of the photons is always emitted according to the light power so that
+// no emitter or direction ever gets a zero probability.
+//
+
+class SPPMEmissionGuide
+  : public foundation::NonCopyable
+{
+  public:
+    // Number of photons emitted from each bin during a pass.
+    struct Statistics
+    {
+        std::vector<foundation::uint32> m_traced_photons;   // photons emitted from each bin
+        std::vector<foundation::uint32> m_useful_photons;   // photons from each bin that were stored in a visible region
+
+        explicit Statistics(const size_t bin_count = 0);
+
+        void insert(const size_t bin, const bool useful);
+        void merge(const Statistics& rhs);
+    };
+
+    // Constructor. The initial distribution is uniform in primary sample space.
+    SPPMEmissionGuide(
+        const size_t            light_bin_count,
+        const size_t            direction_bin_count,        // number of direction bins along each axis
+        const float             guided_fraction);           // fraction of photons emitted according to the learned distribution
+
+    // Return the total number of bins.
+    size_t get_bin_count() const;
+
+    // Warp the light selection sample. Return the density of the warp.
+    float sample_light(
+        float&                  s,
+        size_t&                 light_bin) const;
+
+    // Warp the 2D emission direction sample for a given light bin. Return the density
+    // of the warp and the bin the photon is emitted from.
+    float sample_direction(
+        const size_t            light_bin,
+        foundation::Vector2f&   s,
+        size_t&                 bin) const;
+
+    // Add the statistics of a new pass and update the learned distribution.
+    void update(const Statistics& statistics);
+
+  private:
+    const size_t                    m_light_bin_count;
+    const size_t                    m_direction_bin_count;
+    const float                     m_guided_fraction;
+
+    std::vector<foundation::uint64> m_traced_photons;
+    std::vector<foundation::uint64> m_useful_photons;
+
+    // Marginal distribution of the light bins.
+    std::vector<float>              m_light_pdf;
+    std::vector<float>              m_light_cdf;
+
+    // Distribution of the first direction coordinate given the light bin.
+    std::vector<float>              m_u_pdf;
+    std::vector<float>              m_u_cdf;
+
+    // Distribution of the second direction coordinate given the light bin and the first coordinate.
+    std::vector<float>              m_v_pdf;
+    std::vector<float>              m_v_cdf;
+
+    void build_distributions(const std::vector<float>& weights);
+};
+
+
+//
+// SPPMEmissionGuide::Statistics class implementation.
+//
+
+inline void SPPMEmissionGuide::Statistics::insert(const size_t bin, const bool useful)
+{
+    ++m_traced_photons[bin];
+
+    if (useful)
+        ++m_useful_photons[bin];
+}
+
+
+//
+// SPPMEmissionGuide class implementation.
+//
+
+inline size_t SPPMEmissionGuide::get_bin_count() const
+{
+    return m_light_bin_count * m_direction_bin_count * m_direction_bin_count;
+}
+
+}   // namespace renderer
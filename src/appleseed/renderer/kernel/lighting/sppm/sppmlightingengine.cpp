@@ -39,6 +39,7 @@
 #include "renderer/kernel/lighting/sppm/sppmpasscallback.h"
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
 #include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
+#include "renderer/kernel/lighting/sppm/sppmvisibilitygrid.h"
 #include "renderer/kernel/shading/shadingcomponents.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
@@ -372,6 +373,9 @@ namespace
                     ScatteringMode::All,
                     bsdf_sample_count,
                     light_sample_count,
+                    1,                  // light_candidate_count
+                    0,                  // max_light_sample_count
+                    0.0f,               // light_sample_error_threshold
                     m_params.m_dl_low_light_threshold,
                     false);             // not computing indirect lighting
 
@@ -394,18 +398,23 @@ namespace
                 const PathVertex&           vertex,
                 DirectShadingComponents&    vertex_radiance)
             {
+                const Vector3f point(vertex.get_point());
+
+                // Let the photon tracer know that this part of the scene is seen by the camera.
+                SPPMVisibilityGrid* visibility_grid = m_pass_callback.get_visibility_grid();
+                if (visibility_grid)
+                    visibility_grid->insert(point);
+
                 const SPPMPhotonMap& photon_map = m_pass_callback.get_photon_map();
 
                 // No indirect lighting if the photon map is empty.
                 if (photon_map.empty())
                     return;
 
-                const Vector3f point(vertex.get_point());
                 const float radius = m_pass_callback.get_lookup_radius();
 
                 // Find the nearby photons around the path vertex.
-                const knn::Query3f query(photon_map, m_answer);
-                query.run(point, radius * radius);
+                photon_map.query(point, radius * radius, m_answer);
                 const size_t photon_count = m_answer.size();
 
                 // Compute the square radius of the lookup disk.
@@ -619,11 +628,11 @@ namespace
             Spectrum&               radiance)
         {
             const SPPMPhotonMap& photon_map = m_pass_callback.get_photon_map();
-            const knn::Query3f query(photon_map, m_answer);
 
-            query.run(
+            photon_map.query(
                 Vector3f(shading_point.get_point()),
-                square(m_params.m_view_photons_radius));
+                square(m_params.m_view_photons_radius),
+                m_answer);
 
             radiance.set(0.0f);
 
@@ -746,6 +755,24 @@ Dictionary SPPMLightingEngineFactory::get_params_metadata()
             .insert("default", "6")
             .insert("help", "Consider pruning low contribution photons starting with this bounce"));
 
+    metadata.dictionaries().insert(
+        "enable_importance_emission",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Importance-Driven Emission")
+            .insert("help", "Learn from previous passes to emit more photons toward the parts of the scene seen by the camera"));
+
+    metadata.dictionaries().insert(
+        "importance_emission_fraction",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.5")
+            .insert("min", "0.0")
+            .insert("max", "1.0")
+            .insert("label", "Importance-Driven Fraction")
+            .insert("help", "Fraction of photons emitted according to the learned distribution; the others are emitted according to light power"));
+
     metadata.dictionaries().insert(
         "path_tracing_max_bounces",
         Dictionary()
@@ -809,6 +836,28 @@ Dictionary SPPMLightingEngineFactory::get_params_metadata()
             .insert("label", "Max Photons per Estimate")
             .insert("help", "Maximum number of photons used to estimate radiance"));
 
+    metadata.dictionaries().insert(
+        "photon_map",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "kd_tree|hash_grid")
+            .insert("default", "kd_tree")
+            .insert("label", "Photon Map")
+            .insert("help", "Data structure used to look up photons")
+            .insert(
+                "options",
+                Dictionary()
+                    .insert(
+                        "kd_tree",
+                        Dictionary()
+                            .insert("label", "Kd-Tree")
+                            .insert("help", "Store photons in a kd-tree"))
+                    .insert(
+                        "hash_grid",
+                        Dictionary()
+                            .insert("label", "Hash Grid")
+                            .insert("help", "Store photons in a spatial hash grid with cells the size of the lookup radius; faster to build and query"))));
+
     metadata.dictionaries().insert(
         "alpha",
         Dictionary()
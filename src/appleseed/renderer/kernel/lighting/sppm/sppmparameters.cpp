@@ -36,6 +36,7 @@
 #include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #include "foundation/utility/makevector.h"
 #include "foundation/utility/string.h"
 
@@ -93,6 +94,23 @@ namespace
             value == "rt" ? SPPMParameters::RayTraced :
             SPPMParameters::Off;
     }
+
+    SPPMParameters::PhotonMapType get_photon_map_type(
+        const ParamArray&   params,
+        const char*         name,
+        const char*         default_value)
+    {
+        const string value =
+            params.get_optional<string>(
+                name,
+                default_value,
+                make_vector("kd_tree", "hash_grid"));
+
+        return
+            value == "kd_tree"
+                ? SPPMParameters::KdTree
+                : SPPMParameters::HashGrid;
+    }
 }
 
 SPPMParameters::SPPMParameters(const ParamArray& params)
@@ -102,11 +120,14 @@ SPPMParameters::SPPMParameters(const ParamArray& params)
   , m_dl_mode(get_mode(params, "dl_mode", "rt"))
   , m_enable_ibl(params.get_optional<bool>("enable_ibl", true))
   , m_enable_caustics(params.get_optional<bool>("enable_caustics", true))
+  , m_caustic_photons_only(params.get_optional<bool>("caustic_photons_only", false))
   , m_light_photon_count(params.get_optional<size_t>("light_photons_per_pass", 1000000))
   , m_env_photon_count(params.get_optional<size_t>("env_photons_per_pass", 1000000))
   , m_photon_packet_size(params.get_optional<size_t>("photon_packet_size", 100000))
   , m_photon_tracing_max_bounces(fixup_bounces(params.get_optional<int>("photon_tracing_max_bounces", -1)))
   , m_photon_tracing_rr_min_path_length(fixup_path_length(params.get_optional<size_t>("photon_tracing_rr_min_path_length", 6)))
+  , m_enable_importance_emission(params.get_optional<bool>("enable_importance_emission", false))
+  , m_importance_emission_fraction(saturate(params.get_optional<float>("importance_emission_fraction", 0.5f)))
   , m_path_tracing_max_bounces(fixup_bounces(params.get_optional<int>("path_tracing_max_bounces", -1)))
   , m_path_tracing_rr_min_path_length(fixup_path_length(params.get_optional<size_t>("path_tracing_rr_min_path_length", 6)))
   , m_path_tracing_max_ray_intensity(params.get_optional<float>("path_tracing_max_ray_intensity", 0.0f))
@@ -116,6 +137,7 @@ SPPMParameters::SPPMParameters(const ParamArray& params)
   , m_initial_radius_percents(params.get_optional<float>("initial_radius", 0.1f))
   , m_alpha(params.get_optional<float>("alpha", 0.7f))
   , m_max_photons_per_estimate(params.get_optional<size_t>("max_photons_per_estimate", 100))
+  , m_photon_map_type(get_photon_map_type(params, "photon_map", "kd_tree"))
   , m_dl_light_sample_count(params.get_optional<float>("dl_light_samples", 1.0f))
   , m_dl_low_light_threshold(params.get_optional<float>("dl_low_light_threshold", 0.0f))
   , m_view_photons(params.get_optional<bool>("view_photons", false))
@@ -145,11 +167,15 @@ void SPPMParameters::print() const
         "  light photons                 %s\n"
         "  environment photons           %s\n"
         "  max bounces                   %s\n"
-        "  russian roulette start bounce %s",
+        "  russian roulette start bounce %s\n"
+        "  importance emission           %s",
         pretty_uint(m_light_photon_count).c_str(),
         pretty_uint(m_env_photon_count).c_str(),
         m_photon_tracing_max_bounces == ~size_t(0) ? "unlimited" : pretty_uint(m_photon_tracing_max_bounces).c_str(),
-        m_photon_tracing_rr_min_path_length == ~size_t(0) ? "unlimited" : pretty_uint(m_photon_tracing_rr_min_path_length).c_str());
+        m_photon_tracing_rr_min_path_length == ~size_t(0) ? "unlimited" : pretty_uint(m_photon_tracing_rr_min_path_length).c_str(),
+        m_enable_importance_emission
+            ? ("on (" + pretty_percent(m_importance_emission_fraction, 1.0f, 1) + " guided)").c_str()
+            : "off");
 
     RENDERER_LOG_INFO(
         "sppm path tracing settings:\n"
@@ -159,6 +185,7 @@ void SPPMParameters::print() const
         "  initial radius                %s%%\n"
         "  alpha                         %s\n"
         "  max photons per estimate      %s\n"
+        "  photon map                    %s\n"
         "  dl light samples              %s\n"
         "  dl light threshold            %s",
         m_path_tracing_max_bounces == ~size_t(0) ? "unlimited" : pretty_uint(m_path_tracing_max_bounces).c_str(),
@@ -167,6 +194,7 @@ void SPPMParameters::print() const
         pretty_scalar(m_initial_radius_percents, 3).c_str(),
         pretty_scalar(m_alpha, 1).c_str(),
         pretty_uint(m_max_photons_per_estimate).c_str(),
+        m_photon_map_type == KdTree ? "kd-tree" : "hash grid",
         pretty_scalar(m_dl_light_sample_count).c_str(),
         pretty_scalar(m_dl_low_light_threshold, 3).c_str());
 }
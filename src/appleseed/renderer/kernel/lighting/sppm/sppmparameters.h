@@ -45,6 +45,7 @@ struct SPPMParameters
 {
     enum PhotonType { Monochromatic, Polychromatic };
     enum Mode { RayTraced, SPPM, Off };
+    enum PhotonMapType { KdTree, HashGrid };
 
     const Spectrum::Mode        m_spectrum_mode;
     const SamplingContext::Mode m_sampling_mode;
@@ -54,6 +55,7 @@ struct SPPMParameters
     const Mode                  m_dl_mode;                              // direct lighting mode
     const bool                  m_enable_ibl;                           // is image-based lighting enabled?
     const bool                  m_enable_caustics;                      // are caustics enabled?
+    const bool                  m_caustic_photons_only;                 // only store photons at the end of glossy and specular chains?
 
     const size_t                m_light_photon_count;                   // number of photons emitted from the lights
     const size_t                m_env_photon_count;                     // number of photons emitted from the environment
@@ -61,6 +63,8 @@ struct SPPMParameters
 
     const size_t                m_photon_tracing_max_bounces;           // maximum number of photon bounces, ~0 for unlimited
     const size_t                m_photon_tracing_rr_min_path_length;    // minimum photon tracing path length before Russian Roulette kicks in, ~0 for unlimited
+    const bool                  m_enable_importance_emission;           // emit more photons toward the regions seen by the camera?
+    const float                 m_importance_emission_fraction;         // fraction of photons emitted according to the learned distribution
 
     const size_t                m_path_tracing_max_bounces;             // maximum number of path bounces, ~0 for unlimited
     const size_t                m_path_tracing_rr_min_path_length;      // minimum path tracing path length before Russian Roulette kicks in, ~0 for unlimited
@@ -73,6 +77,7 @@ struct SPPMParameters
     const float                 m_initial_radius_percents;              // initial lookup radius as a percentage of the scene diameter
     const float                 m_alpha;                                // radius shrinking control
     const size_t                m_max_photons_per_estimate;             // maximum number of photons per density estimation
+    const PhotonMapType         m_photon_map_type;                      // data structure used to look up photons
     const float                 m_dl_light_sample_count;                // number of light samples used to estimate direct illumination in ray traced mode
     const float                 m_dl_low_light_threshold;               // light contribution threshold to disable shadow rays
     float                       m_rcp_dl_light_sample_count;
@@ -59,6 +59,14 @@ namespace renderer
 // SPPMPassCallback class implementation.
 //
 
+namespace
+{
+    // Size of the cells of the visibility grid, relative to the lookup radius.
+    // Cells larger than the lookup disks also catch photons that fall next to a
+    // camera vertex.
+    const float VisibilityCellSizeFactor = 2.0f;
+}
+
 SPPMPassCallback::SPPMPassCallback(
     const Scene&                    scene,
     const ForwardLightSampler&      light_sampler,
@@ -77,6 +85,7 @@ SPPMPassCallback::SPPMPassCallback(
         shading_system,
         params)
   , m_pass_number(0)
+  , m_photons_memory_record(MemoryTagPhotons)
 {
     // Compute the initial lookup radius.
     const GAABB3 scene_bbox = scene.compute_bbox();
@@ -86,6 +95,10 @@ SPPMPassCallback::SPPMPassCallback(
 
     // Start with the initial lookup radius.
     m_lookup_radius = m_initial_lookup_radius;
+
+    // Camera paths record the regions they see so that the photon tracer can learn where to emit photons.
+    if (m_params.m_enable_importance_emission && m_initial_lookup_radius > 0.0f)
+        m_visibility_grid.reset(new SPPMVisibilityGrid());
 }
 
 void SPPMPassCallback::release()
@@ -113,16 +126,28 @@ void SPPMPassCallback::on_pass_begin(
     m_photons.clear_keep_memory();
     m_photon_tracer.trace_photons(
         m_photons,
+        m_visibility_grid.get(),
         pass_hash,
         job_queue,
         abort_switch);
 
+    m_photons_memory_record.set(m_photons.get_memory_size());
+
     // Stop there if rendering was aborted.
     if (abort_switch.is_aborted())
         return;
 
+    // Camera paths of this pass will mark the cells they see.
+    if (m_visibility_grid)
+        m_visibility_grid->clear(VisibilityCellSizeFactor * m_lookup_radius);
+
     // Build a new photon map.
-    m_photon_map.reset(new SPPMPhotonMap(m_photons));
+    MemoryTagScope memory_tag_scope(MemoryTagPhotons);
+    m_photon_map.reset(
+        new SPPMPhotonMap(
+            m_photons,
+            m_params.m_photon_map_type,
+            m_lookup_radius));
 }
 
 void SPPMPassCallback::on_pass_end(
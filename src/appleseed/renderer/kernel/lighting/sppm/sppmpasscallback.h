@@ -34,6 +34,7 @@
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
 #include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
 #include "renderer/kernel/lighting/sppm/sppmphotontracer.h"
+#include "renderer/kernel/lighting/sppm/sppmvisibilitygrid.h"
 #include "renderer/kernel/rendering/ipasscallback.h"
 
 // appleseed.foundation headers.
@@ -41,6 +42,9 @@
 #include "foundation/platform/timers.h"
 #include "foundation/utility/stopwatch.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
 #include <cstddef>
 #include <memory>
@@ -102,12 +106,18 @@ class SPPMPassCallback
     // Return the current lookup radius.
     float get_lookup_radius() const;
 
+    // Return the grid into which camera paths record the regions they see during
+    // the current pass, or nullptr if importance-driven emission is disabled.
+    SPPMVisibilityGrid* get_visibility_grid() const;
+
   private:
     const SPPMParameters                m_params;
     SPPMPhotonTracer                    m_photon_tracer;
     size_t                              m_pass_number;
     SPPMPhotonVector                    m_photons;
+    TaggedMemoryRecord                  m_photons_memory_record;
     std::unique_ptr<SPPMPhotonMap>      m_photon_map;
+    std::unique_ptr<SPPMVisibilityGrid> m_visibility_grid;
     float                               m_initial_lookup_radius;
     float                               m_lookup_radius;
     foundation::Stopwatch<foundation::DefaultWallclockTimer>
@@ -139,4 +149,9 @@ inline float SPPMPassCallback::get_lookup_radius() const
     return m_lookup_radius;
 }
 
+inline SPPMVisibilityGrid* SPPMPassCallback::get_visibility_grid() const
+{
+    return m_visibility_grid.get();
+}
+
 }   // namespace renderer
@@ -33,7 +33,12 @@
 // appleseed.foundation headers.
 #include "foundation/utility/memory.h"
 
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -74,6 +79,13 @@ void SPPMPhotonVector::clear_keep_memory()
     foundation::clear_keep_memory(m_poly_photons);
 }
 
+void SPPMPhotonVector::clear_release_memory()
+{
+    foundation::clear_release_memory(m_positions);
+    foundation::clear_release_memory(m_mono_photons);
+    foundation::clear_release_memory(m_poly_photons);
+}
+
 void SPPMPhotonVector::reserve_mono_photons(const size_t capacity)
 {
     m_positions.reserve(capacity);
@@ -102,13 +114,28 @@ void SPPMPhotonVector::push_back(
     m_poly_photons.push_back(photon);
 }
 
-void SPPMPhotonVector::append(const SPPMPhotonVector& rhs)
+void SPPMPhotonVector::resize(
+    const size_t            mono_photon_count,
+    const size_t            poly_photon_count)
+{
+    m_positions.resize(mono_photon_count + poly_photon_count);
+    m_mono_photons.resize(mono_photon_count);
+    m_poly_photons.resize(poly_photon_count);
+}
+
+void SPPMPhotonVector::copy_at(
+    const SPPMPhotonVector& rhs,
+    const size_t            position_index,
+    const size_t            mono_photon_index,
+    const size_t            poly_photon_index)
 {
-    boost::mutex::scoped_lock lock(m_mutex);
+    assert(position_index + rhs.m_positions.size() <= m_positions.size());
+    assert(mono_photon_index + rhs.m_mono_photons.size() <= m_mono_photons.size());
+    assert(poly_photon_index + rhs.m_poly_photons.size() <= m_poly_photons.size());
 
-    m_positions.insert(m_positions.end(), rhs.m_positions.begin(), rhs.m_positions.end());
-    m_mono_photons.insert(m_mono_photons.end(), rhs.m_mono_photons.begin(), rhs.m_mono_photons.end());
-    m_poly_photons.insert(m_poly_photons.end(), rhs.m_poly_photons.begin(), rhs.m_poly_photons.end());
+    copy(rhs.m_positions.begin(), rhs.m_positions.end(), m_positions.begin() + position_index);
+    copy(rhs.m_mono_photons.begin(), rhs.m_mono_photons.end(), m_mono_photons.begin() + mono_photon_index);
+    copy(rhs.m_poly_photons.begin(), rhs.m_poly_photons.end(), m_poly_photons.begin() + poly_photon_index);
 }
 
 }   // namespace renderer
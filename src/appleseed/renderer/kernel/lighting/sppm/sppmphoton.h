@@ -34,7 +34,6 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/vector.h"
-#include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
@@ -86,7 +85,6 @@ class SPPMPhotonVector
     std::vector<foundation::Vector3f>   m_positions;
     std::vector<SPPMMonoPhoton>         m_mono_photons;
     std::vector<SPPMPolyPhoton>         m_poly_photons;
-    boost::mutex                        m_mutex;
 
     bool empty() const;
     size_t size() const;
@@ -96,6 +94,7 @@ class SPPMPhotonVector
 
     void swap(SPPMPhotonVector& rhs);
     void clear_keep_memory();
+    void clear_release_memory();
     void reserve_mono_photons(const size_t capacity);
     void reserve_poly_photons(const size_t capacity);
     void push_back(
@@ -105,8 +104,19 @@ class SPPMPhotonVector
         const foundation::Vector3f&     position,
         const SPPMPolyPhoton&           photon);
 
-    // The only thread-safe method of this class.
-    void append(const SPPMPhotonVector& rhs);
+    // Resize this vector to hold a given number of monochromatic and polychromatic photons.
+    void resize(
+        const size_t                    mono_photon_count,
+        const size_t                    poly_photon_count);
+
+    // Copy the photons of another vector into this one, starting at given indices.
+    // The photons must fit. Concurrent calls are safe as long as they write to
+    // disjoint ranges of photons.
+    void copy_at(
+        const SPPMPhotonVector&         rhs,
+        const size_t                    position_index,
+        const size_t                    mono_photon_index,
+        const size_t                    poly_photon_index);
 };
 
 }   // namespace renderer
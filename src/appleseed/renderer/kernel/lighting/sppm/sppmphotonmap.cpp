@@ -35,48 +35,249 @@
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/distance.h"
+#include "foundation/math/scalar.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/system.h"
+#include "foundation/utility/memory.h"
 #include "foundation/utility/statistics.h"
+#include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <string>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
-SPPMPhotonMap::SPPMPhotonMap(SPPMPhotonVector& photons)
+//
+// SPPMPhotonMap class implementation.
+//
+
+SPPMPhotonMap::SPPMPhotonMap(
+    SPPMPhotonVector&                   photons,
+    const SPPMParameters::PhotonMapType type,
+    const float                         lookup_radius)
+  : m_type(type)
+  , m_rcp_cell_size(0.0f)
+  , m_bucket_mask(0)
 {
     const size_t photon_count = photons.size();
 
-    if (photon_count > 0)
+    if (photon_count == 0)
     {
-        RENDERER_LOG_INFO(
-            "building sppm photon map from %s %s...",
-            pretty_uint(photon_count).c_str(),
-            photon_count > 1 ? "photons" : "photon");
+        RENDERER_LOG_WARNING(
+            "cannot build sppm photon map because no photon were stored by the photon tracing pass.");
+        return;
+    }
+
+    // The hash grid needs a lookup radius to size its cells.
+    if (lookup_radius <= 0.0f)
+        m_type = SPPMParameters::KdTree;
+
+    RENDERER_LOG_INFO(
+        "building sppm photon %s from %s %s...",
+        m_type == SPPMParameters::KdTree ? "kd-tree" : "hash grid",
+        pretty_uint(photon_count).c_str(),
+        photon_count > 1 ? "photons" : "photon");
 
-        knn::Builder3f builder(*this);
+    Statistics statistics;
+    const size_t photon_data_size = photons.get_memory_size();
+
+    if (m_type == SPPMParameters::KdTree)
+    {
+        knn::Builder3f builder(m_tree, System::get_logical_cpu_core_count());
         builder.build_move_points<DefaultWallclockTimer>(photons.m_positions);
 
-        Statistics statistics;
         statistics.insert_time("build time", builder.get_build_time());
-        statistics.insert_size("size", photons.get_memory_size());
-        statistics.merge(knn::TreeStatistics<knn::Tree3f>(*this));
-
-        RENDERER_LOG_DEBUG("%s",
-            StatisticsVector::make(
-                "sppm photon map statistics",
-                statistics).to_string().c_str());
+        statistics.insert_size("size", photon_data_size);
+        statistics.merge(knn::TreeStatistics<knn::Tree3f>(m_tree));
     }
     else
     {
-        RENDERER_LOG_WARNING(
-            "cannot build sppm photon map because no photon were stored by the photon tracing pass.");
+        Stopwatch<DefaultWallclockTimer> stopwatch;
+        stopwatch.start();
+
+        build_hash_grid(photons.m_positions, lookup_radius);
+
+        stopwatch.measure();
+
+        statistics.insert_time("build time", stopwatch.get_seconds());
+        statistics.insert_size(
+            "size",
+            photon_data_size +
+            m_bucket_begin.capacity() * sizeof(uint32) +
+            m_indices.capacity() * sizeof(uint32));
+        statistics.insert("buckets", m_bucket_begin.size() - 1);
+        statistics.insert("cell size", lookup_radius);
     }
+
+    RENDERER_LOG_DEBUG("%s",
+        StatisticsVector::make(
+            "sppm photon map statistics",
+            statistics).to_string().c_str());
+}
+
+void SPPMPhotonMap::build_hash_grid(
+    vector<Vector3f>&                   positions,
+    const float                         cell_size)
+{
+    const size_t photon_count = positions.size();
+    assert(photon_count < ~uint32(0));
+
+    m_rcp_cell_size = 1.0f / cell_size;
+
+    // Use about one bucket per photon.
+    const uint32 bucket_count = next_pow2(static_cast<uint32>(photon_count));
+    m_bucket_mask = bucket_count - 1;
+
+    // Count the photons of each bucket.
+    vector<uint32> photon_buckets(photon_count);
+    m_bucket_begin.assign(bucket_count + 1, 0);
+    for (size_t i = 0; i < photon_count; ++i)
+    {
+        const uint32 bucket = hash_cell(compute_cell(positions[i]));
+        photon_buckets[i] = bucket;
+        ++m_bucket_begin[bucket + 1];
+    }
+
+    // Compute the index of the first photon of each bucket.
+    for (uint32 b = 0; b < bucket_count; ++b)
+        m_bucket_begin[b + 1] += m_bucket_begin[b];
+
+    // Sort the photons by bucket.
+    vector<uint32> bucket_end(m_bucket_begin.begin(), m_bucket_begin.end() - 1);
+    m_points.resize(photon_count);
+    m_indices.resize(photon_count);
+    for (size_t i = 0; i < photon_count; ++i)
+    {
+        const uint32 j = bucket_end[photon_buckets[i]]++;
+        m_points[j] = positions[i];
+        m_indices[j] = static_cast<uint32>(i);
+    }
+
+    clear_release_memory(positions);
+}
+
+namespace
+{
+    // Insert a photon into an answer, keeping the closest ones once the answer is full.
+    inline void insert_photon(
+        knn::Answer<float>&             answer,
+        const size_t                    max_answer_size,
+        const uint32                    index,
+        const float                     square_dist,
+        float&                          query_max_square_dist)
+    {
+        if (answer.size() < max_answer_size)
+        {
+            answer.array_insert(index, square_dist);
+
+            if (answer.size() == max_answer_size)
+            {
+                answer.make_heap();
+                query_max_square_dist = answer.top().m_square_dist;
+            }
+        }
+        else
+        {
+            answer.heap_insert(index, square_dist);
+            query_max_square_dist = answer.top().m_square_dist;
+        }
+    }
+}
+
+void SPPMPhotonMap::query_hash_grid(
+    const Vector3f&                     point,
+    const float                         max_square_dist,
+    knn::Answer<float>&                 answer) const
+{
+    answer.clear();
+
+    if (m_points.empty())
+        return;
+
+    const float radius = sqrt(max_square_dist);
+    const Vector3i min_cell = compute_cell(point - Vector3f(radius));
+    const Vector3i max_cell = compute_cell(point + Vector3f(radius));
+
+    const size_t max_answer_size = answer.max_size();
+    float query_max_square_dist = max_square_dist;
+
+    // Lookups much larger than the cells would visit more cells than there are photons.
+    const Vector3d cell_range(max_cell - min_cell + Vector3i(1));
+    if (cell_range.x * cell_range.y * cell_range.z > static_cast<double>(m_points.size()))
+    {
+        for (uint32 i = 0, e = static_cast<uint32>(m_points.size()); i < e; ++i)
+        {
+            const float square_dist = square_distance(m_points[i], point);
+            if (square_dist >= query_max_square_dist)
+                continue;
+
+            insert_photon(answer, max_answer_size, i, square_dist, query_max_square_dist);
+        }
+
+        return;
+    }
+
+    for (int z = min_cell.z; z <= max_cell.z; ++z)
+    {
+        for (int y = min_cell.y; y <= max_cell.y; ++y)
+        {
+            for (int x = min_cell.x; x <= max_cell.x; ++x)
+            {
+                const Vector3i cell(x, y, z);
+                const uint32 bucket = hash_cell(cell);
+                const uint32 bucket_end = m_bucket_begin[bucket + 1];
+
+                for (uint32 i = m_bucket_begin[bucket]; i < bucket_end; ++i)
+                {
+                    const float square_dist = square_distance(m_points[i], point);
+                    if (square_dist >= query_max_square_dist)
+                        continue;
+
+                    // Several cells may share a bucket: only consider the photons of this cell
+                    // so that no photon is found twice.
+                    if (compute_cell(m_points[i]) != cell)
+                        continue;
+
+                    insert_photon(answer, max_answer_size, i, square_dist, query_max_square_dist);
+                }
+            }
+        }
+    }
+}
+
+inline Vector3i SPPMPhotonMap::compute_cell(const Vector3f& p) const
+{
+    return
+        Vector3i(
+            static_cast<int>(floor(p.x * m_rcp_cell_size)),
+            static_cast<int>(floor(p.y * m_rcp_cell_size)),
+            static_cast<int>(floor(p.z * m_rcp_cell_size)));
+}
+
+inline uint32 SPPMPhotonMap::hash_cell(const Vector3i& cell) const
+{
+    // Reference:
+    //
+    //   Optimized Spatial Hashing for Collision Detection of Deformable Objects
+    //   Matthias Teschner, Bruno Heidelberger, Matthias Mueller, Danat Pomeranets, Markus Gross
+    //   Vision, Modeling, and Visualization 2003
+    //
+
+    const uint32 h =
+        (static_cast<uint32>(cell.x) * 73856093u) ^
+        (static_cast<uint32>(cell.y) * 19349663u) ^
+        (static_cast<uint32>(cell.z) * 83492791u);
+
+    return h & m_bucket_mask;
 }
 
 }   // namespace renderer
@@ -29,8 +29,18 @@
 
 #pragma once
 
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/knn.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
 
 // Forward declarations.
 namespace renderer  { class SPPMPhotonVector; }
@@ -38,12 +48,90 @@ namespace renderer  { class SPPMPhotonVector; }
 namespace renderer
 {
 
+//
+// A photon map.
+//
+// Photons are either stored in a kd-tree or in a spatial hash grid whose cells are
+// as large as the lookup radius. The hash grid is faster to build and to query with
+// that radius; larger lookups remain correct but visit more cells.
+//
+
 class SPPMPhotonMap
-  : public foundation::knn::Tree3f
+  : public foundation::NonCopyable
 {
   public:
     // Constructor, *moves* the photon positions into the map.
-    explicit SPPMPhotonMap(SPPMPhotonVector& photons);
+    SPPMPhotonMap(
+        SPPMPhotonVector&                   photons,
+        const SPPMParameters::PhotonMapType type,
+        const float                         lookup_radius);
+
+    // Return true if the map does not contain any photon.
+    bool empty() const;
+
+    // Transform an internal index, as found in query answers, to a photon index.
+    size_t remap(const size_t i) const;
+
+    // Find the photons closest to a given point, strictly within a given distance,
+    // up to the capacity of the answer.
+    void query(
+        const foundation::Vector3f&         point,
+        const float                         max_square_dist,
+        foundation::knn::Answer<float>&     answer) const;
+
+  private:
+    SPPMParameters::PhotonMapType           m_type;
+
+    // Kd-tree.
+    foundation::knn::Tree3f                 m_tree;
+
+    // Hash grid.
+    float                                   m_rcp_cell_size;
+    foundation::uint32                      m_bucket_mask;
+    std::vector<foundation::uint32>         m_bucket_begin;     // photons of bucket b are [m_bucket_begin[b], m_bucket_begin[b + 1])
+    std::vector<foundation::Vector3f>       m_points;           // photon positions, sorted by bucket
+    std::vector<foundation::uint32>         m_indices;          // photon indices, sorted by bucket
+
+    void build_hash_grid(
+        std::vector<foundation::Vector3f>&  positions,
+        const float                         cell_size);
+
+    void query_hash_grid(
+        const foundation::Vector3f&         point,
+        const float                         max_square_dist,
+        foundation::knn::Answer<float>&     answer) const;
+
+    foundation::Vector3i compute_cell(const foundation::Vector3f& p) const;
+
+    foundation::uint32 hash_cell(const foundation::Vector3i& cell) const;
 };
 
+
+//
+// SPPMPhotonMap class implementation.
+//
+
+inline bool SPPMPhotonMap::empty() const
+{
+    return m_type == SPPMParameters::KdTree ? m_tree.empty() : m_points.empty();
+}
+
+inline size_t SPPMPhotonMap::remap(const size_t i) const
+{
+    return m_type == SPPMParameters::KdTree ? m_tree.remap(i) : m_indices[i];
+}
+
+inline void SPPMPhotonMap::query(
+    const foundation::Vector3f&             point,
+    const float                             max_square_dist,
+    foundation::knn::Answer<float>&         answer) const
+{
+    if (m_type == SPPMParameters::KdTree)
+    {
+        const foundation::knn::Query3f query(m_tree, answer);
+        query.run(point, max_square_dist);
+    }
+    else query_hash_grid(point, max_square_dist, answer);
+}
+
 }   // namespace renderer
@@ -35,6 +35,7 @@
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/kernel/lighting/sppm/sppmphoton.h"
+#include "renderer/kernel/lighting/sppm/sppmvisibilitygrid.h"
 #include "renderer/kernel/lighting/forwardlightsampler.h"
 #include "renderer/kernel/lighting/pathtracer.h"
 #include "renderer/kernel/lighting/pathvertex.h"
@@ -101,20 +102,25 @@ namespace
         const bool                  m_store_indirect;
         const bool                  m_store_caustics;
         SPPMPhotonVector&           m_photons;
+        const SPPMVisibilityGrid*   m_visibility_grid;
+        bool                        m_useful;           // was a photon stored in a region seen by the camera?
 
         PathVisitor(
-            const Spectrum&         initial_flux,
-            const SPPMParameters&   params,
-            const bool              store_direct,
-            const bool              store_indirect,
-            const bool              store_caustics,
-            SPPMPhotonVector&       photons)
+            const Spectrum&             initial_flux,
+            const SPPMParameters&       params,
+            const bool                  store_direct,
+            const bool                  store_indirect,
+            const bool                  store_caustics,
+            SPPMPhotonVector&           photons,
+            const SPPMVisibilityGrid*   visibility_grid)
           : m_initial_flux(initial_flux)
           , m_params(params)
           , m_store_direct(store_direct)
           , m_store_indirect(store_indirect)
           , m_store_caustics(store_caustics)
           , m_photons(photons)
+          , m_visibility_grid(visibility_grid)
+          , m_useful(false)
         {
         }
 
@@ -139,6 +145,10 @@ namespace
                     return false;
             }
 
+            // Caustic photons only follow glossy and specular bounces.
+            if (m_params.m_caustic_photons_only && !ScatteringMode::has_glossy_or_specular(next_mode))
+                return false;
+
             return true;
         }
 
@@ -159,6 +169,9 @@ namespace
                 if (vertex.m_bsdf->is_purely_specular())
                     return;
 
+                if (m_visibility_grid && !m_useful)
+                    m_useful = m_visibility_grid->contains(Vector3f(vertex.get_point()));
+
                 if (m_params.m_photon_type == SPPMParameters::Monochromatic)
                 {
                     // Choose a wavelength at random.
@@ -204,10 +217,17 @@ namespace
 
     struct VolumeVisitor
     {
+        const bool                  m_accept_scattering;
+
+        explicit VolumeVisitor(const bool accept_scattering)
+          : m_accept_scattering(accept_scattering)
+        {
+        }
+
         bool accept_scattering(
             const ScatteringMode::Mode  prev_mode)
         {
-            return true;
+            return m_accept_scattering;
         }
 
         void on_scatter(PathVertex& vertex)
@@ -236,7 +256,10 @@ namespace
             OIIOTextureSystem&              oiio_texture_system,
             OSLShadingSystem&               shading_system,
             const SPPMParameters&           params,
-            SPPMPhotonVector&               global_photons,
+            SPPMPhotonVector&               photons,
+            const SPPMEmissionGuide*        guide,
+            const SPPMVisibilityGrid*       visibility_grid,
+            SPPMEmissionGuide::Statistics*  statistics,
             const size_t                    photon_begin,
             const size_t                    photon_end,
             const uint32                    pass_hash,
@@ -256,7 +279,10 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_photons(photons)
+          , m_guide(guide)
+          , m_visibility_grid(visibility_grid)
+          , m_statistics(statistics)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -301,8 +327,6 @@ namespace
                 SamplingContext child_sampling_context(sampling_context);
                 trace_light_photon(shading_context, child_sampling_context, light_sample_s);
             }
-
-            m_global_photons.append(m_local_photons);
         }
 
       private:
@@ -316,12 +340,14 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_photons;
+        const SPPMEmissionGuide*    m_guide;
+        const SPPMVisibilityGrid*   m_visibility_grid;
+        SPPMEmissionGuide::Statistics* m_statistics;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const uint32                m_pass_hash;
         IAbortSwitch&               m_abort_switch;
-        SPPMPhotonVector            m_local_photons;
         float                       m_shutter_open_begin_time;
         float                       m_shutter_close_end_time;
 
@@ -330,13 +356,21 @@ namespace
             SamplingContext&        sampling_context,
             const Vector4f&         light_sample_s)
         {
+            // Let the emission guide choose the light.
+            float light_selection_s = light_sample_s[1];
+            size_t light_bin = 0;
+            const float guide_density =
+                m_guide != nullptr
+                    ? m_guide->sample_light(light_selection_s, light_bin)
+                    : 1.0f;
+
             LightSample light_sample;
             m_light_sampler.sample(
                 ShadingRay::Time::create_with_normalized_time(
                     light_sample_s[0],
                     m_shutter_open_begin_time,
                     m_shutter_close_end_time),
-                Vector3f(light_sample_s[1], light_sample_s[2], light_sample_s[3]),
+                Vector3f(light_selection_s, light_sample_s[2], light_sample_s[3]),
                 light_sample);
 
             if (light_sample.m_shape)
@@ -344,21 +378,27 @@ namespace
                 trace_emitting_shape_photon(
                     shading_context,
                     sampling_context,
-                    light_sample);
+                    light_sample,
+                    light_bin,
+                    guide_density);
             }
             else
             {
                 trace_non_physical_light_photon(
                     shading_context,
                     sampling_context,
-                    light_sample);
+                    light_sample,
+                    light_bin,
+                    guide_density);
             }
         }
 
         void trace_emitting_shape_photon(
             const ShadingContext&   shading_context,
             SamplingContext&        sampling_context,
-            LightSample&            light_sample)
+            LightSample&            light_sample,
+            const size_t            light_bin,
+            float                   guide_density)
         {
             // Make sure the geometric normal of the light sample is in the same hemisphere as the shading normal.
             light_sample.m_geometric_normal =
@@ -386,6 +426,10 @@ namespace
 
             // Sample the EDF.
             sampling_context.split_in_place(2, 1);
+            Vector2f edf_s = sampling_context.next2<Vector2f>();
+            size_t bin = 0;
+            if (m_guide != nullptr)
+                guide_density *= m_guide->sample_direction(light_bin, edf_s, bin);
             Vector3f emission_direction;
             Spectrum edf_value(Spectrum::Illuminance);
             float edf_prob;
@@ -394,7 +438,7 @@ namespace
                 edf->evaluate_inputs(shading_context, light_shading_point),
                 Vector3f(light_sample.m_geometric_normal),
                 Basis3f(Vector3f(light_sample.m_shading_normal)),
-                sampling_context.next2<Vector2f>(),
+                edf_s,
                 emission_direction,
                 edf_value,
                 edf_prob);
@@ -403,7 +447,7 @@ namespace
             Spectrum initial_flux = edf_value;
             initial_flux *=
                 dot(emission_direction, Vector3f(light_sample.m_shading_normal)) /
-                (light_sample.m_probability * edf_prob * m_params.m_light_photon_count);
+                (light_sample.m_probability * edf_prob * guide_density * m_params.m_light_photon_count);
 
             // Make a shading point that will be used to avoid self-intersections with the light sample.
             ShadingPoint parent_shading_point;
@@ -429,11 +473,12 @@ namespace
             PathVisitor path_visitor(
                 initial_flux,
                 m_params,
-                m_params.m_dl_mode == SPPMParameters::SPPM, // store direct lighting photons?
+                m_params.m_dl_mode == SPPMParameters::SPPM && !m_params.m_caustic_photons_only,    // store direct lighting photons?
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
-            VolumeVisitor volume_visitor;
+                m_photons,
+                m_visibility_grid);
+            VolumeVisitor volume_visitor(!m_params.m_caustic_photons_only);
             PathTracer<PathVisitor, VolumeVisitor, true> path_tracer(      // true = adjoint
                 path_visitor,
                 volume_visitor,
@@ -449,22 +494,36 @@ namespace
 
             // Trace the photon path.
             path_tracer.trace(sampling_context, shading_context, ray, &parent_shading_point);
+
+            // Remember whether the photon path reached a region seen by the camera.
+            if (m_statistics != nullptr)
+                m_statistics->insert(bin, path_visitor.m_useful);
         }
 
         void trace_non_physical_light_photon(
             const ShadingContext&   shading_context,
             SamplingContext&        sampling_context,
-            const LightSample&      light_sample)
+            const LightSample&      light_sample,
+            const size_t            light_bin,
+            float                   guide_density)
         {
             // Sample the light.
             sampling_context.split_in_place(2, 1);
+            Vector2d light_s = sampling_context.next2<Vector2d>();
+            size_t bin = 0;
+            if (m_guide != nullptr)
+            {
+                Vector2f guided_light_s(light_s);
+                guide_density *= m_guide->sample_direction(light_bin, guided_light_s, bin);
+                light_s = Vector2d(guided_light_s);
+            }
             Vector3d emission_position, emission_direction;
             Spectrum light_value(Spectrum::Illuminance);
             float light_prob;
             light_sample.m_light->sample(
                 shading_context,
                 light_sample.m_light_transform,
-                sampling_context.next2<Vector2d>(),
+                light_s,
                 m_photon_targets,
                 emission_position,
                 emission_direction,
@@ -473,7 +532,7 @@ namespace
 
             // Compute the initial particle weight.
             Spectrum initial_flux = light_value;
-            initial_flux /= light_sample.m_probability * light_prob * m_params.m_light_photon_count;
+            initial_flux /= light_sample.m_probability * light_prob * guide_density * m_params.m_light_photon_count;
 
             // Build the photon ray.
             sampling_context.split_in_place(1, 1);
@@ -492,11 +551,12 @@ namespace
             PathVisitor path_visitor(
                 initial_flux,
                 m_params,
-                m_params.m_dl_mode == SPPMParameters::SPPM, // store direct lighting photons?
+                m_params.m_dl_mode == SPPMParameters::SPPM && !m_params.m_caustic_photons_only,    // store direct lighting photons?
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
-            VolumeVisitor volume_visitor;
+                m_photons,
+                m_visibility_grid);
+            VolumeVisitor volume_visitor(!m_params.m_caustic_photons_only);
             PathTracer<PathVisitor, VolumeVisitor, true> path_tracer(      // true = adjoint
                 path_visitor,
                 volume_visitor,
@@ -511,6 +571,10 @@ namespace
 
             // Trace the photon path.
             path_tracer.trace(sampling_context, shading_context, ray);
+
+            // Remember whether the photon path reached a region seen by the camera.
+            if (m_statistics != nullptr)
+                m_statistics->insert(bin, path_visitor.m_useful);
         }
     };
 
@@ -531,7 +595,10 @@ namespace
             OIIOTextureSystem&          oiio_texture_system,
             OSLShadingSystem&           shading_system,
             const SPPMParameters&       params,
-            SPPMPhotonVector&           global_photons,
+            SPPMPhotonVector&           photons,
+            const SPPMEmissionGuide*    guide,
+            const SPPMVisibilityGrid*   visibility_grid,
+            SPPMEmissionGuide::Statistics* statistics,
             const size_t                photon_begin,
             const size_t                photon_end,
             const uint32                pass_hash,
@@ -551,7 +618,10 @@ namespace
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
                 false)
-          , m_global_photons(global_photons)
+          , m_photons(photons)
+          , m_guide(guide)
+          , m_visibility_grid(visibility_grid)
+          , m_statistics(statistics)
           , m_photon_begin(photon_begin)
           , m_photon_end(photon_end)
           , m_pass_hash(pass_hash)
@@ -601,8 +671,6 @@ namespace
                 SamplingContext child_sampling_context(sampling_context);
                 trace_env_photon(shading_context, child_sampling_context, env_edf_s);
             }
-
-            m_global_photons.append(m_local_photons);
         }
 
       private:
@@ -616,12 +684,14 @@ namespace
         OSLShaderGroupExec          m_shadergroup_exec;
         const SPPMParameters        m_params;
         Tracer                      m_tracer;
-        SPPMPhotonVector&           m_global_photons;
+        SPPMPhotonVector&           m_photons;
+        const SPPMEmissionGuide*    m_guide;
+        const SPPMVisibilityGrid*   m_visibility_grid;
+        SPPMEmissionGuide::Statistics* m_statistics;
         const size_t                m_photon_begin;
         const size_t                m_photon_end;
         const uint32                m_pass_hash;
         IAbortSwitch&               m_abort_switch;
-        SPPMPhotonVector            m_local_photons;
         float                       m_shutter_open_begin_time;
         float                       m_shutter_close_end_time;
 
@@ -634,13 +704,21 @@ namespace
             SamplingContext&        sampling_context,
             const Vector2f&         env_edf_s)
         {
+            // Let the emission guide choose the emission direction.
+            Vector2f direction_s = env_edf_s;
+            size_t bin = 0;
+            const float guide_density =
+                m_guide != nullptr
+                    ? m_guide->sample_direction(0, direction_s, bin)
+                    : 1.0f;
+
             // Sample the environment.
             Vector3f outgoing;
             Spectrum env_edf_value(Spectrum::Illuminance);
             float env_edf_prob;
             m_env_edf.sample(
                 shading_context,
-                env_edf_s,
+                direction_s,
                 outgoing,   // points toward the environment
                 env_edf_value,
                 env_edf_prob);
@@ -681,7 +759,7 @@ namespace
 
             // Compute the initial particle weight.
             Spectrum initial_flux = env_edf_value;
-            initial_flux /= disk_point_prob * env_edf_prob * m_params.m_env_photon_count;
+            initial_flux /= disk_point_prob * env_edf_prob * guide_density * m_params.m_env_photon_count;
 
             // Build the photon ray.
             sampling_context.split_in_place(1, 1);
@@ -700,11 +778,12 @@ namespace
             PathVisitor path_visitor(
                 initial_flux,
                 m_params,
-                true,
+                !m_params.m_caustic_photons_only,           // store direct lighting photons?
                 cast_indirect_light,
                 m_params.m_enable_caustics,
-                m_local_photons);
-            VolumeVisitor volume_visitor;
+                m_photons,
+                m_visibility_grid);
+            VolumeVisitor volume_visitor(!m_params.m_caustic_photons_only);
             PathTracer<PathVisitor, VolumeVisitor, true> path_tracer(   // true = adjoint
                 path_visitor,
                 volume_visitor,
@@ -719,8 +798,55 @@ namespace
 
             // Trace the photon path.
             path_tracer.trace(sampling_context, shading_context, ray);
+
+            // Remember whether the photon path reached a region seen by the camera.
+            if (m_statistics != nullptr)
+                m_statistics->insert(bin, path_visitor.m_useful);
         }
     };
+
+
+    //
+    // A job that copies the photons stored by a photon tracing job into their final location.
+    //
+
+    class PhotonMergingJob
+      : public IJob
+    {
+      public:
+        PhotonMergingJob(
+            SPPMPhotonVector&           job_photons,
+            SPPMPhotonVector&           photons,
+            const size_t                position_index,
+            const size_t                mono_photon_index,
+            const size_t                poly_photon_index)
+          : m_job_photons(job_photons)
+          , m_photons(photons)
+          , m_position_index(position_index)
+          , m_mono_photon_index(mono_photon_index)
+          , m_poly_photon_index(poly_photon_index)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            m_photons.copy_at(
+                m_job_photons,
+                m_position_index,
+                m_mono_photon_index,
+                m_poly_photon_index);
+
+            // Don't keep a second copy of the photons around.
+            m_job_photons.clear_release_memory();
+        }
+
+      private:
+        SPPMPhotonVector&           m_job_photons;
+        SPPMPhotonVector&           m_photons;
+        const size_t                m_position_index;
+        const size_t                m_mono_photon_index;
+        const size_t                m_poly_photon_index;
+    };
 }
 
 
@@ -728,6 +854,14 @@ namespace
 // SPPMPhotonTracer class implementation.
 //
 
+namespace
+{
+    // Resolution of the learned emission distributions.
+    const size_t LightGuideLightBinCount = 32;
+    const size_t LightGuideDirectionBinCount = 8;
+    const size_t EnvGuideDirectionBinCount = 16;
+}
+
 SPPMPhotonTracer::SPPMPhotonTracer(
     const Scene&                scene,
     const ForwardLightSampler&  light_sampler,
@@ -746,6 +880,20 @@ SPPMPhotonTracer::SPPMPhotonTracer(
   , m_oiio_texture_system(oiio_texture_system)
   , m_shading_system(shading_system)
 {
+    if (m_params.m_enable_importance_emission)
+    {
+        m_light_guide.reset(
+            new SPPMEmissionGuide(
+                LightGuideLightBinCount,
+                LightGuideDirectionBinCount,
+                m_params.m_importance_emission_fraction));
+
+        m_env_guide.reset(
+            new SPPMEmissionGuide(
+                1,
+                EnvGuideDirectionBinCount,
+                m_params.m_importance_emission_fraction));
+    }
 }
 
 namespace
@@ -807,10 +955,11 @@ namespace
 }
 
 void SPPMPhotonTracer::trace_photons(
-    SPPMPhotonVector&       photons,
-    const uint32            pass_hash,
-    JobQueue&               job_queue,
-    IAbortSwitch&           abort_switch)
+    SPPMPhotonVector&           photons,
+    const SPPMVisibilityGrid*   visibility_grid,
+    const uint32                pass_hash,
+    JobQueue&                   job_queue,
+    IAbortSwitch&               abort_switch)
 {
     // Start stopwatch.
     Stopwatch<DefaultWallclockTimer> stopwatch;
@@ -823,25 +972,47 @@ void SPPMPhotonTracer::trace_photons(
         Transformd::identity(),
         photon_targets);
 
+    // Each photon tracing job stores its photons into its own vector; that vector
+    // must not move once the jobs are scheduled.
+    const bool trace_light_photons = m_light_sampler.has_lights();
+    const bool trace_env_photons = m_params.m_enable_ibl && m_scene.get_environment()->get_environment_edf();
+    const size_t packet_size = m_params.m_photon_packet_size;
+    const size_t light_job_count = trace_light_photons ? (m_params.m_light_photon_count + packet_size - 1) / packet_size : 0;
+    const size_t env_job_count = trace_env_photons ? (m_params.m_env_photon_count + packet_size - 1) / packet_size : 0;
+    m_job_photons.clear();
+    m_job_photons.resize(light_job_count + env_job_count);
+
+    // Photon paths can only be rated once the camera has seen part of the scene.
+    if (!m_light_guide || (visibility_grid && visibility_grid->empty()))
+        visibility_grid = nullptr;
+
+    // Each job counts how many of the photons it emits from each bin of the emission guides are useful.
+    m_job_statistics.clear();
+    if (visibility_grid)
+    {
+        m_job_statistics.resize(light_job_count, SPPMEmissionGuide::Statistics(m_light_guide->get_bin_count()));
+        m_job_statistics.resize(light_job_count + env_job_count, SPPMEmissionGuide::Statistics(m_env_guide->get_bin_count()));
+    }
+
     // Schedule photon tracing jobs.
     size_t job_count = 0;
     size_t emitted_photon_count = 0;
-    if (m_light_sampler.has_lights())
+    if (trace_light_photons)
     {
         schedule_light_photon_tracing_jobs(
             photon_targets,
-            photons,
+            visibility_grid,
             pass_hash,
             job_queue,
             job_count,
             emitted_photon_count,
             abort_switch);
     }
-    if (m_params.m_enable_ibl && m_scene.get_environment()->get_environment_edf())
+    if (trace_env_photons)
     {
         schedule_environment_photon_tracing_jobs(
             photon_targets,
-            photons,
+            visibility_grid,
             pass_hash,
             job_queue,
             job_count,
@@ -851,6 +1022,43 @@ void SPPMPhotonTracer::trace_photons(
 
     // Wait until the photon tracing jobs have completed.
     job_queue.wait_until_completion();
+    assert(job_count == m_job_photons.size());
+
+    // Gather the photons of all jobs.
+    merge_photons(photons, job_queue);
+
+    // Learn where to emit photons in the next passes.
+    size_t traced_photon_count = 0;
+    size_t useful_photon_count = 0;
+    if (!m_job_statistics.empty() && !abort_switch.is_aborted())
+    {
+        SPPMEmissionGuide::Statistics light_statistics(m_light_guide->get_bin_count());
+        for (size_t i = 0; i < light_job_count; ++i)
+            light_statistics.merge(m_job_statistics[i]);
+
+        SPPMEmissionGuide::Statistics env_statistics(m_env_guide->get_bin_count());
+        for (size_t i = light_job_count; i < light_job_count + env_job_count; ++i)
+            env_statistics.merge(m_job_statistics[i]);
+
+        for (size_t i = 0, e = light_statistics.m_traced_photons.size(); i < e; ++i)
+        {
+            traced_photon_count += light_statistics.m_traced_photons[i];
+            useful_photon_count += light_statistics.m_useful_photons[i];
+        }
+
+        for (size_t i = 0, e = env_statistics.m_traced_photons.size(); i < e; ++i)
+        {
+            traced_photon_count += env_statistics.m_traced_photons[i];
+            useful_photon_count += env_statistics.m_useful_photons[i];
+        }
+
+        if (light_job_count > 0)
+            m_light_guide->update(light_statistics);
+
+        if (env_job_count > 0)
+            m_env_guide->update(env_statistics);
+    }
+    m_job_statistics.clear();
 
     // Update photon tracing statistics.
     m_total_emitted_photon_count += emitted_photon_count;
@@ -866,6 +1074,14 @@ void SPPMPhotonTracer::trace_photons(
         pretty_uint(m_total_stored_photon_count) + " (" +
         pretty_percent(m_total_stored_photon_count, m_total_emitted_photon_count) +
         ")");
+    if (traced_photon_count > 0)
+    {
+        statistics.insert(
+            "useful emitted",
+            pretty_uint(useful_photon_count) + " (" +
+            pretty_percent(useful_photon_count, traced_photon_count) +
+            ")");
+    }
     RENDERER_LOG_DEBUG("%s",
         StatisticsVector::make(
             "sppm photon tracing statistics",
@@ -873,13 +1089,13 @@ void SPPMPhotonTracer::trace_photons(
 }
 
 void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
-    const LightTargetArray& photon_targets,
-    SPPMPhotonVector&       photons,
-    const uint32            pass_hash,
-    JobQueue&               job_queue,
-    size_t&                 job_count,
-    size_t&                 emitted_photon_count,
-    IAbortSwitch&           abort_switch)
+    const LightTargetArray&     photon_targets,
+    const SPPMVisibilityGrid*   visibility_grid,
+    const uint32                pass_hash,
+    JobQueue&                   job_queue,
+    size_t&                     job_count,
+    size_t&                     emitted_photon_count,
+    IAbortSwitch&               abort_switch)
 {
     RENDERER_LOG_INFO(
         "tracing %s sppm light %s...",
@@ -901,7 +1117,10 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                m_job_photons[job_count],
+                m_light_guide.get(),
+                visibility_grid,
+                m_job_statistics.empty() ? nullptr : &m_job_statistics[job_count],
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -913,13 +1132,13 @@ void SPPMPhotonTracer::schedule_light_photon_tracing_jobs(
 }
 
 void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
-    const LightTargetArray& photon_targets,
-    SPPMPhotonVector&       photons,
-    const uint32            pass_hash,
-    JobQueue&               job_queue,
-    size_t&                 job_count,
-    size_t&                 emitted_photon_count,
-    IAbortSwitch&           abort_switch)
+    const LightTargetArray&     photon_targets,
+    const SPPMVisibilityGrid*   visibility_grid,
+    const uint32                pass_hash,
+    JobQueue&                   job_queue,
+    size_t&                     job_count,
+    size_t&                     emitted_photon_count,
+    IAbortSwitch&               abort_switch)
 {
     RENDERER_LOG_INFO(
         "tracing %s sppm environment %s...",
@@ -940,7 +1159,10 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
                 m_oiio_texture_system,
                 m_shading_system,
                 m_params,
-                photons,
+                m_job_photons[job_count],
+                m_env_guide.get(),
+                visibility_grid,
+                m_job_statistics.empty() ? nullptr : &m_job_statistics[job_count],
                 photon_begin,
                 photon_end,
                 pass_hash,
@@ -951,4 +1173,49 @@ void SPPMPhotonTracer::schedule_environment_photon_tracing_jobs(
     }
 }
 
+void SPPMPhotonTracer::merge_photons(
+    SPPMPhotonVector&       photons,
+    JobQueue&               job_queue)
+{
+    size_t mono_photon_count = 0;
+    size_t poly_photon_count = 0;
+
+    for (size_t i = 0, e = m_job_photons.size(); i < e; ++i)
+    {
+        mono_photon_count += m_job_photons[i].m_mono_photons.size();
+        poly_photon_count += m_job_photons[i].m_poly_photons.size();
+    }
+
+    photons.resize(mono_photon_count, poly_photon_count);
+
+    // Each job writes to its own range of photons: no locking is needed.
+    size_t position_index = 0;
+    size_t mono_photon_index = 0;
+    size_t poly_photon_index = 0;
+
+    for (size_t i = 0, e = m_job_photons.size(); i < e; ++i)
+    {
+        SPPMPhotonVector& job_photons = m_job_photons[i];
+
+        if (job_photons.empty())
+            continue;
+
+        job_queue.schedule(
+            new PhotonMergingJob(
+                job_photons,
+                photons,
+                position_index,
+                mono_photon_index,
+                poly_photon_index));
+
+        position_index += job_photons.size();
+        mono_photon_index += job_photons.m_mono_photons.size();
+        poly_photon_index += job_photons.m_poly_photons.size();
+    }
+
+    job_queue.wait_until_completion();
+
+    m_job_photons.clear();
+}
+
 }   // namespace renderer
@@ -30,7 +30,9 @@
 #pragma once
 
 // appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmemissionguide.h"
 #include "renderer/kernel/lighting/sppm/sppmparameters.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
@@ -38,6 +40,8 @@
 
 // Standard headers.
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -47,7 +51,7 @@ namespace renderer      { class LightTargetArray; }
 namespace renderer      { class OIIOTextureSystem; }
 namespace renderer      { class OSLShadingSystem; }
 namespace renderer      { class Scene; }
-namespace renderer      { class SPPMPhotonVector; }
+namespace renderer      { class SPPMVisibilityGrid; }
 namespace renderer      { class TextureStore; }
 namespace renderer      { class TraceContext; }
 
@@ -67,8 +71,12 @@ class SPPMPhotonTracer
         OSLShadingSystem&           shading_system,
         const SPPMParameters&       params);
 
+    // If a visibility grid is provided and importance-driven emission is enabled,
+    // the photons stored in visible regions are used to learn where to emit photons
+    // in the next passes.
     void trace_photons(
         SPPMPhotonVector&           photons,
+        const SPPMVisibilityGrid*   visibility_grid,
         const foundation::uint32    pass_hash,
         foundation::JobQueue&       job_queue,
         foundation::IAbortSwitch&   abort_switch);
@@ -83,10 +91,17 @@ class SPPMPhotonTracer
     size_t                          m_total_stored_photon_count;
     OIIOTextureSystem&              m_oiio_texture_system;
     OSLShadingSystem&               m_shading_system;
+    std::vector<SPPMPhotonVector>   m_job_photons;          // photons stored by each tracing job
+    std::unique_ptr<SPPMEmissionGuide>
+                                    m_light_guide;          // learned emission distribution for light photons
+    std::unique_ptr<SPPMEmissionGuide>
+                                    m_env_guide;            // learned emission distribution for environment photons
+    std::vector<SPPMEmissionGuide::Statistics>
+                                    m_job_statistics;       // emission statistics of each tracing job
 
     void schedule_light_photon_tracing_jobs(
         const LightTargetArray&     photon_targets,
-        SPPMPhotonVector&           photons,
+        const SPPMVisibilityGrid*   visibility_grid,
         const foundation::uint32    pass_hash,
         foundation::JobQueue&       job_queue,
         size_t&                     job_count,
@@ -95,12 +110,17 @@ class SPPMPhotonTracer
 
     void schedule_environment_photon_tracing_jobs(
         const LightTargetArray&     photon_targets,
-        SPPMPhotonVector&           photons,
+        const SPPMVisibilityGrid*   visibility_grid,
         const foundation::uint32    pass_hash,
         foundation::JobQueue&       job_queue,
         size_t&                     job_count,
         size_t&                     emitted_photon_count,
         foundation::IAbortSwitch&   abort_switch);
+
+    // Gather the photons stored by all tracing jobs, in job order.
+    void merge_photons(
+        SPPMPhotonVector&           photons,
+        foundation::JobQueue&       job_queue);
 };
 
 }   // namespace renderer
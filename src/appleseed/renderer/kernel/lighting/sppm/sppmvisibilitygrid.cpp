@@ -0,0 +1,71 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sppmvisibilitygrid.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+
+namespace renderer
+{
+
+//
+// SPPMVisibilityGrid class implementation.
+//
+
+SPPMVisibilityGrid::SPPMVisibilityGrid(const size_t bit_count)
+  : m_word_count(bit_count / 32)
+  , m_words(new boost::atomic<uint32>[bit_count / 32])
+  , m_rcp_cell_size(1.0f)
+  , m_empty(true)
+{
+    assert(bit_count >= 32);
+    assert(is_pow2(bit_count));
+
+    for (size_t i = 0; i < m_word_count; ++i)
+        m_words[i].store(0, boost::memory_order_relaxed);
+}
+
+void SPPMVisibilityGrid::clear(const float cell_size)
+{
+    assert(cell_size > 0.0f);
+
+    for (size_t i = 0; i < m_word_count; ++i)
+        m_words[i].store(0, boost::memory_order_relaxed);
+
+    m_rcp_cell_size = 1.0f / cell_size;
+    m_empty.store(true, boost::memory_order_relaxed);
+}
+
+}   // namespace renderer
@@ -0,0 +1,125 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+namespace renderer
+{
+
+//
+// A conservative record of the regions of the scene seen by camera paths during a pass.
+//
+// Space is divided into cubic cells which are hashed into a fixed-size bit set, so
+// a query may report a cell as visible when it only shares its bit with a visible
+// cell, but never the other way around. Cells can be marked from multiple threads.
+//
+
+class SPPMVisibilityGrid
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    explicit SPPMVisibilityGrid(const size_t bit_count = size_t(1) << 24);
+
+    // Forget all visible cells and set the size of the cells.
+    void clear(const float cell_size);
+
+    // Return true if no cell was marked since the last call to clear().
+    bool empty() const;
+
+    // Mark the cell containing a given point as visible. Thread-safe.
+    void insert(const foundation::Vector3f& point);
+
+    // Return true if the cell containing a given point was marked as visible.
+    bool contains(const foundation::Vector3f& point) const;
+
+  private:
+    const size_t                                            m_word_count;
+    std::unique_ptr<boost::atomic<foundation::uint32>[]>    m_words;
+    float                                                   m_rcp_cell_size;
+    boost::atomic<bool>                                     m_empty;
+
+    size_t hash_point(const foundation::Vector3f& point) const;
+};
+
+
+//
+// SPPMVisibilityGrid class implementation.
+//
+
+inline bool SPPMVisibilityGrid::empty() const
+{
+    return m_empty.load(boost::memory_order_relaxed);
+}
+
+inline void SPPMVisibilityGrid::insert(const foundation::Vector3f& point)
+{
+    const size_t bit = hash_point(point);
+    const foundation::uint32 mask = 1u << (bit & 31);
+    boost::atomic<foundation::uint32>& word = m_words[bit >> 5];
+
+    // Most camera vertices land in cells that are already marked: avoid the atomic write.
+    if ((word.load(boost::memory_order_relaxed) & mask) == 0)
+    {
+        word.fetch_or(mask, boost::memory_order_relaxed);
+        m_empty.store(false, boost::memory_order_relaxed);
+    }
+}
+
+inline bool SPPMVisibilityGrid::contains(const foundation::Vector3f& point) const
+{
+    const size_t bit = hash_point(point);
+    const foundation::uint32 mask = 1u << (bit & 31);
+    return (m_words[bit >> 5].load(boost::memory_order_relaxed) & mask) != 0;
+}
+
+inline size_t SPPMVisibilityGrid::hash_point(const foundation::Vector3f& point) const
+{
+    // Same spatial hash as the photon map hash grid.
+    const foundation::uint32 h =
+        (static_cast<foundation::uint32>(static_cast<int>(std::floor(point.x * m_rcp_cell_size))) * 73856093u) ^
+        (static_cast<foundation::uint32>(static_cast<int>(std::floor(point.y * m_rcp_cell_size))) * 19349663u) ^
+        (static_cast<foundation::uint32>(static_cast<int>(std::floor(point.z * m_rcp_cell_size))) * 83492791u);
+
+    return static_cast<size_t>(h) & (m_word_count * 32 - 1);
+}
+
+}   // namespace renderer
@@ -42,6 +42,7 @@
 #include "renderer/modeling/volume/volume.h"
 
 // appleseed.foundation headers.
+#include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
@@ -58,13 +59,17 @@ Tracer::Tracer(
     OSLShaderGroupExec&         shadergroup_exec,
     const float                 transparency_threshold,
     const size_t                max_iterations,
-    const bool                  print_details)
+    const bool                  print_details,
+    const bool                  use_occluder_cache)
   : m_intersector(intersector)
   , m_shadergroup_exec(shadergroup_exec)
   , m_assume_no_alpha_mapping(!scene.uses_alpha_mapping())
   , m_assume_no_participating_media(!scene.has_participating_media())
   , m_transmission_threshold(transparency_threshold)
   , m_max_iterations(max_iterations)
+  , m_use_occluder_cache(use_occluder_cache)
+  , m_occluder_cache_lookup_count(0)
+  , m_occluder_cache_hit_count(0)
 {
     if (print_details)
     {
@@ -83,6 +88,18 @@ Tracer::Tracer(
     }
 }
 
+StatisticsVector Tracer::get_statistics() const
+{
+    Statistics stats;
+    stats.insert("occluder cache lookups", m_occluder_cache_lookup_count);
+    stats.insert_percent(
+        "occluder cache hits",
+        m_occluder_cache_hit_count,
+        m_occluder_cache_lookup_count);
+
+    return StatisticsVector::make("tracer statistics", stats);
+}
+
 const ShadingPoint& Tracer::do_trace(
     const ShadingContext&       shading_context,
     const ShadingRay&           ray,
@@ -39,11 +39,13 @@
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
 
 // Standard headers.
 #include <cstddef>
 
 // Forward declarations.
+namespace foundation    { class StatisticsVector; }
 namespace renderer  { class Material;}
 namespace renderer  { class OSLShaderGroupExec; }
 namespace renderer  { class Scene; }
@@ -70,7 +72,8 @@ class Tracer
         OSLShaderGroupExec&             shadergroup_exec,
         const float                     transparency_threshold = 0.001f,
         const size_t                    max_iterations = 1000,
-        const bool                      print_details = true);
+        const bool                      print_details = true,
+        const bool                      use_occluder_cache = true);
 
     // Compute the transmission in a given direction.
     // Returns the transmission factor up to (but excluding) this occluder.
@@ -162,6 +165,9 @@ class Tracer
         const ShadingRay::DepthType     ray_depth,
         Spectrum&                       transmission);
 
+    // Retrieve performance statistics.
+    foundation::StatisticsVector get_statistics() const;
+
   private:
     const Intersector&                  m_intersector;
     OSLShaderGroupExec&                 m_shadergroup_exec;
@@ -169,8 +175,18 @@ class Tracer
     const bool                          m_assume_no_participating_media;
     const float                         m_transmission_threshold;
     const size_t                        m_max_iterations;
+    const bool                          m_use_occluder_cache;
     ShadingPoint                        m_shading_points[2];
 
+    // Occluder of the last blocked probe ray, tested first by the next probe ray.
+    ProbeOccluder                       m_last_occluder;
+    foundation::uint64                  m_occluder_cache_lookup_count;
+    foundation::uint64                  m_occluder_cache_hit_count;
+
+    bool trace_probe(
+        const ShadingRay&               ray,
+        const ShadingPoint*             parent_shading_point = nullptr);
+
     const ShadingPoint& do_trace(
         const ShadingContext&           shading_context,
         const ShadingRay&               ray,
@@ -195,13 +211,34 @@ class Tracer
 // Tracer class implementation.
 //
 
+inline bool Tracer::trace_probe(
+    const ShadingRay&                   ray,
+    const ShadingPoint*                 parent_shading_point)
+{
+    if (!m_use_occluder_cache)
+        return m_intersector.trace_probe(ray, parent_shading_point);
+
+    if (m_last_occluder.m_leaf)
+    {
+        ++m_occluder_cache_lookup_count;
+
+        if (m_intersector.trace_probe_occluder(ray, m_last_occluder, parent_shading_point))
+        {
+            ++m_occluder_cache_hit_count;
+            return true;
+        }
+    }
+
+    return m_intersector.trace_probe(ray, parent_shading_point, &m_last_occluder);
+}
+
 inline void Tracer::trace_simple(
     const ShadingContext&               shading_context,
     const ShadingRay&                   ray,
     Spectrum&                           transmission)
 {
     if (m_assume_no_alpha_mapping && m_assume_no_participating_media)
-        transmission.set(m_intersector.trace_probe(ray) ? 0.0f : 1.0f);
+        transmission.set(trace_probe(ray) ? 0.0f : 1.0f);
     else
     {
         const ShadingPoint& shading_point =
@@ -222,7 +259,7 @@ inline void Tracer::trace_simple(
     Spectrum&                           transmission)
 {
     if (m_assume_no_alpha_mapping && m_assume_no_participating_media)
-        transmission.set(m_intersector.trace_probe(ray, &origin) ? 0.0f : 1.0f);
+        transmission.set(trace_probe(ray, &origin) ? 0.0f : 1.0f);
     else
     {
         const ShadingPoint& shading_point =
@@ -258,7 +295,7 @@ inline void Tracer::trace_between_simple(
             ray_flags,
             origin.get_ray().m_depth + 1);
 
-        transmission.set(m_intersector.trace_probe(ray, &origin) ? 0.0f : 1.0f);
+        transmission.set(trace_probe(ray, &origin) ? 0.0f : 1.0f);
     }
     else
     {
@@ -297,7 +334,7 @@ inline void Tracer::trace_between_simple(
             ray_flags,
             parent_ray.m_depth);
 
-        transmission.set(m_intersector.trace_probe(ray, &origin) ? 0.0f : 1.0f);
+        transmission.set(trace_probe(ray, &origin) ? 0.0f : 1.0f);
     }
     else
     {
@@ -337,7 +374,7 @@ inline void Tracer::trace_between_simple(
             ray_flags,
             parent_ray.m_depth);
 
-        transmission.set(m_intersector.trace_probe(ray) ? 0.0f : 1.0f);
+        transmission.set(trace_probe(ray) ? 0.0f : 1.0f);
     }
     else
     {
@@ -378,7 +415,7 @@ inline void Tracer::trace_between_simple(
             ray_flags,
             ray_depth);
 
-        transmission.set(m_intersector.trace_probe(ray) ? 0.0f : 1.0f);
+        transmission.set(trace_probe(ray) ? 0.0f : 1.0f);
     }
     else
     {
@@ -543,6 +543,9 @@ void VolumeLightingIntegrator::take_single_direction_sample(
         m_scattering_modes,
         1,
         m_light_sample_count,
+        1,                      // light_candidate_count
+        0,                      // max_light_sample_count
+        0.0f,                   // light_sample_error_threshold
         m_low_light_threshold,
         m_indirect);
 
@@ -0,0 +1,230 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "visibilitybuffer.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// VisibilityBuffer class implementation.
+//
+
+VisibilityBuffer::VisibilityBuffer(
+    const size_t        width,
+    const size_t        height)
+  : m_width(width)
+  , m_height(height)
+  , m_samples(width * height)
+{
+    clear();
+}
+
+void VisibilityBuffer::clear()
+{
+    Sample empty;
+    empty.m_depth = numeric_limits<float>::max();
+    empty.m_instance_id = ~uint32(0);
+    empty.m_primitive_index = ~uint32(0);
+    empty.m_bary = Vector2f(0.0f);
+
+    fill(m_samples.begin(), m_samples.end(), empty);
+}
+
+
+//
+// VisibilityBufferRasterizer class implementation.
+//
+
+VisibilityBufferRasterizer::VisibilityBufferRasterizer(
+    const RasterizationCamera&  camera,
+    const double                near_z,
+    const size_t                frame_width,
+    const size_t                frame_height,
+    const size_t                origin_x,
+    const size_t                origin_y,
+    VisibilityBuffer&           buffer)
+  : m_near_z(near_z)
+  , m_kx(0.5 / tan(0.5 * camera.m_hfov) * frame_width)
+  , m_ky(0.5 / tan(0.5 * camera.m_hfov) * camera.m_aspect_ratio * frame_height)
+  , m_offset_x((0.5 - camera.m_shift_x) * frame_width - origin_x)
+  , m_offset_y((0.5 + camera.m_shift_y) * frame_height - origin_y)
+  , m_frame_width(static_cast<double>(frame_width))
+  , m_frame_height(static_cast<double>(frame_height))
+  , m_buffer(buffer)
+  , m_object_to_camera(Transformd::make_identity())
+  , m_instance_id(0)
+  , m_primitive_index(0)
+{
+    assert(near_z > 0.0);
+}
+
+void VisibilityBufferRasterizer::set_object_instance(
+    const Transformd&           object_to_camera,
+    const uint32                instance_id)
+{
+    m_object_to_camera = object_to_camera;
+    m_instance_id = instance_id;
+}
+
+void VisibilityBufferRasterizer::begin_object()
+{
+    m_primitive_index = 0;
+}
+
+void VisibilityBufferRasterizer::end_object()
+{
+}
+
+void VisibilityBufferRasterizer::rasterize(const Triangle& triangle)
+{
+    Vertex input[3];
+    input[0].m_position = m_object_to_camera.point_to_parent(Vector3d(triangle.m_v0[0], triangle.m_v0[1], triangle.m_v0[2]));
+    input[1].m_position = m_object_to_camera.point_to_parent(Vector3d(triangle.m_v1[0], triangle.m_v1[1], triangle.m_v1[2]));
+    input[2].m_position = m_object_to_camera.point_to_parent(Vector3d(triangle.m_v2[0], triangle.m_v2[1], triangle.m_v2[2]));
+    input[0].m_bary = Vector3d(1.0, 0.0, 0.0);
+    input[1].m_bary = Vector3d(0.0, 1.0, 0.0);
+    input[2].m_bary = Vector3d(0.0, 0.0, 1.0);
+
+    // Clip the triangle against the near plane (the camera looks down the -Z axis).
+    Vertex output[4];
+    size_t output_count = 0;
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const Vertex& a = input[i];
+        const Vertex& b = input[(i + 1) % 3];
+        const double da = a.m_position.z + m_near_z;
+        const double db = b.m_position.z + m_near_z;
+
+        if (da <= 0.0)
+            output[output_count++] = a;
+
+        if ((da <= 0.0) != (db <= 0.0))
+        {
+            const double t = da / (da - db);
+            Vertex& v = output[output_count++];
+            v.m_position = lerp(a.m_position, b.m_position, t);
+            v.m_position.z = -m_near_z;
+            v.m_bary = lerp(a.m_bary, b.m_bary, t);
+        }
+    }
+
+    if (output_count >= 3)
+        rasterize_clipped(output[0], output[1], output[2]);
+
+    if (output_count == 4)
+        rasterize_clipped(output[0], output[2], output[3]);
+
+    ++m_primitive_index;
+}
+
+void VisibilityBufferRasterizer::rasterize_clipped(
+    const Vertex&               v0,
+    const Vertex&               v1,
+    const Vertex&               v2)
+{
+    // Project the vertices to pixel coordinates of the buffer.
+    const double rcp_d0 = -1.0 / v0.m_position.z;
+    const double rcp_d1 = -1.0 / v1.m_position.z;
+    const double rcp_d2 = -1.0 / v2.m_position.z;
+    const Vector2d p0(m_offset_x + v0.m_position.x * rcp_d0 * m_kx, m_offset_y - v0.m_position.y * rcp_d0 * m_ky);
+    const Vector2d p1(m_offset_x + v1.m_position.x * rcp_d1 * m_kx, m_offset_y - v1.m_position.y * rcp_d1 * m_ky);
+    const Vector2d p2(m_offset_x + v2.m_position.x * rcp_d2 * m_kx, m_offset_y - v2.m_position.y * rcp_d2 * m_ky);
+
+    // Skip degenerate triangles; both orientations are rasterized.
+    const double area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+    if (area == 0.0)
+        return;
+    const double rcp_area = 1.0 / area;
+
+    // Compute the range of pixels whose center may be covered by the triangle.
+    const double max_x = static_cast<double>(m_buffer.get_width()) - 1.0;
+    const double max_y = static_cast<double>(m_buffer.get_height()) - 1.0;
+    const double x0 = max(ceil(min(min(p0.x, p1.x), p2.x) - 0.5), 0.0);
+    const double y0 = max(ceil(min(min(p0.y, p1.y), p2.y) - 0.5), 0.0);
+    const double x1 = min(floor(max(max(p0.x, p1.x), p2.x) - 0.5), max_x);
+    const double y1 = min(floor(max(max(p0.y, p1.y), p2.y) - 0.5), max_y);
+
+    if (x0 > x1 || y0 > y1)
+        return;
+
+    const size_t begin_x = static_cast<size_t>(x0);
+    const size_t begin_y = static_cast<size_t>(y0);
+    const size_t end_x = static_cast<size_t>(x1) + 1;
+    const size_t end_y = static_cast<size_t>(y1) + 1;
+
+    for (size_t y = begin_y; y < end_y; ++y)
+    {
+        const double cy = y + 0.5;
+
+        for (size_t x = begin_x; x < end_x; ++x)
+        {
+            const double cx = x + 0.5;
+
+            // Screen space barycentric coordinates of the pixel center.
+            const double l0 = ((p1.x - cx) * (p2.y - cy) - (p2.x - cx) * (p1.y - cy)) * rcp_area;
+            const double l1 = ((p2.x - cx) * (p0.y - cy) - (p0.x - cx) * (p2.y - cy)) * rcp_area;
+            const double l2 = 1.0 - l0 - l1;
+
+            if (l0 < 0.0 || l1 < 0.0 || l2 < 0.0)
+                continue;
+
+            // Perspective-correct interpolation of depth and barycentric coordinates.
+            const double w0 = l0 * rcp_d0;
+            const double w1 = l1 * rcp_d1;
+            const double w2 = l2 * rcp_d2;
+            const double depth = 1.0 / (w0 + w1 + w2);
+
+            VisibilityBuffer::Sample& sample = m_buffer.sample(x, y);
+
+            if (depth >= sample.m_depth)
+                continue;
+
+            const Vector3d bary = (w0 * v0.m_bary + w1 * v1.m_bary + w2 * v2.m_bary) * depth;
+
+            sample.m_depth = static_cast<float>(depth);
+            sample.m_instance_id = m_instance_id;
+            sample.m_primitive_index = m_primitive_index;
+            sample.m_bary = Vector2f(static_cast<float>(bary[1]), static_cast<float>(bary[2]));
+        }
+    }
+}
+
+}   // namespace renderer
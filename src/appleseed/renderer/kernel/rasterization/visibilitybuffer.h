@@ -0,0 +1,184 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rasterization/objectrasterizer.h"
+#include "renderer/kernel/rasterization/rasterizationcamera.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// A buffer holding, for each pixel of a rectangular region of the frame,
+// the closest surface seen through the pixel center.
+//
+
+class VisibilityBuffer
+  : public foundation::NonCopyable
+{
+  public:
+    struct Sample
+    {
+        float               m_depth;            // distance to the camera plane, FLT_MAX if nothing was hit
+        foundation::uint32  m_instance_id;      // user-defined identifier of the hit object instance
+        foundation::uint32  m_primitive_index;  // index of the hit triangle within its object
+        foundation::Vector2f m_bary;            // barycentric coordinates, same convention as renderer::ShadingPoint
+
+        bool hit() const;
+    };
+
+    // Constructor.
+    VisibilityBuffer(
+        const size_t        width,
+        const size_t        height);
+
+    // Mark all pixels as empty.
+    void clear();
+
+    size_t get_width() const;
+    size_t get_height() const;
+
+    // Access the sample of a given pixel.
+    Sample& sample(const size_t x, const size_t y);
+    const Sample& sample(const size_t x, const size_t y) const;
+
+  private:
+    const size_t            m_width;
+    const size_t            m_height;
+    std::vector<Sample>     m_samples;
+};
+
+
+//
+// An object rasterizer that rasterizes triangles into a visibility buffer
+// as seen from a perspective camera.
+//
+// The buffer covers the pixels [origin_x, origin_x + buffer width) x
+// [origin_y, origin_y + buffer height) of a frame of a given resolution,
+// which makes it possible to rasterize a single tile at a time.
+//
+
+class VisibilityBufferRasterizer
+  : public ObjectRasterizer
+{
+  public:
+    // Constructor.
+    VisibilityBufferRasterizer(
+        const RasterizationCamera&      camera,
+        const double                    near_z,         // distance to the near plane, strictly positive
+        const size_t                    frame_width,
+        const size_t                    frame_height,
+        const size_t                    origin_x,
+        const size_t                    origin_y,
+        VisibilityBuffer&               buffer);
+
+    // Set the object instance whose triangles are about to be rasterized.
+    // The transform goes from object space to camera space.
+    void set_object_instance(
+        const foundation::Transformd&   object_to_camera,
+        const foundation::uint32        instance_id);
+
+    void begin_object() override;
+    void end_object() override;
+
+    void rasterize(const Triangle& triangle) override;
+
+  private:
+    struct Vertex
+    {
+        foundation::Vector3d            m_position;     // camera space position
+        foundation::Vector3d            m_bary;         // weights of the original triangle vertices
+    };
+
+    const double                        m_near_z;
+    const double                        m_kx;
+    const double                        m_ky;
+    const double                        m_offset_x;
+    const double                        m_offset_y;
+    const double                        m_frame_width;
+    const double                        m_frame_height;
+    VisibilityBuffer&                   m_buffer;
+    foundation::Transformd              m_object_to_camera;
+    foundation::uint32                  m_instance_id;
+    foundation::uint32                  m_primitive_index;
+
+    void rasterize_clipped(
+        const Vertex&                   v0,
+        const Vertex&                   v1,
+        const Vertex&                   v2);
+};
+
+
+//
+// VisibilityBuffer class implementation.
+//
+
+inline bool VisibilityBuffer::Sample::hit() const
+{
+    return m_depth < std::numeric_limits<float>::max();
+}
+
+inline size_t VisibilityBuffer::get_width() const
+{
+    return m_width;
+}
+
+inline size_t VisibilityBuffer::get_height() const
+{
+    return m_height;
+}
+
+inline VisibilityBuffer::Sample& VisibilityBuffer::sample(const size_t x, const size_t y)
+{
+    assert(x < m_width);
+    assert(y < m_height);
+    return m_samples[y * m_width + x];
+}
+
+inline const VisibilityBuffer::Sample& VisibilityBuffer::sample(const size_t x, const size_t y) const
+{
+    assert(x < m_width);
+    assert(y < m_height);
+    return m_samples[y * m_width + x];
+}
+
+}   // namespace renderer
@@ -26,7 +26,6 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 //
-
 // Interface header.
 #include "ephemeralshadingresultframebufferfactory.h"
 
@@ -38,12 +37,91 @@
 // appleseed.foundation headers.
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
+#include "foundation/platform/system.h"
+
+// appleseed.main headers.
+#include "main/allocator.h"
+
+// Boost headers.
+#include "boost/functional/hash.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <vector>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
 
+namespace
+{
+    // Maximum number of framebuffers kept in a pool. Tiles are at most of four
+    // different sizes (interior, right edge, bottom edge and bottom-right corner).
+    const size_t MaxPooledFrameBuffers = 8;
+
+    struct FrameBufferPool
+    {
+        boost::mutex                        m_mutex;
+        vector<ShadingResultFrameBuffer*>   m_framebuffers;
+
+        FrameBufferPool()
+        {
+            m_framebuffers.reserve(MaxPooledFrameBuffers);
+        }
+
+        ~FrameBufferPool()
+        {
+            for (size_t i = 0; i < m_framebuffers.size(); ++i)
+                delete m_framebuffers[i];
+        }
+    };
+}
+
+struct EphemeralShadingResultFrameBufferFactory::Impl
+{
+    const ShadingResultFrameBuffer::Layout  m_layout;
+    vector<FrameBufferPool*>                m_pools;
+
+    explicit Impl(const ShadingResultFrameBuffer::Layout layout)
+      : m_layout(layout)
+    {
+        // Use more pools than threads to make collisions between threads unlikely.
+        const size_t pool_count = max<size_t>(2 * System::get_logical_cpu_core_count(), 1);
+
+        m_pools.reserve(pool_count);
+        for (size_t i = 0; i < pool_count; ++i)
+            m_pools.push_back(new FrameBufferPool());
+    }
+
+    ~Impl()
+    {
+        for (size_t i = 0; i < m_pools.size(); ++i)
+            delete m_pools[i];
+    }
+
+    FrameBufferPool& get_thread_pool()
+    {
+        const size_t h = boost::hash<boost::thread::id>()(boost::this_thread::get_id());
+        return *m_pools[h % m_pools.size()];
+    }
+};
+
+EphemeralShadingResultFrameBufferFactory::EphemeralShadingResultFrameBufferFactory(
+    const ShadingResultFrameBuffer::Layout layout)
+  : impl(new Impl(layout))
+{
+}
+
+EphemeralShadingResultFrameBufferFactory::~EphemeralShadingResultFrameBufferFactory()
+{
+    delete impl;
+}
+
 void EphemeralShadingResultFrameBufferFactory::release()
 {
     delete this;
@@ -56,13 +134,49 @@ ShadingResultFrameBuffer* EphemeralShadingResultFrameBufferFactory::create(
     const AABB2u&               tile_bbox)
 {
     const Tile& tile = frame.image().tile(tile_x, tile_y);
+    const size_t aov_count = frame.aov_images().size();
+
+    ShadingResultFrameBuffer* framebuffer = nullptr;
+
+    // Look for a recycled framebuffer of the right size.
+    {
+        FrameBufferPool& pool = impl->get_thread_pool();
+        boost::mutex::scoped_lock lock(pool.m_mutex);
+
+        vector<ShadingResultFrameBuffer*>& framebuffers = pool.m_framebuffers;
+
+        for (size_t i = framebuffers.size(); i > 0; --i)
+        {
+            ShadingResultFrameBuffer* candidate = framebuffers[i - 1];
+
+            if (candidate->get_width() == tile.get_width() &&
+                candidate->get_height() == tile.get_height() &&
+                candidate->get_channel_count() == ShadingResultFrameBuffer::get_total_channel_count(aov_count))
+            {
+                framebuffers[i - 1] = framebuffers.back();
+                framebuffers.pop_back();
+                framebuffer = candidate;
+                break;
+            }
+        }
+    }
 
-    ShadingResultFrameBuffer* framebuffer =
-        new ShadingResultFrameBuffer(
-            tile.get_width(),
-            tile.get_height(),
-            frame.aov_images().size(),
-            tile_bbox);
+    if (framebuffer)
+    {
+        framebuffer->set_crop_window(tile_bbox);
+    }
+    else
+    {
+        MemoryTagScope memory_tag_scope(MemoryTagFramebuffers);
+
+        framebuffer =
+            new ShadingResultFrameBuffer(
+                tile.get_width(),
+                tile.get_height(),
+                aov_count,
+                tile_bbox,
+                impl->m_layout);
+    }
 
     framebuffer->clear();
 
@@ -72,7 +186,30 @@ ShadingResultFrameBuffer* EphemeralShadingResultFrameBufferFactory::create(
 void EphemeralShadingResultFrameBufferFactory::destroy(
     ShadingResultFrameBuffer*   framebuffer)
 {
-    delete framebuffer;
+    ShadingResultFrameBuffer* evicted = nullptr;
+
+    {
+        FrameBufferPool& pool = impl->get_thread_pool();
+        boost::mutex::scoped_lock lock(pool.m_mutex);
+
+        vector<ShadingResultFrameBuffer*>& framebuffers = pool.m_framebuffers;
+
+        // Evict the oldest framebuffer if the pool is full.
+        if (framebuffers.size() == MaxPooledFrameBuffers)
+        {
+            evicted = framebuffers.front();
+            framebuffers.erase(framebuffers.begin());
+        }
+
+        framebuffers.push_back(framebuffer);
+    }
+
+    delete evicted;
+}
+
+bool EphemeralShadingResultFrameBufferFactory::is_permanent() const
+{
+    return false;
 }
 
 }   // namespace renderer
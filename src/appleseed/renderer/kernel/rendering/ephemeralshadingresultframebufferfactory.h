@@ -31,6 +31,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
@@ -41,15 +42,28 @@
 
 // Forward declarations.
 namespace renderer  { class Frame; }
-namespace renderer  { class ShadingResultFrameBuffer; }
 
 namespace renderer
 {
 
+//
+// A factory that returns a new, cleared framebuffer every time create() is called.
+//
+// Destroyed framebuffers are recycled rather than freed: they are kept in small pools
+// selected by thread, so that in steady state tile jobs do not hit the memory allocator.
+//
+
 class EphemeralShadingResultFrameBufferFactory
   : public IShadingResultFrameBufferFactory
 {
   public:
+    // Constructor.
+    explicit EphemeralShadingResultFrameBufferFactory(
+        const ShadingResultFrameBuffer::Layout layout = ShadingResultFrameBuffer::InterleavedLayout);
+
+    // Destructor.
+    ~EphemeralShadingResultFrameBufferFactory() override;
+
     // Delete this instance.
     void release() override;
 
@@ -61,6 +75,12 @@ class EphemeralShadingResultFrameBufferFactory
 
     void destroy(
         ShadingResultFrameBuffer*   framebuffer) override;
+
+    bool is_permanent() const override;
+
+  private:
+    struct Impl;
+    Impl* impl;
 };
 
 }   // namespace renderer
@@ -35,6 +35,7 @@
 #include "renderer/kernel/aov/aovaccumulator.h"
 #include "renderer/kernel/aov/imagestack.h"
 #include "renderer/kernel/aov/tilestack.h"
+#include "renderer/kernel/rendering/final/adaptivetilescheduler.h"
 #include "renderer/kernel/rendering/ipixelrenderer.h"
 #include "renderer/kernel/rendering/isamplerenderer.h"
 #include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
@@ -43,6 +44,7 @@
 #include "renderer/kernel/rendering/shadingresultframebuffer.h"
 #include "renderer/kernel/shading/shadingresult.h"
 #include "renderer/modeling/aov/aov.h"
+#include "renderer/modeling/aov/aovcontainer.h"
 #include "renderer/modeling/aov/pixelsamplecountaov.h"
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/utility/bbox.h"
@@ -105,6 +107,17 @@ namespace
     // Threshold used to warn the user if blocks don't converge.
     const float BlockConvergenceWarningThreshold = 0.5f;
 
+    bool has_cryptomatte_aov(const Frame& frame)
+    {
+        for (size_t i = 0, e = frame.aovs().size(); i < e; ++i)
+        {
+            if (starts_with(frame.aovs().get_by_index(i)->get_model(), "cryptomatte_"))
+                return true;
+        }
+
+        return false;
+    }
+
 
     //
     // A block of pixel used for adaptive sampling.
@@ -147,29 +160,60 @@ namespace
 
 
     //
-    // Calculation of noise level inside a block or a pixel.
+    // The state of a tile between two rounds of samples.
     //
 
-    // Compute the variance of a weighted pixel given the value of the same pixel with 2 different samples count.
-    // The first given pixel `main` contains N samples.
-    // The second given pixel `second` contains N/2 samples (samples included in `second` are also in `main`).
-    float compute_weighted_pixel_variance(
-        const float*            main,
-        const float*            second)
+    struct TileState
+      : public AdaptiveTileScheduler::TileData
     {
-        // Get weights.
-        const float main_weight = *main++;
-        const float rcp_main_weight = main_weight == 0.0f ? 0.0f : 1.0f / main_weight;
-        const float second_weight = *second++;
-        const float rcp_second_weight = second_weight == 0.0f ? 0.0f : 1.0f / second_weight;
+        IShadingResultFrameBufferFactory*       m_framebuffer_factory;
+        const size_t                            m_tile_x;
+        const size_t                            m_tile_y;
+        const int                               m_tile_origin_x;
+        const int                               m_tile_origin_y;
+        size_t                                  m_tile_pixel_count;
+        ShadingResultFrameBuffer*               m_framebuffer;
+        unique_ptr<ShadingResultFrameBuffer>    m_second_framebuffer;
+
+        // Blocks still being rendered and blocks that won't receive more samples.
+        deque<PixelBlock>                       m_rendering_blocks;
+        vector<PixelBlock>                      m_finished_blocks;
+
+        TileState(
+            IShadingResultFrameBufferFactory*   framebuffer_factory,
+            const size_t                        tile_x,
+            const size_t                        tile_y,
+            const int                           tile_origin_x,
+            const int                           tile_origin_y)
+          : m_framebuffer_factory(framebuffer_factory)
+          , m_tile_x(tile_x)
+          , m_tile_y(tile_y)
+          , m_tile_origin_x(tile_origin_x)
+          , m_tile_origin_y(tile_origin_y)
+          , m_tile_pixel_count(0)
+          , m_framebuffer(nullptr)
+        {
+        }
 
-        // Get colors and assign weights.
-        Color4f main_color(main[0], main[1], main[2], main[3]);
-        main_color *= rcp_main_weight;
+        ~TileState() override
+        {
+            if (m_framebuffer != nullptr)
+                m_framebuffer_factory->destroy(m_framebuffer);
+        }
+    };
 
-        Color4f second_color(second[0], second[1], second[2], second[3]);
-        second_color *= rcp_second_weight;
 
+    //
+    // Calculation of noise level inside a block or a pixel.
+    //
+
+    // Compute the variance of a pixel given the value of the same pixel with 2 different samples count.
+    // The first given pixel `main` contains N samples.
+    // The second given pixel `second` contains N/2 samples (samples included in `second` are also in `main`).
+    float compute_pixel_variance(
+        const Color4f&          main_color,
+        const Color4f&          second_color)
+    {
         const float rgb = abs(main_color.r) + abs(main_color.g) + abs(main_color.b);
 
         if (rgb == 0.0f)
@@ -186,9 +230,9 @@ namespace
     // Compute the variance of the tile `main` for pixels in the bounding box `bb`.
     // A second tile `second` is used which contains half of the samples of `main`.
     float compute_tile_variance(
-        const AABB2u&           bb,
-        const AccumulatorTile*  main,
-        const AccumulatorTile*  second)
+        const AABB2u&                   bb,
+        const ShadingResultFrameBuffer* main,
+        const ShadingResultFrameBuffer* second)
     {
         float error = 0.0f;
 
@@ -201,10 +245,11 @@ namespace
         {
             for (size_t x = bb.min.x; x <= bb.max.x; ++x)
             {
-                const float* main_ptr = main->pixel(x, y);
-                const float* second_ptr = second->pixel(x, y);
+                Color4f main_color, second_color;
+                main->get_main_color(x, y, main_color);
+                second->get_main_color(x, y, second_color);
 
-                error = max(error, compute_weighted_pixel_variance(main_ptr, second_ptr));
+                error = max(error, compute_pixel_variance(main_color, second_color));
             }
         }
 
@@ -232,10 +277,12 @@ namespace
             const Frame&                        frame,
             ISampleRendererFactory*             sample_renderer_factory,
             IShadingResultFrameBufferFactory*   framebuffer_factory,
+            AdaptiveTileScheduler*              scheduler,
             const ParamArray&                   params,
             const size_t                        thread_index)
           : m_aov_accumulators(frame)
           , m_framebuffer_factory(framebuffer_factory)
+          , m_scheduler(scheduler)
           , m_params(params)
           , m_invalid_sample_count(0)
           , m_sample_aov_tile(nullptr)
@@ -273,11 +320,15 @@ namespace
                 "  batch size                    %s\n"
                 "  min samples                   %s\n"
                 "  max samples                   %s\n"
-                "  noise threshold               %f",
+                "  noise threshold               %f\n"
+                "  frame scheduling              %s\n"
+                "  time limit                    %s",
                 pretty_uint(m_params.m_batch_size).c_str(),
                 pretty_uint(m_params.m_min_samples).c_str(),
                 m_params.m_max_samples > 0 ? pretty_uint(m_params.m_max_samples).c_str() : "unlimited",
-                m_params.m_noise_threshold);
+                m_params.m_noise_threshold,
+                m_scheduler != nullptr ? "on" : "off",
+                m_params.m_time_limit > 0.0 ? pretty_time(m_params.m_time_limit).c_str() : "unlimited");
 
             RENDERER_LOG_DEBUG("adaptive tile renderer splitting threshold: %f",
                 m_params.m_splitting_threshold);
@@ -291,16 +342,205 @@ namespace
             const size_t                        tile_y,
             const uint32                        pass_hash,
             IAbortSwitch&                       abort_switch) override
+        {
+            if (m_scheduler != nullptr)
+                m_scheduler->on_tile_begin(pass_hash);
+
+            unique_ptr<TileState> state(begin_tile(frame, tile_x, tile_y, pass_hash, abort_switch));
+
+            if (m_scheduler == nullptr)
+            {
+                // Render the tile until all its blocks are finished.
+                if (state != nullptr && refine_tile(*state, frame, pass_hash, abort_switch, ~size_t(0)))
+                    end_tile(*state, frame);
+                return;
+            }
+
+            // Render one round of samples, then let the noisiest tiles of the frame,
+            // including this one, compete for extra rounds.
+            while (true)
+            {
+                if (state != nullptr)
+                {
+                    if (refine_tile(*state, frame, pass_hash, abort_switch, state->m_rendering_blocks.size()))
+                    {
+                        if (state->m_rendering_blocks.empty())
+                            end_tile(*state, frame);
+                        else
+                        {
+                            release_tile(*state, frame);
+
+                            const size_t tile_index =
+                                state->m_tile_y * frame.image().properties().m_tile_count_x + state->m_tile_x;
+                            const float tile_error = compute_tile_error(*state);
+                            m_scheduler->push(tile_index, tile_error, move(state));
+                        }
+                    }
+
+                    state.reset();
+                }
+
+                size_t tile_index;
+                float tile_error;
+                unique_ptr<AdaptiveTileScheduler::TileData> data;
+                if (!m_scheduler->pop(tile_index, tile_error, data))
+                    break;
+
+                state.reset(static_cast<TileState*>(data.release()));
+
+                // Tiles popped after an abort are discarded.
+                if (abort_switch.is_aborted())
+                {
+                    state.reset();
+                    continue;
+                }
+
+                acquire_tile(*state, frame);
+
+                // Out of time: finish the tile with the samples it has.
+                if (!m_scheduler->has_time_left())
+                {
+                    end_tile(*state, frame);
+                    state.reset();
+                }
+            }
+        }
+
+        StatisticsVector get_statistics() const override
+        {
+            Statistics stats;
+
+            // How many samples per pixel were computed.
+            stats.insert("samples/pixel", m_spp);
+
+            // Converged pixels over total pixels.
+            stats.insert_percent("convergence rate", m_total_converged_pixel_count, m_total_pixel_count);
+
+            StatisticsVector vec;
+            vec.insert("adaptive tile renderer statistics", stats);
+            vec.merge(m_sample_renderer->get_statistics());
+
+            return vec;
+        }
+
+      private:
+        struct Parameters
+        {
+            const SamplingContext::Mode         m_sampling_mode;
+            const size_t                        m_batch_size;
+            const size_t                        m_min_samples;
+            const size_t                        m_max_samples;
+            const float                         m_noise_threshold;
+            const float                         m_splitting_threshold;
+            const size_t                        m_passes;
+            const double                        m_time_limit;
+
+            explicit Parameters(const ParamArray& params)
+              : m_sampling_mode(get_sampling_context_mode(params))
+              , m_batch_size(params.get_required<size_t>("batch_size", 16))
+              , m_min_samples(params.get_required<size_t>("min_samples", 0))
+              , m_max_samples(params.get_required<size_t>("max_samples", 256))
+              , m_noise_threshold(params.get_required<float>("noise_threshold", 1.0f))
+              , m_splitting_threshold(m_noise_threshold * 256.0f)
+              , m_passes(params.get_optional<size_t>("passes", 1))
+              , m_time_limit(params.get_optional<double>("time_limit", 0.0))
+            {
+            }
+        };
+
+        AOVAccumulatorContainer                 m_aov_accumulators;
+        IShadingResultFrameBufferFactory*       m_framebuffer_factory;
+        AdaptiveTileScheduler*                  m_scheduler;
+        const Parameters                        m_params;
+        size_t                                  m_sample_aov_index;
+        size_t                                  m_variation_aov_index;
+        size_t                                  m_invalid_sample_count;
+        Tile*                                   m_sample_aov_tile;
+        Tile*                                   m_variation_aov_tile;
+        auto_release_ptr<ISampleRenderer>       m_sample_renderer;
+
+        // Members used for statistics.
+        Population<uint64>                      m_spp;
+        size_t                                  m_total_pixel_count;
+        size_t                                  m_total_converged_pixel_count;
+
+        void on_tile_begin(
+            const Frame&                        frame,
+            const size_t                        tile_x,
+            const size_t                        tile_y,
+            Tile&                               tile,
+            TileStack&                          aov_tiles)
+        {
+            if (m_sample_aov_index != ~size_t(0))
+                m_sample_aov_tile = &frame.aovs().get_by_index(m_sample_aov_index)->get_image().tile(tile_x, tile_y);
+
+            if (m_variation_aov_index != ~size_t(0))
+                m_variation_aov_tile = &frame.aovs().get_by_index(m_variation_aov_index)->get_image().tile(tile_x, tile_y);
+        }
+
+        void on_tile_end(
+            const Frame&                        frame,
+            const size_t                        tile_x,
+            const size_t                        tile_y,
+            Tile&                               tile,
+            TileStack&                          aov_tiles)
+        {
+            m_sample_aov_tile = nullptr;
+            m_variation_aov_tile = nullptr;
+        }
+
+        void on_pixel_begin(
+            const Frame&                        frame,
+            const Vector2i&                     pi,
+            const Vector2i&                     pt)
+        {
+            m_invalid_sample_count = 0;
+            m_aov_accumulators.on_pixel_begin(pi);
+        }
+
+        void on_pixel_end(
+            const Frame&                        frame,
+            const Vector2i&                     pi,
+            const Vector2i&                     pt)
+        {
+            static const size_t MaxWarningsPerThread = 2;
+
+            m_aov_accumulators.on_pixel_end(pi);
+
+            // Warns the user for bad pixels.
+            if (m_invalid_sample_count > 0)
+            {
+                // We can't store the number of error per pixel because of adaptive rendering.
+                if (m_invalid_sample_count <= MaxWarningsPerThread)
+                {
+                    RENDERER_LOG_WARNING(
+                        "%s sample%s at pixel (%d, %d) had nan, negative or infinite components and %s ignored.",
+                        pretty_uint(m_invalid_sample_count).c_str(),
+                        m_invalid_sample_count > 1 ? "s" : "",
+                        pi.x, pi.y,
+                        m_invalid_sample_count > 1 ? "were" : "was");
+                }
+                else if (m_invalid_sample_count == MaxWarningsPerThread + 1)
+                {
+                    RENDERER_LOG_WARNING("more invalid samples found, omitting warning messages for brevity.");
+                }
+            }
+        }
+
+        TileState* begin_tile(
+            const Frame&                        frame,
+            const size_t                        tile_x,
+            const size_t                        tile_y,
+            const uint32                        pass_hash,
+            IAbortSwitch&                       abort_switch)
         {
             // Retrieve frame properties.
             const CanvasProperties& frame_properties = frame.image().properties();
             assert(tile_x < frame_properties.m_tile_count_x);
             assert(tile_y < frame_properties.m_tile_count_y);
-            const size_t aov_count = frame.aov_images().size();
 
             // Retrieve tile properties.
-            Tile& tile = frame.image().tile(tile_x, tile_y);
-            TileStack aov_tiles = frame.aov_images().tiles(tile_x, tile_y);
+            const Tile& tile = frame.image().tile(tile_x, tile_y);
             const int tile_origin_x = static_cast<int>(frame_properties.m_tile_width * tile_x);
             const int tile_origin_y = static_cast<int>(frame_properties.m_tile_height * tile_y);
             const int tile_width = static_cast<int>(tile.get_width());
@@ -315,49 +555,48 @@ namespace
                     tile_height,
                     frame.get_crop_window());
             if (!tile_bbox.is_valid())
-                return;
+                return nullptr;
 
-            // Inform the pixel renderer that we are about to render a tile.
-            on_tile_begin(frame, tile_x, tile_y, tile, aov_tiles);
+            unique_ptr<TileState> state(
+                new TileState(
+                    m_framebuffer_factory,
+                    tile_x,
+                    tile_y,
+                    tile_origin_x,
+                    tile_origin_y));
 
-            // Inform the AOV accumulators that we are about to render a tile.
-            m_aov_accumulators.on_tile_begin(
-                frame,
-                tile_x,
-                tile_y,
-                m_params.m_max_samples);
+            // Inform the pixel renderer and the AOV accumulators that we are about to render a tile.
+            acquire_tile(*state, frame);
 
             // Create the framebuffer into which we will accumulate the samples.
-            ShadingResultFrameBuffer* framebuffer =
+            state->m_framebuffer =
                 m_framebuffer_factory->create(
                     frame,
                     tile_x,
                     tile_y,
                     tile_bbox);
-            assert(framebuffer);
+            assert(state->m_framebuffer);
 
             // Create the buffer into which we will accumulate every second samples.
             // If rendering multiple passes, the permanent buffer factory will return
             // the same buffer so we must create a new one.
-            unique_ptr<ShadingResultFrameBuffer> second_framebuffer(
+            state->m_second_framebuffer.reset(
                 new ShadingResultFrameBuffer(
                     tile.get_width(),
                     tile.get_height(),
                     frame.aov_images().size(),
-                    tile_bbox));
+                    tile_bbox,
+                    state->m_framebuffer->get_layout()));
 
             if (m_params.m_passes > 1)
-                second_framebuffer->copy_from(*framebuffer);
-            else second_framebuffer->clear();
-
-            const size_t tile_pixel_count = framebuffer->get_width() * framebuffer->get_height();
+                state->m_second_framebuffer->copy_from(*state->m_framebuffer);
+            else state->m_second_framebuffer->clear();
 
-            // Blocks rendering.
-            deque<PixelBlock> rendering_blocks;
-            vector<PixelBlock> finished_blocks;
+            state->m_tile_pixel_count = state->m_framebuffer->get_width() * state->m_framebuffer->get_height();
 
             // Initially split blocks so that no block is larger than `BlockMaxAllowedSize`.
-            create_rendering_blocks(rendering_blocks, tile_bbox, framebuffer->get_crop_window());
+            deque<PixelBlock>& rendering_blocks = state->m_rendering_blocks;
+            create_rendering_blocks(rendering_blocks, tile_bbox, state->m_framebuffer->get_crop_window());
 
             // First uniform pass based on adaptiveness parameter.
             if (m_params.m_min_samples > 0)
@@ -380,20 +619,42 @@ namespace
                         pb,
                         abort_switch,
                         batch_size,
-                        framebuffer,
-                        second_framebuffer.get(),
+                        state->m_framebuffer,
+                        state->m_second_framebuffer.get(),
                         tile_origin_x,
                         tile_origin_y,
                         frame,
                         frame_properties.m_canvas_width,
                         frame_properties.m_canvas_height,
                         pass_hash,
-                        aov_count);
+                        frame.aov_images().size());
 
                     rendering_blocks.push_back(pb);
                 }
             }
 
+            return state.release();
+        }
+
+        // Sample the blocks of a tile, at most `max_batch_count` batches at a time.
+        // Return false if rendering was aborted.
+        bool refine_tile(
+            TileState&                          state,
+            const Frame&                        frame,
+            const uint32                        pass_hash,
+            IAbortSwitch&                       abort_switch,
+            const size_t                        max_batch_count)
+        {
+            const CanvasProperties& frame_properties = frame.image().properties();
+            const size_t aov_count = frame.aov_images().size();
+
+            ShadingResultFrameBuffer* framebuffer = state.m_framebuffer;
+            ShadingResultFrameBuffer* second_framebuffer = state.m_second_framebuffer.get();
+            deque<PixelBlock>& rendering_blocks = state.m_rendering_blocks;
+            vector<PixelBlock>& finished_blocks = state.m_finished_blocks;
+
+            size_t batch_count = 0;
+
             while (true)
             {
                 // Check if image is converged or rendering was aborted.
@@ -402,11 +663,15 @@ namespace
                     finished_blocks.insert(finished_blocks.end(), rendering_blocks.begin(), rendering_blocks.end());
 
                     if (rendering_blocks.empty())
-                        break;
+                        return true;
                     else
-                        return;
+                        return false;
                 }
 
+                // Leave the remaining blocks for another round.
+                if (batch_count++ == max_batch_count)
+                    return true;
+
                 // Sample the block in front of the deque.
                 PixelBlock pb = rendering_blocks.front();
                 rendering_blocks.pop_front();
@@ -430,9 +695,9 @@ namespace
                     abort_switch,
                     batch_size,
                     framebuffer,
-                    second_framebuffer.get(),
-                    tile_origin_x,
-                    tile_origin_y,
+                    second_framebuffer,
+                    state.m_tile_origin_x,
+                    state.m_tile_origin_y,
                     frame,
                     frame_properties.m_canvas_width,
                     frame_properties.m_canvas_height,
@@ -446,7 +711,7 @@ namespace
                     compute_tile_variance(
                         block_image_bb,
                         framebuffer,
-                        second_framebuffer.get());
+                        second_framebuffer);
 
                 if (batch_size < m_params.m_batch_size)
                 {
@@ -489,23 +754,26 @@ namespace
                     rendering_blocks.push_front(pb);
                 }
             }
+        }
 
-            //
-            // Rendering finished, fill diagnostic AOVs and update statistics.
-            //
+        // Fill diagnostic AOVs, update statistics and develop a tile that won't receive more samples.
+        void end_tile(
+            TileState&                          state,
+            const Frame&                        frame)
+        {
+            const size_t tile_x = state.m_tile_x;
+            const size_t tile_y = state.m_tile_y;
+            const size_t tile_pixel_count = state.m_tile_pixel_count;
+            ShadingResultFrameBuffer* framebuffer = state.m_framebuffer;
+            vector<PixelBlock>& finished_blocks = state.m_finished_blocks;
+
+            // Blocks still being rendered, if any, are finished as they are.
+            finished_blocks.insert(finished_blocks.end(), state.m_rendering_blocks.begin(), state.m_rendering_blocks.end());
+            state.m_rendering_blocks.clear();
 
             size_t tile_converged_pixel_count = 0;
             float average_noise_level = 0.0f;
             const float normalizing_factor = 1.0f / m_params.m_noise_threshold;
-            
-            for (size_t i = 0, n = rendering_blocks.size(); i < n; ++i)
-            {
-                const PixelBlock& pb = rendering_blocks[i];
-                const AABB2u pb_image_aabb = AABB2i::intersect(framebuffer->get_crop_window(), pb.m_surface);
-                const size_t pb_pixel_count = pb_image_aabb.volume();
-
-                average_noise_level += pb.m_block_error * pb_pixel_count;
-            }
 
             for (size_t i = 0, n = finished_blocks.size(); i < n; ++i)
             {
@@ -583,134 +851,56 @@ namespace
             }
 
             // Develop the framebuffer to the tile.
+            Tile& tile = frame.image().tile(tile_x, tile_y);
+            TileStack aov_tiles = frame.aov_images().tiles(tile_x, tile_y);
             framebuffer->develop_to_tile(tile, aov_tiles);
 
             // Release the framebuffer.
             m_framebuffer_factory->destroy(framebuffer);
+            state.m_framebuffer = nullptr;
 
-            // Inform the AOV accumulators that we are done rendering the tile.
-            m_aov_accumulators.on_tile_end(frame, tile_x, tile_y);
-
-            // Inform the pixel renderer that we are done rendering the tile.
-            on_tile_end(frame, tile_x, tile_y, tile, aov_tiles);
+            release_tile(state, frame);
         }
 
-        StatisticsVector get_statistics() const override
+        // Inform the pixel renderer and the AOV accumulators that this thread starts rendering a tile.
+        void acquire_tile(
+            TileState&                          state,
+            const Frame&                        frame)
         {
-            Statistics stats;
-
-            // How many samples per pixel were computed.
-            stats.insert("samples/pixel", m_spp);
+            Tile& tile = frame.image().tile(state.m_tile_x, state.m_tile_y);
+            TileStack aov_tiles = frame.aov_images().tiles(state.m_tile_x, state.m_tile_y);
 
-            // Converged pixels over total pixels.
-            stats.insert_percent("convergence rate", m_total_converged_pixel_count, m_total_pixel_count);
-
-            StatisticsVector vec;
-            vec.insert("adaptive tile renderer statistics", stats);
-            vec.merge(m_sample_renderer->get_statistics());
+            on_tile_begin(frame, state.m_tile_x, state.m_tile_y, tile, aov_tiles);
 
-            return vec;
+            m_aov_accumulators.on_tile_begin(
+                frame,
+                state.m_tile_x,
+                state.m_tile_y,
+                m_params.m_max_samples);
         }
 
-      private:
-        struct Parameters
+        // Inform the AOV accumulators and the pixel renderer that this thread is done rendering a tile.
+        void release_tile(
+            TileState&                          state,
+            const Frame&                        frame)
         {
-            const SamplingContext::Mode         m_sampling_mode;
-            const size_t                        m_batch_size;
-            const size_t                        m_min_samples;
-            const size_t                        m_max_samples;
-            const float                         m_noise_threshold;
-            const float                         m_splitting_threshold;
-            const size_t                        m_passes;
+            Tile& tile = frame.image().tile(state.m_tile_x, state.m_tile_y);
+            TileStack aov_tiles = frame.aov_images().tiles(state.m_tile_x, state.m_tile_y);
 
-            explicit Parameters(const ParamArray& params)
-              : m_sampling_mode(get_sampling_context_mode(params))
-              , m_batch_size(params.get_required<size_t>("batch_size", 16))
-              , m_min_samples(params.get_required<size_t>("min_samples", 0))
-              , m_max_samples(params.get_required<size_t>("max_samples", 256))
-              , m_noise_threshold(params.get_required<float>("noise_threshold", 1.0f))
-              , m_splitting_threshold(m_noise_threshold * 256.0f)
-              , m_passes(params.get_optional<size_t>("passes", 1))
-            {
-            }
-        };
+            m_aov_accumulators.on_tile_end(frame, state.m_tile_x, state.m_tile_y);
 
-        AOVAccumulatorContainer                 m_aov_accumulators;
-        IShadingResultFrameBufferFactory*       m_framebuffer_factory;
-        const Parameters                        m_params;
-        size_t                                  m_sample_aov_index;
-        size_t                                  m_variation_aov_index;
-        size_t                                  m_invalid_sample_count;
-        Tile*                                   m_sample_aov_tile;
-        Tile*                                   m_variation_aov_tile;
-        auto_release_ptr<ISampleRenderer>       m_sample_renderer;
-
-        // Members used for statistics.
-        Population<uint64>                      m_spp;
-        size_t                                  m_total_pixel_count;
-        size_t                                  m_total_converged_pixel_count;
-
-        void on_tile_begin(
-            const Frame&                        frame,
-            const size_t                        tile_x,
-            const size_t                        tile_y,
-            Tile&                               tile,
-            TileStack&                          aov_tiles)
-        {
-            if (m_sample_aov_index != ~size_t(0))
-                m_sample_aov_tile = &frame.aovs().get_by_index(m_sample_aov_index)->get_image().tile(tile_x, tile_y);
-
-            if (m_variation_aov_index != ~size_t(0))
-                m_variation_aov_tile = &frame.aovs().get_by_index(m_variation_aov_index)->get_image().tile(tile_x, tile_y);
+            on_tile_end(frame, state.m_tile_x, state.m_tile_y, tile, aov_tiles);
         }
 
-        void on_tile_end(
-            const Frame&                        frame,
-            const size_t                        tile_x,
-            const size_t                        tile_y,
-            Tile&                               tile,
-            TileStack&                          aov_tiles)
+        // The noise level of a tile is the one of its noisiest block.
+        static float compute_tile_error(const TileState& state)
         {
-            m_sample_aov_tile = nullptr;
-            m_variation_aov_tile = nullptr;
-        }
+            float error = 0.0f;
 
-        void on_pixel_begin(
-            const Frame&                        frame,
-            const Vector2i&                     pi,
-            const Vector2i&                     pt)
-        {
-            m_invalid_sample_count = 0;
-            m_aov_accumulators.on_pixel_begin(pi);
-        }
+            for (const PixelBlock& pb : state.m_rendering_blocks)
+                error = max(error, pb.m_block_error);
 
-        void on_pixel_end(
-            const Frame&                        frame,
-            const Vector2i&                     pi,
-            const Vector2i&                     pt)
-        {
-            static const size_t MaxWarningsPerThread = 2;
-
-            m_aov_accumulators.on_pixel_end(pi);
-
-            // Warns the user for bad pixels.
-            if (m_invalid_sample_count > 0)
-            {
-                // We can't store the number of error per pixel because of adaptive rendering.
-                if (m_invalid_sample_count <= MaxWarningsPerThread)
-                {
-                    RENDERER_LOG_WARNING(
-                        "%s sample%s at pixel (%d, %d) had nan, negative or infinite components and %s ignored.",
-                        pretty_uint(m_invalid_sample_count).c_str(),
-                        m_invalid_sample_count > 1 ? "s" : "",
-                        pi.x, pi.y,
-                        m_invalid_sample_count > 1 ? "were" : "was");
-                }
-                else if (m_invalid_sample_count == MaxWarningsPerThread + 1)
-                {
-                    RENDERER_LOG_WARNING("more invalid samples found, omitting warning messages for brevity.");
-                }
-            }
+            return error;
         }
 
         void create_rendering_blocks(
@@ -918,6 +1108,7 @@ namespace
             assert(s_block.m_surface.extent(0) >= BlockMinAllowedSize && s_block.m_surface.extent(1) >= BlockMinAllowedSize);
 
             f_block.m_spp = s_block.m_spp = pb.m_spp;
+            f_block.m_block_error = s_block.m_block_error = pb.m_block_error;
 
             blocks.push_front(s_block);
             blocks.push_front(f_block);
@@ -974,6 +1165,23 @@ Dictionary AdaptiveTileRendererFactory::get_params_metadata()
             .insert("label", "Noise Threshold")
             .insert("help", "Maximum amount of noise allowed in the image"));
 
+    metadata.dictionaries().insert(
+        "frame_scheduling",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Frame Scheduling")
+            .insert("help", "Dispatch extra rounds of samples to the noisiest tiles of the whole frame"));
+
+    metadata.dictionaries().insert(
+        "time_limit",
+        Dictionary()
+            .insert("type", "float")
+            .insert("min", "0.0")
+            .insert("default", "0.0")
+            .insert("label", "Time Limit")
+            .insert("help", "Time in seconds after which a pass stops dispatching extra rounds of samples (0 for unlimited, requires frame scheduling)"));
+
     return metadata;
 }
 
@@ -986,6 +1194,24 @@ AdaptiveTileRendererFactory::AdaptiveTileRendererFactory(
   , m_sample_renderer_factory(sample_renderer_factory)
   , m_framebuffer_factory(framebuffer_factory)
   , m_params(params)
+{
+    if (m_params.get_optional<bool>("frame_scheduling", false))
+    {
+        if (has_cryptomatte_aov(frame))
+        {
+            // Cryptomatte accumulators restart from scratch every time a tile is resumed.
+            RENDERER_LOG_WARNING("frame scheduling is not compatible with cryptomatte aovs and will be disabled.");
+        }
+        else
+        {
+            m_scheduler.reset(
+                new AdaptiveTileScheduler(
+                    max(m_params.get_optional<double>("time_limit", 0.0), 0.0)));
+        }
+    }
+}
+
+AdaptiveTileRendererFactory::~AdaptiveTileRendererFactory()
 {
 }
 
@@ -1002,6 +1228,7 @@ ITileRenderer* AdaptiveTileRendererFactory::create(
             m_frame,
             m_sample_renderer_factory,
             m_framebuffer_factory,
+            m_scheduler.get(),
             m_params,
             thread_index);
 }
@@ -34,8 +34,10 @@
 
 // Standard headers.
 #include <cstddef>
+#include <memory>
 
 // Forward declarations.
+namespace renderer  { class AdaptiveTileScheduler; }
 namespace renderer  { class Frame; }
 namespace renderer  { class ISampleRendererFactory; }
 namespace renderer  { class IShadingResultFrameBufferFactory; }
@@ -61,6 +63,9 @@ class AdaptiveTileRendererFactory
         IShadingResultFrameBufferFactory*   framebuffer_factory,
         const ParamArray&                   params);
 
+    // Destructor.
+    ~AdaptiveTileRendererFactory() override;
+
     // Delete this instance.
     void release() override;
 
@@ -73,6 +78,7 @@ class AdaptiveTileRendererFactory
     ISampleRendererFactory*                 m_sample_renderer_factory;
     IShadingResultFrameBufferFactory*       m_framebuffer_factory;
     const ParamArray                        m_params;
+    std::unique_ptr<AdaptiveTileScheduler>  m_scheduler;
 };
 
 }   // namespace renderer
@@ -0,0 +1,127 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "adaptivetilescheduler.h"
+
+// Standard headers.
+#include <algorithm>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// AdaptiveTileScheduler class implementation.
+//
+
+bool AdaptiveTileScheduler::Entry::operator<(const Entry& rhs) const
+{
+    // Break ties on the tile index to keep the dispatch order deterministic.
+    return
+        m_error < rhs.m_error ||
+        (m_error == rhs.m_error && m_tile_index > rhs.m_tile_index);
+}
+
+AdaptiveTileScheduler::AdaptiveTileScheduler(const double time_limit)
+  : m_time_limit(time_limit)
+  , m_has_pass(false)
+  , m_pass_hash(0)
+{
+}
+
+void AdaptiveTileScheduler::on_tile_begin(const uint32 pass_hash)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (!m_has_pass || pass_hash != m_pass_hash)
+    {
+        m_has_pass = true;
+        m_pass_hash = pass_hash;
+        m_stopwatch.start();
+    }
+}
+
+bool AdaptiveTileScheduler::has_time_left()
+{
+    if (m_time_limit <= 0.0)
+        return true;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    return m_stopwatch.measure().get_seconds() < m_time_limit;
+}
+
+void AdaptiveTileScheduler::push(
+    const size_t                tile_index,
+    const float                 error,
+    unique_ptr<TileData>        data)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    Entry entry;
+    entry.m_error = error;
+    entry.m_tile_index = tile_index;
+    entry.m_data = move(data);
+
+    m_queue.push_back(move(entry));
+    push_heap(m_queue.begin(), m_queue.end());
+}
+
+bool AdaptiveTileScheduler::pop(
+    size_t&                     tile_index,
+    float&                      error,
+    unique_ptr<TileData>&       data)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_queue.empty())
+        return false;
+
+    pop_heap(m_queue.begin(), m_queue.end());
+
+    Entry& entry = m_queue.back();
+    tile_index = entry.m_tile_index;
+    error = entry.m_error;
+    data = move(entry.m_data);
+
+    m_queue.pop_back();
+
+    return true;
+}
+
+size_t AdaptiveTileScheduler::size() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    return m_queue.size();
+}
+
+}   // namespace renderer
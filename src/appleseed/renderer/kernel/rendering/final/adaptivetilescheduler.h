@@ -0,0 +1,114 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/timers.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/stopwatch.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// Frame-level scheduler for adaptive sampling.
+//
+// Tiles that still have noisy pixels after a round of samples are queued together
+// with their noise level and the data needed to resume rendering them. Rendering
+// threads pick the noisiest queued tile first, so that extra samples go where the
+// frame needs them most, regardless of which thread rendered a tile initially.
+// Rounds stop being dispatched once the optional time limit of the pass is reached.
+//
+// This class is thread-safe.
+//
+
+class AdaptiveTileScheduler
+  : public foundation::NonCopyable
+{
+  public:
+    // Base class of the data kept for a queued tile.
+    struct TileData
+    {
+        virtual ~TileData() {}
+    };
+
+    // Constructor. Pass 0 for an unlimited time budget.
+    explicit AdaptiveTileScheduler(const double time_limit);
+
+    // Notify the scheduler that a tile of a given pass is about to be rendered.
+    // The time budget is reset when a new pass begins.
+    void on_tile_begin(const foundation::uint32 pass_hash);
+
+    // Return true if more samples may still be dispatched during the current pass.
+    bool has_time_left();
+
+    // Queue a tile that needs more samples.
+    void push(
+        const size_t                    tile_index,
+        const float                     error,
+        std::unique_ptr<TileData>       data);
+
+    // Retrieve the noisiest queued tile. Return false if no tile is queued.
+    bool pop(
+        size_t&                         tile_index,
+        float&                          error,
+        std::unique_ptr<TileData>&      data);
+
+    // Return the number of queued tiles.
+    size_t size() const;
+
+  private:
+    struct Entry
+    {
+        float                           m_error;
+        size_t                          m_tile_index;
+        std::unique_ptr<TileData>       m_data;
+
+        bool operator<(const Entry& rhs) const;
+    };
+
+    const double                        m_time_limit;
+    mutable boost::mutex                m_mutex;
+    std::vector<Entry>                  m_queue;                // binary max-heap on the error
+    bool                                m_has_pass;
+    foundation::uint32                  m_pass_hash;
+    foundation::Stopwatch<foundation::DefaultWallclockTimer>
+                                        m_stopwatch;
+};
+
+}   // namespace renderer
@@ -60,9 +60,12 @@
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -73,6 +76,9 @@ namespace
     // Uniform pixel renderer.
     //
 
+    // Maximum number of samples handed to the sample renderer at once.
+    const size_t SampleBatchSize = 64;
+
     class UniformPixelRenderer
       : public PixelRendererBase
     {
@@ -85,6 +91,7 @@ namespace
           : m_params(params)
           , m_sample_renderer(factory->create(thread_index))
           , m_sample_count(m_params.m_samples)
+          , m_shading_results(SampleBatchSize)
         {
             const size_t sample_aov_index = frame.aovs().get_index("pixel_sample_count");
 
@@ -144,43 +151,62 @@ namespace
                 0,                          // number of samples -- unknown
                 instance);                  // initial instance number
 
-            for (size_t i = 0; i < m_sample_count; ++i)
+            // Render the samples of the pixel in batches, so that the sample renderer
+            // may trace and shade the samples of a batch together.
+            const auto& filter_table = frame.get_filter_sampling_table();
+            for (size_t i = 0; i < m_sample_count; i += SampleBatchSize)
             {
-                // Generate a uniform sample in [0,1)^2.
-                const Vector2f s =
-                    m_sample_count > 1 || m_params.m_force_aa
-                        ? sampling_context.next2<Vector2f>()
-                        : Vector2f(0.5f);
-
-                // Sample the pixel filter.
-                const auto& filter_table = frame.get_filter_sampling_table();
-                const Vector2d pf(
-                    static_cast<double>(filter_table.sample(s[0]) + 0.5f),
-                    static_cast<double>(filter_table.sample(s[1]) + 0.5f));
-
-                // Compute the sample position in NDC.
-                const Vector2d sample_position = frame.get_sample_position(pi.x + pf.x, pi.y + pf.y);
-
-                // Create a pixel context that identifies the pixel and sample currently being rendered.
-                const PixelContext pixel_context(pi, sample_position);
-
-                // Render the sample.
-                ShadingResult shading_result(aov_count);
-                SamplingContext child_sampling_context(sampling_context);
-                m_sample_renderer->render_sample(
-                    child_sampling_context,
-                    pixel_context,
-                    sample_position,
+                const size_t batch_size = min(m_sample_count - i, SampleBatchSize);
+
+                m_sampling_contexts.clear();
+                m_pixel_contexts.clear();
+                m_sample_positions.clear();
+
+                for (size_t j = 0; j < batch_size; ++j)
+                {
+                    // Generate a uniform sample in [0,1)^2.
+                    const Vector2f s =
+                        m_sample_count > 1 || m_params.m_force_aa
+                            ? sampling_context.next2<Vector2f>()
+                            : Vector2f(0.5f);
+
+                    // Sample the pixel filter.
+                    const Vector2d pf(
+                        static_cast<double>(filter_table.sample(s[0]) + 0.5f),
+                        static_cast<double>(filter_table.sample(s[1]) + 0.5f));
+
+                    // Compute the sample position in NDC.
+                    const Vector2d sample_position = frame.get_sample_position(pi.x + pf.x, pi.y + pf.y);
+                    m_sample_positions.push_back(sample_position);
+
+                    // Create a pixel context that identifies the pixel and sample currently being rendered.
+                    m_pixel_contexts.emplace_back(pi, sample_position);
+
+                    // Create a child sampling context for this sample.
+                    m_sampling_contexts.push_back(sampling_context);
+
+                    m_shading_results[j].clear(aov_count);
+                }
+
+                // Render the samples.
+                m_sample_renderer->render_samples(
+                    batch_size,
+                    &m_sampling_contexts[0],
+                    &m_pixel_contexts[0],
+                    &m_sample_positions[0],
                     aov_accumulators,
-                    shading_result);
-
-                // Update sampling statistics.
-                m_total_sampling_dim.insert(child_sampling_context.get_total_dimension());
-
-                // Merge the sample into the framebuffer.
-                if (shading_result.is_valid())
-                    framebuffer.add(Vector2u(pt), shading_result);
-                else signal_invalid_sample();
+                    &m_shading_results[0]);
+
+                for (size_t j = 0; j < batch_size; ++j)
+                {
+                    // Update sampling statistics.
+                    m_total_sampling_dim.insert(m_sampling_contexts[j].get_total_dimension());
+
+                    // Merge the sample into the framebuffer.
+                    if (m_shading_results[j].is_valid())
+                        framebuffer.add(Vector2u(pt), m_shading_results[j]);
+                    else signal_invalid_sample();
+                }
             }
 
             on_pixel_end(frame, pi, pt, tile_bbox, aov_accumulators);
@@ -222,6 +248,11 @@ namespace
         auto_release_ptr<ISampleRenderer>   m_sample_renderer;
         const size_t                        m_sample_count;
         Population<uint64>                  m_total_sampling_dim;
+
+        std::vector<SamplingContext>        m_sampling_contexts;
+        std::vector<PixelContext>           m_pixel_contexts;
+        std::vector<Vector2d>               m_sample_positions;
+        std::vector<ShadingResult>          m_shading_results;
     };
 }
 
@@ -52,12 +52,12 @@
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/containers/dictionary.h"
-#include "foundation/utility/foreach.h"
 #include "foundation/utility/job.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <memory>
@@ -103,7 +103,9 @@ namespace
                     global_logger(),
                     m_job_queue,
                     m_params.m_thread_count,
-                    JobManager::KeepRunningOnEmptyQueue));
+                    JobManager::KeepRunningOnEmptyQueue |
+                    (m_params.m_work_stealing || m_params.m_tile_affinity ? JobManager::WorkStealing : 0) |
+                    (m_params.m_numa_pinning ? JobManager::PinThreadsToNumaNodes : 0)));
 
             // Instantiate tile renderers, one per rendering thread.
             m_tile_renderers.reserve(m_params.m_thread_count);
@@ -150,14 +152,22 @@ namespace
                 "  sampling mode                 %s\n"
                 "  rendering threads             %s\n"
                 "  tile ordering                 %s\n"
-                "  passes                        %s",
+                "  tile splitting                %s\n"
+                "  tile affinity                 %s\n"
+                "  passes                        %s\n"
+                "  work stealing                 %s\n"
+                "  numa pinning                  %s",
                 get_spectrum_mode_name(m_params.m_spectrum_mode).c_str(),
                 get_sampling_context_mode_name(m_params.m_sampling_mode).c_str(),
                 pretty_uint(m_params.m_thread_count).c_str(),
                 m_params.m_tile_ordering == TileJobFactory::TileOrdering::LinearOrdering ? "linear" :
                 m_params.m_tile_ordering == TileJobFactory::TileOrdering::SpiralOrdering ? "spiral" :
                 m_params.m_tile_ordering == TileJobFactory::TileOrdering::HilbertOrdering ? "hilbert" : "random",
-                pretty_uint(m_params.m_pass_count).c_str());
+                m_params.m_tile_splitting ? "on" : "off",
+                m_params.m_tile_affinity ? "on" : "off",
+                pretty_uint(m_params.m_pass_count).c_str(),
+                m_params.m_work_stealing ? "on" : "off",
+                m_params.m_numa_pinning ? "on" : "off");
 
             m_tile_renderers.front()->print_settings();
         }
@@ -173,6 +183,11 @@ namespace
             return m_is_rendering;
         }
 
+        double get_remaining_time() const override
+        {
+            return -1.0;
+        }
+
         void start_rendering() override
         {
             assert(!is_rendering());
@@ -194,6 +209,8 @@ namespace
                     m_pass_callback,
                     m_params.m_spectrum_mode,
                     m_params.m_tile_ordering,
+                    m_params.m_tile_splitting,
+                    m_params.m_tile_affinity,
                     m_params.m_pass_count,
                     m_job_queue,
                     m_params.m_thread_count,
@@ -201,21 +218,25 @@ namespace
                     m_is_rendering));
             ThreadFunctionWrapper<PassManagerFunc> wrapper(m_pass_manager_func.get());
             m_pass_manager_thread.reset(new boost::thread(wrapper));
+
+            // Resume rendering if it was paused.
+            resume_rendering();
         }
 
         void stop_rendering() override
         {
-            // First, delete scheduled jobs to prevent worker threads from picking them up.
-            m_job_queue.clear_scheduled_jobs();
-
-            // Tell rendering jobs and the pass manager thread to stop.
+            // First, tell rendering jobs and the pass manager thread to stop.
             m_abort_switch.abort();
 
+            // Delete scheduled jobs to prevent worker threads from picking them up.
+            m_job_queue.clear_scheduled_jobs();
+
             // Wait until the pass manager thread has stopped.
             m_pass_manager_thread->join();
 
-            // Stop job execution.
-            m_job_manager->stop();
+            // Wait until rendering jobs have effectively stopped. Worker threads are
+            // kept alive so that rendering can restart without recreating them.
+            m_job_queue.wait_until_completion();
         }
 
         void pause_rendering() override
@@ -232,6 +253,9 @@ namespace
         {
             stop_rendering();
 
+            // Stop job execution.
+            m_job_manager->stop();
+
             print_tile_renderers_stats();
         }
 
@@ -242,14 +266,22 @@ namespace
             const SamplingContext::Mode         m_sampling_mode;
             const size_t                        m_thread_count;     // number of rendering threads
             const TileJobFactory::TileOrdering  m_tile_ordering;    // tile rendering order
+            const bool                          m_tile_splitting;   // split the last tiles of the frame into regions?
+            const bool                          m_tile_affinity;    // render contiguous ranges of tiles on each thread?
             const size_t                        m_pass_count;       // number of rendering passes
+            const bool                          m_work_stealing;    // use per-thread job deques with work stealing?
+            const bool                          m_numa_pinning;     // pin rendering threads to NUMA nodes?
 
             explicit Parameters(const ParamArray& params)
               : m_spectrum_mode(get_spectrum_mode(params))
               , m_sampling_mode(get_sampling_context_mode(params))
               , m_thread_count(get_rendering_thread_count(params))
               , m_tile_ordering(get_tile_ordering(params))
+              , m_tile_splitting(params.get_optional<bool>("tile_splitting", true))
+              , m_tile_affinity(params.get_optional<bool>("tile_affinity", false))
               , m_pass_count(params.get_optional<size_t>("passes", 1))
+              , m_work_stealing(params.get_optional<bool>("work_stealing", false))
+              , m_numa_pinning(params.get_optional<bool>("numa_pinning", false))
             {
             }
 
@@ -299,6 +331,8 @@ namespace
                 IPassCallback*                      pass_callback,
                 const Spectrum::Mode                spectrum_mode,
                 const TileJobFactory::TileOrdering  tile_ordering,
+                const bool                          tile_splitting,
+                const bool                          tile_affinity,
                 const size_t                        pass_count,
                 JobQueue&                           job_queue,
                 const size_t                        thread_count,
@@ -311,6 +345,8 @@ namespace
               , m_pass_callback(pass_callback)
               , m_spectrum_mode(spectrum_mode)
               , m_tile_ordering(tile_ordering)
+              , m_tile_splitting(tile_splitting)
+              , m_tile_affinity(tile_affinity)
               , m_pass_count(pass_count)
               , m_job_queue(job_queue)
               , m_thread_count(thread_count)
@@ -324,19 +360,17 @@ namespace
                 set_current_thread_name("pass_manager");
 
                 const size_t start_pass = m_frame.get_initial_pass();
+                const size_t end_pass = min(m_frame.get_end_pass(), m_pass_count);
 
                 //
                 // Rendering passes.
                 //
 
-                for (size_t pass = start_pass; pass < m_pass_count; ++pass)
+                for (size_t pass = start_pass; pass < end_pass; ++pass)
                 {
                     // Check abort flag.
                     if (m_abort_switch.is_aborted())
-                    {
-                        m_is_rendering = false;
-                        return;
-                    }
+                        break;
 
                     if (m_pass_count > 1)
                         RENDERER_LOG_INFO("--- beginning rendering pass %s ---", pretty_uint(pass + 1).c_str());
@@ -353,9 +387,18 @@ namespace
                     for (auto tile_callback : m_tile_callbacks)
                         tile_callback->on_tiled_frame_begin(&m_frame);
 
+                    // Post-process tiles and write them to the output file as they are finished during the last pass.
+                    const bool last_pass = pass + 1 == end_pass;
+                    if (last_pass)
+                    {
+                        m_frame.begin_incremental_post_processing();
+                        m_frame.begin_output_streaming(can_release_tiles());
+                    }
+
                     // Create tile jobs.
                     const uint32 pass_hash = mix_uint32(m_frame.get_noise_seed(), static_cast<uint32>(pass));
                     TileJobFactory::TileJobVector tile_jobs;
+                    TileJobFactory::ThreadIndexVector tile_job_threads;
                     m_tile_job_factory.create(
                         m_frame,
                         m_tile_ordering,
@@ -363,12 +406,19 @@ namespace
                         m_tile_callbacks,
                         pass_hash,
                         m_spectrum_mode,
+                        m_tile_splitting,
                         tile_jobs,
+                        tile_job_threads,
                         m_abort_switch);
 
-                    // Schedule tile jobs.
-                    for (const_each<TileJobFactory::TileJobVector> i = tile_jobs; i; ++i)
-                        m_job_queue.schedule(*i);
+                    // Schedule tile jobs. With tile affinity, each rendering thread gets its own range of
+                    // tiles, the same at every pass, and only steals tiles from other threads once done.
+                    for (size_t i = 0, e = tile_jobs.size(); i < e; ++i)
+                    {
+                        if (m_tile_affinity)
+                            m_job_queue.schedule_on_worker(tile_jobs[i], tile_job_threads[i]);
+                        else m_job_queue.schedule(tile_jobs[i]);
+                    }
 
                     // Wait until tile jobs have effectively stopped.
                     m_job_queue.wait_until_completion();
@@ -377,6 +427,9 @@ namespace
                     for (auto tile_callback : m_tile_callbacks)
                         tile_callback->on_tiled_frame_end(&m_frame);
 
+                    if (last_pass)
+                        m_frame.end_output_streaming();
+
                     // Invoke the post-pass callback if there is one.
                     if (m_pass_callback)
                     {
@@ -388,6 +441,9 @@ namespace
                     m_frame.save_checkpoint(m_framebuffer_factory, pass);
                 }
 
+                // Make sure the last checkpoint is on disk before returning.
+                m_frame.wait_for_checkpoint();
+
                 // Check abort flag.
                 if (m_abort_switch.is_aborted())
                 {
@@ -411,7 +467,7 @@ namespace
                     on_tile_begin_whole_frame();
 
                     // Denoise the frame.
-                    m_frame.denoise(m_thread_count, &m_abort_switch);
+                    m_frame.denoise(m_job_queue, m_thread_count, &m_abort_switch);
 
                     // Call on_tile_end() on all tiles of the frame.
                     on_tile_end_whole_frame();
@@ -428,6 +484,8 @@ namespace
             IPassCallback*                          m_pass_callback;
             const Spectrum::Mode                    m_spectrum_mode;
             const TileJobFactory::TileOrdering      m_tile_ordering;
+            const bool                              m_tile_splitting;
+            const bool                              m_tile_affinity;
             const size_t                            m_pass_count;
             JobQueue&                               m_job_queue;
             const size_t                            m_thread_count;
@@ -435,6 +493,18 @@ namespace
             bool&                                   m_is_rendering;
             TileJobFactory                          m_tile_job_factory;
 
+            // Return true if tiles can be released from memory once on_tile_end() has returned.
+            bool can_release_tiles() const
+            {
+                for (auto tile_callback : m_tile_callbacks)
+                {
+                    if (!tile_callback->accesses_tiles_synchronously())
+                        return false;
+                }
+
+                return true;
+            }
+
             void on_tile_begin_whole_frame()
             {
                 if (!m_tile_callbacks.empty())
@@ -539,6 +609,22 @@ Dictionary GenericFrameRendererFactory::get_params_metadata()
                             .insert("label", "Random")
                             .insert("help", "Random tile ordering"))));
 
+    metadata.dictionaries().insert(
+        "tile_splitting",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "true")
+            .insert("label", "Tile Splitting")
+            .insert("help", "Split the last tiles of the frame into smaller regions to keep all rendering threads busy"));
+
+    metadata.dictionaries().insert(
+        "tile_affinity",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Tile Affinity")
+            .insert("help", "Render a contiguous range of tiles on each rendering thread to improve cache locality; idle threads steal tiles from other threads"));
+
     return metadata;
 }
 
@@ -55,6 +55,7 @@
 #include "foundation/utility/statistics.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -166,6 +167,39 @@ namespace
             if (x >= m_window_width || y >= m_window_height)
                 return 0;
 
+            return render_sample(x, y, sequence_index, samples);
+        }
+
+        bool generate_bootstrap_samples(
+            const size_t                    block_size,
+            const size_t                    block_index,
+            SampleVector&                   samples) override
+        {
+            const int b = static_cast<int>(block_size);
+            const size_t block_count_x = static_cast<size_t>((m_window_width + b - 1) / b);
+            const size_t block_count_y = static_cast<size_t>((m_window_height + b - 1) / b);
+
+            if (block_index >= block_count_x * block_count_y)
+                return false;
+
+            // Render the pixel at the center of the block.
+            const int bx = static_cast<int>(block_index % block_count_x);
+            const int by = static_cast<int>(block_index / block_count_x);
+            const int x = min(bx * b + b / 2, m_window_width - 1);
+            const int y = min(by * b + b / 2, m_window_height - 1);
+
+            render_sample(x, y, block_index, samples);
+
+            return true;
+        }
+
+        // Render a sample in a given pixel of the crop window.
+        size_t render_sample(
+            const int                       x,
+            const int                       y,
+            const size_t                    sequence_index,
+            SampleVector&                   samples)
+        {
             // Create a sampling context. We start with an initial dimension of 2,
             // corresponding to the Halton sequence used for the sample positions.
             SamplingContext sampling_context(
@@ -38,6 +38,8 @@
 #include "renderer/kernel/intersection/tracecontext.h"
 #include "renderer/kernel/lighting/ilightingengine.h"
 #include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/rendering/pixelcontext.h"
+#include "renderer/kernel/rendering/primaryhitcache.h"
 #include "renderer/kernel/shading/oslshadergroupexec.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
 #include "renderer/kernel/shading/shadingcontext.h"
@@ -47,14 +49,22 @@
 #include "renderer/kernel/shading/shadingresult.h"
 #include "renderer/kernel/texturing/oiiotexturesystem.h"
 #include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/bssrdf/bssrdf.h"
 #include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/input/inputarray.h"
+#include "renderer/modeling/input/source.h"
+#include "renderer/modeling/material/material.h"
 #include "renderer/modeling/scene/scene.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
 #include "foundation/image/image.h"
 #include "foundation/image/regularspectrum.h"
+#include "foundation/math/raysorting.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/arena.h"
@@ -62,12 +72,11 @@
 #include "foundation/utility/string.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 #include <string>
-
-// Forward declarations.
-namespace renderer  { class PixelContext; }
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -98,6 +107,7 @@ namespace
             ShadingEngine&          shading_engine,
             OIIOTextureSystem&      oiio_texture_system,
             OSLShadingSystem&       shading_system,
+            PrimaryHitCache*        primary_hit_cache,
             const size_t            thread_index,
             const ParamArray&       params)
           : m_params(params)
@@ -119,7 +129,8 @@ namespace
                 m_shadergroup_exec,
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations,
-                thread_index == 0)
+                thread_index == 0,
+                m_params.m_occluder_cache)
           , m_shading_context(
                 m_intersector,
                 m_tracer,
@@ -131,6 +142,9 @@ namespace
                 m_lighting_engine,
                 m_params.m_transparency_threshold,
                 m_params.m_max_iterations)
+          , m_primary_hit_cache(primary_hit_cache)
+          , m_primary_hit_cache_lookup_count(0)
+          , m_primary_hit_cache_hit_count(0)
         {
             // 1/4 of a pixel, like in RenderMan RIS.
             const CanvasProperties& c = frame.image().properties();
@@ -154,10 +168,16 @@ namespace
                 "generic sample renderer settings:\n"
                 "  transparency threshold        %f\n"
                 "  max iterations                %s\n"
-                "  report self intersections     %s",
+                "  report self intersections     %s\n"
+                "  wavefront                     %s\n"
+                "  osl batch size                %s\n"
+                "  occluder cache                %s",
                 m_params.m_transparency_threshold,
                 pretty_uint(m_params.m_max_iterations).c_str(),
-                m_params.m_report_self_intersections ? "on" : "off");
+                m_params.m_report_self_intersections ? "on" : "off",
+                m_params.m_wavefront ? "on" : "off",
+                pretty_uint(m_params.m_osl_batch_size).c_str(),
+                m_params.m_occluder_cache ? "on" : "off");
 
             m_lighting_engine->print_settings();
         }
@@ -183,14 +203,245 @@ namespace
                 Dual2d(image_point, m_image_point_dx, m_image_point_dy),
                 primary_ray);
 
+            // Reuse the first hit of this camera ray from a previous render if possible.
+            const ShadingPoint* first_hit = nullptr;
+            if (m_primary_hit_cache != nullptr)
+            {
+                ++m_primary_hit_cache_lookup_count;
+
+                m_cached_first_hit.clear();
+                if (m_primary_hit_cache->lookup(
+                        pixel_context.get_pixel_coords(),
+                        primary_ray,
+                        m_scene,
+                        m_texture_cache,
+                        m_cached_first_hit))
+                    ++m_primary_hit_cache_hit_count;
+                else
+                {
+                    m_intersector.trace(primary_ray, m_cached_first_hit);
+                    m_primary_hit_cache->insert(pixel_context.get_pixel_coords(), m_cached_first_hit);
+                }
+
+                first_hit = &m_cached_first_hit;
+            }
+
+            // Inform the AOV accumulators that we are about to render a sample.
+            aov_accumulators.on_sample_begin(pixel_context);
+
+            // Trace and shade the primary ray.
+            render_ray(
+                sampling_context,
+                pixel_context,
+                primary_ray,
+                first_hit,
+                aov_accumulators,
+                shading_result);
+
+            // Inform the AOV accumulators that we are done rendering a sample.
+            aov_accumulators.on_sample_end(pixel_context);
+
+#ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCE
+
+            const uint64 delta_hit_count = m_texture_cache.get_hit_count() - last_texture_cache_hit_count;
+            const uint64 delta_miss_count = m_texture_cache.get_miss_count() - last_texture_cache_miss_count;
+
+            if (delta_hit_count + delta_miss_count == 0)
+            {
+                // In black: no access to the texture cache.
+                shading_result.m_main = Color4f(0.0f, 0.0f, 0.0f, 1.0f);
+            }
+            else if (delta_hit_count > delta_miss_count)
+            {
+                // In green: a majority of cache hits.
+                shading_result.m_main = Color4f(0.0f, 1.0f, 0.0f, 1.0f);
+            }
+            else
+            {
+                // In red: a majority of cache misses.
+                shading_result.m_main = Color4f(1.0f, 0.0f, 0.0f, 1.0f);
+            }
+
+#endif
+        }
+
+        void render_samples(
+            const size_t                sample_count,
+            SamplingContext*            sampling_contexts,
+            const PixelContext*         pixel_contexts,
+            const Vector2d*             image_points,
+            AOVAccumulatorContainer&    aov_accumulators,
+            ShadingResult*              shading_results) override
+        {
+            if (!m_params.m_wavefront || sample_count < 2)
+            {
+                ISampleRenderer::render_samples(
+                    sample_count,
+                    sampling_contexts,
+                    pixel_contexts,
+                    image_points,
+                    aov_accumulators,
+                    shading_results);
+                return;
+            }
+
+            // Construct the primary rays.
+            m_primary_ray_ndcs.resize(sample_count);
+            for (size_t i = 0; i < sample_count; ++i)
+                m_primary_ray_ndcs[i] = Dual2d(image_points[i], m_image_point_dx, m_image_point_dy);
+            m_primary_rays.resize(sample_count);
+            m_scene.get_active_camera()->spawn_rays(
+                sample_count,
+                sampling_contexts,
+                &m_primary_ray_ndcs[0],
+                &m_primary_rays[0]);
+
+            // Sort the primary rays by direction and origin.
+            ray_sort_ordering(m_ray_ordering, &m_primary_rays[0], sample_count);
+            m_sorted_rays.resize(sample_count);
+            for (size_t i = 0; i < sample_count; ++i)
+                m_sorted_rays[i] = m_primary_rays[m_ray_ordering[i]];
+
+            // Trace all the primary rays at once.
+            m_first_hits.resize(sample_count);
+            for (size_t i = 0; i < sample_count; ++i)
+                m_first_hits[i].clear();
+            m_intersector.trace(&m_sorted_rays[0], &m_first_hits[0], sample_count);
+
+            // Group the hits by material so that samples sharing a material are shaded together.
+            m_hit_materials.resize(sample_count);
+            m_shading_ordering.resize(sample_count);
+            for (size_t i = 0; i < sample_count; ++i)
+            {
+                m_hit_materials[i] =
+                    m_first_hits[i].hit_surface() ? m_first_hits[i].get_material() : nullptr;
+                m_shading_ordering[i] = i;
+            }
+            stable_sort(
+                m_shading_ordering.begin(),
+                m_shading_ordering.end(),
+                [this](const size_t lhs, const size_t rhs)
+                {
+                    return m_hit_materials[lhs] < m_hit_materials[rhs];
+                });
+
+            // Let the texture store's I/O threads load the tiles needed by the first hits while we shade.
+            if (m_texture_cache.is_prefetching_enabled())
+            {
+                for (size_t i = 0; i < sample_count; ++i)
+                {
+                    if (m_hit_materials[i] != nullptr)
+                        prefetch_textures(m_first_hits[i], *m_hit_materials[i]);
+                }
+            }
+
+            // Shade the samples.
+            for (size_t begin = 0; begin < sample_count; )
+            {
+                // Find the run of consecutive samples that can share an OSL batch.
+                const ShaderGroup* shader_group = get_shader_group(m_shading_ordering[begin]);
+                size_t end = begin + 1;
+                while (end < sample_count &&
+                       end - begin < m_params.m_osl_batch_size &&
+                       get_shader_group(m_shading_ordering[end]) == shader_group)
+                    ++end;
+
+                // Run the surface shader of the first hits of these samples back-to-back.
+                if (shader_group != nullptr && end - begin > 1)
+                {
+                    const ShadingPoint* batch[OSLShaderGroupExec::MaxBatchSize];
+                    for (size_t i = begin; i < end; ++i)
+                        batch[i - begin] = &m_first_hits[m_shading_ordering[i]];
+                    m_shading_context.execute_osl_shading_batch(*shader_group, batch, end - begin);
+                }
+
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const size_t ray_index = m_shading_ordering[i];
+                    const size_t sample_index = m_ray_ordering[ray_index];
+                    const PixelContext& pixel_context = pixel_contexts[sample_index];
+
+                    aov_accumulators.on_sample_begin(pixel_context);
+                    render_ray(
+                        sampling_contexts[sample_index],
+                        pixel_context,
+                        m_sorted_rays[ray_index],
+                        &m_first_hits[ray_index],
+                        aov_accumulators,
+                        shading_results[sample_index]);
+                    aov_accumulators.on_sample_end(pixel_context);
+                }
+
+                begin = end;
+            }
+        }
+
+        StatisticsVector get_statistics() const override
+        {
+            StatisticsVector stats;
+
+            if (m_primary_hit_cache != nullptr)
+            {
+                Statistics primary_hit_cache_stats;
+                primary_hit_cache_stats.insert("lookups", m_primary_hit_cache_lookup_count);
+                primary_hit_cache_stats.insert_percent(
+                    "hits",
+                    m_primary_hit_cache_hit_count,
+                    m_primary_hit_cache_lookup_count);
+                stats.insert("primary hit cache statistics", primary_hit_cache_stats);
+            }
+
+            stats.merge(m_texture_cache.get_statistics());
+            stats.merge(m_intersector.get_statistics());
+            stats.merge(m_tracer.get_statistics());
+            stats.merge(m_lighting_engine->get_statistics());
+            return stats;
+        }
+
+      private:
+        // Return the OSL shader group of the material at the first hit of a ray, if any.
+        const ShaderGroup* get_shader_group(const size_t ray_index) const
+        {
+            const Material* material = m_hit_materials[ray_index];
+            return material != nullptr ? material->get_render_data().m_shader_group : nullptr;
+        }
+
+        void prefetch_textures(
+            const ShadingPoint&         shading_point,
+            const Material&             material)
+        {
+            const Vector2f& uv = shading_point.get_uv(0);
+            const Vector2f& duvdx = shading_point.get_duvdx(0);
+            const Vector2f& duvdy = shading_point.get_duvdy(0);
+
+            const Material::RenderData& render_data = material.get_render_data();
+
+            if (render_data.m_bsdf)
+                render_data.m_bsdf->get_inputs().prefetch(m_texture_cache, uv, duvdx, duvdy);
+
+            if (render_data.m_bssrdf)
+                render_data.m_bssrdf->get_inputs().prefetch(m_texture_cache, uv, duvdx, duvdy);
+
+            if (render_data.m_edf)
+                render_data.m_edf->get_inputs().prefetch(m_texture_cache, uv, duvdx, duvdy);
+
+            if (render_data.m_alpha_map)
+                render_data.m_alpha_map->prefetch(m_texture_cache, uv, duvdx, duvdy);
+        }
+
+        void render_ray(
+            SamplingContext&            sampling_context,
+            const PixelContext&         pixel_context,
+            ShadingRay&                 primary_ray,
+            const ShadingPoint*         first_hit,
+            AOVAccumulatorContainer&    aov_accumulators,
+            ShadingResult&              shading_result)
+        {
             ShadingPoint shading_points[2];
             size_t shading_point_index = 0;
             const ShadingPoint* shading_point_ptr = nullptr;
             size_t iterations = 0;
 
-            // Inform the AOV accumulators that we are about to render a sample.
-            aov_accumulators.on_sample_begin(pixel_context);
-
             while (true)
             {
                 // Put a hard limit on the number of iterations.
@@ -204,16 +455,24 @@ namespace
 
                 m_arena.clear();
 
-                // Trace the ray.
-                shading_points[shading_point_index].clear();
-                m_intersector.trace(
-                    primary_ray,
-                    shading_points[shading_point_index],
-                    shading_point_ptr);
-
-                // Update the pointers to the shading points.
-                shading_point_ptr = &shading_points[shading_point_index];
-                shading_point_index = 1 - shading_point_index;
+                if (iterations == 1 && first_hit != nullptr)
+                {
+                    // The first intersection was found ahead of time.
+                    shading_point_ptr = first_hit;
+                }
+                else
+                {
+                    // Trace the ray.
+                    shading_points[shading_point_index].clear();
+                    m_intersector.trace(
+                        primary_ray,
+                        shading_points[shading_point_index],
+                        shading_point_ptr);
+
+                    // Update the pointers to the shading points.
+                    shading_point_ptr = &shading_points[shading_point_index];
+                    shading_point_index = 1 - shading_point_index;
+                }
 
                 if (iterations == 1)
                 {
@@ -265,54 +524,28 @@ namespace
                     primary_ray.m_ry.m_org = primary_ray.m_ry.point_at(t);
                 }
             }
-
-            // Inform the AOV accumulators that we are done rendering a sample.
-            aov_accumulators.on_sample_end(pixel_context);
-
-#ifdef DEBUG_DISPLAY_TEXTURE_CACHE_PERFORMANCE
-
-            const uint64 delta_hit_count = m_texture_cache.get_hit_count() - last_texture_cache_hit_count;
-            const uint64 delta_miss_count = m_texture_cache.get_miss_count() - last_texture_cache_miss_count;
-
-            if (delta_hit_count + delta_miss_count == 0)
-            {
-                // In black: no access to the texture cache.
-                shading_result.m_main = Color4f(0.0f, 0.0f, 0.0f, 1.0f);
-            }
-            else if (delta_hit_count > delta_miss_count)
-            {
-                // In green: a majority of cache hits.
-                shading_result.m_main = Color4f(0.0f, 1.0f, 0.0f, 1.0f);
-            }
-            else
-            {
-                // In red: a majority of cache misses.
-                shading_result.m_main = Color4f(1.0f, 0.0f, 0.0f, 1.0f);
-            }
-
-#endif
         }
 
-        StatisticsVector get_statistics() const override
-        {
-            StatisticsVector stats;
-            stats.merge(m_texture_cache.get_statistics());
-            stats.merge(m_intersector.get_statistics());
-            stats.merge(m_lighting_engine->get_statistics());
-            return stats;
-        }
-
-      private:
         struct Parameters
         {
             const float     m_transparency_threshold;
             const size_t    m_max_iterations;
             const bool      m_report_self_intersections;
+            const bool      m_wavefront;
+            const size_t    m_osl_batch_size;
+            const bool      m_occluder_cache;
 
             explicit Parameters(const ParamArray& params)
               : m_transparency_threshold(params.get_optional<float>("transparency_threshold", 0.001f))
               , m_max_iterations(params.get_optional<size_t>("max_iterations", 100))
               , m_report_self_intersections(params.get_optional<bool>("report_self_intersections", false))
+              , m_wavefront(params.get_optional<bool>("wavefront", false))
+              , m_osl_batch_size(
+                    clamp<size_t>(
+                        params.get_optional<size_t>("osl_batch_size", 8),
+                        1,
+                        OSLShaderGroupExec::MaxBatchSize))
+              , m_occluder_cache(params.get_optional<bool>("occluder_cache", true))
             {
             }
         };
@@ -334,6 +567,21 @@ namespace
 
         Vector2d                    m_image_point_dx;
         Vector2d                    m_image_point_dy;
+
+        // Primary hit cache.
+        PrimaryHitCache*            m_primary_hit_cache;
+        ShadingPoint                m_cached_first_hit;
+        uint64                      m_primary_hit_cache_lookup_count;
+        uint64                      m_primary_hit_cache_hit_count;
+
+        // Wavefront mode.
+        vector<Dual2d>              m_primary_ray_ndcs;
+        vector<ShadingRay>          m_primary_rays;
+        vector<ShadingRay>          m_sorted_rays;
+        vector<ShadingPoint>        m_first_hits;
+        vector<const Material*>     m_hit_materials;
+        vector<size_t>              m_ray_ordering;
+        vector<size_t>              m_shading_ordering;
     };
 }
 
@@ -351,6 +599,7 @@ GenericSampleRendererFactory::GenericSampleRendererFactory(
     ShadingEngine&          shading_engine,
     OIIOTextureSystem&      oiio_texture_system,
     OSLShadingSystem&       shading_system,
+    PrimaryHitCache*        primary_hit_cache,
     const ParamArray&       params)
   : m_scene(scene)
   , m_frame(frame)
@@ -360,6 +609,7 @@ GenericSampleRendererFactory::GenericSampleRendererFactory(
   , m_shading_engine(shading_engine)
   , m_oiio_texture_system(oiio_texture_system)
   , m_shading_system(shading_system)
+  , m_primary_hit_cache(primary_hit_cache)
   , m_params(params)
 {
 }
@@ -381,6 +631,7 @@ ISampleRenderer* GenericSampleRendererFactory::create(const size_t thread_index)
             m_shading_engine,
             m_oiio_texture_system,
             m_shading_system,
+            m_primary_hit_cache,
             thread_index,
             m_params);
 }
@@ -41,6 +41,7 @@ namespace renderer  { class Frame; }
 namespace renderer  { class ILightingEngineFactory; }
 namespace renderer  { class OIIOTextureSystem; }
 namespace renderer  { class OSLShadingSystem; }
+namespace renderer  { class PrimaryHitCache; }
 namespace renderer  { class Scene; }
 namespace renderer  { class ShadingEngine; }
 namespace renderer  { class TextureStore; }
@@ -57,7 +58,7 @@ class GenericSampleRendererFactory
   : public ISampleRendererFactory
 {
   public:
-    // Constructor.
+    // Constructor. `primary_hit_cache` may be nullptr.
     GenericSampleRendererFactory(
         const Scene&            scene,
         const Frame&            frame,
@@ -67,6 +68,7 @@ class GenericSampleRendererFactory
         ShadingEngine&          shading_engine,
         OIIOTextureSystem&      oiio_texture_system,
         OSLShadingSystem&       shading_system,
+        PrimaryHitCache*        primary_hit_cache,
         const ParamArray&       params);
 
     // Delete this instance.
@@ -85,6 +87,7 @@ class GenericSampleRendererFactory
     ShadingEngine&              m_shading_engine;
     OIIOTextureSystem&          m_oiio_texture_system;
     OSLShadingSystem&           m_shading_system;
+    PrimaryHitCache*            m_primary_hit_cache;
     const ParamArray            m_params;
 };
 
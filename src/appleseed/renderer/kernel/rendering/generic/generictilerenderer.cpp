@@ -40,6 +40,8 @@
 #include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
 #include "renderer/kernel/rendering/pixelcontext.h"
 #include "renderer/kernel/rendering/shadingresultframebuffer.h"
+#include "renderer/modeling/aov/aov.h"
+#include "renderer/modeling/aov/aovcontainer.h"
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/utility/bbox.h"
 
@@ -88,6 +90,17 @@ namespace
 
 #endif
 
+    bool has_cryptomatte_aov(const Frame& frame)
+    {
+        for (size_t i = 0, e = frame.aovs().size(); i < e; ++i)
+        {
+            if (starts_with(frame.aovs().get_by_index(i)->get_model(), "cryptomatte_"))
+                return true;
+        }
+
+        return false;
+    }
+
     class GenericTileRenderer
       : public ITileRenderer
     {
@@ -101,6 +114,10 @@ namespace
           : m_pixel_renderer(pixel_renderer_factory->create(thread_index))
           , m_aov_accumulators(frame)
           , m_framebuffer_factory(framebuffer_factory)
+          , m_supports_tile_regions(
+                // Permanent framebuffers are shared by all the regions of a tile, and
+                // cryptomatte accumulators process whole tiles in on_tile_end().
+                !framebuffer_factory->is_permanent() && !has_cryptomatte_aov(frame))
         {
             compute_pixel_ordering(frame);
         }
@@ -121,6 +138,54 @@ namespace
             const size_t    tile_y,
             const uint32    pass_hash,
             IAbortSwitch&   abort_switch) override
+        {
+            const Tile& tile = frame.image().tile(tile_x, tile_y);
+            const AABB2u region(
+                Vector2u(0, 0),
+                Vector2u(
+                    static_cast<uint32>(tile.get_width() - 1),
+                    static_cast<uint32>(tile.get_height() - 1)));
+
+            render_region(frame, tile_x, tile_y, region, false, pass_hash, abort_switch);
+        }
+
+        bool supports_tile_regions() const override
+        {
+            return m_supports_tile_regions;
+        }
+
+        void render_tile_region(
+            const Frame&    frame,
+            const size_t    tile_x,
+            const size_t    tile_y,
+            const AABB2u&   region,
+            const uint32    pass_hash,
+            IAbortSwitch&   abort_switch) override
+        {
+            assert(m_supports_tile_regions);
+            render_region(frame, tile_x, tile_y, region, true, pass_hash, abort_switch);
+        }
+
+        StatisticsVector get_statistics() const override
+        {
+            return m_pixel_renderer->get_statistics();
+        }
+
+      protected:
+        auto_release_ptr<IPixelRenderer>    m_pixel_renderer;
+        AOVAccumulatorContainer             m_aov_accumulators;
+        IShadingResultFrameBufferFactory*   m_framebuffer_factory;
+        const bool                          m_supports_tile_regions;
+        vector<Vector<int16, 2>>            m_pixel_ordering;
+
+        void render_region(
+            const Frame&    frame,
+            const size_t    tile_x,
+            const size_t    tile_y,
+            const AABB2u&   region,
+            const bool      partial_tile,
+            const uint32    pass_hash,
+            IAbortSwitch&   abort_switch)
         {
             // Retrieve frame properties.
             const CanvasProperties& frame_properties = frame.image().properties();
@@ -137,12 +202,14 @@ namespace
 
             // Compute the tile space bounding box of the pixels to render.
             const AABB2i tile_bbox =
-                compute_tile_space_bbox(
-                    tile_origin_x,
-                    tile_origin_y,
-                    tile_width,
-                    tile_height,
-                    frame.get_crop_window());
+                AABB2i::intersect(
+                    compute_tile_space_bbox(
+                        tile_origin_x,
+                        tile_origin_y,
+                        tile_width,
+                        tile_height,
+                        frame.get_crop_window()),
+                    AABB2i(region));
             if (!tile_bbox.is_valid())
                 return;
 
@@ -207,8 +274,12 @@ namespace
                     *framebuffer);
             }
 
-            // Develop the framebuffer to the tile.
-            framebuffer->develop_to_tile(tile, aov_tiles);
+            // Develop the framebuffer to the tile. Other regions of the tile may be
+            // rendered concurrently, so only develop the pixels of this region then.
+            if (partial_tile)
+                framebuffer->develop_to_tile(tile, aov_tiles, AABB2u(tile_bbox));
+            else
+                framebuffer->develop_to_tile(tile, aov_tiles);
 
             // Release the framebuffer.
             m_framebuffer_factory->destroy(framebuffer);
@@ -225,17 +296,6 @@ namespace
                 aov_tiles);
         }
 
-        StatisticsVector get_statistics() const override
-        {
-            return m_pixel_renderer->get_statistics();
-        }
-
-      protected:
-        auto_release_ptr<IPixelRenderer>    m_pixel_renderer;
-        AOVAccumulatorContainer             m_aov_accumulators;
-        IShadingResultFrameBufferFactory*   m_framebuffer_factory;
-        vector<Vector<int16, 2>>            m_pixel_ordering;
-
         void compute_pixel_ordering(const Frame& frame)
         {
             // Compute the dimensions in pixels of the tile.
@@ -39,6 +39,7 @@
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
+#include "foundation/utility/eventtracer.h"
 
 // Standard headers.
 #include <cassert>
@@ -54,6 +55,12 @@ namespace renderer
 // TileJob class implementation.
 //
 
+TileJob::TileRegions::TileRegions(const size_t region_count)
+  : m_started_count(0)
+  , m_remaining_count(region_count)
+{
+}
+
 TileJob::TileJob(
     const TileRendererVector&   tile_renderers,
     const TileCallbackVector&   tile_callbacks,
@@ -68,6 +75,7 @@ TileJob::TileJob(
   , m_frame(frame)
   , m_tile_x(tile_x)
   , m_tile_y(tile_y)
+  , m_region(AABB2u::invalid())
   , m_pass_hash(pass_hash)
   , m_spectrum_mode(spectrum_mode)
   , m_abort_switch(abort_switch)
@@ -79,8 +87,38 @@ TileJob::TileJob(
         || m_tile_callbacks.size() == tile_renderers.size());
 }
 
+TileJob::TileJob(
+    const TileRendererVector&           tile_renderers,
+    const TileCallbackVector&           tile_callbacks,
+    const Frame&                        frame,
+    const size_t                        tile_x,
+    const size_t                        tile_y,
+    const AABB2u&                       region,
+    const shared_ptr<TileRegions>&      tile_regions,
+    const uint32                        pass_hash,
+    const Spectrum::Mode                spectrum_mode,
+    IAbortSwitch&                       abort_switch)
+  : m_tile_renderers(tile_renderers)
+  , m_tile_callbacks(tile_callbacks)
+  , m_frame(frame)
+  , m_tile_x(tile_x)
+  , m_tile_y(tile_y)
+  , m_region(region)
+  , m_tile_regions(tile_regions)
+  , m_pass_hash(pass_hash)
+  , m_spectrum_mode(spectrum_mode)
+  , m_abort_switch(abort_switch)
+{
+    assert(m_tile_regions);
+    assert(
+           m_tile_callbacks.size() == 0
+        || m_tile_callbacks.size() == tile_renderers.size());
+}
+
 void TileJob::execute(const size_t thread_index)
 {
+    TraceScope trace_scope("rendering", "render tile");
+
     // Initialize thread-local variables.
     Spectrum::set_mode(m_spectrum_mode);
 
@@ -124,8 +162,11 @@ void TileJob::execute(const size_t thread_index)
     // to invoking `on_tile_begin()` is a faster, sufficient alternative.
     //
 
-    // This causes the tile to be allocated.
-    m_frame.image().tile(m_tile_x, m_tile_y);
+    // This causes the tile to be allocated. When the tile is rendered in several regions,
+    // the tile job factory allocates it before the jobs are scheduled instead, since the
+    // jobs may run concurrently.
+    if (!m_tile_regions)
+        m_frame.image().tile(m_tile_x, m_tile_y);
 
     // Retrieve the tile callback.
     assert(thread_index < m_tile_renderers.size());
@@ -135,32 +176,61 @@ void TileJob::execute(const size_t thread_index)
             : nullptr;
 
     // Call the pre-render tile callback.
-    if (tile_callback)
+    const bool first_region = !m_tile_regions || m_tile_regions->m_started_count++ == 0;
+    if (tile_callback && first_region)
         tile_callback->on_tile_begin(&m_frame, m_tile_x, m_tile_y);
 
     try
     {
         // Render the tile.
-        m_tile_renderers[thread_index]->render_tile(
-            m_frame,
-            m_tile_x,
-            m_tile_y,
-            m_pass_hash,
-            m_abort_switch);
+        if (m_tile_regions)
+        {
+            m_tile_renderers[thread_index]->render_tile_region(
+                m_frame,
+                m_tile_x,
+                m_tile_y,
+                m_region,
+                m_pass_hash,
+                m_abort_switch);
+        }
+        else
+        {
+            m_tile_renderers[thread_index]->render_tile(
+                m_frame,
+                m_tile_x,
+                m_tile_y,
+                m_pass_hash,
+                m_abort_switch);
+        }
     }
     catch (const exception&)
     {
         // Call the post-render tile callback.
-        if (tile_callback)
-            tile_callback->on_tile_end(&m_frame, m_tile_x, m_tile_y);
+        end_tile(tile_callback);
 
         // Rethrow the exception.
         throw;
     }
 
     // Call the post-render tile callback.
+    end_tile(tile_callback);
+}
+
+void TileJob::end_tile(ITileCallback* tile_callback)
+{
+    const bool last_region = !m_tile_regions || --m_tile_regions->m_remaining_count == 0;
+    if (!last_region)
+        return;
+
+    // Execute the post-processing stages that can run on finished tiles.
+    if (!m_abort_switch.is_aborted())
+        m_frame.post_process_tile(m_tile_x, m_tile_y);
+
     if (tile_callback)
         tile_callback->on_tile_end(&m_frame, m_tile_x, m_tile_y);
+
+    // Write the tile to the output file if the frame is being streamed.
+    m_frame.stream_tile(m_tile_x, m_tile_y);
 }
 
 }   // namespace renderer
@@ -33,11 +33,16 @@
 #include "renderer/global/globaltypes.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/aabb.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/job.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
 // Standard headers.
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 // Forward declarations.
@@ -59,7 +64,17 @@ class TileJob
     typedef std::vector<ITileRenderer*> TileRendererVector;
     typedef std::vector<ITileCallback*> TileCallbackVector;
 
-    // Constructor.
+    // State shared by the jobs rendering the regions of a same tile. The first job
+    // to start invokes on_tile_begin(), the last one to finish invokes on_tile_end().
+    struct TileRegions
+    {
+        boost::atomic<size_t>       m_started_count;
+        boost::atomic<size_t>       m_remaining_count;
+
+        explicit TileRegions(const size_t region_count);
+    };
+
+    // Constructor, render a whole tile.
     TileJob(
         const TileRendererVector&   tile_renderers,
         const TileCallbackVector&   tile_callbacks,
@@ -70,6 +85,20 @@ class TileJob
         const Spectrum::Mode        spectrum_mode,
         foundation::IAbortSwitch&   abort_switch);
 
+    // Constructor, render a region of a tile, in tile space and inclusive on all sides.
+    // The tile must have been allocated in the frame's images before the job executes.
+    TileJob(
+        const TileRendererVector&           tile_renderers,
+        const TileCallbackVector&           tile_callbacks,
+        const Frame&                        frame,
+        const size_t                        tile_x,
+        const size_t                        tile_y,
+        const foundation::AABB2u&           region,
+        const std::shared_ptr<TileRegions>& tile_regions,
+        const foundation::uint32            pass_hash,
+        const Spectrum::Mode                spectrum_mode,
+        foundation::IAbortSwitch&           abort_switch);
+
     // Execute the job.
     void execute(const size_t thread_index) override;
 
@@ -79,9 +108,13 @@ class TileJob
     const Frame&                    m_frame;
     const size_t                    m_tile_x;
     const size_t                    m_tile_y;
+    const foundation::AABB2u        m_region;
+    std::shared_ptr<TileRegions>    m_tile_regions;
     const foundation::uint32        m_pass_hash;
     const Spectrum::Mode            m_spectrum_mode;
     foundation::IAbortSwitch&       m_abort_switch;
+
+    void end_tile(ITileCallback* tile_callback);
 };
 
 }   // namespace renderer
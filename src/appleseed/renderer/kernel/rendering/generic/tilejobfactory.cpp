@@ -31,16 +31,26 @@
 #include "tilejobfactory.h"
 
 // appleseed.renderer headers.
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/tilestack.h"
+#include "renderer/kernel/rendering/itilerenderer.h"
+#include "renderer/modeling/aov/aov.h"
+#include "renderer/modeling/aov/aovcontainer.h"
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
 #include "foundation/math/ordering.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
 #include "foundation/utility/otherwise.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <memory>
 
 using namespace foundation;
 using namespace std;
@@ -48,6 +58,19 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    // Regions are never smaller than this number of pixels along each axis.
+    const size_t MinRegionSize = 8;
+
+    // Maximum number of regions along each axis.
+    const size_t MaxSplitFactor = 8;
+
+    // Number of jobs per rendering thread to create from the last tiles of the frame.
+    const size_t TailJobsPerThread = 4;
+}
+
+
 //
 // TileJobFactory class implementation.
 //
@@ -59,7 +82,9 @@ void TileJobFactory::create(
     const TileJob::TileCallbackVector&  tile_callbacks,
     const uint32                        pass_hash,
     const Spectrum::Mode                spectrum_mode,
+    const bool                          tile_splitting,
     TileJobVector&                      tile_jobs,
+    ThreadIndexVector&                  tile_job_threads,
     IAbortSwitch&                       abort_switch)
 {
     // Retrieve frame properties.
@@ -72,6 +97,16 @@ void TileJobFactory::create(
     // Make sure the right number of tiles was created.
     assert(tiles.size() == props.m_tile_count);
 
+    // Split the last tiles, one per rendering thread, into regions.
+    const size_t thread_count = tile_renderers.size();
+    const bool split =
+        tile_splitting &&
+        thread_count > 1 &&
+        tile_renderers.front()->supports_tile_regions();
+    const size_t split_tile_count = split ? min(props.m_tile_count, thread_count) : 0;
+    const size_t split_factor = split ? compute_tile_split_factor(props.m_tile_count, thread_count) : 1;
+    const size_t whole_tile_count = props.m_tile_count - split_tile_count;
+
     // Create tile jobs, one per tile.
     for (size_t i = 0; i < props.m_tile_count; ++i)
     {
@@ -82,6 +117,28 @@ void TileJobFactory::create(
         assert(tile_x < props.m_tile_count_x);
         assert(tile_y < props.m_tile_count_y);
 
+        // Create one job per region of the tile.
+        if (i + split_tile_count >= props.m_tile_count)
+        {
+            create_region_jobs(
+                frame,
+                tile_x,
+                tile_y,
+                split_factor,
+                tile_renderers,
+                tile_callbacks,
+                pass_hash,
+                spectrum_mode,
+                tile_jobs,
+                abort_switch);
+
+            // Distribute region jobs over all rendering threads.
+            while (tile_job_threads.size() < tile_jobs.size())
+                tile_job_threads.push_back(tile_job_threads.size() % thread_count);
+
+            continue;
+        }
+
         // Create the tile job.
         tile_jobs.push_back(
             new TileJob(
@@ -93,6 +150,80 @@ void TileJobFactory::create(
                 pass_hash,
                 spectrum_mode,
                 abort_switch));
+
+        // Assign the i'th range of the tile ordering to the i'th rendering thread.
+        tile_job_threads.push_back((i * thread_count) / whole_tile_count);
+    }
+}
+
+size_t TileJobFactory::compute_tile_split_factor(
+    const size_t                        tile_count,
+    const size_t                        thread_count)
+{
+    assert(tile_count > 0);
+
+    // The last min(tile_count, thread_count) tiles are split into split_factor^2 regions.
+    const size_t split_tile_count = min(tile_count, thread_count);
+    const double target_regions_per_tile =
+        static_cast<double>(TailJobsPerThread * thread_count) / split_tile_count;
+    const size_t split_factor = truncate<size_t>(ceil(sqrt(target_regions_per_tile)));
+
+    return clamp<size_t>(split_factor, 2, MaxSplitFactor);
+}
+
+void TileJobFactory::create_region_jobs(
+    const Frame&                        frame,
+    const size_t                        tile_x,
+    const size_t                        tile_y,
+    const size_t                        split_factor,
+    const TileJob::TileRendererVector&  tile_renderers,
+    const TileJob::TileCallbackVector&  tile_callbacks,
+    const uint32                        pass_hash,
+    const Spectrum::Mode                spectrum_mode,
+    TileJobVector&                      tile_jobs,
+    IAbortSwitch&                       abort_switch)
+{
+    // Allocate the tiles now since Image::tile() is not thread-safe but regions
+    // of the tile are going to be rendered concurrently.
+    const Tile& tile = frame.image().tile(tile_x, tile_y);
+    frame.aov_images().tiles(tile_x, tile_y);
+    for (size_t i = 0, e = frame.aovs().size(); i < e; ++i)
+        frame.aovs().get_by_index(i)->get_image().tile(tile_x, tile_y);
+
+    // Never create regions smaller than MinRegionSize.
+    const size_t tile_width = tile.get_width();
+    const size_t tile_height = tile.get_height();
+    const size_t count_x = clamp<size_t>(tile_width / MinRegionSize, 1, split_factor);
+    const size_t count_y = clamp<size_t>(tile_height / MinRegionSize, 1, split_factor);
+
+    shared_ptr<TileJob::TileRegions> tile_regions(
+        new TileJob::TileRegions(count_x * count_y));
+
+    for (size_t ry = 0; ry < count_y; ++ry)
+    {
+        for (size_t rx = 0; rx < count_x; ++rx)
+        {
+            const AABB2u region(
+                Vector2u(
+                    static_cast<uint32>(rx * tile_width / count_x),
+                    static_cast<uint32>(ry * tile_height / count_y)),
+                Vector2u(
+                    static_cast<uint32>((rx + 1) * tile_width / count_x - 1),
+                    static_cast<uint32>((ry + 1) * tile_height / count_y - 1)));
+
+            tile_jobs.push_back(
+                new TileJob(
+                    tile_renderers,
+                    tile_callbacks,
+                    frame,
+                    tile_x,
+                    tile_y,
+                    region,
+                    tile_regions,
+                    pass_hash,
+                    spectrum_mode,
+                    abort_switch));
+        }
     }
 }
 
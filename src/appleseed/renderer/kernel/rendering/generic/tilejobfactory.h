@@ -58,6 +58,7 @@ class TileJobFactory
 {
   public:
     typedef std::vector<TileJob*> TileJobVector;
+    typedef std::vector<size_t> ThreadIndexVector;
 
     // Tile orderings.
     enum TileOrdering
@@ -68,7 +69,14 @@ class TileJobFactory
         RandomOrdering
     };
 
-    // Create tile jobs for a given frame.
+    // Create tile jobs for a given frame. If `tile_splitting` is true and tile renderers
+    // support it, the last tiles of the frame are split into regions rendered by separate
+    // jobs such that rendering threads don't sit idle while the last tiles are rendered.
+    //
+    // The rendering thread that should preferably execute each job is returned in
+    // `tile_job_threads`: the tile ordering is cut into contiguous ranges of tiles, one
+    // per thread, so that each thread renders a spatially coherent set of tiles (with
+    // all but random orderings), and region jobs are distributed over all threads.
     void create(
         const Frame&                        frame,
         const TileOrdering                  tile_ordering,
@@ -76,12 +84,32 @@ class TileJobFactory
         const TileJob::TileCallbackVector&  tile_callbacks,
         const foundation::uint32            pass_hash,
         const Spectrum::Mode                spectrum_mode,
+        const bool                          tile_splitting,
         TileJobVector&                      tile_jobs,
+        ThreadIndexVector&                  tile_job_threads,
         foundation::IAbortSwitch&           abort_switch);
 
+    // Return the number of regions along each axis into which the last tiles of a frame are
+    // split, given the number of tiles in the frame and the number of rendering threads.
+    static size_t compute_tile_split_factor(
+        const size_t                        tile_count,
+        const size_t                        thread_count);
+
   private:
     foundation::MersenneTwister             m_rng;
 
+    static void create_region_jobs(
+        const Frame&                        frame,
+        const size_t                        tile_x,
+        const size_t                        tile_y,
+        const size_t                        split_factor,
+        const TileJob::TileRendererVector&  tile_renderers,
+        const TileJob::TileCallbackVector&  tile_callbacks,
+        const foundation::uint32            pass_hash,
+        const Spectrum::Mode                spectrum_mode,
+        TileJobVector&                      tile_jobs,
+        foundation::IAbortSwitch&           abort_switch);
+
     void generate_tile_ordering(
         const foundation::CanvasProperties& frame_properties,
         const TileOrdering                  tile_ordering,
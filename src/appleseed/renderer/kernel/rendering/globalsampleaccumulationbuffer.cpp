@@ -40,10 +40,13 @@
 #include "foundation/image/image.h"
 #include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
+#include "foundation/platform/system.h"
 #include "foundation/utility/job/iabortswitch.h"
 
-// Boost headers.
-#include "boost/chrono/duration.hpp"
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -51,37 +54,60 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    // Maximum number of splat buffers.
+    const size_t MaxSplatBufferCount = 16;
+
+    // Maximum amount of memory used by all splat buffers together, in bytes.
+    const size_t MaxSplatBufferMemory = 256 * 1024 * 1024;
+}
+
 GlobalSampleAccumulationBuffer::GlobalSampleAccumulationBuffer(
     const size_t    width,
     const size_t    height)
-  : m_fb(width, height, 3)
+  : m_width(width)
+  , m_height(height)
+  , m_splat_buffer_count(
+        max<size_t>(
+            min<size_t>(
+                MaxSplatBufferMemory / (width * height * 4 * sizeof(float)),
+                MaxSplatBufferCount),
+            1))
+  , m_splat_buffers(new boost::atomic<AccumulatorTile*>[m_splat_buffer_count])
 {
+    for (size_t i = 0; i < m_splat_buffer_count; ++i)
+        m_splat_buffers[i].store(nullptr);
+}
+
+GlobalSampleAccumulationBuffer::~GlobalSampleAccumulationBuffer()
+{
+    for (size_t i = 0; i < m_splat_buffer_count; ++i)
+        delete m_splat_buffers[i].load();
 }
 
 void GlobalSampleAccumulationBuffer::clear()
 {
-    // Request exclusive access.
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    boost::mutex::scoped_lock lock(m_mutex);
 
     m_sample_count = 0;
 
-    m_fb.clear();
+    for (size_t i = 0; i < m_splat_buffer_count; ++i)
+    {
+        AccumulatorTile* splat_buffer = m_splat_buffers[i].load();
+        if (splat_buffer)
+            splat_buffer->clear();
+    }
 }
 
 void GlobalSampleAccumulationBuffer::store_samples(
+    const size_t    generator_index,
     const size_t    sample_count,
     const Sample    samples[],
     IAbortSwitch&   abort_switch)
 {
-    // Request non-exclusive access.
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
-    while (true)
-    {
-        if (abort_switch.is_aborted())
-            return;
-        if (lock.try_lock_for(boost::chrono::milliseconds(5)))
-            break;
-    }
+    // Sample generators sharing a splat buffer may splat into the same pixels.
+    AccumulatorTile& splat_buffer = get_splat_buffer(generator_index);
 
     size_t counter = 0;
 
@@ -92,7 +118,7 @@ void GlobalSampleAccumulationBuffer::store_samples(
             return;
 
         Color3f value(s->m_color.rgb());
-        m_fb.atomic_add(Vector2u(s->m_pixel_coords), &value[0]);
+        splat_buffer.atomic_add(Vector2u(s->m_pixel_coords), &value[0]);
     }
 }
 
@@ -100,40 +126,68 @@ void GlobalSampleAccumulationBuffer::develop_to_frame(
     Frame&          frame,
     IAbortSwitch&   abort_switch)
 {
-    // Request exclusive access.
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex, boost::defer_lock);
-    while (true)
-    {
-        if (abort_switch.is_aborted())
-            return;
-        if (lock.try_lock_for(boost::chrono::milliseconds(5)))
-            break;
-    }
+    boost::mutex::scoped_lock lock(m_mutex);
 
     Image& image = frame.image();
     const CanvasProperties& frame_props = image.properties();
 
-    assert(frame_props.m_canvas_width == m_fb.get_width());
-    assert(frame_props.m_canvas_height == m_fb.get_height());
+    assert(frame_props.m_canvas_width == m_width);
+    assert(frame_props.m_canvas_height == m_height);
     assert(frame_props.m_channel_count == 4);
 
+    // Collect the splat buffers allocated so far. Samples stored while the frame is
+    // being developed may or may not be taken into account.
+    vector<const AccumulatorTile*> splat_buffers;
+    for (size_t i = 0; i < m_splat_buffer_count; ++i)
+    {
+        const AccumulatorTile* splat_buffer = m_splat_buffers[i].load();
+        if (splat_buffer)
+            splat_buffers.push_back(splat_buffer);
+    }
+
     const float scale = 1.0f / m_sample_count;
 
-    for (size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty)
+    // Sum the splat buffers in parallel, one row of tiles at a time.
+    boost::atomic<size_t> next_tile_row(0);
+
+    const auto worker = [&]()
     {
-        for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
+        while (!abort_switch.is_aborted())
         {
-            if (abort_switch.is_aborted())
-                return;
+            const size_t ty = next_tile_row++;
+            if (ty >= frame_props.m_tile_count_y)
+                break;
+
+            for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
+            {
+                Tile& tile = image.tile(tx, ty);
+
+                const size_t x = tx * frame_props.m_tile_width;
+                const size_t y = ty * frame_props.m_tile_height;
+
+                develop_to_tile(
+                    tile,
+                    splat_buffers.empty() ? nullptr : &splat_buffers[0],
+                    splat_buffers.size(),
+                    x,
+                    y,
+                    scale);
+            }
+        }
+    };
 
-            Tile& tile = image.tile(tx, ty);
+    const size_t thread_count =
+        min(
+            System::get_logical_cpu_core_count(),
+            frame_props.m_tile_count_y);
 
-            const size_t x = tx * frame_props.m_tile_width;
-            const size_t y = ty * frame_props.m_tile_height;
+    boost::thread_group threads;
+    for (size_t i = 1; i < thread_count; ++i)
+        threads.create_thread(worker);
 
-            develop_to_tile(tile, x, y, tx, ty, scale);
-        }
-    }
+    worker();
+
+    threads.join_all();
 }
 
 void GlobalSampleAccumulationBuffer::increment_sample_count(const uint64 delta_sample_count)
@@ -141,13 +195,33 @@ void GlobalSampleAccumulationBuffer::increment_sample_count(const uint64 delta_s
     m_sample_count += delta_sample_count;
 }
 
+AccumulatorTile& GlobalSampleAccumulationBuffer::get_splat_buffer(const size_t generator_index)
+{
+    boost::atomic<AccumulatorTile*>& slot = m_splat_buffers[generator_index % m_splat_buffer_count];
+
+    AccumulatorTile* splat_buffer = slot.load(boost::memory_order_acquire);
+
+    if (splat_buffer == nullptr)
+    {
+        // Allocate the splat buffer; if another sample generator beat us to it, use theirs.
+        AccumulatorTile* new_splat_buffer = new AccumulatorTile(m_width, m_height, 3);
+        new_splat_buffer->clear();
+
+        if (slot.compare_exchange_strong(splat_buffer, new_splat_buffer, boost::memory_order_acq_rel))
+            splat_buffer = new_splat_buffer;
+        else delete new_splat_buffer;
+    }
+
+    return *splat_buffer;
+}
+
 void GlobalSampleAccumulationBuffer::develop_to_tile(
-    Tile&           tile,
-    const size_t    origin_x,
-    const size_t    origin_y,
-    const size_t    tile_x,
-    const size_t    tile_y,
-    const float     scale) const
+    Tile&                           tile,
+    const AccumulatorTile* const    splat_buffers[],
+    const size_t                    splat_buffer_count,
+    const size_t                    origin_x,
+    const size_t                    origin_y,
+    const float                     scale)
 {
     const size_t tile_width = tile.get_width();
     const size_t tile_height = tile.get_height();
@@ -156,9 +230,16 @@ void GlobalSampleAccumulationBuffer::develop_to_tile(
     {
         for (size_t x = 0; x < tile_width; ++x)
         {
-            const float* ptr = m_fb.pixel(origin_x + x, origin_y + y);
+            Color4f color(0.0f, 0.0f, 0.0f, 1.0f);
+
+            for (size_t i = 0; i < splat_buffer_count; ++i)
+            {
+                const float* ptr = splat_buffers[i]->pixel(origin_x + x, origin_y + y);
+                color[0] += ptr[1];
+                color[1] += ptr[2];
+                color[2] += ptr[3];
+            }
 
-            Color4f color(ptr[1], ptr[2], ptr[3], 1.0f);
             color.rgb() *= scale;
 
             tile.set_pixel(x, y, color);
@@ -38,8 +38,12 @@
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
 // Standard headers.
 #include <cstddef>
+#include <memory>
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
@@ -50,6 +54,16 @@ namespace renderer      { class Sample; }
 namespace renderer
 {
 
+//
+// A sample accumulation buffer for samples that may land anywhere in the frame.
+//
+// To keep sample generators from contending for the same memory, samples are
+// splatted into one of several full-frame splat buffers, chosen according to the
+// index of the sample generator. Splat buffers are allocated on first use; their
+// number is bounded by a memory budget. They are summed when the buffer is
+// developed to a frame.
+//
+
 class GlobalSampleAccumulationBuffer
   : public SampleAccumulationBuffer
 {
@@ -59,11 +73,15 @@ class GlobalSampleAccumulationBuffer
         const size_t                width,
         const size_t                height);
 
-    // Reset the buffer to its initial state. Thread-safe.
+    // Destructor.
+    ~GlobalSampleAccumulationBuffer() override;
+
+    // Reset the buffer to its initial state. Must not be called while samples are being stored.
     void clear() override;
 
     // Store a set of samples into the buffer. Thread-safe.
     void store_samples(
+        const size_t                generator_index,
         const size_t                sample_count,
         const Sample                samples[],
         foundation::IAbortSwitch&   abort_switch) override;
@@ -76,17 +94,36 @@ class GlobalSampleAccumulationBuffer
     // Increment the number of samples used for pixel values renormalization. Thread-safe.
     void increment_sample_count(const foundation::uint64 delta_sample_count);
 
+    // Return the maximum number of splat buffers.
+    size_t get_splat_buffer_count() const;
+
   private:
-    boost::shared_mutex             m_mutex;
-    foundation::AccumulatorTile     m_fb;
-
-    void develop_to_tile(
-        foundation::Tile&           tile,
-        const size_t                origin_x,
-        const size_t                origin_y,
-        const size_t                tile_x,
-        const size_t                tile_y,
-        const float                 scale) const;
+    const size_t                    m_width;
+    const size_t                    m_height;
+    const size_t                    m_splat_buffer_count;
+    std::unique_ptr<boost::atomic<foundation::AccumulatorTile*>[]>
+                                    m_splat_buffers;
+    boost::mutex                    m_mutex;
+
+    foundation::AccumulatorTile& get_splat_buffer(const size_t generator_index);
+
+    static void develop_to_tile(
+        foundation::Tile&                           tile,
+        const foundation::AccumulatorTile* const    splat_buffers[],
+        const size_t                                splat_buffer_count,
+        const size_t                                origin_x,
+        const size_t                                origin_y,
+        const float                                 scale);
 };
 
+
+//
+// GlobalSampleAccumulationBuffer class implementation.
+//
+
+inline size_t GlobalSampleAccumulationBuffer::get_splat_buffer_count() const
+{
+    return m_splat_buffer_count;
+}
+
 }   // namespace renderer
@@ -56,6 +56,10 @@ class IFrameRenderer
     virtual void pause_rendering() = 0;
     virtual void resume_rendering() = 0;
     virtual void terminate_rendering() = 0;
+
+    // Return an estimate of the time in seconds until rendering completes,
+    // or a negative value if no estimate is available.
+    virtual double get_remaining_time() const = 0;
 };
 
 
@@ -73,6 +73,10 @@ class APPLESEED_DLLSYMBOL IRendererController
     // This method is called continuously during rendering.
     virtual void on_progress() = 0;
 
+    // This method is called during rendering whenever the frame renderer
+    // updates its estimate of the time left until rendering completes.
+    virtual void on_remaining_time(const double seconds) {}
+
     enum Status
     {
         // Continue/resume rendering.
@@ -63,6 +63,14 @@ class ISampleGenerator
         SampleAccumulationBuffer&   buffer,
         foundation::IAbortSwitch&   abort_switch) = 0;
 
+    // Generate one sample in each block of block_size x block_size pixels of the crop window,
+    // for the blocks assigned to this generator, and accumulate them into a buffer. Sample
+    // generators whose samples are not tied to pixels don't generate any bootstrap sample.
+    virtual void generate_bootstrap_samples(
+        const size_t                block_size,
+        SampleAccumulationBuffer&   buffer,
+        foundation::IAbortSwitch&   abort_switch) = 0;
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
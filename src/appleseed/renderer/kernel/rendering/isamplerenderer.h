@@ -68,6 +68,16 @@ class ISampleRenderer
         AOVAccumulatorContainer&        aov_accumulators,
         ShadingResult&                  shading_result) = 0;
 
+    // Render a batch of samples. Sample renderers may trace and shade the samples
+    // of a batch in any order; the default implementation renders them one by one.
+    virtual void render_samples(
+        const size_t                    sample_count,
+        SamplingContext*                sampling_contexts,
+        const PixelContext*             pixel_contexts,
+        const foundation::Vector2d*     image_points,
+        AOVAccumulatorContainer&        aov_accumulators,
+        ShadingResult*                  shading_results);
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
@@ -55,6 +55,10 @@ class IShadingResultFrameBufferFactory
 
     virtual void destroy(
         ShadingResultFrameBuffer*   framebuffer) = 0;
+
+    // Return true if create() returns the same framebuffer every time it is called
+    // for a given tile, instead of a new framebuffer.
+    virtual bool is_permanent() const = 0;
 };
 
 }   // namespace renderer
@@ -84,6 +84,15 @@ class APPLESEED_DLLSYMBOL ITileCallback
 
     // This method is called after the frame has been updated.
     virtual void on_progressive_frame_update(const Frame* frame) = 0;
+
+    //
+    // Properties.
+    //
+
+    // Return true if this tile callback only accesses a tile of the frame from within
+    // on_tile_begin() and on_tile_end() for that tile. Renderers may then release tiles
+    // from memory once on_tile_end() has returned.
+    virtual bool accesses_tiles_synchronously() const { return false; }
 };
 
 
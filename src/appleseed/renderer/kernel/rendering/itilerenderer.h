@@ -31,6 +31,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/iunknown.h"
+#include "foundation/math/aabb.h"
 #include "foundation/platform/types.h"
 
 // Standard headers.
@@ -63,6 +64,26 @@ class ITileRenderer
         const foundation::uint32    pass_hash,
         foundation::IAbortSwitch&   abort_switch) = 0;
 
+    // Return true if this tile renderer can render regions of a tile, in which case
+    // disjoint regions of a same tile may be rendered concurrently by different threads.
+    virtual bool supports_tile_regions() const
+    {
+        return false;
+    }
+
+    // Render a region of a tile. `region` is expressed in tile space and is inclusive
+    // on all sides. Tile renderers that don't support tile regions render the whole tile.
+    virtual void render_tile_region(
+        const Frame&                frame,
+        const size_t                tile_x,
+        const size_t                tile_y,
+        const foundation::AABB2u&   region,
+        const foundation::uint32    pass_hash,
+        foundation::IAbortSwitch&   abort_switch)
+    {
+        render_tile(frame, tile_x, tile_y, pass_hash, abort_switch);
+    }
+
     // Retrieve performance statistics.
     virtual foundation::StatisticsVector get_statistics() const = 0;
 };
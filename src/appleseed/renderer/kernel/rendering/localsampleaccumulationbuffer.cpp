@@ -37,7 +37,7 @@
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
-#include "foundation/image/accumulatortile.h"
+#include "foundation/image/coloraccumulatortile.h"
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/color.h"
 #include "foundation/image/image.h"
@@ -77,9 +77,23 @@ namespace renderer
 //   pushing samples to and the level that is displayed. As soon as a level contains enough
 //   samples, it becomes the new active level.
 //
+//   Storing samples only requires non-exclusive access to the buffer, and so does
+//   developing it: develop_to_frame() doesn't stop the rendering threads. To make it
+//   cheap to call often, the rows of the highest resolution level are grouped into
+//   stripes that get flagged when samples are stored into them. Once the highest
+//   resolution level is active, only the tiles overlapping flagged stripes are
+//   developed again. A pixel may be read while a sample is being added to it; the
+//   stripe is then flagged again and the pixel is fixed by the next call.
+//
 
 //#define PRINT_DETAILED_PERF_REPORTS
 
+namespace
+{
+    // Height of a stripe, as a power of two.
+    const size_t StripeHeightLog2 = 4;
+}
+
 LocalSampleAccumulationBuffer::LocalSampleAccumulationBuffer(
     const size_t        width,
     const size_t        height)
@@ -91,7 +105,7 @@ LocalSampleAccumulationBuffer::LocalSampleAccumulationBuffer(
 
     while (true)
     {
-        m_levels.push_back(new AccumulatorTile(level_width, level_height, 4));
+        m_levels.push_back(new ColorAccumulatorTile(level_width, level_height));
         m_level_scales.push_back(
             Vector2f(
                 static_cast<float>(level_width) / width,
@@ -106,11 +120,15 @@ LocalSampleAccumulationBuffer::LocalSampleAccumulationBuffer(
 
     m_remaining_pixels = new boost::atomic<int32>[m_levels.size()];
 
+    m_stripe_count = ((height - 1) >> StripeHeightLog2) + 1;
+    m_dirty_stripes = new boost::atomic<bool>[m_stripe_count];
+
     clear();
 }
 
 LocalSampleAccumulationBuffer::~LocalSampleAccumulationBuffer()
 {
+    delete[] m_dirty_stripes;
     delete[] m_remaining_pixels;
 
     for (size_t i = 0, e = m_levels.size(); i < e; ++i)
@@ -143,9 +161,15 @@ void LocalSampleAccumulationBuffer::clear()
     }
 
     m_active_level = static_cast<uint32>(m_levels.size() - 1);
+
+    // The whole frame must be developed again.
+    for (size_t i = 0; i < m_stripe_count; ++i)
+        m_dirty_stripes[i].store(true, boost::memory_order_relaxed);
+    m_developed_level = ~uint32(0);
 }
 
 void LocalSampleAccumulationBuffer::store_samples(
+    const size_t            generator_index,
     const size_t            sample_count,
     const Sample            samples[],
     IAbortSwitch&           abort_switch)
@@ -169,30 +193,43 @@ void LocalSampleAccumulationBuffer::store_samples(
         RENDERER_LOG_DEBUG("store_samples: acquiring lock: %f", sw.get_seconds() * 1000.0);
 #endif
 
-        // Store samples at every level, starting with the highest resolution level up to the active level.
-        size_t counter = 0;
-        for (uint32 i = 0, e = m_active_level; i <= e; ++i)
-        {
-            AccumulatorTile* level = m_levels[i];
-            const Vector2f& level_scale = m_level_scales[i];
+        // Store each sample at every level, starting with the highest resolution level up to the active level.
+        const uint32 active_level = m_active_level;
+        ColorAccumulatorTile* const* levels = &m_levels[0];
+        const Vector2f* level_scales = &m_level_scales[0];
 
-            const Sample* sample_end = samples + sample_count;
-            for (const Sample* s = samples; s < sample_end; ++s)
+        const Sample* sample_end = samples + sample_count;
+        for (const Sample* s = samples; s < sample_end; ++s)
+        {
+            if (((s - samples) & 4095) == 0 && abort_switch.is_aborted())
             {
-                if ((counter++ & 4096) == 0 && abort_switch.is_aborted())
-                {
-                    m_lock.unlock_read();
-                    return;
-                }
+                m_lock.unlock_read();
+                return;
+            }
+
+            const float* values = &s->m_color[0];
 
-                level->atomic_add(
+            levels[0]->atomic_add(Vector2u(s->m_pixel_coords), values);
+
+            for (uint32 i = 1; i <= active_level; ++i)
+            {
+                const Vector2f& level_scale = level_scales[i];
+                levels[i]->atomic_add(
                     Vector2u(
                         static_cast<size_t>(s->m_pixel_coords.x * level_scale.x),
                         static_cast<size_t>(s->m_pixel_coords.y * level_scale.y)),
-                    &s->m_color[0]);
+                    values);
             }
         }
 
+        // Flag the stripes that received samples. This must happen after the samples were added.
+        for (const Sample* s = samples; s < sample_end; ++s)
+        {
+            boost::atomic<bool>& dirty = m_dirty_stripes[s->m_pixel_coords.y >> StripeHeightLog2];
+            if (!dirty.load(boost::memory_order_relaxed))
+                dirty.store(true, boost::memory_order_release);
+        }
+
         m_lock.unlock_read();
     }
 
@@ -238,8 +275,10 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
     sw.start();
 #endif
 
-    // Request exclusive access.
-    while (!m_lock.try_lock_write())
+    boost::mutex::scoped_lock develop_lock(m_develop_mutex);
+
+    // Request non-exclusive access.
+    while (!m_lock.try_lock_read())
     {
         foundation::sleep(5);
         if (abort_switch.is_aborted())
@@ -261,20 +300,48 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
 
     const AABB2u& crop_window = frame.get_crop_window();
 
-    const AccumulatorTile& level = *m_levels[m_active_level];
+    const uint32 active_level = m_active_level;
+    const ColorAccumulatorTile& level = *m_levels[active_level];
+
+    // Pixels of coarser levels span several stripes, develop the whole frame.
+    const bool develop_all_tiles = active_level > 0 || m_developed_level != active_level;
+
+    // Collect and reset the dirty flags of all stripes.
+    vector<bool> dirty_stripes(m_stripe_count);
+    for (size_t i = 0; i < m_stripe_count; ++i)
+        dirty_stripes[i] = m_dirty_stripes[i].exchange(false, boost::memory_order_acquire);
 
     for (size_t ty = 0; ty < frame_props.m_tile_count_y; ++ty)
     {
+        const size_t origin_y = ty * frame_props.m_tile_height;
+
+        if (!develop_all_tiles)
+        {
+            // Skip this row of tiles if none of its pixels received samples.
+            const size_t row_end_y = min(origin_y + frame_props.m_tile_height, frame_props.m_canvas_height);
+            const size_t stripe_begin = origin_y >> StripeHeightLog2;
+            const size_t stripe_end = ((row_end_y - 1) >> StripeHeightLog2) + 1;
+
+            bool dirty = false;
+            for (size_t i = stripe_begin; i < stripe_end; ++i)
+                dirty = dirty || dirty_stripes[i];
+
+            if (!dirty)
+                continue;
+        }
+
         for (size_t tx = 0; tx < frame_props.m_tile_count_x; ++tx)
         {
             if (abort_switch.is_aborted())
             {
-                m_lock.unlock_write();
+                // Make sure the tiles we didn't get to are developed next time.
+                m_developed_level = ~uint32(0);
+
+                m_lock.unlock_read();
                 return;
             }
 
             const size_t origin_x = tx * frame_props.m_tile_width;
-            const size_t origin_y = ty * frame_props.m_tile_height;
 
             Tile& color_tile = color_image.tile(tx, ty);
 
@@ -294,7 +361,9 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
         }
     }
 
-    m_lock.unlock_write();
+    m_developed_level = active_level;
+
+    m_lock.unlock_read();
 
 #ifdef PRINT_DETAILED_PERF_REPORTS
     sw.measure();
@@ -304,16 +373,14 @@ void LocalSampleAccumulationBuffer::develop_to_frame(
 }
 
 void LocalSampleAccumulationBuffer::develop_to_tile(
-    Tile&                   color_tile,
-    const size_t            image_width,
-    const size_t            image_height,
-    const AccumulatorTile&  level,
-    const size_t            origin_x,
-    const size_t            origin_y,
-    const AABB2u&           rect)
+    Tile&                        color_tile,
+    const size_t                 image_width,
+    const size_t                 image_height,
+    const ColorAccumulatorTile&  level,
+    const size_t                 origin_x,
+    const size_t                 origin_y,
+    const AABB2u&                rect)
 {
-    assert(level.get_channel_count() == 4);
-
     if (rect.min.x > rect.max.x)
         return;
 
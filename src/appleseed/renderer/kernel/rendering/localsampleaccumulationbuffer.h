@@ -45,7 +45,7 @@
 #include <vector>
 
 // Forward declarations.
-namespace foundation    { class AccumulatorTile; }
+namespace foundation    { class ColorAccumulatorTile; }
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class Tile; }
 namespace renderer      { class Frame; }
@@ -71,35 +71,47 @@ class LocalSampleAccumulationBuffer
 
     // Store a set of samples into the buffer. Thread-safe.
     void store_samples(
+        const size_t                        generator_index,
         const size_t                        sample_count,
         const Sample                        samples[],
         foundation::IAbortSwitch&           abort_switch) override;
 
-    // Develop the buffer to a frame. Thread-safe.
+    // Develop the buffer to a frame. Thread-safe. Samples can be stored while the
+    // buffer is being developed; only the tiles that were touched since the previous
+    // call are developed again.
     void develop_to_frame(
         Frame&                              frame,
         foundation::IAbortSwitch&           abort_switch) override;
 
     // Exposed for tests and benchmarks.
     static void develop_to_tile(
-        foundation::Tile&                   color_tile,
-        const size_t                        image_width,
-        const size_t                        image_height,
-        const foundation::AccumulatorTile&  level,
-        const size_t                        origin_x,
-        const size_t                        origin_y,
-        const foundation::AABB2u&           rect);
+        foundation::Tile&                        color_tile,
+        const size_t                             image_width,
+        const size_t                             image_height,
+        const foundation::ColorAccumulatorTile&  level,
+        const size_t                             origin_x,
+        const size_t                             origin_y,
+        const foundation::AABB2u&                rect);
 
   private:
     typedef foundation::ReadWriteLock<
         foundation::SleepWaitPolicy<5>
     > LockType;
 
-    LockType                                  m_lock;
-    std::vector<foundation::AccumulatorTile*> m_levels;
-    std::vector<foundation::Vector2f>         m_level_scales;
-    boost::atomic<foundation::int32>*         m_remaining_pixels;
-    boost::atomic<foundation::uint32>         m_active_level;
+    LockType                                        m_lock;
+    std::vector<foundation::ColorAccumulatorTile*>  m_levels;
+    std::vector<foundation::Vector2f>               m_level_scales;
+    boost::atomic<foundation::int32>*               m_remaining_pixels;
+    boost::atomic<foundation::uint32>               m_active_level;
+
+    // Rows of the highest resolution level are grouped in stripes; a stripe is dirty
+    // if samples were stored into it since the last time it was developed.
+    size_t                                          m_stripe_count;
+    boost::atomic<bool>*                            m_dirty_stripes;
+
+    // Serialize calls to develop_to_frame().
+    boost::mutex                                    m_develop_mutex;
+    foundation::uint32                              m_developed_level;
 };
 
 }   // namespace renderer
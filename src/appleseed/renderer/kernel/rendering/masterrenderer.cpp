@@ -32,51 +32,75 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/intersection/raydump.h"
+#include "renderer/kernel/lighting/backwardlightsamplercache.h"
 #include "renderer/kernel/lighting/lightpathrecorder.h"
 #include "renderer/kernel/rendering/iframerenderer.h"
 #include "renderer/kernel/rendering/itilecallback.h"
 #include "renderer/kernel/rendering/oiioerrorhandler.h"
+#include "renderer/kernel/rendering/primaryhitcache.h"
 #include "renderer/kernel/rendering/renderercomponents.h"
 #include "renderer/kernel/rendering/rendererservices.h"
 #include "renderer/kernel/rendering/serialrenderercontroller.h"
 #include "renderer/kernel/rendering/serialtilecallback.h"
 #include "renderer/kernel/shading/closures.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
+#include "renderer/kernel/shading/shadergroupoptimizer.h"
 #include "renderer/kernel/texturing/oiiotexturesystem.h"
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/display/display.h"
 #include "renderer/modeling/entity/onframebeginrecorder.h"
 #include "renderer/modeling/entity/onrenderbeginrecorder.h"
 #include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/input/inputbinder.h"
+#include "renderer/modeling/postprocessingstage/postprocessingstage.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
 #include "renderer/modeling/shadergroup/shadercompiler.h"
+#include "renderer/utility/messagecontext.h"
 #include "renderer/utility/settingsparsing.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/image.h"
+#include "foundation/math/population.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/defaulttimers.h"
 #include "foundation/platform/thread.h"
 #include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/eventtracer.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/job/iabortswitch.h"
+#include "foundation/utility/makevector.h"
 #include "foundation/utility/otherwise.h"
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/stopwatch.h"
+#include "foundation/utility/string.h"
+
+// appleseed.main headers.
+#include "main/allocator.h"
+
+// Boost headers.
+#include "boost/filesystem/path.hpp"
 
 // Standard headers.
 #include <algorithm>
 #include <cassert>
 #include <exception>
+#include <memory>
 #include <new>
 #include <string>
 #include <vector>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
@@ -87,6 +111,34 @@ namespace renderer
 
 namespace
 {
+    // Collect the live and peak memory usage of every memory tag, and how much of it is on huge pages.
+    Statistics get_tagged_memory_statistics()
+    {
+        Statistics stats;
+
+        for (size_t i = 0; i < MemoryTagCount; ++i)
+        {
+            const MemoryTag tag = static_cast<MemoryTag>(i);
+            string usage =
+                pretty_size(get_tagged_memory_live_bytes(tag)) + " live, " +
+                pretty_size(get_tagged_memory_peak_bytes(tag)) + " peak";
+            if (get_huge_page_mode(tag) != HugePagesOff)
+                usage += ", " + pretty_size(get_huge_page_live_bytes(tag)) + " on huge pages";
+            stats.insert<string>(get_memory_tag_name(tag), usage);
+        }
+
+        return stats;
+    }
+
+    // Return the path of the output file of a view, e.g. render.left.exr for render.exr.
+    string make_view_file_path(const string& file_path, const string& camera_name)
+    {
+        const bf::path path(file_path);
+        return
+            (path.parent_path() /
+                (path.stem().string() + "." + camera_name + path.extension().string())).string();
+    }
+
     // An abort switch whose abort status is determined by a renderer::IRendererController.
     class RendererControllerAbortSwitch
       : public IAbortSwitch
@@ -109,6 +161,65 @@ namespace
       private:
         IRendererController& m_renderer_controller;
     };
+
+    // Record the rays traced through the scene into the ray dump file named by the
+    // "ray_dump_file" parameter, if any, for as long as this object lives.
+    class RayDumpScope
+      : public NonCopyable
+    {
+      public:
+        RayDumpScope(
+            Project&            project,
+            const ParamArray&   params)
+          : m_project(project)
+          , m_path(params.get_optional<string>("ray_dump_file", ""))
+        {
+            if (m_path.empty())
+                return;
+
+            // By default, rays of all types are recorded.
+            const string ray_type_names = params.get_optional<string>("ray_dump_ray_types", "");
+            const VisibilityFlags::Type ray_types =
+                ray_type_names.empty()
+                    ? VisibilityFlags::AllRays
+                    : VisibilityFlags::parse_names(ray_type_names, MessageContext());
+
+            if (!m_writer.open(m_path.c_str(), ray_types))
+            {
+                RENDERER_LOG_ERROR("failed to create ray dump file %s.", m_path.c_str());
+                return;
+            }
+
+            m_project.set_ray_dump_writer(&m_writer);
+
+            RENDERER_LOG_INFO("recording rays into ray dump file %s.", m_path.c_str());
+        }
+
+        ~RayDumpScope()
+        {
+            if (!m_writer.is_open())
+                return;
+
+            m_project.set_ray_dump_writer(nullptr);
+
+            const uint64 ray_count = m_writer.get_ray_count();
+
+            if (m_writer.close())
+            {
+                RENDERER_LOG_INFO(
+                    "wrote %s %s to ray dump file %s.",
+                    pretty_uint(ray_count).c_str(),
+                    plural(ray_count, "ray").c_str(),
+                    m_path.c_str());
+            }
+            else RENDERER_LOG_ERROR("failed to write ray dump file %s.", m_path.c_str());
+        }
+
+      private:
+        Project&                m_project;
+        const string            m_path;
+        RayDumpWriter           m_writer;
+    };
 }
 
 struct MasterRenderer::Impl
@@ -133,6 +244,9 @@ struct MasterRenderer::Impl
 
     Display*                            m_display;
 
+    BackwardLightSamplerCache           m_backward_light_sampler_cache;
+    PrimaryHitCache                     m_primary_hit_cache;
+
     Stopwatch<DefaultWallclockTimer>    m_stopwatch;
 
     Impl(
@@ -265,16 +379,39 @@ struct MasterRenderer::Impl
             const APIString stdosl_path = m_resource_search_paths.qualify("stdosl.h");
             RENDERER_LOG_INFO("found OSL headers in %s", stdosl_path.c_str());
             m_osl_compiler = ShaderCompilerFactory::create(stdosl_path.c_str());
+            m_osl_compiler->set_cache_directory(
+                m_params.get_optional<string>("shader_cache_directory", "").c_str());
         }
         else
             RENDERER_LOG_INFO("OSL headers not found.");
 
-        // Re-optimize shader groups that need updating.
+        // Re-optimize shader groups that need updating. In background optimization mode,
+        // shader groups are only set up here and optimized while rendering.
         return
             m_project.get_scene()->create_optimized_osl_shader_groups(
                 *m_shading_system,
                 m_osl_compiler.get(),
-                &abort_switch);
+                &abort_switch,
+                m_params.get_optional<bool>("background_shader_optimization", false));
+    }
+
+    // Start optimizing the shader groups that are not optimized yet on background threads.
+    // Return nullptr if background optimization is disabled or if there is nothing to optimize.
+    unique_ptr<ShaderGroupOptimizer> create_shader_group_optimizer()
+    {
+        unique_ptr<ShaderGroupOptimizer> optimizer;
+
+        if (m_params.get_optional<bool>("background_shader_optimization", false))
+        {
+            const size_t thread_count =
+                max<size_t>(m_params.get_optional<size_t>("background_shader_optimization_threads", 1), 1);
+
+            optimizer.reset(new ShaderGroupOptimizer(*m_shading_system, thread_count));
+            if (optimizer->schedule(*m_project.get_scene()) == 0)
+                optimizer.reset();
+        }
+
+        return optimizer;
     }
 
     // Render the project.
@@ -299,6 +436,10 @@ struct MasterRenderer::Impl
             m_stopwatch.start();
             result.m_status = do_render();
             m_stopwatch.measure();
+
+            // The light sampler and primary hits are only reused across reinitializations of the same render.
+            m_backward_light_sampler_cache.clear();
+            m_primary_hit_cache.clear();
             result.m_render_time = m_stopwatch.get_seconds();
 
             // Insert render time into the frame's render info.
@@ -423,6 +564,9 @@ struct MasterRenderer::Impl
         // Construct an abort switch that will allow to abort initialization or rendering.
         RendererControllerAbortSwitch abort_switch(*m_renderer_controller);
 
+        // Report memory peaks relative to this render.
+        reset_tagged_memory_peaks();
+
         // Create the texture store.
         TextureStore texture_store(
             *m_project.get_scene(),
@@ -439,6 +583,9 @@ struct MasterRenderer::Impl
                     : IRendererController::AbortRendering;
         }
 
+        // Optimize the remaining shader groups while rendering. This must not outlive the texture store.
+        unique_ptr<ShaderGroupOptimizer> shader_group_optimizer = create_shader_group_optimizer();
+
         // Let scene entities perform their pre-render actions. Don't proceed if that failed.
         // This is done before creating renderer components because renderer components need
         // to access the scene's render data such as the scene's bounding box.
@@ -450,6 +597,10 @@ struct MasterRenderer::Impl
             return m_renderer_controller->get_status();
         }
 
+        // Start recording rays if requested. Intersectors flush their recorded rays when
+        // renderer components are destroyed, so this must outlive them.
+        RayDumpScope ray_dump_scope(m_project, m_params);
+
         // Create renderer components.
         RendererComponents components(
             m_project,
@@ -457,7 +608,9 @@ struct MasterRenderer::Impl
             m_tile_callback_factory,
             texture_store,
             *m_texture_system,
-            *m_shading_system);
+            *m_shading_system,
+            m_backward_light_sampler_cache,
+            m_primary_hit_cache);
         if (!components.create())
             return IRendererController::AbortRendering;
 
@@ -468,6 +621,21 @@ struct MasterRenderer::Impl
 #ifdef APPLESEED_WITH_EMBREE
         const bool use_embree = m_params.get_optional<bool>("use_embree", false);
         m_project.set_use_embree(use_embree);
+        m_project.set_use_embree_instancing(m_params.get_optional<bool>("use_embree_instancing", false));
+
+        EmbreeSceneSettings embree_scene_settings;
+        const string embree_build_quality =
+            m_params.get_optional<string>(
+                "embree_build_quality",
+                "high",
+                make_vector("low", "medium", "high"));
+        embree_scene_settings.m_build_quality =
+            embree_build_quality == "low" ? EmbreeSceneSettings::BuildQualityLow :
+            embree_build_quality == "medium" ? EmbreeSceneSettings::BuildQualityMedium :
+            EmbreeSceneSettings::BuildQualityHigh;
+        embree_scene_settings.m_compact = m_params.get_optional<bool>("embree_compact", false);
+        embree_scene_settings.m_robust = m_params.get_optional<bool>("embree_robust", false);
+        m_project.set_embree_scene_settings(embree_scene_settings);
 #else
         const bool use_embree = false;
 #endif
@@ -475,6 +643,10 @@ struct MasterRenderer::Impl
              RENDERER_LOG_INFO("using Intel Embree ray tracing kernel.");
         else RENDERER_LOG_INFO("using built-in ray tracing kernel.");
 
+#ifdef APPLESEED_WITH_GPU
+        m_project.set_use_gpu(m_params.get_optional<bool>("use_gpu", false));
+#endif
+
         // Updating the trace context causes ray tracing acceleration structures to be updated or rebuilt.
         m_project.update_trace_context();
 
@@ -492,7 +664,7 @@ struct MasterRenderer::Impl
         }
 
         // Execute the main rendering loop.
-        const auto status = render_frame(components, abort_switch);
+        const auto status = render_frame(components, abort_switch, shader_group_optimizer.get());
 
         // Perform post-render actions.
         recorder.on_render_end(m_project);
@@ -506,29 +678,66 @@ struct MasterRenderer::Impl
         // Print texture store performance statistics.
         RENDERER_LOG_DEBUG("%s", texture_store.get_statistics().to_string().c_str());
 
+        // Print the texture working set analysis if it was requested.
+        if (texture_store.is_working_set_analysis_enabled())
+            RENDERER_LOG_INFO("%s", texture_store.get_working_set_statistics().to_string().c_str());
+
+        // Print memory usage per subsystem.
+        RENDERER_LOG_INFO(
+            "%s",
+            StatisticsVector::make(
+                "memory statistics",
+                get_tagged_memory_statistics()).to_string().c_str());
+
         return status;
     }
 
     // Render a frame until completed or aborted and handle restart events.
     IRendererController::Status render_frame(
         RendererComponents&     components,
-        IAbortSwitch&           abort_switch)
+        IAbortSwitch&           abort_switch,
+        ShaderGroupOptimizer*   shader_group_optimizer)
     {
+        // Latencies of rendering restarts, measured from the restart request.
+        Stopwatch<DefaultWallclockTimer> restart_stopwatch;
+        Population<double> stop_latencies;
+        Population<double> restart_latencies;
+        bool restarting = false;
+
+        // Cameras of the views rendered in turn in this session.
+        vector<string> views;
+        if (!collect_views(views))
+            return IRendererController::AbortRendering;
+
+        size_t view_index = 0;
+
+        if (!views.empty())
+            begin_view(views[view_index], view_index, views.size());
+
         while (true)
         {
             // The `on_frame_begin()` method of the renderer controller might alter the scene
             // (e.g. transform the camera), thus it needs to be called before the `on_frame_begin()`
             // of the scene which assumes the scene is up-to-date and ready to be rendered.
-            m_renderer_controller->on_frame_begin();
+            // Shader groups are not optimized while the scene may be edited.
+            {
+                ShaderGroupOptimizer::SuspendScope suspend_scope(shader_group_optimizer);
+                m_renderer_controller->on_frame_begin();
+            }
 
             // Discard recorded light paths.
             m_project.get_light_path_recorder().clear();
 
             // Perform pre-frame actions. Don't proceed if that failed.
             OnFrameBeginRecorder recorder;
-            if (!components.on_frame_begin(recorder, &abort_switch) ||
-                !m_project.on_frame_begin(m_project, nullptr, recorder, &abort_switch) ||
-                abort_switch.is_aborted())
+            bool frame_began;
+            {
+                TraceScope trace_scope("rendering", "on frame begin");
+                frame_began =
+                    components.on_frame_begin(recorder, &abort_switch) &&
+                    m_project.on_frame_begin(m_project, nullptr, recorder, &abort_switch);
+            }
+            if (!frame_began || abort_switch.is_aborted())
             {
                 recorder.on_frame_end(m_project);
                 m_renderer_controller->on_frame_end();
@@ -545,8 +754,31 @@ struct MasterRenderer::Impl
             // Start rendering the frame.
             frame_renderer.start_rendering();
 
+            if (restarting)
+            {
+                restart_stopwatch.measure();
+                restart_latencies.insert(restart_stopwatch.get_seconds() * 1000.0);
+                restarting = false;
+            }
+
             // Wait until the the frame is completed or rendering is aborted.
-            const IRendererController::Status status = wait_for_event(frame_renderer);
+            const IRendererController::Status status = wait_for_event(frame_renderer, shader_group_optimizer);
+
+            // Keep worker threads and caches alive to render the next view.
+            if (status == IRendererController::TerminateRendering &&
+                !frame_renderer.is_rendering() &&
+                view_index + 1 < views.size())
+            {
+                frame_renderer.stop_rendering();
+                recorder.on_frame_end(m_project);
+                m_renderer_controller->on_frame_end();
+
+                end_view(views[view_index]);
+
+                ++view_index;
+                begin_view(views[view_index], view_index, views.size());
+                continue;
+            }
 
             switch (status)
             {
@@ -554,10 +786,15 @@ struct MasterRenderer::Impl
               case IRendererController::AbortRendering:
               case IRendererController::ReinitializeRendering:
                 frame_renderer.terminate_rendering();
+                print_restart_statistics(stop_latencies, restart_latencies);
                 break;
 
               case IRendererController::RestartRendering:
+                restart_stopwatch.start();
                 frame_renderer.stop_rendering();
+                restart_stopwatch.measure();
+                stop_latencies.insert(restart_stopwatch.get_seconds() * 1000.0);
+                restarting = true;
                 break;
 
               assert_otherwise;
@@ -584,14 +821,94 @@ struct MasterRenderer::Impl
         }
     }
 
-    // Wait until the the frame is completed or rendering is aborted.
-    IRendererController::Status wait_for_event(IFrameRenderer& frame_renderer)
+    // Collect the cameras listed in the "views" parameter. Return false if one of them doesn't exist.
+    bool collect_views(vector<string>& views) const
+    {
+        tokenize(m_params.get_optional<string>("views", ""), Blanks, views);
+
+        const Scene& scene = *m_project.get_scene();
+
+        for (const string& camera_name : views)
+        {
+            if (scene.cameras().get_by_name(camera_name.c_str()) == nullptr)
+            {
+                RENDERER_LOG_ERROR("view camera \"%s\" not found.", camera_name.c_str());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Make a camera the active camera of the frame.
+    void begin_view(
+        const string&           camera_name,
+        const size_t            view_index,
+        const size_t            view_count)
+    {
+        RENDERER_LOG_INFO(
+            "rendering view %s of %s through camera \"%s\"...",
+            pretty_uint(view_index + 1).c_str(),
+            pretty_uint(view_count).c_str(),
+            camera_name.c_str());
+
+        m_project.get_frame()->get_parameters().insert("camera", camera_name);
+    }
+
+    // Post-process the frame and write its images next to the output file of the frame.
+    // The last view is left in the frame instead, to be post-processed and written as usual.
+    void end_view(const string& camera_name)
+    {
+        Frame& frame = *m_project.get_frame();
+
+        postprocess(RenderingResult());
+
+        const string file_path = frame.get_parameters().get_optional<string>("output_filename", "");
+        if (file_path.empty())
+            RENDERER_LOG_WARNING("frame has no output file, view \"%s\" is not written.", camera_name.c_str());
+        else frame.write_main_and_aov_images(make_view_file_path(file_path, camera_name).c_str());
+
+        frame.clear_main_and_aov_images();
+    }
+
+    static void print_restart_statistics(
+        const Population<double>&   stop_latencies,
+        const Population<double>&   restart_latencies)
+    {
+        if (stop_latencies.get_size() == 0)
+            return;
+
+        Statistics stats;
+        stats.insert("restarts", static_cast<uint64>(stop_latencies.get_size()));
+        stats.insert("stop latency", stop_latencies, "ms");
+        stats.insert("restart latency", restart_latencies, "ms");
+
+        RENDERER_LOG_INFO(
+            "%s",
+            StatisticsVector::make(
+                "interactive restart statistics",
+                stats).to_string().c_str());
+    }
+
+    // Wait until the the frame is completed or rendering is aborted. Also restart rendering
+    // when shader groups optimized in the background become available.
+    IRendererController::Status wait_for_event(
+        IFrameRenderer&         frame_renderer,
+        ShaderGroupOptimizer*   shader_group_optimizer)
     {
         bool is_paused = false;
+        double last_remaining_time = -1.0;
+
+        // Don't restart rendering more than this often while shader groups are being optimized.
+        const double MinRestartInterval = 0.5;     // in seconds
+        Stopwatch<DefaultWallclockTimer> optimization_stopwatch;
+        optimization_stopwatch.start();
 
         while (true)
         {
-            if (!frame_renderer.is_rendering())
+            // Don't complete the frame with fallback shading, wait for pending shader groups instead.
+            const bool frame_completed = !frame_renderer.is_rendering();
+            if (frame_completed && shader_group_optimizer == nullptr)
                 return IRendererController::TerminateRendering;
 
             const IRendererController::Status status = m_renderer_controller->get_status();
@@ -622,6 +939,36 @@ struct MasterRenderer::Impl
                 return status;
             }
 
+            if (shader_group_optimizer != nullptr)
+            {
+                const bool is_busy = shader_group_optimizer->is_busy();
+
+                if (!is_busy ||
+                    (!frame_completed && optimization_stopwatch.measure().get_seconds() >= MinRestartInterval))
+                {
+                    // Newly emissive or transparent surfaces invalidate light samplers and acceleration structures.
+                    bool needs_reinitialization;
+                    if (shader_group_optimizer->fetch_optimized_shader_groups(needs_reinitialization))
+                    {
+                        return
+                            needs_reinitialization
+                                ? IRendererController::ReinitializeRendering
+                                : IRendererController::RestartRendering;
+                    }
+
+                    if (frame_completed && !is_busy)
+                        return IRendererController::TerminateRendering;
+                }
+            }
+
+            // Only report the remaining time when the estimate changes.
+            const double remaining_time = frame_renderer.get_remaining_time();
+            if (remaining_time >= 0.0 && remaining_time != last_remaining_time)
+            {
+                m_renderer_controller->on_remaining_time(remaining_time);
+                last_remaining_time = remaining_time;
+            }
+
             m_renderer_controller->on_progress();
 
             foundation::sleep(1);   // namespace qualifer required
@@ -630,6 +977,8 @@ struct MasterRenderer::Impl
 
     void postprocess(const RenderingResult& rendering_result)
     {
+        TraceScope trace_scope("rendering", "post-process frame");
+
         Frame* frame = m_project.get_frame();
         assert(frame != nullptr);
 
@@ -637,20 +986,9 @@ struct MasterRenderer::Impl
         if (frame->post_processing_stages().empty())
             return;
 
-        // Collect post-processing stages.
+        // Collect post-processing stages and sort them in increasing order.
         vector<PostProcessingStage*> ordered_stages;
-        ordered_stages.reserve(frame->post_processing_stages().size());
-        for (auto& stage : frame->post_processing_stages())
-            ordered_stages.push_back(&stage);
-
-        // Sort post-processing stages in increasing order.
-        sort(
-            ordered_stages.begin(),
-            ordered_stages.end(),
-            [](PostProcessingStage* lhs, PostProcessingStage* rhs)
-            {
-                return lhs->get_order() < rhs->get_order();
-            });
+        get_ordered_post_processing_stages(frame->post_processing_stages(), ordered_stages);
 
         // Detect post-processing stages with equal order.
         size_t previous_stage_index = 0;
@@ -668,14 +1006,58 @@ struct MasterRenderer::Impl
             }
         }
 
+        // The leading stages may already have been executed on the tiles of the frame during rendering.
+        const size_t incremental_stage_count = frame->get_incremental_post_processing_stage_count();
+        assert(incremental_stage_count <= ordered_stages.size());
+
+        // Stages supporting tiled execution process the tiles of the frame in parallel.
+        const size_t thread_count = get_rendering_thread_count(m_params);
+        unique_ptr<JobQueue> job_queue;
+        unique_ptr<JobManager> job_manager;
+        if (thread_count > 1)
+        {
+            for (size_t i = incremental_stage_count, e = ordered_stages.size(); i < e; ++i)
+            {
+                if (ordered_stages[i]->supports_tiled_execution())
+                {
+                    job_queue.reset(new JobQueue());
+                    job_manager.reset(
+                        new JobManager(
+                            global_logger(),
+                            *job_queue,
+                            thread_count,
+                            JobManager::KeepRunningOnEmptyQueue));
+                    job_manager->start();
+                    break;
+                }
+            }
+        }
+
         // Execute post-processing stages.
-        for (auto stage : ordered_stages)
+        for (size_t i = 0, e = ordered_stages.size(); i < e; ++i)
         {
-            RENDERER_LOG_INFO("executing \"%s\" post-processing stage with order %d on frame \"%s\"...",
-                stage->get_path().c_str(), stage->get_order(), frame->get_path().c_str());
-            stage->execute(*frame);
+            PostProcessingStage* stage = ordered_stages[i];
+
+            if (i < incremental_stage_count)
+            {
+                RENDERER_LOG_INFO("completing \"%s\" post-processing stage with order %d on frame \"%s\"...",
+                    stage->get_path().c_str(), stage->get_order(), frame->get_path().c_str());
+                stage->end_tiled_execution(*frame);
+            }
+            else
+            {
+                RENDERER_LOG_INFO("executing \"%s\" post-processing stage with order %d on frame \"%s\"...",
+                    stage->get_path().c_str(), stage->get_order(), frame->get_path().c_str());
+                if (job_manager)
+                    execute_post_processing_stage(*stage, *frame, *job_queue);
+                else stage->execute(*frame);
+            }
+
             invoke_tile_callbacks(*frame);
         }
+
+        if (job_manager)
+            job_manager->stop();
     }
 
     void invoke_tile_callbacks(const Frame& frame)
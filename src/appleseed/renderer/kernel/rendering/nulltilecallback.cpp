@@ -42,6 +42,11 @@ void NullTileCallback::release()
     delete this;
 }
 
+bool NullTileCallback::accesses_tiles_synchronously() const
+{
+    return true;
+}
+
 
 //
 // NullTileCallbackFactory class implementation.
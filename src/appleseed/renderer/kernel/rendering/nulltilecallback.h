@@ -51,6 +51,8 @@ class NullTileCallback
 {
   public:
     void release() override;
+
+    bool accesses_tiles_synchronously() const override;
 };
 
 class APPLESEED_DLLSYMBOL NullTileCallbackFactory
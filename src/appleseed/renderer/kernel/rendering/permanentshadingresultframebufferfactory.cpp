@@ -40,6 +40,9 @@
 #include "foundation/image/image.h"
 #include "foundation/image/tile.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 using namespace foundation;
 
 namespace renderer
@@ -51,7 +54,9 @@ void PermanentShadingResultFrameBufferFactory::release()
 }
 
 PermanentShadingResultFrameBufferFactory::PermanentShadingResultFrameBufferFactory(
-    const Frame&                frame)
+    const Frame&                frame,
+    const ShadingResultFrameBuffer::Layout layout)
+  : m_layout(layout)
 {
     const size_t tile_count_x = frame.image().properties().m_tile_count_x;
     const size_t tile_count_y = frame.image().properties().m_tile_count_y;
@@ -76,6 +81,8 @@ ShadingResultFrameBuffer* PermanentShadingResultFrameBufferFactory::create(
 
     if (m_framebuffers[index] == nullptr)
     {
+        MemoryTagScope memory_tag_scope(MemoryTagFramebuffers);
+
         const Tile& tile = frame.image().tile(tile_x, tile_y);
 
         m_framebuffers[index] =
@@ -83,7 +90,8 @@ ShadingResultFrameBuffer* PermanentShadingResultFrameBufferFactory::create(
                 tile.get_width(),
                 tile.get_height(),
                 frame.aov_images().size(),
-                tile_bbox);
+                tile_bbox,
+                m_layout);
 
         m_framebuffers[index]->clear();
     }
@@ -96,4 +104,9 @@ void PermanentShadingResultFrameBufferFactory::destroy(
 {
 }
 
+bool PermanentShadingResultFrameBufferFactory::is_permanent() const
+{
+    return true;
+}
+
 }   // namespace renderer
@@ -31,6 +31,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
 
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
@@ -42,7 +43,6 @@
 
 // Forward declarations.
 namespace renderer  { class Frame; }
-namespace renderer  { class ShadingResultFrameBuffer; }
 
 namespace renderer
 {
@@ -53,7 +53,8 @@ class PermanentShadingResultFrameBufferFactory
   public:
     // Constructor.
     explicit PermanentShadingResultFrameBufferFactory(
-        const Frame&                frame);
+        const Frame&                frame,
+        const ShadingResultFrameBuffer::Layout layout = ShadingResultFrameBuffer::InterleavedLayout);
 
     // Destructor.
     ~PermanentShadingResultFrameBufferFactory() override;
@@ -70,8 +71,11 @@ class PermanentShadingResultFrameBufferFactory
     void destroy(
         ShadingResultFrameBuffer*   framebuffer) override;
 
+    bool is_permanent() const override;
+
   private:
-    std::vector<ShadingResultFrameBuffer*> m_framebuffers;
+    const ShadingResultFrameBuffer::Layout  m_layout;
+    std::vector<ShadingResultFrameBuffer*>  m_framebuffers;
 };
 
 }   // namespace renderer
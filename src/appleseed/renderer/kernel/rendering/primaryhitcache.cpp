@@ -0,0 +1,321 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "primaryhitcache.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/math/matrix.h"
+#include "foundation/utility/siphash.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// PrimaryHitCache class implementation.
+//
+
+namespace
+{
+    uint64 combine_transform(uint64 signature, const Transformd& transform)
+    {
+        return
+            Entity::combine_signatures(
+                signature,
+                siphash24(&transform.get_local_to_parent(), sizeof(Matrix4d)));
+    }
+
+    uint64 combine_materials(uint64 signature, const MaterialArray& materials)
+    {
+        for (size_t i = 0, e = materials.size(); i < e; ++i)
+        {
+            const Material* material = materials[i];
+            signature =
+                Entity::combine_signatures(
+                    signature,
+                    material != nullptr ? material->compute_signature() : 0);
+        }
+
+        return signature;
+    }
+
+    uint64 combine_geometry(uint64 signature, const Assembly& assembly)
+    {
+        for (const ObjectInstance& object_instance : assembly.object_instances())
+        {
+            signature = Entity::combine_signatures(signature, object_instance.compute_signature());
+            signature = combine_transform(signature, object_instance.get_transform());
+            signature = combine_materials(signature, object_instance.get_front_materials());
+            signature = combine_materials(signature, object_instance.get_back_materials());
+        }
+
+        return signature;
+    }
+
+    uint64 combine_geometry(uint64 signature, const AssemblyInstanceContainer& assembly_instances)
+    {
+        for (const AssemblyInstance& assembly_instance : assembly_instances)
+        {
+            const Assembly& assembly = assembly_instance.get_assembly();
+
+            signature = Entity::combine_signatures(signature, assembly_instance.compute_signature());
+            signature = Entity::combine_signatures(signature, assembly.compute_signature());
+
+            const TransformSequence& transform_sequence = assembly_instance.transform_sequence();
+            for (size_t i = 0, e = transform_sequence.size(); i < e; ++i)
+            {
+                float time;
+                Transformd transform;
+                transform_sequence.get_transform(i, time, transform);
+                signature = Entity::combine_signatures(signature, siphash24(time));
+                signature = combine_transform(signature, transform);
+            }
+
+            signature = combine_geometry(signature, assembly.assembly_instances());
+            signature = combine_geometry(signature, assembly);
+        }
+
+        return signature;
+    }
+}
+
+PrimaryHitCache::PrimaryHitCache()
+  : m_width(0)
+  , m_height(0)
+  , m_hits_per_pixel(0)
+  , m_signature(0)
+  , m_locks(new Spinlock[LockCount])
+{
+}
+
+PrimaryHitCache::~PrimaryHitCache()
+{
+}
+
+uint64 PrimaryHitCache::compute_signature(const Scene& scene)
+{
+    return combine_geometry(0, scene.assembly_instances());
+}
+
+void PrimaryHitCache::prepare(
+    const Scene&            scene,
+    const Frame&            frame,
+    const size_t            hits_per_pixel)
+{
+    if (hits_per_pixel == 0)
+    {
+        clear();
+        return;
+    }
+
+    const CanvasProperties& props = frame.image().properties();
+    const uint64 signature = compute_signature(scene);
+
+    // The trace context has been updated since the last render, its transform sequences are new.
+    m_transform_seq_copies.clear();
+
+    if (m_signature == signature &&
+        m_width == props.m_canvas_width &&
+        m_height == props.m_canvas_height &&
+        m_hits_per_pixel == hits_per_pixel)
+    {
+        RENDERER_LOG_DEBUG("scene geometry is unchanged, reusing primary hits.");
+        return;
+    }
+
+    clear();
+
+    m_width = props.m_canvas_width;
+    m_height = props.m_canvas_height;
+    m_hits_per_pixel = hits_per_pixel;
+    m_signature = signature;
+    m_pixels.resize(m_width * m_height);
+}
+
+bool PrimaryHitCache::lookup(
+    const Vector2i&         pi,
+    const ShadingRay&       ray,
+    const Scene&            scene,
+    TextureCache&           texture_cache,
+    ShadingPoint&           shading_point) const
+{
+    assert(is_enabled());
+
+    if (pi.x < 0 || pi.y < 0 ||
+        static_cast<size_t>(pi.x) >= m_width ||
+        static_cast<size_t>(pi.y) >= m_height)
+        return false;
+
+    const size_t pixel_index = pi.y * m_width + pi.x;
+    Spinlock::ScopedLock lock(get_lock(pixel_index));
+
+    for (const Hit& hit : m_pixels[pixel_index])
+    {
+        if (hit.m_org != ray.m_org ||
+            hit.m_dir != ray.m_dir ||
+            hit.m_time != ray.m_time.m_absolute)
+            continue;
+
+        // Context.
+        shading_point.m_texture_cache = &texture_cache;
+        shading_point.m_scene = &scene;
+        shading_point.m_ray = ray;
+        shading_point.m_ray.m_tmax = hit.m_tmax;
+
+        // Primary intersection results.
+        shading_point.m_primitive_type = hit.m_primitive_type;
+        shading_point.m_bary = hit.m_bary;
+        shading_point.m_assembly_instance = hit.m_assembly_instance;
+        shading_point.m_assembly_instance_transform = hit.m_assembly_instance_transform;
+        shading_point.m_assembly_instance_transform_seq = hit.m_assembly_instance_transform_seq;
+        shading_point.m_point_instancer = hit.m_point_instancer;
+        shading_point.m_point_instance_index = hit.m_point_instance_index;
+        shading_point.m_object_instance_index = hit.m_object_instance_index;
+        shading_point.m_primitive_index = hit.m_primitive_index;
+        shading_point.m_triangle_support_plane = hit.m_triangle_support_plane;
+
+        // Available on-demand results: none.
+        shading_point.m_members = 0;
+
+        return true;
+    }
+
+    return false;
+}
+
+void PrimaryHitCache::insert(
+    const Vector2i&         pi,
+    const ShadingPoint&     shading_point)
+{
+    assert(is_enabled());
+
+    if (pi.x < 0 || pi.y < 0 ||
+        static_cast<size_t>(pi.x) >= m_width ||
+        static_cast<size_t>(pi.y) >= m_height)
+        return;
+
+    const size_t pixel_index = pi.y * m_width + pi.x;
+
+    // Bail out early once the pixel is full, before copying any transform sequence.
+    {
+        Spinlock::ScopedLock lock(get_lock(pixel_index));
+        if (m_pixels[pixel_index].size() >= m_hits_per_pixel)
+            return;
+    }
+
+    const TransformSequence* transform_seq =
+        shading_point.hit_surface()
+            ? get_transform_seq_copy(shading_point.m_assembly_instance_transform_seq)
+            : nullptr;
+
+    Spinlock::ScopedLock lock(get_lock(pixel_index));
+
+    HitVector& hits = m_pixels[pixel_index];
+
+    if (hits.size() >= m_hits_per_pixel)
+        return;
+
+    if (hits.capacity() == 0)
+        hits.reserve(m_hits_per_pixel);
+
+    Hit hit;
+    hit.m_org = shading_point.m_ray.m_org;
+    hit.m_dir = shading_point.m_ray.m_dir;
+    hit.m_time = shading_point.m_ray.m_time.m_absolute;
+    hit.m_tmax = shading_point.m_ray.m_tmax;
+    hit.m_primitive_type = shading_point.m_primitive_type;
+    hit.m_bary = shading_point.m_bary;
+    hit.m_assembly_instance = shading_point.m_assembly_instance;
+    hit.m_assembly_instance_transform = shading_point.m_assembly_instance_transform;
+    hit.m_assembly_instance_transform_seq = transform_seq;
+    hit.m_point_instancer = shading_point.m_point_instancer;
+    hit.m_point_instance_index = shading_point.m_point_instance_index;
+    hit.m_object_instance_index = shading_point.m_object_instance_index;
+    hit.m_primitive_index = shading_point.m_primitive_index;
+    hit.m_triangle_support_plane = shading_point.m_triangle_support_plane;
+    hits.push_back(hit);
+}
+
+void PrimaryHitCache::clear()
+{
+    m_width = 0;
+    m_height = 0;
+    m_hits_per_pixel = 0;
+    m_signature = 0;
+
+    // Release the memory held by the hits.
+    vector<HitVector>().swap(m_pixels);
+    m_transform_seq_copies.clear();
+    m_transform_seqs.clear();
+}
+
+Spinlock& PrimaryHitCache::get_lock(const size_t pixel_index) const
+{
+    return m_locks[pixel_index % LockCount];
+}
+
+const TransformSequence* PrimaryHitCache::get_transform_seq_copy(const TransformSequence* transform_seq)
+{
+    assert(transform_seq);
+
+    boost::mutex::scoped_lock lock(m_transform_seqs_mutex);
+
+    const TransformSequenceMap::const_iterator it = m_transform_seq_copies.find(transform_seq);
+    if (it != m_transform_seq_copies.end())
+        return it->second;
+
+    m_transform_seqs.push_back(*transform_seq);
+
+    const TransformSequence* copy = &m_transform_seqs.back();
+    m_transform_seq_copies.insert(make_pair(transform_seq, copy));
+
+    return copy;
+}
+
+}   // namespace renderer
@@ -0,0 +1,174 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Forward declarations.
+namespace renderer      { class Frame; }
+namespace renderer      { class Scene; }
+namespace renderer      { class ShadingRay; }
+namespace renderer      { class TextureCache; }
+
+namespace renderer
+{
+
+//
+// Keeps the first hits of camera rays alive across reinitializations of a render
+// so that edits that don't affect geometry (e.g. tweaking a material during look
+// development) don't require camera rays to be traced again.
+//
+// Progressive renders restart their sample sequences after every edit, hence the
+// camera rays of the first passes are identical from one restart to the next.
+// The cache stores up to a fixed number of hits per pixel, each keyed by the exact
+// origin, direction and time of its camera ray, so that camera moves simply cause
+// cache misses. The transform sequences of the hit assembly instances are owned by
+// the cache since the trace context recreates them whenever it is updated. All hits
+// are dropped whenever the signature of the geometry of the scene changes. This signature covers the assembly instances, the assemblies, the
+// object instances with their objects and materials (whose alpha maps affect ray
+// intersections) and all their transforms.
+//
+// Lookups and insertions are thread-safe.
+//
+
+class PrimaryHitCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    PrimaryHitCache();
+
+    // Destructor.
+    ~PrimaryHitCache();
+
+    // Compute the signature of the geometry of a scene.
+    // Must be called after the scene's on_render_begin() method.
+    static foundation::uint64 compute_signature(const Scene& scene);
+
+    // Prepare the cache for rendering a given scene into a given frame, dropping all
+    // hits if the geometry of the scene, the frame resolution or the number of hits
+    // per pixel changed. The cache is disabled if `hits_per_pixel` is zero.
+    // Must be called after the scene's on_render_begin() method.
+    void prepare(
+        const Scene&                    scene,
+        const Frame&                    frame,
+        const size_t                    hits_per_pixel);
+
+    // Return true if the cache is enabled.
+    bool is_enabled() const;
+
+    // Retrieve the first hit of a camera ray. Return true if it was found.
+    bool lookup(
+        const foundation::Vector2i&     pi,
+        const ShadingRay&               ray,
+        const Scene&                    scene,
+        TextureCache&                   texture_cache,
+        ShadingPoint&                   shading_point) const;
+
+    // Store the first hit of a camera ray, unless the pixel already holds its maximum number of hits.
+    void insert(
+        const foundation::Vector2i&     pi,
+        const ShadingPoint&             shading_point);
+
+    // Drop all hits and disable the cache.
+    void clear();
+
+  private:
+    struct Hit
+    {
+        foundation::Vector3d            m_org;
+        foundation::Vector3d            m_dir;
+        float                           m_time;
+        double                          m_tmax;
+        ShadingPoint::PrimitiveType     m_primitive_type;
+        foundation::Vector2f            m_bary;
+        const AssemblyInstance*         m_assembly_instance;
+        foundation::Transformd          m_assembly_instance_transform;
+        const TransformSequence*        m_assembly_instance_transform_seq;
+        const PointInstancer*           m_point_instancer;
+        size_t                          m_point_instance_index;
+        size_t                          m_object_instance_index;
+        size_t                          m_primitive_index;
+        TriangleSupportPlaneType        m_triangle_support_plane;
+    };
+
+    typedef std::vector<Hit> HitVector;
+    typedef std::map<const TransformSequence*, const TransformSequence*> TransformSequenceMap;
+
+    enum { LockCount = 256 };
+
+    size_t                              m_width;
+    size_t                              m_height;
+    size_t                              m_hits_per_pixel;
+    foundation::uint64                  m_signature;
+    std::vector<HitVector>              m_pixels;
+    std::unique_ptr<foundation::Spinlock[]> m_locks;
+
+    // Copies of the transform sequences referenced by the hits, and their originals in the current trace context.
+    std::deque<TransformSequence>       m_transform_seqs;
+    TransformSequenceMap                m_transform_seq_copies;
+    boost::mutex                        m_transform_seqs_mutex;
+
+    foundation::Spinlock& get_lock(const size_t pixel_index) const;
+
+    // Return the copy of a transform sequence of the current trace context owned by the cache.
+    const TransformSequence* get_transform_seq_copy(const TransformSequence* transform_seq);
+};
+
+
+//
+// PrimaryHitCache class implementation.
+//
+
+inline bool PrimaryHitCache::is_enabled() const
+{
+    return m_hits_per_pixel > 0;
+}
+
+}   // namespace renderer
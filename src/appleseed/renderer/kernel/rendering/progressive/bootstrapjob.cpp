@@ -0,0 +1,162 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "bootstrapjob.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/isamplegenerator.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/eventtracer.h"
+
+// Standard headers.
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// BootstrapSchedule class implementation.
+//
+
+BootstrapSchedule::BootstrapSchedule(
+    JobQueue&                   job_queue,
+    const size_t                pass_count)
+  : m_job_queue(job_queue)
+  , m_pass(0)
+  , m_remaining_jobs(0)
+{
+    // The last pass renders one sample per 2x2 block of pixels, the pass before it one
+    // sample per 4x4 block, and so on.
+    for (size_t i = pass_count; i > 0; --i)
+        m_block_sizes.push_back(size_t(1) << i);
+}
+
+void BootstrapSchedule::set_jobs(
+    const vector<IJob*>&        bootstrap_jobs,
+    const vector<IJob*>&        follow_up_jobs)
+{
+    m_bootstrap_jobs = bootstrap_jobs;
+    m_follow_up_jobs = follow_up_jobs;
+}
+
+void BootstrapSchedule::start()
+{
+    m_pass = 0;
+
+    if (m_block_sizes.empty() || m_bootstrap_jobs.empty())
+        schedule(m_follow_up_jobs);
+    else
+    {
+        m_remaining_jobs = m_bootstrap_jobs.size();
+        schedule(m_bootstrap_jobs);
+    }
+}
+
+void BootstrapSchedule::on_job_completed(const bool aborted)
+{
+    assert(m_remaining_jobs > 0);
+
+    // Only the last job of the pass schedules the next jobs.
+    if (--m_remaining_jobs > 0)
+        return;
+
+    // Rendering was stopped, the remaining passes are dropped.
+    if (aborted)
+        return;
+
+    if (++m_pass < m_block_sizes.size())
+    {
+        m_remaining_jobs = m_bootstrap_jobs.size();
+        schedule(m_bootstrap_jobs);
+    }
+    else schedule(m_follow_up_jobs);
+}
+
+void BootstrapSchedule::schedule(const vector<IJob*>& jobs)
+{
+    for (auto job : jobs)
+    {
+        m_job_queue.schedule(
+            job,
+            false);     // don't transfer ownership of the job to the queue
+    }
+}
+
+
+//
+// BootstrapJob class implementation.
+//
+
+BootstrapJob::BootstrapJob(
+    SampleAccumulationBuffer&   buffer,
+    ISampleGenerator*           sample_generator,
+    const Spectrum::Mode        spectrum_mode,
+    BootstrapSchedule&          schedule,
+    IAbortSwitch&               abort_switch)
+  : m_buffer(buffer)
+  , m_sample_generator(sample_generator)
+  , m_spectrum_mode(spectrum_mode)
+  , m_schedule(schedule)
+  , m_abort_switch(abort_switch)
+{
+}
+
+void BootstrapJob::execute(const size_t thread_index)
+{
+    TraceScope trace_scope("rendering", "generate bootstrap samples");
+
+    // Initialize thread-local variables.
+    Spectrum::set_mode(m_spectrum_mode);
+
+    // Like the first samples of regular rendering, the first pass is uninterruptible
+    // in order to always have something to show during navigation.
+    if (m_schedule.is_first_pass())
+    {
+        AbortSwitch no_abort;
+        m_sample_generator->generate_bootstrap_samples(
+            m_schedule.get_block_size(),
+            m_buffer,
+            no_abort);
+    }
+    else
+    {
+        m_sample_generator->generate_bootstrap_samples(
+            m_schedule.get_block_size(),
+            m_buffer,
+            m_abort_switch);
+    }
+
+    m_schedule.on_job_completed(m_abort_switch.is_aborted());
+}
+
+}   // namespace renderer
@@ -0,0 +1,138 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/job.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class ISampleGenerator; }
+namespace renderer  { class SampleAccumulationBuffer; }
+
+namespace renderer
+{
+
+//
+// Bootstrap passes render one sample per block of pixels, for decreasing block sizes,
+// before regular progressive rendering starts. Each pass fills one level of the
+// accumulation buffer's resolution pyramid, so that coarse images can be displayed
+// right away.
+//
+// The bootstrap jobs of a pass run concurrently, one per sample generator. The last
+// job to complete a pass schedules the jobs of the next pass; the last pass schedules
+// the regular rendering jobs.
+//
+
+class BootstrapSchedule
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    BootstrapSchedule(
+        foundation::JobQueue&               job_queue,
+        const size_t                        pass_count);
+
+    // Set the jobs of the bootstrap passes and the jobs scheduled once the passes are complete.
+    void set_jobs(
+        const std::vector<foundation::IJob*>&   bootstrap_jobs,
+        const std::vector<foundation::IJob*>&   follow_up_jobs);
+
+    // Schedule the jobs of the first pass, or the follow-up jobs if there is no pass.
+    void start();
+
+    // Return the block size of the current pass.
+    size_t get_block_size() const;
+
+    // Return true if the current pass is the first one.
+    bool is_first_pass() const;
+
+    // Signal the completion of a bootstrap job; schedule the next jobs if it was the last job of its pass.
+    void on_job_completed(const bool aborted);
+
+  private:
+    foundation::JobQueue&                   m_job_queue;
+    std::vector<size_t>                     m_block_sizes;      // coarsest first
+    std::vector<foundation::IJob*>          m_bootstrap_jobs;
+    std::vector<foundation::IJob*>          m_follow_up_jobs;
+    size_t                                  m_pass;
+    boost::atomic<size_t>                   m_remaining_jobs;   // jobs of the current pass still running
+
+    void schedule(const std::vector<foundation::IJob*>& jobs);
+};
+
+class BootstrapJob
+  : public foundation::IJob
+{
+  public:
+    // Constructor.
+    BootstrapJob(
+        SampleAccumulationBuffer&           buffer,
+        ISampleGenerator*                   sample_generator,
+        const Spectrum::Mode                spectrum_mode,
+        BootstrapSchedule&                  schedule,
+        foundation::IAbortSwitch&           abort_switch);
+
+    // Execute the job.
+    void execute(const size_t thread_index) override;
+
+  private:
+    SampleAccumulationBuffer&               m_buffer;
+    ISampleGenerator*                       m_sample_generator;
+    const Spectrum::Mode                    m_spectrum_mode;
+    BootstrapSchedule&                      m_schedule;
+    foundation::IAbortSwitch&               m_abort_switch;
+};
+
+
+//
+// BootstrapSchedule class implementation.
+//
+
+inline size_t BootstrapSchedule::get_block_size() const
+{
+    return m_block_sizes[m_pass];
+}
+
+inline bool BootstrapSchedule::is_first_pass() const
+{
+    return m_pass == 0;
+}
+
+}   // namespace renderer
@@ -32,9 +32,12 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/denoising/previewdenoiser.h"
 #include "renderer/kernel/rendering/iframerenderer.h"
 #include "renderer/kernel/rendering/isamplegenerator.h"
 #include "renderer/kernel/rendering/itilecallback.h"
+#include "renderer/kernel/rendering/progressive/bootstrapjob.h"
+#include "renderer/kernel/rendering/progressive/samplebudget.h"
 #include "renderer/kernel/rendering/progressive/samplecounter.h"
 #include "renderer/kernel/rendering/progressive/samplecounthistory.h"
 #include "renderer/kernel/rendering/progressive/samplegeneratorjob.h"
@@ -66,6 +69,7 @@
 #include "foundation/utility/string.h"
 
 // Boost headers.
+#include "boost/atomic/atomic.hpp"
 #include "boost/filesystem.hpp"
 
 // Standard headers.
@@ -86,6 +90,9 @@ namespace renderer
 
 namespace
 {
+    // Bootstrap passes are rendered at 1/8, 1/4 and 1/2 resolution.
+    const size_t MaxBootstrapPasses = 3;
+
     //
     // Progressive frame renderer.
     //
@@ -103,10 +110,11 @@ namespace
             const ParamArray&               params)
           : m_project(project)
           , m_params(params)
-          , m_sample_counter(
+          , m_max_sample_count(
                 m_params.m_max_average_spp < numeric_limits<uint64>::max()
                     ? m_params.m_max_average_spp * project.get_frame()->get_crop_window().volume()
                     : m_params.m_max_average_spp)
+          , m_sample_counter(m_max_sample_count)
           , m_ref_image_avg_lum(0.0)
         {
             // We must have a generator factory, but it's OK not to have a callback factory.
@@ -121,7 +129,9 @@ namespace
                     global_logger(),
                     m_job_queue,
                     m_params.m_thread_count,
-                    JobManager::KeepRunningOnEmptyQueue));
+                    JobManager::KeepRunningOnEmptyQueue |
+                    (m_params.m_work_stealing ? JobManager::WorkStealing : 0) |
+                    (m_params.m_numa_pinning ? JobManager::PinThreadsToNumaNodes : 0)));
 
             // Instantiate sample generators, one per rendering thread.
             m_sample_generators.reserve(m_params.m_thread_count);
@@ -146,10 +156,46 @@ namespace
                         m_abort_switch));
             }
 
+            // Create bootstrap jobs, one per rendering thread.
+            m_bootstrap_schedule.reset(
+                new BootstrapSchedule(m_job_queue, m_params.m_bootstrap_passes));
+            if (m_params.m_bootstrap_passes > 0)
+            {
+                m_bootstrap_jobs.reserve(m_params.m_thread_count);
+                for (size_t i = 0; i < m_params.m_thread_count; ++i)
+                {
+                    m_bootstrap_jobs.push_back(
+                        new BootstrapJob(
+                            *m_buffer.get(),
+                            m_sample_generators[i],
+                            m_params.m_spectrum_mode,
+                            *m_bootstrap_schedule.get(),
+                            m_abort_switch));
+                }
+            }
+            m_bootstrap_schedule->set_jobs(
+                vector<IJob*>(m_bootstrap_jobs.begin(), m_bootstrap_jobs.end()),
+                vector<IJob*>(m_sample_generator_jobs.begin(), m_sample_generator_jobs.end()));
+
             // Instantiate a single tile callback.
             if (callback_factory)
                 m_tile_callback.reset(callback_factory->create());
 
+            // Create the preview denoiser. Previews are only useful if there is a tile callback to present them.
+            if (m_params.m_denoise_preview_passes > 0 && m_tile_callback.get() != nullptr)
+            {
+                if (m_project.get_frame()->denoiser_aov() != nullptr)
+                {
+                    m_preview_denoiser.reset(
+                        new PreviewDenoiser(
+                            *m_project.get_frame(),
+                            m_params.m_denoise_preview_passes,
+                            m_params.m_denoise_preview_threads));
+                    m_buffer->set_preview_denoiser(m_preview_denoiser.get());
+                }
+                else RENDERER_LOG_WARNING("denoising is disabled on the frame, disabling denoised previews.");
+            }
+
             if (m_project.get_frame()->has_valid_ref_image())
             {
                 m_ref_image_avg_lum = compute_average_luminance(*m_project.get_frame()->ref_image());
@@ -167,6 +213,14 @@ namespace
             if (m_statistics_thread.get() && m_statistics_thread->joinable())
                 m_statistics_thread->join();
 
+            // Stop the budget thread.
+            if (m_budget_thread.get() && m_budget_thread->joinable())
+                m_budget_thread->join();
+
+            // Stop the preview denoising thread.
+            if (m_denoise_preview_thread.get() && m_denoise_preview_thread->joinable())
+                m_denoise_preview_thread->join();
+
             // Stop the display thread.
             m_display_thread_abort_switch.abort();
             if (m_display_thread.get() && m_display_thread->joinable())
@@ -178,6 +232,8 @@ namespace
             // Delete rendering jobs.
             for (auto sample_generator_job : m_sample_generator_jobs)
                 delete sample_generator_job;
+            for (auto bootstrap_job : m_bootstrap_jobs)
+                delete bootstrap_job;
 
             // Delete sample generators.
             for (auto sample_generator : m_sample_generators)
@@ -197,18 +253,37 @@ namespace
                 "  sampling mode                 %s\n"
                 "  rendering threads             %s\n"
                 "  max average samples per pixel %s\n"
+                "  time limit                    %s\n"
                 "  max fps                       %f\n"
+                "  bootstrap passes              %s\n"
                 "  collect performance stats     %s\n"
-                "  collect luminance stats       %s",
+                "  collect luminance stats       %s\n"
+                "  work stealing                 %s\n"
+                "  numa pinning                  %s\n"
+                "  denoised previews             %s",
                 get_spectrum_mode_name(m_params.m_spectrum_mode).c_str(),
                 get_sampling_context_mode_name(m_params.m_sampling_mode).c_str(),
                 pretty_uint(m_params.m_thread_count).c_str(),
                 m_params.m_max_average_spp == numeric_limits<uint64>::max()
                     ? "unlimited"
                     : pretty_uint(m_params.m_max_average_spp).c_str(),
+                m_params.m_time_limit > 0.0
+                    ? pretty_time(m_params.m_time_limit).c_str()
+                    : "unlimited",
                 m_params.m_max_fps,
+                m_params.m_bootstrap_passes > 0
+                    ? pretty_uint(m_params.m_bootstrap_passes).c_str()
+                    : "off",
                 m_params.m_perf_stats ? "on" : "off",
-                m_params.m_luminance_stats ? "on" : "off");
+                m_params.m_luminance_stats ? "on" : "off",
+                m_params.m_work_stealing ? "on" : "off",
+                m_params.m_numa_pinning ? "on" : "off",
+                m_preview_denoiser.get()
+                    ? ("every " + pretty_uint(m_params.m_denoise_preview_passes) + " " +
+                       plural(m_params.m_denoise_preview_passes, "pass", "passes") + ", " +
+                       pretty_uint(m_params.m_denoise_preview_threads) + " " +
+                       plural(m_params.m_denoise_preview_threads, "thread")).c_str()
+                    : "off");
 
             m_sample_generators.front()->print_settings();
         }
@@ -225,6 +300,11 @@ namespace
             return m_job_queue.has_scheduled_or_running_jobs();
         }
 
+        double get_remaining_time() const override
+        {
+            return m_budget_func.get() ? m_budget_func->get_remaining_time() : -1.0;
+        }
+
         void start_rendering() override
         {
             assert(!is_rendering());
@@ -233,18 +313,17 @@ namespace
             m_abort_switch.clear();
             m_buffer->clear();
             m_sample_counter.clear();
+            m_sample_counter.set_max_sample_count(m_max_sample_count);
+
+            if (m_preview_denoiser.get())
+                m_preview_denoiser->clear();
 
             // Reset sample generators.
             for (auto sample_generator : m_sample_generators)
                 sample_generator->reset();
 
-            // Schedule rendering jobs.
-            for (auto sample_generator_job : m_sample_generator_jobs)
-            {
-                m_job_queue.schedule(
-                    sample_generator_job,
-                    false);     // don't transfer ownership of the job to the queue
-            }
+            // Schedule bootstrap jobs, or rendering jobs directly if there are no bootstrap passes.
+            m_bootstrap_schedule->start();
 
             // Start job execution.
             m_job_manager->start();
@@ -263,6 +342,35 @@ namespace
                 new boost::thread(
                     ThreadFunctionWrapper<StatisticsFunc>(m_statistics_func.get())));
 
+            // Create and start the budget thread.
+            if (m_params.m_time_limit > 0.0)
+            {
+                m_budget_func.reset(
+                    new BudgetFunc(
+                        m_sample_counter,
+                        SampleBudget(
+                            m_project.get_frame()->get_crop_window().volume(),
+                            m_params.m_time_limit,
+                            m_max_sample_count),
+                        m_params.m_time_limit,
+                        m_abort_switch));
+                m_budget_thread.reset(
+                    new boost::thread(
+                        ThreadFunctionWrapper<BudgetFunc>(m_budget_func.get())));
+            }
+
+            // Create and start the preview denoising thread.
+            if (m_preview_denoiser.get())
+            {
+                m_denoise_preview_func.reset(
+                    new DenoisePreviewFunc(
+                        *m_preview_denoiser.get(),
+                        m_abort_switch));
+                m_denoise_preview_thread.reset(
+                    new boost::thread(
+                        ThreadFunctionWrapper<DenoisePreviewFunc>(m_denoise_preview_func.get())));
+            }
+
             // Create and start the display thread.
             if (m_tile_callback.get() != nullptr && m_display_thread.get() == nullptr)
             {
@@ -271,6 +379,7 @@ namespace
                         *m_project.get_frame(),
                         *m_buffer.get(),
                         m_tile_callback.get(),
+                        m_preview_denoiser.get(),
                         m_params.m_max_fps,
                         m_display_thread_abort_switch));
                 m_display_thread.reset(
@@ -284,17 +393,26 @@ namespace
 
         void stop_rendering() override
         {
-            // First, delete scheduled jobs to prevent worker threads from picking them up.
-            m_job_queue.clear_scheduled_jobs();
-
-            // Tell rendering jobs and the statistics thread to stop.
+            // First, tell rendering jobs, the statistics and the budget threads to stop.
+            // Running jobs then stop rendering and don't reschedule themselves.
             m_abort_switch.abort();
 
+            // Delete scheduled jobs to prevent worker threads from picking them up.
+            m_job_queue.clear_scheduled_jobs();
+
             // Wait until rendering jobs have effectively stopped.
             m_job_queue.wait_until_completion();
 
             // Wait until the statistics thread has stopped.
             m_statistics_thread->join();
+
+            // Wait until the budget thread has stopped.
+            if (m_budget_thread.get())
+                m_budget_thread->join();
+
+            // Wait until the preview denoising thread has stopped.
+            if (m_denoise_preview_thread.get())
+                m_denoise_preview_thread->join();
         }
 
         void pause_rendering() override
@@ -305,10 +423,22 @@ namespace
                 m_display_func->pause();
 
             m_statistics_func->pause();
+
+            if (m_budget_func.get())
+                m_budget_func->pause();
+
+            if (m_denoise_preview_func.get())
+                m_denoise_preview_func->pause();
         }
 
         void resume_rendering() override
         {
+            if (m_denoise_preview_func.get())
+                m_denoise_preview_func->resume();
+
+            if (m_budget_func.get())
+                m_budget_func->resume();
+
             m_statistics_func->resume();
 
             if (m_display_func.get())
@@ -327,6 +457,14 @@ namespace
             m_statistics_thread.reset();
             m_statistics_func.reset();
 
+            // The budget thread has already been joined in stop_rendering() as well.
+            m_budget_thread.reset();
+            m_budget_func.reset();
+
+            // So has the preview denoising thread.
+            m_denoise_preview_thread.reset();
+            m_denoise_preview_func.reset();
+
             // Join and delete the display thread.
             if (m_display_thread.get())
             {
@@ -366,18 +504,30 @@ namespace
             const SamplingContext::Mode m_sampling_mode;
             const size_t                m_thread_count;       // number of rendering threads
             const uint64                m_max_average_spp;    // maximum average number of samples to compute per pixel
+            const double                m_time_limit;         // rendering time budget in seconds, 0 for no budget
             const double                m_max_fps;            // maximum display frequency in frames/second
+            const size_t                m_bootstrap_passes;   // number of low resolution passes rendered first, 0 to disable them
             const bool                  m_perf_stats;         // collect and print performance statistics?
             const bool                  m_luminance_stats;    // collect and print luminance statistics?
+            const bool                  m_work_stealing;      // use per-thread job deques with work stealing?
+            const bool                  m_numa_pinning;       // pin rendering threads to NUMA nodes?
+            const size_t                m_denoise_preview_passes;   // number of passes between denoised previews, 0 to disable them
+            const size_t                m_denoise_preview_threads;  // number of threads used to denoise previews
 
             explicit Parameters(const ParamArray& params)
               : m_spectrum_mode(get_spectrum_mode(params))
               , m_sampling_mode(get_sampling_context_mode(params))
               , m_thread_count(get_rendering_thread_count(params))
               , m_max_average_spp(params.get_optional<uint64>("max_average_spp", numeric_limits<uint64>::max()))
+              , m_time_limit(params.get_optional<double>("time_limit", 0.0))
               , m_max_fps(params.get_optional<double>("max_fps", 30.0))
+              , m_bootstrap_passes(min<size_t>(params.get_optional<size_t>("bootstrap_passes", 0), MaxBootstrapPasses))
               , m_perf_stats(params.get_optional<bool>("performance_statistics", false))
               , m_luminance_stats(params.get_optional<bool>("luminance_statistics", false))
+              , m_work_stealing(params.get_optional<bool>("work_stealing", false))
+              , m_numa_pinning(params.get_optional<bool>("numa_pinning", false))
+              , m_denoise_preview_passes(params.get_optional<size_t>("denoise_preview_passes", 0))
+              , m_denoise_preview_threads(params.get_optional<size_t>("denoise_preview_threads", max<size_t>(m_thread_count / 4, 1)))
             {
             }
         };
@@ -394,11 +544,13 @@ namespace
                 Frame&                      frame,
                 SampleAccumulationBuffer&   buffer,
                 ITileCallback*              tile_callback,
+                PreviewDenoiser*            preview_denoiser,
                 const double                max_fps,
                 IAbortSwitch&               abort_switch)
               : m_frame(frame)
               , m_buffer(buffer)
               , m_tile_callback(tile_callback)
+              , m_preview_denoiser(preview_denoiser)
               , m_min_sample_count(min<uint64>(frame.get_crop_window().volume(), 32 * 32 * 2))
               , m_target_elapsed(1.0 / max_fps)
               , m_abort_switch(abort_switch)
@@ -475,6 +627,18 @@ namespace
                 if (m_abort_switch.is_aborted())
                     return;
 
+                if (m_preview_denoiser)
+                {
+                    m_preview_denoiser->on_frame_developed(m_buffer.get_sample_count());
+
+                    // Once a denoised preview is available, only present denoised previews.
+                    if (m_preview_denoiser->has_preview())
+                    {
+                        m_preview_denoiser->present_new_preview(m_tile_callback);
+                        return;
+                    }
+                }
+
                 // Present the frame.
                 m_tile_callback->on_progressive_frame_update(&m_frame);
 
@@ -498,6 +662,7 @@ namespace
             Frame&                              m_frame;
             SampleAccumulationBuffer&           m_buffer;
             ITileCallback*                      m_tile_callback;
+            PreviewDenoiser*                    m_preview_denoiser;
             const uint64                        m_min_sample_count;
             const double                        m_target_elapsed;
             IAbortSwitch&                       m_abort_switch;
@@ -505,6 +670,50 @@ namespace
             Stopwatch<DefaultWallclockTimer>    m_stopwatch;
         };
 
+        //
+        // Preview denoising thread.
+        //
+
+        class DenoisePreviewFunc
+          : public NonCopyable
+        {
+          public:
+            DenoisePreviewFunc(
+                PreviewDenoiser&            preview_denoiser,
+                IAbortSwitch&               abort_switch)
+              : m_preview_denoiser(preview_denoiser)
+              , m_abort_switch(abort_switch)
+            {
+            }
+
+            void pause()
+            {
+                m_pause_flag.set();
+            }
+
+            void resume()
+            {
+                m_pause_flag.clear();
+            }
+
+            void operator()()
+            {
+                set_current_thread_name("denoise preview");
+
+                while (!m_abort_switch.is_aborted())
+                {
+                    // Snapshots are taken by the display thread; wait for the next one.
+                    if (m_pause_flag.is_set() || !m_preview_denoiser.denoise_pending_snapshot(m_abort_switch))
+                        sleep(20, m_abort_switch);
+                }
+            }
+
+          private:
+            PreviewDenoiser&                m_preview_denoiser;
+            IAbortSwitch&                   m_abort_switch;
+            ThreadFlag                      m_pause_flag;
+        };
+
         //
         // Statistics gathering and printing thread.
         //
@@ -672,12 +881,111 @@ namespace
             }
         };
 
+        //
+        // Sample budget thread.
+        //
+        // Measures the rendering rate and adjusts the maximum number of samples
+        // such that rendering stops on a complete pass right before the time limit.
+        //
+
+        class BudgetFunc
+          : public NonCopyable
+        {
+          public:
+            BudgetFunc(
+                SampleCounter&              sample_counter,
+                const SampleBudget&         budget,
+                const double                time_limit,
+                IAbortSwitch&               abort_switch)
+              : m_sample_counter(sample_counter)
+              , m_budget(budget)
+              , m_time_limit(time_limit)
+              , m_abort_switch(abort_switch)
+              , m_remaining_time(time_limit)
+            {
+            }
+
+            void pause()
+            {
+                m_pause_flag.set();
+            }
+
+            void resume()
+            {
+                m_pause_flag.clear();
+            }
+
+            double get_remaining_time() const
+            {
+                return m_remaining_time.load();
+            }
+
+            void operator()()
+            {
+                set_current_thread_name("budget");
+
+                DefaultWallclockTimer timer;
+                const double rcp_timer_freq = 1.0 / timer.frequency();
+                uint64 last_time = timer.read();
+                double elapsed = 0.0;
+
+                while (!m_abort_switch.is_aborted())
+                {
+                    // Only count time during which rendering was not paused.
+                    const uint64 time = timer.read();
+                    if (m_pause_flag.is_clear())
+                        elapsed += (time - last_time) * rcp_timer_freq;
+                    last_time = time;
+
+                    if (m_pause_flag.is_clear())
+                        update(elapsed);
+
+                    sleep(100, m_abort_switch);
+                }
+            }
+
+          private:
+            SampleCounter&                  m_sample_counter;
+            const SampleBudget              m_budget;
+            const double                    m_time_limit;
+            IAbortSwitch&                   m_abort_switch;
+            ThreadFlag                      m_pause_flag;
+            SampleCountHistory<32>          m_sample_count_history;
+            boost::atomic<double>           m_remaining_time;
+
+            void update(const double elapsed)
+            {
+                const uint64 sample_count = m_sample_counter.read();
+                m_sample_count_history.insert(elapsed, sample_count);
+
+                // Wait until the rendering rate can be measured. Once the maximum number
+                // of samples is reached the rate drops to zero; keep the last plan then.
+                const double samples_per_second = m_sample_count_history.get_samples_per_second();
+                if (samples_per_second <= 0.0)
+                {
+                    m_remaining_time.store(max(m_time_limit - elapsed, 0.0));
+                    return;
+                }
+
+                const uint64 target_sample_count =
+                    m_budget.compute_sample_count(elapsed, sample_count, samples_per_second);
+                m_sample_counter.set_max_sample_count(target_sample_count);
+
+                m_remaining_time.store(
+                    SampleBudget::compute_remaining_time(
+                        m_sample_counter.get_max_sample_count(),
+                        sample_count,
+                        samples_per_second));
+            }
+        };
+
         //
         // Progressive frame renderer implementation details.
         //
 
         const Project&                          m_project;
         const Parameters                        m_params;
+        const uint64                            m_max_sample_count;
         SampleCounter                           m_sample_counter;
 
         unique_ptr<SampleAccumulationBuffer>    m_buffer;
@@ -692,6 +1000,10 @@ namespace
         typedef vector<SampleGeneratorJob*> SampleGeneratorJobVector;
         SampleGeneratorJobVector                m_sample_generator_jobs;
 
+        unique_ptr<BootstrapSchedule>           m_bootstrap_schedule;
+        typedef vector<BootstrapJob*> BootstrapJobVector;
+        BootstrapJobVector                      m_bootstrap_jobs;
+
         auto_release_ptr<ITileCallback>         m_tile_callback;
 
         double                                  m_ref_image_avg_lum;
@@ -703,6 +1015,13 @@ namespace
         unique_ptr<StatisticsFunc>              m_statistics_func;
         unique_ptr<boost::thread>               m_statistics_thread;
 
+        unique_ptr<BudgetFunc>                  m_budget_func;
+        unique_ptr<boost::thread>               m_budget_thread;
+
+        unique_ptr<PreviewDenoiser>             m_preview_denoiser;
+        unique_ptr<DenoisePreviewFunc>          m_denoise_preview_func;
+        unique_ptr<boost::thread>               m_denoise_preview_thread;
+
         void print_sample_generators_stats() const
         {
             assert(!m_sample_generators.empty());
@@ -743,6 +1062,32 @@ Dictionary ProgressiveFrameRendererFactory::get_params_metadata()
             .insert("label", "Max Average Samples Per Pixel")
             .insert("help", "Maximum number of average samples per pixel"));
 
+    metadata.dictionaries().insert(
+        "bootstrap_passes",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("min", "0")
+            .insert("max", "3")
+            .insert("label", "Bootstrap Passes")
+            .insert("help", "Number of low resolution passes (1/2, 1/4 and 1/8 resolution) rendered before full resolution passes (0 to disable)"));
+
+    metadata.dictionaries().insert(
+        "denoise_preview_passes",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Denoised Preview Passes")
+            .insert("help", "Number of passes between denoised previews; requires denoising to be enabled on the frame (0 to disable)"));
+
+    metadata.dictionaries().insert(
+        "time_limit",
+        Dictionary()
+            .insert("type", "float")
+            .insert("default", "0.0")
+            .insert("label", "Time Limit")
+            .insert("help", "Rendering time budget in seconds; rendering stops on a complete pass before the limit (0 to disable)"));
+
     return metadata;
 }
 
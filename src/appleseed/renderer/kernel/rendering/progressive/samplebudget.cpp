@@ -0,0 +1,97 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "samplebudget.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// SampleBudget class implementation.
+//
+
+SampleBudget::SampleBudget(
+    const uint64    pass_sample_count,
+    const double    time_limit,
+    const uint64    max_sample_count)
+  : m_pass_sample_count(max<uint64>(pass_sample_count, 1))
+  , m_time_limit(time_limit)
+  , m_max_sample_count(max_sample_count)
+{
+}
+
+uint64 SampleBudget::compute_sample_count(
+    const double    elapsed,
+    const uint64    sample_count,
+    const double    samples_per_second) const
+{
+    // Keep rendering until the rendering rate is known.
+    if (samples_per_second <= 0.0)
+        return m_max_sample_count;
+
+    // Number of samples that can still be rendered before the time limit.
+    const double remaining_time = max(m_time_limit - elapsed, 0.0);
+    const double remaining_samples = samples_per_second * remaining_time;
+    const uint64 projected_sample_count =
+        remaining_samples < static_cast<double>(m_max_sample_count - min(sample_count, m_max_sample_count))
+            ? sample_count + truncate<uint64>(remaining_samples)
+            : m_max_sample_count;
+
+    // Round down to complete passes, but finish the pass in progress.
+    const uint64 projected_pass_count = projected_sample_count / m_pass_sample_count;
+    const uint64 started_pass_count = sample_count / m_pass_sample_count + (sample_count % m_pass_sample_count > 0 ? 1 : 0);
+    const uint64 pass_count = max<uint64>(max(projected_pass_count, started_pass_count), 1);
+
+    return
+        pass_count < m_max_sample_count / m_pass_sample_count
+            ? pass_count * m_pass_sample_count
+            : m_max_sample_count;
+}
+
+double SampleBudget::compute_remaining_time(
+    const uint64    target_sample_count,
+    const uint64    sample_count,
+    const double    samples_per_second)
+{
+    if (target_sample_count <= sample_count || samples_per_second <= 0.0)
+        return 0.0;
+
+    return (target_sample_count - sample_count) / samples_per_second;
+}
+
+}   // namespace renderer
@@ -0,0 +1,76 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+
+namespace renderer
+{
+
+//
+// Sizes progressive rendering so that it completes on a time limit.
+//
+// Given the rate at which samples are currently being rendered, the budget
+// determines how many samples can still be rendered before the time limit,
+// rounded down to complete passes over the image, so that rendering stops
+// on an evenly sampled image instead of being cut in the middle of a pass.
+//
+
+class SampleBudget
+{
+  public:
+    // Constructor. `pass_sample_count` is the number of samples of a complete pass.
+    SampleBudget(
+        const foundation::uint64    pass_sample_count,
+        const double                time_limit,
+        const foundation::uint64    max_sample_count);
+
+    // Return the total number of samples to render given the time elapsed since
+    // rendering began, the number of samples reserved so far and the current
+    // rendering rate. The result is a whole number of passes and is never less
+    // than what is needed to complete the pass in progress.
+    foundation::uint64 compute_sample_count(
+        const double                elapsed,
+        const foundation::uint64    sample_count,
+        const double                samples_per_second) const;
+
+    // Estimate the time in seconds left until `target_sample_count` samples are rendered.
+    static double compute_remaining_time(
+        const foundation::uint64    target_sample_count,
+        const foundation::uint64    sample_count,
+        const double                samples_per_second);
+
+  private:
+    const foundation::uint64        m_pass_sample_count;
+    const double                    m_time_limit;
+    const foundation::uint64        m_max_sample_count;
+};
+
+}   // namespace renderer
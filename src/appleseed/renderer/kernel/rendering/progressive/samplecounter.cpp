@@ -32,7 +32,6 @@
 
 // Standard headers.
 #include <algorithm>
-#include <cassert>
 
 using namespace foundation;
 using namespace std;
@@ -61,12 +60,26 @@ uint64 SampleCounter::reserve(const uint64 n)
     while (true)
     {
         uint64 current = m_sample_count;
-        assert(current <= m_max_sample_count);
+        const uint64 max_sample_count = m_max_sample_count;
 
-        const uint64 reserved = min(n, m_max_sample_count - current);
+        // The maximum may have been lowered concurrently with a reservation.
+        if (current >= max_sample_count)
+            return 0;
+
+        const uint64 reserved = min(n, max_sample_count - current);
         if (m_sample_count.compare_exchange_weak(current, current + reserved))
             return reserved;
     }
 }
 
+uint64 SampleCounter::get_max_sample_count() const
+{
+    return m_max_sample_count;
+}
+
+void SampleCounter::set_max_sample_count(const uint64 max_sample_count)
+{
+    m_max_sample_count = max<uint64>(max_sample_count, m_sample_count);
+}
+
 }   // namespace renderer
@@ -53,8 +53,14 @@ class SampleCounter
 
     foundation::uint64 reserve(const foundation::uint64 n);
 
+    foundation::uint64 get_max_sample_count() const;
+
+    // Change the maximum number of samples while samples are being reserved.
+    // The maximum never drops below the number of samples already reserved.
+    void set_max_sample_count(const foundation::uint64 max_sample_count);
+
   private:
-    const foundation::uint64            m_max_sample_count;
+    boost::atomic<foundation::uint64>   m_max_sample_count;
     boost::atomic<foundation::uint64>   m_sample_count;
 };
 
@@ -41,6 +41,7 @@
 #include "foundation/image/image.h"
 #include "foundation/math/scalar.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/stopwatch.h"
 
 // Standard headers.
@@ -109,6 +110,8 @@ uint64 SampleGeneratorJob::samples_to_samples_per_job(const uint64 samples)
 
 void SampleGeneratorJob::execute(const size_t thread_index)
 {
+    TraceScope trace_scope("rendering", "generate samples");
+
     // Initialize thread-local variables.
     Spectrum::set_mode(m_spectrum_mode);
 
@@ -31,9 +31,12 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/lighting/backwardlightsamplercache.h"
 #include "renderer/kernel/lighting/bdpt/bdptlightingengine.h"
+#include "renderer/kernel/lighting/causticphotonmap.h"
 #include "renderer/kernel/lighting/lighttracing/lighttracingsamplegenerator.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
+#include "renderer/kernel/lighting/pt/ptpasscallback.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmparameters.h"
 #include "renderer/kernel/lighting/sppm/sppmpasscallback.h"
@@ -50,9 +53,12 @@
 #include "renderer/kernel/rendering/generic/genericsamplerenderer.h"
 #include "renderer/kernel/rendering/generic/generictilerenderer.h"
 #include "renderer/kernel/rendering/permanentshadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/primaryhitcache.h"
 #include "renderer/kernel/rendering/progressive/progressiveframerenderer.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
 #include "renderer/kernel/shading/oslshadingsystem.h"
 #include "renderer/kernel/texturing/oiiotexturesystem.h"
+#include "renderer/modeling/frame/frame.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/utility/paramarray.h"
 
@@ -100,12 +106,14 @@ namespace
 }
 
 RendererComponents::RendererComponents(
-    const Project&          project,
-    const ParamArray&       params,
-    ITileCallbackFactory*   tile_callback_factory,
-    TextureStore&           texture_store,
-    OIIOTextureSystem&      texture_system,
-    OSLShadingSystem&       shading_system)
+    const Project&              project,
+    const ParamArray&           params,
+    ITileCallbackFactory*       tile_callback_factory,
+    TextureStore&               texture_store,
+    OIIOTextureSystem&          texture_system,
+    OSLShadingSystem&           shading_system,
+    BackwardLightSamplerCache&  backward_light_sampler_cache,
+    PrimaryHitCache&            primary_hit_cache)
   : m_project(project)
   , m_params(params)
   , m_tile_callback_factory(tile_callback_factory)
@@ -113,7 +121,9 @@ RendererComponents::RendererComponents(
   , m_frame(*project.get_frame())
   , m_trace_context(project.get_trace_context())
   , m_forward_light_sampler(nullptr)
+  , m_backward_light_sampler_cache(backward_light_sampler_cache)
   , m_backward_light_sampler(nullptr)
+  , m_primary_hit_cache(primary_hit_cache)
   , m_shading_engine(get_child_and_inherit_globals(params, "shading_engine"))
   , m_texture_store(texture_store)
   , m_texture_system(texture_system)
@@ -183,16 +193,48 @@ bool RendererComponents::create_lighting_engine_factory()
     }
     else if (name == "pt")
     {
-        m_backward_light_sampler.reset(
-            new BackwardLightSampler(
+        m_backward_light_sampler =
+            &m_backward_light_sampler_cache.get(
                 m_scene,
-                get_child_and_inherit_globals(m_params, "light_sampler")));
+                get_child_and_inherit_globals(m_params, "light_sampler"));
+
+        const ParamArray pt_params = get_child_and_inherit_globals(m_params, "pt");    // todo: change to "pt_lighting_engine"?
+
+        CausticPhotonMap* caustic_photon_map = nullptr;
+        if (pt_params.get_optional<bool>("enable_caustic_photon_map", false))
+        {
+            m_forward_light_sampler.reset(
+                new ForwardLightSampler(
+                    m_scene,
+                    get_child_and_inherit_globals(m_params, "light_sampler")));
+
+            caustic_photon_map =
+                new CausticPhotonMap(
+                    m_scene,
+                    *m_forward_light_sampler,
+                    m_trace_context,
+                    m_texture_store,
+                    m_texture_system,
+                    m_shading_system,
+                    pt_params);
+        }
+
+        PTPassCallback* pt_pass_callback = nullptr;
+        if (pt_params.get_optional<bool>("enable_path_guiding", false) ||
+            pt_params.get_optional<bool>("enable_radiance_cache", false) ||
+            pt_params.get_optional<bool>("enable_sss_irradiance_cloud", false) ||
+            caustic_photon_map != nullptr)
+        {
+            pt_pass_callback = new PTPassCallback(m_scene, pt_params, caustic_photon_map);
+            m_pass_callback.reset(pt_pass_callback);
+        }
 
         m_lighting_engine_factory.reset(
             new PTLightingEngineFactory(
                 *m_backward_light_sampler,
                 m_project.get_light_path_recorder(),
-                get_child_and_inherit_globals(m_params, "pt")));    // todo: change to "pt_lighting_engine"?
+                pt_pass_callback,
+                pt_params));
 
         return true;
     }
@@ -218,10 +260,10 @@ bool RendererComponents::create_lighting_engine_factory()
                 m_scene,
                 get_child_and_inherit_globals(m_params, "light_sampler")));
 
-        m_backward_light_sampler.reset(
-            new BackwardLightSampler(
+        m_backward_light_sampler =
+            &m_backward_light_sampler_cache.get(
                 m_scene,
-                get_child_and_inherit_globals(m_params, "light_sampler")));
+                get_child_and_inherit_globals(m_params, "light_sampler"));
 
         const SPPMParameters sppm_params(
             get_child_and_inherit_globals(m_params, "sppm"));
@@ -266,6 +308,14 @@ bool RendererComponents::create_sample_renderer_factory()
     }
     else if (name == "generic")
     {
+        const ParamArray params = get_child_and_inherit_globals(m_params, "generic_sample_renderer");
+
+        // Drop the cached primary hits if the geometry of the scene changed.
+        m_primary_hit_cache.prepare(
+            m_scene,
+            m_frame,
+            params.get_optional<size_t>("primary_hit_cache_size", 0));
+
         m_sample_renderer_factory.reset(
             new GenericSampleRendererFactory(
                 m_scene,
@@ -276,7 +326,8 @@ bool RendererComponents::create_sample_renderer_factory()
                 m_shading_engine,
                 m_texture_system,
                 m_shading_system,
-                get_child_and_inherit_globals(m_params, "generic_sample_renderer")));
+                m_primary_hit_cache.is_enabled() ? &m_primary_hit_cache : nullptr,
+                params));
         return true;
     }
     else if (name == "blank")
@@ -423,19 +474,43 @@ bool RendererComponents::create_shading_result_framebuffer_factory()
     const string name = m_params.get_optional<string>("shading_result_framebuffer", "ephemeral");
 
     if (name.empty())
-    {
         return true;
+
+    const string layout_name =
+        m_params.get_optional<string>("shading_result_framebuffer_layout", "interleaved");
+
+    ShadingResultFrameBuffer::Layout layout;
+    if (layout_name == "interleaved")
+        layout = ShadingResultFrameBuffer::InterleavedLayout;
+    else if (layout_name == "planar")
+        layout = ShadingResultFrameBuffer::PlanarLayout;
+    else
+    {
+        RENDERER_LOG_ERROR(
+            "invalid value for \"shading_result_framebuffer_layout\" parameter: \"%s\".",
+            layout_name.c_str());
+        return false;
+    }
+
+    // Checkpoints store the framebuffers as they are laid out in memory, in the interleaved layout.
+    if (layout == ShadingResultFrameBuffer::PlanarLayout &&
+        (m_frame.get_parameters().get_optional<bool>("checkpoint_create", false) ||
+         m_frame.get_parameters().get_optional<bool>("checkpoint_resume", false)))
+    {
+        RENDERER_LOG_WARNING("checkpoints require interleaved shading result framebuffers, ignoring planar layout.");
+        layout = ShadingResultFrameBuffer::InterleavedLayout;
     }
-    else if (name == "ephemeral")
+
+    if (name == "ephemeral")
     {
         m_shading_result_framebuffer_factory.reset(
-            new EphemeralShadingResultFrameBufferFactory());
+            new EphemeralShadingResultFrameBufferFactory(layout));
         return true;
     }
     else if (name == "permanent")
     {
         m_shading_result_framebuffer_factory.reset(
-            new PermanentShadingResultFrameBufferFactory(m_frame));
+            new PermanentShadingResultFrameBufferFactory(m_frame, layout));
         return true;
     }
     else
@@ -567,6 +642,13 @@ bool RendererComponents::create_frame_renderer_factory()
             return false;
         }
 
+        PTPassCallback* pt_pass_callback = dynamic_cast<PTPassCallback*>(m_pass_callback.get());
+        if (pt_pass_callback != nullptr)
+        {
+            RENDERER_LOG_WARNING("path guiding, the radiance cache, the sss irradiance cloud and the caustic photon map are only built by the generic frame renderer and will have no effect.");
+            pt_pass_callback->disable_training();
+        }
+
         m_frame_renderer.reset(
             ProgressiveFrameRendererFactory::create(
                 m_project,
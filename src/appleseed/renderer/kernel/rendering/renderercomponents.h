@@ -49,6 +49,7 @@
 
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class BackwardLightSamplerCache; }
 namespace renderer      { class Frame; }
 namespace renderer      { class IFrameRenderer; }
 namespace renderer      { class ITileCallbackFactory; }
@@ -57,6 +58,7 @@ namespace renderer      { class OnFrameBeginRecorder; }
 namespace renderer      { class OnRenderBeginRecorder; }
 namespace renderer      { class OSLShadingSystem; }
 namespace renderer      { class ParamArray; }
+namespace renderer      { class PrimaryHitCache; }
 namespace renderer      { class Project; }
 namespace renderer      { class Scene; }
 namespace renderer      { class TextureStore; }
@@ -80,7 +82,9 @@ class RendererComponents
         ITileCallbackFactory*       tile_callback_factory,
         TextureStore&               texture_store,
         OIIOTextureSystem&          texture_system,
-        OSLShadingSystem&           shading_system);
+        OSLShadingSystem&           shading_system,
+        BackwardLightSamplerCache&  backward_light_sampler_cache,
+        PrimaryHitCache&            primary_hit_cache);
 
     // Create all components as specified by the parameters passed at construction.
     bool create();
@@ -111,7 +115,9 @@ class RendererComponents
     const Frame&                                        m_frame;
     const TraceContext&                                 m_trace_context;
     std::unique_ptr<ForwardLightSampler>                m_forward_light_sampler;
-    std::unique_ptr<BackwardLightSampler>               m_backward_light_sampler;
+    BackwardLightSamplerCache&                          m_backward_light_sampler_cache;
+    BackwardLightSampler*                               m_backward_light_sampler;
+    PrimaryHitCache&                                    m_primary_hit_cache;
     ShadingEngine                                       m_shading_engine;
     TextureStore&                                       m_texture_store;
     OIIOTextureSystem&                                  m_texture_system;
@@ -34,6 +34,7 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/intersection/intersector.h"
 #include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/texturing/oiiotexturesystem.h"
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/modeling/camera/camera.h"
 #include "renderer/modeling/frame/frame.h"
@@ -433,6 +434,98 @@ bool RendererServices::transform_points(
     return false;
 }
 
+void RendererServices::resolve_texture_handle(
+    OSL::ShaderGlobals*         sg,
+    OIIO::ustring               filename,
+    TextureHandle*&             texture_handle,
+    TexturePerthread*&          texture_thread_info)
+{
+    // Shader globals set up by OSLShaderGroupExec point to the texture cache of the thread.
+    if (sg == nullptr || sg->objdata == nullptr)
+        return;
+
+    OIIOTextureThreadCache& texture_thread_cache =
+        *reinterpret_cast<OIIOTextureThreadCache*>(sg->objdata);
+
+    if (texture_thread_info == nullptr)
+        texture_thread_info = texture_thread_cache.get_thread_info();
+
+    // OSL already resolves the handles of constant filenames.
+    if (texture_handle == nullptr)
+        texture_handle = texture_thread_cache.get_texture_handle(filename);
+}
+
+bool RendererServices::texture(
+    OIIO::ustring               filename,
+    TextureHandle*              texture_handle,
+    TexturePerthread*           texture_thread_info,
+    OIIO::TextureOpt&           options,
+    OSL::ShaderGlobals*         sg,
+    float                       s,
+    float                       t,
+    float                       dsdx,
+    float                       dtdx,
+    float                       dsdy,
+    float                       dtdy,
+    int                         nchannels,
+    float*                      result,
+    float*                      dresultds,
+    float*                      dresultdt,
+    OIIO::ustring*              errormessage)
+{
+    resolve_texture_handle(sg, filename, texture_handle, texture_thread_info);
+
+    return
+        OSL::RendererServices::texture(
+            filename,
+            texture_handle,
+            texture_thread_info,
+            options,
+            sg,
+            s, t,
+            dsdx, dtdx,
+            dsdy, dtdy,
+            nchannels,
+            result,
+            dresultds,
+            dresultdt,
+            errormessage);
+}
+
+bool RendererServices::environment(
+    OIIO::ustring               filename,
+    TextureHandle*              texture_handle,
+    TexturePerthread*           texture_thread_info,
+    OIIO::TextureOpt&           options,
+    OSL::ShaderGlobals*         sg,
+    const OSL::Vec3&            R,
+    const OSL::Vec3&            dRdx,
+    const OSL::Vec3&            dRdy,
+    int                         nchannels,
+    float*                      result,
+    float*                      dresultds,
+    float*                      dresultdt,
+    OIIO::ustring*              errormessage)
+{
+    resolve_texture_handle(sg, filename, texture_handle, texture_thread_info);
+
+    return
+        OSL::RendererServices::environment(
+            filename,
+            texture_handle,
+            texture_thread_info,
+            options,
+            sg,
+            R,
+            dRdx,
+            dRdy,
+            nchannels,
+            result,
+            dresultds,
+            dresultdt,
+            errormessage);
+}
+
 bool RendererServices::trace(
     TraceOpt&                   options,
     OSL::ShaderGlobals*         sg,
@@ -501,7 +594,7 @@ bool RendererServices::trace(
         trace_data->m_hit = true;
         trace_data->m_P = Imath::V3d(shading_point.get_point());
         trace_data->m_hit_distance = static_cast<float>(shading_point.get_distance());
-        trace_data->m_N = Imath::V3d(shading_point.get_shading_normal());
+        trace_data->m_N = Imath::V3d(Vector3d(shading_point.get_shading_normal()));
         trace_data->m_Ng = Imath::V3d(shading_point.get_geometric_normal());
         const Vector2f& uv = shading_point.get_uv(0);
         trace_data->m_u = uv[0];
@@ -1119,7 +1212,7 @@ IMPLEMENT_USER_DATA_GETTER(tn)
         const ShadingPoint* shading_point =
             reinterpret_cast<const ShadingPoint*>(sg->renderstate);
 
-        const Vector3d& tn = shading_point->get_shading_basis().get_tangent_u();
+        const SVector3& tn = shading_point->get_shading_basis().get_tangent_u();
         OSL::Vec3 v(
             static_cast<float>(tn.x),
             static_cast<float>(tn.y),
@@ -1145,7 +1238,7 @@ IMPLEMENT_USER_DATA_GETTER(bn)
         const ShadingPoint* shading_point =
             reinterpret_cast<const ShadingPoint*>(sg->renderstate);
 
-        const Vector3d& bn = shading_point->get_shading_basis().get_tangent_v();
+        const SVector3& bn = shading_point->get_shading_basis().get_tangent_v();
         OSL::Vec3 v(
             static_cast<float>(bn.x),
             static_cast<float>(bn.y),
@@ -193,6 +193,43 @@ class RendererServices
         int                         npoints,
         OSL::TypeDesc::VECSEMANTICS vectype) override;
 
+    // Filtered 2D texture lookup for a single point. Lookups by filename reuse
+    // the texture handles resolved by the rendering thread.
+    bool texture(
+        OIIO::ustring               filename,
+        TextureHandle*              texture_handle,
+        TexturePerthread*           texture_thread_info,
+        OIIO::TextureOpt&           options,
+        OSL::ShaderGlobals*         sg,
+        float                       s,
+        float                       t,
+        float                       dsdx,
+        float                       dtdx,
+        float                       dsdy,
+        float                       dtdy,
+        int                         nchannels,
+        float*                      result,
+        float*                      dresultds,
+        float*                      dresultdt,
+        OIIO::ustring*              errormessage) override;
+
+    // Filtered environment lookup for a single point. Lookups by filename reuse
+    // the texture handles resolved by the rendering thread.
+    bool environment(
+        OIIO::ustring               filename,
+        TextureHandle*              texture_handle,
+        TexturePerthread*           texture_thread_info,
+        OIIO::TextureOpt&           options,
+        OSL::ShaderGlobals*         sg,
+        const OSL::Vec3&            R,
+        const OSL::Vec3&            dRdx,
+        const OSL::Vec3&            dRdy,
+        int                         nchannels,
+        float*                      result,
+        float*                      dresultds,
+        float*                      dresultdt,
+        OIIO::ustring*              errormessage) override;
+
     // Immediately trace a ray from P in the direction R.  Return true
     // if anything hit, otherwise false.
     bool trace(
@@ -258,6 +295,13 @@ class RendererServices
         void*                       val) override;
 
   private:
+    // Substitute the texture handle and per-thread info cached by the rendering thread.
+    static void resolve_texture_handle(
+        OSL::ShaderGlobals*         sg,
+        OIIO::ustring               filename,
+        TextureHandle*&             texture_handle,
+        TexturePerthread*&          texture_thread_info);
+
     // This code is based on OSL's test renderer.
     typedef bool (RendererServices::*AttrGetterFun)(
         OSL::ShaderGlobals*         sg,
@@ -0,0 +1,81 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+
+namespace renderer
+{
+
+//
+// Counters of the work done by a rendering thread.
+//
+// Each thread updates its own set of counters, without synchronization. The counters
+// are never reset: consumers sample them before and after an operation (for instance
+// the rendering of a pixel) and use the difference.
+//
+
+struct RenderingCounters
+{
+    foundation::uint64  m_ray_count;                    // rays traced, including probe rays
+    foundation::uint64  m_traversal_step_count;         // acceleration structure leaves visited
+    foundation::uint64  m_texture_cache_miss_count;     // texture tiles missing from the thread-local cache
+    foundation::uint64  m_texture_load_count;           // texture tiles loaded into the texture store
+
+    // Return the counters of the calling thread.
+    static RenderingCounters& current();
+};
+
+RenderingCounters operator-(const RenderingCounters& lhs, const RenderingCounters& rhs);
+
+
+//
+// RenderingCounters class implementation.
+//
+
+extern APPLESEED_TLS RenderingCounters t_rendering_counters;
+
+inline RenderingCounters& RenderingCounters::current()
+{
+    return t_rendering_counters;
+}
+
+inline RenderingCounters operator-(const RenderingCounters& lhs, const RenderingCounters& rhs)
+{
+    RenderingCounters result;
+    result.m_ray_count = lhs.m_ray_count - rhs.m_ray_count;
+    result.m_traversal_step_count = lhs.m_traversal_step_count - rhs.m_traversal_step_count;
+    result.m_texture_cache_miss_count = lhs.m_texture_cache_miss_count - rhs.m_texture_cache_miss_count;
+    result.m_texture_load_count = lhs.m_texture_load_count - rhs.m_texture_load_count;
+    return result;
+}
+
+}   // namespace renderer
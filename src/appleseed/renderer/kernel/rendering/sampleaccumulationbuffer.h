@@ -40,6 +40,7 @@
 // Forward declarations.
 namespace foundation    { class IAbortSwitch; }
 namespace renderer      { class Frame; }
+namespace renderer      { class PreviewDenoiser; }
 namespace renderer      { class Sample; }
 
 namespace renderer
@@ -49,6 +50,9 @@ class SampleAccumulationBuffer
   : public foundation::NonCopyable
 {
   public:
+    // Constructor.
+    SampleAccumulationBuffer();
+
     // Destructor.
     virtual ~SampleAccumulationBuffer() {}
 
@@ -58,8 +62,11 @@ class SampleAccumulationBuffer
     // Reset the buffer to its initial state. Thread-safe.
     virtual void clear() = 0;
 
-    // Store a set of samples into the buffer. Thread-safe.
+    // Store a set of samples into the buffer. Thread-safe. generator_index is the index
+    // of the sample generator that produced the samples; buffers may use it to reduce
+    // contention between sample generators.
     virtual void store_samples(
+        const size_t                generator_index,
         const size_t                sample_count,
         const Sample                samples[],
         foundation::IAbortSwitch&   abort_switch) = 0;
@@ -69,8 +76,18 @@ class SampleAccumulationBuffer
         Frame&                      frame,
         foundation::IAbortSwitch&   abort_switch) = 0;
 
+    // Set the preview denoiser to which sample generators also send their samples, or nullptr.
+    // Must not be called while samples are being stored.
+    void set_preview_denoiser(PreviewDenoiser* preview_denoiser);
+
+    // Return the preview denoiser, or nullptr if there is none.
+    PreviewDenoiser* get_preview_denoiser() const;
+
   protected:
     boost::atomic<foundation::uint64> m_sample_count;
+
+  private:
+    PreviewDenoiser*                  m_preview_denoiser;
 };
 
 
@@ -78,9 +95,24 @@ class SampleAccumulationBuffer
 // SampleAccumulationBuffer class implementation.
 //
 
+inline SampleAccumulationBuffer::SampleAccumulationBuffer()
+  : m_preview_denoiser(nullptr)
+{
+}
+
 inline foundation::uint64 SampleAccumulationBuffer::get_sample_count() const
 {
     return m_sample_count;
 }
 
+inline void SampleAccumulationBuffer::set_preview_denoiser(PreviewDenoiser* preview_denoiser)
+{
+    m_preview_denoiser = preview_denoiser;
+}
+
+inline PreviewDenoiser* SampleAccumulationBuffer::get_preview_denoiser() const
+{
+    return m_preview_denoiser;
+}
+
 }   // namespace renderer
@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/denoising/previewdenoiser.h"
 #include "renderer/kernel/rendering/sampleaccumulationbuffer.h"
 
 // appleseed.foundation headers.
@@ -58,6 +59,7 @@ SampleGeneratorBase::SampleGeneratorBase(
     const size_t                generator_index,
     const size_t                generator_count)
   : m_generator_index(generator_index)
+  , m_generator_count(generator_count)
   , m_stride((generator_count - 1) * SampleBatchSize)
 {
     reset();
@@ -91,14 +93,44 @@ void SampleGeneratorBase::generate_samples(
         {
             m_current_batch_size = 0;
             m_sequence_index += m_stride;
-
-            if (abort_switch.is_aborted())
-                break;
         }
+
+        // Check for abortion after every sample rather than every batch since a batch
+        // of samples can take a long time to render in heavy scenes. The next call
+        // resumes the current batch.
+        if (abort_switch.is_aborted())
+            break;
     }
 
-    if (stored > 0)
-        buffer.store_samples(stored, &m_samples[0], abort_switch);
+    store_samples(buffer, abort_switch);
+}
+
+void SampleGeneratorBase::generate_bootstrap_samples(
+    const size_t                block_size,
+    SampleAccumulationBuffer&   buffer,
+    IAbortSwitch&               abort_switch)
+{
+    assert(block_size > 0);
+
+    clear_keep_memory(m_samples);
+
+    for (size_t block_index = m_generator_index;
+         generate_bootstrap_samples(block_size, block_index, m_samples);
+         block_index += m_generator_count)
+    {
+        if (abort_switch.is_aborted())
+            break;
+    }
+
+    store_samples(buffer, abort_switch);
+}
+
+bool SampleGeneratorBase::generate_bootstrap_samples(
+    const size_t                block_size,
+    const size_t                block_index,
+    SampleVector&               samples)
+{
+    return false;
 }
 
 void SampleGeneratorBase::signal_invalid_sample()
@@ -115,4 +147,20 @@ void SampleGeneratorBase::signal_invalid_sample()
         RENDERER_LOG_WARNING("more invalid samples found, omitting warning messages for brevity.");
 }
 
+void SampleGeneratorBase::store_samples(
+    SampleAccumulationBuffer&   buffer,
+    IAbortSwitch&               abort_switch)
+{
+    if (m_samples.empty())
+        return;
+
+    const size_t stored = m_samples.size();
+    buffer.store_samples(m_generator_index, stored, &m_samples[0], abort_switch);
+
+    // Feed the statistics of the preview denoiser, if any.
+    PreviewDenoiser* preview_denoiser = buffer.get_preview_denoiser();
+    if (preview_denoiser)
+        preview_denoiser->store_samples(stored, &m_samples[0]);
+}
+
 }   // namespace renderer
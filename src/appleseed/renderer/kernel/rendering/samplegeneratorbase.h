@@ -68,6 +68,12 @@ class SampleGeneratorBase
         SampleAccumulationBuffer&   buffer,
         foundation::IAbortSwitch&   abort_switch) override;
 
+    // Generate one sample per block of pixels and accumulate them into a buffer.
+    void generate_bootstrap_samples(
+        const size_t                block_size,
+        SampleAccumulationBuffer&   buffer,
+        foundation::IAbortSwitch&   abort_switch) override;
+
   protected:
     typedef std::vector<Sample> SampleVector;
 
@@ -77,15 +83,28 @@ class SampleGeneratorBase
         const size_t                sequence_index,
         SampleVector&               samples) = 0;
 
+    // Generate one or multiple samples for a given block of block_size x block_size pixels
+    // and store them in 'samples'. Return false if there is no block with this index.
+    // The default implementation doesn't support bootstrap samples and always returns false.
+    virtual bool generate_bootstrap_samples(
+        const size_t                block_size,
+        const size_t                block_index,
+        SampleVector&               samples);
+
     void signal_invalid_sample();
 
   private:
     const size_t                    m_generator_index;
+    const size_t                    m_generator_count;
     const size_t                    m_stride;
     size_t                          m_sequence_index;
     size_t                          m_current_batch_size;
     SampleVector                    m_samples;
     foundation::uint64              m_invalid_sample_count;
+
+    void store_samples(
+        SampleAccumulationBuffer&   buffer,
+        foundation::IAbortSwitch&   abort_switch);
 };
 
 }   // namespace renderer
@@ -37,6 +37,8 @@
 #include "renderer/kernel/shading/shadingray.h"
 #include "renderer/kernel/texturing/texturecache.h"
 #include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/aov/aov.h"
+#include "renderer/modeling/aov/idaov.h"
 #include "renderer/modeling/bsdf/bsdftraits.h"
 #include "renderer/modeling/bssrdf/bssrdftraits.h"
 #include "renderer/modeling/camera/camera.h"
@@ -46,15 +48,22 @@
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/material/materialtraits.h"
 #include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/surfaceshader/surfaceshadertraits.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
 #include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/utility/uid.h"
 
 // Standard headers.
 #include <cstddef>
+#include <cstring>
 #include <limits>
 
 using namespace foundation;
@@ -63,6 +72,115 @@ using namespace std;
 namespace renderer
 {
 
+namespace
+{
+    void clear_result(
+        const Vector2d&                 ndc,
+        const Project&                  project,
+        ScenePicker::PickingResult&     result)
+    {
+        result.m_ndc = ndc;
+
+        result.m_hit = false;
+        result.m_primitive_type = ShadingPoint::PrimitiveNone;
+        result.m_distance = numeric_limits<double>::max();
+
+        result.m_bary = Vector2f(0.0);
+        result.m_uv = Vector2f(0.0);
+        result.m_duvdx = Vector2f(0.0);
+        result.m_duvdy = Vector2f(0.0);
+        result.m_point = Vector3d(0.0);
+        result.m_dpdu = Vector3d(0.0);
+        result.m_dpdv = Vector3d(0.0);
+        result.m_dndu = Vector3d(0.0);
+        result.m_dndv = Vector3d(0.0);
+        result.m_dpdx = Vector3d(0.0);
+        result.m_dpdy = Vector3d(0.0);
+        result.m_geometric_normal = Vector3d(0.0);
+        result.m_original_shading_normal = Vector3d(0.0);
+        result.m_side = ObjectInstance::FrontSide;
+
+        result.m_camera = project.get_uncached_active_camera();
+        result.m_assembly_instance = nullptr;
+        result.m_assembly = nullptr;
+        result.m_object_instance = nullptr;
+        result.m_object = nullptr;
+        result.m_material = nullptr;
+        result.m_surface_shader = nullptr;
+        result.m_bsdf = nullptr;
+        result.m_bssrdf = nullptr;
+        result.m_edf = nullptr;
+    }
+
+    void find_material_entities(ScenePicker::PickingResult& result)
+    {
+        if (result.m_material)
+        {
+            const Entity* parent = result.m_material->get_parent();
+
+            const char* ss_name = result.m_material->get_surface_shader_name();
+            result.m_surface_shader = ss_name ? InputBinder::static_find_entity<SurfaceShader>(ss_name, parent) : nullptr;
+
+            const char* bsdf_name = result.m_material->get_bsdf_name();
+            result.m_bsdf = bsdf_name ? InputBinder::static_find_entity<BSDF>(bsdf_name, parent) : nullptr;
+
+            const char* bssrdf_name = result.m_material->get_bssrdf_name();
+            result.m_bssrdf = bssrdf_name ? InputBinder::static_find_entity<BSSRDF>(bssrdf_name, parent) : nullptr;
+
+            const char* edf = result.m_material->get_edf_name();
+            result.m_edf = edf ? InputBinder::static_find_entity<EDF>(edf, parent) : nullptr;
+        }
+    }
+
+    const Image* find_id_aov_image(const Project& project)
+    {
+        const Frame* frame = project.get_frame();
+
+        if (frame == nullptr)
+            return nullptr;
+
+        for (const AOV& aov : frame->aovs())
+        {
+            // ID AOV images must be stored in floating-point to hold exact values.
+            if (strcmp(aov.get_model(), "id_aov") == 0 &&
+                aov.get_image().properties().m_pixel_format == PixelFormatFloat)
+                return &aov.get_image();
+        }
+
+        return nullptr;
+    }
+
+    template <typename EntityType>
+    EntityType* find_entity_by_uid(
+        const AssemblyContainer&        assemblies,
+        const UniqueID                  uid,
+        EntityType* (*find_in_assembly)(const Assembly&, const UniqueID))
+    {
+        for (const Assembly& assembly : assemblies)
+        {
+            EntityType* entity = find_in_assembly(assembly, uid);
+
+            if (entity == nullptr)
+                entity = find_entity_by_uid(assembly.assemblies(), uid, find_in_assembly);
+
+            if (entity)
+                return entity;
+        }
+
+        return nullptr;
+    }
+
+    ObjectInstance* find_object_instance_in_assembly(const Assembly& assembly, const UniqueID uid)
+    {
+        return assembly.object_instances().get_by_uid(uid);
+    }
+
+    Material* find_material_in_assembly(const Assembly& assembly, const UniqueID uid)
+    {
+        return assembly.materials().get_by_uid(uid);
+    }
+}
+
 struct ScenePicker::Impl
 {
     const Project&      m_project;
@@ -70,6 +188,7 @@ struct ScenePicker::Impl
     TextureStore        m_texture_store;
     TextureCache        m_texture_cache;
     Intersector         m_intersector;
+    const Image*        m_id_image;
 
     explicit Impl(const Project& project)
       : m_project(project)
@@ -77,6 +196,7 @@ struct ScenePicker::Impl
       , m_texture_store(m_trace_context.get_scene())
       , m_texture_cache(m_texture_store)
       , m_intersector(m_trace_context, m_texture_cache)
+      , m_id_image(find_id_aov_image(project))
     {
     }
 };
@@ -94,38 +214,7 @@ ScenePicker::~ScenePicker()
 ScenePicker::PickingResult ScenePicker::pick(const Vector2d& ndc) const
 {
     PickingResult result;
-
-    result.m_ndc = ndc;
-
-    result.m_hit = false;
-    result.m_primitive_type = ShadingPoint::PrimitiveNone;
-    result.m_distance = numeric_limits<double>::max();
-
-    result.m_bary = Vector2f(0.0);
-    result.m_uv = Vector2f(0.0);
-    result.m_duvdx = Vector2f(0.0);
-    result.m_duvdy = Vector2f(0.0);
-    result.m_point = Vector3d(0.0);
-    result.m_dpdu = Vector3d(0.0);
-    result.m_dpdv = Vector3d(0.0);
-    result.m_dndu = Vector3d(0.0);
-    result.m_dndv = Vector3d(0.0);
-    result.m_dpdx = Vector3d(0.0);
-    result.m_dpdy = Vector3d(0.0);
-    result.m_geometric_normal = Vector3d(0.0);
-    result.m_original_shading_normal = Vector3d(0.0);
-    result.m_side = ObjectInstance::FrontSide;
-
-    result.m_camera = impl->m_project.get_uncached_active_camera();
-    result.m_assembly_instance = nullptr;
-    result.m_assembly = nullptr;
-    result.m_object_instance = nullptr;
-    result.m_object = nullptr;
-    result.m_material = nullptr;
-    result.m_surface_shader = nullptr;
-    result.m_bsdf = nullptr;
-    result.m_bssrdf = nullptr;
-    result.m_edf = nullptr;
+    clear_result(ndc, impl->m_project, result);
 
     if (result.m_camera == nullptr)
         return result;
@@ -191,21 +280,55 @@ ScenePicker::PickingResult ScenePicker::pick(const Vector2d& ndc) const
         }
     }
 
-    if (result.m_material)
-    {
-        const Entity* parent = result.m_material->get_parent();
+    find_material_entities(result);
+
+    return result;
+}
+
+ScenePicker::PickingResult ScenePicker::pick_entities(const Vector2d& ndc) const
+{
+    if (impl->m_id_image == nullptr || ndc.x < 0.0 || ndc.x >= 1.0 || ndc.y < 0.0 || ndc.y >= 1.0)
+        return pick(ndc);
 
-        const char* ss_name = result.m_material->get_surface_shader_name();
-        result.m_surface_shader = ss_name ? InputBinder::static_find_entity<SurfaceShader>(ss_name, parent) : nullptr;
+    const CanvasProperties& props = impl->m_id_image->properties();
+    const size_t x = static_cast<size_t>(ndc.x * props.m_canvas_width);
+    const size_t y = static_cast<size_t>(ndc.y * props.m_canvas_height);
 
-        const char* bsdf_name = result.m_material->get_bsdf_name();
-        result.m_bsdf = bsdf_name ? InputBinder::static_find_entity<BSDF>(bsdf_name, parent) : nullptr;
+    Color<float, 2> ids;
+    impl->m_id_image->get_pixel(x, y, ids);
 
-        const char* bssrdf_name = result.m_material->get_bssrdf_name();
-        result.m_bssrdf = bssrdf_name ? InputBinder::static_find_entity<BSSRDF>(bssrdf_name, parent) : nullptr;
+    PickingResult result;
+    clear_result(ndc, impl->m_project, result);
+
+    if (result.m_camera == nullptr || ids[0] == IDAOVNoneValue)
+        return result;
 
-        const char* edf = result.m_material->get_edf_name();
-        result.m_edf = edf ? InputBinder::static_find_entity<EDF>(edf, parent) : nullptr;
+    if (ids[0] < IDAOVFirstValue || ids[1] == IDAOVUnknownValue)
+        return pick(ndc);
+
+    const AssemblyContainer& assemblies = impl->m_trace_context.get_scene().assemblies();
+
+    result.m_object_instance =
+        find_entity_by_uid(
+            assemblies,
+            id_aov_value_to_uid(ids[0]),
+            &find_object_instance_in_assembly);
+
+    if (result.m_object_instance == nullptr)
+        return pick(ndc);
+
+    result.m_hit = true;
+    result.m_assembly = static_cast<const Assembly*>(result.m_object_instance->get_parent());
+    result.m_object = result.m_object_instance->find_object();
+
+    if (ids[1] >= IDAOVFirstValue)
+    {
+        result.m_material =
+            find_entity_by_uid(
+                assemblies,
+                id_aov_value_to_uid(ids[1]),
+                &find_material_in_assembly);
+        find_material_entities(result);
     }
 
     return result;
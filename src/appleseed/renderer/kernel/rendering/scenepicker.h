@@ -102,8 +102,15 @@ class APPLESEED_DLLSYMBOL ScenePicker
 
     ~ScenePicker();
 
+    // Trace a ray through a given point of the frame and return everything known about the hit.
     PickingResult pick(const foundation::Vector2d& ndc) const;
 
+    // Only identify the object instance and material seen through a given point of the frame.
+    // If the frame has an ID AOV (stored in floating-point) holding the corresponding pixel,
+    // they are looked up from the AOV image without tracing any ray; in that case geometric
+    // fields and the assembly instance are left unset. Otherwise this is equivalent to pick().
+    PickingResult pick_entities(const foundation::Vector2d& ndc) const;
+
   private:
     struct Impl;
     Impl* impl;
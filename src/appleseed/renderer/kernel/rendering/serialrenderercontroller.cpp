@@ -99,6 +99,11 @@ void SerialRendererController::on_progress()
     m_controller->on_progress();
 }
 
+void SerialRendererController::on_remaining_time(const double seconds)
+{
+    m_controller->on_remaining_time(seconds);
+}
+
 IRendererController::Status SerialRendererController::get_status() const
 {
     return m_controller->get_status();
@@ -69,6 +69,7 @@ class SerialRendererController
     void on_frame_begin() override;
     void on_frame_end() override;
     void on_progress() override;
+    void on_remaining_time(const double seconds) override;
     Status get_status() const override;
 
     void add_on_tiled_frame_begin_callback(
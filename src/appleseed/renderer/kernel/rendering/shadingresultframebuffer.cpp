@@ -36,11 +36,17 @@
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
+#include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/platform/compiler.h"
+#ifdef APPLESEED_USE_SSE
+#include "foundation/platform/sse.h"
+#endif
+#include "foundation/utility/memory.h"
 
 // Standard headers.
 #include <cassert>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -51,12 +57,15 @@ namespace renderer
 ShadingResultFrameBuffer::ShadingResultFrameBuffer(
     const size_t                    width,
     const size_t                    height,
-    const size_t                    aov_count)
+    const size_t                    aov_count,
+    const Layout                    layout)
   : AccumulatorTile(
         width,
         height,
-        get_total_channel_count(aov_count))
+        get_total_channel_count(aov_count),
+        allocate_storage(width, height, aov_count, layout))
   , m_aov_count(aov_count)
+  , m_layout(layout)
   , m_scratch(get_total_channel_count(aov_count))
 {
 }
@@ -65,21 +74,97 @@ ShadingResultFrameBuffer::ShadingResultFrameBuffer(
     const size_t                    width,
     const size_t                    height,
     const size_t                    aov_count,
-    const AABB2u&                   crop_window)
+    const AABB2u&                   crop_window,
+    const Layout                    layout)
   : AccumulatorTile(
         width,
         height,
         get_total_channel_count(aov_count),
-        crop_window)
+        crop_window,
+        allocate_storage(width, height, aov_count, layout))
   , m_aov_count(aov_count)
+  , m_layout(layout)
   , m_scratch(get_total_channel_count(aov_count))
 {
 }
 
+ShadingResultFrameBuffer::~ShadingResultFrameBuffer()
+{
+    if (m_layout == PlanarLayout)
+        aligned_free(get_storage());
+}
+
+uint8* ShadingResultFrameBuffer::allocate_storage(
+    const size_t                    width,
+    const size_t                    height,
+    const size_t                    aov_count,
+    const Layout                    layout)
+{
+    // The interleaved layout uses the storage allocated by the Tile class.
+    if (layout == InterleavedLayout)
+        return nullptr;
+
+    // The RGBA planes come first so that they all start on 16-byte boundaries.
+    const size_t size = width * height * (get_total_channel_count(aov_count) + 1) * sizeof(float);
+    return static_cast<uint8*>(aligned_malloc(size, 16));
+}
+
+void ShadingResultFrameBuffer::get_main_color(
+    const size_t                    x,
+    const size_t                    y,
+    Color4f&                        color) const
+{
+    assert(x < m_width);
+    assert(y < m_height);
+
+    float weight;
+    const float* ptr;
+
+    if (m_layout == PlanarLayout)
+    {
+        const size_t i = y * m_width + x;
+        weight = weights()[i];
+        ptr = layer(0) + 4 * i;
+    }
+    else
+    {
+        ptr = pixel(x, y);
+        weight = *ptr++;
+    }
+
+    const float rcp_weight = weight == 0.0f ? 0.0f : 1.0f / weight;
+    color = Color4f(ptr[0], ptr[1], ptr[2], ptr[3]) * rcp_weight;
+}
+
 void ShadingResultFrameBuffer::add(
     const Vector2u&                 pi,
     const ShadingResult&            sample)
 {
+    if (m_layout == PlanarLayout)
+    {
+        // Ignore samples outside the crop window.
+        if (!m_crop_window.contains(pi))
+            return;
+
+        const size_t i = pi.y * m_width + pi.x;
+        weights()[i] += 1.0f;
+
+        for (size_t l = 0, e = m_aov_count + 1; l < e; ++l)
+        {
+            const Color4f& value = l == 0 ? sample.m_main : sample.m_aovs[l - 1];
+            float* APPLESEED_RESTRICT ptr = layer(l) + 4 * i;
+
+#ifdef APPLESEED_USE_SSE
+            _mm_store_ps(ptr, _mm_add_ps(_mm_load_ps(ptr), _mm_loadu_ps(&value[0])));
+#else
+            for (size_t c = 0; c < 4; ++c)
+                ptr[c] += value[c];
+#endif
+        }
+
+        return;
+    }
+
     float* ptr = &m_scratch[0];
 
     *ptr++ = sample.m_main[0];
@@ -108,6 +193,34 @@ void ShadingResultFrameBuffer::merge(
     const float                     scaling)
 {
     assert(m_channel_count == source.m_channel_count);
+    assert(m_layout == source.m_layout);
+
+    if (m_layout == PlanarLayout)
+    {
+        const size_t dest_index = dest_y * m_width + dest_x;
+        const size_t source_index = source_y * source.m_width + source_x;
+
+        weights()[dest_index] += source.weights()[source_index] * scaling;
+
+#ifdef APPLESEED_USE_SSE
+        const __m128 s = _mm_set1_ps(scaling);
+#endif
+
+        for (size_t l = 0, e = m_aov_count + 1; l < e; ++l)
+        {
+            const float* APPLESEED_RESTRICT source_ptr = source.layer(l) + 4 * source_index;
+            float* APPLESEED_RESTRICT dest_ptr = layer(l) + 4 * dest_index;
+
+#ifdef APPLESEED_USE_SSE
+            _mm_store_ps(dest_ptr, _mm_add_ps(_mm_load_ps(dest_ptr), _mm_mul_ps(_mm_load_ps(source_ptr), s)));
+#else
+            for (size_t c = 0; c < 4; ++c)
+                dest_ptr[c] += source_ptr[c] * scaling;
+#endif
+        }
+
+        return;
+    }
 
     const float* APPLESEED_RESTRICT source_ptr = source.pixel(source_x, source_y);
     float* APPLESEED_RESTRICT dest_ptr = pixel(dest_x, dest_y);
@@ -120,6 +233,15 @@ void ShadingResultFrameBuffer::develop_to_tile(
     Tile&                           tile,
     TileStack&                      aov_tiles) const
 {
+    if (m_layout == PlanarLayout)
+    {
+        develop_planar(
+            tile,
+            aov_tiles,
+            AABB2u(Vector2u(0, 0), Vector2u(m_width - 1, m_height - 1)));
+        return;
+    }
+
     const float* ptr = pixel(0);
 
     for (size_t y = 0, h = m_height; y < h; ++y)
@@ -143,4 +265,107 @@ void ShadingResultFrameBuffer::develop_to_tile(
     }
 }
 
+void ShadingResultFrameBuffer::develop_to_tile(
+    Tile&                           tile,
+    TileStack&                      aov_tiles,
+    const AABB2u&                   region) const
+{
+    assert(region.max.x < m_width);
+    assert(region.max.y < m_height);
+
+    if (m_layout == PlanarLayout)
+    {
+        develop_planar(tile, aov_tiles, region);
+        return;
+    }
+
+    for (size_t y = region.min.y; y <= region.max.y; ++y)
+    {
+        const float* ptr = pixel(region.min.x, y);
+
+        for (size_t x = region.min.x; x <= region.max.x; ++x)
+        {
+            const float weight = *ptr++;
+            const float rcp_weight = weight == 0.0f ? 0.0f : 1.0f / weight;
+
+            const Color4f color(ptr[0], ptr[1], ptr[2], ptr[3]);
+            tile.set_pixel(x, y, color * rcp_weight);
+            ptr += 4;
+
+            for (size_t i = 0, e = m_aov_count; i < e; ++i)
+            {
+                const Color4f aov(ptr[0], ptr[1], ptr[2], ptr[3]);
+                aov_tiles.set_pixel(x, y, i, aov * rcp_weight);
+                ptr += 4;
+            }
+        }
+    }
+}
+
+void ShadingResultFrameBuffer::develop_planar(
+    Tile&                           tile,
+    TileStack&                      aov_tiles,
+    const AABB2u&                   region) const
+{
+    const size_t region_width = region.extent(0);
+    const size_t region_height = region.extent(1);
+
+    // Compute the reciprocal weights of the region once for all layers.
+    vector<float> rcp_weights(region_width * region_height);
+    for (size_t y = 0; y < region_height; ++y)
+    {
+        const float* APPLESEED_RESTRICT w = weights() + (region.min.y + y) * m_width + region.min.x;
+        float* APPLESEED_RESTRICT rcp_w = &rcp_weights[y * region_width];
+
+        for (size_t x = 0; x < region_width; ++x)
+            rcp_w[x] = w[x] == 0.0f ? 0.0f : 1.0f / w[x];
+    }
+
+    // Develop one layer at a time, converting whole rows of pixels to the format of the target tiles.
+    vector<float> row(region_width * 4);
+
+    for (size_t l = 0, e = m_aov_count + 1; l < e; ++l)
+    {
+        Tile& target = l == 0 ? tile : aov_tiles.get_tile(l - 1);
+        const float* plane = layer(l);
+
+        for (size_t y = 0; y < region_height; ++y)
+        {
+            const size_t iy = region.min.y + y;
+            const float* APPLESEED_RESTRICT ptr = plane + 4 * (iy * m_width + region.min.x);
+            const float* APPLESEED_RESTRICT rcp_w = &rcp_weights[y * region_width];
+            float* APPLESEED_RESTRICT out = &row[0];
+
+            for (size_t x = 0; x < region_width; ++x, ptr += 4, out += 4)
+            {
+#ifdef APPLESEED_USE_SSE
+                _mm_storeu_ps(out, _mm_mul_ps(_mm_load_ps(ptr), _mm_set1_ps(rcp_w[x])));
+#else
+                for (size_t c = 0; c < 4; ++c)
+                    out[c] = ptr[c] * rcp_w[x];
+#endif
+            }
+
+            if (target.get_channel_count() == 4)
+            {
+                Pixel::convert_to_format(
+                    &row[0],                                    // source begin
+                    &row[0] + row.size(),                       // source end
+                    1,                                          // source stride
+                    target.get_pixel_format(),                  // destination format
+                    target.pixel(region.min.x, iy),             // destination
+                    1);                                         // destination stride
+            }
+            else
+            {
+                for (size_t x = 0; x < region_width; ++x)
+                {
+                    const float* c = &row[x * 4];
+                    target.set_pixel(region.min.x + x, iy, Color4f(c[0], c[1], c[2], c[3]));
+                }
+            }
+        }
+    }
+}
+
 }   // namespace renderer
@@ -31,6 +31,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/image/accumulatortile.h"
+#include "foundation/image/color.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/vector.h"
 
@@ -46,23 +47,53 @@ namespace renderer      { class TileStack; }
 namespace renderer
 {
 
+//
+// A framebuffer accumulating the main color and the AOVs of shading results.
+//
+// In the interleaved layout, the weight and all the channels of a pixel are contiguous,
+// matching the AccumulatorTile layout. This is the layout checkpoints are written in.
+//
+// In the planar layout, the main color and each AOV are stored in their own plane of
+// 16-byte aligned RGBA values, followed by a plane of weights. Merging and developing
+// then process one layer at a time with SIMD operations. Pixels must not be accessed
+// through the Tile or AccumulatorTile interfaces in this layout.
+//
+
 class ShadingResultFrameBuffer
   : public foundation::AccumulatorTile
 {
   public:
+    enum Layout
+    {
+        InterleavedLayout,
+        PlanarLayout
+    };
+
     ShadingResultFrameBuffer(
         const size_t                    width,
         const size_t                    height,
-        const size_t                    aov_count);
+        const size_t                    aov_count,
+        const Layout                    layout = InterleavedLayout);
 
     ShadingResultFrameBuffer(
         const size_t                    width,
         const size_t                    height,
         const size_t                    aov_count,
-        const foundation::AABB2u&       crop_window);
+        const foundation::AABB2u&       crop_window,
+        const Layout                    layout = InterleavedLayout);
+
+    ~ShadingResultFrameBuffer();
 
     static size_t get_total_channel_count(const size_t aov_count);
 
+    Layout get_layout() const;
+
+    // Retrieve the main color of a given pixel, divided by its weight.
+    void get_main_color(
+        const size_t                    x,
+        const size_t                    y,
+        foundation::Color4f&            color) const;
+
     void add(
         const foundation::Vector2u&     pi,
         const ShadingResult&            sample);
@@ -79,9 +110,33 @@ class ShadingResultFrameBuffer
         foundation::Tile&               tile,
         TileStack&                      aov_tiles) const;
 
+    // Develop a region of the framebuffer, inclusive on all sides, leaving other pixels untouched.
+    void develop_to_tile(
+        foundation::Tile&               tile,
+        TileStack&                      aov_tiles,
+        const foundation::AABB2u&       region) const;
+
   private:
     const size_t                        m_aov_count;
+    const Layout                        m_layout;
     std::vector<float>                  m_scratch;
+
+    static foundation::uint8* allocate_storage(
+        const size_t                    width,
+        const size_t                    height,
+        const size_t                    aov_count,
+        const Layout                    layout);
+
+    // Planar layout: return the RGBA plane of a given layer (0 is the main color).
+    float* layer(const size_t index) const;
+
+    // Planar layout: return the plane of weights.
+    float* weights() const;
+
+    void develop_planar(
+        foundation::Tile&               tile,
+        TileStack&                      aov_tiles,
+        const foundation::AABB2u&       region) const;
 };
 
 inline size_t ShadingResultFrameBuffer::get_total_channel_count(const size_t aov_count)
@@ -90,4 +145,19 @@ inline size_t ShadingResultFrameBuffer::get_total_channel_count(const size_t aov
     return (1 + aov_count) * 4;
 }
 
+inline ShadingResultFrameBuffer::Layout ShadingResultFrameBuffer::get_layout() const
+{
+    return m_layout;
+}
+
+inline float* ShadingResultFrameBuffer::layer(const size_t index) const
+{
+    return reinterpret_cast<float*>(get_storage()) + index * m_pixel_count * 4;
+}
+
+inline float* ShadingResultFrameBuffer::weights() const
+{
+    return layer(1 + m_aov_count);
+}
+
 }   // namespace renderer
@@ -29,9 +29,21 @@
 // Interface header.
 #include "tilecallbackcollection.h"
 
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/thread.h"
+
+// Boost headers.
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
 // Standard headers.
 #include <cassert>
+#include <cstddef>
+#include <deque>
 #include <list>
+#include <memory>
 
 using namespace foundation;
 using namespace std;
@@ -41,11 +53,218 @@ namespace renderer
 
 namespace
 {
+    typedef list<ITileCallback*> TileCallbackList;
+
+    //
+    // Delivers on_tile_begin() and on_tile_end() events from a dedicated thread
+    // such that slow tile callbacks don't stall rendering threads.
+    //
+    // Tile callbacks read tiles from the frame when they are invoked, so a tile
+    // that was rendered again before its last on_tile_end() event was delivered
+    // only needs one on_tile_end() event: if the tile callbacks fall behind, the
+    // new events of such a tile are dropped.
+    //
+
+    class TileEventQueue
+      : public NonCopyable
+    {
+      public:
+        TileEventQueue()
+          : m_delivering(false)
+          , m_abort(false)
+        {
+            m_thread.reset(
+                new boost::thread(
+                    ThreadFunctionWrapper<TileEventQueue>(this)));
+        }
+
+        ~TileEventQueue()
+        {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_abort = true;
+            }
+
+            m_event_pushed.notify_one();
+            m_thread->join();
+        }
+
+        void push_tile_begin(
+            TileCallbackList*   callbacks,
+            const Frame*        frame,
+            const size_t        tile_x,
+            const size_t        tile_y)
+        {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_events.push_back(Event(Event::TileBegin, callbacks, frame, tile_x, tile_y));
+            }
+
+            m_event_pushed.notify_one();
+        }
+
+        void push_tile_end(
+            TileCallbackList*   callbacks,
+            const Frame*        frame,
+            const size_t        tile_x,
+            const size_t        tile_y)
+        {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+
+                if (!coalesce_tile_end(callbacks, frame, tile_x, tile_y))
+                    m_events.push_back(Event(Event::TileEnd, callbacks, frame, tile_x, tile_y));
+            }
+
+            m_event_pushed.notify_one();
+        }
+
+        // Wait until all pending events have been delivered.
+        void flush()
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            while (!m_events.empty() || m_delivering)
+                m_queue_empty.wait(lock);
+        }
+
+        void operator()()
+        {
+            set_current_thread_name("tile_callbacks");
+
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            while (true)
+            {
+                while (m_events.empty() && !m_abort)
+                    m_event_pushed.wait(lock);
+
+                if (m_events.empty())
+                    break;
+
+                const Event event = m_events.front();
+                m_events.pop_front();
+                m_delivering = true;
+
+                // Invoke the tile callbacks without holding the lock.
+                lock.unlock();
+                deliver(event);
+                lock.lock();
+
+                m_delivering = false;
+
+                if (m_events.empty())
+                    m_queue_empty.notify_all();
+            }
+        }
+
+      private:
+        struct Event
+        {
+            enum Type { None, TileBegin, TileEnd };
+
+            Type                m_type;
+            TileCallbackList*   m_callbacks;
+            const Frame*        m_frame;
+            size_t              m_tile_x;
+            size_t              m_tile_y;
+
+            Event(
+                const Type          type,
+                TileCallbackList*   callbacks,
+                const Frame*        frame,
+                const size_t        tile_x,
+                const size_t        tile_y)
+              : m_type(type)
+              , m_callbacks(callbacks)
+              , m_frame(frame)
+              , m_tile_x(tile_x)
+              , m_tile_y(tile_y)
+            {
+            }
+
+            bool is_same_tile(
+                const TileCallbackList* callbacks,
+                const Frame*            frame,
+                const size_t            tile_x,
+                const size_t            tile_y) const
+            {
+                return
+                    m_callbacks == callbacks &&
+                    m_frame == frame &&
+                    m_tile_x == tile_x &&
+                    m_tile_y == tile_y;
+            }
+        };
+
+        boost::mutex                    m_mutex;
+        boost::condition_variable       m_event_pushed;
+        boost::condition_variable       m_queue_empty;
+        deque<Event>                    m_events;
+        bool                            m_delivering;
+        bool                            m_abort;
+        unique_ptr<boost::thread>       m_thread;
+
+        // If an on_tile_end() event of this tile is still pending, the tile callbacks will
+        // see the latest pixels of the tile when it is delivered. Cancel the pending
+        // on_tile_begin() event issued since then and return true. The mutex must be held.
+        bool coalesce_tile_end(
+            const TileCallbackList* callbacks,
+            const Frame*            frame,
+            const size_t            tile_x,
+            const size_t            tile_y)
+        {
+            Event* begin_event = nullptr;
+
+            for (auto i = m_events.rbegin(), e = m_events.rend(); i != e; ++i)
+            {
+                if (i->m_type == Event::None || !i->is_same_tile(callbacks, frame, tile_x, tile_y))
+                    continue;
+
+                if (i->m_type == Event::TileEnd)
+                {
+                    if (begin_event)
+                        begin_event->m_type = Event::None;
+                    return true;
+                }
+
+                if (begin_event)
+                    break;
+
+                begin_event = &*i;
+            }
+
+            return false;
+        }
+
+        static void deliver(const Event& event)
+        {
+            switch (event.m_type)
+            {
+              case Event::TileBegin:
+                for (auto i : *event.m_callbacks)
+                    i->on_tile_begin(event.m_frame, event.m_tile_x, event.m_tile_y);
+                break;
+
+              case Event::TileEnd:
+                for (auto i : *event.m_callbacks)
+                    i->on_tile_end(event.m_frame, event.m_tile_x, event.m_tile_y);
+                break;
+
+              default:
+                break;
+            }
+        }
+    };
+
     class TileCallbackCollection
       : public ITileCallback
     {
       public:
-        explicit TileCallbackCollection(list<ITileCallbackFactory*> factories)
+        TileCallbackCollection(
+            list<ITileCallbackFactory*> factories,
+            TileEventQueue*             event_queue)
+          : m_event_queue(event_queue)
         {
             for (auto i : factories)
                 m_callbacks.push_back(i->create());
@@ -53,18 +272,29 @@ namespace
 
         void release() override
         {
+            // Make sure no event is delivered to released tile callbacks.
+            if (m_event_queue)
+                m_event_queue->flush();
+
             for (auto i : m_callbacks)
                 i->release();
         }
 
         void on_tiled_frame_begin(const Frame* frame) override
         {
+            if (m_event_queue)
+                m_event_queue->flush();
+
             for (auto i : m_callbacks)
                 i->on_tiled_frame_begin(frame);
         }
 
         void on_tiled_frame_end(const Frame* frame) override
         {
+            // All tiles of the frame must have been presented before the frame ends.
+            if (m_event_queue)
+                m_event_queue->flush();
+
             for (auto i : m_callbacks)
                 i->on_tiled_frame_end(frame);
         }
@@ -74,6 +304,12 @@ namespace
             const size_t tile_x,
             const size_t tile_y) override
         {
+            if (m_event_queue)
+            {
+                m_event_queue->push_tile_begin(&m_callbacks, frame, tile_x, tile_y);
+                return;
+            }
+
             for (auto i : m_callbacks)
                 i->on_tile_begin(frame, tile_x, tile_y);
         }
@@ -83,18 +319,43 @@ namespace
             const size_t tile_x,
             const size_t tile_y) override
         {
+            if (m_event_queue)
+            {
+                m_event_queue->push_tile_end(&m_callbacks, frame, tile_x, tile_y);
+                return;
+            }
+
             for (auto i : m_callbacks)
                 i->on_tile_end(frame, tile_x, tile_y);
         }
 
         void on_progressive_frame_update(const Frame* frame) override
         {
+            if (m_event_queue)
+                m_event_queue->flush();
+
             for (auto i : m_callbacks)
                 i->on_progressive_frame_update(frame);
         }
 
+        bool accesses_tiles_synchronously() const override
+        {
+            // Events delivered from the event queue happen after the fact.
+            if (m_event_queue)
+                return false;
+
+            for (auto i : m_callbacks)
+            {
+                if (!i->accesses_tiles_synchronously())
+                    return false;
+            }
+
+            return true;
+        }
+
       private:
-        list<ITileCallback*> m_callbacks;
+        TileEventQueue*     m_event_queue;
+        TileCallbackList    m_callbacks;
     };
 }
 
@@ -107,13 +368,16 @@ struct TileCallbackCollectionFactory::Impl
 {
     typedef list<ITileCallbackFactory*> TileCallbackFactoryContainer;
 
-    TileCallbackFactoryContainer m_factories;
+    TileCallbackFactoryContainer    m_factories;
+    unique_ptr<TileEventQueue>      m_event_queue;
 };
 
 
-TileCallbackCollectionFactory::TileCallbackCollectionFactory()
+TileCallbackCollectionFactory::TileCallbackCollectionFactory(const bool asynchronous)
   : impl(new Impl())
 {
+    if (asynchronous)
+        impl->m_event_queue.reset(new TileEventQueue());
 }
 
 TileCallbackCollectionFactory::~TileCallbackCollectionFactory()
@@ -128,7 +392,7 @@ void TileCallbackCollectionFactory::release()
 
 ITileCallback* TileCallbackCollectionFactory::create()
 {
-    return new TileCallbackCollection(impl->m_factories);
+    return new TileCallbackCollection(impl->m_factories, impl->m_event_queue.get());
 }
 
 void TileCallbackCollectionFactory::insert(ITileCallbackFactory* factory)
@@ -40,13 +40,17 @@ namespace renderer
 //
 // A collection of tile callback factories.
 //
+// In asynchronous mode, on_tile_begin() and on_tile_end() are delivered to the
+// tile callbacks from a dedicated thread instead of the rendering threads, and
+// all pending events are delivered before on_tiled_frame_end() is invoked.
+//
 
 class APPLESEED_DLLSYMBOL TileCallbackCollectionFactory
   : public ITileCallbackFactory
 {
   public:
     // Constructor.
-    TileCallbackCollectionFactory();
+    explicit TileCallbackCollectionFactory(const bool asynchronous = false);
 
     // Destructor.
     ~TileCallbackCollectionFactory();
@@ -63,7 +63,7 @@ double compute_ambient_occlusion(
     const size_t            sample_count)
 {
     const foundation::Vector3d& geometric_normal = shading_point.get_geometric_normal();
-    const foundation::Basis3d& shading_basis = shading_point.get_shading_basis();
+    const foundation::Basis3d shading_basis(shading_point.get_shading_basis());
 
     // Create a sampling context.
     SamplingContext child_sampling_context = sampling_context.split(2, sample_count);
@@ -129,6 +129,83 @@ namespace
         return 0;
     }
 
+    //
+    // Closure tree traversal.
+    //
+    // Invoke a visitor on every component of a closure tree, along with the
+    // accumulated weight of the component, in depth-first, left-to-right order.
+    // The tree is walked iteratively: multiplications are folded into the running
+    // weight and the right operands of additions are kept on a small local stack.
+    //
+
+    template <typename Visitor>
+    void visit_closure_components(
+        const OSL::ClosureColor*    closure,
+        Color3f                     weight,
+        const Visitor&              visitor)
+    {
+        struct PendingClosure
+        {
+            const OSL::ClosureColor*    m_closure;
+            Color3f                     m_weight;
+        };
+
+        const size_t MaxPendingClosures = 32;
+        PendingClosure pending[MaxPendingClosures];
+        size_t pending_count = 0;
+
+        while (true)
+        {
+            if (closure != nullptr)
+            {
+                switch (closure->id)
+                {
+                  case OSL::ClosureColor::MUL:
+                    {
+                        const OSL::ClosureMul* c = reinterpret_cast<const OSL::ClosureMul*>(closure);
+                        weight = weight * Color3f(c->weight);
+                        closure = c->closure;
+                    }
+                    continue;
+
+                  case OSL::ClosureColor::ADD:
+                    {
+                        const OSL::ClosureAdd* c = reinterpret_cast<const OSL::ClosureAdd*>(closure);
+
+                        if APPLESEED_LIKELY(pending_count < MaxPendingClosures)
+                        {
+                            pending[pending_count].m_closure = c->closureB;
+                            pending[pending_count].m_weight = weight;
+                            ++pending_count;
+                            closure = c->closureA;
+                        }
+                        else
+                        {
+                            // Out of stack space: handle the left operand recursively.
+                            visit_closure_components(c->closureA, weight, visitor);
+                            closure = c->closureB;
+                        }
+                    }
+                    continue;
+
+                  default:
+                    {
+                        const OSL::ClosureComponent* c = reinterpret_cast<const OSL::ClosureComponent*>(closure);
+                        visitor(c, weight * Color3f(c->w));
+                    }
+                    break;
+                }
+            }
+
+            if (pending_count == 0)
+                break;
+
+            --pending_count;
+            closure = pending[pending_count].m_closure;
+            weight = pending[pending_count].m_weight;
+        }
+    }
+
     //
     // Closures.
     //
@@ -1941,37 +2018,14 @@ void CompositeSurfaceClosure::process_closure_tree(
     const Color3f&              weight,
     Arena&                      arena)
 {
-    if (closure == nullptr)
-        return;
-
-    switch (closure->id)
-    {
-      case OSL::ClosureColor::MUL:
-        {
-            const OSL::ClosureMul* c = reinterpret_cast<const OSL::ClosureMul*>(closure);
-            const Color3f w = weight * Color3f(c->weight);
-            process_closure_tree(c->closure, original_shading_basis, w, arena);
-        }
-        break;
-
-      case OSL::ClosureColor::ADD:
-        {
-            const OSL::ClosureAdd* c = reinterpret_cast<const OSL::ClosureAdd*>(closure);
-            process_closure_tree(c->closureA, original_shading_basis, weight, arena);
-            process_closure_tree(c->closureB, original_shading_basis, weight, arena);
-        }
-        break;
-
-      default:
+    visit_closure_components(
+        closure,
+        weight,
+        [&](const OSL::ClosureComponent* c, const Color3f& w)
         {
-            const OSL::ClosureComponent* c = reinterpret_cast<const OSL::ClosureComponent*>(closure);
-            const Color3f w = weight * Color3f(c->w);
-
             if (luminance(w) > 0.0f)
                 g_closure_convert_funs[c->id](*this, original_shading_basis, c->data(), w, arena);
-        }
-        break;
-    }
+        });
 }
 
 
@@ -2000,33 +2054,13 @@ void CompositeSubsurfaceClosure::process_closure_tree(
     const Color3f&              weight,
     Arena&                      arena)
 {
-    if (closure == nullptr)
-        return;
-
-    switch (closure->id)
-    {
-      case OSL::ClosureColor::MUL:
-        {
-            const OSL::ClosureMul* c = reinterpret_cast<const OSL::ClosureMul*>(closure);
-            process_closure_tree(c->closure, original_shading_basis, weight * Color3f(c->weight), arena);
-        }
-        break;
-
-      case OSL::ClosureColor::ADD:
-        {
-            const OSL::ClosureAdd* c = reinterpret_cast<const OSL::ClosureAdd*>(closure);
-            process_closure_tree(c->closureA, original_shading_basis, weight, arena);
-            process_closure_tree(c->closureB, original_shading_basis, weight, arena);
-        }
-        break;
-
-      default:
+    visit_closure_components(
+        closure,
+        weight,
+        [&](const OSL::ClosureComponent* c, const Color3f& w)
         {
-            const OSL::ClosureComponent* c = reinterpret_cast<const OSL::ClosureComponent*>(closure);
-
             if (c->id == SubsurfaceID)
             {
-                const Color3f w = weight * Color3f(c->w);
                 if (luminance(w) > 0.0f)
                 {
                     SubsurfaceClosure::convert_closure(
@@ -2039,7 +2073,6 @@ void CompositeSubsurfaceClosure::process_closure_tree(
             }
             else if (c->id == RandomwalkGlassID)
             {
-                const Color3f w = weight * Color3f(c->w);
                 if (luminance(w) > 0.0f)
                 {
                     RandomwalkGlassClosure::convert_closure(
@@ -2050,9 +2083,7 @@ void CompositeSubsurfaceClosure::process_closure_tree(
                         arena);
                 }
             }
-        }
-        break;
-    }
+        });
 }
 
 
@@ -2105,31 +2136,11 @@ void CompositeEmissionClosure::process_closure_tree(
     const Color3f&              weight,
     Arena&                      arena)
 {
-    if (closure == nullptr)
-        return;
-
-    switch (closure->id)
-    {
-      case OSL::ClosureColor::MUL:
-        {
-            const OSL::ClosureMul* c = reinterpret_cast<const OSL::ClosureMul*>(closure);
-            process_closure_tree(c->closure, weight * Color3f(c->weight), arena);
-        }
-        break;
-
-      case OSL::ClosureColor::ADD:
-        {
-            const OSL::ClosureAdd* c = reinterpret_cast<const OSL::ClosureAdd*>(closure);
-            process_closure_tree(c->closureA, weight, arena);
-            process_closure_tree(c->closureB, weight, arena);
-        }
-        break;
-
-      default:
+    visit_closure_components(
+        closure,
+        weight,
+        [&](const OSL::ClosureComponent* c, const Color3f& w)
         {
-            const OSL::ClosureComponent* c = reinterpret_cast<const OSL::ClosureComponent*>(closure);
-
-            const Color3f w = weight * Color3f(c->w);
             const float max_weight_component = max_value(w);
 
             if (max_weight_component > 0.0f)
@@ -2144,9 +2155,7 @@ void CompositeEmissionClosure::process_closure_tree(
                         arena);
                 }
             }
-        }
-        break;
-    }
+        });
 }
 
 
@@ -2208,33 +2217,13 @@ void CompositeNPRClosure::process_closure_tree(
     const Color3f&              weight,
     Arena&                      arena)
 {
-    if (closure == nullptr)
-        return;
-
-    switch (closure->id)
-    {
-      case OSL::ClosureColor::MUL:
-        {
-            const OSL::ClosureMul* c = reinterpret_cast<const OSL::ClosureMul*>(closure);
-            process_closure_tree(c->closure, weight * Color3f(c->weight), arena);
-        }
-        break;
-
-      case OSL::ClosureColor::ADD:
-        {
-            const OSL::ClosureAdd* c = reinterpret_cast<const OSL::ClosureAdd*>(closure);
-            process_closure_tree(c->closureA, weight, arena);
-            process_closure_tree(c->closureB, weight, arena);
-        }
-        break;
-
-      default:
+    visit_closure_components(
+        closure,
+        weight,
+        [&](const OSL::ClosureComponent* c, const Color3f& w)
         {
-            const OSL::ClosureComponent* c = reinterpret_cast<const OSL::ClosureComponent*>(closure);
-
             if (c->id == NPRShadingID)
             {
-                const Color3f w = weight * Color3f(c->w);
                 NPRShadingClosure::convert_closure(
                     *this,
                     c->data(),
@@ -2243,16 +2232,13 @@ void CompositeNPRClosure::process_closure_tree(
             }
             else if (c->id == NPRContourID)
             {
-                const Color3f w = weight * Color3f(c->w);
                 NPRContourClosure::convert_closure(
                     *this,
                     c->data(),
                     w,
                     arena);
             }
-        }
-        break;
-    }
+        });
 }
 
 
@@ -56,6 +56,7 @@
 // Standard headers.
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 
 using namespace foundation;
 using namespace std;
@@ -210,11 +211,11 @@ void AOVoxelTree::build(
             const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
 
             // Push all triangles of the mesh into the tree.
-            const size_t triangle_count = tess.m_primitives.size();
+            const size_t triangle_count = tess.get_primitive_count();
             for (size_t triangle_index = 0; triangle_index < triangle_count; ++triangle_index)
             {
                 // Fetch the triangle.
-                const Triangle& triangle = tess.m_primitives[triangle_index];
+                const Triangle triangle = tess.get_primitive(triangle_index);
 
                 // Retrieve object instance space vertices of the triangle.
                 const GVector3& v0_os = tess.m_vertices[triangle.m_v0];
@@ -289,6 +290,72 @@ bool AOVoxelTreeIntersector::trace(
     return false;
 }
 
+size_t AOVoxelTreeIntersector::trace_packet(
+    const ShadingRay::RayType   rays[],
+    const size_t                ray_count,
+    const bool                  solid,
+    double                      distances[]) const
+{
+    assert(ray_count > 0 && ray_count <= PacketSize);
+
+    // Retrieve the voxel tree.
+    const AOVoxelTree::TreeType& tree = m_tree.m_tree;
+    const AABB3d tree_bbox(tree.get_bbox());
+
+    // Clip the rays against the bounding box of the tree and keep those that overlap it.
+    ShadingRay::RayType clipped_rays[PacketSize];
+    ShadingRay::RayInfoType clipped_ray_infos[PacketSize];
+    size_t ray_indices[PacketSize];
+    size_t clipped_ray_count = 0;
+
+    for (size_t i = 0; i < ray_count; ++i)
+    {
+        ShadingRay::RayType& ray = clipped_rays[clipped_ray_count];
+        ShadingRay::RayInfoType& ray_info = clipped_ray_infos[clipped_ray_count];
+
+        ray = rays[i];
+        ray_info = ShadingRay::RayInfoType(ray);
+
+        if (clip(ray, ray_info, tree_bbox))
+            ray_indices[clipped_ray_count++] = i;
+    }
+
+    size_t hits = 0;
+
+    if (clipped_ray_count > 0)
+    {
+        // Intersect the rays with the tree.
+        double clipped_distances[PacketSize];
+        IntersectorType intersector;
+        const size_t clipped_hits =
+            intersector.intersect_packet(
+                tree,
+                clipped_rays,
+                clipped_ray_infos,
+                clipped_ray_count,
+                solid,
+                clipped_distances);
+
+        for (size_t i = 0; i < clipped_ray_count; ++i)
+        {
+            const size_t ray_index = ray_indices[i];
+
+            if (clipped_hits & (size_t(1) << i))
+            {
+                hits |= size_t(1) << ray_index;
+                distances[ray_index] = clipped_distances[i];
+            }
+            else if (!solid)
+            {
+                if (intersect(clipped_rays[i], clipped_ray_infos[i], tree_bbox, distances[ray_index]))
+                    hits |= size_t(1) << ray_index;
+            }
+        }
+    }
+
+    return hits;
+}
+
 
 //
 // Compute fast ambient occlusion at a given point in space.
@@ -307,38 +374,72 @@ double compute_fast_ambient_occlusion(
     // Create a sampling context.
     SamplingContext child_sampling_context = sampling_context.split(2, sample_count);
 
-    // Construct the ambient occlusion ray.
-    ShadingRay::RayType ray;
-    ray.m_org = point;
-    ray.m_tmin = 0.0;
-    ray.m_tmax = max_distance;
+    const size_t PacketSize = AOVoxelTreeIntersector::PacketSize;
+
+    // Packets of ambient occlusion rays being filled, one per octant.
+    ShadingRay::RayType packets[8][PacketSize];
+    size_t packet_sizes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
     size_t computed_samples = 0;
     size_t occluded_samples = 0;
 
     min_distance = max_distance;
 
-    for (size_t i = 0; i < sample_count; ++i)
+    for (size_t i = 0; i <= sample_count; ++i)
     {
-        // Generate a cosine-weighted direction over the unit hemisphere.
-        ray.m_dir = sample_hemisphere_cosine(child_sampling_context.next2<Vector2d>());
+        if (i < sample_count)
+        {
+            // Generate a cosine-weighted direction over the unit hemisphere.
+            Vector3d dir = sample_hemisphere_cosine(child_sampling_context.next2<Vector2d>());
+
+            // Transform the direction to world space.
+            dir = shading_basis.transform_to_parent(dir);
+
+            // Don't cast rays on or below the geometric surface.
+            if (dot(dir, geometric_normal) <= 0.0)
+                continue;
+
+            // Count the number of computed samples.
+            ++computed_samples;
+
+            // Construct the ambient occlusion ray and add it to the packet of its octant.
+            // Like RayInfo, treat negative zero components as negative.
+            const size_t octant =
+                (signbit(dir[0]) ? 0 : 1) |
+                (signbit(dir[1]) ? 0 : 2) |
+                (signbit(dir[2]) ? 0 : 4);
+            ShadingRay::RayType& ray = packets[octant][packet_sizes[octant]++];
+            ray.m_org = point;
+            ray.m_dir = dir;
+            ray.m_tmin = 0.0;
+            ray.m_tmax = max_distance;
+
+            // Wait until the packet is full.
+            if (packet_sizes[octant] < PacketSize)
+                continue;
+        }
 
-        // Transform the direction to world space.
-        ray.m_dir = shading_basis.transform_to_parent(ray.m_dir);
+        // Trace full packets, and all partial packets once all rays are generated.
+        for (size_t octant = 0; octant < 8; ++octant)
+        {
+            const size_t packet_size = packet_sizes[octant];
+            if (packet_size == 0 || (i < sample_count && packet_size < PacketSize))
+                continue;
 
-        // Don't cast rays on or below the geometric surface.
-        if (dot(ray.m_dir, geometric_normal) <= 0.0)
-            continue;
+            // Trace the ambient occlusion rays and count the number of occluded samples.
+            double distances[PacketSize];
+            const size_t hits = intersector.trace_packet(packets[octant], packet_size, true, distances);
 
-        // Count the number of computed samples.
-        ++computed_samples;
+            for (size_t j = 0; j < packet_size; ++j)
+            {
+                if (hits & (size_t(1) << j))
+                {
+                    ++occluded_samples;
+                    min_distance = min(min_distance, distances[j]);
+                }
+            }
 
-        // Trace the ambient occlusion ray and count the number of occluded samples.
-        double distance;
-        if (intersector.trace(ray, true, distance))
-        {
-            ++occluded_samples;
-            min_distance = min(min_distance, distance);
+            packet_sizes[octant] = 0;
         }
     }
 
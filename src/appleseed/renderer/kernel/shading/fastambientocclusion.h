@@ -109,6 +109,18 @@ class AOVoxelTreeIntersector
         const bool          solid,
         double&             distance) const;
 
+    // Maximum number of rays in a packet.
+    static const size_t PacketSize = 4;
+
+    // Trace a packet of up to PacketSize world space rays sharing their origin and the
+    // signs of the components of their direction through the voxel tree. Return a bit
+    // mask of the rays that hit; the distance is stored in distances[i] for every such ray i.
+    size_t trace_packet(
+        const ShadingRay::RayType   rays[],
+        const size_t                ray_count,
+        const bool                  solid,
+        double                      distances[]) const;
+
   private:
     // Types.
     typedef foundation::voxel::Intersector<
@@ -129,6 +141,8 @@ class AOVoxelTreeIntersector
 //
 // Compute fast ambient occlusion at a given point in space.
 //
+// The occlusion rays are binned by octant and traced in packets.
+//
 // todo: implement optional computation of the mean unoccluded direction.
 //
 
@@ -52,13 +52,28 @@ namespace renderer
 OSLShaderGroupExec::OSLShaderGroupExec(OSLShadingSystem& shading_system, Arena& arena)
   : m_osl_shading_system(shading_system)
   , m_arena(arena)
+  , m_texture_thread_cache(*shading_system.renderer()->texturesys())
   , m_osl_thread_info(shading_system.create_thread_info())
-  , m_osl_shading_context(shading_system.get_context(m_osl_thread_info))
+  , m_osl_shading_context(
+        shading_system.get_context(
+            m_osl_thread_info,
+            m_texture_thread_cache.get_thread_info()))
 {
+    for (size_t i = 0; i < MaxBatchSize; ++i)
+        m_osl_batch_contexts[i] = nullptr;
 }
 
 OSLShaderGroupExec::~OSLShaderGroupExec()
 {
+    for (size_t i = 0; i < MaxBatchSize; ++i)
+    {
+        if (m_osl_batch_contexts[i])
+            m_osl_shading_system.release_context(m_osl_batch_contexts[i]);
+    }
+
+    for (const ConstantClosures& constant_closures : m_constant_closures)
+        m_osl_shading_system.release_context(constant_closures.m_osl_shading_context);
+
     if (m_osl_shading_context)
         m_osl_shading_system.release_context(m_osl_shading_context);
 
@@ -76,6 +91,55 @@ void OSLShaderGroupExec::execute_shading(
         shading_point.get_ray().m_flags);
 }
 
+void OSLShaderGroupExec::execute_shading_batch(
+    const ShaderGroup&              shader_group,
+    const ShadingPoint* const*      shading_points,
+    const size_t                    shading_point_count) const
+{
+    assert(m_osl_thread_info);
+    assert(shading_point_count <= MaxBatchSize);
+
+    // Constant shader groups don't need to run at every point.
+    if (shader_group.is_constant())
+        return;
+
+    OSL::ShaderGroup& osl_shader_group =
+        *reinterpret_cast<OSL::ShaderGroup*>(shader_group.osl_shader_group());
+
+    // Set up the shader globals of all shading points first so that
+    // the shader group then runs on the whole batch without interruption.
+    for (size_t i = 0; i < shading_point_count; ++i)
+    {
+        const ShadingPoint& shading_point = *shading_points[i];
+        shading_point.initialize_osl_shader_globals(
+            shader_group,
+            shading_point.get_ray().m_flags,
+            m_osl_shading_system.renderer());
+        shading_point.get_osl_shader_globals().objdata = &m_texture_thread_cache;
+    }
+
+    for (size_t i = 0; i < shading_point_count; ++i)
+    {
+        OSL::ShadingContext*& osl_context = m_osl_batch_contexts[i];
+        if (osl_context == nullptr)
+        {
+            osl_context =
+                m_osl_shading_system.get_context(
+                    m_osl_thread_info,
+                    m_texture_thread_cache.get_thread_info());
+        }
+
+        const ShadingPoint& shading_point = *shading_points[i];
+        m_osl_shading_system.execute(
+            osl_context,
+            osl_shader_group,
+            shading_point.get_osl_shader_globals());
+
+        shading_point.m_osl_batch_shader_group = &shader_group;
+        shading_point.m_members |= ShadingPoint::HasOSLBatchResults;
+    }
+}
+
 void OSLShaderGroupExec::execute_subsurface(
     const ShaderGroup&              shader_group,
     const ShadingPoint&             shading_point) const
@@ -191,6 +255,7 @@ Color3f OSLShaderGroupExec::execute_background(
     sg.I = outgoing;
     sg.renderer = m_osl_shading_system.renderer();
     sg.raytype = VisibilityFlags::CameraRay;
+    sg.objdata = &m_texture_thread_cache;
 
     m_osl_shading_system.execute(
         m_osl_shading_context,
@@ -208,10 +273,29 @@ void OSLShaderGroupExec::do_execute(
     assert(m_osl_shading_context);
     assert(m_osl_thread_info);
 
+    // Reuse the results of a batched execution of this shader group, if any.
+    if (shading_point.m_members & ShadingPoint::HasOSLBatchResults)
+    {
+        shading_point.m_members &= ~ShadingPoint::HasOSLBatchResults;
+
+        if (shading_point.m_osl_batch_shader_group == &shader_group &&
+            shading_point.get_osl_shader_globals().raytype == static_cast<int>(ray_flags))
+            return;
+    }
+
     shading_point.initialize_osl_shader_globals(
         shader_group,
         ray_flags,
         m_osl_shading_system.renderer());
+    shading_point.get_osl_shader_globals().objdata = &m_texture_thread_cache;
+
+    // Reuse the closures of constant shader groups.
+    if (shader_group.is_constant())
+    {
+        shading_point.get_osl_shader_globals().Ci =
+            get_constant_closures(shader_group, shading_point, ray_flags);
+        return;
+    }
 
     m_osl_shading_system.execute(
         m_osl_shading_context,
@@ -219,6 +303,46 @@ void OSLShaderGroupExec::do_execute(
         shading_point.get_osl_shader_globals());
 }
 
+OSL::ClosureColor* OSLShaderGroupExec::get_constant_closures(
+    const ShaderGroup&              shader_group,
+    const ShadingPoint&             shading_point,
+    const VisibilityFlags::Type     ray_flags) const
+{
+    const int ray_flags_int = static_cast<int>(ray_flags);
+
+    for (const ConstantClosures& constant_closures : m_constant_closures)
+    {
+        if (constant_closures.m_shader_group == &shader_group &&
+            constant_closures.m_ray_flags == ray_flags_int)
+            return constant_closures.m_closures;
+    }
+
+    OSL::ShaderGroup& osl_shader_group =
+        *reinterpret_cast<OSL::ShaderGroup*>(shader_group.osl_shader_group());
+    OSL::ShaderGlobals& sg = shading_point.get_osl_shader_globals();
+
+    // Too many constant shader groups: run the shader group as usual.
+    if (m_constant_closures.size() >= MaxConstantClosures)
+    {
+        m_osl_shading_system.execute(m_osl_shading_context, osl_shader_group, sg);
+        return sg.Ci;
+    }
+
+    // Run the shader group once in a context of its own so that its closures stay alive.
+    ConstantClosures constant_closures;
+    constant_closures.m_shader_group = &shader_group;
+    constant_closures.m_ray_flags = ray_flags_int;
+    constant_closures.m_osl_shading_context =
+        m_osl_shading_system.get_context(
+            m_osl_thread_info,
+            m_texture_thread_cache.get_thread_info());
+    m_osl_shading_system.execute(constant_closures.m_osl_shading_context, osl_shader_group, sg);
+    constant_closures.m_closures = sg.Ci;
+    m_constant_closures.push_back(constant_closures);
+
+    return constant_closures.m_closures;
+}
+
 void OSLShaderGroupExec::choose_bsdf_closure_shading_basis(
     const ShadingPoint&             shading_point,
     const Vector2f&                 s) const
@@ -30,6 +30,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globaltypes.h"
+#include "renderer/kernel/texturing/oiiotexturesystem.h"
 #include "renderer/modeling/scene/visibilityflags.h"
 
 // appleseed.foundation headers.
@@ -43,6 +44,10 @@
 #include "OSL/oslversion.h"
 #include "foundation/platform/_endoslheaders.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 // Forward declarations.
 namespace foundation    { class Arena; }
 namespace renderer      { class OSLShadingSystem; }
@@ -58,6 +63,9 @@ class OSLShaderGroupExec
   : public foundation::NonCopyable
 {
   public:
+    // Maximum number of shading points in a batch, see execute_shading_batch().
+    enum { MaxBatchSize = 16 };
+
     OSLShaderGroupExec(
         OSLShadingSystem&               shading_system,
         foundation::Arena&              arena);
@@ -71,8 +79,29 @@ class OSLShaderGroupExec
     OSLShadingSystem&                   m_osl_shading_system;
     foundation::Arena&                  m_arena;
 
+
+    // Per-thread texture lookup state, shared by all the OSL contexts of this thread.
+    // Shader globals point to it (via their objdata field) so that RendererServices
+    // can reuse resolved texture handles.
+    mutable OIIOTextureThreadCache      m_texture_thread_cache;
+
     OSL::PerThreadInfo*                 m_osl_thread_info;
     OSL::ShadingContext*                m_osl_shading_context;
+    mutable OSL::ShadingContext*        m_osl_batch_contexts[MaxBatchSize];
+
+    // Closures of constant shader groups, evaluated once per ray type. Each entry
+    // owns the OSL context that holds its closure tree.
+    struct ConstantClosures
+    {
+        const ShaderGroup*              m_shader_group;
+        int                             m_ray_flags;
+        OSL::ShadingContext*            m_osl_shading_context;
+        OSL::ClosureColor*              m_closures;
+    };
+
+    enum { MaxConstantClosures = 64 };
+
+    mutable std::vector<ConstantClosures> m_constant_closures;
     char*                               m_osl_mem_pool;
     char*                               m_osl_mem_pool_start;
     mutable size_t                      m_osl_mem_used;
@@ -81,6 +110,16 @@ class OSLShaderGroupExec
         const ShaderGroup&              shader_group,
         const ShadingPoint&             shading_point) const;
 
+    // Execute a shader group on a batch of shading points, back-to-back. Each point
+    // gets its own OSL context so that the closure trees of all points of the batch
+    // stay alive; the next execute_shading() call on one of these points with the
+    // same shader group reuses the precomputed closures instead of running the group
+    // again. The results of a batch are only valid until the next batch is executed.
+    void execute_shading_batch(
+        const ShaderGroup&              shader_group,
+        const ShadingPoint* const*      shading_points,
+        const size_t                    shading_point_count) const;
+
     void execute_subsurface(
         const ShaderGroup&              shader_group,
         const ShadingPoint&             shading_point) const;
@@ -121,6 +160,11 @@ class OSLShaderGroupExec
         const ShadingPoint&             shading_point,
         const VisibilityFlags::Type     ray_flags) const;
 
+    OSL::ClosureColor* get_constant_closures(
+        const ShaderGroup&              shader_group,
+        const ShadingPoint&             shading_point,
+        const VisibilityFlags::Type     ray_flags) const;
+
     void choose_bsdf_closure_shading_basis(
         const ShadingPoint&             shading_point,
         const foundation::Vector2f&     s) const;
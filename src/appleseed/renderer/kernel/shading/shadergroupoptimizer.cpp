@@ -0,0 +1,228 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "shadergroupoptimizer.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/basegroup.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// ShaderGroupOptimizer class implementation.
+//
+
+// Every job optimizes the most urgent pending shader group at the time it is executed.
+class ShaderGroupOptimizer::OptimizationJob
+  : public IJob
+{
+  public:
+    explicit OptimizationJob(ShaderGroupOptimizer& optimizer)
+      : m_optimizer(optimizer)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        boost::shared_lock<boost::shared_mutex> lock(m_optimizer.m_suspend_mutex);
+
+        if (ShaderGroup* shader_group = m_optimizer.acquire_pending_shader_group())
+            m_optimizer.optimize(*shader_group);
+    }
+
+  private:
+    ShaderGroupOptimizer& m_optimizer;
+};
+
+ShaderGroupOptimizer::ShaderGroupOptimizer(
+    OSLShadingSystem&       shading_system,
+    const size_t            thread_count)
+  : m_shading_system(shading_system)
+  , m_optimized_count(0)
+  , m_needs_reinitialization(false)
+{
+    assert(thread_count > 0);
+
+    m_job_manager.reset(
+        new JobManager(
+            global_logger(),
+            m_job_queue,
+            thread_count,
+            JobManager::KeepRunningOnEmptyQueue));
+    m_job_manager->start();
+}
+
+ShaderGroupOptimizer::~ShaderGroupOptimizer()
+{
+    cancel();
+    m_job_manager->stop();
+}
+
+size_t ShaderGroupOptimizer::schedule(BaseGroup& base_group)
+{
+    vector<ShaderGroup*> shader_groups;
+    collect(base_group, shader_groups);
+
+    size_t scheduled_count = 0;
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        for (ShaderGroup* shader_group : shader_groups)
+        {
+            // Skip shader groups that were already scheduled.
+            if (find(m_pending_shader_groups.begin(), m_pending_shader_groups.end(), shader_group)
+                    != m_pending_shader_groups.end())
+                continue;
+
+            m_pending_shader_groups.push_back(shader_group);
+            ++scheduled_count;
+        }
+    }
+
+    for (size_t i = 0; i < scheduled_count; ++i)
+        m_job_queue.schedule(new OptimizationJob(*this));
+
+    if (scheduled_count > 0)
+    {
+        RENDERER_LOG_INFO(
+            "optimizing %s %s in the background...",
+            pretty_uint(scheduled_count).c_str(),
+            plural(scheduled_count, "shader group").c_str());
+    }
+
+    return scheduled_count;
+}
+
+bool ShaderGroupOptimizer::is_busy() const
+{
+    return m_job_queue.has_scheduled_or_running_jobs();
+}
+
+bool ShaderGroupOptimizer::fetch_optimized_shader_groups(bool& needs_reinitialization)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    const bool optimized = m_optimized_count > 0;
+    needs_reinitialization = m_needs_reinitialization;
+
+    m_optimized_count = 0;
+    m_needs_reinitialization = false;
+
+    return optimized;
+}
+
+void ShaderGroupOptimizer::wait_until_completion()
+{
+    m_job_queue.wait_until_completion();
+}
+
+void ShaderGroupOptimizer::cancel()
+{
+    m_job_queue.clear_scheduled_jobs();
+
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_pending_shader_groups.clear();
+    }
+
+    m_job_queue.wait_until_completion();
+}
+
+void ShaderGroupOptimizer::collect(
+    BaseGroup&              base_group,
+    vector<ShaderGroup*>&   shader_groups) const
+{
+    for (Assembly& assembly : base_group.assemblies())
+        collect(assembly, shader_groups);
+
+    for (ShaderGroup& shader_group : base_group.shader_groups())
+    {
+        if (shader_group.is_valid() && !shader_group.is_optimized())
+            shader_groups.push_back(&shader_group);
+    }
+}
+
+ShaderGroup* ShaderGroupOptimizer::acquire_pending_shader_group()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_pending_shader_groups.empty())
+        return nullptr;
+
+    // Pick the shader group that was hit first. Ties keep scheduling order.
+    size_t best_index = 0;
+    for (size_t i = 1, e = m_pending_shader_groups.size(); i < e; ++i)
+    {
+        if (m_pending_shader_groups[i]->get_first_use() < m_pending_shader_groups[best_index]->get_first_use())
+            best_index = i;
+    }
+
+    ShaderGroup* shader_group = m_pending_shader_groups[best_index];
+    m_pending_shader_groups.erase(m_pending_shader_groups.begin() + best_index);
+
+    return shader_group;
+}
+
+void ShaderGroupOptimizer::optimize(ShaderGroup& shader_group)
+{
+    // Errors are reported by the shader group; it keeps being shaded with a fallback.
+    if (!shader_group.optimize_osl_shader_group(m_shading_system))
+        return;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    ++m_optimized_count;
+
+    if (shader_group.has_emission() || shader_group.has_transparency())
+        m_needs_reinitialization = true;
+}
+
+ShaderGroupOptimizer::SuspendScope::SuspendScope(ShaderGroupOptimizer* optimizer)
+{
+    if (optimizer != nullptr)
+        m_lock.reset(new boost::unique_lock<boost::shared_mutex>(optimizer->m_suspend_mutex));
+}
+
+}   // namespace renderer
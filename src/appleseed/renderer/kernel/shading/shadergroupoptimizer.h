@@ -0,0 +1,128 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/utility/job.h"
+
+// Boost headers.
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/shared_mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class BaseGroup; }
+namespace renderer  { class OSLShadingSystem; }
+namespace renderer  { class ShaderGroup; }
+
+namespace renderer
+{
+
+//
+// Optimizes and JIT-compiles OSL shader groups on background threads while rendering
+// proceeds with fallback shading.
+//
+// Shader groups are optimized in the order in which they were first hit, and shader
+// groups that were never hit are optimized last, in scene order.
+//
+
+class ShaderGroupOptimizer
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor.
+    ShaderGroupOptimizer(
+        OSLShadingSystem&       shading_system,
+        const size_t            thread_count);
+
+    // Destructor. Cancels pending optimizations.
+    ~ShaderGroupOptimizer();
+
+    // Schedule the optimization of the shader groups of a scene or an assembly, and of its
+    // child assemblies, that are set up but not optimized yet. Return the number of shader
+    // groups scheduled for optimization.
+    size_t schedule(BaseGroup& base_group);
+
+    // Return true if some shader groups are still waiting to be optimized or being optimized.
+    bool is_busy() const;
+
+    // Return true if shader groups were optimized since the last call. needs_reinitialization
+    // is set to true if one of them has emission or transparency, in which case rendering
+    // components depending on them (such as light samplers) must be rebuilt.
+    bool fetch_optimized_shader_groups(bool& needs_reinitialization);
+
+    // Wait until all scheduled shader groups are optimized.
+    void wait_until_completion();
+
+    // Drop the shader groups that are not being optimized yet and wait for the others.
+    void cancel();
+
+    // Prevent shader groups from being optimized for as long as this object lives,
+    // such as while the scene is being edited.
+    class SuspendScope
+      : public foundation::NonCopyable
+    {
+      public:
+        explicit SuspendScope(ShaderGroupOptimizer* optimizer);
+
+      private:
+        std::unique_ptr<boost::unique_lock<boost::shared_mutex>> m_lock;
+    };
+
+  private:
+    class OptimizationJob;
+
+    OSLShadingSystem&                           m_shading_system;
+    foundation::JobQueue                        m_job_queue;
+    std::unique_ptr<foundation::JobManager>     m_job_manager;
+
+    // Held in shared mode while a shader group is being optimized.
+    boost::shared_mutex                         m_suspend_mutex;
+
+    boost::mutex                                m_mutex;
+    std::vector<ShaderGroup*>                   m_pending_shader_groups;
+    size_t                                      m_optimized_count;
+    bool                                        m_needs_reinitialization;
+
+    void collect(
+        BaseGroup&              base_group,
+        std::vector<ShaderGroup*>& shader_groups) const;
+
+    ShaderGroup* acquire_pending_shader_group();
+
+    void optimize(ShaderGroup& shader_group);
+};
+
+}   // namespace renderer
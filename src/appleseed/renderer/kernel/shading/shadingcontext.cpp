@@ -94,6 +94,17 @@ void ShadingContext::execute_osl_shading(
         shading_point);
 }
 
+void ShadingContext::execute_osl_shading_batch(
+    const ShaderGroup&          shader_group,
+    const ShadingPoint* const*  shading_points,
+    const size_t                shading_point_count) const
+{
+    m_shadergroup_exec.execute_shading_batch(
+        shader_group,
+        shading_points,
+        shading_point_count);
+}
+
 void ShadingContext::execute_osl_subsurface(
     const ShaderGroup&      shader_group,
     const ShadingPoint&     shading_point) const
@@ -97,10 +97,21 @@ class ShadingContext
     OSLShadingSystem& get_osl_shading_system() const;
     OSL::ShadingContext* get_osl_shading_context() const;
 
+    // Return the OSL shader group executor, for instance to build a shading
+    // context that shares it but allocates from a different arena.
+    OSLShaderGroupExec& get_osl_shadergroup_exec() const;
+
     void execute_osl_shading(
         const ShaderGroup&          shader_group,
         const ShadingPoint&         shading_point) const;
 
+    // Execute the OSL shader group on up to OSLShaderGroupExec::MaxBatchSize shading points.
+    // A subsequent execute_osl_shading() call on one of these points reuses the results.
+    void execute_osl_shading_batch(
+        const ShaderGroup&          shader_group,
+        const ShadingPoint* const*  shading_points,
+        const size_t                shading_point_count) const;
+
     void execute_osl_subsurface(
         const ShaderGroup&          shader_group,
         const ShadingPoint&         shading_point) const;
@@ -182,6 +193,11 @@ inline foundation::Arena& ShadingContext::get_arena() const
     return m_arena;
 }
 
+inline OSLShaderGroupExec& ShadingContext::get_osl_shadergroup_exec() const
+{
+    return m_shadergroup_exec;
+}
+
 inline size_t ShadingContext::get_thread_index() const
 {
     return m_thread_index;
@@ -121,6 +121,11 @@ bool ShadingEngine::shade_hit_point(
     // Retrieve the material of the intersected surface.
     const Material* material = shading_point.get_material();
 
+    // Let the background shader group optimizer know that this shader group is visible.
+    if (material != nullptr &&
+        material->get_render_data().m_pending_shader_group != nullptr)
+        material->get_render_data().m_pending_shader_group->record_use();
+
     if (material != nullptr &&
         material->get_render_data().m_shader_group != nullptr)
     {
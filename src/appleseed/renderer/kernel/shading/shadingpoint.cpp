@@ -131,7 +131,7 @@ void ShadingPoint::flip_side()
     if (m_members & HasShadingBasis)
     {
         // todo: add a more efficient flip() method to foundation::Basis.
-        m_shading_basis = Basis3d(
+        m_shading_basis = SBasis3(
             -m_shading_basis.get_normal(),
             -m_shading_basis.get_tangent_u(),
              m_shading_basis.get_tangent_v());
@@ -164,8 +164,13 @@ void ShadingPoint::fetch_source_geometry() const
     m_object_instance = m_assembly->object_instances().get_by_index(m_object_instance_index);
     assert(m_object_instance);
 
-    // Retrieve the object.
+    // Retrieve the object, or the proxy that was intersected in its place.
     m_object = &m_object_instance->get_object();
+    if (m_primitive_type == PrimitiveTriangle && (m_ray.m_flags & VisibilityFlags::ProxyRay))
+    {
+        if (Object* proxy_object = m_object_instance->get_proxy_object())
+            m_object = proxy_object;
+    }
 
     // Fetch primitive-specific geometry.
     switch (m_primitive_type)
@@ -201,7 +206,7 @@ void ShadingPoint::fetch_triangle_source_geometry() const
     const GScalar one_minus_frac = GScalar(1.0) - frac;
 
     // Retrieve the triangle.
-    const Triangle& triangle = tess.m_primitives[m_primitive_index];
+    const Triangle triangle = tess.get_primitive(m_primitive_index);
     assert(triangle.m_v0 != Triangle::None);
     assert(triangle.m_v1 != Triangle::None);
     assert(triangle.m_v2 != Triangle::None);
@@ -269,9 +274,9 @@ void ShadingPoint::fetch_triangle_source_geometry() const
             // Fetch vertex normals from previous pose.
             if (base_index == 0)
             {
-                m_n0 = tess.m_vertex_normals[triangle.m_n0];
-                m_n1 = tess.m_vertex_normals[triangle.m_n1];
-                m_n2 = tess.m_vertex_normals[triangle.m_n2];
+                m_n0 = tess.get_vertex_normal(triangle.m_n0);
+                m_n1 = tess.get_vertex_normal(triangle.m_n1);
+                m_n2 = tess.get_vertex_normal(triangle.m_n2);
             }
             else
             {
@@ -296,9 +301,9 @@ void ShadingPoint::fetch_triangle_source_geometry() const
         }
         else
         {
-            m_n0 = tess.m_vertex_normals[triangle.m_n0];
-            m_n1 = tess.m_vertex_normals[triangle.m_n1];
-            m_n2 = tess.m_vertex_normals[triangle.m_n2];
+            m_n0 = tess.get_vertex_normal(triangle.m_n0);
+            m_n1 = tess.get_vertex_normal(triangle.m_n1);
+            m_n2 = tess.get_vertex_normal(triangle.m_n2);
         }
 
         assert(is_normalized(m_n0));
@@ -807,7 +812,7 @@ void ShadingPoint::compute_shading_basis() const
     // Construct an orthonormal basis.
     const Vector3d t = normalize(cross(tangent, sn));
     const Vector3d s = normalize(cross(sn, t));
-    m_shading_basis.build(sn, s, t);
+    Basis3d shading_basis(sn, s, t);
 
     // Apply the basis modifier if the material has one.
     if (m_primitive_type == PrimitiveTriangle)
@@ -818,14 +823,16 @@ void ShadingPoint::compute_shading_basis() const
             const Material::RenderData& material_data = material->get_render_data();
             if (material_data.m_basis_modifier)
             {
-                m_shading_basis =
+                shading_basis =
                     material_data.m_basis_modifier->modify(
                         *m_texture_cache,
-                        m_shading_basis,
+                        shading_basis,
                         *this);
             }
         }
     }
+
+    m_shading_basis = SBasis3(shading_basis);
 }
 
 void ShadingPoint::compute_world_space_triangle_vertices() const
@@ -856,7 +863,7 @@ void ShadingPoint::compute_world_space_point_velocity() const
         const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
 
         // Retrieve the triangle.
-        const Triangle& triangle = tess.m_primitives[m_primitive_index];
+        const Triangle triangle = tess.get_primitive(m_primitive_index);
         assert(triangle.m_v0 != Triangle::None);
         assert(triangle.m_v1 != Triangle::None);
         assert(triangle.m_v2 != Triangle::None);
@@ -890,6 +897,15 @@ void ShadingPoint::compute_world_space_point_velocity() const
     p0 = obj_instance_transform.point_to_parent(p0);
     p1 = obj_instance_transform.point_to_parent(p1);
 
+    // Transform positions to point instancer space.
+    if (m_point_instancer && m_assembly_instance_transform_seq->size() > 1)
+    {
+        const Transformd point_instance_transform =
+            m_point_instancer->get_instance_transform(m_point_instance_index);
+        p0 = point_instance_transform.point_to_parent(p0);
+        p1 = point_instance_transform.point_to_parent(p1);
+    }
+
     // Transform positions to world space.
     if (m_assembly_instance_transform_seq->size() > 1)
     {
@@ -1017,8 +1033,13 @@ void ShadingPoint::initialize_osl_shader_globals(
         m_shader_globals.P = Vector3f(get_point());
         m_shader_globals.I = Vector3f(ray.m_dir);
 
+        const bool assembly_instance_swaps_handedness =
+            m_point_instancer
+                ? m_assembly_instance_transform.swaps_handedness()
+                : m_assembly_instance_transform_seq->swaps_handedness(m_assembly_instance_transform);
+
         m_shader_globals.flipHandedness =
-            m_assembly_instance_transform_seq->swaps_handedness(m_assembly_instance_transform) !=
+            assembly_instance_swaps_handedness !=
             get_object_instance().transform_swaps_handedness() ? 1 : 0;
 
         // Surface position and incident ray direction differentials.
@@ -1095,6 +1116,8 @@ void ShadingPoint::initialize_osl_shader_globals(
 
         // Transformations.
         m_obj_transform_info.m_assembly_instance_transform = m_assembly_instance_transform_seq;
+        m_obj_transform_info.m_point_instancer = m_point_instancer;
+        m_obj_transform_info.m_point_instance_index = m_point_instance_index;
         m_obj_transform_info.m_object_instance_transform = &m_object_instance->get_transform();
         m_shader_globals.object2common = reinterpret_cast<OSL::TransformationPtr>(&m_obj_transform_info);
         m_shader_globals.shader2common = nullptr;
@@ -1125,6 +1148,14 @@ bool ShadingPoint::OSLObjectTransformInfo::is_animated() const
     return !m_assembly_instance_transform->empty();
 }
 
+Transformd ShadingPoint::OSLObjectTransformInfo::get_point_instance_transform() const
+{
+    return
+        m_point_instancer
+            ? m_point_instancer->get_instance_transform(m_point_instance_index)
+            : Transformd::identity();
+}
+
 OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_transform() const
 {
     assert(!is_animated());
@@ -1132,6 +1163,7 @@ OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_transform() const
     const Transformd& assembly_xform = m_assembly_instance_transform->get_earliest_transform();
     const Transformd::MatrixType m(
         m_object_instance_transform->get_local_to_parent() *
+        get_point_instance_transform().get_local_to_parent() *
         assembly_xform.get_local_to_parent());
 
     return Matrix4f(m);
@@ -1142,6 +1174,7 @@ OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_transform(const float t)
     const Transformd assembly_xform = m_assembly_instance_transform->evaluate(t);
     const Transformd::MatrixType m(
         m_object_instance_transform->get_local_to_parent() *
+        get_point_instance_transform().get_local_to_parent() *
         assembly_xform.get_local_to_parent());
 
     return Matrix4f(m);
@@ -1154,6 +1187,7 @@ OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_inverse_transform() cons
     const Transformd& assembly_xform = m_assembly_instance_transform->get_earliest_transform();
     const Transformd::MatrixType m(
         m_object_instance_transform->get_parent_to_local() *
+        get_point_instance_transform().get_parent_to_local() *
         assembly_xform.get_parent_to_local());
 
     return Matrix4f(m);
@@ -1164,6 +1198,7 @@ OSL::Matrix44 ShadingPoint::OSLObjectTransformInfo::get_inverse_transform(const
     const Transformd assembly_xform = m_assembly_instance_transform->evaluate(t);
     const Transformd::MatrixType m(
         m_object_instance_transform->get_parent_to_local() *
+        get_point_instance_transform().get_parent_to_local() *
         assembly_xform.get_parent_to_local());
 
     return Matrix4f(m);
@@ -1197,6 +1232,8 @@ void PoisonImpl<renderer::ShadingPoint>::do_poison(renderer::ShadingPoint& point
     always_poison(point.m_assembly_instance);
     always_poison(point.m_assembly_instance_transform);
     always_poison(point.m_assembly_instance_transform_seq);
+    always_poison(point.m_point_instancer);
+    always_poison(point.m_point_instance_index);
     always_poison(point.m_object_instance_index);
     always_poison(point.m_primitive_index);
     always_poison(point.m_triangle_support_plane);
@@ -1216,21 +1253,12 @@ void PoisonImpl<renderer::ShadingPoint>::do_poison(renderer::ShadingPoint& point
     always_poison(point.m_n0);
     always_poison(point.m_n1);
     always_poison(point.m_n2);
-    always_poison(point.m_t0);
-    always_poison(point.m_t1);
-    always_poison(point.m_t2);
 
     always_poison(point.m_uv);
-    always_poison(point.m_duvdx);
-    always_poison(point.m_duvdy);
     always_poison(point.m_point);
     always_poison(point.m_biased_point);
     always_poison(point.m_dpdu);
     always_poison(point.m_dpdv);
-    always_poison(point.m_dndu);
-    always_poison(point.m_dndv);
-    always_poison(point.m_dpdx);
-    always_poison(point.m_dpdy);
     always_poison(point.m_geometric_normal);
     always_poison(point.m_original_shading_normal);
     always_poison(point.m_shading_basis);
@@ -1238,17 +1266,33 @@ void PoisonImpl<renderer::ShadingPoint>::do_poison(renderer::ShadingPoint& point
     always_poison(point.m_v0_w);
     always_poison(point.m_v1_w);
     always_poison(point.m_v2_w);
-    always_poison(point.m_point_velocity);
     always_poison(point.m_material);
     always_poison(point.m_opposite_material);
     always_poison(point.m_alpha);
-    always_poison(point.m_color);
 
     always_poison(point.m_asm_geo_normal);
     always_poison(point.m_front_point);
     always_poison(point.m_back_point);
 
+    always_poison(point.m_t0);
+    always_poison(point.m_t1);
+    always_poison(point.m_t2);
+    always_poison(point.m_duvdx);
+    always_poison(point.m_duvdy);
+    always_poison(point.m_dndu);
+    always_poison(point.m_dndv);
+    always_poison(point.m_dpdx);
+    always_poison(point.m_dpdy);
+    always_poison(point.m_point_velocity);
+    always_poison(point.m_color);
+
+    always_poison(point.m_surface_shader_diffuse);
+    always_poison(point.m_surface_shader_glossy);
+    always_poison(point.m_surface_shader_emission);
+
     always_poison(point.m_obj_transform_info.m_assembly_instance_transform);
+    always_poison(point.m_obj_transform_info.m_point_instancer);
+    always_poison(point.m_obj_transform_info.m_point_instance_index);
     always_poison(point.m_obj_transform_info.m_object_instance_transform);
 
     always_poison(point.m_osl_trace_data.m_traced);
@@ -1295,10 +1339,7 @@ void PoisonImpl<renderer::ShadingPoint>::do_poison(renderer::ShadingPoint& point
     always_poison(point.m_shader_globals.raytype);
     always_poison(point.m_shader_globals.flipHandedness);
     always_poison(point.m_shader_globals.backfacing);
-
-    always_poison(point.m_surface_shader_diffuse);
-    always_poison(point.m_surface_shader_glossy);
-    always_poison(point.m_surface_shader_emission);
+    always_poison(point.m_osl_batch_shader_group);
 }
 
 }   // namespace foundation
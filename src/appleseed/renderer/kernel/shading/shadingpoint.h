@@ -41,6 +41,7 @@
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/containers.h"
 #include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/pointinstancer.h"
 #include "renderer/modeling/scene/visibilityflags.h"
 
 // appleseed.foundation headers.
@@ -183,11 +184,13 @@ class ShadingPoint
     // Return the (possibly modified) world space shading normal at the intersection point.
     // The shading normal is always in the same hemisphere as the geometric normal but it is
     // not necessarily facing the incoming ray, i.e. dot(ray_dir, shading_normal) may be negative.
-    const foundation::Vector3d& get_shading_normal() const;
+    // It is stored in single precision when APPLESEED_WITH_SINGLE_PRECISION_SHADING is defined.
+    const SVector3& get_shading_normal() const;
 
     // Set/get the world space orthonormal basis around the (possibly modified) shading normal.
+    // The basis is stored in single precision when APPLESEED_WITH_SINGLE_PRECISION_SHADING is defined.
     void set_shading_basis(const foundation::Basis3d& basis) const;
-    const foundation::Basis3d& get_shading_basis() const;
+    const SBasis3& get_shading_basis() const;
 
     // Return the side of the surface that was hit.
     ObjectInstance::Side get_side() const;
@@ -215,8 +218,18 @@ class ShadingPoint
     const AssemblyInstance& get_assembly_instance() const;
 
     // Return the transform at ray time of the assembly instance that was hit.
+    // When a point instance was hit, this is the transform of the point instance
+    // composed with the one of its point instancer.
     const foundation::Transformd& get_assembly_instance_transform() const;
 
+    // Return the point instancer that was hit, or nullptr if a regular assembly
+    // instance was hit. In the former case, get_assembly_instance() returns the
+    // assembly instance standing for the prototype of the hit point instance.
+    const PointInstancer* get_point_instancer() const;
+
+    // Return the index of the point instance that was hit.
+    size_t get_point_instance_index() const;
+
     // Return the assembly that was hit.
     const Assembly& get_assembly() const;
 
@@ -255,7 +268,11 @@ class ShadingPoint
         OSL::Matrix44 get_inverse_transform() const;
         OSL::Matrix44 get_inverse_transform(const float t) const;
 
+        foundation::Transformd get_point_instance_transform() const;
+
         const TransformSequence*        m_assembly_instance_transform;
+        const PointInstancer*           m_point_instancer;
+        size_t                          m_point_instance_index;
         const foundation::Transformd*   m_object_instance_transform;
     };
 
@@ -272,13 +289,17 @@ class ShadingPoint
     };
 
   private:
+    friend class AssemblyLeafPacketVisitor;
     friend class AssemblyLeafProbeVisitor;
     friend class AssemblyLeafVisitor;
     friend class CurveLeafVisitor;
+    friend class EmbreeInstanceScene;
     friend class EmbreeScene;
+    friend class GPUScene;
     friend class Intersector;
     friend class NPRSurfaceShaderHelper;
     friend class OSLShaderGroupExec;
+    friend class PrimaryHitCache;
     friend class RendererServices;
     friend class ShadingPointBuilder;
     friend class TriangleLeafVisitor;
@@ -287,6 +308,12 @@ class ShadingPoint
     //
     // Make sure to update `PoisonImpl<>::do_poison()` in shadinpoint.cpp when adding new data members.
     //
+    // Data members are split in two groups: the hot data that is accessed for every
+    // shading point (intersection, BSDF sampling, spawning of secondary rays) comes
+    // first and is laid out contiguously, while the cold data that only a few code
+    // paths ever compute (texture filtering, OSL, NPR, motion blur) is kept at the
+    // end of the object so that it doesn't dilute the cache lines of the hot data.
+    //
 
     // Context.
     TextureCache*                       m_texture_cache;
@@ -299,6 +326,8 @@ class ShadingPoint
     const AssemblyInstance*             m_assembly_instance;                // hit assembly instance
     foundation::Transformd              m_assembly_instance_transform;      // transform of the hit assembly instance at ray time
     const TransformSequence*            m_assembly_instance_transform_seq;  // transform sequence of the hit assembly instance.
+    const PointInstancer*               m_point_instancer;                  // hit point instancer, if any
+    size_t                              m_point_instance_index;             // index of the hit point instance
     size_t                              m_object_instance_index;            // index of the object instance that was hit
     size_t                              m_primitive_index;                  // index of the hit primitive
     TriangleSupportPlaneType            m_triangle_support_plane;           // support plane of the hit triangle
@@ -323,7 +352,8 @@ class ShadingPoint
         HasAlpha                        = 1UL << 14,
         HasPerVertexColor               = 1UL << 15,
         HasScreenSpaceDerivatives       = 1UL << 16,
-        HasOSLShaderGlobals             = 1UL << 17
+        HasOSLShaderGlobals             = 1UL << 17,
+        HasOSLBatchResults              = 1UL << 18
     };
     mutable foundation::uint32          m_members;
 
@@ -335,46 +365,53 @@ class ShadingPoint
     mutable GVector2                    m_v0_uv, m_v1_uv, m_v2_uv;      // texture coordinates from UV set #0 at triangle vertices
     mutable GVector3                    m_v0, m_v1, m_v2;               // object instance space triangle vertices
     mutable GVector3                    m_n0, m_n1, m_n2;               // object instance space triangle vertex normals
-    mutable GVector3                    m_t0, m_t1, m_t2;               // object instance space triangle vertex tangents
 
     // On-demand intersection results (derived from primary intersection results).
     mutable foundation::Vector2f        m_uv;                           // texture coordinates from UV set #0
-    mutable foundation::Vector2f        m_duvdx;                        // screen space partial derivative of the texture coords wrt. X
-    mutable foundation::Vector2f        m_duvdy;                        // screen space partial derivative of the texture coords wrt. Y
     mutable foundation::Vector3d        m_point;                        // world space intersection point
     mutable foundation::Vector3d        m_biased_point;                 // world space intersection point with per-object-instance bias applied
     mutable foundation::Vector3d        m_dpdu;                         // world space partial derivative of the intersection point wrt. U
     mutable foundation::Vector3d        m_dpdv;                         // world space partial derivative of the intersection point wrt. V
-    mutable foundation::Vector3d        m_dndu;                         // world space partial derivative of the intersection normal wrt. U
-    mutable foundation::Vector3d        m_dndv;                         // world space partial derivative of the intersection normal wrt. V
-    mutable foundation::Vector3d        m_dpdx;                         // screen space partial derivative of the intersection point wrt. X
-    mutable foundation::Vector3d        m_dpdy;                         // screen space partial derivative of the intersection point wrt. Y
     mutable foundation::Vector3d        m_geometric_normal;             // world space geometric normal, unit-length
     mutable foundation::Vector3d        m_original_shading_normal;      // original world space shading normal, unit-length
-    mutable foundation::Basis3d         m_shading_basis;                // world space orthonormal basis around shading normal
+    mutable SBasis3                     m_shading_basis;                // world space orthonormal basis around shading normal
     mutable ObjectInstance::Side        m_side;                         // side of the surface that was hit
     mutable foundation::Vector3d        m_v0_w, m_v1_w, m_v2_w;         // world space triangle vertices
-    mutable foundation::Vector3d        m_point_velocity;               // world space point velocity
     mutable const Material*             m_material;                     // material at intersection point
     mutable const Material*             m_opposite_material;            // opposite material at intersection point
     mutable Alpha                       m_alpha;                        // opacity at intersection point
-    mutable foundation::Color3f         m_color;                        // per-vertex interpolated color at intersection point
 
     // Data required to avoid self-intersections.
     mutable foundation::Vector3d        m_asm_geo_normal;               // assembly instance space geometric normal to hit triangle
     mutable foundation::Vector3d        m_front_point;                  // hit point refined to front, in assembly instance space
     mutable foundation::Vector3d        m_back_point;                   // hit point refined to back, in assembly instance space
 
-    // OSL-related data.
-    mutable OSLObjectTransformInfo      m_obj_transform_info;
-    mutable OSLTraceData                m_osl_trace_data;
-    mutable OSL::ShaderGlobals          m_shader_globals;
+    //
+    // Cold data: everything below is only touched by the code paths that need it.
+    //
+
+    // Rarely used source geometry and on-demand intersection results.
+    mutable GVector3                    m_t0, m_t1, m_t2;               // object instance space triangle vertex tangents
+    mutable foundation::Vector2f        m_duvdx;                        // screen space partial derivative of the texture coords wrt. X
+    mutable foundation::Vector2f        m_duvdy;                        // screen space partial derivative of the texture coords wrt. Y
+    mutable foundation::Vector3d        m_dndu;                         // world space partial derivative of the intersection normal wrt. U
+    mutable foundation::Vector3d        m_dndv;                         // world space partial derivative of the intersection normal wrt. V
+    mutable foundation::Vector3d        m_dpdx;                         // screen space partial derivative of the intersection point wrt. X
+    mutable foundation::Vector3d        m_dpdy;                         // screen space partial derivative of the intersection point wrt. Y
+    mutable foundation::Vector3d        m_point_velocity;               // world space point velocity
+    mutable foundation::Color3f         m_color;                        // per-vertex interpolated color at intersection point
 
     // NPR-related data.
     mutable foundation::Color3f         m_surface_shader_diffuse;
     mutable foundation::Color3f         m_surface_shader_glossy;
     mutable foundation::Color3f         m_surface_shader_emission;
 
+    // OSL-related data.
+    mutable OSLObjectTransformInfo      m_obj_transform_info;
+    mutable OSLTraceData                m_osl_trace_data;
+    mutable OSL::ShaderGlobals          m_shader_globals;
+    mutable const ShaderGroup*          m_osl_batch_shader_group;       // shader group whose batched results are held in m_shader_globals.Ci
+
     // Fetch and cache the source geometry.
     void cache_source_geometry() const;
 
@@ -430,6 +467,8 @@ inline ShadingPoint::ShadingPoint(const ShadingPoint& rhs)
   , m_assembly_instance(rhs.m_assembly_instance)
   , m_assembly_instance_transform(rhs.m_assembly_instance_transform)
   , m_assembly_instance_transform_seq(rhs.m_assembly_instance_transform_seq)
+  , m_point_instancer(rhs.m_point_instancer)
+  , m_point_instance_index(rhs.m_point_instance_index)
   , m_object_instance_index(rhs.m_object_instance_index)
   , m_primitive_index(rhs.m_primitive_index)
   , m_triangle_support_plane(rhs.m_triangle_support_plane)
@@ -447,6 +486,8 @@ inline ShadingPoint& ShadingPoint::operator=(const ShadingPoint& rhs)
     m_assembly_instance = rhs.m_assembly_instance;
     m_assembly_instance_transform = rhs.m_assembly_instance_transform;
     m_assembly_instance_transform_seq = rhs.m_assembly_instance_transform_seq;
+    m_point_instancer = rhs.m_point_instancer;
+    m_point_instance_index = rhs.m_point_instance_index;
     m_object_instance_index = rhs.m_object_instance_index;
     m_primitive_index = rhs.m_primitive_index;
     m_triangle_support_plane = rhs.m_triangle_support_plane;
@@ -459,6 +500,8 @@ APPLESEED_FORCE_INLINE void ShadingPoint::clear()
     m_texture_cache = nullptr;
     m_scene = nullptr;
     m_primitive_type = PrimitiveNone;
+    m_point_instancer = nullptr;
+    m_point_instance_index = 0;
     m_members = 0;
 }
 
@@ -724,7 +767,7 @@ inline const foundation::Vector3d& ShadingPoint::get_original_shading_normal() c
     return m_original_shading_normal;
 }
 
-inline const foundation::Vector3d& ShadingPoint::get_shading_normal() const
+inline const SVector3& ShadingPoint::get_shading_normal() const
 {
     return get_shading_basis().get_normal();
 }
@@ -732,12 +775,12 @@ inline const foundation::Vector3d& ShadingPoint::get_shading_normal() const
 inline void ShadingPoint::set_shading_basis(const foundation::Basis3d& basis) const
 {
     assert(hit_surface());
-    m_shading_basis = basis;
+    m_shading_basis = SBasis3(basis);
     m_members |= HasShadingBasis;
     m_members &= ~HasScreenSpaceDerivatives;
 }
 
-inline const foundation::Basis3d& ShadingPoint::get_shading_basis() const
+inline const SBasis3& ShadingPoint::get_shading_basis() const
 {
     assert(hit_surface());
 
@@ -855,6 +898,16 @@ inline const foundation::Transformd& ShadingPoint::get_assembly_instance_transfo
     return m_assembly_instance_transform;
 }
 
+inline const PointInstancer* ShadingPoint::get_point_instancer() const
+{
+    return m_point_instancer;
+}
+
+inline size_t ShadingPoint::get_point_instance_index() const
+{
+    return m_point_instance_index;
+}
+
 inline const Assembly& ShadingPoint::get_assembly() const
 {
     assert(hit_surface());
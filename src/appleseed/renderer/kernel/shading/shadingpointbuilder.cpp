@@ -84,7 +84,7 @@ void ShadingPointBuilder::set_side(const ObjectInstance::Side side)
 
 void ShadingPointBuilder::set_shading_basis(const Basis3d& basis)
 {
-    m_shading_point.m_shading_basis = basis;
+    m_shading_point.m_shading_basis = SBasis3(basis);
     m_shading_point.m_members |= ShadingPoint::HasShadingBasis;
 }
 
@@ -35,14 +35,19 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/compressedunitvector.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/attributeset.h"
 #include "foundation/utility/lazy.h"
+#include "foundation/utility/memory.h"
 #include "foundation/utility/numerictype.h"
 #include "foundation/utility/poolallocator.h"
 
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <limits>
 #include <vector>
 
 namespace renderer
@@ -51,6 +56,14 @@ namespace renderer
 //
 // A tessellation as a collection of polygonal primitives.
 //
+// When appleseed is built with APPLESEED_WITH_COMPRESSED_NORMALS, vertex normals,
+// vertex tangents and their motion poses are stored as 32-bit octahedral unit
+// vectors instead of three scalars, and decoded when they are accessed.
+//
+// Once a tessellation is complete, compact() may additionally switch primitives
+// to 16-bit indices and texture coordinates to 16-bit quantized values, when the
+// tessellation allows it. Primitives must then be read with get_primitive().
+//
 
 template <typename Primitive>
 class StaticTessellation
@@ -60,15 +73,27 @@ class StaticTessellation
     // Primitive type.
     typedef Primitive PrimitiveType;
 
-    // Vertex and primitive array types.
+    // Vertex and primitive array types. They are allocated with foundation::aligned_malloc()
+    // so that large tessellations can be placed on huge pages.
     // todo: use paged arrays?
-    typedef std::vector<GVector3> VectorArray;
-    typedef std::vector<PrimitiveType> PrimitiveArray;
+    typedef std::vector<GVector3, foundation::AlignedAllocator<GVector3>> VectorArray;
+    typedef std::vector<PrimitiveType, foundation::AlignedAllocator<PrimitiveType>> PrimitiveArray;
+    typedef typename PrimitiveType::CompactType CompactPrimitiveType;
+    typedef std::vector<CompactPrimitiveType, foundation::AlignedAllocator<CompactPrimitiveType>> CompactPrimitiveArray;
+
+    // Storage type of unit vectors (vertex normals and tangents).
+#ifdef APPLESEED_WITH_COMPRESSED_NORMALS
+    typedef foundation::CompressedUnitVector UnitVectorType;
+#else
+    typedef GVector3 UnitVectorType;
+#endif
+    typedef std::vector<UnitVectorType, foundation::AlignedAllocator<UnitVectorType>> UnitVectorArray;
 
     // Primary features.
     VectorArray                 m_vertices;
-    VectorArray                 m_vertex_normals;
+    UnitVectorArray             m_vertex_normals;
     PrimitiveArray              m_primitives;
+    CompactPrimitiveArray       m_compact_primitives;       // replaces m_primitives after compact()
 
     // Additional attributes.
     // todo: we could live with a single attribute set with multiple channels.
@@ -82,6 +107,34 @@ class StaticTessellation
     // Constructor.
     StaticTessellation();
 
+    // Replace the contents of this tessellation by a copy of another tessellation.
+    void copy_from(const StaticTessellation& source);
+
+    // Access primitives, whether or not they are stored in compact form.
+    size_t get_primitive_count() const;
+    PrimitiveType get_primitive(const size_t index) const;
+
+    // Store primitives with 16-bit indices if every index fits, and texture coordinates
+    // as 16-bit values quantized over their bounding box if its extent is small enough.
+    // m_primitives is empty while primitives are compacted. Quantization of texture
+    // coordinates is lossy. Inserting texture coordinates expands them back.
+    void compact();
+
+    // Go back to storing primitives and texture coordinates at full precision.
+    void expand();
+
+    // Return true if primitives are stored in compact form.
+    bool has_compact_primitives() const;
+
+    // Return true if texture coordinates are stored quantized.
+    bool has_quantized_tex_coords() const;
+
+    // Insert and access vertex normals.
+    void reserve_vertex_normals(const size_t count);
+    size_t push_vertex_normal(const GVector3& normal);      // the normal must be unit-length
+    size_t get_vertex_normal_count() const;
+    GVector3 get_vertex_normal(const size_t index) const;
+
     // Insert and access texture coordinates.
     void reserve_tex_coords(const size_t count);
     size_t push_tex_coords(const GVector2& uv);
@@ -143,7 +196,19 @@ class StaticTessellation
     // Compute the local space bounding box of the tessellation over the shutter interval.
     GAABB3 compute_local_bbox() const;
 
+    // Return the size (in bytes) of this object in memory.
+    size_t get_memory_size() const;
+
   private:
+    typedef foundation::Vector<foundation::uint16, 2> QuantizedTexCoords;
+
+    // Largest extent of texture coordinates, along u or v, that is quantized.
+    static const size_t MaxQuantizedTexCoordsExtent = 4;
+
+    std::vector<QuantizedTexCoords>     m_quantized_uv_0;
+    GVector2                            m_quantized_uv_0_origin;
+    GVector2                            m_quantized_uv_0_step;
+
     foundation::AttributeSet::ChannelID m_uv_0_cid;         // UV coordinates set #0
     foundation::AttributeSet::ChannelID m_tangents_cid;     // per-vertex tangent vectors
     foundation::AttributeSet::ChannelID m_ms_count_cid;     // motion segment count
@@ -153,6 +218,15 @@ class StaticTessellation
 
     void create_uv_0_attribute();
     void create_tangents_attribute();
+
+    void compact_primitives();
+    void expand_primitives();
+    void quantize_tex_coords();
+    void dequantize_tex_coords();
+
+    static foundation::AttributeSet::ChannelID create_unit_vector_channel(
+        foundation::AttributeSet&   attributes,
+        const char*                 name);
 };
 
 // Specialization of the StaticTessellation class for triangles.
@@ -186,12 +260,113 @@ inline StaticTessellation<Primitive>::StaticTessellation()
 {
 }
 
+template <typename Primitive>
+void StaticTessellation<Primitive>::copy_from(const StaticTessellation& source)
+{
+    m_vertices = source.m_vertices;
+    m_vertex_normals = source.m_vertex_normals;
+    m_primitives = source.m_primitives;
+    m_compact_primitives = source.m_compact_primitives;
+
+    m_tessellation_attributes.copy_from(source.m_tessellation_attributes);
+    m_vertex_attributes.copy_from(source.m_vertex_attributes);
+    m_vertex_normal_attributes.copy_from(source.m_vertex_normal_attributes);
+    m_vertex_tangent_attributes.copy_from(source.m_vertex_tangent_attributes);
+    m_vertex_tangent_poses.copy_from(source.m_vertex_tangent_poses);
+    m_primitive_attributes.copy_from(source.m_primitive_attributes);
+
+    m_quantized_uv_0 = source.m_quantized_uv_0;
+    m_quantized_uv_0_origin = source.m_quantized_uv_0_origin;
+    m_quantized_uv_0_step = source.m_quantized_uv_0_step;
+
+    m_uv_0_cid = source.m_uv_0_cid;
+    m_tangents_cid = source.m_tangents_cid;
+    m_ms_count_cid = source.m_ms_count_cid;
+    m_vp_cid = source.m_vp_cid;
+    m_vnp_cid = source.m_vnp_cid;
+    m_vtp_cid = source.m_vtp_cid;
+}
+
+template <typename Primitive>
+inline size_t StaticTessellation<Primitive>::get_primitive_count() const
+{
+    return m_primitives.size() + m_compact_primitives.size();
+}
+
+template <typename Primitive>
+inline Primitive StaticTessellation<Primitive>::get_primitive(const size_t index) const
+{
+    if (!m_compact_primitives.empty())
+    {
+        assert(index < m_compact_primitives.size());
+        return m_compact_primitives[index].expand();
+    }
+
+    assert(index < m_primitives.size());
+    return m_primitives[index];
+}
+
+template <typename Primitive>
+void StaticTessellation<Primitive>::compact()
+{
+    compact_primitives();
+    quantize_tex_coords();
+}
+
+template <typename Primitive>
+void StaticTessellation<Primitive>::expand()
+{
+    expand_primitives();
+    dequantize_tex_coords();
+}
+
+template <typename Primitive>
+inline bool StaticTessellation<Primitive>::has_compact_primitives() const
+{
+    return !m_compact_primitives.empty();
+}
+
+template <typename Primitive>
+inline bool StaticTessellation<Primitive>::has_quantized_tex_coords() const
+{
+    return !m_quantized_uv_0.empty();
+}
+
+template <typename Primitive>
+inline void StaticTessellation<Primitive>::reserve_vertex_normals(const size_t count)
+{
+    m_vertex_normals.reserve(count);
+}
+
+template <typename Primitive>
+inline size_t StaticTessellation<Primitive>::push_vertex_normal(const GVector3& normal)
+{
+    const size_t index = m_vertex_normals.size();
+    m_vertex_normals.push_back(UnitVectorType(normal));
+    return index;
+}
+
+template <typename Primitive>
+inline size_t StaticTessellation<Primitive>::get_vertex_normal_count() const
+{
+    return m_vertex_normals.size();
+}
+
+template <typename Primitive>
+inline GVector3 StaticTessellation<Primitive>::get_vertex_normal(const size_t index) const
+{
+    assert(index < m_vertex_normals.size());
+    return GVector3(m_vertex_normals[index]);
+}
+
 template <typename Primitive>
 inline void StaticTessellation<Primitive>::reserve_tex_coords(const size_t count)
 {
     if (m_uv_0_cid == foundation::AttributeSet::InvalidChannelID)
         create_uv_0_attribute();
 
+    dequantize_tex_coords();
+
     m_vertex_attributes.reserve_attributes(m_uv_0_cid, count);
 }
 
@@ -201,6 +376,8 @@ inline size_t StaticTessellation<Primitive>::push_tex_coords(const GVector2& uv)
     if (m_uv_0_cid == foundation::AttributeSet::InvalidChannelID)
         create_uv_0_attribute();
 
+    dequantize_tex_coords();
+
     return m_vertex_attributes.push_attribute(m_uv_0_cid, uv);
 }
 
@@ -210,6 +387,9 @@ inline size_t StaticTessellation<Primitive>::get_tex_coords_count() const
     if (m_uv_0_cid == foundation::AttributeSet::InvalidChannelID)
         return 0;
 
+    if (!m_quantized_uv_0.empty())
+        return m_quantized_uv_0.size();
+
     return m_vertex_attributes.get_attribute_count(m_uv_0_cid);
 }
 
@@ -218,6 +398,18 @@ inline GVector2 StaticTessellation<Primitive>::get_tex_coords(const size_t index
 {
     assert(m_uv_0_cid != foundation::AttributeSet::InvalidChannelID);
 
+    if (!m_quantized_uv_0.empty())
+    {
+        assert(index < m_quantized_uv_0.size());
+
+        const QuantizedTexCoords& q = m_quantized_uv_0[index];
+
+        return
+            GVector2(
+                m_quantized_uv_0_origin[0] + q[0] * m_quantized_uv_0_step[0],
+                m_quantized_uv_0_origin[1] + q[1] * m_quantized_uv_0_step[1]);
+    }
+
     GVector2 uv;
     m_vertex_attributes.get_attribute(m_uv_0_cid, index, &uv);
 
@@ -239,7 +431,7 @@ inline size_t StaticTessellation<Primitive>::push_vertex_tangent(const GVector3&
     if (m_tangents_cid == foundation::AttributeSet::InvalidChannelID)
         create_tangents_attribute();
 
-    return m_vertex_attributes.push_attribute(m_tangents_cid, tangent);
+    return m_vertex_attributes.push_attribute(m_tangents_cid, UnitVectorType(tangent));
 }
 
 template <typename Primitive>
@@ -256,10 +448,10 @@ inline GVector3 StaticTessellation<Primitive>::get_vertex_tangent(const size_t i
 {
     assert(m_tangents_cid != foundation::AttributeSet::InvalidChannelID);
 
-    GVector3 tangent;
+    UnitVectorType tangent;
     m_vertex_attributes.get_attribute(m_tangents_cid, index, &tangent);
 
-    return tangent;
+    return GVector3(tangent);
 }
 
 template <typename Primitive>
@@ -359,16 +551,15 @@ inline void StaticTessellation<Primitive>::set_vertex_normal_pose(
     if (m_vnp_cid == foundation::AttributeSet::InvalidChannelID)
     {
         m_vnp_cid =
-            m_vertex_normal_attributes.create_channel(
-                "vertex_normal_poses",
-                foundation::NumericType::id<GVector3::ValueType>(),
-                3);
+            create_unit_vector_channel(
+                m_vertex_normal_attributes,
+                "vertex_normal_poses");
     }
 
     m_vertex_normal_attributes.set_attribute(
         m_vnp_cid,
         normal_index * motion_segment_count + motion_segment_index,
-        normal);
+        UnitVectorType(normal));
 }
 
 template <typename Primitive>
@@ -382,13 +573,13 @@ inline GVector3 StaticTessellation<Primitive>::get_vertex_normal_pose(
     const size_t motion_segment_count = get_motion_segment_count();
     assert(motion_segment_index < motion_segment_count);
 
-    GVector3 normal;
+    UnitVectorType normal;
     m_vertex_normal_attributes.get_attribute(
         m_vnp_cid,
         normal_index * motion_segment_count + motion_segment_index,
         &normal);
 
-    return normal;
+    return GVector3(normal);
 }
 
 template <typename Primitive>
@@ -415,16 +606,15 @@ inline void StaticTessellation<Primitive>::set_vertex_tangent_pose(
     if (m_vtp_cid == foundation::AttributeSet::InvalidChannelID)
     {
         m_vtp_cid =
-            m_vertex_tangent_poses.create_channel(
-                "vertex_tangent_poses",
-                foundation::NumericType::id<GVector3::ValueType>(),
-                3);
+            create_unit_vector_channel(
+                m_vertex_tangent_poses,
+                "vertex_tangent_poses");
     }
 
     m_vertex_tangent_poses.set_attribute(
         m_vtp_cid,
         tangent_index * motion_segment_count + motion_segment_index,
-        tangent);
+        UnitVectorType(tangent));
 }
 
 template <typename Primitive>
@@ -438,13 +628,13 @@ inline GVector3 StaticTessellation<Primitive>::get_vertex_tangent_pose(
     const size_t motion_segment_count = get_motion_segment_count();
     assert(motion_segment_index < motion_segment_count);
 
-    GVector3 tangent;
+    UnitVectorType tangent;
     m_vertex_tangent_poses.get_attribute(
         m_vtp_cid,
         tangent_index * motion_segment_count + motion_segment_index,
         &tangent);
 
-    return tangent;
+    return GVector3(tangent);
 }
 
 template <typename Primitive>
@@ -477,6 +667,129 @@ GAABB3 StaticTessellation<Primitive>::compute_local_bbox() const
     return bbox;
 }
 
+template <typename Primitive>
+size_t StaticTessellation<Primitive>::get_memory_size() const
+{
+    size_t mem_size = sizeof(*this);
+    mem_size += m_vertices.capacity() * sizeof(GVector3);
+    mem_size += m_vertex_normals.capacity() * sizeof(UnitVectorType);
+    mem_size += m_primitives.capacity() * sizeof(PrimitiveType);
+    mem_size += m_compact_primitives.capacity() * sizeof(CompactPrimitiveType);
+    mem_size += m_quantized_uv_0.capacity() * sizeof(QuantizedTexCoords);
+
+    // The attribute sets are embedded in this object: only count their channels.
+    mem_size += m_tessellation_attributes.get_memory_size() - sizeof(foundation::AttributeSet);
+    mem_size += m_vertex_attributes.get_memory_size() - sizeof(foundation::AttributeSet);
+    mem_size += m_vertex_normal_attributes.get_memory_size() - sizeof(foundation::AttributeSet);
+    mem_size += m_vertex_tangent_attributes.get_memory_size() - sizeof(foundation::AttributeSet);
+    mem_size += m_vertex_tangent_poses.get_memory_size() - sizeof(foundation::AttributeSet);
+    mem_size += m_primitive_attributes.get_memory_size() - sizeof(foundation::AttributeSet);
+
+    return mem_size;
+}
+
+template <typename Primitive>
+void StaticTessellation<Primitive>::compact_primitives()
+{
+    if (m_primitives.empty())
+        return;
+
+    for (const PrimitiveType& primitive : m_primitives)
+    {
+        if (!CompactPrimitiveType::is_representable(primitive))
+            return;
+    }
+
+    m_compact_primitives.reserve(m_primitives.size());
+
+    for (const PrimitiveType& primitive : m_primitives)
+        m_compact_primitives.push_back(CompactPrimitiveType(primitive));
+
+    foundation::clear_release_memory(m_primitives);
+}
+
+template <typename Primitive>
+void StaticTessellation<Primitive>::expand_primitives()
+{
+    if (m_compact_primitives.empty())
+        return;
+
+    m_primitives.reserve(m_compact_primitives.size());
+
+    for (const CompactPrimitiveType& primitive : m_compact_primitives)
+        m_primitives.push_back(primitive.expand());
+
+    foundation::clear_release_memory(m_compact_primitives);
+}
+
+template <typename Primitive>
+void StaticTessellation<Primitive>::quantize_tex_coords()
+{
+    if (!m_quantized_uv_0.empty())
+        return;
+
+    const size_t count = get_tex_coords_count();
+
+    if (count == 0)
+        return;
+
+    GVector2 uv_min(std::numeric_limits<GScalar>::max());
+    GVector2 uv_max(-std::numeric_limits<GScalar>::max());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const GVector2 uv = get_tex_coords(i);
+        uv_min = foundation::component_wise_min(uv_min, uv);
+        uv_max = foundation::component_wise_max(uv_max, uv);
+    }
+
+    const GVector2 extent = uv_max - uv_min;
+
+    // This also rejects NaN texture coordinates.
+    if (!(foundation::max_value(extent) <= GScalar(MaxQuantizedTexCoordsExtent)))
+        return;
+
+    const GScalar MaxQuantizedValue = GScalar(65535.0);
+
+    m_quantized_uv_0_origin = uv_min;
+    m_quantized_uv_0_step = extent / MaxQuantizedValue;
+
+    m_quantized_uv_0.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        GVector2 uv;
+        m_vertex_attributes.get_attribute(m_uv_0_cid, i, &uv);
+
+        for (size_t j = 0; j < 2; ++j)
+        {
+            m_quantized_uv_0[i][j] =
+                extent[j] > GScalar(0.0)
+                    ? static_cast<foundation::uint16>(
+                        (uv[j] - uv_min[j]) / extent[j] * MaxQuantizedValue + GScalar(0.5))
+                    : 0;
+        }
+    }
+
+    m_vertex_attributes.clear_attributes(m_uv_0_cid);
+}
+
+template <typename Primitive>
+void StaticTessellation<Primitive>::dequantize_tex_coords()
+{
+    if (m_quantized_uv_0.empty())
+        return;
+
+    const size_t count = m_quantized_uv_0.size();
+
+    m_vertex_attributes.reserve_attributes(m_uv_0_cid, count);
+
+    for (size_t i = 0; i < count; ++i)
+        m_vertex_attributes.push_attribute(m_uv_0_cid, get_tex_coords(i));
+
+    foundation::clear_release_memory(m_quantized_uv_0);
+}
+
 template <typename Primitive>
 void StaticTessellation<Primitive>::create_uv_0_attribute()
 {
@@ -491,10 +804,29 @@ template <typename Primitive>
 void StaticTessellation<Primitive>::create_tangents_attribute()
 {
     m_tangents_cid =
-        m_vertex_attributes.create_channel(
-            "tangents",
+        create_unit_vector_channel(
+            m_vertex_attributes,
+            "tangents");
+}
+
+template <typename Primitive>
+foundation::AttributeSet::ChannelID StaticTessellation<Primitive>::create_unit_vector_channel(
+    foundation::AttributeSet&       attributes,
+    const char*                     name)
+{
+#ifdef APPLESEED_WITH_COMPRESSED_NORMALS
+    return
+        attributes.create_channel(
+            name,
+            foundation::NumericType::id<foundation::int16>(),
+            2);
+#else
+    return
+        attributes.create_channel(
+            name,
             foundation::NumericType::id<GVector3::ValueType>(),
             3);
+#endif
 }
 
 }   // namespace renderer
@@ -0,0 +1,468 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "subdivisionsurface.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/object/triangle.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // A polygon mesh with face-varying texture coordinates.
+    //
+
+    struct PolygonMesh
+    {
+        size_t                      m_vertex_count;
+        vector<vector<GVector3>>    m_poses;            // vertex positions, then vertex poses of each motion segment
+        vector<uint32>              m_face_offsets;     // index of the first corner of each face, plus the total corner count
+        vector<uint32>              m_corner_vertices;
+        vector<GVector2>            m_corner_uvs;       // empty if the mesh has no texture coordinates
+        vector<uint32>              m_face_pas;         // primitive attribute index of each face
+    };
+
+    void load_polygon_mesh(const StaticTriangleTess& tess, PolygonMesh& mesh)
+    {
+        const size_t vertex_count = tess.m_vertices.size();
+        const size_t motion_segment_count = tess.get_motion_segment_count();
+        const size_t triangle_count = tess.get_primitive_count();
+        const bool has_uvs = tess.get_tex_coords_count() > 0;
+
+        mesh.m_vertex_count = vertex_count;
+
+        mesh.m_poses.resize(motion_segment_count + 1);
+        mesh.m_poses[0].assign(tess.m_vertices.begin(), tess.m_vertices.end());
+
+        for (size_t s = 0; s < motion_segment_count; ++s)
+        {
+            vector<GVector3>& pose = mesh.m_poses[s + 1];
+            pose.resize(vertex_count);
+
+            for (size_t v = 0; v < vertex_count; ++v)
+                pose[v] = tess.get_vertex_pose(v, s);
+        }
+
+        mesh.m_face_offsets.resize(triangle_count + 1);
+        mesh.m_corner_vertices.resize(triangle_count * 3);
+        mesh.m_face_pas.resize(triangle_count);
+
+        if (has_uvs)
+            mesh.m_corner_uvs.resize(triangle_count * 3);
+
+        for (size_t i = 0; i < triangle_count; ++i)
+        {
+            const Triangle triangle = tess.get_primitive(i);
+
+            mesh.m_face_offsets[i] = static_cast<uint32>(i * 3);
+            mesh.m_corner_vertices[i * 3 + 0] = triangle.m_v0;
+            mesh.m_corner_vertices[i * 3 + 1] = triangle.m_v1;
+            mesh.m_corner_vertices[i * 3 + 2] = triangle.m_v2;
+            mesh.m_face_pas[i] = triangle.m_pa;
+
+            if (has_uvs)
+            {
+                mesh.m_corner_uvs[i * 3 + 0] = triangle.m_a0 != Triangle::None ? tess.get_tex_coords(triangle.m_a0) : GVector2(0.0);
+                mesh.m_corner_uvs[i * 3 + 1] = triangle.m_a1 != Triangle::None ? tess.get_tex_coords(triangle.m_a1) : GVector2(0.0);
+                mesh.m_corner_uvs[i * 3 + 2] = triangle.m_a2 != Triangle::None ? tess.get_tex_coords(triangle.m_a2) : GVector2(0.0);
+            }
+        }
+
+        mesh.m_face_offsets[triangle_count] = static_cast<uint32>(triangle_count * 3);
+    }
+
+    //
+    // One step of Catmull-Clark subdivision.
+    //
+    // New vertices are laid out as the updated original vertices, followed by one edge
+    // point per edge, followed by one face point per face. Each face with k corners is
+    // replaced by k quads.
+    //
+
+    void subdivide_polygon_mesh(const PolygonMesh& src, PolygonMesh& dst)
+    {
+        const size_t vertex_count = src.m_vertex_count;
+        const size_t face_count = src.m_face_offsets.size() - 1;
+        const size_t corner_count = src.m_corner_vertices.size();
+
+        // Collect edges; corner_edges[c] is the edge from corner c to the next corner of its face.
+        unordered_map<uint64, uint32> edge_map;
+        edge_map.reserve(corner_count);
+        vector<uint32> corner_edges(corner_count);
+        vector<pair<uint32, uint32>> edges;
+        vector<uint32> edge_face_counts;
+        edges.reserve(corner_count);
+        edge_face_counts.reserve(corner_count);
+
+        for (size_t f = 0; f < face_count; ++f)
+        {
+            const uint32 begin = src.m_face_offsets[f];
+            const uint32 end = src.m_face_offsets[f + 1];
+
+            for (uint32 c = begin; c < end; ++c)
+            {
+                const uint32 a = src.m_corner_vertices[c];
+                const uint32 b = src.m_corner_vertices[c + 1 < end ? c + 1 : begin];
+                const uint64 key = (static_cast<uint64>(min(a, b)) << 32) | max(a, b);
+
+                const auto inserted = edge_map.insert(make_pair(key, static_cast<uint32>(edges.size())));
+                if (inserted.second)
+                {
+                    edges.emplace_back(a, b);
+                    edge_face_counts.push_back(0);
+                }
+
+                const uint32 edge_index = inserted.first->second;
+                ++edge_face_counts[edge_index];
+                corner_edges[c] = edge_index;
+            }
+        }
+
+        const size_t edge_count = edges.size();
+
+        // Gather vertex valences.
+        vector<uint32> vertex_face_counts(vertex_count, 0);
+        vector<uint32> vertex_edge_counts(vertex_count, 0);
+        vector<uint32> vertex_boundary_edge_counts(vertex_count, 0);
+
+        for (size_t c = 0; c < corner_count; ++c)
+            ++vertex_face_counts[src.m_corner_vertices[c]];
+
+        for (size_t e = 0; e < edge_count; ++e)
+        {
+            ++vertex_edge_counts[edges[e].first];
+            ++vertex_edge_counts[edges[e].second];
+
+            if (edge_face_counts[e] != 2)
+            {
+                ++vertex_boundary_edge_counts[edges[e].first];
+                ++vertex_boundary_edge_counts[edges[e].second];
+            }
+        }
+
+        // Compute new vertex positions, for every pose.
+        dst.m_vertex_count = vertex_count + edge_count + face_count;
+        dst.m_poses.resize(src.m_poses.size());
+
+        vector<GVector3> face_points(face_count);
+        vector<GVector3> edge_face_point_sums(edge_count);
+        vector<GVector3> vertex_face_point_sums(vertex_count);
+        vector<GVector3> vertex_midpoint_sums(vertex_count);
+        vector<GVector3> vertex_boundary_neighbor_sums(vertex_count);
+
+        for (size_t p = 0, pose_count = src.m_poses.size(); p < pose_count; ++p)
+        {
+            const vector<GVector3>& positions = src.m_poses[p];
+            vector<GVector3>& new_positions = dst.m_poses[p];
+            new_positions.resize(dst.m_vertex_count);
+
+            fill(edge_face_point_sums.begin(), edge_face_point_sums.end(), GVector3(0.0));
+            fill(vertex_face_point_sums.begin(), vertex_face_point_sums.end(), GVector3(0.0));
+            fill(vertex_midpoint_sums.begin(), vertex_midpoint_sums.end(), GVector3(0.0));
+            fill(vertex_boundary_neighbor_sums.begin(), vertex_boundary_neighbor_sums.end(), GVector3(0.0));
+
+            // Face points.
+            for (size_t f = 0; f < face_count; ++f)
+            {
+                const uint32 begin = src.m_face_offsets[f];
+                const uint32 end = src.m_face_offsets[f + 1];
+
+                GVector3 sum(0.0);
+                for (uint32 c = begin; c < end; ++c)
+                    sum += positions[src.m_corner_vertices[c]];
+
+                face_points[f] = sum / static_cast<GScalar>(end - begin);
+
+                for (uint32 c = begin; c < end; ++c)
+                {
+                    edge_face_point_sums[corner_edges[c]] += face_points[f];
+                    vertex_face_point_sums[src.m_corner_vertices[c]] += face_points[f];
+                }
+
+                new_positions[vertex_count + edge_count + f] = face_points[f];
+            }
+
+            // Edge points.
+            for (size_t e = 0; e < edge_count; ++e)
+            {
+                const uint32 a = edges[e].first;
+                const uint32 b = edges[e].second;
+                const GVector3 midpoint = GScalar(0.5) * (positions[a] + positions[b]);
+
+                new_positions[vertex_count + e] =
+                    edge_face_counts[e] == 2
+                        ? GScalar(0.25) * (positions[a] + positions[b] + edge_face_point_sums[e])
+                        : midpoint;
+
+                vertex_midpoint_sums[a] += midpoint;
+                vertex_midpoint_sums[b] += midpoint;
+
+                if (edge_face_counts[e] != 2)
+                {
+                    vertex_boundary_neighbor_sums[a] += positions[b];
+                    vertex_boundary_neighbor_sums[b] += positions[a];
+                }
+            }
+
+            // Vertex points.
+            for (size_t v = 0; v < vertex_count; ++v)
+            {
+                const GVector3& position = positions[v];
+
+                if (vertex_face_counts[v] == 0)
+                {
+                    // Isolated vertex.
+                    new_positions[v] = position;
+                }
+                else if (vertex_boundary_edge_counts[v] == 0)
+                {
+                    // Interior vertex.
+                    const GScalar n = static_cast<GScalar>(vertex_face_counts[v]);
+                    const GVector3 q = vertex_face_point_sums[v] / n;
+                    const GVector3 r = vertex_midpoint_sums[v] / static_cast<GScalar>(vertex_edge_counts[v]);
+                    new_positions[v] = (q + GScalar(2.0) * r + (n - GScalar(3.0)) * position) / n;
+                }
+                else if (vertex_boundary_edge_counts[v] == 2)
+                {
+                    // Regular boundary vertex.
+                    new_positions[v] = GScalar(0.75) * position + GScalar(0.125) * vertex_boundary_neighbor_sums[v];
+                }
+                else
+                {
+                    // Corner or non-manifold vertex.
+                    new_positions[v] = position;
+                }
+            }
+        }
+
+        // Build the new faces.
+        const bool has_uvs = !src.m_corner_uvs.empty();
+
+        dst.m_face_offsets.resize(corner_count + 1);
+        dst.m_corner_vertices.resize(corner_count * 4);
+        dst.m_face_pas.resize(corner_count);
+        dst.m_corner_uvs.clear();
+
+        if (has_uvs)
+            dst.m_corner_uvs.resize(corner_count * 4);
+
+        size_t quad_index = 0;
+
+        for (size_t f = 0; f < face_count; ++f)
+        {
+            const uint32 begin = src.m_face_offsets[f];
+            const uint32 end = src.m_face_offsets[f + 1];
+
+            GVector2 face_uv(0.0);
+            if (has_uvs)
+            {
+                for (uint32 c = begin; c < end; ++c)
+                    face_uv += src.m_corner_uvs[c];
+                face_uv /= static_cast<GScalar>(end - begin);
+            }
+
+            for (uint32 c = begin; c < end; ++c)
+            {
+                const uint32 prev = c > begin ? c - 1 : end - 1;
+                const uint32 next = c + 1 < end ? c + 1 : begin;
+                const size_t q = quad_index * 4;
+
+                dst.m_face_offsets[quad_index] = static_cast<uint32>(q);
+                dst.m_corner_vertices[q + 0] = src.m_corner_vertices[c];
+                dst.m_corner_vertices[q + 1] = static_cast<uint32>(vertex_count + corner_edges[c]);
+                dst.m_corner_vertices[q + 2] = static_cast<uint32>(vertex_count + edge_count + f);
+                dst.m_corner_vertices[q + 3] = static_cast<uint32>(vertex_count + corner_edges[prev]);
+                dst.m_face_pas[quad_index] = src.m_face_pas[f];
+
+                if (has_uvs)
+                {
+                    dst.m_corner_uvs[q + 0] = src.m_corner_uvs[c];
+                    dst.m_corner_uvs[q + 1] = GScalar(0.5) * (src.m_corner_uvs[c] + src.m_corner_uvs[next]);
+                    dst.m_corner_uvs[q + 2] = face_uv;
+                    dst.m_corner_uvs[q + 3] = GScalar(0.5) * (src.m_corner_uvs[prev] + src.m_corner_uvs[c]);
+                }
+
+                ++quad_index;
+            }
+        }
+
+        dst.m_face_offsets[quad_index] = static_cast<uint32>(quad_index * 4);
+    }
+
+    template <typename PositionArray>
+    void compute_vertex_normals(
+        const PositionArray&                        positions,
+        const StaticTriangleTess::PrimitiveArray&   triangles,
+        vector<GVector3>&                           normals)
+    {
+        normals.assign(positions.size(), GVector3(0.0));
+
+        // Area-weighted sum of the normals of the triangles sharing each vertex.
+        for (const Triangle& triangle : triangles)
+        {
+            const GVector3& v0 = positions[triangle.m_v0];
+            const GVector3& v1 = positions[triangle.m_v1];
+            const GVector3& v2 = positions[triangle.m_v2];
+            const GVector3 n = cross(v1 - v0, v2 - v0);
+
+            normals[triangle.m_v0] += n;
+            normals[triangle.m_v1] += n;
+            normals[triangle.m_v2] += n;
+        }
+
+        for (GVector3& n : normals)
+            n = safe_normalize(n, GVector3(0.0, 1.0, 0.0));
+    }
+
+    void store_polygon_mesh(
+        const PolygonMesh&          mesh,
+        const bool                  has_normals,
+        StaticTriangleTess&         tess)
+    {
+        const size_t face_count = mesh.m_face_offsets.size() - 1;
+        const bool has_uvs = !mesh.m_corner_uvs.empty();
+
+        // Vertices.
+        tess.m_vertices.assign(mesh.m_poses[0].begin(), mesh.m_poses[0].end());
+
+        // Texture coordinates, one per face corner.
+        if (has_uvs)
+        {
+            tess.reserve_tex_coords(mesh.m_corner_uvs.size());
+
+            for (const GVector2& uv : mesh.m_corner_uvs)
+                tess.push_tex_coords(uv);
+        }
+
+        // Triangulate faces as fans.
+        tess.m_primitives.reserve(mesh.m_corner_vertices.size() - 2 * face_count);
+
+        for (size_t f = 0; f < face_count; ++f)
+        {
+            const uint32 begin = mesh.m_face_offsets[f];
+            const uint32 end = mesh.m_face_offsets[f + 1];
+
+            for (uint32 c = begin + 1; c + 1 < end; ++c)
+            {
+                const uint32 v0 = mesh.m_corner_vertices[begin];
+                const uint32 v1 = mesh.m_corner_vertices[c];
+                const uint32 v2 = mesh.m_corner_vertices[c + 1];
+
+                tess.m_primitives.push_back(
+                    Triangle(
+                        v0, v1, v2,
+                        has_normals ? v0 : Triangle::None,
+                        has_normals ? v1 : Triangle::None,
+                        has_normals ? v2 : Triangle::None,
+                        has_uvs ? begin : Triangle::None,
+                        has_uvs ? c : Triangle::None,
+                        has_uvs ? c + 1 : Triangle::None,
+                        mesh.m_face_pas[f]));
+            }
+        }
+
+        // Vertex normals.
+        if (has_normals)
+        {
+            vector<GVector3> normals;
+            compute_vertex_normals(tess.m_vertices, tess.m_primitives, normals);
+
+            tess.reserve_vertex_normals(normals.size());
+
+            for (const GVector3& n : normals)
+                tess.push_vertex_normal(n);
+        }
+
+        // Motion segments.
+        const size_t motion_segment_count = mesh.m_poses.size() - 1;
+
+        if (motion_segment_count > 0)
+        {
+            tess.set_motion_segment_count(motion_segment_count);
+
+            vector<GVector3> pose_normals;
+
+            for (size_t s = 0; s < motion_segment_count; ++s)
+            {
+                const vector<GVector3>& pose = mesh.m_poses[s + 1];
+
+                for (size_t v = 0, e = pose.size(); v < e; ++v)
+                    tess.set_vertex_pose(v, s, pose[v]);
+
+                if (has_normals)
+                {
+                    compute_vertex_normals(pose, tess.m_primitives, pose_normals);
+
+                    for (size_t v = 0, e = pose_normals.size(); v < e; ++v)
+                        tess.set_vertex_normal_pose(v, s, pose_normals[v]);
+                }
+            }
+        }
+    }
+}
+
+void subdivide_catmull_clark(
+    const StaticTriangleTess&   source,
+    const size_t                step_count,
+    StaticTriangleTess&         result)
+{
+    assert(result.m_vertices.empty());
+    assert(result.m_primitives.empty());
+
+    PolygonMesh mesh;
+    load_polygon_mesh(source, mesh);
+
+    for (size_t i = 0; i < step_count; ++i)
+    {
+        PolygonMesh subdivided;
+        subdivide_polygon_mesh(mesh, subdivided);
+        swap(mesh, subdivided);
+    }
+
+    store_polygon_mesh(mesh, source.get_vertex_normal_count() > 0, result);
+}
+
+}   // namespace renderer
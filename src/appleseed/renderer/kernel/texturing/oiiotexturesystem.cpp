@@ -43,4 +43,20 @@ OIIOTextureSystem* OIIOTextureSystemFactory::create(const bool shared)
     return reinterpret_cast<OIIOTextureSystem*>(OIIO::TextureSystem::create(shared));
 }
 
+
+//
+// OIIOTextureThreadCache class implementation.
+//
+
+OIIOTextureThreadCache::OIIOTextureThreadCache(OIIO::TextureSystem& texture_system)
+  : m_texture_system(texture_system)
+  , m_thread_info(texture_system.create_thread_info())
+{
+}
+
+OIIOTextureThreadCache::~OIIOTextureThreadCache()
+{
+    m_texture_system.destroy_thread_info(m_thread_info);
+}
+
 }   // namespace renderer
@@ -28,11 +28,18 @@
 
 #pragma once
 
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
 // OpenImageIO headers.
 #include "foundation/platform/_beginoiioheaders.h"
 #include "OpenImageIO/texture.h"
+#include "OpenImageIO/ustring.h"
 #include "foundation/platform/_endoiioheaders.h"
 
+// Boost headers.
+#include "boost/unordered_map.hpp"
+
 namespace renderer
 {
 
@@ -55,4 +62,61 @@ class OIIOTextureSystemFactory
     static OIIOTextureSystem* create(const bool shared = true);
 };
 
+
+//
+// Per-thread state for texture lookups: OIIO's per-thread info and the texture
+// handles resolved so far, so that repeated lookups of the same file bypass the
+// filename hash and the thread-specific pointer lookup of the texture system.
+//
+// Not thread-safe: each rendering thread must use its own instance.
+//
+
+class OIIOTextureThreadCache
+  : public foundation::NonCopyable
+{
+  public:
+    explicit OIIOTextureThreadCache(OIIO::TextureSystem& texture_system);
+
+    ~OIIOTextureThreadCache();
+
+    OIIO::TextureSystem::Perthread* get_thread_info() const;
+
+    // Return the texture handle of a given file, or nullptr if it cannot be resolved.
+    OIIO::TextureSystem::TextureHandle* get_texture_handle(const OIIO::ustring filename);
+
+  private:
+    typedef boost::unordered_map<
+        OIIO::ustring,
+        OIIO::TextureSystem::TextureHandle*,
+        OIIO::ustringHash
+    > TextureHandleMap;
+
+    OIIO::TextureSystem&                m_texture_system;
+    OIIO::TextureSystem::Perthread*     m_thread_info;
+    TextureHandleMap                    m_texture_handles;
+};
+
+
+//
+// OIIOTextureThreadCache class implementation.
+//
+
+inline OIIO::TextureSystem::Perthread* OIIOTextureThreadCache::get_thread_info() const
+{
+    return m_thread_info;
+}
+
+inline OIIO::TextureSystem::TextureHandle* OIIOTextureThreadCache::get_texture_handle(const OIIO::ustring filename)
+{
+    const TextureHandleMap::const_iterator i = m_texture_handles.find(filename);
+    if (i != m_texture_handles.end())
+        return i->second;
+
+    OIIO::TextureSystem::TextureHandle* handle =
+        m_texture_system.get_texture_handle(filename, m_thread_info);
+    m_texture_handles.insert(TextureHandleMap::value_type(filename, handle));
+
+    return handle;
+}
+
 }   // namespace renderer
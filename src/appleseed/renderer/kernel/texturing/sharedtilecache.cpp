@@ -0,0 +1,439 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "sharedtilecache.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/cache.h"
+#include "foundation/utility/murmurhash.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/filesystem.hpp"
+#include "boost/interprocess/allocators/allocator.hpp"
+#include "boost/interprocess/containers/list.hpp"
+#include "boost/interprocess/containers/map.hpp"
+#include "boost/interprocess/containers/string.hpp"
+#include "boost/interprocess/exceptions.hpp"
+#include "boost/interprocess/managed_shared_memory.hpp"
+#include "boost/interprocess/offset_ptr.hpp"
+#include "boost/interprocess/sync/interprocess_mutex.hpp"
+#include "boost/interprocess/sync/scoped_lock.hpp"
+
+// Standard headers.
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+using namespace foundation;
+using namespace std;
+
+namespace bf = boost::filesystem;
+namespace bip = boost::interprocess;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // Data structures living in the shared memory segment.
+    //
+    // They only hold offset pointers since the segment is mapped at different
+    // addresses in different processes.
+    //
+
+    typedef bip::managed_shared_memory::segment_manager SegmentManager;
+
+    typedef bip::allocator<char, SegmentManager> CharAllocator;
+    typedef bip::basic_string<char, char_traits<char>, CharAllocator> SharedString;
+
+    typedef SharedTileCache::EntryID EntryID;
+
+    // Entry IDs, from the least recently used entry to the most recently used one.
+    typedef bip::allocator<EntryID, SegmentManager> EntryIDAllocator;
+    typedef bip::list<EntryID, EntryIDAllocator> LRUList;
+
+    struct Entry
+    {
+        SharedString                m_filepath;
+        uint64                      m_file_size;
+        uint64                      m_last_write_time;
+        uint32                      m_tile_xy;
+        uint32                      m_mip_level;
+        uint32                      m_variant;
+
+        uint32                      m_width;
+        uint32                      m_height;
+        uint32                      m_channel_count;
+        uint32                      m_pixel_format;
+        bip::offset_ptr<uint8>      m_storage;
+        size_t                      m_storage_size;
+
+        uint32                      m_ref_count;        // number of process-level references
+        LRUList::iterator           m_lru_it;
+
+        explicit Entry(const CharAllocator& allocator)
+          : m_filepath(allocator)
+        {
+        }
+    };
+
+    typedef pair<const EntryID, Entry> EntryMapValue;
+    typedef bip::allocator<EntryMapValue, SegmentManager> EntryMapAllocator;
+    typedef bip::map<EntryID, Entry, less<EntryID>, EntryMapAllocator> EntryMap;
+
+    struct Header
+    {
+        bip::interprocess_mutex     m_mutex;
+        EntryMap                    m_entries;
+        LRUList                     m_lru;
+
+        explicit Header(SegmentManager* segment_manager)
+          : m_entries(less<EntryID>(), EntryMapAllocator(segment_manager))
+          , m_lru(EntryIDAllocator(segment_manager))
+        {
+        }
+    };
+
+    const char* HeaderName = "appleseed_shared_tile_cache_header";
+
+    // Key of a tile completed with the state of its texture file.
+    struct ResolvedKey
+    {
+        const SharedTileCache::TileKey& m_key;
+        uint64                          m_file_size;
+        uint64                          m_last_write_time;
+        EntryID                         m_entry_id;
+
+        explicit ResolvedKey(const SharedTileCache::TileKey& key)
+          : m_key(key)
+          , m_entry_id(SharedTileCache::InvalidEntryID)
+        {
+            boost::system::error_code size_ec, time_ec;
+            const bf::path filepath(key.m_filepath);
+            m_file_size = static_cast<uint64>(bf::file_size(filepath, size_ec));
+            m_last_write_time = static_cast<uint64>(bf::last_write_time(filepath, time_ec));
+            if (size_ec || time_ec)
+                return;
+
+            MurmurHash hash;
+            hash.append(key.m_filepath);
+            hash.append(m_file_size);
+            hash.append(m_last_write_time);
+            hash.append(key.m_tile_xy);
+            hash.append(key.m_mip_level);
+            hash.append(key.m_variant);
+
+            m_entry_id = hash.h1();
+            if (m_entry_id == SharedTileCache::InvalidEntryID)
+                m_entry_id = ~SharedTileCache::InvalidEntryID;
+        }
+
+        bool is_valid() const
+        {
+            return m_entry_id != SharedTileCache::InvalidEntryID;
+        }
+
+        // Hash collisions between different tiles are treated as misses.
+        bool matches(const Entry& entry) const
+        {
+            return
+                entry.m_file_size == m_file_size &&
+                entry.m_last_write_time == m_last_write_time &&
+                entry.m_tile_xy == m_key.m_tile_xy &&
+                entry.m_mip_level == m_key.m_mip_level &&
+                entry.m_variant == m_key.m_variant &&
+                entry.m_filepath.size() == m_key.m_filepath.size() &&
+                memcmp(entry.m_filepath.data(), m_key.m_filepath.data(), m_key.m_filepath.size()) == 0;
+        }
+    };
+}
+
+struct SharedTileCache::Impl
+{
+    unique_ptr<bip::managed_shared_memory>  m_segment;
+    Header*                                 m_header;
+
+    boost::atomic<uint64>                   m_hit_count;
+    boost::atomic<uint64>                   m_miss_count;
+    boost::atomic<uint64>                   m_insert_count;
+    boost::atomic<uint64>                   m_eviction_count;
+
+    Impl()
+      : m_header(nullptr)
+      , m_hit_count(0)
+      , m_miss_count(0)
+      , m_insert_count(0)
+      , m_eviction_count(0)
+    {
+    }
+
+    // Acquire an existing entry. Requires the segment lock.
+    Tile* acquire_entry(Entry& entry)
+    {
+        ++entry.m_ref_count;
+        m_header->m_lru.splice(m_header->m_lru.end(), m_header->m_lru, entry.m_lru_it);
+
+        return
+            new Tile(
+                entry.m_width,
+                entry.m_height,
+                entry.m_channel_count,
+                static_cast<PixelFormat>(entry.m_pixel_format),
+                entry.m_storage.get());
+    }
+
+    // Evict the least recently used unreferenced entry. Requires the segment lock.
+    bool evict_entry()
+    {
+        for (auto i = m_header->m_lru.begin(), e = m_header->m_lru.end(); i != e; ++i)
+        {
+            const auto entry_it = m_header->m_entries.find(*i);
+            assert(entry_it != m_header->m_entries.end());
+
+            if (entry_it->second.m_ref_count > 0)
+                continue;
+
+            m_segment->deallocate(entry_it->second.m_storage.get());
+            m_header->m_lru.erase(i);
+            m_header->m_entries.erase(entry_it);
+            ++m_eviction_count;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    // Allocate storage for a tile, evicting entries as needed. Requires the segment lock.
+    uint8* allocate_storage(const size_t size)
+    {
+        while (true)
+        {
+            void* storage = m_segment->allocate(size, nothrow);
+
+            if (storage != nullptr)
+                return static_cast<uint8*>(storage);
+
+            if (!evict_entry())
+                return nullptr;
+        }
+    }
+};
+
+SharedTileCache::SharedTileCache(
+    const char*     name,
+    const size_t    size)
+  : impl(new Impl())
+{
+    try
+    {
+        impl->m_segment.reset(new bip::managed_shared_memory(bip::open_or_create, name, size));
+        impl->m_header =
+            impl->m_segment->find_or_construct<Header>(HeaderName)(impl->m_segment->get_segment_manager());
+
+        RENDERER_LOG_INFO(
+            "opened shared texture tile cache \"%s\" (%s).",
+            name,
+            pretty_size(impl->m_segment->get_size()).c_str());
+    }
+    catch (const bip::interprocess_exception& e)
+    {
+        RENDERER_LOG_WARNING("could not open shared texture tile cache \"%s\": %s.", name, e.what());
+        impl->m_segment.reset();
+        impl->m_header = nullptr;
+    }
+}
+
+SharedTileCache::~SharedTileCache()
+{
+    delete impl;
+}
+
+bool SharedTileCache::is_open() const
+{
+    return impl->m_header != nullptr;
+}
+
+Tile* SharedTileCache::acquire(const TileKey& key, EntryID& entry_id)
+{
+    assert(is_open());
+
+    const ResolvedKey resolved_key(key);
+
+    if (resolved_key.is_valid())
+    {
+        bip::scoped_lock<bip::interprocess_mutex> lock(impl->m_header->m_mutex);
+
+        const auto entry_it = impl->m_header->m_entries.find(resolved_key.m_entry_id);
+
+        if (entry_it != impl->m_header->m_entries.end() && resolved_key.matches(entry_it->second))
+        {
+            ++impl->m_hit_count;
+            entry_id = resolved_key.m_entry_id;
+            return impl->acquire_entry(entry_it->second);
+        }
+    }
+
+    ++impl->m_miss_count;
+    entry_id = InvalidEntryID;
+    return nullptr;
+}
+
+Tile* SharedTileCache::insert(const TileKey& key, const Tile& tile, EntryID& entry_id)
+{
+    assert(is_open());
+
+    entry_id = InvalidEntryID;
+
+    const ResolvedKey resolved_key(key);
+    if (!resolved_key.is_valid())
+        return nullptr;
+
+    bip::scoped_lock<bip::interprocess_mutex> lock(impl->m_header->m_mutex);
+
+    EntryMap& entries = impl->m_header->m_entries;
+    const auto entry_it = entries.find(resolved_key.m_entry_id);
+
+    if (entry_it != entries.end())
+    {
+        // Another process inserted the tile in the meantime.
+        if (!resolved_key.matches(entry_it->second))
+            return nullptr;
+
+        entry_id = resolved_key.m_entry_id;
+        return impl->acquire_entry(entry_it->second);
+    }
+
+    uint8* storage = impl->allocate_storage(tile.get_size());
+    if (storage == nullptr)
+        return nullptr;
+
+    memcpy(storage, tile.get_storage(), tile.get_size());
+
+    LRUList& lru = impl->m_header->m_lru;
+    LRUList::iterator lru_it = lru.end();
+
+    try
+    {
+        lru_it = lru.insert(lru.end(), resolved_key.m_entry_id);
+
+        SegmentManager* segment_manager = impl->m_segment->get_segment_manager();
+        Entry entry((CharAllocator(segment_manager)));
+        entry.m_filepath.assign(key.m_filepath.begin(), key.m_filepath.end());
+        entry.m_file_size = resolved_key.m_file_size;
+        entry.m_last_write_time = resolved_key.m_last_write_time;
+        entry.m_tile_xy = key.m_tile_xy;
+        entry.m_mip_level = key.m_mip_level;
+        entry.m_variant = key.m_variant;
+        entry.m_width = static_cast<uint32>(tile.get_width());
+        entry.m_height = static_cast<uint32>(tile.get_height());
+        entry.m_channel_count = static_cast<uint32>(tile.get_channel_count());
+        entry.m_pixel_format = static_cast<uint32>(tile.get_pixel_format());
+        entry.m_storage = storage;
+        entry.m_storage_size = tile.get_size();
+        entry.m_ref_count = 0;
+        entry.m_lru_it = lru_it;
+
+        Entry& inserted_entry =
+            entries.insert(EntryMapValue(resolved_key.m_entry_id, entry)).first->second;
+        ++impl->m_insert_count;
+
+        entry_id = resolved_key.m_entry_id;
+        return impl->acquire_entry(inserted_entry);
+    }
+    catch (const bip::bad_alloc&)
+    {
+        // The segment is too full to hold the bookkeeping of the entry.
+        if (lru_it != lru.end())
+            lru.erase(lru_it);
+        impl->m_segment->deallocate(storage);
+        return nullptr;
+    }
+}
+
+void SharedTileCache::release(const EntryID entry_id, Tile* tile)
+{
+    assert(is_open());
+    assert(entry_id != InvalidEntryID);
+
+    {
+        bip::scoped_lock<bip::interprocess_mutex> lock(impl->m_header->m_mutex);
+
+        const auto entry_it = impl->m_header->m_entries.find(entry_id);
+        assert(entry_it != impl->m_header->m_entries.end());
+        assert(entry_it->second.m_ref_count > 0);
+
+        --entry_it->second.m_ref_count;
+    }
+
+    // The tile does not own its storage.
+    delete tile;
+}
+
+StatisticsVector SharedTileCache::get_statistics() const
+{
+    Statistics stats;
+    stats.insert(
+        unique_ptr<foundation::cache_impl::CacheStatisticsEntry>(
+            new foundation::cache_impl::CacheStatisticsEntry(
+                "performance",
+                impl->m_hit_count.load(),
+                impl->m_miss_count.load())));
+    stats.insert("inserted tiles", impl->m_insert_count.load());
+    stats.insert("evicted tiles", impl->m_eviction_count.load());
+
+    if (is_open())
+    {
+        bip::scoped_lock<bip::interprocess_mutex> lock(impl->m_header->m_mutex);
+        stats.insert("resident tiles", static_cast<uint64>(impl->m_header->m_entries.size()));
+        stats.insert_size("free memory", impl->m_segment->get_free_memory());
+    }
+
+    return StatisticsVector::make("shared texture tile cache statistics", stats);
+}
+
+bool SharedTileCache::remove(const char* name)
+{
+    return bip::shared_memory_object::remove(name);
+}
+
+}   // namespace renderer
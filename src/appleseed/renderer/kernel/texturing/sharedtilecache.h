@@ -0,0 +1,112 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+// Forward declarations.
+namespace foundation    { class StatisticsVector; }
+namespace foundation    { class Tile; }
+
+namespace renderer
+{
+
+//
+// A texture tile cache living in a named shared memory segment, shared by all the
+// render processes of a machine that open it under the same name.
+//
+// Tiles are identified by the path to their texture file, the size and last write
+// time of that file, their coordinates and mipmap level, and the conversion applied
+// to them after decoding. Entries are reference-counted: each process referencing a
+// tile holds a reference until its own texture store evicts the tile. When the segment
+// is full, unreferenced entries are evicted in least recently used order, regardless
+// of the process that inserted them.
+//
+// The segment outlives the processes using it so that consecutive renders reuse the
+// tiles decoded by earlier ones; it can be removed with remove().
+//
+
+class SharedTileCache
+  : public foundation::NonCopyable
+{
+  public:
+    // This structure identifies a texture tile across processes.
+    struct TileKey
+    {
+        std::string             m_filepath;
+        foundation::uint32      m_tile_xy;
+        foundation::uint32      m_mip_level;
+        foundation::uint32      m_variant;      // identifies the conversion applied to the decoded tile
+    };
+
+    // Identifies an entry of the cache acquired by this process.
+    typedef foundation::uint64 EntryID;
+
+    static const EntryID InvalidEntryID = 0;
+
+    // Constructor. Open the segment with a given name, or create it with a given size in bytes.
+    SharedTileCache(
+        const char*             name,
+        const size_t            size);
+
+    // Destructor.
+    ~SharedTileCache();
+
+    // Return true if the segment could be opened or created.
+    bool is_open() const;
+
+    // Acquire a tile. Return a tile whose storage lives in the segment and set 'entry_id',
+    // or return nullptr if the tile is not in the cache. Thread-safe.
+    foundation::Tile* acquire(const TileKey& key, EntryID& entry_id);
+
+    // Insert a copy of a tile into the cache and acquire it. Return nullptr if the tile
+    // cannot be inserted, e.g. if all the entries of a full cache are referenced. Thread-safe.
+    foundation::Tile* insert(const TileKey& key, const foundation::Tile& tile, EntryID& entry_id);
+
+    // Release and delete a tile returned by acquire() or insert(). Thread-safe.
+    void release(const EntryID entry_id, foundation::Tile* tile);
+
+    // Retrieve performance statistics.
+    foundation::StatisticsVector get_statistics() const;
+
+    // Remove the segment with a given name. Processes having it open keep using it.
+    static bool remove(const char* name);
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}   // namespace renderer
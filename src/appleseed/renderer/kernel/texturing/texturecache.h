@@ -30,6 +30,7 @@
 #pragma once
 
 // appleseed.renderer headers.
+#include "renderer/kernel/rendering/renderingcounters.h"
 #include "renderer/kernel/texturing/texturestore.h"
 
 // appleseed.foundation headers.
@@ -59,12 +60,27 @@ class TextureCache
     // Constructor.
     explicit TextureCache(TextureStore& store);
 
-    // Get a tile from the cache.
+    // Get a tile of a given mipmap level from the cache.
     foundation::Tile& get(
         const foundation::UniqueID  assembly_uid,
         const foundation::UniqueID  texture_uid,
         const size_t                tile_x,
-        const size_t                tile_y);
+        const size_t                tile_y,
+        const size_t                mip_level = 0);
+
+    // Return true if the backing texture store holds tiles in a compact form.
+    bool is_tile_compression_enabled() const;
+
+    // Return true if the backing texture store services prefetch requests.
+    bool is_prefetching_enabled() const;
+
+    // Request the asynchronous loading of a tile into the backing texture store.
+    void prefetch(
+        const foundation::UniqueID  assembly_uid,
+        const foundation::UniqueID  texture_uid,
+        const size_t                tile_x,
+        const size_t                tile_y,
+        const size_t                mip_level = 0);
 
     // Retrieve performance statistics.
     foundation::StatisticsVector get_statistics() const;
@@ -103,6 +119,7 @@ class TextureCache
         4                   // number of ways
     > TileCache;
 
+    TextureStore&           m_store;
     TileKeyHasher           m_tile_key_hasher;
     TileRecordSwapper       m_tile_record_swapper;
     TileCache               m_tile_cache;
@@ -114,7 +131,8 @@ class TextureCache
 //
 
 inline TextureCache::TextureCache(TextureStore& store)
-  : m_tile_record_swapper(store)
+  : m_store(store)
+  , m_tile_record_swapper(store)
   , m_tile_cache(m_tile_key_hasher, m_tile_record_swapper, TileKey::invalid())
 {
 }
@@ -123,12 +141,34 @@ inline foundation::Tile& TextureCache::get(
     const foundation::UniqueID      assembly_uid,
     const foundation::UniqueID      texture_uid,
     const size_t                    tile_x,
-    const size_t                    tile_y)
+    const size_t                    tile_y,
+    const size_t                    mip_level)
 {
-    const TileKey key(assembly_uid, texture_uid, tile_x, tile_y);
+    const TileKey key(assembly_uid, texture_uid, tile_x, tile_y, mip_level);
     return *m_tile_cache.get(key)->m_tile;
 }
 
+inline bool TextureCache::is_tile_compression_enabled() const
+{
+    return m_store.is_tile_compression_enabled();
+}
+
+inline bool TextureCache::is_prefetching_enabled() const
+{
+    return m_store.is_prefetching_enabled();
+}
+
+inline void TextureCache::prefetch(
+    const foundation::UniqueID      assembly_uid,
+    const foundation::UniqueID      texture_uid,
+    const size_t                    tile_x,
+    const size_t                    tile_y,
+    const size_t                    mip_level)
+{
+    const TileKey key(assembly_uid, texture_uid, tile_x, tile_y, mip_level);
+    m_store.prefetch(key);
+}
+
 inline foundation::StatisticsVector TextureCache::get_statistics() const
 {
     return
@@ -159,6 +199,7 @@ inline TextureCache::TileRecordSwapper::TileRecordSwapper(TextureStore& store)
 
 inline void TextureCache::TileRecordSwapper::load(const TileKey& key, TileRecordPtr& record)
 {
+    ++RenderingCounters::current().m_texture_cache_miss_count;
     record = &m_store.acquire(key);
 }
 
@@ -32,6 +32,9 @@
 
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
+#include "renderer/kernel/rendering/renderingcounters.h"
+#include "renderer/kernel/texturing/sharedtilecache.h"
+#include "renderer/kernel/texturing/textureworkingsetanalyzer.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/texture/texture.h"
@@ -43,14 +46,24 @@
 #include "foundation/image/tile.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/countof.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job/ijob.h"
 #include "foundation/utility/memory.h"
 #include "foundation/utility/statistics.h"
 #include "foundation/utility/string.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -72,6 +85,41 @@ Dictionary TextureStore::get_params_metadata()
             .insert("default", get_default_size())
             .insert("label", "Texture Cache Size")
             .insert("help", "Texture cache size in bytes"));
+    metadata.dictionaries().insert(
+        "prefetch_threads",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "0")
+            .insert("label", "Texture Prefetch Threads")
+            .insert("help", "Number of I/O threads loading texture tiles ahead of time (0 disables prefetching)"));
+    metadata.dictionaries().insert(
+        "compress_tiles",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Compress Texture Tiles")
+            .insert("help", "Store floating-point tiles in half precision and 8-bit sRGB tiles without conversion to fit more tiles in the cache"));
+    metadata.dictionaries().insert(
+        "analyze_working_set",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Analyze Texture Working Set")
+            .insert("help", "Record texture tile accesses to report the working set of each texture and recommend texture cache sizes"));
+    metadata.dictionaries().insert(
+        "shared_cache_name",
+        Dictionary()
+            .insert("type", "string")
+            .insert("default", "")
+            .insert("label", "Shared Texture Cache Name")
+            .insert("help", "Name of a shared memory texture tile cache used by all render processes of the machine (empty disables sharing)"));
+    metadata.dictionaries().insert(
+        "shared_cache_size",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", get_default_size())
+            .insert("label", "Shared Texture Cache Size")
+            .insert("help", "Size in bytes of the shared memory texture tile cache when this process creates it"));
 
     return metadata;
 }
@@ -81,20 +129,332 @@ size_t TextureStore::get_default_size()
     return 1024 * 1024 * 1024;
 }
 
+//
+// A job that loads a tile into the store on behalf of a prefetch request.
+//
+
+class TextureStore::PrefetchJob
+  : public IJob
+{
+  public:
+    PrefetchJob(
+        TextureStore&   store,
+        const TileKey&  key)
+      : m_store(store)
+      , m_key(key)
+    {
+    }
+
+    void execute(const size_t thread_index) override
+    {
+        // Load the tile, then let it be evicted like any other tile.
+        m_store.release(m_store.acquire_tile(m_key));
+
+        Shard& shard = m_store.get_shard(m_key);
+        boost::mutex::scoped_lock lock(shard.m_mutex);
+        shard.m_pending_prefetches.erase(m_key);
+    }
+
+  private:
+    TextureStore&   m_store;
+    const TileKey   m_key;
+};
+
 TextureStore::TextureStore(
     const Scene&        scene,
     const ParamArray&   params)
-  : m_tile_swapper(scene, params)
-  , m_tile_cache(m_tile_key_hasher, m_tile_swapper)
+  : m_compress_tiles(params.get_optional<bool>("compress_tiles", false))
+  , m_prefetch_count(0)
+  , m_scene(scene)
+{
+    gather_assemblies(scene.assemblies());
+
+    const size_t memory_limit = params.get_optional<size_t>("max_size", 256 * 1024 * 1024);
+    const size_t shard_count = max<size_t>(params.get_optional<size_t>("shard_count", 16), 1);
+    assert(memory_limit > 0);
+
+    // Open the shared tile cache.
+    const string shared_cache_name = params.get_optional<string>("shared_cache_name", "");
+    if (!shared_cache_name.empty())
+    {
+        m_shared_tile_cache.reset(
+            new SharedTileCache(
+                shared_cache_name.c_str(),
+                params.get_optional<size_t>("shared_cache_size", get_default_size())));
+
+        if (!m_shared_tile_cache->is_open())
+            m_shared_tile_cache.reset();
+    }
+
+    // Split the memory budget evenly between the shards.
+    const size_t shard_memory_limit = max<size_t>(memory_limit / shard_count, 1);
+
+    m_shards.reserve(shard_count);
+
+    for (size_t i = 0; i < shard_count; ++i)
+        m_shards.push_back(new Shard(scene, m_assemblies, params, shard_memory_limit, m_shared_tile_cache.get()));
+
+    // Start the I/O threads servicing prefetch requests.
+    const size_t prefetch_thread_count = params.get_optional<size_t>("prefetch_threads", 0);
+    if (prefetch_thread_count > 0)
+    {
+        m_prefetch_job_manager.reset(
+            new JobManager(
+                global_logger(),
+                m_prefetch_job_queue,
+                prefetch_thread_count,
+                JobManager::KeepRunningOnEmptyQueue));
+        m_prefetch_job_manager->start();
+    }
+
+    if (params.get_optional<bool>("analyze_working_set", false))
+        m_working_set_analyzer.reset(new TextureWorkingSetAnalyzer());
+}
+
+TextureStore::~TextureStore()
 {
+    // Stop the I/O threads before tearing down the shards.
+    if (m_prefetch_job_manager)
+    {
+        m_prefetch_job_queue.clear_scheduled_jobs();
+        m_prefetch_job_manager->stop();
+    }
+
+    for (each<ShardVector> i = m_shards; i; ++i)
+        delete *i;
 }
 
 StatisticsVector TextureStore::get_statistics() const
 {
-    Statistics stats = make_single_stage_cache_stats(m_tile_cache);
-    stats.insert_size("peak size", m_tile_swapper.get_peak_memory_size());
+    uint64 hit_count = 0;
+    uint64 miss_count = 0;
+    size_t peak_memory_size = 0;
+
+    for (const_each<ShardVector> i = m_shards; i; ++i)
+    {
+        hit_count += (*i)->m_tile_cache.get_hit_count();
+        miss_count += (*i)->m_tile_cache.get_miss_count();
+        peak_memory_size += (*i)->m_tile_swapper.get_peak_memory_size();
+    }
+
+    Statistics stats;
+    stats.insert(
+        unique_ptr<cache_impl::CacheStatisticsEntry>(
+            new cache_impl::CacheStatisticsEntry(
+                "performance",
+                hit_count,
+                miss_count)));
+    stats.insert("shards", static_cast<uint64>(m_shards.size()));
+    stats.insert("prefetched tiles", m_prefetch_count.load());
+    stats.insert_size("peak size", peak_memory_size);
+
+    StatisticsVector vec = StatisticsVector::make("texture store statistics", stats);
+
+    if (m_shared_tile_cache)
+        vec.merge(m_shared_tile_cache->get_statistics());
+
+    return vec;
+}
+
+namespace
+{
+    typedef map<pair<UniqueID, UniqueID>, const Texture*> TextureMap;
+
+    void gather_textures(
+        const UniqueID          assembly_uid,
+        const TextureContainer& textures,
+        TextureMap&             texture_map)
+    {
+        for (const_each<TextureContainer> i = textures; i; ++i)
+            texture_map[make_pair(assembly_uid, i->get_uid())] = &*i;
+    }
+
+    string format_tile_access_histogram(const vector<uint64>& histogram)
+    {
+        string result;
+
+        for (size_t i = 0, e = histogram.size(); i < e; ++i)
+        {
+            if (histogram[i] == 0)
+                continue;
+
+            if (!result.empty())
+                result += ", ";
+
+            // Bucket i counts the tiles accessed [2^i, 2^(i+1)) times.
+            const uint64 lo = uint64(1) << i;
+            const uint64 hi = (lo << 1) - 1;
+            result += lo == hi ? to_string(lo) : to_string(lo) + "-" + to_string(hi);
+            result += ": " + to_string(histogram[i]);
+        }
+
+        return result;
+    }
+
+    string format_store_size(const size_t bytes)
+    {
+        return bytes == 0 ? "unreachable" : to_string(bytes) + " (" + pretty_size(bytes) + ")";
+    }
+}
+
+StatisticsVector TextureStore::get_working_set_statistics() const
+{
+    StatisticsVector vec;
+
+    if (!m_working_set_analyzer)
+        return vec;
+
+    const TextureWorkingSetAnalyzer& analyzer = *m_working_set_analyzer;
+
+    // Textures in the scene, scene textures use an invalid assembly UID.
+    TextureMap textures;
+    gather_textures(~UniqueID(0), m_scene.textures(), textures);
+    for (const_each<AssemblyMap> i = m_assemblies; i; ++i)
+        gather_textures(i->first, i->second->textures(), textures);
+
+    // Working set of the whole store.
+    Statistics stats;
+    stats.insert("accesses", analyzer.get_access_count());
+    stats.insert("cold misses", analyzer.get_cold_miss_count());
+    stats.insert("distinct tiles", static_cast<uint64>(analyzer.get_tile_count()));
+    stats.insert_size("working set", analyzer.get_memory_size());
+
+    const double TargetHitRates[] = { 0.5, 0.75, 0.9, 0.95, 0.99 };
+    for (size_t i = 0; i < countof(TargetHitRates); ++i)
+    {
+        stats.insert<string>(
+            "max_size for " + to_string(static_cast<int>(TargetHitRates[i] * 100.0)) + "% hits",
+            format_store_size(analyzer.get_store_size_for_hit_rate(TargetHitRates[i])));
+    }
+
+    // Working sets of the textures accessed.
+    const TextureWorkingSetAnalyzer::TextureWorkingSetVector working_sets =
+        analyzer.get_texture_working_sets();
+
+    StatisticsVector texture_vec;
+
+    for (const_each<TextureWorkingSetAnalyzer::TextureWorkingSetVector> i = working_sets; i; ++i)
+    {
+        const TextureMap::iterator texture =
+            textures.find(make_pair(i->m_assembly_uid, i->m_texture_uid));
+        if (texture == textures.end())
+            continue;
+
+        Statistics texture_stats;
+        texture_stats.insert("accesses", i->m_access_count);
+        texture_stats.insert("distinct tiles", static_cast<uint64>(i->m_tile_count));
+        texture_stats.insert_size("working set", i->m_memory_size);
+        texture_stats.insert<string>("tiles by accesses", format_tile_access_histogram(i->m_tile_access_histogram));
+        texture_vec.insert(string("texture ") + texture->second->get_path().c_str(), texture_stats);
+
+        // Only untouched textures remain.
+        textures.erase(texture);
+    }
+
+    // Textures that were never accessed.
+    string never_accessed;
+    for (const_each<TextureMap> i = textures; i; ++i)
+    {
+        if (!never_accessed.empty())
+            never_accessed += ", ";
+        never_accessed += i->second->get_path().c_str();
+    }
+
+    stats.insert("never accessed textures", static_cast<uint64>(textures.size()));
+    if (!never_accessed.empty())
+        stats.insert<string>("never accessed", never_accessed);
+
+    vec.insert("texture working set statistics", stats);
+    vec.merge(texture_vec);
+
+    return vec;
+}
+
+void TextureStore::prefetch(const TileKey& key)
+{
+    if (!m_prefetch_job_manager)
+        return;
+
+    Shard& shard = get_shard(key);
+
+    {
+        boost::mutex::scoped_lock lock(shard.m_mutex);
+
+        // Skip tiles that are already loaded, being loaded, or about to be prefetched.
+        if (shard.m_tile_cache.contains(key))
+            return;
+        if (!shard.m_pending_prefetches.insert(key).second)
+            return;
+    }
+
+    ++m_prefetch_count;
+    m_prefetch_job_queue.schedule(new PrefetchJob(*this, key));
+}
+
+void TextureStore::gather_assemblies(const AssemblyContainer& assemblies)
+{
+    for (const_each<AssemblyContainer> i = assemblies; i; ++i)
+    {
+        m_assemblies[i->get_uid()] = &*i;
+        gather_assemblies(i->assemblies());
+    }
+}
+
+void TextureStore::record_access(const TileKey& key, const TileRecord& record)
+{
+    assert(m_working_set_analyzer);
+    assert(record.m_tile);
+
+    m_working_set_analyzer->record_access(key, record.m_tile->get_memory_size());
+}
+
+void TextureStore::load_tile(Shard& shard, const TileKey& key, TileRecord& record)
+{
+    if (atomic_cas(&record.m_state, TileRecord::Empty, TileRecord::Loading) == TileRecord::Empty)
+    {
+        // This thread is in charge of loading the tile. Other threads are not blocked meanwhile.
+        Tile* tile;
+        bool converted;
+        uint64 shared_entry;
+        {
+            TraceScope trace_scope("texturing", "load texture tile");
+            tile = shard.m_tile_swapper.load_tile(key, converted, shared_entry);
+        }
+        ++RenderingCounters::current().m_texture_load_count;
+
+        {
+            boost::mutex::scoped_lock lock(shard.m_mutex);
+            shard.m_tile_swapper.track_loaded_tile(*tile);
+        }
+
+        // Publish the tile.
+        record.m_tile = tile;
+        record.m_converted = converted;
+        record.m_shared_entry = shared_entry;
+        atomic_cas(&record.m_state, TileRecord::Loading, TileRecord::Loaded);
+    }
+    else
+    {
+        // Another thread is loading the tile, wait until it's done.
+        while (atomic_read(&record.m_state) != TileRecord::Loaded)
+            foundation::yield();
+    }
+}
+
+
+//
+// TextureStore::Shard class implementation.
+//
 
-    return StatisticsVector::make("texture store statistics", stats);
+TextureStore::Shard::Shard(
+    const Scene&        scene,
+    const AssemblyMap&  assemblies,
+    const ParamArray&   params,
+    const size_t        memory_limit,
+    SharedTileCache*    shared_tile_cache)
+  : m_tile_swapper(scene, assemblies, params, memory_limit, shared_tile_cache)
+  , m_tile_cache(m_tile_key_hasher, m_tile_swapper)
+{
 }
 
 
@@ -165,25 +525,96 @@ namespace
 
 TextureStore::TileSwapper::TileSwapper(
     const Scene&        scene,
-    const ParamArray&   params)
+    const AssemblyMap&  assemblies,
+    const ParamArray&   params,
+    const size_t        memory_limit,
+    SharedTileCache*    shared_tile_cache)
   : m_scene(scene)
+  , m_assemblies(assemblies)
   , m_params(params)
+  , m_memory_limit(memory_limit)
+  , m_shared_tile_cache(shared_tile_cache)
   , m_memory_size(0)
   , m_peak_memory_size(0)
 {
-    gather_assemblies(scene.assemblies());
 }
 
 void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
 {
-    // Fetch the texture container.
-    const TextureContainer& textures =
-        key.m_assembly_uid == ~UniqueID(0)
-            ? m_scene.textures()
-            : m_assemblies[key.m_assembly_uid]->textures();
+    // Only initialize the cache line: the tile is loaded outside of the shard lock.
+    record.m_tile = nullptr;
+    record.m_owners = 0;
+    record.m_state = TileRecord::Empty;
+    record.m_converted = false;
+    record.m_shared_entry = SharedTileCache::InvalidEntryID;
+}
+
+bool TextureStore::TileSwapper::unload(const TileKey& key, TileRecord& record)
+{
+    // Cannot unload tiles that are still in use.
+    if (atomic_read(&record.m_owners) > 0)
+        return false;
+
+    // Records are always acquired before their tile is loaded, so an unused record is either loaded or empty.
+    assert(record.m_state != TileRecord::Loading);
+    if (record.m_tile == nullptr)
+        return true;
+
+    // Track the amount of memory used by the tile cache.
+    const size_t tile_memory_size = record.m_tile->get_memory_size();
+    assert(m_memory_size >= tile_memory_size);
+    m_memory_size -= tile_memory_size;
 
     // Fetch the texture.
-    Texture* texture = textures.get_by_uid(key.m_texture_uid);
+    Texture* texture = get_texture(key);
+
+    if (m_params.m_track_tile_unloading)
+    {
+        RENDERER_LOG_DEBUG(
+            "unloading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") "
+            "from texture \"%s\"...",
+            key.get_tile_x(),
+            key.get_tile_y(),
+            texture->get_path().c_str());
+    }
+
+    // Unload the tile. Tiles of the shared tile cache and converted tiles are owned by the store.
+    if (record.m_shared_entry != SharedTileCache::InvalidEntryID)
+        m_shared_tile_cache->release(record.m_shared_entry, record.m_tile);
+    else if (record.m_converted)
+        delete record.m_tile;
+    else texture->unload_tile(key.get_tile_x(), key.get_tile_y(), record.m_tile);
+
+    // Successfully unloaded the tile.
+    return true;
+}
+
+Tile* TextureStore::TileSwapper::load_tile(
+    const TileKey&      key,
+    bool&               converted,
+    uint64&             shared_entry) const
+{
+    // Fetch the texture.
+    Texture* texture = get_texture(key);
+
+    converted = false;
+    shared_entry = SharedTileCache::InvalidEntryID;
+
+    // Look the tile up in the shared tile cache before decoding it.
+    const bool share_tile = m_shared_tile_cache != nullptr && texture->get_filepath() != nullptr;
+    SharedTileCache::TileKey shared_key;
+    if (share_tile)
+    {
+        shared_key.m_filepath = texture->get_filepath();
+        shared_key.m_tile_xy = key.m_tile_xy;
+        shared_key.m_mip_level = key.m_mip_level;
+        shared_key.m_variant =
+            static_cast<uint32>(texture->get_color_space()) * 2 + (m_params.m_compress_tiles ? 1 : 0);
+
+        Tile* tile = m_shared_tile_cache->acquire(shared_key, shared_entry);
+        if (tile != nullptr)
+            return tile;
+    }
 
     if (m_params.m_track_tile_loading)
     {
@@ -196,8 +627,18 @@ void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
     }
 
     // Load the tile.
-    record.m_tile = texture->load_tile(key.get_tile_x(), key.get_tile_y());
-    record.m_owners = 0;
+    MemoryTagScope memory_tag_scope(MemoryTagTextures);
+    Tile* tile = texture->load_mip_level_tile(key.get_mip_level(), key.get_tile_x(), key.get_tile_y());
+
+    // Store floating-point tiles in half precision.
+    if (m_params.m_compress_tiles &&
+        (tile->get_pixel_format() == PixelFormatFloat || tile->get_pixel_format() == PixelFormatDouble))
+    {
+        Tile* half_tile = new Tile(*tile, PixelFormatHalf);
+        texture->unload_tile(key.get_tile_x(), key.get_tile_y(), tile);
+        tile = half_tile;
+        converted = true;
+    }
 
     // Convert the tile to the linear RGB color space.
     switch (texture->get_color_space())
@@ -206,85 +647,73 @@ void TextureStore::TileSwapper::load(const TileKey& key, TileRecord& record)
         break;
 
       case ColorSpaceSRGB:
-        convert_tile_srgb_to_linear_rgb(*record.m_tile);
+        // 8-bit tiles of compressed stores are decoded when texels are fetched.
+        if (!m_params.m_compress_tiles || tile->get_pixel_format() != PixelFormatUInt8)
+            convert_tile_srgb_to_linear_rgb(*tile);
         break;
 
       case ColorSpaceCIEXYZ:
-        convert_tile_ciexyz_to_linear_rgb(*record.m_tile);
+        convert_tile_ciexyz_to_linear_rgb(*tile);
         break;
 
       assert_otherwise;
     }
 
+    // Move the tile to the shared tile cache.
+    if (share_tile)
+    {
+        Tile* shared_tile = m_shared_tile_cache->insert(shared_key, *tile, shared_entry);
+        if (shared_tile != nullptr)
+        {
+            if (converted)
+                delete tile;
+            else texture->unload_tile(key.get_tile_x(), key.get_tile_y(), tile);
+
+            tile = shared_tile;
+            converted = false;
+        }
+    }
+
+    return tile;
+}
+
+void TextureStore::TileSwapper::track_loaded_tile(const Tile& tile)
+{
     // Track the amount of memory used by the tile cache.
-    m_memory_size += record.m_tile->get_memory_size();
+    m_memory_size += tile.get_memory_size();
     m_peak_memory_size = max(m_peak_memory_size, m_memory_size);
 
     if (m_params.m_track_store_size)
     {
-        if (m_memory_size > m_params.m_memory_limit)
+        if (m_memory_size > m_memory_limit)
         {
             RENDERER_LOG_DEBUG(
-                "texture store size is %s, exceeding capacity %s by %s",
+                "texture store shard size is %s, exceeding capacity %s by %s",
                 pretty_size(m_memory_size).c_str(),
-                pretty_size(m_params.m_memory_limit).c_str(),
-                pretty_size(m_memory_size - m_params.m_memory_limit).c_str());
+                pretty_size(m_memory_limit).c_str(),
+                pretty_size(m_memory_size - m_memory_limit).c_str());
         }
         else
         {
             RENDERER_LOG_DEBUG(
-                "texture store size is %s, below capacity %s by %s",
+                "texture store shard size is %s, below capacity %s by %s",
                 pretty_size(m_memory_size).c_str(),
-                pretty_size(m_params.m_memory_limit).c_str(),
-                pretty_size(m_params.m_memory_limit - m_memory_size).c_str());
+                pretty_size(m_memory_limit).c_str(),
+                pretty_size(m_memory_limit - m_memory_size).c_str());
         }
     }
 }
 
-bool TextureStore::TileSwapper::unload(const TileKey& key, TileRecord& record)
+Texture* TextureStore::TileSwapper::get_texture(const TileKey& key) const
 {
-    // Cannot unload tiles that are still in use.
-    if (atomic_read(&record.m_owners) > 0)
-        return false;
-
-    // Track the amount of memory used by the tile cache.
-    const size_t tile_memory_size = record.m_tile->get_memory_size();
-    assert(m_memory_size >= tile_memory_size);
-    m_memory_size -= tile_memory_size;
-
     // Fetch the texture container.
     const TextureContainer& textures =
         key.m_assembly_uid == ~UniqueID(0)
             ? m_scene.textures()
-            : m_assemblies[key.m_assembly_uid]->textures();
+            : m_assemblies.find(key.m_assembly_uid)->second->textures();
 
     // Fetch the texture.
-    Texture* texture = textures.get_by_uid(key.m_texture_uid);
-
-    if (m_params.m_track_tile_unloading)
-    {
-        RENDERER_LOG_DEBUG(
-            "unloading tile (" FMT_SIZE_T ", " FMT_SIZE_T ") "
-            "from texture \"%s\"...",
-            key.get_tile_x(),
-            key.get_tile_y(),
-            texture->get_path().c_str());
-    }
-
-    // Unload the tile.
-    texture->unload_tile(key.get_tile_x(), key.get_tile_y(), record.m_tile);
-
-    // Successfully unloaded the tile.
-    return true;
-}
-
-void TextureStore::TileSwapper::gather_assemblies(const AssemblyContainer& assemblies)
-{
-    for (const_each<AssemblyContainer> i = assemblies; i; ++i)
-    {
-        m_assemblies[i->get_uid()] = &*i;
-        gather_assemblies(i->assemblies());
-    }
+    return textures.get_by_uid(key.m_texture_uid);
 }
 
 
@@ -293,12 +722,11 @@ void TextureStore::TileSwapper::gather_assemblies(const AssemblyContainer& assem
 //
 
 TextureStore::TileSwapper::Parameters::Parameters(const ParamArray& params)
-  : m_memory_limit(params.get_optional<size_t>("max_size", 256 * 1024 * 1024))
-  , m_track_tile_loading(params.get_optional<bool>("track_tile_loading", false))
+  : m_track_tile_loading(params.get_optional<bool>("track_tile_loading", false))
   , m_track_tile_unloading(params.get_optional<bool>("track_tile_unloading", false))
   , m_track_store_size(params.get_optional<bool>("track_store_size", false))
+  , m_compress_tiles(params.get_optional<bool>("compress_tiles", false))
 {
-    assert(m_memory_limit > 0);
 }
 
 }   // namespace renderer
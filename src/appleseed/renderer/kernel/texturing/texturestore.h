@@ -39,12 +39,20 @@
 #include "foundation/platform/thread.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/cache.h"
+#include "foundation/utility/job/jobmanager.h"
+#include "foundation/utility/job/jobqueue.h"
 #include "foundation/utility/uid.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
 // Standard headers.
 #include <cassert>
 #include <cstddef>
 #include <map>
+#include <memory>
+#include <set>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class Dictionary; }
@@ -52,6 +60,9 @@ namespace foundation    { class StatisticsVector; }
 namespace foundation    { class Tile; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class Scene; }
+namespace renderer      { class SharedTileCache; }
+namespace renderer      { class Texture; }
+namespace renderer      { class TextureWorkingSetAnalyzer; }
 
 namespace renderer
 {
@@ -59,6 +70,27 @@ namespace renderer
 //
 // A shared store for texture tiles (the backend of the thread-local texture cache).
 //
+// The store is split into a number of shards, each holding a LRU cache protected by
+// its own lock and limited to its own share of the memory budget. Tile keys are hashed
+// to shards. Tiles are loaded outside of the shard lock: a thread that requests a tile
+// which is being loaded by another thread waits for that tile only.
+//
+// Tiles can also be prefetched: prefetch requests are serviced asynchronously by a
+// small pool of I/O threads, separate from the rendering threads, so that the tiles
+// are (hopefully) resident by the time the rendering threads need them.
+//
+// Optionally, tiles can be held in a compact form to fit more of them in the memory
+// budget: floating-point tiles are converted to half precision, and 8-bit tiles of
+// sRGB textures are kept in the sRGB color space, to be decoded when texels are
+// fetched (see is_tile_compression_enabled()).
+//
+// Optionally, the tile accesses can be recorded to analyze the working set of the
+// render and recommend store sizes (see get_working_set_statistics()).
+//
+// Optionally, tiles of textures read from files can be shared with the other render
+// processes of the machine through a shared memory tile cache (see SharedTileCache):
+// tiles found there are not decoded again, and decoded tiles are moved there.
+//
 
 class TextureStore
   : public foundation::NonCopyable
@@ -70,6 +102,7 @@ class TextureStore
         foundation::UniqueID    m_assembly_uid;
         foundation::UniqueID    m_texture_uid;
         foundation::uint32      m_tile_xy;
+        foundation::uint32      m_mip_level;
 
         TileKey();
 
@@ -77,7 +110,8 @@ class TextureStore
             const foundation::UniqueID  assembly_uid,
             const foundation::UniqueID  texture_uid,
             const size_t                tile_x,
-            const size_t                tile_y);
+            const size_t                tile_y,
+            const size_t                mip_level = 0);
 
         TileKey(
             const foundation::UniqueID  assembly_uid,
@@ -88,6 +122,7 @@ class TextureStore
 
         size_t get_tile_x() const;
         size_t get_tile_y() const;
+        size_t get_mip_level() const;
 
         // Return an invalid key.
         static TileKey invalid();
@@ -105,8 +140,18 @@ class TextureStore
 
     struct TileRecord
     {
+        enum State
+        {
+            Empty,                              // the tile needs to be loaded
+            Loading,                            // the tile is being loaded by a thread
+            Loaded                              // the tile is ready to be used
+        };
+
         foundation::Tile*           m_tile;
         volatile foundation::uint32 m_owners;
+        volatile foundation::uint32 m_state;    // one of the State values
+        bool                        m_converted;    // the tile is a converted copy owned by the store
+        foundation::uint64          m_shared_entry; // entry of the shared tile cache holding the tile's pixels, if any
     };
 
     // Return parameters metadata.
@@ -120,16 +165,39 @@ class TextureStore
         const Scene&        scene,
         const ParamArray&   params = ParamArray());
 
+    // Destructor.
+    ~TextureStore();
+
     // Acquire an element from the store. Thread-safe.
     TileRecord& acquire(const TileKey& key);
 
     // Release a previously-acquired element. Thread-safe.
     void release(TileRecord& record) const;
 
+    // Return true if tiles are held in a compact form. When this is the case, 8-bit tiles
+    // of textures in the sRGB color space are not converted to linear RGB by the store.
+    bool is_tile_compression_enabled() const;
+
+    // Return true if prefetch requests are serviced.
+    bool is_prefetching_enabled() const;
+
+    // Request the asynchronous loading of a tile. Returns immediately.
+    // Does nothing if prefetching is disabled or if the tile is already in the store. Thread-safe.
+    void prefetch(const TileKey& key);
+
     // Retrieve performance statistics.
     foundation::StatisticsVector get_statistics() const;
 
+    // Return true if tile accesses are recorded to analyze the working set.
+    bool is_working_set_analysis_enabled() const;
+
+    // Retrieve the working set analysis: store sizes reaching various hit rates,
+    // working sets of the textures accessed, and textures that were never accessed.
+    foundation::StatisticsVector get_working_set_statistics() const;
+
   private:
+    typedef std::map<foundation::UniqueID, const Assembly*> AssemblyMap;
+
     class TileSwapper
       : public foundation::NonCopyable
     {
@@ -137,9 +205,12 @@ class TextureStore
         // Constructor.
         TileSwapper(
             const Scene&        scene,
-            const ParamArray&   params);
+            const AssemblyMap&  assemblies,
+            const ParamArray&   params,
+            const size_t        memory_limit,
+            SharedTileCache*    shared_tile_cache);
 
-        // Load a cache line.
+        // Load a cache line. The tile itself is loaded later by load_tile().
         void load(const TileKey& key, TileRecord& record);
 
         // Unload a cache line.
@@ -148,29 +219,39 @@ class TextureStore
         // Return true if the cache is full, false otherwise.
         bool is_full(const size_t element_count) const;
 
+        // Load and convert a tile, or acquire it from the shared tile cache.
+        // Thread-safe, does not require the shard lock.
+        foundation::Tile* load_tile(
+            const TileKey&      key,
+            bool&               converted,
+            foundation::uint64& shared_entry) const;
+
+        // Account for a tile returned by load_tile(). Requires the shard lock.
+        void track_loaded_tile(const foundation::Tile& tile);
+
         // Return the peak memory size in bytes of the tile cache.
         size_t get_peak_memory_size() const;
 
       private:
         struct Parameters
         {
-            const size_t    m_memory_limit;
             const bool      m_track_tile_loading;
             const bool      m_track_tile_unloading;
             const bool      m_track_store_size;
+            const bool      m_compress_tiles;
 
             explicit Parameters(const ParamArray& params);
         };
 
-        typedef std::map<foundation::UniqueID, const Assembly*> AssemblyMap;
-
         const Scene&        m_scene;
+        const AssemblyMap&  m_assemblies;
         const Parameters    m_params;
+        const size_t        m_memory_limit;
+        SharedTileCache*    m_shared_tile_cache;
         size_t              m_memory_size;
         size_t              m_peak_memory_size;
-        AssemblyMap         m_assemblies;
 
-        void gather_assemblies(const AssemblyContainer& assemblies);
+        Texture* get_texture(const TileKey& key) const;
     };
 
     typedef foundation::LRUCache<
@@ -180,10 +261,55 @@ class TextureStore
         TileSwapper
     > TileCache;
 
-    boost::mutex            m_mutex;
-    TileKeyHasher           m_tile_key_hasher;
-    TileSwapper             m_tile_swapper;
-    TileCache               m_tile_cache;
+    struct Shard
+      : public foundation::NonCopyable
+    {
+        boost::mutex        m_mutex;
+        TileKeyHasher       m_tile_key_hasher;
+        TileSwapper         m_tile_swapper;
+        TileCache           m_tile_cache;
+        std::set<TileKey>   m_pending_prefetches;
+
+        Shard(
+            const Scene&        scene,
+            const AssemblyMap&  assemblies,
+            const ParamArray&   params,
+            const size_t        memory_limit,
+            SharedTileCache*    shared_tile_cache);
+    };
+
+    typedef std::vector<Shard*> ShardVector;
+
+    class PrefetchJob;
+
+    const bool                                  m_compress_tiles;
+    TileKeyHasher                               m_tile_key_hasher;
+    AssemblyMap                                 m_assemblies;
+    std::unique_ptr<SharedTileCache>            m_shared_tile_cache;
+    ShardVector                                 m_shards;
+
+    // Prefetching.
+    foundation::JobQueue                        m_prefetch_job_queue;
+    std::unique_ptr<foundation::JobManager>     m_prefetch_job_manager;
+    boost::atomic<foundation::uint64>           m_prefetch_count;
+
+    // Working set analysis.
+    const Scene&                                m_scene;
+    std::unique_ptr<TextureWorkingSetAnalyzer>  m_working_set_analyzer;
+
+    void gather_assemblies(const AssemblyContainer& assemblies);
+
+    // Acquire an element from the store without recording the access. Thread-safe.
+    TileRecord& acquire_tile(const TileKey& key);
+
+    // Record an access to a loaded tile for the working set analysis. Thread-safe.
+    void record_access(const TileKey& key, const TileRecord& record);
+
+    // Return the shard a given tile belongs to.
+    Shard& get_shard(const TileKey& key);
+
+    // Load the tile of a record, or wait until another thread has loaded it.
+    void load_tile(Shard& shard, const TileKey& key, TileRecord& record);
 };
 
 
@@ -193,20 +319,61 @@ class TextureStore
 
 inline TextureStore::TileRecord& TextureStore::acquire(const TileKey& key)
 {
-    boost::mutex::scoped_lock lock(m_mutex);
+    TileRecord& record = acquire_tile(key);
 
-    TileRecord& record = m_tile_cache.get(key);
-    foundation::atomic_inc(&record.m_owners);
+    if (m_working_set_analyzer)
+        record_access(key, record);
 
     return record;
 }
 
+inline TextureStore::TileRecord& TextureStore::acquire_tile(const TileKey& key)
+{
+    Shard& shard = get_shard(key);
+
+    TileRecord* record;
+
+    {
+        boost::mutex::scoped_lock lock(shard.m_mutex);
+
+        // Acquiring the record under the lock prevents it from being evicted while the tile is loaded.
+        record = &shard.m_tile_cache.get(key);
+        foundation::atomic_inc(&record->m_owners);
+    }
+
+    if (foundation::atomic_read(&record->m_state) != TileRecord::Loaded)
+        load_tile(shard, key, *record);
+
+    return *record;
+}
+
 inline void TextureStore::release(TileRecord& record) const
 {
     assert(foundation::atomic_read(&record.m_owners) > 0);
     foundation::atomic_dec(&record.m_owners);
 }
 
+inline bool TextureStore::is_tile_compression_enabled() const
+{
+    return m_compress_tiles;
+}
+
+inline bool TextureStore::is_prefetching_enabled() const
+{
+    return m_prefetch_job_manager != nullptr;
+}
+
+inline bool TextureStore::is_working_set_analysis_enabled() const
+{
+    return m_working_set_analyzer != nullptr;
+}
+
+inline TextureStore::Shard& TextureStore::get_shard(const TileKey& key)
+{
+    // Use the high bits of the hash to select the shard, the low bits are used by the cache index.
+    return *m_shards[(m_tile_key_hasher(key) >> 16) % m_shards.size()];
+}
+
 
 //
 // TextureStore::TileKey class implementation.
@@ -220,10 +387,12 @@ inline TextureStore::TileKey::TileKey(
     const foundation::UniqueID  assembly_uid,
     const foundation::UniqueID  texture_uid,
     const size_t                tile_x,
-    const size_t                tile_y)
+    const size_t                tile_y,
+    const size_t                mip_level)
   : m_assembly_uid(assembly_uid)
   , m_texture_uid(texture_uid)
   , m_tile_xy(static_cast<foundation::uint32>((tile_y << 16) | tile_x))
+  , m_mip_level(static_cast<foundation::uint32>(mip_level))
 {
     assert(tile_x < (1UL << 16));
     assert(tile_y < (1UL << 16));
@@ -236,6 +405,7 @@ inline TextureStore::TileKey::TileKey(
   : m_assembly_uid(assembly_uid)
   , m_texture_uid(texture_uid)
   , m_tile_xy(tile_xy)
+  , m_mip_level(0)
 {
 }
 
@@ -243,6 +413,7 @@ inline TextureStore::TileKey::TileKey(const TileKey& rhs)
   : m_assembly_uid(rhs.m_assembly_uid)
   , m_texture_uid(rhs.m_texture_uid)
   , m_tile_xy(rhs.m_tile_xy)
+  , m_mip_level(rhs.m_mip_level)
 {
 }
 
@@ -256,6 +427,11 @@ inline size_t TextureStore::TileKey::get_tile_y() const
     return static_cast<size_t>(m_tile_xy >> 16);
 }
 
+inline size_t TextureStore::TileKey::get_mip_level() const
+{
+    return static_cast<size_t>(m_mip_level);
+}
+
 inline TextureStore::TileKey TextureStore::TileKey::invalid()
 {
     return
@@ -269,6 +445,7 @@ inline bool TextureStore::TileKey::operator==(const TileKey& rhs) const
 {
     return
         m_tile_xy == rhs.m_tile_xy &&
+        m_mip_level == rhs.m_mip_level &&
         m_texture_uid == rhs.m_texture_uid &&
         m_assembly_uid == rhs.m_assembly_uid;
 }
@@ -283,7 +460,9 @@ inline bool TextureStore::TileKey::operator<(const TileKey& rhs) const
     return
         m_assembly_uid == rhs.m_assembly_uid ?
             m_texture_uid == rhs.m_texture_uid ?
-                m_tile_xy < rhs.m_tile_xy :
+                m_mip_level == rhs.m_mip_level ?
+                    m_tile_xy < rhs.m_tile_xy :
+                m_mip_level < rhs.m_mip_level :
             m_texture_uid < rhs.m_texture_uid :
         m_assembly_uid < rhs.m_assembly_uid;
 }
@@ -299,7 +478,8 @@ inline size_t TextureStore::TileKeyHasher::operator()(const TileKey& key) const
         foundation::mix_uint32(
             static_cast<foundation::uint32>(key.m_assembly_uid),
             static_cast<foundation::uint32>(key.m_texture_uid),
-            static_cast<foundation::uint32>(key.m_tile_xy));
+            static_cast<foundation::uint32>(key.m_tile_xy),
+            static_cast<foundation::uint32>(key.m_mip_level));
 }
 
 
@@ -309,7 +489,7 @@ inline size_t TextureStore::TileKeyHasher::operator()(const TileKey& key) const
 
 inline bool TextureStore::TileSwapper::is_full(const size_t element_count) const
 {
-    return m_memory_size >= m_params.m_memory_limit;
+    return m_memory_size >= m_memory_limit;
 }
 
 inline size_t TextureStore::TileSwapper::get_peak_memory_size() const
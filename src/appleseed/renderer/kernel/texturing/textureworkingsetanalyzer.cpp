@@ -0,0 +1,281 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "textureworkingsetanalyzer.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// TextureWorkingSetAnalyzer class implementation.
+//
+
+namespace
+{
+    const size_t MinTimelineSize = 1024;
+    const size_t DistanceBucketCount = 4 * 63 + 4;
+
+    // Map a reuse distance to a histogram bucket. Distances below 8 have their own
+    // bucket, larger distances share buckets spanning a quarter of a power of two.
+    size_t distance_to_bucket(const uint64 distance)
+    {
+        if (distance < 8)
+            return static_cast<size_t>(distance);
+
+        const size_t e = static_cast<size_t>(log2_int(distance));
+        const size_t m = static_cast<size_t>(distance >> (e - 2)) & 3;
+
+        return 4 * (e - 1) + m;
+    }
+
+    // Return the largest distance mapped to a given histogram bucket.
+    uint64 bucket_to_max_distance(const size_t bucket)
+    {
+        if (bucket < 8)
+            return static_cast<uint64>(bucket);
+
+        const size_t e = bucket / 4 + 1;
+        const uint64 m = static_cast<uint64>(bucket % 4);
+
+        return ((5 + m) << (e - 2)) - 1;
+    }
+}
+
+TextureWorkingSetAnalyzer::TextureWorkingSetAnalyzer()
+  : m_time(0)
+  , m_access_count(0)
+  , m_cold_miss_count(0)
+  , m_memory_size(0)
+  , m_distance_histogram(DistanceBucketCount, 0)
+{
+}
+
+void TextureWorkingSetAnalyzer::record_access(const TileKey& key, const size_t tile_size)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_time == m_timeline.size())
+        compact_timeline();
+
+    ++m_access_count;
+
+    const pair<TileMap::iterator, bool> result = m_tiles.insert(make_pair(key, TileState()));
+    TileState& tile = result.first->second;
+
+    if (result.second)
+    {
+        // First access to this tile.
+        tile.m_size = tile_size;
+        tile.m_access_count = 0;
+        m_memory_size += tile_size;
+        ++m_cold_miss_count;
+    }
+    else
+    {
+        // Total size of the tiles accessed since the previous access to this tile, this tile included.
+        const uint64 distance =
+            sum_timeline(m_time) - sum_timeline(tile.m_time + 1) + tile.m_size;
+        ++m_distance_histogram[distance_to_bucket(distance)];
+
+        // Unsigned arithmetic wraps around: removing a size from the tree is exact.
+        add_to_timeline(tile.m_time, ~uint64(tile.m_size) + 1);
+    }
+
+    tile.m_time = m_time++;
+    ++tile.m_access_count;
+    add_to_timeline(tile.m_time, tile.m_size);
+}
+
+uint64 TextureWorkingSetAnalyzer::get_access_count() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_access_count;
+}
+
+uint64 TextureWorkingSetAnalyzer::get_cold_miss_count() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_cold_miss_count;
+}
+
+size_t TextureWorkingSetAnalyzer::get_tile_count() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_tiles.size();
+}
+
+size_t TextureWorkingSetAnalyzer::get_memory_size() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_memory_size;
+}
+
+double TextureWorkingSetAnalyzer::get_hit_rate(const size_t store_size) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    if (m_access_count == 0)
+        return 0.0;
+
+    // Only count buckets whose distances all fit in the store.
+    uint64 hit_count = 0;
+    for (size_t i = 0; i < DistanceBucketCount; ++i)
+    {
+        if (bucket_to_max_distance(i) > store_size)
+            break;
+        hit_count += m_distance_histogram[i];
+    }
+
+    return static_cast<double>(hit_count) / m_access_count;
+}
+
+size_t TextureWorkingSetAnalyzer::get_store_size_for_hit_rate(const double hit_rate) const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    const double target_hit_count = hit_rate * m_access_count;
+    if (target_hit_count > m_access_count - m_cold_miss_count)
+        return 0;
+
+    uint64 hit_count = 0;
+    for (size_t i = 0; i < DistanceBucketCount; ++i)
+    {
+        hit_count += m_distance_histogram[i];
+        if (hit_count >= target_hit_count)
+            return static_cast<size_t>(bucket_to_max_distance(i));
+    }
+
+    return 0;
+}
+
+TextureWorkingSetAnalyzer::TextureWorkingSetVector TextureWorkingSetAnalyzer::get_texture_working_sets() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    typedef map<pair<UniqueID, UniqueID>, TextureWorkingSet> TextureMap;
+    TextureMap textures;
+
+    for (TileMap::const_iterator i = m_tiles.begin(), e = m_tiles.end(); i != e; ++i)
+    {
+        const pair<TextureMap::iterator, bool> result =
+            textures.insert(
+                make_pair(
+                    make_pair(i->first.m_assembly_uid, i->first.m_texture_uid),
+                    TextureWorkingSet()));
+
+        TextureWorkingSet& working_set = result.first->second;
+
+        if (result.second)
+        {
+            working_set.m_assembly_uid = i->first.m_assembly_uid;
+            working_set.m_texture_uid = i->first.m_texture_uid;
+            working_set.m_access_count = 0;
+            working_set.m_tile_count = 0;
+            working_set.m_memory_size = 0;
+        }
+
+        working_set.m_access_count += i->second.m_access_count;
+        working_set.m_tile_count += 1;
+        working_set.m_memory_size += i->second.m_size;
+
+        const size_t bucket = static_cast<size_t>(log2_int(i->second.m_access_count));
+        if (working_set.m_tile_access_histogram.size() <= bucket)
+            working_set.m_tile_access_histogram.resize(bucket + 1, 0);
+        ++working_set.m_tile_access_histogram[bucket];
+    }
+
+    TextureWorkingSetVector working_sets;
+    working_sets.reserve(textures.size());
+
+    for (TextureMap::const_iterator i = textures.begin(), e = textures.end(); i != e; ++i)
+        working_sets.push_back(i->second);
+
+    sort(
+        working_sets.begin(),
+        working_sets.end(),
+        [](const TextureWorkingSet& lhs, const TextureWorkingSet& rhs)
+        {
+            return lhs.m_memory_size > rhs.m_memory_size;
+        });
+
+    return working_sets;
+}
+
+void TextureWorkingSetAnalyzer::compact_timeline()
+{
+    // Order the tiles by time of last access.
+    vector<pair<size_t, TileState*>> tiles;
+    tiles.reserve(m_tiles.size());
+    for (TileMap::iterator i = m_tiles.begin(), e = m_tiles.end(); i != e; ++i)
+        tiles.emplace_back(i->second.m_time, &i->second);
+    sort(tiles.begin(), tiles.end());
+
+    // Renumber them without gaps in a timeline with room for as many accesses.
+    m_timeline.assign(max(2 * tiles.size(), MinTimelineSize), 0);
+    for (size_t i = 0, e = tiles.size(); i < e; ++i)
+    {
+        tiles[i].second->m_time = i;
+        add_to_timeline(i, tiles[i].second->m_size);
+    }
+
+    m_time = tiles.size();
+}
+
+void TextureWorkingSetAnalyzer::add_to_timeline(const size_t time, const uint64 value)
+{
+    assert(time < m_timeline.size());
+
+    for (size_t i = time + 1, e = m_timeline.size(); i <= e; i += i & (~i + 1))
+        m_timeline[i - 1] += value;
+}
+
+uint64 TextureWorkingSetAnalyzer::sum_timeline(const size_t end) const
+{
+    assert(end <= m_timeline.size());
+
+    uint64 sum = 0;
+
+    for (size_t i = end; i > 0; i -= i & (~i + 1))
+        sum += m_timeline[i - 1];
+
+    return sum;
+}
+
+}   // namespace renderer
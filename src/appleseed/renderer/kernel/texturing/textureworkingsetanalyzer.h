@@ -0,0 +1,136 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/texturing/texturestore.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/uid.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace renderer
+{
+
+//
+// Records the tile accesses of a texture store in order to characterize its working set.
+//
+// For every access to a tile that was accessed before, the reuse distance is the total
+// size of the distinct tiles accessed since the previous access to that tile, including
+// the tile itself. A LRU store whose size is at least the reuse distance of an access
+// would have hit. The distances are tracked with a Fenwick tree over the access timeline,
+// and accumulated in a histogram with four buckets per power of two.
+//
+// The texture store is split into shards with their own LRU cache. Since tiles are
+// spread evenly across shards, the analysis treats the store as a single LRU cache.
+//
+
+class TextureWorkingSetAnalyzer
+  : public foundation::NonCopyable
+{
+  public:
+    typedef TextureStore::TileKey TileKey;
+
+    // Accesses to the tiles of a given texture.
+    struct TextureWorkingSet
+    {
+        foundation::UniqueID                m_assembly_uid;
+        foundation::UniqueID                m_texture_uid;
+        foundation::uint64                  m_access_count;
+        size_t                              m_tile_count;               // number of distinct tiles accessed
+        size_t                              m_memory_size;              // total size of the distinct tiles accessed
+        std::vector<foundation::uint64>     m_tile_access_histogram;    // number of tiles accessed [2^i, 2^(i+1)) times
+    };
+
+    typedef std::vector<TextureWorkingSet> TextureWorkingSetVector;
+
+    // Constructor.
+    TextureWorkingSetAnalyzer();
+
+    // Record an access to a tile of a given size in bytes. Thread-safe.
+    void record_access(const TileKey& key, const size_t tile_size);
+
+    // Return the number of recorded accesses.
+    foundation::uint64 get_access_count() const;
+
+    // Return the number of accesses to tiles that were never accessed before.
+    foundation::uint64 get_cold_miss_count() const;
+
+    // Return the number of distinct tiles accessed.
+    size_t get_tile_count() const;
+
+    // Return the total size in bytes of the distinct tiles accessed.
+    size_t get_memory_size() const;
+
+    // Return the hit rate a LRU store of a given size in bytes would have reached.
+    double get_hit_rate(const size_t store_size) const;
+
+    // Return the smallest size in bytes of a LRU store reaching a given hit rate,
+    // or 0 if cold misses alone prevent reaching it.
+    size_t get_store_size_for_hit_rate(const double hit_rate) const;
+
+    // Return the working sets of the textures accessed, by decreasing size.
+    TextureWorkingSetVector get_texture_working_sets() const;
+
+  private:
+    struct TileState
+    {
+        size_t                              m_time;                     // time of the last access
+        size_t                              m_size;
+        foundation::uint64                  m_access_count;
+    };
+
+    typedef std::map<TileKey, TileState> TileMap;
+
+    mutable boost::mutex                    m_mutex;
+    TileMap                                 m_tiles;
+    std::vector<foundation::uint64>         m_timeline;                 // Fenwick tree of tile sizes at the time of their last access
+    size_t                                  m_time;
+    foundation::uint64                      m_access_count;
+    foundation::uint64                      m_cold_miss_count;
+    size_t                                  m_memory_size;
+    std::vector<foundation::uint64>         m_distance_histogram;
+
+    // Renumber the last access times of the tiles to make room in the timeline.
+    void compact_timeline();
+
+    void add_to_timeline(const size_t time, const foundation::uint64 value);
+    foundation::uint64 sum_timeline(const size_t end) const;
+};
+
+}   // namespace renderer
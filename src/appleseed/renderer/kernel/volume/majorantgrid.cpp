@@ -0,0 +1,219 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "majorantgrid.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// MajorantGrid class implementation.
+//
+
+namespace
+{
+    size_t compute_cell_count(const size_t voxel_count, const size_t cell_size)
+    {
+        return max<size_t>((voxel_count + cell_size - 1) / cell_size, 1);
+    }
+
+    // Return the range of voxels contributing to nearest and trilinear lookups in [a, b].
+    void compute_voxel_range(
+        const double    a,
+        const double    b,
+        const size_t    voxel_count,
+        size_t&         begin,
+        size_t&         end)
+    {
+        begin = truncate<size_t>(a * (voxel_count - 1));
+        end = min(truncate<size_t>(b * voxel_count) + 2, voxel_count);
+    }
+}
+
+MajorantGrid::MajorantGrid(
+    const VoxelGrid&    voxel_grid,
+    const size_t        density_channel_index,
+    const size_t        cell_size)
+  : m_grid(
+        compute_cell_count(voxel_grid.get_xres(), max<size_t>(cell_size, 1)),
+        compute_cell_count(voxel_grid.get_yres(), max<size_t>(cell_size, 1)),
+        compute_cell_count(voxel_grid.get_zres(), max<size_t>(cell_size, 1)),
+        1)
+  , m_max_majorant(0.0f)
+{
+    initialize(voxel_grid, density_channel_index);
+}
+
+MajorantGrid::MajorantGrid(
+    const SparseVoxelGrid&  voxel_grid,
+    const size_t            density_channel_index,
+    const size_t            cell_size)
+  : m_grid(
+        compute_cell_count(voxel_grid.get_xres(), max<size_t>(cell_size, 1)),
+        compute_cell_count(voxel_grid.get_yres(), max<size_t>(cell_size, 1)),
+        compute_cell_count(voxel_grid.get_zres(), max<size_t>(cell_size, 1)),
+        1)
+  , m_max_majorant(0.0f)
+{
+    initialize(voxel_grid, density_channel_index);
+}
+
+void MajorantGrid::initialize(
+    const VoxelGrid&    voxel_grid,
+    const size_t        density_channel_index)
+{
+    assert(density_channel_index < voxel_grid.get_channel_count());
+
+    const size_t xres = m_grid.get_xres();
+    const size_t yres = m_grid.get_yres();
+    const size_t zres = m_grid.get_zres();
+
+    for (size_t z = 0; z < zres; ++z)
+    {
+        size_t vz_begin, vz_end;
+        compute_voxel_range(
+            static_cast<double>(z) / zres,
+            static_cast<double>(z + 1) / zres,
+            voxel_grid.get_zres(),
+            vz_begin,
+            vz_end);
+
+        for (size_t y = 0; y < yres; ++y)
+        {
+            size_t vy_begin, vy_end;
+            compute_voxel_range(
+                static_cast<double>(y) / yres,
+                static_cast<double>(y + 1) / yres,
+                voxel_grid.get_yres(),
+                vy_begin,
+                vy_end);
+
+            for (size_t x = 0; x < xres; ++x)
+            {
+                size_t vx_begin, vx_end;
+                compute_voxel_range(
+                    static_cast<double>(x) / xres,
+                    static_cast<double>(x + 1) / xres,
+                    voxel_grid.get_xres(),
+                    vx_begin,
+                    vx_end);
+
+                float majorant = 0.0f;
+
+                for (size_t vz = vz_begin; vz < vz_end; ++vz)
+                {
+                    for (size_t vy = vy_begin; vy < vy_end; ++vy)
+                    {
+                        for (size_t vx = vx_begin; vx < vx_end; ++vx)
+                        {
+                            const float density = voxel_grid.voxel(vx, vy, vz)[density_channel_index];
+                            assert(density >= 0.0f);
+                            majorant = max(majorant, density);
+                        }
+                    }
+                }
+
+                m_grid.voxel(x, y, z)[0] = majorant;
+                m_max_majorant = max(m_max_majorant, majorant);
+            }
+        }
+    }
+}
+
+void MajorantGrid::initialize(
+    const SparseVoxelGrid&  voxel_grid,
+    const size_t            density_channel_index)
+{
+    assert(density_channel_index < voxel_grid.get_channel_count());
+
+    const size_t xres = m_grid.get_xres();
+    const size_t yres = m_grid.get_yres();
+    const size_t zres = m_grid.get_zres();
+    const size_t LeafLog2 = SparseVoxelGrid::LeafLog2;
+
+    for (size_t z = 0; z < zres; ++z)
+    {
+        size_t vz_begin, vz_end;
+        compute_voxel_range(
+            static_cast<double>(z) / zres,
+            static_cast<double>(z + 1) / zres,
+            voxel_grid.get_zres(),
+            vz_begin,
+            vz_end);
+
+        for (size_t y = 0; y < yres; ++y)
+        {
+            size_t vy_begin, vy_end;
+            compute_voxel_range(
+                static_cast<double>(y) / yres,
+                static_cast<double>(y + 1) / yres,
+                voxel_grid.get_yres(),
+                vy_begin,
+                vy_end);
+
+            for (size_t x = 0; x < xres; ++x)
+            {
+                size_t vx_begin, vx_end;
+                compute_voxel_range(
+                    static_cast<double>(x) / xres,
+                    static_cast<double>(x + 1) / xres,
+                    voxel_grid.get_xres(),
+                    vx_begin,
+                    vx_end);
+
+                float majorant = 0.0f;
+
+                for (size_t lz = vz_begin >> LeafLog2; lz <= (vz_end - 1) >> LeafLog2; ++lz)
+                {
+                    for (size_t ly = vy_begin >> LeafLog2; ly <= (vy_end - 1) >> LeafLog2; ++ly)
+                    {
+                        for (size_t lx = vx_begin >> LeafLog2; lx <= (vx_end - 1) >> LeafLog2; ++lx)
+                        {
+                            const float density = voxel_grid.get_leaf_max(lx, ly, lz, density_channel_index);
+                            assert(density >= 0.0f);
+                            majorant = max(majorant, density);
+                        }
+                    }
+                }
+
+                m_grid.voxel(x, y, z)[0] = majorant;
+                m_max_majorant = max(m_max_majorant, majorant);
+            }
+        }
+    }
+}
+
+}   // namespace renderer
@@ -0,0 +1,389 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/ray.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/sparsevoxelgrid.h"
+#include "foundation/math/vector.h"
+#include "foundation/math/voxelgrid.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace renderer
+{
+
+//
+// A coarse grid of density majorants over a voxel grid.
+//
+// Each cell stores the maximum density of the voxels that contribute to nearest
+// and trilinear lookups inside the cell. A 3D-DDA walks the cells crossed by a ray
+// so that delta and ratio tracking sample free paths against the local majorant
+// instead of the global one, stepping over empty cells at no cost.
+//
+// Rays are expressed in the unit cube [0,1]^3 of the voxel grid. Distances along
+// the ray are measured in ray parameter units: extinction_scale converts densities
+// to extinction coefficients per unit of ray parameter.
+//
+
+class MajorantGrid
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor. Each cell covers cell_size^3 voxels.
+    MajorantGrid(
+        const VoxelGrid&                voxel_grid,
+        const size_t                    density_channel_index,
+        const size_t                    cell_size);
+
+    // Constructor for sparse voxel grids. Majorants are bounded by the maxima of
+    // the leaves overlapping each cell, so unallocated leaves are never visited.
+    MajorantGrid(
+        const SparseVoxelGrid&          voxel_grid,
+        const size_t                    density_channel_index,
+        const size_t                    cell_size);
+
+    // Return the resolution of the grid.
+    size_t get_xres() const;
+    size_t get_yres() const;
+    size_t get_zres() const;
+
+    // Return the majorant of a given cell.
+    float get_majorant(
+        const size_t                    x,
+        const size_t                    y,
+        const size_t                    z) const;
+
+    // Return the largest majorant of the grid.
+    float get_max_majorant() const;
+
+    // Visit the cells crossed by the segment [tmin, tmax) of a ray, in order.
+    // The visitor is called as visitor(t0, t1, majorant) for each cell and
+    // returns false to stop the traversal.
+    template <typename Visitor>
+    void traverse(
+        const foundation::Ray3d&        ray,
+        const double                    tmin,
+        const double                    tmax,
+        Visitor&                        visitor) const;
+
+    // Sample a collision distance along the segment [tmin, tmax) of a ray using delta tracking.
+    // density(t) returns the density at ray parameter t. Returns false if the ray leaves the
+    // segment without colliding.
+    template <typename DensityFunction, typename RNG>
+    bool sample_distance(
+        const foundation::Ray3d&        ray,
+        const double                    tmin,
+        const double                    tmax,
+        const float                     extinction_scale,
+        DensityFunction&                density,
+        RNG&                            rng,
+        double&                         distance) const;
+
+    // Estimate the transmission along the segment [tmin, tmax) of a ray using ratio tracking.
+    template <typename DensityFunction, typename RNG>
+    float estimate_transmission(
+        const foundation::Ray3d&        ray,
+        const double                    tmin,
+        const double                    tmax,
+        const float                     extinction_scale,
+        DensityFunction&                density,
+        RNG&                            rng) const;
+
+  private:
+    foundation::VoxelGrid3<float, double>   m_grid;
+    float                                   m_max_majorant;
+
+    void initialize(
+        const VoxelGrid&                voxel_grid,
+        const size_t                    density_channel_index);
+
+    void initialize(
+        const SparseVoxelGrid&          voxel_grid,
+        const size_t                    density_channel_index);
+};
+
+
+//
+// MajorantGrid class implementation.
+//
+
+inline size_t MajorantGrid::get_xres() const
+{
+    return m_grid.get_xres();
+}
+
+inline size_t MajorantGrid::get_yres() const
+{
+    return m_grid.get_yres();
+}
+
+inline size_t MajorantGrid::get_zres() const
+{
+    return m_grid.get_zres();
+}
+
+inline float MajorantGrid::get_majorant(
+    const size_t                        x,
+    const size_t                        y,
+    const size_t                        z) const
+{
+    return m_grid.voxel(x, y, z)[0];
+}
+
+inline float MajorantGrid::get_max_majorant() const
+{
+    return m_max_majorant;
+}
+
+template <typename Visitor>
+void MajorantGrid::traverse(
+    const foundation::Ray3d&            ray,
+    const double                        tmin,
+    const double                        tmax,
+    Visitor&                            visitor) const
+{
+    // Clip the segment against the unit cube.
+    double t0 = tmin;
+    double t1 = tmax;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        if (ray.m_dir[i] == 0.0)
+        {
+            if (ray.m_org[i] < 0.0 || ray.m_org[i] > 1.0)
+                return;
+        }
+        else
+        {
+            const double rcp_dir = 1.0 / ray.m_dir[i];
+            double t_near = -ray.m_org[i] * rcp_dir;
+            double t_far = (1.0 - ray.m_org[i]) * rcp_dir;
+            if (t_near > t_far)
+                std::swap(t_near, t_far);
+            t0 = std::max(t0, t_near);
+            t1 = std::min(t1, t_far);
+        }
+    }
+
+    if (!(t0 < t1))
+        return;
+
+    // Initialize the DDA.
+    const size_t res[3] = { m_grid.get_xres(), m_grid.get_yres(), m_grid.get_zres() };
+    size_t cell[3];
+    int step[3];
+    double t_next[3];
+    double t_delta[3];
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const double p = (ray.m_org[i] + t0 * ray.m_dir[i]) * res[i];
+        cell[i] = p <= 0.0 ? 0 : std::min(foundation::truncate<size_t>(p), res[i] - 1);
+
+        if (ray.m_dir[i] > 0.0)
+        {
+            step[i] = +1;
+            t_next[i] = (static_cast<double>(cell[i] + 1) / res[i] - ray.m_org[i]) / ray.m_dir[i];
+            t_delta[i] = 1.0 / (res[i] * ray.m_dir[i]);
+        }
+        else if (ray.m_dir[i] < 0.0)
+        {
+            step[i] = -1;
+            t_next[i] = (static_cast<double>(cell[i]) / res[i] - ray.m_org[i]) / ray.m_dir[i];
+            t_delta[i] = -1.0 / (res[i] * ray.m_dir[i]);
+        }
+        else
+        {
+            step[i] = 0;
+            t_next[i] = std::numeric_limits<double>::max();
+            t_delta[i] = 0.0;
+        }
+    }
+
+    // Walk the cells.
+    double t = t0;
+    while (true)
+    {
+        const size_t axis =
+            t_next[0] < t_next[1]
+                ? (t_next[0] < t_next[2] ? 0 : 2)
+                : (t_next[1] < t_next[2] ? 1 : 2);
+
+        const double t_exit = std::min(t_next[axis], t1);
+
+        if (t_exit > t)
+        {
+            if (!visitor(t, t_exit, m_grid.voxel(cell[0], cell[1], cell[2])[0]))
+                return;
+        }
+
+        if (t_exit >= t1)
+            return;
+
+        if (step[axis] > 0 ? cell[axis] + 1 >= res[axis] : cell[axis] == 0)
+            return;
+
+        cell[axis] += step[axis];
+        t_next[axis] += t_delta[axis];
+        t = t_exit;
+    }
+}
+
+namespace majorant_grid_impl
+{
+    template <typename DensityFunction, typename RNG>
+    struct DeltaTrackingVisitor
+    {
+        const float         m_extinction_scale;
+        DensityFunction&    m_density;
+        RNG&                m_rng;
+        bool                m_collided;
+        double              m_distance;
+
+        DeltaTrackingVisitor(
+            const float         extinction_scale,
+            DensityFunction&    density,
+            RNG&                rng)
+          : m_extinction_scale(extinction_scale)
+          , m_density(density)
+          , m_rng(rng)
+          , m_collided(false)
+        {
+        }
+
+        bool operator()(const double t0, const double t1, const float majorant)
+        {
+            const double sigma_max = static_cast<double>(majorant) * m_extinction_scale;
+            if (sigma_max <= 0.0)
+                return true;
+
+            // Free paths are memoryless: leaving the cell restarts sampling in the next one.
+            double t = t0;
+            while (true)
+            {
+                t -= std::log(1.0 - foundation::rand_float2(m_rng)) / sigma_max;
+                if (t >= t1)
+                    return true;
+
+                if (foundation::rand_float2(m_rng) * majorant < m_density(t))
+                {
+                    m_collided = true;
+                    m_distance = t;
+                    return false;
+                }
+            }
+        }
+    };
+
+    template <typename DensityFunction, typename RNG>
+    struct RatioTrackingVisitor
+    {
+        const float         m_extinction_scale;
+        DensityFunction&    m_density;
+        RNG&                m_rng;
+        float               m_transmission;
+
+        RatioTrackingVisitor(
+            const float         extinction_scale,
+            DensityFunction&    density,
+            RNG&                rng)
+          : m_extinction_scale(extinction_scale)
+          , m_density(density)
+          , m_rng(rng)
+          , m_transmission(1.0f)
+        {
+        }
+
+        bool operator()(const double t0, const double t1, const float majorant)
+        {
+            const double sigma_max = static_cast<double>(majorant) * m_extinction_scale;
+            if (sigma_max <= 0.0)
+                return true;
+
+            const float rcp_majorant = 1.0f / majorant;
+
+            double t = t0;
+            while (true)
+            {
+                t -= std::log(1.0 - foundation::rand_float2(m_rng)) / sigma_max;
+                if (t >= t1)
+                    return true;
+
+                m_transmission *= std::max(1.0f - m_density(t) * rcp_majorant, 0.0f);
+                if (m_transmission == 0.0f)
+                    return false;
+            }
+        }
+    };
+}
+
+template <typename DensityFunction, typename RNG>
+bool MajorantGrid::sample_distance(
+    const foundation::Ray3d&            ray,
+    const double                        tmin,
+    const double                        tmax,
+    const float                         extinction_scale,
+    DensityFunction&                    density,
+    RNG&                                rng,
+    double&                             distance) const
+{
+    majorant_grid_impl::DeltaTrackingVisitor<DensityFunction, RNG> visitor(extinction_scale, density, rng);
+    traverse(ray, tmin, tmax, visitor);
+
+    if (visitor.m_collided)
+        distance = visitor.m_distance;
+
+    return visitor.m_collided;
+}
+
+template <typename DensityFunction, typename RNG>
+float MajorantGrid::estimate_transmission(
+    const foundation::Ray3d&            ray,
+    const double                        tmin,
+    const double                        tmax,
+    const float                         extinction_scale,
+    DensityFunction&                    density,
+    RNG&                                rng) const
+{
+    majorant_grid_impl::RatioTrackingVisitor<DensityFunction, RNG> visitor(extinction_scale, density, rng);
+    traverse(ray, tmin, tmax, visitor);
+    return visitor.m_transmission;
+}
+
+}   // namespace renderer
@@ -35,6 +35,7 @@
 #include "foundation/utility/cc.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <utility>
@@ -281,6 +282,85 @@ unique_ptr<VoxelGrid> read_fluid_file(
     return read == needed ? move(grid) : unique_ptr<VoxelGrid>(nullptr);
 }
 
+namespace
+{
+    bool is_region_above_threshold(
+        const VoxelGrid&    grid,
+        const size_t        x_begin,
+        const size_t        x_end,
+        const size_t        y_begin,
+        const size_t        y_end,
+        const size_t        z_begin,
+        const size_t        z_end,
+        const float         threshold)
+    {
+        const size_t channel_count = grid.get_channel_count();
+
+        for (size_t z = z_begin; z < z_end; ++z)
+        {
+            for (size_t y = y_begin; y < y_end; ++y)
+            {
+                for (size_t x = x_begin; x < x_end; ++x)
+                {
+                    const float* voxel = grid.voxel(x, y, z);
+
+                    for (size_t i = 0; i < channel_count; ++i)
+                    {
+                        if (voxel[i] > threshold)
+                            return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+}
+
+unique_ptr<SparseVoxelGrid> create_sparse_voxel_grid(
+    const VoxelGrid&    grid,
+    const float         threshold)
+{
+    const size_t xres = grid.get_xres();
+    const size_t yres = grid.get_yres();
+    const size_t zres = grid.get_zres();
+
+    unique_ptr<SparseVoxelGrid> sparse_grid(
+        new SparseVoxelGrid(xres, yres, zres, grid.get_channel_count()));
+
+    const size_t LeafDim = SparseVoxelGrid::LeafDim;
+
+    for (size_t lz = 0; lz < zres; lz += LeafDim)
+    {
+        const size_t z_end = min(lz + LeafDim, zres);
+
+        for (size_t ly = 0; ly < yres; ly += LeafDim)
+        {
+            const size_t y_end = min(ly + LeafDim, yres);
+
+            for (size_t lx = 0; lx < xres; lx += LeafDim)
+            {
+                const size_t x_end = min(lx + LeafDim, xres);
+
+                // Leaves are either copied entirely or skipped entirely.
+                if (!is_region_above_threshold(grid, lx, x_end, ly, y_end, lz, z_end, threshold))
+                    continue;
+
+                for (size_t z = lz; z < z_end; ++z)
+                {
+                    for (size_t y = ly; y < y_end; ++y)
+                    {
+                        for (size_t x = lx; x < x_end; ++x)
+                            sparse_grid->set_voxel(x, y, z, grid.voxel(x, y, z));
+                    }
+                }
+            }
+        }
+    }
+
+    return sparse_grid;
+}
+
 void write_voxel_grid(
     const char*         filename,
     const VoxelGrid&    grid)
@@ -30,6 +30,7 @@
 #pragma once
 
 // appleseed.foundation headers.
+#include "foundation/math/sparsevoxelgrid.h"
 #include "foundation/math/voxelgrid.h"
 
 // Standard headers.
@@ -46,6 +47,13 @@ namespace renderer
 typedef foundation::VoxelGrid3<float, double> VoxelGrid;
 
 
+//
+// The sparse voxel grid used for rendering large, mostly empty volumes.
+//
+
+typedef foundation::SparseVoxelGrid3<float, double> SparseVoxelGrid;
+
+
 //
 // A structure to keep track of the channels in a voxel grid.
 //
@@ -77,6 +85,12 @@ std::unique_ptr<VoxelGrid> read_fluid_file(
     const char*         filename,
     FluidChannels&      channels);
 
+// Convert a dense voxel grid to a sparse one. Leaves whose voxels all have
+// channel values not greater than 'threshold' are left unallocated.
+std::unique_ptr<SparseVoxelGrid> create_sparse_voxel_grid(
+    const VoxelGrid&    grid,
+    const float         threshold = 0.0f);
+
 // Write a voxel grid to disk in a human-readable format.
 void write_voxel_grid(
     const char*         filename,
@@ -0,0 +1,252 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectprimitives.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Intersection_Intersector)
+{
+    const size_t RayCount = 10000;
+
+    void insert_sphere_object(
+        Assembly&           assembly,
+        const char*         resolution_u,
+        const char*         resolution_v)
+    {
+        auto_release_ptr<MeshObject> sphere(
+            create_primitive_mesh(
+                "sphere",
+                ParamArray()
+                    .insert("primitive", "sphere")
+                    .insert("resolution_u", resolution_u)
+                    .insert("resolution_v", resolution_v)));
+
+        assembly.objects().insert(auto_release_ptr<Object>(sphere.release()));
+
+        assembly.object_instances().insert(
+            ObjectInstanceFactory::create(
+                "sphere_inst",
+                ParamArray(),
+                "sphere",
+                Transformd::identity(),
+                StringDictionary()));
+    }
+
+    // A single instance of an assembly containing a finely tessellated sphere
+    // (about 130,000 triangles): traversal time is dominated by the triangle tree.
+    struct SingleMeshScene
+      : public TestSceneBase
+    {
+        SingleMeshScene()
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            insert_sphere_object(assembly.ref(), "256", "256");
+
+            m_scene.assemblies().insert(assembly);
+
+            m_scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    "assembly"));
+        }
+    };
+
+    // A 32x32 grid of instances of an assembly containing a coarse sphere:
+    // traversal time is dominated by the assembly tree.
+    struct InstancedAssembliesScene
+      : public TestSceneBase
+    {
+        InstancedAssembliesScene()
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            insert_sphere_object(assembly.ref(), "16", "16");
+
+            m_scene.assemblies().insert(assembly);
+
+            const size_t GridSize = 32;
+
+            for (size_t y = 0; y < GridSize; ++y)
+            {
+                for (size_t x = 0; x < GridSize; ++x)
+                {
+                    const string name = "assembly_inst_" + to_string(x) + "_" + to_string(y);
+
+                    auto_release_ptr<AssemblyInstance> assembly_instance(
+                        AssemblyInstanceFactory::create(
+                            name.c_str(),
+                            ParamArray(),
+                            "assembly"));
+
+                    assembly_instance->transform_sequence().set_transform(
+                        0.0f,
+                        Transformd::from_local_to_parent(
+                            Matrix4d::make_translation(
+                                Vector3d(
+                                    2.5 * (static_cast<double>(x) - 0.5 * GridSize),
+                                    2.5 * (static_cast<double>(y) - 0.5 * GridSize),
+                                    0.0))));
+
+                    m_scene.assembly_instances().insert(assembly_instance);
+                }
+            }
+        }
+    };
+
+    template <typename SceneType>
+    struct Fixture
+      : public StaticTestSceneContext<SceneType>
+    {
+        TraceContext            m_trace_context;
+        TextureStore            m_texture_store;
+        TextureCache            m_texture_cache;
+        Intersector             m_intersector;
+        vector<ShadingRay>      m_rays;
+        size_t                  m_hit_count;
+
+        Fixture()
+          : m_trace_context(SceneType::m_scene)
+          , m_texture_store(SceneType::m_scene)
+          , m_texture_cache(m_texture_store)
+          , m_intersector(m_trace_context, m_texture_cache)
+          , m_hit_count(0)
+        {
+            m_trace_context.update();
+
+            // Shoot rays from a sphere enclosing the scene toward random points of the scene.
+            const GAABB3 bbox = SceneType::m_scene.compute_bbox();
+            const Vector3d center(bbox.center());
+            const double radius = 2.0 * static_cast<double>(bbox.radius());
+
+            MersenneTwister rng;
+            m_rays.reserve(RayCount);
+
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                const Vector3d origin =
+                    center + radius * sample_sphere_uniform(rand_vector2<Vector2d>(rng));
+
+                const Vector3d s = rand_vector2<Vector3d>(rng);
+                const Vector3d target(
+                    bbox.min.x + s.x * (bbox.max.x - bbox.min.x),
+                    bbox.min.y + s.y * (bbox.max.y - bbox.min.y),
+                    bbox.min.z + s.z * (bbox.max.z - bbox.min.z));
+
+                m_rays.emplace_back(
+                    origin,
+                    normalize(target - origin),
+                    ShadingRay::Time(),
+                    VisibilityFlags::CameraRay,
+                    0);
+            }
+        }
+
+        void trace()
+        {
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                ShadingPoint shading_point;
+                if (m_intersector.trace(m_rays[i], shading_point))
+                    ++m_hit_count;
+            }
+        }
+
+        void trace_probe()
+        {
+            for (size_t i = 0; i < RayCount; ++i)
+            {
+                if (m_intersector.trace_probe(m_rays[i]))
+                    ++m_hit_count;
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(Trace_TriangleTree, Fixture<SingleMeshScene>)
+    {
+        trace();
+    }
+
+    BENCHMARK_CASE_F(TraceProbe_TriangleTree, Fixture<SingleMeshScene>)
+    {
+        trace_probe();
+    }
+
+    BENCHMARK_CASE_F(Trace_AssemblyTreeOfInstancedAssemblies, Fixture<InstancedAssembliesScene>)
+    {
+        trace();
+    }
+
+    BENCHMARK_CASE_F(TraceProbe_AssemblyTreeOfInstancedAssemblies, Fixture<InstancedAssembliesScene>)
+    {
+        trace_probe();
+    }
+}
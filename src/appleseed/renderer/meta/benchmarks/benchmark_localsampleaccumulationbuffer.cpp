@@ -30,7 +30,7 @@
 #include "renderer/kernel/rendering/localsampleaccumulationbuffer.h"
 
 // appleseed.foundation headers.
-#include "foundation/image/accumulatortile.h"
+#include "foundation/image/coloraccumulatortile.h"
 #include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/aabb.h"
@@ -45,12 +45,12 @@ BENCHMARK_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
     struct Fixture
     {
         Tile                            m_color_tile;
-        AccumulatorTile                 m_level;
+        ColorAccumulatorTile            m_level;
         AABB2u                          m_rect;
 
         Fixture()
           : m_color_tile(64, 64, 4, PixelFormatHalf)
-          , m_level(256, 256, 4)
+          , m_level(256, 256)
           , m_rect(Vector2u(0, 0), Vector2u(63, 63))
         {
             m_level.clear();
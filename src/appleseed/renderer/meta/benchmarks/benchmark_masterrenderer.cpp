@@ -0,0 +1,89 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/defaultrenderercontroller.h"
+#include "renderer/kernel/rendering/masterrenderer.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/project-builtin/cornellboxproject.h"
+#include "renderer/modeling/project/configuration.h"
+#include "renderer/modeling/project/configurationcontainer.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/searchpaths.h"
+
+// Standard headers.
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Rendering_MasterRenderer)
+{
+    // Path-trace a single 32x32 tile of the built-in Cornell box using the final configuration.
+    struct CornellBoxTileFixture
+    {
+        auto_release_ptr<Project>   m_project;
+        ParamArray                  m_params;
+        DefaultRendererController   m_renderer_controller;
+        SearchPaths                 m_resource_search_paths;
+        unique_ptr<MasterRenderer>  m_renderer;
+
+        CornellBoxTileFixture()
+          : m_project(CornellBoxProjectFactory::create())
+        {
+            m_project->set_frame(
+                FrameFactory::create(
+                    "beauty",
+                    ParamArray()
+                        .insert("camera", "camera")
+                        .insert("resolution", "32 32")
+                        .insert("tile_size", "32 32")));
+
+            m_params = m_project->configurations().get_by_name("final")->get_inherited_parameters();
+            m_params.insert_path("uniform_pixel_renderer.samples", "16");
+
+            m_renderer.reset(
+                new MasterRenderer(
+                    m_project.ref(),
+                    m_params,
+                    m_resource_search_paths,
+                    &m_renderer_controller));
+        }
+    };
+
+    BENCHMARK_CASE_F(RenderCornellBoxTile, CornellBoxTileFixture)
+    {
+        m_renderer->render();
+    }
+}
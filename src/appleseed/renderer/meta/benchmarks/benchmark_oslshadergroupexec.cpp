@@ -0,0 +1,220 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/lighting/tracer.h"
+#include "renderer/kernel/rendering/rendererservices.h"
+#include "renderer/kernel/shading/oslshadergroupexec.h"
+#include "renderer/kernel/shading/oslshadingsystem.h"
+#include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/oiiotexturesystem.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectprimitives.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/arena.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/containers/dictionary.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Shading_OSLShaderGroupExec)
+{
+    const size_t ShadingPointCount = 1000;
+    const size_t BatchSize = 8;
+
+    // A single sphere seen from the camera.
+    struct SphereScene
+      : public TestSceneBase
+    {
+        SphereScene()
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            auto_release_ptr<MeshObject> sphere(
+                create_primitive_mesh(
+                    "sphere",
+                    ParamArray()
+                        .insert("primitive", "sphere")
+                        .insert("resolution_u", "32")
+                        .insert("resolution_v", "16")));
+
+            assembly->objects().insert(auto_release_ptr<Object>(sphere.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "sphere_inst",
+                    ParamArray(),
+                    "sphere",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene.assemblies().insert(assembly);
+
+            m_scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    "assembly"));
+        }
+    };
+
+    struct Fixture
+      : public StaticTestSceneContext<SphereScene>
+    {
+        TextureStore                        m_texture_store;
+        TextureCache                        m_texture_cache;
+        shared_ptr<OIIOTextureSystem>       m_texture_system;
+        RendererServices                    m_renderer_services;
+        shared_ptr<OSLShadingSystem>        m_shading_system;
+        Intersector                         m_intersector;
+        Arena                               m_arena;
+        OSLShaderGroupExec                  m_sg_exec;
+        Tracer                              m_tracer;
+        ShadingContext                      m_shading_context;
+        auto_release_ptr<ShaderGroup>       m_shader_group;
+        ShadingPoint                        m_shading_point;
+        ShadingPoint                        m_batch_points[BatchSize];
+        const ShadingPoint*                 m_batch[BatchSize];
+        bool                                m_valid;
+
+        Fixture()
+          : m_texture_store(m_scene)
+          , m_texture_cache(m_texture_store)
+          , m_texture_system(
+                OIIOTextureSystemFactory::create(),
+                [](OIIOTextureSystem* object) { object->release(); })
+          , m_renderer_services(m_project, *m_texture_system)
+          , m_shading_system(
+                OSLShadingSystemFactory::create(&m_renderer_services, m_texture_system.get()),
+                [](OSLShadingSystem* object) { object->release(); })
+          , m_intersector(
+                m_project.get_trace_context(),
+                m_texture_cache)
+          , m_sg_exec(*m_shading_system, m_arena)
+          , m_tracer(
+                m_scene,
+                m_intersector,
+                m_sg_exec)
+          , m_shading_context(
+                m_intersector,
+                m_tracer,
+                m_texture_cache,
+                *m_texture_system,
+                m_sg_exec,
+                m_arena,
+                0)  // thread index
+          , m_shader_group(ShaderGroupFactory::create("shader_group"))
+        {
+            m_project.get_trace_context().update();
+
+            // Compiled shaders are located in sandbox/shaders/appleseed/, relatively to the tests root.
+            m_shading_system->attribute("searchpath:shader", string("../shaders/appleseed"));
+
+            // A plastic material, as exported by the DCC plugins.
+            m_shader_group->add_shader("shader", "as_plastic", "plastic", ParamArray());
+            m_shader_group->add_shader("surface", "as_closure2surface", "closure2surface", ParamArray());
+            m_shader_group->add_connection("plastic", "out_outColor", "closure2surface", "in_input");
+
+            const ShadingRay ray(
+                Vector3d(0.0, 0.0, 5.0),
+                Vector3d(0.0, 0.0, -1.0),
+                ShadingRay::Time(),
+                VisibilityFlags::CameraRay,
+                0);
+
+            m_valid =
+                m_shader_group->create_optimized_osl_shader_group(*m_shading_system, nullptr) &&
+                m_intersector.trace(ray, m_shading_point);
+
+            for (size_t i = 0; i < BatchSize; ++i)
+            {
+                m_batch_points[i] = m_shading_point;
+                m_batch[i] = &m_batch_points[i];
+            }
+        }
+
+        ~Fixture()
+        {
+            m_shader_group->release_optimized_osl_shader_group();
+        }
+    };
+
+    BENCHMARK_CASE_F(ExecuteShading_Plastic, Fixture)
+    {
+        // Nothing to measure if the shaders could not be found.
+        if (!m_valid)
+            return;
+
+        for (size_t i = 0; i < ShadingPointCount; ++i)
+        {
+            m_arena.clear();
+            m_shading_context.execute_osl_shading(*m_shader_group, m_shading_point);
+        }
+    }
+
+    BENCHMARK_CASE_F(ExecuteShadingBatch_Plastic, Fixture)
+    {
+        // Nothing to measure if the shaders could not be found.
+        if (!m_valid)
+            return;
+
+        for (size_t i = 0; i < ShadingPointCount; i += BatchSize)
+        {
+            m_arena.clear();
+            m_shading_context.execute_osl_shading_batch(*m_shader_group, m_batch, BatchSize);
+        }
+    }
+}
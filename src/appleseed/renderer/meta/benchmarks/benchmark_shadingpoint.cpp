@@ -0,0 +1,192 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/intersection/tracecontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectprimitives.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/basis.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/containers/dictionary.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Shading_ShadingPoint)
+{
+    // Enough shading points to exceed the L2 cache, so that throughput depends
+    // on how many cache lines the accessed fields of each shading point span.
+    const size_t PointCount = 16384;
+
+    struct SphereScene
+      : public TestSceneBase
+    {
+        SphereScene()
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            auto_release_ptr<MeshObject> sphere(
+                create_primitive_mesh(
+                    "sphere",
+                    ParamArray()
+                        .insert("primitive", "sphere")
+                        .insert("resolution_u", "64")
+                        .insert("resolution_v", "64")));
+
+            assembly->objects().insert(auto_release_ptr<Object>(sphere.release()));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "sphere_inst",
+                    ParamArray(),
+                    "sphere",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene.assemblies().insert(assembly);
+
+            m_scene.assembly_instances().insert(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    "assembly"));
+        }
+    };
+
+    struct Fixture
+      : public StaticTestSceneContext<SphereScene>
+    {
+        TraceContext                    m_trace_context;
+        TextureStore                    m_texture_store;
+        TextureCache                    m_texture_cache;
+        Intersector                     m_intersector;
+        unique_ptr<ShadingPoint[]>      m_points;
+        size_t                          m_point_count;
+        double                          m_dummy;
+
+        Fixture()
+          : m_trace_context(m_scene)
+          , m_texture_store(m_scene)
+          , m_texture_cache(m_texture_store)
+          , m_intersector(m_trace_context, m_texture_cache)
+          , m_points(new ShadingPoint[PointCount])
+          , m_point_count(0)
+          , m_dummy(0.0)
+        {
+            m_trace_context.update();
+
+            // Shoot rays from outside the unit sphere toward its center and keep the hits.
+            MersenneTwister rng;
+
+            for (size_t i = 0; i < PointCount; ++i)
+            {
+                const Vector3d origin = 4.0 * sample_sphere_uniform(rand_vector2<Vector2d>(rng));
+                const ShadingRay ray(
+                    origin,
+                    normalize(-origin),
+                    ShadingRay::Time(),
+                    VisibilityFlags::CameraRay,
+                    0);
+
+                if (m_intersector.trace(ray, m_points[m_point_count]))
+                    ++m_point_count;
+            }
+
+            // Compute and cache all on-demand results once.
+            query_hot_data();
+            query_cold_data();
+        }
+
+        // Fields needed to sample a BSDF and to spawn a secondary ray.
+        void query_hot_data()
+        {
+            for (size_t i = 0; i < m_point_count; ++i)
+            {
+                const ShadingPoint& point = m_points[i];
+                m_dummy += point.get_point().x;
+                m_dummy += point.get_geometric_normal().y;
+                m_dummy += point.get_shading_basis().get_normal().z;
+                m_dummy += point.get_uv(0).x;
+                m_dummy += point.get_dpdu(0).x;
+            }
+        }
+
+        // Fields only needed by texture filtering, OSL and motion blur.
+        void query_cold_data()
+        {
+            for (size_t i = 0; i < m_point_count; ++i)
+            {
+                const ShadingPoint& point = m_points[i];
+                m_dummy += point.get_duvdx(0).x;
+                m_dummy += point.get_dndu(0).x;
+                m_dummy += point.get_dpdx().x;
+                m_dummy += point.get_world_space_point_velocity().x;
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(QueryHotData, Fixture)
+    {
+        query_hot_data();
+    }
+
+    BENCHMARK_CASE_F(QueryHotAndColdData, Fixture)
+    {
+        query_hot_data();
+        query_cold_data();
+    }
+}
@@ -0,0 +1,115 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
+#include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/knn.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/benchmark.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Lighting_SPPM_SPPMPhotonMap)
+{
+    const size_t PhotonCount = 100000;
+    const size_t QueryCount = 1000;
+    const size_t MaxPhotonsPerEstimate = 100;
+    const float LookupRadius = 0.01f;
+
+    struct Fixture
+    {
+        SPPMPhotonVector                m_photons;
+        vector<Vector3f>                m_query_points;
+        unique_ptr<SPPMPhotonMap>       m_kd_tree;
+        unique_ptr<SPPMPhotonMap>       m_hash_grid;
+        knn::Answer<float>              m_answer;
+        size_t                          m_accumulator;
+
+        Fixture()
+          : m_answer(MaxPhotonsPerEstimate)
+          , m_accumulator(0)
+        {
+            MersenneTwister rng;
+
+            // Photons on the ground plane, half of them in a caustic.
+            for (size_t i = 0; i < PhotonCount; ++i)
+            {
+                const Vector2f s = rand_vector1<Vector2f>(rng);
+                const Vector2f p = i % 2 == 0 ? s : Vector2f(0.45f) + 0.1f * s;
+                m_photons.push_back(Vector3f(p.x, 0.0f, p.y), SPPMPolyPhoton());
+            }
+
+            for (size_t i = 0; i < QueryCount; ++i)
+            {
+                const Vector2f s = rand_vector1<Vector2f>(rng);
+                m_query_points.emplace_back(s.x, 0.0f, s.y);
+            }
+
+            SPPMPhotonVector kd_tree_photons(m_photons);
+            m_kd_tree.reset(new SPPMPhotonMap(kd_tree_photons, SPPMParameters::KdTree, LookupRadius));
+
+            SPPMPhotonVector hash_grid_photons(m_photons);
+            m_hash_grid.reset(new SPPMPhotonMap(hash_grid_photons, SPPMParameters::HashGrid, LookupRadius));
+        }
+
+        void build(const SPPMParameters::PhotonMapType type)
+        {
+            SPPMPhotonVector photons(m_photons);
+            const SPPMPhotonMap photon_map(photons, type, LookupRadius);
+            m_accumulator += photon_map.empty() ? 0 : 1;
+        }
+
+        void query(const SPPMPhotonMap& photon_map)
+        {
+            for (size_t i = 0; i < QueryCount; ++i)
+            {
+                photon_map.query(m_query_points[i], LookupRadius * LookupRadius, m_answer);
+                m_accumulator += m_answer.size();
+            }
+        }
+    };
+
+    BENCHMARK_CASE_F(Build_KdTree, Fixture)     { build(SPPMParameters::KdTree); }
+    BENCHMARK_CASE_F(Build_HashGrid, Fixture)   { build(SPPMParameters::HashGrid); }
+
+    BENCHMARK_CASE_F(Query_KdTree, Fixture)     { query(*m_kd_tree); }
+    BENCHMARK_CASE_F(Query_HashGrid, Fixture)   { query(*m_hash_grid); }
+}
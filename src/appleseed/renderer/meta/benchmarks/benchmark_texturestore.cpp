@@ -0,0 +1,221 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/texture/memorytexture2d.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/benchmark.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/uid.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+BENCHMARK_SUITE(Renderer_Kernel_Texturing_TextureStore)
+{
+    const size_t TextureSize = 2048;
+    const size_t TileSize = 16;
+    const size_t TileCount = TextureSize / TileSize;
+    const size_t LookupCount = 10000;
+    const size_t JobCount = 16;
+
+    // A scene containing a single in-memory texture made of 16,384 tiles, many more
+    // than a texture cache can hold, so that most lookups reach the texture store.
+    struct SceneWithLargeTexture
+      : public TestSceneBase
+    {
+        UniqueID m_texture_uid;
+
+        SceneWithLargeTexture()
+        {
+            auto_release_ptr<Image> image(
+                new Image(
+                    TextureSize,
+                    TextureSize,
+                    TileSize,
+                    TileSize,
+                    3,
+                    PixelFormatUInt8));
+
+            auto_release_ptr<Texture> texture(
+                MemoryTexture2dFactory().create(
+                    "texture",
+                    ParamArray().insert("color_space", "linear_rgb"),
+                    image));
+
+            m_texture_uid = texture->get_uid();
+
+            m_scene.textures().insert(texture);
+        }
+    };
+
+    struct TextureLookupJobBase
+      : public IJob
+    {
+        TextureStore&   m_texture_store;
+        UniqueID        m_texture_uid;
+        uint32          m_seed;
+        size_t          m_checksum;
+
+        TextureLookupJobBase(
+            TextureStore&   texture_store,
+            const UniqueID  texture_uid,
+            const uint32    seed)
+          : m_texture_store(texture_store)
+          , m_texture_uid(texture_uid)
+          , m_seed(seed)
+          , m_checksum(0)
+        {
+        }
+    };
+
+    // Each job owns a texture cache, like a rendering thread does, and looks up
+    // random tiles of the texture through it.
+    struct TextureLookupJob
+      : public TextureLookupJobBase
+    {
+        using TextureLookupJobBase::TextureLookupJobBase;
+
+        void execute(const size_t thread_index) override
+        {
+            TextureCache texture_cache(m_texture_store);
+            MersenneTwister rng(m_seed);
+
+            for (size_t i = 0; i < LookupCount; ++i)
+            {
+                const size_t tile_x = rand_int1(rng, 0, static_cast<int32>(TileCount - 1));
+                const size_t tile_y = rand_int1(rng, 0, static_cast<int32>(TileCount - 1));
+
+                // Scene textures are identified by an invalid assembly UID.
+                const Tile& tile =
+                    texture_cache.get(~UniqueID(0), m_texture_uid, tile_x, tile_y);
+
+                m_checksum += tile.get_width();
+            }
+        }
+    };
+
+    // Each job directly acquires and releases random tiles from the texture store,
+    // which measures the contention on the store itself.
+    struct AcquireReleaseJob
+      : public TextureLookupJobBase
+    {
+        using TextureLookupJobBase::TextureLookupJobBase;
+
+        void execute(const size_t thread_index) override
+        {
+            MersenneTwister rng(m_seed);
+
+            for (size_t i = 0; i < LookupCount; ++i)
+            {
+                const size_t tile_x = rand_int1(rng, 0, static_cast<int32>(TileCount - 1));
+                const size_t tile_y = rand_int1(rng, 0, static_cast<int32>(TileCount - 1));
+
+                TextureStore::TileRecord& record =
+                    m_texture_store.acquire(
+                        TextureStore::TileKey(~UniqueID(0), m_texture_uid, tile_x, tile_y));
+
+                m_checksum += record.m_tile->get_width();
+
+                m_texture_store.release(record);
+            }
+        }
+    };
+
+    // The total number of lookups is the same regardless of the number of threads.
+    template <size_t ThreadCount>
+    struct Fixture
+      : public StaticTestSceneContext<SceneWithLargeTexture>
+    {
+        Logger                                  m_logger;
+        TextureStore                            m_texture_store;
+        JobQueue                                m_job_queue;
+        JobManager                              m_job_manager;
+        vector<unique_ptr<IJob>>                m_lookup_jobs;
+        vector<unique_ptr<IJob>>                m_acquire_release_jobs;
+
+        Fixture()
+          : m_texture_store(m_scene)
+          , m_job_manager(m_logger, m_job_queue, ThreadCount, JobManager::KeepRunningOnEmptyQueue)
+        {
+            m_lookup_jobs.reserve(JobCount);
+            m_acquire_release_jobs.reserve(JobCount);
+
+            for (size_t i = 0; i < JobCount; ++i)
+            {
+                const uint32 seed = static_cast<uint32>(i);
+                m_lookup_jobs.emplace_back(new TextureLookupJob(m_texture_store, m_texture_uid, seed));
+                m_acquire_release_jobs.emplace_back(new AcquireReleaseJob(m_texture_store, m_texture_uid, seed));
+            }
+
+            m_job_manager.start();
+        }
+
+        void run_jobs(const vector<unique_ptr<IJob>>& jobs)
+        {
+            for (size_t i = 0; i < jobs.size(); ++i)
+                m_job_queue.schedule(jobs[i].get(), false);
+
+            m_job_queue.wait_until_completion();
+        }
+    };
+
+    BENCHMARK_CASE_F(ContendedLookups_1Thread, Fixture<1>)          { run_jobs(m_lookup_jobs); }
+    BENCHMARK_CASE_F(ContendedLookups_2Threads, Fixture<2>)         { run_jobs(m_lookup_jobs); }
+    BENCHMARK_CASE_F(ContendedLookups_4Threads, Fixture<4>)         { run_jobs(m_lookup_jobs); }
+    BENCHMARK_CASE_F(ContendedLookups_8Threads, Fixture<8>)         { run_jobs(m_lookup_jobs); }
+    BENCHMARK_CASE_F(ContendedLookups_16Threads, Fixture<16>)       { run_jobs(m_lookup_jobs); }
+
+    BENCHMARK_CASE_F(AcquireRelease_1Thread, Fixture<1>)            { run_jobs(m_acquire_release_jobs); }
+    BENCHMARK_CASE_F(AcquireRelease_2Threads, Fixture<2>)           { run_jobs(m_acquire_release_jobs); }
+    BENCHMARK_CASE_F(AcquireRelease_4Threads, Fixture<4>)           { run_jobs(m_acquire_release_jobs); }
+    BENCHMARK_CASE_F(AcquireRelease_8Threads, Fixture<8>)           { run_jobs(m_acquire_release_jobs); }
+    BENCHMARK_CASE_F(AcquireRelease_16Threads, Fixture<16>)         { run_jobs(m_acquire_release_jobs); }
+}
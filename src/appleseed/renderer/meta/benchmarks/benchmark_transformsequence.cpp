@@ -36,8 +36,13 @@
 #include "foundation/math/scalar.h"
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
 #include "foundation/utility/benchmark.h"
 
+// Standard headers.
+#include <cstddef>
+
 using namespace foundation;
 using namespace renderer;
 
@@ -49,6 +54,10 @@ BENCHMARK_SUITE(Renderer_Utility_TransformSequence)
         TransformSequence   m_sequence;
         AABB3d              m_motion_bbox;
 
+        static const size_t TimeCount = 64;
+        float               m_times[TimeCount];
+        Transformd          m_transforms[TimeCount];
+
         Fixture()
           : m_bbox(Vector3d(-20.0, -20.0, -5.0), Vector3d(-10.0, -10.0, 5.0))
         {
@@ -64,6 +73,10 @@ BENCHMARK_SUITE(Renderer_Utility_TransformSequence)
                     Matrix4d::make_rotation(axis, Pi<double>() - Pi<double>() / 8) *
                     Matrix4d::make_scaling(Vector3d(0.2))));
             m_sequence.prepare();
+
+            MersenneTwister rng;
+            for (size_t i = 0; i < TimeCount; ++i)
+                m_times[i] = rand_float1(rng);
         }
     };
 
@@ -71,4 +84,15 @@ BENCHMARK_SUITE(Renderer_Utility_TransformSequence)
     {
         m_motion_bbox = m_sequence.to_parent(m_bbox);
     }
+
+    BENCHMARK_CASE_F(Evaluate, Fixture)
+    {
+        for (size_t i = 0; i < TimeCount; ++i)
+            m_transforms[i] = m_sequence.evaluate(m_times[i]);
+    }
+
+    BENCHMARK_CASE_F(EvaluateBatch, Fixture)
+    {
+        m_sequence.evaluate(TimeCount, m_times, m_transforms);
+    }
 }
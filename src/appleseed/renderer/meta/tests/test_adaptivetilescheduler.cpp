@@ -0,0 +1,146 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/final/adaptivetilescheduler.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_Final_AdaptiveTileScheduler)
+{
+    struct TileData
+      : public AdaptiveTileScheduler::TileData
+    {
+        explicit TileData(size_t& destroyed_count)
+          : m_destroyed_count(destroyed_count)
+        {
+        }
+
+        ~TileData() override
+        {
+            ++m_destroyed_count;
+        }
+
+        size_t& m_destroyed_count;
+    };
+
+    TEST_CASE(Pop_GivenEmptyQueue_ReturnsFalse)
+    {
+        AdaptiveTileScheduler scheduler(0.0);
+
+        size_t tile_index;
+        float error;
+        unique_ptr<AdaptiveTileScheduler::TileData> data;
+
+        EXPECT_FALSE(scheduler.pop(tile_index, error, data));
+    }
+
+    TEST_CASE(Pop_ReturnsNoisiestTileFirst)
+    {
+        AdaptiveTileScheduler scheduler(0.0);
+        scheduler.push(0, 0.5f, nullptr);
+        scheduler.push(1, 2.0f, nullptr);
+        scheduler.push(2, 1.0f, nullptr);
+        scheduler.push(3, 2.0f, nullptr);
+
+        EXPECT_EQ(4, scheduler.size());
+
+        size_t tile_index;
+        float error;
+        unique_ptr<AdaptiveTileScheduler::TileData> data;
+
+        ASSERT_TRUE(scheduler.pop(tile_index, error, data));
+        EXPECT_EQ(1, tile_index);
+        EXPECT_EQ(2.0f, error);
+
+        ASSERT_TRUE(scheduler.pop(tile_index, error, data));
+        EXPECT_EQ(3, tile_index);
+
+        ASSERT_TRUE(scheduler.pop(tile_index, error, data));
+        EXPECT_EQ(2, tile_index);
+
+        ASSERT_TRUE(scheduler.pop(tile_index, error, data));
+        EXPECT_EQ(0, tile_index);
+
+        EXPECT_FALSE(scheduler.pop(tile_index, error, data));
+    }
+
+    TEST_CASE(Pop_TransfersOwnershipOfTileData)
+    {
+        size_t destroyed_count = 0;
+
+        {
+            AdaptiveTileScheduler scheduler(0.0);
+            scheduler.push(0, 1.0f, unique_ptr<AdaptiveTileScheduler::TileData>(new TileData(destroyed_count)));
+            scheduler.push(1, 0.5f, unique_ptr<AdaptiveTileScheduler::TileData>(new TileData(destroyed_count)));
+
+            size_t tile_index;
+            float error;
+            unique_ptr<AdaptiveTileScheduler::TileData> data;
+            ASSERT_TRUE(scheduler.pop(tile_index, error, data));
+
+            EXPECT_NEQ(nullptr, data.get());
+            EXPECT_EQ(0, destroyed_count);
+
+            data.reset();
+            EXPECT_EQ(1, destroyed_count);
+        }
+
+        // Tiles left in the queue are destroyed with the scheduler.
+        EXPECT_EQ(2, destroyed_count);
+    }
+
+    TEST_CASE(HasTimeLeft_GivenUnlimitedTimeBudget_ReturnsTrue)
+    {
+        AdaptiveTileScheduler scheduler(0.0);
+        scheduler.on_tile_begin(42);
+
+        EXPECT_TRUE(scheduler.has_time_left());
+    }
+
+    TEST_CASE(HasTimeLeft_GivenExhaustedTimeBudget_ReturnsFalse)
+    {
+        AdaptiveTileScheduler scheduler(1.0e-9);
+        scheduler.on_tile_begin(42);
+
+        size_t i = 0;
+        while (scheduler.has_time_left() && i < 1000000)
+            ++i;
+
+        EXPECT_FALSE(scheduler.has_time_left());
+    }
+}
@@ -0,0 +1,143 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/backwardlightsampler.h"
+#include "renderer/kernel/lighting/backwardlightsamplercache.h"
+#include "renderer/modeling/light/light.h"
+#include "renderer/modeling/light/pointlight.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_BackwardLightSamplerCache)
+{
+    struct Fixture
+    {
+        auto_release_ptr<Scene>     m_scene;
+        Assembly*                   m_assembly;
+        AssemblyInstance*           m_assembly_instance;
+
+        Fixture()
+          : m_scene(SceneFactory::create())
+        {
+            m_scene->assemblies().insert(
+                AssemblyFactory().create("assembly", ParamArray()));
+            m_assembly = m_scene->assemblies().get_by_name("assembly");
+
+            add_light("light");
+
+            m_scene->assembly_instances().insert(
+                AssemblyInstanceFactory::create("assembly_inst", ParamArray(), "assembly"));
+            m_assembly_instance = m_scene->assembly_instances().get_by_name("assembly_inst");
+            m_assembly_instance->bind_assembly(m_scene->assemblies());
+        }
+
+        void add_light(const char* name)
+        {
+            m_assembly->lights().insert(
+                PointLightFactory().create(
+                    name,
+                    ParamArray()
+                        .insert("intensity", "1.0")));
+        }
+    };
+
+    TEST_CASE_F(ComputeSignature_GivenUnchangedScene_ReturnsSameSignature, Fixture)
+    {
+        const uint64 signature1 = BackwardLightSamplerCache::compute_signature(m_scene.ref());
+        const uint64 signature2 = BackwardLightSamplerCache::compute_signature(m_scene.ref());
+
+        EXPECT_EQ(signature1, signature2);
+    }
+
+    TEST_CASE_F(ComputeSignature_AfterAddingLight_ReturnsDifferentSignature, Fixture)
+    {
+        const uint64 signature1 = BackwardLightSamplerCache::compute_signature(m_scene.ref());
+        add_light("other_light");
+        const uint64 signature2 = BackwardLightSamplerCache::compute_signature(m_scene.ref());
+
+        EXPECT_NEQ(signature1, signature2);
+    }
+
+    TEST_CASE_F(ComputeSignature_AfterMovingLight_ReturnsDifferentSignature, Fixture)
+    {
+        const uint64 signature1 = BackwardLightSamplerCache::compute_signature(m_scene.ref());
+        m_assembly->lights().get_by_name("light")->set_transform(
+            Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(1.0, 0.0, 0.0))));
+        const uint64 signature2 = BackwardLightSamplerCache::compute_signature(m_scene.ref());
+
+        EXPECT_NEQ(signature1, signature2);
+    }
+
+    TEST_CASE_F(ComputeSignature_AfterMovingAssemblyInstance_ReturnsDifferentSignature, Fixture)
+    {
+        const uint64 signature1 = BackwardLightSamplerCache::compute_signature(m_scene.ref());
+        m_assembly_instance->transform_sequence().set_transform(
+            0.0f,
+            Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(0.0, 1.0, 0.0))));
+        const uint64 signature2 = BackwardLightSamplerCache::compute_signature(m_scene.ref());
+
+        EXPECT_NEQ(signature1, signature2);
+    }
+
+    TEST_CASE_F(Get_GivenUnchangedScene_ReusesLightSampler, Fixture)
+    {
+        BackwardLightSamplerCache cache;
+
+        const BackwardLightSampler* light_sampler1 = &cache.get(m_scene.ref(), ParamArray());
+        const BackwardLightSampler* light_sampler2 = &cache.get(m_scene.ref(), ParamArray());
+
+        EXPECT_TRUE(light_sampler1->has_lights());
+        EXPECT_EQ(light_sampler1, light_sampler2);
+    }
+
+    TEST_CASE_F(Get_AfterAddingLight_RebuildsLightSampler, Fixture)
+    {
+        BackwardLightSamplerCache cache;
+
+        cache.get(m_scene.ref(), ParamArray());
+        add_light("other_light");
+        const BackwardLightSampler& light_sampler = cache.get(m_scene.ref(), ParamArray());
+
+        EXPECT_EQ(2, light_sampler.get_non_physical_light_count());
+    }
+}
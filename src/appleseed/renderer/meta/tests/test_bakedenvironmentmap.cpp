@@ -0,0 +1,154 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/modeling/environmentedf/bakedenvironmentmap.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/regularspectrum.h"
+#include "foundation/math/qmc.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Modeling_EnvironmentEDF_BakedEnvironmentMap)
+{
+    void constant_radiance(const Vector3f& outgoing, RegularSpectrum31f& radiance)
+    {
+        radiance.set(2.0f);
+    }
+
+    void sky_radiance(const Vector3f& outgoing, RegularSpectrum31f& radiance)
+    {
+        radiance.set(max(outgoing.y, 0.0f));
+    }
+
+    void black_radiance(const Vector3f& outgoing, RegularSpectrum31f& radiance)
+    {
+        radiance.set(0.0f);
+    }
+
+    TEST_CASE(Bake_ConstantRadiance_EvaluateReturnsConstantRadiance)
+    {
+        BakedEnvironmentMap map;
+        EXPECT_TRUE(map.bake(16, 8, constant_radiance));
+        EXPECT_FALSE(map.empty());
+
+        RegularSpectrum31f radiance;
+        map.evaluate(normalize(Vector3f(0.3f, -0.2f, 0.7f)), radiance);
+
+        EXPECT_FEQ(2.0f, radiance[0]);
+        EXPECT_FEQ(2.0f, radiance[30]);
+    }
+
+    TEST_CASE(Evaluate_BetweenTexelCorners_InterpolatesRadiance)
+    {
+        BakedEnvironmentMap map;
+        map.bake(32, 16, sky_radiance);
+
+        const Vector3f outgoing = normalize(Vector3f(0.4f, 0.5f, -0.1f));
+
+        RegularSpectrum31f radiance;
+        map.evaluate(outgoing, radiance);
+
+        EXPECT_FEQ_EPS(outgoing.y, radiance[0], 0.02f);
+    }
+
+    TEST_CASE(Sample_ReturnsProbabilityMatchingEvaluatePdf)
+    {
+        BakedEnvironmentMap map;
+        map.bake(32, 16, sky_radiance);
+
+        const size_t SampleCount = 64;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const Vector2f s(
+                radical_inverse_base2<float>(i),
+                (i + 0.5f) / SampleCount);
+
+            Vector3f outgoing;
+            RegularSpectrum31f radiance;
+            float probability;
+            map.sample(s, outgoing, radiance, probability);
+
+            ASSERT_GT(0.0f, probability);
+            ASSERT_FEQ_EPS(map.evaluate_pdf(outgoing), probability, 1.0e-3f);
+
+            RegularSpectrum31f evaluated_radiance;
+            map.evaluate(outgoing, evaluated_radiance);
+            ASSERT_FEQ_EPS(evaluated_radiance[0], radiance[0], 1.0e-3f);
+        }
+    }
+
+    TEST_CASE(EvaluatePdf_IntegratesToOneOverTheSphere)
+    {
+        BakedEnvironmentMap map;
+        map.bake(32, 16, sky_radiance);
+
+        const size_t SampleCount = 16384;
+
+        float integral = 0.0f;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const Vector2f s(
+                radical_inverse_base2<float>(i),
+                (i + 0.5f) / SampleCount);
+
+            integral += map.evaluate_pdf(sample_sphere_uniform(s));
+        }
+
+        integral *= FourPi<float>() / SampleCount;
+
+        EXPECT_FEQ_EPS(1.0f, integral, 0.02f);
+    }
+
+    TEST_CASE(Sample_BlackRadiance_ReturnsZeroProbability)
+    {
+        BakedEnvironmentMap map;
+        map.bake(16, 8, black_radiance);
+
+        Vector3f outgoing;
+        RegularSpectrum31f radiance;
+        float probability;
+        map.sample(Vector2f(0.5f), outgoing, radiance, probability);
+
+        EXPECT_EQ(0.0f, probability);
+        EXPECT_EQ(0.0f, map.evaluate_pdf(normalize(Vector3f(0.0f, 1.0f, 0.0f))));
+    }
+}
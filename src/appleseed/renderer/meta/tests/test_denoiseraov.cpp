@@ -0,0 +1,161 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/aov/imagestack.h"
+#include "renderer/modeling/aov/denoiseraov.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// BCD headers.
+#include "bcd/DeepImage.h"
+
+using namespace bcd;
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_AOV_DenoiserAOV)
+{
+    const size_t Width = 40;
+    const size_t Height = 30;
+    const size_t TileSize = 16;
+    const size_t NumBins = 20;
+
+    struct Fixture
+    {
+        ImageStack                      m_image_stack;
+        auto_release_ptr<DenoiserAOV>   m_aov;
+
+        Fixture()
+          : m_image_stack(Width, Height, TileSize, TileSize)
+          , m_aov(DenoiserAOVFactory::create(2.5f, NumBins))
+        {
+            m_aov->create_image(Width, Height, TileSize, TileSize, m_image_stack);
+        }
+    };
+
+    TEST_CASE_F(ExtractHistogramsImage_GivenNoSamples_ReturnsOneBlackSamplePerPixel, Fixture)
+    {
+        Deepimf histograms;
+        m_aov->extract_histograms_image(histograms);
+
+        ASSERT_EQ(static_cast<int>(m_aov->get_histograms_channel_count()), histograms.getDepth());
+        EXPECT_EQ(1.0f, histograms.get(29, 39, 0));
+        EXPECT_EQ(0.0f, histograms.get(29, 39, 1));
+        EXPECT_EQ(1.0f, histograms.get(29, 39, NumBins));
+        EXPECT_EQ(1.0f, histograms.get(29, 39, 2 * NumBins));
+        EXPECT_EQ(1.0f, histograms.get(29, 39, 3 * NumBins));
+    }
+
+    TEST_CASE_F(StoreSample_GivenBlackSamples_AccumulatesThemInFirstBins, Fixture)
+    {
+        for (size_t i = 0; i < 1000; ++i)
+            m_aov->store_sample(Vector2i(17, 3), Color4f(0.0f, 0.0f, 0.0f, 1.0f));
+
+        Deepimf histograms;
+        m_aov->extract_histograms_image(histograms);
+
+        EXPECT_EQ(1000.0f, histograms.get(3, 17, 0));
+        EXPECT_EQ(0.0f, histograms.get(3, 17, 1));
+        EXPECT_EQ(1000.0f, histograms.get(3, 17, NumBins));
+        EXPECT_EQ(1000.0f, histograms.get(3, 17, 2 * NumBins));
+        EXPECT_EQ(1000.0f, histograms.get(3, 17, 3 * NumBins));
+
+        Deepimf num_samples;
+        m_aov->extract_num_samples_image(num_samples);
+
+        EXPECT_EQ(1000.0f, num_samples.get(3, 17, 0));
+        EXPECT_EQ(1.0f, num_samples.get(0, 0, 0));
+    }
+
+    TEST_CASE_F(StoreSample_GivenManySamples_KeepsBinsWithinRelativePrecision, Fixture)
+    {
+        const size_t SampleCount = 100000;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            const float value = static_cast<float>(i % 7) / 7.0f;
+            m_aov->store_sample(Vector2i(5, 5), Color4f(value, value, value, 1.0f));
+        }
+
+        Deepimf histograms;
+        m_aov->extract_histograms_image(histograms);
+
+        // Each sample distributes a total weight of 1 across the bins of each channel.
+        float sum = 0.0f;
+        for (size_t i = 0; i < NumBins; ++i)
+            sum += histograms.get(5, 5, static_cast<int>(i));
+
+        EXPECT_FEQ_EPS(static_cast<float>(SampleCount), sum, 1.0e-3f * SampleCount);
+    }
+
+    TEST_CASE_F(SetHistogramsImage_GivenExtractedHistograms_RestoresThem, Fixture)
+    {
+        m_aov->store_sample(Vector2i(1, 2), Color4f(0.5f, 0.25f, 0.125f, 1.0f));
+        m_aov->store_sample(Vector2i(1, 2), Color4f(0.2f, 0.1f, 0.9f, 1.0f));
+
+        Deepimf histograms;
+        m_aov->extract_histograms_image(histograms);
+
+        Fixture other;
+        ASSERT_TRUE(other.m_aov->set_histograms_image(histograms));
+
+        Deepimf restored;
+        other.m_aov->extract_histograms_image(restored);
+
+        for (int c = 0; c < histograms.getDepth(); ++c)
+            EXPECT_FEQ_EPS(histograms.get(2, 1, c), restored.get(2, 1, c), 1.0e-3f);
+    }
+
+    TEST_CASE_F(SetHistogramsImage_GivenMismatchingDimensions_ReturnsFalse, Fixture)
+    {
+        Deepimf histograms(Width, Height, 3 * 10 + 1);
+
+        EXPECT_FALSE(m_aov->set_histograms_image(histograms));
+    }
+
+    TEST_CASE_F(CopyStatisticsFrom_CopiesHistograms, Fixture)
+    {
+        m_aov->store_sample(Vector2i(30, 20), Color4f(0.0f, 0.0f, 0.0f, 1.0f));
+
+        auto_release_ptr<DenoiserAOV> copy(DenoiserAOVFactory::create());
+        copy->copy_statistics_from(m_aov.ref());
+
+        Deepimf histograms;
+        copy->extract_histograms_image(histograms);
+
+        EXPECT_EQ(Width, static_cast<size_t>(histograms.getWidth()));
+        EXPECT_EQ(Height, static_cast<size_t>(histograms.getHeight()));
+        EXPECT_EQ(1.0f, histograms.get(20, 30, 0));
+        EXPECT_EQ(1.0f, histograms.get(20, 30, 3 * NumBins));
+    }
+}
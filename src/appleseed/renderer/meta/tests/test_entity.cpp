@@ -0,0 +1,157 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/entity/entityvector.h"
+#include "renderer/modeling/entity/onframebeginrecorder.h"
+#include "renderer/modeling/project/project.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+#include "foundation/utility/uid.h"
+
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Modeling_Entity_Entity)
+{
+    class FrameBeginCounter
+      : public Entity
+    {
+      public:
+        boost::atomic<size_t>&  m_begin_count;
+        boost::atomic<size_t>&  m_end_count;
+        const bool              m_fail;
+
+        FrameBeginCounter(
+            const char*             name,
+            boost::atomic<size_t>&  begin_count,
+            boost::atomic<size_t>&  end_count,
+            const bool              fail)
+          : Entity(new_guid())
+          , m_begin_count(begin_count)
+          , m_end_count(end_count)
+          , m_fail(fail)
+        {
+            set_name(name);
+        }
+
+        void release() override
+        {
+            delete this;
+        }
+
+        bool on_frame_begin(
+            const Project&          project,
+            const BaseGroup*        parent,
+            OnFrameBeginRecorder&   recorder,
+            IAbortSwitch*           abort_switch) override
+        {
+            if (m_fail)
+                return false;
+
+            if (!Entity::on_frame_begin(project, parent, recorder, abort_switch))
+                return false;
+
+            ++m_begin_count;
+            return true;
+        }
+
+        void on_frame_end(
+            const Project&          project,
+            const BaseGroup*        parent) override
+        {
+            ++m_end_count;
+            Entity::on_frame_end(project, parent);
+        }
+    };
+
+    void fill(
+        EntityVector&           entities,
+        const size_t            count,
+        const size_t            failing_index,
+        boost::atomic<size_t>&  begin_count,
+        boost::atomic<size_t>&  end_count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            entities.insert(
+                auto_release_ptr<Entity>(
+                    new FrameBeginCounter(
+                        ("entity" + to_string(i)).c_str(),
+                        begin_count,
+                        end_count,
+                        i == failing_index)));
+        }
+    }
+
+    TEST_CASE(InvokeOnFrameBeginParallel_CallsOnFrameBeginOnEveryEntity)
+    {
+        auto_release_ptr<Project> project(ProjectFactory::create("project"));
+
+        boost::atomic<size_t> begin_count(0), end_count(0);
+        EntityVector entities;
+        fill(entities, 100, ~size_t(0), begin_count, end_count);
+
+        OnFrameBeginRecorder recorder;
+        const bool success =
+            invoke_on_frame_begin_parallel(entities, project.ref(), nullptr, recorder, nullptr);
+        recorder.on_frame_end(project.ref());
+
+        EXPECT_TRUE(success);
+        EXPECT_EQ(100, begin_count.load());
+        EXPECT_EQ(100, end_count.load());
+    }
+
+    TEST_CASE(InvokeOnFrameBeginParallel_GivenFailingEntity_ReturnsFalseAndRecordsSucceedingEntities)
+    {
+        auto_release_ptr<Project> project(ProjectFactory::create("project"));
+
+        boost::atomic<size_t> begin_count(0), end_count(0);
+        EntityVector entities;
+        fill(entities, 100, 50, begin_count, end_count);
+
+        OnFrameBeginRecorder recorder;
+        const bool success =
+            invoke_on_frame_begin_parallel(entities, project.ref(), nullptr, recorder, nullptr);
+        recorder.on_frame_end(project.ref());
+
+        EXPECT_FALSE(success);
+        EXPECT_EQ(begin_count.load(), end_count.load());
+    }
+}
@@ -27,6 +27,8 @@
 //
 
 // appleseed.renderer headers.
+#include "renderer/kernel/rendering/permanentshadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
 #include "renderer/modeling/aov/aov.h"
 #include "renderer/modeling/aov/aovcontainer.h"
 #include "renderer/modeling/aov/diffuseaov.h"
@@ -35,8 +37,16 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
 #include "foundation/platform/thread.h"
+#include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
 #include "foundation/utility/test.h"
 
 // Boost headers.
@@ -179,4 +189,211 @@ TEST_SUITE(Renderer_Modeling_Frame_Frame)
         EXPECT_TRUE(bf::exists(m_output_directory / "override.direct_glossy.exr"));         // note: file name overridden and exr extension added
         EXPECT_TRUE(bf::exists(m_output_directory / "override.indirect_glossy.exr"));       // note: file name overridden and exr extension added
     }
+
+    TEST_CASE(Constructor_GivenAutoTileSizeAndSmallFrame_UsesSmallestTileSize)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "32 32")
+                    .insert("tile_size", "auto")));
+
+        EXPECT_EQ(16, frame->image().properties().m_tile_width);
+        EXPECT_EQ(16, frame->image().properties().m_tile_height);
+    }
+
+    TEST_CASE(Constructor_GivenAutoTileSizeAndLargeFrame_UsesLargestTileSize)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "8192 8192")
+                    .insert("tile_size", "auto")));
+
+        EXPECT_EQ(64, frame->image().properties().m_tile_width);
+        EXPECT_EQ(64, frame->image().properties().m_tile_height);
+    }
+
+    TEST_CASE(BeginOutputStreaming_GivenOutputStreamingIsDisabled_ReturnsFalse)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "32 32")
+                    .insert("output_filename", "unit tests/outputs/test_frame_streaming_disabled.exr")));
+
+        EXPECT_FALSE(frame->begin_output_streaming(true));
+        EXPECT_FALSE(frame->is_output_streamed());
+    }
+
+    TEST_CASE(EndOutputStreaming_GivenStreamedTiles_WritesImageFile)
+    {
+        const bf::path file_path = bf::absolute("unit tests/outputs/test_frame_streaming.exr");
+        remove(file_path);
+
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "32 32")
+                    .insert("tile_size", "16 16")
+                    .insert("output_streaming", true)
+                    .insert("output_filename", file_path.string())));
+        frame->clear_main_and_aov_images();
+
+        ASSERT_TRUE(frame->begin_output_streaming(true));
+        frame->stream_tile(0, 0);
+        frame->stream_tile(1, 1);
+        EXPECT_TRUE(frame->end_output_streaming());
+
+        EXPECT_TRUE(frame->is_output_streamed());
+        EXPECT_TRUE(bf::exists(file_path));
+        EXPECT_TRUE(frame->write_main_image(file_path.string().c_str()));
+        EXPECT_FALSE(frame->write_main_image("unit tests/outputs/test_frame_streaming_other.exr"));
+    }
+
+    TEST_CASE(SaveCheckpoint_ThenWaitForCheckpoint_WritesCheckpointThatCanBeResumed)
+    {
+        const bf::path file_path = bf::absolute("unit tests/outputs/test_frame.checkpoint.exr");
+        remove(file_path);
+
+        AOVContainer aovs;
+        aovs.insert(DirectDiffuseAOVFactory().create(ParamArray()));
+
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "32 32")
+                    .insert("tile_size", "16 16")
+                    .insert("passes", 4)
+                    .insert("checkpoint_create", true)
+                    .insert("checkpoint_create_path", file_path.string())
+                    .insert("checkpoint_resume", true)
+                    .insert("checkpoint_resume_path", file_path.string()),
+                aovs));
+        frame->clear_main_and_aov_images();
+
+        PermanentShadingResultFrameBufferFactory buffer_factory(frame.ref());
+        frame->save_checkpoint(&buffer_factory, 0);
+        frame->save_checkpoint(&buffer_factory, 1);
+        frame->wait_for_checkpoint();
+
+        ASSERT_TRUE(bf::exists(file_path));
+        ASSERT_TRUE(frame->load_checkpoint(&buffer_factory));
+        EXPECT_EQ(2, frame->get_initial_pass());
+    }
+
+    void render_checkpoint(
+        const bf::path&     file_path,
+        const char*         pass_range,
+        const float         value)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "16 16")
+                    .insert("passes", 2)
+                    .insert("pass_range", pass_range)
+                    .insert("checkpoint_create", true)
+                    .insert("checkpoint_create_path", file_path.string())));
+
+        // Store a single sample of a given value in each pixel.
+        PermanentShadingResultFrameBufferFactory buffer_factory(frame.ref());
+        ShadingResultFrameBuffer* framebuffer =
+            buffer_factory.create(frame.ref(), 0, 0, AABB2u(Vector2u(0, 0), Vector2u(15, 15)));
+        for (size_t i = 0, e = framebuffer->get_pixel_count(); i < e; ++i)
+        {
+            framebuffer->set_component(i, 0, 1.0f);
+            for (size_t c = 1; c < 5; ++c)
+                framebuffer->set_component(i, c, value);
+        }
+
+        frame->save_checkpoint(&buffer_factory, frame->get_end_pass() - 1);
+        frame->wait_for_checkpoint();
+    }
+
+    TEST_CASE(MergeCheckpoints_GivenCheckpointsOfDistinctPassRanges_AveragesSamples)
+    {
+        const bf::path file_path1 = bf::absolute("unit tests/outputs/test_frame_merge1.checkpoint.exr");
+        const bf::path file_path2 = bf::absolute("unit tests/outputs/test_frame_merge2.checkpoint.exr");
+        render_checkpoint(file_path1, "0 0", 1.0f);
+        render_checkpoint(file_path2, "1 1", 3.0f);
+
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "16 16")
+                    .insert("passes", 2)));
+
+        StringArray checkpoint_paths;
+        checkpoint_paths.push_back(file_path1.string().c_str());
+        checkpoint_paths.push_back(file_path2.string().c_str());
+        ASSERT_TRUE(frame->merge_checkpoints(checkpoint_paths));
+
+        Color4f color;
+        frame->image().tile(0, 0).get_pixel(7, 7, color);
+        EXPECT_FEQ(Color4f(2.0f), color);
+    }
+
+    TEST_CASE(Constructor_GivenInvalidPassRange_RendersAllPasses)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "16 16")
+                    .insert("passes", 4)
+                    .insert("pass_range", "2 4")));
+
+        EXPECT_EQ(0, frame->get_initial_pass());
+        EXPECT_EQ(4, frame->get_end_pass());
+    }
+
+    TEST_CASE(Constructor_GivenPassRange_RendersPassesOfRange)
+    {
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray()
+                    .insert("resolution", "16 16")
+                    .insert("passes", 4)
+                    .insert("pass_range", "1 2")));
+
+        EXPECT_EQ(1, frame->get_initial_pass());
+        EXPECT_EQ(3, frame->get_end_pass());
+    }
+
+    TEST_CASE(Constructor_GivenColorAOVWithoutStorageFormat_StoresAOVImageAsHalfFloats)
+    {
+        AOVContainer aovs;
+        aovs.insert(DirectDiffuseAOVFactory().create(ParamArray()));
+
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray().insert("resolution", "32 32"),
+                aovs));
+
+        EXPECT_EQ(PixelFormatHalf, frame->aovs().get_by_index(0)->get_image().properties().m_pixel_format);
+    }
+
+    TEST_CASE(Constructor_GivenColorAOVWithFloatStorageFormat_StoresAOVImageAsFloats)
+    {
+        AOVContainer aovs;
+        aovs.insert(DirectDiffuseAOVFactory().create(ParamArray().insert("storage_format", "float")));
+
+        auto_release_ptr<Frame> frame(
+            FrameFactory::create(
+                "frame",
+                ParamArray().insert("resolution", "32 32"),
+                aovs));
+
+        EXPECT_EQ(PixelFormatFloat, frame->aovs().get_by_index(0)->get_image().properties().m_pixel_format);
+    }
 }
@@ -95,4 +95,39 @@ TEST_SUITE(Renderer_Modeling_Input_InputArray)
 
         EXPECT_EQ(expected_source, source);
     }
+
+    struct Values
+    {
+        float m_x;
+        float m_y;
+    };
+
+    TEST_CASE(EvaluateUniforms_GivenBoundAndUnboundInputs_ReturnsBoundValuesAndZeroes)
+    {
+        InputArray inputs;
+        inputs.declare("x", InputFormatFloat);
+        inputs.declare("y", InputFormatFloat);
+        inputs.find("y").bind(new ScalarSource(2.0));
+
+        Values values;
+        inputs.evaluate_uniforms(&values);
+
+        EXPECT_EQ(0.0f, values.m_x);
+        EXPECT_EQ(2.0f, values.m_y);
+    }
+
+    TEST_CASE(EvaluateUniforms_AfterRebindingInput_ReturnsNewValue)
+    {
+        InputArray inputs;
+        inputs.declare("x", InputFormatFloat);
+        inputs.declare("y", InputFormatFloat);
+        inputs.find("x").bind(new ScalarSource(1.0));
+        inputs.find("x").bind(new ScalarSource(3.0));
+
+        Values values;
+        inputs.evaluate_uniforms(&values);
+
+        EXPECT_EQ(3.0f, values.m_x);
+        EXPECT_EQ(0.0f, values.m_y);
+    }
 }
@@ -0,0 +1,161 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/irradiancepointcloud.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_IrradiancePointCloud)
+{
+    const BSSRDF* FakeBSSRDF = reinterpret_cast<const BSSRDF*>(1);
+    const ObjectInstance* FakeObjectInstance = reinterpret_cast<const ObjectInstance*>(2);
+    const ObjectInstance* OtherFakeObjectInstance = reinterpret_cast<const ObjectInstance*>(3);
+
+    struct ConstantProfile
+    {
+        void operator()(const float square_distance, Spectrum& value) const
+        {
+            value.set(1.0f);
+        }
+    };
+
+    struct ExponentialProfile
+    {
+        void operator()(const float square_distance, Spectrum& value) const
+        {
+            value.set(exp(-10.0f * sqrt(square_distance)));
+        }
+    };
+
+    // A 60x60 grid of records with unit irradiance covering [0,1]^2 on the y = 0 plane.
+    void fill(IrradiancePointCloud& cloud)
+    {
+        const size_t Resolution = 60;
+
+        IrradiancePointCloud::RecordVector records;
+
+        for (size_t i = 0; i < Resolution; ++i)
+        {
+            for (size_t j = 0; j < Resolution; ++j)
+            {
+                IrradiancePointCloud::Record record;
+                record.m_position =
+                    Vector3f(
+                        (i + 0.5f) / Resolution,
+                        0.0f,
+                        (j + 0.5f) / Resolution);
+                record.m_bssrdf = FakeBSSRDF;
+                record.m_object_instance = FakeObjectInstance;
+                record.m_irradiance.set(1.0f);
+                records.push_back(record);
+            }
+        }
+
+        cloud.insert(records);
+        cloud.set_recording(false);
+        cloud.update();
+    }
+
+    TEST_CASE(IsReady_WhileRecording_ReturnsFalse)
+    {
+        IrradiancePointCloud cloud(0.1f, 10000);
+        fill(cloud);
+        cloud.set_recording(true);
+
+        EXPECT_FALSE(cloud.is_ready());
+    }
+
+    TEST_CASE(Integrate_GivenUnknownSurface_ReturnsFalse)
+    {
+        IrradiancePointCloud cloud(0.1f, 10000);
+        fill(cloud);
+
+        Spectrum result;
+        const bool found =
+            cloud.integrate(
+                Vector3f(0.5f, 0.0f, 0.5f),
+                FakeBSSRDF,
+                OtherFakeObjectInstance,
+                1.0f,
+                ConstantProfile(),
+                result);
+
+        EXPECT_FALSE(found);
+    }
+
+    TEST_CASE(Integrate_GivenConstantProfile_ReturnsAreaOfDisk)
+    {
+        IrradiancePointCloud cloud(0.1f, 10000);
+        fill(cloud);
+
+        const float Radius = 0.25f;
+
+        Spectrum result;
+        const bool found =
+            cloud.integrate(
+                Vector3f(0.5f, 0.0f, 0.5f),
+                FakeBSSRDF,
+                FakeObjectInstance,
+                Radius,
+                ConstantProfile(),
+                result);
+
+        ASSERT_TRUE(found);
+        EXPECT_FEQ_EPS(Pi<float>() * Radius * Radius, result[0], 0.03f);
+    }
+
+    TEST_CASE(Integrate_UsingNodeAggregates_MatchesIntegrationOverAllRecords)
+    {
+        IrradiancePointCloud coarse_cloud(0.1f, 10000);
+        fill(coarse_cloud);
+
+        IrradiancePointCloud exact_cloud(0.0f, 10000);
+        fill(exact_cloud);
+
+        const Vector3f position(0.3f, 0.0f, 0.6f);
+
+        Spectrum coarse_result, exact_result;
+        coarse_cloud.integrate(position, FakeBSSRDF, FakeObjectInstance, 1.0f, ExponentialProfile(), coarse_result);
+        exact_cloud.integrate(position, FakeBSSRDF, FakeObjectInstance, 1.0f, ExponentialProfile(), exact_result);
+
+        EXPECT_FEQ_EPS(exact_result[0], coarse_result[0], 0.02f);
+    }
+}
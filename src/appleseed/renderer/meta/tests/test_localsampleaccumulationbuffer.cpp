@@ -30,8 +30,8 @@
 #include "renderer/kernel/rendering/localsampleaccumulationbuffer.h"
 
 // appleseed.foundation headers.
-#include "foundation/image/accumulatortile.h"
 #include "foundation/image/color.h"
+#include "foundation/image/coloraccumulatortile.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/rng/distribution.h"
@@ -52,7 +52,7 @@ TEST_SUITE(Renderer_Kernel_Rendering_LocalSampleAccumulationBuffer)
     bool honors_crop_window(const AABB2u& crop_window)
     {
         // A full low resolution framebuffer.
-        AccumulatorTile level(64, 64, 4);
+        ColorAccumulatorTile level(64, 64);
         level.clear();
 
         for (size_t y = 0; y < level.get_height(); ++y)
@@ -0,0 +1,169 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/camera/pinholecamera.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/lodselector.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Modeling_Scene_LODSelector)
+{
+    struct Fixture
+    {
+        auto_release_ptr<Scene>     m_scene;
+        AssemblyInstance*           m_assembly_instance;
+        ObjectInstance*             m_object_instance;
+
+        Fixture()
+          : m_scene(SceneFactory::create())
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            // A unit object and two coarser variants of it.
+            const char* ObjectNames[] = { "object", "object_lod1", "object_lod2" };
+            for (size_t i = 0; i < 3; ++i)
+            {
+                assembly->objects().insert(
+                    auto_release_ptr<Object>(
+                        new BoundingBoxObject(
+                            ObjectNames[i],
+                            GAABB3(GVector3(-0.5), GVector3(+0.5)))));
+            }
+
+            ParamArray object_instance_params;
+            object_instance_params.insert_path("lod.objects", "object_lod1 object_lod2");
+            object_instance_params.insert_path("lod.screen_sizes", "0.5 0.1");
+
+            auto_release_ptr<ObjectInstance> object_instance(
+                ObjectInstanceFactory::create(
+                    "object_inst",
+                    object_instance_params,
+                    "object",
+                    Transformd::identity(),
+                    StringDictionary()));
+            m_object_instance = object_instance.get();
+            assembly->object_instances().insert(object_instance);
+
+            auto_release_ptr<AssemblyInstance> assembly_instance(
+                AssemblyInstanceFactory::create(
+                    "assembly_inst",
+                    ParamArray(),
+                    "assembly"));
+            m_assembly_instance = assembly_instance.get();
+
+            m_scene->assemblies().insert(assembly);
+            m_scene->assembly_instances().insert(assembly_instance);
+
+            m_assembly_instance->bind_assembly(m_scene->assemblies());
+            m_object_instance->bind_object(m_assembly_instance->get_assembly().objects());
+            m_object_instance->check_object();
+        }
+
+        // Move the object at a given distance in front of a camera sitting at the origin.
+        void place_object(const double distance)
+        {
+            m_assembly_instance->transform_sequence().set_transform(
+                0.0f,
+                Transformd::from_local_to_parent(
+                    Matrix4d::make_translation(Vector3d(0.0, 0.0, -distance))));
+        }
+
+        size_t select_lods()
+        {
+            auto_release_ptr<Camera> camera(
+                PinholeCameraFactory().create("camera", ParamArray()));
+
+            return select_object_instance_lods(m_scene.ref(), camera.ref());
+        }
+    };
+
+    TEST_CASE_F(SelectObjectInstanceLODs_GivenCloseObject_KeepsBaseObject, Fixture)
+    {
+        place_object(1.0);
+
+        EXPECT_EQ(0, select_lods());
+        EXPECT_EQ(0, m_object_instance->get_lod());
+        EXPECT_EQ("object", string(m_object_instance->get_object().get_name()));
+    }
+
+    TEST_CASE_F(SelectObjectInstanceLODs_GivenDistantObject_SelectsCoarsestVariant, Fixture)
+    {
+        place_object(100.0);
+
+        EXPECT_EQ(1, select_lods());
+        EXPECT_EQ(2, m_object_instance->get_lod());
+        EXPECT_EQ("object_lod2", string(m_object_instance->get_object().get_name()));
+    }
+
+    TEST_CASE_F(SelectObjectInstanceLODs_GivenObjectMovingCloser_SelectsFinerVariant, Fixture)
+    {
+        place_object(100.0);
+        select_lods();
+
+        place_object(5.0);
+
+        EXPECT_EQ(1, select_lods());
+        EXPECT_EQ(1, m_object_instance->get_lod());
+        EXPECT_EQ("object_lod1", string(m_object_instance->get_object().get_name()));
+    }
+
+    TEST_CASE_F(SelectObjectInstanceLODs_GivenUnchangedSelection_ReturnsZero, Fixture)
+    {
+        place_object(100.0);
+        select_lods();
+
+        EXPECT_EQ(0, select_lods());
+    }
+}
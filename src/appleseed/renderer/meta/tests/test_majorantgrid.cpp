@@ -0,0 +1,217 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/volume/majorantgrid.h"
+#include "renderer/kernel/volume/volume.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/ray.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Volume_MajorantGrid)
+{
+    // An 8x8x8 voxel grid that is empty except for a slab of constant density at x >= 0.5.
+    struct SlabFixture
+    {
+        VoxelGrid       m_voxel_grid;
+
+        SlabFixture()
+          : m_voxel_grid(8, 8, 8, 1)
+        {
+            for (size_t z = 0; z < 8; ++z)
+            {
+                for (size_t y = 0; y < 8; ++y)
+                {
+                    for (size_t x = 4; x < 8; ++x)
+                        m_voxel_grid.voxel(x, y, z)[0] = 2.0f;
+                }
+            }
+        }
+    };
+
+    struct ConstantDensity
+    {
+        float m_density;
+
+        explicit ConstantDensity(const float density)
+          : m_density(density)
+        {
+        }
+
+        float operator()(const double t) const
+        {
+            return m_density;
+        }
+    };
+
+    struct SegmentRecorder
+    {
+        vector<double>  m_t0;
+        vector<double>  m_t1;
+        vector<float>   m_majorants;
+
+        bool operator()(const double t0, const double t1, const float majorant)
+        {
+            m_t0.push_back(t0);
+            m_t1.push_back(t1);
+            m_majorants.push_back(majorant);
+            return true;
+        }
+    };
+
+    TEST_CASE_F(Constructor_MajorantsBoundDensitiesOfCell, SlabFixture)
+    {
+        const MajorantGrid grid(m_voxel_grid, 0, 2);
+
+        ASSERT_EQ(4, grid.get_xres());
+        EXPECT_EQ(0.0f, grid.get_majorant(0, 0, 0));
+        EXPECT_EQ(2.0f, grid.get_majorant(3, 0, 0));
+        EXPECT_EQ(2.0f, grid.get_max_majorant());
+    }
+
+    TEST_CASE_F(Constructor_CellNextToDenseRegion_IncludesNeighborVoxelUsedByTrilinearLookups, SlabFixture)
+    {
+        const MajorantGrid grid(m_voxel_grid, 0, 2);
+
+        EXPECT_EQ(2.0f, grid.get_majorant(1, 0, 0));
+    }
+
+    TEST_CASE_F(Constructor_GivenSparseGrid_MajorantsBoundDensities, SlabFixture)
+    {
+        const unique_ptr<SparseVoxelGrid> sparse_grid(create_sparse_voxel_grid(m_voxel_grid));
+        const MajorantGrid grid(*sparse_grid, 0, 2);
+
+        ASSERT_EQ(4, grid.get_xres());
+        EXPECT_EQ(2.0f, grid.get_majorant(3, 0, 0));
+        EXPECT_EQ(2.0f, grid.get_max_majorant());
+    }
+
+    TEST_CASE(Constructor_GivenSparseGrid_CellsOverUnallocatedLeavesAreEmpty)
+    {
+        VoxelGrid voxel_grid(32, 8, 8, 1);
+        voxel_grid.voxel(30, 4, 4)[0] = 1.0f;
+
+        const unique_ptr<SparseVoxelGrid> sparse_grid(create_sparse_voxel_grid(voxel_grid));
+        const MajorantGrid grid(*sparse_grid, 0, 4);
+
+        ASSERT_EQ(1, sparse_grid->get_leaf_count());
+        EXPECT_EQ(0.0f, grid.get_majorant(0, 0, 0));
+        EXPECT_EQ(1.0f, grid.get_majorant(7, 1, 1));
+    }
+
+    TEST_CASE_F(Traverse_SegmentsAreContiguousAndCoverClippedRay, SlabFixture)
+    {
+        const MajorantGrid grid(m_voxel_grid, 0, 2);
+        const Ray3d ray(Vector3d(-0.5, 0.3, 0.6), normalize(Vector3d(1.0, 0.2, -0.1)));
+
+        SegmentRecorder recorder;
+        grid.traverse(ray, 0.0, 10.0, recorder);
+
+        ASSERT_FALSE(recorder.m_t0.empty());
+
+        for (size_t i = 1; i < recorder.m_t0.size(); ++i)
+            EXPECT_FEQ(recorder.m_t1[i - 1], recorder.m_t0[i]);
+
+        // The ray enters the unit cube at x = 0 and leaves it at x = 1.
+        EXPECT_FEQ_EPS(0.0, ray.point_at(recorder.m_t0.front()).x, 1.0e-9);
+        EXPECT_FEQ_EPS(1.0, ray.point_at(recorder.m_t1.back()).x, 1.0e-9);
+    }
+
+    TEST_CASE_F(Traverse_RayMissingGrid_VisitsNoCell, SlabFixture)
+    {
+        const MajorantGrid grid(m_voxel_grid, 0, 2);
+        const Ray3d ray(Vector3d(-0.5, 2.0, 0.5), Vector3d(1.0, 0.0, 0.0));
+
+        SegmentRecorder recorder;
+        grid.traverse(ray, 0.0, 10.0, recorder);
+
+        EXPECT_TRUE(recorder.m_t0.empty());
+    }
+
+    TEST_CASE_F(EstimateTransmission_ThroughEmptyCells_ReturnsOne, SlabFixture)
+    {
+        const MajorantGrid grid(m_voxel_grid, 0, 2);
+        const Ray3d ray(Vector3d(0.1, 0.5, 0.5), Vector3d(0.0, 1.0, 0.0));
+
+        ConstantDensity density(0.0f);
+        MersenneTwister rng;
+
+        EXPECT_EQ(1.0f, grid.estimate_transmission(ray, 0.0, 10.0, 1.0f, density, rng));
+    }
+
+    TEST_CASE(SampleDistance_GivenConstantDensity_CollisionProbabilityMatchesBeerLambert)
+    {
+        VoxelGrid voxel_grid(4, 4, 4, 1);
+        for (size_t z = 0; z < 4; ++z)
+        {
+            for (size_t y = 0; y < 4; ++y)
+            {
+                for (size_t x = 0; x < 4; ++x)
+                    voxel_grid.voxel(x, y, z)[0] = 1.0f;
+            }
+        }
+
+        const MajorantGrid grid(voxel_grid, 0, 1);
+        const Ray3d ray(Vector3d(0.0, 0.5, 0.5), Vector3d(1.0, 0.0, 0.0));
+
+        // Half of the density is real, the rest produces null collisions.
+        ConstantDensity density(0.5f);
+        MersenneTwister rng;
+
+        const size_t SampleCount = 20000;
+        size_t collision_count = 0;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            double distance;
+            if (grid.sample_distance(ray, 0.0, 1.0, 2.0f, density, rng, distance))
+            {
+                EXPECT_TRUE(distance >= 0.0 && distance < 1.0);
+                ++collision_count;
+            }
+        }
+
+        // The extinction coefficient is 0.5 * 2 = 1 over a unit length.
+        const double expected = 1.0 - exp(-1.0);
+        EXPECT_FEQ_EPS(expected, static_cast<double>(collision_count) / SampleCount, 0.02);
+    }
+}
@@ -0,0 +1,208 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectoperations.h"
+#include "renderer/modeling/object/triangle.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/triangle.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Modeling_Object_MeshObjectOperations)
+{
+    // A flat grid of 16x16 quads, each split into two triangles.
+    struct GridFixture
+    {
+        static const size_t Resolution = 16;
+
+        auto_release_ptr<MeshObject> m_grid;
+
+        GridFixture()
+          : m_grid(MeshObjectFactory().create("grid", ParamArray()))
+        {
+            m_grid->push_material_slot("front");
+            m_grid->push_material_slot("back");
+
+            for (size_t y = 0; y <= Resolution; ++y)
+            {
+                for (size_t x = 0; x <= Resolution; ++x)
+                {
+                    m_grid->push_vertex(
+                        GVector3(
+                            static_cast<GScalar>(x) / Resolution,
+                            static_cast<GScalar>(y) / Resolution,
+                            GScalar(0.0)));
+                }
+            }
+
+            for (size_t y = 0; y < Resolution; ++y)
+            {
+                for (size_t x = 0; x < Resolution; ++x)
+                {
+                    const size_t v0 = y * (Resolution + 1) + x;
+                    const size_t v1 = v0 + 1;
+                    const size_t v2 = v1 + Resolution + 1;
+                    const size_t v3 = v0 + Resolution + 1;
+                    const size_t pa = (x + y) % 2;
+
+                    m_grid->push_triangle(Triangle(v0, v1, v2, pa));
+                    m_grid->push_triangle(Triangle(v0, v2, v3, pa));
+                }
+            }
+        }
+    };
+
+    // A wavy grid large enough for normals to be computed on several threads.
+    struct LargeWavyGridFixture
+    {
+        static const size_t Resolution = 300;
+
+        auto_release_ptr<MeshObject> m_grid;
+
+        LargeWavyGridFixture()
+          : m_grid(MeshObjectFactory().create("grid", ParamArray()))
+        {
+            for (size_t y = 0; y <= Resolution; ++y)
+            {
+                for (size_t x = 0; x <= Resolution; ++x)
+                {
+                    const GScalar u = static_cast<GScalar>(x) / Resolution;
+                    const GScalar v = static_cast<GScalar>(y) / Resolution;
+                    m_grid->push_vertex(GVector3(u, v, GScalar(0.1) * sin(GScalar(20.0) * u) * cos(GScalar(13.0) * v)));
+                }
+            }
+
+            for (size_t y = 0; y < Resolution; ++y)
+            {
+                for (size_t x = 0; x < Resolution; ++x)
+                {
+                    const size_t v0 = y * (Resolution + 1) + x;
+                    const size_t v1 = v0 + 1;
+                    const size_t v2 = v1 + Resolution + 1;
+                    const size_t v3 = v0 + Resolution + 1;
+
+                    m_grid->push_triangle(Triangle(v0, v1, v2, 0));
+                    m_grid->push_triangle(Triangle(v0, v2, v3, 0));
+                }
+            }
+        }
+    };
+
+    TEST_CASE_F(ComputeSmoothVertexNormals_MatchesSequentialSum, LargeWavyGridFixture)
+    {
+        const size_t vertex_count = m_grid->get_vertex_count();
+
+        // Sum triangle normals in triangle order, then store them the way the mesh stores normals.
+        vector<GVector3> sums(vertex_count, GVector3(0.0));
+        for (size_t i = 0, e = m_grid->get_triangle_count(); i < e; ++i)
+        {
+            const Triangle& triangle = m_grid->get_triangle(i);
+            const GVector3 normal =
+                normalize(
+                    compute_triangle_normal(
+                        m_grid->get_vertex(triangle.m_v0),
+                        m_grid->get_vertex(triangle.m_v1),
+                        m_grid->get_vertex(triangle.m_v2)));
+            sums[triangle.m_v0] += normal;
+            sums[triangle.m_v1] += normal;
+            sums[triangle.m_v2] += normal;
+        }
+
+        auto_release_ptr<MeshObject> expected(MeshObjectFactory().create("expected", ParamArray()));
+        for (size_t i = 0; i < vertex_count; ++i)
+            expected->push_vertex_normal(safe_normalize(sums[i]));
+
+        compute_smooth_vertex_normals(m_grid.ref());
+
+        ASSERT_EQ(vertex_count, m_grid->get_vertex_normal_count());
+
+        size_t mismatch_count = 0;
+        for (size_t i = 0; i < vertex_count; ++i)
+        {
+            if (m_grid->get_vertex_normal(i) != expected->get_vertex_normal(i))
+                ++mismatch_count;
+        }
+
+        EXPECT_EQ(0, mismatch_count);
+    }
+
+    TEST_CASE_F(CreateDecimatedMesh_ReducesTriangleCount, GridFixture)
+    {
+        auto_release_ptr<MeshObject> proxy(create_decimated_mesh("proxy", m_grid.ref(), 0.25));
+
+        EXPECT_LT(m_grid->get_vertex_count(), proxy->get_vertex_count() * 2);
+        EXPECT_GT(0, proxy->get_triangle_count());
+        EXPECT_LT(m_grid->get_triangle_count(), proxy->get_triangle_count());
+    }
+
+    TEST_CASE_F(CreateDecimatedMesh_DoesNotCreateDegenerateTriangles, GridFixture)
+    {
+        auto_release_ptr<MeshObject> proxy(create_decimated_mesh("proxy", m_grid.ref(), 0.25));
+
+        for (size_t i = 0, e = proxy->get_triangle_count(); i < e; ++i)
+        {
+            const Triangle& triangle = proxy->get_triangle(i);
+            EXPECT_NEQ(triangle.m_v0, triangle.m_v1);
+            EXPECT_NEQ(triangle.m_v1, triangle.m_v2);
+            EXPECT_NEQ(triangle.m_v2, triangle.m_v0);
+        }
+    }
+
+    TEST_CASE_F(CreateDecimatedMesh_KeepsMaterialSlots, GridFixture)
+    {
+        auto_release_ptr<MeshObject> proxy(create_decimated_mesh("proxy", m_grid.ref(), 0.25));
+
+        ASSERT_EQ(2, proxy->get_material_slot_count());
+        EXPECT_EQ(string("front"), proxy->get_material_slot(0));
+        EXPECT_EQ(string("back"), proxy->get_material_slot(1));
+    }
+
+    TEST_CASE_F(CreateDecimatedMesh_GivenRatioOfOne_KeepsAllVertices, GridFixture)
+    {
+        auto_release_ptr<MeshObject> proxy(create_decimated_mesh("proxy", m_grid.ref(), 1.0));
+
+        EXPECT_EQ(m_grid->get_vertex_count(), proxy->get_vertex_count());
+        EXPECT_EQ(m_grid->get_triangle_count(), proxy->get_triangle_count());
+    }
+}
@@ -0,0 +1,122 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/pointinstancer.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
+#include "renderer/utility/testutils.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Scene_PointInstancer)
+{
+    TEST_CASE(GetInstanceTransform_ReturnsPushedTransform)
+    {
+        auto_release_ptr<PointInstancer> point_instancer(
+            PointInstancerFactory::create("point_instancer", ParamArray()));
+
+        point_instancer->push_prototype("assembly");
+
+        const Transformd transform =
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(1.0, 2.0, 3.0)) *
+                Matrix4d::make_scaling(Vector3d(2.0)));
+
+        EXPECT_EQ(0, point_instancer->push_instance(transform, 0));
+        EXPECT_EQ(1, point_instancer->get_instance_count());
+        EXPECT_EQ(0, point_instancer->get_instance_prototype(0));
+        EXPECT_FEQ(transform.get_local_to_parent(), point_instancer->get_instance_transform(0).get_local_to_parent());
+        EXPECT_FEQ(transform.get_parent_to_local(), point_instancer->get_instance_transform(0).get_parent_to_local());
+    }
+
+    struct TestScene
+    {
+        auto_release_ptr<Scene> m_scene;
+
+        TestScene()
+          : m_scene(SceneFactory::create())
+        {
+            auto_release_ptr<Assembly> assembly(
+                AssemblyFactory().create("assembly", ParamArray()));
+
+            assembly->objects().insert(
+                auto_release_ptr<Object>(
+                    new BoundingBoxObject(
+                        "object",
+                        GAABB3(GVector3(-1.0), GVector3(1.0)))));
+
+            assembly->object_instances().insert(
+                ObjectInstanceFactory::create(
+                    "object_instance",
+                    ParamArray(),
+                    "object",
+                    Transformd::identity(),
+                    StringDictionary()));
+
+            m_scene->assemblies().insert(assembly);
+
+            auto_release_ptr<PointInstancer> point_instancer(
+                PointInstancerFactory::create("point_instancer", ParamArray()));
+
+            point_instancer->push_prototype("assembly");
+            point_instancer->push_instance(
+                Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(-5.0, 0.0, 0.0))),
+                0);
+            point_instancer->push_instance(
+                Transformd::from_local_to_parent(Matrix4d::make_translation(Vector3d(5.0, 0.0, 0.0))),
+                0);
+
+            m_scene->point_instancers().insert(point_instancer);
+        }
+    };
+
+    TEST_CASE_F(ComputeParentBBox_ReturnsUnionOfInstanceBBoxes, TestScene)
+    {
+        const PointInstancer* point_instancer =
+            m_scene->point_instancers().get_by_name("point_instancer");
+        const GAABB3 parent_bbox = point_instancer->compute_parent_bbox();
+
+        EXPECT_EQ(GAABB3(GVector3(-6.0, -1.0, -1.0), GVector3(6.0, 1.0, 1.0)), parent_bbox);
+    }
+}
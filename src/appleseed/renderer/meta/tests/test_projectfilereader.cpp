@@ -76,6 +76,49 @@ TEST_SUITE(Renderer_Modeling_Project_ProjectFileReader)
         EXPECT_TRUE(identical);
     }
 
+    TEST_CASE(BinaryProjectFileRoundTrip)
+    {
+        ProjectFileReader reader;
+        auto_release_ptr<Project> project =
+            reader.read(
+                "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed",
+                "../../../schemas/project.xsd",             // path relative to input file
+                ProjectFileReader::OmitProjectFileUpdate);
+
+        ASSERT_NEQ(0, project.get());
+
+        const bool binary_success =
+            ProjectFileWriter::write(
+                project.ref(),
+                "unit tests/outputs/test_projectfilereader_binaryprojectfile.appleseedb",
+                ProjectFileWriter::OmitHeaderComment);
+
+        ASSERT_TRUE(binary_success);
+
+        auto_release_ptr<Project> binary_project =
+            reader.read(
+                "unit tests/outputs/test_projectfilereader_binaryprojectfile.appleseedb",
+                "../../../schemas/project.xsd",             // binary project files are not validated
+                ProjectFileReader::OmitProjectFileUpdate);
+
+        ASSERT_NEQ(0, binary_project.get());
+
+        const bool success =
+            ProjectFileWriter::write(
+                binary_project.ref(),
+                "unit tests/outputs/test_projectfilereader_binaryprojectfile.appleseed",
+                ProjectFileWriter::OmitHeaderComment);
+
+        ASSERT_TRUE(success);
+
+        const bool identical =
+            compare_text_files(
+                "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed",
+                "unit tests/outputs/test_projectfilereader_binaryprojectfile.appleseed");
+
+        EXPECT_TRUE(identical);
+    }
+
     TEST_CASE(ReadValidPackedProject)
     {
         const char* UnpackDirectory = "unit tests/inputs/test_projectfilereader_validpackedproject.unpacked/";
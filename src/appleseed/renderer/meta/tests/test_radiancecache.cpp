@@ -0,0 +1,126 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/lighting/radiancecache.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/knn.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_RadianceCache)
+{
+    const Material* FakeMaterial = reinterpret_cast<const Material*>(1);
+
+    struct Fixture
+    {
+        RadianceCache           m_cache;
+        knn::Answer<float>      m_answer;
+
+        Fixture()
+          : m_cache(1.0f, 1000)
+          , m_answer(RadianceCache::LookupRecordCount)
+        {
+            // A grid of records on the y = 0 plane, facing +Y.
+            RadianceCache::RecordVector records;
+
+            for (size_t i = 0; i < 10; ++i)
+            {
+                for (size_t j = 0; j < 10; ++j)
+                {
+                    RadianceCache::Record record;
+                    record.m_position = Vector3f(0.1f * i, 0.0f, 0.1f * j);
+                    record.m_normal = Vector3f(0.0f, 1.0f, 0.0f);
+                    record.m_material = FakeMaterial;
+                    record.m_radiance.set(2.0f);
+                    records.push_back(record);
+                }
+            }
+
+            m_cache.insert(records);
+        }
+    };
+
+    TEST_CASE_F(Lookup_BeforeUpdate_ReturnsFalse, Fixture)
+    {
+        Spectrum radiance;
+        EXPECT_FALSE(m_cache.lookup(Vector3f(0.5f, 0.0f, 0.5f), Vector3f(0.0f, 1.0f, 0.0f), FakeMaterial, m_answer, radiance));
+    }
+
+    TEST_CASE_F(Lookup_GivenMatchingSurface_ReturnsAverageRadiance, Fixture)
+    {
+        m_cache.update();
+
+        Spectrum radiance;
+        ASSERT_TRUE(m_cache.lookup(Vector3f(0.5f, 0.0f, 0.5f), Vector3f(0.0f, 1.0f, 0.0f), FakeMaterial, m_answer, radiance));
+
+        EXPECT_FEQ(2.0f, radiance[0]);
+    }
+
+    TEST_CASE_F(Lookup_GivenOppositeNormal_ReturnsFalse, Fixture)
+    {
+        m_cache.update();
+
+        Spectrum radiance;
+        EXPECT_FALSE(m_cache.lookup(Vector3f(0.5f, 0.0f, 0.5f), Vector3f(0.0f, -1.0f, 0.0f), FakeMaterial, m_answer, radiance));
+    }
+
+    TEST_CASE_F(Lookup_GivenOtherMaterial_ReturnsFalse, Fixture)
+    {
+        m_cache.update();
+
+        Spectrum radiance;
+        EXPECT_FALSE(m_cache.lookup(Vector3f(0.5f, 0.0f, 0.5f), Vector3f(0.0f, 1.0f, 0.0f), nullptr, m_answer, radiance));
+    }
+
+    TEST_CASE_F(Lookup_GivenDistantPoint_ReturnsFalse, Fixture)
+    {
+        m_cache.update();
+
+        Spectrum radiance;
+        EXPECT_FALSE(m_cache.lookup(Vector3f(5.0f, 0.0f, 5.0f), Vector3f(0.0f, 1.0f, 0.0f), FakeMaterial, m_answer, radiance));
+    }
+
+    TEST_CASE(Insert_BeyondMaxRecordCount_DiscardsRecordsAndStopsRecording)
+    {
+        RadianceCache cache(1.0f, 3);
+        cache.insert(RadianceCache::RecordVector(5));
+        cache.update();
+
+        EXPECT_EQ(3, cache.size());
+        EXPECT_FALSE(cache.is_recording());
+    }
+}
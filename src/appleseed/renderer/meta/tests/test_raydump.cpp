@@ -0,0 +1,137 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/intersection/raydump.h"
+#include "renderer/kernel/shading/shadingray.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Intersection_RayDump)
+{
+    RayDumpRecord make_record(const size_t i)
+    {
+        const ShadingRay ray(
+            Vector3d(static_cast<double>(i), 1.0, 2.0),
+            Vector3d(0.0, 0.0, 1.0),
+            ShadingRay::Time::create_with_normalized_time(0.5f, 0.0f, 1.0f),
+            i % 2 == 0 ? VisibilityFlags::ShadowRay : VisibilityFlags::CameraRay,
+            static_cast<ShadingRay::DepthType>(i));
+
+        return
+            RayDumpRecord::make(
+                ray,
+                nullptr,
+                i % 2 == 0 ? RayDumpRecord::Probe : RayDumpRecord::Trace,
+                i % 3 == 0 ? -1.0 : static_cast<double>(i));
+    }
+
+    TEST_CASE(ReadRecords_GivenRecordsWrittenInSeveralBatches_ReturnsSameRecords)
+    {
+        const char* Path = "unit tests/outputs/test_raydump_roundtrip.raydump";
+        const size_t RecordCount = 1000;
+
+        vector<RayDumpRecord> written;
+        for (size_t i = 0; i < RecordCount; ++i)
+            written.push_back(make_record(i));
+
+        RayDumpWriter writer;
+        ASSERT_TRUE(writer.open(Path));
+        writer.write(&written[0], 300);
+        writer.write(&written[300], RecordCount - 300);
+        EXPECT_EQ(RecordCount, writer.get_ray_count());
+        ASSERT_TRUE(writer.close());
+
+        RayDumpReader reader;
+        ASSERT_TRUE(reader.open(Path));
+
+        vector<RayDumpRecord> read(RecordCount + 1);
+        size_t read_count = 0;
+        while (const size_t count = reader.read(&read[read_count], read.size() - read_count))
+            read_count += count;
+
+        ASSERT_EQ(RecordCount, read_count);
+
+        for (size_t i = 0; i < RecordCount; ++i)
+        {
+            EXPECT_EQ(written[i].m_org, read[i].m_org);
+            EXPECT_EQ(written[i].m_dir, read[i].m_dir);
+            EXPECT_EQ(written[i].m_flags, read[i].m_flags);
+            EXPECT_EQ(written[i].m_depth, read[i].m_depth);
+            EXPECT_EQ(written[i].m_kind, read[i].m_kind);
+            EXPECT_EQ(written[i].m_hit_distance, read[i].m_hit_distance);
+            EXPECT_EQ(written[i].is_hit(), read[i].is_hit());
+        }
+    }
+
+    TEST_CASE(Record_GivenRayTypeNotRecorded_SkipsRay)
+    {
+        const char* Path = "unit tests/outputs/test_raydump_filtering.raydump";
+
+        RayDumpWriter writer;
+        ASSERT_TRUE(writer.open(Path, VisibilityFlags::CameraRay));
+
+        {
+            RayDumpStream stream(writer);
+
+            for (size_t i = 0; i < 10; ++i)
+            {
+                const ShadingRay ray(
+                    Vector3d(0.0),
+                    Vector3d(0.0, 0.0, 1.0),
+                    ShadingRay::Time::create_with_normalized_time(0.0f, 0.0f, 1.0f),
+                    i % 2 == 0 ? VisibilityFlags::ShadowRay : VisibilityFlags::CameraRay,
+                    0);
+
+                stream.record(ray, nullptr, RayDumpRecord::Trace, 1.0);
+            }
+        }
+
+        EXPECT_EQ(5U, writer.get_ray_count());
+        EXPECT_TRUE(writer.close());
+    }
+
+    TEST_CASE(Open_GivenFileThatIsNotARayDump_ReturnsFalse)
+    {
+        RayDumpReader reader;
+
+        EXPECT_FALSE(reader.open("unit tests/inputs/test_iesparser_1.ies"));
+    }
+}
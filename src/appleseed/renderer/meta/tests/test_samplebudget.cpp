@@ -0,0 +1,109 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/progressive/samplebudget.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/types.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <limits>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_Progressive_SampleBudget)
+{
+    const uint64 Unlimited = numeric_limits<uint64>::max();
+
+    TEST_CASE(ComputeSampleCount_GivenUnknownRate_ReturnsMaxSampleCount)
+    {
+        const SampleBudget budget(100, 10.0, 5000);
+
+        EXPECT_EQ(5000, budget.compute_sample_count(1.0, 250, 0.0));
+    }
+
+    TEST_CASE(ComputeSampleCount_RoundsDownToCompletePasses)
+    {
+        const SampleBudget budget(100, 10.0, Unlimited);
+
+        // 250 samples rendered, 50 samples/second during 9 remaining seconds: 700 samples.
+        EXPECT_EQ(700, budget.compute_sample_count(1.0, 250, 50.0));
+
+        // 250 + 470 = 720 samples, rounded down to 7 passes.
+        EXPECT_EQ(700, budget.compute_sample_count(1.0, 250, 470.0 / 9.0));
+    }
+
+    TEST_CASE(ComputeSampleCount_GivenTimeLimitReached_CompletesPassInProgress)
+    {
+        const SampleBudget budget(100, 10.0, Unlimited);
+
+        EXPECT_EQ(300, budget.compute_sample_count(12.0, 250, 50.0));
+    }
+
+    TEST_CASE(ComputeSampleCount_GivenCompletedPassAndTimeLimitReached_ReturnsSampleCount)
+    {
+        const SampleBudget budget(100, 10.0, Unlimited);
+
+        EXPECT_EQ(300, budget.compute_sample_count(12.0, 300, 50.0));
+    }
+
+    TEST_CASE(ComputeSampleCount_GivenNoSample_RendersAtLeastOnePass)
+    {
+        const SampleBudget budget(100, 10.0, Unlimited);
+
+        EXPECT_EQ(100, budget.compute_sample_count(20.0, 0, 1.0));
+    }
+
+    TEST_CASE(ComputeSampleCount_NeverExceedsMaxSampleCount)
+    {
+        const SampleBudget budget(100, 10.0, 400);
+
+        EXPECT_EQ(400, budget.compute_sample_count(1.0, 250, 1.0e9));
+    }
+
+    TEST_CASE(ComputeSampleCount_GivenHugeRateAndUnlimitedMaxSampleCount_DoesNotOverflow)
+    {
+        const SampleBudget budget(100, 1.0e30, Unlimited);
+
+        EXPECT_EQ(Unlimited, budget.compute_sample_count(0.0, 250, 1.0e30));
+    }
+
+    TEST_CASE(ComputeRemainingTime_ReturnsTimeToReachTargetSampleCount)
+    {
+        EXPECT_FEQ(2.0, SampleBudget::compute_remaining_time(300, 200, 50.0));
+    }
+
+    TEST_CASE(ComputeRemainingTime_GivenTargetReached_ReturnsZero)
+    {
+        EXPECT_EQ(0.0, SampleBudget::compute_remaining_time(300, 300, 50.0));
+    }
+}
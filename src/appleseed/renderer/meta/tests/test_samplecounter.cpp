@@ -82,4 +82,25 @@ TEST_SUITE(Renderer_Kernel_Rendering_Progressive_SampleCounter)
 
         EXPECT_EQ(0, sample_counter.reserve(3));
     }
+
+    TEST_CASE(SetMaxSampleCount_RaiseMaxSampleCountAfterReachingIt_AllowsMoreReservations)
+    {
+        SampleCounter sample_counter(1);
+        sample_counter.reserve(3);
+
+        sample_counter.set_max_sample_count(4);
+
+        EXPECT_EQ(3, sample_counter.reserve(3));
+    }
+
+    TEST_CASE(SetMaxSampleCount_LowerMaxSampleCountBelowReservedSamples_ClampsToReservedSamples)
+    {
+        SampleCounter sample_counter(10);
+        sample_counter.reserve(6);
+
+        sample_counter.set_max_sample_count(2);
+
+        EXPECT_EQ(6, sample_counter.get_max_sample_count());
+        EXPECT_EQ(0, sample_counter.reserve(1));
+    }
 }
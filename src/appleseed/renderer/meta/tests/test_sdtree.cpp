@@ -0,0 +1,187 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sdtree.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/sampling/mappings.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_DTree)
+{
+    // Train a directional tree on radiance arriving mostly from a narrow cone around +Y.
+    void train(DTree& tree)
+    {
+        MersenneTwister rng;
+
+        for (size_t pass = 0; pass < 4; ++pass)
+        {
+            DTree building;
+            building.refine_from(tree, 0.01f, 20);
+
+            for (size_t i = 0; i < 10000; ++i)
+            {
+                const Vector3f d = sample_sphere_uniform(rand_vector2<Vector2f>(rng));
+                building.record(d, d.y > 0.9f ? 100.0f : 1.0f);
+            }
+
+            tree = building;
+        }
+    }
+
+    TEST_CASE(EvaluatePdf_GivenEmptyTree_ReturnsUniformDensity)
+    {
+        const DTree tree;
+
+        EXPECT_FEQ(RcpFourPi<float>(), tree.evaluate_pdf(Vector3f(0.0f, 1.0f, 0.0f)));
+        EXPECT_FEQ(RcpFourPi<float>(), tree.evaluate_pdf(Vector3f(0.0f, 0.0f, -1.0f)));
+    }
+
+    TEST_CASE(Sample_GivenEmptyTree_ReturnsUniformDensity)
+    {
+        const DTree tree;
+
+        float probability;
+        const Vector3f d = tree.sample(Vector2f(0.3f, 0.7f), probability);
+
+        EXPECT_FEQ(1.0f, norm(d));
+        EXPECT_FEQ(RcpFourPi<float>(), probability);
+    }
+
+    TEST_CASE(RefineFrom_GivenTrainedTree_SubdividesTowardEnergy)
+    {
+        DTree tree;
+        train(tree);
+
+        EXPECT_GT(1, tree.get_node_count());
+        EXPECT_GT(RcpFourPi<float>(), tree.evaluate_pdf(Vector3f(0.0f, 1.0f, 0.0f)));
+        EXPECT_LT(RcpFourPi<float>(), tree.evaluate_pdf(Vector3f(0.0f, -1.0f, 0.0f)));
+    }
+
+    TEST_CASE(Sample_ReturnsProbabilityMatchingEvaluatePdf)
+    {
+        DTree tree;
+        train(tree);
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            float probability;
+            const Vector3f d = tree.sample(rand_vector2<Vector2f>(rng), probability);
+
+            EXPECT_FEQ_EPS(1.0f, norm(d), 1.0e-5f);
+            EXPECT_FEQ_EPS(tree.evaluate_pdf(d), probability, 1.0e-3f * probability);
+        }
+    }
+
+    TEST_CASE(EvaluatePdf_IntegratesToOne)
+    {
+        DTree tree;
+        train(tree);
+
+        // The mapping of directions to the unit square preserves areas.
+        const size_t Resolution = 1024;
+
+        double integral = 0.0;
+        for (size_t y = 0; y < Resolution; ++y)
+        {
+            for (size_t x = 0; x < Resolution; ++x)
+            {
+                const Vector2f s(
+                    (x + 0.5f) / Resolution,
+                    (y + 0.5f) / Resolution);
+                integral += tree.evaluate_pdf(sample_sphere_uniform(s));
+            }
+        }
+        integral *= FourPi<double>() / (Resolution * Resolution);
+
+        EXPECT_FEQ_EPS(1.0, integral, 1.0e-3);
+    }
+}
+
+TEST_SUITE(Renderer_Kernel_Lighting_SDTree)
+{
+    TEST_CASE(Update_GivenManySamples_SplitsSpace)
+    {
+        SDTree tree(AABB3d(Vector3d(-1.0), Vector3d(1.0)), 0.5f, 100);
+
+        EXPECT_FALSE(tree.is_ready());
+
+        MersenneTwister rng;
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const Vector3d p(
+                rand_double1(rng, -1.0, 1.0),
+                rand_double1(rng, -1.0, 1.0),
+                rand_double1(rng, -1.0, 1.0));
+            tree.record(p, Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+        }
+
+        tree.update();
+
+        EXPECT_TRUE(tree.is_ready());
+        EXPECT_GT(1, tree.get_leaf_count());
+    }
+
+    TEST_CASE(GetDTree_AfterUpdate_ReturnsLearnedDistribution)
+    {
+        SDTree tree(AABB3d(Vector3d(-1.0), Vector3d(1.0)), 0.5f, 100000);
+
+        // Learn radiance coming mostly from +Y.
+        for (size_t pass = 0; pass < 3; ++pass)
+        {
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                tree.record(Vector3d(0.0, -0.5, 0.0), Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+                tree.record(Vector3d(0.0, -0.5, 0.0), Vector3f(1.0f, 0.0f, 0.0f), 0.01f);
+            }
+
+            tree.update();
+        }
+
+        const DTree& d_tree = tree.get_d_tree(Vector3d(0.0, -0.5, 0.0));
+
+        EXPECT_GT(RcpFourPi<float>(), d_tree.evaluate_pdf(Vector3f(0.0f, 1.0f, 0.0f)));
+        EXPECT_LT(RcpFourPi<float>(), d_tree.evaluate_pdf(Vector3f(0.0f, -1.0f, 0.0f)));
+    }
+}
@@ -0,0 +1,138 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_ShaderGroup)
+{
+    TEST_CASE(GetFallbackAlbedo_NoColorParameter_ReturnsMiddleGray)
+    {
+        auto_release_ptr<ShaderGroup> shader_group(ShaderGroupFactory::create("shader_group"));
+        shader_group->add_shader(
+            "shader",
+            "as_glass",
+            "layer",
+            ParamArray()
+                .insert("in_ior", "float 1.5")
+                .insert("in_transmittance", "color 0.1 0.2 0.3"));
+
+        EXPECT_EQ(Color3f(0.5f), shader_group->get_fallback_albedo());
+    }
+
+    TEST_CASE(GetFallbackAlbedo_ColorParameter_ReturnsItsValue)
+    {
+        auto_release_ptr<ShaderGroup> shader_group(ShaderGroupFactory::create("shader_group"));
+        shader_group->add_shader(
+            "surface",
+            "as_plastic",
+            "layer",
+            ParamArray()
+                .insert("in_specular_color", "color 0.25 0.5 0.75"));
+
+        EXPECT_EQ(Color3f(0.25f, 0.5f, 0.75f), shader_group->get_fallback_albedo());
+    }
+
+    TEST_CASE(GetFallbackAlbedo_PrefersBaseColorOverOtherColors)
+    {
+        auto_release_ptr<ShaderGroup> shader_group(ShaderGroupFactory::create("shader_group"));
+        shader_group->add_shader(
+            "surface",
+            "as_standard_surface",
+            "layer",
+            ParamArray()
+                .insert("in_diffuse_color", "color 0 1 0")
+                .insert("in_base_color", "color 0.25 0.5 0.75")
+                .insert("in_specular_color", "color 1 0 0"));
+
+        EXPECT_EQ(Color3f(0.25f, 0.5f, 0.75f), shader_group->get_fallback_albedo());
+    }
+
+    TEST_CASE(GetFallbackAlbedo_SaturatesValues)
+    {
+        auto_release_ptr<ShaderGroup> shader_group(ShaderGroupFactory::create("shader_group"));
+        shader_group->add_shader(
+            "surface",
+            "as_lambert",
+            "layer",
+            ParamArray()
+                .insert("in_color", "color 2 -1 0.5"));
+
+        EXPECT_EQ(Color3f(1.0f, 0.0f, 0.5f), shader_group->get_fallback_albedo());
+    }
+
+    TEST_CASE(GetFallbackAlbedo_PrefersLastShader)
+    {
+        auto_release_ptr<ShaderGroup> shader_group(ShaderGroupFactory::create("shader_group"));
+        shader_group->add_shader(
+            "shader",
+            "as_color_texture",
+            "texture",
+            ParamArray()
+                .insert("in_base_color", "color 1 0 0"));
+        shader_group->add_shader(
+            "surface",
+            "as_disney_material",
+            "material",
+            ParamArray()
+                .insert("in_base_color", "color 0 0 1"));
+
+        EXPECT_EQ(Color3f(0.0f, 0.0f, 1.0f), shader_group->get_fallback_albedo());
+    }
+
+    TEST_CASE(IsOptimized_GivenNewShaderGroup_ReturnsFalse)
+    {
+        auto_release_ptr<ShaderGroup> shader_group(ShaderGroupFactory::create("shader_group"));
+
+        EXPECT_FALSE(shader_group->is_optimized());
+    }
+
+    TEST_CASE(RecordUse_KeepsFirstUse)
+    {
+        auto_release_ptr<ShaderGroup> shader_group1(ShaderGroupFactory::create("shader_group1"));
+        auto_release_ptr<ShaderGroup> shader_group2(ShaderGroupFactory::create("shader_group2"));
+
+        EXPECT_EQ(~uint64(0), shader_group1->get_first_use());
+
+        shader_group2->record_use();
+        shader_group1->record_use();
+        shader_group2->record_use();
+
+        EXPECT_LT(shader_group1->get_first_use(), shader_group2->get_first_use());
+    }
+}
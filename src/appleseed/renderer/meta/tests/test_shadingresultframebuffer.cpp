@@ -0,0 +1,226 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/aov/tilestack.h"
+#include "renderer/kernel/rendering/shadingresultframebuffer.h"
+#include "renderer/kernel/shading/shadingresult.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_ShadingResultFrameBuffer)
+{
+    const size_t Width = 5;
+    const size_t Height = 3;
+    const size_t AOVCount = 2;
+
+    struct DevelopedFrameBuffer
+    {
+        Tile                m_main;
+        unique_ptr<Tile>    m_aovs[AOVCount];
+        TileStack           m_aov_tiles;
+
+        DevelopedFrameBuffer()
+          : m_main(Width, Height, 4, PixelFormatFloat)
+        {
+            m_main.clear(Color4f(-1.0f));
+
+            for (size_t i = 0; i < AOVCount; ++i)
+            {
+                m_aovs[i].reset(new Tile(Width, Height, 4, PixelFormatFloat));
+                m_aovs[i]->clear(Color4f(-1.0f));
+                m_aov_tiles.append(m_aovs[i].get());
+            }
+        }
+
+        bool is_equal(const DevelopedFrameBuffer& rhs) const
+        {
+            for (size_t y = 0; y < Height; ++y)
+            {
+                for (size_t x = 0; x < Width; ++x)
+                {
+                    Color4f lhs_color, rhs_color;
+
+                    m_main.get_pixel(x, y, lhs_color);
+                    rhs.m_main.get_pixel(x, y, rhs_color);
+                    if (!feq(lhs_color, rhs_color))
+                        return false;
+
+                    for (size_t i = 0; i < AOVCount; ++i)
+                    {
+                        m_aovs[i]->get_pixel(x, y, lhs_color);
+                        rhs.m_aovs[i]->get_pixel(x, y, rhs_color);
+                        if (!feq(lhs_color, rhs_color))
+                            return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+    };
+
+    void fill(ShadingResultFrameBuffer& framebuffer)
+    {
+        framebuffer.clear();
+
+        ShadingResult result(AOVCount);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                // Leave the last pixel empty.
+                if (x == Width - 1 && y == Height - 1)
+                    continue;
+
+                for (size_t s = 0; s < 1 + (x + y) % 3; ++s)
+                {
+                    const float v = static_cast<float>(x + 10 * y + s);
+                    result.m_main = Color4f(v, v + 0.25f, v + 0.5f, 1.0f);
+                    result.m_aovs[0] = Color4f(2.0f * v, 0.0f, 1.0f, 1.0f);
+                    result.m_aovs[1] = Color4f(0.5f, v, 0.0f, 0.5f);
+                    framebuffer.add(Vector2u(x, y), result);
+                }
+            }
+        }
+    }
+
+    TEST_CASE(DevelopToTile_PlanarLayout_MatchesInterleavedLayout)
+    {
+        ShadingResultFrameBuffer interleaved(Width, Height, AOVCount, ShadingResultFrameBuffer::InterleavedLayout);
+        ShadingResultFrameBuffer planar(Width, Height, AOVCount, ShadingResultFrameBuffer::PlanarLayout);
+        fill(interleaved);
+        fill(planar);
+
+        DevelopedFrameBuffer expected, result;
+        interleaved.develop_to_tile(expected.m_main, expected.m_aov_tiles);
+        planar.develop_to_tile(result.m_main, result.m_aov_tiles);
+
+        EXPECT_TRUE(result.is_equal(expected));
+    }
+
+    TEST_CASE(DevelopToTile_GivenRegion_PlanarLayout_MatchesInterleavedLayout)
+    {
+        ShadingResultFrameBuffer interleaved(Width, Height, AOVCount, ShadingResultFrameBuffer::InterleavedLayout);
+        ShadingResultFrameBuffer planar(Width, Height, AOVCount, ShadingResultFrameBuffer::PlanarLayout);
+        fill(interleaved);
+        fill(planar);
+
+        const AABB2u region(Vector2u(1, 1), Vector2u(3, 2));
+
+        DevelopedFrameBuffer expected, result;
+        interleaved.develop_to_tile(expected.m_main, expected.m_aov_tiles, region);
+        planar.develop_to_tile(result.m_main, result.m_aov_tiles, region);
+
+        EXPECT_TRUE(result.is_equal(expected));
+    }
+
+    TEST_CASE(Merge_PlanarLayout_MatchesInterleavedLayout)
+    {
+        ShadingResultFrameBuffer interleaved(Width, Height, AOVCount, ShadingResultFrameBuffer::InterleavedLayout);
+        ShadingResultFrameBuffer planar(Width, Height, AOVCount, ShadingResultFrameBuffer::PlanarLayout);
+        fill(interleaved);
+        fill(planar);
+
+        ShadingResultFrameBuffer interleaved_source(Width, Height, AOVCount, ShadingResultFrameBuffer::InterleavedLayout);
+        ShadingResultFrameBuffer planar_source(Width, Height, AOVCount, ShadingResultFrameBuffer::PlanarLayout);
+        fill(interleaved_source);
+        fill(planar_source);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                interleaved.merge(x, y, interleaved_source, Width - 1 - x, y, 0.5f);
+                planar.merge(x, y, planar_source, Width - 1 - x, y, 0.5f);
+            }
+        }
+
+        DevelopedFrameBuffer expected, result;
+        interleaved.develop_to_tile(expected.m_main, expected.m_aov_tiles);
+        planar.develop_to_tile(result.m_main, result.m_aov_tiles);
+
+        EXPECT_TRUE(result.is_equal(expected));
+    }
+
+    TEST_CASE(GetMainColor_PlanarLayout_MatchesInterleavedLayout)
+    {
+        ShadingResultFrameBuffer interleaved(Width, Height, AOVCount, ShadingResultFrameBuffer::InterleavedLayout);
+        ShadingResultFrameBuffer planar(Width, Height, AOVCount, ShadingResultFrameBuffer::PlanarLayout);
+        fill(interleaved);
+        fill(planar);
+
+        for (size_t y = 0; y < Height; ++y)
+        {
+            for (size_t x = 0; x < Width; ++x)
+            {
+                Color4f expected, result;
+                interleaved.get_main_color(x, y, expected);
+                planar.get_main_color(x, y, result);
+
+                EXPECT_FEQ(expected, result);
+            }
+        }
+    }
+
+    TEST_CASE(Add_GivenSampleOutsideCropWindow_PlanarLayout_IgnoresSample)
+    {
+        ShadingResultFrameBuffer planar(
+            Width,
+            Height,
+            AOVCount,
+            AABB2u(Vector2u(0, 0), Vector2u(1, 1)),
+            ShadingResultFrameBuffer::PlanarLayout);
+        planar.clear();
+
+        ShadingResult result(AOVCount);
+        result.m_main = Color4f(1.0f);
+        planar.add(Vector2u(2, 2), result);
+
+        Color4f color;
+        planar.get_main_color(2, 2, color);
+
+        EXPECT_EQ(Color4f(0.0f), color);
+    }
+}
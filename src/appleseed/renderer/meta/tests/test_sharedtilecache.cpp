@@ -0,0 +1,155 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/texturing/sharedtilecache.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Texturing_SharedTileCache)
+{
+    const char* CacheName = "appleseed_test_shared_tile_cache";
+
+    // Any existing file is suitable: only its size and last write time are used.
+    const char* TextureFilePath = "unit tests/inputs/test_projectfilereader_configurationblocks.appleseed";
+
+    SharedTileCache::TileKey make_key(const size_t tile_x)
+    {
+        SharedTileCache::TileKey key;
+        key.m_filepath = TextureFilePath;
+        key.m_tile_xy = static_cast<uint32>(tile_x);
+        key.m_mip_level = 0;
+        key.m_variant = 0;
+        return key;
+    }
+
+    struct Fixture
+    {
+        Fixture()
+        {
+            SharedTileCache::remove(CacheName);
+        }
+
+        ~Fixture()
+        {
+            SharedTileCache::remove(CacheName);
+        }
+    };
+
+    TEST_CASE_F(Acquire_GivenTileNotInserted_ReturnsNull, Fixture)
+    {
+        SharedTileCache cache(CacheName, 1024 * 1024);
+        ASSERT_TRUE(cache.is_open());
+
+        SharedTileCache::EntryID entry_id;
+        const Tile* tile = cache.acquire(make_key(0), entry_id);
+
+        EXPECT_EQ(nullptr, tile);
+        EXPECT_EQ(SharedTileCache::InvalidEntryID, entry_id);
+    }
+
+    TEST_CASE_F(Acquire_GivenTileInsertedThroughAnotherInstance_ReturnsTileWithSamePixels, Fixture)
+    {
+        SharedTileCache cache1(CacheName, 1024 * 1024);
+        SharedTileCache cache2(CacheName, 1024 * 1024);
+        ASSERT_TRUE(cache1.is_open());
+        ASSERT_TRUE(cache2.is_open());
+
+        Tile source(4, 4, 3, PixelFormatFloat);
+        source.clear(Color3f(0.5f));
+
+        SharedTileCache::EntryID entry_id1;
+        Tile* inserted = cache1.insert(make_key(0), source, entry_id1);
+        ASSERT_NEQ(nullptr, inserted);
+
+        SharedTileCache::EntryID entry_id2;
+        Tile* acquired = cache2.acquire(make_key(0), entry_id2);
+        ASSERT_NEQ(nullptr, acquired);
+
+        EXPECT_EQ(entry_id1, entry_id2);
+        EXPECT_EQ(4, acquired->get_width());
+        EXPECT_EQ(3, acquired->get_channel_count());
+        EXPECT_EQ(PixelFormatFloat, acquired->get_pixel_format());
+
+        Color3f color;
+        acquired->get_pixel(3, 3, color);
+        EXPECT_EQ(Color3f(0.5f), color);
+
+        cache2.release(entry_id2, acquired);
+        cache1.release(entry_id1, inserted);
+    }
+
+    TEST_CASE_F(Insert_GivenFullCache_EvictsUnreferencedTilesOnly, Fixture)
+    {
+        SharedTileCache cache(CacheName, 256 * 1024);
+        ASSERT_TRUE(cache.is_open());
+
+        Tile source(32, 32, 4, PixelFormatFloat);
+        source.clear(Color4f(1.0f));
+
+        // Keep a reference to tile 0, release tile 1.
+        SharedTileCache::EntryID referenced_id;
+        Tile* referenced = cache.insert(make_key(0), source, referenced_id);
+        ASSERT_NEQ(nullptr, referenced);
+
+        SharedTileCache::EntryID released_id;
+        cache.release(released_id, cache.insert(make_key(1), source, released_id));
+
+        // Insert more tiles than the cache can hold.
+        for (size_t i = 2; i < 34; ++i)
+        {
+            SharedTileCache::EntryID entry_id;
+            Tile* tile = cache.insert(make_key(i), source, entry_id);
+            ASSERT_NEQ(nullptr, tile);
+            cache.release(entry_id, tile);
+        }
+
+        SharedTileCache::EntryID entry_id;
+        Tile* tile0 = cache.acquire(make_key(0), entry_id);
+        Tile* tile1 = cache.acquire(make_key(1), entry_id);
+
+        EXPECT_NEQ(nullptr, tile0);
+        EXPECT_EQ(nullptr, tile1);
+
+        if (tile0)
+            cache.release(referenced_id, tile0);
+        cache.release(referenced_id, referenced);
+    }
+}
@@ -0,0 +1,117 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/spatiallightcache.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SpatialLightCache)
+{
+    struct Fixture
+    {
+        vector<Vector3d>    m_positions;
+        vector<float>       m_importances;
+
+        Fixture()
+        {
+            // A row of identical lights along the x axis.
+            for (size_t i = 0; i < 10; ++i)
+            {
+                m_positions.emplace_back(static_cast<double>(i) * 10.0, 0.0, 0.0);
+                m_importances.push_back(1.0f);
+            }
+        }
+    };
+
+    TEST_CASE_F(EvaluatePdf_SumsToOneOverAllLights, Fixture)
+    {
+        const SpatialLightCache cache(AABB3d(Vector3d(0.0), Vector3d(90.0)), m_positions, m_importances, 8, 3);
+
+        const Vector3d point(42.0, 1.0, 0.0);
+
+        float sum = 0.0f;
+        for (size_t i = 0; i < cache.get_light_count(); ++i)
+        {
+            const float pdf = cache.evaluate_pdf(point, i);
+            EXPECT_GT(0.0f, pdf);
+            sum += pdf;
+        }
+
+        EXPECT_FEQ(1.0f, sum);
+    }
+
+    TEST_CASE_F(Sample_FavorsLightsCloseToPoint, Fixture)
+    {
+        const SpatialLightCache cache(AABB3d(Vector3d(0.0), Vector3d(90.0)), m_positions, m_importances, 8, 3);
+
+        const Vector3d point(1.0, 1.0, 0.0);
+
+        EXPECT_LT(cache.evaluate_pdf(point, 0), cache.evaluate_pdf(point, 9));
+    }
+
+    TEST_CASE_F(Sample_ReturnsProbabilityMatchingEvaluatePdf, Fixture)
+    {
+        const SpatialLightCache cache(AABB3d(Vector3d(0.0), Vector3d(90.0)), m_positions, m_importances, 8, 3);
+
+        const Vector3d point(63.0, -2.0, 5.0);
+
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const float s = static_cast<float>(i) / 100.0f;
+
+            float probability;
+            const size_t light_index = cache.sample(point, s, probability);
+
+            ASSERT_LT(cache.get_light_count(), light_index);
+            EXPECT_FEQ(cache.evaluate_pdf(point, light_index), probability);
+        }
+    }
+
+    TEST_CASE_F(Sample_GivenFewerLightsThanVoxelCapacity_OnlyUsesVoxelDistribution, Fixture)
+    {
+        const SpatialLightCache cache(AABB3d(Vector3d(0.0), Vector3d(90.0)), m_positions, m_importances, 8, 16);
+
+        float sum = 0.0f;
+        for (size_t i = 0; i < cache.get_light_count(); ++i)
+            sum += cache.evaluate_pdf(Vector3d(-100.0), i);
+
+        EXPECT_FEQ(1.0f, sum);
+    }
+}
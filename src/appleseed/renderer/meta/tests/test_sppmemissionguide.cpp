@@ -0,0 +1,166 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmemissionguide.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SPPM_SPPMEmissionGuide)
+{
+    const size_t LightBinCount = 4;
+    const size_t DirectionBinCount = 4;
+
+    size_t compute_bin(const float light_s, const Vector2f& direction_s)
+    {
+        const size_t light_bin = static_cast<size_t>(light_s * LightBinCount);
+        const size_t u_bin = static_cast<size_t>(direction_s[0] * DirectionBinCount);
+        const size_t v_bin = static_cast<size_t>(direction_s[1] * DirectionBinCount);
+        return (light_bin * DirectionBinCount + u_bin) * DirectionBinCount + v_bin;
+    }
+
+    void train_on_single_bin(SPPMEmissionGuide& guide, const size_t useful_bin)
+    {
+        SPPMEmissionGuide::Statistics statistics(guide.get_bin_count());
+
+        for (size_t i = 0; i < guide.get_bin_count(); ++i)
+        {
+            for (size_t j = 0; j < 100; ++j)
+                statistics.insert(i, i == useful_bin);
+        }
+
+        guide.update(statistics);
+    }
+
+    TEST_CASE(Sample_GivenUntrainedGuide_LeavesSamplesUnchanged)
+    {
+        const SPPMEmissionGuide guide(LightBinCount, DirectionBinCount, 0.5f);
+
+        float light_s = 0.3f;
+        size_t light_bin;
+        const float light_density = guide.sample_light(light_s, light_bin);
+
+        Vector2f direction_s(0.6f, 0.1f);
+        size_t bin;
+        const float direction_density = guide.sample_direction(light_bin, direction_s, bin);
+
+        EXPECT_FEQ(1.0f, light_density);
+        EXPECT_FEQ(1.0f, direction_density);
+        EXPECT_FEQ(0.3f, light_s);
+        EXPECT_FEQ(Vector2f(0.6f, 0.1f), direction_s);
+        EXPECT_EQ(1, light_bin);
+        EXPECT_EQ(compute_bin(0.3f, Vector2f(0.6f, 0.1f)), bin);
+    }
+
+    TEST_CASE(Sample_GivenTrainedGuide_ReturnsBinContainingWarpedSample)
+    {
+        SPPMEmissionGuide guide(LightBinCount, DirectionBinCount, 0.5f);
+        train_on_single_bin(guide, 37);
+
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            float light_s = rand_float2(rng);
+            size_t light_bin;
+            guide.sample_light(light_s, light_bin);
+
+            Vector2f direction_s = rand_vector2<Vector2f>(rng);
+            size_t bin;
+            guide.sample_direction(light_bin, direction_s, bin);
+
+            ASSERT_EQ(compute_bin(light_s, direction_s), bin);
+        }
+    }
+
+    TEST_CASE(Sample_GivenTrainedGuide_FavorsUsefulBin)
+    {
+        SPPMEmissionGuide guide(LightBinCount, DirectionBinCount, 0.5f);
+        train_on_single_bin(guide, 37);
+
+        MersenneTwister rng;
+
+        const size_t SampleCount = 10000;
+        size_t useful_bin_sample_count = 0;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            float light_s = rand_float2(rng);
+            size_t light_bin;
+            guide.sample_light(light_s, light_bin);
+
+            Vector2f direction_s = rand_vector2<Vector2f>(rng);
+            size_t bin;
+            guide.sample_direction(light_bin, direction_s, bin);
+
+            if (bin == 37)
+                ++useful_bin_sample_count;
+        }
+
+        // Without guiding, 1/64th of the samples would land in the useful bin.
+        EXPECT_LT(useful_bin_sample_count, 10 * SampleCount / guide.get_bin_count());
+    }
+
+    TEST_CASE(Sample_GivenTrainedGuide_ReturnsConsistentDensities)
+    {
+        SPPMEmissionGuide guide(LightBinCount, DirectionBinCount, 0.5f);
+        train_on_single_bin(guide, 37);
+
+        MersenneTwister rng;
+
+        // The reciprocal of the density of a warp has an expected value of 1.
+        const size_t SampleCount = 100000;
+        double rcp_density_sum = 0.0;
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            float light_s = rand_float2(rng);
+            size_t light_bin;
+            const float light_density = guide.sample_light(light_s, light_bin);
+
+            Vector2f direction_s = rand_vector2<Vector2f>(rng);
+            size_t bin;
+            const float direction_density = guide.sample_direction(light_bin, direction_s, bin);
+
+            rcp_density_sum += 1.0 / (light_density * direction_density);
+        }
+
+        EXPECT_FEQ_EPS(1.0, rcp_density_sum / SampleCount, 0.02);
+    }
+}
@@ -0,0 +1,142 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmparameters.h"
+#include "renderer/kernel/lighting/sppm/sppmphoton.h"
+#include "renderer/kernel/lighting/sppm/sppmphotonmap.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/knn.h"
+#include "foundation/math/rng/distribution.h"
+#include "foundation/math/rng/mersennetwister.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SPPM_SPPMPhotonMap)
+{
+    void make_random_photons(
+        const size_t            photon_count,
+        SPPMPhotonVector&       photons)
+    {
+        MersenneTwister rng;
+
+        for (size_t i = 0; i < photon_count; ++i)
+            photons.push_back(rand_vector1<Vector3f>(rng), SPPMPolyPhoton());
+    }
+
+    vector<size_t> find_photons(
+        const SPPMPhotonMap&    photon_map,
+        const Vector3f&         point,
+        const float             radius,
+        knn::Answer<float>&     answer)
+    {
+        photon_map.query(point, radius * radius, answer);
+
+        vector<size_t> photons;
+        for (size_t i = 0; i < answer.size(); ++i)
+            photons.push_back(photon_map.remap(answer.get(i).m_index));
+
+        sort(photons.begin(), photons.end());
+
+        return photons;
+    }
+
+    bool do_hash_grid_and_kd_tree_agree(
+        const float             cell_size,
+        const float             query_radius,
+        const size_t            answer_size)
+    {
+        const size_t PhotonCount = 20000;
+        const size_t QueryCount = 200;
+
+        SPPMPhotonVector kd_tree_photons;
+        make_random_photons(PhotonCount, kd_tree_photons);
+        SPPMPhotonVector hash_grid_photons;
+        make_random_photons(PhotonCount, hash_grid_photons);
+
+        const SPPMPhotonMap kd_tree(kd_tree_photons, SPPMParameters::KdTree, cell_size);
+        const SPPMPhotonMap hash_grid(hash_grid_photons, SPPMParameters::HashGrid, cell_size);
+
+        knn::Answer<float> answer(answer_size);
+        MersenneTwister rng(42);
+
+        for (size_t i = 0; i < QueryCount; ++i)
+        {
+            const Vector3f q = rand_vector1<Vector3f>(rng);
+
+            if (find_photons(kd_tree, q, query_radius, answer) !=
+                find_photons(hash_grid, q, query_radius, answer))
+                return false;
+        }
+
+        return true;
+    }
+
+    TEST_CASE(Query_GivenRadiusEqualToCellSize_ReturnsSamePhotonsAsKdTree)
+    {
+        EXPECT_TRUE(do_hash_grid_and_kd_tree_agree(0.05f, 0.05f, 1000));
+    }
+
+    TEST_CASE(Query_GivenRadiusLargerThanCellSize_ReturnsSamePhotonsAsKdTree)
+    {
+        EXPECT_TRUE(do_hash_grid_and_kd_tree_agree(0.02f, 0.05f, 1000));
+    }
+
+    TEST_CASE(Query_GivenFullAnswer_ReturnsSameClosestPhotonsAsKdTree)
+    {
+        EXPECT_TRUE(do_hash_grid_and_kd_tree_agree(0.05f, 0.05f, 10));
+    }
+
+    TEST_CASE(Query_GivenRadiusSpanningTheWholeMap_ReturnsSamePhotonsAsKdTree)
+    {
+        EXPECT_TRUE(do_hash_grid_and_kd_tree_agree(1.0e-4f, 0.2f, 100));
+    }
+
+    TEST_CASE(Empty_GivenNoPhoton_ReturnsTrue)
+    {
+        SPPMPhotonVector photons;
+        const SPPMPhotonMap photon_map(photons, SPPMParameters::HashGrid, 0.1f);
+
+        EXPECT_TRUE(photon_map.empty());
+
+        knn::Answer<float> answer(10);
+        photon_map.query(Vector3f(0.0f), 1.0f, answer);
+
+        EXPECT_TRUE(answer.empty());
+    }
+}
@@ -0,0 +1,73 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/lighting/sppm/sppmvisibilitygrid.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Lighting_SPPM_SPPMVisibilityGrid)
+{
+    TEST_CASE(Contains_GivenPointInMarkedCell_ReturnsTrue)
+    {
+        SPPMVisibilityGrid grid;
+        grid.clear(0.1f);
+
+        grid.insert(Vector3f(0.51f, -0.22f, 3.07f));
+
+        EXPECT_FALSE(grid.empty());
+        EXPECT_TRUE(grid.contains(Vector3f(0.59f, -0.21f, 3.01f)));
+    }
+
+    TEST_CASE(Contains_GivenPointInNeighborCell_ReturnsFalse)
+    {
+        SPPMVisibilityGrid grid;
+        grid.clear(0.1f);
+
+        grid.insert(Vector3f(0.51f, -0.22f, 3.07f));
+
+        EXPECT_FALSE(grid.contains(Vector3f(0.61f, -0.22f, 3.07f)));
+    }
+
+    TEST_CASE(Clear_GivenMarkedCell_ForgetsIt)
+    {
+        SPPMVisibilityGrid grid;
+        grid.clear(0.1f);
+        grid.insert(Vector3f(0.51f, -0.22f, 3.07f));
+
+        grid.clear(0.1f);
+
+        EXPECT_TRUE(grid.empty());
+        EXPECT_FALSE(grid.contains(Vector3f(0.51f, -0.22f, 3.07f)));
+    }
+}
@@ -0,0 +1,172 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/tessellation/statictessellation.h"
+#include "renderer/modeling/object/triangle.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Tessellation_StaticTessellation)
+{
+    TEST_CASE(CompactTriangle_GivenTriangleWithAbsentFeatures_PreservesAllIndices)
+    {
+        const Triangle triangle(1, 2, 3, 4, 5, 6, Triangle::None, Triangle::None, Triangle::None, 7);
+
+        ASSERT_TRUE(CompactTriangle::is_representable(triangle));
+
+        const Triangle expanded = CompactTriangle(triangle).expand();
+
+        EXPECT_EQ(1, expanded.m_v0);
+        EXPECT_EQ(3, expanded.m_v2);
+        EXPECT_EQ(6, expanded.m_n2);
+        EXPECT_TRUE(expanded.m_a0 == Triangle::None);
+        EXPECT_TRUE(expanded.m_a2 == Triangle::None);
+        EXPECT_EQ(7, expanded.m_pa);
+    }
+
+    TEST_CASE(CompactTriangle_GivenIndexAbove16Bits_IsNotRepresentable)
+    {
+        EXPECT_FALSE(CompactTriangle::is_representable(Triangle(0, 1, 65535)));
+        EXPECT_FALSE(CompactTriangle::is_representable(Triangle(0, 1, 100000)));
+        EXPECT_TRUE(CompactTriangle::is_representable(Triangle(0, 1, 65534)));
+    }
+
+    TEST_CASE(Compact_GivenSmallMesh_StoresCompactPrimitivesAndQuantizedTexCoords)
+    {
+        StaticTriangleTess tess;
+
+        tess.push_tex_coords(GVector2(0.0f, 0.0f));
+        tess.push_tex_coords(GVector2(1.0f, 0.25f));
+        tess.push_tex_coords(GVector2(0.3f, 1.0f));
+        tess.m_primitives.push_back(Triangle(0, 1, 2, 0, 1, 2, 0, 1, 2, 0));
+        tess.m_primitives.push_back(Triangle(2, 1, 0, 2));
+
+        tess.compact();
+
+        ASSERT_TRUE(tess.has_compact_primitives());
+        ASSERT_TRUE(tess.has_quantized_tex_coords());
+        EXPECT_TRUE(tess.m_primitives.empty());
+
+        ASSERT_EQ(2, tess.get_primitive_count());
+        EXPECT_EQ(2, tess.get_primitive(0).m_a2);
+        EXPECT_TRUE(tess.get_primitive(1).m_n0 == Triangle::None);
+        EXPECT_EQ(2, tess.get_primitive(1).m_pa);
+
+        ASSERT_EQ(3, tess.get_tex_coords_count());
+        EXPECT_FEQ_EPS(GVector2(0.0f, 0.0f), tess.get_tex_coords(0), 1.0e-4f);
+        EXPECT_FEQ_EPS(GVector2(1.0f, 0.25f), tess.get_tex_coords(1), 1.0e-4f);
+        EXPECT_FEQ_EPS(GVector2(0.3f, 1.0f), tess.get_tex_coords(2), 1.0e-4f);
+    }
+
+    TEST_CASE(Compact_GivenTexCoordsWithLargeExtent_KeepsFullPrecisionTexCoords)
+    {
+        StaticTriangleTess tess;
+
+        tess.push_tex_coords(GVector2(0.0f, 0.0f));
+        tess.push_tex_coords(GVector2(100.0f, 0.0f));
+
+        tess.compact();
+
+        EXPECT_FALSE(tess.has_quantized_tex_coords());
+        EXPECT_EQ(GVector2(100.0f, 0.0f), tess.get_tex_coords(1));
+    }
+
+    TEST_CASE(Expand_GivenCompactedTessellation_RestoresPrimitivesAndTexCoords)
+    {
+        StaticTriangleTess tess;
+
+        tess.push_tex_coords(GVector2(0.5f, 0.5f));
+        tess.push_tex_coords(GVector2(0.75f, 0.5f));
+        tess.m_primitives.push_back(Triangle(0, 1, 2, 0, 1, 1, 0, 1, 0, 0));
+
+        tess.compact();
+        tess.expand();
+
+        EXPECT_FALSE(tess.has_compact_primitives());
+        EXPECT_FALSE(tess.has_quantized_tex_coords());
+        ASSERT_EQ(1, tess.m_primitives.size());
+        EXPECT_EQ(1, tess.m_primitives[0].m_a1);
+        ASSERT_EQ(2, tess.get_tex_coords_count());
+        EXPECT_FEQ_EPS(GVector2(0.75f, 0.5f), tess.get_tex_coords(1), 1.0e-4f);
+    }
+
+    TEST_CASE(PushTexCoords_GivenQuantizedTexCoords_ExpandsThemFirst)
+    {
+        StaticTriangleTess tess;
+
+        tess.push_tex_coords(GVector2(0.0f, 0.0f));
+        tess.push_tex_coords(GVector2(1.0f, 1.0f));
+        tess.compact();
+
+        tess.push_tex_coords(GVector2(20.0f, 0.0f));
+
+        EXPECT_FALSE(tess.has_quantized_tex_coords());
+        ASSERT_EQ(3, tess.get_tex_coords_count());
+        EXPECT_FEQ_EPS(GVector2(1.0f, 1.0f), tess.get_tex_coords(1), 1.0e-4f);
+        EXPECT_EQ(GVector2(20.0f, 0.0f), tess.get_tex_coords(2));
+    }
+
+    TEST_CASE(CopyFrom_GivenCompactedTessellation_CopiesAllFeatures)
+    {
+        StaticTriangleTess tess;
+
+        tess.m_vertices.push_back(GVector3(1.0f, 2.0f, 3.0f));
+        tess.push_vertex_normal(GVector3(0.0f, 1.0f, 0.0f));
+        tess.push_tex_coords(GVector2(0.5f, 0.5f));
+        tess.push_tex_coords(GVector2(0.75f, 0.5f));
+        tess.m_primitives.push_back(Triangle(0, 1, 2, 0, 1, 1, 0, 1, 0, 0));
+        tess.compact();
+
+        StaticTriangleTess copy;
+        copy.copy_from(tess);
+        tess.expand();
+        tess.m_vertices.clear();
+
+        EXPECT_TRUE(copy.has_compact_primitives());
+        EXPECT_TRUE(copy.has_quantized_tex_coords());
+        ASSERT_EQ(1, copy.m_vertices.size());
+        EXPECT_EQ(GVector3(1.0f, 2.0f, 3.0f), copy.m_vertices[0]);
+        ASSERT_EQ(1, copy.get_vertex_normal_count());
+        EXPECT_FEQ_EPS(GVector3(0.0f, 1.0f, 0.0f), copy.get_vertex_normal(0), 1.0e-4f);
+        ASSERT_EQ(1, copy.get_primitive_count());
+        EXPECT_EQ(1, copy.get_primitive(0).m_a1);
+        ASSERT_EQ(2, copy.get_tex_coords_count());
+        EXPECT_FEQ_EPS(GVector2(0.75f, 0.5f), copy.get_tex_coords(1), 1.0e-4f);
+    }
+}
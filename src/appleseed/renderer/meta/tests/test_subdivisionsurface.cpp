@@ -0,0 +1,170 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/tessellation/statictessellation.h"
+#include "renderer/kernel/tessellation/subdivisionsurface.h"
+#include "renderer/modeling/object/triangle.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Tessellation_SubdivisionSurface)
+{
+    // A unit square made of two triangles, with texture coordinates matching positions.
+    struct SquareFixture
+    {
+        StaticTriangleTess m_square;
+
+        SquareFixture()
+        {
+            m_square.m_vertices.emplace_back(0.0, 0.0, 0.0);
+            m_square.m_vertices.emplace_back(1.0, 0.0, 0.0);
+            m_square.m_vertices.emplace_back(1.0, 1.0, 0.0);
+            m_square.m_vertices.emplace_back(0.0, 1.0, 0.0);
+
+            m_square.push_tex_coords(GVector2(0.0, 0.0));
+            m_square.push_tex_coords(GVector2(1.0, 0.0));
+            m_square.push_tex_coords(GVector2(1.0, 1.0));
+            m_square.push_tex_coords(GVector2(0.0, 1.0));
+
+            m_square.m_primitives.push_back(Triangle(0, 1, 2, Triangle::None, Triangle::None, Triangle::None, 0, 1, 2, 0));
+            m_square.m_primitives.push_back(Triangle(0, 2, 3, Triangle::None, Triangle::None, Triangle::None, 0, 2, 3, 1));
+        }
+    };
+
+    TEST_CASE_F(SubdivideCatmullClark_GivenZeroSteps_PreservesTriangles, SquareFixture)
+    {
+        StaticTriangleTess result;
+        subdivide_catmull_clark(m_square, 0, result);
+
+        ASSERT_EQ(4, result.m_vertices.size());
+        ASSERT_EQ(2, result.m_primitives.size());
+        EXPECT_EQ(m_square.m_vertices[2], result.m_vertices[result.m_primitives[0].m_v2]);
+        EXPECT_EQ(1, result.m_primitives[1].m_pa);
+    }
+
+    TEST_CASE_F(SubdivideCatmullClark_GivenOneStep_SplitsEachTriangleIntoThreeQuads, SquareFixture)
+    {
+        StaticTriangleTess result;
+        subdivide_catmull_clark(m_square, 1, result);
+
+        // 4 vertex points, 5 edge points and 2 face points.
+        EXPECT_EQ(11, result.m_vertices.size());
+
+        // 6 quads, each split into two triangles.
+        EXPECT_EQ(12, result.m_primitives.size());
+    }
+
+    TEST_CASE_F(SubdivideCatmullClark_GivenBoundaryCorner_AppliesBoundaryRule, SquareFixture)
+    {
+        StaticTriangleTess result;
+        subdivide_catmull_clark(m_square, 1, result);
+
+        // 3/4 of the vertex plus 1/8 of each of its two boundary neighbors.
+        EXPECT_FEQ(GVector3(0.125, 0.125, 0.0), result.m_vertices[0]);
+    }
+
+    TEST_CASE_F(SubdivideCatmullClark_GivenTexCoords_InterpolatesThemLinearly, SquareFixture)
+    {
+        StaticTriangleTess result;
+        subdivide_catmull_clark(m_square, 2, result);
+
+        // One set of texture coordinates per quad corner.
+        ASSERT_EQ(result.m_primitives.size() * 2, result.get_tex_coords_count());
+
+        // The square is flat and its texture coordinates match positions on the control mesh.
+        // Positions move under subdivision but texture coordinates stay within the square.
+        for (size_t i = 0; i < result.get_tex_coords_count(); ++i)
+        {
+            const GVector2 uv = result.get_tex_coords(i);
+            EXPECT_TRUE(uv[0] >= 0.0 && uv[0] <= 1.0);
+            EXPECT_TRUE(uv[1] >= 0.0 && uv[1] <= 1.0);
+        }
+
+        EXPECT_EQ(0, result.m_primitives[0].m_pa);
+        EXPECT_EQ(1, result.m_primitives.back().m_pa);
+    }
+
+    TEST_CASE(SubdivideCatmullClark_GivenClosedCube_StaysWithinControlHullAndComputesUnitNormals)
+    {
+        StaticTriangleTess cube;
+
+        for (size_t i = 0; i < 8; ++i)
+        {
+            cube.m_vertices.emplace_back(
+                (i & 1) ? 1.0 : -1.0,
+                (i & 2) ? 1.0 : -1.0,
+                (i & 4) ? 1.0 : -1.0);
+            cube.push_vertex_normal(normalize(cube.m_vertices.back()));
+        }
+
+        const size_t Quads[6][4] =
+        {
+            { 0, 2, 3, 1 }, { 4, 5, 7, 6 },
+            { 0, 1, 5, 4 }, { 2, 6, 7, 3 },
+            { 0, 4, 6, 2 }, { 1, 3, 7, 5 }
+        };
+
+        for (size_t i = 0; i < 6; ++i)
+        {
+            const size_t* q = Quads[i];
+            cube.m_primitives.push_back(Triangle(q[0], q[1], q[2], q[0], q[1], q[2], 0));
+            cube.m_primitives.push_back(Triangle(q[0], q[2], q[3], q[0], q[2], q[3], 0));
+        }
+
+        StaticTriangleTess result;
+        subdivide_catmull_clark(cube, 2, result);
+
+        const GAABB3 control_bbox(GVector3(-1.0), GVector3(1.0));
+
+        for (size_t i = 0; i < result.m_vertices.size(); ++i)
+            EXPECT_TRUE(control_bbox.contains(result.m_vertices[i]));
+
+        ASSERT_EQ(result.m_vertices.size(), result.get_vertex_normal_count());
+
+        for (size_t i = 0; i < result.get_vertex_normal_count(); ++i)
+        {
+            EXPECT_FEQ_EPS(GScalar(1.0), norm(result.get_vertex_normal(i)), GScalar(1.0e-5));
+
+            // Normals point outward.
+            EXPECT_GT(0.0, dot(result.get_vertex_normal(i), result.m_vertices[i]));
+        }
+    }
+}
@@ -0,0 +1,133 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/texturing/texturestore.h"
+#include "renderer/kernel/texturing/textureworkingsetanalyzer.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Texturing_TextureWorkingSetAnalyzer)
+{
+    typedef TextureStore::TileKey TileKey;
+
+    TEST_CASE(RecordAccess_GivenCyclicAccesses_ReportsHitRateOfStoreHoldingTheCycle)
+    {
+        TextureWorkingSetAnalyzer analyzer;
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+                analyzer.record_access(TileKey(0, 1, j, 0), 100);
+        }
+
+        EXPECT_EQ(30, analyzer.get_access_count());
+        EXPECT_EQ(3, analyzer.get_cold_miss_count());
+        EXPECT_EQ(3, analyzer.get_tile_count());
+        EXPECT_EQ(300, analyzer.get_memory_size());
+        EXPECT_EQ(0.0, analyzer.get_hit_rate(299));
+        EXPECT_FEQ(0.9, analyzer.get_hit_rate(320));
+    }
+
+    TEST_CASE(GetStoreSizeForHitRate_GivenReachableHitRate_ReturnsSizeCoveringReuseDistances)
+    {
+        TextureWorkingSetAnalyzer analyzer;
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+                analyzer.record_access(TileKey(0, 1, j, 0), 100);
+        }
+
+        const size_t store_size = analyzer.get_store_size_for_hit_rate(0.9);
+
+        EXPECT_GT(299, store_size);
+        EXPECT_LT(400, store_size);
+    }
+
+    TEST_CASE(GetStoreSizeForHitRate_GivenHitRateAboveColdMissLimit_ReturnsZero)
+    {
+        TextureWorkingSetAnalyzer analyzer;
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            for (size_t j = 0; j < 3; ++j)
+                analyzer.record_access(TileKey(0, 1, j, 0), 100);
+        }
+
+        EXPECT_EQ(0, analyzer.get_store_size_for_hit_rate(0.95));
+    }
+
+    TEST_CASE(RecordAccess_GivenMoreAccessesThanTimelineSize_KeepsReuseDistancesExact)
+    {
+        TextureWorkingSetAnalyzer analyzer;
+
+        for (size_t i = 0; i < 5000; ++i)
+        {
+            analyzer.record_access(TileKey(0, 1, 0, 0), 4);
+            analyzer.record_access(TileKey(0, 1, 1, 0), 3);
+        }
+
+        EXPECT_EQ(0.0, analyzer.get_hit_rate(6));
+        EXPECT_FEQ(9998.0 / 10000.0, analyzer.get_hit_rate(7));
+    }
+
+    TEST_CASE(GetTextureWorkingSets_SortsTexturesByDecreasingSize)
+    {
+        TextureWorkingSetAnalyzer analyzer;
+
+        analyzer.record_access(TileKey(0, 1, 0, 0), 100);
+        analyzer.record_access(TileKey(0, 2, 0, 0), 100);
+        analyzer.record_access(TileKey(0, 2, 1, 0), 100);
+        analyzer.record_access(TileKey(0, 2, 1, 0), 100);
+        analyzer.record_access(TileKey(0, 2, 1, 0), 100);
+
+        const TextureWorkingSetAnalyzer::TextureWorkingSetVector working_sets =
+            analyzer.get_texture_working_sets();
+
+        ASSERT_EQ(2, working_sets.size());
+
+        EXPECT_EQ(2, working_sets[0].m_texture_uid);
+        EXPECT_EQ(4, working_sets[0].m_access_count);
+        EXPECT_EQ(2, working_sets[0].m_tile_count);
+        EXPECT_EQ(200, working_sets[0].m_memory_size);
+        ASSERT_EQ(2, working_sets[0].m_tile_access_histogram.size());
+        EXPECT_EQ(1, working_sets[0].m_tile_access_histogram[0]);     // one tile accessed once
+        EXPECT_EQ(1, working_sets[0].m_tile_access_histogram[1]);     // one tile accessed 2 to 3 times
+
+        EXPECT_EQ(1, working_sets[1].m_texture_uid);
+        EXPECT_EQ(100, working_sets[1].m_memory_size);
+    }
+}
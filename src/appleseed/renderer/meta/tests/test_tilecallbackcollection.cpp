@@ -0,0 +1,220 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/itilecallback.h"
+#include "renderer/kernel/rendering/tilecallbackcollection.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/test.h"
+
+// Boost headers.
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_TileCallbackCollection)
+{
+    struct Log
+    {
+        boost::mutex                m_mutex;
+        boost::condition_variable   m_gate_opened;
+        bool                        m_gate_open;
+        vector<string>              m_events;
+        vector<boost::thread::id>   m_thread_ids;
+
+        Log()
+          : m_gate_open(true)
+        {
+        }
+
+        void record(const string& event)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            while (!m_gate_open)
+                m_gate_opened.wait(lock);
+
+            m_events.push_back(event);
+            m_thread_ids.push_back(boost::this_thread::get_id());
+        }
+
+        void open_gate()
+        {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_gate_open = true;
+            }
+
+            m_gate_opened.notify_all();
+        }
+    };
+
+    class LoggingTileCallback
+      : public ITileCallback
+    {
+      public:
+        explicit LoggingTileCallback(Log& log)
+          : m_log(log)
+        {
+        }
+
+        void release() override
+        {
+            delete this;
+        }
+
+        void on_tiled_frame_begin(const Frame* frame) override
+        {
+            m_log.record("frame_begin");
+        }
+
+        void on_tiled_frame_end(const Frame* frame) override
+        {
+            m_log.record("frame_end");
+        }
+
+        void on_tile_begin(const Frame* frame, const size_t tile_x, const size_t tile_y) override
+        {
+            m_log.record("tile_begin " + to_string(tile_x) + " " + to_string(tile_y));
+        }
+
+        void on_tile_end(const Frame* frame, const size_t tile_x, const size_t tile_y) override
+        {
+            m_log.record("tile_end " + to_string(tile_x) + " " + to_string(tile_y));
+        }
+
+        void on_progressive_frame_update(const Frame* frame) override
+        {
+            m_log.record("frame_update");
+        }
+
+      private:
+        Log& m_log;
+    };
+
+    class LoggingTileCallbackFactory
+      : public ITileCallbackFactory
+    {
+      public:
+        explicit LoggingTileCallbackFactory(Log& log)
+          : m_log(log)
+        {
+        }
+
+        void release() override
+        {
+            delete this;
+        }
+
+        ITileCallback* create() override
+        {
+            return new LoggingTileCallback(m_log);
+        }
+
+      private:
+        Log& m_log;
+    };
+
+    TEST_CASE(OnTileEnd_Synchronous_DeliversEventFromCallingThread)
+    {
+        Log log;
+        TileCallbackCollectionFactory factory;
+        factory.insert(new LoggingTileCallbackFactory(log));
+        ITileCallback* callback = factory.create();
+
+        callback->on_tile_end(nullptr, 1, 2);
+
+        ASSERT_EQ(1, log.m_events.size());
+        EXPECT_EQ("tile_end 1 2", log.m_events[0]);
+        EXPECT_EQ(boost::this_thread::get_id(), log.m_thread_ids[0]);
+
+        callback->release();
+    }
+
+    TEST_CASE(OnTiledFrameEnd_Asynchronous_DeliversPendingEventsInOrderFromAnotherThread)
+    {
+        Log log;
+        TileCallbackCollectionFactory factory(true);
+        factory.insert(new LoggingTileCallbackFactory(log));
+        ITileCallback* callback = factory.create();
+
+        callback->on_tiled_frame_begin(nullptr);
+        callback->on_tile_begin(nullptr, 0, 0);
+        callback->on_tile_begin(nullptr, 1, 0);
+        callback->on_tile_end(nullptr, 1, 0);
+        callback->on_tile_end(nullptr, 0, 0);
+        callback->on_tiled_frame_end(nullptr);
+
+        ASSERT_EQ(6, log.m_events.size());
+        EXPECT_EQ("frame_begin", log.m_events[0]);
+        EXPECT_EQ("tile_begin 0 0", log.m_events[1]);
+        EXPECT_EQ("tile_begin 1 0", log.m_events[2]);
+        EXPECT_EQ("tile_end 1 0", log.m_events[3]);
+        EXPECT_EQ("tile_end 0 0", log.m_events[4]);
+        EXPECT_EQ("frame_end", log.m_events[5]);
+        EXPECT_TRUE(log.m_thread_ids[2] != boost::this_thread::get_id());
+
+        callback->release();
+    }
+
+    TEST_CASE(OnTileEnd_Asynchronous_TileRenderedAgainWhileEndIsPending_CoalescesEvents)
+    {
+        Log log;
+        TileCallbackCollectionFactory factory(true);
+        factory.insert(new LoggingTileCallbackFactory(log));
+        ITileCallback* callback = factory.create();
+
+        // Stall delivery such that the events below are still pending.
+        log.m_gate_open = false;
+
+        callback->on_tile_begin(nullptr, 0, 0);
+        callback->on_tile_end(nullptr, 0, 0);
+        callback->on_tile_begin(nullptr, 0, 0);
+        callback->on_tile_end(nullptr, 0, 0);
+
+        log.open_gate();
+        callback->on_tiled_frame_end(nullptr);
+
+        ASSERT_EQ(3, log.m_events.size());
+        EXPECT_EQ("tile_begin 0 0", log.m_events[0]);
+        EXPECT_EQ("tile_end 0 0", log.m_events[1]);
+        EXPECT_EQ("frame_end", log.m_events[2]);
+
+        callback->release();
+    }
+}
@@ -0,0 +1,327 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rendering/generic/tilejob.h"
+#include "renderer/kernel/rendering/generic/tilejobfactory.h"
+#include "renderer/kernel/rendering/itilerenderer.h"
+#include "renderer/kernel/rendering/tilecallbackbase.h"
+#include "renderer/modeling/frame/frame.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/statistics.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Rendering_Generic_TileJobFactory)
+{
+    class PixelCountingTileRenderer
+      : public ITileRenderer
+    {
+      public:
+        PixelCountingTileRenderer(
+            const bool          supports_tile_regions,
+            vector<size_t>&     pixel_counts)
+          : m_supports_tile_regions(supports_tile_regions)
+          , m_pixel_counts(pixel_counts)
+        {
+        }
+
+        void release() override
+        {
+            delete this;
+        }
+
+        void print_settings() const override
+        {
+        }
+
+        void render_tile(
+            const Frame&        frame,
+            const size_t        tile_x,
+            const size_t        tile_y,
+            const uint32        pass_hash,
+            IAbortSwitch&       abort_switch) override
+        {
+            const Tile& tile = frame.image().tile(tile_x, tile_y);
+            m_pixel_counts[tile_index(frame, tile_x, tile_y)] += tile.get_pixel_count();
+        }
+
+        bool supports_tile_regions() const override
+        {
+            return m_supports_tile_regions;
+        }
+
+        void render_tile_region(
+            const Frame&        frame,
+            const size_t        tile_x,
+            const size_t        tile_y,
+            const AABB2u&       region,
+            const uint32        pass_hash,
+            IAbortSwitch&       abort_switch) override
+        {
+            m_pixel_counts[tile_index(frame, tile_x, tile_y)] += region.volume();
+        }
+
+        StatisticsVector get_statistics() const override
+        {
+            return StatisticsVector();
+        }
+
+      private:
+        const bool              m_supports_tile_regions;
+        vector<size_t>&         m_pixel_counts;
+
+        static size_t tile_index(const Frame& frame, const size_t tile_x, const size_t tile_y)
+        {
+            return tile_y * frame.image().properties().m_tile_count_x + tile_x;
+        }
+    };
+
+    class CountingTileCallback
+      : public TileCallbackBase
+    {
+      public:
+        size_t m_begin_count;
+        size_t m_end_count;
+
+        CountingTileCallback()
+          : m_begin_count(0)
+          , m_end_count(0)
+        {
+        }
+
+        void release() override
+        {
+        }
+
+        void on_tile_begin(
+            const Frame*        frame,
+            const size_t        tile_x,
+            const size_t        tile_y) override
+        {
+            ++m_begin_count;
+        }
+
+        void on_tile_end(
+            const Frame*        frame,
+            const size_t        tile_x,
+            const size_t        tile_y) override
+        {
+            ++m_end_count;
+        }
+    };
+
+    struct Fixture
+    {
+        auto_release_ptr<Frame>             m_frame;
+        vector<size_t>                      m_pixel_counts;
+        TileJob::TileRendererVector         m_tile_renderers;
+        CountingTileCallback                m_tile_callback;
+        TileJob::TileCallbackVector         m_tile_callbacks;
+        TileJobFactory::TileJobVector       m_tile_jobs;
+        TileJobFactory::ThreadIndexVector   m_tile_job_threads;
+        AbortSwitch                         m_abort_switch;
+
+        Fixture()
+          : m_frame(
+                FrameFactory::create(
+                    "frame",
+                    ParamArray()
+                        .insert("resolution", "256 200")
+                        .insert("tile_size", "64 64")))
+          , m_pixel_counts(m_frame->image().properties().m_tile_count, 0)
+        {
+        }
+
+        ~Fixture()
+        {
+            for (size_t i = 0, e = m_tile_jobs.size(); i < e; ++i)
+                delete m_tile_jobs[i];
+
+            for (size_t i = 0, e = m_tile_renderers.size(); i < e; ++i)
+                m_tile_renderers[i]->release();
+        }
+
+        void create_tile_jobs(
+            const size_t    thread_count,
+            const bool      supports_tile_regions,
+            const bool      tile_splitting)
+        {
+            for (size_t i = 0; i < thread_count; ++i)
+            {
+                m_tile_renderers.push_back(new PixelCountingTileRenderer(supports_tile_regions, m_pixel_counts));
+                m_tile_callbacks.push_back(&m_tile_callback);
+            }
+
+            TileJobFactory tile_job_factory;
+            tile_job_factory.create(
+                m_frame.ref(),
+                TileJobFactory::LinearOrdering,
+                m_tile_renderers,
+                m_tile_callbacks,
+                0,
+                Spectrum::RGB,
+                tile_splitting,
+                m_tile_jobs,
+                m_tile_job_threads,
+                m_abort_switch);
+        }
+
+        void execute_tile_jobs()
+        {
+            for (size_t i = 0, e = m_tile_jobs.size(); i < e; ++i)
+                m_tile_jobs[i]->execute(i % m_tile_renderers.size());
+        }
+
+        bool all_pixels_rendered_once() const
+        {
+            const Image& image = m_frame->image();
+            const CanvasProperties& props = image.properties();
+
+            for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+            {
+                for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+                {
+                    const size_t tile_index = ty * props.m_tile_count_x + tx;
+                    if (m_pixel_counts[tile_index] != image.tile(tx, ty).get_pixel_count())
+                        return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    TEST_CASE(ComputeTileSplitFactor_GivenMoreTilesThanThreads_SplitsTilesInFour)
+    {
+        EXPECT_EQ(2, TileJobFactory::compute_tile_split_factor(100, 8));
+    }
+
+    TEST_CASE(ComputeTileSplitFactor_GivenFewerTilesThanThreads_SplitsTilesFurther)
+    {
+        EXPECT_EQ(3, TileJobFactory::compute_tile_split_factor(8, 16));
+    }
+
+    TEST_CASE(ComputeTileSplitFactor_GivenVeryFewTiles_ClampsSplitFactor)
+    {
+        EXPECT_EQ(8, TileJobFactory::compute_tile_split_factor(1, 128));
+    }
+
+    TEST_CASE_F(Create_TileSplittingDisabled_CreatesOneJobPerTile, Fixture)
+    {
+        create_tile_jobs(4, true, false);
+
+        EXPECT_EQ(16, m_tile_jobs.size());
+    }
+
+    TEST_CASE_F(Create_TileRenderersDontSupportTileRegions_CreatesOneJobPerTile, Fixture)
+    {
+        create_tile_jobs(4, false, true);
+
+        EXPECT_EQ(16, m_tile_jobs.size());
+    }
+
+    TEST_CASE_F(Create_SingleRenderingThread_CreatesOneJobPerTile, Fixture)
+    {
+        create_tile_jobs(1, true, true);
+
+        EXPECT_EQ(16, m_tile_jobs.size());
+    }
+
+    TEST_CASE_F(Create_TileSplittingEnabled_SplitsLastTilesIntoRegions, Fixture)
+    {
+        create_tile_jobs(4, true, true);
+
+        // 12 whole tiles, and the 4 tiles of the last row, only 8 pixels high, split into 2x1 regions.
+        EXPECT_EQ(12 + 4 * 2, m_tile_jobs.size());
+    }
+
+    TEST_CASE_F(Create_TileSplittingDisabled_AssignsContiguousTileRangesToThreads, Fixture)
+    {
+        create_tile_jobs(4, true, false);
+
+        ASSERT_EQ(16, m_tile_job_threads.size());
+
+        for (size_t i = 0; i < 16; ++i)
+            EXPECT_EQ(i / 4, m_tile_job_threads[i]);
+    }
+
+    TEST_CASE_F(Create_TileSplittingEnabled_DistributesRegionJobsOverAllThreads, Fixture)
+    {
+        create_tile_jobs(4, true, true);
+
+        ASSERT_EQ(m_tile_jobs.size(), m_tile_job_threads.size());
+
+        // The 12 whole tiles are split into 4 ranges of 3 tiles.
+        for (size_t i = 0; i < 12; ++i)
+            EXPECT_EQ(i / 3, m_tile_job_threads[i]);
+
+        // The 8 region jobs are distributed evenly.
+        vector<size_t> region_job_counts(4, 0);
+        for (size_t i = 12; i < m_tile_job_threads.size(); ++i)
+            ++region_job_counts[m_tile_job_threads[i]];
+
+        for (size_t i = 0; i < 4; ++i)
+            EXPECT_EQ(2, region_job_counts[i]);
+    }
+
+    TEST_CASE_F(Execute_TileSplittingEnabled_RendersEveryPixelOnce, Fixture)
+    {
+        create_tile_jobs(4, true, true);
+
+        execute_tile_jobs();
+
+        EXPECT_TRUE(all_pixels_rendered_once());
+    }
+
+    TEST_CASE_F(Execute_TileSplittingEnabled_InvokesTileCallbacksOncePerTile, Fixture)
+    {
+        create_tile_jobs(4, true, true);
+
+        execute_tile_jobs();
+
+        EXPECT_EQ(16, m_tile_callback.m_begin_count);
+        EXPECT_EQ(16, m_tile_callback.m_end_count);
+    }
+}
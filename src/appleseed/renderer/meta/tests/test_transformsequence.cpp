@@ -381,6 +381,35 @@ TEST_SUITE(Renderer_Utility_TransformSequence)
         EXPECT_FEQ(expected, m_sequence.evaluate(2.0));
     }
 
+    TEST_CASE(EvaluateBatch_GivenThreeTransforms_MatchesIndividualEvaluations)
+    {
+        TransformSequence sequence;
+        sequence.set_transform(
+            0.0f,
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(1.0, 2.0, 3.0))));
+        sequence.set_transform(
+            1.0f,
+            Transformd::from_local_to_parent(
+                Matrix4d::make_rotation_y(Pi<double>() / 3.0) *
+                Matrix4d::make_scaling(Vector3d(2.0))));
+        sequence.set_transform(
+            2.0f,
+            Transformd::from_local_to_parent(
+                Matrix4d::make_translation(Vector3d(-1.0, 0.0, 4.0)) *
+                Matrix4d::make_rotation_x(Pi<double>() / 2.0)));
+        sequence.prepare();
+
+        const float Times[] = { -1.0f, 0.25f, 0.5f, 1.5f, 0.75f, 1.0f, 1.25f, 3.0f };
+        const size_t TimeCount = sizeof(Times) / sizeof(Times[0]);
+
+        Transformd results[TimeCount];
+        sequence.evaluate(TimeCount, Times, results);
+
+        for (size_t i = 0; i < TimeCount; ++i)
+            EXPECT_FEQ(sequence.evaluate(Times[i]), results[i]);
+    }
+
     TEST_CASE(Evaluate_GivenTwoTransformsSetInReverseOrder_ReturnsCorrectlyInterpolatedTransform)
     {
         const Transformd ExpectedFirstTransform(
@@ -0,0 +1,253 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/kernel/intersection/intersectionsettings.h"
+#include "renderer/kernel/intersection/triangleencoder.h"
+#include "renderer/kernel/intersection/trianglevertexinfo.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/vector.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/memory.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+
+TEST_SUITE(Renderer_Kernel_Intersection_TriangleEncoder)
+{
+    struct Fixture
+    {
+        vector<TriangleVertexInfo>  m_vertex_infos;
+        vector<GVector3>            m_vertices;
+        vector<size_t>              m_indices;
+        TriangleQuantizationGrid    m_grid;
+
+        Fixture()
+        {
+            // Two triangles sharing an edge.
+            add_triangle(GVector3(0.0f, 0.0f, 0.0f), GVector3(1.0f, 0.0f, 0.0f), GVector3(0.0f, 1.0f, 0.0f));
+            add_triangle(GVector3(1.0f, 0.0f, 0.0f), GVector3(1.0f, 1.0f, 0.0f), GVector3(0.0f, 1.0f, 0.0f));
+
+            m_grid.initialize(GAABB3(GVector3(-10.0f), GVector3(10.0f)), 2.0f);
+        }
+
+        void add_triangle(const GVector3& v0, const GVector3& v1, const GVector3& v2)
+        {
+            m_indices.push_back(m_vertex_infos.size());
+            m_vertex_infos.emplace_back(m_vertices.size(), 0, 1);
+            m_vertices.push_back(v0);
+            m_vertices.push_back(v1);
+            m_vertices.push_back(v2);
+        }
+    };
+
+    TEST_CASE_F(EncodeCompact_SharesVerticesBetweenTriangles, Fixture)
+    {
+        const size_t size =
+            TriangleEncoder::compute_compact_size(
+                m_grid,
+                m_vertex_infos,
+                m_vertices,
+                m_indices,
+                0,
+                m_indices.size());
+
+        vector<uint8> data(size);
+        MemoryWriter writer(&data[0]);
+        TriangleEncoder::encode_compact(
+            m_grid,
+            m_vertex_infos,
+            m_vertices,
+            m_indices,
+            0,
+            m_indices.size(),
+            writer);
+
+        EXPECT_EQ(size, writer.offset());
+
+        MemoryReader reader(&data[0]);
+        EXPECT_EQ(4, reader.read<uint32>());
+    }
+
+    TEST_CASE_F(DecodeCompact_ReturnsVerticesCloseToOriginalVertices, Fixture)
+    {
+        vector<uint8> data(
+            TriangleEncoder::compute_compact_size(
+                m_grid,
+                m_vertex_infos,
+                m_vertices,
+                m_indices,
+                0,
+                m_indices.size()));
+
+        MemoryWriter writer(&data[0]);
+        TriangleEncoder::encode_compact(
+            m_grid,
+            m_vertex_infos,
+            m_vertices,
+            m_indices,
+            0,
+            m_indices.size(),
+            writer);
+
+        MemoryReader reader(&data[0]);
+        const size_t vertex_count = reader.read<uint32>();
+        GVector3 vertices[TriangleEncoder::MaxCompactLeafVertexCount];
+        TriangleEncoder::decode_compact_vertices(m_grid, vertex_count, reader, vertices);
+
+        for (size_t i = 0; i < m_indices.size(); ++i)
+        {
+            EXPECT_EQ(1, reader.read<uint32>());
+            const uint8* indices = static_cast<const uint8*>(reader.read(4));
+
+            for (size_t j = 0; j < 3; ++j)
+                EXPECT_FEQ_EPS(m_vertices[i * 3 + j], vertices[indices[j]], 1.0e-4f);
+        }
+
+        EXPECT_EQ(data.size(), reader.offset());
+    }
+
+    TEST_CASE_F(EncodeCompact_GivenMovingTriangle_FallsBackToRegularLayout, Fixture)
+    {
+        m_vertex_infos[1].m_motion_segment_count = 1;
+        m_vertices.push_back(GVector3(1.0f, 0.0f, 1.0f));
+        m_vertices.push_back(GVector3(1.0f, 1.0f, 1.0f));
+        m_vertices.push_back(GVector3(0.0f, 1.0f, 1.0f));
+
+        const size_t size =
+            TriangleEncoder::compute_compact_size(
+                m_grid,
+                m_vertex_infos,
+                m_vertices,
+                m_indices,
+                0,
+                m_indices.size());
+
+        EXPECT_EQ(
+            sizeof(uint32) + TriangleEncoder::compute_size(m_vertex_infos, m_indices, 0, m_indices.size()),
+            size);
+
+        vector<uint8> data(size);
+        MemoryWriter writer(&data[0]);
+        TriangleEncoder::encode_compact(
+            m_grid,
+            m_vertex_infos,
+            m_vertices,
+            m_indices,
+            0,
+            m_indices.size(),
+            writer);
+
+        MemoryReader reader(&data[0]);
+        EXPECT_EQ(0, reader.read<uint32>());
+    }
+
+    TEST_CASE_F(EncodeSIMD_StoresTrianglesInOneGroup, Fixture)
+    {
+        const size_t size =
+            TriangleEncoder::compute_simd_size(
+                m_vertex_infos,
+                m_indices,
+                0,
+                m_indices.size());
+
+        vector<uint8> data(size);
+        MemoryWriter writer(&data[0]);
+        TriangleEncoder::encode_simd(
+            m_vertex_infos,
+            m_vertices,
+            m_indices,
+            0,
+            m_indices.size(),
+            writer);
+
+        EXPECT_EQ(size, writer.offset());
+
+        MemoryReader reader(&data[0]);
+        EXPECT_EQ(1, reader.read<uint32>());
+
+        const uint32* vis_flags = static_cast<const uint32*>(reader.read(4 * sizeof(uint32)));
+        EXPECT_EQ(1, vis_flags[0]);
+        EXPECT_EQ(1, vis_flags[1]);
+        EXPECT_EQ(0, vis_flags[2]);
+        EXPECT_EQ(0, vis_flags[3]);
+
+        const GTriangle4Type& triangles = reader.read<GTriangle4Type>();
+        for (size_t i = 0; i < m_indices.size(); ++i)
+        {
+            const GTriangleType triangle = triangles.get(i);
+            EXPECT_EQ(m_vertices[i * 3 + 0], triangle.m_v0);
+            EXPECT_EQ(m_vertices[i * 3 + 1] - m_vertices[i * 3 + 0], triangle.m_e0);
+            EXPECT_EQ(m_vertices[i * 3 + 2] - m_vertices[i * 3 + 0], triangle.m_e1);
+        }
+
+        EXPECT_EQ(data.size(), reader.offset());
+    }
+
+    TEST_CASE_F(EncodeSIMD_GivenMovingTriangle_FallsBackToRegularLayout, Fixture)
+    {
+        m_vertex_infos[1].m_motion_segment_count = 1;
+        m_vertices.push_back(GVector3(1.0f, 0.0f, 1.0f));
+        m_vertices.push_back(GVector3(1.0f, 1.0f, 1.0f));
+        m_vertices.push_back(GVector3(0.0f, 1.0f, 1.0f));
+
+        const size_t size =
+            TriangleEncoder::compute_simd_size(
+                m_vertex_infos,
+                m_indices,
+                0,
+                m_indices.size());
+
+        EXPECT_EQ(
+            sizeof(uint32) + TriangleEncoder::compute_size(m_vertex_infos, m_indices, 0, m_indices.size()),
+            size);
+
+        vector<uint8> data(size);
+        MemoryWriter writer(&data[0]);
+        TriangleEncoder::encode_simd(
+            m_vertex_infos,
+            m_vertices,
+            m_indices,
+            0,
+            m_indices.size(),
+            writer);
+
+        MemoryReader reader(&data[0]);
+        EXPECT_EQ(0, reader.read<uint32>());
+    }
+}
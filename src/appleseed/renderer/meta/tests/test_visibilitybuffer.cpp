@@ -0,0 +1,223 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/kernel/rasterization/rasterizationcamera.h"
+#include "renderer/kernel/rasterization/visibilitybuffer.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/scalar.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Kernel_Rasterization_VisibilityBuffer)
+{
+    struct Fixture
+    {
+        RasterizationCamera     m_camera;
+
+        Fixture()
+        {
+            // 90 degrees horizontal field of view: pixel x of a 10x10 frame is at 5 + 5 * X / depth.
+            m_camera.m_aspect_ratio = 1.0;
+            m_camera.m_hfov = deg_to_rad(90.0);
+            m_camera.m_shift_x = 0.0;
+            m_camera.m_shift_y = 0.0;
+        }
+
+        static ObjectRasterizer::Triangle make_triangle(
+            const Vector3d&     v0,
+            const Vector3d&     v1,
+            const Vector3d&     v2)
+        {
+            ObjectRasterizer::Triangle triangle;
+
+            for (size_t i = 0; i < 3; ++i)
+            {
+                triangle.m_v0[i] = v0[i];
+                triangle.m_v1[i] = v1[i];
+                triangle.m_v2[i] = v2[i];
+                triangle.m_n0[i] = triangle.m_n1[i] = triangle.m_n2[i] = i == 2 ? 1.0 : 0.0;
+            }
+
+            return triangle;
+        }
+
+        // Intersect the ray going from the camera through the center of pixel (x, y) of a
+        // 10x10 frame with a triangle. Returns the distance to the camera plane.
+        static double intersect_pixel_ray(
+            const size_t        x,
+            const size_t        y,
+            const Vector3d&     v0,
+            const Vector3d&     v1,
+            const Vector3d&     v2,
+            Vector2d&           bary)
+        {
+            const Vector3d dir((x + 0.5 - 5.0) / 5.0, (5.0 - (y + 0.5)) / 5.0, -1.0);
+            const Vector3d e1 = v1 - v0;
+            const Vector3d e2 = v2 - v0;
+            const Vector3d p = cross(dir, e2);
+            const double rcp_det = 1.0 / dot(e1, p);
+            const Vector3d s = -v0;
+            const Vector3d q = cross(s, e1);
+
+            bary[0] = dot(s, p) * rcp_det;
+            bary[1] = dot(dir, q) * rcp_det;
+
+            return dot(e2, q) * rcp_det;
+        }
+    };
+
+    TEST_CASE(Clear_MarksAllPixelsAsEmpty)
+    {
+        VisibilityBuffer buffer(4, 2);
+
+        EXPECT_FALSE(buffer.sample(0, 0).hit());
+        EXPECT_FALSE(buffer.sample(3, 1).hit());
+    }
+
+    TEST_CASE_F(Rasterize_GivenTriangleFacingCamera_CoversPixelsInsideTriangleOnly, Fixture)
+    {
+        VisibilityBuffer buffer(10, 10);
+        VisibilityBufferRasterizer rasterizer(m_camera, 0.01, 10, 10, 0, 0, buffer);
+        rasterizer.set_object_instance(Transformd::make_identity(), 7);
+
+        rasterizer.begin_object();
+        rasterizer.rasterize(
+            make_triangle(
+                Vector3d(-0.2, -0.2, -1.0),
+                Vector3d(0.2, -0.2, -1.0),
+                Vector3d(0.0, 0.2, -1.0)));
+        rasterizer.end_object();
+
+        const VisibilityBuffer::Sample& center = buffer.sample(5, 5);
+        ASSERT_TRUE(center.hit());
+        EXPECT_FEQ(1.0f, center.m_depth);
+        EXPECT_EQ(7, center.m_instance_id);
+        EXPECT_EQ(0, center.m_primitive_index);
+        EXPECT_FEQ(Vector2f(0.625f, 0.25f), center.m_bary);
+
+        EXPECT_FALSE(buffer.sample(0, 0).hit());
+        EXPECT_FALSE(buffer.sample(9, 9).hit());
+    }
+
+    TEST_CASE_F(Rasterize_GivenTiltedTriangle_MatchesRayIntersection, Fixture)
+    {
+        const Vector3d v0(-0.6, -0.6, -1.0);
+        const Vector3d v1(1.2, -1.2, -3.0);
+        const Vector3d v2(0.0, 1.2, -2.0);
+
+        VisibilityBuffer buffer(10, 10);
+        VisibilityBufferRasterizer rasterizer(m_camera, 0.01, 10, 10, 0, 0, buffer);
+
+        rasterizer.begin_object();
+        rasterizer.rasterize(make_triangle(v0, v1, v2));
+        rasterizer.end_object();
+
+        Vector2d expected_bary;
+        const double expected_depth = intersect_pixel_ray(5, 5, v0, v1, v2, expected_bary);
+
+        const VisibilityBuffer::Sample& sample = buffer.sample(5, 5);
+        ASSERT_TRUE(sample.hit());
+        EXPECT_FEQ_EPS(static_cast<float>(expected_depth), sample.m_depth, 1.0e-5f);
+        EXPECT_FEQ_EPS(Vector2f(expected_bary), sample.m_bary, 1.0e-5f);
+    }
+
+    TEST_CASE_F(Rasterize_GivenOverlappingTriangles_KeepsClosestOne, Fixture)
+    {
+        VisibilityBuffer buffer(10, 10);
+        VisibilityBufferRasterizer rasterizer(m_camera, 0.01, 10, 10, 0, 0, buffer);
+
+        rasterizer.begin_object();
+        rasterizer.rasterize(
+            make_triangle(
+                Vector3d(-0.2, -0.2, -1.0),
+                Vector3d(0.2, -0.2, -1.0),
+                Vector3d(0.0, 0.2, -1.0)));
+        rasterizer.rasterize(
+            make_triangle(
+                Vector3d(-4.0, -4.0, -2.0),
+                Vector3d(4.0, -4.0, -2.0),
+                Vector3d(0.0, 4.0, -2.0)));
+        rasterizer.rasterize(
+            make_triangle(
+                Vector3d(0.0, -0.1, -0.5),
+                Vector3d(0.1, -0.1, -0.5),
+                Vector3d(0.05, 0.1, -0.5)));
+        rasterizer.end_object();
+
+        EXPECT_EQ(2, buffer.sample(5, 5).m_primitive_index);
+        EXPECT_FEQ(0.5f, buffer.sample(5, 5).m_depth);
+        EXPECT_EQ(0, buffer.sample(4, 5).m_primitive_index);
+        EXPECT_EQ(1, buffer.sample(1, 8).m_primitive_index);
+    }
+
+    TEST_CASE_F(Rasterize_GivenTriangleCrossingNearPlane_MatchesRayIntersection, Fixture)
+    {
+        const Vector3d v0(-1.0, -1.0, -1.0);
+        const Vector3d v1(1.0, -1.0, -1.0);
+        const Vector3d v2(0.0, 1.0, 0.5);
+
+        VisibilityBuffer buffer(10, 10);
+        VisibilityBufferRasterizer rasterizer(m_camera, 0.01, 10, 10, 0, 0, buffer);
+
+        rasterizer.begin_object();
+        rasterizer.rasterize(make_triangle(v0, v1, v2));
+        rasterizer.end_object();
+
+        Vector2d expected_bary;
+        const double expected_depth = intersect_pixel_ray(5, 5, v0, v1, v2, expected_bary);
+
+        const VisibilityBuffer::Sample& sample = buffer.sample(5, 5);
+        ASSERT_TRUE(sample.hit());
+        EXPECT_FEQ_EPS(static_cast<float>(expected_depth), sample.m_depth, 1.0e-5f);
+        EXPECT_FEQ_EPS(Vector2f(expected_bary), sample.m_bary, 1.0e-5f);
+    }
+
+    TEST_CASE_F(Rasterize_GivenBufferOrigin_RasterizesCorrespondingRegionOfFrame, Fixture)
+    {
+        VisibilityBuffer buffer(2, 2);
+        VisibilityBufferRasterizer rasterizer(m_camera, 0.01, 10, 10, 4, 4, buffer);
+
+        rasterizer.begin_object();
+        rasterizer.rasterize(
+            make_triangle(
+                Vector3d(-0.2, -0.2, -1.0),
+                Vector3d(0.2, -0.2, -1.0),
+                Vector3d(0.0, 0.2, -1.0)));
+        rasterizer.end_object();
+
+        ASSERT_TRUE(buffer.sample(1, 1).hit());
+        EXPECT_FEQ(Vector2f(0.625f, 0.25f), buffer.sample(1, 1).m_bary);
+    }
+}
@@ -0,0 +1,103 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// appleseed.renderer headers.
+#include "renderer/modeling/color/wavelengths.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/regularspectrum.h"
+#include "foundation/utility/iostreamop.h"
+#include "foundation/utility/test.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace renderer;
+
+TEST_SUITE(Renderer_Modeling_Color_Wavelengths)
+{
+    TEST_CASE(SampleHeroWavelengths_ReturnsEquallySpacedWavelengthsWithinRange)
+    {
+        float wavelengths[HeroWavelengthCount];
+        sample_hero_wavelengths(0.9f, wavelengths);
+
+        EXPECT_FEQ(670.0f, wavelengths[0]);
+        EXPECT_FEQ(445.0f, wavelengths[1]);
+        EXPECT_FEQ(520.0f, wavelengths[2]);
+        EXPECT_FEQ(595.0f, wavelengths[3]);
+    }
+
+    TEST_CASE(EvaluateSpectrum_GivenSampleWavelengths_ReturnsSpectrumSamples)
+    {
+        RegularSpectrum31f spectrum;
+        for (size_t i = 0; i < spectrum.Samples; ++i)
+            spectrum[i] = static_cast<float>(i);
+
+        const float Wavelengths[3] = { 400.0f, 550.0f, 700.0f };
+        float values[3];
+        evaluate_spectrum(spectrum, 3, Wavelengths, values);
+
+        EXPECT_FEQ(0.0f, values[0]);
+        EXPECT_FEQ(15.0f, values[1]);
+        EXPECT_FEQ(30.0f, values[2]);
+    }
+
+    TEST_CASE(EvaluateSpectrum_GivenWavelengthBetweenSamples_InterpolatesLinearly)
+    {
+        RegularSpectrum31f spectrum(0.0f);
+        spectrum[10] = 1.0f;
+        spectrum[11] = 3.0f;
+
+        const float Wavelength = 502.5f;
+        float value;
+        evaluate_spectrum(spectrum, 1, &Wavelength, &value);
+
+        EXPECT_FEQ(1.5f, value);
+    }
+
+    TEST_CASE(SplatHeroWavelengths_GivenConstantSpectrum_ConvergesToConstantSpectrum)
+    {
+        const size_t SampleCount = 1000;
+
+        RegularSpectrum31f accumulated(0.0f);
+
+        for (size_t i = 0; i < SampleCount; ++i)
+        {
+            float wavelengths[HeroWavelengthCount];
+            sample_hero_wavelengths((static_cast<float>(i) + 0.5f) / SampleCount, wavelengths);
+
+            const float Values[HeroWavelengthCount] = { 1.0f, 1.0f, 1.0f, 1.0f };
+            splat_hero_wavelengths(wavelengths, Values, accumulated);
+        }
+
+        accumulated /= static_cast<float>(SampleCount);
+
+        EXPECT_FEQ_EPS(RegularSpectrum31f(1.0f), accumulated, 1.0e-2f);
+    }
+}
@@ -67,6 +67,11 @@ namespace
         {
         }
 
+        int get_events() const override
+        {
+            return WriteEvents;
+        }
+
         void write(
             const PixelContext&         pixel_context,
             const ShadingPoint&         shading_point,
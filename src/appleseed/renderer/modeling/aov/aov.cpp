@@ -32,6 +32,7 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/aov/imagestack.h"
+#include "renderer/utility/messagecontext.h"
 
 // appleseed.foundation headers.
 #include "foundation/image/color.h"
@@ -40,13 +41,16 @@
 #include "foundation/image/imageattributes.h"
 #include "foundation/platform/defaulttimers.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/makevector.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
 // Standard headers.
 #include <exception>
+#include <string>
 
 using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -89,6 +93,11 @@ void AOV::post_process_image(const Frame& frame)
 {
 }
 
+bool AOV::supports_streaming() const
+{
+    return true;
+}
+
 bool AOV::write_images(
     const char*             file_path,
     const ImageAttributes&  image_attributes) const
@@ -135,6 +144,33 @@ bool AOV::write_images(
     return true;
 }
 
+PixelFormat AOV::get_storage_format() const
+{
+    const PixelFormat default_format = get_default_storage_format();
+
+    const string storage_format =
+        m_params.get_optional<string>(
+            "storage_format",
+            pixel_format_name(default_format),
+            make_vector("half", "float", "uint8", "uint16"),
+            EntityDefMessageContext("aov", this));
+
+    if (storage_format == "half")
+        return PixelFormatHalf;
+    else if (storage_format == "float")
+        return PixelFormatFloat;
+    else if (storage_format == "uint8")
+        return PixelFormatUInt8;
+    else if (storage_format == "uint16")
+        return PixelFormatUInt16;
+    else return default_format;
+}
+
+PixelFormat AOV::get_default_storage_format() const
+{
+    return PixelFormatFloat;
+}
+
 void AOV::create_image(
     const size_t            canvas_width,
     const size_t            canvas_height,
@@ -149,7 +185,7 @@ void AOV::create_image(
         m_image_index = aov_images.append(
             get_name(),
             get_channel_count(),
-            PixelFormatFloat);
+            get_storage_format());
     }
 
     m_image = &aov_images.get_image(m_image_index);
@@ -186,6 +222,11 @@ void ColorAOV::clear_image()
     m_image->clear(Color4f(0.0f));
 }
 
+PixelFormat ColorAOV::get_default_storage_format() const
+{
+    return PixelFormatHalf;
+}
+
 
 //
 // UnfilteredAOV class implementation.
@@ -236,7 +277,7 @@ void UnfilteredAOV::create_image(
             tile_width,
             tile_height,
             get_channel_count(),
-            PixelFormatFloat);
+            get_storage_format());
 
     // We need to clear the image because the default channel value might not be zero.
     clear_image();
@@ -32,6 +32,7 @@
 #include "renderer/modeling/entity/entity.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/pixel.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/uid.h"
 
@@ -91,6 +92,9 @@ class APPLESEED_DLLSYMBOL AOV
     // Apply any post-processing needed to the AOV image.
     virtual void post_process_image(const Frame& frame);
 
+    // Return true if the AOV image can be written tile by tile while the frame is rendering.
+    virtual bool supports_streaming() const;
+
     // Write image to OpenEXR file.
     virtual bool write_images(
         const char*                         file_path,
@@ -103,6 +107,14 @@ class APPLESEED_DLLSYMBOL AOV
     foundation::Image*  m_image;
     size_t              m_image_index;
 
+    // Return the pixel format of the AOV image. It can be set with the "storage_format"
+    // parameter: "half", "float", "uint8" or "uint16". Integer formats store values
+    // normalized to [0, 1] and are only suitable for masks.
+    foundation::PixelFormat get_storage_format() const;
+
+    // Return the pixel format of the AOV image when no storage format is specified.
+    virtual foundation::PixelFormat get_default_storage_format() const;
+
     // Create an image to store the AOV result.
     virtual void create_image(
         const size_t    canvas_width,
@@ -138,6 +150,10 @@ class ColorAOV
 
     // Clear the AOV image to default values.
     void clear_image() override;
+
+  protected:
+    // Color AOVs are written as half floats, so they are stored as half floats by default.
+    foundation::PixelFormat get_default_storage_format() const override;
 };
 
 
@@ -37,9 +37,11 @@
 #include "renderer/modeling/aov/diffuseaov.h"
 #include "renderer/modeling/aov/emissionaov.h"
 #include "renderer/modeling/aov/glossyaov.h"
+#include "renderer/modeling/aov/idaov.h"
 #include "renderer/modeling/aov/invalidsamplesaov.h"
 #include "renderer/modeling/aov/normalaov.h"
 #include "renderer/modeling/aov/npraovs.h"
+#include "renderer/modeling/aov/pixelcostaovs.h"
 #include "renderer/modeling/aov/pixelerroraov.h"
 #include "renderer/modeling/aov/pixelsamplecountaov.h"
 #include "renderer/modeling/aov/pixeltimeaov.h"
@@ -79,6 +81,7 @@ AOVFactoryRegistrar::AOVFactoryRegistrar(const SearchPaths& search_paths)
     impl->register_factory(auto_release_ptr<FactoryType>(new DirectGlossyAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new EmissionAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new GlossyAOVFactory()));
+    impl->register_factory(auto_release_ptr<FactoryType>(new IDAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new IndirectDiffuseAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new IndirectGlossyAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new InvalidSamplesAOVFactory()));
@@ -86,8 +89,11 @@ AOVFactoryRegistrar::AOVFactoryRegistrar(const SearchPaths& search_paths)
     impl->register_factory(auto_release_ptr<FactoryType>(new NPRContourAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new NPRShadingAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new PixelErrorAOVFactory()));
+    impl->register_factory(auto_release_ptr<FactoryType>(new PixelRayCountAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new PixelSampleCountAOVFactory()));
+    impl->register_factory(auto_release_ptr<FactoryType>(new PixelTextureFetchAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new PixelTimeAOVFactory()));
+    impl->register_factory(auto_release_ptr<FactoryType>(new PixelTraversalStepCountAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new PixelVariationAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new PositionAOVFactory()));
     impl->register_factory(auto_release_ptr<FactoryType>(new ScreenSpaceVelocityAOVFactory()));
@@ -101,9 +107,14 @@ AOVFactoryRegistrar::~AOVFactoryRegistrar()
     delete impl;
 }
 
-void AOVFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
+const char* AOVFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
 {
-    impl->register_factory_plugin(plugin, plugin_entry_point);
+    return impl->register_factory_plugin(plugin, plugin_entry_point);
+}
+
+void AOVFactoryRegistrar::set_plugin_store(PluginStore* plugin_store, const char* entry_point_name)
+{
+    impl->set_plugin_store(plugin_store, entry_point_name);
 }
 
 AOVFactoryArray AOVFactoryRegistrar::get_factories() const
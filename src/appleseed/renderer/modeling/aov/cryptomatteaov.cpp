@@ -37,6 +37,7 @@
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingresult.h"
 #include "renderer/modeling/color/colorspace.h"
+#include "renderer/modeling/entity/entity.h"
 #include "renderer/modeling/frame/frame.h"
 
 // appleseed.foundation headers.
@@ -59,6 +60,8 @@
 
 // Boost headers.
 #include "boost/filesystem.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
 
 // Murmurhash3 headers.
 #include "MurmurHash3.h"
@@ -265,120 +268,100 @@ namespace
         }
     };
 
-    class WeightMap
+    //
+    // Per-pixel coverage of a tile, as weighted lists of hashed names.
+    //
+    // Each pixel has room for a fixed number of entries, all stored in a single array
+    // that is only reallocated when the tile grows. Samples of names that do not fit
+    // are still counted in the total weight of the pixel, so that coverage values
+    // remain fractions of the pixel.
+    //
+
+    class CoverageTile
     {
       public:
         struct Entry
         {
-            uint32 key;
-            float value;
-
-            Entry()
-              : key(0)
-              , value(0.0f)
-            {
-            }
+            uint32  m_key;
+            float   m_weight;
         };
 
-        explicit WeightMap(const size_t size)
-          : m_size(static_cast<uint32>(size))
-          , m_index(0)
+        explicit CoverageTile(const size_t rank)
+          : m_rank(rank)
+          , m_width(0)
+          , m_height(0)
         {
-            assert(size > 0);
-            m_map = new Entry[size];
-        }
-
-        WeightMap(const WeightMap& other)
-          : m_size(other.m_size)
-          , m_index(other.m_index)
-        {
-            m_map = new Entry[m_size];
-            for (size_t i = 0; i < m_index; ++i)
-            {
-                m_map[i] = other.m_map[i];
-            }
+            assert(rank > 0);
         }
 
-        WeightMap& operator=(const WeightMap& rhs)
+        // Resize the tile and clear all pixels.
+        void reset(const size_t width, const size_t height)
         {
-            if (m_size != rhs.m_size)
-            {
-                delete[] m_map;
-                m_map = new Entry[rhs.m_size];
-            }
+            m_width = width;
+            m_height = height;
 
-            m_size = rhs.m_size;
-            m_index = rhs.m_size;
-            for (size_t i = 0; i < m_index; ++i)
-            {
-                m_map[i] = rhs.m_map[i];
-            }
-            return *this;
+            const size_t pixel_count = width * height;
+            m_entries.resize(pixel_count * m_rank);
+            m_entry_counts.assign(pixel_count, 0);
+            m_total_weights.assign(pixel_count, 0.0f);
         }
 
-        ~WeightMap()
+        size_t get_rank() const
         {
-            delete[] m_map;
+            return m_rank;
         }
 
-        void insert(const uint32 key, const float value)
+        void add(const size_t x, const size_t y, const uint32 key)
         {
-            assert(m_map);
+            assert(x < m_width);
+            assert(y < m_height);
+
+            const size_t i = y * m_width + x;
+            m_total_weights[i] += 1.0f;
 
-            for (size_t i = 0; i < m_index; ++i)
+            Entry* entries = &m_entries[i * m_rank];
+            const size_t count = m_entry_counts[i];
+
+            for (size_t j = 0; j < count; ++j)
             {
-                if (m_map[i].key == key)
+                if (entries[j].m_key == key)
                 {
-                    m_map[i].value = value;
+                    entries[j].m_weight += 1.0f;
                     return;
                 }
             }
 
-            if (m_index < m_size)
+            if (count < m_rank)
             {
-                m_map[m_index].key = key;
-                m_map[m_index].value = value;
-                ++m_index;
+                entries[count].m_key = key;
+                entries[count].m_weight = 1.0f;
+                m_entry_counts[i] = static_cast<uint32>(count + 1);
             }
         }
 
-        float get(const uint32 key) const
+        size_t get_entry_count(const size_t x, const size_t y) const
         {
-            assert(m_map);
-
-            for (size_t i = 0; i < m_index; ++i)
-            {
-                if (m_map[i].key == key)
-                    return m_map[i].value;
-            }
-
-            return 0.0f;
+            return m_entry_counts[y * m_width + x];
         }
 
-        void clear()
+        // Entries are not sorted.
+        Entry* get_entries(const size_t x, const size_t y)
         {
-            m_index = 0;
+            return &m_entries[(y * m_width + x) * m_rank];
         }
 
-        bool empty() const
+        float get_total_weight(const size_t x, const size_t y) const
         {
-            return m_index == 0;
-        }
-
-        Entry* begin() const
-        {
-            return m_map;
-        }
-
-        Entry* end() const
-        {
-            return m_map + m_index;
+            return m_total_weights[y * m_width + x];
         }
 
       private:
-        uint32  m_size;
-        uint32  m_index;
-        Entry*  m_map;
+        const size_t    m_rank;
+        size_t          m_width;
+        size_t          m_height;
+        vector<Entry>   m_entries;
+        vector<uint32>  m_entry_counts;
+        vector<float>   m_total_weights;
     };
 
     // Code taken from Cryptomatte specification: https://github.com/Psyop/Cryptomatte/blob/master/specification/cryptomatte_specification.pdf
@@ -403,6 +386,13 @@ namespace
 
     typedef map<uint32, string> NameMap;
 
+    // Names of all the objects or materials seen while rendering, shared by all accumulators.
+    struct NameManifest
+    {
+        boost::mutex    m_mutex;
+        NameMap         m_names;
+    };
+
 
     //
     // Cryptomatte AOV accumulator.
@@ -414,15 +404,17 @@ namespace
       public:
         CryptomatteAOVAccumulator(
             Image&                              aov_image,
-            vector<WeightMap>&                  pixel_samples,
-            NameMap*                            tile_name_array,
+            NameManifest&                       manifest,
             size_t                              num_layers,
             CryptomatteAOV::CryptomatteType     layer_type)
           : m_aov_image(aov_image)
           , m_num_layers(num_layers)
-          , m_pixel_samples(pixel_samples)
-          , m_tile_name_array(tile_name_array)
+          , m_manifest(manifest)
           , m_layer_type(layer_type)
+          , m_coverage(num_layers + 1)  // one more entry for the background
+          , m_pixel_values((num_layers * 2) + 3)
+          , m_last_entity(nullptr)
+          , m_last_hash(0)
         {
         }
 
@@ -436,20 +428,16 @@ namespace
             const CanvasProperties& props = frame.image().properties();
             const Tile& tile = frame.image().tile(tile_x, tile_y);
 
-            m_frame_width = props.m_canvas_width;
-            m_tile_index = tile_y * props.m_tile_count_y + tile_x;
-
             // Fetch the tile bounds (inclusive).
+            m_tile_x = tile_x;
+            m_tile_y = tile_y;
             m_tile_origin_x = tile_x * props.m_tile_width;
             m_tile_origin_y = tile_y * props.m_tile_height;
             m_tile_end_x = m_tile_origin_x + tile.get_width() - 1;
             m_tile_end_y = m_tile_origin_y + tile.get_height() - 1;
 
-            for (size_t ry = m_tile_origin_y; ry <= m_tile_end_y; ++ry)
-            {
-                for (size_t rx = m_tile_origin_x; rx <= m_tile_end_x; ++rx)
-                    m_pixel_samples[ry * m_frame_width + rx].clear();
-            }
+            m_coverage.reset(tile.get_width(), tile.get_height());
+            m_last_entity = nullptr;
 
             m_crop_window =
                 frame.has_crop_window()
@@ -462,77 +450,87 @@ namespace
             const size_t                tile_x,
             const size_t                tile_y) override
         {
-            vector<pair<float, uint32>> ranked_vector;
-            vector<float> pixel_values;
             const float uint32_max_rcp = 1.0f / numeric_limits<uint32>::max();
 
-            for (size_t ry = m_tile_origin_y; ry <= m_tile_end_y; ++ry)
+            Tile& aov_tile = m_aov_image.tile(m_tile_x, m_tile_y);
+
+            for (size_t y = 0, h = aov_tile.get_height(); y < h; ++y)
             {
-                for (size_t rx = m_tile_origin_x; rx <= m_tile_end_x; ++rx)
+                for (size_t x = 0, w = aov_tile.get_width(); x < w; ++x)
                 {
-                    const WeightMap& weight_map = m_pixel_samples[ry * m_frame_width + rx];
+                    // Only write pixels that received samples, other regions of the tile
+                    // may be rendered concurrently by other accumulators.
+                    size_t entry_count = m_coverage.get_entry_count(x, y);
+                    if (entry_count == 0)
+                        continue;
 
-                    if (!weight_map.empty())
-                    {
-                        clear_keep_memory(ranked_vector);
-                        clear_keep_memory(pixel_values);
+                    CoverageTile::Entry* entries = m_coverage.get_entries(x, y);
+                    const float total_weight = m_coverage.get_total_weight(x, y);
 
-                        float total_weight = 0.0f;
-                        for (const auto& item : weight_map)
-                            total_weight += item.value;
+                    sort(entries, entries + entry_count,
+                        [](const CoverageTile::Entry& a, const CoverageTile::Entry& b)
+                        {
+                            return a.m_weight > b.m_weight;
+                        });
 
-                        if (total_weight == 0.0f)
-                            total_weight = 1.0f;
+                    const uint32 m3hash_preview = entries[0].m_key;
 
-                        for (const auto& item : weight_map)
-                            ranked_vector.push_back(make_pair(item.value, item.key));
+                    // Preview channels (deprecated in recent Cryptomatte specification).
+                    float r(0.0f), g(0.0f), b(0.0f);
+                    if (m3hash_preview != 0)
+                    {
+                        r = hash_to_float(m3hash_preview);
+                        g = static_cast<float>(m3hash_preview << 8) * uint32_max_rcp;
+                        b = static_cast<float>(m3hash_preview << 16) * uint32_max_rcp;
+                    }
 
-                        sort(ranked_vector.begin(), ranked_vector.end(),
-                            [](pair<float, uint32> const& a, pair<float, uint32> const& b)
-                            {
-                                return a.first > b.first;
-                            });
+                    float* values = m_pixel_values.data();
+                    *values++ = r;
+                    *values++ = g;
+                    *values++ = b;
 
-                        const uint32 m3hash_preview = ranked_vector[0].second;
+                    // Remove background contribution.
+                    if (entry_count > 1 && m3hash_preview == 0)
+                    {
+                        ++entries;
+                        --entry_count;
+                    }
 
-                        // Preview channels (deprecated in recent Cryptomatte specification).
-                        float r(0.0f), g(0.0f), b(0.0f);
-                        if (m3hash_preview != 0)
+                    // Ranked channels.
+                    const size_t ranked_count = min(entry_count, m_num_layers);
+                    for (size_t i = 0; i < ranked_count; ++i)
+                    {
+                        const uint32 m3hash = entries[i].m_key;
+                        float rank(0.0f), coverage(0.0f);
+                        if (m3hash != 0)
                         {
-                            r = hash_to_float(m3hash_preview);
-                            g = static_cast<float>(m3hash_preview << 8) * uint32_max_rcp;
-                            b = static_cast<float>(m3hash_preview << 16) * uint32_max_rcp;
+                            rank = hash_to_float(m3hash);
+                            coverage = entries[i].m_weight / total_weight;
                         }
-                        pixel_values.push_back(r);
-                        pixel_values.push_back(g);
-                        pixel_values.push_back(b);
+                        *values++ = rank;
+                        *values++ = coverage;
+                    }
 
-                        // Remove background contribution.
-                        if (ranked_vector.size() > 1 && m3hash_preview == 0)
-                            ranked_vector.erase(ranked_vector.begin());
+                    for (size_t i = ranked_count; i < m_num_layers; ++i)
+                    {
+                        *values++ = 0.0f;
+                        *values++ = 0.0f;
+                    }
 
-                        // Ranked channels.
-                        for (size_t i = 0, e = min(ranked_vector.size(), m_num_layers); i < e; ++i)
-                        {
-                            const uint32 m3hash = ranked_vector[i].second;
-                            float rank(0.0f), coverage(0.0f);
-                            if (m3hash != 0)
-                            {
-                                rank = hash_to_float(m3hash);
-                                coverage = ranked_vector[i].first / total_weight;
-                            }
-                            pixel_values.push_back(rank);
-                            pixel_values.push_back(coverage);
-                        }
+                    aov_tile.set_pixel(x, y, m_pixel_values.data(), m_pixel_values.size());
+                }
+            }
 
-                        const size_t num_channels = (m_num_layers * 2) + 3;
-                        for (size_t i = ranked_vector.size(); i < num_channels; ++i)
-                            pixel_values.push_back(0.0f);
+            // Publish the names seen in this tile.
+            if (!m_tile_names.empty())
+            {
+                boost::mutex::scoped_lock lock(m_manifest.m_mutex);
 
-                        m_aov_image.set_pixel(rx, ry, pixel_values.data(), pixel_values.size());
-                    }
-                }
+                for (const auto& name : m_tile_names)
+                    m_manifest.m_names.insert(name);
             }
+
+            m_tile_names.clear();
         }
 
         void on_sample_begin(const PixelContext& pixel_context) override
@@ -558,62 +556,71 @@ namespace
             const AOVComponents&        aov_components,
             ShadingResult&              shading_result) override
         {
-            uint32 m3hash = 0;
-            string obj_name;
+            const Vector2u pixel_pos(pixel_context.get_pixel_coords());
+
+            // Ignore samples outside the crop window.
+            if (!m_crop_window.contains(pixel_pos))
+                return;
+
+            const Entity* entity = nullptr;
 
             if (shading_point.hit_surface())
             {
                 switch (m_layer_type)
                 {
                   case CryptomatteAOV::CryptomatteType::ObjectNames:
-                    obj_name = shading_point.get_object().get_name();
+                    entity = &shading_point.get_object();
                     break;
 
                   case CryptomatteAOV::CryptomatteType::MaterialNames:
-                    {
-                      const auto* obj_material = shading_point.get_material();
-                      if (obj_material != nullptr)
-                          obj_name = obj_material->get_name();
-                    }
+                    entity = shading_point.get_material();
                     break;
 
                   assert_otherwise;
                 }
-
-                MurmurHash3_x86_32(reinterpret_cast<const unsigned char*>(obj_name.c_str()), static_cast<int>(obj_name.size()), 0, &m3hash);
             }
 
-            const Vector2u pixel_pos(pixel_context.get_pixel_coords());
-
-            // Ignore samples outside the crop window.
-            if (!m_crop_window.contains(pixel_pos))
-                return;
+            // Consecutive samples mostly hit the same entity: only hash names when it changes.
+            if (entity != m_last_entity)
+            {
+                m_last_entity = entity;
+                m_last_hash = 0;
 
-            m_tile_name_array[m_tile_index][m3hash] = obj_name;
+                if (entity != nullptr)
+                {
+                    const char* name = entity->get_name();
+                    const size_t name_length = strlen(name);
 
-            const size_t x = pixel_pos.x - m_tile_origin_x;
-            const size_t y = pixel_pos.y - m_tile_origin_y;
+                    MurmurHash3_x86_32(reinterpret_cast<const unsigned char*>(name), static_cast<int>(name_length), 0, &m_last_hash);
 
-            WeightMap& weight_map =
-                m_pixel_samples[(m_tile_origin_y + y) * m_frame_width + (m_tile_origin_x + x)];
+                    if (m_tile_names.find(m_last_hash) == m_tile_names.end())
+                        m_tile_names.insert(make_pair(m_last_hash, string(name, name_length)));
+                }
+            }
 
-            const float old_value = weight_map.get(m3hash);
-            weight_map.insert(m3hash, old_value + 1.0f);
+            m_coverage.add(
+                pixel_pos.x - m_tile_origin_x,
+                pixel_pos.y - m_tile_origin_y,
+                m_last_hash);
         }
 
       private:
+        size_t                          m_tile_x;
+        size_t                          m_tile_y;
         size_t                          m_tile_origin_x;
         size_t                          m_tile_origin_y;
         size_t                          m_tile_end_x;
         size_t                          m_tile_end_y;
-        size_t                          m_tile_index;
-        size_t                          m_frame_width;
         AABB2u                          m_crop_window;
         Image&                          m_aov_image;
-        size_t                          m_num_layers;
-        vector<WeightMap>&              m_pixel_samples;
-        NameMap*                        m_tile_name_array;
+        const size_t                    m_num_layers;
+        NameManifest&                   m_manifest;
         CryptomatteAOV::CryptomatteType m_layer_type;
+        CoverageTile                    m_coverage;
+        vector<float>                   m_pixel_values;
+        NameMap                         m_tile_names;
+        const Entity*                   m_last_entity;
+        uint32                          m_last_hash;
     };
 
     const char* CryptomatteObjectAOVModel = "cryptomatte_object_aov";
@@ -627,16 +634,10 @@ namespace
 
 struct CryptomatteAOV::Impl
 {
-    vector<WeightMap>                   m_pixel_samples;
-    NameMap*                            m_tile_name_array;
+    NameManifest                        m_manifest;
     unique_ptr<Image>                   m_image;
     size_t                              m_num_layers;
     CryptomatteAOV::CryptomatteType     m_layer_type;
-
-    Impl()
-      : m_tile_name_array(nullptr)
-    {
-    }
 };
 
 CryptomatteAOV::CryptomatteAOV(const ParamArray& params)
@@ -661,7 +662,6 @@ CryptomatteAOV::CryptomatteAOV(const ParamArray& params)
 
 CryptomatteAOV::~CryptomatteAOV()
 {
-    delete[] impl->m_tile_name_array;
     delete impl;
 }
 
@@ -708,9 +708,6 @@ void CryptomatteAOV::create_image(
             tile_height,
             num_channels,
             PixelFormatFloat));
-    impl->m_pixel_samples.resize(canvas_width * canvas_height, WeightMap(impl->m_num_layers));
-    const auto& image_props = impl->m_image->properties();
-    impl->m_tile_name_array = new NameMap[image_props.m_tile_count];
     clear_image();
 }
 
@@ -726,8 +723,7 @@ void CryptomatteAOV::clear_image()
             impl->m_image->set_pixel(rx, ry, pixel_values.data(), pixel_values.size());
     }
 
-    for (size_t i = 0, e = image_props.m_tile_count; i < e; ++i)
-        impl->m_tile_name_array[i].clear();
+    impl->m_manifest.m_names.clear();
 }
 
 auto_release_ptr<AOVAccumulator> CryptomatteAOV::create_accumulator() const
@@ -735,12 +731,17 @@ auto_release_ptr<AOVAccumulator> CryptomatteAOV::create_accumulator() const
     return auto_release_ptr<AOVAccumulator>(
         new CryptomatteAOVAccumulator(
             *impl->m_image,
-            impl->m_pixel_samples,
-            impl->m_tile_name_array,
+            impl->m_manifest,
             impl->m_num_layers,
             impl->m_layer_type));
 }
 
+bool CryptomatteAOV::supports_streaming() const
+{
+    // Cryptomatte images are written with their own layout and manifest.
+    return false;
+}
+
 bool CryptomatteAOV::write_images(
     const char*             file_path,
     const ImageAttributes&  image_attributes) const
@@ -783,25 +784,16 @@ bool CryptomatteAOV::write_images(
     image_attributes_copy.insert(layer_prefix + "/hash", "MurmurHash3_32");
     image_attributes_copy.insert(layer_prefix + "/name", layer_name);
 
-    NameMap name_map;
-    const auto& image_props = impl->m_image->properties();
-    for (size_t i = 0, e = image_props.m_tile_count; i < e; ++i)
-    {
-        const NameMap& tile_name_map = impl->m_tile_name_array[i];
-
-        for (const auto& hash : tile_name_map)
-        {
-            if (hash.first == 0)
-                continue;
-            name_map[hash.first] = hash.second;
-        }
-    }
+    const NameMap& name_map = impl->m_manifest.m_names;
 
     stringstream manifest_str;
     manifest_str << "{";
 
     for (const auto& hash : name_map)
     {
+        if (hash.first == 0)
+            continue;
+
         char hash_hex[9];
         sprintf(hash_hex, "%08x", hash.first);
         manifest_str << "\"" << hash.second << "\":\"" << hash_hex << "\",";
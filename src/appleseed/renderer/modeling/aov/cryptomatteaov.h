@@ -86,6 +86,8 @@ class CryptomatteAOV
 
     foundation::auto_release_ptr<AOVAccumulator> create_accumulator() const override;
 
+    bool supports_streaming() const override;
+
     bool write_images(
         const char*                         file_path,
         const foundation::ImageAttributes&  image_attributes) const override;
@@ -43,6 +43,7 @@
 #include "foundation/image/color.h"
 #include "foundation/image/image.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
@@ -57,8 +58,11 @@
 #include "boost/filesystem.hpp"
 
 // Standard headers.
+#include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <memory>
+#include <vector>
 
 using namespace bcd;
 using namespace foundation;
@@ -70,6 +74,301 @@ namespace renderer
 
 namespace
 {
+    //
+    // Compact storage for the per-pixel histograms of the denoiser.
+    //
+    // Bins are stored as 16-bit fixed-point numbers sharing one exponent per pixel
+    // and color channel: when a bin would overflow, all the bins of the channel are
+    // halved and the exponent is incremented. The precision of a bin is therefore
+    // relative to the largest bin of its channel, which is what the histogram
+    // distances of the denoiser are sensitive to. Storage is allocated one frame
+    // tile at a time, the first time a sample lands in the tile.
+    //
+
+    class CompactHistograms
+    {
+      public:
+        CompactHistograms()
+          : m_width(0)
+          , m_height(0)
+          , m_tile_width(1)
+          , m_tile_height(1)
+          , m_tile_count_x(0)
+          , m_num_bins(0)
+        {
+        }
+
+        void resize(
+            const size_t    width,
+            const size_t    height,
+            const size_t    tile_width,
+            const size_t    tile_height,
+            const size_t    num_bins)
+        {
+            m_width = width;
+            m_height = height;
+            m_tile_width = tile_width;
+            m_tile_height = tile_height;
+            m_tile_count_x = (width + tile_width - 1) / tile_width;
+            m_num_bins = num_bins;
+
+            m_tiles.clear();
+            m_tiles.resize(m_tile_count_x * ((height + tile_height - 1) / tile_height));
+        }
+
+        // Release the storage of all tiles.
+        void clear()
+        {
+            for (auto& tile : m_tiles)
+                tile.reset();
+        }
+
+        void copy_from(const CompactHistograms& source)
+        {
+            resize(
+                source.m_width,
+                source.m_height,
+                source.m_tile_width,
+                source.m_tile_height,
+                source.m_num_bins);
+
+            for (size_t i = 0, e = m_tiles.size(); i < e; ++i)
+            {
+                if (source.m_tiles[i])
+                    m_tiles[i].reset(new Tile(*source.m_tiles[i]));
+            }
+        }
+
+        size_t get_width() const
+        {
+            return m_width;
+        }
+
+        size_t get_height() const
+        {
+            return m_height;
+        }
+
+        // Allocate the storage of a frame tile. Once allocated, a tile may be
+        // accumulated into by a single thread without synchronization.
+        void create_tile(const size_t tile_x, const size_t tile_y)
+        {
+            std::unique_ptr<Tile>& tile = m_tiles[tile_y * m_tile_count_x + tile_x];
+
+            if (!tile)
+            {
+                const size_t pixel_count = m_tile_width * m_tile_height;
+                tile.reset(new Tile());
+                tile->m_bins.assign(pixel_count * 3 * m_num_bins, 0);
+                tile->m_exponents.assign(pixel_count * 3, 0);
+                tile->m_sample_counts.assign(pixel_count, 0.0f);
+            }
+        }
+
+        void add_sample_count(
+            const size_t    x,
+            const size_t    y,
+            const float     count)
+        {
+            size_t pixel_index;
+            Tile& tile = fetch_tile(x, y, pixel_index);
+            tile.m_sample_counts[pixel_index] += count;
+        }
+
+        void add(
+            const size_t    x,
+            const size_t    y,
+            const size_t    channel,
+            const size_t    bin,
+            const float     weight)
+        {
+            if (!(weight > 0.0f))
+                return;
+
+            size_t pixel_index;
+            Tile& tile = fetch_tile(x, y, pixel_index);
+
+            uint16* bins = &tile.m_bins[(pixel_index * 3 + channel) * m_num_bins];
+            uint8& exponent = tile.m_exponents[pixel_index * 3 + channel];
+
+            while (true)
+            {
+                const float q = ldexp(weight, FractionBits - exponent) + 0.5f;
+
+                if (bins[bin] + q < 65536.0f)
+                {
+                    bins[bin] += static_cast<uint16>(q);
+                    break;
+                }
+
+                // Halve the bins of the channel to make room for the new weight.
+                assert(exponent < 255);
+                for (size_t i = 0; i < m_num_bins; ++i)
+                    bins[i] = static_cast<uint16>((bins[i] + 1) >> 1);
+                ++exponent;
+            }
+        }
+
+        float get_sample_count(const size_t x, const size_t y) const
+        {
+            size_t pixel_index;
+            const Tile* tile = find_tile(x, y, pixel_index);
+            return tile ? tile->m_sample_counts[pixel_index] : 0.0f;
+        }
+
+        // Decode the bins of a pixel into num_bins * 3 values.
+        void get_bins(const size_t x, const size_t y, float* values) const
+        {
+            size_t pixel_index;
+            const Tile* tile = find_tile(x, y, pixel_index);
+
+            if (tile == nullptr)
+            {
+                for (size_t i = 0; i < 3 * m_num_bins; ++i)
+                    values[i] = 0.0f;
+                return;
+            }
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+                const uint16* bins = &tile->m_bins[(pixel_index * 3 + c) * m_num_bins];
+                const float scale = ldexp(1.0f, tile->m_exponents[pixel_index * 3 + c] - FractionBits);
+
+                for (size_t i = 0; i < m_num_bins; ++i)
+                    values[c * m_num_bins + i] = bins[i] * scale;
+            }
+        }
+
+      private:
+        // Number of fractional bits of the bins of a channel whose exponent is zero.
+        static const int FractionBits = 10;
+
+        struct Tile
+        {
+            std::vector<uint16>     m_bins;
+            std::vector<uint8>      m_exponents;
+            std::vector<float>      m_sample_counts;
+        };
+
+        size_t                      m_width;
+        size_t                      m_height;
+        size_t                      m_tile_width;
+        size_t                      m_tile_height;
+        size_t                      m_tile_count_x;
+        size_t                      m_num_bins;
+        std::vector<std::unique_ptr<Tile>> m_tiles;
+
+        size_t get_tile_index(const size_t x, const size_t y, size_t& pixel_index) const
+        {
+            assert(x < m_width);
+            assert(y < m_height);
+
+            pixel_index = (y % m_tile_height) * m_tile_width + x % m_tile_width;
+            return (y / m_tile_height) * m_tile_count_x + x / m_tile_width;
+        }
+
+        Tile& fetch_tile(const size_t x, const size_t y, size_t& pixel_index)
+        {
+            const size_t tile_index = get_tile_index(x, y, pixel_index);
+
+            if (!m_tiles[tile_index])
+                create_tile(tile_index % m_tile_count_x, tile_index / m_tile_count_x);
+
+            return *m_tiles[tile_index];
+        }
+
+        const Tile* find_tile(const size_t x, const size_t y, size_t& pixel_index) const
+        {
+            return m_tiles[get_tile_index(x, y, pixel_index)].get();
+        }
+    };
+
+    // Accumulate an unpremultiplied sample into the statistics used by the denoiser.
+    void accumulate_sample(
+        const Vector2i&     pi,
+        const Color4f&      sample,
+        const size_t        num_bins,
+        const float         gamma,
+        const float         rcp_gamma,
+        const float         max_value,
+        Deepimf&            sum_accum,
+        Deepimf&            covariance_accum,
+        CompactHistograms&  histograms)
+    {
+        const size_t x = static_cast<size_t>(pi.x);
+        const size_t y = static_cast<size_t>(pi.y);
+
+        // Update the num samples channel.
+        histograms.add_sample_count(x, y, 1.0f);
+
+        // Update the sum and covariance accumulator.
+        sum_accum.get(pi.y, pi.x, 0) += sample.r;
+        sum_accum.get(pi.y, pi.x, 1) += sample.g;
+        sum_accum.get(pi.y, pi.x, 2) += sample.b;
+
+        const size_t c_xx = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xx);
+        const size_t c_yy = static_cast<size_t>(ESymmetricMatrix3x3Data::e_yy);
+        const size_t c_zz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_zz);
+        const size_t c_yz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_yz);
+        const size_t c_xz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xz);
+        const size_t c_xy = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xy);
+
+        covariance_accum.get(pi.y, pi.x, c_xx) += sample.r * sample.r;
+        covariance_accum.get(pi.y, pi.x, c_yy) += sample.g * sample.g;
+        covariance_accum.get(pi.y, pi.x, c_zz) += sample.b * sample.b;
+        covariance_accum.get(pi.y, pi.x, c_yz) += sample.g * sample.b;
+        covariance_accum.get(pi.y, pi.x, c_xz) += sample.r * sample.b;
+        covariance_accum.get(pi.y, pi.x, c_xy) += sample.r * sample.g;
+
+        // Fill histogram: code from BCD's SampleAccumulator class.
+        for (size_t c = 0; c < 3; ++c)
+        {
+            float value = sample[c];
+
+            // Clamp to 0.
+            value = max(value, 0.0f);
+
+            // Exponential scaling.
+            if (gamma > 1.0f) value = pow(value, rcp_gamma);
+
+            // Normalize to the maximum value.
+            if (max_value > 0.0f)
+                value /= max_value;
+
+            // Used for determining the weight to give to the sample
+            // in the highest two bins, when the sample is saturated.
+            const float sature_level_gamma = 2.0f;
+            value = min(value, sature_level_gamma);
+
+            const float bin_float_index = value * (num_bins - 2);
+
+            size_t floor_bin_index = truncate<size_t>(bin_float_index);
+            size_t ceil_bin_index;
+
+            float floor_bin_weight;
+            float ceil_bin_weight;
+
+            if (floor_bin_index < num_bins - 2)
+            {
+                // In bounds.
+                ceil_bin_index = floor_bin_index + 1;
+                ceil_bin_weight = bin_float_index - floor_bin_index;
+                floor_bin_weight = 1.0f - ceil_bin_weight;
+            }
+            else
+            {
+                // Out of bounds... v >= 1.
+                floor_bin_index = num_bins - 2;
+                ceil_bin_index = floor_bin_index + 1;
+                ceil_bin_weight = (value - 1.0f) / (sature_level_gamma - 1.f);
+                floor_bin_weight = 1.0f - ceil_bin_weight;
+            }
+
+            histograms.add(x, y, c, floor_bin_index, floor_bin_weight);
+            histograms.add(x, y, c, ceil_bin_index, ceil_bin_weight);
+        }
+    }
+
     //
     // Denoiser AOV accumulator.
     //
@@ -84,18 +383,22 @@ namespace
             const float    max_value,
             Deepimf&       sum_accum,
             Deepimf&       covariance_accum,
-            Deepimf&       histograms)
+            CompactHistograms& histograms)
           : m_num_bins(num_bins)
           , m_gamma(gamma)
           , m_rcp_gamma(1.0f / gamma)
           , m_max_value(max_value)
-          , m_samples_channel_index(3 * num_bins)
           , m_sum_accum(sum_accum)
           , m_covariance_accum(covariance_accum)
           , m_histograms(histograms)
         {
         }
 
+        int get_events() const override
+        {
+            return TileEvents | SampleEvents | WriteEvents;
+        }
+
         void on_tile_begin(
             const Frame&                frame,
             const size_t                tile_x,
@@ -111,6 +414,9 @@ namespace
             m_tile_origin_y = static_cast<int>(tile_y * props.m_tile_height);
             m_tile_end_x = static_cast<int>(m_tile_origin_x + tile.get_width() - 1);
             m_tile_end_y = static_cast<int>(m_tile_origin_y + tile.get_height() - 1);
+
+            // Allocate the histograms of the tile from the thread that renders it.
+            m_histograms.create_tile(tile_x, tile_y);
         }
 
         void on_sample_begin(
@@ -135,84 +441,16 @@ namespace
 
             // Accumulate unpremultiplied samples.
             m_accum.unpremultiply_in_place();
-
-            // Update the num samples channel.
-            m_histograms.get(pi.y, pi.x, static_cast<int>(m_samples_channel_index)) += 1.0f;
-
-            // Update the sum and covariance accumulator.
-            m_sum_accum.get(pi.y, pi.x, 0) += m_accum.r;
-            m_sum_accum.get(pi.y, pi.x, 1) += m_accum.g;
-            m_sum_accum.get(pi.y, pi.x, 2) += m_accum.b;
-
-            const size_t c_xx = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xx);
-            const size_t c_yy = static_cast<size_t>(ESymmetricMatrix3x3Data::e_yy);
-            const size_t c_zz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_zz);
-            const size_t c_yz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_yz);
-            const size_t c_xz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xz);
-            const size_t c_xy = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xy);
-
-            m_covariance_accum.get(pi.y, pi.x, c_xx) += m_accum.r * m_accum.r;
-            m_covariance_accum.get(pi.y, pi.x, c_yy) += m_accum.g * m_accum.g;
-            m_covariance_accum.get(pi.y, pi.x, c_zz) += m_accum.b * m_accum.b;
-            m_covariance_accum.get(pi.y, pi.x, c_yz) += m_accum.g * m_accum.b;
-            m_covariance_accum.get(pi.y, pi.x, c_xz) += m_accum.r * m_accum.b;
-            m_covariance_accum.get(pi.y, pi.x, c_xy) += m_accum.r * m_accum.g;
-
-            // Fill histogram: code from BCD's SampleAccumulator class.
-            for (size_t c = 0; c < 3; ++c)
-            {
-                const size_t start_bin = c * m_num_bins;
-                float value = m_accum[c];
-
-                // Clamp to 0.
-                value = max(value, 0.0f);
-
-                // Exponential scaling.
-                if (m_gamma > 1.0f) value = pow(value, m_rcp_gamma);
-
-                // Normalize to the maximum value.
-                if (m_max_value > 0.0f)
-                    value /= m_max_value;
-
-                // Used for determining the weight to give to the sample
-                // in the highest two bins, when the sample is saturated.
-                const float sature_level_gamma = 2.0f;
-                value = min(value, sature_level_gamma);
-
-                const float bin_float_index = value * (m_num_bins - 2);
-
-                size_t floor_bin_index = truncate<size_t>(bin_float_index);
-                size_t ceil_bin_index;
-
-                float floor_bin_weight;
-                float ceil_bin_weight;
-
-                if (floor_bin_index < m_num_bins - 2)
-                {
-                    // In bounds.
-                    ceil_bin_index = floor_bin_index + 1;
-                    ceil_bin_weight = bin_float_index - floor_bin_index;
-                    floor_bin_weight = 1.0f - ceil_bin_weight;
-                }
-                else
-                {
-                    // Out of bounds... v >= 1.
-                    floor_bin_index = m_num_bins - 2;
-                    ceil_bin_index = floor_bin_index + 1;
-                    ceil_bin_weight = (value - 1.0f) / (sature_level_gamma - 1.f);
-                    floor_bin_weight = 1.0f - ceil_bin_weight;
-                }
-
-                m_histograms.get(
-                    pi.y,
-                    pi.x,
-                    static_cast<int>(start_bin + floor_bin_index)) += floor_bin_weight;
-
-                m_histograms.get(
-                    pi.y,
-                    pi.x,
-                    static_cast<int>(start_bin + ceil_bin_index)) += ceil_bin_weight;
-            }
+            accumulate_sample(
+                pi,
+                m_accum,
+                m_num_bins,
+                m_gamma,
+                m_rcp_gamma,
+                m_max_value,
+                m_sum_accum,
+                m_covariance_accum,
+                m_histograms);
         }
 
         void write(
@@ -240,7 +478,6 @@ namespace
         const float     m_gamma;
         const float     m_rcp_gamma;
         const float     m_max_value;
-        const size_t    m_samples_channel_index;
 
         int             m_tile_origin_x;
         int             m_tile_origin_y;
@@ -250,7 +487,7 @@ namespace
         Deepimf&        m_sum_accum;
         Deepimf&        m_covariance_accum;
 
-        Deepimf&        m_histograms;
+        CompactHistograms& m_histograms;
 
         bool outside_tile(const Vector2i& pi) const
         {
@@ -279,7 +516,7 @@ struct DenoiserAOV::Impl
     Deepimf m_sum_accum;
     Deepimf m_covariance_accum;
 
-    Deepimf m_histograms;
+    CompactHistograms m_histograms;
 };
 
 DenoiserAOV::DenoiserAOV(
@@ -327,11 +564,15 @@ void DenoiserAOV::create_image(
 {
     const int w = static_cast<int>(canvas_width);
     const int h = static_cast<int>(canvas_height);
-    const int bins = static_cast<int>(impl->m_num_bins);
 
     impl->m_sum_accum.resize(w, h, 3);
     impl->m_covariance_accum.resize(w, h, 6);
-    impl->m_histograms.resize(w, h, 3 * bins + 1);
+    impl->m_histograms.resize(
+        canvas_width,
+        canvas_height,
+        tile_width,
+        tile_height,
+        impl->m_num_bins);
 
     clear_image();
 }
@@ -340,43 +581,123 @@ void DenoiserAOV::clear_image()
 {
     impl->m_sum_accum.fill(0.0f);
     impl->m_covariance_accum.fill(0.0f);
-    impl->m_histograms.fill(0.0f);
+    impl->m_histograms.clear();
+}
+
+void DenoiserAOV::store_sample(
+    const Vector2i&         pi,
+    const Color4f&          color)
+{
+    accumulate_sample(
+        pi,
+        color.unpremultiplied(),
+        impl->m_num_bins,
+        impl->m_gamma,
+        1.0f / impl->m_gamma,
+        impl->m_max_value,
+        impl->m_sum_accum,
+        impl->m_covariance_accum,
+        impl->m_histograms);
 }
 
-void DenoiserAOV::fill_empty_samples() const
+void DenoiserAOV::copy_statistics_from(const DenoiserAOV& source)
 {
-    const int w = impl->m_histograms.getWidth();
-    const int h = impl->m_histograms.getHeight();
+    impl->m_num_bins = source.impl->m_num_bins;
+    impl->m_max_value = source.impl->m_max_value;
+    impl->m_gamma = source.impl->m_gamma;
+
+    impl->m_sum_accum = source.impl->m_sum_accum;
+    impl->m_covariance_accum = source.impl->m_covariance_accum;
+    impl->m_histograms.copy_from(source.impl->m_histograms);
+}
+
+size_t DenoiserAOV::get_histograms_channel_count() const
+{
+    return 3 * impl->m_num_bins + 1;
+}
+
+void DenoiserAOV::extract_histograms_image(Deepimf& histograms_image) const
+{
+    const int w = static_cast<int>(impl->m_histograms.get_width());
+    const int h = static_cast<int>(impl->m_histograms.get_height());
 
     const int num_bins = static_cast<int>(impl->m_num_bins);
     const int samples_channel_index = num_bins * 3;
 
+    histograms_image.resize(w, h, samples_channel_index + 1);
+
     for (int y = 0; y < h; ++y)
     {
         for (int x = 0; x < w; ++x)
         {
-            const float num_samples =
-                impl->m_histograms.get(y, x, samples_channel_index);
+            const float num_samples = impl->m_histograms.get_sample_count(x, y);
 
             if (num_samples == 0.0f)
             {
-                impl->m_histograms.get(y, x, 0) = 1.0f;
-                impl->m_histograms.get(y, x, num_bins) = 1.0f;
-                impl->m_histograms.get(y, x, num_bins * 2) = 1.0f;
-                impl->m_histograms.get(y, x, samples_channel_index) = 1.0f;
+                // The denoiser expects at least one sample per pixel.
+                for (int c = 0; c < samples_channel_index; ++c)
+                    histograms_image.get(y, x, c) = 0.0f;
+
+                histograms_image.get(y, x, 0) = 1.0f;
+                histograms_image.get(y, x, num_bins) = 1.0f;
+                histograms_image.get(y, x, num_bins * 2) = 1.0f;
+                histograms_image.get(y, x, samples_channel_index) = 1.0f;
+            }
+            else
+            {
+                impl->m_histograms.get_bins(x, y, &histograms_image.get(y, x, 0));
+                histograms_image.get(y, x, samples_channel_index) = num_samples;
             }
         }
     }
 }
 
-const Deepimf& DenoiserAOV::histograms_image() const
+bool DenoiserAOV::add_histograms_image(const Deepimf& histograms_image)
 {
-    return impl->m_histograms;
+    const int w = static_cast<int>(impl->m_histograms.get_width());
+    const int h = static_cast<int>(impl->m_histograms.get_height());
+
+    const size_t num_bins = impl->m_num_bins;
+    const int samples_channel_index = static_cast<int>(num_bins * 3);
+
+    if (histograms_image.getWidth() != w ||
+        histograms_image.getHeight() != h ||
+        histograms_image.getDepth() != samples_channel_index + 1)
+        return false;
+
+    for (int y = 0; y < h; ++y)
+    {
+        for (int x = 0; x < w; ++x)
+        {
+            const float num_samples = histograms_image.get(y, x, samples_channel_index);
+
+            if (num_samples == 0.0f)
+                continue;
+
+            impl->m_histograms.add_sample_count(x, y, num_samples);
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+                for (size_t i = 0; i < num_bins; ++i)
+                {
+                    impl->m_histograms.add(
+                        x,
+                        y,
+                        c,
+                        i,
+                        histograms_image.get(y, x, static_cast<int>(c * num_bins + i)));
+                }
+            }
+        }
+    }
+
+    return true;
 }
 
-Deepimf& DenoiserAOV::histograms_image()
+bool DenoiserAOV::set_histograms_image(const Deepimf& histograms_image)
 {
-    return impl->m_histograms;
+    impl->m_histograms.clear();
+    return add_histograms_image(histograms_image);
 }
 
 const Deepimf& DenoiserAOV::covariance_image() const
@@ -401,16 +722,19 @@ Deepimf& DenoiserAOV::sum_image()
 
 void DenoiserAOV::extract_num_samples_image(bcd::Deepimf& num_samples_image) const
 {
-    const int w = impl->m_histograms.getWidth();
-    const int h = impl->m_histograms.getHeight();
-    const int samples_channel_index = static_cast<int>(impl->m_num_bins * 3);
+    const int w = static_cast<int>(impl->m_histograms.get_width());
+    const int h = static_cast<int>(impl->m_histograms.get_height());
 
     num_samples_image.resize(w, h, 1);
 
     for (int y = 0; y < h; ++y)
     {
         for (int x = 0; x < w; ++x)
-            num_samples_image.get(y, x, 0) = impl->m_histograms.get(y, x, samples_channel_index);
+        {
+            // Pixels without samples are reported as having one, as the denoiser expects.
+            const float num_samples = impl->m_histograms.get_sample_count(x, y);
+            num_samples_image.get(y, x, 0) = num_samples == 0.0f ? 1.0f : num_samples;
+        }
     }
 }
 
@@ -422,8 +746,6 @@ void DenoiserAOV::compute_covariances_image(Deepimf& covariances_image) const
     covariances_image.resize(w, h, 6);
     covariances_image.fill(0.0f);
 
-    const int samples_channel_index = static_cast<int>(impl->m_num_bins * 3);
-
     const size_t c_xx = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xx);
     const size_t c_yy = static_cast<size_t>(ESymmetricMatrix3x3Data::e_yy);
     const size_t c_zz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_zz);
@@ -435,7 +757,7 @@ void DenoiserAOV::compute_covariances_image(Deepimf& covariances_image) const
     {
         for (int x = 0; x < w; ++x)
         {
-            const float sample_count = impl->m_histograms.get(y, x, samples_channel_index);
+            const float sample_count = impl->m_histograms.get_sample_count(x, y);
 
             if (sample_count != 0.0f)
             {
@@ -473,8 +795,6 @@ bool DenoiserAOV::write_images(
     const char*             file_path,
     const ImageAttributes&  image_attributes) const
 {
-    fill_empty_samples();
-
     const bf::path boost_file_path(file_path);
     const bf::path directory = boost_file_path.parent_path();
     const string base_file_name = boost_file_path.stem().string();
@@ -486,9 +806,11 @@ bool DenoiserAOV::write_images(
 
     // Write histograms.
     stopwatch.start();
+    Deepimf histograms_image;
+    extract_histograms_image(histograms_image);
     const string hist_file_name = base_file_name + ".hist" + extension;
     const string hist_file_path = (directory / hist_file_name).string();
-    if (ImageIO::writeMultiChannelsEXR(histograms_image(), hist_file_path.c_str()))
+    if (ImageIO::writeMultiChannelsEXR(histograms_image, hist_file_path.c_str()))
     {
         stopwatch.measure();
         RENDERER_LOG_INFO(
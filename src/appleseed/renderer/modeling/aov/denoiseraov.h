@@ -32,6 +32,8 @@
 #include "renderer/modeling/aov/aov.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/vector.h"
 #include "foundation/utility/autoreleaseptr.h"
 
 // BCD headers.
@@ -75,10 +77,23 @@ class DenoiserAOV
 
     void clear_image() override;
 
-    void fill_empty_samples() const;
+    // Accumulate a single premultiplied sample landing in a given pixel. Not thread-safe.
+    void store_sample(
+        const foundation::Vector2i&     pi,
+        const foundation::Color4f&      color);
 
-    const bcd::Deepimf& histograms_image() const;
-    bcd::Deepimf& histograms_image();
+    // Copy the accumulated statistics of another denoiser AOV.
+    void copy_statistics_from(const DenoiserAOV& source);
+
+    // Histograms are stored in a compact form and are only expanded to a deep image
+    // (3 * num_bins bins plus the sample count per pixel) on demand. Pixels without
+    // samples are expanded as if they had received a single black sample.
+    size_t get_histograms_channel_count() const;
+    void extract_histograms_image(bcd::Deepimf& histograms_image) const;
+
+    // Replace or add to the histograms. Return false if the dimensions don't match.
+    bool set_histograms_image(const bcd::Deepimf& histograms_image);
+    bool add_histograms_image(const bcd::Deepimf& histograms_image);
 
     const bcd::Deepimf& covariance_image() const;
     bcd::Deepimf& covariance_image();
@@ -85,22 +85,21 @@ namespace
             if (!m_cropped_tile_bbox.contains(pi))
                 return;
 
-            float* out =
-                reinterpret_cast<float*>(
-                    m_tile->pixel(
-                        pi.x - m_tile_origin_x,
-                        pi.y - m_tile_origin_y));
+            float depth = 0.0f;
 
             if (shading_point.hit_surface())
             {
                 shading_result.m_aovs[0].a = 1.0f;
-                *out = static_cast<float>(shading_point.get_distance());
-            }
-            else
-            {
-                shading_result.m_aovs[0].a = 0.0f;
-                *out = 0.0f;
+                depth = static_cast<float>(shading_point.get_distance());
             }
+            else shading_result.m_aovs[0].a = 0.0f;
+
+            // Convert to the storage format of the AOV image.
+            m_tile->set_component(
+                pi.x - m_tile_origin_x,
+                pi.y - m_tile_origin_y,
+                0,
+                depth);
         }
     };
 
@@ -66,6 +66,11 @@ namespace
         {
         }
 
+        int get_events() const override
+        {
+            return WriteEvents;
+        }
+
         void write(
             const PixelContext&         pixel_context,
             const ShadingPoint&         shading_point,
@@ -98,6 +103,11 @@ namespace
         {
         }
 
+        int get_events() const override
+        {
+            return WriteEvents;
+        }
+
         void write(
             const PixelContext&         pixel_context,
             const ShadingPoint&         shading_point,
@@ -129,6 +139,11 @@ namespace
         {
         }
 
+        int get_events() const override
+        {
+            return WriteEvents;
+        }
+
         void write(
             const PixelContext&         pixel_context,
             const ShadingPoint&         shading_point,
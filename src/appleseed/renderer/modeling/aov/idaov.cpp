@@ -0,0 +1,189 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "idaov.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/aov/aovaccumulator.h"
+#include "renderer/kernel/rendering/pixelcontext.h"
+#include "renderer/kernel/shading/shadingpoint.h"
+#include "renderer/modeling/aov/aov.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/scene/objectinstance.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/api/specializedapiarrays.h"
+#include "foundation/utility/containers/dictionary.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // ID AOV accumulator.
+    //
+
+    class IDAOVAccumulator
+      : public UnfilteredAOVAccumulator
+    {
+      public:
+        explicit IDAOVAccumulator(Image& image)
+          : UnfilteredAOVAccumulator(image)
+        {
+        }
+
+        void write(
+            const PixelContext&         pixel_context,
+            const ShadingPoint&         shading_point,
+            const ShadingComponents&    shading_components,
+            const AOVComponents&        aov_components,
+            ShadingResult&              shading_result) override
+        {
+            const Vector2i& pi = pixel_context.get_pixel_coords();
+
+            // Ignore samples outside the tile.
+            if (!m_cropped_tile_bbox.contains(pi))
+                return;
+
+            Color<float, 2> ids(IDAOVNoneValue);
+
+            if (shading_point.hit_surface())
+            {
+                ids[0] = uid_to_id_aov_value(shading_point.get_object_instance().get_uid());
+
+                const Material* material = shading_point.get_material();
+                if (material)
+                    ids[1] = uid_to_id_aov_value(material->get_uid());
+            }
+
+            m_tile->set_pixel(
+                pi.x - m_tile_origin_x,
+                pi.y - m_tile_origin_y,
+                ids);
+        }
+    };
+
+
+    //
+    // ID AOV.
+    //
+
+    const char* IDAOVModel = "id_aov";
+
+    class IDAOV
+      : public UnfilteredAOV
+    {
+      public:
+        explicit IDAOV(const ParamArray& params)
+          : UnfilteredAOV("id", params)
+        {
+        }
+
+        void release() override
+        {
+            delete this;
+        }
+
+        const char* get_model() const override
+        {
+            return IDAOVModel;
+        }
+
+        size_t get_channel_count() const override
+        {
+            return 2;
+        }
+
+        const char** get_channel_names() const override
+        {
+            static const char* ChannelNames[] = { "ObjectInstanceID", "MaterialID" };
+            return ChannelNames;
+        }
+
+        void clear_image() override
+        {
+            m_image->clear(Color<float, 2>(IDAOVUnknownValue));
+        }
+
+      private:
+        auto_release_ptr<AOVAccumulator> create_accumulator() const override
+        {
+            return auto_release_ptr<AOVAccumulator>(
+                new IDAOVAccumulator(get_image()));
+        }
+    };
+}
+
+
+//
+// IDAOVFactory class implementation.
+//
+
+void IDAOVFactory::release()
+{
+    delete this;
+}
+
+const char* IDAOVFactory::get_model() const
+{
+    return IDAOVModel;
+}
+
+Dictionary IDAOVFactory::get_model_metadata() const
+{
+    return
+        Dictionary()
+            .insert("name", get_model())
+            .insert("label", "ID")
+            .insert("default_model", "false");
+}
+
+DictionaryArray IDAOVFactory::get_input_metadata() const
+{
+    DictionaryArray metadata;
+    return metadata;
+}
+
+auto_release_ptr<AOV> IDAOVFactory::create(const ParamArray& params) const
+{
+    return auto_release_ptr<AOV>(new IDAOV(params));
+}
+
+}   // namespace renderer
@@ -0,0 +1,115 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/modeling/aov/iaovfactory.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/uid.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cassert>
+
+// Forward declarations.
+namespace foundation    { class Dictionary; }
+namespace foundation    { class DictionaryArray; }
+namespace renderer      { class AOV; }
+namespace renderer      { class ParamArray; }
+
+namespace renderer
+{
+
+//
+// The ID AOV stores, for each pixel, the unique IDs of the object instance and of
+// the material seen through the pixel. Unique IDs are stored as exact floating-point
+// integers offset by IDAOVFirstValue: a value of IDAOVUnknownValue means that the
+// pixel was not rendered yet or that the unique ID is too large to be represented,
+// a value of IDAOVNoneValue means that nothing was hit.
+//
+
+const float IDAOVUnknownValue = 0.0f;
+const float IDAOVNoneValue = 1.0f;
+const float IDAOVFirstValue = 2.0f;
+
+float uid_to_id_aov_value(const foundation::UniqueID uid);
+foundation::UniqueID id_aov_value_to_uid(const float value);
+
+
+//
+// A factory for ID AOVs.
+//
+
+class APPLESEED_DLLSYMBOL IDAOVFactory
+  : public IAOVFactory
+{
+  public:
+    // Delete this instance.
+    void release() override;
+
+    // Return a string identifying this AOV model.
+    const char* get_model() const override;
+
+    // Return metadata for this AOV model.
+    foundation::Dictionary get_model_metadata() const override;
+
+    // Return metadata for the inputs of this AOV model.
+    foundation::DictionaryArray get_input_metadata() const override;
+
+    // Create a new AOV instance.
+    foundation::auto_release_ptr<AOV> create(const ParamArray& params) const override;
+};
+
+
+//
+// Implementation.
+//
+
+inline float uid_to_id_aov_value(const foundation::UniqueID uid)
+{
+    // Largest integer such that all integers up to it are exactly representable as floats.
+    const foundation::UniqueID MaxExactInteger = 1 << 24;
+
+    return
+        uid < MaxExactInteger - static_cast<foundation::UniqueID>(IDAOVFirstValue)
+            ? static_cast<float>(uid) + IDAOVFirstValue
+            : IDAOVUnknownValue;
+}
+
+inline foundation::UniqueID id_aov_value_to_uid(const float value)
+{
+    assert(value >= IDAOVFirstValue);
+    return static_cast<foundation::UniqueID>(value - IDAOVFirstValue);
+}
+
+}   // namespace renderer
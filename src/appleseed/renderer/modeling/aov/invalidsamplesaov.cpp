@@ -76,6 +76,11 @@ namespace
         {
         }
 
+        int get_events() const override
+        {
+            return TileEvents | PixelEvents | WriteEvents;
+        }
+
         void on_pixel_begin(const Vector2i& pi) override
         {
             UnfilteredAOVAccumulator::on_pixel_begin(pi);
@@ -147,6 +152,12 @@ namespace
             return InvalidSamplesAOVModel;
         }
 
+        bool supports_streaming() const override
+        {
+            // Post-processing needs the whole image.
+            return false;
+        }
+
         void post_process_image(const Frame& frame) override
         {
             const AABB2u& crop_window = frame.get_crop_window();
@@ -81,25 +81,21 @@ namespace
             if (!m_cropped_tile_bbox.contains(pi))
                 return;
 
-            float* out =
-                reinterpret_cast<float*>(
-                    m_tile->pixel(
-                        pi.x - m_tile_origin_x,
-                        pi.y - m_tile_origin_y));
+            Color3f normal(0.5f);
 
             if (shading_point.hit_surface())
             {
-                const Vector3d& n = shading_point.get_shading_normal();
-                out[0] = static_cast<float>(n[0]) * 0.5f + 0.5f;
-                out[1] = static_cast<float>(n[1]) * 0.5f + 0.5f;
-                out[2] = static_cast<float>(n[2]) * 0.5f + 0.5f;
-            }
-            else
-            {
-                out[0] = 0.5f;
-                out[1] = 0.5f;
-                out[2] = 0.5f;
+                const SVector3& n = shading_point.get_shading_normal();
+                normal[0] = static_cast<float>(n[0]) * 0.5f + 0.5f;
+                normal[1] = static_cast<float>(n[1]) * 0.5f + 0.5f;
+                normal[2] = static_cast<float>(n[2]) * 0.5f + 0.5f;
             }
+
+            // Convert to the storage format of the AOV image.
+            m_tile->set_pixel(
+                pi.x - m_tile_origin_x,
+                pi.y - m_tile_origin_y,
+                normal);
         }
     };
 
@@ -134,6 +130,13 @@ namespace
             m_image->clear(Color3f(0.5f));
         }
 
+      protected:
+        PixelFormat get_default_storage_format() const override
+        {
+            // Encoded normals are in [0, 1], half floats are precise enough.
+            return PixelFormatHalf;
+        }
+
       private:
         auto_release_ptr<AOVAccumulator> create_accumulator() const override
         {
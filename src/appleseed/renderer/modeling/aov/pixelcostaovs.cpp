@@ -0,0 +1,316 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "pixelcostaovs.h"
+
+// appleseed.renderer headers.
+#include "renderer/kernel/aov/aovaccumulator.h"
+#include "renderer/kernel/rendering/renderingcounters.h"
+#include "renderer/modeling/aov/aov.h"
+#include "renderer/modeling/frame/frame.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/image/colormap.h"
+#include "foundation/image/colormapdata.h"
+#include "foundation/image/image.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/aabb.h"
+#include "foundation/utility/api/specializedapiarrays.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/countof.h"
+
+// Standard headers.
+#include <cstddef>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    //
+    // Pixel cost AOV accumulator.
+    //
+    // Samples the rendering counters of the calling thread at the beginning and at
+    // the end of each pixel and adds the difference to the AOV image. Costs add up
+    // over multiple rendering passes.
+    //
+
+    enum PixelCost
+    {
+        PixelCostRays,
+        PixelCostTraversalSteps,
+        PixelCostTextureFetches
+    };
+
+    class PixelCostAOVAccumulator
+      : public UnfilteredAOVAccumulator
+    {
+      public:
+        PixelCostAOVAccumulator(Image& image, const PixelCost cost)
+          : UnfilteredAOVAccumulator(image)
+          , m_cost(cost)
+        {
+        }
+
+        int get_events() const override
+        {
+            return TileEvents | PixelEvents;
+        }
+
+        void on_pixel_begin(const Vector2i& pi) override
+        {
+            UnfilteredAOVAccumulator::on_pixel_begin(pi);
+
+            m_counters_at_pixel_begin = RenderingCounters::current();
+        }
+
+        void on_pixel_end(const Vector2i& pi) override
+        {
+            if (m_cropped_tile_bbox.contains(pi))
+            {
+                const RenderingCounters pixel_counters =
+                    RenderingCounters::current() - m_counters_at_pixel_begin;
+
+                const size_t x = pi.x - m_tile_origin_x;
+                const size_t y = pi.y - m_tile_origin_y;
+
+                switch (m_cost)
+                {
+                  case PixelCostRays:
+                    add(x, y, 0, pixel_counters.m_ray_count);
+                    break;
+
+                  case PixelCostTraversalSteps:
+                    add(x, y, 0, pixel_counters.m_traversal_step_count);
+                    break;
+
+                  case PixelCostTextureFetches:
+                    add(x, y, 0, pixel_counters.m_texture_cache_miss_count);
+                    add(x, y, 1, pixel_counters.m_texture_load_count);
+                    break;
+                }
+            }
+
+            UnfilteredAOVAccumulator::on_pixel_end(pi);
+        }
+
+      private:
+        const PixelCost     m_cost;
+        RenderingCounters   m_counters_at_pixel_begin;
+
+        void add(const size_t x, const size_t y, const size_t c, const uint64 value)
+        {
+            m_tile->set_component(
+                x,
+                y,
+                c,
+                m_tile->get_component<float>(x, y, c) + static_cast<float>(value));
+        }
+    };
+
+
+    //
+    // Pixel cost AOV.
+    //
+
+    class PixelCostAOV
+      : public UnfilteredAOV
+    {
+      public:
+        PixelCostAOV(
+            const char*         name,
+            const char*         model,
+            const PixelCost     cost,
+            const ParamArray&   params)
+          : UnfilteredAOV(name, params)
+          , m_model(model)
+          , m_cost(cost)
+        {
+        }
+
+        void release() override
+        {
+            delete this;
+        }
+
+        const char* get_model() const override
+        {
+            return m_model;
+        }
+
+        bool supports_streaming() const override
+        {
+            // Heat maps are computed from the whole image, raw counts can be streamed.
+            return m_cost == PixelCostTextureFetches;
+        }
+
+        void post_process_image(const Frame& frame) override
+        {
+            // Texture fetches are kept as raw counts, one per channel.
+            if (m_cost == PixelCostTextureFetches)
+                return;
+
+            const AABB2u& crop_window = frame.get_crop_window();
+
+            ColorMap color_map;
+            color_map.set_palette_from_array(InfernoColorMapLinearRGB, countof(InfernoColorMapLinearRGB) / 3);
+
+            float min_cost, max_cost;
+            color_map.find_min_max_red_channel(*m_image, crop_window, min_cost, max_cost);
+            color_map.remap_red_channel(*m_image, crop_window, min_cost, max_cost);
+        }
+
+      private:
+        const char*         m_model;
+        const PixelCost     m_cost;
+
+        auto_release_ptr<AOVAccumulator> create_accumulator() const override
+        {
+            return auto_release_ptr<AOVAccumulator>(new PixelCostAOVAccumulator(get_image(), m_cost));
+        }
+    };
+
+    const char* PixelRayCountAOVModel = "pixel_ray_count_aov";
+    const char* PixelTraversalStepCountAOVModel = "pixel_traversal_step_count_aov";
+    const char* PixelTextureFetchAOVModel = "pixel_texture_fetch_aov";
+}
+
+
+//
+// PixelRayCountAOVFactory class implementation.
+//
+
+void PixelRayCountAOVFactory::release()
+{
+    delete this;
+}
+
+const char* PixelRayCountAOVFactory::get_model() const
+{
+    return PixelRayCountAOVModel;
+}
+
+Dictionary PixelRayCountAOVFactory::get_model_metadata() const
+{
+    return
+        Dictionary()
+            .insert("name", PixelRayCountAOVModel)
+            .insert("label", "Pixel Ray Count");
+}
+
+DictionaryArray PixelRayCountAOVFactory::get_input_metadata() const
+{
+    DictionaryArray metadata;
+    return metadata;
+}
+
+auto_release_ptr<AOV> PixelRayCountAOVFactory::create(const ParamArray& params) const
+{
+    return
+        auto_release_ptr<AOV>(
+            new PixelCostAOV("pixel_ray_count", PixelRayCountAOVModel, PixelCostRays, params));
+}
+
+
+//
+// PixelTraversalStepCountAOVFactory class implementation.
+//
+
+void PixelTraversalStepCountAOVFactory::release()
+{
+    delete this;
+}
+
+const char* PixelTraversalStepCountAOVFactory::get_model() const
+{
+    return PixelTraversalStepCountAOVModel;
+}
+
+Dictionary PixelTraversalStepCountAOVFactory::get_model_metadata() const
+{
+    return
+        Dictionary()
+            .insert("name", PixelTraversalStepCountAOVModel)
+            .insert("label", "Pixel Traversal Step Count");
+}
+
+DictionaryArray PixelTraversalStepCountAOVFactory::get_input_metadata() const
+{
+    DictionaryArray metadata;
+    return metadata;
+}
+
+auto_release_ptr<AOV> PixelTraversalStepCountAOVFactory::create(const ParamArray& params) const
+{
+    return
+        auto_release_ptr<AOV>(
+            new PixelCostAOV("pixel_traversal_step_count", PixelTraversalStepCountAOVModel, PixelCostTraversalSteps, params));
+}
+
+
+//
+// PixelTextureFetchAOVFactory class implementation.
+//
+
+void PixelTextureFetchAOVFactory::release()
+{
+    delete this;
+}
+
+const char* PixelTextureFetchAOVFactory::get_model() const
+{
+    return PixelTextureFetchAOVModel;
+}
+
+Dictionary PixelTextureFetchAOVFactory::get_model_metadata() const
+{
+    return
+        Dictionary()
+            .insert("name", PixelTextureFetchAOVModel)
+            .insert("label", "Pixel Texture Fetches");
+}
+
+DictionaryArray PixelTextureFetchAOVFactory::get_input_metadata() const
+{
+    DictionaryArray metadata;
+    return metadata;
+}
+
+auto_release_ptr<AOV> PixelTextureFetchAOVFactory::create(const ParamArray& params) const
+{
+    return
+        auto_release_ptr<AOV>(
+            new PixelCostAOV("pixel_texture_fetch", PixelTextureFetchAOVModel, PixelCostTextureFetches, params));
+}
+
+}   // namespace renderer
@@ -77,6 +77,12 @@ namespace
             return PixelErrorAOVModel;
         }
 
+        bool supports_streaming() const override
+        {
+            // Post-processing needs the whole image.
+            return false;
+        }
+
         void post_process_image(const Frame& frame) override
         {
             if (!frame.has_valid_ref_image())
@@ -115,7 +121,7 @@ namespace
       private:
         auto_release_ptr<AOVAccumulator> create_accumulator() const override
         {
-            return auto_release_ptr<AOVAccumulator>(new AOVAccumulator());
+            return auto_release_ptr<AOVAccumulator>(new NullAOVAccumulator());
         }
     };
 }
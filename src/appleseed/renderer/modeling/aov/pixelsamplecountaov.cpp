@@ -74,6 +74,12 @@ const char* PixelSampleCountAOV::get_model() const
     return PixelSampleCountAOVModel;
 }
 
+bool PixelSampleCountAOV::supports_streaming() const
+{
+    // Post-processing needs the whole image.
+    return false;
+}
+
 void PixelSampleCountAOV::post_process_image(const Frame& frame)
 {
     ColorMap color_map;
@@ -114,7 +120,7 @@ void PixelSampleCountAOV::set_normalization_range(
 
 auto_release_ptr<AOVAccumulator> PixelSampleCountAOV::create_accumulator() const
 {
-    return auto_release_ptr<AOVAccumulator>(new AOVAccumulator());
+    return auto_release_ptr<AOVAccumulator>(new NullAOVAccumulator());
 }
 
 
@@ -75,6 +75,11 @@ namespace
         {
         }
 
+        int get_events() const override
+        {
+            return TileEvents | PixelEvents | SampleEvents;
+        }
+
         void on_tile_begin(
             const Frame&                frame,
             const size_t                tile_x,
@@ -121,13 +126,15 @@ namespace
 
                 const double median = m_samples[mid];
 
-                float* out =
-                    reinterpret_cast<float*>(
-                        m_tile->pixel(
-                            pi.x - m_tile_origin_x,
-                            pi.y - m_tile_origin_y));
+                const size_t x = pi.x - m_tile_origin_x;
+                const size_t y = pi.y - m_tile_origin_y;
 
-                *out += static_cast<float>(median) * m_samples.size();
+                // Convert to the storage format of the AOV image.
+                m_tile->set_component(
+                    x,
+                    y,
+                    0,
+                    m_tile->get_component<float>(x, y, 0) + static_cast<float>(median) * m_samples.size());
             }
 
             UnfilteredAOVAccumulator::on_pixel_end(pi);
@@ -180,6 +187,12 @@ namespace
             m_image->clear(Color<float, 3>(0.0f));
         }
 
+        bool supports_streaming() const override
+        {
+            // Post-processing needs the whole image.
+            return false;
+        }
+
         void post_process_image(const Frame& frame) override
         {
             const AABB2u& crop_window = frame.get_crop_window();
@@ -73,6 +73,12 @@ namespace
         {
         }
 
+        bool supports_streaming() const override
+        {
+            // Post-processing needs the whole image.
+            return false;
+        }
+
         void post_process_image(const Frame& frame) override
         {
             const AABB2u& crop_window = frame.get_crop_window();
@@ -94,7 +100,7 @@ namespace
         auto_release_ptr<AOVAccumulator> create_accumulator() const override
         {
             return auto_release_ptr<AOVAccumulator>(
-                new AOVAccumulator());
+                new NullAOVAccumulator());
         }
     };
 }
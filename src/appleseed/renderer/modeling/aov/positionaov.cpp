@@ -81,11 +81,7 @@ namespace
             if (!m_cropped_tile_bbox.contains(pi))
                 return;
 
-            float* out =
-                reinterpret_cast<float*>(
-                    m_tile->pixel(
-                        pi.x - m_tile_origin_x,
-                        pi.y - m_tile_origin_y));
+            Color3f out(0.0f);
 
             if (shading_point.hit_surface())
             {
@@ -94,12 +90,12 @@ namespace
                 out[1] = static_cast<float>(p[1]);
                 out[2] = static_cast<float>(p[2]);
             }
-            else
-            {
-                out[0] = 0.0f;
-                out[1] = 0.0f;
-                out[2] = 0.0f;
-            }
+
+            // Convert to the storage format of the AOV image.
+            m_tile->set_pixel(
+                pi.x - m_tile_origin_x,
+                pi.y - m_tile_origin_y,
+                out);
         }
     };
 
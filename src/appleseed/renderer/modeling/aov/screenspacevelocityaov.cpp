@@ -130,25 +130,16 @@ namespace
             if (!m_cropped_tile_bbox.contains(pi))
                 return;
 
-            float* out =
-                reinterpret_cast<float*>(
-                    m_tile->pixel(
-                        pi.x - m_tile_origin_x,
-                        pi.y - m_tile_origin_y));
-
-            if (shading_point.hit_surface())
-            {
-                const Color3f c = compute_screen_space_velocity_color(shading_point, m_max_displace);
-                out[0] = c[0];
-                out[1] = c[1];
-                out[2] = c[2];
-            }
-            else
-            {
-                out[0] = 0.0f;
-                out[1] = 0.0f;
-                out[2] = 0.0f;
-            }
+            const Color3f out =
+                shading_point.hit_surface()
+                    ? compute_screen_space_velocity_color(shading_point, m_max_displace)
+                    : Color3f(0.0f);
+
+            // Convert to the storage format of the AOV image.
+            m_tile->set_pixel(
+                pi.x - m_tile_origin_x,
+                pi.y - m_tile_origin_y,
+                out);
         }
 
       private:
@@ -81,25 +81,20 @@ namespace
             if (!m_cropped_tile_bbox.contains(pi))
                 return;
 
-            float* out =
-                reinterpret_cast<float*>(
-                    m_tile->pixel(
-                        pi.x - m_tile_origin_x,
-                        pi.y - m_tile_origin_y));
+            Color3f out(0.0f);
 
             if (shading_point.hit_surface())
             {
                 const Vector2f& uv = shading_point.get_uv(0);
                 out[0] = uv[0];
                 out[1] = uv[1];
-                out[2] = 0.0f;
-            }
-            else
-            {
-                out[0] = 0.0f;
-                out[1] = 0.0f;
-                out[2] = 0.0f;
             }
+
+            // Convert to the storage format of the AOV image.
+            m_tile->set_pixel(
+                pi.x - m_tile_origin_x,
+                pi.y - m_tile_origin_y,
+                out);
         }
     };
 
@@ -39,6 +39,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/basis.h"
+#include "foundation/math/fastmath.h"
 #include "foundation/math/fp.h"
 #include "foundation/math/fresnel.h"
 #include "foundation/math/sampling/mappings.h"
@@ -228,7 +229,7 @@ namespace
             if (ScatteringMode::has_glossy(modes) && glossy_weight > 0.0f)
             {
                 // Evaluate the glossy component of the BRDF (equation 4).
-                const float num = sval.m_kg * pow(cos_hn, exp);
+                const float num = sval.m_kg * shading_pow(cos_hn, exp);
                 const float den = cos_oh * (cos_in + cos_on - cos_in * cos_on);
                 fresnel_reflectance_dielectric_schlick(
                     sample.m_value.m_glossy,
@@ -322,7 +323,7 @@ namespace
                 const float exp_num_v = values->m_nv * cos_hv * cos_hv;
                 const float exp_den = 1.0f - cos_hn * cos_hn;
                 const float exp = (exp_num_u + exp_num_v) / abs(exp_den);
-                const float num = cos_hn == 1.0f ? sval.m_kg : sval.m_kg * pow(cos_hn, exp);
+                const float num = cos_hn == 1.0f ? sval.m_kg : sval.m_kg * shading_pow(cos_hn, exp);
                 const float den = cos_oh * (cos_in + cos_on - cos_in * cos_on);
                 fresnel_reflectance_dielectric_schlick(
                     value.m_glossy,
@@ -399,7 +400,7 @@ namespace
                 const float exp_num_v = values->m_nv * cos_hv * cos_hv;
                 const float exp_den = 1.0f - cos_hn * cos_hn;
                 const float exp = (exp_num_u + exp_num_v) / abs(exp_den);
-                const float num = cos_hn == 1.0f ? sval.m_kg : sval.m_kg * pow(cos_hn, exp);
+                const float num = cos_hn == 1.0f ? sval.m_kg : sval.m_kg * shading_pow(cos_hn, exp);
 
                 // Evaluate the PDF of the glossy component (equation 8).
                 pdf_glossy = num / cos_oh;      // omit division by 4 since num = pdf(h) / 4
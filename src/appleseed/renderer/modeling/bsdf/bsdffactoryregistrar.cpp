@@ -96,9 +96,14 @@ BSDFFactoryRegistrar::~BSDFFactoryRegistrar()
     delete impl;
 }
 
-void BSDFFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
+const char* BSDFFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
 {
-    impl->register_factory_plugin(plugin, plugin_entry_point);
+    return impl->register_factory_plugin(plugin, plugin_entry_point);
+}
+
+void BSDFFactoryRegistrar::set_plugin_store(PluginStore* plugin_store, const char* entry_point_name)
+{
+    impl->set_plugin_store(plugin_store, entry_point_name);
 }
 
 BSDFFactoryArray BSDFFactoryRegistrar::get_factories() const
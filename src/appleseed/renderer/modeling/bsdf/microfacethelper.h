@@ -81,6 +81,46 @@ inline void microfacet_alpha_from_roughness(
 }
 
 
+//
+// Evaluate the D and G terms of a microfacet distribution function, and return
+// the probability density of the microfacet normal m. GGX lobes go through the
+// batched evaluator which shares the terms common to D, G and the pdf.
+//
+
+template <typename MDF>
+inline float evaluate_microfacet_terms(
+    const MDF&                      mdf,
+    const foundation::Vector3f&     wi,
+    const foundation::Vector3f&     wo,
+    const foundation::Vector3f&     m,
+    const float                     alpha_x,
+    const float                     alpha_y,
+    const float                     gamma,
+    float&                          D,
+    float&                          G)
+{
+    D = mdf.D(m, alpha_x, alpha_y, gamma);
+    G = mdf.G(wi, wo, m, alpha_x, alpha_y, gamma);
+    return mdf.pdf(wo, m, alpha_x, alpha_y, gamma);
+}
+
+inline float evaluate_microfacet_terms(
+    const foundation::GGXMDF&       mdf,
+    const foundation::Vector3f&     wi,
+    const foundation::Vector3f&     wo,
+    const foundation::Vector3f&     m,
+    const float                     alpha_x,
+    const float                     alpha_y,
+    const float                     gamma,
+    float&                          D,
+    float&                          G)
+{
+    float pdf;
+    foundation::GGXMDF::evaluate_lobes(wi, wo, m, 1, &alpha_x, &alpha_y, &D, &G, &pdf);
+    return pdf;
+}
+
+
 //
 // Helper class to sample and evaluate microfacet BRDFs.
 //
@@ -126,8 +166,10 @@ class MicrofacetBRDFHelper
 
         const float cos_oh = foundation::dot(wo, m);
 
+        float D, G;
         const float probability =
-            mdf.pdf(wo, m, alpha_x, alpha_y, gamma) / std::abs(4.0f * cos_oh);
+            evaluate_microfacet_terms(mdf, wi, wo, m, alpha_x, alpha_y, gamma, D, G) /
+            std::abs(4.0f * cos_oh);
         assert(probability >= 0.0f);
 
         // Disabled until BSDF are evaluated in local space, because the numerous
@@ -152,16 +194,6 @@ class MicrofacetBRDFHelper
         {
             sample.set_to_scattering(ScatteringMode::Glossy, probability);
 
-            const float D = mdf.D(m, alpha_x, alpha_y, gamma);
-            const float G =
-                mdf.G(
-                    wi,
-                    wo,
-                    m,
-                    alpha_x,
-                    alpha_y,
-                    gamma);
-
             const foundation::Vector3f n(0.0f, 1.0f, 0.0f);
             const float cos_on = wo.y;
             const float cos_in = wi.y;
@@ -210,15 +242,9 @@ class MicrofacetBRDFHelper
         if (cos_oh == 0.0f)
             return 0.0f;
 
-        const float D = mdf.D(m, alpha_x, alpha_y, gamma);
-        const float G =
-            mdf.G(
-                wi,
-                wo,
-                m,
-                alpha_x,
-                alpha_y,
-                gamma);
+        float D, G;
+        const float pdf_m =
+            evaluate_microfacet_terms(mdf, wi, wo, m, alpha_x, alpha_y, gamma, D, G);
 
         const foundation::Vector3f n(0.0f, 1.0f, 0.0f);
         f(wo, m, n, value);
@@ -228,7 +254,7 @@ class MicrofacetBRDFHelper
 
         value *= D * G / std::abs(4.0f * cos_on * cos_in);
 
-        return mdf.pdf(wo, m, alpha_x, alpha_y, gamma) / std::abs(4.0f * cos_oh);
+        return pdf_m / std::abs(4.0f * cos_oh);
     }
 
     template <typename MDF>
@@ -304,17 +330,10 @@ class MicrofacetBRDFHelper
         }
 
         const float gamma = 1.0f;
-        const float D = mdf.D(m, alpha, alpha, gamma);
-        const float G =
-            mdf.G(
-                wi,
-                wo,
-                m,
-                alpha,
-                alpha,
-                gamma);
-
-        probability = mdf.pdf(wo, m, alpha, alpha, gamma) / std::abs(4.0f * cos_oh);
+        float D, G;
+        probability =
+            evaluate_microfacet_terms(mdf, wi, wo, m, alpha, alpha, gamma, D, G) /
+            std::abs(4.0f * cos_oh);
         assert(probability >= 0.0f);
 
         return D * G / (4.0f * cos_on * cos_in);
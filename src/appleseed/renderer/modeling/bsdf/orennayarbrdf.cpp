@@ -38,6 +38,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/basis.h"
+#include "foundation/math/fastmath.h"
 #include "foundation/math/sampling/mappings.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
@@ -249,8 +250,8 @@ namespace
             Spectrum&                   value)
         {
             const float sigma2 = square(roughness);
-            const float theta_r = min(acos(cos_on), HalfPi<float>());
-            const float theta_i = acos(cos_in);
+            const float theta_r = min(shading_acos(cos_on), HalfPi<float>());
+            const float theta_i = shading_acos(cos_in);
             const float alpha = max(theta_r, theta_i);
             const float beta = min(theta_r, theta_i);
 
@@ -107,13 +107,21 @@ namespace
             const Vector3f&         incoming_dir,
             Spectrum&               value) const override
         {
-            const DipoleBSSRDFInputValues* values =
-                static_cast<const DipoleBSSRDFInputValues*>(data);
-
             const float square_radius =
                 static_cast<float>(
                     square_norm(outgoing_point.get_point() - incoming_point.get_point()));
 
+            evaluate_radial_profile(data, square_radius, value);
+        }
+
+        bool evaluate_radial_profile(
+            const void*             data,
+            const float             square_radius,
+            Spectrum&               value) const override
+        {
+            const DipoleBSSRDFInputValues* values =
+                static_cast<const DipoleBSSRDFInputValues*>(data);
+
             const float two_c1 = fresnel_first_moment_x2(values->m_base_values.m_eta);
             const float three_c2 = fresnel_second_moment_x3(values->m_base_values.m_eta);
             const float A = (1.0f + three_c2) / (1.0f - two_c1);
@@ -148,6 +156,8 @@ namespace
                 const float ev = exp(-sigma_tr_dv) * rcp_dv;
                 value[i] = square(alpha_prime) * RcpFourPi<float>() * (kr * er - kv * ev);
             }
+
+            return true;
         }
     };
 }
@@ -80,7 +80,10 @@ void* BSSRDF::evaluate_inputs(
 
     get_inputs().evaluate(
         shading_context.get_texture_cache(),
-        SourceInputs(shading_point.get_uv(0)),
+        SourceInputs(
+            shading_point.get_uv(0),
+            shading_point.get_duvdx(0),
+            shading_point.get_duvdy(0)),
         data);
 
     prepare_inputs(
@@ -98,6 +101,16 @@ void BSSRDF::prepare_inputs(
 {
 }
 
+bool BSSRDF::evaluate_from_irradiance(
+    const void*                 data,
+    const ShadingPoint&         outgoing_point,
+    const Vector3f&             outgoing_dir,
+    const IrradiancePointCloud& irradiance_cloud,
+    Spectrum&                   radiance) const
+{
+    return false;
+}
+
 float BSSRDF::compute_eta(
     const ShadingPoint&     shading_point,
     const float             ior)
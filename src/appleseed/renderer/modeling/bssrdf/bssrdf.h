@@ -46,6 +46,7 @@
 namespace foundation    { class Arena; }
 namespace renderer      { class BSDFSample; }
 namespace renderer      { class BSSRDFSample; }
+namespace renderer      { class IrradiancePointCloud; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class ShadingContext; }
 namespace renderer      { class ShadingPoint; }
@@ -124,6 +125,16 @@ class APPLESEED_DLLSYMBOL BSSRDF
         const int                   modes,
         Spectrum&                   value) const = 0;
 
+    // Evaluate the radiance leaving the outgoing point from the irradiance cached in a point
+    // cloud, in place of sampling an incoming point. Return false if the BSSRDF does not support
+    // this, or if no irradiance was cached on its surface. The default implementation returns false.
+    virtual bool evaluate_from_irradiance(
+        const void*                 data,
+        const ShadingPoint&         outgoing_point,
+        const foundation::Vector3f& outgoing_dir,
+        const IrradiancePointCloud& irradiance_cloud,
+        Spectrum&                   radiance) const;
+
   protected:
     static float compute_eta(
         const ShadingPoint&         shading_point,
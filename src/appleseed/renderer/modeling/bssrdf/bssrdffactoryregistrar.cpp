@@ -75,9 +75,14 @@ BSSRDFFactoryRegistrar::~BSSRDFFactoryRegistrar()
     delete impl;
 }
 
-void BSSRDFFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
+const char* BSSRDFFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
 {
-    impl->register_factory_plugin(plugin, plugin_entry_point);
+    return impl->register_factory_plugin(plugin, plugin_entry_point);
+}
+
+void BSSRDFFactoryRegistrar::set_plugin_store(PluginStore* plugin_store, const char* entry_point_name)
+{
+    impl->set_plugin_store(plugin_store, entry_point_name);
 }
 
 BSSRDFFactoryArray BSSRDFFactoryRegistrar::get_factories() const
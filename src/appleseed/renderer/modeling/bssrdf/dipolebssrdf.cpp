@@ -155,6 +155,25 @@ void DipoleBSSRDF::evaluate(
         value);
 }
 
+bool DipoleBSSRDF::evaluate_from_irradiance(
+    const void*                 data,
+    const ShadingPoint&         outgoing_point,
+    const Vector3f&             outgoing_dir,
+    const IrradiancePointCloud& irradiance_cloud,
+    Spectrum&                   radiance) const
+{
+    const DipoleBSSRDFInputValues* values =
+        static_cast<const DipoleBSSRDFInputValues*>(data);
+
+    return do_evaluate_from_irradiance(
+        data,
+        values->m_base_values,
+        outgoing_point,
+        outgoing_dir,
+        irradiance_cloud,
+        radiance);
+}
+
 
 //
 // DipoleBSSRDFFactory class implementation.
@@ -46,6 +46,7 @@ namespace foundation    { class IAbortSwitch; }
 namespace renderer      { class BaseGroup; }
 namespace renderer      { class BSDFSample; }
 namespace renderer      { class BSSRDFSample; }
+namespace renderer      { class IrradiancePointCloud; }
 namespace renderer      { class OnFrameBeginRecorder; }
 namespace renderer      { class ParamArray; }
 namespace renderer      { class Project; }
@@ -132,6 +133,13 @@ class DipoleBSSRDF
         const int                   modes,
         Spectrum&                   value) const override;
 
+    bool evaluate_from_irradiance(
+        const void*                 data,
+        const ShadingPoint&         outgoing_point,
+        const foundation::Vector3f& outgoing_dir,
+        const IrradiancePointCloud& irradiance_cloud,
+        Spectrum&                   radiance) const override;
+
   protected:
     template <typename ComputeRdFun>
     void do_prepare_inputs(
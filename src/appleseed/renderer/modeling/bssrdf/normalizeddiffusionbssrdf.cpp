@@ -40,12 +40,14 @@
 
 // Standard headers.
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 
 // Forward declarations.
 namespace foundation    { class Arena; }
 namespace renderer      { class BSDFSample; }
 namespace renderer      { class BSSRDFSample; }
+namespace renderer      { class IrradiancePointCloud; }
 namespace renderer      { class ShadingContext; }
 
 using namespace foundation;
@@ -217,13 +219,23 @@ namespace
             const ShadingPoint&     incoming_point,
             const Vector3f&         incoming_dir,
             Spectrum&               value) const override
+        {
+            const float square_radius =
+                static_cast<float>(
+                    square_norm(outgoing_point.get_point() - incoming_point.get_point()));
+
+            evaluate_radial_profile(data, square_radius, value);
+        }
+
+        bool evaluate_radial_profile(
+            const void*             data,
+            const float             square_radius,
+            Spectrum&               value) const override
         {
             const NormalizedDiffusionBSSRDFInputValues* values =
                 static_cast<const NormalizedDiffusionBSSRDFInputValues*>(data);
 
-            const float radius =
-                static_cast<float>(
-                    norm(outgoing_point.get_point() - incoming_point.get_point()));
+            const float radius = sqrt(square_radius);
 
             for (size_t i = 0, e = Spectrum::size(); i < e; ++i)
             {
@@ -232,6 +244,8 @@ namespace
                 const float a = values->m_reflectance[i];
                 value[i] = normalized_diffusion_profile(radius, l, s, a);
             }
+
+            return true;
         }
 
         void evaluate(
@@ -256,6 +270,25 @@ namespace
                 modes,
                 value);
         }
+
+        bool evaluate_from_irradiance(
+            const void*                 data,
+            const ShadingPoint&         outgoing_point,
+            const Vector3f&             outgoing_dir,
+            const IrradiancePointCloud& irradiance_cloud,
+            Spectrum&                   radiance) const override
+        {
+            const NormalizedDiffusionBSSRDFInputValues* values =
+                static_cast<const NormalizedDiffusionBSSRDFInputValues*>(data);
+
+            return do_evaluate_from_irradiance(
+                data,
+                values->m_base_values,
+                outgoing_point,
+                outgoing_dir,
+                irradiance_cloud,
+                radiance);
+        }
     };
 }
 
@@ -363,7 +363,9 @@ namespace
                 // Trace the ray up to the sampled distance.
                 new_ray.m_tmax = distance;
                 bssrdf_sample.m_incoming_point.clear();
-                shading_context.get_intersector().trace(
+                trace_subsurface_ray(
+                    shading_context,
+                    outgoing_point,
                     new_ray,
                     bssrdf_sample.m_incoming_point);
                 transmitted = bssrdf_sample.m_incoming_point.hit_surface();
@@ -602,6 +604,24 @@ namespace
             transmission *= Spectrum::size() / mis_base;
         }
 
+        // Trace a ray inside the object. Object instances forming their own SSS set cannot
+        // hand the walk over to other objects, so their rays are traced against the assembly
+        // instance of the outgoing point only, without traversing the assembly tree.
+        static void trace_subsurface_ray(
+            const ShadingContext&   shading_context,
+            const ShadingPoint&     outgoing_point,
+            const ShadingRay&       ray,
+            ShadingPoint&           shading_point,
+            const ShadingPoint*     parent_shading_point = nullptr)
+        {
+            const Intersector& intersector = shading_context.get_intersector();
+
+            if (outgoing_point.get_object_instance().has_sss_set_identifier())
+                intersector.trace(ray, shading_point, parent_shading_point);
+            else
+                intersector.trace_local(ray, outgoing_point, shading_point, parent_shading_point);
+        }
+
         bool trace_zero_scattering_path_glass(
             const ShadingContext&   shading_context,
             SamplingContext&        sampling_context,
@@ -685,7 +705,9 @@ namespace
                     outgoing_point.get_time(),
                     VisibilityFlags::SubsurfaceRay,
                     outgoing_point.get_ray().m_depth + 1);
-                shading_context.get_intersector().trace(
+                trace_subsurface_ray(
+                    shading_context,
+                    outgoing_point,
                     ray,
                     shading_points[next_point_idx],
                     shading_point_ptr);
@@ -740,7 +762,7 @@ namespace
             sampling_context.split_in_place(2, 1);
             Vector3d initial_dir = sample_hemisphere_cosine(sampling_context.next2<Vector2d>());
             initial_dir.y = -initial_dir.y;
-            initial_dir = outgoing_point.get_shading_basis().transform_to_parent(initial_dir);
+            initial_dir = Basis3d(outgoing_point.get_shading_basis()).transform_to_parent(initial_dir);
             direction = static_cast<Vector3f>(initial_dir);
 
             // Choose color channel used for distance sampling.
@@ -756,7 +778,9 @@ namespace
                 VisibilityFlags::SubsurfaceRay,
                 outgoing_point.get_ray().m_depth + 1);
             bssrdf_sample.m_incoming_point.clear();
-            shading_context.get_intersector().trace(
+            trace_subsurface_ray(
+                shading_context,
+                outgoing_point,
                 ray,
                 bssrdf_sample.m_incoming_point,
                 &outgoing_point);
@@ -31,6 +31,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/intersection/intersector.h"
+#include "renderer/kernel/lighting/irradiancepointcloud.h"
 #include "renderer/kernel/shading/shadingcontext.h"
 #include "renderer/kernel/shading/shadingpoint.h"
 #include "renderer/kernel/shading/shadingray.h"
@@ -199,7 +200,7 @@ namespace
         float projection_axis_prob;
         Basis3d projection_basis;
         pick_projection_axis(
-            outgoing_point.get_shading_basis(),
+            Basis3d(outgoing_point.get_shading_basis()),
             u[2],
             projection_axis,
             projection_axis_prob,
@@ -234,6 +235,11 @@ namespace
         const Material* outgoing_material = outgoing_point.get_material();
         assert(outgoing_material != 0);
 
+        // Only hits on the outgoing object instance are kept if it forms its own SSS set,
+        // in which case the probe ray is traced against its assembly instance only.
+        const Intersector& intersector = shading_context.get_intersector();
+        const bool local_probe = !outgoing_object_instance.has_sss_set_identifier();
+
         const size_t MaxIntersectionCount = 1000;
         const size_t MaxCandidateCount = 16;
         ShadingPoint shading_points[MaxCandidateCount];
@@ -244,7 +250,11 @@ namespace
         {
             // Continue tracing the ray.
             ShadingPoint& incoming_point = shading_points[sample_count];
-            if (!shading_context.get_intersector().trace(probe_ray, incoming_point))
+            const bool hit =
+                local_probe
+                    ? intersector.trace_local(probe_ray, outgoing_point, incoming_point)
+                    : intersector.trace(probe_ray, incoming_point);
+            if (!hit)
                 break;
 
             // Move the ray's origin past the hit surface.
@@ -273,7 +283,7 @@ namespace
 
             const float dot_nn =
                 static_cast<float>(
-                    abs(dot(projection_basis.get_normal(), incoming_point.get_shading_normal())));
+                    abs(dot(projection_basis.get_normal(), Vector3d(incoming_point.get_shading_normal()))));
 
             if (same_material && same_sss_set && dot_nn > 1.0e-6f)
             {
@@ -313,7 +323,7 @@ namespace
         // Compute the PDF of this incoming point.
         const float dot_nn =
             static_cast<float>(
-                abs(dot(projection_basis.get_normal(), incoming_point.get_shading_normal())));
+                abs(dot(projection_basis.get_normal(), Vector3d(incoming_point.get_shading_normal()))));
         incoming_point_prob = projection_axis_prob * disk_point_prob * dot_nn;
 
         // Weight the sample contribution with multiple importance sampling.
@@ -326,7 +336,7 @@ namespace
                 incoming_point_prob,
                 outgoing_point.get_point(),
                 incoming_point.get_point(),
-                incoming_point.get_shading_normal());
+                Vector3d(incoming_point.get_shading_normal()));
 
         // Multiplying the contribution by mis_weight is equivalent to dividing the probability by it.
         incoming_point_prob /= mis_weight;
@@ -336,6 +346,28 @@ namespace
 
         return true;
     }
+
+    // Adapts the radial profile of a separable BSSRDF to IrradiancePointCloud::integrate().
+    class RadialProfile
+    {
+      public:
+        RadialProfile(
+            const SeparableBSSRDF&  bssrdf,
+            const void*             data)
+          : m_bssrdf(bssrdf)
+          , m_data(data)
+        {
+        }
+
+        void operator()(const float square_radius, Spectrum& value) const
+        {
+            m_bssrdf.evaluate_radial_profile(m_data, square_radius, value);
+        }
+
+      private:
+        const SeparableBSSRDF&      m_bssrdf;
+        const void*                 m_data;
+    };
 }
 
 SeparableBSSRDF::SeparableBSSRDF(
@@ -354,6 +386,14 @@ SeparableBSSRDF::~SeparableBSSRDF()
     delete m_brdf;
 }
 
+bool SeparableBSSRDF::evaluate_radial_profile(
+    const void*             data,
+    const float             square_radius,
+    Spectrum&               value) const
+{
+    return false;
+}
+
 bool SeparableBSSRDF::do_sample(
     const ShadingContext&   shading_context,
     SamplingContext&        sampling_context,
@@ -527,4 +567,69 @@ void SeparableBSSRDF::do_evaluate(
     value *= values.m_weight * fo * fi / c;
 }
 
+bool SeparableBSSRDF::do_evaluate_from_irradiance(
+    const void*                 data,
+    const InputValues&          values,
+    const ShadingPoint&         outgoing_point,
+    const Vector3f&             outgoing_dir,
+    const IrradiancePointCloud& irradiance_cloud,
+    Spectrum&                   radiance) const
+{
+    //
+    // Integrating the diffusion term (see do_evaluate()) against the irradiance E cached
+    // over the surface gives the outgoing radiance
+    //
+    //   Lo(xo, wo) = 1 / (Pi * C) * Ft(eta, wo) * Integral( Rd(||xi - xo||) * <Ft> * E(xi) dxi )
+    //
+    // where the Fresnel transmittance at the incoming points, which varies with the direction
+    // of incident light, is approximated by its cosine-weighted average over the hemisphere:
+    //
+    //   <Ft> = 1 - 2 * C1(1/eta) = C
+    //
+    // Reference:
+    //
+    //   A Rapid Hierarchical Rendering Technique for Translucent Materials
+    //   Henrik Wann Jensen, Juan Buhler
+    //   http://graphics.ucsd.edu/~henrik/papers/fast_bssrdf/fast_bssrdf.pdf
+    //
+
+    if (values.m_weight == 0.0f)
+    {
+        radiance.set(0.0f);
+        return true;
+    }
+
+    // Bail out if the profile does not only depend on the distance between the points.
+    if (!evaluate_radial_profile(data, 0.0f, radiance))
+        return false;
+
+    if (!irradiance_cloud.integrate(
+            Vector3f(outgoing_point.get_point()),
+            this,
+            &outgoing_point.get_object_instance(),
+            values.m_max_disk_radius,
+            RadialProfile(*this, data),
+            radiance))
+        return false;
+
+    float fo = 1.0f;
+
+    if (values.m_fresnel_weight != 0.0f)
+    {
+        // Fresnel factor at outgoing direction.
+        const Vector3f outgoing_normal(outgoing_point.get_shading_normal());
+        const float cos_on = min(abs(dot(outgoing_dir, outgoing_normal)), 1.0f);
+        fresnel_transmittance_dielectric(fo, values.m_eta, cos_on);
+        fo = lerp(1.0f, fo, values.m_fresnel_weight);
+    }
+
+    // Normalization constant, also the average Fresnel factor at the incoming points.
+    const float c = 1.0f - fresnel_first_moment_x2(values.m_eta);
+    const float fi = lerp(1.0f, c, values.m_fresnel_weight);
+
+    radiance *= values.m_weight * fo * fi / (c * Pi<float>());
+
+    return true;
+}
+
 }   // namespace renderer
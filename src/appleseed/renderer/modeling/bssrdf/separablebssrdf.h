@@ -46,6 +46,7 @@
 namespace renderer  { class BSDF; }
 namespace renderer  { class BSDFSample; }
 namespace renderer  { class BSSRDFSample; }
+namespace renderer  { class IrradiancePointCloud; }
 namespace renderer  { class ParamArray; }
 namespace renderer  { class ShadingContext; }
 namespace renderer  { class ShadingPoint; }
@@ -90,6 +91,14 @@ class APPLESEED_DLLSYMBOL SeparableBSSRDF
         const foundation::Vector3f& incoming_dir,
         Spectrum&                   value) const = 0;
 
+    // Evaluate the radially-symmetric profile from the squared distance between the incoming
+    // and outgoing points alone. Return false if the profile also depends on the directions or
+    // normals at these points. The default implementation returns false.
+    virtual bool evaluate_radial_profile(
+        const void*                 data,
+        const float                 square_radius,
+        Spectrum&                   value) const;
+
     struct InputValues
     {
         float       m_weight;
@@ -125,6 +134,15 @@ class APPLESEED_DLLSYMBOL SeparableBSSRDF
         const foundation::Vector3f& incoming_dir,
         const int                   modes,
         Spectrum&                   value) const;
+
+    // Implementation of the BSSRDF::evaluate_from_irradiance() method.
+    bool do_evaluate_from_irradiance(
+        const void*                 data,
+        const InputValues&          values,
+        const ShadingPoint&         outgoing_point,
+        const foundation::Vector3f& outgoing_dir,
+        const IrradiancePointCloud& irradiance_cloud,
+        Spectrum&                   radiance) const;
 };
 
 }   // namespace renderer
@@ -110,13 +110,21 @@ namespace
             const Vector3f&         incoming_dir,
             Spectrum&               value) const override
         {
-            const DipoleBSSRDFInputValues* values =
-                static_cast<const DipoleBSSRDFInputValues*>(data);
-
             const float square_radius =
                 static_cast<float>(
                     square_norm(outgoing_point.get_point() - incoming_point.get_point()));
 
+            evaluate_radial_profile(data, square_radius, value);
+        }
+
+        bool evaluate_radial_profile(
+            const void*             data,
+            const float             square_radius,
+            Spectrum&               value) const override
+        {
+            const DipoleBSSRDFInputValues* values =
+                static_cast<const DipoleBSSRDFInputValues*>(data);
+
             const float fdr = fresnel_internal_diffuse_reflectance(values->m_base_values.m_eta);
             const float a = (1.0f + fdr) / (1.0f - fdr);
 
@@ -195,6 +203,8 @@ namespace
                 const float ev = exp(-sigma_tr_dv) * rcp_dv;
                 value[i] = alpha_prime * RcpFourPi<float>() * (kr * er - kv * ev);
             }
+
+            return true;
         }
     };
 }
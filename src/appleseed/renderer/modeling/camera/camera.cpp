@@ -197,6 +197,16 @@ bool Camera::on_frame_begin(
     return true;
 }
 
+void Camera::spawn_rays(
+    const size_t            count,
+    SamplingContext*        sampling_contexts,
+    const Dual2d*           ndcs,
+    ShadingRay*             rays) const
+{
+    for (size_t i = 0; i < count; ++i)
+        spawn_ray(sampling_contexts[i], ndcs[i], rays[i]);
+}
+
 bool Camera::project_point(
     const float             time,
     const Vector3d&         point,
@@ -510,6 +520,22 @@ void Camera::initialize_ray(
             m_shutter_close_end_time);
 }
 
+const Transformd* Camera::initialize_rays(
+    const size_t            count,
+    SamplingContext*        sampling_contexts,
+    ShadingRay*             rays,
+    Transformd&             scratch) const
+{
+    for (size_t i = 0; i < count; ++i)
+        initialize_ray(sampling_contexts[i], rays[i]);
+
+    // Without motion blur all rays are spawned at the same time.
+    if (count > 0 && (!m_motion_blur_enabled || m_transform_sequence.size() <= 1))
+        return &m_transform_sequence.evaluate(rays[0].m_time.m_absolute, scratch);
+
+    return nullptr;
+}
+
 float Camera::map_to_shutter_curve(const float sample) const
 {
     assert(m_motion_blur_enabled);
@@ -36,12 +36,16 @@
 
 // appleseed.foundation headers.
 #include "foundation/math/dual.h"
+#include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/uid.h"
 
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+
 // Forward declarations.
 namespace foundation    { class DictionaryArray; }
 namespace foundation    { class IAbortSwitch; }
@@ -125,6 +129,15 @@ class APPLESEED_DLLSYMBOL Camera
         const foundation::Dual2d&       ndc,
         ShadingRay&                     ray) const = 0;
 
+    // Generate a batch of rays, one per sampling context and point on the film plane.
+    // The result is the same as calling spawn_ray() for each ray in turn, but derived
+    // classes may evaluate the camera transform once for the whole batch.
+    virtual void spawn_rays(
+        const size_t                    count,
+        SamplingContext*                sampling_contexts,
+        const foundation::Dual2d*       ndcs,
+        ShadingRay*                     rays) const;
+
     // Connect a vertex to the camera and return the direction vector from the
     // point to the camera, the normalized device coordinates of the projected
     // point on the camera film and the emitted importance. The direction vector
@@ -213,6 +226,15 @@ class APPLESEED_DLLSYMBOL Camera
         SamplingContext&                sampling_context,
         ShadingRay&                     ray) const;
 
+    // Initialize a batch of rays but does not set their origin or direction. Returns
+    // the camera transform if it is the same for all rays, or nullptr if the camera
+    // is moving and its transform needs to be evaluated at the time of each ray.
+    const foundation::Transformd* initialize_rays(
+        const size_t                    count,
+        SamplingContext*                sampling_contexts,
+        ShadingRay*                     rays,
+        foundation::Transformd&         scratch) const;
+
     // Map a sample using inverse of CDF calculated from camera shutter graph. Used in initialize_ray().
     float map_to_shutter_curve(const float sample) const;
 
@@ -74,9 +74,14 @@ CameraFactoryRegistrar::~CameraFactoryRegistrar()
     delete impl;
 }
 
-void CameraFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
+const char* CameraFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
 {
-    impl->register_factory_plugin(plugin, plugin_entry_point);
+    return impl->register_factory_plugin(plugin, plugin_entry_point);
+}
+
+void CameraFactoryRegistrar::set_plugin_store(PluginStore* plugin_store, const char* entry_point_name)
+{
+    impl->set_plugin_store(plugin_store, entry_point_name);
 }
 
 CameraFactoryArray CameraFactoryRegistrar::get_factories() const
@@ -181,20 +181,31 @@ namespace
             const Transformd& transform =
                 m_transform_sequence.evaluate(ray.m_time.m_absolute, scratch);
 
-            // Compute ray origin and direction.
-            ray.m_org = transform.get_local_to_parent().extract_translation();
-            ray.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(ndc.get_value())));
+            // Compute ray origin, direction and derivatives.
+            compute_ray(ndc, transform, ray);
+        }
 
-            // Compute ray derivatives.
-            if (ndc.has_derivatives())
+        void spawn_rays(
+            const size_t            count,
+            SamplingContext*        sampling_contexts,
+            const Dual2d*           ndcs,
+            ShadingRay*             rays) const override
+        {
+            // Initialize the rays.
+            Transformd scratch;
+            const Transformd* shared_transform =
+                initialize_rays(count, sampling_contexts, rays, scratch);
+
+            for (size_t i = 0; i < count; ++i)
             {
-                const Vector2d px(ndc.get_value() + ndc.get_dx());
-                const Vector2d py(ndc.get_value() + ndc.get_dy());
-                ray.m_rx.m_org = ray.m_org;
-                ray.m_ry.m_org = ray.m_org;
-                ray.m_rx.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(px)));
-                ray.m_ry.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(py)));
-                ray.m_has_differentials = true;
+                // Retrieve the camera transform, unless it is shared by all rays.
+                const Transformd& transform =
+                    shared_transform != nullptr
+                        ? *shared_transform
+                        : m_transform_sequence.evaluate(rays[i].m_time.m_absolute, scratch);
+
+                // Compute ray origin, direction and derivatives.
+                compute_ray(ndcs[i], transform, rays[i]);
             }
         }
 
@@ -365,6 +376,28 @@ namespace
                     radius_1 * x * rcp_radius_2 - m_shift.x,
                     radius_1 * y * rcp_radius_2 - m_shift.y);
         }
+
+        void compute_ray(
+            const Dual2d&           ndc,
+            const Transformd&       transform,
+            ShadingRay&             ray) const
+        {
+            // Compute ray origin and direction.
+            ray.m_org = transform.get_local_to_parent().extract_translation();
+            ray.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(ndc.get_value())));
+
+            // Compute ray derivatives.
+            if (ndc.has_derivatives())
+            {
+                const Vector2d px(ndc.get_value() + ndc.get_dx());
+                const Vector2d py(ndc.get_value() + ndc.get_dy());
+                ray.m_rx.m_org = ray.m_org;
+                ray.m_ry.m_org = ray.m_org;
+                ray.m_rx.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(px)));
+                ray.m_ry.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(py)));
+                ray.m_has_differentials = true;
+            }
+        }
     };
 }
 
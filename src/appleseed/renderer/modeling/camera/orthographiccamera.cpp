@@ -159,23 +159,31 @@ namespace
             const Transformd& transform =
                 m_transform_sequence.evaluate(ray.m_time.m_absolute, scratch);
 
-            // Compute ray origin and direction.
-            ray.m_org = transform.point_to_parent(ndc_to_camera(ndc.get_value()));
-            ray.m_dir = normalize(transform.vector_to_parent(Vector3d(0.0, 0.0, -1.0)));
-
-            // Compute ray derivatives.
-            if (ndc.has_derivatives())
-            {
-                const Vector2d px(ndc.get_value() + ndc.get_dx());
-                const Vector2d py(ndc.get_value() + ndc.get_dy());
-
-                ray.m_rx.m_org = transform.point_to_parent(ndc_to_camera(px));
-                ray.m_ry.m_org = transform.point_to_parent(ndc_to_camera(py));
+            // Compute ray origin, direction and derivatives.
+            compute_ray(ndc, transform, ray);
+        }
 
-                ray.m_rx.m_dir = ray.m_dir;
-                ray.m_ry.m_dir = ray.m_dir;
+        void spawn_rays(
+            const size_t            count,
+            SamplingContext*        sampling_contexts,
+            const Dual2d*           ndcs,
+            ShadingRay*             rays) const override
+        {
+            // Initialize the rays.
+            Transformd scratch;
+            const Transformd* shared_transform =
+                initialize_rays(count, sampling_contexts, rays, scratch);
 
-                ray.m_has_differentials = true;
+            for (size_t i = 0; i < count; ++i)
+            {
+                // Retrieve the camera transform, unless it is shared by all rays.
+                const Transformd& transform =
+                    shared_transform != nullptr
+                        ? *shared_transform
+                        : m_transform_sequence.evaluate(rays[i].m_time.m_absolute, scratch);
+
+                // Compute ray origin, direction and derivatives.
+                compute_ray(ndcs[i], transform, rays[i]);
             }
         }
 
@@ -291,6 +299,31 @@ namespace
                     0.5 + point.x * m_rcp_film_width,
                     0.5 - point.y * m_rcp_film_height);
         }
+
+        void compute_ray(
+            const Dual2d&           ndc,
+            const Transformd&       transform,
+            ShadingRay&             ray) const
+        {
+            // Compute ray origin and direction.
+            ray.m_org = transform.point_to_parent(ndc_to_camera(ndc.get_value()));
+            ray.m_dir = normalize(transform.vector_to_parent(Vector3d(0.0, 0.0, -1.0)));
+
+            // Compute ray derivatives.
+            if (ndc.has_derivatives())
+            {
+                const Vector2d px(ndc.get_value() + ndc.get_dx());
+                const Vector2d py(ndc.get_value() + ndc.get_dy());
+
+                ray.m_rx.m_org = transform.point_to_parent(ndc_to_camera(px));
+                ray.m_ry.m_org = transform.point_to_parent(ndc_to_camera(py));
+
+                ray.m_rx.m_dir = ray.m_dir;
+                ray.m_ry.m_dir = ray.m_dir;
+
+                ray.m_has_differentials = true;
+            }
+        }
     };
 }
 
@@ -166,20 +166,73 @@ namespace
             const Transformd& transform =
                 m_transform_sequence.evaluate(ray.m_time.m_absolute, scratch);
 
-            // Compute ray origin and direction.
-            ray.m_org = transform.get_local_to_parent().extract_translation();
-            ray.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(ndc.get_value())));
+            // Compute ray origin, direction and derivatives.
+            compute_ray(ndc, transform, ray);
+        }
 
-            // Compute ray derivatives.
-            if (ndc.has_derivatives())
+        void spawn_rays(
+            const size_t            count,
+            SamplingContext*        sampling_contexts,
+            const Dual2d*           ndcs,
+            ShadingRay*             rays) const override
+        {
+            // Initialize the rays.
+            Transformd scratch;
+            const Transformd* shared_transform =
+                initialize_rays(count, sampling_contexts, rays, scratch);
+
+            // If the camera is moving, evaluate its transform at the time of each ray.
+            if (shared_transform == nullptr)
             {
-                const Vector2d px(ndc.get_value() + ndc.get_dx());
-                const Vector2d py(ndc.get_value() + ndc.get_dy());
-                ray.m_rx.m_org = ray.m_org;
-                ray.m_ry.m_org = ray.m_org;
-                ray.m_rx.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(px)));
-                ray.m_ry.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(py)));
-                ray.m_has_differentials = true;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const Transformd& transform =
+                        m_transform_sequence.evaluate(rays[i].m_time.m_absolute, scratch);
+                    compute_ray(ndcs[i], transform, rays[i]);
+                }
+                return;
+            }
+
+            //
+            // Otherwise the (unnormalized) ray direction is an affine function of the film point:
+            //
+            //   dir(p) = base + p.x * du + p.y * dv
+            //
+            // and we only need to transform the base point and the two axes once per batch.
+            //
+
+            const Vector3d org = shared_transform->get_local_to_parent().extract_translation();
+            const Vector3d base =
+                shared_transform->vector_to_parent(
+                    Vector3d(
+                        m_shift.x - 0.5 * m_film_dimensions[0],
+                        m_shift.y + 0.5 * m_film_dimensions[1],
+                        -m_focal_length));
+            const Vector3d du = shared_transform->vector_to_parent(Vector3d(m_film_dimensions[0], 0.0, 0.0));
+            const Vector3d dv = shared_transform->vector_to_parent(Vector3d(0.0, -m_film_dimensions[1], 0.0));
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Dual2d& ndc = ndcs[i];
+                const Vector2d& p = ndc.get_value();
+                ShadingRay& ray = rays[i];
+
+                // Compute ray origin and direction.
+                const Vector3d dir = base + p.x * du + p.y * dv;
+                ray.m_org = org;
+                ray.m_dir = normalize(dir);
+
+                // Compute ray derivatives.
+                if (ndc.has_derivatives())
+                {
+                    const Vector2d& dx = ndc.get_dx();
+                    const Vector2d& dy = ndc.get_dy();
+                    ray.m_rx.m_org = org;
+                    ray.m_ry.m_org = org;
+                    ray.m_rx.m_dir = normalize(dir + dx.x * du + dx.y * dv);
+                    ray.m_ry.m_dir = normalize(dir + dy.x * du + dy.y * dv);
+                    ray.m_has_differentials = true;
+                }
             }
         }
 
@@ -218,6 +271,29 @@ namespace
             // The connection was possible.
             return true;
         }
+
+      private:
+        void compute_ray(
+            const Dual2d&           ndc,
+            const Transformd&       transform,
+            ShadingRay&             ray) const
+        {
+            // Compute ray origin and direction.
+            ray.m_org = transform.get_local_to_parent().extract_translation();
+            ray.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(ndc.get_value())));
+
+            // Compute ray derivatives.
+            if (ndc.has_derivatives())
+            {
+                const Vector2d px(ndc.get_value() + ndc.get_dx());
+                const Vector2d py(ndc.get_value() + ndc.get_dy());
+                ray.m_rx.m_org = ray.m_org;
+                ray.m_ry.m_org = ray.m_org;
+                ray.m_rx.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(px)));
+                ray.m_ry.m_dir = normalize(transform.vector_to_parent(-ndc_to_camera(py)));
+                ray.m_has_differentials = true;
+            }
+        }
     };
 }
 
@@ -329,26 +329,31 @@ namespace
             const Transformd& transform =
                 m_transform_sequence.evaluate(ray.m_time.m_absolute, scratch);
 
-            // Compute lens point in world space.
-            const Vector3d lens_point = transform.point_to_parent(sample_lens(sampling_context));
+            // Compute ray origin, direction and derivatives.
+            compute_ray(sampling_context, ndc, transform, ray);
+        }
 
-            // Compute ray origin and direction.
-            ray.m_org = lens_point;
-            ray.m_dir = compute_ray_direction(ndc.get_value(), lens_point, transform);
+        void spawn_rays(
+            const size_t            count,
+            SamplingContext*        sampling_contexts,
+            const Dual2d*           ndcs,
+            ShadingRay*             rays) const override
+        {
+            // Initialize the rays.
+            Transformd scratch;
+            const Transformd* shared_transform =
+                initialize_rays(count, sampling_contexts, rays, scratch);
 
-            // Compute ray derivatives.
-            if (ndc.has_derivatives())
+            for (size_t i = 0; i < count; ++i)
             {
-                const Vector2d px(ndc.get_value() + ndc.get_dx());
-                const Vector2d py(ndc.get_value() + ndc.get_dy());
-
-                ray.m_rx.m_org = ray.m_org;
-                ray.m_ry.m_org = ray.m_org;
-
-                ray.m_rx.m_dir = compute_ray_direction(px, lens_point, transform);
-                ray.m_ry.m_dir = compute_ray_direction(py, lens_point, transform);
-
-                ray.m_has_differentials = true;
+                // Retrieve the camera transform, unless it is shared by all rays.
+                const Transformd& transform =
+                    shared_transform != nullptr
+                        ? *shared_transform
+                        : m_transform_sequence.evaluate(rays[i].m_time.m_absolute, scratch);
+
+                // Compute ray origin, direction and derivatives.
+                compute_ray(sampling_contexts[i], ndcs[i], transform, rays[i]);
             }
         }
 
@@ -609,6 +614,35 @@ namespace
             }
         }
 
+        void compute_ray(
+            SamplingContext&        sampling_context,
+            const Dual2d&           ndc,
+            const Transformd&       transform,
+            ShadingRay&             ray) const
+        {
+            // Compute lens point in world space.
+            const Vector3d lens_point = transform.point_to_parent(sample_lens(sampling_context));
+
+            // Compute ray origin and direction.
+            ray.m_org = lens_point;
+            ray.m_dir = compute_ray_direction(ndc.get_value(), lens_point, transform);
+
+            // Compute ray derivatives.
+            if (ndc.has_derivatives())
+            {
+                const Vector2d px(ndc.get_value() + ndc.get_dx());
+                const Vector2d py(ndc.get_value() + ndc.get_dy());
+
+                ray.m_rx.m_org = ray.m_org;
+                ray.m_ry.m_org = ray.m_org;
+
+                ray.m_rx.m_dir = compute_ray_direction(px, lens_point, transform);
+                ray.m_ry.m_dir = compute_ray_direction(py, lens_point, transform);
+
+                ray.m_has_differentials = true;
+            }
+        }
+
         Vector3d compute_ray_direction(
             const Vector2d&         film_point,         // NDC
             const Vector3d&         lens_point,         // world space
@@ -35,6 +35,7 @@
 #include "foundation/math/scalar.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -125,4 +126,92 @@ void spectral_values_to_spectrum(
         &output_spectrum[0]);
 }
 
+
+//
+// Hero wavelength spectral sampling implementation.
+//
+
+namespace
+{
+    const float WavelengthRange = HighWavelength - LowWavelength;
+    const float BandWidth = WavelengthRange / (RegularSpectrum31f::Samples - 1);
+
+    // Find the two spectrum samples surrounding a wavelength and the weight of the second one.
+    void locate_wavelength(
+        const float         wavelength,
+        size_t&             i0,
+        size_t&             i1,
+        float&              t)
+    {
+        const float x =
+            clamp(
+                (wavelength - LowWavelength) * (1.0f / BandWidth),
+                0.0f,
+                static_cast<float>(RegularSpectrum31f::Samples - 1));
+
+        i0 = min(truncate<size_t>(x), RegularSpectrum31f::Samples - 2);
+        i1 = i0 + 1;
+        t = x - static_cast<float>(i0);
+    }
+}
+
+void sample_hero_wavelengths(
+    const float             s,
+    float                   wavelengths[HeroWavelengthCount])
+{
+    assert(s >= 0.0f && s < 1.0f);
+
+    const float hero = s * WavelengthRange;
+
+    for (size_t i = 0; i < HeroWavelengthCount; ++i)
+    {
+        float offset = hero + static_cast<float>(i) * (WavelengthRange / HeroWavelengthCount);
+
+        if (offset >= WavelengthRange)
+            offset -= WavelengthRange;
+
+        wavelengths[i] = LowWavelength + offset;
+    }
+}
+
+void evaluate_spectrum(
+    const RegularSpectrum31f& spectrum,
+    const size_t            count,
+    const float             wavelengths[],
+    float                   values[])
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t i0, i1;
+        float t;
+        locate_wavelength(wavelengths[i], i0, i1, t);
+
+        values[i] = lerp(spectrum[i0], spectrum[i1], t);
+    }
+}
+
+void splat_hero_wavelengths(
+    const float             wavelengths[HeroWavelengthCount],
+    const float             values[HeroWavelengthCount],
+    RegularSpectrum31f&     spectrum)
+{
+    // The spectrum samples are the coefficients of a basis of tent functions. Each sample
+    // receives the Monte Carlo estimate of the average of the carried spectrum over the
+    // support of its tent function. Tents at both ends of the range are half as wide.
+    const float Weight = WavelengthRange / (HeroWavelengthCount * BandWidth);
+
+    for (size_t i = 0; i < HeroWavelengthCount; ++i)
+    {
+        size_t i0, i1;
+        float t;
+        locate_wavelength(wavelengths[i], i0, i1, t);
+
+        const float w0 = i0 == 0 ? 2.0f * Weight : Weight;
+        const float w1 = i1 == RegularSpectrum31f::Samples - 1 ? 2.0f * Weight : Weight;
+
+        spectrum[i0] += (1.0f - t) * w0 * values[i];
+        spectrum[i1] += t * w1 * values[i];
+    }
+}
+
 }   // namespace renderer
@@ -71,4 +71,41 @@ APPLESEED_DLLSYMBOL void spectral_values_to_spectrum(
     const float                         input_spectrum[],
     foundation::RegularSpectrum31f&     output_spectrum);
 
+
+//
+// Hero wavelength spectral sampling.
+//
+// A path carries radiance at a small set of wavelengths: a hero wavelength sampled uniformly
+// in [LowWavelength, HighWavelength) and companion wavelengths offset from it at regular
+// intervals, wrapping around the wavelength range. All wavelengths share the same pdf.
+//
+// Reference:
+//
+//   Hero Wavelength Spectral Sampling
+//   Alexander Wilkie, Sehera Nawaz, Marc Droske, Andrea Weidlich, Johannes Hanika
+//   https://jo.dreggn.org/home/2014_herowavelength.pdf
+//
+
+// Number of wavelengths carried along a path.
+const size_t HeroWavelengthCount = 4;
+
+// Generate a set of wavelengths, in nm, from a uniform sample in [0,1).
+APPLESEED_DLLSYMBOL void sample_hero_wavelengths(
+    const float                         s,
+    float                               wavelengths[HeroWavelengthCount]);
+
+// Evaluate a spectrum at arbitrary wavelengths, in nm, using linear interpolation.
+APPLESEED_DLLSYMBOL void evaluate_spectrum(
+    const foundation::RegularSpectrum31f& spectrum,
+    const size_t                        count,
+    const float                         wavelengths[],
+    float                               values[]);
+
+// Accumulate values carried at hero wavelengths into a spectrum. The expected value of the
+// accumulated spectrum is the spectrum from which the values were taken.
+APPLESEED_DLLSYMBOL void splat_hero_wavelengths(
+    const float                         wavelengths[HeroWavelengthCount],
+    const float                         values[HeroWavelengthCount],
+    foundation::RegularSpectrum31f&     spectrum);
+
 }   // namespace renderer
@@ -68,9 +68,14 @@ EDFFactoryRegistrar::~EDFFactoryRegistrar()
     delete impl;
 }
 
-void EDFFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
+const char* EDFFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
 {
-    impl->register_factory_plugin(plugin, plugin_entry_point);
+    return impl->register_factory_plugin(plugin, plugin_entry_point);
+}
+
+void EDFFactoryRegistrar::set_plugin_store(PluginStore* plugin_store, const char* entry_point_name)
+{
+    impl->set_plugin_store(plugin_store, entry_point_name);
 }
 
 EDFFactoryArray EDFFactoryRegistrar::get_factories() const
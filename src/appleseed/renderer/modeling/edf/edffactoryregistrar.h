@@ -40,6 +40,7 @@
 namespace renderer  { class EDF; }
 namespace renderer  { class IEDFFactory; }
 namespace renderer  { class Plugin; }
+namespace renderer  { class PluginStore; }
 
 namespace renderer
 {
@@ -69,8 +70,11 @@ class APPLESEED_DLLSYMBOL EDFFactoryRegistrar
     // Destructor.
     ~EDFFactoryRegistrar();
 
-    // Register a factory defined in a plugin.
-    void register_factory_plugin(Plugin* plugin, void* plugin_entry_point);
+    // Register a factory defined in a plugin. Return the model of the registered factory.
+    const char* register_factory_plugin(Plugin* plugin, void* plugin_entry_point);
+
+    // Let the registrar load deferred plugins from a plugin store when a factory is missing.
+    void set_plugin_store(PluginStore* plugin_store, const char* entry_point_name);
 
     // Retrieve the registered factories.
     FactoryArrayType get_factories() const;
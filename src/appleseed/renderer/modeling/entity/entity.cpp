@@ -31,17 +31,29 @@
 #include "entity.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/modeling/entity/onframebeginrecorder.h"
 #include "renderer/modeling/entity/onrenderbeginrecorder.h"
 
 // appleseed.foundation headers.
+#include "foundation/platform/system.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/job.h"
 
 // OpenImageIO headers.
 #include "foundation/platform/_beginoiioheaders.h"
 #include "OpenImageIO/ustring.h"
 #include "foundation/platform/_endoiioheaders.h"
 
+// Boost headers.
+#include "boost/atomic/atomic.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <exception>
+
 using namespace foundation;
 using namespace std;
 
@@ -167,4 +179,130 @@ void Entity::on_frame_end(
 {
 }
 
+
+//
+// invoke_on_frame_begin_parallel() implementation.
+//
+
+namespace
+{
+    // Collections with fewer entities are processed on the calling thread.
+    const size_t MinParallelOnFrameBeginEntityCount = 8;
+
+    struct OnFrameBeginState
+    {
+        const Project&          m_project;
+        const BaseGroup*        m_parent;
+        OnFrameBeginRecorder&   m_recorder;
+        IAbortSwitch*           m_abort_switch;
+        boost::atomic<bool>     m_failed;
+        boost::mutex            m_exception_mutex;
+        exception_ptr           m_exception;
+
+        OnFrameBeginState(
+            const Project&          project,
+            const BaseGroup*        parent,
+            OnFrameBeginRecorder&   recorder,
+            IAbortSwitch*           abort_switch)
+          : m_project(project)
+          , m_parent(parent)
+          , m_recorder(recorder)
+          , m_abort_switch(abort_switch)
+          , m_failed(false)
+        {
+        }
+    };
+
+    class OnFrameBeginJob
+      : public IJob
+    {
+      public:
+        OnFrameBeginJob(
+            Entity*                 entity,
+            OnFrameBeginState&      state)
+          : m_entity(entity)
+          , m_state(state)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            // Don't bother preparing more entities once one of them failed.
+            if (m_state.m_failed.load() || is_aborted(m_state.m_abort_switch))
+                return;
+
+            try
+            {
+                if (!m_entity->on_frame_begin(
+                        m_state.m_project,
+                        m_state.m_parent,
+                        m_state.m_recorder,
+                        m_state.m_abort_switch))
+                    m_state.m_failed.store(true);
+            }
+            catch (...)
+            {
+                // Keep the first exception so that it can be rethrown on the calling thread.
+                boost::lock_guard<boost::mutex> lock(m_state.m_exception_mutex);
+                if (!m_state.m_exception)
+                    m_state.m_exception = current_exception();
+                m_state.m_failed.store(true);
+            }
+        }
+
+      private:
+        Entity*                     m_entity;
+        OnFrameBeginState&          m_state;
+    };
+}
+
+bool invoke_on_frame_begin_parallel(
+    Entity* const*          entities,
+    const size_t            entity_count,
+    const Project&          project,
+    const BaseGroup*        parent,
+    OnFrameBeginRecorder&   recorder,
+    IAbortSwitch*           abort_switch)
+{
+    const size_t thread_count =
+        min(System::get_logical_cpu_core_count(), entity_count);
+
+    if (entity_count < MinParallelOnFrameBeginEntityCount || thread_count < 2)
+    {
+        for (size_t i = 0; i < entity_count; ++i)
+        {
+            if (is_aborted(abort_switch))
+                return false;
+
+            if (!entities[i]->on_frame_begin(project, parent, recorder, abort_switch))
+                return false;
+        }
+
+        return true;
+    }
+
+    OnFrameBeginState state(project, parent, recorder, abort_switch);
+
+    JobQueue job_queue;
+
+    for (size_t i = 0; i < entity_count; ++i)
+        job_queue.schedule(new OnFrameBeginJob(entities[i], state));
+
+    JobManager job_manager(
+        global_logger(),
+        job_queue,
+        thread_count,
+        JobManager::KeepRunningOnEmptyQueue);
+
+    job_manager.start();
+    job_queue.wait_until_completion();
+    job_manager.stop();
+
+    // Entities that succeeded have been recorded and will be rolled back by the caller.
+    if (state.m_exception)
+        rethrow_exception(state.m_exception);
+
+    return !state.m_failed.load() && !is_aborted(abort_switch);
+}
+
 }   // namespace renderer
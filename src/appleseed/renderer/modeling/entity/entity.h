@@ -46,6 +46,7 @@
 // Standard headers.
 #include <cstddef>
 #include <string>
+#include <vector>
 
 // Forward declarations.
 namespace foundation    { class APIString; }
@@ -211,6 +212,26 @@ bool invoke_on_frame_begin(
     OnFrameBeginRecorder&               recorder,
     foundation::IAbortSwitch*           abort_switch);
 
+// Utility function to invoke on_frame_begin() concurrently on a collection of entities.
+// The on_frame_begin() method of the entities of the collection must not depend on each other.
+// Returns true on success, or false if an error occurred or if the abort switch was triggered.
+template <typename EntityCollection>
+bool invoke_on_frame_begin_parallel(
+    EntityCollection&                   entities,
+    const Project&                      project,
+    const BaseGroup*                    parent,
+    OnFrameBeginRecorder&               recorder,
+    foundation::IAbortSwitch*           abort_switch);
+
+// Utility function to invoke on_frame_begin() concurrently on an array of independent entities.
+APPLESEED_DLLSYMBOL bool invoke_on_frame_begin_parallel(
+    Entity* const*                      entities,
+    const size_t                        entity_count,
+    const Project&                      project,
+    const BaseGroup*                    parent,
+    OnFrameBeginRecorder&               recorder,
+    foundation::IAbortSwitch*           abort_switch);
+
 
 //
 // Entity class implementation.
@@ -311,4 +332,28 @@ bool invoke_on_frame_begin(
     return true;
 }
 
+template <typename EntityCollection>
+bool invoke_on_frame_begin_parallel(
+    EntityCollection&                   entities,
+    const Project&                      project,
+    const BaseGroup*                    parent,
+    OnFrameBeginRecorder&               recorder,
+    foundation::IAbortSwitch*           abort_switch)
+{
+    std::vector<Entity*> entity_ptrs;
+    entity_ptrs.reserve(entities.size());
+
+    for (auto& entity : entities)
+        entity_ptrs.push_back(&entity);
+
+    return
+        invoke_on_frame_begin_parallel(
+            entity_ptrs.data(),
+            entity_ptrs.size(),
+            project,
+            parent,
+            recorder,
+            abort_switch);
+}
+
 }   // namespace renderer
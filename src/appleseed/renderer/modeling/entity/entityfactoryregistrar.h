@@ -28,6 +28,9 @@
 
 #pragma once
 
+// appleseed.renderer headers.
+#include "renderer/utility/pluginstore.h"
+
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
 #include "foundation/utility/autoreleaseptr.h"
@@ -53,20 +56,28 @@ class EntityFactoryRegistrarImpl
   : public foundation::NonCopyable
 {
   public:
+    // Constructor.
+    EntityFactoryRegistrarImpl();
+
     // Register a factory.
     void register_factory(foundation::auto_release_ptr<FactoryType> factory);
 
-    // Register a factory defined in a plugin.
-    void register_factory_plugin(Plugin* plugin, void* plugin_entry_point);
+    // Register a factory defined in a plugin. Return the model of the factory.
+    const char* register_factory_plugin(Plugin* plugin, void* plugin_entry_point);
 
-    // Retrieve registered factories.
+    // Load deferred plugins from a given plugin store when a factory is missing.
+    void set_plugin_store(PluginStore* plugin_store, const char* entry_point_name);
+
+    // Retrieve registered factories, including the ones of deferred plugins.
     FactoryArrayType get_factories() const;
 
-    // Lookup a factory by name.
+    // Lookup a factory by name, loading the deferred plugin that provides it if needed.
     const FactoryType* lookup(const char* name) const;
 
   private:
-    foundation::Registrar<FactoryType> m_registrar;
+    foundation::Registrar<FactoryType>  m_registrar;
+    PluginStore*                        m_plugin_store;
+    std::string                         m_entry_point_name;
 };
 
 
@@ -74,6 +85,12 @@ class EntityFactoryRegistrarImpl
 // EntityFactoryRegistrar class implementation.
 //
 
+template <typename EntityType, typename FactoryType, typename FactoryArrayType>
+EntityFactoryRegistrarImpl<EntityType, FactoryType, FactoryArrayType>::EntityFactoryRegistrarImpl()
+  : m_plugin_store(nullptr)
+{
+}
+
 template <typename EntityType, typename FactoryType, typename FactoryArrayType>
 void EntityFactoryRegistrarImpl<EntityType, FactoryType, FactoryArrayType>::register_factory(foundation::auto_release_ptr<FactoryType> factory)
 {
@@ -82,15 +99,28 @@ void EntityFactoryRegistrarImpl<EntityType, FactoryType, FactoryArrayType>::regi
 }
 
 template <typename EntityType, typename FactoryType, typename FactoryArrayType>
-void EntityFactoryRegistrarImpl<EntityType, FactoryType, FactoryArrayType>::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
+const char* EntityFactoryRegistrarImpl<EntityType, FactoryType, FactoryArrayType>::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
 {
     const auto create_factory = reinterpret_cast<FactoryType* (*)()>(plugin_entry_point);
-    register_factory(foundation::auto_release_ptr<FactoryType>(create_factory()));
+    foundation::auto_release_ptr<FactoryType> factory(create_factory());
+    const std::string model = factory->get_model();
+    register_factory(std::move(factory));
+    return m_registrar.lookup(model)->get_model();
+}
+
+template <typename EntityType, typename FactoryType, typename FactoryArrayType>
+void EntityFactoryRegistrarImpl<EntityType, FactoryType, FactoryArrayType>::set_plugin_store(PluginStore* plugin_store, const char* entry_point_name)
+{
+    m_plugin_store = plugin_store;
+    m_entry_point_name = entry_point_name;
 }
 
 template <typename EntityType, typename FactoryType, typename FactoryArrayType>
 FactoryArrayType EntityFactoryRegistrarImpl<EntityType, FactoryType, FactoryArrayType>::get_factories() const
 {
+    if (m_plugin_store)
+        m_plugin_store->load_deferred_plugins(m_entry_point_name.c_str());
+
     FactoryArrayType factories;
 
     for (const auto& item : m_registrar.items())
@@ -103,7 +133,15 @@ template <typename EntityType, typename FactoryType, typename FactoryArrayType>
 const FactoryType* EntityFactoryRegistrarImpl<EntityType, FactoryType, FactoryArrayType>::lookup(const char* name) const
 {
     assert(name);
-    return m_registrar.lookup(name);
+
+    const FactoryType* factory = m_registrar.lookup(name);
+
+    if (factory == nullptr &&
+        m_plugin_store &&
+        m_plugin_store->load_deferred_plugins(m_entry_point_name.c_str(), name))
+        factory = m_registrar.lookup(name);
+
+    return factory;
 }
 
 }   // namespace renderer
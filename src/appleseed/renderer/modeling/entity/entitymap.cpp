@@ -32,10 +32,15 @@
 
 // appleseed.foundation headers.
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/unordered_map.hpp"
 
 // Standard headers.
 #include <cassert>
 #include <map>
+#include <string>
 
 using namespace foundation;
 using namespace std;
@@ -45,8 +50,9 @@ namespace renderer
 
 struct EntityMap::Impl
 {
+    // Entities are stored by unique ID, which keeps iteration in insertion order.
     typedef map<UniqueID, Entity*> Storage;
-    typedef map<string, Entity*> Index;
+    typedef boost::unordered_map<string, Entity*, StringHash, StringEqual> Index;
 
     Storage m_storage;
     Index   m_index;
@@ -311,7 +317,7 @@ Entity* EntityMap::get_by_uid(const UniqueID id) const
 Entity* EntityMap::get_by_name(const char* name) const
 {
     assert(name);
-    const Impl::Index::iterator it = impl->m_index.find(name);
+    const Impl::Index::iterator it = impl->m_index.find(name, StringHash(), StringEqual());
     return it == impl->m_index.end() ? nullptr : it->second;
 }
 
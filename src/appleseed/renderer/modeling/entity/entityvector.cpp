@@ -32,10 +32,14 @@
 
 // appleseed.foundation headers.
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/unordered_map.hpp"
 
 // Standard headers.
 #include <cassert>
-#include <map>
+#include <string>
 #include <vector>
 
 using namespace foundation;
@@ -47,8 +51,8 @@ namespace renderer
 struct EntityVector::Impl
 {
     typedef vector<Entity*> Storage;
-    typedef map<UniqueID, size_t> IDIndex;
-    typedef map<string, size_t> NameIndex;
+    typedef boost::unordered_map<UniqueID, size_t> IDIndex;
+    typedef boost::unordered_map<string, size_t, StringHash, StringEqual> NameIndex;
 
     Storage     m_storage;
     IDIndex     m_id_index;
@@ -300,7 +304,8 @@ auto_release_ptr<Entity> EntityVector::remove(Entity* entity)
 
     // Find the entity to remove in the vector.
     const Impl::IDIndex::iterator id_it = impl->m_id_index.find(entity->get_uid());
-    const Impl::NameIndex::iterator name_it = impl->m_name_index.find(entity->get_name());
+    const Impl::NameIndex::iterator name_it =
+        impl->m_name_index.find(entity->get_name(), StringHash(), StringEqual());
     assert(id_it != impl->m_id_index.end());
     assert(name_it != impl->m_name_index.end());
     assert(id_it->second == name_it->second);
@@ -336,7 +341,7 @@ size_t EntityVector::get_index(const UniqueID id) const
 size_t EntityVector::get_index(const char* name) const
 {
     assert(name);
-    const Impl::NameIndex::iterator it = impl->m_name_index.find(name);
+    const Impl::NameIndex::iterator it = impl->m_name_index.find(name, StringHash(), StringEqual());
     return it == impl->m_name_index.end() ? ~size_t(0) : it->second;
 }
 
@@ -32,6 +32,10 @@
 // appleseed.renderer headers.
 #include "renderer/modeling/entity/entity.h"
 
+// Boost headers.
+#include "boost/thread/locks.hpp"
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
 #include <cassert>
 #include <stack>
@@ -49,7 +53,8 @@ struct OnFrameBeginRecorder::Impl
         const BaseGroup*    m_parent;
     };
 
-    stack<Record> m_records;
+    boost::mutex    m_mutex;
+    stack<Record>   m_records;
 };
 
 OnFrameBeginRecorder::OnFrameBeginRecorder()
@@ -68,6 +73,8 @@ void OnFrameBeginRecorder::record(Entity* entity, const BaseGroup* parent)
     Impl::Record record;
     record.m_entity = entity;
     record.m_parent = parent;
+
+    boost::lock_guard<boost::mutex> lock(impl->m_mutex);
     impl->m_records.push(record);
 }
 
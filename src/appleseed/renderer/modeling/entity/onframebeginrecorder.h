@@ -42,6 +42,7 @@ namespace renderer
 //
 // Keep tracks of which entities we have called `on_frame_begin()` on,
 // and allows to call `on_frame_end()` on those entities, in reverse order.
+// Entities may be recorded concurrently from multiple threads.
 //
 
 class APPLESEED_DLLSYMBOL OnFrameBeginRecorder
@@ -0,0 +1,374 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "bakedenvironmentmap.h"
+
+// appleseed.renderer headers.
+#include "renderer/modeling/environmentedf/sphericalcoordinates.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
+#include "foundation/math/sampling/imageimportancesampler.h"
+#include "foundation/math/scalar.h"
+#include "foundation/utility/job/iabortswitch.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    struct EmptyPayload {};
+
+    typedef ImageImportanceSampler<EmptyPayload, float> ImportanceSamplerType;
+
+    // Return a quantity proportional to the luminance of a spectrum.
+    float spectrum_luminance(const RegularSpectrum31f& spectrum)
+    {
+        return sum_value(spectrum * XYZCMFCIE19312Deg[1]);
+    }
+
+    class CellImportanceSampler
+    {
+      public:
+        CellImportanceSampler(
+            const vector<float>&    vertex_luminances,
+            const size_t            width,
+            const size_t            height)
+          : m_vertex_luminances(vertex_luminances)
+          , m_width(width)
+          , m_height(height)
+        {
+        }
+
+        void sample(const size_t x, const size_t y, EmptyPayload& payload, float& importance) const
+        {
+            const size_t row = m_width + 1;
+            const size_t i = y * row + x;
+
+            // Use the brightest corner so that every cell with a non-zero bilinear
+            // radiance somewhere inside it gets a non-zero probability.
+            const float max_luminance =
+                max(
+                    max(m_vertex_luminances[i], m_vertex_luminances[i + 1]),
+                    max(m_vertex_luminances[i + row], m_vertex_luminances[i + row + 1]));
+
+            // Account for the solid angle subtended by the cell.
+            const float sin_theta = sin(Pi<float>() * (y + 0.5f) / m_height);
+
+            importance = max_luminance * sin_theta;
+        }
+
+      private:
+        const vector<float>&        m_vertex_luminances;
+        const size_t                m_width;
+        const size_t                m_height;
+    };
+}
+
+
+//
+// BakedEnvironmentMap class implementation.
+//
+
+struct BakedEnvironmentMap::Impl
+{
+    size_t                              m_width;
+    size_t                              m_height;
+    float                               m_probability_scale;
+
+    // Radiance at the (width + 1) x (height + 1) corners of the cells.
+    vector<RegularSpectrum31f>          m_vertices;
+
+    // Null if the map is black.
+    unique_ptr<ImportanceSamplerType>   m_importance_sampler;
+
+    Impl()
+      : m_width(0)
+      , m_height(0)
+      , m_probability_scale(0.0f)
+    {
+    }
+
+    void lookup(
+        const size_t                    x,
+        const size_t                    y,
+        const float                     fx,
+        const float                     fy,
+        RegularSpectrum31f&             radiance) const
+    {
+        assert(x < m_width);
+        assert(y < m_height);
+
+        const size_t row = m_width + 1;
+        const RegularSpectrum31f* v = &m_vertices[y * row + x];
+
+        radiance = v[0] * ((1.0f - fx) * (1.0f - fy));
+        radiance += v[1] * (fx * (1.0f - fy));
+        radiance += v[row] * ((1.0f - fx) * fy);
+        radiance += v[row + 1] * (fx * fy);
+    }
+
+    void locate(
+        const Vector3f&                 outgoing,
+        size_t&                         x,
+        size_t&                         y,
+        float&                          fx,
+        float&                          fy,
+        float&                          sin_theta) const
+    {
+        float theta, phi;
+        unit_vector_to_angles(outgoing, theta, phi);
+        sin_theta = sin(theta);
+
+        float u, v;
+        angles_to_unit_square(theta, phi, u, v);
+
+        const float px = u * m_width;
+        const float py = v * m_height;
+        x = min(truncate<size_t>(px), m_width - 1);
+        y = min(truncate<size_t>(py), m_height - 1);
+        fx = px - x;
+        fy = py - y;
+    }
+
+    float compute_pdf(
+        const size_t                    x,
+        const size_t                    y,
+        const float                     sin_theta) const
+    {
+        if (m_importance_sampler.get() == nullptr || sin_theta <= 0.0f)
+            return 0.0f;
+
+        const float prob_xy = m_importance_sampler->get_pdf(x, y);
+        return prob_xy * m_probability_scale / sin_theta;
+    }
+};
+
+BakedEnvironmentMap::BakedEnvironmentMap()
+  : impl(new Impl())
+{
+}
+
+BakedEnvironmentMap::~BakedEnvironmentMap()
+{
+    delete impl;
+}
+
+bool BakedEnvironmentMap::empty() const
+{
+    return impl->m_vertices.empty();
+}
+
+void BakedEnvironmentMap::clear()
+{
+    impl->m_width = 0;
+    impl->m_height = 0;
+    impl->m_probability_scale = 0.0f;
+
+    vector<RegularSpectrum31f>().swap(impl->m_vertices);
+    impl->m_importance_sampler.reset();
+}
+
+bool BakedEnvironmentMap::bake(
+    const size_t                        width,
+    const size_t                        height,
+    const RadianceFunction&             radiance_function,
+    IAbortSwitch*                       abort_switch)
+{
+    assert(width > 0);
+    assert(height > 0);
+
+    clear();
+
+    const size_t vertex_count = (width + 1) * (height + 1);
+    impl->m_vertices.resize(vertex_count);
+
+    vector<float> vertex_luminances(vertex_count);
+    float max_luminance = 0.0f;
+
+    // Tabulate the radiance function at the corners of the cells.
+    for (size_t y = 0; y <= height; ++y)
+    {
+        if (is_aborted(abort_switch))
+        {
+            clear();
+            return false;
+        }
+
+        const float v = static_cast<float>(y) / height;
+
+        for (size_t x = 0; x <= width; ++x)
+        {
+            const float u = static_cast<float>(x) / width;
+
+            float theta, phi;
+            unit_square_to_angles(u, v, theta, phi);
+
+            const Vector3f outgoing =
+                Vector3f::make_unit_vector(cos(theta), sin(theta), cos(phi), sin(phi));
+
+            const size_t i = y * (width + 1) + x;
+            RegularSpectrum31f& radiance = impl->m_vertices[i];
+            radiance_function(outgoing, radiance);
+
+            const float luminance = spectrum_luminance(radiance);
+            vertex_luminances[i] = luminance > 0.0f ? luminance : 0.0f;
+            max_luminance = max(max_luminance, vertex_luminances[i]);
+        }
+    }
+
+    impl->m_width = width;
+    impl->m_height = height;
+    impl->m_probability_scale = (width * height) / (2.0f * PiSquare<float>());
+
+    // Build the importance sampler, unless the map is completely black.
+    if (max_luminance > 0.0f)
+    {
+        CellImportanceSampler sampler(vertex_luminances, width, height);
+        impl->m_importance_sampler.reset(new ImportanceSamplerType(width, height));
+        impl->m_importance_sampler->rebuild(sampler, abort_switch);
+
+        if (is_aborted(abort_switch))
+        {
+            clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t BakedEnvironmentMap::get_memory_size() const
+{
+    const size_t cell_count = impl->m_width * impl->m_height;
+
+    return
+        impl->m_vertices.capacity() * sizeof(RegularSpectrum31f) +
+        (impl->m_importance_sampler.get() ? cell_count * (sizeof(EmptyPayload) + 2 * sizeof(float)) : 0);
+}
+
+void BakedEnvironmentMap::sample(
+    const Vector2f&                     s,
+    Vector3f&                           outgoing,
+    RegularSpectrum31f&                 radiance,
+    float&                              probability) const
+{
+    assert(!empty());
+
+    if (impl->m_importance_sampler.get() == nullptr)
+    {
+        outgoing = Vector3f(0.0f, 1.0f, 0.0f);
+        radiance.set(0.0f);
+        probability = 0.0f;
+        return;
+    }
+
+    // Sample the importance map.
+    size_t x, y;
+    EmptyPayload payload;
+    float prob_xy;
+    Vector2f jitter;
+    impl->m_importance_sampler->sample(s, x, y, payload, prob_xy, jitter);
+    assert(prob_xy > 0.0f);
+
+    // Compute the spherical coordinates of the sample.
+    float theta, phi;
+    unit_square_to_angles(
+        (x + jitter[0]) / impl->m_width,
+        (y + jitter[1]) / impl->m_height,
+        theta,
+        phi);
+
+    const float sin_theta = sin(theta);
+    outgoing = Vector3f::make_unit_vector(cos(theta), sin_theta, cos(phi), sin(phi));
+
+    if (sin_theta <= 0.0f)
+    {
+        radiance.set(0.0f);
+        probability = 0.0f;
+        return;
+    }
+
+    impl->lookup(x, y, jitter[0], jitter[1], radiance);
+    probability = prob_xy * impl->m_probability_scale / sin_theta;
+    assert(probability > 0.0f);
+}
+
+void BakedEnvironmentMap::evaluate(
+    const Vector3f&                     outgoing,
+    RegularSpectrum31f&                 radiance) const
+{
+    assert(!empty());
+    assert(is_normalized(outgoing));
+
+    size_t x, y;
+    float fx, fy, sin_theta;
+    impl->locate(outgoing, x, y, fx, fy, sin_theta);
+    impl->lookup(x, y, fx, fy, radiance);
+}
+
+void BakedEnvironmentMap::evaluate(
+    const Vector3f&                     outgoing,
+    RegularSpectrum31f&                 radiance,
+    float&                              probability) const
+{
+    assert(!empty());
+    assert(is_normalized(outgoing));
+
+    size_t x, y;
+    float fx, fy, sin_theta;
+    impl->locate(outgoing, x, y, fx, fy, sin_theta);
+    impl->lookup(x, y, fx, fy, radiance);
+    probability = impl->compute_pdf(x, y, sin_theta);
+}
+
+float BakedEnvironmentMap::evaluate_pdf(
+    const Vector3f&                     outgoing) const
+{
+    assert(!empty());
+    assert(is_normalized(outgoing));
+
+    size_t x, y;
+    float fx, fy, sin_theta;
+    impl->locate(outgoing, x, y, fx, fy, sin_theta);
+
+    return impl->compute_pdf(x, y, sin_theta);
+}
+
+}   // namespace renderer
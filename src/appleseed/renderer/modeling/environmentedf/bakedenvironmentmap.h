@@ -0,0 +1,114 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/image/regularspectrum.h"
+#include "foundation/math/vector.h"
+
+// Standard headers.
+#include <cstddef>
+#include <functional>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+
+namespace renderer
+{
+
+//
+// A radiance function tabulated over the sphere of directions in latitude-longitude
+// parameterization, with piecewise bilinear lookups and importance sampling.
+//
+// Analytic environment EDFs (such as sky models) can bake themselves into this map
+// once per frame to replace costly per-direction evaluations by table lookups.
+// All directions are expressed in the local space of the environment EDF.
+//
+
+class BakedEnvironmentMap
+  : public foundation::NonCopyable
+{
+  public:
+    typedef std::function<
+        void (const foundation::Vector3f& outgoing, foundation::RegularSpectrum31f& radiance)
+    > RadianceFunction;
+
+    // Constructor.
+    BakedEnvironmentMap();
+
+    // Destructor.
+    ~BakedEnvironmentMap();
+
+    // Return true if the map has not been baked.
+    bool empty() const;
+
+    // Release the baked data.
+    void clear();
+
+    // Tabulate a radiance function on a grid of width x height cells.
+    // Return false if the operation was aborted, in which case the map is left empty.
+    bool bake(
+        const size_t                        width,
+        const size_t                        height,
+        const RadianceFunction&             radiance_function,
+        foundation::IAbortSwitch*           abort_switch = nullptr);
+
+    // Return the approximate amount of memory used by the baked data, in bytes.
+    size_t get_memory_size() const;
+
+    // Sample a direction proportionally to the tabulated luminance.
+    void sample(
+        const foundation::Vector2f&         s,
+        foundation::Vector3f&               outgoing,
+        foundation::RegularSpectrum31f&     radiance,
+        float&                              probability) const;
+
+    // Look up the radiance along a given direction.
+    void evaluate(
+        const foundation::Vector3f&         outgoing,
+        foundation::RegularSpectrum31f&     radiance) const;
+
+    // Look up the radiance along a given direction and the probability density
+    // with which sample() would have chosen this direction.
+    void evaluate(
+        const foundation::Vector3f&         outgoing,
+        foundation::RegularSpectrum31f&     radiance,
+        float&                              probability) const;
+
+    // Return the probability density with which sample() chooses a given direction.
+    float evaluate_pdf(
+        const foundation::Vector3f&         outgoing) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}   // namespace renderer
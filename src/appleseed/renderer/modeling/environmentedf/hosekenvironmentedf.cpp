@@ -31,14 +31,22 @@
 #include "hosekenvironmentedf.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/kernel/shading/shadingcontext.h"
+#include "renderer/kernel/texturing/texturecache.h"
+#include "renderer/kernel/texturing/texturestore.h"
 #include "renderer/modeling/color/colorspace.h"
+#include "renderer/modeling/environment/environment.h"
+#include "renderer/modeling/environmentedf/bakedenvironmentmap.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/environmentedf/sphericalcoordinates.h"
 #include "renderer/modeling/input/inputarray.h"
 #include "renderer/modeling/input/source.h"
 #include "renderer/modeling/input/sourceinputs.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/paramarray.h"
 #include "renderer/utility/transformsequence.h"
 
 // appleseed.foundation headers.
@@ -51,8 +59,10 @@
 #include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
 #include <algorithm>
@@ -110,6 +120,9 @@ namespace
             m_inputs.declare("luminance_gamma", InputFormatFloat, "1.0");
             m_inputs.declare("saturation_multiplier", InputFormatFloat, "1.0");
             m_inputs.declare("horizon_shift", InputFormatFloat, "0.0");
+
+            m_bake_sky = m_params.get_optional<bool>("bake_sky", false);
+            m_bake_sky_resolution = max(m_params.get_optional<size_t>("bake_sky_resolution", 256), size_t(2));
         }
 
         void release() override
@@ -156,6 +169,11 @@ namespace
                     m_uniform_master_Y);
             }
 
+            // Tabulate the sky into a latitude-longitude map, or switch back to analytic evaluation.
+            m_baked_sky.clear();
+            if (m_bake_sky && project.get_scene()->get_environment()->get_uncached_environment_edf() == this)
+                bake_sky(*project.get_scene(), abort_switch);
+
             return true;
         }
 
@@ -166,16 +184,26 @@ namespace
             Spectrum&               value,
             float&                  probability) const override
         {
-            const Vector3f local_outgoing = sample_hemisphere_cosine(s);
-
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
+
+            if (!m_baked_sky.empty())
+            {
+                Vector3f local_outgoing;
+                RegularSpectrum31f radiance;
+                m_baked_sky.sample(s, local_outgoing, radiance, probability);
+                outgoing = transform.vector_to_parent(local_outgoing);
+                value.set(radiance, g_std_lighting_conditions, Spectrum::Illuminance);
+                return;
+            }
+
+            const Vector3f local_outgoing = sample_hemisphere_cosine(s);
             outgoing = transform.vector_to_parent(local_outgoing);
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             RegularSpectrum31f radiance;
             if (shifted_outgoing.y > 0.0f)
-                compute_sky_radiance(shading_context, shifted_outgoing, radiance);
+                compute_sky_radiance(shading_context.get_texture_cache(), shifted_outgoing, radiance);
             else radiance.set(0.0f);
 
             value.set(radiance, g_std_lighting_conditions, Spectrum::Illuminance);
@@ -193,11 +221,20 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (!m_baked_sky.empty())
+            {
+                RegularSpectrum31f radiance;
+                m_baked_sky.evaluate(normalize(local_outgoing), radiance);
+                value.set(radiance, g_std_lighting_conditions, Spectrum::Illuminance);
+                return;
+            }
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             RegularSpectrum31f radiance;
             if (shifted_outgoing.y > 0.0f)
-                compute_sky_radiance(shading_context, shifted_outgoing, radiance);
+                compute_sky_radiance(shading_context.get_texture_cache(), shifted_outgoing, radiance);
             else radiance.set(0.0f);
 
             value.set(radiance, g_std_lighting_conditions, Spectrum::Illuminance);
@@ -214,11 +251,20 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (!m_baked_sky.empty())
+            {
+                RegularSpectrum31f radiance;
+                m_baked_sky.evaluate(normalize(local_outgoing), radiance, probability);
+                value.set(radiance, g_std_lighting_conditions, Spectrum::Illuminance);
+                return;
+            }
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             RegularSpectrum31f radiance;
             if (shifted_outgoing.y > 0.0f)
-                compute_sky_radiance(shading_context, shifted_outgoing, radiance);
+                compute_sky_radiance(shading_context.get_texture_cache(), shifted_outgoing, radiance);
             else radiance.set(0.0f);
 
             value.set(radiance, g_std_lighting_conditions, Spectrum::Illuminance);
@@ -234,6 +280,10 @@ namespace
             Transformd scratch;
             const Transformd& transform = m_transform_sequence.evaluate(0.0f, scratch);
             const Vector3f local_outgoing = transform.vector_to_local(outgoing);
+
+            if (!m_baked_sky.empty())
+                return m_baked_sky.evaluate_pdf(normalize(local_outgoing));
+
             const Vector3f shifted_outgoing = shift(local_outgoing);
 
             const float probability = shifted_outgoing.y > 0.0f ? shifted_outgoing.y * RcpPi<float>() : 0.0f;
@@ -258,6 +308,10 @@ namespace
 
         InputValues                 m_uniform_values;
 
+        bool                        m_bake_sky;
+        size_t                      m_bake_sky_resolution;  // width of the baked sky, its height is half of it
+        BakedEnvironmentMap         m_baked_sky;
+
         float                       m_sun_theta;    // sun zenith angle in radians, 0=zenith
         float                       m_sun_phi;      // radians
         Vector3f                    m_sun_dir;
@@ -381,7 +435,7 @@ namespace
 
         // Compute the sky radiance along a given direction.
         void compute_sky_radiance(
-            const ShadingContext&   shading_context,
+            TextureCache&           texture_cache,
             const Vector3f&         outgoing,
             RegularSpectrum31f&     radiance) const
         {
@@ -412,7 +466,7 @@ namespace
                 unit_vector_to_angles(outgoing, theta, phi);
                 angles_to_unit_square(theta, phi, u, v);
                 InputValues values;
-                m_inputs.evaluate(shading_context.get_texture_cache(), SourceInputs(Vector2f(u, v)), &values);
+                m_inputs.evaluate(texture_cache, SourceInputs(Vector2f(u, v)), &values);
                 float turbidity = values.m_turbidity;
 
                 // Apply turbidity multiplier and bias.
@@ -467,6 +521,38 @@ namespace
                 * RcpPi<float>();                                   // convert irradiance to radiance
         }
 
+        void bake_sky(const Scene& scene, IAbortSwitch* abort_switch)
+        {
+            TextureStore texture_store(scene);
+            TextureCache texture_cache(texture_store);
+
+            const size_t width = m_bake_sky_resolution;
+            const size_t height = width / 2;
+
+            const bool baked =
+                m_baked_sky.bake(
+                    width,
+                    height,
+                    [this, &texture_cache](const Vector3f& local_outgoing, RegularSpectrum31f& radiance)
+                    {
+                        const Vector3f shifted_outgoing = shift(local_outgoing);
+                        if (shifted_outgoing.y > 0.0f)
+                            compute_sky_radiance(texture_cache, shifted_outgoing, radiance);
+                        else radiance.set(0.0f);
+                    },
+                    abort_switch);
+
+            if (baked)
+            {
+                RENDERER_LOG_DEBUG(
+                    "baked " FMT_SIZE_T "x" FMT_SIZE_T " sky for environment edf \"%s\" (%s).",
+                    width,
+                    height,
+                    get_path().c_str(),
+                    pretty_size(m_baked_sky.get_memory_size()).c_str());
+            }
+        }
+
         Vector3f shift(Vector3f v) const
         {
             v.y -= m_uniform_values.m_horizon_shift;
@@ -161,6 +161,32 @@ void IEnvironmentEDFFactory::add_common_sky_input_metadata(DictionaryArray& meta
             .insert("use", "optional")
             .insert("default", "0.0")
             .insert("help", "Shift the horizon vertically"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "bake_sky")
+            .insert("label", "Bake Sky")
+            .insert("type", "boolean")
+            .insert("use", "optional")
+            .insert("default", "false")
+            .insert("help", "Tabulate the sky once per frame and importance sample it instead of evaluating the sky model for every ray"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "bake_sky_resolution")
+            .insert("label", "Baked Sky Resolution")
+            .insert("type", "integer")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "2")
+                    .insert("type", "hard"))
+            .insert("max",
+                Dictionary()
+                    .insert("value", "4096")
+                    .insert("type", "soft"))
+            .insert("use", "optional")
+            .insert("default", "256")
+            .insert("help", "Horizontal resolution of the baked sky, the vertical resolution is half of it"));
 }
 
 }   // namespace renderer
@@ -186,6 +186,7 @@ namespace
 
             m_phi_shift = deg_to_rad(m_params.get_optional<float>("horizontal_shift", 0.0f));
             m_theta_shift = deg_to_rad(m_params.get_optional<float>("vertical_shift", 0.0f));
+            m_alias_sampling = m_params.get_optional<bool>("enable_alias_sampling", false);
         }
 
         void release() override
@@ -257,14 +258,13 @@ namespace
             size_t x, y;
             Color3f payload;
             float prob_xy;
-            m_importance_sampler->sample(s, x, y, payload, prob_xy);
+            Vector2f jitter;
+            m_importance_sampler->sample(s, x, y, payload, prob_xy, jitter);
             assert(prob_xy >= 0.0f);
 
             // Compute the coordinates in [0,1)^2 of the sample.
-            const float jitter_x = frac(s[0] * m_importance_map_width);
-            const float jitter_y = frac(s[1] * m_importance_map_height);
-            const float u = (x + jitter_x) * m_rcp_importance_map_width;
-            const float v = (y + jitter_y) * m_rcp_importance_map_height;
+            const float u = (x + jitter[0]) * m_rcp_importance_map_width;
+            const float v = (y + jitter[1]) * m_rcp_importance_map_height;
             assert(u >= 0.0f && u < 1.0f);
             assert(v >= 0.0f && v < 1.0f);
 
@@ -399,6 +399,7 @@ namespace
 
         float   m_phi_shift;                        // horizontal shift in radians
         float   m_theta_shift;                      // vertical shift in radians
+        bool    m_alias_sampling;                   // sample the importance map with alias tables
 
         size_t  m_importance_map_width;
         size_t  m_importance_map_height;
@@ -441,7 +442,8 @@ namespace
             m_importance_sampler.reset(
                 new ImageImportanceSamplerType(
                     m_importance_map_width,
-                    m_importance_map_height));
+                    m_importance_map_height,
+                    m_alias_sampling));
 
             RENDERER_LOG_INFO(
                 "building " FMT_SIZE_T "x" FMT_SIZE_T " importance map "
@@ -622,6 +624,15 @@ DictionaryArray LatLongMapEnvironmentEDFFactory::get_input_metadata() const
             .insert("use", "optional")
             .insert("help", "Environment texture vertical shift in degrees"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "enable_alias_sampling")
+            .insert("label", "Alias Sampling")
+            .insert("type", "boolean")
+            .insert("use", "optional")
+            .insert("default", "false")
+            .insert("help", "Sample the importance map in constant time using alias tables instead of binary searches"));
+
     return metadata;
 }
 
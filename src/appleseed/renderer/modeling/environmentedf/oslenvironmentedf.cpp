@@ -106,6 +106,14 @@ namespace
             m_shader_group =
                 static_cast<ShaderGroup*>(m_inputs.get_entity("osl_background"));
 
+            // Render a black background until the shader group has been optimized.
+            // The background covers the whole frame so request it as early as possible.
+            if (m_shader_group && !m_shader_group->is_optimized())
+            {
+                m_shader_group->record_use();
+                m_shader_group = nullptr;
+            }
+
             return true;
         }
 
@@ -34,8 +34,10 @@
 #include "renderer/global/globallogger.h"
 #include "renderer/kernel/aov/aovsettings.h"
 #include "renderer/kernel/aov/imagestack.h"
+#include "renderer/kernel/aov/tilestack.h"
 #include "renderer/kernel/denoising/denoiser.h"
 #include "renderer/kernel/rendering/ishadingresultframebufferfactory.h"
+#include "renderer/kernel/rendering/permanentshadingresultframebufferfactory.h"
 #include "renderer/kernel/rendering/shadingresultframebuffer.h"
 #include "renderer/modeling/aov/aov.h"
 #include "renderer/modeling/aov/aovfactoryregistrar.h"
@@ -47,6 +49,7 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/core/exceptions/exceptionioerror.h"
 #include "foundation/image/analysis.h"
 #include "foundation/image/color.h"
@@ -54,6 +57,7 @@
 #include "foundation/image/genericimagefilereader.h"
 #include "foundation/image/genericimagefilewriter.h"
 #include "foundation/image/genericprogressiveimagefilereader.h"
+#include "foundation/image/genericprogressiveimagefilewriter.h"
 #include "foundation/image/image.h"
 #include "foundation/image/imageattributes.h"
 #include "foundation/image/pixel.h"
@@ -62,15 +66,30 @@
 #include "foundation/math/scalar.h"
 #include "foundation/platform/defaulttimers.h"
 #include "foundation/platform/path.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/thread.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/countof.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/iostreamop.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/job/iabortswitch.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/imageio.h"
+#include "foundation/platform/_endoiioheaders.h"
+
 // Boost headers.
+#include "boost/atomic/atomic.hpp"
 #include "boost/filesystem.hpp"
+#include "boost/thread/thread.hpp"
 
 // BCD headers.
 #include "bcd/DeepImage.h"
@@ -79,9 +98,11 @@
 // Standard headers.
 #include <algorithm>
 #include <exception>
+#include <functional>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 using namespace bcd;
@@ -99,6 +120,8 @@ namespace renderer
 namespace
 {
     const UniqueID g_class_uid = new_guid();
+
+    class CheckpointWriter;
 }
 
 UniqueID Frame::get_class_uid()
@@ -123,6 +146,7 @@ struct Frame::Impl
     string                          m_checkpoint_create_path;
     bool                            m_checkpoint_resume;
     string                          m_checkpoint_resume_path;
+    bool                            m_output_streaming;
 
     // When resuming a render, first pass index should be
     // the number of the resumed render's pass + 1.
@@ -130,6 +154,14 @@ struct Frame::Impl
     size_t                          m_initial_pass;
     size_t                          m_pass_count;
 
+    // Range of passes rendered by this frame, used to render a frame on several machines.
+    // The end of the range is exclusive.
+    size_t                          m_pass_range_begin;
+    size_t                          m_pass_range_end;
+
+    // First pass of the samples accumulated in the shading buffer.
+    size_t                          m_checkpoint_first_pass;
+
     // Child entities.
     AOVContainer                    m_aovs;
     DenoiserAOV*                    m_denoiser_aov;
@@ -146,11 +178,56 @@ struct Frame::Impl
     unique_ptr<FilterSamplingTable> m_filter_sampling_table;
     ParamArray                      m_render_info;
 
+    // Output streaming.
+    unique_ptr<GenericProgressiveImageFileWriter>   m_stream_writer;
+    string                                          m_stream_file_path;
+    vector<AOV*>                                    m_streamed_aovs;
+    bool                                            m_release_streamed_tiles;
+    boost::atomic<bool>                             m_stream_failed;
+    bool                                            m_output_streamed;
+
+    // Incremental post-processing.
+    vector<PostProcessingStage*>                    m_incremental_stages;
+
+    // Checkpoint writing.
+    unique_ptr<CheckpointWriter>                    m_checkpoint_writer;
+    unique_ptr<boost::thread>                       m_checkpoint_thread;
+
+    // Background image writing.
+    unique_ptr<boost::thread>                       m_image_write_thread;
+    boost::atomic<bool>                             m_image_write_failed;
+
     explicit Impl(Frame* parent)
       : m_aovs(parent)
       , m_internal_aovs(parent)
       , m_post_processing_stages(parent)
+      , m_release_streamed_tiles(false)
+      , m_stream_failed(false)
+      , m_output_streamed(false)
+      , m_image_write_failed(false)
+    {
+    }
+
+    ~Impl();
+
+    // Wait until the checkpoint being written in the background is complete.
+    void wait_for_checkpoint();
+
+    // Wait until the image files being written in the background are complete.
+    void wait_for_image_writes();
+
+    // Return true if the tiles of the main image were released by output streaming.
+    bool has_released_main_image() const
+    {
+        return m_output_streamed && m_release_streamed_tiles;
+    }
+
+    // Return true if the tiles of a given AOV were released by output streaming.
+    bool has_released_aov_image(const AOV& aov) const
     {
+        return
+            has_released_main_image() &&
+            find(m_streamed_aovs.begin(), m_streamed_aovs.end(), &aov) != m_streamed_aovs.end();
     }
 };
 
@@ -167,6 +244,7 @@ Frame::Frame(
     extract_parameters();
 
     // Create the underlying image.
+    MemoryTagScope framebuffers_memory_tag_scope(MemoryTagFramebuffers);
     impl->m_image.reset(
         new Image(
             impl->m_frame_width,
@@ -206,6 +284,7 @@ Frame::Frame(
     }
 
     // Create the image stack for AOVs.
+    MemoryTagScope aovs_memory_tag_scope(MemoryTagAOVs);
     impl->m_aov_images.reset(
         new ImageStack(
             impl->m_frame_width,
@@ -259,8 +338,26 @@ Frame::Frame(
     }
     else impl->m_denoiser_aov = nullptr;
 
-    impl->m_initial_pass = 0;
-    impl->m_pass_count = params.get_optional<size_t>("passes", 1);
+    impl->m_pass_count = max<size_t>(params.get_optional<size_t>("passes", 1), 1);
+
+    // Retrieve the range of passes to render, inclusive on both sides.
+    const Vector2u default_pass_range(0, impl->m_pass_count - 1);
+    Vector2u pass_range = params.get_optional<Vector2u>("pass_range", default_pass_range);
+    if (pass_range[0] > pass_range[1] || pass_range[1] >= impl->m_pass_count)
+    {
+        RENDERER_LOG_ERROR(
+            "invalid pass range (%s, %s) for %s pass%s, rendering all passes.",
+            pretty_uint(pass_range[0]).c_str(),
+            pretty_uint(pass_range[1]).c_str(),
+            pretty_uint(impl->m_pass_count).c_str(),
+            impl->m_pass_count > 1 ? "es" : "");
+        pass_range = default_pass_range;
+    }
+
+    impl->m_pass_range_begin = pass_range[0];
+    impl->m_pass_range_end = pass_range[1] + 1;
+    impl->m_initial_pass = impl->m_pass_range_begin;
+    impl->m_checkpoint_first_pass = impl->m_pass_range_begin;
 }
 
 Frame::~Frame()
@@ -287,9 +384,11 @@ void Frame::print_settings()
         "  crop window                   (%s, %s)-(%s, %s)\n"
         "  dithering                     %s\n"
         "  noise seed                    %s\n"
+        "  pass range                    %s-%s\n"
         "  denoising mode                %s\n"
         "  create checkpoint             %s\n"
         "  resume checkpoint             %s\n"
+        "  output streaming              %s\n"
         "  reference image path          %s",
         get_path().c_str(),
         get_uid(),
@@ -306,10 +405,13 @@ void Frame::print_settings()
         pretty_uint(impl->m_crop_window.max[1]).c_str(),
         impl->m_enable_dithering ? "on" : "off",
         pretty_uint(impl->m_noise_seed).c_str(),
+        pretty_uint(impl->m_pass_range_begin).c_str(),
+        pretty_uint(impl->m_pass_range_end - 1).c_str(),
         impl->m_denoising_mode == DenoisingMode::Off ? "off" :
         impl->m_denoising_mode == DenoisingMode::WriteOutputs ? "write outputs" : "denoise",
         impl->m_checkpoint_create ? impl->m_checkpoint_create_path.c_str() : "off",
         impl->m_checkpoint_resume ? impl->m_checkpoint_resume_path.c_str() : "off",
+        impl->m_output_streaming ? "on" : "off",
         impl->m_ref_image_path.empty() ? "n/a" : impl->m_ref_image_path.c_str());
 }
 
@@ -374,6 +476,11 @@ size_t Frame::get_initial_pass() const
     return impl->m_initial_pass;
 }
 
+size_t Frame::get_end_pass() const
+{
+    return impl->m_pass_range_end;
+}
+
 void Frame::reset_crop_window()
 {
     impl->m_crop_window =
@@ -436,12 +543,18 @@ bool Frame::on_frame_begin(
     if (!Entity::on_frame_begin(project, parent, recorder, abort_switch))
         return false;
 
+    // The images are about to be rendered again.
+    impl->wait_for_image_writes();
+
     if (!invoke_on_frame_begin(impl->m_aovs, project, parent, recorder, abort_switch))
         return false;
 
     if (!invoke_on_frame_begin(impl->m_post_processing_stages, project, parent, recorder, abort_switch))
         return false;
 
+    impl->m_output_streamed = false;
+    impl->m_incremental_stages.clear();
+
     return true;
 }
 
@@ -464,12 +577,15 @@ Frame::DenoisingMode Frame::get_denoising_mode() const
     return impl->m_denoising_mode;
 }
 
-void Frame::denoise(
-    const size_t                                thread_count,
-    IAbortSwitch*                               abort_switch) const
+DenoiserAOV* Frame::denoiser_aov() const
 {
-    DenoiserOptions options;
+    return impl->m_denoiser_aov;
+}
 
+void Frame::get_denoiser_options(
+    DenoiserOptions&                            options,
+    const size_t                                thread_count) const
+{
     const bool skip_denoised = m_params.get_optional<bool>("skip_denoised", true);
     options.m_marked_pixels_skipping_probability = skip_denoised ? 1.0f : 0.0f;
 
@@ -502,9 +618,28 @@ void Frame::denoise(
     options.m_mark_invalid_pixels =
         m_params.get_optional<bool>("mark_invalid_pixels", false);
 
+    options.m_tile_size =
+        m_params.get_optional<size_t>(
+            "denoise_tile_size",
+            options.m_tile_size);
+
+    // The memory limit is expressed in megabytes.
+    options.m_memory_limit =
+        m_params.get_optional<size_t>("denoise_memory_limit", 0) * 1024 * 1024;
+}
+
+void Frame::denoise(
+    JobQueue&                                   job_queue,
+    const size_t                                thread_count,
+    IAbortSwitch*                               abort_switch) const
+{
+    DenoiserOptions options;
+    get_denoiser_options(options, thread_count);
+
     assert(impl->m_denoiser_aov);
 
-    impl->m_denoiser_aov->fill_empty_samples();
+    Deepimf histograms_image;
+    impl->m_denoiser_aov->extract_histograms_image(histograms_image);
 
     Deepimf num_samples_image;
     impl->m_denoiser_aov->extract_num_samples_image(num_samples_image);
@@ -516,9 +651,10 @@ void Frame::denoise(
     denoise_beauty_image(
         image(),
         num_samples_image,
-        impl->m_denoiser_aov->histograms_image(),
+        histograms_image,
         covariances_image,
         options,
+        &job_queue,
         abort_switch);
 
     for (const AOV& aov : impl->m_aovs)
@@ -529,9 +665,10 @@ void Frame::denoise(
             denoise_aov_image(
                 aov.get_image(),
                 num_samples_image,
-                impl->m_denoiser_aov->histograms_image(),
+                histograms_image,
                 covariances_image,
                 options,
+                &job_queue,
                 abort_switch);
         }
     }
@@ -742,7 +879,7 @@ namespace
         DenoiserAOV*                    denoiser_aov)
     {
         // todo: reload denoiser checkpoint from the same file.
-        Deepimf& histograms_image = denoiser_aov->histograms_image();
+        Deepimf histograms_image;
         Deepimf& covariance_image = denoiser_aov->covariance_image();
         Deepimf& sum_image = denoiser_aov->sum_image();
 
@@ -759,20 +896,153 @@ namespace
         result = result && ImageIO::loadMultiChannelsEXR(sum_image, sum_file_path.c_str());
 
         if (!result)
+        {
+            RENDERER_LOG_ERROR("could not load denoiser checkpoint.");
+            return false;
+        }
+
+        if (!denoiser_aov->set_histograms_image(histograms_image))
+        {
+            RENDERER_LOG_ERROR("incorrect denoiser checkpoint: the accumulators don't match the renderer properties.");
+            return false;
+        }
+
+        return true;
+    }
+
+    void add_deep_image(
+        Deepimf&                        dest,
+        const Deepimf&                  source)
+    {
+        for (int y = 0, h = dest.getHeight(); y < h; ++y)
+        {
+            for (int x = 0, w = dest.getWidth(); x < w; ++x)
+            {
+                for (int c = 0, d = dest.getDepth(); c < d; ++c)
+                    dest.get(y, x, c) += source.get(y, x, c);
+            }
+        }
+    }
+
+    bool merge_denoiser_checkpoint(
+        const string&                   checkpoint_path,
+        DenoiserAOV*                    denoiser_aov)
+    {
+        // Load the accumulators of the checkpoint in temporary images.
+        Deepimf histograms_image;
+        Deepimf covariance_image;
+        Deepimf sum_image;
+
+        string hist_file_path, cov_file_path, sum_file_path;
+        get_denoiser_checkpoint_paths(checkpoint_path, hist_file_path, cov_file_path, sum_file_path);
+
+        bool result = ImageIO::loadMultiChannelsEXR(histograms_image, hist_file_path.c_str());
+        result = result && ImageIO::loadMultiChannelsEXR(covariance_image, cov_file_path.c_str());
+        result = result && ImageIO::loadMultiChannelsEXR(sum_image, sum_file_path.c_str());
+
+        if (!result)
+        {
             RENDERER_LOG_ERROR("could not load denoiser checkpoint.");
+            return false;
+        }
+
+        if (histograms_image.getWidth() != denoiser_aov->sum_image().getWidth() ||
+            histograms_image.getHeight() != denoiser_aov->sum_image().getHeight() ||
+            histograms_image.getDepth() != static_cast<int>(denoiser_aov->get_histograms_channel_count()))
+        {
+            RENDERER_LOG_ERROR("incorrect denoiser checkpoint: the accumulators don't match the renderer properties.");
+            return false;
+        }
+
+        // The denoiser accumulators are plain sums, they can be added together.
+        denoiser_aov->add_histograms_image(histograms_image);
+        add_deep_image(denoiser_aov->covariance_image(), covariance_image);
+        add_deep_image(denoiser_aov->sum_image(), sum_image);
+
+        return true;
+    }
+
+    void read_checkpoint_properties(
+        GenericProgressiveImageFileReader&  reader,
+        CheckpointProperties&               checkpoint_props)
+    {
+        size_t layer_index = 0;
+        while (reader.choose_subimage(layer_index))
+        {
+            CanvasProperties layer_canvas_props;
+            ImageAttributes layer_attributes;
+
+            reader.read_canvas_properties(layer_canvas_props);
+            reader.read_image_attributes(layer_attributes);
+
+            const string layer_name =
+                layer_attributes.exist("name")
+                    ? layer_attributes.get<string>("name")
+                    : "undefined";
+
+            checkpoint_props.emplace_back(
+                layer_name,
+                layer_canvas_props,
+                layer_attributes);
+
+            ++layer_index;
+        }
+    }
+
+    size_t get_checkpoint_first_pass(const CheckpointProperties& checkpoint_props)
+    {
+        // Checkpoints written before the introduction of pass ranges start at pass 0.
+        const ImageAttributes& exr_attributes = get<2>(checkpoint_props[0]);
+        return
+            exr_attributes.exist("appleseed:FirstPass")
+                ? exr_attributes.get<size_t>("appleseed:FirstPass")
+                : 0;
+    }
+
+    void read_unfiltered_aov_tiles(
+        GenericProgressiveImageFileReader&  reader,
+        const CheckpointProperties&         checkpoint_props,
+        const Frame&                        frame,
+        const size_t                        tile_x,
+        const size_t                        tile_y)
+    {
+        for (size_t i = 0; i < frame.aovs().size(); ++i)
+        {
+            UnfilteredAOV* aov = dynamic_cast<UnfilteredAOV*>(
+                frame.aovs().get_by_index(i));
+
+            if (aov == nullptr)
+                continue;
+
+            const string aov_name = aov->get_name();
+
+            // Search layer index in the file.
+            size_t subimage_index(~0);
+            for (size_t s = 0; s < checkpoint_props.size(); ++s)
+            {
+                if (get<0>(checkpoint_props[s]) == aov_name)
+                {
+                    subimage_index = s;
+                    break;
+                }
+            }
 
-        return result;
+            assert(subimage_index != size_t(~0));
+
+            Image& aov_image = aov->get_image();
+            Tile& aov_tile = aov_image.tile(tile_x, tile_y);
+            reader.choose_subimage(subimage_index);
+            reader.read_tile(tile_x, tile_y, &aov_tile);
+        }
     }
 
     void save_denoiser_checkpoint(
         const string&                   checkpoint_path,
-        const DenoiserAOV*              denoiser_aov)
+        const Deepimf&                  histograms_image,
+        const Deepimf&                  covariance_image,
+        const Deepimf&                  sum_image)
     {
         // todo: save denoiser checkpoint in the same file.
-        const Deepimf& histograms_image = denoiser_aov->histograms_image();
-        const Deepimf& covariance_image = denoiser_aov->covariance_image();
-        const Deepimf& sum_image = denoiser_aov->sum_image();
-
         string hist_file_path, cov_file_path, sum_file_path;
         get_denoiser_checkpoint_paths(checkpoint_path, hist_file_path, cov_file_path, sum_file_path);
 
@@ -788,6 +1058,149 @@ namespace
         if (!result)
             RENDERER_LOG_ERROR("could not save denoiser checkpoint.");
     }
+
+
+    //
+    // Writes a snapshot of the frame to a checkpoint file from a dedicated thread,
+    // such that rendering threads don't have to wait for the file to be written.
+    //
+
+    class CheckpointWriter
+      : public NonCopyable
+    {
+      public:
+        CheckpointWriter(
+            const string&               checkpoint_path,
+            const size_t                first_pass,
+            const size_t                pass)
+          : m_checkpoint_path(checkpoint_path)
+          , m_first_pass(first_pass)
+          , m_pass(pass)
+        {
+        }
+
+        // Add a copy of an image to the checkpoint. The image is written with
+        // default channel names if channel_names is empty.
+        void add_layer(
+            const char*                 name,
+            unique_ptr<Image>           image,
+            const vector<string>&       channel_names = vector<string>())
+        {
+            Layer layer;
+            layer.m_name = name;
+            layer.m_image = move(image);
+            layer.m_channel_names = channel_names;
+            m_layers.push_back(move(layer));
+        }
+
+        // Add a copy of the accumulators of the denoiser to the checkpoint.
+        void add_denoiser_images(const DenoiserAOV& denoiser_aov)
+        {
+            m_histograms_image.reset(new Deepimf());
+            denoiser_aov.extract_histograms_image(*m_histograms_image);
+            m_covariance_image.reset(new Deepimf(denoiser_aov.covariance_image()));
+            m_sum_image.reset(new Deepimf(denoiser_aov.sum_image()));
+        }
+
+        // Thread function.
+        void operator()()
+        {
+            set_current_thread_name("checkpoint");
+
+            try
+            {
+                write();
+            }
+            catch (const exception& e)
+            {
+                RENDERER_LOG_ERROR("could not write checkpoint file %s: %s.",
+                    m_checkpoint_path.c_str(),
+                    e.what());
+                return;
+            }
+
+            RENDERER_LOG_INFO("wrote checkpoint file %s for pass %s.",
+                m_checkpoint_path.c_str(),
+                pretty_uint(m_pass + 1).c_str());
+        }
+
+      private:
+        struct Layer
+        {
+            string                      m_name;
+            unique_ptr<Image>           m_image;
+            vector<string>              m_channel_names;
+        };
+
+        const string                    m_checkpoint_path;
+        const size_t                    m_first_pass;
+        const size_t                    m_pass;
+        vector<Layer>                   m_layers;
+        unique_ptr<Deepimf>             m_histograms_image;
+        unique_ptr<Deepimf>             m_covariance_image;
+        unique_ptr<Deepimf>             m_sum_image;
+
+        void write() const
+        {
+            create_parent_directories(m_checkpoint_path.c_str());
+
+            GenericImageFileWriter writer(m_checkpoint_path.c_str());
+
+            for (size_t i = 0, e = m_layers.size(); i < e; ++i)
+            {
+                const Layer& layer = m_layers[i];
+
+                writer.append_image(layer.m_image.get());
+
+                if (!layer.m_channel_names.empty())
+                {
+                    vector<const char*> channel_names;
+                    for (const string& channel_name : layer.m_channel_names)
+                        channel_names.push_back(channel_name.c_str());
+
+                    writer.set_image_channels(channel_names.size(), channel_names.data());
+                }
+
+                ImageAttributes image_attributes = ImageAttributes::create_default_attributes();
+                if (i == 0)
+                {
+                    image_attributes.insert("appleseed:FirstPass", m_first_pass);
+                    image_attributes.insert("appleseed:LastPass", m_pass);
+                }
+                image_attributes.insert("image_name", layer.m_name);
+                writer.set_image_attributes(image_attributes);
+            }
+
+            // Write the file.
+            writer.write();
+
+            // Save denoiser checkpoint (in external files).
+            if (m_histograms_image)
+            {
+                save_denoiser_checkpoint(
+                    m_checkpoint_path,
+                    *m_histograms_image,
+                    *m_covariance_image,
+                    *m_sum_image);
+            }
+        }
+    };
+}
+
+Frame::Impl::~Impl()
+{
+    wait_for_checkpoint();
+    wait_for_image_writes();
+}
+
+void Frame::Impl::wait_for_checkpoint()
+{
+    if (m_checkpoint_thread)
+    {
+        m_checkpoint_thread->join();
+        m_checkpoint_thread.reset();
+        m_checkpoint_writer.reset();
+    }
 }
 
 bool Frame::load_checkpoint(IShadingResultFrameBufferFactory* buffer_factory)
@@ -795,6 +1208,9 @@ bool Frame::load_checkpoint(IShadingResultFrameBufferFactory* buffer_factory)
     if  (!impl->m_checkpoint_resume)
         return true;
 
+    // Make sure the checkpoint isn't being written.
+    impl->wait_for_checkpoint();
+
     bf::path bf_path(impl->m_checkpoint_resume_path.c_str());
 
     // Check if the file exists.
@@ -810,27 +1226,7 @@ bool Frame::load_checkpoint(IShadingResultFrameBufferFactory* buffer_factory)
 
     // First, read layers name and properties.
     CheckpointProperties checkpoint_props;
-    size_t layer_index = 0;
-    while (reader.choose_subimage(layer_index))
-    {
-        CanvasProperties layer_canvas_props;
-        ImageAttributes layer_attributes;
-
-        reader.read_canvas_properties(layer_canvas_props);
-        reader.read_image_attributes(layer_attributes);
-
-        const string layer_name =
-            layer_attributes.exist("name")
-                ? layer_attributes.get<string>("name")
-                : "undefined";
-
-        checkpoint_props.emplace_back(
-            layer_name,
-            layer_canvas_props,
-            layer_attributes);
-
-        ++layer_index;
-    }
+    read_checkpoint_properties(reader, checkpoint_props);
 
     // Check checkpoint's compatibility.
     if (!is_checkpoint_compatible(impl->m_checkpoint_resume_path, *this, checkpoint_props))
@@ -841,7 +1237,7 @@ bool Frame::load_checkpoint(IShadingResultFrameBufferFactory* buffer_factory)
     const size_t start_pass = get<2>(checkpoint_props[0]).get<size_t>("appleseed:LastPass") + 1;
 
     // Check if passes have already been rendered.
-    if (impl->m_pass_count <= start_pass)
+    if (impl->m_pass_range_end <= start_pass)
     {
         RENDERER_LOG_WARNING("the requested passes have already been rendered and saved into the checkpoint.");
         return false;
@@ -866,36 +1262,7 @@ bool Frame::load_checkpoint(IShadingResultFrameBufferFactory* buffer_factory)
             // are in the shading buffer.
 
             // Read unfiltered AOV layers.
-            vector<unique_ptr<Tile>> aov_tiles;
-            vector<const float*> aov_ptrs;
-            for (size_t i = 0; i < aovs().size(); ++i)
-            {
-                UnfilteredAOV* aov = dynamic_cast<UnfilteredAOV*>(
-                    aovs().get_by_index(i));
-
-                if (aov == nullptr)
-                    continue;
-
-                const string aov_name = aov->get_name();
-
-                // Search layer index in the file.
-                size_t subimage_index(~0);
-                for (size_t s = 0; s < checkpoint_props.size(); ++s)
-                {
-                    if (get<0>(checkpoint_props[s]) == aov_name)
-                    {
-                        subimage_index = s;
-                        break;
-                    }
-                }
-
-                assert(subimage_index != size_t(~0));
-
-                Image& aov_image = aov->get_image();
-                Tile& aov_tile = aov_image.tile(tile_x, tile_y);
-                reader.choose_subimage(subimage_index);
-                reader.read_tile(tile_x, tile_y, &aov_tile);
-            }
+            read_unfiltered_aov_tiles(reader, checkpoint_props, *this, tile_x, tile_y);
         }
     }
 
@@ -919,6 +1286,114 @@ bool Frame::load_checkpoint(IShadingResultFrameBufferFactory* buffer_factory)
         pretty_uint(start_pass).c_str());
 
     impl->m_initial_pass = start_pass;
+    impl->m_checkpoint_first_pass = get_checkpoint_first_pass(checkpoint_props);
+
+    return true;
+}
+
+bool Frame::merge_checkpoints(const StringArray& checkpoint_paths)
+{
+    // Interface the shading buffer in a canvas.
+    PermanentShadingResultFrameBufferFactory buffer_factory(*this);
+    ShadingBufferCanvas shading_canvas(*this, &buffer_factory);
+    const CanvasProperties& props = image().properties();
+
+    vector<pair<size_t, size_t>> merged_pass_ranges;
+
+    for (size_t i = 0, e = checkpoint_paths.size(); i < e; ++i)
+    {
+        const string checkpoint_path = checkpoint_paths[i];
+
+        if (!bf::exists(bf::path(checkpoint_path.c_str())))
+        {
+            RENDERER_LOG_ERROR("checkpoint file %s does not exist.", checkpoint_path.c_str());
+            return false;
+        }
+
+        // Open the file and read layers name and properties.
+        GenericProgressiveImageFileReader reader;
+        reader.open(checkpoint_path.c_str());
+        CheckpointProperties checkpoint_props;
+        read_checkpoint_properties(reader, checkpoint_props);
+
+        // Check checkpoint's compatibility.
+        if (!is_checkpoint_compatible(checkpoint_path, *this, checkpoint_props))
+            return false;
+
+        // Passes rendered with the same noise seed produce the same samples,
+        // merging them would not reduce noise.
+        const size_t first_pass = get_checkpoint_first_pass(checkpoint_props);
+        const size_t last_pass = get<2>(checkpoint_props[0]).get<size_t>("appleseed:LastPass");
+        for (const pair<size_t, size_t>& range : merged_pass_ranges)
+        {
+            if (first_pass <= range.second && range.first <= last_pass)
+            {
+                RENDERER_LOG_WARNING(
+                    "passes of checkpoint file %s were already merged from another checkpoint file.",
+                    checkpoint_path.c_str());
+                break;
+            }
+        }
+        merged_pass_ranges.emplace_back(first_pass, last_pass);
+
+        for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
+        {
+            for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
+            {
+                // Accumulate the shading buffer. Samples are stored weighted along
+                // with their weight, so they can simply be added together.
+                reader.choose_subimage(1);
+                const unique_ptr<Tile> checkpoint_tile(reader.read_tile(tile_x, tile_y));
+                Tile& shading_tile = shading_canvas.tile(tile_x, tile_y);
+                assert(checkpoint_tile->get_pixel_count() == shading_tile.get_pixel_count());
+                assert(checkpoint_tile->get_channel_count() == shading_tile.get_channel_count());
+
+                for (size_t p = 0, pe = shading_tile.get_pixel_count(); p < pe; ++p)
+                {
+                    for (size_t c = 0, ce = shading_tile.get_channel_count(); c < ce; ++c)
+                    {
+                        shading_tile.set_component(
+                            p, c,
+                            shading_tile.get_component<float>(p, c) +
+                            checkpoint_tile->get_component<float>(p, c));
+                    }
+                }
+
+                // Unfiltered AOVs cannot be accumulated, they are read from the first checkpoint.
+                if (i == 0)
+                    read_unfiltered_aov_tiles(reader, checkpoint_props, *this, tile_x, tile_y);
+            }
+        }
+
+        // Accumulate the denoiser's checkpoint.
+        if (impl->m_denoiser_aov != nullptr)
+        {
+            const bool result =
+                i == 0
+                    ? load_denoiser_checkpoint(checkpoint_path, impl->m_denoiser_aov)
+                    : merge_denoiser_checkpoint(checkpoint_path, impl->m_denoiser_aov);
+
+            if (!result)
+                return false;
+        }
+
+        RENDERER_LOG_INFO("merged checkpoint file %s (passes %s to %s).",
+            checkpoint_path.c_str(),
+            pretty_uint(first_pass + 1).c_str(),
+            pretty_uint(last_pass + 1).c_str());
+    }
+
+    // Develop the merged shading buffer to the main image and the AOV images.
+    for (size_t tile_y = 0; tile_y < props.m_tile_count_y; ++tile_y)
+    {
+        for (size_t tile_x = 0; tile_x < props.m_tile_count_x; ++tile_x)
+        {
+            const ShadingResultFrameBuffer& framebuffer =
+                static_cast<const ShadingResultFrameBuffer&>(shading_canvas.tile(tile_x, tile_y));
+            TileStack aov_tiles = aov_images().tiles(tile_x, tile_y);
+            framebuffer.develop_to_tile(image().tile(tile_x, tile_y), aov_tiles);
+        }
+    }
 
     return true;
 }
@@ -930,75 +1405,86 @@ void Frame::save_checkpoint(
     if (!impl->m_checkpoint_create)
         return;
 
-    create_parent_directories(impl->m_checkpoint_create_path.c_str());
+    // Wait until the previous checkpoint is written.
+    impl->wait_for_checkpoint();
 
-    GenericImageFileWriter writer(impl->m_checkpoint_create_path.c_str());
+    // Take a snapshot of the frame. Copying images is cheap compared to encoding
+    // and writing them, and lets the next pass start right away.
+    unique_ptr<CheckpointWriter> checkpoint_writer(
+        new CheckpointWriter(impl->m_checkpoint_create_path, impl->m_checkpoint_first_pass, pass));
 
     // Add the beauty image.
-    {
-        writer.append_image(&image());
-        ImageAttributes image_attributes = ImageAttributes::create_default_attributes();
-        image_attributes.insert("appleseed:LastPass", pass);
-        image_attributes.insert("image_name", "beauty");
-        writer.set_image_attributes(image_attributes);
-    }
+    checkpoint_writer->add_layer("beauty", unique_ptr<Image>(new Image(image())));
 
     // Buffer containing pixels' weight.
     ShadingBufferCanvas pixels_weight_buffer(*this, buffer_factory);
-    const size_t shading_channel_count = pixels_weight_buffer.properties().m_channel_count;
+    const CanvasProperties& shading_props = pixels_weight_buffer.properties();
+    const size_t shading_channel_count = shading_props.m_channel_count;
 
     // Create channel names.
     vector<string> shading_channel_names;
-    vector<const char *> shading_channel_names_cstr;
     {
         static const string channel_name_prefix = "channel_";
         for (size_t i = 0; i < shading_channel_count; ++i)
-        {
             shading_channel_names.push_back(channel_name_prefix + pad_left(to_string(i + 1), '0', 4));
-            shading_channel_names_cstr.push_back(shading_channel_names[i].c_str());
-        }
 
         assert(shading_channel_names.size() == shading_channel_count);
     }
 
     // Add the shading buffer.
     {
-        writer.append_image(&pixels_weight_buffer);
-        writer.set_image_channels(shading_channel_count, shading_channel_names_cstr.data());
+        unique_ptr<Image> shading_image(new Image(shading_props));
 
-        ImageAttributes image_attributes = ImageAttributes::create_default_attributes();
-        image_attributes.insert("image_name", "appleseed:RenderingBuffer");
-        writer.set_image_attributes(image_attributes);
+        for (size_t tile_y = 0; tile_y < shading_props.m_tile_count_y; ++tile_y)
+        {
+            for (size_t tile_x = 0; tile_x < shading_props.m_tile_count_x; ++tile_x)
+                shading_image->tile(tile_x, tile_y).copy_from(pixels_weight_buffer.tile(tile_x, tile_y));
+        }
+
+        checkpoint_writer->add_layer(
+            "appleseed:RenderingBuffer",
+            move(shading_image),
+            shading_channel_names);
     }
 
     // Add AOV images.
     for (const AOV& aov : aovs())
     {
-        const char* aov_name = aov.get_name();
-        const Image& aov_image = aov.get_image();
-        writer.append_image(&aov_image);
-        writer.set_image_channels(aov.get_channel_count(), aov.get_channel_names());
+        const char** aov_channel_names = aov.get_channel_names();
 
-        ImageAttributes image_attributes = ImageAttributes::create_default_attributes();
-        image_attributes.insert("image_name", aov_name);
-        writer.set_image_attributes(image_attributes);
+        checkpoint_writer->add_layer(
+            aov.get_name(),
+            unique_ptr<Image>(new Image(aov.get_image())),
+            vector<string>(aov_channel_names, aov_channel_names + aov.get_channel_count()));
     }
 
-    // Write the file.
-    writer.write();
-
     // Add internal AOVs layers (in external files).
     for (const AOV& aov : internal_aovs())
     {
-        // Save denoiser checkpoint.
         const DenoiserAOV* denoiser_aov = dynamic_cast<const DenoiserAOV*>(&aov);
         if (denoiser_aov != nullptr)
-            save_denoiser_checkpoint(impl->m_checkpoint_create_path, denoiser_aov);
+            checkpoint_writer->add_denoiser_images(*denoiser_aov);
     }
 
-    RENDERER_LOG_INFO("wrote checkpoint file %s for pass %s.",
-        impl->m_checkpoint_create_path.c_str(),
-        pretty_uint(pass + 1).c_str());
+    // Write the checkpoint in the background.
+    impl->m_checkpoint_writer = move(checkpoint_writer);
+    impl->m_checkpoint_thread.reset(
+        new boost::thread(
+            ThreadFunctionWrapper<CheckpointWriter>(impl->m_checkpoint_writer.get())));
+}
+
+void Frame::wait_for_checkpoint() const
+{
+    impl->wait_for_checkpoint();
+}
+
+void Frame::Impl::wait_for_image_writes()
+{
+    if (m_image_write_thread)
+    {
+        m_image_write_thread->join();
+        m_image_write_thread.reset();
+    }
 }
 
 namespace
@@ -1112,11 +1598,194 @@ namespace
 
         return true;
     }
-}
 
-bool Frame::write_main_image(const char* file_path) const
-{
-    assert(file_path);
+    typedef vector<function<bool ()>> ImageWriteVector;
+
+    class ImageWriteJob
+      : public IJob
+    {
+      public:
+        ImageWriteJob(
+            const function<bool ()>&    write,
+            boost::atomic<bool>&        success)
+          : m_write(write)
+          , m_success(success)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            try
+            {
+                if (!m_write())
+                    m_success.store(false);
+            }
+            catch (const exception& e)
+            {
+                RENDERER_LOG_ERROR("failed to write image file: %s.", e.what());
+                m_success.store(false);
+            }
+        }
+
+      private:
+        const function<bool ()>&        m_write;
+        boost::atomic<bool>&            m_success;
+    };
+
+    // Write image files concurrently.
+    bool execute_image_writes(const ImageWriteVector& writes)
+    {
+        const size_t core_count = System::get_logical_cpu_core_count();
+
+        // Let OpenEXR compress the blocks of each file in parallel as well.
+        OIIO::attribute("exr_threads", static_cast<int>(core_count));
+
+        const size_t thread_count = min(core_count, writes.size());
+
+        if (thread_count < 2)
+        {
+            bool success = true;
+
+            for (const auto& write : writes)
+            {
+                if (!write())
+                    success = false;
+            }
+
+            return success;
+        }
+
+        boost::atomic<bool> success(true);
+
+        JobQueue job_queue;
+
+        for (const auto& write : writes)
+            job_queue.schedule(new ImageWriteJob(write, success));
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            thread_count,
+            JobManager::KeepRunningOnEmptyQueue);
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+        job_manager.stop();
+
+        return success.load();
+    }
+
+    function<bool ()> make_aov_image_write(const AOV& aov, const string& file_path)
+    {
+        return
+            [&aov, file_path]()
+            {
+                ImageAttributes image_attributes = ImageAttributes::create_default_attributes();
+                return aov.write_images(file_path.c_str(), image_attributes);
+            };
+    }
+
+    // Collect the writes of AOV images to files named after a given main image file.
+    void collect_aov_image_writes(
+        const AOVContainer&                 aovs,
+        const function<bool (const AOV&)>&  is_released,
+        const char*                         file_path,
+        ImageWriteVector&                   writes)
+    {
+        if (aovs.empty())
+            return;
+
+        bf::path bf_file_path(file_path);
+        const string extension = lower_case(bf_file_path.extension().string());
+
+        if (extension != ".exr")
+        {
+            if (has_extension(bf_file_path))
+            {
+                RENDERER_LOG_WARNING(
+                    "aovs cannot be saved to %s files; saving them to exr files instead.",
+                    extension.substr(1).c_str());
+            }
+
+            bf_file_path.replace_extension(".exr");
+        }
+
+        const bf::path directory = bf_file_path.parent_path();
+        const string base_file_name = bf_file_path.stem().string();
+
+        for (const AOV& aov : aovs)
+        {
+            // Streamed AOVs are in the image file written by output streaming.
+            if (is_released(aov))
+                continue;
+
+            // Compute AOV image file path.
+            const string aov_name = aov.get_name();
+            const string safe_aov_name = make_safe_filename(aov_name);
+            const string aov_file_name = base_file_name + "." + safe_aov_name + ".exr";
+            const string aov_file_path = (directory / aov_file_name).string();
+
+            writes.push_back(make_aov_image_write(aov, aov_file_path));
+        }
+    }
+
+    // Collect the writes of AOV images to the files named by their "output_filename" parameter.
+    void collect_aov_image_writes(
+        const AOVContainer&                 aovs,
+        const function<bool (const AOV&)>&  is_released,
+        ImageWriteVector&                   writes)
+    {
+        for (const AOV& aov : aovs)
+        {
+            // Streamed AOVs are in the image file written by output streaming.
+            if (is_released(aov))
+                continue;
+
+            bf::path bf_file_path = aov.get_parameters().get_optional<string>("output_filename");
+            if (bf_file_path.empty())
+                continue;
+
+            const string extension = lower_case(bf_file_path.extension().string());
+            if (extension != ".exr")
+            {
+                if (has_extension(bf_file_path))
+                {
+                    RENDERER_LOG_WARNING(
+                        "aov \"%s\" cannot be saved to %s file; saving it to exr file instead.",
+                        aov.get_path().c_str(),
+                        extension.substr(1).c_str());
+                }
+
+                bf_file_path.replace_extension(".exr");
+            }
+
+            writes.push_back(make_aov_image_write(aov, bf_file_path.string()));
+        }
+    }
+}
+
+bool Frame::write_main_image(const char* file_path) const
+{
+    assert(file_path);
+
+    TraceScope trace_scope("output", "write main image");
+
+    // Don't overwrite the image file written by output streaming.
+    if (impl->m_output_streamed)
+    {
+        if (bf::path(file_path) == bf::path(impl->m_stream_file_path))
+            return true;
+
+        if (impl->has_released_main_image())
+        {
+            RENDERER_LOG_ERROR(
+                "cannot write image file %s: frame \"%s\" was streamed to %s and is no longer in memory.",
+                file_path,
+                get_path().c_str(),
+                impl->m_stream_file_path.c_str());
+            return false;
+        }
+    }
 
     // Convert main image to half floats.
     const Image& image = *impl->m_image;
@@ -1148,87 +1817,64 @@ bool Frame::write_aov_images(const char* file_path) const
 {
     assert(file_path);
 
-    if (impl->m_aovs.empty())
-        return true;
+    TraceScope trace_scope("output", "write aov images");
 
-    bf::path bf_file_path(file_path);
-    const string extension = lower_case(bf_file_path.extension().string());
-
-    if (extension != ".exr")
-    {
-        if (has_extension(bf_file_path))
-        {
-            RENDERER_LOG_WARNING(
-                "aovs cannot be saved to %s files; saving them to exr files instead.",
-                extension.substr(1).c_str());
-        }
+    ImageWriteVector writes;
+    collect_aov_image_writes(
+        impl->m_aovs,
+        [this](const AOV& aov) { return impl->has_released_aov_image(aov); },
+        file_path,
+        writes);
 
-        bf_file_path.replace_extension(".exr");
-    }
+    return execute_image_writes(writes);
+}
 
-    const bf::path directory = bf_file_path.parent_path();
-    const string base_file_name = bf_file_path.stem().string();
+bool Frame::write_main_and_aov_images(const char* file_path) const
+{
+    const auto is_released = [this](const AOV& aov) { return impl->has_released_aov_image(aov); };
 
-    bool success = true;
+    ImageWriteVector writes;
 
-    for (const AOV& aov : impl->m_aovs)
+    if (file_path != nullptr)
     {
-        // Compute AOV image file path.
-        const string aov_name = aov.get_name();
-        const string safe_aov_name = make_safe_filename(aov_name);
-        const string aov_file_name = base_file_name + "." + safe_aov_name + ".exr";
-        const string aov_file_path = (directory / aov_file_name).string();
-
-        // Write AOV image.
-        ImageAttributes image_attributes = ImageAttributes::create_default_attributes();
-        if (!aov.write_images(aov_file_path.c_str(), image_attributes))
-            success = false;
+        // Write the same files as write_main_image() and write_aov_images().
+        const string main_file_path = file_path;
+        writes.push_back([this, main_file_path]() { return write_main_image(main_file_path.c_str()); });
+        collect_aov_image_writes(impl->m_aovs, is_released, file_path, writes);
+    }
+    else
+    {
+        const string main_file_path = get_parameters().get_optional<string>("output_filename");
+        if (!main_file_path.empty())
+            writes.push_back([this, main_file_path]() { return write_main_image(main_file_path.c_str()); });
+        collect_aov_image_writes(impl->m_aovs, is_released, writes);
     }
 
-    return success;
+    return execute_image_writes(writes);
 }
 
-bool Frame::write_main_and_aov_images() const
+void Frame::write_main_and_aov_images_in_background(const char* file_path) const
 {
-    bool success = true;
+    // Only one set of images is written at a time.
+    impl->wait_for_image_writes();
 
-    // Write main image.
-    {
-        const string file_path = get_parameters().get_optional<string>("output_filename");
-        if (!file_path.empty())
-        {
-            if (!write_main_image(file_path.c_str()))
-                success = false;
-        }
-    }
+    const string main_file_path = file_path != nullptr ? file_path : "";
 
-    // Write AOV images.
-    for (const AOV& aov : impl->m_aovs)
-    {
-        bf::path bf_file_path = aov.get_parameters().get_optional<string>("output_filename");
-        if (!bf_file_path.empty())
-        {
-            const string extension = lower_case(bf_file_path.extension().string());
-            if (extension != ".exr")
+    impl->m_image_write_thread.reset(
+        new boost::thread(
+            [this, main_file_path]()
             {
-                if (has_extension(bf_file_path))
-                {
-                    RENDERER_LOG_WARNING(
-                        "aov \"%s\" cannot be saved to %s file; saving it to exr file instead.",
-                        aov.get_path().c_str(),
-                        extension.substr(1).c_str());
-                }
+                set_current_thread_name("image_writer");
 
-                bf_file_path.replace_extension(".exr");
-            }
-
-            ImageAttributes image_attributes = ImageAttributes::create_default_attributes();
-            if (!aov.write_images(bf_file_path.string().c_str(), image_attributes))
-                success = false;
-        }
-    }
+                if (!write_main_and_aov_images(main_file_path.empty() ? nullptr : main_file_path.c_str()))
+                    impl->m_image_write_failed.store(true);
+            }));
+}
 
-    return success;
+bool Frame::wait_for_image_writes() const
+{
+    impl->wait_for_image_writes();
+    return !impl->m_image_write_failed.exchange(false);
 }
 
 void Frame::write_main_and_aov_images_to_multipart_exr(const char* file_path) const
@@ -1286,12 +1932,264 @@ void Frame::write_main_and_aov_images_to_multipart_exr(const char* file_path) co
         pretty_time(stopwatch.get_seconds()).c_str());
 }
 
+bool Frame::begin_output_streaming(const bool release_tiles) const
+{
+    assert(!impl->m_stream_writer);
+
+    impl->m_output_streamed = false;
+
+    if (!impl->m_output_streaming)
+        return false;
+
+    bf::path bf_file_path = get_parameters().get_optional<string>("output_filename");
+
+    if (bf_file_path.empty())
+    {
+        RENDERER_LOG_WARNING("output streaming requires an output filename; disabling output streaming.");
+        return false;
+    }
+
+    if (lower_case(bf_file_path.extension().string()) != ".exr")
+    {
+        if (has_extension(bf_file_path))
+            RENDERER_LOG_WARNING("output streaming is only supported with exr files; disabling output streaming.");
+        return false;
+    }
+
+    // These features need the whole frame after rendering.
+    if (impl->m_denoising_mode != DenoisingMode::Off ||
+        impl->m_checkpoint_create ||
+        !impl->m_post_processing_stages.empty())
+    {
+        RENDERER_LOG_WARNING(
+            "output streaming is not compatible with denoising, checkpoints and post-processing stages; "
+            "disabling output streaming.");
+        return false;
+    }
+
+    try
+    {
+        create_parent_directories(bf_file_path);
+
+        const string file_path = bf_file_path.string();
+        unique_ptr<GenericProgressiveImageFileWriter> writer(
+            new GenericProgressiveImageFileWriter(file_path.c_str()));
+
+        // The main image is always saved as half floats.
+        const char* main_channel_names[] = { "R", "G", "B", "A" };
+        writer->add_channels(4, main_channel_names, PixelFormatHalf);
+
+        // AOV channels are prefixed with the name of the AOV.
+        impl->m_streamed_aovs.clear();
+        vector<string> aov_channel_names;
+        for (AOV& aov : impl->m_aovs)
+        {
+            if (!aov.supports_streaming())
+                continue;
+
+            const size_t channel_count = aov.get_channel_count();
+            const char** channel_names = aov.get_channel_names();
+
+            aov_channel_names.clear();
+            for (size_t i = 0; i < channel_count; ++i)
+                aov_channel_names.push_back(string(aov.get_name()) + "." + channel_names[i]);
+
+            vector<const char*> aov_channel_name_ptrs;
+            for (const string& name : aov_channel_names)
+                aov_channel_name_ptrs.push_back(name.c_str());
+
+            // If the AOV has color data, assume we can save it as half floats.
+            writer->add_channels(
+                channel_count,
+                aov_channel_name_ptrs.data(),
+                aov.has_color_data() ? PixelFormatHalf : PixelFormatFloat);
+
+            impl->m_streamed_aovs.push_back(&aov);
+        }
+
+        ImageAttributes image_attributes = ImageAttributes::create_default_attributes();
+        add_chromaticities_attributes(image_attributes);
+        image_attributes.insert("color_space", "linear");
+
+        writer->open(
+            impl->m_frame_width,
+            impl->m_frame_height,
+            impl->m_tile_width,
+            impl->m_tile_height,
+            image_attributes);
+
+        impl->m_stream_writer = move(writer);
+        impl->m_stream_file_path = file_path;
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_ERROR(
+            "failed to open image file %s for streaming frame \"%s\": %s.",
+            bf_file_path.string().c_str(),
+            get_path().c_str(),
+            e.what());
+
+        impl->m_streamed_aovs.clear();
+        return false;
+    }
+
+    // AOVs that are not streamed may read the main image during post-processing.
+    impl->m_release_streamed_tiles =
+        release_tiles && impl->m_streamed_aovs.size() == impl->m_aovs.size();
+    impl->m_stream_failed = false;
+
+    RENDERER_LOG_INFO(
+        "streaming frame \"%s\" to image file %s%s.",
+        get_path().c_str(),
+        impl->m_stream_file_path.c_str(),
+        impl->m_release_streamed_tiles ? ", releasing tiles once written" : "");
+
+    return true;
+}
+
+void Frame::stream_tile(
+    const size_t                                tile_x,
+    const size_t                                tile_y) const
+{
+    if (!impl->m_stream_writer || impl->m_stream_failed)
+        return;
+
+    vector<const Tile*> tiles;
+    tiles.reserve(1 + impl->m_streamed_aovs.size());
+    tiles.push_back(&impl->m_image->tile(tile_x, tile_y));
+    for (const AOV* aov : impl->m_streamed_aovs)
+        tiles.push_back(&aov->get_image().tile(tile_x, tile_y));
+
+    try
+    {
+        impl->m_stream_writer->write_tile(tile_x, tile_y, tiles.data());
+    }
+    catch (const exception& e)
+    {
+        // Keep the remaining tiles in memory such that they can still be written at the end.
+        if (!impl->m_stream_failed.exchange(true))
+        {
+            RENDERER_LOG_ERROR(
+                "failed to stream tile (" FMT_SIZE_T ", " FMT_SIZE_T ") of frame \"%s\": %s.",
+                tile_x,
+                tile_y,
+                get_path().c_str(),
+                e.what());
+        }
+
+        return;
+    }
+
+    if (impl->m_release_streamed_tiles)
+    {
+        impl->m_image->set_tile(tile_x, tile_y, nullptr);
+        for (const AOV* aov : impl->m_streamed_aovs)
+            aov->get_image().set_tile(tile_x, tile_y, nullptr);
+    }
+}
+
+bool Frame::end_output_streaming() const
+{
+    if (!impl->m_stream_writer)
+        return false;
+
+    bool success = !impl->m_stream_failed;
+
+    try
+    {
+        impl->m_stream_writer->close();
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_ERROR(
+            "failed to write image file %s for frame \"%s\": %s.",
+            impl->m_stream_file_path.c_str(),
+            get_path().c_str(),
+            e.what());
+
+        success = false;
+    }
+
+    impl->m_stream_writer.reset();
+    impl->m_output_streamed = success;
+
+    if (success)
+    {
+        RENDERER_LOG_INFO(
+            "wrote image file %s for frame \"%s\".",
+            impl->m_stream_file_path.c_str(),
+            get_path().c_str());
+    }
+    else impl->m_streamed_aovs.clear();
+
+    return success;
+}
+
+bool Frame::is_output_streamed() const
+{
+    return impl->m_output_streamed;
+}
+
+size_t Frame::begin_incremental_post_processing() const
+{
+    impl->m_incremental_stages.clear();
+
+    if (impl->m_denoising_mode == DenoisingMode::Denoise || impl->m_checkpoint_create)
+        return 0;
+
+    vector<PostProcessingStage*> ordered_stages;
+    get_ordered_post_processing_stages(impl->m_post_processing_stages, ordered_stages);
+
+    for (PostProcessingStage* stage : ordered_stages)
+    {
+        // Later stages depend on the output of this one on the whole frame.
+        if (!stage->supports_incremental_execution())
+            break;
+
+        stage->begin_tiled_execution(*this);
+        impl->m_incremental_stages.push_back(stage);
+    }
+
+    if (!impl->m_incremental_stages.empty())
+    {
+        RENDERER_LOG_INFO(
+            "executing %s %s on tiles of frame \"%s\" as they are rendered.",
+            pretty_uint(impl->m_incremental_stages.size()).c_str(),
+            plural(impl->m_incremental_stages.size(), "post-processing stage").c_str(),
+            get_path().c_str());
+    }
+
+    return impl->m_incremental_stages.size();
+}
+
+void Frame::post_process_tile(
+    const size_t                                tile_x,
+    const size_t                                tile_y) const
+{
+    for (const PostProcessingStage* stage : impl->m_incremental_stages)
+        stage->execute_tile(*this, tile_x, tile_y);
+}
+
+size_t Frame::get_incremental_post_processing_stage_count() const
+{
+    return impl->m_incremental_stages.size();
+}
+
 bool Frame::archive(
     const char*                                 directory,
     char**                                      output_path) const
 {
     assert(directory);
 
+    if (impl->has_released_main_image())
+    {
+        RENDERER_LOG_WARNING(
+            "cannot archive frame \"%s\": it was streamed to %s and is no longer in memory.",
+            get_path().c_str(),
+            impl->m_stream_file_path.c_str());
+        return false;
+    }
+
     // Construct the name of the image file.
     const string filename = "autosave." + get_time_stamp_string() + ".exr";
 
@@ -1306,6 +2204,31 @@ bool Frame::archive(
     return write_image(*this, file_path.c_str(), *impl->m_image, image_attributes);
 }
 
+namespace
+{
+    // Return the largest tile size that cuts the frame into enough tiles
+    // for the rendering threads to share the load evenly.
+    size_t compute_auto_tile_size(
+        const size_t    frame_width,
+        const size_t    frame_height,
+        const size_t    thread_count)
+    {
+        const size_t TileSizes[] = { 64, 48, 32, 24, 16 };
+        const size_t MinTilesPerThread = 8;
+
+        for (const size_t tile_size : TileSizes)
+        {
+            const size_t tile_count_x = (frame_width + tile_size - 1) / tile_size;
+            const size_t tile_count_y = (frame_height + tile_size - 1) / tile_size;
+
+            if (tile_count_x * tile_count_y >= MinTilesPerThread * thread_count)
+                return tile_size;
+        }
+
+        return TileSizes[countof(TileSizes) - 1];
+    }
+}
+
 void Frame::extract_parameters()
 {
     // Retrieve frame resolution parameter.
@@ -1328,6 +2251,18 @@ void Frame::extract_parameters()
     }
 
     // Retrieve tile size parameter.
+    if (m_params.strings().exist("tile_size") &&
+        m_params.strings().get<string>("tile_size") == "auto")
+    {
+        const size_t tile_size =
+            compute_auto_tile_size(
+                impl->m_frame_width,
+                impl->m_frame_height,
+                System::get_logical_cpu_core_count());
+        impl->m_tile_width = tile_size;
+        impl->m_tile_height = tile_size;
+    }
+    else
     {
         const Vector2i DefaultTileSize(64, 64);
         Vector2i tile_size = m_params.get_optional<Vector2i>("tile_size", DefaultTileSize);
@@ -1494,6 +2429,9 @@ void Frame::extract_parameters()
         }
     }
 
+    // Retrieve output streaming parameter.
+    impl->m_output_streaming = m_params.get_optional<bool>("output_streaming", false);
+
     // Retrieve reference image path parameters.
     impl->m_ref_image_path = m_params.get_optional<string>("reference_image", "");
 }
@@ -1580,6 +2518,13 @@ DictionaryArray FrameFactory::get_input_metadata()
             .insert("use", "optional")
             .insert("default", "0"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "pass_range")
+            .insert("label", "Pass Range")
+            .insert("type", "text")
+            .insert("use", "optional"));
+
     metadata.push_back(
         Dictionary()
             .insert("name", "enable_dithering")
@@ -1588,6 +2533,14 @@ DictionaryArray FrameFactory::get_input_metadata()
             .insert("use", "optional")
             .insert("default", "true"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "output_streaming")
+            .insert("label", "Output Streaming")
+            .insert("type", "boolean")
+            .insert("use", "optional")
+            .insert("default", "false"));
+
     metadata.push_back(
         Dictionary()
             .insert("name", "denoiser")
@@ -1692,6 +2645,36 @@ DictionaryArray FrameFactory::get_input_metadata()
                 Dictionary()
                     .insert("denoiser", "on")));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "denoise_tile_size")
+            .insert("label", "Denoise Tile Size")
+            .insert("type", "integer")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "0")
+                    .insert("type", "hard"))
+            .insert("use", "optional")
+            .insert("default", "0")
+            .insert("visible_if",
+                Dictionary()
+                    .insert("denoiser", "on")));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "denoise_memory_limit")
+            .insert("label", "Denoise Memory Limit")
+            .insert("type", "integer")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "0")
+                    .insert("type", "hard"))
+            .insert("use", "optional")
+            .insert("default", "0")
+            .insert("visible_if",
+                Dictionary()
+                    .insert("denoiser", "on")));
+
     metadata.push_back(
         Dictionary()
             .insert("name", "mark_invalid_pixels")
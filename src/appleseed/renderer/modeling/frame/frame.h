@@ -56,12 +56,14 @@ namespace foundation    { class FilterSamplingTable; }
 namespace foundation    { class IAbortSwitch; }
 namespace foundation    { class Image; }
 namespace foundation    { class ImageAttributes; }
+namespace foundation    { class JobQueue; }
 namespace foundation    { class SearchPaths; }
 namespace foundation    { class StringArray; }
 namespace foundation    { class StringDictionary; }
 namespace foundation    { class Tile; }
 namespace renderer      { class BaseGroup; }
 namespace renderer      { class DenoiserAOV; }
+namespace renderer      { class DenoiserOptions; }
 namespace renderer      { class ImageStack; }
 namespace renderer      { class IShadingResultFrameBufferFactory; }
 namespace renderer      { class OnFrameBeginRecorder; }
@@ -119,9 +121,15 @@ class APPLESEED_DLLSYMBOL Frame
     const foundation::FilterSamplingTable& get_filter_sampling_table() const;
 
     // Return the number of the first pass to be rendered.
-    // 0 by default but can be different if a checkpoint was loaded.
+    // 0 by default but can be different if a checkpoint was loaded
+    // or if the "pass_range" parameter is set.
     size_t get_initial_pass() const;
 
+    // Return the number of the pass following the last pass to be rendered.
+    // The number of passes by default but can be smaller if the "pass_range"
+    // parameter is set.
+    size_t get_end_pass() const;
+
     // Set/get the crop window. The crop window is inclusive on all sides.
     void reset_crop_window();
     bool has_crop_window() const;
@@ -179,8 +187,18 @@ class APPLESEED_DLLSYMBOL Frame
     // Retrieve the selected denoising mode.
     DenoisingMode get_denoising_mode() const;
 
-    // Run the denoiser on the frame.
+    // Return the denoiser AOV, or nullptr if denoising is disabled.
+    DenoiserAOV* denoiser_aov() const;
+
+    // Retrieve the denoiser options set on the frame.
+    void get_denoiser_options(
+        DenoiserOptions&                            options,
+        const size_t                                thread_count) const;
+
+    // Run the denoiser on the frame. When tiled denoising is enabled, tiles are
+    // denoised in parallel on the given job queue.
     void denoise(
+        foundation::JobQueue&                       job_queue,
         const size_t                                thread_count,
         foundation::IAbortSwitch*                   abort_switch) const;
 
@@ -188,11 +206,58 @@ class APPLESEED_DLLSYMBOL Frame
     // Returns true if successful, false otherwise.
     bool load_checkpoint(IShadingResultFrameBufferFactory*  buffer_factory);
 
+    // Accumulate the shading buffers of checkpoint files rendered with distinct pass
+    // ranges, then develop the result to the main image and the AOV images. Unfiltered
+    // AOVs are read from the first checkpoint file.
+    // Returns true if successful, false otherwise.
+    bool merge_checkpoints(const foundation::StringArray& checkpoint_paths);
+
     // Create a checkpoint file for the resuming the render at the current pass.
+    // The frame is copied and the file is written in the background.
     void save_checkpoint(
         IShadingResultFrameBufferFactory*           buffer_factory,
         const size_t                                pass) const;
 
+    // Wait until the checkpoint file created by save_checkpoint() is written to disk.
+    void wait_for_checkpoint() const;
+
+    // If the "output_streaming" parameter is enabled, open the frame's output file
+    // such that finished tiles of the main image and of the AOVs that support it
+    // can be written while the frame is rendering. If release_tiles is true, tiles
+    // are released from memory once written.
+    // Return true if streaming has begun, false otherwise.
+    bool begin_output_streaming(const bool release_tiles) const;
+
+    // Write a finished tile to the output file if output streaming has begun.
+    // This method is thread-safe.
+    void stream_tile(
+        const size_t                                tile_x,
+        const size_t                                tile_y) const;
+
+    // Complete and close the output file if output streaming has begun.
+    // Return true if successful, false otherwise.
+    bool end_output_streaming() const;
+
+    // Return true if the main image was written by output streaming.
+    bool is_output_streamed() const;
+
+    // Begin executing post-processing stages on tiles as they are finished during the
+    // last rendering pass. Only the leading stages, in execution order, that support
+    // incremental execution are executed this way, and only if denoising and checkpoints
+    // are disabled since both need the frame before post-processing.
+    // Return the number of post-processing stages executed incrementally.
+    size_t begin_incremental_post_processing() const;
+
+    // Execute the incremental post-processing stages on a finished tile.
+    // This method is thread-safe.
+    void post_process_tile(
+        const size_t                                tile_x,
+        const size_t                                tile_y) const;
+
+    // Return the number of leading post-processing stages, in execution order, that
+    // were executed on the tiles of the frame during rendering.
+    size_t get_incremental_post_processing_stage_count() const;
+
     // Write the main image to disk.
     // Return true if successful, false otherwise.
     bool write_main_image(const char* file_path) const;
@@ -201,10 +266,23 @@ class APPLESEED_DLLSYMBOL Frame
     // Return true if successful, false otherwise.
     bool write_aov_images(const char* file_path) const;
 
-    // Write the main image and the AOV images to disk.
-    // Output file paths are taken from the frame's and AOVs' "output_filename" parameters.
+    // Write the main image and the AOV images to disk. The files are written concurrently.
+    // If file_path is provided, the main image is written to this file and AOV images next
+    // to it, like write_main_image() and write_aov_images() do. Otherwise output file paths
+    // are taken from the frame's and AOVs' "output_filename" parameters.
     // Return true if successful, false otherwise.
-    bool write_main_and_aov_images() const;
+    bool write_main_and_aov_images(const char* file_path = nullptr) const;
+
+    // Same as write_main_and_aov_images() but the files are written in the background,
+    // for instance while the next frame of an animation is being set up. The images must
+    // not be modified until wait_for_image_writes() returns; on_frame_begin() waits for
+    // the writes to complete.
+    void write_main_and_aov_images_in_background(const char* file_path = nullptr) const;
+
+    // Wait until the image files written in the background are on disk.
+    // Return true if all image files written in the background since the last call were
+    // successfully written, false otherwise.
+    bool wait_for_image_writes() const;
 
     // Write the main image and the AOV images to a multipart OpenEXR file.
     void write_main_and_aov_images_to_multipart_exr(const char* file_path) const;
@@ -37,6 +37,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/platform/types.h"
+#include "foundation/utility/alignedallocator.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/memory.h"
 #include "foundation/utility/otherwise.h"
@@ -329,11 +330,56 @@ namespace
     };
 
     typedef vector<Input> InputVector;
+
+    struct VaryingInput
+    {
+        size_t          m_index;            // index of the input
+        size_t          m_offset;           // offset of the input value, before alignment
+    };
+
+    typedef vector<VaryingInput> VaryingInputVector;
 }
 
 struct InputArray::Impl
 {
-    InputVector m_inputs;
+    InputVector         m_inputs;
+
+    // Values of all inputs as laid out by evaluate(), with varying inputs set to zero.
+    vector<uint8, AlignedAllocator<uint8>>
+                        m_uniform_values;
+
+    // Inputs bound to varying sources.
+    VaryingInputVector  m_varying_inputs;
+
+    // Recompute the uniform values and the list of varying inputs.
+    // Must be called whenever an input is declared or bound.
+    void update_uniform_values()
+    {
+        m_varying_inputs.clear();
+
+        size_t size = 0;
+        for (size_t i = 0, e = m_inputs.size(); i < e; ++i)
+        {
+            const Input& input = m_inputs[i];
+
+            if (input.m_source && !input.m_source->is_uniform())
+            {
+                VaryingInput varying_input;
+                varying_input.m_index = i;
+                varying_input.m_offset = size;
+                m_varying_inputs.push_back(varying_input);
+            }
+
+            size = input.add_size(size);
+        }
+
+        // Start from zeroes so that all spectrum samples are defined regardless of the spectrum mode.
+        m_uniform_values.assign(size, 0);
+
+        uint8* ptr = m_uniform_values.empty() ? nullptr : &m_uniform_values[0];
+        for (const_each<InputVector> i = m_inputs; i; ++i)
+            ptr = i->evaluate_uniform(ptr);
+    }
 };
 
 InputArray::InputArray()
@@ -368,6 +414,7 @@ void InputArray::declare(
     input.m_entity = nullptr;
 
     impl->m_inputs.push_back(input);
+    impl->update_uniform_values();
 }
 
 InputArray::iterator InputArray::begin()
@@ -471,8 +518,25 @@ void InputArray::evaluate(
     assert(is_aligned(ptr, 16));
 #endif
 
+    // Copy the precomputed values of uniform inputs, then only evaluate varying inputs.
+    if (!impl->m_uniform_values.empty())
+        memcpy(ptr, &impl->m_uniform_values[0], impl->m_uniform_values.size());
+
+    for (const_each<VaryingInputVector> i = impl->m_varying_inputs; i; ++i)
+        impl->m_inputs[i->m_index].evaluate(texture_cache, source_inputs, ptr + i->m_offset);
+}
+
+void InputArray::prefetch(
+    TextureCache&               texture_cache,
+    const Vector2f&             uv,
+    const Vector2f&             duvdx,
+    const Vector2f&             duvdy) const
+{
     for (const_each<InputVector> i = impl->m_inputs; i; ++i)
-        ptr = i->evaluate(texture_cache, source_inputs, ptr);
+    {
+        if (i->m_source)
+            i->m_source->prefetch(texture_cache, uv, duvdx, duvdy);
+    }
 }
 
 void InputArray::evaluate_uniforms(
@@ -486,8 +550,8 @@ void InputArray::evaluate_uniforms(
     assert(is_aligned(ptr, 16));
 #endif
 
-    for (const_each<InputVector> i = impl->m_inputs; i; ++i)
-        ptr = i->evaluate_uniform(ptr);
+    if (!impl->m_uniform_values.empty())
+        memcpy(ptr, &impl->m_uniform_values[0], impl->m_uniform_values.size());
 }
 
 
@@ -622,6 +686,8 @@ void InputArray::iterator::bind(Source* source)
     Input& input = m_input_array->impl->m_inputs[m_input_index];
     delete input.m_source;
     input.m_source = source;
+
+    m_input_array->impl->update_uniform_values();
 }
 
 void InputArray::iterator::bind(Entity* entity)
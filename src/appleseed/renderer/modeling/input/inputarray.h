@@ -221,6 +221,14 @@ class APPLESEED_DLLSYMBOL InputArray
         const SourceInputs&         source_inputs,
         void*                       values) const;
 
+    // Request the asynchronous loading of the textures bound to the inputs
+    // over a given texture space footprint.
+    void prefetch(
+        TextureCache&               texture_cache,
+        const foundation::Vector2f& uv,
+        const foundation::Vector2f& duvdx,
+        const foundation::Vector2f& duvdy) const;
+
     // Evaluate all uniform inputs into a preallocated block of memory.
     // 'values' must be 16-byte aligned.
     void evaluate_uniforms(
@@ -51,6 +51,7 @@
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/pointinstancer.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
@@ -347,6 +348,14 @@ void InputBinder::bind_scene_entities_inputs()
         assembly_instance.bind_assembly(m_scene.assemblies());
         assembly_instance.check_assembly();
     }
+
+    // Bind prototype assemblies to point instancers.
+    for (auto& point_instancer : m_scene.point_instancers())
+    {
+        point_instancer.unbind_prototypes();
+        point_instancer.bind_prototypes(m_scene.assemblies());
+        point_instancer.check_prototypes();
+    }
 }
 
 void InputBinder::bind_assembly_entities_inputs(
@@ -480,6 +489,19 @@ void InputBinder::bind_assembly_entities_inputs(
         assembly_instance.check_assembly();
     }
 
+    // Bind prototype assemblies to point instancers.
+    for (auto& point_instancer : assembly.point_instancers())
+    {
+        point_instancer.unbind_prototypes();
+
+        for (auto j = m_assembly_info.rbegin(); j != m_assembly_info.rend(); ++j)
+            point_instancer.bind_prototypes(j->m_assembly->assemblies());
+
+        point_instancer.bind_prototypes(m_scene.assemblies());
+
+        point_instancer.check_prototypes();
+    }
+
     // Recurse into child assemblies.
     for (const auto& child_assembly : assembly.assemblies())
         bind_assembly_entities_inputs(child_assembly);
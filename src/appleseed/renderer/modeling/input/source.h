@@ -107,6 +107,14 @@ class APPLESEED_DLLSYMBOL Source
         Spectrum&                   spectrum,
         Alpha&                      alpha) const;
 
+    // Request the asynchronous loading of the data needed to evaluate the source
+    // over a given texture space footprint. The default implementation does nothing.
+    virtual void prefetch(
+        TextureCache&               texture_cache,
+        const foundation::Vector2f& uv,
+        const foundation::Vector2f& duvdx,
+        const foundation::Vector2f& duvdy) const;
+
     // Evaluate the source as a uniform source.
     virtual void evaluate_uniform(
         float&                      scalar) const;
@@ -196,6 +204,14 @@ inline void Source::evaluate(
     evaluate_uniform(spectrum, alpha);
 }
 
+inline void Source::prefetch(
+    TextureCache&                   texture_cache,
+    const foundation::Vector2f&     uv,
+    const foundation::Vector2f&     duvdx,
+    const foundation::Vector2f&     duvdy) const
+{
+}
+
 inline void Source::evaluate_uniform(
     float&                          scalar) const
 {
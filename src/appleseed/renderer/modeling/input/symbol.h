@@ -32,10 +32,13 @@
 // appleseed.foundation headers.
 #include "foundation/core/exceptions/stringexception.h"
 #include "foundation/utility/kvpair.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/unordered_map.hpp"
 
 // Standard headers.
 #include <cassert>
-#include <map>
 #include <string>
 #include <utility>
 
@@ -91,10 +94,16 @@ class SymbolTable
         const SymbolID      symbol_id);
 
     // Lookup a symbol.
+    SymbolID lookup(const char* name) const;
     SymbolID lookup(const std::string& name) const;
 
   private:
-    typedef std::map<std::string, SymbolID> SymbolContainer;
+    typedef boost::unordered_map<
+        std::string,
+        SymbolID,
+        foundation::StringHash,
+        foundation::StringEqual
+    > SymbolContainer;
 
     SymbolContainer m_symbols;
 };
@@ -147,6 +156,14 @@ inline void SymbolTable::insert(
         throw ExceptionDuplicateSymbol(name.c_str());
 }
 
+inline SymbolTable::SymbolID SymbolTable::lookup(const char* name) const
+{
+    assert(name);
+    const SymbolContainer::const_iterator i =
+        m_symbols.find(name, foundation::StringHash(), foundation::StringEqual());
+    return i == m_symbols.end() ? SymbolNotFound : i->second;
+}
+
 inline SymbolTable::SymbolID SymbolTable::lookup(const std::string& name) const
 {
     const SymbolContainer::const_iterator i = m_symbols.find(name);
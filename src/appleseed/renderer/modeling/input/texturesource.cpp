@@ -36,6 +36,8 @@
 #include "renderer/modeling/texture/texture.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/colorspace.h"
+#include "foundation/image/pixel.h"
 #include "foundation/image/tile.h"
 #include "foundation/math/hash.h"
 #include "foundation/math/scalar.h"
@@ -43,6 +45,7 @@
 
 // Standard headers.
 #include <cassert>
+#include <cmath>
 
 using namespace foundation;
 using namespace std;
@@ -118,11 +121,43 @@ namespace
                 static_cast<size_t>(iy));
     }
 
+    // Read a texel from a tile. Return a color in the linear RGB color space.
+    // If decode_srgb is true, 8-bit tiles are assumed to be in the sRGB color space.
+    inline void get_tile_texel(
+        const Tile&                 tile,
+        const bool                  decode_srgb,
+        const size_t                pixel_x,
+        const size_t                pixel_y,
+        Color4f&                    texel)
+    {
+        if (decode_srgb && tile.get_pixel_format() == PixelFormatUInt8)
+        {
+            // Compressed texture stores leave 8-bit tiles of sRGB textures encoded.
+            const uint8* pixel = tile.pixel(pixel_x, pixel_y);
+            texel[0] = srgb_uint8_to_linear_rgb(pixel[0]);
+            texel[1] = srgb_uint8_to_linear_rgb(pixel[1]);
+            texel[2] = srgb_uint8_to_linear_rgb(pixel[2]);
+            texel[3] = tile.get_channel_count() == 3 ? 1.0f : pixel[3] * (1.0f / 255.0f);
+        }
+        else if (tile.get_channel_count() == 3)
+        {
+            Color3f rgb;
+            tile.get_pixel(pixel_x, pixel_y, rgb);
+            texel[0] = rgb[0];
+            texel[1] = rgb[1];
+            texel[2] = rgb[2];
+            texel[3] = 1.0f;
+        }
+        else tile.get_pixel(pixel_x, pixel_y, texel);
+    }
+
     // Utility function to sample a tile.
     inline void sample_tile(
         TextureCache&               texture_cache,
         const UniqueID              assembly_uid,
         const UniqueID              texture_uid,
+        const size_t                mip_level,
+        const bool                  decode_srgb,
         const size_t                tile_x,
         const size_t                tile_y,
         const size_t                pixel_x,
@@ -135,19 +170,11 @@ namespace
                 assembly_uid,
                 texture_uid,
                 tile_x,
-                tile_y);
+                tile_y,
+                mip_level);
 
         // Sample the tile.
-        if (tile.get_channel_count() == 3)
-        {
-            Color3f rgb;
-            tile.get_pixel(pixel_x, pixel_y, rgb);
-            sample[0] = rgb[0];
-            sample[1] = rgb[1];
-            sample[2] = rgb[2];
-            sample[3] = 1.0f;
-        }
-        else tile.get_pixel(pixel_x, pixel_y, sample);
+        get_tile_texel(tile, decode_srgb, pixel_x, pixel_y, sample);
     }
 }
 
@@ -158,12 +185,24 @@ TextureSource::TextureSource(
   , m_assembly_uid(assembly_uid)
   , m_texture_instance(texture_instance)
   , m_texture_uid(texture_instance.get_texture().get_uid())
-  , m_texture_props(texture_instance.get_texture().properties())
   , m_texture_transform(texture_instance.get_transform())
-  , m_scalar_canvas_width(static_cast<float>(m_texture_props.m_canvas_width))
-  , m_scalar_canvas_height(static_cast<float>(m_texture_props.m_canvas_height))
-  , m_max_x(static_cast<float>(m_texture_props.m_canvas_width - 1))
-  , m_max_y(static_cast<float>(m_texture_props.m_canvas_height - 1))
+  , m_srgb_texture(texture_instance.get_texture().get_color_space() == ColorSpaceSRGB)
+{
+    Texture& texture = texture_instance.get_texture();
+
+    m_mip_levels.push_back(MipLevel(texture.properties()));
+
+    const size_t mip_level_count = texture.get_mip_level_count();
+    for (size_t i = 1; i < mip_level_count; ++i)
+        m_mip_levels.push_back(MipLevel(texture.mip_level_properties(i)));
+}
+
+TextureSource::MipLevel::MipLevel(const CanvasProperties& props)
+  : m_props(props)
+  , m_scalar_canvas_width(static_cast<float>(props.m_canvas_width))
+  , m_scalar_canvas_height(static_cast<float>(props.m_canvas_height))
+  , m_max_x(static_cast<float>(props.m_canvas_width - 1))
+  , m_max_y(static_cast<float>(props.m_canvas_height - 1))
 {
 }
 
@@ -175,8 +214,8 @@ uint64 TextureSource::compute_signature() const
 TextureSource::Hints TextureSource::get_hints() const
 {
     Hints hints;
-    hints.m_width = m_texture_props.m_canvas_width;
-    hints.m_height = m_texture_props.m_canvas_height;
+    hints.m_width = m_mip_levels[0].m_props.m_canvas_width;
+    hints.m_height = m_mip_levels[0].m_props.m_canvas_height;
     return hints;
 }
 
@@ -192,19 +231,45 @@ Vector2f TextureSource::apply_transform(const Vector2f& uv) const
     return Vector2f(p.x, p.y);
 }
 
+size_t TextureSource::select_mip_level(
+    const Vector2f&             dpdx,
+    const Vector2f&             dpdy) const
+{
+    if (m_mip_levels.size() == 1)
+        return 0;
+
+    // Compute the width of the footprint in texels of the base level.
+    const MipLevel& base_level = m_mip_levels[0];
+    const float width =
+        max(
+            norm(Vector2f(dpdx.x * base_level.m_scalar_canvas_width, dpdx.y * base_level.m_scalar_canvas_height)),
+            norm(Vector2f(dpdy.x * base_level.m_scalar_canvas_width, dpdy.y * base_level.m_scalar_canvas_height)));
+
+    // Select the finest level whose texels are at least as large as the footprint.
+    // Footprints are unknown (zero) for rays without differentials: use the base level.
+    if (!(width > 1.0f))
+        return 0;
+
+    const size_t level = log2_int(truncate<size_t>(min(width, 65536.0f)));
+    return min(level, m_mip_levels.size() - 1);
+}
+
 Color4f TextureSource::get_texel(
     TextureCache&               texture_cache,
+    const size_t                mip_level,
     const size_t                ix,
     const size_t                iy) const
 {
-    assert(ix < m_texture_props.m_canvas_width);
-    assert(iy < m_texture_props.m_canvas_height);
+    const CanvasProperties& props = m_mip_levels[mip_level].m_props;
+
+    assert(ix < props.m_canvas_width);
+    assert(iy < props.m_canvas_height);
 
     // Compute the coordinates of the tile containing the texel (x, y).
-    const size_t tile_x = truncate<size_t>(ix * m_texture_props.m_rcp_tile_width);
-    const size_t tile_y = truncate<size_t>(iy * m_texture_props.m_rcp_tile_height);
-    assert(tile_x < m_texture_props.m_tile_count_x);
-    assert(tile_y < m_texture_props.m_tile_count_y);
+    const size_t tile_x = truncate<size_t>(ix * props.m_rcp_tile_width);
+    const size_t tile_y = truncate<size_t>(iy * props.m_rcp_tile_height);
+    assert(tile_x < props.m_tile_count_x);
+    assert(tile_y < props.m_tile_count_y);
 
 #ifdef DEBUG_DISPLAY_TEXTURE_TILES
 
@@ -221,10 +286,10 @@ Color4f TextureSource::get_texel(
 #endif
 
     // Compute the tile space coordinates of the texel (x, y).
-    const size_t pixel_x = ix - tile_x * m_texture_props.m_tile_width;
-    const size_t pixel_y = iy - tile_y * m_texture_props.m_tile_height;
-    assert(pixel_x < m_texture_props.m_tile_width);
-    assert(pixel_y < m_texture_props.m_tile_height);
+    const size_t pixel_x = ix - tile_x * props.m_tile_width;
+    const size_t pixel_y = iy - tile_y * props.m_tile_height;
+    assert(pixel_x < props.m_tile_width);
+    assert(pixel_y < props.m_tile_height);
 
     // Sample the tile.
     Color4f sample;
@@ -232,6 +297,8 @@ Color4f TextureSource::get_texel(
         texture_cache,
         m_assembly_uid,
         m_texture_uid,
+        mip_level,
+        m_srgb_texture && texture_cache.is_tile_compression_enabled(),
         tile_x,
         tile_y,
         pixel_x,
@@ -243,6 +310,7 @@ Color4f TextureSource::get_texel(
 
 void TextureSource::get_texels_2x2(
     TextureCache&               texture_cache,
+    const size_t                mip_level,
     const int                   ix,
     const int                   iy,
     Color4f&                    t00,
@@ -250,19 +318,21 @@ void TextureSource::get_texels_2x2(
     Color4f&                    t01,
     Color4f&                    t11) const
 {
+    const CanvasProperties& props = m_mip_levels[mip_level].m_props;
+
     const Vector<size_t, 2> p00 =
         constrain_to_canvas(
             m_texture_instance.get_addressing_mode(),
-            m_texture_props.m_canvas_width,
-            m_texture_props.m_canvas_height,
+            props.m_canvas_width,
+            props.m_canvas_height,
             ix + 0,
             iy + 0);
 
     const Vector<size_t, 2> p11 =
         constrain_to_canvas(
             m_texture_instance.get_addressing_mode(),
-            m_texture_props.m_canvas_width,
-            m_texture_props.m_canvas_height,
+            props.m_canvas_width,
+            props.m_canvas_height,
             ix + 1,
             iy + 1);
 
@@ -270,10 +340,10 @@ void TextureSource::get_texels_2x2(
     const Vector<size_t, 2> p01(p00.x, p11.y);
 
     // Compute the coordinates of the tile containing each texel.
-    const size_t tile_x_00 = truncate<size_t>(p00.x * m_texture_props.m_rcp_tile_width);
-    const size_t tile_y_00 = truncate<size_t>(p00.y * m_texture_props.m_rcp_tile_height);
-    const size_t tile_x_11 = truncate<size_t>(p11.x * m_texture_props.m_rcp_tile_width);
-    const size_t tile_y_11 = truncate<size_t>(p11.y * m_texture_props.m_rcp_tile_height);
+    const size_t tile_x_00 = truncate<size_t>(p00.x * props.m_rcp_tile_width);
+    const size_t tile_y_00 = truncate<size_t>(p00.y * props.m_rcp_tile_height);
+    const size_t tile_x_11 = truncate<size_t>(p11.x * props.m_rcp_tile_width);
+    const size_t tile_y_11 = truncate<size_t>(p11.y * props.m_rcp_tile_height);
 
     // Check whether all four texels are part of the same tile.
     const size_t tile_x_mask = tile_x_00 ^ tile_x_11;
@@ -284,24 +354,25 @@ void TextureSource::get_texels_2x2(
         // Not all four texels are part of the same tile.
 
         // Compute the tile space coordinates of each texel.
-        const size_t pixel_x_00 = p00.x - tile_x_00 * m_texture_props.m_tile_width;
-        const size_t pixel_y_00 = p00.y - tile_y_00 * m_texture_props.m_tile_height;
-        const size_t pixel_x_11 = p11.x - tile_x_11 * m_texture_props.m_tile_width;
-        const size_t pixel_y_11 = p11.y - tile_y_11 * m_texture_props.m_tile_height;
+        const size_t pixel_x_00 = p00.x - tile_x_00 * props.m_tile_width;
+        const size_t pixel_y_00 = p00.y - tile_y_00 * props.m_tile_height;
+        const size_t pixel_x_11 = p11.x - tile_x_11 * props.m_tile_width;
+        const size_t pixel_y_11 = p11.y - tile_y_11 * props.m_tile_height;
 
         // Sample the tile.
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_00, tile_y_00, pixel_x_00, pixel_y_00, t00);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_11, tile_y_00, pixel_x_11, pixel_y_00, t10);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_00, tile_y_11, pixel_x_00, pixel_y_11, t01);
-        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, tile_x_11, tile_y_11, pixel_x_11, pixel_y_11, t11);
+        const bool decode_srgb = m_srgb_texture && texture_cache.is_tile_compression_enabled();
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, mip_level, decode_srgb, tile_x_00, tile_y_00, pixel_x_00, pixel_y_00, t00);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, mip_level, decode_srgb, tile_x_11, tile_y_00, pixel_x_11, pixel_y_00, t10);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, mip_level, decode_srgb, tile_x_00, tile_y_11, pixel_x_00, pixel_y_11, t01);
+        sample_tile(texture_cache, m_assembly_uid, m_texture_uid, mip_level, decode_srgb, tile_x_11, tile_y_11, pixel_x_11, pixel_y_11, t11);
     }
     else
     {
         // All four texels are part of the same tile.
 
         // Compute the tile space coordinates of each texel.
-        const size_t org_x = tile_x_00 * m_texture_props.m_tile_width;
-        const size_t org_y = tile_y_00 * m_texture_props.m_tile_height;
+        const size_t org_x = tile_x_00 * props.m_tile_width;
+        const size_t org_y = tile_y_00 * props.m_tile_height;
         const size_t pixel_x_00 = p00.x - org_x;
         const size_t pixel_y_00 = p00.y - org_y;
         const size_t pixel_x_11 = p11.x - org_x;
@@ -313,53 +384,87 @@ void TextureSource::get_texels_2x2(
                 m_assembly_uid,
                 m_texture_uid,
                 tile_x_00,
-                tile_y_00);
+                tile_y_00,
+                mip_level);
 
         // Sample the tile.
-        if (tile.get_channel_count() == 3)
-        {
-            Color3f rgb;
+        const bool decode_srgb = m_srgb_texture && texture_cache.is_tile_compression_enabled();
+        get_tile_texel(tile, decode_srgb, pixel_x_00, pixel_y_00, t00);
+        get_tile_texel(tile, decode_srgb, pixel_x_11, pixel_y_00, t10);
+        get_tile_texel(tile, decode_srgb, pixel_x_00, pixel_y_11, t01);
+        get_tile_texel(tile, decode_srgb, pixel_x_11, pixel_y_11, t11);
+    }
+}
 
-            tile.get_pixel(pixel_x_00, pixel_y_00, rgb);
-            t00[0] = rgb[0];
-            t00[1] = rgb[1];
-            t00[2] = rgb[2];
-            t00[3] = 1.0f;
-
-            tile.get_pixel(pixel_x_11, pixel_y_00, rgb);
-            t10[0] = rgb[0];
-            t10[1] = rgb[1];
-            t10[2] = rgb[2];
-            t10[3] = 1.0f;
-
-            tile.get_pixel(pixel_x_00, pixel_y_11, rgb);
-            t01[0] = rgb[0];
-            t01[1] = rgb[1];
-            t01[2] = rgb[2];
-            t01[3] = 1.0f;
-
-            tile.get_pixel(pixel_x_11, pixel_y_11, rgb);
-            t11[0] = rgb[0];
-            t11[1] = rgb[1];
-            t11[2] = rgb[2];
-            t11[3] = 1.0f;
-        }
-        else
-        {
-            tile.get_pixel(pixel_x_00, pixel_y_00, t00);
-            tile.get_pixel(pixel_x_11, pixel_y_00, t10);
-            tile.get_pixel(pixel_x_00, pixel_y_11, t01);
-            tile.get_pixel(pixel_x_11, pixel_y_11, t11);
-        }
+void TextureSource::prefetch(
+    TextureCache&               texture_cache,
+    const Vector2f&             uv,
+    const Vector2f&             duvdx,
+    const Vector2f&             duvdy) const
+{
+    // Larger footprints are left to the regular, synchronous loading path.
+    const size_t MaxPrefetchedTileCount = 16;
+
+    // Compute the center and the half-extent of the footprint in transformed texture space.
+    Vector2f p = apply_transform(uv);
+    const Vector2f dpdx = apply_transform(uv + duvdx) - p;
+    const Vector2f dpdy = apply_transform(uv + duvdy) - p;
+    const float extent_x = abs(dpdx.x) + abs(dpdy.x);
+    const float extent_y = abs(dpdx.y) + abs(dpdy.y);
+    p.y = 1.0f - p.y;
+
+    // Prefetch the tiles of the mipmap level the footprint will be sampled from.
+    const size_t mip_level = select_mip_level(dpdx, dpdy);
+    const MipLevel& level = m_mip_levels[mip_level];
+
+    // Apply the texture addressing mode to the center of the footprint.
+    apply_addressing_mode(m_texture_instance.get_addressing_mode(), p);
+
+    // Compute the footprint in texel space, constrained to the canvas.
+    const float x0 = clamp((p.x - extent_x) * level.m_scalar_canvas_width, 0.0f, level.m_max_x);
+    const float y0 = clamp((p.y - extent_y) * level.m_scalar_canvas_height, 0.0f, level.m_max_y);
+    const float x1 = clamp((p.x + extent_x) * level.m_scalar_canvas_width, 0.0f, level.m_max_x);
+    const float y1 = clamp((p.y + extent_y) * level.m_scalar_canvas_height, 0.0f, level.m_max_y);
+
+    // Compute the range of tiles covered by the footprint.
+    size_t tile_x0 = truncate<size_t>(x0 * level.m_props.m_rcp_tile_width);
+    size_t tile_y0 = truncate<size_t>(y0 * level.m_props.m_rcp_tile_height);
+    size_t tile_x1 = truncate<size_t>(x1 * level.m_props.m_rcp_tile_width);
+    size_t tile_y1 = truncate<size_t>(y1 * level.m_props.m_rcp_tile_height);
+    assert(tile_x1 < level.m_props.m_tile_count_x);
+    assert(tile_y1 < level.m_props.m_tile_count_y);
+
+    if ((tile_x1 - tile_x0 + 1) * (tile_y1 - tile_y0 + 1) > MaxPrefetchedTileCount)
+    {
+        // Only prefetch the tile containing the center of the footprint.
+        tile_x0 = tile_x1 = truncate<size_t>(clamp(p.x * level.m_scalar_canvas_width, 0.0f, level.m_max_x) * level.m_props.m_rcp_tile_width);
+        tile_y0 = tile_y1 = truncate<size_t>(clamp(p.y * level.m_scalar_canvas_height, 0.0f, level.m_max_y) * level.m_props.m_rcp_tile_height);
+    }
+
+    for (size_t tile_y = tile_y0; tile_y <= tile_y1; ++tile_y)
+    {
+        for (size_t tile_x = tile_x0; tile_x <= tile_x1; ++tile_x)
+            texture_cache.prefetch(m_assembly_uid, m_texture_uid, tile_x, tile_y, mip_level);
     }
 }
 
 Color4f TextureSource::sample_texture(
     TextureCache&               texture_cache,
-    const Vector2f&             uv) const
+    const SourceInputs&         source_inputs) const
 {
+    // Select the mipmap level from the footprint in transformed texture space.
+    size_t mip_level = 0;
+    if (m_mip_levels.size() > 1)
+    {
+        const Vector3f dpdx = m_texture_transform.vector_to_local(Vector3f(source_inputs.m_duvdx_x, source_inputs.m_duvdx_y, 0.0f));
+        const Vector3f dpdy = m_texture_transform.vector_to_local(Vector3f(source_inputs.m_duvdy_x, source_inputs.m_duvdy_y, 0.0f));
+        mip_level = select_mip_level(Vector2f(dpdx.x, dpdx.y), Vector2f(dpdy.x, dpdy.y));
+    }
+
+    const MipLevel& level = m_mip_levels[mip_level];
+
     // Start with the transformed input texture coordinates.
-    Vector2f p = apply_transform(uv);
+    Vector2f p = apply_transform(Vector2f(source_inputs.m_uv_x, source_inputs.m_uv_y));
     p.y = 1.0f - p.y;
 
     // Apply the texture addressing mode.
@@ -369,19 +474,19 @@ Color4f TextureSource::sample_texture(
     {
       case TextureFilteringNearest:
         {
-            p.x = clamp(p.x * m_scalar_canvas_width, 0.0f, m_max_x);
-            p.y = clamp(p.y * m_scalar_canvas_height, 0.0f, m_max_y);
+            p.x = clamp(p.x * level.m_scalar_canvas_width, 0.0f, level.m_max_x);
+            p.y = clamp(p.y * level.m_scalar_canvas_height, 0.0f, level.m_max_y);
 
             const size_t ix = truncate<size_t>(p.x);
             const size_t iy = truncate<size_t>(p.y);
 
-            return get_texel(texture_cache, ix, iy);
+            return get_texel(texture_cache, mip_level, ix, iy);
         }
 
       case TextureFilteringBilinear:
         {
-            p.x *= m_max_x;
-            p.y *= m_max_y;
+            p.x *= level.m_max_x;
+            p.y *= level.m_max_y;
 
             const int ix = truncate<int>(p.x);
             const int iy = truncate<int>(p.y);
@@ -390,6 +495,7 @@ Color4f TextureSource::sample_texture(
             Color4f t00, t10, t01, t11;
             get_texels_2x2(
                 texture_cache,
+                mip_level,
                 ix, iy,
                 t00, t10, t01, t11);
 
@@ -76,9 +76,14 @@ LightFactoryRegistrar::~LightFactoryRegistrar()
     delete impl;
 }
 
-void LightFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
+const char* LightFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
 {
-    impl->register_factory_plugin(plugin, plugin_entry_point);
+    return impl->register_factory_plugin(plugin, plugin_entry_point);
+}
+
+void LightFactoryRegistrar::set_plugin_store(PluginStore* plugin_store, const char* entry_point_name)
+{
+    impl->set_plugin_store(plugin_store, entry_point_name);
 }
 
 LightFactoryArray LightFactoryRegistrar::get_factories() const
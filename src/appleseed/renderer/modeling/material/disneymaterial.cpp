@@ -82,6 +82,7 @@ namespace
           : m_param_name(name)
           , m_expr(params.get<string>(name))
           , m_is_vector(is_vector)
+          , m_is_prepared(false)
           , m_is_constant(false)
           , m_texture_is_srgb(true)
         {
@@ -91,6 +92,7 @@ namespace
           : m_param_name(other.m_param_name)
           , m_expr(other.m_expr)
           , m_is_vector(other.m_is_vector)
+          , m_is_prepared(other.m_is_prepared)
           , m_is_constant(other.m_is_constant)
           , m_constant_value(other.m_constant_value)
           , m_texture_filename(other.m_texture_filename)
@@ -109,8 +111,23 @@ namespace
             return m_expr;
         }
 
+        bool is_constant() const
+        {
+            return m_is_constant;
+        }
+
+        const Color3d& get_constant_value() const
+        {
+            return m_constant_value;
+        }
+
         bool prepare()
         {
+            // Copies of a prepared parameter (such as per-thread copies) only need to
+            // build their own SeExpr object if they actually evaluate the expression.
+            if (m_is_prepared && (m_is_constant || !m_texture_filename.empty()))
+                return true;
+
             m_expression.setWantVec(m_is_vector);
             m_expression.set_expr(m_expr);
 
@@ -121,6 +138,11 @@ namespace
                 return false;
             }
 
+            if (m_is_prepared)
+                return true;
+
+            m_is_prepared = true;
+
             // Case of a simple constant.
             m_is_constant = m_expression.isConstant();
             if (m_is_constant)
@@ -216,6 +238,7 @@ namespace
         const char*                 m_param_name;
         string                      m_expr;
         bool                        m_is_vector;
+        bool                        m_is_prepared;
         bool                        m_is_constant;
         Color3d                     m_constant_value;
         OIIO::ustring               m_texture_filename;
@@ -801,6 +824,19 @@ bool DisneyMaterial::prepare_layers(const MessageContext& context)
 
     sort(impl->m_layers.begin(), impl->m_layers.end());
 
+    // Layers below the topmost layer with a constant, fully opaque mask are entirely
+    // overridden by it and don't need to be evaluated.
+    for (size_t i = impl->m_layers.size(); i > 1; --i)
+    {
+        const DisneyLayerParam& mask = impl->m_layers[i - 1].impl->m_mask;
+
+        if (mask.is_constant() && mask.get_constant_value()[0] >= 1.0)
+        {
+            impl->m_layers.erase(impl->m_layers.begin(), impl->m_layers.begin() + (i - 1));
+            break;
+        }
+    }
+
     return true;
 }
 
@@ -185,6 +185,7 @@ bool Material::on_frame_begin(
     m_render_data.m_edf = nullptr;
     m_render_data.m_alpha_map = get_uncached_alpha_map();
     m_render_data.m_shader_group = nullptr;
+    m_render_data.m_pending_shader_group = nullptr;
     m_render_data.m_basis_modifier = nullptr;
     m_render_data.m_volume = nullptr;
     m_has_render_data = true;
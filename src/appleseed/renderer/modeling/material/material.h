@@ -140,6 +140,7 @@ class APPLESEED_DLLSYMBOL Material
         const Volume*               m_volume;
         const Source*               m_alpha_map;
         const ShaderGroup*          m_shader_group;
+        const ShaderGroup*          m_pending_shader_group;     // shader group still being optimized, m_bsdf is a stand-in meanwhile
         const IBasisModifier*       m_basis_modifier;   // owned by RenderData
     };
 
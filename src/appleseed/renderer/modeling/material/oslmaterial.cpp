@@ -31,19 +31,27 @@
 
 // appleseed.renderer headers.
 #include "renderer/modeling/bsdf/bsdf.h"
+#include "renderer/modeling/bsdf/lambertianbrdf.h"
 #include "renderer/modeling/bsdf/oslbsdf.h"
 #include "renderer/modeling/bssrdf/bssrdf.h"
 #include "renderer/modeling/bssrdf/oslbssrdf.h"
+#include "renderer/modeling/color/colorentity.h"
 #include "renderer/modeling/edf/edf.h"
 #include "renderer/modeling/edf/osledf.h"
+#include "renderer/modeling/input/colorsource.h"
 #include "renderer/modeling/input/inputarray.h"
+#include "renderer/modeling/input/scalarsource.h"
 #include "renderer/modeling/material/material.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/color.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 
+// Standard headers.
+#include <string>
+
 using namespace foundation;
 
 namespace renderer
@@ -126,6 +134,21 @@ namespace
                 if (m_render_data.m_shader_group->has_emission())
                     m_render_data.m_edf = m_osl_edf.get();
             }
+            else if (const ShaderGroup* sg = get_osl_surface_entity())
+            {
+                // The shader group is valid but is still being optimized in the background:
+                // shade with a diffuse approximation of it until it becomes available.
+                if (!sg->is_optimized())
+                {
+                    create_fallback_bsdf(*sg);
+
+                    if (!m_fallback_bsdf->on_frame_begin(project, parent, recorder, abort_switch))
+                        return false;
+
+                    m_render_data.m_bsdf = m_fallback_bsdf.get();
+                    m_render_data.m_pending_shader_group = sg;
+                }
+            }
 
             return true;
         }
@@ -134,14 +157,38 @@ namespace
         auto_release_ptr<BSDF>      m_osl_bsdf;
         auto_release_ptr<BSSRDF>    m_osl_bssrdf;
         auto_release_ptr<EDF>       m_osl_edf;
+        auto_release_ptr<ColorEntity> m_fallback_color;
+        auto_release_ptr<BSDF>      m_fallback_bsdf;
 
-        const ShaderGroup* get_uncached_osl_surface() const override
+        const ShaderGroup* get_osl_surface_entity() const
         {
             const ShaderGroup* sg =
                 static_cast<const ShaderGroup*>(m_inputs.get_entity("osl_surface"));
 
             return sg && sg->is_valid() ? sg : nullptr;
         }
+
+        const ShaderGroup* get_uncached_osl_surface() const override
+        {
+            const ShaderGroup* sg = get_osl_surface_entity();
+            return sg && sg->is_optimized() ? sg : nullptr;
+        }
+
+        void create_fallback_bsdf(const ShaderGroup& sg)
+        {
+            const Color3f albedo = sg.get_fallback_albedo();
+            const std::string name = std::string(get_name()) + "_fallback";
+
+            m_fallback_bsdf = LambertianBRDFFactory().create(name.c_str(), ParamArray());
+            m_fallback_color =
+                ColorEntityFactory::create(
+                    name.c_str(),
+                    ParamArray().insert("color_space", "linear_rgb"),
+                    ColorValueArray(3, &albedo[0]));
+
+            m_fallback_bsdf->get_inputs().find("reflectance").bind(new ColorSource(*m_fallback_color));
+            m_fallback_bsdf->get_inputs().find("reflectance_multiplier").bind(new ScalarSource(1.0f));
+        }
     };
 }
 
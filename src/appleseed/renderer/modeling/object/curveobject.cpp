@@ -33,6 +33,8 @@
 #include "renderer/modeling/object/curveobjectreader.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/half.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/otherwise.h"
@@ -58,13 +60,123 @@ namespace
     const char* Model = "curve_object";
 }
 
+namespace
+{
+    //
+    // Compact storage for curves of a given degree.
+    //
+    // Control points are stored in single precision, widths and opacities in half
+    // precision. Colors are stored once per curve for as long as every curve has a
+    // uniform color; the first curve with varying colors switches the array to one
+    // color per control point.
+    //
+
+    template <typename CurveType, size_t PointCount>
+    class CompactCurveArray
+    {
+      public:
+        CompactCurveArray()
+          : m_per_vertex_colors(false)
+        {
+        }
+
+        size_t size() const
+        {
+            return m_points.size() / PointCount;
+        }
+
+        void reserve(const size_t count)
+        {
+            m_points.reserve(count * PointCount);
+            m_widths.reserve(count * PointCount);
+            m_opacities.reserve(count * PointCount);
+            m_colors.reserve(m_per_vertex_colors ? count * PointCount : count);
+        }
+
+        void push_back(const CurveType& curve)
+        {
+            for (size_t i = 0; i < PointCount; ++i)
+            {
+                m_points.push_back(curve.get_control_point(i));
+                m_widths.push_back(Half(curve.get_width(i)));
+                m_opacities.push_back(Half(curve.get_opacity(i)));
+            }
+
+            if (!m_per_vertex_colors && !has_uniform_color(curve))
+                expand_colors();
+
+            if (m_per_vertex_colors)
+            {
+                for (size_t i = 0; i < PointCount; ++i)
+                    m_colors.push_back(curve.get_color(i));
+            }
+            else m_colors.push_back(curve.get_color(0));
+        }
+
+        CurveType operator[](const size_t index) const
+        {
+            assert(index < size());
+
+            const size_t first = index * PointCount;
+
+            GVector3 points[PointCount];
+            GScalar widths[PointCount];
+            GScalar opacities[PointCount];
+            Color3f colors[PointCount];
+
+            for (size_t i = 0; i < PointCount; ++i)
+            {
+                points[i] = m_points[first + i];
+                widths[i] = m_widths[first + i];
+                opacities[i] = m_opacities[first + i];
+                colors[i] = m_per_vertex_colors ? m_colors[first + i] : m_colors[index];
+            }
+
+            return CurveType(points, widths, opacities, colors);
+        }
+
+      private:
+        vector<GVector3>    m_points;
+        vector<Half>        m_widths;
+        vector<Half>        m_opacities;
+        vector<Color3f>     m_colors;
+        bool                m_per_vertex_colors;
+
+        static bool has_uniform_color(const CurveType& curve)
+        {
+            for (size_t i = 1; i < PointCount; ++i)
+            {
+                if (curve.get_color(i) != curve.get_color(0))
+                    return false;
+            }
+
+            return true;
+        }
+
+        void expand_colors()
+        {
+            vector<Color3f> colors;
+            colors.reserve(m_colors.capacity() * PointCount);
+
+            for (const Color3f& color : m_colors)
+            {
+                for (size_t i = 0; i < PointCount; ++i)
+                    colors.push_back(color);
+            }
+
+            m_colors.swap(colors);
+            m_per_vertex_colors = true;
+        }
+    };
+}
+
 struct CurveObject::Impl
 {
-    CurveBasis          m_basis;
-    size_t              m_curve_count;
-    vector<Curve1Type>  m_curves1;
-    vector<Curve3Type>  m_curves3;
-    vector<string>      m_material_slots;
+    CurveBasis                              m_basis;
+    size_t                                  m_curve_count;
+    CompactCurveArray<Curve1Type, 2>        m_curves1;
+    CompactCurveArray<Curve3Type, 4>        m_curves3;
+    vector<string>                          m_material_slots;
 
     Impl()
     {
@@ -205,13 +317,13 @@ size_t CurveObject::get_curve3_count() const
     return impl->m_curves3.size();
 }
 
-const Curve1Type& CurveObject::get_curve1(const size_t index) const
+Curve1Type CurveObject::get_curve1(const size_t index) const
 {
     assert(index < impl->m_curves1.size());
     return impl->m_curves1[index];
 }
 
-const Curve3Type& CurveObject::get_curve3(const size_t index) const
+Curve3Type CurveObject::get_curve3(const size_t index) const
 {
     assert(index < impl->m_curves3.size());
     return impl->m_curves3[index];
@@ -81,15 +81,17 @@ class APPLESEED_DLLSYMBOL CurveObject
     void push_curve_count(const size_t count);
     size_t get_curve_count() const;
 
-    // Insert and access curves.
+    // Insert and access curves. Curves are kept in a compact form (half-precision
+    // widths and opacities, colors shared per curve when uniform) and are
+    // reconstructed on access.
     void reserve_curves1(const size_t count);
     void reserve_curves3(const size_t count);
     size_t push_curve1(const Curve1Type& curve);
     size_t push_curve3(const Curve3Type& curve);
     size_t get_curve1_count() const;
     size_t get_curve3_count() const;
-    const Curve1Type& get_curve1(const size_t index) const;
-    const Curve3Type& get_curve3(const size_t index) const;
+    Curve1Type get_curve1(const size_t index) const;
+    Curve3Type get_curve3(const size_t index) const;
 
     // Insert and access material slots.
     size_t get_material_slot_count() const override;
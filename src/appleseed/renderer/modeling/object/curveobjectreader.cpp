@@ -41,6 +41,7 @@
 #include "foundation/curve/icurvefilereader.h"
 #include "foundation/math/aabb.h"
 #include "foundation/math/fp.h"
+#include "foundation/math/half.h"
 #include "foundation/math/qmc.h"
 #include "foundation/math/rng/distribution.h"
 #include "foundation/math/rng/mersennetwister.h"
@@ -185,6 +186,23 @@ namespace
             return m_colors.push_back(c);
         }
 
+        void push_vertex_arrays(
+            const size_t    count,
+            const Vector3f  vertices[],
+            const Half      widths[],
+            const Half      opacities[],
+            const Color3f   colors[],
+            const size_t    color_count) override
+        {
+            m_vertices.insert(m_vertices.end(), vertices, vertices + count);
+            m_widths.insert(m_widths.end(), widths, widths + count);
+            m_opacities.insert(m_opacities.end(), opacities, opacities + count);
+
+            if (color_count == 1)
+                m_colors.insert(m_colors.end(), count, colors[0]);
+            else m_colors.insert(m_colors.end(), colors, colors + count);
+        }
+
         auto_release_ptr<CurveObject> create_hair_ball()
         {
             const size_t ControlPointCount = 4;
@@ -136,13 +136,15 @@ namespace
 
             for (size_t i = 0, e = m_object.get_curve1_count(); i < e; ++i)
             {
+                const Curve1Type curve = m_object.get_curve1(i);
+
                 // todo: why use feq() here?
-                if (m_vertices.empty() || !feq(m_vertices.back(), m_object.get_curve1(i).get_control_point(0)))
+                if (m_vertices.empty() || !feq(m_vertices.back(), curve.get_control_point(0)))
                 {
-                    m_vertices.push_back(m_object.get_curve1(i).get_control_point(0));
-                    m_widths.push_back(m_object.get_curve1(i).get_width(0));
-                    m_opacities.push_back(m_object.get_curve1(i).get_opacity(0));
-                    m_colors.push_back(m_object.get_curve1(i).get_color(0));
+                    m_vertices.push_back(curve.get_control_point(0));
+                    m_widths.push_back(curve.get_width(0));
+                    m_opacities.push_back(curve.get_opacity(0));
+                    m_colors.push_back(curve.get_color(0));
 
                     m_vertex_counts.push_back(vertex_count);
                     vertex_count = 1;
@@ -151,10 +153,10 @@ namespace
                     ++m_total_vertex_count;
                 }
 
-                m_vertices.push_back(m_object.get_curve1(i).get_control_point(1));
-                m_widths.push_back(m_object.get_curve1(i).get_width(1));
-                m_opacities.push_back(m_object.get_curve1(i).get_opacity(1));
-                m_colors.push_back(m_object.get_curve1(i).get_color(1));
+                m_vertices.push_back(curve.get_control_point(1));
+                m_widths.push_back(curve.get_width(1));
+                m_opacities.push_back(curve.get_opacity(1));
+                m_colors.push_back(curve.get_color(1));
 
                 ++vertex_count;
                 ++m_total_vertex_count;
@@ -169,13 +171,15 @@ namespace
 
             for (size_t i = 0, e = m_object.get_curve3_count(); i < e; ++i)
             {
+                const Curve3Type curve = m_object.get_curve3(i);
+
                 // todo: why use feq() here?
-                if (m_vertices.empty() || !feq(m_vertices.back(), m_object.get_curve3(i).get_control_point(0)))
+                if (m_vertices.empty() || !feq(m_vertices.back(), curve.get_control_point(0)))
                 {
-                    m_vertices.push_back(m_object.get_curve3(i).get_control_point(0));
-                    m_widths.push_back(m_object.get_curve3(i).get_width(0));
-                    m_opacities.push_back(m_object.get_curve3(i).get_opacity(0));
-                    m_colors.push_back(m_object.get_curve3(i).get_color(0));
+                    m_vertices.push_back(curve.get_control_point(0));
+                    m_widths.push_back(curve.get_width(0));
+                    m_opacities.push_back(curve.get_opacity(0));
+                    m_colors.push_back(curve.get_color(0));
 
                     m_vertex_counts.push_back(vertex_count);
                     vertex_count = 1;
@@ -186,10 +190,10 @@ namespace
 
                 for (size_t k = 1; k < 4; ++k)
                 {
-                    m_vertices.push_back(m_object.get_curve3(i).get_control_point(k));
-                    m_widths.push_back(m_object.get_curve3(i).get_width(k));
-                    m_opacities.push_back(m_object.get_curve3(i).get_opacity(k));
-                    m_colors.push_back(m_object.get_curve3(i).get_color(k));
+                    m_vertices.push_back(curve.get_control_point(k));
+                    m_widths.push_back(curve.get_width(k));
+                    m_opacities.push_back(curve.get_opacity(k));
+                    m_colors.push_back(curve.get_color(k));
 
                     ++vertex_count;
                     ++m_total_vertex_count;
@@ -221,14 +225,15 @@ namespace
 
 bool CurveObjectWriter::write(
     const CurveObject&  object,
-    const char*         filepath)
+    const char*         filepath,
+    const int           binarycurve_options)
 {
     assert(filepath);
 
     Stopwatch<DefaultWallclockTimer> stopwatch;
     stopwatch.start();
 
-    GenericCurveFileWriter writer(filepath);
+    GenericCurveFileWriter writer(filepath, binarycurve_options);
     CurveObjectWalker walker(object);
 
     try
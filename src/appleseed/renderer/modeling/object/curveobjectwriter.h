@@ -44,11 +44,13 @@ namespace renderer
 class APPLESEED_DLLSYMBOL CurveObjectWriter
 {
   public:
-    // Write a curve object to disk.
+    // Write a curve object to disk. binarycurve_options is a combination of
+    // foundation::BinaryCurveFileWriter::Options flags.
     // Return true on success, false otherwise.
     static bool write(
         const CurveObject&  object,
-        const char*         filepath);
+        const char*         filepath,
+        const int           binarycurve_options = 0);
 };
 
 }   // namespace renderer
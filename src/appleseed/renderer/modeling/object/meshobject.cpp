@@ -31,19 +31,35 @@
 #include "meshobject.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/kernel/rasterization/objectrasterizer.h"
+#include "renderer/kernel/tessellation/subdivisionsurface.h"
 #include "renderer/modeling/object/meshobjectprimitives.h"
 #include "renderer/modeling/object/meshobjectreader.h"
 #include "renderer/modeling/object/triangle.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/scalar.h"
 #include "foundation/utility/api/apiarray.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/murmurhash.h"
+#include "foundation/utility/string.h"
+
+// appleseed.main headers.
+#include "main/allocator.h"
+
+// Boost headers.
+#include "boost/thread/mutex.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -60,12 +76,80 @@ namespace renderer
 namespace
 {
     const char* Model = "mesh_object";
+
+    // Tessellations shared by mesh objects with identical contents, indexed by signature.
+    class SharedTessellationRegistry
+      : public NonCopyable
+    {
+      public:
+        // Return the tessellation registered under a given signature, or register
+        // a given tessellation under this signature if there is none.
+        shared_ptr<StaticTriangleTess> insert(
+            const MurmurHash&                       signature,
+            const shared_ptr<StaticTriangleTess>&   tess)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            weak_ptr<StaticTriangleTess>& entry = m_tessellations[signature];
+
+            shared_ptr<StaticTriangleTess> existing = entry.lock();
+            if (existing)
+                return existing;
+
+            entry = tess;
+            return tess;
+        }
+
+      private:
+        boost::mutex                                            m_mutex;
+        map<MurmurHash, weak_ptr<StaticTriangleTess>>           m_tessellations;
+    };
+
+    SharedTessellationRegistry g_shared_tessellations;
 }
 
 struct MeshObject::Impl
 {
-    StaticTriangleTess          m_tess;
-    vector<string>              m_material_slots;
+    shared_ptr<StaticTriangleTess>  m_tess;
+    vector<string>                  m_material_slots;
+    TaggedMemoryRecord              m_memory_record;
+
+    // Subdivision surface.
+    bool                            m_subdivision;
+    size_t                          m_subdivision_max_level;
+    double                          m_subdivision_edge_length;
+    unique_ptr<StaticTriangleTess>  m_subdivided_tess;
+    size_t                          m_subdivision_level;
+    size_t                          m_control_vertex_count;
+    size_t                          m_control_triangle_count;
+    VersionID                       m_control_version_id;
+
+    Impl()
+      : m_tess(new StaticTriangleTess())
+      , m_memory_record(MemoryTagGeometry)
+      , m_subdivision(false)
+      , m_subdivision_max_level(3)
+      , m_subdivision_edge_length(2.0)
+      , m_subdivision_level(0)
+      , m_control_vertex_count(0)
+      , m_control_triangle_count(0)
+      , m_control_version_id(~VersionID(0))
+    {
+    }
+
+    // Return the tessellation for editing, after giving this object its own copy
+    // of it if it is shared with other objects.
+    StaticTriangleTess& writable_tess()
+    {
+        if (m_tess.use_count() > 1)
+        {
+            shared_ptr<StaticTriangleTess> copy(new StaticTriangleTess());
+            copy->copy_from(*m_tess);
+            m_tess = copy;
+        }
+
+        return *m_tess;
+    }
 };
 
 MeshObject::MeshObject(
@@ -75,6 +159,21 @@ MeshObject::MeshObject(
   , impl(new Impl())
 {
     m_inputs.declare("alpha_map", InputFormatFloat, "");
+
+    const string scheme = m_params.get_optional<string>("subdivision_scheme", "none");
+    if (scheme == "catmull_clark")
+        impl->m_subdivision = true;
+    else if (scheme != "none")
+    {
+        RENDERER_LOG_ERROR(
+            "invalid value \"%s\" for parameter \"subdivision_scheme\" of object \"%s\", "
+            "using default value \"none\".",
+            scheme.c_str(),
+            name);
+    }
+
+    impl->m_subdivision_max_level = m_params.get_optional<size_t>("subdivision_max_level", 3);
+    impl->m_subdivision_edge_length = m_params.get_optional<double>("subdivision_edge_length", 2.0);
 }
 
 MeshObject::~MeshObject()
@@ -97,30 +196,178 @@ const Source* MeshObject::get_uncached_alpha_map() const
     return m_inputs.source("alpha_map");
 }
 
+bool MeshObject::on_render_begin(
+    const Project&              project,
+    const BaseGroup*            parent,
+    OnRenderBeginRecorder&      recorder,
+    IAbortSwitch*               abort_switch)
+{
+    if (!Object::on_render_begin(project, parent, recorder, abort_switch))
+        return false;
+
+    // The mesh is complete: switch to a more compact storage if it allows it.
+    impl->m_tess->compact();
+
+    return true;
+}
+
+bool MeshObject::on_frame_begin(
+    const Project&              project,
+    const BaseGroup*            parent,
+    OnFrameBeginRecorder&       recorder,
+    IAbortSwitch*               abort_switch)
+{
+    if (!Object::on_frame_begin(project, parent, recorder, abort_switch))
+        return false;
+
+    // Account for the memory used by the tessellations, which may have been edited since the last frame.
+    // A tessellation shared with other mesh objects is accounted for in equal parts by each of them.
+    impl->m_memory_record.set(
+        impl->m_tess->get_memory_size() / impl->m_tess.use_count() +
+        (impl->m_subdivided_tess ? impl->m_subdivided_tess->get_memory_size() : 0));
+
+    return true;
+}
+
 GAABB3 MeshObject::compute_local_bbox() const
 {
-    return impl->m_tess.compute_local_bbox();
+    return impl->m_tess->compute_local_bbox();
 }
 
 const StaticTriangleTess& MeshObject::get_static_triangle_tess() const
 {
-    return impl->m_tess;
+    return impl->m_subdivided_tess ? *impl->m_subdivided_tess : *impl->m_tess;
+}
+
+size_t MeshObject::share_tessellation(const MurmurHash& signature)
+{
+    const shared_ptr<StaticTriangleTess> tess = g_shared_tessellations.insert(signature, impl->m_tess);
+
+    if (tess == impl->m_tess)
+        return 0;
+
+    const size_t saved_bytes = impl->m_tess->get_memory_size();
+    impl->m_tess = tess;
+
+    return saved_bytes;
+}
+
+bool MeshObject::is_subdivision_surface() const
+{
+    return impl->m_subdivision;
+}
+
+double MeshObject::get_average_control_edge_length() const
+{
+    const StaticTriangleTess& tess = *impl->m_tess;
+
+    const size_t triangle_count = tess.get_primitive_count();
+
+    if (triangle_count == 0)
+        return 0.0;
+
+    // Interior edges are counted twice, which doesn't bias the average much.
+    double total_length = 0.0;
+
+    for (size_t i = 0; i < triangle_count; ++i)
+    {
+        const Triangle prim = tess.get_primitive(i);
+
+        const GVector3& v0 = tess.m_vertices[prim.m_v0];
+        const GVector3& v1 = tess.m_vertices[prim.m_v1];
+        const GVector3& v2 = tess.m_vertices[prim.m_v2];
+
+        total_length += norm(v1 - v0);
+        total_length += norm(v2 - v1);
+        total_length += norm(v0 - v2);
+    }
+
+    return total_length / (3 * triangle_count);
+}
+
+size_t MeshObject::compute_subdivision_level(const double edge_length_in_pixels) const
+{
+    // Without a target edge length, subdivide uniformly up to the maximum level.
+    if (impl->m_subdivision_edge_length <= 0.0)
+        return impl->m_subdivision_max_level;
+
+    // Each step halves the length of the edges.
+    const double ratio = edge_length_in_pixels / impl->m_subdivision_edge_length;
+    if (!(ratio > 1.0))
+        return 0;
+
+    const double level = ceil(log2(ratio));
+
+    return level < static_cast<double>(impl->m_subdivision_max_level)
+        ? static_cast<size_t>(level)
+        : impl->m_subdivision_max_level;
+}
+
+size_t MeshObject::get_max_subdivision_level() const
+{
+    return impl->m_subdivision_max_level;
+}
+
+bool MeshObject::update_subdivision(const size_t level)
+{
+    assert(impl->m_subdivision);
+
+    const size_t clamped_level = min(level, impl->m_subdivision_max_level);
+
+    const bool control_mesh_changed =
+        impl->m_control_version_id != get_version_id() ||
+        impl->m_control_vertex_count != impl->m_tess->m_vertices.size() ||
+        impl->m_control_triangle_count != impl->m_tess->get_primitive_count();
+
+    if (!control_mesh_changed && clamped_level == impl->m_subdivision_level)
+        return false;
+
+    impl->m_control_version_id = get_version_id();
+    impl->m_control_vertex_count = impl->m_tess->m_vertices.size();
+    impl->m_control_triangle_count = impl->m_tess->get_primitive_count();
+    impl->m_subdivision_level = clamped_level;
+
+    if (clamped_level == 0)
+        impl->m_subdivided_tess.reset();
+    else
+    {
+        impl->m_subdivided_tess.reset(new StaticTriangleTess());
+        subdivide_catmull_clark(*impl->m_tess, clamped_level, *impl->m_subdivided_tess);
+        impl->m_subdivided_tess->compact();
+
+        RENDERER_LOG_DEBUG(
+            "subdivided object \"%s\" " FMT_SIZE_T " time%s: %s triangle%s.",
+            get_name(),
+            clamped_level,
+            clamped_level > 1 ? "s" : "",
+            pretty_uint(impl->m_subdivided_tess->get_primitive_count()).c_str(),
+            impl->m_subdivided_tess->get_primitive_count() > 1 ? "s" : "");
+    }
+
+    return true;
+}
+
+size_t MeshObject::get_subdivision_level() const
+{
+    return impl->m_subdivision_level;
 }
 
 void MeshObject::rasterize(ObjectRasterizer& rasterizer) const
 {
     rasterizer.begin_object();
 
-    for (const auto& prim : impl->m_tess.m_primitives)
+    for (size_t i = 0, e = impl->m_tess->get_primitive_count(); i < e; ++i)
     {
-        const auto& v0 = impl->m_tess.m_vertices[prim.m_v0];
-        const auto& v1 = impl->m_tess.m_vertices[prim.m_v1];
-        const auto& v2 = impl->m_tess.m_vertices[prim.m_v2];
+        const Triangle prim = impl->m_tess->get_primitive(i);
+
+        const auto& v0 = impl->m_tess->m_vertices[prim.m_v0];
+        const auto& v1 = impl->m_tess->m_vertices[prim.m_v1];
+        const auto& v2 = impl->m_tess->m_vertices[prim.m_v2];
 
         // todo: check that vertex normals are available.
-        const auto& n0 = impl->m_tess.m_vertex_normals[prim.m_n0];
-        const auto& n1 = impl->m_tess.m_vertex_normals[prim.m_n1];
-        const auto& n2 = impl->m_tess.m_vertex_normals[prim.m_n2];
+        const GVector3 n0 = impl->m_tess->get_vertex_normal(prim.m_n0);
+        const GVector3 n1 = impl->m_tess->get_vertex_normal(prim.m_n1);
+        const GVector3 n2 = impl->m_tess->get_vertex_normal(prim.m_n2);
 
         ObjectRasterizer::Triangle triangle;
 
@@ -156,135 +403,138 @@ void MeshObject::rasterize(ObjectRasterizer& rasterizer) const
 
 void MeshObject::reserve_vertices(const size_t count)
 {
-    impl->m_tess.m_vertices.reserve(count);
+    impl->writable_tess().m_vertices.reserve(count);
 }
 
 size_t MeshObject::push_vertex(const GVector3& vertex)
 {
-    const size_t index = impl->m_tess.m_vertices.size();
-    impl->m_tess.m_vertices.push_back(vertex);
+    const size_t index = impl->writable_tess().m_vertices.size();
+    impl->writable_tess().m_vertices.push_back(vertex);
     return index;
 }
 
 size_t MeshObject::get_vertex_count() const
 {
-    return impl->m_tess.m_vertices.size();
+    return impl->m_tess->m_vertices.size();
 }
 
 const GVector3& MeshObject::get_vertex(const size_t index) const
 {
-    return impl->m_tess.m_vertices[index];
+    return impl->m_tess->m_vertices[index];
 }
 
 void MeshObject::reserve_vertex_normals(const size_t count)
 {
-    impl->m_tess.m_vertex_normals.reserve(count);
+    impl->writable_tess().reserve_vertex_normals(count);
 }
 
 size_t MeshObject::push_vertex_normal(const GVector3& normal)
 {
     assert(is_normalized(normal));
 
-    const size_t index = impl->m_tess.m_vertex_normals.size();
-    impl->m_tess.m_vertex_normals.push_back(normal);
-    return index;
+    return impl->writable_tess().push_vertex_normal(normal);
 }
 
 size_t MeshObject::get_vertex_normal_count() const
 {
-    return impl->m_tess.m_vertex_normals.size();
+    return impl->m_tess->get_vertex_normal_count();
 }
 
-const GVector3& MeshObject::get_vertex_normal(const size_t index) const
+GVector3 MeshObject::get_vertex_normal(const size_t index) const
 {
-    return impl->m_tess.m_vertex_normals[index];
+    return impl->m_tess->get_vertex_normal(index);
 }
 
 void MeshObject::clear_vertex_normals()
 {
-    impl->m_tess.m_vertex_normals.clear();
+    impl->writable_tess().m_vertex_normals.clear();
 }
 
 void MeshObject::reserve_vertex_tangents(const size_t count)
 {
-    impl->m_tess.reserve_vertex_tangents(count);
+    impl->writable_tess().reserve_vertex_tangents(count);
 }
 
 size_t MeshObject::push_vertex_tangent(const GVector3& tangent)
 {
-    return impl->m_tess.push_vertex_tangent(tangent);
+    return impl->writable_tess().push_vertex_tangent(tangent);
 }
 
 size_t MeshObject::get_vertex_tangent_count() const
 {
-    return impl->m_tess.get_vertex_tangent_count();
+    return impl->m_tess->get_vertex_tangent_count();
 }
 
 GVector3 MeshObject::get_vertex_tangent(const size_t index) const
 {
-    return impl->m_tess.get_vertex_tangent(index);
+    return impl->m_tess->get_vertex_tangent(index);
 }
 
 void MeshObject::reserve_tex_coords(const size_t count)
 {
-    impl->m_tess.reserve_tex_coords(count);
+    impl->writable_tess().reserve_tex_coords(count);
 }
 
 size_t MeshObject::push_tex_coords(const GVector2& tex_coords)
 {
-    return impl->m_tess.push_tex_coords(tex_coords);
+    return impl->writable_tess().push_tex_coords(tex_coords);
 }
 
 size_t MeshObject::get_tex_coords_count() const
 {
-    return impl->m_tess.get_tex_coords_count();
+    return impl->m_tess->get_tex_coords_count();
 }
 
 GVector2 MeshObject::get_tex_coords(const size_t index) const
 {
-    return impl->m_tess.get_tex_coords(index);
+    return impl->m_tess->get_tex_coords(index);
 }
 
 void MeshObject::reserve_triangles(const size_t count)
 {
-    impl->m_tess.m_primitives.reserve(count);
+    impl->writable_tess().expand();
+    impl->writable_tess().m_primitives.reserve(count);
 }
 
 size_t MeshObject::push_triangle(const Triangle& triangle)
 {
-    const size_t index = impl->m_tess.m_primitives.size();
-    impl->m_tess.m_primitives.push_back(triangle);
+    impl->writable_tess().expand();
+
+    const size_t index = impl->writable_tess().m_primitives.size();
+    impl->writable_tess().m_primitives.push_back(triangle);
     return index;
 }
 
 size_t MeshObject::get_triangle_count() const
 {
-    return impl->m_tess.m_primitives.size();
+    return impl->m_tess->get_primitive_count();
 }
 
-const Triangle& MeshObject::get_triangle(const size_t index) const
+Triangle MeshObject::get_triangle(const size_t index) const
 {
-    return impl->m_tess.m_primitives[index];
+    return impl->m_tess->get_primitive(index);
 }
 
 Triangle& MeshObject::get_triangle(const size_t index)
 {
-    return impl->m_tess.m_primitives[index];
+    impl->writable_tess().expand();
+    return impl->writable_tess().m_primitives[index];
 }
 
 void MeshObject::clear_triangles()
 {
-    impl->m_tess.m_primitives.clear();
+    impl->writable_tess().expand();
+    impl->writable_tess().m_primitives.clear();
 }
 
 void MeshObject::set_motion_segment_count(const size_t count)
 {
-    impl->m_tess.set_motion_segment_count(count);
+    impl->writable_tess().set_motion_segment_count(count);
 }
 
 size_t MeshObject::get_motion_segment_count() const
 {
-    return impl->m_tess.get_motion_segment_count();
+    return impl->m_tess->get_motion_segment_count();
 }
 
 void MeshObject::set_vertex_pose(
@@ -292,19 +542,19 @@ void MeshObject::set_vertex_pose(
     const size_t            motion_segment_index,
     const GVector3&         vertex)
 {
-    impl->m_tess.set_vertex_pose(vertex_index, motion_segment_index, vertex);
+    impl->writable_tess().set_vertex_pose(vertex_index, motion_segment_index, vertex);
 }
 
 GVector3 MeshObject::get_vertex_pose(
     const size_t            vertex_index,
     const size_t            motion_segment_index) const
 {
-    return impl->m_tess.get_vertex_pose(vertex_index, motion_segment_index);
+    return impl->m_tess->get_vertex_pose(vertex_index, motion_segment_index);
 }
 
 void MeshObject::clear_vertex_poses()
 {
-    impl->m_tess.clear_vertex_poses();
+    impl->writable_tess().clear_vertex_poses();
 }
 
 void MeshObject::set_vertex_normal_pose(
@@ -312,19 +562,19 @@ void MeshObject::set_vertex_normal_pose(
     const size_t            motion_segment_index,
     const GVector3&         normal)
 {
-    impl->m_tess.set_vertex_normal_pose(normal_index, motion_segment_index, normal);
+    impl->writable_tess().set_vertex_normal_pose(normal_index, motion_segment_index, normal);
 }
 
 GVector3 MeshObject::get_vertex_normal_pose(
     const size_t            normal_index,
     const size_t            motion_segment_index) const
 {
-    return impl->m_tess.get_vertex_normal_pose(normal_index, motion_segment_index);
+    return impl->m_tess->get_vertex_normal_pose(normal_index, motion_segment_index);
 }
 
 void MeshObject::clear_vertex_normal_poses()
 {
-    impl->m_tess.clear_vertex_normal_poses();
+    impl->writable_tess().clear_vertex_normal_poses();
 }
 
 void MeshObject::set_vertex_tangent_pose(
@@ -332,19 +582,19 @@ void MeshObject::set_vertex_tangent_pose(
     const size_t            motion_segment_index,
     const GVector3&         tangent)
 {
-    impl->m_tess.set_vertex_tangent_pose(tangent_index, motion_segment_index, tangent);
+    impl->writable_tess().set_vertex_tangent_pose(tangent_index, motion_segment_index, tangent);
 }
 
 GVector3 MeshObject::get_vertex_tangent_pose(
     const size_t            tangent_index,
     const size_t            motion_segment_index) const
 {
-    return impl->m_tess.get_vertex_tangent_pose(tangent_index, motion_segment_index);
+    return impl->m_tess->get_vertex_tangent_pose(tangent_index, motion_segment_index);
 }
 
 void MeshObject::clear_vertex_tangent_poses()
 {
-    impl->m_tess.clear_vertex_tangent_poses();
+    impl->writable_tess().clear_vertex_tangent_poses();
 }
 
 void MeshObject::reserve_material_slots(const size_t count)
@@ -439,6 +689,51 @@ DictionaryArray MeshObjectFactory::get_input_metadata() const
                     .insert("type", "hard"))
             .insert("use", "optional"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "subdivision_scheme")
+            .insert("label", "Subdivision Scheme")
+            .insert("type", "enumeration")
+            .insert("items",
+                Dictionary()
+                    .insert("None", "none")
+                    .insert("Catmull-Clark", "catmull_clark"))
+            .insert("use", "optional")
+            .insert("default", "none"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "subdivision_max_level")
+            .insert("label", "Max Subdivision Level")
+            .insert("type", "integer")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "0")
+                    .insert("type", "hard"))
+            .insert("max",
+                Dictionary()
+                    .insert("value", "6")
+                    .insert("type", "soft"))
+            .insert("use", "optional")
+            .insert("default", "3"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "subdivision_edge_length")
+            .insert("label", "Target Edge Length")
+            .insert("type", "numeric")
+            .insert("min",
+                Dictionary()
+                    .insert("value", "0.0")
+                    .insert("type", "hard"))
+            .insert("max",
+                Dictionary()
+                    .insert("value", "16.0")
+                    .insert("type", "soft"))
+            .insert("use", "optional")
+            .insert("default", "2.0")
+            .insert("help", "Target length in pixels of the edges of the subdivided mesh; 0 subdivides uniformly up to the maximum level"));
+
     return metadata;
 }
 
@@ -48,11 +48,17 @@
 // Forward declarations.
 namespace foundation    { class Dictionary; }
 namespace foundation    { class DictionaryArray; }
+namespace foundation    { class IAbortSwitch; }
+namespace foundation    { class MurmurHash; }
 namespace foundation    { class SearchPaths; }
 namespace foundation    { class StringArray; }
 namespace foundation    { class StringDictionary; }
+namespace renderer      { class BaseGroup; }
 namespace renderer      { class ObjectRasterizer; }
+namespace renderer      { class OnFrameBeginRecorder; }
+namespace renderer      { class OnRenderBeginRecorder; }
 namespace renderer      { class ParamArray; }
+namespace renderer      { class Project; }
 namespace renderer      { class Source; }
 namespace renderer      { class Triangle; }
 
@@ -78,12 +84,52 @@ class APPLESEED_DLLSYMBOL MeshObject
     // Return the source bound to the alpha map input, or 0 if the object doesn't have an alpha map.
     const Source* get_uncached_alpha_map() const override;
 
+    bool on_render_begin(
+        const Project&              project,
+        const BaseGroup*            parent,
+        OnRenderBeginRecorder&      recorder,
+        foundation::IAbortSwitch*   abort_switch = nullptr) override;
+
+    bool on_frame_begin(
+        const Project&              project,
+        const BaseGroup*            parent,
+        OnFrameBeginRecorder&       recorder,
+        foundation::IAbortSwitch*   abort_switch = nullptr) override;
+
     // Compute the local space bounding box of the object over the shutter interval.
     GAABB3 compute_local_bbox() const override;
 
-    // Return the static triangle tessellation of the object.
+    // Return the static triangle tessellation of the object. For subdivision surfaces,
+    // this is the subdivided tessellation rather than the control mesh.
     const StaticTriangleTess& get_static_triangle_tess() const;
 
+    // Share the tessellation of this object with the mesh objects whose tessellation was
+    // registered under the same signature, or register it if there is none. A shared
+    // tessellation is copied when it is edited. Return the number of bytes saved.
+    size_t share_tessellation(const foundation::MurmurHash& signature);
+
+    // Return true if this object is a Catmull-Clark subdivision surface whose control mesh
+    // is the tessellation built with the methods below.
+    bool is_subdivision_surface() const;
+
+    // Return the average object space length of the edges of the control mesh.
+    double get_average_control_edge_length() const;
+
+    // Return the number of subdivision steps needed for the edges of the control mesh,
+    // which span a given number of pixels on screen, to reach the target edge length.
+    size_t compute_subdivision_level(const double edge_length_in_pixels) const;
+
+    // Return the maximum number of subdivision steps.
+    size_t get_max_subdivision_level() const;
+
+    // Tessellate the subdivision surface using a given number of subdivision steps.
+    // The tessellation is reused if neither the level nor the control mesh changed.
+    // Returns true if the tessellation was rebuilt.
+    bool update_subdivision(const size_t level);
+
+    // Return the number of subdivision steps of the current tessellation.
+    size_t get_subdivision_level() const;
+
     // Send this object to an object rasterizer.
     void rasterize(ObjectRasterizer& drawer) const override;
 
@@ -97,7 +143,7 @@ class APPLESEED_DLLSYMBOL MeshObject
     void reserve_vertex_normals(const size_t count);
     size_t push_vertex_normal(const GVector3& normal);      // the normal must be unit-length
     size_t get_vertex_normal_count() const;
-    const GVector3& get_vertex_normal(const size_t index) const;
+    GVector3 get_vertex_normal(const size_t index) const;
     void clear_vertex_normals();
 
     // Insert and access vertex tangents.
@@ -116,7 +162,7 @@ class APPLESEED_DLLSYMBOL MeshObject
     void reserve_triangles(const size_t count);
     size_t push_triangle(const Triangle& triangle);
     size_t get_triangle_count() const;
-    const Triangle& get_triangle(const size_t index) const;
+    Triangle get_triangle(const size_t index) const;
     Triangle& get_triangle(const size_t index);
     void clear_triangles();
 
@@ -30,18 +30,28 @@
 #include "meshobjectoperations.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/global/globaltypes.h"
 #include "renderer/modeling/object/meshobject.h"
 #include "renderer/modeling/object/triangle.h"
+#include "renderer/utility/paramarray.h"
 #include "renderer/utility/triangle.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/murmurhash.h"
 
 // Standard headers.
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <unordered_map>
 #include <vector>
 
 using namespace foundation;
@@ -50,178 +60,427 @@ using namespace std;
 namespace renderer
 {
 
-void compute_smooth_vertex_normals_base_pose(MeshObject& object)
+namespace
+{
+    // Meshes with fewer vertices than this are processed on the calling thread.
+    const size_t MinParallelVertexCount = 64 * 1024;
+
+    template <typename Function>
+    class RangeJob
+      : public IJob
+    {
+      public:
+        RangeJob(
+            const Function&     function,
+            const size_t        begin,
+            const size_t        end)
+          : m_function(function)
+          , m_begin(begin)
+          , m_end(end)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            m_function(m_begin, m_end);
+        }
+
+      private:
+        const Function&         m_function;
+        const size_t            m_begin;
+        const size_t            m_end;
+    };
+
+    // Call function(begin, end) on disjoint ranges covering [0, count), in parallel for large counts.
+    template <typename Function>
+    void for_each_range(const size_t count, const Function& function)
+    {
+        const size_t thread_count =
+            min(System::get_logical_cpu_core_count(), count / MinParallelVertexCount);
+
+        if (thread_count < 2)
+        {
+            function(0, count);
+            return;
+        }
+
+        // Use more ranges than threads to balance the load.
+        const size_t range_count = 4 * thread_count;
+
+        JobQueue job_queue;
+
+        for (size_t i = 0; i < range_count; ++i)
+        {
+            job_queue.schedule(
+                new RangeJob<Function>(
+                    function,
+                    i * count / range_count,
+                    (i + 1) * count / range_count));
+        }
+
+        JobManager job_manager(
+            global_logger(),
+            job_queue,
+            thread_count,
+            JobManager::KeepRunningOnEmptyQueue);
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+        job_manager.stop();
+    }
+
+    // The triangles incident to each vertex, in increasing order. Summing per-triangle vectors
+    // over them adds the same values in the same order as a sequential loop over the triangles,
+    // so results don't depend on the number of threads.
+    struct VertexTriangles
+    {
+        vector<size_t>          m_offsets;      // triangles of vertex i are in [m_offsets[i], m_offsets[i + 1])
+        vector<uint32>          m_triangles;
+
+        explicit VertexTriangles(const MeshObject& object)
+        {
+            const size_t vertex_count = object.get_vertex_count();
+            const size_t triangle_count = object.get_triangle_count();
+
+            m_offsets.assign(vertex_count + 1, 0);
+
+            for (size_t i = 0; i < triangle_count; ++i)
+            {
+                const Triangle triangle = object.get_triangle(i);
+                ++m_offsets[triangle.m_v0 + 1];
+                ++m_offsets[triangle.m_v1 + 1];
+                ++m_offsets[triangle.m_v2 + 1];
+            }
+
+            for (size_t i = 0; i < vertex_count; ++i)
+                m_offsets[i + 1] += m_offsets[i];
+
+            vector<size_t> ends(m_offsets.begin(), m_offsets.end() - 1);
+            m_triangles.resize(m_offsets[vertex_count]);
+
+            for (size_t i = 0; i < triangle_count; ++i)
+            {
+                const Triangle triangle = object.get_triangle(i);
+                m_triangles[ends[triangle.m_v0]++] = static_cast<uint32>(i);
+                m_triangles[ends[triangle.m_v1]++] = static_cast<uint32>(i);
+                m_triangles[ends[triangle.m_v2]++] = static_cast<uint32>(i);
+            }
+        }
+    };
+
+    // Compute the normalized sum of the unit normals of the triangles incident to each vertex,
+    // with vertex positions given by get_vertex(vertex_index).
+    template <typename GetVertex>
+    void compute_smooth_normals(
+        const MeshObject&       object,
+        const VertexTriangles&  vertex_triangles,
+        const GetVertex&        get_vertex,
+        vector<GVector3>&       normals)
+    {
+        normals.resize(object.get_vertex_count());
+
+        for_each_range(
+            normals.size(),
+            [&](const size_t begin, const size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    GVector3 sum(0.0);
+
+                    for (size_t j = vertex_triangles.m_offsets[i], e = vertex_triangles.m_offsets[i + 1]; j < e; ++j)
+                    {
+                        const Triangle triangle = object.get_triangle(vertex_triangles.m_triangles[j]);
+                        sum +=
+                            normalize(
+                                compute_triangle_normal(
+                                    get_vertex(triangle.m_v0),
+                                    get_vertex(triangle.m_v1),
+                                    get_vertex(triangle.m_v2)));
+                    }
+
+                    normals[i] = safe_normalize(sum);
+                }
+            });
+    }
+
+    // Compute the normalized sum of the unit tangents of the triangles incident to each vertex,
+    // with vertex positions given by get_vertex(vertex_index).
+    template <typename GetVertex>
+    void compute_smooth_tangents(
+        const MeshObject&       object,
+        const VertexTriangles&  vertex_triangles,
+        const GetVertex&        get_vertex,
+        vector<GVector3>&       tangents)
+    {
+        tangents.resize(object.get_vertex_count());
+
+        for_each_range(
+            tangents.size(),
+            [&](const size_t begin, const size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    GVector3 sum(0.0);
+
+                    for (size_t j = vertex_triangles.m_offsets[i], e = vertex_triangles.m_offsets[i + 1]; j < e; ++j)
+                    {
+                        const Triangle triangle = object.get_triangle(vertex_triangles.m_triangles[j]);
+
+                        if (!triangle.has_vertex_attributes())
+                            continue;
+
+                        const GVector2 v0_uv = object.get_tex_coords(triangle.m_a0);
+                        const GVector2 v1_uv = object.get_tex_coords(triangle.m_a1);
+                        const GVector2 v2_uv = object.get_tex_coords(triangle.m_a2);
+
+                        //
+                        // Reference:
+                        //
+                        //   Physically Based Rendering, first edition, pp. 128-129
+                        //
+
+                        const GScalar du0 = v0_uv[0] - v2_uv[0];
+                        const GScalar dv0 = v0_uv[1] - v2_uv[1];
+                        const GScalar du1 = v1_uv[0] - v2_uv[0];
+                        const GScalar dv1 = v1_uv[1] - v2_uv[1];
+                        const GScalar det = du0 * dv1 - dv0 * du1;
+
+                        if (det == GScalar(0.0))
+                            continue;
+
+                        const GVector3 v2 = get_vertex(triangle.m_v2);
+                        const GVector3 dp0 = get_vertex(triangle.m_v0) - v2;
+                        const GVector3 dp1 = get_vertex(triangle.m_v1) - v2;
+                        sum += normalize(dv1 * dp0 - dv0 * dp1);
+                    }
+
+                    tangents[i] = safe_normalize(sum);
+                }
+            });
+    }
+}
+
+void compute_smooth_vertex_normals(MeshObject& object)
 {
     assert(object.get_vertex_normal_count() == 0);
 
     const size_t vertex_count = object.get_vertex_count();
     const size_t triangle_count = object.get_triangle_count();
 
-    vector<GVector3> normals(vertex_count, GVector3(0.0));
-
     for (size_t i = 0; i < triangle_count; ++i)
     {
         Triangle& triangle = object.get_triangle(i);
         triangle.m_n0 = triangle.m_v0;
         triangle.m_n1 = triangle.m_v1;
         triangle.m_n2 = triangle.m_v2;
+    }
 
-        const GVector3& v0 = object.get_vertex(triangle.m_v0);
-        const GVector3& v1 = object.get_vertex(triangle.m_v1);
-        const GVector3& v2 = object.get_vertex(triangle.m_v2);
-        const GVector3 normal = normalize(compute_triangle_normal(v0, v1, v2));
+    // Only use const accessors from here on: they are safe to call from multiple threads.
+    const MeshObject& const_object = object;
+    const VertexTriangles vertex_triangles(const_object);
+    vector<GVector3> normals;
 
-        normals[triangle.m_v0] += normal;
-        normals[triangle.m_v1] += normal;
-        normals[triangle.m_v2] += normal;
-    }
+    compute_smooth_normals(
+        const_object,
+        vertex_triangles,
+        [&const_object](const size_t vertex_index)
+        {
+            return const_object.get_vertex(vertex_index);
+        },
+        normals);
 
     object.reserve_vertex_normals(vertex_count);
 
     for (size_t i = 0; i < vertex_count; ++i)
-        object.push_vertex_normal(safe_normalize(normals[i]));
+        object.push_vertex_normal(normals[i]);
+
+    for (size_t j = 0, e = object.get_motion_segment_count(); j < e; ++j)
+    {
+        compute_smooth_normals(
+            const_object,
+            vertex_triangles,
+            [&const_object, j](const size_t vertex_index)
+            {
+                return const_object.get_vertex_pose(vertex_index, j);
+            },
+            normals);
+
+        for (size_t i = 0; i < vertex_count; ++i)
+            object.set_vertex_normal_pose(i, j, normals[i]);
+    }
 }
 
-void compute_smooth_vertex_normals_pose(MeshObject& object, const size_t motion_segment_index)
+void compute_smooth_vertex_tangents(MeshObject& object)
 {
-    const size_t vertex_count = object.get_vertex_count();
-    const size_t triangle_count = object.get_triangle_count();
+    assert(object.get_vertex_tangent_count() == 0);
+    assert(object.get_tex_coords_count() > 0);
 
-    vector<GVector3> normals(vertex_count, GVector3(0.0));
+    const size_t vertex_count = object.get_vertex_count();
 
-    for (size_t i = 0; i < triangle_count; ++i)
-    {
-        const Triangle& triangle = object.get_triangle(i);
+    // Only use const accessors from here on: they are safe to call from multiple threads.
+    const MeshObject& const_object = object;
+    const VertexTriangles vertex_triangles(const_object);
+    vector<GVector3> tangents;
 
-        const GVector3& v0 = object.get_vertex_pose(triangle.m_v0, motion_segment_index);
-        const GVector3& v1 = object.get_vertex_pose(triangle.m_v1, motion_segment_index);
-        const GVector3& v2 = object.get_vertex_pose(triangle.m_v2, motion_segment_index);
-        const GVector3 normal = normalize(compute_triangle_normal(v0, v1, v2));
+    compute_smooth_tangents(
+        const_object,
+        vertex_triangles,
+        [&const_object](const size_t vertex_index)
+        {
+            return const_object.get_vertex(vertex_index);
+        },
+        tangents);
 
-        normals[triangle.m_v0] += normal;
-        normals[triangle.m_v1] += normal;
-        normals[triangle.m_v2] += normal;
-    }
+    object.reserve_vertex_tangents(vertex_count);
 
     for (size_t i = 0; i < vertex_count; ++i)
-        object.set_vertex_normal_pose(i, motion_segment_index, safe_normalize(normals[i]));
+        object.push_vertex_tangent(tangents[i]);
+
+    for (size_t j = 0, e = object.get_motion_segment_count(); j < e; ++j)
+    {
+        compute_smooth_tangents(
+            const_object,
+            vertex_triangles,
+            [&const_object, j](const size_t vertex_index)
+            {
+                return const_object.get_vertex_pose(vertex_index, j);
+            },
+            tangents);
+
+        for (size_t i = 0; i < vertex_count; ++i)
+            object.set_vertex_tangent_pose(i, j, tangents[i]);
+    }
 }
 
-void compute_smooth_vertex_normals(MeshObject& object)
+auto_release_ptr<MeshObject> create_decimated_mesh(
+    const char*         name,
+    const MeshObject&   object,
+    const double        vertex_ratio)
 {
-    compute_smooth_vertex_normals_base_pose(object);
+    assert(vertex_ratio > 0.0);
 
-    for (size_t i = 0; i < object.get_motion_segment_count(); ++i)
-        compute_smooth_vertex_normals_pose(object, i);
-}
+    auto_release_ptr<MeshObject> result(MeshObjectFactory().create(name, ParamArray()));
 
-void compute_smooth_vertex_tangents_base_pose(MeshObject& object)
-{
-    assert(object.get_vertex_tangent_count() == 0);
-    assert(object.get_tex_coords_count() > 0);
+    for (size_t i = 0, e = object.get_material_slot_count(); i < e; ++i)
+        result->push_material_slot(object.get_material_slot(i));
 
     const size_t vertex_count = object.get_vertex_count();
     const size_t triangle_count = object.get_triangle_count();
+    const size_t motion_segment_count = object.get_motion_segment_count();
 
-    vector<GVector3> tangents(vertex_count, GVector3(0.0));
+    if (vertex_count == 0 || triangle_count == 0)
+        return result;
 
+    // Compute the bounding box and the area of the mesh.
+    GAABB3 bbox;
+    bbox.invalidate();
+    for (size_t i = 0; i < vertex_count; ++i)
+        bbox.insert(object.get_vertex(i));
+
+    double area = 0.0;
     for (size_t i = 0; i < triangle_count; ++i)
     {
         const Triangle& triangle = object.get_triangle(i);
+        area +=
+            0.5 * norm(
+                compute_triangle_normal(
+                    object.get_vertex(triangle.m_v0),
+                    object.get_vertex(triangle.m_v1),
+                    object.get_vertex(triangle.m_v2)));
+    }
 
-        if (!triangle.has_vertex_attributes())
-            continue;
-
-        const GVector2 v0_uv = object.get_tex_coords(triangle.m_a0);
-        const GVector2 v1_uv = object.get_tex_coords(triangle.m_a1);
-        const GVector2 v2_uv = object.get_tex_coords(triangle.m_a2);
+    // Size the cells of the grid so that the surface spans about as many cells as there are
+    // vertices to keep, and keep cell coordinates within 21 bits.
+    const double target_vertex_count = max(vertex_ratio * vertex_count, 4.0);
+    const double cell_size =
+        max(
+            sqrt(area / target_vertex_count),
+            static_cast<double>(max_value(bbox.extent())) / (1 << 21));
 
-        //
-        // Reference:
-        //
-        //   Physically Based Rendering, first edition, pp. 128-129
-        //
+    // Map vertices to the clusters of the cells that contain them.
+    unordered_map<uint64, uint32> cells;
+    vector<uint32> vertex_clusters(vertex_count);
+    vector<GVector3> cluster_positions;         // summed positions of all poses, pose-major
+    vector<size_t> cluster_sizes;
 
-        const GScalar du0 = v0_uv[0] - v2_uv[0];
-        const GScalar dv0 = v0_uv[1] - v2_uv[1];
-        const GScalar du1 = v1_uv[0] - v2_uv[0];
-        const GScalar dv1 = v1_uv[1] - v2_uv[1];
-        const GScalar det = du0 * dv1 - dv0 * du1;
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        uint64 cell_key = 0;
 
-        if (det == GScalar(0.0))
-            continue;
+        if (cell_size > 0.0)
+        {
+            const GVector3 p = (object.get_vertex(i) - bbox.min) / static_cast<GScalar>(cell_size);
+            for (size_t d = 0; d < 3; ++d)
+                cell_key = (cell_key << 21) | min<uint64>(truncate<uint64>(max<GScalar>(p[d], 0)), (1 << 21) - 1);
+        }
 
-        const GVector3& v2 = object.get_vertex(triangle.m_v2);
-        const GVector3 dp0 = object.get_vertex(triangle.m_v0) - v2;
-        const GVector3 dp1 = object.get_vertex(triangle.m_v1) - v2;
-        const GVector3 tangent = normalize(dv1 * dp0 - dv0 * dp1);
+        const auto it = cells.insert(make_pair(cell_key, static_cast<uint32>(cluster_sizes.size())));
+        if (it.second)
+            cluster_sizes.push_back(0);
 
-        tangents[triangle.m_v0] += tangent;
-        tangents[triangle.m_v1] += tangent;
-        tangents[triangle.m_v2] += tangent;
+        vertex_clusters[i] = it.first->second;
+        ++cluster_sizes[it.first->second];
     }
 
-    object.reserve_vertex_tangents(vertex_count);
+    const size_t cluster_count = cluster_sizes.size();
+    cluster_positions.assign(cluster_count * (1 + motion_segment_count), GVector3(0.0));
 
     for (size_t i = 0; i < vertex_count; ++i)
-        object.push_vertex_tangent(safe_normalize(tangents[i]));
-}
-
-void compute_smooth_vertex_tangents_pose(MeshObject& object, const size_t motion_segment_index)
-{
-    assert(object.get_tex_coords_count() > 0);
-
-    const size_t vertex_count = object.get_vertex_count();
-    const size_t triangle_count = object.get_triangle_count();
-
-    vector<GVector3> tangents(vertex_count, GVector3(0.0));
-
-    for (size_t i = 0; i < triangle_count; ++i)
     {
-        const Triangle& triangle = object.get_triangle(i);
-
-        if (!triangle.has_vertex_attributes())
-            continue;
-
-        const GVector2 v0_uv = object.get_tex_coords(triangle.m_a0);
-        const GVector2 v1_uv = object.get_tex_coords(triangle.m_a1);
-        const GVector2 v2_uv = object.get_tex_coords(triangle.m_a2);
+        const size_t cluster = vertex_clusters[i];
+        cluster_positions[cluster] += object.get_vertex(i);
 
-        //
-        // Reference:
-        //
-        //   Physically Based Rendering, first edition, pp. 128-129
-        //
+        for (size_t j = 0; j < motion_segment_count; ++j)
+            cluster_positions[(1 + j) * cluster_count + cluster] += object.get_vertex_pose(i, j);
+    }
 
-        const GScalar du0 = v0_uv[0] - v2_uv[0];
-        const GScalar dv0 = v0_uv[1] - v2_uv[1];
-        const GScalar du1 = v1_uv[0] - v2_uv[0];
-        const GScalar dv1 = v1_uv[1] - v2_uv[1];
-        const GScalar det = du0 * dv1 - dv0 * du1;
+    // Clusters are placed at the average position of their vertices.
+    result->reserve_vertices(cluster_count);
+    for (size_t i = 0; i < cluster_count; ++i)
+        result->push_vertex(cluster_positions[i] / static_cast<GScalar>(cluster_sizes[i]));
 
-        if (det == GScalar(0.0))
-            continue;
+    result->set_motion_segment_count(motion_segment_count);
+    for (size_t j = 0; j < motion_segment_count; ++j)
+    {
+        for (size_t i = 0; i < cluster_count; ++i)
+        {
+            result->set_vertex_pose(
+                i,
+                j,
+                cluster_positions[(1 + j) * cluster_count + i] / static_cast<GScalar>(cluster_sizes[i]));
+        }
+    }
 
-        const GVector3& v2 = object.get_vertex_pose(triangle.m_v2, motion_segment_index);
-        const GVector3 dp0 = object.get_vertex_pose(triangle.m_v0, motion_segment_index) - v2;
-        const GVector3 dp1 = object.get_vertex_pose(triangle.m_v1, motion_segment_index) - v2;
-        const GVector3 tangent = normalize(dv1 * dp0 - dv0 * dp1);
+    // Vertex normals and texture coordinates are kept as they are.
+    result->reserve_vertex_normals(object.get_vertex_normal_count());
+    for (size_t i = 0, e = object.get_vertex_normal_count(); i < e; ++i)
+        result->push_vertex_normal(object.get_vertex_normal(i));
 
-        tangents[triangle.m_v0] += tangent;
-        tangents[triangle.m_v1] += tangent;
-        tangents[triangle.m_v2] += tangent;
+    for (size_t j = 0; j < motion_segment_count; ++j)
+    {
+        for (size_t i = 0, e = object.get_vertex_normal_count(); i < e; ++i)
+            result->set_vertex_normal_pose(i, j, object.get_vertex_normal_pose(i, j));
     }
 
-    for (size_t i = 0; i < vertex_count; ++i)
-        object.set_vertex_tangent_pose(i, motion_segment_index, safe_normalize(tangents[i]));
-}
+    result->reserve_tex_coords(object.get_tex_coords_count());
+    for (size_t i = 0, e = object.get_tex_coords_count(); i < e; ++i)
+        result->push_tex_coords(object.get_tex_coords(i));
 
-void compute_smooth_vertex_tangents(MeshObject& object)
-{
-    compute_smooth_vertex_tangents_base_pose(object);
+    // Keep the triangles whose vertices fall into three distinct clusters.
+    for (size_t i = 0; i < triangle_count; ++i)
+    {
+        Triangle triangle = object.get_triangle(i);
+        triangle.m_v0 = vertex_clusters[triangle.m_v0];
+        triangle.m_v1 = vertex_clusters[triangle.m_v1];
+        triangle.m_v2 = vertex_clusters[triangle.m_v2];
+
+        if (triangle.m_v0 != triangle.m_v1 &&
+            triangle.m_v1 != triangle.m_v2 &&
+            triangle.m_v2 != triangle.m_v0)
+            result->push_triangle(triangle);
+    }
 
-    for (size_t i = 0; i < object.get_motion_segment_count(); ++i)
-        compute_smooth_vertex_tangents_pose(object, i);
+    return result;
 }
 
 void compute_signature(MurmurHash& hash, const MeshObject& object)
@@ -266,6 +525,11 @@ void compute_signature(MurmurHash& hash, const MeshObject& object)
         for (size_t i = 0, e = object.get_vertex_tangent_count(); i < e; ++i)
             hash.append(object.get_vertex_tangent_pose(i, j));
     }
+
+    // Subdivision.
+
+    if (object.is_subdivision_surface())
+        hash.append(object.get_subdivision_level());
 }
 
 }   // namespace renderer
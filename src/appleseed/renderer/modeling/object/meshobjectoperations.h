@@ -28,6 +28,9 @@
 
 #pragma once
 
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
@@ -47,6 +50,14 @@ APPLESEED_DLLSYMBOL void compute_smooth_vertex_normals(MeshObject& object);
 // The mesh object must have texture coordinates.
 APPLESEED_DLLSYMBOL void compute_smooth_vertex_tangents(MeshObject& object);
 
+// Create a coarser version of a mesh object by clustering its vertices on a regular grid,
+// keeping about 'vertex_ratio' of them. Triangles keep their vertex normals, texture
+// coordinates and materials; vertex tangents are dropped.
+APPLESEED_DLLSYMBOL foundation::auto_release_ptr<MeshObject> create_decimated_mesh(
+    const char*         name,
+    const MeshObject&   object,
+    const double        vertex_ratio);
+
 // Compute a hash for a mesh object.
 APPLESEED_DLLSYMBOL void compute_signature(foundation::MurmurHash& hash, const MeshObject& object);
 
@@ -55,10 +55,14 @@
 #include "foundation/utility/filter.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/memory.h"
+#include "foundation/utility/murmurhash.h"
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Standard headers.
 #include <algorithm>
 #include <cassert>
@@ -172,23 +176,27 @@ namespace
             return m_objects.back()->push_vertex(GVector3(v));
         }
 
-        size_t push_vertex_normal(const Vector3d& v) override
+        void push_vertex_array(const Vector3f vertices[], const size_t count) override
         {
-            GVector3 n(v);
+            MeshObject* object = m_objects.back();
+            object->reserve_vertices(object->get_vertex_count() + count);
 
-            const GScalar norm_n = norm(n);
+            for (size_t i = 0; i < count; ++i)
+                object->push_vertex(GVector3(vertices[i]));
+        }
 
-            if (norm_n > GScalar(0.0))
-                n /= norm_n;
-            else
-            {
-                ++m_null_normal_vector_count;
-                n = GVector3(GScalar(1.0), GScalar(0.0), GScalar(0.0));
-            }
+        size_t push_vertex_normal(const Vector3d& v) override
+        {
+            return normalize_and_push_vertex_normal(GVector3(v));
+        }
 
-            ++m_normal_count;
+        void push_vertex_normal_array(const Vector3f vertex_normals[], const size_t count) override
+        {
+            MeshObject* object = m_objects.back();
+            object->reserve_vertex_normals(object->get_vertex_normal_count() + count);
 
-            return m_objects.back()->push_vertex_normal(n);
+            for (size_t i = 0; i < count; ++i)
+                normalize_and_push_vertex_normal(GVector3(vertex_normals[i]));
         }
 
         size_t push_tex_coords(const Vector2d& v) override
@@ -196,6 +204,15 @@ namespace
             return m_objects.back()->push_tex_coords(GVector2(v));
         }
 
+        void push_tex_coords_array(const Vector2f tex_coords[], const size_t count) override
+        {
+            MeshObject* object = m_objects.back();
+            object->reserve_tex_coords(object->get_tex_coords_count() + count);
+
+            for (size_t i = 0; i < count; ++i)
+                object->push_tex_coords(GVector2(tex_coords[i]));
+        }
+
         size_t push_material_slot(const char* name) override
         {
             return m_objects.back()->push_material_slot(name);
@@ -291,6 +308,51 @@ namespace
             m_face_material = static_cast<uint32>(material);
         }
 
+        void push_triangle_array(
+            const uint32        vertices[],
+            const uint32        vertex_normals[],
+            const uint32        tex_coords[],
+            const uint16        materials[],
+            const size_t        count) override
+        {
+            MeshObject* object = m_objects.back();
+            object->reserve_triangles(object->get_triangle_count() + count);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                const uint32* v = vertices + i * 3;
+                const uint32* n = vertex_normals + i * 3;
+                const uint32* a = tex_coords + i * 3;
+
+                Triangle triangle;
+                triangle.m_v0 = v[0];
+                triangle.m_v1 = v[1];
+                triangle.m_v2 = v[2];
+
+                if (!m_ignore_vertex_normals)
+                {
+                    triangle.m_n0 = n[0];
+                    triangle.m_n1 = n[1];
+                    triangle.m_n2 = n[2];
+                }
+                else
+                {
+                    triangle.m_n0 = Triangle::None;
+                    triangle.m_n1 = Triangle::None;
+                    triangle.m_n2 = Triangle::None;
+                }
+
+                triangle.m_a0 = a[0];
+                triangle.m_a1 = a[1];
+                triangle.m_a2 = a[2];
+                triangle.m_pa = materials[i];
+
+                object->push_triangle(triangle);
+            }
+
+            m_face_count += count;
+        }
+
       private:
         const ParamArray        m_params;
         const bool              m_ignore_vertex_normals;
@@ -324,6 +386,23 @@ namespace
         size_t                  m_total_vertex_count;
         size_t                  m_total_triangle_count;
 
+        size_t normalize_and_push_vertex_normal(GVector3 n)
+        {
+            const GScalar norm_n = norm(n);
+
+            if (norm_n > GScalar(0.0))
+                n /= norm_n;
+            else
+            {
+                ++m_null_normal_vector_count;
+                n = GVector3(GScalar(1.0), GScalar(0.0), GScalar(0.0));
+            }
+
+            ++m_normal_count;
+
+            return m_objects.back()->push_vertex_normal(n);
+        }
+
         void reset_mesh_stats()
         {
             m_normal_count = 0;
@@ -402,6 +481,10 @@ namespace
     {
         GenericMeshFileReader reader(filename);
 
+        // Parsing OBJ files in parallel yields the exact same meshes as parsing them sequentially.
+        reader.set_obj_options(
+            reader.get_obj_options() | OBJMeshFileReader::ParallelParsing);
+
         const string obj_parsing_mode = params.get_optional<string>("obj_parsing_mode", "fast");
 
         if (obj_parsing_mode == "fast")
@@ -814,6 +897,8 @@ bool MeshObjectReader::read(
 {
     assert(base_object_name);
 
+    MemoryTagScope memory_tag_scope(MemoryTagGeometry);
+
     // Objects will be tagged with the name of their parent.
     ParamArray completed_params(params);
     completed_params.insert("__base_object_name", base_object_name);
@@ -914,6 +999,24 @@ bool MeshObjectReader::read(
         }
     }
 
+    // Share the tessellation of objects identical to previously loaded ones.
+    for (size_t i = 0, e = objects.size(); i < e; ++i)
+    {
+        MeshObject& object = *objects[i];
+
+        MurmurHash signature;
+        compute_signature(signature, object);
+
+        const size_t saved_bytes = object.share_tessellation(signature);
+        if (saved_bytes > 0)
+        {
+            RENDERER_LOG_INFO(
+                "mesh object \"%s\" is identical to a previously loaded mesh object, sharing its tessellation (saved %s).",
+                object.get_path().c_str(),
+                pretty_size(saved_bytes).c_str());
+        }
+    }
+
     return true;
 }
 
@@ -33,8 +33,12 @@
 #include "foundation/platform/types.h"
 
 // Standard headers.
+#include <cassert>
 #include <cstddef>
 
+// Forward declarations.
+namespace renderer  { class CompactTriangle; }
+
 namespace renderer
 {
 
@@ -47,9 +51,8 @@ namespace renderer
 class Triangle
 {
   public:
-    // todo: indices could be stored as 16-bit integers if the number of
-    // vertices / vertex normals / vertex attributes per region would be
-    // limited to 65535 (one value is used to indicate an absent feature).
+    // Compact representation of triangles.
+    typedef CompactTriangle CompactType;
 
     // Special index value used to indicate that a feature is not present.
     static const foundation::uint32 None = ~foundation::uint32(0);
@@ -95,6 +98,41 @@ class Triangle
 };
 
 
+//
+// A triangle with 16-bit indices, used by tessellations whose feature arrays
+// are small enough. Absent features are still represented by Triangle::None
+// once the triangle is expanded back to a Triangle.
+//
+
+class CompactTriangle
+{
+  public:
+    // Special index value used to indicate that a feature is not present.
+    static const foundation::uint16 None = ~foundation::uint16(0);
+
+    // Public members.
+    foundation::uint16  m_v0, m_v1, m_v2;   // vertex indices
+    foundation::uint16  m_n0, m_n1, m_n2;   // vertex normal indices
+    foundation::uint16  m_a0, m_a1, m_a2;   // vertex attribute indices
+    foundation::uint16  m_pa;               // primitive attribute index
+
+    // Constructors.
+    CompactTriangle();                      // leave all fields uninitialized
+    explicit CompactTriangle(const Triangle& triangle);
+
+    // Return true if all indices of a given triangle fit in a compact triangle.
+    static bool is_representable(const Triangle& triangle);
+
+    // Convert back to a triangle with 32-bit indices.
+    Triangle expand() const;
+
+  private:
+    static bool is_representable(const foundation::uint32 index);
+    static foundation::uint16 compact_index(const foundation::uint32 index);
+    static foundation::uint32 expand_index(const foundation::uint16 index);
+};
+
+
 //
 // Triangle class implementation.
 //
@@ -188,4 +226,81 @@ inline bool Triangle::has_vertex_attributes() const
     return m_a0 != None && m_a1 != None && m_a2 != None;
 }
 
+
+//
+// CompactTriangle class implementation.
+//
+
+inline CompactTriangle::CompactTriangle()
+{
+}
+
+inline CompactTriangle::CompactTriangle(const Triangle& triangle)
+  : m_v0(compact_index(triangle.m_v0))
+  , m_v1(compact_index(triangle.m_v1))
+  , m_v2(compact_index(triangle.m_v2))
+  , m_n0(compact_index(triangle.m_n0))
+  , m_n1(compact_index(triangle.m_n1))
+  , m_n2(compact_index(triangle.m_n2))
+  , m_a0(compact_index(triangle.m_a0))
+  , m_a1(compact_index(triangle.m_a1))
+  , m_a2(compact_index(triangle.m_a2))
+  , m_pa(compact_index(triangle.m_pa))
+{
+}
+
+inline bool CompactTriangle::is_representable(const Triangle& triangle)
+{
+    return
+        is_representable(triangle.m_v0) &&
+        is_representable(triangle.m_v1) &&
+        is_representable(triangle.m_v2) &&
+        is_representable(triangle.m_n0) &&
+        is_representable(triangle.m_n1) &&
+        is_representable(triangle.m_n2) &&
+        is_representable(triangle.m_a0) &&
+        is_representable(triangle.m_a1) &&
+        is_representable(triangle.m_a2) &&
+        is_representable(triangle.m_pa);
+}
+
+inline Triangle CompactTriangle::expand() const
+{
+    return
+        Triangle(
+            expand_index(m_v0),
+            expand_index(m_v1),
+            expand_index(m_v2),
+            expand_index(m_n0),
+            expand_index(m_n1),
+            expand_index(m_n2),
+            expand_index(m_a0),
+            expand_index(m_a1),
+            expand_index(m_a2),
+            expand_index(m_pa));
+}
+
+inline bool CompactTriangle::is_representable(const foundation::uint32 index)
+{
+    return index < None || index == Triangle::None;
+}
+
+inline foundation::uint16 CompactTriangle::compact_index(const foundation::uint32 index)
+{
+    assert(is_representable(index));
+
+    if (index == Triangle::None)
+        return None;
+
+    return static_cast<foundation::uint16>(index);
+}
+
+inline foundation::uint32 CompactTriangle::expand_index(const foundation::uint16 index)
+{
+    if (index == None)
+        return Triangle::None;
+
+    return static_cast<foundation::uint32>(index);
+}
+
 }   // namespace renderer
@@ -199,20 +199,42 @@ namespace
 
         void execute(Frame& frame) const override
         {
-            float min_luminance, max_luminance;
+            begin_tiled_execution(frame);
 
+            m_color_map.remap_relative_luminance(
+                frame.image(),
+                frame.get_crop_window(),
+                m_min_luminance,
+                m_max_luminance);
+
+            end_tiled_execution(frame);
+        }
+
+        bool supports_tiled_execution() const override
+        {
+            return true;
+        }
+
+        bool supports_incremental_execution() const override
+        {
+            // The automatic luminance range and the isolines depend on the whole frame.
+            return !m_auto_range && !m_render_isolines;
+        }
+
+        void begin_tiled_execution(const Frame& frame) const override
+        {
             if (m_auto_range)
             {
                 m_color_map.find_min_max_relative_luminance(
                     frame.image(),
                     frame.get_crop_window(),
-                    min_luminance,
-                    max_luminance);
+                    m_min_luminance,
+                    m_max_luminance);
             }
             else
             {
-                min_luminance = m_range_min;
-                max_luminance = m_range_max;
+                m_min_luminance = m_range_min;
+                m_max_luminance = m_range_max;
             }
 
             RENDERER_LOG_INFO(
@@ -220,25 +242,46 @@ namespace
                 "  min luminance                 %f\n"
                 "  max luminance                 %f",
                 get_path().c_str(),
-                min_luminance,
-                max_luminance);
+                m_min_luminance,
+                m_max_luminance);
 
-            SegmentVector isoline_segments;
+            m_isoline_segments.clear();
 
             if (m_render_isolines)
-                collect_isoline_segments(isoline_segments, frame, min_luminance, max_luminance);
+                collect_isoline_segments(m_isoline_segments, frame, m_min_luminance, m_max_luminance);
+        }
+
+        void execute_tile(
+            const Frame&            frame,
+            const size_t            tile_x,
+            const size_t            tile_y) const override
+        {
+            const CanvasProperties& props = frame.image().properties();
+
+            const Vector2u tile_origin(tile_x * props.m_tile_width, tile_y * props.m_tile_height);
+            const AABB2u tile_bbox(
+                tile_origin,
+                tile_origin + Vector2u(props.get_tile_width(tile_x) - 1, props.get_tile_height(tile_y) - 1));
+
+            // Only remap the pixels of the tile that lie inside the crop window.
+            const AABB2u window = AABB2u::intersect(tile_bbox, frame.get_crop_window());
+            if (!window.is_valid())
+                return;
 
             m_color_map.remap_relative_luminance(
                 frame.image(),
-                frame.get_crop_window(),
-                min_luminance,
-                max_luminance);
+                window,
+                m_min_luminance,
+                m_max_luminance);
+        }
 
+        void end_tiled_execution(const Frame& frame) const override
+        {
             if (m_render_isolines)
-                render_isoline_segments(frame, isoline_segments);
+                render_isoline_segments(frame, m_isoline_segments);
 
             if (m_add_legend_bar)
-                add_legend_bar(frame, min_luminance, max_luminance);
+                add_legend_bar(frame, m_min_luminance, m_max_luminance);
         }
 
       private:
@@ -277,6 +320,11 @@ namespace
         bool                m_render_isolines;
         float               m_line_thickness;
 
+        // State of the current tiled execution.
+        mutable float           m_min_luminance;
+        mutable float           m_max_luminance;
+        mutable SegmentVector   m_isoline_segments;
+
         void set_palette_from_image_file(const string& file_path)
         {
             GenericImageFileReader reader;
@@ -288,7 +336,7 @@ namespace
             m_color_map.set_palette_from_image_file(*image.get());
         }
 
-        void add_legend_bar(Frame& frame, const float min_luminance, const float max_luminance) const
+        void add_legend_bar(const Frame& frame, const float min_luminance, const float max_luminance) const
         {
             // Legend bar settings.
             const float LegendBarWidthPercent = 5.0f;               // width in percents of the legend bar
@@ -415,7 +463,7 @@ namespace
         }
 
         void render_isoline_segments(
-            Frame&                      frame,
+            const Frame&                frame,
             const SegmentVector&        segments) const
         {
             Image& image = frame.image();
@@ -30,9 +30,20 @@
 #include "postprocessingstage.h"
 
 // appleseed.renderer headers.
+#include "renderer/modeling/frame/frame.h"
 #include "renderer/utility/messagecontext.h"
 #include "renderer/utility/paramarray.h"
 
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/math/aabb.h"
+#include "foundation/utility/job.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+
 using namespace foundation;
 using namespace std;
 
@@ -65,4 +76,121 @@ PostProcessingStage::PostProcessingStage(
     m_order = m_params.get_required<int>("order", 0, context);
 }
 
+bool PostProcessingStage::supports_tiled_execution() const
+{
+    return false;
+}
+
+bool PostProcessingStage::supports_incremental_execution() const
+{
+    return false;
+}
+
+void PostProcessingStage::begin_tiled_execution(
+    const Frame&        frame) const
+{
+}
+
+void PostProcessingStage::execute_tile(
+    const Frame&        frame,
+    const size_t        tile_x,
+    const size_t        tile_y) const
+{
+}
+
+void PostProcessingStage::end_tiled_execution(
+    const Frame&        frame) const
+{
+}
+
+
+//
+// Utility functions implementation.
+//
+
+void get_ordered_post_processing_stages(
+    PostProcessingStageContainer&       stages,
+    vector<PostProcessingStage*>&       ordered_stages)
+{
+    ordered_stages.clear();
+    ordered_stages.reserve(stages.size());
+
+    for (auto& stage : stages)
+        ordered_stages.push_back(&stage);
+
+    // Stages with equal order keep their relative order so that all callers agree on it.
+    stable_sort(
+        ordered_stages.begin(),
+        ordered_stages.end(),
+        [](PostProcessingStage* lhs, PostProcessingStage* rhs)
+        {
+            return lhs->get_order() < rhs->get_order();
+        });
+}
+
+namespace
+{
+    class PostProcessingTileJob
+      : public IJob
+    {
+      public:
+        PostProcessingTileJob(
+            const PostProcessingStage&  stage,
+            const Frame&                frame,
+            const size_t                tile_x,
+            const size_t                tile_y)
+          : m_stage(stage)
+          , m_frame(frame)
+          , m_tile_x(tile_x)
+          , m_tile_y(tile_y)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            m_stage.execute_tile(m_frame, m_tile_x, m_tile_y);
+        }
+
+      private:
+        const PostProcessingStage&      m_stage;
+        const Frame&                    m_frame;
+        const size_t                    m_tile_x;
+        const size_t                    m_tile_y;
+    };
+}
+
+void execute_post_processing_stage(
+    const PostProcessingStage&          stage,
+    Frame&                              frame,
+    JobQueue&                           job_queue)
+{
+    if (!stage.supports_tiled_execution())
+    {
+        stage.execute(frame);
+        return;
+    }
+
+    stage.begin_tiled_execution(frame);
+
+    // Only process the tiles that intersect the crop window.
+    const CanvasProperties& props = frame.image().properties();
+    const AABB2u& crop_window = frame.get_crop_window();
+    const size_t min_tile_x = crop_window.min.x / props.m_tile_width;
+    const size_t min_tile_y = crop_window.min.y / props.m_tile_height;
+    const size_t max_tile_x = crop_window.max.x / props.m_tile_width;
+    const size_t max_tile_y = crop_window.max.y / props.m_tile_height;
+    assert(max_tile_x < props.m_tile_count_x);
+    assert(max_tile_y < props.m_tile_count_y);
+
+    for (size_t ty = min_tile_y; ty <= max_tile_y; ++ty)
+    {
+        for (size_t tx = min_tile_x; tx <= max_tile_x; ++tx)
+            job_queue.schedule(new PostProcessingTileJob(stage, frame, tx, ty));
+    }
+
+    job_queue.wait_until_completion();
+
+    stage.end_tiled_execution(frame);
+}
+
 }   // namespace renderer
@@ -30,6 +30,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/modeling/entity/connectableentity.h"
+#include "renderer/modeling/postprocessingstage/postprocessingstagecontainer.h"
 
 // appleseed.foundation headers.
 #include "foundation/utility/uid.h"
@@ -37,9 +38,14 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <cstddef>
+#include <vector>
+
 // Forward declarations.
-namespace renderer  { class Frame; }
-namespace renderer  { class ParamArray; }
+namespace foundation    { class JobQueue; }
+namespace renderer      { class Frame; }
+namespace renderer      { class ParamArray; }
 
 namespace renderer
 {
@@ -66,10 +72,54 @@ class APPLESEED_DLLSYMBOL PostProcessingStage
     virtual void execute(
         Frame&                  frame) const = 0;
 
+    //
+    // Tiled execution.
+    //
+    // Stages supporting tiled execution are executed in three steps: begin_tiled_execution()
+    // is called once on the whole frame, then execute_tile() is called concurrently on all
+    // the tiles of the frame, then end_tiled_execution() is called once on the whole frame.
+    //
+
+    // Return true if this stage supports tiled execution. The default is false.
+    virtual bool supports_tiled_execution() const;
+
+    // Return true if this stage supports tiled execution and execute_tile() may be called
+    // on tiles as soon as they are rendered, i.e. if begin_tiled_execution() does not read
+    // the pixels of the frame. The default is false.
+    virtual bool supports_incremental_execution() const;
+
+    virtual void begin_tiled_execution(
+        const Frame&            frame) const;
+
+    virtual void execute_tile(
+        const Frame&            frame,
+        const size_t            tile_x,
+        const size_t            tile_y) const;
+
+    virtual void end_tiled_execution(
+        const Frame&            frame) const;
+
   private:
     int m_order;
 };
 
+
+//
+// Utility functions.
+//
+
+// Collect the post-processing stages of a container, sorted in execution order.
+APPLESEED_DLLSYMBOL void get_ordered_post_processing_stages(
+    PostProcessingStageContainer&           stages,
+    std::vector<PostProcessingStage*>&      ordered_stages);
+
+// Execute a post-processing stage on a frame. If the stage supports tiled execution,
+// the tiles of the frame are processed in parallel on the given job queue.
+APPLESEED_DLLSYMBOL void execute_post_processing_stage(
+    const PostProcessingStage&              stage,
+    Frame&                                  frame,
+    foundation::JobQueue&                   job_queue);
+
 //
 // PostProcessingStage class implementation.
 //
@@ -68,9 +68,14 @@ PostProcessingStageFactoryRegistrar::~PostProcessingStageFactoryRegistrar()
     delete impl;
 }
 
-void PostProcessingStageFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
+const char* PostProcessingStageFactoryRegistrar::register_factory_plugin(Plugin* plugin, void* plugin_entry_point)
 {
-    impl->register_factory_plugin(plugin, plugin_entry_point);
+    return impl->register_factory_plugin(plugin, plugin_entry_point);
+}
+
+void PostProcessingStageFactoryRegistrar::set_plugin_store(PluginStore* plugin_store, const char* entry_point_name)
+{
+    impl->set_plugin_store(plugin_store, entry_point_name);
 }
 
 PostProcessingStageFactoryArray PostProcessingStageFactoryRegistrar::get_factories() const
@@ -32,6 +32,7 @@
 
 // appleseed.renderer headers.
 #include "renderer/kernel/lighting/backwardlightsampler.h"
+#include "renderer/kernel/lighting/forwardlightsampler.h"
 #include "renderer/kernel/lighting/pt/ptlightingengine.h"
 #include "renderer/kernel/lighting/sppm/sppmlightingengine.h"
 #include "renderer/kernel/rendering/final/adaptivetilerenderer.h"
@@ -99,7 +100,7 @@ Dictionary Configuration::get_metadata()
         "sampling_mode",
         Dictionary()
             .insert("type", "enum")
-            .insert("values", "rng|qmc")
+            .insert("values", "rng|qmc|sobol")
             .insert("default", "qmc")
             .insert("label", "Sampler")
             .insert("help", "Sampling algorithm used in Monte Carlo integration")
@@ -115,7 +116,12 @@ Dictionary Configuration::get_metadata()
                         "qmc",
                         Dictionary()
                             .insert("label", "QMC")
-                            .insert("help", "Quasi Monte Carlo sampler"))));
+                            .insert("help", "Quasi Monte Carlo sampler"))
+                    .insert(
+                        "sobol",
+                        Dictionary()
+                            .insert("label", "Sobol")
+                            .insert("help", "Quasi Monte Carlo sampler based on Owen-scrambled Sobol sequences"))));
 
     metadata.dictionaries().insert(
         "passes",
@@ -154,6 +160,14 @@ Dictionary Configuration::get_metadata()
             .insert("label", "Render Threads")
             .insert("help", "Number of threads to use for rendering"));
 
+    metadata.insert(
+        "views",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Views")
+            .insert("help", "Space-separated names of cameras to render in turn in one session; all views but the last are written next to the output file of the frame, suffixed with their camera name"));
+
 #ifdef APPLESEED_WITH_EMBREE
 
     metadata.insert(
@@ -163,11 +177,117 @@ Dictionary Configuration::get_metadata()
             .insert("label", "Use Embree")
             .insert("help", "Whether to use Embree ray tracing kernels or appleseed internal ones"));
 
+    metadata.insert(
+        "use_embree_instancing",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Use Embree Instancing")
+            .insert("help", "When using Embree, whether Embree also handles assembly instances so that rays are traced entirely by Embree"));
+
+    metadata.insert(
+        "embree_build_quality",
+        Dictionary()
+            .insert("type", "enum")
+            .insert("values", "low|medium|high")
+            .insert("default", "high")
+            .insert("label", "Embree Build Quality")
+            .insert("help", "Quality of the Embree acceleration structures")
+            .insert(
+                "options",
+                Dictionary()
+                    .insert(
+                        "low",
+                        Dictionary()
+                            .insert("label", "Low")
+                            .insert("help", "Fastest builds, slower ray tracing"))
+                    .insert(
+                        "medium",
+                        Dictionary()
+                            .insert("label", "Medium")
+                            .insert("help", "Balance between build and ray tracing speed"))
+                    .insert(
+                        "high",
+                        Dictionary()
+                            .insert("label", "High")
+                            .insert("help", "Slowest builds, fastest ray tracing"))));
+
+    metadata.insert(
+        "embree_compact",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Compact Embree Scenes")
+            .insert("help", "Use more compact but slower Embree acceleration structures"));
+
+    metadata.insert(
+        "embree_robust",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Robust Embree Scenes")
+            .insert("help", "Avoid Embree optimizations that reduce arithmetic accuracy"));
+
 #endif
 
+#ifdef APPLESEED_WITH_GPU
+
+    metadata.insert(
+        "use_gpu",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Use GPU")
+            .insert("help", "Whether to trace batches of rays on the GPU with OptiX Prime when the scene allows it"));
+
+#endif
+
+    metadata.insert(
+        "ray_dump_file",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Ray Dump File")
+            .insert("help", "File into which the rays traced while rendering are recorded, to be replayed with projecttool replay"));
+
+    metadata.insert(
+        "ray_dump_ray_types",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Ray Dump Ray Types")
+            .insert("help", "Space-separated types of the rays to record (camera, light, shadow, transparency, probe, diffuse, glossy, specular, subsurface, npr); all rays are recorded by default"));
+
+    metadata.insert(
+        "shader_cache_directory",
+        Dictionary()
+            .insert("type", "text")
+            .insert("default", "")
+            .insert("label", "Shader Cache Directory")
+            .insert("help", "Directory where compiled OSL source shaders are cached across renders"));
+
+    metadata.insert(
+        "background_shader_optimization",
+        Dictionary()
+            .insert("type", "bool")
+            .insert("default", "false")
+            .insert("label", "Background Shader Optimization")
+            .insert("help", "Start rendering before OSL shader groups are optimized, shading them with a diffuse approximation until they are ready"));
+
+    metadata.insert(
+        "background_shader_optimization_threads",
+        Dictionary()
+            .insert("type", "int")
+            .insert("default", "1")
+            .insert("label", "Background Shader Optimization Threads")
+            .insert("help", "Number of threads optimizing OSL shader groups in the background"));
+
+    Dictionary light_sampler_metadata = BackwardLightSampler::get_params_metadata();
+    light_sampler_metadata.merge(ForwardLightSampler::get_params_metadata());
+
     metadata.dictionaries().insert(
         "light_sampler",
-        BackwardLightSampler::get_params_metadata());
+        light_sampler_metadata);
 
     metadata.dictionaries().insert(
         "texture_store",
@@ -310,6 +430,11 @@ auto_release_ptr<Configuration> BaseConfigurationFactory::create_base_interactiv
     parameters.insert("sample_renderer", "generic");
     parameters.insert("lighting_engine", "pt");
 
+#ifdef APPLESEED_WITH_EMBREE
+    // Interactive renders rebuild scenes often: favor fast Embree builds.
+    parameters.insert("embree_build_quality", "low");
+#endif
+
     return configuration;
 }
 
@@ -43,6 +43,7 @@
 #include "renderer/modeling/environmentedf/environmentedffactoryregistrar.h"
 #include "renderer/modeling/environmentshader/environmentshaderfactoryregistrar.h"
 #include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/input/inputbinder.h"
 #include "renderer/modeling/light/lightfactoryregistrar.h"
 #include "renderer/modeling/material/materialfactoryregistrar.h"
 #include "renderer/modeling/object/objectfactoryregistrar.h"
@@ -52,6 +53,7 @@
 #include "renderer/modeling/project/projectformatrevision.h"
 #include "renderer/modeling/scene/assemblyfactoryregistrar.h"
 #include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/lodselector.h"
 #include "renderer/modeling/scene/scene.h"
 #include "renderer/modeling/surfaceshader/surfaceshaderfactoryregistrar.h"
 #include "renderer/modeling/texture/texturefactoryregistrar.h"
@@ -60,6 +62,7 @@
 
 // appleseed.foundation headers.
 #include "foundation/utility/searchpaths.h"
+#include "foundation/utility/string.h"
 
 // Standard headers.
 #include <algorithm>
@@ -404,7 +407,50 @@ const TraceContext& Project::get_trace_context() const
 void Project::update_trace_context()
 {
     if (impl->m_trace_context.get() != nullptr)
+    {
+        // Some acceleration structures depend on the camera (e.g. the level of detail of
+        // curves), so make the active camera known to the scene before updating them.
+        impl->m_scene->m_camera = get_uncached_active_camera();
+
+        // Pick the level of detail of object instances before their geometry is collected.
+        if (impl->m_scene->m_camera != nullptr)
+        {
+            const size_t changed_lod_count =
+                select_object_instance_lods(*impl->m_scene, *impl->m_scene->m_camera);
+
+            if (changed_lod_count > 0)
+            {
+                RENDERER_LOG_INFO(
+                    "changed level of detail of %s object %s.",
+                    pretty_uint(changed_lod_count).c_str(),
+                    plural(changed_lod_count, "instance").c_str());
+            }
+        }
+
         impl->m_trace_context->update();
+    }
+}
+
+bool Project::build_trace_context()
+{
+    if (impl->m_scene.get() == nullptr)
+        return false;
+
+    InputBinder input_binder(*impl->m_scene);
+    input_binder.bind();
+    if (input_binder.get_error_count() > 0)
+        return false;
+
+    get_trace_context();
+    update_trace_context();
+
+    return true;
+}
+
+void Project::set_ray_dump_writer(RayDumpWriter* writer)
+{
+    get_trace_context();
+    impl->m_trace_context->set_ray_dump_writer(writer);
 }
 
 #ifdef APPLESEED_WITH_EMBREE
@@ -415,6 +461,28 @@ void Project::set_use_embree(const bool value)
         impl->m_trace_context->set_use_embree(value);
 }
 
+void Project::set_use_embree_instancing(const bool value)
+{
+    if (impl->m_trace_context.get() != nullptr)
+        impl->m_trace_context->set_use_embree_instancing(value);
+}
+
+void Project::set_embree_scene_settings(const EmbreeSceneSettings& settings)
+{
+    if (impl->m_trace_context.get() != nullptr)
+        impl->m_trace_context->set_embree_scene_settings(settings);
+}
+
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+
+void Project::set_use_gpu(const bool value)
+{
+    if (impl->m_trace_context.get() != nullptr)
+        impl->m_trace_context->set_use_gpu(value);
+}
+
 #endif
 
 void Project::add_base_configurations()
@@ -448,8 +516,10 @@ namespace
             entry_point_name.c_str(),
             [&registrar](Plugin* plugin, void* plugin_entry_point)
             {
-                registrar.register_factory_plugin(plugin, plugin_entry_point);
+                return registrar.register_factory_plugin(plugin, plugin_entry_point);
             });
+
+        registrar.set_plugin_store(&plugin_store, entry_point_name.c_str());
     }
 }
 
@@ -71,6 +71,7 @@ namespace renderer      { class BSSRDF; }
 namespace renderer      { class Camera; }
 namespace renderer      { class Display; }
 namespace renderer      { class EDF; }
+namespace renderer      { struct EmbreeSceneSettings; }
 namespace renderer      { class EnvironmentEDF; }
 namespace renderer      { class EnvironmentShader; }
 namespace renderer      { class Frame; }
@@ -81,6 +82,7 @@ namespace renderer      { class Object; }
 namespace renderer      { class OnFrameBeginRecorder; }
 namespace renderer      { class PluginStore; }
 namespace renderer      { class PostProcessingStage; }
+namespace renderer      { class RayDumpWriter; }
 namespace renderer      { class Scene; }
 namespace renderer      { class SurfaceShader; }
 namespace renderer      { class Texture; }
@@ -178,9 +180,29 @@ class APPLESEED_DLLSYMBOL Project
     // Synchronize the trace context with the scene.
     void update_trace_context();
 
+    // Bind the inputs of the scene entities, then build or synchronize the trace context,
+    // e.g. to inspect the acceleration structures without rendering the project.
+    // Returns false if the scene is missing or if some inputs could not be bound.
+    bool build_trace_context();
+
+    // Record the rays traced through the scene into a ray dump, or stop recording if 'writer' is null.
+    // Only intersectors created after this call record their rays.
+    void set_ray_dump_writer(RayDumpWriter* writer);
+
 #ifdef APPLESEED_WITH_EMBREE
     // Set use Embree flag for trace context
     void set_use_embree(const bool value);
+
+    // Set whether Embree also handles assembly instances in the trace context.
+    void set_use_embree_instancing(const bool value);
+
+    // Set the build quality and flags of the Embree scenes of the trace context.
+    void set_embree_scene_settings(const EmbreeSceneSettings& settings);
+#endif
+
+#ifdef APPLESEED_WITH_GPU
+    // Set whether batches of rays are traced on the GPU in the trace context.
+    void set_use_gpu(const bool value);
 #endif
 
   private:
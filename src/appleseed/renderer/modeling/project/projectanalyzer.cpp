@@ -0,0 +1,426 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "projectanalyzer.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/kernel/intersection/triangletree.h"
+#include "renderer/kernel/tessellation/statictessellation.h"
+#include "renderer/modeling/input/inputbinder.h"
+#include "renderer/modeling/object/curveobject.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/object.h"
+#include "renderer/modeling/project/configuration.h"
+#include "renderer/modeling/project/configurationcontainer.h"
+#include "renderer/modeling/project/project.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/modeling/shadergroup/shadergroup.h"
+#include "renderer/modeling/texture/texture.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/statistics.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <set>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// ProjectAnalyzer class implementation.
+//
+// Entities are counted once per assembly, instanced counts are counted once per
+// instance of the assemblies. Emission of OSL materials is only known once their
+// shader groups have been compiled by the shading system, so only emitting
+// materials with an EDF are accounted for.
+//
+
+namespace
+{
+    // Same default as the texture store.
+    const size_t DefaultTextureStoreSize = 256 * 1024 * 1024;
+
+    // Costs of an assembly and of the assemblies it instantiates.
+    struct InstancedCost
+    {
+        uint64  m_assembly_instance_count;
+        uint64  m_object_instance_count;
+        uint64  m_triangle_count;
+        uint64  m_light_count;
+        uint64  m_emitting_object_instance_count;
+        uint64  m_emitting_triangle_count;
+
+        InstancedCost()
+          : m_assembly_instance_count(0)
+          , m_object_instance_count(0)
+          , m_triangle_count(0)
+          , m_light_count(0)
+          , m_emitting_object_instance_count(0)
+          , m_emitting_triangle_count(0)
+        {
+        }
+
+        InstancedCost& operator+=(const InstancedCost& rhs)
+        {
+            m_assembly_instance_count += rhs.m_assembly_instance_count;
+            m_object_instance_count += rhs.m_object_instance_count;
+            m_triangle_count += rhs.m_triangle_count;
+            m_light_count += rhs.m_light_count;
+            m_emitting_object_instance_count += rhs.m_emitting_object_instance_count;
+            m_emitting_triangle_count += rhs.m_emitting_triangle_count;
+            return *this;
+        }
+    };
+}
+
+struct ProjectAnalyzer::Impl
+{
+    // Geometry.
+    uint64                                  m_assembly_count;
+    uint64                                  m_object_instance_count;
+    uint64                                  m_mesh_object_count;
+    uint64                                  m_curve_object_count;
+    uint64                                  m_static_triangle_count;
+    uint64                                  m_moving_triangle_count;
+    uint64                                  m_curve_count;
+    uint64                                  m_tessellation_memory_size;
+    uint64                                  m_triangle_tree_memory_size;
+
+    // Instancing and emitters.
+    InstancedCost                           m_instanced_cost;
+    uint64                                  m_environment_edf_count;
+
+    // Textures.
+    uint64                                  m_texture_count;
+    uint64                                  m_unreadable_texture_count;
+    uint64                                  m_texel_count;
+    uint64                                  m_texture_memory_size;
+    uint64                                  m_texture_store_size;
+
+    // Shading.
+    uint64                                  m_shader_group_count;
+    uint64                                  m_shader_count;
+
+    set<const Object*>                      m_visited_objects;
+    set<const StaticTriangleTess*>          m_visited_tessellations;
+    map<const Assembly*, InstancedCost>     m_assembly_costs;
+
+    explicit Impl(Project& project)
+      : m_assembly_count(0)
+      , m_object_instance_count(0)
+      , m_mesh_object_count(0)
+      , m_curve_object_count(0)
+      , m_static_triangle_count(0)
+      , m_moving_triangle_count(0)
+      , m_curve_count(0)
+      , m_tessellation_memory_size(0)
+      , m_triangle_tree_memory_size(0)
+      , m_environment_edf_count(0)
+      , m_texture_count(0)
+      , m_unreadable_texture_count(0)
+      , m_texel_count(0)
+      , m_texture_memory_size(0)
+      , m_texture_store_size(DefaultTextureStoreSize)
+      , m_shader_group_count(0)
+      , m_shader_count(0)
+    {
+        const Scene* scene = project.get_scene();
+        if (scene == nullptr)
+            return;
+
+        // Materials of object instances are only known once inputs are bound.
+        InputBinder input_binder(*scene);
+        input_binder.bind();
+
+        const Configuration* configuration = project.configurations().get_by_name("final");
+        if (configuration != nullptr)
+        {
+            m_texture_store_size =
+                configuration->get_inherited_parameters().get_path_optional<size_t>(
+                    "texture_store.max_size",
+                    DefaultTextureStoreSize);
+        }
+
+        m_environment_edf_count = scene->environment_edfs().size();
+
+        analyze_base_group(*scene);
+        m_instanced_cost = analyze_assembly_instances(*scene);
+    }
+
+    void analyze_base_group(const BaseGroup& base_group)
+    {
+        for (Texture& texture : base_group.textures())
+            analyze_texture(texture);
+
+        m_shader_group_count += base_group.shader_groups().size();
+
+        for (const ShaderGroup& shader_group : base_group.shader_groups())
+            m_shader_count += shader_group.shaders().size();
+    }
+
+    void analyze_texture(Texture& texture)
+    {
+        ++m_texture_count;
+
+        try
+        {
+            for (size_t i = 0, e = max<size_t>(texture.get_mip_level_count(), 1); i < e; ++i)
+            {
+                const CanvasProperties& props = texture.mip_level_properties(i);
+                m_texel_count += props.m_pixel_count;
+                m_texture_memory_size += props.m_pixel_count * props.m_pixel_size;
+            }
+        }
+        catch (const exception& e)
+        {
+            ++m_unreadable_texture_count;
+
+            RENDERER_LOG_WARNING(
+                "could not read texture \"%s\": %s",
+                texture.get_path().c_str(),
+                e.what());
+        }
+    }
+
+    InstancedCost analyze_assembly_instances(const BaseGroup& base_group)
+    {
+        InstancedCost cost;
+
+        for (const AssemblyInstance& assembly_instance : base_group.assembly_instances())
+        {
+            const Assembly* assembly = assembly_instance.find_assembly();
+            if (assembly == nullptr)
+                continue;
+
+            ++cost.m_assembly_instance_count;
+            cost += analyze_assembly(*assembly);
+        }
+
+        return cost;
+    }
+
+    InstancedCost analyze_assembly(const Assembly& assembly)
+    {
+        // Assemblies are only analyzed once, no matter how many times they are instantiated.
+        const auto it = m_assembly_costs.find(&assembly);
+        if (it != m_assembly_costs.end())
+            return it->second;
+
+        ++m_assembly_count;
+
+        analyze_base_group(assembly);
+
+        InstancedCost cost;
+        cost.m_light_count = assembly.lights().size();
+
+        uint64 static_triangle_count = 0;
+        uint64 moving_triangle_count = 0;
+        uint64 moving_triangle_pose_count = 0;
+
+        for (const ObjectInstance& object_instance : assembly.object_instances())
+        {
+            ++m_object_instance_count;
+            ++cost.m_object_instance_count;
+
+            const Object* object = object_instance.find_object();
+            if (object == nullptr)
+                continue;
+
+            const bool is_new_object = m_visited_objects.insert(object).second;
+
+            const bool is_emitting =
+                has_emitting_materials(object_instance.get_front_materials()) ||
+                has_emitting_materials(object_instance.get_back_materials());
+
+            if (is_emitting)
+                ++cost.m_emitting_object_instance_count;
+
+            if (strcmp(object->get_model(), MeshObjectFactory().get_model()) == 0)
+            {
+                const MeshObject& mesh = static_cast<const MeshObject&>(*object);
+                const StaticTriangleTess& tess = mesh.get_static_triangle_tess();
+                const size_t triangle_count = mesh.get_triangle_count();
+                const size_t motion_segment_count = tess.get_motion_segment_count();
+
+                if (is_new_object)
+                {
+                    ++m_mesh_object_count;
+
+                    // Objects may share their tessellation.
+                    if (m_visited_tessellations.insert(&tess).second)
+                        m_tessellation_memory_size += tess.get_memory_size();
+                }
+
+                // The triangles of each object instance are copied into the triangle tree of the assembly.
+                if (motion_segment_count > 0)
+                {
+                    moving_triangle_count += triangle_count;
+                    moving_triangle_pose_count += triangle_count * (motion_segment_count + 1);
+                }
+                else static_triangle_count += triangle_count;
+
+                cost.m_triangle_count += triangle_count;
+
+                if (is_emitting)
+                    cost.m_emitting_triangle_count += triangle_count;
+            }
+            else if (strcmp(object->get_model(), CurveObjectFactory().get_model()) == 0)
+            {
+                if (is_new_object)
+                {
+                    ++m_curve_object_count;
+                    m_curve_count += static_cast<const CurveObject*>(object)->get_curve_count();
+                }
+            }
+        }
+
+        m_static_triangle_count += static_triangle_count;
+        m_moving_triangle_count += moving_triangle_count;
+
+        if (static_triangle_count + moving_triangle_count > 0)
+        {
+            m_triangle_tree_memory_size +=
+                TriangleTree::estimate_memory_size(
+                    static_cast<size_t>(static_triangle_count),
+                    static_cast<size_t>(moving_triangle_count),
+                    static_cast<size_t>(moving_triangle_pose_count));
+        }
+
+        cost += analyze_assembly_instances(assembly);
+
+        m_assembly_costs[&assembly] = cost;
+
+        return cost;
+    }
+
+    uint64 get_estimated_memory_size() const
+    {
+        return
+              m_tessellation_memory_size
+            + m_triangle_tree_memory_size
+            + min<uint64>(m_texture_memory_size, m_texture_store_size);
+    }
+};
+
+ProjectAnalyzer::ProjectAnalyzer(Project& project)
+  : impl(new Impl(project))
+{
+}
+
+ProjectAnalyzer::~ProjectAnalyzer()
+{
+    delete impl;
+}
+
+uint64 ProjectAnalyzer::get_estimated_memory_size() const
+{
+    return impl->get_estimated_memory_size();
+}
+
+void ProjectAnalyzer::print_report(Logger& logger) const
+{
+    StatisticsVector stats;
+
+    Statistics geometry_stats;
+    geometry_stats.insert("assemblies", impl->m_assembly_count);
+    geometry_stats.insert("object instances", impl->m_object_instance_count);
+    geometry_stats.insert("mesh objects", impl->m_mesh_object_count);
+    geometry_stats.insert("static triangles", impl->m_static_triangle_count);
+    geometry_stats.insert("moving triangles", impl->m_moving_triangle_count);
+    geometry_stats.insert("curve objects", impl->m_curve_object_count);
+    geometry_stats.insert("curves", impl->m_curve_count);
+    stats.insert("geometry statistics", geometry_stats);
+
+    const InstancedCost& instanced = impl->m_instanced_cost;
+    const uint64 triangle_count = impl->m_static_triangle_count + impl->m_moving_triangle_count;
+
+    Statistics instancing_stats;
+    instancing_stats.insert("assembly instances", instanced.m_assembly_instance_count);
+    instancing_stats.insert("object instances", instanced.m_object_instance_count);
+    instancing_stats.insert("triangles", instanced.m_triangle_count);
+    instancing_stats.insert(
+        "triangle fan-out",
+        triangle_count > 0
+            ? static_cast<double>(instanced.m_triangle_count) / triangle_count
+            : 0.0,
+        "x");
+    stats.insert("instancing statistics", instancing_stats);
+
+    Statistics emitter_stats;
+    emitter_stats.insert("environment edfs", impl->m_environment_edf_count);
+    emitter_stats.insert("lights", instanced.m_light_count);
+    emitter_stats.insert("emitting object instances", instanced.m_emitting_object_instance_count);
+    emitter_stats.insert("emitting triangles", instanced.m_emitting_triangle_count);
+    stats.insert("emitter statistics", emitter_stats);
+
+    Statistics texture_stats;
+    texture_stats.insert("textures", impl->m_texture_count);
+    texture_stats.insert("unreadable textures", impl->m_unreadable_texture_count);
+    texture_stats.insert("texels", impl->m_texel_count);
+    texture_stats.insert_size("size", impl->m_texture_memory_size);
+    texture_stats.insert_size("texture store size", impl->m_texture_store_size);
+    texture_stats.insert_percent("fits in texture store",
+        min<uint64>(impl->m_texture_memory_size, impl->m_texture_store_size),
+        impl->m_texture_memory_size);
+    stats.insert("texture statistics", texture_stats);
+
+    Statistics shading_stats;
+    shading_stats.insert("osl shader groups", impl->m_shader_group_count);
+    shading_stats.insert("osl shaders", impl->m_shader_count);
+    stats.insert("shading statistics", shading_stats);
+
+    Statistics memory_stats;
+    memory_stats.insert_size("mesh tessellations", impl->m_tessellation_memory_size);
+    memory_stats.insert_size("triangle trees", impl->m_triangle_tree_memory_size);
+    memory_stats.insert_size(
+        "texture store",
+        min<uint64>(impl->m_texture_memory_size, impl->m_texture_store_size));
+    memory_stats.insert_size("total", impl->get_estimated_memory_size());
+    stats.insert("estimated memory usage", memory_stats);
+
+    LOG_INFO(logger, "%s", stats.to_string().c_str());
+}
+
+}   // namespace renderer
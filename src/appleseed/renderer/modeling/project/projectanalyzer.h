@@ -0,0 +1,75 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/platform/types.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Forward declarations.
+namespace foundation    { class Logger; }
+namespace renderer      { class Project; }
+
+namespace renderer
+{
+
+//
+// Estimate the cost of rendering a project without rendering it: geometry and
+// instancing, emitters, textures and OSL shaders, along with the memory required
+// by the main subsystems of the renderer.
+//
+// Mesh files must have been read for the geometry statistics to be meaningful.
+//
+
+class APPLESEED_DLLSYMBOL ProjectAnalyzer
+  : public foundation::NonCopyable
+{
+  public:
+    // Constructor, binds the inputs of the scene entities and analyzes the project.
+    explicit ProjectAnalyzer(Project& project);
+
+    // Destructor.
+    ~ProjectAnalyzer();
+
+    // Return the estimated memory usage of the scene, in bytes, with the size
+    // of the textures clamped to the texture store budget.
+    foundation::uint64 get_estimated_memory_size() const;
+
+    // Print the cost report.
+    void print_report(foundation::Logger& logger) const;
+
+  private:
+    struct Impl;
+    Impl* impl;
+};
+
+}   // namespace renderer
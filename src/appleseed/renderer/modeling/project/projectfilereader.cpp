@@ -109,12 +109,16 @@
 #include "foundation/math/vector.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/platform/system.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/api/apiarray.h"
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/binaryxml.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/eventtracer.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/iterators.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/log.h"
 #include "foundation/utility/memory.h"
 #include "foundation/utility/otherwise.h"
@@ -125,6 +129,7 @@
 #include "foundation/utility/zip.h"
 
 // Xerces-C++ headers.
+#include "xercesc/framework/MemBufInputSource.hpp"
 #include "xercesc/sax2/Attributes.hpp"
 #include "xercesc/sax2/SAX2XMLReader.hpp"
 #include "xercesc/sax2/XMLReaderFactory.hpp"
@@ -207,6 +212,228 @@ namespace
     };
 
 
+    //
+    // Create the objects defined by an <object> element.
+    // Return false and log an error message if creation failed.
+    //
+
+    bool create_objects(
+        const IObjectFactory&   factory,
+        const string&           name,
+        const ParamArray&       params,
+        const SearchPaths&      search_paths,
+        const bool              omit_loading_assets,
+        vector<Object*>&        objects)
+    {
+        try
+        {
+            ObjectArray object_array;
+            const bool succeeded =
+                factory.create(
+                    name.c_str(),
+                    params,
+                    search_paths,
+                    omit_loading_assets,
+                    object_array);
+
+            objects = array_vector<vector<Object*>>(object_array);
+            return succeeded;
+        }
+        catch (const ExceptionDictionaryKeyNotFound& e)
+        {
+            RENDERER_LOG_ERROR(
+                "while defining object \"%s\": required parameter \"%s\" missing.",
+                name.c_str(),
+                e.string());
+        }
+        catch (const ExceptionUnknownEntity& e)
+        {
+            RENDERER_LOG_ERROR(
+                "while defining object \"%s\": unknown entity \"%s\".",
+                name.c_str(),
+                e.string());
+        }
+        catch (const Exception& e)
+        {
+            RENDERER_LOG_ERROR(
+                "while defining object \"%s\": %s",
+                name.c_str(),
+                e.what());
+        }
+
+        return false;
+    }
+
+
+    //
+    // The objects defined by one <object> element, created on a worker thread.
+    //
+    // Messages logged while creating the objects are kept aside and replayed
+    // when the objects are attached to their assembly, so that they appear in
+    // the order in which objects are declared in the project file.
+    //
+
+    class ObjectLoadRequest
+      : public NonCopyable
+    {
+      public:
+        ObjectLoadRequest(
+            const IObjectFactory&   factory,
+            const string&           name,
+            const ParamArray&       params,
+            const SearchPaths&      search_paths,
+            const bool              omit_loading_assets)
+          : m_factory(factory)
+          , m_name(name)
+          , m_params(params)
+          , m_search_paths(search_paths)
+          , m_omit_loading_assets(omit_loading_assets)
+          , m_succeeded(false)
+          , m_assembly(nullptr)
+        {
+        }
+
+        ~ObjectLoadRequest()
+        {
+            for (Object* object : m_objects)
+                object->release();
+        }
+
+        // Create the objects. Called from a worker thread.
+        void load()
+        {
+            global_logger().set_thread_message_buffer(&m_messages);
+
+            m_succeeded =
+                create_objects(
+                    m_factory,
+                    m_name,
+                    m_params,
+                    m_search_paths,
+                    m_omit_loading_assets,
+                    m_objects);
+
+            global_logger().set_thread_message_buffer(nullptr);
+        }
+
+        // Set the assembly that will receive the objects.
+        void set_assembly(Assembly* assembly)
+        {
+            m_assembly = assembly;
+        }
+
+        // Replay the messages logged during creation and move the objects into their assembly.
+        void attach(EventCounters& event_counters)
+        {
+            global_logger().write_buffered_messages(m_messages);
+
+            if (!m_succeeded)
+                event_counters.signal_error();
+
+            if (m_assembly == nullptr)
+                return;
+
+            ObjectContainer& objects = m_assembly->objects();
+
+            for (Object* object : m_objects)
+            {
+                if (objects.get_by_name(object->get_name()) != nullptr)
+                {
+                    RENDERER_LOG_ERROR(
+                        "an entity with the path \"%s\" already exists.",
+                        object->get_path().c_str());
+                    event_counters.signal_error();
+                    object->release();
+                }
+                else objects.insert(auto_release_ptr<Object>(object));
+            }
+
+            m_objects.clear();
+        }
+
+      private:
+        const IObjectFactory&   m_factory;
+        const string            m_name;
+        const ParamArray        m_params;
+        const SearchPaths       m_search_paths;
+        const bool              m_omit_loading_assets;
+        Logger::MessageBuffer   m_messages;
+        vector<Object*>         m_objects;
+        bool                    m_succeeded;
+        Assembly*               m_assembly;
+    };
+
+
+    //
+    // Create objects concurrently while the project file is being parsed.
+    //
+
+    class ObjectLoader
+      : public NonCopyable
+    {
+      public:
+        explicit ObjectLoader(const size_t thread_count)
+          : m_job_manager(
+                global_logger(),
+                m_job_queue,
+                thread_count,
+                JobManager::KeepRunningOnEmptyQueue)
+        {
+            m_job_manager.start();
+        }
+
+        ~ObjectLoader()
+        {
+            m_job_queue.clear_scheduled_jobs();
+            m_job_manager.stop();
+        }
+
+        // Schedule the creation of a set of objects. Returns immediately.
+        ObjectLoadRequest* load(unique_ptr<ObjectLoadRequest> request)
+        {
+            ObjectLoadRequest* result = request.get();
+            m_requests.push_back(move(request));
+            m_job_queue.schedule(new LoadJob(*result));
+            return result;
+        }
+
+        // Wait until all objects are created, then attach them to their
+        // assemblies in the order in which they were requested.
+        void finish(EventCounters& event_counters)
+        {
+            m_job_queue.wait_until_completion();
+
+            for (const unique_ptr<ObjectLoadRequest>& request : m_requests)
+                request->attach(event_counters);
+
+            m_requests.clear();
+        }
+
+      private:
+        class LoadJob
+          : public IJob
+        {
+          public:
+            explicit LoadJob(ObjectLoadRequest& request)
+              : m_request(request)
+            {
+            }
+
+            void execute(const size_t thread_index) override
+            {
+                m_request.load();
+            }
+
+          private:
+            ObjectLoadRequest& m_request;
+        };
+
+        JobQueue                                m_job_queue;
+        JobManager                              m_job_manager;
+        vector<unique_ptr<ObjectLoadRequest>>   m_requests;
+    };
+
+
     //
     // A set of objects that is passed to all element handlers.
     //
@@ -217,10 +444,12 @@ namespace
         ParseContext(
             Project&        project,
             const int       options,
-            EventCounters&  event_counters)
+            EventCounters&  event_counters,
+            ObjectLoader*   object_loader = nullptr)
           : m_project(project)
           , m_options(options)
           , m_event_counters(event_counters)
+          , m_object_loader(object_loader)
         {
         }
 
@@ -239,10 +468,18 @@ namespace
             return m_event_counters;
         }
 
+        // Return the loader to use for creating objects concurrently, or nullptr
+        // if objects must be created immediately.
+        ObjectLoader* get_object_loader()
+        {
+            return m_object_loader;
+        }
+
       private:
         Project&            m_project;
         const int           m_options;
         EventCounters&      m_event_counters;
+        ObjectLoader*       m_object_loader;
     };
 
 
@@ -1531,6 +1768,7 @@ namespace
 
         explicit ObjectElementHandler(ParseContext& context)
           : m_context(context)
+          , m_load_request(nullptr)
         {
         }
 
@@ -1539,6 +1777,7 @@ namespace
             ParametrizedElementHandler::start_element(attrs);
 
             clear_keep_memory(m_objects);
+            m_load_request = nullptr;
 
             m_name = get_value(attrs, "name");
             m_model = get_value(attrs, "model");
@@ -1548,56 +1787,44 @@ namespace
         {
             ParametrizedElementHandler::end_element();
 
-            try
-            {
-                const IObjectFactory* factory =
-                    m_context.get_project().get_factory_registrar<Object>().lookup(m_model.c_str());
-
-                if (factory)
-                {
-                    ObjectArray objects;
-                    if (!factory->create(
-                            m_name.c_str(),
-                            m_params,
-                            m_context.get_project().search_paths(),
-                            m_context.get_options() & ProjectFileReader::OmitReadingMeshFiles,
-                            objects))
-                        m_context.get_event_counters().signal_error();
+            const IObjectFactory* factory =
+                m_context.get_project().get_factory_registrar<Object>().lookup(m_model.c_str());
 
-                    m_objects = array_vector<ObjectVector>(objects);
-                }
-                else
-                {
-                    RENDERER_LOG_ERROR(
-                        "while defining object \"%s\": invalid model \"%s\".",
-                        m_name.c_str(),
-                        m_model.c_str());
-                    m_context.get_event_counters().signal_error();
-                }
-            }
-            catch (const ExceptionDictionaryKeyNotFound& e)
+            if (factory == nullptr)
             {
                 RENDERER_LOG_ERROR(
-                    "while defining object \"%s\": required parameter \"%s\" missing.",
+                    "while defining object \"%s\": invalid model \"%s\".",
                     m_name.c_str(),
-                    e.string());
+                    m_model.c_str());
                 m_context.get_event_counters().signal_error();
+                return;
             }
-            catch (const ExceptionUnknownEntity& e)
+
+            const bool omit_loading_assets =
+                (m_context.get_options() & ProjectFileReader::OmitReadingMeshFiles) != 0;
+
+            if (ObjectLoader* loader = m_context.get_object_loader())
             {
-                RENDERER_LOG_ERROR(
-                    "while defining object \"%s\": unknown entity \"%s\".",
-                    m_name.c_str(),
-                    e.string());
-                m_context.get_event_counters().signal_error();
+                m_load_request =
+                    loader->load(
+                        unique_ptr<ObjectLoadRequest>(
+                            new ObjectLoadRequest(
+                                *factory,
+                                m_name,
+                                m_params,
+                                m_context.get_project().search_paths(),
+                                omit_loading_assets)));
             }
-            catch (const Exception& e)
+            else
             {
-                RENDERER_LOG_ERROR(
-                    "while defining object \"%s\": %s",
-                    m_name.c_str(),
-                    e.what());
-                m_context.get_event_counters().signal_error();
+                if (!create_objects(
+                        *factory,
+                        m_name,
+                        m_params,
+                        m_context.get_project().search_paths(),
+                        omit_loading_assets,
+                        m_objects))
+                    m_context.get_event_counters().signal_error();
             }
         }
 
@@ -1606,11 +1833,18 @@ namespace
             return m_objects;
         }
 
+        // Return the pending creation of the objects, or nullptr if they were created immediately.
+        ObjectLoadRequest* get_load_request() const
+        {
+            return m_load_request;
+        }
+
       private:
-        ParseContext&   m_context;
-        ObjectVector    m_objects;
-        string          m_name;
-        string          m_model;
+        ParseContext&       m_context;
+        ObjectVector        m_objects;
+        ObjectLoadRequest*  m_load_request;
+        string              m_name;
+        string              m_model;
     };
 
 
@@ -2096,6 +2330,7 @@ namespace
             m_surface_shaders.clear();
             m_textures.clear();
             m_texture_instances.clear();
+            m_object_load_requests.clear();
 
             m_name = get_value(attrs, "name");
             m_model = get_value(attrs, "model", AssemblyFactory().get_model());
@@ -2127,6 +2362,10 @@ namespace
                 m_assembly->surface_shaders().swap(m_surface_shaders);
                 m_assembly->textures().swap(m_textures);
                 m_assembly->texture_instances().swap(m_texture_instances);
+
+                // Objects still being loaded will be attached once parsing is complete.
+                for (ObjectLoadRequest* request : m_object_load_requests)
+                    request->set_assembly(m_assembly.get());
             }
             else
             {
@@ -2193,8 +2432,15 @@ namespace
                 break;
 
               case ElementObject:
-                for (Object* object : static_cast<ObjectElementHandler*>(handler)->get_objects())
-                    insert(m_objects, auto_release_ptr<Object>(object));
+                {
+                    ObjectElementHandler* object_handler = static_cast<ObjectElementHandler*>(handler);
+
+                    for (Object* object : object_handler->get_objects())
+                        insert(m_objects, auto_release_ptr<Object>(object));
+
+                    if (ObjectLoadRequest* request = object_handler->get_load_request())
+                        m_object_load_requests.push_back(request);
+                }
                 break;
 
               case ElementObjectInstance:
@@ -2263,6 +2509,7 @@ namespace
         SurfaceShaderContainer      m_surface_shaders;
         TextureContainer            m_textures;
         TextureInstanceContainer    m_texture_instances;
+        vector<ObjectLoadRequest*>  m_object_load_requests;
     };
 
 
@@ -3142,28 +3389,52 @@ namespace
         return false;
     }
 
-    // Return the name of the single .appleseed file inside a given archive file.
-    // If there are zero or more than one .appleseed file inside the archive, an
-    // empty string is returned (i.e. the archive is not a valid packed project).
-    string get_project_filename_from_archive(const char* project_filepath)
+    // Read the single .appleseed file of a packed project directly from the archive and
+    // extract the other files, which the project refers to by path, to a given directory.
+    // Return false if there are zero or more than one .appleseed file inside the archive
+    // (i.e. the archive is not a valid packed project). Throw ZipException on I/O errors.
+    bool read_packed_project(
+        const char*             packed_project_filepath,
+        const bf::path&         unpacked_project_directory,
+        string&                 project_filepath,
+        vector<char>&           project_file_contents)
     {
-        const vector<string> files =
-            get_filenames_with_extension_from_zip(project_filepath, ".appleseed");
+        ZipArchive archive;
+        archive.open(packed_project_filepath);
 
-        return files.size() == 1 ? files[0] : string();
-    }
+        string project_filename;
+
+        for (const_each<vector<string>> i = archive.get_entry_names(); i; ++i)
+        {
+            if (ends_with(*i, ".appleseed"))
+            {
+                if (!project_filename.empty())
+                    return false;
+
+                project_filename = *i;
+            }
+        }
+
+        if (project_filename.empty())
+            return false;
 
-    string unpack_project(
-        const string& project_filepath,
-        const string& project_name,
-        const bf::path& unpacked_project_directory)
-    {
         if (bf::exists(unpacked_project_directory))
             bf::remove_all(unpacked_project_directory);
 
-        unzip(project_filepath, unpacked_project_directory.string());
+        bf::create_directories(unpacked_project_directory);
 
-        return (unpacked_project_directory / project_name).string().c_str();
+        // Stored entries are copied straight from the memory mapping of the archive.
+        for (const_each<vector<string>> i = archive.get_entry_names(); i; ++i)
+        {
+            if (*i != project_filename)
+                archive.extract_entry(*i, (unpacked_project_directory / *i).string());
+        }
+
+        archive.read_entry(project_filename, project_file_contents);
+
+        project_filepath = (unpacked_project_directory / project_filename).string();
+
+        return true;
     }
 }
 
@@ -3174,6 +3445,8 @@ auto_release_ptr<Project> ProjectFileReader::read(
 {
     assert(project_filepath);
 
+    TraceScope trace_scope("project", "load project");
+
     // Handle built-in projects.
     string project_name;
     if (is_builtin_project(project_filepath, project_name))
@@ -3181,30 +3454,37 @@ auto_release_ptr<Project> ProjectFileReader::read(
 
     // Handle packed projects.
     string actual_project_filepath;
-    if (is_zip_file(project_filepath))
+    vector<char> project_file_contents;
+    const bool packed_project = is_zip_file(project_filepath);
+    if (packed_project)
     {
-        const string project_filename = get_project_filename_from_archive(project_filepath);
-        if (project_filename.empty())
-        {
-            RENDERER_LOG_ERROR(
-                "%s looks like a packed project file, but it should contain a single *.appleseed file in order to be valid.",
-                project_filepath);
-            return auto_release_ptr<Project>(nullptr);
-        }
-
-        const string unpacked_project_directory =
-            bf::path(project_filepath).replace_extension(".unpacked").string();
+        const bf::path unpacked_project_directory =
+            bf::path(project_filepath).replace_extension(".unpacked");
 
         RENDERER_LOG_INFO(
-            "%s appears to be a packed project; unpacking to %s...",
+            "%s appears to be a packed project; reading it in place and extracting the files it references to %s...",
             project_filepath,
-            unpacked_project_directory.c_str());
+            unpacked_project_directory.string().c_str());
 
-        actual_project_filepath =
-            unpack_project(
-                project_filepath,
-                project_filename,
-                unpacked_project_directory);
+        try
+        {
+            if (!read_packed_project(
+                    project_filepath,
+                    unpacked_project_directory,
+                    actual_project_filepath,
+                    project_file_contents))
+            {
+                RENDERER_LOG_ERROR(
+                    "%s looks like a packed project file, but it should contain a single *.appleseed file in order to be valid.",
+                    project_filepath);
+                return auto_release_ptr<Project>(nullptr);
+            }
+        }
+        catch (const ZipException& e)
+        {
+            RENDERER_LOG_ERROR("failed to read packed project file %s: %s", project_filepath, e.what());
+            return auto_release_ptr<Project>(nullptr);
+        }
 
         project_filepath = actual_project_filepath.data();
     }
@@ -3229,7 +3509,9 @@ auto_release_ptr<Project> ProjectFileReader::read(
             project_filepath,
             schema_filepath,
             options,
-            event_counters));
+            event_counters,
+            nullptr,
+            packed_project ? &project_file_contents : nullptr));
 
     if (project.get())
         postprocess_project(project.ref(), event_counters, options);
@@ -3255,26 +3537,30 @@ auto_release_ptr<Assembly> ProjectFileReader::read_archive(
 
     // Handle packed archives.
     string actual_archive_filepath;
-    if (is_zip_file(archive_filepath))
+    vector<char> archive_file_contents;
+    const bool packed_archive = is_zip_file(archive_filepath);
+    if (packed_archive)
     {
-        const string archive_name = get_project_filename_from_archive(archive_filepath);
-        if (archive_name.empty())
+        try
         {
-            RENDERER_LOG_ERROR(
-                "%s looks like a packed archive file, but it should contain a single *.appleseed file in order to be valid.",
-                archive_filepath);
+            if (!read_packed_project(
+                    archive_filepath,
+                    bf::path(archive_filepath).replace_extension(".unpacked"),
+                    actual_archive_filepath,
+                    archive_file_contents))
+            {
+                RENDERER_LOG_ERROR(
+                    "%s looks like a packed archive file, but it should contain a single *.appleseed file in order to be valid.",
+                    archive_filepath);
+                return auto_release_ptr<Assembly>(nullptr);
+            }
+        }
+        catch (const ZipException& e)
+        {
+            RENDERER_LOG_ERROR("failed to read packed archive file %s: %s", archive_filepath, e.what());
             return auto_release_ptr<Assembly>(nullptr);
         }
 
-        const string unpacked_archive_directory =
-            bf::path(archive_filepath).replace_extension(".unpacked").string();
-
-        actual_archive_filepath =
-            unpack_project(
-                archive_filepath,
-                archive_name,
-                unpacked_archive_directory);
-
         archive_filepath = actual_archive_filepath.data();
     }
 
@@ -3299,7 +3585,8 @@ auto_release_ptr<Assembly> ProjectFileReader::read_archive(
             schema_filepath,
             options | OmitSearchPaths,
             event_counters,
-            &search_paths));
+            &search_paths,
+            packed_archive ? &archive_file_contents : nullptr));
 
     if (project.get())
     {
@@ -3363,7 +3650,8 @@ auto_release_ptr<Project> ProjectFileReader::load_project_file(
     const char*                     schema_filepath,
     const int                       options,
     EventCounters&                  event_counters,
-    const foundation::SearchPaths*  search_paths) const
+    const foundation::SearchPaths*  search_paths,
+    const vector<char>*             project_file_contents) const
 {
     // Create an empty project.
     auto_release_ptr<Project> project(ProjectFactory::create(project_filepath));
@@ -3386,52 +3674,94 @@ auto_release_ptr<Project> ProjectFileReader::load_project_file(
             project_filepath,
             event_counters));
 
+    // Create the object loader.
+    unique_ptr<ObjectLoader> object_loader;
+    if (!(options & OmitParallelObjectLoading))
+        object_loader.reset(new ObjectLoader(System::get_logical_cpu_core_count()));
+
     // Create the content handler.
-    ParseContext context(project.ref(), options, event_counters);
+    ParseContext context(project.ref(), options, event_counters, object_loader.get());
     unique_ptr<ContentHandler> content_handler(
         new ContentHandler(
             project.get(),
             context));
 
-    // Create the parser.
-    unique_ptr<SAX2XMLReader> parser(XMLReaderFactory::createXMLReader());
-    parser->setFeature(XMLUni::fgSAX2CoreNameSpaces, true);         // perform namespace processing
+    const bool binary_project_file =
+        project_file_contents
+            ? BinaryXMLReader::is_binary_xml_data(project_file_contents->data(), project_file_contents->size())
+            : BinaryXMLReader::is_binary_xml_file(project_filepath);
 
-    if (!(options & OmitProjectSchemaValidation))
+    if (binary_project_file)
     {
-        assert(schema_filepath);
-        parser->setFeature(XMLUni::fgSAX2CoreValidation, true);     // report all validation errors
-        parser->setFeature(XMLUni::fgXercesSchema, true);           // enable the parser's schema support
-        parser->setProperty(
-            XMLUni::fgXercesSchemaExternalNoNameSpaceSchemaLocation,
-            const_cast<void*>(
-                static_cast<const void*>(
-                    transcode(schema_filepath).c_str())));
+        // Binary project files are replayed directly into the content handler.
+        // They are not validated: they were produced from valid project files.
+        RENDERER_LOG_INFO("loading binary project file %s...", project_filepath);
+        const bool success =
+            project_file_contents
+                ? BinaryXMLReader().parse(project_file_contents->data(), project_file_contents->size(), *content_handler)
+                : BinaryXMLReader().parse(project_filepath, *content_handler);
+        if (!success)
+        {
+            RENDERER_LOG_ERROR("failed to load binary project file %s: invalid or corrupted file.", project_filepath);
+            event_counters.signal_error();
+            return auto_release_ptr<Project>(nullptr);
+        }
     }
     else
     {
-        parser->setFeature(XMLUni::fgSAX2CoreValidation, false); // ignore all validation errors
-        parser->setFeature(XMLUni::fgXercesSchema, false);       // disable the parser's schema support
-    }
+        // Create the parser.
+        unique_ptr<SAX2XMLReader> parser(XMLReaderFactory::createXMLReader());
+        parser->setFeature(XMLUni::fgSAX2CoreNameSpaces, true);         // perform namespace processing
 
-    parser->setErrorHandler(error_handler.get());
-    parser->setContentHandler(content_handler.get());
+        if (!(options & OmitProjectSchemaValidation))
+        {
+            assert(schema_filepath);
+            parser->setFeature(XMLUni::fgSAX2CoreValidation, true);     // report all validation errors
+            parser->setFeature(XMLUni::fgXercesSchema, true);           // enable the parser's schema support
+            parser->setProperty(
+                XMLUni::fgXercesSchemaExternalNoNameSpaceSchemaLocation,
+                const_cast<void*>(
+                    static_cast<const void*>(
+                        transcode(schema_filepath).c_str())));
+        }
+        else
+        {
+            parser->setFeature(XMLUni::fgSAX2CoreValidation, false); // ignore all validation errors
+            parser->setFeature(XMLUni::fgXercesSchema, false);       // disable the parser's schema support
+        }
 
-    // Load the project file.
-    RENDERER_LOG_INFO("loading project file %s...", project_filepath);
-    try
-    {
-        parser->parse(project_filepath);
-    }
-    catch (const XMLException&)
-    {
-        return auto_release_ptr<Project>(nullptr);
-    }
-    catch (const SAXParseException&)
-    {
-        return auto_release_ptr<Project>(nullptr);
+        parser->setErrorHandler(error_handler.get());
+        parser->setContentHandler(content_handler.get());
+
+        // Load the project file.
+        RENDERER_LOG_INFO("loading project file %s...", project_filepath);
+        try
+        {
+            if (project_file_contents)
+            {
+                const MemBufInputSource input_source(
+                    reinterpret_cast<const XMLByte*>(project_file_contents->data()),
+                    project_file_contents->size(),
+                    project_filepath);
+                parser->parse(input_source);
+            }
+            else
+                parser->parse(project_filepath);
+        }
+        catch (const XMLException&)
+        {
+            return auto_release_ptr<Project>(nullptr);
+        }
+        catch (const SAXParseException&)
+        {
+            return auto_release_ptr<Project>(nullptr);
+        }
     }
 
+    // Wait for objects still being loaded and attach them to their assemblies.
+    if (object_loader)
+        object_loader->finish(event_counters);
+
     // Report a failure in case of warnings or errors.
     if (error_handler->get_warning_count() > 0 ||
         error_handler->get_error_count() > 0 ||
@@ -36,6 +36,9 @@
 // appleseed.main headers.
 #include "main/dllsymbol.h"
 
+// Standard headers.
+#include <vector>
+
 // Forward declarations.
 namespace renderer  { class Assembly; }
 namespace renderer  { class EventCounters; }
@@ -57,7 +60,8 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
         OmitReadingMeshFiles        = 1UL << 0,     // do not read mesh files from disk
         OmitProjectFileUpdate       = 1UL << 1,     // do not update the project file format to the latest revision
         OmitSearchPaths             = 1UL << 2,     // do not read search paths from the project
-        OmitProjectSchemaValidation = 1UL << 3      // do not validate project against schema
+        OmitProjectSchemaValidation = 1UL << 3,     // do not validate project against schema
+        OmitParallelObjectLoading   = 1UL << 4      // read geometry files one after the other on the parsing thread
     };
 
     // Read a project from disk (or load a built-in project).
@@ -86,7 +90,8 @@ class APPLESEED_DLLSYMBOL ProjectFileReader
         const char*                     schema_filepath,
         const int                       options,
         EventCounters&                  event_counters,
-        const foundation::SearchPaths*  search_paths = nullptr) const;
+        const foundation::SearchPaths*  search_paths = nullptr,
+        const std::vector<char>*        project_file_contents = nullptr) const;
 
     foundation::auto_release_ptr<Project> construct_builtin_project(
         const char*                     project_name,
@@ -31,6 +31,7 @@
 #include "projectfilewriter.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/modeling/aov/aov.h"
 #include "renderer/modeling/bsdf/bsdf.h"
 #include "renderer/modeling/bssrdf/bssrdf.h"
@@ -72,14 +73,17 @@
 
 // appleseed.foundation headers.
 #include "foundation/core/appleseed.h"
+#include "foundation/curve/binarycurvefilewriter.h"
 #include "foundation/math/transform.h"
 #include "foundation/platform/defaulttimers.h"
+#include "foundation/utility/binaryxml.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/indenter.h"
 #include "foundation/utility/searchpaths.h"
 #include "foundation/utility/stopwatch.h"
 #include "foundation/utility/string.h"
+#include "foundation/utility/xercesc.h"
 #include "foundation/utility/xmlelement.h"
 #include "foundation/utility/zip.h"
 
@@ -715,7 +719,12 @@ namespace
                 {
                     // Write the curve file to disk.
                     const string filepath = (m_project_new_root_dir / filename).string();
-                    CurveObjectWriter::write(object, filepath.c_str());
+                    CurveObjectWriter::write(
+                        object,
+                        filepath.c_str(),
+                        (m_options & ProjectFileWriter::MemoryMappableCurveFiles)
+                            ? BinaryCurveFileWriter::MemoryMappable
+                            : BinaryCurveFileWriter::Default);
                 }
 
                 // Add a file path parameter to the object.
@@ -926,10 +935,13 @@ bool ProjectFileWriter::write(
     const int       options,
     const char*     extra_comments)
 {
-    return
-        lower_case(bf::path(filepath).extension().string()) == ".appleseedz"
-            ? write_packed_project_file(project, filepath, options, extra_comments)
-            : write_plain_project_file(project, filepath, options, extra_comments);
+    const string extension = lower_case(bf::path(filepath).extension().string());
+
+    if (extension == ".appleseedz")
+        return write_packed_project_file(project, filepath, options, extra_comments);
+    else if (extension == ".appleseedb")
+        return write_binary_project_file(project, filepath, options, extra_comments);
+    else return write_plain_project_file(project, filepath, options, extra_comments);
 }
 
 bool ProjectFileWriter::write_plain_project_file(
@@ -1071,4 +1083,46 @@ bool ProjectFileWriter::write_packed_project_file(
     return success;
 }
 
+bool ProjectFileWriter::write_binary_project_file(
+    Project&        project,
+    const char*     filepath,
+    const int       options,
+    const char*     extra_comments)
+{
+    const bf::path project_path(filepath);
+
+    // The temporary plain project file must live next to the binary one for asset paths to be correct.
+    const bf::path temp_project_filepath =
+        project_path.parent_path() /
+        project_path.filename().replace_extension(".temp.appleseed");
+
+    bool success =
+        write_plain_project_file(
+            project,
+            temp_project_filepath.string().c_str(),
+            options,
+            extra_comments);
+
+    if (success)
+    {
+        XercesCContext xerces_context(global_logger());
+
+        success =
+            xerces_context.is_initialized() &&
+            convert_xml_file_to_binary_xml_file(
+                global_logger(),
+                temp_project_filepath.string().c_str(),
+                filepath);
+
+        if (success)
+            RENDERER_LOG_INFO("converted project file to binary project file %s.", filepath);
+        else RENDERER_LOG_ERROR("failed to write binary project file %s.", filepath);
+    }
+
+    if (bf::exists(temp_project_filepath))
+        bf::remove(temp_project_filepath);
+
+    return success;
+}
+
 }   // namespace renderer
@@ -51,11 +51,13 @@ class APPLESEED_DLLSYMBOL ProjectFileWriter
         OmitHeaderComment           = 1UL << 0,     // do not write the header comment
         OmitWritingGeometryFiles    = 1UL << 1,     // do not write geometry files to disk
         OmitHandlingAssetFiles      = 1UL << 2,     // do not change paths to asset files (such as texture files)
-        CopyAllAssets               = 1UL << 3      // copy all asset files (by default copy asset files with relative paths only)
+        CopyAllAssets               = 1UL << 3,     // copy all asset files (by default copy asset files with relative paths only)
+        MemoryMappableCurveFiles    = 1UL << 4      // write curve files in the uncompressed, memory-mappable binarycurve format
     };
 
-    // Write a project to disk.
-    // Returns true on success, false otherwise.
+    // Write a project to disk. Projects are written as packed files if the extension of
+    // the file path is .appleseedz, as binary files if it is .appleseedb, and as plain
+    // XML files otherwise. Returns true on success, false otherwise.
     static bool write(
         Project&        project,
         const char*     filepath,
@@ -78,6 +80,14 @@ class APPLESEED_DLLSYMBOL ProjectFileWriter
         const char*     filepath,
         const int       options,
         const char*     extra_comments);
+
+    // Write a project file to disk as a binary project file.
+    // Returns true on success, false otherwise.
+    static bool write_binary_project_file(
+        Project&        project,
+        const char*     filepath,
+        const int       options,
+        const char*     extra_comments);
 };
 
 }   // namespace renderer
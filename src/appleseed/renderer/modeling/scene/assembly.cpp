@@ -41,6 +41,7 @@
 #include "renderer/modeling/object/proceduralobject.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/pointinstancer.h"
 #include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 #include "renderer/modeling/surfaceshader/surfaceshader.h"
@@ -200,6 +201,11 @@ GAABB3 Assembly::compute_local_bbox() const
             assembly_instances().begin(),
             assembly_instances().end()));
 
+    bbox.insert(
+        compute_parent_bbox<GAABB3>(
+            point_instancers().begin(),
+            point_instancers().end()));
+
     return bbox;
 }
 
@@ -279,16 +285,17 @@ bool Assembly::on_frame_begin(
     if (!BaseGroup::on_frame_begin(project, parent, recorder, abort_switch))
         return false;
 
+    // Materials are kept sequential since some of them compile expressions or shaders.
     bool success = true;
-    success = success && invoke_on_frame_begin(bsdfs(), project, this, recorder, abort_switch);
+    success = success && invoke_on_frame_begin_parallel(bsdfs(), project, this, recorder, abort_switch);
     success = success && invoke_on_frame_begin(bssrdfs(), project, this, recorder, abort_switch);
     success = success && invoke_on_frame_begin(edfs(), project, this, recorder, abort_switch);
     success = success && invoke_on_frame_begin(surface_shaders(), project, this, recorder, abort_switch);
     success = success && invoke_on_frame_begin(materials(), project, this, recorder, abort_switch);
-    success = success && invoke_on_frame_begin(lights(), project, this, recorder, abort_switch);
-    success = success && invoke_on_frame_begin(objects(), project, this, recorder, abort_switch);
-    success = success && invoke_on_frame_begin(object_instances(), project, this, recorder, abort_switch);
-    success = success && invoke_on_frame_begin(volumes(), project, this, recorder, abort_switch);
+    success = success && invoke_on_frame_begin_parallel(lights(), project, this, recorder, abort_switch);
+    success = success && invoke_on_frame_begin_parallel(objects(), project, this, recorder, abort_switch);
+    success = success && invoke_on_frame_begin_parallel(object_instances(), project, this, recorder, abort_switch);
+    success = success && invoke_on_frame_begin_parallel(volumes(), project, this, recorder, abort_switch);
     if (!success)
         return false;
 
@@ -35,6 +35,7 @@
 #include "renderer/modeling/color/colorentity.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/pointinstancer.h"
 #include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/shadergroup/shadergroup.h"
 #include "renderer/modeling/texture/texture.h"
@@ -55,6 +56,7 @@ struct BaseGroup::Impl
     ShaderGroupContainer        m_shader_groups;
     AssemblyContainer           m_assemblies;
     AssemblyInstanceContainer   m_assembly_instances;
+    PointInstancerContainer     m_point_instancers;
 
     explicit Impl(Entity* parent)
       : m_colors(parent)
@@ -63,6 +65,7 @@ struct BaseGroup::Impl
       , m_shader_groups(parent)
       , m_assemblies(parent)
       , m_assembly_instances(parent)
+      , m_point_instancers(parent)
     {
     }
 };
@@ -105,12 +108,14 @@ void BaseGroup::clear()
     impl->m_shader_groups.clear();
     impl->m_assemblies.clear();
     impl->m_assembly_instances.clear();
+    impl->m_point_instancers.clear();
 }
 
 bool BaseGroup::create_optimized_osl_shader_groups(
     OSLShadingSystem&           shading_system,
     const ShaderCompiler*       shader_compiler,
-    IAbortSwitch*               abort_switch)
+    IAbortSwitch*               abort_switch,
+    const bool                  defer_optimization)
 {
     for (Assembly& assembly : assemblies())
     {
@@ -120,7 +125,8 @@ bool BaseGroup::create_optimized_osl_shader_groups(
         if (!assembly.create_optimized_osl_shader_groups(
                 shading_system,
                 shader_compiler,
-                abort_switch))
+                abort_switch,
+                defer_optimization))
             return false;
     }
 
@@ -132,7 +138,8 @@ bool BaseGroup::create_optimized_osl_shader_groups(
         if (!shader_group.create_optimized_osl_shader_group(
                 shading_system,
                 shader_compiler,
-                abort_switch))
+                abort_switch,
+                defer_optimization))
             return false;
     }
 
@@ -158,6 +165,11 @@ AssemblyInstanceContainer& BaseGroup::assembly_instances() const
     return impl->m_assembly_instances;
 }
 
+PointInstancerContainer& BaseGroup::point_instancers() const
+{
+    return impl->m_point_instancers;
+}
+
 void BaseGroup::collect_asset_paths(StringArray& paths) const
 {
     invoke_collect_asset_paths(colors(), paths);
@@ -166,6 +178,7 @@ void BaseGroup::collect_asset_paths(StringArray& paths) const
     invoke_collect_asset_paths(shader_groups(), paths);
     invoke_collect_asset_paths(assemblies(), paths);
     invoke_collect_asset_paths(assembly_instances(), paths);
+    invoke_collect_asset_paths(point_instancers(), paths);
 }
 
 void BaseGroup::update_asset_paths(const StringDictionary& mappings)
@@ -176,6 +189,7 @@ void BaseGroup::update_asset_paths(const StringDictionary& mappings)
     invoke_update_asset_paths(shader_groups(), mappings);
     invoke_update_asset_paths(assemblies(), mappings);
     invoke_update_asset_paths(assembly_instances(), mappings);
+    invoke_update_asset_paths(point_instancers(), mappings);
 }
 
 bool BaseGroup::on_render_begin(
@@ -191,6 +205,7 @@ bool BaseGroup::on_render_begin(
     success = success && invoke_on_render_begin(shader_groups(), project, this, recorder, abort_switch);
     success = success && invoke_on_render_begin(assemblies(), project, this, recorder, abort_switch);
     success = success && invoke_on_render_begin(assembly_instances(), project, this, recorder, abort_switch);
+    success = success && invoke_on_render_begin(point_instancers(), project, this, recorder, abort_switch);
     return success;
 }
 
@@ -200,13 +215,16 @@ bool BaseGroup::on_frame_begin(
     OnFrameBeginRecorder&       recorder,
     IAbortSwitch*               abort_switch)
 {
+    // Entities within the collections processed with invoke_on_frame_begin_parallel() are independent
+    // from each other; collections themselves are processed in order of dependency.
     bool success = true;
     success = success && invoke_on_frame_begin(colors(), project, this, recorder, abort_switch);
-    success = success && invoke_on_frame_begin(textures(), project, this, recorder, abort_switch);
+    success = success && invoke_on_frame_begin_parallel(textures(), project, this, recorder, abort_switch);
     success = success && invoke_on_frame_begin(texture_instances(), project, this, recorder, abort_switch);
     success = success && invoke_on_frame_begin(shader_groups(), project, this, recorder, abort_switch);
     success = success && invoke_on_frame_begin(assemblies(), project, this, recorder, abort_switch);
     success = success && invoke_on_frame_begin(assembly_instances(), project, this, recorder, abort_switch);
+    success = success && invoke_on_frame_begin(point_instancers(), project, this, recorder, abort_switch);
     return success;
 }
 
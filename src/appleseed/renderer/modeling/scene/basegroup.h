@@ -71,11 +71,12 @@ class APPLESEED_DLLSYMBOL BaseGroup
     // Clear the base group contents.
     void clear();
 
-    // Create OSL shader groups and optimize them.
+    // Create OSL shader groups and optimize them, unless optimization is deferred.
     bool create_optimized_osl_shader_groups(
         OSLShadingSystem&           shading_system,
         const ShaderCompiler*       shader_compiler,
-        foundation::IAbortSwitch*   abort_switch = nullptr);
+        foundation::IAbortSwitch*   abort_switch = nullptr,
+        const bool                  defer_optimization = false);
 
     // Release internal OSL shader groups.
     void release_optimized_osl_shader_groups();
@@ -86,6 +87,9 @@ class APPLESEED_DLLSYMBOL BaseGroup
     // Access the assembly instances.
     AssemblyInstanceContainer& assembly_instances() const;
 
+    // Access the point instancers.
+    PointInstancerContainer& point_instancers() const;
+
     // Expose asset file paths referenced by this entity to the outside.
     void collect_asset_paths(foundation::StringArray& paths) const;
     void update_asset_paths(const foundation::StringDictionary& mappings);
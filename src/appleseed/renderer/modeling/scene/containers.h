@@ -58,6 +58,7 @@ namespace renderer  { class Light; }
 namespace renderer  { class Material; }
 namespace renderer  { class Object; }
 namespace renderer  { class ObjectInstance; }
+namespace renderer  { class PointInstancer; }
 namespace renderer  { class Shader; }
 namespace renderer  { class ShaderConnection; }
 namespace renderer  { class ShaderGroup; }
@@ -87,6 +88,7 @@ typedef TypedEntityVector<Light>                LightContainer;
 typedef TypedEntityVector<Material>             MaterialContainer;
 typedef TypedEntityVector<Object>               ObjectContainer;
 typedef TypedEntityVector<ObjectInstance>       ObjectInstanceContainer;
+typedef TypedEntityVector<PointInstancer>       PointInstancerContainer;
 typedef TypedEntityVector<Shader>               ShaderContainer;
 typedef TypedEntityVector<ShaderConnection>     ShaderConnectionContainer;
 typedef TypedEntityVector<ShaderGroup>          ShaderGroupContainer;
@@ -0,0 +1,167 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "lodselector.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/camera/camera.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/containers.h"
+#include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/scene.h"
+#include "renderer/utility/transformsequence.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/aabb.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+#include "foundation/utility/foreach.h"
+#include "foundation/utility/uid.h"
+
+// Standard headers.
+#include <algorithm>
+#include <map>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+namespace
+{
+    struct LODSelection
+    {
+        Assembly*               m_assembly;
+        ObjectInstance*         m_object_instance;
+        size_t                  m_lod;
+    };
+
+    typedef map<UniqueID, LODSelection> LODSelectionMap;
+
+    size_t compute_lod(
+        const ObjectInstance&   object_instance,
+        const Transformd&       assembly_transform,
+        const Vector3d&         camera_position)
+    {
+        const GAABB3 parent_bbox = object_instance.compute_parent_bbox();
+        if (!parent_bbox.is_valid())
+            return 0;
+
+        const AABB3d bbox = assembly_transform.to_parent(AABB3d(parent_bbox));
+        const double distance = norm(bbox.center() - camera_position);
+        if (distance == 0.0)
+            return 0;
+
+        const double screen_size = norm(bbox.extent()) / distance;
+
+        size_t lod = 0;
+        while (lod < object_instance.get_lod_count() &&
+               screen_size < object_instance.get_lod_screen_size(lod + 1))
+            ++lod;
+
+        return lod;
+    }
+
+    void collect_lod_selections(
+        const AssemblyInstanceContainer&    assembly_instances,
+        const Transformd&                   parent_transform,
+        const Vector3d&                     camera_position,
+        LODSelectionMap&                    selections)
+    {
+        for (const_each<AssemblyInstanceContainer> i = assembly_instances; i; ++i)
+        {
+            const AssemblyInstance& assembly_instance = *i;
+            Assembly& assembly = assembly_instance.get_assembly();
+
+            const Transformd transform =
+                assembly_instance.transform_sequence().get_earliest_transform() * parent_transform;
+
+            // Recurse into child assembly instances.
+            collect_lod_selections(
+                assembly.assembly_instances(),
+                transform,
+                camera_position,
+                selections);
+
+            for (each<ObjectInstanceContainer> j = assembly.object_instances(); j; ++j)
+            {
+                ObjectInstance& object_instance = *j;
+
+                if (object_instance.get_lod_count() == 0)
+                    continue;
+
+                const size_t lod = compute_lod(object_instance, transform, camera_position);
+
+                // Keep the finest level of detail required by any instance of the assembly.
+                const LODSelectionMap::iterator it = selections.find(object_instance.get_uid());
+                if (it == selections.end())
+                {
+                    const LODSelection selection = { &assembly, &object_instance, lod };
+                    selections.insert(make_pair(object_instance.get_uid(), selection));
+                }
+                else it->second.m_lod = min(it->second.m_lod, lod);
+            }
+        }
+    }
+}
+
+size_t select_object_instance_lods(
+    Scene&          scene,
+    const Camera&   camera)
+{
+    const Vector3d camera_position =
+        camera.transform_sequence().get_earliest_transform().point_to_parent(Vector3d(0.0));
+
+    LODSelectionMap selections;
+    collect_lod_selections(
+        scene.assembly_instances(),
+        Transformd::identity(),
+        camera_position,
+        selections);
+
+    size_t changed_count = 0;
+
+    for (const_each<LODSelectionMap> i = selections; i; ++i)
+    {
+        const LODSelection& selection = i->second;
+
+        if (selection.m_object_instance->select_lod(selection.m_lod))
+        {
+            selection.m_assembly->bump_version_id();
+            ++changed_count;
+        }
+    }
+
+    return changed_count;
+}
+
+}   // namespace renderer
@@ -33,6 +33,8 @@
 // appleseed.renderer headers.
 #include "renderer/global/globallogger.h"
 #include "renderer/modeling/material/material.h"
+#include "renderer/modeling/object/meshobject.h"
+#include "renderer/modeling/object/meshobjectoperations.h"
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/visibilityflags.h"
@@ -41,9 +43,12 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
+#include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/makevector.h"
+#include "foundation/utility/string.h"
 
 // OpenImageIO headers.
 #include "foundation/platform/_beginoiioheaders.h"
@@ -51,7 +56,10 @@
 #include "foundation/platform/_endoiioheaders.h"
 
 // Standard headers.
+#include <cassert>
+#include <cstring>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -138,6 +146,19 @@ struct ObjectInstance::Impl
     StringDictionary        m_front_material_mappings;
     StringDictionary        m_back_material_mappings;
     OIIO::ustring           m_sss_set_identifier;
+
+    // Level of detail variants of the object.
+    vector<string>          m_lod_object_names;
+    vector<double>          m_lod_screen_sizes;
+    vector<Object*>         m_lod_objects;          // base object followed by the variants
+    size_t                  m_lod;
+
+    // Proxy geometry.
+    string                  m_proxy_object_name;
+    double                  m_proxy_decimation;
+    Object*                 m_proxy_object;
+    auto_release_ptr<MeshObject> m_generated_proxy;
+    const Object*           m_generated_proxy_source;
 };
 
 ObjectInstance::ObjectInstance(
@@ -189,8 +210,62 @@ ObjectInstance::ObjectInstance(
     // Retrieve flip normals flag.
     m_flip_normals = params.get_optional<bool>("flip_normals");
 
+    // Retrieve level of detail variants.
+    impl->m_lod = 0;
+    if (params.dictionaries().exist("lod"))
+    {
+        const ParamArray& lod_params = params.child("lod");
+
+        vector<string> object_names, screen_sizes;
+        tokenize(lod_params.get_optional<string>("objects", ""), Blanks, object_names);
+        tokenize(lod_params.get_optional<string>("screen_sizes", ""), Blanks, screen_sizes);
+
+        if (object_names.size() == screen_sizes.size())
+        {
+            try
+            {
+                for (size_t i = 0, e = screen_sizes.size(); i < e; ++i)
+                    impl->m_lod_screen_sizes.push_back(from_string<double>(screen_sizes[i]));
+                impl->m_lod_object_names = object_names;
+            }
+            catch (const ExceptionStringConversionError&)
+            {
+                impl->m_lod_screen_sizes.clear();
+                RENDERER_LOG_ERROR("%s: invalid level of detail screen sizes.", context.get());
+            }
+        }
+        else
+        {
+            RENDERER_LOG_ERROR(
+                "%s: the number of level of detail objects and screen sizes do not match.",
+                context.get());
+        }
+    }
+
+    // Retrieve proxy geometry settings.
+    impl->m_proxy_decimation = 0.0;
+    if (params.dictionaries().exist("proxy"))
+    {
+        const ParamArray& proxy_params = params.child("proxy");
+
+        impl->m_proxy_object_name = proxy_params.get_optional<string>("object", "");
+
+        if (impl->m_proxy_object_name.empty())
+        {
+            impl->m_proxy_decimation = proxy_params.get_optional<double>("decimation", 0.0, context);
+
+            if (impl->m_proxy_decimation < 0.0 || impl->m_proxy_decimation >= 1.0)
+            {
+                RENDERER_LOG_ERROR("%s: proxy decimation must be in [0, 1), ignoring it.", context.get());
+                impl->m_proxy_decimation = 0.0;
+            }
+        }
+    }
+
     // No bound object yet.
     m_object = nullptr;
+    impl->m_proxy_object = nullptr;
+    impl->m_generated_proxy_source = nullptr;
 }
 
 ObjectInstance::~ObjectInstance()
@@ -216,6 +291,11 @@ const char* ObjectInstance::get_object_name() const
     return impl->m_object_name.c_str();
 }
 
+bool ObjectInstance::has_sss_set_identifier() const
+{
+    return !impl->m_sss_set_identifier.empty();
+}
+
 bool ObjectInstance::is_in_same_sss_set(const ObjectInstance& other) const
 {
     // If it is the same object instance, the SSS set is also the same.
@@ -347,21 +427,117 @@ const char* ObjectInstance::get_material_name(const size_t pa_index, const Side
     }
 }
 
+size_t ObjectInstance::get_lod_count() const
+{
+    return impl->m_lod_object_names.size();
+}
+
+double ObjectInstance::get_lod_screen_size(const size_t lod) const
+{
+    assert(lod > 0 && lod <= impl->m_lod_screen_sizes.size());
+    return impl->m_lod_screen_sizes[lod - 1];
+}
+
+size_t ObjectInstance::get_lod() const
+{
+    return impl->m_lod;
+}
+
+bool ObjectInstance::select_lod(const size_t lod)
+{
+    assert(lod <= impl->m_lod_object_names.size());
+
+    if (lod == impl->m_lod)
+        return false;
+
+    impl->m_lod = lod;
+
+    if (impl->m_lod < impl->m_lod_objects.size() && impl->m_lod_objects[impl->m_lod])
+        m_object = impl->m_lod_objects[impl->m_lod];
+
+    return true;
+}
+
+Object* ObjectInstance::get_proxy_object() const
+{
+    return impl->m_proxy_object;
+}
+
 void ObjectInstance::unbind_object()
 {
     m_object = nullptr;
+    impl->m_lod_objects.clear();
+    impl->m_proxy_object = nullptr;
 }
 
 void ObjectInstance::bind_object(const ObjectContainer& objects)
 {
-    if (m_object == nullptr)
-        m_object = objects.get_by_name(impl->m_object_name.c_str());
+    // Objects are bound from the innermost assembly outward: keep the first match.
+    impl->m_lod_objects.resize(1 + impl->m_lod_object_names.size(), nullptr);
+
+    if (impl->m_lod_objects[0] == nullptr)
+        impl->m_lod_objects[0] = objects.get_by_name(impl->m_object_name.c_str());
+
+    for (size_t i = 0, e = impl->m_lod_object_names.size(); i < e; ++i)
+    {
+        if (impl->m_lod_objects[i + 1] == nullptr)
+            impl->m_lod_objects[i + 1] = objects.get_by_name(impl->m_lod_object_names[i].c_str());
+    }
+
+    // Keep using the level of detail selected previously.
+    m_object = impl->m_lod_objects[impl->m_lod];
+
+    // Bind the proxy. Only meshes are intersected against proxies.
+    const Object* base_object = impl->m_lod_objects[0];
+    if (impl->m_proxy_object == nullptr &&
+        base_object != nullptr &&
+        strcmp(base_object->get_model(), MeshObjectFactory().get_model()) == 0)
+    {
+        if (!impl->m_proxy_object_name.empty())
+        {
+            Object* proxy_object = objects.get_by_name(impl->m_proxy_object_name.c_str());
+            if (proxy_object != nullptr && strcmp(proxy_object->get_model(), MeshObjectFactory().get_model()) == 0)
+                impl->m_proxy_object = proxy_object;
+        }
+        else if (impl->m_proxy_decimation > 0.0)
+        {
+            // Decimate the object only once, unless it was replaced since.
+            if (impl->m_generated_proxy.get() == nullptr || impl->m_generated_proxy_source != base_object)
+            {
+                impl->m_generated_proxy =
+                    create_decimated_mesh(
+                        (string(base_object->get_name()) + "_proxy").c_str(),
+                        static_cast<const MeshObject&>(*base_object),
+                        impl->m_proxy_decimation);
+                impl->m_generated_proxy_source = base_object;
+
+                RENDERER_LOG_DEBUG(
+                    "object instance \"%s\": decimated object \"%s\" from %s to %s %s.",
+                    get_path().c_str(),
+                    base_object->get_path().c_str(),
+                    pretty_uint(static_cast<const MeshObject*>(base_object)->get_triangle_count()).c_str(),
+                    pretty_uint(impl->m_generated_proxy->get_triangle_count()).c_str(),
+                    plural(impl->m_generated_proxy->get_triangle_count(), "triangle").c_str());
+            }
+
+            impl->m_proxy_object = impl->m_generated_proxy.get();
+        }
+    }
 }
 
 void ObjectInstance::check_object() const
 {
-    if (m_object == nullptr)
+    if (impl->m_lod_objects.empty() || impl->m_lod_objects[0] == nullptr)
         throw ExceptionUnknownEntity(impl->m_object_name.c_str(), this);
+
+    for (size_t i = 0, e = impl->m_lod_object_names.size(); i < e; ++i)
+    {
+        if (impl->m_lod_objects[i + 1] == nullptr)
+            throw ExceptionUnknownEntity(impl->m_lod_object_names[i].c_str(), this);
+    }
+
+    if (!impl->m_proxy_object_name.empty() && impl->m_proxy_object == nullptr)
+        throw ExceptionUnknownEntity(impl->m_proxy_object_name.c_str(), this);
 }
 
 namespace
@@ -552,6 +728,22 @@ DictionaryArray ObjectInstanceFactory::get_input_metadata()
             .insert("use", "optional")
             .insert("default", "0.0"));
 
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "curve_lod_distance")
+            .insert("label", "Curve LOD Distance")
+            .insert("type", "text")
+            .insert("use", "optional")
+            .insert("default", "0.0"));
+
+    metadata.push_back(
+        Dictionary()
+            .insert("name", "curve_lod_min_density")
+            .insert("label", "Curve LOD Minimum Density")
+            .insert("type", "text")
+            .insert("use", "optional")
+            .insert("default", "0.1"));
+
     metadata.push_back(
         Dictionary()
         .insert("name", "sss_set_id")
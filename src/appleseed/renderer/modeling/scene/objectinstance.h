@@ -124,12 +124,36 @@ class APPLESEED_DLLSYMBOL ObjectInstance
     RayBiasMethod get_ray_bias_method() const;
     double get_ray_bias_distance() const;
 
+    // Return true if this object instance shares an SSS set with other object instances.
+    // Otherwise it forms its own SSS set.
+    bool has_sss_set_identifier() const;
+
     // Check if this object instance is in the same SSS set as another.
     bool is_in_same_sss_set(const ObjectInstance& other) const;
 
     // Find the object bound to this instance.
     Object* find_object() const;
 
+    // Level of detail. An instance may list coarser variants of its object, each associated
+    // with a projected size (the diameter of the instance's bounding box divided by its
+    // distance to the camera) below which it replaces the base object. Variants must have
+    // the same material slots as the base object. Level 0 designates the base object,
+    // level i > 0 the i'th variant.
+    size_t get_lod_count() const;
+    double get_lod_screen_size(const size_t lod) const;
+    size_t get_lod() const;
+
+    // Select the object used by this instance. Return true if the selection changed.
+    bool select_lod(const size_t lod);
+
+    // Proxy geometry. An instance of a mesh object may have a coarser proxy mesh that rays
+    // carrying VisibilityFlags::ProxyRay are intersected against instead of the object:
+    // either another mesh object ("proxy.object"), or one generated when the object is bound
+    // by decimating the object ("proxy.decimation", the fraction of vertices to keep).
+    // Proxies must be meshes with the same material slots as the object. Return nullptr if this
+    // instance has no proxy.
+    Object* get_proxy_object() const;
+
     // Compute the parent space bounding box of the instance.
     GAABB3 compute_parent_bbox() const;
 
@@ -0,0 +1,384 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Interface header.
+#include "pointinstancer.h"
+
+// appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
+#include "renderer/modeling/scene/assembly.h"
+#include "renderer/modeling/scene/assemblyinstance.h"
+#include "renderer/modeling/scene/basegroup.h"
+#include "renderer/modeling/scene/visibilityflags.h"
+#include "renderer/utility/messagecontext.h"
+#include "renderer/utility/paramarray.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/matrix.h"
+#include "foundation/utility/api/apistring.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace foundation;
+using namespace std;
+
+namespace renderer
+{
+
+//
+// PointInstancer class implementation.
+//
+
+namespace
+{
+    const UniqueID g_class_uid = new_guid();
+
+    // The upper 3x4 part of a local-to-parent and of a parent-to-local matrix,
+    // in single precision, row-major order.
+    struct PackedTransform
+    {
+        float m_local_to_parent[12];
+        float m_parent_to_local[12];
+    };
+
+    void pack_matrix(const Matrix4d& m, float* out)
+    {
+        for (size_t i = 0; i < 12; ++i)
+            out[i] = static_cast<float>(m[i]);
+    }
+
+    Matrix4d unpack_matrix(const float* in)
+    {
+        Matrix4d m;
+
+        for (size_t i = 0; i < 12; ++i)
+            m[i] = static_cast<double>(in[i]);
+
+        m[12] = 0.0;
+        m[13] = 0.0;
+        m[14] = 0.0;
+        m[15] = 1.0;
+
+        return m;
+    }
+}
+
+UniqueID PointInstancer::get_class_uid()
+{
+    return g_class_uid;
+}
+
+struct PointInstancer::Impl
+{
+    vector<string>              m_prototype_names;
+    vector<AssemblyInstance*>   m_prototype_instances;
+    vector<PackedTransform>     m_transforms;
+    vector<uint32>              m_prototype_indices;
+    vector<uint32>              m_ids;
+    vector<Color3f>             m_colors;
+
+    ~Impl()
+    {
+        for (AssemblyInstance* prototype_instance : m_prototype_instances)
+            prototype_instance->release();
+    }
+
+    const Assembly* find_prototype_assembly(
+        const Entity*           parent,
+        const size_t            prototype_index) const
+    {
+        while (parent)
+        {
+            const BaseGroup* parent_base_group = dynamic_cast<const BaseGroup*>(parent);
+            assert(parent_base_group);
+
+            const Assembly* assembly =
+                parent_base_group->assemblies().get_by_name(m_prototype_names[prototype_index].c_str());
+
+            if (assembly)
+                return assembly;
+
+            parent = parent->get_parent();
+        }
+
+        return nullptr;
+    }
+};
+
+PointInstancer::PointInstancer(
+    const char*                 name,
+    const ParamArray&           params)
+  : Entity(g_class_uid, params)
+  , impl(new Impl())
+{
+    set_name(name);
+
+    const EntityDefMessageContext context("point instancer", this);
+
+    // Retrieve visibility flags.
+    m_vis_flags = VisibilityFlags::parse(params.child("visibility"), context);
+}
+
+PointInstancer::~PointInstancer()
+{
+    delete impl;
+}
+
+void PointInstancer::release()
+{
+    delete this;
+}
+
+size_t PointInstancer::push_prototype(const char* assembly_name)
+{
+    assert(assembly_name);
+
+    const size_t prototype_index = impl->m_prototype_names.size();
+
+    // Prototypes are exposed to the rest of the renderer as regular assembly instances
+    // named after the point instancer, sharing its parameters and visibility flags.
+    auto_release_ptr<AssemblyInstance> prototype_instance(
+        AssemblyInstanceFactory::create(
+            get_name(),
+            get_parameters(),
+            assembly_name));
+    prototype_instance->transform_sequence().set_transform(0.0f, Transformd::identity());
+
+    impl->m_prototype_names.emplace_back(assembly_name);
+    impl->m_prototype_instances.push_back(prototype_instance.release());
+
+    bump_version_id();
+
+    return prototype_index;
+}
+
+size_t PointInstancer::get_prototype_count() const
+{
+    return impl->m_prototype_names.size();
+}
+
+const char* PointInstancer::get_prototype_name(const size_t prototype_index) const
+{
+    assert(prototype_index < impl->m_prototype_names.size());
+    return impl->m_prototype_names[prototype_index].c_str();
+}
+
+void PointInstancer::unbind_prototypes()
+{
+    for (AssemblyInstance* prototype_instance : impl->m_prototype_instances)
+        prototype_instance->unbind_assembly();
+}
+
+void PointInstancer::bind_prototypes(const AssemblyContainer& assemblies)
+{
+    for (AssemblyInstance* prototype_instance : impl->m_prototype_instances)
+        prototype_instance->bind_assembly(assemblies);
+}
+
+void PointInstancer::check_prototypes() const
+{
+    for (const AssemblyInstance* prototype_instance : impl->m_prototype_instances)
+        prototype_instance->check_assembly();
+}
+
+const AssemblyInstance& PointInstancer::get_prototype_instance(const size_t prototype_index) const
+{
+    assert(prototype_index < impl->m_prototype_instances.size());
+    return *impl->m_prototype_instances[prototype_index];
+}
+
+void PointInstancer::reserve_instances(const size_t count)
+{
+    impl->m_transforms.reserve(count);
+    impl->m_prototype_indices.reserve(count);
+}
+
+size_t PointInstancer::push_instance(
+    const Transformd&           transform,
+    const size_t                prototype_index)
+{
+    assert(prototype_index < impl->m_prototype_names.size());
+
+    const size_t instance_index = impl->m_transforms.size();
+
+    PackedTransform packed;
+    pack_matrix(transform.get_local_to_parent(), packed.m_local_to_parent);
+    pack_matrix(transform.get_parent_to_local(), packed.m_parent_to_local);
+
+    impl->m_transforms.push_back(packed);
+    impl->m_prototype_indices.push_back(static_cast<uint32>(prototype_index));
+
+    bump_version_id();
+
+    return instance_index;
+}
+
+void PointInstancer::push_instance_id(const uint32 id)
+{
+    impl->m_ids.push_back(id);
+    bump_version_id();
+}
+
+void PointInstancer::push_instance_color(const Color3f& color)
+{
+    impl->m_colors.push_back(color);
+    bump_version_id();
+}
+
+size_t PointInstancer::get_instance_count() const
+{
+    return impl->m_transforms.size();
+}
+
+Transformd PointInstancer::get_instance_transform(const size_t instance_index) const
+{
+    assert(instance_index < impl->m_transforms.size());
+
+    const PackedTransform& packed = impl->m_transforms[instance_index];
+
+    return
+        Transformd(
+            unpack_matrix(packed.m_local_to_parent),
+            unpack_matrix(packed.m_parent_to_local));
+}
+
+size_t PointInstancer::get_instance_prototype(const size_t instance_index) const
+{
+    assert(instance_index < impl->m_prototype_indices.size());
+    return impl->m_prototype_indices[instance_index];
+}
+
+bool PointInstancer::has_instance_ids() const
+{
+    return !impl->m_ids.empty();
+}
+
+uint32 PointInstancer::get_instance_id(const size_t instance_index) const
+{
+    assert(instance_index < impl->m_ids.size());
+    return impl->m_ids[instance_index];
+}
+
+bool PointInstancer::has_instance_colors() const
+{
+    return !impl->m_colors.empty();
+}
+
+const Color3f& PointInstancer::get_instance_color(const size_t instance_index) const
+{
+    assert(instance_index < impl->m_colors.size());
+    return impl->m_colors[instance_index];
+}
+
+GAABB3 PointInstancer::compute_parent_bbox() const
+{
+    // Like AssemblyInstance::compute_parent_bbox(), manually look prototypes up
+    // through the assembly hierarchy since they may not be bound yet.
+
+    const size_t prototype_count = impl->m_prototype_names.size();
+    vector<GAABB3> prototype_bboxes(prototype_count);
+
+    for (size_t i = 0; i < prototype_count; ++i)
+    {
+        const Assembly* assembly = impl->find_prototype_assembly(get_parent(), i);
+        prototype_bboxes[i] =
+            assembly
+                ? assembly->compute_non_hierarchical_local_bbox()
+                : GAABB3::invalid();
+    }
+
+    GAABB3 bbox;
+    bbox.invalidate();
+
+    const size_t instance_count = impl->m_transforms.size();
+
+    for (size_t i = 0; i < instance_count; ++i)
+    {
+        const GAABB3& prototype_bbox = prototype_bboxes[impl->m_prototype_indices[i]];
+
+        if (prototype_bbox.is_valid())
+            bbox.insert(get_instance_transform(i).to_parent(prototype_bbox));
+    }
+
+    return bbox;
+}
+
+bool PointInstancer::on_frame_begin(
+    const Project&              project,
+    const BaseGroup*            parent,
+    OnFrameBeginRecorder&       recorder,
+    IAbortSwitch*               abort_switch)
+{
+    if (!Entity::on_frame_begin(project, parent, recorder, abort_switch))
+        return false;
+
+    if (!impl->m_ids.empty() && impl->m_ids.size() != impl->m_transforms.size())
+    {
+        RENDERER_LOG_ERROR(
+            "point instancer \"%s\" has " FMT_SIZE_T " instance ids but " FMT_SIZE_T " instances.",
+            get_path().c_str(),
+            impl->m_ids.size(),
+            impl->m_transforms.size());
+        return false;
+    }
+
+    if (!impl->m_colors.empty() && impl->m_colors.size() != impl->m_transforms.size())
+    {
+        RENDERER_LOG_ERROR(
+            "point instancer \"%s\" has " FMT_SIZE_T " instance colors but " FMT_SIZE_T " instances.",
+            get_path().c_str(),
+            impl->m_colors.size(),
+            impl->m_transforms.size());
+        return false;
+    }
+
+    for (AssemblyInstance* prototype_instance : impl->m_prototype_instances)
+        prototype_instance->transform_sequence().prepare();
+
+    return true;
+}
+
+
+//
+// PointInstancerFactory class implementation.
+//
+
+auto_release_ptr<PointInstancer> PointInstancerFactory::create(
+    const char*                 name,
+    const ParamArray&           params)
+{
+    return
+        auto_release_ptr<PointInstancer>(
+            new PointInstancer(name, params));
+}
+
+}   // namespace renderer
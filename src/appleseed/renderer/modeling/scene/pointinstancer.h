@@ -0,0 +1,176 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+// appleseed.renderer headers.
+#include "renderer/global/globaltypes.h"
+#include "renderer/modeling/entity/entity.h"
+#include "renderer/modeling/scene/containers.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/color.h"
+#include "foundation/math/transform.h"
+#include "foundation/platform/compiler.h"
+#include "foundation/platform/types.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/uid.h"
+
+// appleseed.main headers.
+#include "main/dllsymbol.h"
+
+// Standard headers.
+#include <cstddef>
+
+// Forward declarations.
+namespace foundation    { class IAbortSwitch; }
+namespace renderer      { class AssemblyInstance; }
+namespace renderer      { class BaseGroup; }
+namespace renderer      { class OnFrameBeginRecorder; }
+namespace renderer      { class ParamArray; }
+namespace renderer      { class Project; }
+
+namespace renderer
+{
+
+//
+// A point instancer places a large number of copies of a small set of prototype
+// assemblies. Instances are stored in packed arrays (a single-precision transform
+// and a prototype index per instance, plus optional per-instance IDs and colors)
+// rather than as individual AssemblyInstance entities, and are intersected through
+// a dedicated BVH built by the assembly tree.
+//
+// Prototypes are instantiated without their own child assembly instances: only
+// the objects directly contained in a prototype assembly are rendered.
+//
+
+class APPLESEED_DLLSYMBOL PointInstancer
+  : public Entity
+{
+  public:
+    // Return the unique ID of this class of entities.
+    static foundation::UniqueID get_class_uid();
+
+    // Delete this instance.
+    void release() override;
+
+    // Return the visibility flags of this point instancer.
+    foundation::uint32 get_vis_flags() const;
+
+    // Append a prototype and return its index.
+    size_t push_prototype(const char* assembly_name);
+
+    // Return the number of prototypes.
+    size_t get_prototype_count() const;
+
+    // Return the name of a given prototype assembly.
+    const char* get_prototype_name(const size_t prototype_index) const;
+
+    // Prototype binding.
+    void unbind_prototypes();
+    void bind_prototypes(const AssemblyContainer& assemblies);
+    void check_prototypes() const;
+
+    // Return the internal assembly instance standing for a given prototype.
+    // Only valid once prototypes are bound.
+    const AssemblyInstance& get_prototype_instance(const size_t prototype_index) const;
+
+    // Reserve memory for a given number of instances.
+    void reserve_instances(const size_t count);
+
+    // Append an instance and return its index.
+    size_t push_instance(
+        const foundation::Transformd&   transform,
+        const size_t                    prototype_index);
+
+    // Append an optional per-instance ID or color. When used, there must be
+    // exactly one ID (resp. color) per instance.
+    void push_instance_id(const foundation::uint32 id);
+    void push_instance_color(const foundation::Color3f& color);
+
+    // Access instances.
+    size_t get_instance_count() const;
+    foundation::Transformd get_instance_transform(const size_t instance_index) const;
+    size_t get_instance_prototype(const size_t instance_index) const;
+    bool has_instance_ids() const;
+    foundation::uint32 get_instance_id(const size_t instance_index) const;
+    bool has_instance_colors() const;
+    const foundation::Color3f& get_instance_color(const size_t instance_index) const;
+
+    // Compute the parent space bounding box of all instances.
+    // Like AssemblyInstance::compute_parent_bbox(), this works before input binding.
+    GAABB3 compute_parent_bbox() const;
+
+    bool on_frame_begin(
+        const Project&                  project,
+        const BaseGroup*                parent,
+        OnFrameBeginRecorder&           recorder,
+        foundation::IAbortSwitch*       abort_switch = nullptr) override;
+
+  private:
+    friend class PointInstancerFactory;
+
+    struct Impl;
+    Impl* impl;
+
+    foundation::uint32  m_vis_flags;
+
+    // Constructor.
+    PointInstancer(
+        const char*                     name,
+        const ParamArray&               params);
+
+    // Destructor.
+    ~PointInstancer() override;
+};
+
+
+//
+// Point instancer factory.
+//
+
+class APPLESEED_DLLSYMBOL PointInstancerFactory
+{
+  public:
+    // Create a new point instancer.
+    static foundation::auto_release_ptr<PointInstancer> create(
+        const char*                     name,
+        const ParamArray&               params);
+};
+
+
+//
+// PointInstancer class implementation.
+//
+
+inline foundation::uint32 PointInstancer::get_vis_flags() const
+{
+    return m_vis_flags;
+}
+
+}   // namespace renderer
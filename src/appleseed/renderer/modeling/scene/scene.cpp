@@ -38,12 +38,16 @@
 #include "renderer/modeling/color/colorentity.h"
 #include "renderer/modeling/environmentedf/environmentedf.h"
 #include "renderer/modeling/environmentshader/environmentshader.h"
+#include "renderer/kernel/rasterization/rasterizationcamera.h"
 #include "renderer/modeling/frame/frame.h"
+#include "renderer/modeling/material/material.h"
+#include "renderer/modeling/object/meshobject.h"
 #include "renderer/modeling/object/object.h"
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/scene/assembly.h"
 #include "renderer/modeling/scene/assemblyinstance.h"
 #include "renderer/modeling/scene/objectinstance.h"
+#include "renderer/modeling/scene/pointinstancer.h"
 #include "renderer/modeling/scene/proceduralassembly.h"
 #include "renderer/modeling/scene/textureinstance.h"
 #include "renderer/modeling/scene/visibilityflags.h"
@@ -54,12 +58,18 @@
 #include "renderer/utility/bbox.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/math/aabb.h"
+#include "foundation/math/transform.h"
 #include "foundation/math/vector.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/foreach.h"
 #include "foundation/utility/job/abortswitch.h"
 
 // Standard headers.
+#include <limits>
+#include <map>
 #include <set>
 
 using namespace foundation;
@@ -90,6 +100,8 @@ struct Scene::Impl
     EnvironmentEDFContainer         m_environment_edfs;
     EnvironmentShaderContainer      m_environment_shaders;
     auto_release_ptr<SurfaceShader> m_default_surface_shader;
+    bool                            m_has_volumes;
+    bool                            m_has_subsurface_scattering;
 #ifdef APPLESEED_WITH_EMBREE
     EmbreeDevice                    m_embree_device;
 #endif
@@ -102,6 +114,8 @@ struct Scene::Impl
             PhysicalSurfaceShaderFactory().create(
                 "default_surface_shader",
                 ParamArray()))
+      , m_has_volumes(false)
+      , m_has_subsurface_scattering(false)
     {
     }
 };
@@ -167,12 +181,46 @@ SurfaceShader* Scene::get_default_surface_shader() const
 GAABB3 Scene::compute_bbox() const
 {
     const AssemblyInstanceContainer& instances = assembly_instances();
-    const GAABB3 bbox = compute_parent_bbox<GAABB3>(instances.begin(), instances.end());
+    GAABB3 bbox = compute_parent_bbox<GAABB3>(instances.begin(), instances.end());
+    bbox.insert(compute_parent_bbox<GAABB3>(point_instancers().begin(), point_instancers().end()));
     return bbox.is_valid() ? bbox : GAABB3(GVector3(0.0f), GVector3(0.0f));
 }
 
 namespace
 {
+    bool point_instancers_use_alpha_mapping(
+        const PointInstancerContainer&    point_instancers)
+    {
+        const VisibilityFlags::Type visibility_mask =
+            VisibilityFlags::CameraRay |
+            VisibilityFlags::ShadowRay;
+
+        for (const PointInstancer& point_instancer : point_instancers)
+        {
+            // Skip invisible point instancers.
+            if ((point_instancer.get_vis_flags() & visibility_mask) == 0)
+                continue;
+
+            // Prototypes are instantiated without their child assembly instances.
+            for (size_t i = 0, e = point_instancer.get_prototype_count(); i < e; ++i)
+            {
+                const Assembly& assembly = point_instancer.get_prototype_instance(i).get_assembly();
+
+                for (const_each<ObjectInstanceContainer> j = assembly.object_instances(); j; ++j)
+                {
+                    // Skip invisible object instances.
+                    if ((j->get_vis_flags() & visibility_mask) == 0)
+                        continue;
+
+                    if (j->uses_alpha_mapping())
+                        return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
     bool assembly_instances_use_alpha_mapping(
         const AssemblyInstanceContainer&  assembly_instances,
         set<UniqueID>&                    visited_assemblies)
@@ -210,6 +258,10 @@ namespace
                         return true;
                 }
 
+                // Check point instancers.
+                if (point_instancers_use_alpha_mapping(assembly.point_instancers()))
+                    return true;
+
                 // Recurse into child assembly instances.
                 if (assembly_instances_use_alpha_mapping(assembly.assembly_instances(), visited_assemblies))
                     return true;
@@ -264,10 +316,39 @@ namespace
 
         return false;
     }
+
+    void collect_material_features(
+        const AssemblyContainer&            assemblies,
+        bool&                               has_volumes,
+        bool&                               has_subsurface_scattering)
+    {
+        for (const Assembly& assembly : assemblies)
+        {
+            for (const Material& material : assembly.materials())
+            {
+                const Material::RenderData& render_data = material.get_render_data();
+
+                if (render_data.m_volume != nullptr)
+                    has_volumes = true;
+
+                if (render_data.m_bssrdf != nullptr)
+                    has_subsurface_scattering = true;
+            }
+
+            // Recurse into child assemblies.
+            collect_material_features(
+                assembly.assemblies(),
+                has_volumes,
+                has_subsurface_scattering);
+        }
+    }
 }
 
 bool Scene::uses_alpha_mapping() const
 {
+    if (point_instancers_use_alpha_mapping(point_instancers()))
+        return true;
+
     set<UniqueID> visited_assemblies;
     return assembly_instances_use_alpha_mapping(assembly_instances(), visited_assemblies);
 }
@@ -278,6 +359,16 @@ bool Scene::has_participating_media() const
     return assembly_instances_has_participating_media(assembly_instances(), visited_assemblies);
 }
 
+bool Scene::has_volumes() const
+{
+    return impl->m_has_volumes;
+}
+
+bool Scene::has_subsurface_scattering() const
+{
+    return impl->m_has_subsurface_scattering;
+}
+
 void Scene::collect_asset_paths(StringArray& paths) const
 {
     BaseGroup::collect_asset_paths(paths);
@@ -331,6 +422,117 @@ namespace
     }
 }
 
+namespace
+{
+    // Largest on-screen length, in pixels, of the control edges of each subdivision surface.
+    typedef map<MeshObject*, double> SubdivisionEdgeLengths;
+
+    void collect_subdivision_edge_lengths(
+        const Assembly&         assembly,
+        const Transformd&       assembly_to_world,
+        const Vector3d&         camera_position,
+        const double            pixels_per_radian,
+        SubdivisionEdgeLengths& edge_lengths)
+    {
+        for (const_each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
+        {
+            MeshObject* mesh = dynamic_cast<MeshObject*>(i->find_object());
+            if (mesh == nullptr || !mesh->is_subdivision_surface())
+                continue;
+
+            const AABB3d local_bbox(mesh->compute_local_bbox());
+            if (!local_bbox.is_valid())
+                continue;
+
+            const Transformd instance_to_world = i->get_transform() * assembly_to_world;
+            const AABB3d world_bbox = instance_to_world.to_parent(local_bbox);
+
+            // Distance from the camera to the closest point of the instance.
+            Vector3d closest;
+            for (size_t d = 0; d < 3; ++d)
+                closest[d] = clamp(camera_position[d], world_bbox.min[d], world_bbox.max[d]);
+            const double distance = norm(closest - camera_position);
+
+            double edge_length = numeric_limits<double>::max();
+            if (distance > 0.0 && pixels_per_radian > 0.0)
+            {
+                const double local_diameter = local_bbox.diameter();
+                const double scale = local_diameter > 0.0 ? world_bbox.diameter() / local_diameter : 1.0;
+                edge_length = mesh->get_average_control_edge_length() * scale * pixels_per_radian / distance;
+            }
+
+            double& max_edge_length = edge_lengths[mesh];
+            max_edge_length = max(max_edge_length, edge_length);
+        }
+
+        for (const_each<AssemblyInstanceContainer> i = assembly.assembly_instances(); i; ++i)
+        {
+            const Assembly* child_assembly = i->find_assembly();
+            if (child_assembly == nullptr)
+                continue;
+
+            collect_subdivision_edge_lengths(
+                *child_assembly,
+                i->transform_sequence().get_earliest_transform() * assembly_to_world,
+                camera_position,
+                pixels_per_radian,
+                edge_lengths);
+        }
+    }
+
+    void update_subdivision_surfaces(
+        const Scene&            scene,
+        const Project&          project)
+    {
+        // Without an active camera, subdivision surfaces are subdivided up to their maximum level.
+        Vector3d camera_position(0.0);
+        double pixels_per_radian = 0.0;
+        const Camera* camera = project.get_uncached_active_camera();
+        const Frame* frame = project.get_frame();
+        if (camera != nullptr && frame != nullptr)
+        {
+            camera_position =
+                camera->transform_sequence().get_earliest_transform().get_local_to_parent().extract_translation();
+
+            const double hfov = camera->get_rasterization_camera().m_hfov;
+            if (hfov > 0.0)
+                pixels_per_radian = frame->image().properties().m_canvas_width / hfov;
+        }
+
+        SubdivisionEdgeLengths edge_lengths;
+        for (const_each<AssemblyInstanceContainer> i = scene.assembly_instances(); i; ++i)
+        {
+            const Assembly* assembly = i->find_assembly();
+            if (assembly == nullptr)
+                continue;
+
+            collect_subdivision_edge_lengths(
+                *assembly,
+                i->transform_sequence().get_earliest_transform(),
+                camera_position,
+                pixels_per_radian,
+                edge_lengths);
+        }
+
+        for (const_each<SubdivisionEdgeLengths> i = edge_lengths; i; ++i)
+        {
+            MeshObject* mesh = i->first;
+            const size_t level =
+                pixels_per_radian > 0.0
+                    ? mesh->compute_subdivision_level(i->second)
+                    : mesh->get_max_subdivision_level();
+
+            if (mesh->update_subdivision(level))
+            {
+                // Force the rebuild of the acceleration structures of the parent assembly.
+                Entity* parent = mesh->get_parent();
+                if (parent != nullptr)
+                    parent->bump_version_id();
+            }
+        }
+    }
+}
+
 bool Scene::expand_procedural_assemblies(
     const Project&          project,
     IAbortSwitch*           abort_switch)
@@ -374,6 +576,10 @@ bool Scene::on_render_begin(
         success = success && impl->m_environment->on_render_begin(project, this, recorder, abort_switch);
     success = success && invoke_on_render_begin(cameras(), project, this, recorder, abort_switch);
 
+    // Subdivision levels depend on the active camera, and must be known before the trace context is updated.
+    if (success)
+        update_subdivision_surfaces(*this, project);
+
     return success;
 }
 
@@ -410,6 +616,17 @@ bool Scene::on_frame_begin(
 
     m_camera = project.get_uncached_active_camera();
 
+    // Materials are ready: determine which shading features the scene requires.
+    impl->m_has_volumes = false;
+    impl->m_has_subsurface_scattering = false;
+    if (success)
+    {
+        collect_material_features(
+            assemblies(),
+            impl->m_has_volumes,
+            impl->m_has_subsurface_scattering);
+    }
+
     return success;
 }
 
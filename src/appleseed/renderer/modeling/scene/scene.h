@@ -109,6 +109,11 @@ class APPLESEED_DLLSYMBOL Scene
     // Return true if the scene contains participating media.
     bool has_participating_media() const;
 
+    // Return true if at least one material of the scene has a volume, or a BSSRDF, respectively.
+    // These methods are only valid between on_frame_begin() and on_frame_end() calls.
+    bool has_volumes() const;
+    bool has_subsurface_scattering() const;
+
     // Expose asset file paths referenced by this entity to the outside.
     void collect_asset_paths(foundation::StringArray& paths) const override;
     void update_asset_paths(const foundation::StringDictionary& mappings) override;
@@ -158,6 +163,7 @@ class APPLESEED_DLLSYMBOL Scene
     const RenderData& get_render_data() const;
 
   private:
+    friend class Project;
     friend class SceneFactory;
 
     struct Impl;
@@ -30,11 +30,19 @@
 #include "visibilityflags.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/utility/messagecontext.h"
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
 #include "foundation/utility/countof.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <vector>
+
+using namespace foundation;
+using namespace std;
 
 namespace renderer
 {
@@ -72,6 +80,35 @@ VisibilityFlags::Type VisibilityFlags::parse(
     return flags;
 }
 
+VisibilityFlags::Type VisibilityFlags::parse_names(
+    const string&           names,
+    const MessageContext&   message_context)
+{
+    vector<string> tokens;
+    tokenize(names, Blanks, tokens);
+
+    Type flags = 0;
+
+    for (const string& token : tokens)
+    {
+        size_t i = 0;
+        while (i < Count && token != Names[i])
+            ++i;
+
+        if (i < Count)
+            flags |= 1UL << i;
+        else
+        {
+            RENDERER_LOG_WARNING(
+                "%sunknown ray type \"%s\", ignoring it.",
+                message_context.get(),
+                token.c_str());
+        }
+    }
+
+    return flags;
+}
+
 ParamArray VisibilityFlags::to_dictionary(const Type flags)
 {
     ParamArray params;
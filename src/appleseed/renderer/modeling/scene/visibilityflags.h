@@ -36,6 +36,7 @@
 
 // Standard headers.
 #include <cstddef>
+#include <string>
 
 // Forward declarations.
 namespace renderer  { class MessageContext; }
@@ -62,10 +63,14 @@ class APPLESEED_DLLSYMBOL VisibilityFlags
         SpecularRay     = 1UL << 7,
         SubsurfaceRay   = 1UL << 8,
         NPRRay          = 1UL << 9,
-        AllRays         = ~0
+        AllRays         = ~0,
+
+        // Not a ray type but a modifier: rays carrying this flag are intersected
+        // against the proxy geometry of object instances, where there is one.
+        ProxyRay        = 1UL << 31
     };
 
-    // Names follow the same order as values.
+    // Names of ray types, in the same order as values.
     static const size_t Count;
     static const char* Names[];
 
@@ -74,6 +79,12 @@ class APPLESEED_DLLSYMBOL VisibilityFlags
         const ParamArray&       params,
         const MessageContext&   message_context);
 
+    // Parse a space-separated list of ray type names and combine them into a bitmask.
+    // Unknown names are reported and ignored.
+    static Type parse_names(
+        const std::string&      names,
+        const MessageContext&   message_context);
+
     // Convert visibility flags to a dictionary.
     static ParamArray to_dictionary(const Type flags);
 };
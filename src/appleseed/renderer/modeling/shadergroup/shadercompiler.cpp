@@ -30,22 +30,33 @@
 #include "shadercompiler.h"
 
 // appleseed.renderer headers.
+#include "renderer/global/globallogger.h"
 #include "renderer/kernel/rendering/oiioerrorhandler.h"
 
 // appleseed.foundation headers.
 #include "foundation/utility/api/apistring.h"
+#include "foundation/utility/murmurhash.h"
 
 // OSL headers.
 #include "foundation/platform/_beginoslheaders.h"
 #include "OSL/oslcomp.h"
+#include "OSL/oslversion.h"
 #include "foundation/platform/_endoslheaders.h"
 
+// Boost headers.
+#include "boost/filesystem.hpp"
+#include "boost/filesystem/fstream.hpp"
+
 // Standard headers.
+#include <exception>
+#include <ios>
+#include <iterator>
 #include <string>
 #include <vector>
 
 using namespace foundation;
 using namespace std;
+namespace bfs = boost::filesystem;
 
 namespace renderer
 {
@@ -53,6 +64,26 @@ namespace renderer
 //
 // ShaderCompiler class implementation.
 //
+// Compiled shaders are cached in files named after a MurmurHash of the cache format
+// version, the OSL version, the contents of stdosl.h, the compiler options and the
+// shader source code. Files #included by the source code other than stdosl.h are
+// not part of the key.
+//
+
+namespace
+{
+    const size_t ShaderCacheFormatVersion = 1;
+
+    bool read_file(const bfs::path& filepath, string& contents)
+    {
+        bfs::ifstream file(filepath, ios::in | ios::binary);
+        if (!file)
+            return false;
+
+        contents.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        return !file.bad();
+    }
+}
 
 struct ShaderCompiler::Impl
 {
@@ -77,6 +108,75 @@ struct ShaderCompiler::Impl
     OSL::OSLCompiler*   m_compiler;
     OIIOErrorHandler*   m_error_handler;
     vector<string>      m_options;
+    string              m_cache_directory;
+    string              m_stdosl_contents;
+
+    string compute_cache_key(const char* source_code) const
+    {
+        MurmurHash hash;
+        hash.append(ShaderCacheFormatVersion);
+        hash.append(OSL_LIBRARY_VERSION_STRING);
+
+        hash.append(m_stdosl_contents);
+
+        hash.append(m_options.size());
+        for (const string& option : m_options)
+            hash.append(option);
+
+        hash.append(source_code);
+
+        return hash.to_string();
+    }
+
+    static bool load_from_cache(const bfs::path& filepath, string& byte_code)
+    {
+        if (!read_file(filepath, byte_code))
+            return false;
+
+        // Reject files that don't look like OSL byte code, e.g. truncated files.
+        if (byte_code.compare(0, 19, "OpenShadingLanguage") != 0)
+        {
+            RENDERER_LOG_WARNING("ignoring invalid compiled shader cache file %s.", filepath.string().c_str());
+            return false;
+        }
+
+        RENDERER_LOG_DEBUG("loaded compiled shader from cache file %s.", filepath.string().c_str());
+        return true;
+    }
+
+    static void save_to_cache(const bfs::path& filepath, const string& byte_code)
+    {
+        try
+        {
+            bfs::create_directories(filepath.parent_path());
+
+            // Write to a temporary file first so that concurrent renders never see a partial cache file.
+            const bfs::path temp_filepath =
+                filepath.parent_path() / bfs::unique_path(filepath.filename().string() + ".%%%%-%%%%-%%%%.tmp");
+
+            {
+                bfs::ofstream file(temp_filepath, ios::out | ios::binary | ios::trunc);
+                file.write(byte_code.data(), byte_code.size());
+
+                if (!file)
+                {
+                    file.close();
+                    bfs::remove(temp_filepath);
+                    RENDERER_LOG_WARNING("failed to write compiled shader cache file %s.", filepath.string().c_str());
+                    return;
+                }
+            }
+
+            bfs::rename(temp_filepath, filepath);
+        }
+        catch (const exception& e)
+        {
+            RENDERER_LOG_WARNING(
+                "failed to write compiled shader cache file %s: %s.",
+                filepath.string().c_str(),
+                e.what());
+        }
+    }
 };
 
 ShaderCompiler::ShaderCompiler(const char* stdosl_path)
@@ -104,11 +204,34 @@ void ShaderCompiler::add_option(const char* option)
     impl->m_options.push_back(option);
 }
 
+void ShaderCompiler::set_cache_directory(const char* path)
+{
+    impl->m_cache_directory = path;
+
+    impl->m_stdosl_contents.clear();
+    if (!impl->m_cache_directory.empty())
+        read_file(impl->m_stdosl_path, impl->m_stdosl_contents);
+}
+
 bool ShaderCompiler::compile_buffer(
     const char* source_code,
     APIString&  result) const
 {
     string buffer;
+
+    // Look for the compiled shader in the cache.
+    bfs::path cache_filepath;
+    if (!impl->m_cache_directory.empty())
+    {
+        cache_filepath = bfs::path(impl->m_cache_directory) / (impl->compute_cache_key(source_code) + ".oso");
+
+        if (Impl::load_from_cache(cache_filepath, buffer))
+        {
+            result = APIString(buffer.c_str());
+            return true;
+        }
+    }
+
     const bool ok = impl->m_compiler->compile_buffer(
         source_code,
         buffer,
@@ -116,8 +239,14 @@ bool ShaderCompiler::compile_buffer(
         impl->m_stdosl_path.c_str());
 
     if (ok)
+    {
         result = APIString(buffer.c_str());
 
+        // Store the compiled shader into the cache.
+        if (!cache_filepath.empty())
+            Impl::save_to_cache(cache_filepath, buffer);
+    }
+
     return ok;
 }
 
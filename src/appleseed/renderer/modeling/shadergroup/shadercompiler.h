@@ -56,6 +56,10 @@ class APPLESEED_DLLSYMBOL ShaderCompiler
 
     void add_option(const char* option);
 
+    // Set the directory where compiled shaders are cached across renders.
+    // An empty path (the default) disables the cache.
+    void set_cache_directory(const char* path);
+
     bool compile_buffer(
         const char*             source_code,
         foundation::APIString&  result) const;
@@ -35,20 +35,32 @@
 #include "renderer/modeling/project/project.h"
 #include "renderer/modeling/shadergroup/shader.h"
 #include "renderer/modeling/shadergroup/shaderconnection.h"
+#include "renderer/modeling/shadergroup/shaderparam.h"
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/math/scalar.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
+#include "foundation/utility/countof.h"
 #include "foundation/utility/job/abortswitch.h"
+#include "foundation/utility/string.h"
 #include "foundation/utility/uid.h"
 
+// appleseed.main headers.
+#include "main/allocator.h"
+
 // Boost headers.
+#include "boost/atomic/atomic.hpp"
 #include "boost/unordered/unordered_map.hpp"
 
 // Standard headers.
+#include <cassert>
+#include <cstddef>
 #include <exception>
+#include <string>
 #include <utility>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -77,6 +89,9 @@ namespace
 
     const OIIO::ustring g_dPdtime_str("dPdtime");
 
+    const uint64 NeverUsed = ~uint64(0);
+    boost::atomic<uint64> g_use_count(0);
+
     bool is_subsurface_closure(const OIIO::ustring& closure_name)
     {
         return
@@ -94,6 +109,10 @@ struct ShaderGroup::Impl
     ShaderConnectionContainer   m_connections;
     mutable OSL::ShaderGroupRef m_shader_group_ref;
     mutable SurfaceAreaMap      m_surface_areas;
+
+    // Set once the group is optimized, after the closure and globals flags are known.
+    boost::atomic<bool>         m_optimized;
+    mutable boost::atomic<uint64> m_first_use;
 };
 
 ShaderGroup::ShaderGroup(const char* name)
@@ -124,6 +143,8 @@ void ShaderGroup::clear()
     impl->m_shaders.clear();
     impl->m_connections.clear();
     impl->m_shader_group_ref.reset();
+    impl->m_optimized = false;
+    impl->m_first_use = NeverUsed;
     m_flags = 0;
 }
 
@@ -191,13 +212,17 @@ void ShaderGroup::add_connection(
 bool ShaderGroup::create_optimized_osl_shader_group(
     OSLShadingSystem&       shading_system,
     const ShaderCompiler*   shader_compiler,
-    IAbortSwitch*           abort_switch)
+    IAbortSwitch*           abort_switch,
+    const bool              defer_optimization)
 {
+    // The group may have been set up earlier with its optimization deferred.
     if (is_valid())
-        return true;
+        return defer_optimization || optimize_osl_shader_group(shading_system);
 
     RENDERER_LOG_DEBUG("setting up shader group \"%s\"...", get_path().c_str());
 
+    MemoryTagScope memory_tag_scope(MemoryTagOSL);
+
     if (!compile_source_shaders(shader_compiler))
         return false;
 
@@ -242,7 +267,28 @@ bool ShaderGroup::create_optimized_osl_shader_group(
         }
 
         impl->m_shader_group_ref = shader_group_ref;
+    }
+    catch (const exception& e)
+    {
+        RENDERER_LOG_ERROR("failed to setup shader group \"%s\": %s.", get_path().c_str(), e.what());
+        return false;
+    }
+
+    return defer_optimization ? true : optimize_osl_shader_group(shading_system);
+}
+
+bool ShaderGroup::optimize_osl_shader_group(OSLShadingSystem& shading_system)
+{
+    assert(is_valid());
+
+    if (is_optimized())
+        return true;
+
+    MemoryTagScope memory_tag_scope(MemoryTagOSL);
 
+    try
+    {
+        // Querying the closures and globals needed by the group optimizes and JIT-compiles it.
         get_shadergroup_closures_info(shading_system);
         report_has_closure("bsdf", HasBSDFs);
         report_has_closure(g_emission_str.c_str(), HasEmission);
@@ -256,11 +302,17 @@ bool ShaderGroup::create_optimized_osl_shader_group(
         get_shadergroup_globals_info(shading_system);
         report_uses_global("dPdtime", UsesdPdTime);
 
+        get_shadergroup_constness_info(shading_system);
+        if (is_constant())
+            RENDERER_LOG_DEBUG("shader group \"%s\" is constant.", get_path().c_str());
+
+        impl->m_optimized = true;
+
         return true;
     }
     catch (const exception& e)
     {
-        RENDERER_LOG_ERROR("failed to setup shader group \"%s\": %s.", get_path().c_str(), e.what());
+        RENDERER_LOG_ERROR("failed to optimize shader group \"%s\": %s.", get_path().c_str(), e.what());
         return false;
     }
 }
@@ -268,6 +320,7 @@ bool ShaderGroup::create_optimized_osl_shader_group(
 void ShaderGroup::release_optimized_osl_shader_group()
 {
     impl->m_shader_group_ref.reset();
+    impl->m_optimized = false;
 }
 
 const ShaderContainer& ShaderGroup::shaders() const
@@ -285,6 +338,75 @@ bool ShaderGroup::is_valid() const
     return impl->m_shader_group_ref.get() != nullptr;
 }
 
+bool ShaderGroup::is_optimized() const
+{
+    return impl->m_optimized.load(boost::memory_order_acquire);
+}
+
+void ShaderGroup::record_use() const
+{
+    if (impl->m_first_use.load(boost::memory_order_relaxed) == NeverUsed)
+    {
+        uint64 expected = NeverUsed;
+        impl->m_first_use.compare_exchange_strong(expected, g_use_count++);
+    }
+}
+
+uint64 ShaderGroup::get_first_use() const
+{
+    return impl->m_first_use.load(boost::memory_order_relaxed);
+}
+
+Color3f ShaderGroup::get_fallback_albedo() const
+{
+    // Names of the parameters that most likely hold a diffuse color, by decreasing preference.
+    static const char* PreferredNames[] = { "base_color", "diffuse", "albedo", "reflectance" };
+
+    Color3f albedo(0.5f);
+    size_t best_rank = ~size_t(0);
+
+    // The last shaders are the closest to the closures.
+    for (size_t i = impl->m_shaders.size(); i-- > 0; )
+    {
+        const Shader& shader = *impl->m_shaders.get_by_index(i);
+
+        for (const ShaderParam& param : shader.shader_params())
+        {
+            vector<string> tokens;
+            tokenize(param.get_value_as_string(), Blanks, tokens);
+            if (tokens.size() != 4 || tokens[0] != "color")
+                continue;
+
+            const string name = lower_case(param.get_name());
+            if (name.find("color") == string::npos && name.find("albedo") == string::npos)
+                continue;
+
+            // Any color parameter is a better guess than the default albedo.
+            size_t rank = countof(PreferredNames);
+            for (size_t j = 0; j < countof(PreferredNames); ++j)
+            {
+                if (name.find(PreferredNames[j]) != string::npos)
+                {
+                    rank = j;
+                    break;
+                }
+            }
+
+            if (rank < best_rank)
+            {
+                for (size_t j = 0; j < 3; ++j)
+                    albedo[j] = saturate(from_string<float>(tokens[j + 1]));
+                best_rank = rank;
+            }
+        }
+
+        if (best_rank < countof(PreferredNames))
+            break;
+    }
+
+    return albedo;
+}
+
 float ShaderGroup::get_surface_area(
     const AssemblyInstance* assembly_instance,
     const ObjectInstance*   object_instance) const
@@ -486,6 +608,44 @@ void ShaderGroup::report_uses_global(const char* global_name, const Flags flag)
     }
 }
 
+void ShaderGroup::get_shadergroup_constness_info(OSLShadingSystem& shading_system)
+{
+    // Assume the shader group is not constant.
+    m_flags &= ~IsConstant;
+
+    // Each of these counts must be zero for the outputs of the optimized
+    // shader group not to depend on the point being shaded.
+    const char* Queries[] =
+    {
+        "num_globals_needed",
+        "num_attributes_needed",
+        "unknown_attributes_needed",
+        "num_userdata"
+    };
+
+    for (const char* query : Queries)
+    {
+        int count = 0;
+        if (!shading_system.getattribute(
+                impl->m_shader_group_ref.get(),
+                query,
+                count))
+        {
+            RENDERER_LOG_WARNING(
+                "getattribute: %s call failed for shader group \"%s\"; "
+                "assuming shader group is not constant.",
+                query,
+                get_path().c_str());
+            return;
+        }
+
+        if (count != 0)
+            return;
+    }
+
+    m_flags |= IsConstant;
+}
+
 void ShaderGroup::set_surface_area(
     const AssemblyInstance* assembly_instance,
     const ObjectInstance*   object_instance,
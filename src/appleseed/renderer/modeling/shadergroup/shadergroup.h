@@ -33,6 +33,7 @@
 #include "renderer/modeling/scene/containers.h"
 
 // appleseed.foundation headers.
+#include "foundation/image/color.h"
 #include "foundation/platform/compiler.h"
 #include "foundation/platform/types.h"
 #include "foundation/utility/api/specializedapiarrays.h"
@@ -92,11 +93,18 @@ class APPLESEED_DLLSYMBOL ShaderGroup
         const char*                 dst_layer,
         const char*                 dst_param);
 
-    // Create internal OSL shader group.
+    // Create internal OSL shader group. Unless optimization is deferred, the group is also
+    // optimized and JIT-compiled; otherwise optimize_osl_shader_group() must be called
+    // before the group can be used for shading.
     bool create_optimized_osl_shader_group(
         OSLShadingSystem&           shading_system,
         const ShaderCompiler*       shader_compiler,
-        foundation::IAbortSwitch*   abort_switch = nullptr);
+        foundation::IAbortSwitch*   abort_switch = nullptr,
+        const bool                  defer_optimization = false);
+
+    // Optimize and JIT-compile an internal OSL shader group whose optimization was deferred.
+    // May be called from any thread, but not concurrently for the same shader group.
+    bool optimize_osl_shader_group(OSLShadingSystem& shading_system);
 
     // Release internal OSL shader group.
     void release_optimized_osl_shader_group();
@@ -110,6 +118,21 @@ class APPLESEED_DLLSYMBOL ShaderGroup
     // Return true if the shader group was setup correctly.
     bool is_valid() const;
 
+    // Return true if the shader group is optimized and can be used for shading.
+    // The closure and globals queries below are only meaningful for optimized groups.
+    bool is_optimized() const;
+
+    // Record that a surface shaded by this shader group was hit while the group was
+    // not optimized yet. Only the first use is kept.
+    void record_use() const;
+
+    // Return a number ordering shader groups by first recorded use, or ~0 if there was none.
+    foundation::uint64 get_first_use() const;
+
+    // Return the albedo used to shade surfaces while this shader group is not optimized,
+    // guessed from the color parameters of its shaders.
+    foundation::Color3f get_fallback_albedo() const;
+
     // Return true if the shader group contains at least one BSDF closure.
     bool has_bsdfs() const;
 
@@ -134,6 +157,11 @@ class APPLESEED_DLLSYMBOL ShaderGroup
     // Return true if the shader group uses the dPdtime global.
     bool uses_dPdtime() const;
 
+    // Return true if the outputs of the shader group depend neither on globals nor on
+    // attributes or user data, i.e. if it produces the same closures at every point
+    // for a given ray type.
+    bool is_constant() const;
+
     // Return the surface area of an object.
     // Can only be called if the shader group has emission closures.
     float get_surface_area(
@@ -171,7 +199,10 @@ class APPLESEED_DLLSYMBOL ShaderGroup
 
         // Globals.
         UsesdPdTime     = 1u << 7,
-        UsesAllGlobals  = UsesdPdTime
+        UsesAllGlobals  = UsesdPdTime,
+
+        // Point-independent outputs.
+        IsConstant      = 1u << 8
     };
     foundation::uint32 m_flags;
 
@@ -189,6 +220,8 @@ class APPLESEED_DLLSYMBOL ShaderGroup
     void get_shadergroup_globals_info(OSLShadingSystem& shading_system);
     void report_uses_global(const char* global_name, const Flags flag) const;
 
+    void get_shadergroup_constness_info(OSLShadingSystem& shading_system);
+
     void set_surface_area(
         const AssemblyInstance* assembly_instance,
         const ObjectInstance*   object_instance,
@@ -263,4 +296,9 @@ inline bool ShaderGroup::uses_dPdtime() const
     return (m_flags & UsesdPdTime) != 0;
 }
 
+inline bool ShaderGroup::is_constant() const
+{
+    return (m_flags & IsConstant) != 0;
+}
+
 }   // namespace renderer
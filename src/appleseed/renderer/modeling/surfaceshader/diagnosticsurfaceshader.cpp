@@ -294,7 +294,7 @@ void DiagnosticSurfaceShader::evaluate(
 
       case FacingRatio:
         {
-            const Vector3d& normal = shading_point.get_shading_normal();
+            const Vector3d normal(shading_point.get_shading_normal());
             const Vector3d& view = shading_point.get_ray().m_dir;
             const double facing = abs(dot(normal, view));
             set_shading_result(
@@ -382,7 +382,7 @@ void DiagnosticSurfaceShader::evaluate(
                 }
             }
 
-            const Vector3d v =
+            const SVector3 v =
                 impl->m_shading_mode == ShadingNormal ? shading_point.get_shading_basis().get_normal() :
                 impl->m_shading_mode == Tangent ? shading_point.get_shading_basis().get_tangent_u() :
                 shading_point.get_shading_basis().get_tangent_v();
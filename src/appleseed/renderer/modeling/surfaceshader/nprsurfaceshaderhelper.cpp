@@ -168,7 +168,7 @@ Color4f NPRSurfaceShaderHelper::evaluate_npr_contour(
     const Intersector& intersector = shading_context.get_intersector();
 
     const Vector3d& p = shading_point.get_point();
-    const Vector3d& n = shading_point.get_shading_normal();
+    const Vector3d n(shading_point.get_shading_normal());
     const ShadingRay& original_ray = shading_point.get_ray();
 
     const Vector3d& I = original_ray.m_dir;
@@ -250,7 +250,7 @@ Color4f NPRSurfaceShaderHelper::evaluate_npr_contour(
 
                         if (values->m_features & static_cast<unsigned int>(NPRContourFeatures::CreaseEdges))
                         {
-                            const Vector3d& nc = other_shading_point.get_shading_normal();
+                            const Vector3d nc(other_shading_point.get_shading_normal());
                             const float cos_nnc = static_cast<float>(dot(n, nc));
 
                             if (cos_nnc < values->m_cos_crease_threshold)
@@ -115,7 +115,7 @@ namespace
             // OSL shaders can modify the shading basis in the shading point when using bump,
             // normal maps or anisotropy. When using more than 1 lighting sample, we need to
             // save and restore the basis for each sample.
-            const Basis3d basis = shading_point.get_shading_basis();
+            const Basis3d basis(shading_point.get_shading_basis());
             shading_context.get_lighting_engine()->compute_lighting(
                 sampling_context,
                 pixel_context,
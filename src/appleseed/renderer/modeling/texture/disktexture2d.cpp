@@ -39,11 +39,13 @@
 #include "renderer/utility/paramarray.h"
 
 // appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
 #include "foundation/image/canvasproperties.h"
 #include "foundation/image/colorspace.h"
 #include "foundation/image/genericprogressiveimagefilereader.h"
 #include "foundation/image/tile.h"
 #include "foundation/platform/thread.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/api/apistring.h"
 #include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/containers/dictionary.h"
@@ -52,18 +54,107 @@
 #include "foundation/utility/string.h"
 #include "foundation/utility/uid.h"
 
+// Boost headers.
+#include "boost/filesystem.hpp"
+#include "boost/thread/mutex.hpp"
+
 // Standard headers.
+#include <cassert>
 #include <cstddef>
+#include <map>
 #include <string>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace renderer
 {
 
 namespace
 {
+    //
+    // Process-wide cache of texture file headers.
+    //
+    // Entries are validated against the size and the modification time of the file,
+    // so that rendering a scene again (for instance after an interactive edit) does
+    // not require reopening every texture file just to learn its dimensions.
+    //
+
+    class TextureHeaderCache
+      : public NonCopyable
+    {
+      public:
+        typedef vector<CanvasProperties> LevelProperties;
+
+        bool lookup(const string& filepath, LevelProperties& level_props)
+        {
+            FileStamp stamp;
+            if (!stamp.read(filepath))
+                return false;
+
+            boost::mutex::scoped_lock lock(m_mutex);
+
+            const EntryMap::const_iterator i = m_entries.find(filepath);
+            if (i == m_entries.end() || !(i->second.m_stamp == stamp))
+                return false;
+
+            level_props = i->second.m_level_props;
+            return true;
+        }
+
+        void insert(const string& filepath, const LevelProperties& level_props)
+        {
+            Entry entry;
+            if (!entry.m_stamp.read(filepath))
+                return;
+            entry.m_level_props = level_props;
+
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_entries[filepath] = entry;
+        }
+
+      private:
+        struct FileStamp
+        {
+            uint64  m_file_size;
+            time_t  m_last_write_time;
+
+            bool read(const string& filepath)
+            {
+                boost::system::error_code size_ec, time_ec;
+                m_file_size = static_cast<uint64>(bf::file_size(filepath, size_ec));
+                m_last_write_time = bf::last_write_time(filepath, time_ec);
+                return !size_ec && !time_ec;
+            }
+
+            bool operator==(const FileStamp& rhs) const
+            {
+                return
+                    m_file_size == rhs.m_file_size &&
+                    m_last_write_time == rhs.m_last_write_time;
+            }
+        };
+
+        struct Entry
+        {
+            FileStamp           m_stamp;
+            LevelProperties     m_level_props;
+        };
+
+        typedef map<string, Entry> EntryMap;
+
+        boost::mutex    m_mutex;
+        EntryMap        m_entries;
+    };
+
+    TextureHeaderCache& texture_header_cache()
+    {
+        static TextureHeaderCache cache;
+        return cache;
+    }
+
     //
     // 2D on-disk texture.
     //
@@ -80,6 +171,7 @@ namespace
             const SearchPaths&      search_paths)
           : Texture(name, params)
           , m_reader(&global_logger())
+          , m_mip_level(0)
         {
             const EntityDefMessageContext context("texture", this);
 
@@ -114,12 +206,17 @@ namespace
             const Project&          project,
             const BaseGroup*        parent) override
         {
+            boost::mutex::scoped_lock lock(m_mutex);
+
             if (m_reader.is_open())
             {
                 RENDERER_LOG_INFO("closing texture file %s...", m_filepath.c_str());
                 m_reader.close();
             }
 
+            // Revalidate the header against the file on the next render.
+            m_level_props.clear();
+
             Texture::on_render_end(project, parent);
         }
 
@@ -128,6 +225,11 @@ namespace
             return m_color_space;
         }
 
+        const char* get_filepath() const override
+        {
+            return m_filepath.c_str();
+        }
+
         void collect_asset_paths(StringArray& paths) const override
         {
             if (m_params.strings().exist("filename"))
@@ -146,8 +248,8 @@ namespace
         const CanvasProperties& properties() override
         {
             boost::mutex::scoped_lock lock(m_mutex);
-            open_image_file();
-            return m_props;
+            read_level_properties();
+            return m_level_props[0];
         }
 
         Source* create_source(
@@ -161,9 +263,7 @@ namespace
             const size_t            tile_x,
             const size_t            tile_y) override
         {
-            boost::mutex::scoped_lock lock(m_mutex);
-            open_image_file();
-            return m_reader.read_tile(tile_x, tile_y);
+            return load_mip_level_tile(0, tile_x, tile_y);
         }
 
         void unload_tile(
@@ -174,13 +274,66 @@ namespace
             delete tile;
         }
 
+        size_t get_mip_level_count() override
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            read_level_properties();
+            return m_level_props.size();
+        }
+
+        const CanvasProperties& mip_level_properties(
+            const size_t            level) override
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            read_level_properties();
+            assert(level < m_level_props.size());
+            return m_level_props[level];
+        }
+
+        Tile* load_mip_level_tile(
+            const size_t            level,
+            const size_t            tile_x,
+            const size_t            tile_y) override
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            open_image_file();
+            assert(level < m_level_props.size());
+
+            if (level != m_mip_level)
+            {
+                m_reader.choose_mip_level(level);
+                m_mip_level = level;
+            }
+
+            return m_reader.read_tile(tile_x, tile_y);
+        }
+
       private:
         string                              m_filepath;
         ColorSpace                          m_color_space;
 
         mutable boost::mutex                m_mutex;
         GenericProgressiveImageFileReader   m_reader;
-        CanvasProperties                    m_props;
+        size_t                              m_mip_level;        // mipmap level the reader is positioned on
+        vector<CanvasProperties>            m_level_props;      // canvas properties of each mipmap level
+
+        // Retrieve the canvas properties of each mipmap level, from the header cache
+        // if possible. The texture file itself is only opened on first tile access.
+        void read_level_properties()
+        {
+            if (!m_level_props.empty())
+                return;
+
+            if (texture_header_cache().lookup(m_filepath, m_level_props))
+            {
+                RENDERER_LOG_DEBUG(
+                    "reusing cached metadata of texture file %s.",
+                    m_filepath.c_str());
+                return;
+            }
+
+            open_image_file();
+        }
 
         void open_image_file()
         {
@@ -191,7 +344,25 @@ namespace
                     m_filepath.c_str());
 
                 m_reader.open(m_filepath.c_str());
-                m_reader.read_canvas_properties(m_props);
+
+                // Keep properties already obtained from the header cache: references
+                // to them may have been handed out.
+                if (m_level_props.empty())
+                {
+                    // Tiled files such as the ones produced by maketx may store a full mipmap
+                    // pyramid: gather the canvas properties of each level.
+                    CanvasProperties props;
+                    do
+                    {
+                        m_reader.read_canvas_properties(props);
+                        m_level_props.push_back(props);
+                    } while (m_reader.choose_mip_level(m_level_props.size()));
+
+                    texture_header_cache().insert(m_filepath, m_level_props);
+                }
+
+                m_reader.choose_mip_level(0);
+                m_mip_level = 0;
             }
         }
     };
@@ -30,6 +30,9 @@
 // Interface header.
 #include "texture.h"
 
+// Standard headers.
+#include <cassert>
+
 using namespace foundation;
 
 namespace renderer
@@ -57,4 +60,29 @@ Texture::Texture(
     set_name(name);
 }
 
+const char* Texture::get_filepath() const
+{
+    return nullptr;
+}
+
+size_t Texture::get_mip_level_count()
+{
+    return 1;
+}
+
+const CanvasProperties& Texture::mip_level_properties(const size_t level)
+{
+    assert(level == 0);
+    return properties();
+}
+
+Tile* Texture::load_mip_level_tile(
+    const size_t        level,
+    const size_t        tile_x,
+    const size_t        tile_y)
+{
+    assert(level == 0);
+    return load_tile(tile_x, tile_y);
+}
+
 }   // namespace renderer
@@ -74,6 +74,10 @@ class APPLESEED_DLLSYMBOL Texture
     // Return the color space of the texture.
     virtual foundation::ColorSpace get_color_space() const = 0;
 
+    // Return the path to the file the texture is read from, or nullptr if the texture
+    // is not backed by a file. The default implementation returns nullptr.
+    virtual const char* get_filepath() const;
+
     // Access canvas properties.
     virtual const foundation::CanvasProperties& properties() = 0;
 
@@ -93,6 +97,23 @@ class APPLESEED_DLLSYMBOL Texture
         const size_t                tile_x,
         const size_t                tile_y,
         const foundation::Tile*     tile) = 0;
+
+    // Return the number of mipmap levels of the texture, including the base level.
+    // The default implementation returns 1.
+    virtual size_t get_mip_level_count();
+
+    // Access canvas properties of a given mipmap level.
+    // The default implementation returns the properties of the base level.
+    virtual const foundation::CanvasProperties& mip_level_properties(
+        const size_t                level);
+
+    // Load a given tile of a given mipmap level.
+    // The tile remains owned by the texture and is unloaded with unload_tile().
+    // The default implementation loads tiles of the base level.
+    virtual foundation::Tile* load_mip_level_tile(
+        const size_t                level,
+        const size_t                tile_x,
+        const size_t                tile_y);
 };
 
 }   // namespace renderer
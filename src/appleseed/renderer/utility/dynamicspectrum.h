@@ -144,6 +144,7 @@ class DynamicSpectrum
     static APPLESEED_TLS Mode       s_mode;
     static APPLESEED_TLS size_t     s_size;
 
+    // Only 16-byte alignment is guaranteed, AVX code paths use unaligned loads and stores.
     APPLESEED_SIMD4_ALIGN ValueType m_samples[StoredSamples];
 };
 
@@ -393,6 +394,14 @@ APPLESEED_FORCE_INLINE void DynamicSpectrum<float, 31>::set(const float val)
 
     if (s_size > 3)
     {
+#ifdef APPLESEED_USE_AVX
+        const __m256 mval8 = _mm256_set1_ps(val);
+
+        _mm256_storeu_ps(&m_samples[ 4], mval8);
+        _mm256_storeu_ps(&m_samples[12], mval8);
+        _mm256_storeu_ps(&m_samples[20], mval8);
+        _mm_store_ps(&m_samples[28], mval);
+#else
         _mm_store_ps(&m_samples[ 4], mval);
         _mm_store_ps(&m_samples[ 8], mval);
         _mm_store_ps(&m_samples[12], mval);
@@ -400,6 +409,7 @@ APPLESEED_FORCE_INLINE void DynamicSpectrum<float, 31>::set(const float val)
         _mm_store_ps(&m_samples[20], mval);
         _mm_store_ps(&m_samples[24], mval);
         _mm_store_ps(&m_samples[28], mval);
+#endif
     }
 }
 
@@ -626,6 +636,12 @@ APPLESEED_FORCE_INLINE DynamicSpectrum<float, 31>& operator+=(DynamicSpectrum<fl
 
     if (DynamicSpectrum<float, 31>::size() > 3)
     {
+#ifdef APPLESEED_USE_AVX
+        _mm256_storeu_ps(&lhs[ 4], _mm256_add_ps(_mm256_loadu_ps(&lhs[ 4]), _mm256_loadu_ps(&rhs[ 4])));
+        _mm256_storeu_ps(&lhs[12], _mm256_add_ps(_mm256_loadu_ps(&lhs[12]), _mm256_loadu_ps(&rhs[12])));
+        _mm256_storeu_ps(&lhs[20], _mm256_add_ps(_mm256_loadu_ps(&lhs[20]), _mm256_loadu_ps(&rhs[20])));
+        _mm_store_ps(&lhs[28], _mm_add_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&rhs[28])));
+#else
         _mm_store_ps(&lhs[ 4], _mm_add_ps(_mm_load_ps(&lhs[ 4]), _mm_load_ps(&rhs[ 4])));
         _mm_store_ps(&lhs[ 8], _mm_add_ps(_mm_load_ps(&lhs[ 8]), _mm_load_ps(&rhs[ 8])));
         _mm_store_ps(&lhs[12], _mm_add_ps(_mm_load_ps(&lhs[12]), _mm_load_ps(&rhs[12])));
@@ -633,6 +649,7 @@ APPLESEED_FORCE_INLINE DynamicSpectrum<float, 31>& operator+=(DynamicSpectrum<fl
         _mm_store_ps(&lhs[20], _mm_add_ps(_mm_load_ps(&lhs[20]), _mm_load_ps(&rhs[20])));
         _mm_store_ps(&lhs[24], _mm_add_ps(_mm_load_ps(&lhs[24]), _mm_load_ps(&rhs[24])));
         _mm_store_ps(&lhs[28], _mm_add_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&rhs[28])));
+#endif
     }
 
     return lhs;
@@ -669,6 +686,14 @@ APPLESEED_FORCE_INLINE DynamicSpectrum<float, 31>& operator*=(DynamicSpectrum<fl
 
     if (DynamicSpectrum<float, 31>::size() > 3)
     {
+#ifdef APPLESEED_USE_AVX
+        const __m256 mrhs8 = _mm256_set1_ps(rhs);
+
+        _mm256_storeu_ps(&lhs[ 4], _mm256_mul_ps(_mm256_loadu_ps(&lhs[ 4]), mrhs8));
+        _mm256_storeu_ps(&lhs[12], _mm256_mul_ps(_mm256_loadu_ps(&lhs[12]), mrhs8));
+        _mm256_storeu_ps(&lhs[20], _mm256_mul_ps(_mm256_loadu_ps(&lhs[20]), mrhs8));
+        _mm_store_ps(&lhs[28], _mm_mul_ps(_mm_load_ps(&lhs[28]), mrhs));
+#else
         _mm_store_ps(&lhs[ 4], _mm_mul_ps(_mm_load_ps(&lhs[ 4]), mrhs));
         _mm_store_ps(&lhs[ 8], _mm_mul_ps(_mm_load_ps(&lhs[ 8]), mrhs));
         _mm_store_ps(&lhs[12], _mm_mul_ps(_mm_load_ps(&lhs[12]), mrhs));
@@ -676,6 +701,7 @@ APPLESEED_FORCE_INLINE DynamicSpectrum<float, 31>& operator*=(DynamicSpectrum<fl
         _mm_store_ps(&lhs[20], _mm_mul_ps(_mm_load_ps(&lhs[20]), mrhs));
         _mm_store_ps(&lhs[24], _mm_mul_ps(_mm_load_ps(&lhs[24]), mrhs));
         _mm_store_ps(&lhs[28], _mm_mul_ps(_mm_load_ps(&lhs[28]), mrhs));
+#endif
     }
 
     return lhs;
@@ -701,6 +727,12 @@ APPLESEED_FORCE_INLINE DynamicSpectrum<float, 31>& operator*=(DynamicSpectrum<fl
 
     if (DynamicSpectrum<float, 31>::size() > 3)
     {
+#ifdef APPLESEED_USE_AVX
+        _mm256_storeu_ps(&lhs[ 4], _mm256_mul_ps(_mm256_loadu_ps(&lhs[ 4]), _mm256_loadu_ps(&rhs[ 4])));
+        _mm256_storeu_ps(&lhs[12], _mm256_mul_ps(_mm256_loadu_ps(&lhs[12]), _mm256_loadu_ps(&rhs[12])));
+        _mm256_storeu_ps(&lhs[20], _mm256_mul_ps(_mm256_loadu_ps(&lhs[20]), _mm256_loadu_ps(&rhs[20])));
+        _mm_store_ps(&lhs[28], _mm_mul_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&rhs[28])));
+#else
         _mm_store_ps(&lhs[ 4], _mm_mul_ps(_mm_load_ps(&lhs[ 4]), _mm_load_ps(&rhs[ 4])));
         _mm_store_ps(&lhs[ 8], _mm_mul_ps(_mm_load_ps(&lhs[ 8]), _mm_load_ps(&rhs[ 8])));
         _mm_store_ps(&lhs[12], _mm_mul_ps(_mm_load_ps(&lhs[12]), _mm_load_ps(&rhs[12])));
@@ -708,6 +740,7 @@ APPLESEED_FORCE_INLINE DynamicSpectrum<float, 31>& operator*=(DynamicSpectrum<fl
         _mm_store_ps(&lhs[20], _mm_mul_ps(_mm_load_ps(&lhs[20]), _mm_load_ps(&rhs[20])));
         _mm_store_ps(&lhs[24], _mm_mul_ps(_mm_load_ps(&lhs[24]), _mm_load_ps(&rhs[24])));
         _mm_store_ps(&lhs[28], _mm_mul_ps(_mm_load_ps(&lhs[28]), _mm_load_ps(&rhs[28])));
+#endif
     }
 
     return lhs;
@@ -783,6 +816,12 @@ APPLESEED_FORCE_INLINE void madd(
 
     if (DynamicSpectrum<float, 31>::size() > 3)
     {
+#ifdef APPLESEED_USE_AVX
+        _mm256_storeu_ps(&a[ 4], _mm256_add_ps(_mm256_loadu_ps(&a[ 4]), _mm256_mul_ps(_mm256_loadu_ps(&b[ 4]), _mm256_loadu_ps(&c[ 4]))));
+        _mm256_storeu_ps(&a[12], _mm256_add_ps(_mm256_loadu_ps(&a[12]), _mm256_mul_ps(_mm256_loadu_ps(&b[12]), _mm256_loadu_ps(&c[12]))));
+        _mm256_storeu_ps(&a[20], _mm256_add_ps(_mm256_loadu_ps(&a[20]), _mm256_mul_ps(_mm256_loadu_ps(&b[20]), _mm256_loadu_ps(&c[20]))));
+        _mm_store_ps(&a[28], _mm_add_ps(_mm_load_ps(&a[28]), _mm_mul_ps(_mm_load_ps(&b[28]), _mm_load_ps(&c[28]))));
+#else
         _mm_store_ps(&a[ 4], _mm_add_ps(_mm_load_ps(&a[ 4]), _mm_mul_ps(_mm_load_ps(&b[ 4]), _mm_load_ps(&c[ 4]))));
         _mm_store_ps(&a[ 8], _mm_add_ps(_mm_load_ps(&a[ 8]), _mm_mul_ps(_mm_load_ps(&b[ 8]), _mm_load_ps(&c[ 8]))));
         _mm_store_ps(&a[12], _mm_add_ps(_mm_load_ps(&a[12]), _mm_mul_ps(_mm_load_ps(&b[12]), _mm_load_ps(&c[12]))));
@@ -790,6 +829,7 @@ APPLESEED_FORCE_INLINE void madd(
         _mm_store_ps(&a[20], _mm_add_ps(_mm_load_ps(&a[20]), _mm_mul_ps(_mm_load_ps(&b[20]), _mm_load_ps(&c[20]))));
         _mm_store_ps(&a[24], _mm_add_ps(_mm_load_ps(&a[24]), _mm_mul_ps(_mm_load_ps(&b[24]), _mm_load_ps(&c[24]))));
         _mm_store_ps(&a[28], _mm_add_ps(_mm_load_ps(&a[28]), _mm_mul_ps(_mm_load_ps(&b[28]), _mm_load_ps(&c[28]))));
+#endif
     }
 }
 
@@ -805,6 +845,14 @@ APPLESEED_FORCE_INLINE void madd(
 
     if (DynamicSpectrum<float, 31>::size() > 3)
     {
+#ifdef APPLESEED_USE_AVX
+        const __m256 k8 = _mm256_set1_ps(c);
+
+        _mm256_storeu_ps(&a[ 4], _mm256_add_ps(_mm256_loadu_ps(&a[ 4]), _mm256_mul_ps(_mm256_loadu_ps(&b[ 4]), k8)));
+        _mm256_storeu_ps(&a[12], _mm256_add_ps(_mm256_loadu_ps(&a[12]), _mm256_mul_ps(_mm256_loadu_ps(&b[12]), k8)));
+        _mm256_storeu_ps(&a[20], _mm256_add_ps(_mm256_loadu_ps(&a[20]), _mm256_mul_ps(_mm256_loadu_ps(&b[20]), k8)));
+        _mm_store_ps(&a[28], _mm_add_ps(_mm_load_ps(&a[28]), _mm_mul_ps(_mm_load_ps(&b[28]), k)));
+#else
         _mm_store_ps(&a[ 4], _mm_add_ps(_mm_load_ps(&a[ 4]), _mm_mul_ps(_mm_load_ps(&b[ 4]), k)));
         _mm_store_ps(&a[ 8], _mm_add_ps(_mm_load_ps(&a[ 8]), _mm_mul_ps(_mm_load_ps(&b[ 8]), k)));
         _mm_store_ps(&a[12], _mm_add_ps(_mm_load_ps(&a[12]), _mm_mul_ps(_mm_load_ps(&b[12]), k)));
@@ -812,6 +860,7 @@ APPLESEED_FORCE_INLINE void madd(
         _mm_store_ps(&a[20], _mm_add_ps(_mm_load_ps(&a[20]), _mm_mul_ps(_mm_load_ps(&b[20]), k)));
         _mm_store_ps(&a[24], _mm_add_ps(_mm_load_ps(&a[24]), _mm_mul_ps(_mm_load_ps(&b[24]), k)));
         _mm_store_ps(&a[28], _mm_add_ps(_mm_load_ps(&a[28]), _mm_mul_ps(_mm_load_ps(&b[28]), k)));
+#endif
     }
 }
 
@@ -1021,6 +1070,24 @@ APPLESEED_FORCE_INLINE renderer::DynamicSpectrum<float, 31> lerp(
 
     if (renderer::DynamicSpectrum<float, 31>::size() > 3)
     {
+#ifdef APPLESEED_USE_AVX
+        const __m256 one8 = _mm256_set1_ps(1.0f);
+
+        for (size_t i = 4; i + 8 <= a.StoredSamples; i += 8)
+        {
+            const __m256 t8 = _mm256_loadu_ps(&t[i]);
+            const __m256 one_minus_t8 = _mm256_sub_ps(one8, t8);
+            const __m256 x8 = _mm256_mul_ps(_mm256_loadu_ps(&a[i]), one_minus_t8);
+            const __m256 y8 = _mm256_mul_ps(_mm256_loadu_ps(&b[i]), t8);
+            _mm256_storeu_ps(&result[i], _mm256_add_ps(x8, y8));
+        }
+
+        t4 = _mm_load_ps(&t[28]);
+        one_minus_t4 = _mm_sub_ps(one4, t4);
+        x = _mm_mul_ps(_mm_load_ps(&a[28]), one_minus_t4);
+        y = _mm_mul_ps(_mm_load_ps(&b[28]), t4);
+        _mm_store_ps(&result[28], _mm_add_ps(x, y));
+#else
         for (size_t i = 4; i < a.StoredSamples; i += 4)
         {
             t4 = _mm_load_ps(&t[i]);
@@ -1029,6 +1096,7 @@ APPLESEED_FORCE_INLINE renderer::DynamicSpectrum<float, 31> lerp(
             y = _mm_mul_ps(_mm_load_ps(&b[i]), t4);
             _mm_store_ps(&result[i], _mm_add_ps(x, y));
         }
+#endif
     }
 
     return result;
@@ -1058,6 +1126,14 @@ inline float min_value(const renderer::DynamicSpectrum<float, 31>& s)
     if (renderer::DynamicSpectrum<float, 31>::size() == 3)
         return std::min(std::min(s[0], s[1]), s[2]);
 
+#ifdef APPLESEED_USE_AVX
+    // Replace the padding sample by a copy of the last sample.
+    const __m256 s24 = _mm256_blend_ps(_mm256_loadu_ps(&s[24]), _mm256_loadu_ps(&s[23]), 0x80);
+    const __m256 m1 = _mm256_min_ps(_mm256_loadu_ps(&s[ 0]), _mm256_loadu_ps(&s[ 8]));
+    const __m256 m2 = _mm256_min_ps(_mm256_loadu_ps(&s[16]), s24);
+    const __m256 m3 = _mm256_min_ps(m1, m2);
+          __m128 m  = _mm_min_ps(_mm256_castps256_ps128(m3), _mm256_extractf128_ps(m3, 1));
+#else
     const __m128 m1 = _mm_min_ps(_mm_load_ps(&s[ 0]), _mm_load_ps(&s[ 4]));
     const __m128 m2 = _mm_min_ps(_mm_load_ps(&s[ 8]), _mm_load_ps(&s[12]));
     const __m128 m3 = _mm_min_ps(_mm_load_ps(&s[16]), _mm_load_ps(&s[20]));
@@ -1066,6 +1142,7 @@ inline float min_value(const renderer::DynamicSpectrum<float, 31>& s)
     const __m128 m5 = _mm_min_ps(m1, m2);
     const __m128 m6 = _mm_min_ps(m3, m4);
           __m128 m  = _mm_min_ps(m5, m6);
+#endif
 
     m = _mm_min_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
     m = _mm_min_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
@@ -1097,6 +1174,14 @@ inline float max_value(const renderer::DynamicSpectrum<float, 31>& s)
     if (renderer::DynamicSpectrum<float, 31>::size() == 3)
         return std::max(std::max(s[0], s[1]), s[2]);
 
+#ifdef APPLESEED_USE_AVX
+    // Replace the padding sample by a copy of the last sample.
+    const __m256 s24 = _mm256_blend_ps(_mm256_loadu_ps(&s[24]), _mm256_loadu_ps(&s[23]), 0x80);
+    const __m256 m1 = _mm256_max_ps(_mm256_loadu_ps(&s[ 0]), _mm256_loadu_ps(&s[ 8]));
+    const __m256 m2 = _mm256_max_ps(_mm256_loadu_ps(&s[16]), s24);
+    const __m256 m3 = _mm256_max_ps(m1, m2);
+          __m128 m  = _mm_max_ps(_mm256_castps256_ps128(m3), _mm256_extractf128_ps(m3, 1));
+#else
     const __m128 m1 = _mm_max_ps(_mm_load_ps(&s[ 0]), _mm_load_ps(&s[ 4]));
     const __m128 m2 = _mm_max_ps(_mm_load_ps(&s[ 8]), _mm_load_ps(&s[12]));
     const __m128 m3 = _mm_max_ps(_mm_load_ps(&s[16]), _mm_load_ps(&s[20]));
@@ -1105,6 +1190,7 @@ inline float max_value(const renderer::DynamicSpectrum<float, 31>& s)
     const __m128 m5 = _mm_max_ps(m1, m2);
     const __m128 m6 = _mm_max_ps(m3, m4);
           __m128 m  = _mm_max_ps(m5, m6);
+#endif
 
     m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
     m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
@@ -1257,6 +1343,12 @@ APPLESEED_FORCE_INLINE renderer::DynamicSpectrum<float, 31> sqrt(const renderer:
 
     if (renderer::DynamicSpectrum<float, 31>::size() > 3)
     {
+#ifdef APPLESEED_USE_AVX
+        _mm256_storeu_ps(&result[ 4], _mm256_sqrt_ps(_mm256_loadu_ps(&s[ 4])));
+        _mm256_storeu_ps(&result[12], _mm256_sqrt_ps(_mm256_loadu_ps(&s[12])));
+        _mm256_storeu_ps(&result[20], _mm256_sqrt_ps(_mm256_loadu_ps(&s[20])));
+        _mm_store_ps(&result[28], _mm_sqrt_ps(_mm_load_ps(&s[28])));
+#else
         _mm_store_ps(&result[ 4], _mm_sqrt_ps(_mm_load_ps(&s[ 4])));
         _mm_store_ps(&result[ 8], _mm_sqrt_ps(_mm_load_ps(&s[ 8])));
         _mm_store_ps(&result[12], _mm_sqrt_ps(_mm_load_ps(&s[12])));
@@ -1264,6 +1356,7 @@ APPLESEED_FORCE_INLINE renderer::DynamicSpectrum<float, 31> sqrt(const renderer:
         _mm_store_ps(&result[20], _mm_sqrt_ps(_mm_load_ps(&s[20])));
         _mm_store_ps(&result[24], _mm_sqrt_ps(_mm_load_ps(&s[24])));
         _mm_store_ps(&result[28], _mm_sqrt_ps(_mm_load_ps(&s[28])));
+#endif
     }
 
     return result;
@@ -32,6 +32,8 @@
 
 // Standard headers.
 #include <cstddef>
+#include <cstring>
+#include <string>
 #include <vector>
 
 using namespace foundation;
@@ -100,41 +102,53 @@ ParamArray& ParamArray::insert_path(const char* path, const char* value)
 
 bool ParamArray::exist_path(const char* path) const
 {
-    assert(path);
-
-    vector<string> parts;
-    tokenize(path, PartSeparator, parts);
-
-    assert(!parts.empty());
+    return find_path(path) != nullptr;
+}
 
-    const Dictionary* leaf = this;
+const char* ParamArray::get_path(const char* path) const
+{
+    const char* value = find_path(path);
 
-    for (size_t i = 0; i < parts.size() - 1; ++i)
-    {
-        if (!leaf->dictionaries().exist(parts[i]))
-            return false;
+    if (value == nullptr)
+        throw ExceptionDictionaryKeyNotFound(path);
 
-        leaf = &leaf->dictionary(parts[i]);
-    }
-
-    return leaf->strings().exist(parts.back().c_str());
+    return value;
 }
 
-const char* ParamArray::get_path(const char* path) const
+const char* ParamArray::find_path(const char* path) const
 {
     assert(path);
 
-    vector<string> parts;
-    tokenize(path, PartSeparator, parts);
+    // Walk down the path without splitting it into a vector of strings:
+    // this function is called for every parameter lookup by path.
+    const Dictionary* leaf = this;
+    string part;
 
-    assert(!parts.empty());
+    while (true)
+    {
+        path += strspn(path, PartSeparator);
 
-    const Dictionary* leaf = this;
+        const size_t part_length = strcspn(path, PartSeparator);
+        const char* part_end = path + part_length;
 
-    for (size_t i = 0; i < parts.size() - 1; ++i)
-        leaf = &leaf->dictionary(parts[i]);
+        if (part_end[strspn(part_end, PartSeparator)] == '\0')
+        {
+            // Last part of the path: it is the key of the parameter.
+            if (*part_end == '\0')
+                return leaf->strings().find(path);
+
+            part.assign(path, part_length);
+            return leaf->strings().find(part.c_str());
+        }
 
-    return leaf->strings().get(parts.back().c_str());
+        part.assign(path, part_length);
+        leaf = leaf->dictionaries().find(part.c_str());
+
+        if (leaf == nullptr)
+            return nullptr;
+
+        path = part_end;
+    }
 }
 
 ParamArray& ParamArray::remove_path(const char* path)
@@ -164,6 +164,9 @@ class APPLESEED_DLLSYMBOL ParamArray
     // Retrieve a parameter at a given path.
     const char* get_path(const char* path) const;
 
+    // Retrieve a parameter at a given path, or return nullptr if it does not exist.
+    const char* find_path(const char* path) const;
+
     // Like get_required() but given a path instead of a key.
     template <typename T>
     T get_path_required(
@@ -429,28 +432,28 @@ T ParamArray::get_helper(
 {
     assert(name);
 
-    try
-    {
-        if (is_path ? exist_path(name) : strings().exist(name))
-        {
-            const T value = is_path ? foundation::from_string<T>(get_path(name)) : get<T>(name);
+    const char* value = is_path ? find_path(name) : strings().find(name);
 
-            if (allowed_values.empty() || contains(allowed_values, value))
-                return value;
-        }
-        else
+    if (value == nullptr)
+    {
+        if (is_required)
         {
-            if (is_required)
-            {
-                RENDERER_LOG_ERROR(
-                    "%srequired parameter \"%s\" not found; continuing using value \"%s\".",
-                    message_context.get(),
-                    name,
-                    foundation::to_string(default_value).c_str());
-            }
-
-            return default_value;
+            RENDERER_LOG_ERROR(
+                "%srequired parameter \"%s\" not found; continuing using value \"%s\".",
+                message_context.get(),
+                name,
+                foundation::to_string(default_value).c_str());
         }
+
+        return default_value;
+    }
+
+    try
+    {
+        const T result = foundation::from_string<T>(value);
+
+        if (allowed_values.empty() || contains(allowed_values, result))
+            return result;
     }
     catch (const foundation::ExceptionStringConversionError&)
     {
@@ -459,7 +462,7 @@ T ParamArray::get_helper(
     RENDERER_LOG_ERROR(
         "%sinvalid value \"%s\" for parameter \"%s\"; continuing using value \"%s\".",
         message_context.get(),
-        is_path ? get_path(name) : get(name),
+        value,
         name,
         foundation::to_string(default_value).c_str());
 
@@ -476,27 +479,27 @@ T ParamArray::get_helper(
 {
     assert(name);
 
-    try
-    {
-        if (is_path ? exist_path(name) : strings().exist(name))
-        {
-            const T value = is_path ? foundation::from_string<T>(get_path(name)) : get<T>(name);
+    const char* value = is_path ? find_path(name) : strings().find(name);
 
-            if (allowed_values.empty() || contains(allowed_values, value))
-                return value;
-        }
-        else
+    if (value == nullptr)
+    {
+        if (is_required)
         {
-            if (is_required)
-            {
-                RENDERER_LOG_ERROR(
-                    "required parameter \"%s\" not found; continuing using value \"%s\".",
-                    name,
-                    foundation::to_string(default_value).c_str());
-            }
-
-            return default_value;
+            RENDERER_LOG_ERROR(
+                "required parameter \"%s\" not found; continuing using value \"%s\".",
+                name,
+                foundation::to_string(default_value).c_str());
         }
+
+        return default_value;
+    }
+
+    try
+    {
+        const T result = foundation::from_string<T>(value);
+
+        if (allowed_values.empty() || contains(allowed_values, result))
+            return result;
     }
     catch (const foundation::ExceptionStringConversionError&)
     {
@@ -504,7 +507,7 @@ T ParamArray::get_helper(
 
     RENDERER_LOG_ERROR(
         "invalid value \"%s\" for parameter \"%s\"; continuing using value \"%s\".",
-        is_path ? get_path(name) : get(name),
+        value,
         name,
         foundation::to_string(default_value).c_str());
 
@@ -521,25 +524,25 @@ T ParamArray::get_helper(
 {
     assert(name);
 
-    try
+    const char* value = is_path ? find_path(name) : strings().find(name);
+
+    if (value == nullptr)
     {
-        if (is_path ? exist_path(name) : strings().exist(name))
-        {
-            return is_path ? foundation::from_string<T>(get_path(name)) : get<T>(name);
-        }
-        else
+        if (is_required)
         {
-            if (is_required)
-            {
-                RENDERER_LOG_ERROR(
-                    "%srequired parameter \"%s\" not found; continuing using value \"%s\".",
-                    message_context.get(),
-                    name,
-                    foundation::to_string(default_value).c_str());
-            }
-
-            return default_value;
+            RENDERER_LOG_ERROR(
+                "%srequired parameter \"%s\" not found; continuing using value \"%s\".",
+                message_context.get(),
+                name,
+                foundation::to_string(default_value).c_str());
         }
+
+        return default_value;
+    }
+
+    try
+    {
+        return foundation::from_string<T>(value);
     }
     catch (const foundation::ExceptionStringConversionError&)
     {
@@ -548,7 +551,7 @@ T ParamArray::get_helper(
     RENDERER_LOG_ERROR(
         "%sinvalid value \"%s\" for parameter \"%s\"; continuing using value \"%s\".",
         message_context.get(),
-        is_path ? get_path(name) : get(name),
+        value,
         name,
         foundation::to_string(default_value).c_str());
 
@@ -564,24 +567,24 @@ T ParamArray::get_helper(
 {
     assert(name);
 
-    try
+    const char* value = is_path ? find_path(name) : strings().find(name);
+
+    if (value == nullptr)
     {
-        if (is_path ? exist_path(name) : strings().exist(name))
-        {
-            return is_path ? foundation::from_string<T>(get_path(name)) : get<T>(name);
-        }
-        else
+        if (is_required)
         {
-            if (is_required)
-            {
-                RENDERER_LOG_ERROR(
-                    "required parameter \"%s\" not found; continuing using value \"%s\".",
-                    name,
-                    foundation::to_string(default_value).c_str());
-            }
-
-            return default_value;
+            RENDERER_LOG_ERROR(
+                "required parameter \"%s\" not found; continuing using value \"%s\".",
+                name,
+                foundation::to_string(default_value).c_str());
         }
+
+        return default_value;
+    }
+
+    try
+    {
+        return foundation::from_string<T>(value);
     }
     catch (const foundation::ExceptionStringConversionError&)
     {
@@ -589,7 +592,7 @@ T ParamArray::get_helper(
 
     RENDERER_LOG_ERROR(
         "invalid value \"%s\" for parameter \"%s\"; continuing using value \"%s\".",
-        is_path ? get_path(name) : get(name),
+        value,
         name,
         foundation::to_string(default_value).c_str());
 
@@ -37,6 +37,7 @@
 #include "foundation/platform/path.h"
 #include "foundation/platform/sharedlibrary.h"
 #include "foundation/utility/searchpaths.h"
+#include "foundation/utility/string.h"
 
 // Boost headers.
 #include "boost/filesystem.hpp"
@@ -46,9 +47,15 @@
 // Standard headers.
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
 #include <map>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace foundation;
 using namespace std;
@@ -58,11 +65,30 @@ namespace bf = boost::filesystem;
 namespace renderer
 {
 
+const char* PluginStore::CacheFileName = "appleseed.plugincache";
+
 struct PluginStore::Impl
 {
     typedef PluginStore::PluginHandlerType PluginHandlerType;
     typedef map<string, PluginHandlerType> PluginHandlerMap;
 
+    // Entry point names and the models they provide.
+    typedef vector<pair<string, string>> ModelVector;
+
+    // What the cache file of a plugin directory records about a shared library.
+    struct CacheEntry
+    {
+        uintmax_t       m_file_size;
+        time_t          m_last_write_time;
+        ModelVector     m_models;
+    };
+
+    // Cache entries indexed by file name.
+    typedef map<string, CacheEntry> Cache;
+
+    // Plugins that were found but not loaded yet, indexed by file path.
+    typedef map<string, ModelVector> DeferredPluginMap;
+
     struct PluginDeleter;
     typedef unique_ptr<Plugin, PluginDeleter> PluginUniquePtr;
 
@@ -89,6 +115,7 @@ struct PluginStore::Impl
     PluginHandlerMap    m_plugin_handlers;
     PluginMap           m_plugin_map;
     PluginInverseMap    m_plugin_inverse_map;
+    DeferredPluginMap   m_deferred_plugins;
 
     Plugin* load_plugin_no_lock(const char* filepath)
     {
@@ -149,6 +176,12 @@ struct PluginStore::Impl
 
         RENDERER_LOG_INFO("scanning %s for plugins...", path.string().c_str());
 
+        const bf::path cache_filepath = path / PluginStore::CacheFileName;
+        const Cache cache = read_cache(cache_filepath);
+
+        Cache new_cache;
+        bool cache_changed = false;
+
         // Iterate over all files in this directory.
         for (bf::directory_iterator i(path), e; i != e; ++i)
         {
@@ -162,7 +195,36 @@ struct PluginStore::Impl
             if (lower_case(filepath.extension().string()) != SharedLibrary::get_default_file_extension())
                 continue;
 
-            vector<PluginHandlerMap::value_type> relevant_plugin_handlers;
+            boost::system::error_code size_ec, time_ec;
+            CacheEntry cache_entry;
+            cache_entry.m_file_size = bf::file_size(filepath, size_ec);
+            cache_entry.m_last_write_time = bf::last_write_time(filepath, time_ec);
+            if (size_ec || time_ec)
+                continue;
+
+            const string filename = filepath.filename().string();
+
+            // Defer loading the plugin if the cache knows which models it provides.
+            const auto cache_it = cache.find(filename);
+            if (cache_it != cache.end() &&
+                cache_it->second.m_file_size == cache_entry.m_file_size &&
+                cache_it->second.m_last_write_time == cache_entry.m_last_write_time)
+            {
+                new_cache.insert(*cache_it);
+
+                const ModelVector& models = cache_it->second.m_models;
+                if (!models.empty() && m_plugin_map.find(filepath.string()) == m_plugin_map.end())
+                {
+                    RENDERER_LOG_DEBUG("deferring loading of plugin %s.", filepath.string().c_str());
+                    m_deferred_plugins[filepath.string()] = models;
+                }
+
+                continue;
+            }
+
+            cache_changed = true;
+
+            vector<string> relevant_entry_point_names;
 
             try
             {
@@ -176,7 +238,7 @@ struct PluginStore::Impl
 
                     // If the plugin defines the expected entry point then keep this plugin handler to invoke it later.
                     if (library.get_symbol(entry_point_name.c_str()) != nullptr)
-                        relevant_plugin_handlers.push_back(plugin_handler_item);
+                        relevant_entry_point_names.push_back(entry_point_name);
                 }
             }
             catch (const ExceptionCannotLoadSharedLib& e)
@@ -185,24 +247,141 @@ struct PluginStore::Impl
                 continue;
             }
 
-            if (!relevant_plugin_handlers.empty())
+            if (!relevant_entry_point_names.empty())
             {
                 // Load the plugin.
                 Plugin* plugin = load_plugin_no_lock(filepath.string().c_str());
+                if (plugin == nullptr)
+                    continue;
 
                 // Invoke plugin handlers.
-                for (const auto& plugin_handler_item : relevant_plugin_handlers)
-                {
-                    const string& entry_point_name = plugin_handler_item.first;
-                    const PluginHandlerType& plugin_handler = plugin_handler_item.second;
+                cache_entry.m_models = invoke_plugin_handlers(plugin, relevant_entry_point_names);
+            }
+
+            new_cache.insert(Cache::value_type(filename, cache_entry));
+        }
+
+        // Forget about the shared libraries that were removed.
+        if (cache_changed || new_cache.size() != cache.size())
+            write_cache(cache_filepath, new_cache);
+    }
+
+    // Invoke the plugin handlers of given entry points of a plugin. Return the models they provide.
+    ModelVector invoke_plugin_handlers(Plugin* plugin, const vector<string>& entry_point_names)
+    {
+        ModelVector models;
+
+        for (const string& entry_point_name : entry_point_names)
+        {
+            const auto plugin_handler_it = m_plugin_handlers.find(entry_point_name);
+            if (plugin_handler_it == m_plugin_handlers.end())
+                continue;
+
+            // Retrieve again the plugin's entry point corresponding to this plugin handler.
+            void* plugin_entry_point = plugin->get_symbol(entry_point_name.c_str());
+            if (plugin_entry_point == nullptr)
+                continue;
+
+            // Invoke the plugin handler.
+            const char* model = plugin_handler_it->second(plugin, plugin_entry_point);
+            models.emplace_back(entry_point_name, model != nullptr ? model : "");
+        }
 
-                    // Retrieve again the plugin's entry point corresponding to this plugin handler.
-                    void* plugin_entry_point = plugin->get_symbol(entry_point_name.c_str());
+        return models;
+    }
 
-                    // Invoke the plugin handler.
-                    plugin_handler(plugin, plugin_entry_point);
+    bool load_deferred_plugins_no_lock(const char* entry_point_name, const char* model)
+    {
+        bool loaded = false;
+
+        for (auto i = m_deferred_plugins.begin(); i != m_deferred_plugins.end(); )
+        {
+            bool provides_model = false;
+            for (const auto& item : i->second)
+            {
+                if (item.first == entry_point_name && (model == nullptr || item.second == model))
+                {
+                    provides_model = true;
+                    break;
                 }
             }
+
+            if (!provides_model)
+            {
+                ++i;
+                continue;
+            }
+
+            const string filepath = i->first;
+            vector<string> entry_point_names;
+            for (const auto& item : i->second)
+                entry_point_names.push_back(item.first);
+            i = m_deferred_plugins.erase(i);
+
+            // Load the plugin and let it register all its models.
+            Plugin* plugin = load_plugin_no_lock(filepath.c_str());
+            if (plugin == nullptr)
+                continue;
+
+            invoke_plugin_handlers(plugin, entry_point_names);
+            loaded = true;
+
+            // A given model is only provided by one plugin.
+            if (model != nullptr)
+                break;
+        }
+
+        return loaded;
+    }
+
+    // The cache file has one line per shared library: its file name, size and last write time,
+    // followed by the entry point names and models it provides, all separated by tabs.
+    static Cache read_cache(const bf::path& cache_filepath)
+    {
+        Cache cache;
+
+        ifstream file(cache_filepath.string().c_str());
+        if (!file.is_open())
+            return cache;
+
+        string line;
+        while (getline(file, line))
+        {
+            vector<string> fields;
+            split(line, "\t", fields);
+
+            if (fields.size() < 3 || (fields.size() - 3) % 2 != 0)
+                continue;
+
+            CacheEntry cache_entry;
+            istringstream(fields[1]) >> cache_entry.m_file_size;
+            istringstream(fields[2]) >> cache_entry.m_last_write_time;
+            for (size_t j = 3; j < fields.size(); j += 2)
+                cache_entry.m_models.emplace_back(fields[j], fields[j + 1]);
+
+            cache[fields[0]] = cache_entry;
+        }
+
+        return cache;
+    }
+
+    static void write_cache(const bf::path& cache_filepath, const Cache& cache)
+    {
+        ofstream file(cache_filepath.string().c_str());
+        if (!file.is_open())
+        {
+            RENDERER_LOG_DEBUG("could not write plugin cache file %s.", cache_filepath.string().c_str());
+            return;
+        }
+
+        for (const auto& cache_item : cache)
+        {
+            const CacheEntry& cache_entry = cache_item.second;
+
+            file << cache_item.first << '\t' << cache_entry.m_file_size << '\t' << cache_entry.m_last_write_time;
+            for (const auto& model_item : cache_entry.m_models)
+                file << '\t' << model_item.first << '\t' << model_item.second;
+            file << '\n';
         }
     }
 };
@@ -235,6 +414,7 @@ void PluginStore::unload_all_plugins()
 
     impl->m_plugin_inverse_map.clear();
     impl->m_plugin_map.clear();
+    impl->m_deferred_plugins.clear();
 }
 
 Plugin* PluginStore::load_plugin(const char* filepath)
@@ -277,4 +457,14 @@ void PluginStore::load_all_plugins_from_path(const char* path)
     impl->load_all_plugins_from_path_no_lock(path);
 }
 
+bool PluginStore::load_deferred_plugins(
+    const char*                 entry_point_name,
+    const char*                 model)
+{
+    assert(entry_point_name);
+
+    boost::lock_guard<boost::mutex> lock(impl->m_store_mutex);
+    return impl->load_deferred_plugins_no_lock(entry_point_name, model);
+}
+
 }   // namespace renderer
@@ -47,12 +47,22 @@ namespace renderer
 //
 // All methods of this class are thread-safe.
 //
+// Plugins found in a directory are not necessarily loaded right away: each directory has
+// a cache file recording which models the shared libraries it contains provide. Libraries
+// whose cache entry is up-to-date are only loaded when one of their models is needed, see
+// load_deferred_plugins(). Other libraries are loaded and the cache file is updated, if the
+// directory is writable.
+//
 
 class APPLESEED_DLLSYMBOL PluginStore
   : public foundation::NonCopyable
 {
   public:
-    typedef std::function<void (Plugin*, void*)> PluginHandlerType;
+    // A plugin handler returns the model provided by the entry point, or nullptr.
+    typedef std::function<const char* (Plugin*, void*)> PluginHandlerType;
+
+    // Name of the plugin cache file of plugin directories.
+    static const char* CacheFileName;
 
     // Constructor.
     PluginStore();
@@ -75,12 +85,18 @@ class APPLESEED_DLLSYMBOL PluginStore
     // Unload a plugin. The plugin must have been previously loaded.
     void unload_plugin(Plugin* plugin);
 
-    // Load all plugins present inside a given directory.
+    // Load or defer all plugins present inside a given directory.
     void load_all_plugins_from_path(const char* path);
 
-    // Load all plugins present inside a collection of search paths.
+    // Load or defer all plugins present inside a collection of search paths.
     void load_all_plugins_from_paths(const foundation::SearchPaths& search_paths);
 
+    // Load the deferred plugins that define a given entry point and provide a given model
+    // through it, or any model if model is nullptr. Return true if a plugin was loaded.
+    bool load_deferred_plugins(
+        const char*                 entry_point_name,
+        const char*                 model = nullptr);
+
   private:
     struct Impl;
     Impl* impl;
@@ -198,9 +198,14 @@ bool TransformSequence::prepare()
                 m_interpolators[i].set_transforms(
                     m_keys[i].m_transform,
                     m_keys[i + 1].m_transform);
+
+            m_keys[i].m_rcp_duration = 1.0f / (m_keys[i + 1].m_time - m_keys[i].m_time);
         }
     }
 
+    if (m_size > 0)
+        m_keys[m_size - 1].m_rcp_duration = 0.0f;
+
     m_can_swap_handedness = false;
     m_all_swap_handedness = true;
 
@@ -305,11 +310,51 @@ void TransformSequence::copy_from(const TransformSequence& rhs)
     m_all_swap_handedness = rhs.m_all_swap_handedness;
 }
 
-void TransformSequence::interpolate(
-    const float         time,
-    Transformd&         result) const
+void TransformSequence::evaluate(
+    const size_t        count,
+    const float*        times,
+    Transformd*         results) const
 {
-    assert(m_size > 0);
+    if (m_size < 2)
+    {
+        const Transformd& transform =
+            m_size == 0 ? Transformd::identity() : m_keys[0].m_transform;
+
+        for (size_t i = 0; i < count; ++i)
+            results[i] = transform;
+
+        return;
+    }
+
+    const TransformKey* first = m_keys;
+    const TransformKey* last = m_keys + m_size - 1;
+
+    // Index of the motion segment of the previous time value, or ~0 if none.
+    size_t segment = ~size_t(0);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float time = times[i];
+
+        if (time <= first->m_time)
+            results[i] = first->m_transform;
+        else if (time >= last->m_time)
+            results[i] = last->m_transform;
+        else
+        {
+            if (segment == ~size_t(0) ||
+                time < m_keys[segment].m_time ||
+                time >= m_keys[segment + 1].m_time)
+                segment = find_segment(time);
+
+            interpolate(segment, time, results[i]);
+        }
+    }
+}
+
+size_t TransformSequence::find_segment(const float time) const
+{
+    assert(m_size > 1);
 
     size_t begin = 0;
     size_t end = m_size;
@@ -322,14 +367,27 @@ void TransformSequence::interpolate(
         else begin = mid;
     }
 
-    const float begin_time = m_keys[begin].m_time;
-    const float end_time = m_keys[end].m_time;
+    return begin;
+}
+
+void TransformSequence::interpolate(
+    const float         time,
+    Transformd&         result) const
+{
+    interpolate(find_segment(time), time, result);
+}
 
-    assert(end_time > begin_time);
+void TransformSequence::interpolate(
+    const size_t        segment,
+    const float         time,
+    Transformd&         result) const
+{
+    assert(segment < m_size - 1);
+    assert(m_keys[segment + 1].m_time > m_keys[segment].m_time);
 
-    const float t = (time - begin_time) / (end_time - begin_time);
+    const float t = (time - m_keys[segment].m_time) * m_keys[segment].m_rcp_duration;
 
-    m_interpolators[begin].evaluate(static_cast<double>(t), result);
+    m_interpolators[segment].evaluate(static_cast<double>(t), result);
 }
 
 namespace
@@ -115,6 +115,14 @@ class APPLESEED_DLLSYMBOL TransformSequence
         const float                     time,
         foundation::Transformd&         scratch) const;
 
+    // Compute the transforms for a batch of time values, for instance those of rays
+    // hitting the same instance. Consecutive time values that fall in the same motion
+    // segment share the segment lookup.
+    void evaluate(
+        const size_t                    count,
+        const float*                    times,
+        foundation::Transformd*         results) const;
+
     // Compose two transform sequences.
     TransformSequence operator*(const TransformSequence& rhs) const;
 
@@ -127,6 +135,7 @@ class APPLESEED_DLLSYMBOL TransformSequence
     struct TransformKey
     {
         float                           m_time;
+        float                           m_rcp_duration;     // 1 / (next key time - key time), set by prepare()
         foundation::Transformd          m_transform;
 
         bool operator<(const TransformKey& rhs) const
@@ -144,7 +153,14 @@ class APPLESEED_DLLSYMBOL TransformSequence
 
     void copy_from(const TransformSequence& rhs);
 
+    size_t find_segment(const float time) const;
+
+    void interpolate(
+        const float                     time,
+        foundation::Transformd&         result) const;
+
     void interpolate(
+        const size_t                    segment,
         const float                     time,
         foundation::Transformd&         result) const;
 
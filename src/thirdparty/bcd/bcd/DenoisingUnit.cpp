@@ -14,6 +14,15 @@
 #include "Denoiser.h"
 #include "DenoisingUnit.h"
 
+// x86 intrinsics headers.
+#if defined APPLESEED_USE_SSE
+#if defined _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
 // Standard headers.
 #include <cassert>
 
@@ -31,6 +40,24 @@ const size_t g_yz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_yz);
 const size_t g_xz = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xz);
 const size_t g_xy = static_cast<size_t>(ESymmetricMatrix3x3Data::e_xy);
 
+namespace
+{
+#if defined APPLESEED_USE_SSE
+    inline float horizontalSum(const __m128 i_value)
+    {
+        const __m128 pairs = _mm_add_ps(i_value, _mm_movehl_ps(i_value, i_value));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1))));
+    }
+#endif
+
+#if defined APPLESEED_USE_AVX
+    inline float horizontalSum(const __m256 i_value)
+    {
+        return horizontalSum(_mm_add_ps(_mm256_castps256_ps128(i_value), _mm256_extractf128_ps(i_value, 1)));
+    }
+#endif
+}
+
 DenoisingUnit::DenoisingUnit(Denoiser& i_rDenoiser, const int i_threadIndex)
   : m_rDenoiser(i_rDenoiser)
   , m_width(i_rDenoiser.getImagesWidth())
@@ -159,11 +186,21 @@ float DenoisingUnit::histogramPatchDistance(
     PixPatchIt pixPatch1ItEnd = pixPatch1.end();
     int totalNbOfNonBoth0Bins = 0;
     int nbOfNonBoth0Bins = 0;
+    size_t nbOfRemainingPixels = m_nbOfPixelsInPatch;
 
     for (; pixPatch1It != pixPatch1ItEnd; ++pixPatch1It, ++pixPatch2It)
     {
         summedDistance += pixelSummedHistogramDistance(nbOfNonBoth0Bins, *pixPatch1It, *pixPatch2It);
         totalNbOfNonBoth0Bins += nbOfNonBoth0Bins;
+        --nbOfRemainingPixels;
+
+        // Since distances are positive, the final distance is at least the distance summed so far
+        // divided by the largest possible number of non-empty bins. Stop as soon as that lower
+        // bound exceeds the threshold: the patches will not be considered similar anyway.
+        const size_t maxTotalNbOfNonBoth0Bins =
+            static_cast<size_t>(totalNbOfNonBoth0Bins) + nbOfRemainingPixels * m_nbOfBins;
+        if (summedDistance > m_histogramDistanceThreshold * maxTotalNbOfNonBoth0Bins)
+            return numeric_limits<float>::max();
     }
 
     // If the histograms have no bins in common, don't consider them close.
@@ -186,8 +223,80 @@ float DenoisingUnit::pixelSummedHistogramDistance(
     float nbOfSamples2 = m_pNbOfSamplesImage->get(i_rPixel2, 0);
 
     float sum = 0.0f;
+    size_t binIndex = 0;
+
+    // The vectorized loops compute the same terms as the scalar loop below, only
+    // the order in which they are summed differs. Bins that are not summed are
+    // masked out after the division, which may divide by zero.
+
+#if defined APPLESEED_USE_AVX
+    {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 nbOfSamples1x8 = _mm256_set1_ps(nbOfSamples1);
+        const __m256 nbOfSamples2x8 = _mm256_set1_ps(nbOfSamples2);
+        const __m256 nbOfSamplesProductx8 = _mm256_set1_ps(nbOfSamples1 * nbOfSamples2);
+        __m256 sumx8 = _mm256_setzero_ps();
+        __m256 countx8 = _mm256_setzero_ps();
+
+        for (; binIndex + 8 <= m_nbOfBins; binIndex += 8)
+        {
+            const __m256 binValue1 = _mm256_loadu_ps(pHistogram1Val + binIndex);
+            const __m256 binValue2 = _mm256_loadu_ps(pHistogram2Val + binIndex);
+            const __m256 binValueSum = _mm256_add_ps(binValue1, binValue2);
+            const __m256 mask = _mm256_cmp_ps(binValueSum, one, _CMP_NLE_UQ);
+            const __m256 diff =
+                _mm256_sub_ps(
+                    _mm256_mul_ps(nbOfSamples2x8, binValue1),
+                    _mm256_mul_ps(nbOfSamples1x8, binValue2));
+            const __m256 term =
+                _mm256_div_ps(
+                    _mm256_mul_ps(diff, diff),
+                    _mm256_mul_ps(nbOfSamplesProductx8, binValueSum));
+            sumx8 = _mm256_add_ps(sumx8, _mm256_and_ps(mask, term));
+            countx8 = _mm256_add_ps(countx8, _mm256_and_ps(mask, one));
+        }
+
+        sum += horizontalSum(sumx8);
+        i_rNbOfNonBoth0Bins += static_cast<int>(horizontalSum(countx8));
+    }
+#endif
+
+#if defined APPLESEED_USE_SSE
+    {
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 nbOfSamples1x4 = _mm_set1_ps(nbOfSamples1);
+        const __m128 nbOfSamples2x4 = _mm_set1_ps(nbOfSamples2);
+        const __m128 nbOfSamplesProductx4 = _mm_set1_ps(nbOfSamples1 * nbOfSamples2);
+        __m128 sumx4 = _mm_setzero_ps();
+        __m128 countx4 = _mm_setzero_ps();
+
+        for (; binIndex + 4 <= m_nbOfBins; binIndex += 4)
+        {
+            const __m128 binValue1 = _mm_loadu_ps(pHistogram1Val + binIndex);
+            const __m128 binValue2 = _mm_loadu_ps(pHistogram2Val + binIndex);
+            const __m128 binValueSum = _mm_add_ps(binValue1, binValue2);
+            const __m128 mask = _mm_cmpnle_ps(binValueSum, one);
+            const __m128 diff =
+                _mm_sub_ps(
+                    _mm_mul_ps(nbOfSamples2x4, binValue1),
+                    _mm_mul_ps(nbOfSamples1x4, binValue2));
+            const __m128 term =
+                _mm_div_ps(
+                    _mm_mul_ps(diff, diff),
+                    _mm_mul_ps(nbOfSamplesProductx4, binValueSum));
+            sumx4 = _mm_add_ps(sumx4, _mm_and_ps(mask, term));
+            countx4 = _mm_add_ps(countx4, _mm_and_ps(mask, one));
+        }
+
+        sum += horizontalSum(sumx4);
+        i_rNbOfNonBoth0Bins += static_cast<int>(horizontalSum(countx4));
+    }
+#endif
+
+    pHistogram1Val += binIndex;
+    pHistogram2Val += binIndex;
 
-    for (int binIndex = 0; binIndex < m_nbOfBins; ++binIndex)
+    for (; binIndex < m_nbOfBins; ++binIndex)
     {
         const float binValue1 = *pHistogram1Val++;
         const float binValue2 = *pHistogram2Val++;
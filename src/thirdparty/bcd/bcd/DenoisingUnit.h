@@ -40,6 +40,8 @@ class DenoisingUnit
   private:
     void selectSimilarPatches();
 
+    // Return the histogram distance between two patches, or the largest float
+    // as soon as the distance is known to exceed the histogram distance threshold.
     float histogramPatchDistance(
         const PixelPosition&                i_rPatchCenter1,
         const PixelPosition&                i_rPatchCenter2);
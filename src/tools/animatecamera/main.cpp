@@ -28,10 +28,10 @@
 //
 
 // animatecamera headers.
-#include "animationpath.h"
 #include "commandlinehandler.h"
 
 // appleseed.shared headers.
+#include "application/animationpath.h"
 #include "application/application.h"
 #include "application/superlogger.h"
 
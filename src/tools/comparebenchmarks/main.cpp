@@ -0,0 +1,312 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// comparebenchmarks headers.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/application.h"
+#include "application/superlogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/math/population.h"
+#include "foundation/utility/benchmark/timingresult.h"
+#include "foundation/utility/benchmark/xmlfilebenchmarkreader.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/filter.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+using namespace appleseed::comparebenchmarks;
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace std;
+
+namespace
+{
+    //
+    // Statistics of the running time of a benchmark case, in seconds.
+    //
+
+    struct RunningTime
+    {
+        double  m_mean;
+        double  m_variance_of_mean;
+
+        explicit RunningTime(const TimingResult& timing_result)
+        {
+            // Timer frequencies may differ between runs: compare times, not ticks.
+            const double rcp_frequency = 1.0 / timing_result.m_frequency;
+
+            if (timing_result.m_samples.size() >= 2)
+            {
+                Population<double> samples;
+
+                for (size_t i = 0; i < timing_result.m_samples.size(); ++i)
+                    samples.insert(timing_result.m_samples[i] * rcp_frequency);
+
+                const double dev = samples.get_dev();
+
+                m_mean = samples.get_mean();
+                m_variance_of_mean = dev * dev / samples.get_size();
+            }
+            else
+            {
+                // Files written before individual measurements were recorded.
+                m_mean = timing_result.m_ticks * rcp_frequency;
+                m_variance_of_mean = 0.0;
+            }
+        }
+    };
+
+    //
+    // Comparison of the running times of a benchmark case between two runs.
+    //
+
+    struct Comparison
+    {
+        enum Verdict { Unchanged, Faster, Slower };
+
+        double  m_speedup;          // baseline time / candidate time
+        double  m_speedup_low;      // lower bound of the 95% confidence interval of the speedup
+        double  m_speedup_high;     // upper bound of the 95% confidence interval of the speedup
+        Verdict m_verdict;
+
+        Comparison(
+            const RunningTime&  baseline,
+            const RunningTime&  candidate,
+            const double        threshold)
+        {
+            m_speedup = baseline.m_mean / candidate.m_mean;
+
+            // Delta method: the log of a ratio of independent means is approximately normal,
+            // with variance the sum of the squared coefficients of variation of the means.
+            const double log_speedup_dev =
+                sqrt(
+                    baseline.m_variance_of_mean / (baseline.m_mean * baseline.m_mean) +
+                    candidate.m_variance_of_mean / (candidate.m_mean * candidate.m_mean));
+            const double Z95 = 1.96;
+            m_speedup_low = m_speedup * exp(-Z95 * log_speedup_dev);
+            m_speedup_high = m_speedup * exp(+Z95 * log_speedup_dev);
+
+            // Only report changes that are both significant and larger than the threshold.
+            if (m_speedup_low > 1.0 && m_speedup > 1.0 + threshold)
+                m_verdict = Faster;
+            else if (m_speedup_high < 1.0 && 1.0 / m_speedup > 1.0 + threshold)
+                m_verdict = Slower;
+            else m_verdict = Unchanged;
+        }
+    };
+
+    string pretty_duration(const double seconds)
+    {
+        if (seconds < 1.0e-6)
+            return pretty_scalar(seconds * 1.0e9, 1) + " ns";
+        else if (seconds < 1.0e-3)
+            return pretty_scalar(seconds * 1.0e6, 1) + " us";
+        else if (seconds < 1.0)
+            return pretty_scalar(seconds * 1.0e3, 1) + " ms";
+        else return pretty_scalar(seconds, 2) + " s";
+    }
+
+    bool read_benchmark_file(
+        XMLFileBenchmarkReader&     reader,
+        const string&               filepath,
+        SuperLogger&                logger)
+    {
+        if (!reader.read(filepath.c_str()))
+        {
+            LOG_ERROR(logger, "failed to read benchmark results file %s.", filepath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    // Compare two benchmark results files. Return the number of regressions.
+    size_t compare_benchmarks(
+        const XMLFileBenchmarkReader&   baseline,
+        const XMLFileBenchmarkReader&   candidate,
+        const IFilter&                  filter,
+        const double                    threshold,
+        SuperLogger&                    logger)
+    {
+        if (strcmp(baseline.get_configuration(), candidate.get_configuration()) != 0)
+        {
+            LOG_WARNING(
+                logger,
+                "comparing benchmark results of different build configurations (%s and %s).",
+                baseline.get_configuration(),
+                candidate.get_configuration());
+        }
+
+        size_t compared_count = 0;
+        size_t faster_count = 0;
+        size_t slower_count = 0;
+
+        for (size_t i = 0; i < candidate.get_case_count(); ++i)
+        {
+            const char* suite_name = candidate.get_suite_name(i);
+            const char* case_name = candidate.get_case_name(i);
+            const string full_name = string(suite_name) + "::" + case_name;
+
+            if (!filter.accepts(full_name.c_str()))
+                continue;
+
+            const size_t baseline_index = baseline.find_case(suite_name, case_name);
+
+            if (baseline_index == ~size_t(0))
+            {
+                LOG_INFO(logger, "%s: new benchmark case.", full_name.c_str());
+                continue;
+            }
+
+            const RunningTime baseline_time(baseline.get_timing_result(baseline_index));
+            const RunningTime candidate_time(candidate.get_timing_result(i));
+
+            if (baseline_time.m_mean <= 0.0 || candidate_time.m_mean <= 0.0)
+            {
+                LOG_WARNING(logger, "%s: running time too short to be compared.", full_name.c_str());
+                continue;
+            }
+
+            const Comparison comparison(baseline_time, candidate_time, threshold);
+
+            ++compared_count;
+
+            const string message =
+                full_name + ": " +
+                pretty_duration(baseline_time.m_mean) + " -> " +
+                pretty_duration(candidate_time.m_mean) + ", speedup x" +
+                pretty_scalar(comparison.m_speedup, 3) + " (95% confidence interval: x" +
+                pretty_scalar(comparison.m_speedup_low, 3) + " to x" +
+                pretty_scalar(comparison.m_speedup_high, 3) + ")";
+
+            switch (comparison.m_verdict)
+            {
+              case Comparison::Faster:
+                LOG_INFO(logger, "%s: faster.", message.c_str());
+                ++faster_count;
+                break;
+
+              case Comparison::Slower:
+                LOG_WARNING(logger, "%s: slower.", message.c_str());
+                ++slower_count;
+                break;
+
+              default:
+                LOG_DEBUG(logger, "%s: unchanged.", message.c_str());
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < baseline.get_case_count(); ++i)
+        {
+            const char* suite_name = baseline.get_suite_name(i);
+            const char* case_name = baseline.get_case_name(i);
+            const string full_name = string(suite_name) + "::" + case_name;
+
+            if (filter.accepts(full_name.c_str()) &&
+                candidate.find_case(suite_name, case_name) == ~size_t(0))
+                LOG_INFO(logger, "%s: missing from the candidate results.", full_name.c_str());
+        }
+
+        LOG_INFO(
+            logger,
+            "compared %s benchmark case%s: %s faster, %s slower, %s unchanged.",
+            pretty_uint(compared_count).c_str(),
+            compared_count > 1 ? "s" : "",
+            pretty_uint(faster_count).c_str(),
+            pretty_uint(slower_count).c_str(),
+            pretty_uint(compared_count - faster_count - slower_count).c_str());
+
+        return slower_count;
+    }
+}
+
+
+//
+// Entry point of comparebenchmarks.
+//
+// Returns 0 if no benchmark case got significantly slower, 1 otherwise,
+// so that the tool can be used to gate builds on performance.
+//
+
+int main(int argc, char* argv[])
+{
+    // Construct the logger that will be used throughout the program.
+    SuperLogger logger;
+
+    // Make sure this build can run on this host.
+    Application::check_compatibility_with_host(logger);
+
+    // Make sure appleseed is correctly installed.
+    Application::check_installation(logger);
+
+    // Parse the command line.
+    CommandLineHandler cl;
+    cl.parse(argc, argv, logger);
+
+    // Load an apply settings from the settings file.
+    Dictionary settings;
+    Application::load_settings("appleseed.tools.xml", settings, logger);
+    logger.configure_from_settings(settings);
+
+    // Apply command line arguments.
+    cl.apply(logger);
+
+    // Retrieve the command line arguments.
+    const string& baseline_filepath = cl.m_filenames.values()[0];
+    const string& candidate_filepath = cl.m_filenames.values()[1];
+    const double threshold = cl.m_threshold.value() / 100.0;
+    const RegExFilter filter(cl.m_filter.value().c_str());
+
+    if (!filter.is_valid())
+    {
+        LOG_ERROR(logger, "invalid regular expression: %s.", cl.m_filter.value().c_str());
+        return 1;
+    }
+
+    // Read the benchmark results files.
+    XMLFileBenchmarkReader baseline, candidate;
+    if (!read_benchmark_file(baseline, baseline_filepath, logger) ||
+        !read_benchmark_file(candidate, candidate_filepath, logger))
+        return 1;
+
+    // Compare them.
+    const size_t regression_count =
+        compare_benchmarks(baseline, candidate, filter, threshold, logger);
+
+    return regression_count > 0 ? 1 : 0;
+}
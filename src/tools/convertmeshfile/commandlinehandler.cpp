@@ -50,13 +50,44 @@ CommandLineHandler::CommandLineHandler()
 
     parser().set_default_option_handler(
         &m_filenames
-            .set_exact_value_count(2));
+            .set_min_value_count(1));
 
     parser().add_option_handler(
         &m_print_bboxes
             .add_name("--print-bounding-boxes")
             .add_name("-b")
             .set_description("print mesh bounding boxes"));
+
+    parser().add_option_handler(
+        &m_memory_mappable
+            .add_name("--memory-mappable")
+            .add_name("-m")
+            .set_description("write binarymesh files in the uncompressed, memory-mappable format"));
+
+    parser().add_option_handler(
+        &m_output_directory
+            .add_name("--output-directory")
+            .add_name("-o")
+            .set_description("convert all input files, directories and wildcard patterns into this directory")
+            .set_syntax("directory")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_output_format
+            .add_name("--output-format")
+            .add_name("-f")
+            .set_description("set the format of the files written to the output directory: binarymesh or obj")
+            .set_syntax("format")
+            .set_exact_value_count(1)
+            .set_default_value("binarymesh"));
+
+    parser().add_option_handler(
+        &m_threads
+            .add_name("--threads")
+            .add_name("-j")
+            .set_description("set the number of files converted in parallel (default is one per logical core)")
+            .set_syntax("count")
+            .set_exact_value_count(1));
 }
 
 void CommandLineHandler::print_program_usage(
@@ -68,6 +99,7 @@ void CommandLineHandler::print_program_usage(
     logger.set_format(LogMessage::Info, "{message}");
 
     LOG_INFO(logger, "usage: %s [options] input-file output-file", executable_name);
+    LOG_INFO(logger, "       %s [options] --output-directory directory input...", executable_name);
     LOG_INFO(logger, "options:");
 
     parser().print_usage(logger);
@@ -54,6 +54,10 @@ class CommandLineHandler
   public:
     foundation::ValueOptionHandler<std::string> m_filenames;
     foundation::FlagOptionHandler               m_print_bboxes;
+    foundation::FlagOptionHandler               m_memory_mappable;
+    foundation::ValueOptionHandler<std::string> m_output_directory;
+    foundation::ValueOptionHandler<std::string> m_output_format;
+    foundation::ValueOptionHandler<int>         m_threads;
 
     // Constructor.
     CommandLineHandler();
@@ -37,17 +37,29 @@
 // appleseed.foundation headers.
 #include "foundation/math/aabb.h"
 #include "foundation/math/vector.h"
+#include "foundation/mesh/binarymeshfilewriter.h"
 #include "foundation/mesh/genericmeshfilereader.h"
 #include "foundation/mesh/genericmeshfilewriter.h"
 #include "foundation/mesh/imeshbuilder.h"
 #include "foundation/mesh/imeshwalker.h"
+#include "foundation/mesh/objmeshfilereader.h"
 #include "foundation/platform/compiler.h"
+#include "foundation/platform/system.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/filter.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
 #include "foundation/utility/log.h"
+#include "foundation/utility/string.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <deque>
 #include <exception>
 #include <list>
@@ -58,6 +70,7 @@ using namespace appleseed::convertmeshfile;
 using namespace appleseed::shared;
 using namespace foundation;
 using namespace std;
+namespace bf = boost::filesystem;
 
 namespace
 {
@@ -269,6 +282,324 @@ namespace
             bbox.min[0], bbox.min[1], bbox.min[2],
             bbox.max[0], bbox.max[1], bbox.max[2]);
     }
+
+    bool convert_mesh_file(
+        const string&               input_filepath,
+        const string&               output_filepath,
+        const int                   obj_options,
+        const bool                  print_bboxes,
+        const bool                  memory_mappable,
+        Logger&                     logger)
+    {
+        // Read the input mesh file.
+        MeshBuilder builder;
+        try
+        {
+            GenericMeshFileReader reader(input_filepath.c_str());
+            reader.set_obj_options(obj_options);
+            reader.read(builder);
+        }
+        catch (const exception& e)
+        {
+            LOG_ERROR(
+                logger,
+                "could not read mesh file %s (%s).",
+                input_filepath.c_str(),
+                e.what());
+            return false;
+        }
+
+        // Print a warning message and exit if no mesh were defined in the input file.
+        if (builder.get_meshes().empty())
+        {
+            LOG_WARNING(logger, "no mesh defined in %s.", input_filepath.c_str());
+            return true;
+        }
+
+        // Optionally print the bounding box of each loaded mesh.
+        if (print_bboxes)
+        {
+            for (const_each<list<Mesh>> i = builder.get_meshes(); i; ++i)
+                print_bbox(logger, *i);
+        }
+
+        // Write the output mesh file.
+        GenericMeshFileWriter writer(
+            output_filepath.c_str(),
+            memory_mappable ? BinaryMeshFileWriter::MemoryMappable : BinaryMeshFileWriter::Default);
+        try
+        {
+            for (const_each<list<Mesh>> i = builder.get_meshes(); i; ++i)
+            {
+                const MeshWalker walker(*i);
+                writer.write(walker);
+            }
+        }
+        catch (const exception& e)
+        {
+            LOG_ERROR(
+                logger,
+                "could not write mesh file %s (%s).",
+                output_filepath.c_str(),
+                e.what());
+            return false;
+        }
+
+        return true;
+    }
+
+
+    //
+    // Batch conversion.
+    //
+
+    struct Conversion
+    {
+        string  m_input_path;
+        string  m_output_path;
+        bool    m_success;
+    };
+
+    class ConvertMeshFileJob
+      : public IJob
+    {
+      public:
+        ConvertMeshFileJob(
+            const CommandLineHandler&   cl,
+            Conversion&                 conversion,
+            Logger&                     logger)
+          : m_cl(cl)
+          , m_conversion(conversion)
+          , m_logger(logger)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            // Parallelism is over files: don't parse each OBJ file on multiple threads.
+            m_conversion.m_success =
+                convert_mesh_file(
+                    m_conversion.m_input_path,
+                    m_conversion.m_output_path,
+                    OBJMeshFileReader::Default,
+                    m_cl.m_print_bboxes.is_set(),
+                    m_cl.m_memory_mappable.is_set(),
+                    m_logger);
+        }
+
+      private:
+        const CommandLineHandler&       m_cl;
+        Conversion&                     m_conversion;
+        Logger&                         m_logger;
+    };
+
+    bool is_mesh_file(const bf::path& path)
+    {
+        const string extension = lower_case(path.extension().string());
+        return extension == ".obj" || extension == ".binarymesh";
+    }
+
+    bool is_wildcard_pattern(const string& s)
+    {
+        return s.find_first_of("*?") != string::npos;
+    }
+
+    // Convert a wildcard pattern such as *.obj to an anchored regular expression.
+    string wildcard_pattern_to_regex(const string& pattern)
+    {
+        string regex = "^";
+
+        for (const char c : pattern)
+        {
+            if (c == '*')
+                regex += ".*";
+            else if (c == '?')
+                regex += '.';
+            else
+            {
+                if (strchr("\\^$.|+()[]{}", c) != nullptr)
+                    regex += '\\';
+                regex += c;
+            }
+        }
+
+        regex += '$';
+
+        return regex;
+    }
+
+    void add_conversion(
+        const bf::path&             input_path,
+        const bf::path&             output_path,
+        const string&               output_format,
+        vector<Conversion>&         conversions)
+    {
+        Conversion conversion;
+        conversion.m_input_path = input_path.string();
+        conversion.m_output_path = bf::path(output_path).replace_extension(output_format).string();
+        conversion.m_success = false;
+        conversions.push_back(conversion);
+    }
+
+    // Collect the mesh files of a directory and its subdirectories,
+    // preserving the directory structure in the output directory.
+    void collect_directory_mesh_files(
+        const bf::path&             directory,
+        const bf::path&             output_directory,
+        const string&               output_format,
+        vector<Conversion>&         conversions)
+    {
+        const string directory_string = directory.string();
+
+        for (bf::recursive_directory_iterator i(directory), e; i != e; ++i)
+        {
+            const bf::path& path = i->path();
+
+            if (!bf::is_regular_file(path) || !is_mesh_file(path))
+                continue;
+
+            string relative_path = path.string().substr(directory_string.size());
+            while (!relative_path.empty() && (relative_path[0] == '/' || relative_path[0] == '\\'))
+                relative_path.erase(0, 1);
+
+            add_conversion(path, output_directory / relative_path, output_format, conversions);
+        }
+    }
+
+    // Collect the files of a directory whose names match a wildcard pattern.
+    void collect_matching_mesh_files(
+        const bf::path&             pattern,
+        const bf::path&             output_directory,
+        const string&               output_format,
+        vector<Conversion>&         conversions)
+    {
+        const bf::path directory =
+            pattern.has_parent_path() ? pattern.parent_path() : bf::path(".");
+
+        if (!bf::is_directory(directory))
+            return;
+
+        const RegExFilter filter(wildcard_pattern_to_regex(pattern.filename().string()).c_str());
+        vector<bf::path> paths;
+
+        for (bf::directory_iterator i(directory), e; i != e; ++i)
+        {
+            const bf::path& path = i->path();
+
+            if (bf::is_regular_file(path) && filter.accepts(path.filename().string().c_str()))
+                paths.push_back(path);
+        }
+
+        // Directory iteration order is unspecified.
+        sort(paths.begin(), paths.end());
+
+        for (const bf::path& path : paths)
+            add_conversion(path, output_directory / path.filename(), output_format, conversions);
+    }
+
+    int convert_batch(
+        const CommandLineHandler&   cl,
+        Logger&                     logger)
+    {
+        const string output_format = lower_case(cl.m_output_format.value());
+        if (output_format != "binarymesh" && output_format != "obj")
+        {
+            LOG_ERROR(logger, "invalid output format: %s.", cl.m_output_format.value().c_str());
+            return 1;
+        }
+
+        const size_t thread_count =
+            cl.m_threads.is_set() && cl.m_threads.value() > 0
+                ? static_cast<size_t>(cl.m_threads.value())
+                : System::get_logical_cpu_core_count();
+
+        const bf::path output_directory(cl.m_output_directory.value());
+
+        // Collect the files to convert.
+        vector<Conversion> conversions;
+        bool success = true;
+
+        for (const string& input : cl.m_filenames.values())
+        {
+            const bf::path input_path(input);
+
+            if (is_wildcard_pattern(input_path.filename().string()))
+            {
+                const size_t previous_count = conversions.size();
+                collect_matching_mesh_files(input_path, output_directory, output_format, conversions);
+                if (conversions.size() == previous_count)
+                    LOG_WARNING(logger, "no file matches %s.", input.c_str());
+            }
+            else if (bf::is_directory(input_path))
+                collect_directory_mesh_files(input_path, output_directory, output_format, conversions);
+            else if (bf::is_regular_file(input_path))
+                add_conversion(input_path, output_directory / input_path.filename(), output_format, conversions);
+            else
+            {
+                LOG_ERROR(logger, "%s does not exist.", input.c_str());
+                success = false;
+            }
+        }
+
+        // Create the output directories upfront so that jobs only have to write files.
+        for (const Conversion& conversion : conversions)
+        {
+            try
+            {
+                bf::create_directories(bf::path(conversion.m_output_path).parent_path());
+            }
+            catch (const bf::filesystem_error& e)
+            {
+                LOG_ERROR(logger, "could not create directory: %s.", e.what());
+                return 1;
+            }
+        }
+
+        LOG_INFO(
+            logger,
+            "converting %s mesh file%s using %s thread%s...",
+            pretty_uint(conversions.size()).c_str(),
+            conversions.size() > 1 ? "s" : "",
+            pretty_uint(thread_count).c_str(),
+            thread_count > 1 ? "s" : "");
+
+        // Convert the files in parallel.
+        {
+            JobQueue job_queue;
+            JobManager job_manager(
+                logger,
+                job_queue,
+                thread_count,
+                JobManager::KeepRunningOnJobFailure);
+
+            for (Conversion& conversion : conversions)
+                job_queue.schedule(new ConvertMeshFileJob(cl, conversion, logger));
+
+            job_manager.start();
+            job_queue.wait_until_completion();
+        }
+
+        // Report the outcome of the conversions.
+        size_t failed_count = 0;
+
+        for (const Conversion& conversion : conversions)
+        {
+            if (!conversion.m_success)
+                ++failed_count;
+        }
+
+        const size_t converted_count = conversions.size() - failed_count;
+
+        LOG_INFO(
+            logger,
+            "converted %s mesh file%s, %s failure%s.",
+            pretty_uint(converted_count).c_str(),
+            converted_count > 1 ? "s" : "",
+            pretty_uint(failed_count).c_str(),
+            failed_count > 1 ? "s" : "");
+
+        return success && failed_count == 0 ? 0 : 1;
+    }
 }
 
 
@@ -299,58 +630,27 @@ int main(int argc, char* argv[])
     // Apply command line arguments.
     cl.apply(logger);
 
-    // Retrieve the input and output file paths.
-    const string& input_filepath = cl.m_filenames.values()[0];
-    const string& output_filepath = cl.m_filenames.values()[1];
+    // Convert multiple files into an output directory.
+    if (cl.m_output_directory.is_set())
+        return convert_batch(cl, logger);
 
-    // Read the input mesh file.
-    MeshBuilder builder;
-    try
-    {
-        GenericMeshFileReader reader(input_filepath.c_str());
-        reader.read(builder);
-    }
-    catch (const exception& e)
-    {
-        LOG_FATAL(
-            logger,
-            "could not read mesh file %s (%s).",
-            input_filepath.c_str(),
-            e.what());
-    }
-
-    // Print a warning message and exit if no mesh were defined in the input file.
-    if (builder.get_meshes().empty())
-    {
-        LOG_WARNING(logger, "no mesh defined.");
-        return 0;
-    }
-
-    // Optionally print the bounding box of each loaded mesh.
-    if (cl.m_print_bboxes.is_set())
+    // Retrieve the input and output file paths.
+    if (cl.m_filenames.values().size() != 2)
     {
-        for (const_each<list<Mesh>> i = builder.get_meshes(); i; ++i)
-            print_bbox(logger, *i);
+        LOG_ERROR(logger, "expected an input file and an output file, or the --output-directory option.");
+        return 1;
     }
 
-    // Write the output mesh file.
-    GenericMeshFileWriter writer(output_filepath.c_str());
-    try
-    {
-        for (const_each<list<Mesh>> i = builder.get_meshes(); i; ++i)
-        {
-            const MeshWalker walker(*i);
-            writer.write(walker);
-        }
-    }
-    catch (const exception& e)
-    {
-        LOG_FATAL(
-            logger,
-            "could not write mesh file %s (%s).",
-            output_filepath.c_str(),
-            e.what());
-    }
+    const string& input_filepath = cl.m_filenames.values()[0];
+    const string& output_filepath = cl.m_filenames.values()[1];
 
-    return 0;
+    // Convert the file, parsing OBJ files on all available cores.
+    return
+        convert_mesh_file(
+            input_filepath,
+            output_filepath,
+            OBJMeshFileReader::ParallelParsing,
+            cl.m_print_bboxes.is_set(),
+            cl.m_memory_mappable.is_set(),
+            logger) ? 0 : 1;
 }
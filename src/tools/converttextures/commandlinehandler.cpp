@@ -0,0 +1,106 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2018 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// Interface header.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/superlogger.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/log.h"
+
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace std;
+
+namespace appleseed {
+namespace converttextures {
+
+CommandLineHandler::CommandLineHandler()
+  : CommandLineHandlerBase("converttextures")
+{
+    add_default_options();
+
+    parser().set_default_option_handler(
+        &m_inputs
+            .set_min_value_count(1));
+
+    parser().add_option_handler(
+        &m_format
+            .add_name("--format")
+            .add_name("-f")
+            .set_description("set the format of the converted textures (default is exr)")
+            .set_syntax("exr|tiff")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_tile_size
+            .add_name("--tile-size")
+            .add_name("-t")
+            .set_description("set the width and height of the tiles in pixels (default is 64)")
+            .set_syntax("size")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_threads
+            .add_name("--threads")
+            .add_name("-j")
+            .set_description("set the number of textures converted in parallel (default is one per logical core)")
+            .set_syntax("count")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_force
+            .add_name("--force")
+            .add_name("-F")
+            .set_description("convert textures even if the converted files are up-to-date"));
+
+    parser().add_option_handler(
+        &m_rewrite_projects
+            .add_name("--rewrite-projects")
+            .add_name("-r")
+            .set_description("make the textures of the input projects point to the converted files"));
+}
+
+void CommandLineHandler::print_program_usage(
+    const char*     executable_name,
+    SuperLogger&    logger) const
+{
+    SaveLogFormatterConfig save_config(logger);
+    logger.set_verbosity_level(LogMessage::Info);
+    logger.set_format(LogMessage::Info, "{message}");
+
+    LOG_INFO(logger, "usage: %s [options] file|directory|project.appleseed...", executable_name);
+    LOG_INFO(logger, "options:");
+
+    parser().print_usage(logger);
+}
+
+}   // namespace converttextures
+}   // namespace appleseed
@@ -0,0 +1,629 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2010-2013 Francois Beaune, Jupiter Jazz Limited
+// Copyright (c) 2014-2018 Francois Beaune, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+// converttextures headers.
+#include "commandlinehandler.h"
+
+// appleseed.shared headers.
+#include "application/application.h"
+#include "application/superlogger.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/project.h"
+#include "renderer/api/scene.h"
+#include "renderer/api/texture.h"
+
+// appleseed.foundation headers.
+#include "foundation/platform/system.h"
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/log.h"
+#include "foundation/utility/murmurhash.h"
+#include "foundation/utility/searchpaths.h"
+#include "foundation/utility/string.h"
+
+// OpenImageIO headers.
+#include "foundation/platform/_beginoiioheaders.h"
+#include "OpenImageIO/imagebufalgo.h"
+#include "OpenImageIO/imageio.h"
+#include "foundation/platform/_endoiioheaders.h"
+
+// Boost headers.
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
+// Standard headers.
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace appleseed::converttextures;
+using namespace appleseed::shared;
+using namespace foundation;
+using namespace renderer;
+using namespace std;
+namespace bf = boost::filesystem;
+
+namespace
+{
+    CommandLineHandler g_cl;
+
+    struct ConversionSettings
+    {
+        bool        m_tiff;                 // write tiled TIFF files instead of tiled OpenEXR files
+        int         m_tile_size;
+        bool        m_force;
+    };
+
+    //
+    // A texture to convert and the outcome of its conversion.
+    //
+    // Converted files are written next to their source files. The content hash of the
+    // source file and the conversion settings are stored in a small file next to the
+    // converted file, so that textures are only converted again when they change.
+    //
+
+    struct Conversion
+    {
+        enum Status
+        {
+            Pending,
+            Converted,
+            UpToDate,
+            Failed
+        };
+
+        string      m_source_path;
+        string      m_output_path;
+        Status      m_status;
+        string      m_error;
+    };
+
+    // Return the suffix that replaces the extension of converted textures.
+    const char* get_output_suffix(const ConversionSettings& settings)
+    {
+        return settings.m_tiff ? ".tx" : ".tx.exr";
+    }
+
+    bool is_converted_texture(const bf::path& path)
+    {
+        const string filename = lower_case(path.filename().string());
+        return ends_with(filename, ".tx") || ends_with(filename, ".tx.exr");
+    }
+
+    bool is_source_texture(const bf::path& path)
+    {
+        static const char* Extensions[] =
+        {
+            ".bmp", ".exr", ".hdr", ".jpeg", ".jpg", ".png", ".tga", ".tif", ".tiff"
+        };
+
+        if (is_converted_texture(path))
+            return false;
+
+        const string extension = lower_case(path.extension().string());
+
+        for (const char* e : Extensions)
+        {
+            if (extension == e)
+                return true;
+        }
+
+        return false;
+    }
+
+    string make_output_path(const string& source_path, const ConversionSettings& settings)
+    {
+        return bf::path(source_path).replace_extension(get_output_suffix(settings)).string();
+    }
+
+    string make_hash_path(const string& output_path)
+    {
+        return output_path + ".hash";
+    }
+
+    // Hash the content of a source file and the settings it is converted with.
+    bool compute_content_hash(
+        const string&               source_path,
+        const ConversionSettings&   settings,
+        string&                     hash)
+    {
+        ifstream file(source_path.c_str(), ios::in | ios::binary);
+        if (!file.is_open())
+            return false;
+
+        MurmurHash murmur;
+        murmur.append(settings.m_tiff);
+        murmur.append(settings.m_tile_size);
+
+        vector<char> buffer(1024 * 1024);
+
+        while (file)
+        {
+            file.read(&buffer[0], buffer.size());
+
+            const size_t read_size = static_cast<size_t>(file.gcount());
+            if (read_size > 0)
+                murmur.append(string(&buffer[0], read_size));
+        }
+
+        if (file.bad())
+            return false;
+
+        hash = murmur.to_string();
+        return true;
+    }
+
+    bool read_stored_hash(const string& output_path, string& hash)
+    {
+        ifstream file(make_hash_path(output_path).c_str());
+        return static_cast<bool>(file >> hash);
+    }
+
+    bool write_stored_hash(const string& output_path, const string& hash)
+    {
+        ofstream file(make_hash_path(output_path).c_str());
+        return static_cast<bool>(file << hash << endl);
+    }
+
+    //
+    // Job converting one texture to a tiled, mip-mapped texture.
+    //
+
+    class ConvertTextureJob
+      : public IJob
+    {
+      public:
+        ConvertTextureJob(
+            const ConversionSettings&   settings,
+            Conversion&                 conversion,
+            Logger&                     logger)
+          : m_settings(settings)
+          , m_conversion(conversion)
+          , m_logger(logger)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            string hash;
+            if (!compute_content_hash(m_conversion.m_source_path, m_settings, hash))
+            {
+                fail("could not read the file");
+                return;
+            }
+
+            // Skip textures whose converted file is up-to-date.
+            string stored_hash;
+            if (!m_settings.m_force &&
+                bf::exists(m_conversion.m_output_path) &&
+                read_stored_hash(m_conversion.m_output_path, stored_hash) &&
+                stored_hash == hash)
+            {
+                m_conversion.m_status = Conversion::UpToDate;
+                return;
+            }
+
+            OIIO::ImageSpec config;
+            config.tile_width = m_settings.m_tile_size;
+            config.tile_height = m_settings.m_tile_size;
+            config.tile_depth = 1;
+            config.attribute("maketx:fileformatname", m_settings.m_tiff ? "tiff" : "openexr");
+            config.attribute("compression", "zip");
+
+            ostringstream errors;
+            if (!OIIO::ImageBufAlgo::make_texture(
+                    OIIO::ImageBufAlgo::MakeTxTexture,
+                    m_conversion.m_source_path,
+                    m_conversion.m_output_path,
+                    config,
+                    &errors))
+            {
+                fail(errors.str());
+                return;
+            }
+
+            if (!write_stored_hash(m_conversion.m_output_path, hash))
+                LOG_WARNING(m_logger, "could not write the content hash of %s.", m_conversion.m_output_path.c_str());
+
+            m_conversion.m_status = Conversion::Converted;
+
+            LOG_INFO(
+                m_logger,
+                "converted %s to %s.",
+                m_conversion.m_source_path.c_str(),
+                m_conversion.m_output_path.c_str());
+        }
+
+      private:
+        const ConversionSettings&   m_settings;
+        Conversion&                 m_conversion;
+        Logger&                     m_logger;
+
+        void fail(const string& error)
+        {
+            m_conversion.m_status = Conversion::Failed;
+            m_conversion.m_error = trim_both(error);
+        }
+    };
+
+    //
+    // The set of textures to convert, without duplicates.
+    //
+
+    class ConversionList
+    {
+      public:
+        explicit ConversionList(const ConversionSettings& settings)
+          : m_settings(settings)
+        {
+        }
+
+        // Add a texture and return its index.
+        size_t insert(const string& source_path)
+        {
+            const string key = bf::absolute(source_path).string();
+
+            const auto it = m_indices.find(key);
+            if (it != m_indices.end())
+                return it->second;
+
+            Conversion conversion;
+            conversion.m_source_path = source_path;
+            conversion.m_output_path = make_output_path(source_path, m_settings);
+            conversion.m_status = Conversion::Pending;
+
+            const size_t index = m_conversions.size();
+            m_conversions.push_back(conversion);
+            m_indices[key] = index;
+
+            return index;
+        }
+
+        vector<Conversion>& conversions()
+        {
+            return m_conversions;
+        }
+
+      private:
+        const ConversionSettings&   m_settings;
+        vector<Conversion>          m_conversions;
+        map<string, size_t>         m_indices;
+    };
+
+    //
+    // Projects whose textures are converted.
+    //
+
+    struct ProjectTexture
+    {
+        Texture*    m_texture;
+        size_t      m_conversion_index;
+    };
+
+    struct ProjectInput
+    {
+        string                      m_filepath;
+        auto_release_ptr<Project>   m_project;
+        vector<ProjectTexture>      m_textures;
+    };
+
+    bool is_project_file(const bf::path& path)
+    {
+        const string extension = lower_case(path.extension().string());
+        return extension == ".appleseed" || extension == ".appleseedz";
+    }
+
+    auto_release_ptr<Project> load_project(const string& project_filepath)
+    {
+        // Construct the schema file path.
+        const bf::path schema_filepath =
+              bf::path(Application::get_root_path())
+            / "schemas"
+            / "project.xsd";
+
+        // Read the input project from disk. Mesh files are not needed.
+        ProjectFileReader reader;
+        return
+            reader.read(
+                project_filepath.c_str(),
+                schema_filepath.string().c_str(),
+                ProjectFileReader::OmitReadingMeshFiles);
+    }
+
+    void collect_textures(
+        const BaseGroup&            base_group,
+        const SearchPaths&          search_paths,
+        ConversionList&             conversions,
+        ProjectInput&               input)
+    {
+        for (Texture& texture : base_group.textures())
+        {
+            if (strcmp(texture.get_model(), DiskTexture2dFactory().get_model()) != 0)
+                continue;
+
+            const ParamArray& params = texture.get_parameters();
+            if (!params.strings().exist("filename"))
+                continue;
+
+            const string source_path = to_string(search_paths.qualify(params.get("filename")));
+            if (!is_source_texture(source_path))
+                continue;
+
+            ProjectTexture project_texture;
+            project_texture.m_texture = &texture;
+            project_texture.m_conversion_index = conversions.insert(source_path);
+            input.m_textures.push_back(project_texture);
+        }
+
+        for (const Assembly& assembly : base_group.assemblies())
+            collect_textures(assembly, search_paths, conversions, input);
+    }
+
+    void collect_directory_textures(
+        const bf::path&             directory,
+        ConversionList&             conversions)
+    {
+        for (bf::recursive_directory_iterator i(directory), e; i != e; ++i)
+        {
+            const bf::path& path = i->path();
+
+            if (bf::is_regular_file(path) && is_source_texture(path))
+                conversions.insert(path.string());
+        }
+    }
+
+    // Make the textures of a project point to their converted files.
+    bool rewrite_project(
+        ProjectInput&               input,
+        const vector<Conversion>&   conversions,
+        const ConversionSettings&   settings,
+        Logger&                     logger)
+    {
+        size_t rewritten_count = 0;
+
+        for (const ProjectTexture& project_texture : input.m_textures)
+        {
+            const Conversion& conversion = conversions[project_texture.m_conversion_index];
+            if (conversion.m_status != Conversion::Converted &&
+                conversion.m_status != Conversion::UpToDate)
+                continue;
+
+            // Keep the path relative to the search paths of the project.
+            ParamArray& params = project_texture.m_texture->get_parameters();
+            const string filename =
+                bf::path(params.get("filename"))
+                    .replace_extension(get_output_suffix(settings))
+                    .generic_string();
+            params.insert("filename", filename);
+
+            ++rewritten_count;
+        }
+
+        if (rewritten_count == 0)
+            return true;
+
+        LOG_INFO(
+            logger,
+            "rewriting %s texture path%s in %s...",
+            pretty_uint(rewritten_count).c_str(),
+            rewritten_count > 1 ? "s" : "",
+            input.m_filepath.c_str());
+
+        return
+            ProjectFileWriter::write(
+                input.m_project.ref(),
+                input.m_filepath.c_str(),
+                ProjectFileWriter::OmitWritingGeometryFiles | ProjectFileWriter::OmitHandlingAssetFiles);
+    }
+}
+
+
+//
+// Entry point of converttextures.
+//
+
+int main(int argc, char* argv[])
+{
+    // Construct the logger that will be used throughout the program.
+    SuperLogger logger;
+
+    // Make sure this build can run on this host.
+    Application::check_compatibility_with_host(logger);
+
+    // Make sure appleseed is correctly installed.
+    Application::check_installation(logger);
+
+    // Parse the command line.
+    g_cl.parse(argc, argv, logger);
+
+    // Load an apply settings from the settings file.
+    Dictionary settings_dict;
+    Application::load_settings("appleseed.tools.xml", settings_dict, logger);
+    logger.configure_from_settings(settings_dict);
+
+    // Apply command line arguments.
+    g_cl.apply(logger);
+
+    // Configure the renderer's global logger.
+    global_logger().initialize_from(logger);
+
+    // Retrieve conversion settings.
+    ConversionSettings settings;
+    settings.m_tiff = false;
+    settings.m_tile_size = 64;
+    settings.m_force = g_cl.m_force.is_set();
+
+    if (g_cl.m_format.is_set())
+    {
+        const string format = lower_case(g_cl.m_format.value());
+        if (format == "tiff" || format == "tif")
+            settings.m_tiff = true;
+        else if (format != "exr")
+        {
+            LOG_ERROR(logger, "invalid texture format: %s.", g_cl.m_format.value().c_str());
+            return 1;
+        }
+    }
+
+    if (g_cl.m_tile_size.is_set())
+    {
+        settings.m_tile_size = g_cl.m_tile_size.value();
+        if (settings.m_tile_size <= 0)
+        {
+            LOG_ERROR(logger, "invalid tile size: %d.", settings.m_tile_size);
+            return 1;
+        }
+    }
+
+    const size_t thread_count =
+        g_cl.m_threads.is_set() && g_cl.m_threads.value() > 0
+            ? static_cast<size_t>(g_cl.m_threads.value())
+            : System::get_logical_cpu_core_count();
+
+    // Collect the textures to convert.
+    ConversionList conversions(settings);
+    deque<ProjectInput> projects;
+    bool success = true;
+
+    for (const string& input : g_cl.m_inputs.values())
+    {
+        const bf::path input_path(input);
+
+        if (bf::is_directory(input_path))
+            collect_directory_textures(input_path, conversions);
+        else if (is_project_file(input_path))
+        {
+            projects.emplace_back();
+            ProjectInput& project_input = projects.back();
+            project_input.m_filepath = input;
+            project_input.m_project = load_project(input);
+
+            if (project_input.m_project.get() == nullptr)
+            {
+                projects.pop_back();
+                success = false;
+                continue;
+            }
+
+            collect_textures(
+                *project_input.m_project->get_scene(),
+                project_input.m_project->search_paths(),
+                conversions,
+                project_input);
+        }
+        else if (bf::is_regular_file(input_path))
+            conversions.insert(input);
+        else
+        {
+            LOG_ERROR(logger, "%s does not exist.", input.c_str());
+            success = false;
+        }
+    }
+
+    vector<Conversion>& conversion_vector = conversions.conversions();
+
+    LOG_INFO(
+        logger,
+        "converting %s texture%s using %s thread%s...",
+        pretty_uint(conversion_vector.size()).c_str(),
+        conversion_vector.size() > 1 ? "s" : "",
+        pretty_uint(thread_count).c_str(),
+        thread_count > 1 ? "s" : "");
+
+    // Convert the textures in parallel. Parallelism is over textures:
+    // don't let each conversion spawn its own threads.
+    OIIO::attribute("threads", 1);
+
+    {
+        JobQueue job_queue;
+        JobManager job_manager(
+            logger,
+            job_queue,
+            thread_count,
+            JobManager::KeepRunningOnJobFailure);
+
+        for (Conversion& conversion : conversion_vector)
+            job_queue.schedule(new ConvertTextureJob(settings, conversion, logger));
+
+        job_manager.start();
+        job_queue.wait_until_completion();
+    }
+
+    // Report the outcome of the conversions.
+    size_t converted_count = 0;
+    size_t up_to_date_count = 0;
+
+    for (const Conversion& conversion : conversion_vector)
+    {
+        switch (conversion.m_status)
+        {
+          case Conversion::Converted:
+            ++converted_count;
+            break;
+
+          case Conversion::UpToDate:
+            ++up_to_date_count;
+            break;
+
+          default:
+            LOG_ERROR(
+                logger,
+                "failed to convert %s: %s",
+                conversion.m_source_path.c_str(),
+                conversion.m_error.c_str());
+            success = false;
+            break;
+        }
+    }
+
+    LOG_INFO(
+        logger,
+        "%s texture%s converted, %s up-to-date.",
+        pretty_uint(converted_count).c_str(),
+        converted_count > 1 ? "s" : "",
+        pretty_uint(up_to_date_count).c_str());
+
+    // Optionally make the textures of the input projects point to the converted files.
+    if (g_cl.m_rewrite_projects.is_set())
+    {
+        for (ProjectInput& project_input : projects)
+        {
+            if (!rewrite_project(project_input, conversion_vector, settings, logger))
+                success = false;
+        }
+    }
+
+    return success ? 0 : 1;
+}
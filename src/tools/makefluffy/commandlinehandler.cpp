@@ -130,6 +130,20 @@ CommandLineHandler::CommandLineHandler()
             .set_syntax("regex")
             .set_exact_value_count(1)
             .set_default_value("/(?!)/"));      // match nothing -- http://stackoverflow.com/a/4589566/393756
+
+    parser().add_option_handler(
+        &m_threads
+            .add_name("--threads")
+            .add_name("-j")
+            .set_description("set the number of objects processed in parallel (default is one per logical core)")
+            .set_syntax("count")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_memory_mappable
+            .add_name("--memory-mappable")
+            .add_name("-m")
+            .set_description("write binarycurve files in the uncompressed, memory-mappable format"));
 }
 
 void CommandLineHandler::print_program_usage(
@@ -62,6 +62,8 @@ class CommandLineHandler
     foundation::ValueOptionHandler<size_t>          m_presplits;
     foundation::ValueOptionHandler<std::string>     m_include;
     foundation::ValueOptionHandler<std::string>     m_exclude;
+    foundation::ValueOptionHandler<int>             m_threads;
+    foundation::FlagOptionHandler                   m_memory_mappable;
 
     // Constructor.
     CommandLineHandler();
@@ -47,10 +47,14 @@
 #include "foundation/math/sampling/mappings.h"
 #include "foundation/math/scalar.h"
 #include "foundation/math/vector.h"
+#include "foundation/platform/system.h"
+#include "foundation/platform/types.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/containers/dictionary.h"
 #include "foundation/utility/filter.h"
 #include "foundation/utility/foreach.h"
+#include "foundation/utility/job.h"
+#include "foundation/utility/murmurhash.h"
 #include "foundation/utility/uid.h"
 
 // Boost headers.
@@ -63,6 +67,7 @@
 #include <cstring>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace appleseed::makefluffy;
@@ -90,6 +95,7 @@ namespace
         GScalar     m_length_fuzziness;
         GScalar     m_curliness;
         size_t      m_split_count;
+        size_t      m_thread_count;
 
         explicit FluffParams(const CommandLineHandler& cl)
         {
@@ -103,6 +109,10 @@ namespace
             m_length_fuzziness = static_cast<GScalar>(cl.m_length_fuzziness.value());
             m_curliness = static_cast<GScalar>(cl.m_curliness.value());
             m_split_count = cl.m_presplits.value();
+            m_thread_count =
+                cl.m_threads.is_set() && cl.m_threads.value() > 0
+                    ? static_cast<size_t>(cl.m_threads.value())
+                    : System::get_logical_cpu_core_count();
         }
     };
 
@@ -176,6 +186,15 @@ namespace
         else object.push_curve3(curve);
     }
 
+    // Derive the seed of the random number generator of an object from its name,
+    // so that its curves don't depend on the order in which objects are processed.
+    uint32 make_object_seed(const char* object_name)
+    {
+        MurmurHash hash;
+        hash.append(string(object_name));
+        return static_cast<uint32>(hash.h1());
+    }
+
     auto_release_ptr<CurveObject> create_curve_object(
         const Assembly&             assembly,
         const MeshObject&           support_object,
@@ -201,7 +220,7 @@ namespace
         GScalar opacities[ControlPointCount];
         Color3f colors[ControlPointCount];
 
-        MersenneTwister rng;
+        MersenneTwister rng(make_object_seed(support_object.get_name()));
 
         for (size_t i = 0; i < params.m_curve_count; ++i)
         {
@@ -241,13 +260,43 @@ namespace
         return curve_object;
     }
 
+    // Job generating the curves of one support object.
+    class CreateCurveObjectJob
+      : public IJob
+    {
+      public:
+        CreateCurveObjectJob(
+            const Assembly&                 assembly,
+            const MeshObject&               support_object,
+            const FluffParams&              params,
+            auto_release_ptr<CurveObject>&  curve_object)
+          : m_assembly(assembly)
+          , m_support_object(support_object)
+          , m_params(params)
+          , m_curve_object(curve_object)
+        {
+        }
+
+        void execute(const size_t thread_index) override
+        {
+            m_curve_object = create_curve_object(m_assembly, m_support_object, m_params);
+        }
+
+      private:
+        const Assembly&                     m_assembly;
+        const MeshObject&                   m_support_object;
+        const FluffParams&                  m_params;
+        auto_release_ptr<CurveObject>&      m_curve_object;
+    };
+
     void make_fluffy(const Assembly& assembly, const FluffParams& params)
     {
         typedef vector<const ObjectInstance*> ObjectInstanceVector;
-        typedef map<const MeshObject*, ObjectInstanceVector> ObjectToInstanceMap;
+        typedef vector<pair<const MeshObject*, ObjectInstanceVector>> ObjectToInstanceVector;
 
-        // Establish an object -> object instance mapping.
-        ObjectToInstanceMap objects_to_instances;
+        // Establish an object -> object instance mapping, in the order objects are first instantiated.
+        ObjectToInstanceVector objects_to_instances;
+        map<const MeshObject*, size_t> object_indices;
         for (const_each<ObjectInstanceContainer> i = assembly.object_instances(); i; ++i)
         {
             const ObjectInstance& object_instance = *i;
@@ -267,19 +316,44 @@ namespace
                 continue;
 
             // Insert the (object, instance) pair into the mapping.
-            objects_to_instances[
-                static_cast<const MeshObject*>(object)].push_back(&object_instance);
+            const MeshObject* mesh_object = static_cast<const MeshObject*>(object);
+            const map<const MeshObject*, size_t>::const_iterator it = object_indices.find(mesh_object);
+            if (it == object_indices.end())
+            {
+                object_indices[mesh_object] = objects_to_instances.size();
+                objects_to_instances.push_back(make_pair(mesh_object, ObjectInstanceVector(1, &object_instance)));
+            }
+            else objects_to_instances[it->second].second.push_back(&object_instance);
         }
 
-        // Loop over the collected objects.
-        for (const_each<ObjectToInstanceMap> i = objects_to_instances; i; ++i)
+        // Create the curve objects in parallel.
+        vector<auto_release_ptr<CurveObject>> curve_objects(objects_to_instances.size());
         {
-            const MeshObject& support_object = *i->first;
-            const ObjectInstanceVector& support_object_instances = i->second;
+            JobQueue job_queue;
+            JobManager job_manager(
+                global_logger(),
+                job_queue,
+                params.m_thread_count);
 
-            // Create a curve object.
-            auto_release_ptr<CurveObject> curve_object =
-                create_curve_object(assembly, support_object, params);
+            for (size_t i = 0; i < objects_to_instances.size(); ++i)
+            {
+                job_queue.schedule(
+                    new CreateCurveObjectJob(
+                        assembly,
+                        *objects_to_instances[i].first,
+                        params,
+                        curve_objects[i]));
+            }
+
+            job_manager.start();
+            job_queue.wait_until_completion();
+        }
+
+        // Loop over the collected objects.
+        for (size_t i = 0; i < objects_to_instances.size(); ++i)
+        {
+            const ObjectInstanceVector& support_object_instances = objects_to_instances[i].second;
+            auto_release_ptr<CurveObject>& curve_object = curve_objects[i];
 
             // Instantiate the curve object into the assembly.
             for (const_each<ObjectInstanceVector> j = support_object_instances; j; ++j)
@@ -375,7 +449,10 @@ int main(int argc, char* argv[])
     const bool success =
         ProjectFileWriter::write(
             project.ref(),
-            output_filepath.c_str());
+            output_filepath.c_str(),
+            cl.m_memory_mappable.is_set()
+                ? ProjectFileWriter::MemoryMappableCurveFiles
+                : ProjectFileWriter::Defaults);
 
     return success ? 0 : 1;
 }
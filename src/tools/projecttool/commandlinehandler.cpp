@@ -59,6 +59,43 @@ CommandLineHandler::CommandLineHandler()
             .set_description("update the project to this revision (by default, update to the latest revision)")
             .set_syntax("revision")
             .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_checkpoints
+            .add_name("--checkpoints")
+            .add_name("-c")
+            .set_description("checkpoint files to merge")
+            .set_syntax("file1 [file2...]")
+            .set_min_value_count(1));
+
+    parser().add_option_handler(
+        &m_output
+            .add_name("--output")
+            .add_name("-o")
+            .set_description("write the merged frame to this file (by default, to the output file of the frame)")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_rays
+            .add_name("--rays")
+            .set_description("replay the rays of this ray dump file")
+            .set_syntax("filename")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_batch_size
+            .add_name("--batch-size")
+            .set_description("replay rays in batches of this size (by default, one ray at a time)")
+            .set_syntax("size")
+            .set_exact_value_count(1));
+
+    parser().add_option_handler(
+        &m_backend
+            .add_name("--backend")
+            .set_description("replay rays with this ray tracing backend (by default, native)")
+            .set_syntax("native|embree|gpu")
+            .set_exact_value_count(1));
 }
 
 void CommandLineHandler::print_program_usage(
@@ -75,7 +112,13 @@ void CommandLineHandler::print_program_usage(
     LOG_INFO(logger, "  clean                update a project to the latest revision and remove unused entities");
     LOG_INFO(logger, "  pack                 pack a project to an *.appleseedz file");
     LOG_INFO(logger, "  unpack               unpack an *.appleseedz file");
+    LOG_INFO(logger, "  tobinary             convert a project to an *.appleseedb binary project file");
+    LOG_INFO(logger, "  toxml                convert an *.appleseedb binary project file to a plain project file");
     LOG_INFO(logger, "  deps                 print dependencies between entities");
+    LOG_INFO(logger, "  merge                merge checkpoint files rendered with distinct pass ranges");
+    LOG_INFO(logger, "  analyze              estimate the rendering cost and memory usage of a project without rendering it");
+    LOG_INFO(logger, "  trees                build the acceleration structures of a project and print their statistics");
+    LOG_INFO(logger, "  replay               trace the rays of a ray dump file through a project and print timings");
     LOG_INFO(logger, "options:");
 
     parser().print_usage(logger);
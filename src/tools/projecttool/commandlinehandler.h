@@ -54,6 +54,11 @@ class CommandLineHandler
   public:
     foundation::ValueOptionHandler<std::string> m_positional_args;
     foundation::ValueOptionHandler<int>         m_to_revision;
+    foundation::ValueOptionHandler<std::string> m_checkpoints;
+    foundation::ValueOptionHandler<std::string> m_output;
+    foundation::ValueOptionHandler<std::string> m_rays;
+    foundation::ValueOptionHandler<int>         m_batch_size;
+    foundation::ValueOptionHandler<std::string> m_backend;
 
     // Constructor.
     CommandLineHandler();
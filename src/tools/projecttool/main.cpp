@@ -35,17 +35,23 @@
 #include "application/superlogger.h"
 
 // appleseed.renderer headers.
+#include "renderer/api/frame.h"
 #include "renderer/api/project.h"
+#include "renderer/api/scene.h"
+#include "renderer/api/trace.h"
 
 // appleseed.foundation headers.
+#include "foundation/utility/api/specializedapiarrays.h"
 #include "foundation/utility/autoreleaseptr.h"
 #include "foundation/utility/containers/dictionary.h"
+#include "foundation/utility/string.h"
 
 // Boost headers.
 #include "boost/filesystem/operations.hpp"
 #include "boost/filesystem/path.hpp"
 
 // Standard headers.
+#include <cstddef>
 #include <string>
 
 using namespace appleseed::projecttool;
@@ -59,7 +65,9 @@ namespace
 {
     CommandLineHandler g_cl;
 
-    auto_release_ptr<Project> load_project(const string& project_filepath)
+    auto_release_ptr<Project> load_project(
+        const string&                       project_filepath,
+        const int                           options = ProjectFileReader::Defaults)
     {
         // Construct the schema file path.
         const bf::path schema_filepath =
@@ -76,7 +84,7 @@ namespace
             reader.read(
                 project_filepath.c_str(),
                 schema_filepath.string().c_str(),
-                ProjectFileReader::OmitProjectFileUpdate);
+                ProjectFileReader::OmitProjectFileUpdate | options);
     }
 }
 
@@ -201,6 +209,60 @@ bool unpack_project()
 }
 
 
+//
+// Convert a project to an *.appleseedb binary project file.
+//
+
+bool convert_project_to_binary()
+{
+    // Retrieve the input project path.
+    const string& input_filepath = g_cl.m_positional_args.values()[1];
+
+    // Read the input project from disk.
+    auto_release_ptr<Project> project(load_project(input_filepath));
+    if (project.get() == nullptr)
+        return false;
+
+    // Build the path of the output project.
+    const string binary_file_path =
+        bf::path(input_filepath).replace_extension(".appleseedb").string();
+
+    // Write the project to disk.
+    return
+        ProjectFileWriter::write(
+            project.ref(),
+            binary_file_path.c_str(),
+            ProjectFileWriter::OmitWritingGeometryFiles | ProjectFileWriter::OmitHandlingAssetFiles);
+}
+
+
+//
+// Convert an *.appleseedb binary project file to a plain project file.
+//
+
+bool convert_project_to_xml()
+{
+    // Retrieve the input project path.
+    const string& input_filepath = g_cl.m_positional_args.values()[1];
+
+    // Read the input project from disk.
+    auto_release_ptr<Project> project(load_project(input_filepath));
+    if (project.get() == nullptr)
+        return false;
+
+    // Build the path of the output project.
+    const string plain_file_path =
+        bf::path(input_filepath).replace_extension(".appleseed").string();
+
+    // Write the project to disk.
+    return
+        ProjectFileWriter::write(
+            project.ref(),
+            plain_file_path.c_str(),
+            ProjectFileWriter::OmitWritingGeometryFiles | ProjectFileWriter::OmitHandlingAssetFiles);
+}
+
+
 //
 // Print dependencies between entities.
 //
@@ -223,6 +285,208 @@ bool print_entity_dependencies(SuperLogger& logger)
 }
 
 
+//
+// Merge checkpoint files rendered with distinct pass ranges.
+//
+
+bool merge_checkpoints(SuperLogger& logger)
+{
+    if (!g_cl.m_checkpoints.is_set())
+    {
+        LOG_ERROR(logger, "no checkpoint files to merge, use %s.", g_cl.m_checkpoints.get_name().c_str());
+        return false;
+    }
+
+    // Retrieve the input project path.
+    const string& input_filepath = g_cl.m_positional_args.values()[1];
+
+    // Read the input project from disk. Mesh files are not needed to merge checkpoints.
+    auto_release_ptr<Project> project(
+        load_project(input_filepath, ProjectFileReader::OmitReadingMeshFiles));
+    if (project.get() == nullptr)
+        return false;
+
+    Frame* frame = project->get_frame();
+    if (frame == nullptr)
+    {
+        LOG_ERROR(logger, "project %s has no frame.", input_filepath.c_str());
+        return false;
+    }
+
+    // Accumulate the checkpoints into the frame.
+    StringArray checkpoint_paths;
+    for (const string& checkpoint_path : g_cl.m_checkpoints.values())
+        checkpoint_paths.push_back(checkpoint_path.c_str());
+    if (!frame->merge_checkpoints(checkpoint_paths))
+        return false;
+
+    frame->post_process_aov_images();
+
+    // Write the merged frame to disk.
+    if (g_cl.m_output.is_set())
+    {
+        const char* file_path = g_cl.m_output.value().c_str();
+        return frame->write_main_image(file_path) && frame->write_aov_images(file_path);
+    }
+    else return frame->write_main_and_aov_images();
+}
+
+
+//
+// Estimate the rendering cost and memory usage of a project.
+//
+
+bool analyze_project(SuperLogger& logger)
+{
+    // Retrieve the input project path.
+    const string& input_filepath = g_cl.m_positional_args.values()[1];
+
+    // Read the input project from disk.
+    auto_release_ptr<Project> project(load_project(input_filepath));
+    if (project.get() == nullptr)
+        return false;
+
+    // Analyze the project and print the report.
+    const ProjectAnalyzer analyzer(project.ref());
+    analyzer.print_report(logger);
+
+    return true;
+}
+
+
+//
+// Build the acceleration structures of a project and print their statistics.
+//
+
+bool print_tree_statistics(SuperLogger& logger)
+{
+    // Retrieve the input project path.
+    const string& input_filepath = g_cl.m_positional_args.values()[1];
+
+    // Read the input project from disk.
+    auto_release_ptr<Project> project(load_project(input_filepath));
+    if (project.get() == nullptr)
+        return false;
+
+    // Build the acceleration structures and print their statistics.
+    if (!project->build_trace_context())
+    {
+        LOG_ERROR(logger, "failed to build the acceleration structures of project %s.", input_filepath.c_str());
+        return false;
+    }
+
+    project->get_trace_context().print_tree_statistics(logger);
+
+    return true;
+}
+
+
+//
+// Trace the rays of a ray dump file through a project and print timings.
+//
+
+namespace
+{
+    void print_replay_counts(
+        SuperLogger&                            logger,
+        const char*                             label,
+        const RayDumpReplayStatistics::Counts&  counts)
+    {
+        if (counts.m_ray_count == 0)
+            return;
+
+        LOG_INFO(
+            logger,
+            "  %-14s %s %s in %s (%s rays/s), %s hit, %s hit %s, %s distance %s",
+            label,
+            pretty_uint(counts.m_ray_count).c_str(),
+            plural(counts.m_ray_count, "ray").c_str(),
+            pretty_time(counts.m_seconds).c_str(),
+            pretty_ratio(static_cast<double>(counts.m_ray_count), counts.m_seconds).c_str(),
+            pretty_percent(counts.m_hit_count, counts.m_ray_count).c_str(),
+            pretty_uint(counts.m_hit_mismatch_count).c_str(),
+            plural(counts.m_hit_mismatch_count, "mismatch", "mismatches").c_str(),
+            pretty_uint(counts.m_distance_mismatch_count).c_str(),
+            plural(counts.m_distance_mismatch_count, "mismatch", "mismatches").c_str());
+    }
+}
+
+bool replay_rays(SuperLogger& logger)
+{
+    if (!g_cl.m_rays.is_set())
+    {
+        LOG_ERROR(logger, "the replay command requires a ray dump file (--rays).");
+        return false;
+    }
+
+    const size_t batch_size =
+        g_cl.m_batch_size.is_set() && g_cl.m_batch_size.value() > 1
+            ? static_cast<size_t>(g_cl.m_batch_size.value())
+            : 1;
+
+    const string backend = g_cl.m_backend.is_set() ? g_cl.m_backend.value() : "native";
+    if (backend != "native"
+#ifdef APPLESEED_WITH_EMBREE
+        && backend != "embree"
+#endif
+#ifdef APPLESEED_WITH_GPU
+        && backend != "gpu"
+#endif
+        )
+    {
+        LOG_ERROR(logger, "unsupported ray tracing backend: %s", backend.c_str());
+        return false;
+    }
+
+    // Retrieve the input project path.
+    const string& input_filepath = g_cl.m_positional_args.values()[1];
+
+    // Read the input project from disk.
+    auto_release_ptr<Project> project(load_project(input_filepath));
+    if (project.get() == nullptr)
+        return false;
+
+    // Select the ray tracing backend, then build the acceleration structures.
+    project->get_trace_context();
+#ifdef APPLESEED_WITH_EMBREE
+    project->set_use_embree(backend == "embree");
+#endif
+#ifdef APPLESEED_WITH_GPU
+    project->set_use_gpu(backend == "gpu");
+#endif
+    if (!project->build_trace_context())
+    {
+        LOG_ERROR(logger, "failed to build the acceleration structures of project %s.", input_filepath.c_str());
+        return false;
+    }
+
+    // Replay the rays.
+    const string& rays_filepath = g_cl.m_rays.value();
+    RayDumpReplayStatistics stats;
+    if (!replay_ray_dump(rays_filepath.c_str(), project->get_trace_context(), batch_size, stats))
+    {
+        LOG_ERROR(logger, "failed to replay ray dump file %s.", rays_filepath.c_str());
+        return false;
+    }
+
+    LOG_INFO(
+        logger,
+        "replayed ray dump file %s with the %s backend, %s:",
+        rays_filepath.c_str(),
+        backend.c_str(),
+        batch_size > 1
+            ? ("batches of " + pretty_uint(batch_size) + " rays").c_str()
+            : "one ray at a time");
+
+    print_replay_counts(logger, "total", stats.m_total);
+
+    for (size_t i = 0; i < RayDumpReplayStatistics::RayTypeCount && i < VisibilityFlags::Count; ++i)
+        print_replay_counts(logger, VisibilityFlags::Names[i], stats.m_ray_types[i]);
+
+    return true;
+}
+
+
 //
 // Entry point of projecttool.
 //
@@ -268,8 +532,20 @@ int main(int argc, char* argv[])
         success = pack_project();
     else if (command == "unpack")
         success = unpack_project();
+    else if (command == "tobinary")
+        success = convert_project_to_binary();
+    else if (command == "toxml")
+        success = convert_project_to_xml();
     else if (command == "deps")
         success = print_entity_dependencies(logger);
+    else if (command == "merge")
+        success = merge_checkpoints(logger);
+    else if (command == "analyze")
+        success = analyze_project(logger);
+    else if (command == "trees")
+        success = print_tree_statistics(logger);
+    else if (command == "replay")
+        success = replay_rays(logger);
     else LOG_ERROR(logger, "unknown command: %s", command.c_str());
 
     return success ? 0 : 1;